@@ -11,11 +11,22 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include "core/platform.h"
 #include "ac/spritecache.h"
 #include "ac/gamestructdefines.h"
+#include "debug/eventtrace.h"
 #include "debug/out.h"
 #include "gfx/bitmap.h"
+#include "util/jobscheduler.h"
 #include "util/memory_compat.h"
 
 using namespace AGS::Common;
@@ -30,10 +41,12 @@ using namespace AGS::Common;
 #define SPRCACHEFLAG_ERROR          0x04
 // Locked sprites are ones that should not be freed when out of cache space.
 #define SPRCACHEFLAG_LOCKED         0x08
+// Tells that the sprite's image is kept as an indexed bitmap with palette.
+#define SPRCACHEFLAG_INDEXED        0x10
 
 // High-verbosity sprite cache log
 #if DEBUG_SPRITECACHE
-#define SprCacheLog(...) Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Debug, __VA_ARGS__)
+#define SprCacheLog(...) DEBUG_PRINTF(kDbgGroup_SprCache, kDbgMsg_Debug, __VA_ARGS__)
 #else
 #define SprCacheLog(...)
 #endif
@@ -44,6 +57,118 @@ namespace AGS
 namespace Common
 {
 
+struct SpriteCache::PrefetchState
+{
+    std::thread Thread;
+    // Guards the sprite file access, while the background thread is running
+    std::mutex FileMutex;
+    // Guards all the fields below
+    std::mutex Mutex;
+    // Wakes the background thread when there are new requests
+    std::condition_variable WakeCv;
+    // Signals that the background thread has finished loading a sprite
+    std::condition_variable ReadyCv;
+    // Requested sprites in the order of loading; may contain the ones
+    // already cancelled, which are not in the Queued set anymore
+    std::deque<sprkey_t> Queue;
+    std::unordered_set<sprkey_t> Queued;
+    // The sprite being loaded right now
+    sprkey_t Current = -1;
+    // Loaded sprites, waiting to be put into the cache;
+    // null image means that the sprite failed to load
+    struct PrefetchedSprite
+    {
+        std::unique_ptr<Bitmap> Image;
+        std::unique_ptr<SpritePalette> Palette;
+        uint32_t Cost = 0u; // loading time, in microseconds
+    };
+    std::unordered_map<sprkey_t, PrefetchedSprite> Ready;
+    bool Stop = false;
+};
+
+// Returns the time passed since the given moment, in microseconds,
+// used as the sprite's cost of re-loading in the cache
+static uint32_t GetLoadCost(const std::chrono::steady_clock::time_point &start)
+{
+    const int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    return static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(us, 1), UINT32_MAX));
+}
+
+// Max total size of the raw sprite data, read at once by PrecacheSprites
+// before decoding; limits the memory used for the intermediate buffers
+static const size_t BulkLoadBatchSize = 16u * 1024 * 1024;
+
+// Sprite loaded by PrecacheSprites
+struct BulkLoadedSprite
+{
+    sprkey_t Index = -1;
+    SpriteDatHeader Hdr;
+    std::vector<uint8_t> Data; // raw sprite data
+    std::unique_ptr<Bitmap> Image;
+    std::unique_ptr<SpritePalette> Palette;
+    HError Err;
+    uint32_t Cost = 0u; // reading and decoding time, in microseconds
+};
+
+// Decodes the raw data of the loaded sprites using up to the given number
+// of job threads, including the calling one
+static void DecodeBulkSprites(const SpriteFile &file, std::vector<BulkLoadedSprite> &sprites, size_t max_threads)
+{
+    JobScheduler::Global().ParallelFor("Decode sprites", sprites.size(), [&file, &sprites](size_t i)
+    {
+        auto &spr = sprites[i];
+        if (!spr.Err)
+            return;
+        const auto decode_start = std::chrono::steady_clock::now();
+        Bitmap *image{};
+        spr.Err = file.DecodeRawData(spr.Index, spr.Hdr, spr.Data, image, spr.Palette.get());
+        spr.Image.reset(image);
+        spr.Data = std::vector<uint8_t>(); // release the raw data right away
+        spr.Cost = static_cast<uint32_t>(std::min<uint64_t>(
+            static_cast<uint64_t>(spr.Cost) + GetLoadCost(decode_start), UINT32_MAX));
+    }, max_threads);
+}
+
+// Expands the 8-bit image of palette indexes into the full color image
+static std::unique_ptr<Bitmap> ExpandIndexedBitmap(const Bitmap *image, const SpritePalette &palette)
+{
+    std::unique_ptr<Bitmap> full(
+        BitmapHelper::CreateBitmap(image->GetWidth(), image->GetHeight(), palette.ColorDepth));
+    if (!full)
+        return nullptr;
+    // use a full lookup table, in case the image has any indexes past the palette
+    std::array<uint32_t, 256> colors {};
+    std::copy_n(palette.Colors.begin(), std::min<size_t>(palette.Colors.size(), colors.size()), colors.begin());
+    const int w = image->GetWidth();
+    for (int y = 0; y < image->GetHeight(); ++y)
+    {
+        const uint8_t *src = image->GetScanLine(y);
+        switch (full->GetBPP())
+        {
+        case 2:
+        {
+            uint16_t *dst = reinterpret_cast<uint16_t*>(full->GetScanLineForWriting(y));
+            for (int x = 0; x < w; ++x)
+                dst[x] = static_cast<uint16_t>(colors[src[x]]);
+            break;
+        }
+        case 4:
+        {
+            uint32_t *dst = reinterpret_cast<uint32_t*>(full->GetScanLineForWriting(y));
+            for (int x = 0; x < w; ++x)
+                dst[x] = colors[src[x]];
+            break;
+        }
+        default:
+            for (int x = 0; x < w; ++x)
+                full->PutPixel(x, y, colors[src[x]]);
+            break;
+        }
+    }
+    return full;
+}
+
 SpriteCache::SpriteCache(std::vector<SpriteInfo> &sprInfos, const Callbacks &callbacks)
     : ResourceCache(DEFAULTCACHESIZE_KB * 1024u)
     , _sprInfos(sprInfos)
@@ -52,11 +177,17 @@ SpriteCache::SpriteCache(std::vector<SpriteInfo> &sprInfos, const Callbacks &cal
     _callbacks.InitSprite = (callbacks.InitSprite) ? callbacks.InitSprite : DummyInitSprite;
     _callbacks.PostInitSprite = (callbacks.PostInitSprite) ? callbacks.PostInitSprite : DummyPostInitSprite;
     _callbacks.PrewriteSprite = (callbacks.PrewriteSprite) ? callbacks.PrewriteSprite : DummyPrewriteSprite;
+    _callbacks.LockChanged = (callbacks.LockChanged) ? callbacks.LockChanged : DummyLockChanged;
 
     // Generate a placeholder sprite: 1x1 transparent bitmap
     _placeholder.reset(BitmapHelper::CreateTransparentBitmap(1, 1));
 }
 
+SpriteCache::~SpriteCache()
+{
+    StopPrefetch();
+}
+
 size_t SpriteCache::GetSpriteSlotCount() const
 {
     return _spriteData.size();
@@ -78,8 +209,21 @@ bool SpriteCache::IsSpriteLoaded(sprkey_t index) const
     return ResourceCache::Exists(index);
 }
 
+bool SpriteCache::IsSpriteLocked(sprkey_t index) const
+{
+    return index >= 0 && (size_t)index < _spriteData.size() &&
+        _spriteData[index].IsAssetSprite() && _spriteData[index].IsLocked();
+}
+
+bool SpriteCache::IsSpriteIndexed(sprkey_t index) const
+{
+    return index >= 0 && (size_t)index < _spriteData.size() &&
+        _spriteData[index].IsIndexed() && ResourceCache::Exists(index);
+}
+
 void SpriteCache::Reset()
 {
+    StopPrefetch();
     _file.Close();
     ResourceCache::Clear();
     _spriteData.clear();
@@ -107,6 +251,7 @@ bool SpriteCache::SetSprite(sprkey_t index, std::unique_ptr<Bitmap> image, int f
         | (SPF_TRUECOLOR * image->GetColorDepth() > 16);
     _sprInfos[index] = SpriteInfo(image->GetWidth(), image->GetHeight(), spf_flags);
     _spriteData[index].Flags = SPRCACHEFLAG_EXTERNAL | SPRCACHEFLAG_LOCKED; // NOT from asset file
+    _spriteData[index].Mask.reset();
     Put(index, std::move(image), kCacheItem_External | kCacheItem_Locked);
     SprCacheLog("SetSprite: (external) %d", index);
     return true;
@@ -121,6 +266,7 @@ void SpriteCache::SetEmptySprite(sprkey_t index, bool as_asset)
         return;
     }
     ResourceCache::Dispose(index); // make sure it's free
+    _spriteData[index].Mask.reset();
     if (as_asset)
         _spriteData[index].Flags = SPRCACHEFLAG_ISASSET;
     RemapSpriteToPlaceholder(index);
@@ -132,6 +278,8 @@ std::unique_ptr<Bitmap> SpriteCache::RemoveSprite(sprkey_t index)
     if (index < 0 || (size_t)index >= _spriteData.size())
         return nullptr;
     std::unique_ptr<Bitmap> image = ResourceCache::Remove(index);
+    if (image && _spriteData[index].IsIndexed())
+        image = ExpandIndexedBitmap(image.get(), *_spriteData[index].Palette);
     InitNullSprite(index);
     SprCacheLog("RemoveSprite: %d", index);
     return image;
@@ -201,6 +349,11 @@ bool SpriteCache::SpriteData::IsLocked() const
     return (Flags & SPRCACHEFLAG_LOCKED) != 0;
 }
 
+bool SpriteCache::SpriteData::IsIndexed() const
+{
+    return (Flags & SPRCACHEFLAG_INDEXED) != 0;
+}
+
 bool SpriteCache::DoesSpriteExist(sprkey_t index) const
 {
     return (index >= 0 && (size_t)index < _spriteData.size()) && // in the valid range
@@ -222,17 +375,50 @@ Bitmap *SpriteCache::operator [] (sprkey_t index)
     // Try get image from cache
     auto &image = ResourceCache::Get(index);
     if (image)
+    {
+        // The indexed image has to be expanded, as the caller needs
+        // a full color bitmap
+        if (_spriteData[index].IsIndexed())
+        {
+            auto *bitmap = ExpandIndexedSprite(index);
+            return bitmap ? bitmap : _placeholder.get();
+        }
         return image.get();
+    }
     // If no ready image, but has an asset, then try loading one
     if (_spriteData[index].IsAssetSprite())
     {
         auto *bitmap = LoadSprite(index);
+        if (bitmap && _spriteData[index].IsIndexed())
+            bitmap = ExpandIndexedSprite(index);
         if (bitmap)
             return bitmap;
     }
     return _placeholder.get();
 }
 
+const BitMask *SpriteCache::GetSpriteMask(sprkey_t index)
+{
+    assert(index >= 0); // out of positive range indexes are valid to fail
+    if (!DoesSpriteExist(index) || _spriteData[index].IsError())
+        return nullptr;
+    auto &mask = _spriteData[index].Mask;
+    if (!mask)
+    {
+        Bitmap *image = (*this)[index];
+        if (!image)
+            return nullptr;
+        mask.reset(new BitMask(image));
+    }
+    return mask.get();
+}
+
+void SpriteCache::InvalidateSpriteMask(sprkey_t index)
+{
+    if (index >= 0 && (size_t)index < _spriteData.size())
+        _spriteData[index].Mask.reset();
+}
+
 void SpriteCache::DisposeAllCached()
 {
     ResourceCache::DisposeFreeItems();
@@ -251,6 +437,73 @@ void SpriteCache::PrecacheSprite(sprkey_t index)
     SprCacheLog("Precached %d", index);
 }
 
+void SpriteCache::PrecacheSprites(const std::vector<sprkey_t> &indexes)
+{
+    std::vector<std::pair<soff_t, sprkey_t>> request;
+    for (const auto index : indexes)
+    {
+        if (index < 0 || (size_t)index >= _spriteData.size() ||
+            !_spriteData[index].IsAssetSprite() || _spriteData[index].IsError() ||
+            ResourceCache::Exists(index))
+            continue; // only the valid asset sprites, which are not loaded yet
+        // Take the sprite if it was prefetched, this also cancels its prefetch request
+        std::unique_ptr<SpritePalette> palette;
+        uint32_t cost = 0u;
+        Bitmap *image = TakePrefetchedSprite(index, palette, cost);
+        if (image)
+            InitLoadedSprite(index, image, std::move(palette), false, cost);
+        else
+            request.push_back(std::make_pair(_file.GetSpriteOffset(index), index));
+    }
+    if (request.empty())
+        return;
+
+    std::sort(request.begin(), request.end());
+    request.erase(std::unique(request.begin(), request.end()), request.end());
+    const size_t max_threads = (_decodeThreads > 0u) ? _decodeThreads : SIZE_MAX;
+    std::vector<BulkLoadedSprite> batch;
+    for (size_t at = 0; at < request.size();)
+    {
+        // Read the raw data of the next sprites sequentially
+        batch.clear();
+        size_t batch_size = 0u;
+        {
+            std::unique_lock<std::mutex> file_lk;
+            if (_prefetch)
+                file_lk = std::unique_lock<std::mutex>(_prefetch->FileMutex);
+            for (; (at < request.size()) && (batch_size < BulkLoadBatchSize); ++at)
+            {
+                batch.emplace_back();
+                auto &spr = batch.back();
+                spr.Index = request[at].second;
+                if (_keepIndexed)
+                    spr.Palette.reset(new SpritePalette());
+                const auto load_start = std::chrono::steady_clock::now();
+                spr.Err = _file.LoadRawData(spr.Index, spr.Hdr, spr.Data);
+                spr.Cost = GetLoadCost(load_start);
+                batch_size += spr.Data.size();
+            }
+        }
+
+        // Decode them in parallel, but initialize and put into the cache here,
+        // as the callbacks are expected to run on this thread
+        DecodeBulkSprites(_file, batch, max_threads);
+        for (auto &spr : batch)
+        {
+            if (!spr.Image)
+            {
+                Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Warn,
+                    "LoadSprite: failed to load sprite %d:\n%s\n - remapping to placeholder.", spr.Index,
+                    spr.Err ? "Sprite does not exist." : spr.Err->FullMessage().GetCStr());
+                RemapSpriteToPlaceholder(spr.Index);
+                continue;
+            }
+            InitLoadedSprite(spr.Index, spr.Image.release(), std::move(spr.Palette), false, spr.Cost);
+        }
+    }
+    SprCacheLog("Precached %zu sprites, normal size %zu KB", request.size(), _cacheSize / 1024);
+}
+
 std::unique_ptr<Bitmap> SpriteCache::LoadSpriteNoCache(sprkey_t index)
 {
     // invalid sprite slot
@@ -261,7 +514,11 @@ std::unique_ptr<Bitmap> SpriteCache::LoadSpriteNoCache(sprkey_t index)
     // Try get image from cache
     auto &image = ResourceCache::Get(index);
     if (image)
+    {
+        if (_spriteData[index].IsIndexed())
+            return ExpandIndexedBitmap(image.get(), *_spriteData[index].Palette);
         return std::unique_ptr<Bitmap>(BitmapHelper::CreateBitmapCopy(image.get()));
+    }
     // If no ready image, but has an asset, then try loading one
     if (_spriteData[index].IsAssetSprite())
     {
@@ -269,7 +526,17 @@ std::unique_ptr<Bitmap> SpriteCache::LoadSpriteNoCache(sprkey_t index)
         // that assumes that the sprite can be accessed from cache by index.
         auto *bitmap = LoadSprite(index);
         if (bitmap)
-            return ResourceCache::Remove(index);
+        {
+            std::unique_ptr<Bitmap> loaded = ResourceCache::Remove(index);
+            auto &data = _spriteData[index];
+            if (data.IsIndexed())
+            {
+                loaded = ExpandIndexedBitmap(loaded.get(), *data.Palette);
+                data.Flags &= ~SPRCACHEFLAG_INDEXED;
+                data.Palette.reset();
+            }
+            return loaded;
+        }
     }
     return std::unique_ptr<Bitmap>(BitmapHelper::CreateBitmapCopy(_placeholder.get()));
 }
@@ -291,6 +558,7 @@ void SpriteCache::LockSprite(sprkey_t index)
     {
         LoadSprite(index, true);
     }
+    _callbacks.LockChanged(index, true);
     SprCacheLog("Locked %d", index);
 }
 
@@ -305,6 +573,7 @@ void SpriteCache::UnlockSprite(sprkey_t index)
 
     ResourceCache::Release(index);
     _spriteData[index].Flags &= ~SPRCACHEFLAG_LOCKED;
+    _callbacks.LockChanged(index, false);
     SprCacheLog("Unlocked %d", index);
 }
 
@@ -316,13 +585,31 @@ size_t SpriteCache::CalcSize(const std::unique_ptr<Bitmap> &item)
 
 Bitmap *SpriteCache::LoadSprite(sprkey_t index, bool lock)
 {
+    AGS_TRACE_ZONE("LoadSprite");
     assert((index >= 0) && ((size_t)index < _spriteData.size()));
     if (index < 0 || (size_t)index >= _spriteData.size())
         return nullptr;
     assert((_spriteData[index].Flags & SPRCACHEFLAG_ISASSET) != 0);
 
-    Bitmap *image{};
-    HError err = _file.LoadSprite(index, image);
+    std::unique_ptr<SpritePalette> palette;
+    uint32_t cost = 0u;
+    Bitmap *image = TakePrefetchedSprite(index, palette, cost);
+    if (image)
+        return InitLoadedSprite(index, image, std::move(palette), lock, cost);
+
+    if (_keepIndexed)
+        palette.reset(new SpritePalette());
+    const auto load_start = std::chrono::steady_clock::now();
+    HError err = HError::None();
+    if (_prefetch)
+    {
+        std::lock_guard<std::mutex> lk(_prefetch->FileMutex);
+        err = _file.LoadSprite(index, image, palette.get());
+    }
+    else
+    {
+        err = _file.LoadSprite(index, image, palette.get());
+    }
     if (!image)
     {
         Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Warn,
@@ -331,9 +618,27 @@ Bitmap *SpriteCache::LoadSprite(sprkey_t index, bool lock)
         RemapSpriteToPlaceholder(index);
         return nullptr;
     }
+    return InitLoadedSprite(index, image, std::move(palette), lock, GetLoadCost(load_start));
+}
+
+Bitmap *SpriteCache::InitLoadedSprite(sprkey_t index, Bitmap *image, std::unique_ptr<SpritePalette> &&palette,
+                                      bool lock, uint32_t cost)
+{
+    if (palette && (palette->Colors.empty() || !InitIndexedPalette(index, image, *palette)))
+    {
+        // Not an indexed image, or it cannot be kept as such
+        if (!palette->Colors.empty())
+        {
+            std::unique_ptr<Bitmap> full = ExpandIndexedBitmap(image, *palette);
+            delete image;
+            image = full.release();
+        }
+        palette.reset();
+    }
 
     // Let the external user convert this sprite's image for their needs
-    image = _callbacks.InitSprite(index, image, _sprInfos[index].Flags);
+    if (image && !palette)
+        image = _callbacks.InitSprite(index, image, _sprInfos[index].Flags);
     if (!image)
     {
         Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Warn,
@@ -348,10 +653,13 @@ Bitmap *SpriteCache::LoadSprite(sprkey_t index, bool lock)
 
     // Add to the cache, lock if requested or if it's sprite 0
     const bool should_lock = lock || (index == 0);
-    ResourceCache::Put(index, std::unique_ptr<Bitmap>(image), kCacheItem_Locked * should_lock);
+    ResourceCache::RecordLoad(image->GetWidth() * image->GetHeight() * image->GetBPP(), cost);
+    ResourceCache::Put(index, std::unique_ptr<Bitmap>(image), kCacheItem_Locked * should_lock, cost);
     _spriteData[index].Flags =
           SPRCACHEFLAG_ISASSET |
-          SPRCACHEFLAG_LOCKED * should_lock;
+          SPRCACHEFLAG_LOCKED * should_lock |
+          SPRCACHEFLAG_INDEXED * (palette != nullptr);
+    _spriteData[index].Palette = std::move(palette);
     SprCacheLog("Loaded %d, normal size %zu KB", index, _cacheSize / 1024);
 
     // Let the external user to react to the new sprite;
@@ -361,6 +669,195 @@ Bitmap *SpriteCache::LoadSprite(sprkey_t index, bool lock)
     return image;
 }
 
+bool SpriteCache::InitIndexedPalette(sprkey_t index, const Bitmap *image, SpritePalette &palette)
+{
+    // The sprite's conversion may be done on its palette only if it does not
+    // change the sprite's size, in which case it only depends on the colors
+    if (_callbacks.AdjustSize(image->GetSize(), _sprInfos[index].Flags) != image->GetSize())
+        return false;
+    const int count = static_cast<int>(palette.Colors.size());
+    Bitmap *strip = BitmapHelper::CreateBitmap(count, 1, palette.ColorDepth);
+    if (!strip)
+        return false;
+    for (int i = 0; i < count; ++i)
+        strip->PutPixel(i, 0, palette.Colors[i]);
+    uint32_t flags = _sprInfos[index].Flags;
+    std::unique_ptr<Bitmap> result(_callbacks.InitSprite(index, strip, flags));
+    if (!result || (result->GetWidth() != count) || (result->GetHeight() != 1))
+        return false;
+    _sprInfos[index].Flags = flags;
+    palette.ColorDepth = result->GetColorDepth();
+    for (int i = 0; i < count; ++i)
+        palette.Colors[i] = static_cast<uint32_t>(result->GetPixel(i, 0));
+    return true;
+}
+
+Bitmap *SpriteCache::ExpandIndexedSprite(sprkey_t index)
+{
+    auto &data = _spriteData[index];
+    std::unique_ptr<Bitmap> full = ExpandIndexedBitmap(ResourceCache::Get(index).get(), *data.Palette);
+    if (!full)
+        return nullptr;
+    Bitmap *image = full.get();
+    data.Flags &= ~SPRCACHEFLAG_INDEXED;
+    data.Palette.reset();
+    ResourceCache::Put(index, std::move(full), kCacheItem_Locked * data.IsLocked(), ResourceCache::GetCost(index));
+    SprCacheLog("Expanded indexed %d, normal size %zu KB", index, _cacheSize / 1024);
+    return image;
+}
+
+void SpriteCache::PrefetchSprites(const std::vector<sprkey_t> &indexes)
+{
+    if (!_prefetch)
+        _prefetch.reset(new PrefetchState());
+    auto &pf = *_prefetch;
+    std::vector<std::pair<soff_t, sprkey_t>> request;
+    {
+        std::lock_guard<std::mutex> lk(pf.Mutex);
+        for (const auto index : indexes)
+        {
+            if (index < 0 || (size_t)index >= _spriteData.size() ||
+                !_spriteData[index].IsAssetSprite() || _spriteData[index].IsError())
+                continue; // only the valid asset sprites may be loaded
+            if (ResourceCache::Exists(index) || (index == pf.Current) ||
+                (pf.Queued.count(index) > 0) || (pf.Ready.count(index) > 0))
+                continue; // already there or requested
+            request.push_back(std::make_pair(_file.GetSpriteOffset(index), index));
+        }
+    }
+    if (request.empty())
+        return;
+
+    // Read the sprites in the file order, which makes reading mostly sequential;
+    // don't request more than would fit into the cache, as the excess sprites
+    // would only push the other requested ones out
+    std::sort(request.begin(), request.end());
+    request.erase(std::unique(request.begin(), request.end()), request.end());
+    const size_t max_size = ResourceCache::GetMaxCacheSize();
+    const size_t cur_size = ResourceCache::GetCacheSize();
+    size_t free_size = max_size > cur_size ? max_size - cur_size : 0u;
+    size_t added = 0u;
+    {
+        std::lock_guard<std::mutex> lk(pf.Mutex);
+        for (const auto &item : request)
+        {
+            const sprkey_t index = item.second;
+            // the final color depth is not known until the sprite is loaded,
+            // so assume the highest one
+            const size_t size = _sprInfos[index].Width * _sprInfos[index].Height * 4u;
+            if (size > free_size)
+                break;
+            free_size -= size;
+            pf.Queue.push_back(index);
+            pf.Queued.insert(index);
+            added++;
+        }
+    }
+    if (added == 0u)
+        return;
+    SprCacheLog("Prefetch: requested %zu sprites", added);
+    if (!pf.Thread.joinable())
+        pf.Thread = std::thread(&SpriteCache::PrefetchThread, this);
+    pf.WakeCv.notify_one();
+}
+
+void SpriteCache::ProcessPrefetchedSprites()
+{
+    if (!_prefetch)
+        return;
+    std::unordered_map<sprkey_t, PrefetchState::PrefetchedSprite> ready;
+    {
+        std::lock_guard<std::mutex> lk(_prefetch->Mutex);
+        if (_prefetch->Ready.empty())
+            return;
+        std::swap(ready, _prefetch->Ready);
+    }
+    for (auto &item : ready)
+    {
+        const sprkey_t index = item.first;
+        // Skip the failed ones, these will report errors when loaded normally;
+        // also skip the slots which were changed while the sprite was loading
+        if (!item.second.Image || (size_t)index >= _spriteData.size() ||
+            !_spriteData[index].IsAssetSprite() || _spriteData[index].IsError() ||
+            ResourceCache::Exists(index))
+            continue;
+        InitLoadedSprite(index, item.second.Image.release(), std::move(item.second.Palette), false, item.second.Cost);
+    }
+    SprCacheLog("Prefetch: cached %zu sprites, normal size %zu KB", ready.size(), _cacheSize / 1024);
+}
+
+void SpriteCache::StopPrefetch()
+{
+    if (!_prefetch)
+        return;
+    {
+        std::lock_guard<std::mutex> lk(_prefetch->Mutex);
+        _prefetch->Stop = true;
+    }
+    _prefetch->WakeCv.notify_one();
+    if (_prefetch->Thread.joinable())
+        _prefetch->Thread.join();
+    _prefetch.reset();
+}
+
+Bitmap *SpriteCache::TakePrefetchedSprite(sprkey_t index, std::unique_ptr<SpritePalette> &palette, uint32_t &cost)
+{
+    if (!_prefetch)
+        return nullptr;
+    auto &pf = *_prefetch;
+    std::unique_lock<std::mutex> lk(pf.Mutex);
+    // If the sprite's loading has not started yet, then cancel it,
+    // as the caller is going to load it right away
+    if (pf.Queued.erase(index) > 0)
+        return nullptr;
+    // If the sprite is being loaded right now, wait for it
+    pf.ReadyCv.wait(lk, [&pf, index]() { return pf.Current != index; });
+    auto it = pf.Ready.find(index);
+    if (it == pf.Ready.end())
+        return nullptr;
+    Bitmap *image = it->second.Image.release();
+    palette = std::move(it->second.Palette);
+    cost = it->second.Cost;
+    pf.Ready.erase(it);
+    return image;
+}
+
+void SpriteCache::PrefetchThread()
+{
+    auto &pf = *_prefetch;
+    std::unique_lock<std::mutex> lk(pf.Mutex);
+    while (true)
+    {
+        pf.WakeCv.wait(lk, [&pf]() { return pf.Stop || !pf.Queue.empty(); });
+        if (pf.Stop)
+            break;
+        const sprkey_t index = pf.Queue.front();
+        pf.Queue.pop_front();
+        if (pf.Queued.erase(index) == 0)
+            continue; // cancelled
+        pf.Current = index;
+        lk.unlock();
+
+        Bitmap *image{};
+        std::unique_ptr<SpritePalette> palette(_keepIndexed ? new SpritePalette() : nullptr);
+        uint32_t cost;
+        {
+            std::lock_guard<std::mutex> file_lk(pf.FileMutex);
+            const auto load_start = std::chrono::steady_clock::now();
+            _file.LoadSprite(index, image, palette.get());
+            cost = GetLoadCost(load_start);
+        }
+
+        lk.lock();
+        auto &ready = pf.Ready[index];
+        ready.Image.reset(image);
+        ready.Palette = std::move(palette);
+        ready.Cost = cost;
+        pf.Current = -1;
+        pf.ReadyCv.notify_all();
+    }
+}
+
 void SpriteCache::RemapSpriteToPlaceholder(sprkey_t index)
 {
     assert((index > 0) && ((size_t)index < _spriteData.size()));
@@ -378,6 +875,7 @@ void SpriteCache::InitNullSprite(sprkey_t index)
 
 int SpriteCache::SaveToFile(const String &filename, int store_flags, SpriteCompression compress, SpriteFileIndex &index)
 {
+    StopPrefetch(); // the sprite file will be read here
     // Gather a list of sprites;
     // the list contains pairs, where first element tells whether the sprites
     // exists at all (either have a ready image, or found in a input file).
@@ -386,6 +884,8 @@ int SpriteCache::SaveToFile(const String &filename, int store_flags, SpriteCompr
     std::vector<std::pair<bool, Bitmap*>> sprites;
     for (size_t i = 0; i < _spriteData.size(); ++i)
     {
+        if (IsSpriteIndexed(i))
+            ExpandIndexedSprite(i);
         auto &image = ResourceCache::Get(i);
         if (image) // optionally convert a sprite's pixel data for the saving
             _callbacks.PrewriteSprite(image.get());
@@ -401,15 +901,33 @@ HError SpriteCache::InitFile(std::unique_ptr<Stream> &&sprite_file,
 {
     Reset();
 
-    std::vector<Size> metrics;
-    HError err = _file.OpenFile(std::move(sprite_file), std::move(index_file), metrics);
+    HError err = OpenFile(std::move(sprite_file), std::move(index_file));
     if (!err)
         return err;
+    InitFromFile();
+    return HError::None();
+}
+
+HError SpriteCache::OpenFile(std::unique_ptr<Stream> &&sprite_file,
+                             std::unique_ptr<Stream> &&index_file)
+{
+    _fileMetrics.clear();
+    return _file.OpenFile(std::move(sprite_file), std::move(index_file), _fileMetrics);
+}
+
+void SpriteCache::InitFromFile()
+{
+    StopPrefetch();
+    ResourceCache::Clear();
+    _spriteData.clear();
+    std::vector<Size> metrics = std::move(_fileMetrics);
+    _fileMetrics.clear();
 
     // Initialize sprite infos
     size_t newsize = metrics.size();
     _sprInfos.resize(newsize);
     _spriteData.resize(newsize);
+    ResourceCache::Reserve(newsize);
     for (size_t i = 0; i < metrics.size(); ++i)
     {
         if (!metrics[i].IsNull())
@@ -426,11 +944,11 @@ HError SpriteCache::InitFile(std::unique_ptr<Stream> &&sprite_file,
             InitNullSprite(i);
         }
     }
-    return HError::None();
 }
 
 void SpriteCache::DetachFile()
 {
+    StopPrefetch();
     _file.Close();
 }
 
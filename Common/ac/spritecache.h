@@ -17,6 +17,23 @@
 // SpriteCache provides bitmaps by demand; it uses SpriteFile to load sprites
 // and does MRU (most-recent-use) caching.
 //
+// The asset sprites may also be prefetched: the requested sprites are loaded
+// from the file in a background thread, and are put into the cache either
+// when ProcessPrefetchedSprites() is called, or when they are accessed.
+// Only the sprite loading itself runs in the background, the callbacks are
+// always run on the thread that uses the cache.
+//
+// A list of asset sprites may also be loaded at once, with the sprites'
+// data read from the file sequentially, and decoded by several threads;
+// in that case the callbacks are run on the calling thread too.
+//
+// Optionally the cache may keep the sprites, which are stored in the file
+// as indexed bitmaps, in that form: as 8-bit palette indexes and a palette,
+// which takes up to 4 times less memory. Such sprite is expanded into
+// the full color image only when it's accessed with operator[]; the users
+// which only need a temporary full color copy, e.g. to create a texture,
+// should check IsSpriteIndexed() and use LoadSpriteNoCache() instead.
+//
 // TODO: refactor engine code to allow store and return shared_ptr<Bitmap>.
 //
 // TODO: currently inherits ResourceCache<Bitmap> as protected, because sprites
@@ -43,6 +60,7 @@
 #include "core/platform.h"
 #include "ac/spritefile.h"
 #include "gfx/bitmap.h"
+#include "gfx/bitmask.h"
 #include "util/resourcecache.h"
 
 // Max size of the sprite cache, in bytes
@@ -72,6 +90,7 @@ public:
     typedef std::function<Bitmap*(sprkey_t index, Bitmap *image, uint32_t &sprite_flags)> PfnInitSprite;
     typedef std::function<void(sprkey_t index)> PfnPostInitSprite;
     typedef std::function<void(Bitmap *image)> PfnPrewriteSprite;
+    typedef std::function<void(sprkey_t index, bool locked)> PfnSpriteLockChanged;
 
     struct Callbacks
     {
@@ -79,15 +98,25 @@ public:
         PfnInitSprite InitSprite;
         PfnPostInitSprite PostInitSprite;
         PfnPrewriteSprite PrewriteSprite;
+        // Called when the asset sprite is locked or unlocked
+        PfnSpriteLockChanged LockChanged;
     };
 
 
     SpriteCache(std::vector<SpriteInfo> &sprInfos, const Callbacks &callbacks);
-    ~SpriteCache() = default;
+    ~SpriteCache();
 
     // Loads sprite reference information and inits sprite stream
     HError      InitFile(std::unique_ptr<Stream> &&sprite_file,
                          std::unique_ptr<Stream> &&index_file);
+    // Opens the sprite stream and reads the sprite metrics, without touching
+    // the cache's sprite slots or the sprite infos; this lets the file be opened
+    // on a separate thread while the game data is loaded. Must be followed by
+    // InitFromFile, which finishes the initialization.
+    HError      OpenFile(std::unique_ptr<Stream> &&sprite_file,
+                         std::unique_ptr<Stream> &&index_file);
+    // Inits the sprite slots using the file opened with OpenFile
+    void        InitFromFile();
     // Saves current cache contents to the file
     int         SaveToFile(const String &filename, int store_flags, SpriteCompression compress, SpriteFileIndex &index);
     // Closes an active sprite file stream
@@ -114,6 +143,13 @@ public:
     inline size_t GetExternalSize() const { return ResourceCache::GetExternalSize(); }
     // Returns maximal size limit of the cache, in bytes; this includes locked size too!
     inline size_t GetMaxCacheSize() const { return ResourceCache::GetMaxCacheSize(); }
+    // Returns the number of sprite requests that found or missed the image in cache
+    inline uint64_t GetHitCount() const { return ResourceCache::GetHitCount(); }
+    inline uint64_t GetMissCount() const { return ResourceCache::GetMissCount(); }
+    // Returns the cache use statistics: requests, evictions and sprite loads
+    inline const ResourceCacheStats &GetStats() const { return ResourceCache::GetStats(); }
+    // Resets the cache use statistics
+    inline void ResetStats() { ResourceCache::ResetStats(); }
     // Returns number of sprite slots in the bank (this includes both actual sprites and free slots)
     size_t      GetSpriteSlotCount() const;
     // Tells if the sprite storage still has unoccupied slots to put new sprites in
@@ -123,9 +159,26 @@ public:
     bool        IsAssetSprite(sprkey_t index) const;
     // Tells if the sprite is loaded into the memory (either from asset file, or assigned directly)
     bool        IsSpriteLoaded(sprkey_t index) const;
+    // Tells if the asset sprite is locked in the cache
+    bool        IsSpriteLocked(sprkey_t index) const;
+    // Tells if the sprite is loaded and kept as an indexed bitmap
+    bool        IsSpriteIndexed(sprkey_t index) const;
     // Loads sprite using SpriteFile if such index is known,
     // frees the space if cache size reaches the limit
     void        PrecacheSprite(sprkey_t index);
+    // Loads the listed asset sprites at once, which is equivalent to calling
+    // PrecacheSprite for each of them, but faster: the sprites are read in
+    // the order of their position in file, and decoded using multiple threads.
+    void        PrecacheSprites(const std::vector<sprkey_t> &indexes);
+    // Queues the asset sprites for loading in the background thread;
+    // skips the sprites which are already loaded or requested. The sprites
+    // are read in the order of their position in file, and only as many
+    // as fit into the free cache space.
+    void        PrefetchSprites(const std::vector<sprkey_t> &indexes);
+    // Puts the sprites which were loaded in background into the cache
+    void        ProcessPrefetchedSprites();
+    // Stops the background loading, and discards all the prefetched sprites
+    void        StopPrefetch();
     // Loads the sprite if necessary and returns a *copy* of bitmap, passing
     // ownership to the caller. Skips storing the sprite in the cache
     // (unless it was already there).
@@ -163,9 +216,27 @@ public:
     void        SetEmptySprite(sprkey_t index, bool as_asset);
     // Sets max cache size in bytes
     inline void SetMaxCacheSize(size_t size) { ResourceCache::SetMaxCacheSize(size); }
+    // Disposes the least needed unlocked sprites, until at least the given
+    // amount of memory is freed; returns the freed size, in bytes
+    inline size_t ShrinkCache(size_t size) { return ResourceCache::Shrink(size); }
+    // Sets the cache eviction policy, see ResourceCachePolicy
+    inline void SetCachePolicy(ResourceCachePolicy policy) { ResourceCache::SetPolicy(policy); }
+    // Sets whether to keep the sprites stored as indexed bitmaps in that form,
+    // expanding them only when accessed; applies to the newly loaded sprites
+    inline void SetKeepIndexed(bool keep) { _keepIndexed = keep; }
+    // Sets the max number of threads used to decode sprites in PrecacheSprites;
+    // 0 means use all the engine's job threads
+    inline void SetDecodeThreadCount(size_t count) { _decodeThreads = count; }
 
     // Loads (if it's not in cache yet) and returns bitmap by the sprite index
     Bitmap *operator[] (sprkey_t index);
+    // Gets the opacity mask of the sprite, made from its image on the first
+    // request; the mask is kept even if the image is disposed from the cache.
+    // Returns null for the missing sprites.
+    const BitMask *GetSpriteMask(sprkey_t index);
+    // Discards the opacity mask of the sprite, must be called after the
+    // sprite's image was modified
+    void        InvalidateSpriteMask(sprkey_t index);
 
 protected:
     // Calculates item size; expects to return 0 if an item is invalid
@@ -175,6 +246,23 @@ protected:
 private:
     // Load sprite from game resource and put into the cache
     Bitmap *    LoadSprite(sprkey_t index, bool lock = false);
+    // Initializes the loaded asset sprite and puts it into the cache;
+    // an indexed image is kept as-is, if the palette is not empty;
+    // cost is the time it took to load the sprite, in microseconds
+    Bitmap *    InitLoadedSprite(sprkey_t index, Bitmap *image, std::unique_ptr<SpritePalette> &&palette,
+                                 bool lock, uint32_t cost);
+    // Initializes the indexed sprite's palette, converting its colors
+    // the same way that the full image would be; returns false if the
+    // sprite must be converted as a full image
+    bool        InitIndexedPalette(sprkey_t index, const Bitmap *image, SpritePalette &palette);
+    // Replaces the indexed sprite in the cache with its full color image
+    Bitmap *    ExpandIndexedSprite(sprkey_t index);
+    // Retrieves the prefetched sprite, if there's one, waiting for it
+    // if it is being loaded right now. Returns null if the sprite was not
+    // prefetched, otherwise passes ownership of the image to the caller.
+    Bitmap *    TakePrefetchedSprite(sprkey_t index, std::unique_ptr<SpritePalette> &palette, uint32_t &cost);
+    // Background loading thread's function
+    void        PrefetchThread();
     // Remap the given index to the sprite 0
     void        RemapSpriteToPlaceholder(sprkey_t index);
     // Initialize the empty sprite slot
@@ -186,12 +274,17 @@ private:
     static Bitmap* DummyInitSprite(sprkey_t, Bitmap *image, uint32_t&) { return image; }
     static void DummyPostInitSprite(sprkey_t) { /* do nothing */ }
     static void DummyPrewriteSprite(Bitmap*) { /* do nothing */ }
+    static void DummyLockChanged(sprkey_t, bool) { /* do nothing */ }
 
 
     // Information required for the sprite streaming
     struct SpriteData
     {
         uint32_t Flags = 0u;  // SPRCACHEFLAG* flags
+        // Palette of the sprite kept as an indexed bitmap
+        std::unique_ptr<SpritePalette> Palette;
+        // Opacity mask, created on demand
+        std::unique_ptr<BitMask> Mask;
 
         SpriteData() = default;
 
@@ -205,6 +298,8 @@ private:
         bool IsExternalSprite() const;
         // Tells if sprite is locked and should not be disposed by cache logic
         bool IsLocked() const;
+        // Tells if sprite's image is an indexed bitmap, with a palette
+        bool IsIndexed() const;
     };
 
     // Provided map of sprite infos, to fill in loaded sprite properties
@@ -216,6 +311,15 @@ private:
 
     Callbacks  _callbacks;
     SpriteFile _file;
+    // Metrics of the sprites in the file, read by OpenFile
+    std::vector<Size> _fileMetrics;
+    // Whether to keep the indexed sprites without expanding them
+    bool       _keepIndexed = false;
+    // Max number of threads decoding the sprites, 0 means unlimited
+    size_t     _decodeThreads = 0u;
+    // Background loading state, created on the first prefetch request
+    struct PrefetchState;
+    std::unique_ptr<PrefetchState> _prefetch;
 };
 
 } // namespace Common
@@ -19,6 +19,7 @@
 #include "gfx/bitmap.h"
 #include "util/compress.h"
 #include "util/file.h"
+#include "util/jobscheduler.h"
 #include "util/memory_compat.h"
 #include "util/memorystream.h"
 
@@ -272,6 +273,13 @@ sprkey_t SpriteFile::GetTopmostSprite() const
     return (sprkey_t)_spriteData.size() - 1;
 }
 
+soff_t SpriteFile::GetSpriteOffset(sprkey_t index) const
+{
+    if (index < 0 || (size_t)index >= _spriteData.size())
+        return 0;
+    return _spriteData[index].Offset;
+}
+
 bool SpriteFile::LoadSpriteIndexFile(std::unique_ptr<Stream> &&fidx,
     int expectedFileID, soff_t spr_initial_offs, sprkey_t topmost, std::vector<Size> &metrics)
 {
@@ -383,51 +391,44 @@ HError SpriteFile::RebuildSpriteIndex(Stream *in, sprkey_t topmost, std::vector<
     return HError::None();
 }
 
-HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
+// Reads the sprite's palette and pixel data, which follow the sprite header
+// in the stream, and creates a ready bitmap; see SpriteFile::LoadSprite
+static HError ReadSpriteData(sprkey_t index, const SpriteDatHeader &hdr, Stream *in,
+    bool has_data_size, Bitmap *&sprite, SpritePalette *index_pal)
 {
-    sprite = nullptr;
-    if (index < 0 || (size_t)index >= _spriteData.size())
-        return new Error(String::FromFormat("LoadSprite: slot index %d out of bounds (%d - %d).",
-            index, 0, _spriteData.size() - 1));
-
-    if (_spriteData[index].Offset == 0)
-        return HError::None(); // sprite is not in file
-
-    SeekToSprite(index);
-    _curPos = -2; // mark undefined pos
-
-    SpriteDatHeader hdr;
-    ReadSprHeader(hdr, _stream.get(), _version, _compress);
-    if (hdr.BPP == 0) return HError::None(); // empty slot, this is normal
     int bpp = hdr.BPP, w = hdr.Width, h = hdr.Height;
-    std::unique_ptr<Bitmap> image(BitmapHelper::CreateBitmap(w, h, bpp * 8));
+    uint32_t pal_bpp = GetPaletteBPP(hdr.SFormat);
+    // If requested, keep the indexed image as-is, and don't expand to full color
+    const bool keep_indexed = index_pal && (pal_bpp > 0) && (hdr.PalCount > 0);
+    const int image_depth = keep_indexed ? 8 : bpp * 8;
+    std::unique_ptr<Bitmap> image(BitmapHelper::CreateBitmap(w, h, image_depth));
     if (image == nullptr)
     {
         return new Error(String::FromFormat("LoadSprite: failed to allocate bitmap %d (%dx%d%d).",
-            index, w, h, bpp * 8));
+            index, w, h, image_depth));
     }
-    ImBufferPtr im_data(image->GetDataForWriting(), w * h * bpp, bpp);
+    ImBufferPtr im_data(image->GetDataForWriting(), w * h * (image_depth / 8), image_depth / 8);
     // (Optional) Handle storage options, reverse
     std::vector<uint8_t> indexed_buf;
     std::array<uint32_t, 256> palette {};
-    uint32_t pal_bpp = GetPaletteBPP(hdr.SFormat);
     if (pal_bpp > 0)
     { // read palette if format assumes one
         switch (pal_bpp)
         {
-        case 2: for (uint32_t i = 0; i < hdr.PalCount; ++i) { palette[i] = _stream->ReadInt16(); }
+        case 2: for (uint32_t i = 0; i < hdr.PalCount; ++i) { palette[i] = in->ReadInt16(); }
             break;
-        case 4: for (uint32_t i = 0; i < hdr.PalCount; ++i) { palette[i] = _stream->ReadInt32(); }
+        case 4: for (uint32_t i = 0; i < hdr.PalCount; ++i) { palette[i] = in->ReadInt32(); }
             break;
         default: assert(0); break;
         }
-        indexed_buf.resize(w * h);
-        im_data = ImBufferPtr(&indexed_buf[0], indexed_buf.size(), 1);
+        if (!keep_indexed)
+        {
+            indexed_buf.resize(w * h);
+            im_data = ImBufferPtr(&indexed_buf[0], indexed_buf.size(), 1);
+        }
     }
     // (Optional) Decompress the image data into the temp buffer
-    size_t in_data_size =
-        ((_version >= kSprfVersion_StorageFormats) || _compress != kSprCompress_None) ?
-        (uint32_t)_stream->ReadInt32() : (w * h * bpp);
+    size_t in_data_size = has_data_size ? (uint32_t)in->ReadInt32() : (w * h * bpp);
     if (hdr.Compress != kSprCompress_None)
     {
         // TODO: rewrite this to only make a choice once the SpriteFile is initialized
@@ -439,11 +440,13 @@ HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
         bool result;
         switch (hdr.Compress)
         {
-        case kSprCompress_RLE: result = rle_decompress(im_data.Buf, im_data.Size, im_data.BPP, _stream.get());
+        case kSprCompress_RLE: result = rle_decompress(im_data.Buf, im_data.Size, im_data.BPP, in, in_data_size);
+            break;
+        case kSprCompress_LZW: result = lzw_decompress(im_data.Buf, im_data.Size, im_data.BPP, in, in_data_size);
             break;
-        case kSprCompress_LZW: result = lzw_decompress(im_data.Buf, im_data.Size, im_data.BPP, _stream.get(), in_data_size);
+        case kSprCompress_Deflate: result = inflate_decompress(im_data.Buf, im_data.Size, im_data.BPP, in, in_data_size);
             break;
-        case kSprCompress_Deflate: result = inflate_decompress(im_data.Buf, im_data.Size, im_data.BPP, _stream.get(), in_data_size);
+        case kSprCompress_LZ4: result = lz4_decompress(im_data.Buf, im_data.Size, im_data.BPP, in, in_data_size);
             break;
         default: assert(!"Unsupported compression type!"); result = false; break;
         }
@@ -458,28 +461,69 @@ HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
     {
         switch (im_data.BPP)
         {
-        case 1: _stream->Read(im_data.Buf, im_data.Size);
+        case 1: in->Read(im_data.Buf, im_data.Size);
             break;
-        case 2: _stream->ReadArrayOfInt16(
+        case 2: in->ReadArrayOfInt16(
                 reinterpret_cast<int16_t*>(im_data.Buf), im_data.Size / sizeof(int16_t));
             break;
-        case 4: _stream->ReadArrayOfInt32(
+        case 4: in->ReadArrayOfInt32(
                 reinterpret_cast<int32_t*>(im_data.Buf), im_data.Size / sizeof(int32_t));
             break;
         default: assert(0); break;
         }
     }
     // Finally revert storage options
-    if (pal_bpp > 0)
+    if (keep_indexed)
+    {
+        index_pal->ColorDepth = bpp * 8;
+        index_pal->Colors.assign(palette.begin(), palette.begin() + std::min<uint32_t>(hdr.PalCount, 256));
+    }
+    else if (pal_bpp > 0)
     {
         UnpackIndexedBitmap(image.get(), im_data.Buf, im_data.Size, palette, hdr.PalCount);
     }
 
     sprite = image.release(); // FIXME: pass unique_ptr in this function
+    return HError::None();
+}
+
+HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite, SpritePalette *index_pal)
+{
+    sprite = nullptr;
+    if (index_pal)
+        index_pal->Colors.clear();
+    if (index < 0 || (size_t)index >= _spriteData.size())
+        return new Error(String::FromFormat("LoadSprite: slot index %d out of bounds (%d - %d).",
+            index, 0, _spriteData.size() - 1));
+
+    if (_spriteData[index].Offset == 0)
+        return HError::None(); // sprite is not in file
+
+    SeekToSprite(index);
+    _curPos = -2; // mark undefined pos
+
+    SpriteDatHeader hdr;
+    ReadSprHeader(hdr, _stream.get(), _version, _compress);
+    if (hdr.BPP == 0) return HError::None(); // empty slot, this is normal
+    HError err = ReadSpriteData(index, hdr, _stream.get(), HasDataSize(), sprite, index_pal);
+    if (!err)
+        return err;
     _curPos = index + 1; // mark correct pos
     return HError::None();
 }
 
+HError SpriteFile::DecodeRawData(sprkey_t index, const SpriteDatHeader &hdr, const std::vector<uint8_t> &data,
+    Common::Bitmap *&sprite, SpritePalette *index_pal) const
+{
+    sprite = nullptr;
+    if (index_pal)
+        index_pal->Colors.clear();
+    if (hdr.BPP == 0 || data.empty())
+        return HError::None(); // empty slot, this is normal
+    Stream in(std::make_unique<MemoryStream>(data.data(), data.size()));
+    return ReadSpriteData(index, hdr, &in, HasDataSize(), sprite, index_pal);
+}
+
 HError SpriteFile::LoadRawData(sprkey_t index, SpriteDatHeader &hdr, std::vector<uint8_t> &data)
 {
     hdr = SpriteDatHeader();
@@ -503,7 +547,7 @@ HError SpriteFile::LoadRawData(sprkey_t index, SpriteDatHeader &hdr, std::vector
     data_size += pal_size;
     _stream->Seek(pal_size);
     // Pixel data
-    if ((_version >= kSprfVersion_StorageFormats) || _compress != kSprCompress_None)
+    if (HasDataSize())
         data_size += (uint32_t)_stream->ReadInt32() + sizeof(uint32_t);
     else
         data_size += hdr.Width * hdr.Height * hdr.BPP;
@@ -547,10 +591,10 @@ int SaveSpriteFile(const String &save_to_file,
         return -1;
 
     sprkey_t lastslot = FindTopmostSprite(sprites);
-    SpriteFileWriter writer(std::move(output));
+    // The sprites are compressed on several threads, and written in order
+    SpriteFileWriter writer(std::move(output), 0);
     writer.Begin(store_flags, compress, lastslot);
 
-    std::unique_ptr<Bitmap> temp_bmp; // for disposing temp sprites
     std::vector<uint8_t> membuf; // for loading raw sprite data
 
     const bool diff_compress =
@@ -566,19 +610,23 @@ int SaveSpriteFile(const String &save_to_file,
             continue;
         }
 
+        // if managed to load an image - save it according the new compression settings;
+        // the given images stay valid until the end, so these are not copied
         Bitmap *image = sprites[i].second;
+        if (image != nullptr)
+        {
+            writer.QueueBitmap(image);
+            continue;
+        }
         // if compression setting is different, load the sprite into memory
         // (otherwise we will be able to simply copy bytes from one file to another
-        if ((image == nullptr) && diff_compress)
+        if (diff_compress)
         {
             read_from_file->LoadSprite(i, image);
-            temp_bmp.reset(image);
         }
-
-        // if managed to load an image - save it according the new compression settings
         if (image != nullptr)
         {
-            writer.WriteBitmap(image);
+            writer.WriteBitmap(std::unique_ptr<Bitmap>(image));
             continue;
         }
         else if (diff_compress)
@@ -630,6 +678,29 @@ int SaveSpriteIndex(const String &filename, const SpriteFileIndex &index)
 }
 
 
+SpriteFileWriter::SpriteFileWriter(std::unique_ptr<Stream> &&out, int thread_count)
+    : _out(std::move(out))
+{
+    const size_t threads = JobScheduler::ResolveThreadCount(thread_count, MaxAutoThreads);
+    if (threads > 1u)
+    {
+        _jobs.reset(new JobScheduler(threads - 1u));
+        // Keep several sprites per thread in work, so that the workers
+        // do not wait while the sprites are written in order
+        _maxPending = threads * 4u;
+    }
+}
+
+SpriteFileWriter::~SpriteFileWriter()
+{
+    // Make sure that no job references the pending slots
+    for (auto &slot : _pending)
+    {
+        if (slot.Job)
+            _jobs->Wait(slot.Job);
+    }
+}
+
 void SpriteFileWriter::Begin(int store_flags, SpriteCompression compress, sprkey_t last_slot)
 {
     if (!_out) return;
@@ -663,9 +734,9 @@ void SpriteFileWriter::Begin(int store_flags, SpriteCompression compress, sprkey
     }
 }
 
-void SpriteFileWriter::WriteBitmap(Bitmap *image)
+void SpriteFileWriter::PrepareSprite(const Bitmap *image, int store_flags, SpriteCompression compress,
+    PreparedSprite &spr)
 {
-    if (!_out) return;
     int bpp = image->GetBPP();
     int w = image->GetWidth();
     int h = image->GetHeight();
@@ -673,13 +744,12 @@ void SpriteFileWriter::WriteBitmap(Bitmap *image)
 
     // (Optional) Handle storage options
     std::vector<uint8_t> indexed_buf;
-    uint32_t palette[256];
     uint32_t pal_count = 0;
     SpriteFormat sformat = kSprFmt_Undefined;
-    if ((_storeFlags & kSprStore_OptimizeForSize) != 0 && (image->GetBPP() > 1))
+    if ((store_flags & kSprStore_OptimizeForSize) != 0 && (image->GetBPP() > 1))
     { // Try to store this sprite as an indexed bitmap
         uint32_t gen_pal_count;
-        if (CreateIndexedBitmap(image, indexed_buf, palette, gen_pal_count) && gen_pal_count > 0)
+        if (CreateIndexedBitmap(image, indexed_buf, spr.Palette, gen_pal_count) && gen_pal_count > 0)
         { // Test the resulting size, and switch if the paletted image is less
             if (im_data.Size > (indexed_buf.size() + gen_pal_count * image->GetBPP()))
             {
@@ -690,13 +760,11 @@ void SpriteFileWriter::WriteBitmap(Bitmap *image)
         }
     }
     // (Optional) Compress the image data into the temp buffer
-    SpriteCompression compress = kSprCompress_None;
-    if (_compress != kSprCompress_None)
+    if (compress != kSprCompress_None)
     {
         // TODO: rewrite this to only make a choice once the SpriteFile is initialized
         // and use either function ptr or a decompressing stream class object
-        compress = _compress;
-        Stream mems(std::make_unique<VectorStream>(_membuf, kStream_Write));
+        Stream mems(std::make_unique<VectorStream>(spr.Buffer, kStream_Write));
         bool result;
         switch (compress)
         {
@@ -706,16 +774,101 @@ void SpriteFileWriter::WriteBitmap(Bitmap *image)
             break;
         case kSprCompress_Deflate: result = deflate_compress(im_data.Buf, im_data.Size, im_data.BPP, &mems);
             break;
+        case kSprCompress_LZ4: result = lz4_compress(im_data.Buf, im_data.Size, im_data.BPP, &mems);
+            break;
         default: assert(!"Unsupported compression type!"); result = false; break;
         }
         // mark to write as a plain byte array
-        im_data = result ? ImBufferCPtr(&_membuf[0], _membuf.size(), 1) : ImBufferCPtr();
+        im_data = result ? ImBufferCPtr(spr.Buffer.data(), spr.Buffer.size(), 1) : ImBufferCPtr();
+    }
+    else if (im_data.Buf == indexed_buf.data())
+    {
+        // keep the uncompressed indexed data along with the sprite
+        spr.Buffer = std::move(indexed_buf);
+        im_data.Buf = spr.Buffer.data();
     }
 
-    // Write the final data
-    SpriteDatHeader hdr(bpp, sformat, pal_count, compress, w, h);
-    WriteSpriteData(hdr, im_data.Buf, im_data.Size, im_data.BPP, palette);
-    _membuf.clear();
+    spr.Hdr = SpriteDatHeader(bpp, sformat, pal_count, compress, w, h);
+    spr.Data = im_data.Buf;
+    spr.DataSize = im_data.Size;
+    spr.DataBPP = im_data.BPP;
+}
+
+void SpriteFileWriter::WriteBitmap(Bitmap *image)
+{
+    if (!_out) return;
+    FlushPending();
+    PreparedSprite spr;
+    PrepareSprite(image, _storeFlags, _compress, spr);
+    WritePreparedSprite(spr);
+}
+
+void SpriteFileWriter::WriteBitmap(std::unique_ptr<Bitmap> &&image)
+{
+    if (!_out) return;
+    const Bitmap *bmp = image.get();
+    QueueBitmapImpl(bmp, std::move(image));
+}
+
+void SpriteFileWriter::QueueBitmap(const Bitmap *image)
+{
+    if (!_out) return;
+    QueueBitmapImpl(image, nullptr);
+}
+
+void SpriteFileWriter::QueueBitmapImpl(const Bitmap *image, std::unique_ptr<Bitmap> &&owned_image)
+{
+    if (!_jobs)
+    { // no workers, write right away
+        PreparedSprite spr;
+        PrepareSprite(image, _storeFlags, _compress, spr);
+        WritePreparedSprite(spr);
+        return;
+    }
+
+    FlushPending(_maxPending - 1);
+    _pending.emplace_back();
+    PendingSlot &slot = _pending.back();
+    slot.Type = PendingSlot::kBitmap;
+    slot.Image = image;
+    slot.OwnedImage = std::move(owned_image);
+    // NOTE: deque does not move its elements when adding to its ends
+    PreparedSprite *spr = &slot.Sprite;
+    const int store_flags = _storeFlags;
+    const SpriteCompression compress = _compress;
+    slot.Job = _jobs->Submit("PrepareSprite", [image, store_flags, compress, spr]()
+        { PrepareSprite(image, store_flags, compress, *spr); });
+}
+
+void SpriteFileWriter::FlushPending(size_t keep_count)
+{
+    // Write out the slots which are ready, and then wait for as many
+    // of the remaining ones as necessary
+    while (!_pending.empty())
+    {
+        PendingSlot &slot = _pending.front();
+        if ((_pending.size() <= keep_count) && slot.Job && !slot.Job->IsDone())
+            break;
+        switch (slot.Type)
+        {
+        case PendingSlot::kBitmap:
+            _jobs->Wait(slot.Job);
+            WritePreparedSprite(slot.Sprite);
+            break;
+        case PendingSlot::kRaw:
+            WriteRawDataImpl(slot.Sprite.Hdr, slot.Sprite.Buffer.data(), slot.Sprite.Buffer.size());
+            break;
+        default:
+            WriteEmptySlotImpl();
+            break;
+        }
+        _pending.pop_front();
+    }
+}
+
+void SpriteFileWriter::WritePreparedSprite(const PreparedSprite &spr)
+{
+    WriteSpriteData(spr.Hdr, spr.Data, spr.DataSize, spr.DataBPP, spr.Palette);
 }
 
 static inline void WriteSprHeader(const SpriteDatHeader &hdr, Stream *out)
@@ -770,6 +923,19 @@ void SpriteFileWriter::WriteSpriteData(const SpriteDatHeader &hdr,
 void SpriteFileWriter::WriteEmptySlot()
 {
     if (!_out) return;
+    if (_jobs)
+        FlushPending(_maxPending - 1);
+    if (!_pending.empty())
+    {
+        _pending.emplace_back();
+        _pending.back().Type = PendingSlot::kEmpty;
+        return;
+    }
+    WriteEmptySlotImpl();
+}
+
+void SpriteFileWriter::WriteEmptySlotImpl()
+{
     soff_t sproff = _out->GetPosition();
     _out->WriteInt16(0); // write invalid color depth to mark empty slot
     _index.Offsets.push_back(sproff);
@@ -780,6 +946,22 @@ void SpriteFileWriter::WriteEmptySlot()
 void SpriteFileWriter::WriteRawData(const SpriteDatHeader &hdr, const uint8_t *data, size_t data_sz)
 {
     if (!_out) return;
+    if (_jobs)
+        FlushPending(_maxPending - 1);
+    if (!_pending.empty())
+    { // keep a copy of the data, as the caller may reuse its buffer
+        _pending.emplace_back();
+        PendingSlot &slot = _pending.back();
+        slot.Type = PendingSlot::kRaw;
+        slot.Sprite.Hdr = hdr;
+        slot.Sprite.Buffer.assign(data, data + data_sz);
+        return;
+    }
+    WriteRawDataImpl(hdr, data, data_sz);
+}
+
+void SpriteFileWriter::WriteRawDataImpl(const SpriteDatHeader &hdr, const uint8_t *data, size_t data_sz)
+{
     soff_t sproff = _out->GetPosition();
     _index.Offsets.push_back(sproff);
     _index.Widths.push_back(hdr.Width);
@@ -790,7 +972,9 @@ void SpriteFileWriter::WriteRawData(const SpriteDatHeader &hdr, const uint8_t *d
 
 void SpriteFileWriter::Finalize()
 {
-    if (!_out || _lastSlotPos < 0) return;
+    if (!_out) return;
+    FlushPending();
+    if (_lastSlotPos < 0) return;
     _out->Seek(_lastSlotPos, kSeekBegin);
     _out->WriteInt32(_index.GetLastSlot());
     _out.reset();
@@ -21,6 +21,7 @@
 #ifndef __AGS_CN_AC__SPRFILE_H
 #define __AGS_CN_AC__SPRFILE_H
 
+#include <deque>
 #include <memory>
 #include <vector>
 #include "core/types.h"
@@ -36,6 +37,8 @@ namespace Common
 {
 
 class Bitmap;
+class JobScheduler;
+class JobTask;
 
 // TODO: research old version differences
 enum SpriteFileVersion
@@ -84,7 +87,8 @@ enum SpriteCompression
     kSprCompress_None = 0,
     kSprCompress_RLE,
     kSprCompress_LZW,
-    kSprCompress_Deflate
+    kSprCompress_Deflate,
+    kSprCompress_LZ4
 };
 
 typedef int32_t sprkey_t;
@@ -118,6 +122,13 @@ struct SpriteDatHeader
           Compress(compress), Width(w), Height(h) {}
 };
 
+// Palette of a sprite which is kept as an indexed bitmap
+struct SpritePalette
+{
+    int ColorDepth = 0; // color depth of the full image
+    std::vector<uint32_t> Colors; // colors in the format of that color depth
+};
+
 
 // SpriteFile opens a sprite file for reading, reports general information,
 // and lets read sprites in any order.
@@ -141,18 +152,32 @@ public:
     SpriteCompression GetSpriteCompression() const;
     // Tells the highest known sprite index
     sprkey_t    GetTopmostSprite() const;
+    // Returns the sprite's data offset in the file, or 0 if it's not in the file
+    soff_t      GetSpriteOffset(sprkey_t index) const;
 
     // Loads sprite index file
     bool        LoadSpriteIndexFile(std::unique_ptr<Stream> &&index_file,
                                     int expectedFileID, soff_t spr_initial_offs,
                                     sprkey_t topmost, std::vector<Size> &metrics);
 
-    // Loads an image data and creates a ready bitmap
-    HError      LoadSprite(sprkey_t index, Bitmap *&sprite);
+    // Loads an image data and creates a ready bitmap;
+    // if the palette is provided, and the sprite is stored as an indexed
+    // bitmap, then the sprite is returned as an 8-bit bitmap of palette
+    // indexes, and its palette is written into "palette"; otherwise
+    // the palette is left empty.
+    HError      LoadSprite(sprkey_t index, Bitmap *&sprite, SpritePalette *palette = nullptr);
     // Loads a raw sprite element data into the buffer, stores header info separately
     HError      LoadRawData(sprkey_t index, SpriteDatHeader &hdr, std::vector<uint8_t> &data);
+    // Creates a ready bitmap from the raw sprite data, as read by LoadRawData;
+    // follows the same rules as LoadSprite. Does not access the file stream,
+    // so may be called from any thread, also while the file is being read.
+    HError      DecodeRawData(sprkey_t index, const SpriteDatHeader &hdr, const std::vector<uint8_t> &data,
+                              Bitmap *&sprite, SpritePalette *palette = nullptr) const;
 
 private:
+    // Tells if the pixel data in the file is preceded by its size
+    bool        HasDataSize() const
+        { return (_version >= kSprfVersion_StorageFormats) || (_compress != kSprCompress_None); }
     // Rebuilds sprite index from the main sprite file
     HError      RebuildSpriteIndex(Stream *in, sprkey_t topmost, std::vector<Size> &metrics);
     // Seek stream to sprite
@@ -179,12 +204,21 @@ private:
 // SpriteFileWriter class writes a sprite file in a requested format.
 // Start using it by calling Begin, write ready bitmaps or copy raw sprite data
 // over slot by slot, then call Finalize to let it close the format correctly.
+//
+// When created with more than one thread, the writer prepares (converts and
+// compresses) the queued bitmaps on its worker threads, several at a time,
+// and writes them out in the order they were queued. The resulting file is
+// same as when writing on a single thread.
 class SpriteFileWriter
 {
 public:
-    SpriteFileWriter(std::unique_ptr<Stream> &&out)
-        : _out(std::move(out)) {}
-    ~SpriteFileWriter() = default;
+    // Max number of threads to use when there's no explicit setting
+    static const size_t MaxAutoThreads = 8u;
+
+    // Creates the writer; thread_count is the number of threads preparing
+    // the sprites, including the calling one; 0 means choose automatically
+    SpriteFileWriter(std::unique_ptr<Stream> &&out, int thread_count = 1);
+    ~SpriteFileWriter();
 
     // Get the sprite index, accumulated after write
     const SpriteFileIndex &GetIndex() const { return _index; }
@@ -195,6 +229,12 @@ public:
     void Begin(int store_flags, SpriteCompression compress, sprkey_t last_slot = -1);
     // Writes a bitmap into file, compressing if necessary
     void WriteBitmap(Bitmap *image);
+    // Queues the bitmap for writing, taking its ownership; the bitmap
+    // is prepared on a worker thread, if there are any
+    void WriteBitmap(std::unique_ptr<Bitmap> &&image);
+    // Queues the bitmap for writing, same as above, but without taking
+    // its ownership: the bitmap must stay valid until Finalize is called
+    void QueueBitmap(const Bitmap *image);
     // Writes an empty slot marker
     void WriteEmptySlot();
     // Writes a raw sprite data without any additional processing
@@ -203,10 +243,45 @@ public:
     void Finalize();
 
 private:
+    // The image data prepared for writing: converted to the storage format,
+    // and compressed, if necessary
+    struct PreparedSprite
+    {
+        SpriteDatHeader Hdr;
+        uint32_t Palette[256];
+        // Image data, points either to the source bitmap, or to the buffer
+        const uint8_t *Data = nullptr;
+        size_t DataSize = 0u;
+        int DataBPP = 1;
+        std::vector<uint8_t> Buffer;
+    };
+
+    // The slot waiting to be written, in the order of writing
+    struct PendingSlot
+    {
+        enum SlotType { kBitmap, kEmpty, kRaw } Type = kEmpty;
+        const Bitmap *Image = nullptr;
+        std::unique_ptr<Bitmap> OwnedImage;
+        PreparedSprite Sprite;
+        std::shared_ptr<JobTask> Job;
+    };
+
+    // Converts and compresses the bitmap's data; safe to call on any thread
+    static void PrepareSprite(const Bitmap *image, int store_flags, SpriteCompression compress,
+        PreparedSprite &spr);
+    // Adds the bitmap to the pending slots, and starts preparing it
+    void QueueBitmapImpl(const Bitmap *image, std::unique_ptr<Bitmap> &&owned_image);
+    // Writes out the pending slots which are ready, and waits for the rest
+    // to be prepared and written, keeping no more than the given number of them
+    void FlushPending(size_t keep_count = 0u);
+    // Writes prepared sprite in a proper file format
+    void WritePreparedSprite(const PreparedSprite &spr);
     // Writes prepared image data in a proper file format, following explicit data_bpp rule
     void WriteSpriteData(const SpriteDatHeader &hdr,
         const uint8_t *im_data, size_t im_data_sz, int im_bpp,
         const uint32_t palette[256]);
+    void WriteEmptySlotImpl();
+    void WriteRawDataImpl(const SpriteDatHeader &hdr, const uint8_t *data, size_t data_sz);
 
     std::unique_ptr<Stream> _out;
     int _storeFlags = 0;
@@ -214,8 +289,13 @@ private:
     soff_t _lastSlotPos = -1; // last slot save position in file
     // sprite index accumulated on write for reporting back to user
     SpriteFileIndex _index;
-    // compression buffer
-    std::vector<uint8_t> _membuf;
+    // Worker threads preparing the sprites, if more than one thread is used;
+    // NOTE: JobScheduler is not included here, because the header is also
+    // used by the managed code, where the standard thread headers are banned
+    std::unique_ptr<JobScheduler> _jobs;
+    // The slots waiting to be written, and the max number of them
+    std::deque<PendingSlot> _pending;
+    size_t _maxPending = 0u;
 };
 
 
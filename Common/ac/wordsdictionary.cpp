@@ -58,6 +58,7 @@ void WordsDictionary::free_memory()
         wordnum = nullptr;
         num_words = 0;
     }
+    _index = {};
 }
 
 void WordsDictionary::sort () {
@@ -77,15 +78,20 @@ void WordsDictionary::sort () {
             }
         }
     }
+    build_index();
+}
+
+void WordsDictionary::build_index() {
+    _index = {};
+    _index.reserve(num_words);
+    // insert won't replace existing keys, so the first of the equal words is found
+    for (int i = 0; i < num_words; i++)
+        _index.insert(std::make_pair(AGS::Common::String(word[i]), i));
 }
 
 int WordsDictionary::find_index (const char*wrem) {
-    int aa;
-    for (aa = 0; aa < num_words; aa++) {
-        if (ags_stricmp (wrem, word[aa]) == 0)
-            return aa;
-    }
-    return -1;
+    const auto it = _index.find(AGS::Common::String::Wrapper(wrem));
+    return (it != _index.end()) ? it->second : -1;
 }
 
 const char *passwencstring = "Avis Durgan";
@@ -125,6 +131,7 @@ void read_dictionary (WordsDictionary *dict, Stream *out) {
     read_string_decrypt (out, dict->word[ii], MAX_PARSER_WORD_LENGTH);
     dict->wordnum[ii] = out->ReadInt16();
   }
+  dict->build_index();
 }
 
 #if defined (OBSOLETE)
@@ -16,6 +16,8 @@
 #define __AC_WORDSDICTIONARY_H
 
 #include "core/types.h"
+#include "util/flat_hash.h"
+#include "util/string_types.h"
 
 namespace AGS { namespace Common { class Stream; } }
 using namespace AGS; // FIXME later
@@ -34,7 +36,14 @@ struct WordsDictionary {
     void allocate_memory(int wordCount);
     void free_memory();
     void  sort();
+    // Indexes the words for the fast lookup; must be called after the words are changed
+    void  build_index();
+    // Finds the word case-insensitively, returns its index in the array or -1
     int   find_index (const char *);
+
+private:
+    // Case-insensitive word lookup, returns the first index of a word
+    Common::FlatHashMap<Common::String, int, Common::HashStrNoCase, Common::StrEqNoCase> _index;
 };
 
 extern const char *passwencstring;
@@ -0,0 +1,99 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+#include <allegro.h>
+#include "benchmark/benchmark.h"
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+
+// Reimplementation of project-dependent functions from Common
+void __my_setcolor(int *ctset, int newcol, int /*wantColDep*/)
+{
+    *ctset = newcol;
+}
+
+
+static const int SpriteWidth = 64, SpriteHeight = 96;
+static const int ScreenWidth = 640, ScreenHeight = 400;
+
+static void InitAllegro()
+{
+    static bool initialized = false;
+    if (initialized)
+        return;
+    install_allegro(SYSTEM_NONE, &errno, atexit);
+    initialized = true;
+}
+
+// Makes the sprite of the given color depth, with the transparent pixels around
+static std::unique_ptr<Bitmap> MakeSprite(int depth)
+{
+    std::unique_ptr<Bitmap> bmp(BitmapHelper::CreateTransparentBitmap(SpriteWidth, SpriteHeight, depth));
+    const int color = (depth == 8) ? 15 : makecol_depth(depth, 200, 120, 40);
+    bmp->FillRect(Rect(SpriteWidth / 4, SpriteHeight / 4, SpriteWidth * 3 / 4, SpriteHeight * 3 / 4), color);
+    return bmp;
+}
+
+static void BM_Bitmap_Blit(benchmark::State &state)
+{
+    InitAllegro();
+    const int depth = static_cast<int>(state.range(0));
+    std::unique_ptr<Bitmap> src(MakeSprite(depth));
+    std::unique_ptr<Bitmap> dst(BitmapHelper::CreateBitmap(ScreenWidth, ScreenHeight, depth));
+    for (auto _ : state)
+        dst->Blit(src.get(), 100, 100);
+    state.SetItemsProcessed(state.iterations() * SpriteWidth * SpriteHeight);
+}
+BENCHMARK(BM_Bitmap_Blit)->Arg(8)->Arg(16)->Arg(32);
+
+static void BM_Bitmap_MaskedBlit(benchmark::State &state)
+{
+    InitAllegro();
+    const int depth = static_cast<int>(state.range(0));
+    std::unique_ptr<Bitmap> src(MakeSprite(depth));
+    std::unique_ptr<Bitmap> dst(BitmapHelper::CreateBitmap(ScreenWidth, ScreenHeight, depth));
+    for (auto _ : state)
+        dst->MaskedBlit(src.get(), 100, 100);
+    state.SetItemsProcessed(state.iterations() * SpriteWidth * SpriteHeight);
+}
+BENCHMARK(BM_Bitmap_MaskedBlit)->Arg(8)->Arg(16)->Arg(32);
+
+static void BM_Bitmap_StretchBlt(benchmark::State &state)
+{
+    InitAllegro();
+    const int depth = static_cast<int>(state.range(0));
+    std::unique_ptr<Bitmap> src(MakeSprite(depth));
+    std::unique_ptr<Bitmap> dst(BitmapHelper::CreateBitmap(ScreenWidth, ScreenHeight, depth));
+    const Rect dst_rc = RectWH(100, 100, SpriteWidth * 2, SpriteHeight * 2);
+    for (auto _ : state)
+        dst->StretchBlt(src.get(), dst_rc, kBitmap_Transparency);
+    state.SetItemsProcessed(state.iterations() * dst_rc.GetWidth() * dst_rc.GetHeight());
+}
+BENCHMARK(BM_Bitmap_StretchBlt)->Arg(8)->Arg(16)->Arg(32);
+
+static void BM_Bitmap_FullScreenBlit(benchmark::State &state)
+{
+    InitAllegro();
+    const int depth = static_cast<int>(state.range(0));
+    std::unique_ptr<Bitmap> src(BitmapHelper::CreateBitmap(ScreenWidth, ScreenHeight, depth));
+    std::unique_ptr<Bitmap> dst(BitmapHelper::CreateBitmap(ScreenWidth, ScreenHeight, depth));
+    src->Clear();
+    for (auto _ : state)
+        dst->Blit(src.get());
+    state.SetBytesProcessed(state.iterations() * ScreenWidth * ScreenHeight * ((depth + 7) / 8));
+}
+BENCHMARK(BM_Bitmap_FullScreenBlit)->Arg(8)->Arg(16)->Arg(32);
@@ -0,0 +1,177 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Bitmap transformation benchmark: measures the speed of scaling, flipping
+// and rotation of the sprite-sized images done with the BitmapTransform
+// kernels and the matching Allegro functions, and prints the best time of
+// several runs for each.
+//
+// Usage: bitmaptransform_bench [--iterations N] [--depth 8|16|32]
+//
+// NOTE: the bilinear scaling is compared with aastr's anti-aliased scaling,
+// which is what the engine uses for "smooth" sprites; they don't give the
+// same result.
+//
+//=============================================================================
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <aastr.h>
+#include "gfx/bitmap_transform.h"
+
+using namespace AGS::Common;
+
+// Reimplementation of project-dependent functions from Common
+void __my_setcolor(int *ctset, int newcol, int /*wantColDep*/)
+{
+    *ctset = newcol;
+}
+
+
+typedef std::chrono::steady_clock BenchClock;
+
+// Runs the function repeatedly for the number of iterations,
+// and returns the best time of one run in seconds
+static double MeasureBest(int iterations, int repeats, const std::function<void()> &fn)
+{
+    double best = -1.0;
+    for (int iter = 0; iter < iterations; ++iter)
+    {
+        const auto start = BenchClock::now();
+        for (int i = 0; i < repeats; ++i)
+            fn();
+        const double sec = std::chrono::duration<double>(BenchClock::now() - start).count() / repeats;
+        if (best < 0.0 || sec < best)
+            best = sec;
+    }
+    return best;
+}
+
+static void PrintResult(const char *name, double allegro_sec, double kernel_sec)
+{
+    const double kernel = kernel_sec > 0.0 ? kernel_sec : 1e-9;
+    printf("%-22s %12.1f %12.1f %9.2fx\n", name, allegro_sec * 1000000.0,
+        kernel_sec * 1000000.0, allegro_sec / kernel);
+}
+
+// Fills the bitmap with a pattern, which has transparent pixels around
+static void FillSprite(BITMAP *bmp)
+{
+    const int depth = bitmap_color_depth(bmp);
+    clear_to_color(bmp, bitmap_mask_color(bmp));
+    for (int y = bmp->h / 8; y < bmp->h * 7 / 8; ++y)
+    {
+        for (int x = bmp->w / 8; x < bmp->w * 7 / 8; ++x)
+            putpixel(bmp, x, y, (depth == 8) ? (1 + (x ^ y) % 255) :
+                makeacol_depth(depth, x * 3, y * 5, (x ^ y) & 0xFF, 0xFF));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = 5;
+    int depth = 32;
+    for (int i = 1; i < argc; ++i)
+    {
+        if ((strcmp(argv[i], "--iterations") == 0) && (i + 1 < argc))
+            iterations = std::max(1, atoi(argv[++i]));
+        else if ((strcmp(argv[i], "--depth") == 0) && (i + 1 < argc))
+            depth = atoi(argv[++i]);
+        else
+        {
+            printf("Usage: bitmaptransform_bench [--iterations N] [--depth 8|16|32]\n");
+            return 1;
+        }
+    }
+    if ((depth != 8) && (depth != 16) && (depth != 32))
+    {
+        fprintf(stderr, "Unsupported color depth: %d\n", depth);
+        return 1;
+    }
+
+    install_allegro(SYSTEM_NONE, &errno, atexit);
+    // Typical character sprite, scaled by the walkable area scaling
+    const int sw = 120, sh = 200;
+    BITMAP *sprite = create_bitmap_ex(depth, sw, sh);
+    BITMAP *dest = create_bitmap_ex(depth, sw * 2, sh * 2);
+    FillSprite(sprite);
+    clear_to_color(dest, 0);
+    const int repeats = 20;
+
+    printf("Best of %d runs, %d-bit %dx%d sprite\n", iterations, depth, sw, sh);
+    printf("%-22s %12s %12s %10s\n", "operation", "allegro (us)", "kernel (us)", "speedup");
+
+    const struct { const char *Name; int W, H; } scales[] = {
+        { "stretch 150%", sw * 3 / 2, sh * 3 / 2 },
+        { "stretch 200%", sw * 2, sh * 2 },
+        { "stretch 70%", sw * 7 / 10, sh * 7 / 10 }
+    };
+    for (const auto &sc : scales)
+    {
+        const double al = MeasureBest(iterations, repeats,
+            [&]() { stretch_sprite(dest, sprite, 0, 0, sc.W, sc.H); });
+        const double kr = MeasureBest(iterations, repeats, [&]() {
+            BitmapTransform::StretchNearest(dest, sprite, RectWH(0, 0, sw, sh), RectWH(0, 0, sc.W, sc.H), true); });
+        PrintResult(sc.Name, al, kr);
+    }
+    {
+        const double al = MeasureBest(iterations, repeats,
+            [&]() { stretch_blit(sprite, dest, 0, 0, sw, sh, 0, 0, sw * 2, sh * 2); });
+        const double kr = MeasureBest(iterations, repeats, [&]() {
+            BitmapTransform::StretchNearest(dest, sprite, RectWH(0, 0, sw, sh), RectWH(0, 0, sw * 2, sh * 2), false); });
+        PrintResult("stretch 200% opaque", al, kr);
+    }
+    if (depth == 32)
+    {
+        const double al = MeasureBest(iterations, repeats,
+            [&]() { aa_stretch_blit(sprite, dest, 0, 0, sw, sh, 0, 0, sw * 3 / 2, sh * 3 / 2); });
+        const double kr = MeasureBest(iterations, repeats, [&]() {
+            BitmapTransform::StretchBilinear(dest, sprite, RectWH(0, 0, sw, sh), RectWH(0, 0, sw * 3 / 2, sh * 3 / 2)); });
+        PrintResult("smooth 150% (aastr)", al, kr);
+    }
+    {
+        const double al = MeasureBest(iterations, repeats,
+            [&]() { draw_sprite_h_flip(dest, sprite, 0, 0); });
+        const double kr = MeasureBest(iterations, repeats,
+            [&]() { BitmapTransform::FlipSprite(dest, sprite, 0, 0, kFlip_Horizontal); });
+        PrintResult("flip horizontal", al, kr);
+    }
+    {
+        const double al = MeasureBest(iterations, repeats,
+            [&]() { draw_sprite_vh_flip(dest, sprite, 0, 0); });
+        const double kr = MeasureBest(iterations, repeats,
+            [&]() { BitmapTransform::FlipSprite(dest, sprite, 0, 0, kFlip_Both); });
+        PrintResult("flip both", al, kr);
+    }
+    const struct { const char *Name; int Angle; } rotations[] = {
+        { "rotate 90", 64 },
+        { "rotate 180", 128 }
+    };
+    for (const auto &rot : rotations)
+    {
+        const double al = MeasureBest(iterations, repeats,
+            [&]() { pivot_sprite(dest, sprite, sh, sh, sw / 2, sh / 2, itofix(rot.Angle)); });
+        const double kr = MeasureBest(iterations, repeats, [&]() {
+            BitmapTransform::PivotSprite(dest, sprite, itofix(sh), itofix(sh), itofix(sw / 2), itofix(sh / 2), itofix(rot.Angle)); });
+        PrintResult(rot.Name, al, kr);
+    }
+
+    destroy_bitmap(sprite);
+    destroy_bitmap(dest);
+    return 0;
+}
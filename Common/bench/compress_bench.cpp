@@ -0,0 +1,87 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <memory>
+#include <vector>
+#include "benchmark/benchmark.h"
+#include "util/compress.h"
+#include "util/memory_compat.h"
+#include "util/memorystream.h"
+
+using namespace AGS::Common;
+
+typedef bool (*CompressFn)(const uint8_t *data, size_t data_sz, int image_bpp, Stream *out);
+typedef bool (*DecompressFn)(uint8_t *data, size_t data_sz, int image_bpp, Stream *in, size_t in_sz);
+
+static const int ImageWidth = 320, ImageHeight = 200;
+
+// Makes the sprite-like image data: the flat areas and the gradients,
+// with the transparent pixels around
+static std::vector<uint8_t> MakeImage(int bpp)
+{
+    std::vector<uint8_t> data(ImageWidth * ImageHeight * bpp);
+    for (int y = 0; y < ImageHeight; ++y)
+    {
+        for (int x = 0; x < ImageWidth; ++x)
+        {
+            const bool inside = (x > ImageWidth / 8) && (x < ImageWidth * 7 / 8) &&
+                (y > ImageHeight / 8) && (y < ImageHeight * 7 / 8);
+            const uint8_t value = inside ? static_cast<uint8_t>((x / 16) * 16 + y / 25) : 0;
+            for (int b = 0; b < bpp; ++b)
+                data[(y * ImageWidth + x) * bpp + b] = static_cast<uint8_t>(value + b * 40);
+        }
+    }
+    return data;
+}
+
+static void BM_Compress(benchmark::State &state, CompressFn compress)
+{
+    const int bpp = static_cast<int>(state.range(0));
+    const std::vector<uint8_t> image = MakeImage(bpp);
+    std::vector<uint8_t> packed;
+    for (auto _ : state)
+    {
+        packed.clear();
+        Stream out(std::make_unique<VectorStream>(packed, kStream_Write));
+        compress(image.data(), image.size(), bpp, &out);
+    }
+    state.SetBytesProcessed(state.iterations() * image.size());
+    state.counters["ratio"] = static_cast<double>(image.size()) / packed.size();
+}
+
+static void BM_Decompress(benchmark::State &state, CompressFn compress, DecompressFn decompress)
+{
+    const int bpp = static_cast<int>(state.range(0));
+    std::vector<uint8_t> image = MakeImage(bpp);
+    std::vector<uint8_t> packed;
+    {
+        Stream out(std::make_unique<VectorStream>(packed, kStream_Write));
+        compress(image.data(), image.size(), bpp, &out);
+    }
+    for (auto _ : state)
+    {
+        Stream in(std::make_unique<MemoryStream>(packed.data(), packed.size()));
+        decompress(image.data(), image.size(), bpp, &in, packed.size());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * image.size());
+}
+
+BENCHMARK_CAPTURE(BM_Compress, rle, rle_compress)->Arg(1)->Arg(2)->Arg(4);
+BENCHMARK_CAPTURE(BM_Decompress, rle, rle_compress, rle_decompress)->Arg(1)->Arg(2)->Arg(4);
+BENCHMARK_CAPTURE(BM_Compress, lzw, lzw_compress)->Arg(1)->Arg(4);
+BENCHMARK_CAPTURE(BM_Decompress, lzw, lzw_compress, lzw_decompress)->Arg(1)->Arg(4);
+BENCHMARK_CAPTURE(BM_Compress, deflate, deflate_compress)->Arg(1)->Arg(4);
+BENCHMARK_CAPTURE(BM_Decompress, deflate, deflate_compress, inflate_decompress)->Arg(1)->Arg(4);
+BENCHMARK_CAPTURE(BM_Compress, lz4, lz4_compress)->Arg(1)->Arg(4);
+BENCHMARK_CAPTURE(BM_Decompress, lz4, lz4_compress, lz4_decompress)->Arg(1)->Arg(4);
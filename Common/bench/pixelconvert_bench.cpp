@@ -0,0 +1,246 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Pixel format conversion benchmark: measures the speed of converting the
+// texture-sized images of each color depth into the 32-bit texture pixels,
+// done per pixel with Allegro's functions (as the renderers used to do) and
+// with the PixelConvert kernels, and prints the best time of several runs.
+//
+// Usage: pixelconvert_bench [--iterations N] [--size WxH]
+//
+//=============================================================================
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include <allegro.h>
+#include "gfx/pixel_convert.h"
+
+using namespace AGS::Common;
+
+// Reimplementation of project-dependent functions from Common
+void __my_setcolor(int *ctset, int newcol, int /*wantColDep*/)
+{
+    *ctset = newcol;
+}
+
+
+typedef std::chrono::steady_clock BenchClock;
+
+// Runs the function repeatedly for the number of iterations,
+// and returns the best time of one run in seconds
+static double MeasureBest(int iterations, int repeats, const std::function<void()> &fn)
+{
+    double best = -1.0;
+    for (int iter = 0; iter < iterations; ++iter)
+    {
+        const auto start = BenchClock::now();
+        for (int i = 0; i < repeats; ++i)
+            fn();
+        const double sec = std::chrono::duration<double>(BenchClock::now() - start).count() / repeats;
+        if (best < 0.0 || sec < best)
+            best = sec;
+    }
+    return best;
+}
+
+static void PrintResult(const char *name, double allegro_sec, double kernel_sec)
+{
+    const double kernel = kernel_sec > 0.0 ? kernel_sec : 1e-9;
+    printf("%-26s %12.1f %12.1f %9.2fx\n", name, allegro_sec * 1000000.0,
+        kernel_sec * 1000000.0, allegro_sec / kernel);
+}
+
+// Fills the bitmap with a pattern, which has transparent pixels around
+static void FillImage(BITMAP *bmp)
+{
+    const int depth = bitmap_color_depth(bmp);
+    clear_to_color(bmp, bitmap_mask_color(bmp));
+    for (int y = bmp->h / 8; y < bmp->h * 7 / 8; ++y)
+    {
+        for (int x = bmp->w / 8; x < bmp->w * 7 / 8; ++x)
+            putpixel(bmp, x, y, (depth == 8) ? (1 + (x ^ y) % 255) :
+                makeacol_depth(depth, x * 3, y * 5, (x ^ y) & 0xFF, (x + y) & 0xFF));
+    }
+}
+
+// Allegro's functions reading the pixels of each color depth
+struct Pixel8
+{
+    typedef uint8_t T;
+    static int R(int c) { return getr8(c); }
+    static int G(int c) { return getg8(c); }
+    static int B(int c) { return getb8(c); }
+    static int A(int /*c*/) { return 0xFF; }
+};
+
+struct Pixel16
+{
+    typedef uint16_t T;
+    static int R(int c) { return getr16(c); }
+    static int G(int c) { return getg16(c); }
+    static int B(int c) { return getb16(c); }
+    static int A(int /*c*/) { return 0xFF; }
+};
+
+struct Pixel32
+{
+    typedef uint32_t T;
+    static int R(int c) { return getr32(c); }
+    static int G(int c) { return getg32(c); }
+    static int B(int c) { return getb32(c); }
+    static int A(int c) { return geta32(c); }
+};
+
+// Converts the image per pixel, the way the renderers used to
+template <typename TPixel>
+static void ConvertPerPixel(BITMAP *bmp, uint32_t *dst, const PixelConvert::ChannelShifts &sh,
+    PixelConvert::AlphaMode alpha)
+{
+    const int mask = bitmap_mask_color(bmp);
+    for (int y = 0; y < bmp->h; ++y, dst += bmp->w)
+    {
+        const typename TPixel::T *src = reinterpret_cast<const typename TPixel::T*>(bmp->line[y]);
+        for (int x = 0; x < bmp->w; ++x)
+        {
+            const int c = src[x];
+            if ((alpha == PixelConvert::kAlpha_MaskColor) && (c == mask))
+            {
+                dst[x] = 0;
+                continue;
+            }
+            const uint32_t a = (alpha == PixelConvert::kAlpha_Source) ? TPixel::A(c) : 0xFF;
+            dst[x] = (TPixel::R(c) << sh.R) | (TPixel::G(c) << sh.G) | (TPixel::B(c) << sh.B) | (a << sh.A);
+        }
+    }
+}
+
+static void ConvertPerPixel(BITMAP *bmp, uint32_t *dst, const PixelConvert::ChannelShifts &sh,
+    PixelConvert::AlphaMode alpha)
+{
+    switch (bitmap_color_depth(bmp))
+    {
+    case 8: ConvertPerPixel<Pixel8>(bmp, dst, sh, alpha); break;
+    case 16: ConvertPerPixel<Pixel16>(bmp, dst, sh, alpha); break;
+    case 32: ConvertPerPixel<Pixel32>(bmp, dst, sh, alpha); break;
+    default: break;
+    }
+}
+
+static void ConvertRows(BITMAP *bmp, uint32_t *dst, const PixelConvert::ChannelShifts &sh,
+    PixelConvert::AlphaMode alpha)
+{
+    const PixelConvert::RowConverter conv(bitmap_color_depth(bmp), sh, alpha);
+    for (int y = 0; y < bmp->h; ++y, dst += bmp->w)
+        conv.Convert(dst, bmp->line[y], bmp->w);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = 5;
+    int w = 640, h = 360;
+    for (int i = 1; i < argc; ++i)
+    {
+        if ((strcmp(argv[i], "--iterations") == 0) && (i + 1 < argc))
+            iterations = std::max(1, atoi(argv[++i]));
+        else if ((strcmp(argv[i], "--size") == 0) && (i + 1 < argc) &&
+            (sscanf(argv[++i], "%dx%d", &w, &h) == 2) && (w > 0) && (h > 0))
+            continue;
+        else
+        {
+            printf("Usage: pixelconvert_bench [--iterations N] [--size WxH]\n");
+            return 1;
+        }
+    }
+
+    install_allegro(SYSTEM_NONE, &errno, atexit);
+    PALETTE pal;
+    for (int c = 0; c < 256; ++c)
+    {
+        pal[c].r = c % 64;
+        pal[c].g = (c * 7) % 64;
+        pal[c].b = 63 - c % 64;
+    }
+    select_palette(pal);
+
+    std::vector<uint32_t> dst(w * h);
+    const PixelConvert::ChannelShifts argb(16, 8, 0, 24);
+    const PixelConvert::ChannelShifts abgr(0, 8, 16, 24);
+    const int repeats = 10;
+
+    printf("Best of %d runs, %dx%d image\n", iterations, w, h);
+    printf("%-26s %12s %12s %10s\n", "conversion", "allegro (us)", "kernel (us)", "speedup");
+
+    const struct { const char *Name; int Depth; PixelConvert::AlphaMode Alpha; } cases[] = {
+        { "8-bit masked", 8, PixelConvert::kAlpha_MaskColor },
+        { "16-bit masked", 16, PixelConvert::kAlpha_MaskColor },
+        { "16-bit opaque", 16, PixelConvert::kAlpha_Opaque },
+        { "32-bit masked", 32, PixelConvert::kAlpha_MaskColor },
+        { "32-bit alpha", 32, PixelConvert::kAlpha_Source },
+        { "32-bit opaque", 32, PixelConvert::kAlpha_Opaque }
+    };
+    for (const auto &c : cases)
+    {
+        BITMAP *bmp = create_bitmap_ex(c.Depth, w, h);
+        FillImage(bmp);
+        for (const auto *sh : { &argb, &abgr })
+        {
+            char name[64];
+            snprintf(name, sizeof(name), "%s, %s", c.Name, (sh == &argb) ? "ARGB" : "ABGR");
+            const double al = MeasureBest(iterations, repeats,
+                [&]() { ConvertPerPixel(bmp, dst.data(), *sh, c.Alpha); });
+            const double kr = MeasureBest(iterations, repeats,
+                [&]() { ConvertRows(bmp, dst.data(), *sh, c.Alpha); });
+            PrintResult(name, al, kr);
+        }
+        destroy_bitmap(bmp);
+    }
+
+    BITMAP *bmp = create_bitmap_ex(32, w, h);
+    FillImage(bmp);
+    {
+        const double al = MeasureBest(iterations, repeats, [&]() {
+            for (int y = 0; y < h; ++y)
+                for (uint8_t *px = bmp->line[y], *end = px + w * 4; px != end; px += 4)
+                    std::swap(px[0], px[2]);
+        });
+        const double kr = MeasureBest(iterations, repeats, [&]() {
+            for (int y = 0; y < h; ++y)
+                PixelConvert::SwapRedBlue32(reinterpret_cast<uint32_t*>(bmp->line[y]), w);
+        });
+        PrintResult("32-bit swap red and blue", al, kr);
+    }
+    {
+        // NOTE: after the first run there are no pixels to replace, which
+        // is the common case anyway, as most pixels are not transparent
+        const double al = MeasureBest(iterations, repeats, [&]() {
+            for (int y = 0; y < h; ++y)
+                for (uint32_t *px = reinterpret_cast<uint32_t*>(bmp->line[y]), *end = px + w; px != end; ++px)
+                    if (geta32(*px) == 0)
+                        *px = MASK_COLOR_32;
+        });
+        const double kr = MeasureBest(iterations, repeats, [&]() {
+            for (int y = 0; y < h; ++y)
+                PixelConvert::ReplaceAlphaWithMask32(reinterpret_cast<uint32_t*>(bmp->line[y]), w);
+        });
+        PrintResult("32-bit alpha to mask", al, kr);
+    }
+    destroy_bitmap(bmp);
+    unselect_palette();
+    return 0;
+}
@@ -0,0 +1,72 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "benchmark/benchmark.h"
+#include "util/resourcecache.h"
+
+using namespace AGS::Common;
+
+// Cache, where the item's value is also its size
+class BenchCache : public ResourceCache<int, int>
+{
+public:
+    BenchCache(size_t max_size) : ResourceCache(max_size) {}
+
+protected:
+    size_t CalcSize(const int &item) override { return item; }
+};
+
+static const int CacheItems = 1024;
+
+// Fills the cache up with the items of the same size
+static void FillCache(BenchCache &cache)
+{
+    for (int i = 0; i < CacheItems; ++i)
+        cache.Put(i, 1);
+}
+
+static void BM_ResourceCache_GetHit(benchmark::State &state)
+{
+    BenchCache cache(CacheItems);
+    cache.SetPolicy(static_cast<ResourceCachePolicy>(state.range(0)));
+    FillCache(cache);
+    int key = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(cache.Get(key));
+        key = (key + 7) % CacheItems;
+    }
+}
+BENCHMARK(BM_ResourceCache_GetHit)->Arg(kCachePolicy_LRU)->Arg(kCachePolicy_SLRU);
+
+static void BM_ResourceCache_GetMiss(benchmark::State &state)
+{
+    BenchCache cache(CacheItems);
+    FillCache(cache);
+    int key = CacheItems;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(cache.Get(key++));
+}
+BENCHMARK(BM_ResourceCache_GetMiss);
+
+static void BM_ResourceCache_PutEvict(benchmark::State &state)
+{
+    BenchCache cache(CacheItems);
+    cache.SetPolicy(static_cast<ResourceCachePolicy>(state.range(0)));
+    FillCache(cache);
+    // every new item pushes out the oldest one
+    int key = CacheItems;
+    for (auto _ : state)
+        cache.Put(key++, 1);
+}
+BENCHMARK(BM_ResourceCache_PutEvict)->Arg(kCachePolicy_LRU)->Arg(kCachePolicy_SLRU);
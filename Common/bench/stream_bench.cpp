@@ -0,0 +1,133 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <vector>
+#include "benchmark/benchmark.h"
+#include "util/bufferedstream.h"
+#include "util/file.h"
+#include "util/filestream.h"
+#include "util/memory_compat.h"
+#include "util/memorystream.h"
+
+using namespace AGS::Common;
+
+static const char *BenchFile = "bench_stream.dat";
+static const size_t BenchFileSize = 4u * 1024 * 1024;
+
+// Writes the file to read, removes it when destroyed
+class BenchFileScope
+{
+public:
+    BenchFileScope()
+    {
+        std::vector<uint8_t> data(BenchFileSize);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<uint8_t>(i * 31);
+        Stream out(std::make_unique<FileStream>(BenchFile, kFile_CreateAlways, kStream_Write));
+        out.Write(data.data(), data.size());
+    }
+    ~BenchFileScope() { File::DeleteFile(BenchFile); }
+};
+
+// Reads the whole stream by the small values, the way the game data is parsed
+static void ReadInt32s(Stream &in)
+{
+    int32_t sum = 0;
+    for (size_t i = 0; i < BenchFileSize / sizeof(int32_t); ++i)
+        sum += in.ReadInt32();
+    benchmark::DoNotOptimize(sum);
+}
+
+// Reads the whole stream by the chunks of the given size
+static void ReadChunks(Stream &in, size_t chunk_size)
+{
+    std::vector<uint8_t> buf(chunk_size);
+    while (in.Read(buf.data(), buf.size()) > 0)
+        benchmark::ClobberMemory();
+}
+
+static void BM_FileStream_ReadInt32(benchmark::State &state)
+{
+    BenchFileScope file;
+    for (auto _ : state)
+    {
+        Stream in(std::make_unique<FileStream>(BenchFile, kFile_Open, kStream_Read));
+        ReadInt32s(in);
+    }
+    state.SetBytesProcessed(state.iterations() * BenchFileSize);
+}
+BENCHMARK(BM_FileStream_ReadInt32);
+
+static void BM_BufferedStream_ReadInt32(benchmark::State &state)
+{
+    BenchFileScope file;
+    for (auto _ : state)
+    {
+        Stream in(std::make_unique<BufferedStream>(
+            std::make_unique<FileStream>(BenchFile, kFile_Open, kStream_Read)));
+        ReadInt32s(in);
+    }
+    state.SetBytesProcessed(state.iterations() * BenchFileSize);
+}
+BENCHMARK(BM_BufferedStream_ReadInt32);
+
+static void BM_FileStream_ReadChunks(benchmark::State &state)
+{
+    BenchFileScope file;
+    for (auto _ : state)
+    {
+        Stream in(std::make_unique<FileStream>(BenchFile, kFile_Open, kStream_Read));
+        ReadChunks(in, static_cast<size_t>(state.range(0)));
+    }
+    state.SetBytesProcessed(state.iterations() * BenchFileSize);
+}
+BENCHMARK(BM_FileStream_ReadChunks)->Arg(256)->Arg(64 * 1024);
+
+static void BM_BufferedStream_ReadChunks(benchmark::State &state)
+{
+    BenchFileScope file;
+    for (auto _ : state)
+    {
+        Stream in(std::make_unique<BufferedStream>(
+            std::make_unique<FileStream>(BenchFile, kFile_Open, kStream_Read)));
+        ReadChunks(in, static_cast<size_t>(state.range(0)));
+    }
+    state.SetBytesProcessed(state.iterations() * BenchFileSize);
+}
+BENCHMARK(BM_BufferedStream_ReadChunks)->Arg(256)->Arg(64 * 1024);
+
+static void BM_MemoryStream_ReadInt32(benchmark::State &state)
+{
+    std::vector<uint8_t> data(BenchFileSize);
+    for (auto _ : state)
+    {
+        Stream in(std::make_unique<MemoryStream>(data.data(), data.size()));
+        ReadInt32s(in);
+    }
+    state.SetBytesProcessed(state.iterations() * BenchFileSize);
+}
+BENCHMARK(BM_MemoryStream_ReadInt32);
+
+static void BM_VectorStream_WriteInt32(benchmark::State &state)
+{
+    std::vector<uint8_t> data;
+    for (auto _ : state)
+    {
+        data.clear();
+        Stream out(std::make_unique<VectorStream>(data, kStream_Write));
+        for (size_t i = 0; i < BenchFileSize / sizeof(int32_t); ++i)
+            out.WriteInt32(static_cast<int32_t>(i));
+    }
+    state.SetBytesProcessed(state.iterations() * BenchFileSize);
+}
+BENCHMARK(BM_VectorStream_WriteInt32);
@@ -0,0 +1,100 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <vector>
+#include "benchmark/benchmark.h"
+#include "util/string.h"
+
+using namespace AGS::Common;
+
+static void BM_String_Format(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        String s = String::FromFormat("%s%d.%s", "character", 12345, "png");
+        benchmark::DoNotOptimize(s);
+    }
+}
+BENCHMARK(BM_String_Format);
+
+static void BM_String_Append(benchmark::State &state)
+{
+    const int count = static_cast<int>(state.range(0));
+    for (auto _ : state)
+    {
+        String s;
+        for (int i = 0; i < count; ++i)
+            s.Append("text ");
+        benchmark::DoNotOptimize(s);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_String_Append)->Arg(16)->Arg(1024);
+
+static void BM_String_Copy(benchmark::State &state)
+{
+    const String src(String('x', static_cast<size_t>(state.range(0))));
+    for (auto _ : state)
+    {
+        // copies share the buffer until one of them is modified
+        String s = src;
+        s.AppendChar('y');
+        benchmark::DoNotOptimize(s);
+    }
+}
+BENCHMARK(BM_String_Copy)->Arg(16)->Arg(4096);
+
+static void BM_String_CompareNoCase(benchmark::State &state)
+{
+    const String s1 = "Assets/Sprites/Character_Walk_Left.png";
+    const String s2 = "assets/sprites/character_walk_left.PNG";
+    for (auto _ : state)
+        benchmark::DoNotOptimize(s1.CompareNoCase(s2));
+}
+BENCHMARK(BM_String_CompareNoCase);
+
+static void BM_String_FindString(benchmark::State &state)
+{
+    String text;
+    for (int i = 0; i < 100; ++i)
+        text.AppendFmt("line %d of the text without the word; ", i);
+    text.Append("needle");
+    for (auto _ : state)
+        benchmark::DoNotOptimize(text.FindString("needle"));
+    state.SetBytesProcessed(state.iterations() * text.GetLength());
+}
+BENCHMARK(BM_String_FindString);
+
+static void BM_String_Split(benchmark::State &state)
+{
+    String text;
+    for (int i = 0; i < 100; ++i)
+        text.AppendFmt("item%d,", i);
+    for (auto _ : state)
+    {
+        std::vector<String> items = text.Split(',');
+        benchmark::DoNotOptimize(items);
+    }
+}
+BENCHMARK(BM_String_Split);
+
+static void BM_String_Lower(benchmark::State &state)
+{
+    const String s = "Assets/Sprites/Character_Walk_Left.png";
+    for (auto _ : state)
+    {
+        String l = s.Lower();
+        benchmark::DoNotOptimize(l);
+    }
+}
+BENCHMARK(BM_String_Lower);
@@ -26,6 +26,14 @@ namespace AGS
 namespace Common
 {
 
+// Compression of the asset's data stored in library
+enum AssetCompression
+{
+    kAssetCompress_None     = 0,
+    // Compressed in independent LZ4 blocks, see CompressedBlockStream
+    kAssetCompress_LZ4Block = 1
+};
+
 // Information on single asset
 struct AssetInfo
 {
@@ -34,6 +42,9 @@ struct AssetInfo
     int32_t     LibUid;     // index of library partition (separate file)
     soff_t      Offset;     // asset's position in library file (in bytes)
     soff_t      Size;       // asset's size (in bytes)
+    AssetCompression Compression; // how the asset's data is stored
+    soff_t      DataSize;   // size of the stored data (in bytes), equals to
+                            // Size unless the asset is compressed
 
     AssetInfo();
 };
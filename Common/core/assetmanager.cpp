@@ -13,9 +13,20 @@
 //=============================================================================
 #include "core/assetmanager.h"
 #include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <deque>
 #include <regex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "debug/eventtrace.h"
+#include "util/compressedblockstream.h"
 #include "util/directory.h"
 #include "util/file.h"
+#include "util/mappedfilestream.h"
+#include "util/memory_compat.h"
+#include "util/memorystream.h"
 #include "util/multifilelib.h"
 #include "util/path.h"
 
@@ -25,6 +36,56 @@ namespace AGS
 namespace Common
 {
 
+struct AssetManager::AsyncReader
+{
+    // NOTE: the strings in requests are kept unshared with the caller's,
+    // because String's reference counting is not thread-safe
+    struct Request
+    {
+        std::string Key; // identifies the identical requests
+        AssetPath Path;
+        soff_t Offset = 0;
+        soff_t Size = -1;
+        AssetReadPriority Priority = kAssetRead_Normal;
+        std::promise<AssetReadResult> Promise;
+        AssetReadFuture Future;
+    };
+
+    std::thread Thread;
+    // Guards the libraries while the background thread reads an asset
+    std::mutex LibsMutex;
+    // Guards all the fields below
+    std::mutex Mutex;
+    // Wakes the background thread when there are new requests
+    std::condition_variable WakeCv;
+    // Queued requests, per priority; a request which priority was raised
+    // is present in several queues, and is serviced once
+    std::array<std::deque<std::shared_ptr<Request>>, kNumAssetReadPriorities> Queues;
+    // Requests which were not serviced yet, mapped by their key
+    std::unordered_map<std::string, std::shared_ptr<Request>> Pending;
+    bool Stop = false;
+
+    // Takes the next pending request of the highest priority; returns null if there's none
+    std::shared_ptr<Request> TakeNext()
+    {
+        for (int prio = kNumAssetReadPriorities - 1; prio >= 0; --prio)
+        {
+            auto &queue = Queues[prio];
+            while (!queue.empty())
+            {
+                auto req = std::move(queue.front());
+                queue.pop_front();
+                auto it = Pending.find(req->Key);
+                if (it == Pending.end() || it->second != req)
+                    continue; // already serviced
+                Pending.erase(it);
+                return req;
+            }
+        }
+        return nullptr;
+    }
+};
+
 inline static bool IsAssetLibDir(const AssetLibInfo *lib) { return lib->BaseFileName.IsEmpty(); }
 inline static bool IsAssetLibFile(const AssetLibInfo *lib) { return !lib->BaseFileName.IsEmpty(); }
 
@@ -49,6 +110,13 @@ bool SortLibsPriorityLib(const AssetLibInfo *lib1, const AssetLibInfo *lib2)
     return !IsAssetLibDir(lib1) && IsAssetLibDir(lib2);
 }
 
+AssetManager::AssetManager() = default;
+
+AssetManager::~AssetManager()
+{
+    StopAsyncReads();
+}
+
 /* static */ bool AssetManager::IsDataFile(const String &data_file)
 {
     std::unique_ptr<Stream> in = File::OpenFileCI(data_file, kFile_Open, kStream_Read);
@@ -73,6 +141,7 @@ bool SortLibsPriorityLib(const AssetLibInfo *lib1, const AssetLibInfo *lib2)
 
 void AssetManager::SetSearchPriority(AssetSearchPriority priority)
 {
+    auto libs_lock = LockLibs();
     _libsPriority = priority;
     _libsSorter = _libsPriority == kAssetPriorityDir ? SortLibsPriorityDir : SortLibsPriorityLib;
     std::sort(_activeLibs.begin(), _activeLibs.end(), _libsSorter);
@@ -83,6 +152,12 @@ AssetSearchPriority AssetManager::GetSearchPriority() const
     return _libsPriority;
 }
 
+void AssetManager::SetOpenCallback(PfnAssetOpened callback)
+{
+    auto libs_lock = LockLibs();
+    _openCallback = callback;
+}
+
 AssetError AssetManager::AddLibrary(const String &path, const AssetLibInfo **out_lib)
 {
     return AddLibrary(path, "", out_lib);
@@ -93,6 +168,7 @@ AssetError AssetManager::AddLibrary(const String &path, const String &filters, c
     if (path.IsEmpty())
         return kAssetErrNoLibFile;
 
+    auto libs_lock = LockLibs();
     for (const auto &lib : _libs)
     {
         if (Path::ComparePaths(lib->BasePath, path) == 0)
@@ -110,6 +186,7 @@ AssetError AssetManager::AddLibrary(const String &path, const String &filters, c
     if (err != kAssetNoError)
         return err;
     lib->Filters = filters.Split(',');
+    IndexAssetLib(lib);
     auto place = std::upper_bound(_activeLibs.begin(), _activeLibs.end(), lib, _libsSorter);
     _activeLibs.insert(place, lib);
     if (out_lib)
@@ -119,6 +196,7 @@ AssetError AssetManager::AddLibrary(const String &path, const String &filters, c
 
 void AssetManager::RemoveLibrary(const String &path)
 {
+    auto libs_lock = LockLibs();
     for (auto it = _libs.cbegin(); it != _libs.cend(); ++it)
     {
         if (Path::ComparePaths((*it)->BasePath, path) == 0)
@@ -126,6 +204,7 @@ void AssetManager::RemoveLibrary(const String &path)
             auto it_end = std::remove(_activeLibs.begin(), _activeLibs.end(), (*it).get());
             _activeLibs.erase(it_end, _activeLibs.end());
             _libs.erase(it);
+            RebuildAssetIndex();
             return;
         }
     }
@@ -133,8 +212,11 @@ void AssetManager::RemoveLibrary(const String &path)
 
 void AssetManager::RemoveAllLibraries()
 {
+    auto libs_lock = LockLibs();
     _libs.clear();
     _activeLibs.clear();
+    _assetIndex.clear();
+    _assetEntries.clear();
 }
 
 size_t AssetManager::GetLibraryCount() const
@@ -149,6 +231,8 @@ const AssetLibInfo *AssetManager::GetLibraryInfo(size_t index) const
 
 bool AssetManager::DoesAssetExist(const String &asset_name, const String &filter) const
 {
+    auto libs_lock = LockLibs();
+    const uint32_t entry = LookupAsset(asset_name);
     for (const auto &lib : _activeLibs)
     {
         if (!lib->TestFilter(filter))
@@ -160,13 +244,9 @@ bool AssetManager::DoesAssetExist(const String &asset_name, const String &filter
             if (!filename.IsEmpty())
                 return true;
         }
-        else
+        else if (FindAssetInLib(lib, entry))
         {
-            for (const auto &a : lib->AssetInfos)
-            {
-                if (a.FileName.CompareNoCase(asset_name) == 0)
-                    return true;
-            }
+            return true;
         }
     }
     return false;
@@ -175,6 +255,7 @@ bool AssetManager::DoesAssetExist(const String &asset_name, const String &filter
 void AssetManager::FindAssets(std::vector<String> &assets, const String &wildcard,
     const String &filter) const
 {
+    auto libs_lock = LockLibs();
     String pattern = StrUtil::WildcardToRegex(wildcard);
     const std::regex regex(pattern.GetCStr(), std::regex_constants::icase);
     std::cmatch mr;
@@ -249,36 +330,135 @@ AssetError AssetManager::RegisterAssetLib(const String &path, AssetLibEx *&out_l
     return kAssetNoError;
 }
 
+void AssetManager::IndexAssetLib(const AssetLibEx *lib)
+{
+    _assetIndex.reserve(_assetIndex.size() + lib->AssetInfos.size());
+    for (const auto &asset : lib->AssetInfos)
+    {
+        const uint32_t new_entry = static_cast<uint32_t>(_assetEntries.size());
+        AssetIndexEntry entry;
+        entry.Lib = lib;
+        entry.Asset = &asset;
+        _assetEntries.push_back(entry);
+        auto it = _assetIndex.find(asset.FileName);
+        if (it == _assetIndex.end())
+        {
+            _assetIndex.insert(std::make_pair(asset.FileName, new_entry));
+            continue;
+        }
+        // Append to the end of this asset's chain, keeping the first found
+        // asset first, in case the same library has duplicate names
+        uint32_t last = it->second;
+        while (_assetEntries[last].Next != NoIndexEntry)
+            last = _assetEntries[last].Next;
+        _assetEntries[last].Next = new_entry;
+    }
+}
+
+void AssetManager::RebuildAssetIndex()
+{
+    _assetIndex.clear();
+    _assetEntries.clear();
+    for (const auto &lib : _libs)
+    {
+        if (IsAssetLibFile(lib.get()))
+            IndexAssetLib(lib.get());
+    }
+}
+
+uint32_t AssetManager::LookupAsset(const String &asset_name) const
+{
+    auto it = _assetIndex.find(asset_name);
+    return it != _assetIndex.end() ? it->second : NoIndexEntry;
+}
+
+const AssetInfo *AssetManager::FindAssetInLib(const AssetLibEx *lib, uint32_t entry) const
+{
+    for (; entry != NoIndexEntry; entry = _assetEntries[entry].Next)
+    {
+        if (_assetEntries[entry].Lib == lib)
+            return _assetEntries[entry].Asset;
+    }
+    return nullptr;
+}
+
 std::unique_ptr<Stream> AssetManager::OpenAsset(const String &asset_name, const String &filter) const
 {
+    AGS_TRACE_ZONE_DETAIL("OpenAsset", asset_name.GetCStr());
+    auto libs_lock = LockLibs();
+    return FindAndOpenAsset(asset_name, filter);
+}
+
+// Assets not larger than this are read into memory at once, if requested
+static const soff_t ReadWholeAssetMaxSize = 1024 * 1024;
+
+std::unique_ptr<Stream> AssetManager::OpenAsset(const String &asset_name, const String &filter, AssetOpenHint hint) const
+{
+    auto s = OpenAsset(asset_name, filter);
+    if (!s || (hint != kAssetOpen_ReadWhole) || s->GetMemoryBuffer())
+        return s; // not found, no hint, or already in memory
+    const soff_t len = s->GetLength();
+    if (len > ReadWholeAssetMaxSize)
+        return s;
+    // Read small asset in one go, and let the caller parse it from memory,
+    // instead of doing many small reads from the file or a decompressor
+    std::vector<uint8_t> data(static_cast<size_t>(len));
+    if (len > 0 && s->Read(data.data(), data.size()) != data.size())
+        return nullptr;
+    return Stream::WrapMemory(std::make_unique<OwnedMemoryStream>(std::move(data), s->GetPath()));
+}
+
+std::unique_ptr<Stream> AssetManager::FindAndOpenAsset(const String &asset_name, const String &filter) const
+{
+    const uint32_t entry = LookupAsset(asset_name);
     for (const auto *lib : _activeLibs)
     {
         if (!lib->TestFilter(filter)) continue; // filter does not match
 
         std::unique_ptr<Stream> s;
         if (IsAssetLibDir(lib))
+        {
             s = OpenAssetFromDir(lib, asset_name);
+        }
         else
-            s = OpenAssetFromLib(lib, asset_name);
+        {
+            const AssetInfo *asset = FindAssetInLib(lib, entry);
+            if (asset)
+                s = OpenAssetFromLib(lib, *asset);
+        }
         if (s)
+        {
+            if (_openCallback)
+                _openCallback(asset_name);
             return s;
+        }
     }
     return nullptr;
 }
 
-std::unique_ptr<Stream> AssetManager::OpenAssetFromLib(const AssetLibEx *lib, const String &asset_name) const
+std::unique_ptr<Stream> AssetManager::OpenAssetFromLib(const AssetLibEx *lib, const AssetInfo &asset) const
 {
-    for (const auto &a : lib->AssetInfos)
+    String libfile = lib->RealLibFiles[asset.LibUid];
+    if (libfile.IsEmpty())
+        return nullptr;
+    // Prefer mapping the asset into memory, which saves on read calls
+    // and lets read the data in place; use a regular file if failed
+    const soff_t data_end = asset.Offset + asset.DataSize;
+    std::unique_ptr<Stream> s = MappedFileStream::OpenFile(libfile, asset.Offset, data_end);
+    if (!s)
+        s = File::OpenFile(libfile, asset.Offset, data_end);
+    if (!s)
+        return nullptr;
+    switch (asset.Compression)
     {
-        if (a.FileName.CompareNoCase(asset_name) == 0)
-        {
-            String libfile = lib->RealLibFiles[a.LibUid];
-            if (libfile.IsEmpty())
-                return nullptr;
-            return File::OpenFile(libfile, a.Offset, a.Offset + a.Size);
-        }
+    case kAssetCompress_None:
+        return s;
+    case kAssetCompress_LZ4Block:
+        // Compressed asset is decompressed on the fly, block by block
+        return CompressedBlockStream::Open(std::move(s));
+    default:
+        return nullptr; // unsupported compression
     }
-    return nullptr;
 }
 
 std::unique_ptr<Stream> AssetManager::OpenAssetFromDir(const AssetLibEx *lib, const String &file_name) const
@@ -294,6 +474,106 @@ std::unique_ptr<Stream> AssetManager::OpenAsset(const String &asset_name) const
     return OpenAsset(asset_name, "");
 }
 
+AssetReadFuture AssetManager::ReadAssetAsync(const AssetPath &apath, soff_t offset, soff_t size,
+    AssetReadPriority priority)
+{
+    if (!_async)
+        _async.reset(new AsyncReader());
+    auto &async = *_async;
+    const std::string key = String::FromFormat("%s\n%s\n%lld\n%lld", apath.Name.Lower().GetCStr(),
+        apath.Filter.GetCStr(), static_cast<long long>(offset), static_cast<long long>(size)).GetCStr();
+    AssetReadFuture future;
+    {
+        std::lock_guard<std::mutex> lk(async.Mutex);
+        auto it = async.Pending.find(key);
+        if (it != async.Pending.end())
+        {
+            // Merge with the identical request, raising its priority
+            auto &req = it->second;
+            if (priority > req->Priority)
+            {
+                req->Priority = priority;
+                async.Queues[priority].push_back(req);
+            }
+            return req->Future;
+        }
+
+        auto req = std::make_shared<AsyncReader::Request>();
+        req->Key = key;
+        req->Path = AssetPath(String(apath.Name.GetCStr()), String(apath.Filter.GetCStr()));
+        req->Offset = offset;
+        req->Size = size;
+        req->Priority = priority;
+        req->Future = req->Promise.get_future().share();
+        future = req->Future;
+        async.Pending[key] = req;
+        async.Queues[priority].push_back(std::move(req));
+    }
+    if (!async.Thread.joinable())
+        async.Thread = std::thread(&AssetManager::AsyncReadThread, this);
+    async.WakeCv.notify_one();
+    return future;
+}
+
+void AssetManager::StopAsyncReads()
+{
+    if (!_async)
+        return;
+    {
+        std::lock_guard<std::mutex> lk(_async->Mutex);
+        _async->Stop = true;
+    }
+    _async->WakeCv.notify_one();
+    if (_async->Thread.joinable())
+        _async->Thread.join();
+    // Complete the cancelled requests, so that nobody waits for them forever
+    for (auto &item : _async->Pending)
+        item.second->Promise.set_value(AssetReadResult());
+    _async.reset();
+}
+
+std::unique_lock<std::mutex> AssetManager::LockLibs() const
+{
+    if (!_async)
+        return std::unique_lock<std::mutex>();
+    return std::unique_lock<std::mutex>(_async->LibsMutex);
+}
+
+void AssetManager::AsyncReadThread()
+{
+    auto &async = *_async;
+    std::unique_lock<std::mutex> lk(async.Mutex);
+    while (true)
+    {
+        async.WakeCv.wait(lk, [&async]() { return async.Stop || !async.Pending.empty(); });
+        if (async.Stop)
+            break;
+        auto req = async.TakeNext();
+        if (!req)
+            continue;
+        lk.unlock();
+
+        AssetReadResult result;
+        {
+            std::lock_guard<std::mutex> libs_lk(async.LibsMutex);
+            std::unique_ptr<Stream> in = FindAndOpenAsset(req->Path.Name, req->Path.Filter);
+            if (in)
+            {
+                result.AssetSize = in->GetLength();
+                const soff_t offset = std::min(std::max<soff_t>(0, req->Offset), result.AssetSize);
+                const soff_t avail = result.AssetSize - offset;
+                const size_t size = static_cast<size_t>((req->Size < 0) ? avail : std::min(req->Size, avail));
+                result.Data = std::make_shared<std::vector<uint8_t>>(size);
+                in->Seek(offset, kSeekBegin);
+                if (size > 0 && in->Read(result.Data->data(), size) < size)
+                    result.Data.reset(); // failed to read
+            }
+        }
+        req->Promise.set_value(std::move(result));
+        lk.lock();
+    }
+}
+
 
 String GetAssetErrorText(AssetError err)
 {
@@ -32,14 +32,31 @@
 //    in general use (?).
 // Same changes could be done for File helpers (OpenFile etc).
 //
+//-----------------------------------------------------------------------------
+//
+// The assets may also be read asynchronously: ReadAssetAsync queues a read
+// request, which is serviced by the manager's I/O thread, and returns
+// a future for the read data. The requests are serviced in the order of
+// their priority; the identical requests which were not serviced yet are
+// merged into one. The libraries may be added and removed while there are
+// pending requests, but the futures must not be waited for from the methods
+// which do that.
+// NOTE: as String is not thread-safe, the library infos returned by
+// GetLibraryInfo() should not be used while there are pending requests.
+//
 //=============================================================================
 #ifndef __AGS_CN_CORE__ASSETMANAGER_H
 #define __AGS_CN_CORE__ASSETMANAGER_H
 
 #include <memory>
 #include <functional>
+#include <future>
+#include <mutex>
+#include <vector>
 #include "core/asset.h"
+#include "util/flat_hash.h"
 #include "util/stream.h"
+#include "util/string_types.h"
 
 namespace AGS
 {
@@ -62,6 +79,35 @@ enum AssetError
     kAssetErrNoManager      = -6, // asset manager not initialized
 };
 
+// Priority of the asynchronous asset read
+enum AssetReadPriority
+{
+    kAssetRead_Low,
+    kAssetRead_Normal,
+    kAssetRead_High,
+    kNumAssetReadPriorities
+};
+
+// Hint on how the opened asset is going to be read
+enum AssetOpenHint
+{
+    kAssetOpen_Default,
+    // the asset will be read whole, with many small reads (e.g. deserialized);
+    // the small assets are read into memory at once when opened
+    kAssetOpen_ReadWhole
+};
+
+// Result of the asynchronous asset read
+struct AssetReadResult
+{
+    // Read data; null if the asset was not found, or could not be read
+    std::shared_ptr<std::vector<uint8_t>> Data;
+    // Full size of the asset, which may be larger than the data read
+    soff_t AssetSize = 0;
+};
+
+typedef std::shared_future<AssetReadResult> AssetReadFuture;
+
 // AssetPath combines asset name and optional library filter, that serves to narrow down the search
 struct AssetPath
 {
@@ -75,8 +121,11 @@ struct AssetPath
 class AssetManager
 {
 public:
-    AssetManager() = default;
-    ~AssetManager() = default;
+    // Callback run when an asset is opened for reading, receives the asset's name
+    typedef std::function<void(const String &asset_name)> PfnAssetOpened;
+
+    AssetManager();
+    ~AssetManager();
 
     // Test if given file is main data file
     static bool         IsDataFile(const String &data_file);
@@ -87,6 +136,10 @@ public:
     void         SetSearchPriority(AssetSearchPriority priority);
     // Gets current asset search priority
     AssetSearchPriority GetSearchPriority() const;
+    // Sets the callback which is run each time an asset is opened successfully;
+    // the callback may be run from the background reading thread too, but
+    // the calls are never concurrent
+    void         SetOpenCallback(PfnAssetOpened callback);
 
     // Add library location to the list of asset locations
     AssetError   AddLibrary(const String &path, const AssetLibInfo **lib = nullptr);
@@ -115,6 +168,19 @@ public:
     std::unique_ptr<Stream> OpenAsset(const String &asset_name, const String &filter) const;
     inline std::unique_ptr<Stream> OpenAsset(const AssetPath &apath) const
         { return OpenAsset(apath.Name, apath.Filter); }
+    // Open asset stream, with a hint on how it is going to be read
+    std::unique_ptr<Stream> OpenAsset(const String &asset_name, const String &filter, AssetOpenHint hint) const;
+    inline std::unique_ptr<Stream> OpenAsset(const String &asset_name, AssetOpenHint hint) const
+        { return OpenAsset(asset_name, "", hint); }
+    // Queues reading of up to "size" bytes of asset, starting at "offset",
+    // in the background thread; negative size means read till the asset's end.
+    // If the same request is already queued, then returns its future, raising
+    // its priority if necessary.
+    AssetReadFuture ReadAssetAsync(const AssetPath &apath, soff_t offset = 0, soff_t size = -1,
+                                   AssetReadPriority priority = kAssetRead_Normal);
+    // Cancels all the queued read requests and stops the background thread;
+    // the cancelled requests are completed with no data
+    void         StopAsyncReads();
 
 private:
     // AssetLibEx combines library info with extended internal data required for the manager
@@ -126,11 +192,39 @@ private:
         bool TestFilter(const String &filter) const;
     };
 
+    // Entry of the asset index, refers to the asset in a particular library;
+    // entries of the same asset name are chained in the order of adding libraries
+    struct AssetIndexEntry
+    {
+        const AssetLibEx *Lib = nullptr;
+        const AssetInfo *Asset = nullptr;
+        uint32_t Next = UINT32_MAX;
+    };
+    static const uint32_t NoIndexEntry = UINT32_MAX;
+
+    // Locks the libraries from being used by the background thread
+    std::unique_lock<std::mutex> LockLibs() const;
+    // Background reading thread's function
+    void        AsyncReadThread();
+
     // Loads library and registers its contents into the cache
     AssetError  RegisterAssetLib(const String &path, AssetLibEx *&lib);
-
-    // Tries to find asset in the given location, and then opens a stream for reading
-    std::unique_ptr<Stream> OpenAssetFromLib(const AssetLibEx *lib, const String &asset_name) const;
+    // Adds the library's assets to the asset index
+    void        IndexAssetLib(const AssetLibEx *lib);
+    // Rebuilds the asset index for all the registered libraries
+    void        RebuildAssetIndex();
+    // Finds the first index entry for the given asset name, or NoIndexEntry
+    uint32_t    LookupAsset(const String &asset_name) const;
+    // Finds the asset in the given library, following the index entries
+    // starting with the given one; returns null if the library has no such asset
+    const AssetInfo *FindAssetInLib(const AssetLibEx *lib, uint32_t entry) const;
+
+    // Finds the asset in the matching locations and opens a stream for reading;
+    // expects the libraries to be locked
+    std::unique_ptr<Stream> FindAndOpenAsset(const String &asset_name, const String &filter) const;
+    // Opens a stream for reading the asset from the library file
+    std::unique_ptr<Stream> OpenAssetFromLib(const AssetLibEx *lib, const AssetInfo &asset) const;
+    // Tries to find asset in the given directory, and then opens a stream for reading
     std::unique_ptr<Stream> OpenAssetFromDir(const AssetLibEx *lib, const String &asset_name) const;
 
     std::vector<std::unique_ptr<AssetLibEx>> _libs;
@@ -138,6 +232,17 @@ private:
     AssetSearchPriority _libsPriority = kAssetPriorityDir;
     // Sorting function, depends on priority setting
     std::function<bool(const AssetLibInfo*, const AssetLibInfo*)> _libsSorter;
+    PfnAssetOpened _openCallback;
+    // Index of the assets found in the library files, maps the asset name
+    // (case-insensitive) to the first of its entries; the directories are
+    // not indexed, as their contents may change at any time.
+    // The search priority and the filters are applied when looking
+    // through the found entries.
+    FlatHashMap<String, uint32_t, HashStrNoCase, StrEqNoCase> _assetIndex;
+    std::vector<AssetIndexEntry> _assetEntries;
+    // Asynchronous reading state, created on the first request
+    struct AsyncReader;
+    std::unique_ptr<AsyncReader> _async;
 };
 
 
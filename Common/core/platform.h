@@ -200,4 +200,12 @@
     #define DEBUG_SPRITECACHE (0)
 #endif
 
+#if !defined(STRIP_DEBUG_LOG)
+    #define STRIP_DEBUG_LOG (0)
+#endif
+
+#if !defined(EVENT_TRACE)
+    #define EVENT_TRACE (1)
+#endif
+
 #endif // __AC_PLATFORM_H
@@ -0,0 +1,99 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "debug/asyncoutput.h"
+#include <chrono>
+
+namespace AGS
+{
+namespace Common
+{
+
+// Max time the writer sleeps before checking the queue, in case it missed
+// a wake up: the logging thread notifies it without taking the lock
+static const auto WriterWakeInterval = std::chrono::milliseconds(50);
+
+AsyncOutput::AsyncOutput(std::unique_ptr<IOutputHandler> &&handler, size_t queue_size)
+    : _handler(std::move(handler))
+    , _queue(queue_size)
+{
+#if !defined(AGS_DISABLE_THREADS)
+    _thread = std::thread(&AsyncOutput::WriterThread, this);
+#endif
+}
+
+AsyncOutput::~AsyncOutput()
+{
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _quit = true;
+    }
+    _wakeCv.notify_all();
+    if (_thread.joinable())
+        _thread.join();
+}
+
+void AsyncOutput::OnRegister()
+{
+    _handler->OnRegister();
+}
+
+void AsyncOutput::PrintMessage(const DebugMessage &msg)
+{
+#if defined(AGS_DISABLE_THREADS)
+    _handler->PrintMessage(msg);
+#else
+    if (!_queue.TryPush(DebugMessage(msg)))
+    {
+        _dropped++;
+        return;
+    }
+    _wakeCv.notify_one();
+#endif
+}
+
+void AsyncOutput::WriteQueued()
+{
+    DebugMessage msg;
+    while (_queue.TryPop(msg))
+        _handler->PrintMessage(msg);
+    const uint32_t dropped = _dropped.load();
+    if (dropped != _droppedReported)
+    {
+        _handler->PrintMessage(DebugMessage(
+            String::FromFormat("WARNING: log output could not keep up, %u messages were dropped", dropped - _droppedReported),
+            kDbgGroup_Main, "", kDbgMsg_Warn));
+        _droppedReported = dropped;
+    }
+}
+
+void AsyncOutput::WriterThread()
+{
+    std::unique_lock<std::mutex> lk(_mutex);
+    for (;;)
+    {
+        _wakeCv.wait_for(lk, WriterWakeInterval,
+            [this]() { return _quit || !_queue.IsEmpty(); });
+        const bool quit = _quit;
+        // The output is written without holding the lock, so that the
+        // wrapped handler could log something itself
+        lk.unlock();
+        WriteQueued();
+        lk.lock();
+        if (quit)
+            return; // everything queued before quitting is written
+    }
+}
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,81 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// AsyncOutput, the IOutputHandler wrapper that passes the messages to another
+// output handler on a writer thread. The messages are put into a bounded
+// lock-free queue, so the logging thread never waits for a slow output, such
+// as a file. If the queue is full, the message is dropped; the number of
+// dropped messages is counted and reported into the wrapped output as soon
+// as the writer catches up.
+//
+// The messages which are still queued are written when the AsyncOutput is
+// destroyed, but may be lost if the program crashes.
+//
+// DebugManager serializes the calls to PrintMessage, which makes it safe
+// to use the single-producer queue here.
+//
+// When the engine is built with AGS_DISABLE_THREADS, no thread is created
+// and the messages are passed to the wrapped output right away.
+//
+//=============================================================================
+#ifndef __AGS_CN_DEBUG__ASYNCOUTPUT_H
+#define __AGS_CN_DEBUG__ASYNCOUTPUT_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "debug/outputhandler.h"
+#include "util/spsc_queue.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class AsyncOutput : public IOutputHandler
+{
+public:
+    // Wraps the output handler, queueing up to the given number of messages
+    AsyncOutput(std::unique_ptr<IOutputHandler> &&handler, size_t queue_size = 4096u);
+    ~AsyncOutput() override;
+
+    void OnRegister() override;
+    void PrintMessage(const DebugMessage &msg) override;
+
+    // Gets the total number of messages dropped because the queue was full
+    uint32_t GetMessagesDropped() const { return _dropped.load(); }
+
+private:
+    void WriterThread();
+    // Writes all the queued messages, and the dropped messages
+    // warning if necessary
+    void WriteQueued();
+
+    std::unique_ptr<IOutputHandler> _handler;
+    SpscQueue<DebugMessage> _queue;
+    std::atomic<uint32_t> _dropped{0u};
+    // Number of the dropped messages the writer has already reported
+    uint32_t _droppedReported = 0u;
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _wakeCv;
+    bool _quit = false;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_DEBUG__ASYNCOUTPUT_H
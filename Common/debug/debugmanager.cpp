@@ -12,6 +12,7 @@
 //
 //=============================================================================
 #include <stdarg.h>
+#include <algorithm>
 #include "debug/debugmanager.h"
 #include "debug/messagebuffer.h"
 #include "util/memory_compat.h"
@@ -89,6 +90,8 @@ void DebugManager::DebugOutput::SendMessage(const DebugMessage &msg)
 
 DebugManager::DebugManager(bool buffer_messages)
 {
+    for (auto &verbosity : _groupVerbosity)
+        verbosity.store(kDbgMsg_None);
     // Add hardcoded groups
     // TODO: move this out of DebugManager, into the engine!
     RegisterGroup(DebugGroupID(kDbgGroup_Main, "main"), "");
@@ -97,6 +100,7 @@ DebugManager::DebugManager(bool buffer_messages)
     RegisterGroup(DebugGroupID(kDbgGroup_SprCache, "sprcache"), "Sprite cache");
     RegisterGroup(DebugGroupID(kDbgGroup_ManObj, "manobj"), "Managed obj");
     RegisterGroup(DebugGroupID(kDbgGroup_SDL, "sdl"), "SDL");
+    RegisterGroup(DebugGroupID(kDbgGroup_RoomLoad, "roomload"), "Room load");
 
     if (buffer_messages)
     {
@@ -150,6 +154,7 @@ MessageGroupHandle DebugManager::RegisterGroupImpl(const DebugGroupID &group_id,
     {
         out.second.ResolveGroupID(group.UID);
     }
+    UpdateGroupVerbosity();
 
     return group_id.ID;
 }
@@ -163,9 +168,11 @@ void DebugManager::RegisterOutput(const String &id,
         return;
 
     auto out = CreateOutputImpl(id, std::move(handler), def_verbosity, group_filters);
-    // Only lock when inserting new output into the list (minimal time)
-    std::lock_guard<std::mutex> lk(_mutex);
-    _outputs[id] = std::move(out);
+    // Only lock when inserting new output into the list (minimal time);
+    // the replaced output is destroyed after unlocking
+    std::unique_lock<std::mutex> lk(_mutex);
+    std::swap(_outputs[id], out);
+    UpdateGroupVerbosity();
 }
 
 DebugManager::DebugOutput DebugManager::CreateOutputImpl(const String &id,
@@ -202,6 +209,20 @@ void DebugManager::SendBufferedMessages(DebugOutput &out)
     }
 }
 
+void DebugManager::UpdateGroupVerbosity()
+{
+    for (size_t id = 0; id < MaxTestedGroups; ++id)
+    {
+        MessageType verbosity = kDbgMsg_None;
+        if (id < _groups.size() && _groups[id].UID.IsValid())
+        {
+            for (const auto &out : _outputs)
+                verbosity = std::max(verbosity, out.second.GetGroupFilter(id));
+        }
+        _groupVerbosity[id].store(verbosity, std::memory_order_relaxed);
+    }
+}
+
 DebugGroup DebugManager::GetGroup(const DebugGroupID &id)
 {
     std::lock_guard<std::mutex> lk(_mutex);
@@ -241,15 +262,20 @@ void DebugManager::SetOutputFilters(const String &id, MessageType def_verbosity,
     // Make sure that output allocates filters for all known groups
     for (const auto &group : _groups)
         _outputs[id].ResolveGroupID(group.UID);
+    UpdateGroupVerbosity();
 }
 
 void DebugManager::UnregisterAll()
 {
+    // The outputs are destroyed without holding the lock, as they may
+    // have to wait for their own threads, which may be printing something
+    decltype(_outputs) outputs;
     std::lock_guard<std::mutex> lk(_mutex);
     _groups.clear();
     _groupByStrLookup.clear();
-    _outputs.clear();
+    std::swap(_outputs, outputs);
     _freeGroupID = 0u;
+    UpdateGroupVerbosity();
 }
 
 void DebugManager::UnregisterGroup(const DebugGroupID &id)
@@ -263,12 +289,19 @@ void DebugManager::UnregisterGroup(const DebugGroupID &id)
         _freeGroupID = group.UID.ID;
     _groups[group.UID.ID] = DebugGroup();
     _groupByStrLookup.erase(group.UID.SID);
+    UpdateGroupVerbosity();
 }
 
 void DebugManager::UnregisterOutput(const String &id)
 {
+    DebugOutput out; // destroyed after unlocking, see UnregisterAll
     std::lock_guard<std::mutex> lk(_mutex);
-    _outputs.erase(id);
+    auto it = _outputs.find(id);
+    if (it == _outputs.end())
+        return;
+    std::swap(it->second, out);
+    _outputs.erase(it);
+    UpdateGroupVerbosity();
 }
 
 void DebugManager::StartMessageBuffering()
@@ -280,6 +313,7 @@ void DebugManager::StartMessageBuffering()
     std::lock_guard<std::mutex> lk(_mutex);
     _outputs[OutputMsgBufID] = std::move(out);
     _messageBuf = msg_buf_ptr;
+    UpdateGroupVerbosity();
 }
 
 void DebugManager::StopMessageBuffering()
@@ -287,10 +321,15 @@ void DebugManager::StopMessageBuffering()
     std::lock_guard<std::mutex> lk(_mutex);
     _messageBuf = nullptr;
     _outputs.erase(OutputMsgBufID);
+    UpdateGroupVerbosity();
 }
 
 void DebugManager::Print(MessageGroupHandle group_id, MessageType mt, const String &text)
 {
+#if STRIP_DEBUG_LOG
+    if (mt >= kDbgMsg_Debug)
+        return;
+#endif
     std::lock_guard<std::mutex> lk(_mutex);
     assert(group_id < _groups.size());
     if (group_id >= _groups.size())
@@ -326,6 +365,8 @@ void Printf(MessageGroupHandle group, MessageType mt, const String &text)
 
 void Printf(const char *fmt, ...)
 {
+    if (!IsEnabled(kDbgGroup_Main, kDbgMsg_Default))
+        return;
     va_list argptr;
     va_start(argptr, fmt);
     DbgMgr.Print(kDbgGroup_Main, kDbgMsg_Default, String::FromFormatV(fmt, argptr));
@@ -334,6 +375,8 @@ void Printf(const char *fmt, ...)
 
 void Printf(MessageType mt, const char *fmt, ...)
 {
+    if (!IsEnabled(kDbgGroup_Main, mt))
+        return;
     va_list argptr;
     va_start(argptr, fmt);
     DbgMgr.Print(kDbgGroup_Main, mt, String::FromFormatV(fmt, argptr));
@@ -342,12 +385,19 @@ void Printf(MessageType mt, const char *fmt, ...)
 
 void Printf(MessageGroupHandle group, MessageType mt, const char *fmt, ...)
 {
+    if (!IsEnabled(group, mt))
+        return;
     va_list argptr;
     va_start(argptr, fmt);
     DbgMgr.Print(group, mt, String::FromFormatV(fmt, argptr));
     va_end(argptr);
 }
 
+bool IsOutputEnabled(MessageGroupHandle group, MessageType mt)
+{
+    return DbgMgr.IsEnabled(group, mt);
+}
+
 } // namespace Debug
 
 }   // namespace Common
@@ -48,6 +48,7 @@
 #ifndef __AGS_CN_DEBUG__DEBUGMANAGER_H
 #define __AGS_CN_DEBUG__DEBUGMANAGER_H
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -142,6 +143,14 @@ public:
 
     // Output message of given group and message type
     void Print(MessageGroupHandle group_id, MessageType mt, const String &text);
+    // Tells if any output accepts messages of given group and message type;
+    // this test does not lock the manager
+    bool IsEnabled(MessageGroupHandle group_id, MessageType mt) const
+    {
+        if (group_id >= MaxTestedGroups)
+            return true; // let Print decide
+        return _groupVerbosity[group_id].load(std::memory_order_relaxed) >= mt;
+    }
 
 private:
     // OutputSlot struct wraps over output target and adds a flag which indicates
@@ -155,6 +164,11 @@ private:
 
         const String &GetID() const { return _id; }
         IOutputHandler *GetHandler() const { return _handler.get(); }
+        // Gets the max message type this output accepts from the group
+        MessageType GetGroupFilter(MessageGroupHandle id) const
+        {
+            return id < _groupFilter.size() ? _groupFilter[id] : _defaultVerbosity;
+        }
         void SetFilters(MessageType def_verbosity, const std::vector<std::pair<DebugGroupID, MessageType>> *group_filters);
         void ResolveGroupID(const DebugGroupID &id);
         void SendMessage(const DebugMessage &msg);
@@ -188,6 +202,8 @@ private:
         std::unique_ptr<IOutputHandler> &&handler, MessageType def_verbosity,
         const std::vector<std::pair<DebugGroupID, MessageType>> *group_filters);
     void               SendBufferedMessages(DebugOutput &out);
+    // Updates the max message types accepted from the groups; expects the lock held
+    void               UpdateGroupVerbosity();
 
     std::mutex          _mutex;
     uint32_t            _freeGroupID = 0u; // first free group numeric id
@@ -196,6 +212,10 @@ private:
                         _groupByStrLookup;
     std::unordered_map<String, DebugOutput, HashStrNoCase, StrEqNoCase>
                         _outputs;
+    // Max message type accepted by any output, per group, for the quick test;
+    // the groups with the larger IDs are not tested
+    static const size_t MaxTestedGroups = 64;
+    std::atomic<int>    _groupVerbosity[MaxTestedGroups];
 
     // The ID for the optional message buffer
     const String OutputMsgBufID = "internal.buffer";
@@ -0,0 +1,228 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "debug/eventtrace.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "debug/out.h"
+#include "util/file.h"
+#include "util/stream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace EventTrace
+{
+
+std::atomic<bool> Enabled{false};
+
+// Number of events a thread collects before writing them out
+static const size_t FlushThreshold = 1024u;
+
+struct Event
+{
+    const char *Name = nullptr;
+    std::string Detail;
+    uint64_t Start = 0u;
+    uint64_t Duration = 0u;
+};
+
+// The events recorded by one thread; the buffers are owned by the trace
+// as well, so the events are not lost when their thread ends
+struct ThreadBuffer
+{
+    std::mutex Mutex; // guards the events, rarely contended
+    uint32_t ThreadID = 0u;
+    String Name;
+    std::vector<Event> Events;
+};
+
+static std::mutex trace_mutex; // guards everything below
+static std::unique_ptr<Stream> trace_out;
+static bool trace_first_event = true;
+static std::vector<std::shared_ptr<ThreadBuffer>> trace_buffers;
+static uint32_t trace_next_thread_id = 1u;
+static std::chrono::steady_clock::time_point trace_start;
+
+static thread_local std::shared_ptr<ThreadBuffer> thread_buffer;
+
+static ThreadBuffer &GetThreadBuffer()
+{
+    if (!thread_buffer)
+    {
+        thread_buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lk(trace_mutex);
+        thread_buffer->ThreadID = trace_next_thread_id++;
+        trace_buffers.push_back(thread_buffer);
+    }
+    return *thread_buffer;
+}
+
+static void WriteEscaped(String &line, const char *text)
+{
+    for (const char *p = text; *p; ++p)
+    {
+        const char c = *p;
+        if (c == '"' || c == '\\')
+        {
+            line.AppendChar('\\');
+            line.AppendChar(c);
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            line.AppendFmt("\\u%04x", c);
+        }
+        else
+        {
+            line.AppendChar(c);
+        }
+    }
+}
+
+// Writes a ready event line; must be called with the trace lock held
+static void WriteLine(const String &line)
+{
+    if (!trace_out)
+        return;
+    if (!trace_first_event)
+        trace_out->Write(",\n", 2);
+    trace_out->Write(line.GetCStr(), line.GetLength());
+    trace_first_event = false;
+}
+
+// Writes the events; must be called with the trace lock held
+static void WriteEvents(uint32_t thread_id, const std::vector<Event> &events)
+{
+    String line;
+    for (const auto &e : events)
+    {
+        line = R"({"name":")";
+        WriteEscaped(line, e.Name);
+        line.AppendFmt(R"(","ph":"X","pid":1,"tid":%u,"ts":%.3f,"dur":%.3f)",
+            thread_id, e.Start / 1000.0, e.Duration / 1000.0);
+        if (!e.Detail.empty())
+        {
+            line.Append(R"(,"args":{"detail":")");
+            WriteEscaped(line, e.Detail.c_str());
+            line.Append("\"}");
+        }
+        line.AppendChar('}');
+        WriteLine(line);
+    }
+}
+
+bool Start(const String &filename)
+{
+    Stop();
+    auto out = File::CreateFile(filename);
+    if (!out)
+    {
+        Debug::Printf(kDbgMsg_Error, "Failed to open event trace file for writing: %s", filename.GetCStr());
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lk(trace_mutex);
+        // drop the events which could be added after the last stop
+        for (auto &buf : trace_buffers)
+        {
+            std::lock_guard<std::mutex> buf_lk(buf->Mutex);
+            buf->Events.clear();
+        }
+        trace_out = std::move(out);
+        trace_out->Write("[\n", 2);
+        trace_first_event = true;
+        WriteLine(R"({"name":"process_name","ph":"M","pid":1,"args":{"name":"AGS"}})");
+        trace_start = std::chrono::steady_clock::now();
+    }
+    Enabled = true;
+    Debug::Printf(kDbgMsg_Info, "Recording event trace to: %s", filename.GetCStr());
+    return true;
+}
+
+void Stop()
+{
+    if (!Enabled.exchange(false))
+        return;
+    std::lock_guard<std::mutex> lk(trace_mutex);
+    for (auto it = trace_buffers.begin(); it != trace_buffers.end();)
+    {
+        ThreadBuffer &buf = **it;
+        {
+            std::lock_guard<std::mutex> buf_lk(buf.Mutex);
+            WriteEvents(buf.ThreadID, buf.Events);
+            buf.Events.clear();
+            if (!buf.Name.IsEmpty())
+            {
+                String line = String::FromFormat(R"({"name":"thread_name","ph":"M","pid":1,"tid":%u,"args":{"name":")", buf.ThreadID);
+                WriteEscaped(line, buf.Name.GetCStr());
+                line.Append("\"}}");
+                WriteLine(line);
+            }
+        }
+        // forget the buffers of the threads which have ended
+        if (it->use_count() == 1)
+            it = trace_buffers.erase(it);
+        else
+            ++it;
+    }
+    trace_out->Write("\n]\n", 3);
+    trace_out.reset();
+}
+
+void SetThreadName(const char *name)
+{
+    ThreadBuffer &buf = GetThreadBuffer();
+    std::lock_guard<std::mutex> lk(buf.Mutex);
+    buf.Name = name;
+}
+
+uint64_t Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - trace_start).count();
+}
+
+void AddZone(const char *name, const char *detail, uint64_t start_ns, uint64_t end_ns)
+{
+    if (end_ns < start_ns)
+        return; // the zone has begun in the previous recording
+    ThreadBuffer &buf = GetThreadBuffer();
+    std::vector<Event> events;
+    {
+        std::lock_guard<std::mutex> lk(buf.Mutex);
+        Event e;
+        e.Name = name;
+        if (detail)
+            e.Detail = detail;
+        e.Start = start_ns;
+        e.Duration = end_ns - start_ns;
+        buf.Events.push_back(std::move(e));
+        if (buf.Events.size() < FlushThreshold)
+            return;
+        events.swap(buf.Events);
+        buf.Events.reserve(FlushThreshold);
+    }
+    // The buffer is written without holding its lock
+    std::lock_guard<std::mutex> lk(trace_mutex);
+    WriteEvents(buf.ThreadID, events);
+}
+
+} // namespace EventTrace
+
+} // namespace Common
+} // namespace AGS
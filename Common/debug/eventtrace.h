@@ -0,0 +1,107 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Event trace, records the time spent in the instrumented code zones on all
+// threads, and writes them in the Chrome trace event format (JSON), which
+// may be viewed in chrome://tracing, Perfetto UI, or imported into Tracy.
+//
+// The zones are marked with AGS_TRACE_ZONE("name") at the start of a block,
+// and end with the block. The zone name must be a string literal (or other
+// static string); an optional detail text is copied along with the event.
+//
+// While the trace is not recording, a zone costs a single flag check.
+// The recorded events are collected in the per-thread buffers, and written
+// to the file when a buffer fills up, and when the trace is stopped.
+//
+// The instrumentation may be compiled out by building with EVENT_TRACE=0.
+//
+//=============================================================================
+#ifndef __AGS_CN_DEBUG__EVENTTRACE_H
+#define __AGS_CN_DEBUG__EVENTTRACE_H
+
+#include <atomic>
+#include "core/platform.h"
+#include "core/types.h"
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace EventTrace
+{
+    // Starts recording the trace into the file at the given path
+    bool Start(const String &filename);
+    // Stops recording, writes the remaining events and closes the file
+    void Stop();
+    // Names the calling thread in the trace
+    void SetThreadName(const char *name);
+
+    // Gets the current trace time, in nanoseconds
+    uint64_t Now();
+    // Records the complete zone of the calling thread
+    void AddZone(const char *name, const char *detail, uint64_t start_ns, uint64_t end_ns);
+
+    extern std::atomic<bool> Enabled;
+
+    // Tells if the trace is being recorded
+    inline bool IsEnabled() { return Enabled.load(std::memory_order_acquire); }
+
+    // Scoped zone, records the event for the time of its existence
+    class Zone
+    {
+    public:
+        Zone(const char *name, const char *detail = nullptr)
+            : _name(name), _detail(detail)
+        {
+            if (IsEnabled())
+            {
+                _active = true;
+                _start = Now();
+            }
+        }
+        ~Zone()
+        {
+            if (_active && IsEnabled())
+                AddZone(_name, _detail, _start, Now());
+        }
+
+    private:
+        const char *_name;
+        const char *_detail;
+        bool _active = false;
+        uint64_t _start = 0u;
+    };
+} // namespace EventTrace
+
+} // namespace Common
+} // namespace AGS
+
+#define AGS_TRACE_CONCAT_IMPL(a, b) a##b
+#define AGS_TRACE_CONCAT(a, b) AGS_TRACE_CONCAT_IMPL(a, b)
+
+#if EVENT_TRACE
+// Records the zone from this point to the end of the current block
+#define AGS_TRACE_ZONE(name) \
+    AGS::Common::EventTrace::Zone AGS_TRACE_CONCAT(ags_trace_zone_, __LINE__)(name)
+// Same as AGS_TRACE_ZONE, also attaching the detail text to the event
+#define AGS_TRACE_ZONE_DETAIL(name, detail) \
+    AGS::Common::EventTrace::Zone AGS_TRACE_CONCAT(ags_trace_zone_, __LINE__)(name, detail)
+#else
+#define AGS_TRACE_ZONE(name)
+#define AGS_TRACE_ZONE_DETAIL(name, detail)
+#endif
+
+#endif // __AGS_CN_DEBUG__EVENTTRACE_H
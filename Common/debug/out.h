@@ -62,10 +62,24 @@
 // kDbgMsg_Fatal - is the message type to be reported when the program or
 // component abortion is imminent.
 //
+//-----------------------------------------------------------------------------
+//
+// On logging in the frequently run code.
+//
+// Debug::Printf formats the message before it is sent to the outputs, which
+// may all discard it. The printing functions which receive a format string
+// return early if no output accepts the message, but the arguments are still
+// evaluated by the caller. Where that is costly, use DEBUG_PRINTF macro, which
+// tests the message group and type first.
+//
+// When the program is built with STRIP_DEBUG_LOG, kDbgMsg_Debug messages are
+// never printed, and such DEBUG_PRINTF calls are compiled out.
+//
 //=============================================================================
 #ifndef __AGS_CN_DEBUG__OUT_H
 #define __AGS_CN_DEBUG__OUT_H
 
+#include "core/platform.h"
 #include "util/string.h"
 
 namespace AGS
@@ -125,7 +139,9 @@ enum CommonDebugGroup : MessageGroupHandle
     // Group for debugging managed object state (can slow engine down!)
     kDbgGroup_ManObj,
     // SDL backend group
-    kDbgGroup_SDL
+    kDbgGroup_SDL,
+    // Room load time breakdown
+    kDbgGroup_RoomLoad
 };
 
 namespace Debug
@@ -146,8 +162,29 @@ namespace Debug
     // Output formatted message of given group and type
     void Printf(MessageGroupHandle group_id, MessageType mt, const char *fmt, ...);
 
+    // Tells if any of the registered outputs accepts messages of the given
+    // group and type; does not account for STRIP_DEBUG_LOG, see IsEnabled
+    bool IsOutputEnabled(MessageGroupHandle group_id, MessageType mt);
+    // Tells if the message of the given group and type will be printed
+    inline bool IsEnabled(MessageGroupHandle group_id, MessageType mt)
+    {
+#if STRIP_DEBUG_LOG
+        if (mt >= kDbgMsg_Debug)
+            return false;
+#endif
+        return IsOutputEnabled(group_id, mt);
+    }
+
 }   // namespace Debug
 
+// Prints formatted message of given group and type, only evaluating
+// the arguments if the message is going to be printed
+#define DEBUG_PRINTF(group_id, mt, ...) \
+    do { \
+        if (AGS::Common::Debug::IsEnabled(group_id, mt)) \
+            AGS::Common::Debug::Printf(group_id, mt, __VA_ARGS__); \
+    } while (0)
+
 }   // namespace Common
 }   // namespace AGS
 
@@ -110,6 +110,12 @@ public:
     virtual void GetFontMetrics(int fontNumber, FontMetrics *metrics) = 0;
     // Perform any necessary adjustments when the AA mode is toggled
     virtual void AdjustFontForAntiAlias(int fontNumber, bool aa_mode) = 0;
+    // Draws the automatic outline of the text, which surrounds the text drawn
+    // at the same position by the given thickness; the rounded outline has
+    // its corners rounded, otherwise it's squared. Returns false if this is
+    // not supported by the renderer.
+    virtual bool RenderTextOutline(const char *text, int fontNumber, BITMAP *destination,
+        int x, int y, int colour, int thickness, bool rounded) = 0;
 
 protected:
     IAGSFontRendererInternal() = default;
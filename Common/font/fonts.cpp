@@ -24,6 +24,7 @@
 #include "gfx/bitmap.h"
 #include "gui/guidefines.h" // MAXLINE
 #include "util/path.h"
+#include "util/resourcecache.h"
 #include "util/string_utils.h"
 #include "util/utf8.h"
 
@@ -50,6 +51,9 @@ struct Font
     FontMetrics         Metrics;
     // Precalculated linespacing, based on font properties and compat settings
     int                 LineSpacingCalc = 0;
+    // The font is registered, but not loaded from disk yet;
+    // it will be loaded with the stored Info on the first use
+    bool                Deferred = false;
 
     // Outline buffers
     Bitmap TextStencil, TextStencilSub;
@@ -64,6 +68,101 @@ struct Font
 static std::vector<Font> fonts;
 static std::unique_ptr<TTFFontRenderer> ttfRenderer;
 static std::unique_ptr<WFNFontRenderer> wfnRenderer;
+static FontLoadCallback font_load_callback = nullptr;
+
+// Loads the font if it was deferred until the first use;
+// returns whether the font number is valid
+static bool ensure_font_loaded(size_t fontNumber)
+{
+    if (fontNumber >= fonts.size())
+        return false;
+    if (fonts[fontNumber].Deferred)
+    {
+        fonts[fontNumber].Deferred = false;
+        const FontInfo finfo = fonts[fontNumber].Info;
+        if (!load_font_size(fontNumber, finfo))
+        {
+            Debug::Printf(kDbgMsg_Error, "Unable to load font %d, no renderer could load a matching file", fontNumber);
+            return true;
+        }
+        if (font_load_callback)
+            font_load_callback(fontNumber);
+    }
+    return true;
+}
+
+// Text measurement cache: keeps the results of the text width calculation
+// and line splitting, as the GUI labels, overlays and speech request these
+// for the same texts over and over again. The items are keyed by a hash of
+// the text and parameters, and store the parameters for the exact check.
+struct TextCacheItem
+{
+    String Text;
+    size_t Font = 0u;
+    int    Width = 0; // measured width, or the width limit for the split lines
+    size_t MaxLines = 0u;
+    bool   IsSplit = false;
+    std::vector<String> Lines;
+};
+
+class TextCache : public ResourceCache<uint64_t, TextCacheItem>
+{
+public:
+    TextCache(size_t max_size) : ResourceCache(max_size) {}
+
+private:
+    size_t CalcSize(const TextCacheItem &item) override
+    {
+        size_t size = sizeof(TextCacheItem) + item.Text.GetLength();
+        for (const auto &line : item.Lines)
+            size += sizeof(String) + line.GetLength();
+        return size;
+    }
+};
+
+static const size_t TextCacheMaxSize = 256 * 1024;
+static TextCache text_cache(TextCacheMaxSize);
+
+// Tells if the text measurements made with this font may be cached;
+// the bitmap fonts are measured faster than looked up, and the plugin
+// renderers are not guaranteed to give the same results each time
+static bool can_cache_text_measure(size_t fontNumber)
+{
+    return ensure_font_loaded(fontNumber) && fonts[fontNumber].RendererInt &&
+        !fonts[fontNumber].RendererInt->IsBitmapFont();
+}
+
+static uint64_t text_cache_hash(const char *text, size_t fontNumber, int width, size_t max_lines, bool is_split)
+{
+    // 64-bit FNV-1a over the text, followed by the parameters
+    uint64_t hash = 14695981039346656037ULL;
+    const uint64_t prime = 1099511628211ULL;
+    for (; *text; ++text)
+        hash = (hash ^ static_cast<uint8_t>(*text)) * prime;
+    const uint64_t params[] = { fontNumber, static_cast<uint32_t>(width), max_lines, is_split };
+    for (const uint64_t p : params)
+        hash = (hash ^ p) * prime;
+    return hash;
+}
+
+// Finds the cached measurement matching all the parameters, or returns null
+static const TextCacheItem *text_cache_find(uint64_t key, const char *text, size_t fontNumber,
+    int width, size_t max_lines, bool is_split)
+{
+    const TextCacheItem &item = text_cache.Get(key);
+    if (item.Text.IsEmpty() || (item.IsSplit != is_split) || (item.Font != fontNumber) ||
+        (is_split && ((item.Width != width) || (item.MaxLines != max_lines))) ||
+        (item.Text.Compare(text) != 0))
+        return nullptr;
+    return &item;
+}
+
+// Drops all the cached measurements; must be called whenever a font,
+// or any of its properties that affect the text layout, change
+static void text_cache_clear()
+{
+    text_cache.Clear();
+}
 
 
 FontInfo::FontInfo()
@@ -94,19 +193,19 @@ void shutdown_font_renderer()
 
 void adjust_y_coordinate_for_text(int* ypos, size_t fontnum)
 {
-  if (fontnum >= fonts.size() || !fonts[fontnum].Renderer)
+  if (!ensure_font_loaded(fontnum) || !fonts[fontnum].Renderer)
     return;
   fonts[fontnum].Renderer->AdjustYCoordinateForFont(ypos, fontnum);
 }
 
 bool font_first_renderer_loaded()
 {
-  return fonts.size() > 0 && fonts[0].Renderer != nullptr;
+  return ensure_font_loaded(0) && fonts[0].Renderer != nullptr;
 }
 
 bool is_font_loaded(size_t fontNumber)
 {
-    return fontNumber < fonts.size() && fonts[fontNumber].Renderer != nullptr;
+    return ensure_font_loaded(fontNumber) && fonts[fontNumber].Renderer != nullptr;
 }
 
 // Finish font's initialization
@@ -168,6 +267,7 @@ static void font_post_init(size_t fontNumber)
 static void font_replace_renderer(size_t fontNumber,
     IAGSFontRenderer* renderer, IAGSFontRenderer2* renderer2)
 {
+    text_cache_clear();
     fonts[fontNumber].Renderer = renderer;
     fonts[fontNumber].Renderer2 = renderer2;
     // If this is one of our built-in font renderers, then correctly
@@ -188,7 +288,7 @@ static void font_replace_renderer(size_t fontNumber,
 
 IAGSFontRenderer* font_replace_renderer(size_t fontNumber, IAGSFontRenderer* renderer)
 {
-    if (fontNumber >= fonts.size())
+    if (!ensure_font_loaded(fontNumber))
         return nullptr;
     IAGSFontRenderer* old_render = fonts[fontNumber].Renderer;
     font_replace_renderer(fontNumber, renderer, nullptr);
@@ -197,7 +297,7 @@ IAGSFontRenderer* font_replace_renderer(size_t fontNumber, IAGSFontRenderer* ren
 
 IAGSFontRenderer* font_replace_renderer(size_t fontNumber, IAGSFontRenderer2* renderer)
 {
-    if (fontNumber >= fonts.size())
+    if (!ensure_font_loaded(fontNumber))
         return nullptr;
     IAGSFontRenderer* old_render = fonts[fontNumber].Renderer;
     font_replace_renderer(fontNumber, renderer, renderer);
@@ -206,7 +306,7 @@ IAGSFontRenderer* font_replace_renderer(size_t fontNumber, IAGSFontRenderer2* re
 
 void font_recalc_metrics(size_t fontNumber)
 {
-    if (fontNumber >= fonts.size())
+    if (!ensure_font_loaded(fontNumber))
         return;
     fonts[fontNumber].Metrics = FontMetrics();
     font_post_init(fontNumber);
@@ -214,21 +314,21 @@ void font_recalc_metrics(size_t fontNumber)
 
 bool is_bitmap_font(size_t fontNumber)
 {
-    if (fontNumber >= fonts.size() || !fonts[fontNumber].RendererInt)
+    if (!ensure_font_loaded(fontNumber) || !fonts[fontNumber].RendererInt)
         return false;
     return fonts[fontNumber].RendererInt->IsBitmapFont();
 }
 
 bool font_supports_extended_characters(size_t fontNumber)
 {
-  if (fontNumber >= fonts.size() || !fonts[fontNumber].Renderer)
+  if (!ensure_font_loaded(fontNumber) || !fonts[fontNumber].Renderer)
     return false;
   return fonts[fontNumber].Renderer->SupportsExtendedCharacters(fontNumber);
 }
 
 const char *get_font_name(size_t fontNumber)
 {
-  if (fontNumber >= fonts.size() || !fonts[fontNumber].Renderer2)
+  if (!ensure_font_loaded(fontNumber) || !fonts[fontNumber].Renderer2)
     return "";
   const char *name = fonts[fontNumber].Renderer2->GetFontName(fontNumber);
   return name ? name : "";
@@ -236,42 +336,55 @@ const char *get_font_name(size_t fontNumber)
 
 int get_font_flags(size_t fontNumber)
 {
-    if (fontNumber >= fonts.size())
+    if (!ensure_font_loaded(fontNumber))
         return 0;
     return fonts[fontNumber].Info.Flags;
 }
 
 void ensure_text_valid_for_font(char *text, size_t fontnum)
 {
-  if (fontnum >= fonts.size() || !fonts[fontnum].Renderer)
+  if (!ensure_font_loaded(fontnum) || !fonts[fontnum].Renderer)
     return;
   fonts[fontnum].Renderer->EnsureTextValidForFont(text, fontnum);
 }
 
 int get_font_scaling_mul(size_t fontNumber)
 {
-    if (fontNumber >= fonts.size() || !fonts[fontNumber].Renderer)
+    if (!ensure_font_loaded(fontNumber) || !fonts[fontNumber].Renderer)
         return 0;
     return fonts[fontNumber].Info.SizeMultiplier;
 }
 
 int get_text_width(const char *texx, size_t fontNumber)
 {
-  if (fontNumber >= fonts.size() || !fonts[fontNumber].Renderer)
+  if (!ensure_font_loaded(fontNumber) || !fonts[fontNumber].Renderer)
     return 0;
-  return fonts[fontNumber].Renderer->GetTextWidth(texx, fontNumber);
+  if (!texx[0] || !can_cache_text_measure(fontNumber))
+    return fonts[fontNumber].Renderer->GetTextWidth(texx, fontNumber);
+
+  const uint64_t key = text_cache_hash(texx, fontNumber, 0, 0u, false);
+  const TextCacheItem *cached = text_cache_find(key, texx, fontNumber, 0, 0u, false);
+  if (cached)
+    return cached->Width;
+  TextCacheItem item;
+  item.Text = texx;
+  item.Font = fontNumber;
+  item.Width = fonts[fontNumber].Renderer->GetTextWidth(texx, fontNumber);
+  const int width = item.Width;
+  text_cache.Put(key, std::move(item));
+  return width;
 }
 
 int get_text_width_outlined(const char *text, size_t font_number)
 {
-    if (font_number >= fonts.size() || !fonts[font_number].Renderer)
+    if (!ensure_font_loaded(font_number) || !fonts[font_number].Renderer)
         return 0;
     if(text == nullptr || text[0] == 0) // we ignore outline width since the text is empty
         return 0;
 
     int self_width = fonts[font_number].Renderer->GetTextWidth(text, font_number);
     int outline = fonts[font_number].Info.Outline;
-    if (outline < 0 || static_cast<size_t>(outline) > fonts.size())
+    if (outline < 0 || !ensure_font_loaded(outline))
     { // FONT_OUTLINE_AUTO or FONT_OUTLINE_NONE
         return self_width + 2 * fonts[font_number].Info.AutoOutlineThickness;
     }
@@ -281,14 +394,14 @@ int get_text_width_outlined(const char *text, size_t font_number)
 
 int get_font_outline(size_t font_number)
 {
-    if (font_number >= fonts.size())
+    if (!ensure_font_loaded(font_number))
         return FONT_OUTLINE_NONE;
     return fonts[font_number].Info.Outline;
 }
 
 int get_font_outline_thickness(size_t font_number)
 {
-    if (font_number >= fonts.size())
+    if (!ensure_font_loaded(font_number))
         return 0;
     return fonts[font_number].Info.AutoOutlineThickness;
 }
@@ -296,34 +409,35 @@ int get_font_outline_thickness(size_t font_number)
 void set_font_outline(size_t font_number, int outline_type,
     enum FontInfo::AutoOutlineStyle style, int thickness)
 {
-    if (font_number >= fonts.size())
+    if (!ensure_font_loaded(font_number))
         return;
     fonts[font_number].Info.Outline = outline_type;
     fonts[font_number].Info.AutoOutlineStyle = style;
     fonts[font_number].Info.AutoOutlineThickness = thickness;
+    text_cache_clear();
 }
 
 bool is_font_antialiased(size_t font_number)
 {
-    if (font_number >= fonts.size())
+    if (!ensure_font_loaded(font_number))
         return false;
     return ShouldAntiAliasText() && !is_bitmap_font(font_number);
 }
 
 int get_font_height(size_t fontNumber)
 {
-    if (fontNumber >= fonts.size() || !fonts[fontNumber].Renderer)
+    if (!ensure_font_loaded(fontNumber) || !fonts[fontNumber].Renderer)
         return 0;
     return fonts[fontNumber].Metrics.CompatHeight;
 }
 
 int get_font_height_outlined(size_t fontNumber)
 {
-    if (fontNumber >= fonts.size() || !fonts[fontNumber].Renderer)
+    if (!ensure_font_loaded(fontNumber) || !fonts[fontNumber].Renderer)
         return 0;
     int self_height = fonts[fontNumber].Metrics.CompatHeight;
     int outline = fonts[fontNumber].Info.Outline;
-    if (outline < 0 || static_cast<size_t>(outline) > fonts.size())
+    if (outline < 0 || !ensure_font_loaded(outline))
     { // FONT_OUTLINE_AUTO or FONT_OUTLINE_NONE
         return self_height + 2 * fonts[fontNumber].Info.AutoOutlineThickness;
     }
@@ -333,28 +447,28 @@ int get_font_height_outlined(size_t fontNumber)
 
 int get_font_surface_height(size_t fontNumber)
 {
-    if (fontNumber >= fonts.size() || !fonts[fontNumber].Renderer)
+    if (!ensure_font_loaded(fontNumber) || !fonts[fontNumber].Renderer)
         return 0;
     return fonts[fontNumber].Metrics.ExtentHeight();
 }
 
 std::pair<int, int> get_font_surface_extent(size_t fontNumber)
 {
-    if (fontNumber >= fonts.size() || !fonts[fontNumber].Renderer)
+    if (!ensure_font_loaded(fontNumber) || !fonts[fontNumber].Renderer)
         return std::make_pair(0, 0);
     return fonts[fontNumber].Metrics.VExtent;
 }
 
 int get_font_linespacing(size_t fontNumber)
 {
-    if (fontNumber >= fonts.size())
+    if (!ensure_font_loaded(fontNumber))
         return 0;
     return fonts[fontNumber].LineSpacingCalc;
 }
 
 void set_font_linespacing(size_t fontNumber, int spacing)
 {
-    if (fontNumber < fonts.size())
+    if (ensure_font_loaded(fontNumber))
     {
         fonts[fontNumber].Info.Flags &= ~FFLG_DEFLINESPACING;
         fonts[fontNumber].Info.LineSpacing = spacing;
@@ -364,7 +478,7 @@ void set_font_linespacing(size_t fontNumber, int spacing)
 
 int get_text_lines_height(size_t fontNumber, size_t numlines)
 {
-    if (fontNumber >= fonts.size() || numlines == 0)
+    if (!ensure_font_loaded(fontNumber) || numlines == 0)
         return 0;
     return fonts[fontNumber].LineSpacingCalc * (numlines - 1) +
         (fonts[fontNumber].Metrics.CompatHeight +
@@ -373,7 +487,7 @@ int get_text_lines_height(size_t fontNumber, size_t numlines)
 
 int get_text_lines_surf_height(size_t fontNumber, size_t numlines)
 {
-    if (fontNumber >= fonts.size() || numlines == 0)
+    if (!ensure_font_loaded(fontNumber) || numlines == 0)
         return 0;
     return fonts[fontNumber].LineSpacingCalc * (numlines - 1) +
         (fonts[fontNumber].Metrics.RealHeight +
@@ -417,7 +531,7 @@ static void unescape_script_string(const char *cstr, std::string &out)
 }
 
 // Break up the text into lines
-size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, size_t max_lines) {
+static size_t split_lines_impl(const char *todis, SplitLines &lines, int wii, int fonnt, size_t max_lines) {
     // NOTE: following hack accomodates for the legacy math mistake in split_lines.
     // It's hard to tell how cruicial it is for the game looks, so research may be needed.
     // TODO: IMHO this should rely not on game format, but script API level, because it
@@ -510,9 +624,40 @@ size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, siz
     return lines.Count();
 }
 
+size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, size_t max_lines)
+{
+    // The result depends on the widths of both the font and its outline font
+    const int outline = get_font_outline(fonnt);
+    if (!todis[0] || !can_cache_text_measure(fonnt) ||
+        ((outline >= 0) && !can_cache_text_measure(outline)))
+        return split_lines_impl(todis, lines, wii, fonnt, max_lines);
+
+    const uint64_t key = text_cache_hash(todis, fonnt, wii, max_lines, true);
+    const TextCacheItem *cached = text_cache_find(key, todis, fonnt, wii, max_lines, true);
+    if (cached)
+    {
+        lines.Reset();
+        for (const auto &line : cached->Lines)
+            lines.Add(line.GetCStr());
+        return lines.Count();
+    }
+
+    split_lines_impl(todis, lines, wii, fonnt, max_lines);
+    TextCacheItem item;
+    item.Text = todis;
+    item.Font = fonnt;
+    item.Width = wii;
+    item.MaxLines = max_lines;
+    item.IsSplit = true;
+    for (size_t i = 0; i < lines.Count(); ++i)
+        item.Lines.push_back(lines[i]);
+    text_cache.Put(key, std::move(item));
+    return lines.Count();
+}
+
 void wouttextxy(Bitmap *ds, int xxx, int yyy, size_t fontNumber, color_t text_color, const char *texx)
 {
-  if (fontNumber >= fonts.size())
+  if (!ensure_font_loaded(fontNumber))
     return;
   yyy += fonts[fontNumber].Info.YOffset;
   if (yyy > ds->GetClip().Bottom)
@@ -524,18 +669,31 @@ void wouttextxy(Bitmap *ds, int xxx, int yyy, size_t fontNumber, color_t text_co
   }
 }
 
+bool wouttextxy_outline(Bitmap *ds, int xxx, int yyy, size_t fontNumber, color_t outline_color, const char *texx)
+{
+  if (!ensure_font_loaded(fontNumber))
+    return false;
+  const Font &font = fonts[fontNumber];
+  if (!font.RendererInt || (font.Info.AutoOutlineThickness <= 0))
+    return false;
+  yyy += font.Info.YOffset;
+  return font.RendererInt->RenderTextOutline(texx, fontNumber, (BITMAP*)ds->GetAllegroBitmap(),
+    xxx, yyy, outline_color, font.Info.AutoOutlineThickness, font.Info.AutoOutlineStyle == FontInfo::kRounded);
+}
+
 void set_fontinfo(size_t fontNumber, const FontInfo &finfo)
 {
-    if (fontNumber < fonts.size() && fonts[fontNumber].Renderer)
+    if (ensure_font_loaded(fontNumber) && fonts[fontNumber].Renderer)
     {
         fonts[fontNumber].Info = finfo;
         font_post_init(fontNumber);
+        text_cache_clear();
     }
 }
 
 FontInfo get_fontinfo(size_t font_number)
 {
-    if (font_number < fonts.size())
+    if (ensure_font_loaded(font_number))
         return fonts[font_number].Info;
     return FontInfo();
 }
@@ -543,6 +701,7 @@ FontInfo get_fontinfo(size_t font_number)
 // Loads a font from disk
 bool load_font_size(size_t fontNumber, const FontInfo &font_info)
 {
+  text_cache_clear();
   if (fonts.size() <= fontNumber)
     fonts.resize(fontNumber + 1);
   else
@@ -580,6 +739,22 @@ bool load_font_size(size_t fontNumber, const FontInfo &font_info)
   return true;
 }
 
+void register_font_deferred(size_t fontNumber, const FontInfo &font_info)
+{
+    text_cache_clear();
+    if (fonts.size() <= fontNumber)
+        fonts.resize(fontNumber + 1);
+    else
+        wfreefont(fontNumber);
+    fonts[fontNumber].Info = font_info;
+    fonts[fontNumber].Deferred = true;
+}
+
+void set_font_load_callback(FontLoadCallback callback)
+{
+    font_load_callback = callback;
+}
+
 bool load_font_metrics(const AGS::Common::String &filename, int pixel_size, FontMetrics &metrics)
 {
     const String ext = Path::GetFileExtension(filename);
@@ -612,7 +787,7 @@ void alloc_font_outline_buffers(size_t font_number,
     Bitmap **text_stencil, Bitmap **outline_stencil,
     int text_width, int text_height, int color_depth)
 {
-    if (font_number >= fonts.size())
+    if (!ensure_font_loaded(font_number))
         return;
     Font &f = fonts[font_number];
     const int thick = 2 * f.Info.AutoOutlineThickness;
@@ -639,6 +814,7 @@ void alloc_font_outline_buffers(size_t font_number,
 
 void adjust_fonts_for_render_mode(bool aa_mode)
 {
+    text_cache_clear();
     for (size_t i = 0; i < fonts.size(); ++i)
     {
         if (fonts[i].RendererInt)
@@ -651,6 +827,8 @@ void wfreefont(size_t fontNumber)
   if (fontNumber >= fonts.size())
     return;
 
+  text_cache_clear();
+
   fonts[fontNumber].TextStencilSub.Destroy();
   fonts[fontNumber].OutlineStencilSub.Destroy();
   fonts[fontNumber].TextStencil.Destroy();
@@ -659,10 +837,12 @@ void wfreefont(size_t fontNumber)
     fonts[fontNumber].Renderer->FreeMemory(fontNumber);
 
   fonts[fontNumber].Renderer = nullptr;
+  fonts[fontNumber].Deferred = false;
 }
 
 void free_all_fonts()
 {
+    text_cache_clear();
     for (size_t i = 0; i < fonts.size(); ++i)
     {
         if (fonts[i].Renderer != nullptr)
@@ -91,12 +91,24 @@ void set_font_outline(size_t font_number, int outline_type,
 bool is_font_antialiased(size_t font_number);
 // Outputs a single line of text on the defined position on bitmap, using defined font, color and parameters
 void wouttextxy(AGS::Common::Bitmap *ds, int xxx, int yyy, size_t fontNumber, color_t text_color, const char *texx);
+// Outputs the automatic outline of a single line of text, which surrounds the text
+// drawn at the same position, using the outline glyphs cached by the font renderer.
+// Returns false if the font's renderer does not support this, in which case
+// the outline should be produced by the caller.
+bool wouttextxy_outline(AGS::Common::Bitmap *ds, int xxx, int yyy, size_t fontNumber, color_t outline_color, const char *texx);
 // Assigns FontInfo to the font
 void set_fontinfo(size_t fontNumber, const FontInfo &finfo);
 // Gets full information about the font
 FontInfo get_fontinfo(size_t font_number);
 // Loads a font from disk
 bool load_font_size(size_t fontNumber, const FontInfo &font_info);
+// Registers a font to be loaded from disk on its first use; any query of
+// the font's properties or metrics, or text drawing, loads it
+void register_font_deferred(size_t fontNumber, const FontInfo &font_info);
+// Sets a function to call right after a deferred font was loaded,
+// which lets the engine apply its fixups to the font
+typedef void (*FontLoadCallback)(size_t fontNumber);
+void set_font_load_callback(FontLoadCallback callback);
 // Loads a font from disk, reads metrics, and disposes a font
 bool load_font_metrics(const AGS::Common::String &filename, int pixel_size, FontMetrics &metrics);
 void wgtprintf(AGS::Common::Bitmap *ds, int xxx, int yyy, size_t fontNumber, color_t text_color, char *fmt, ...);
@@ -0,0 +1,127 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "font/glyphatlas.h"
+#include <algorithm>
+
+namespace AGS
+{
+namespace Common
+{
+
+GlyphAtlas::GlyphAtlas(const Size &page_size)
+    : _packer(page_size)
+{
+}
+
+const GlyphAtlas::Glyph *GlyphAtlas::Find(uint32_t code) const
+{
+    const auto found = _glyphs.find(code);
+    return found != _glyphs.end() ? &found->second : nullptr;
+}
+
+const GlyphAtlas::Glyph &GlyphAtlas::Add(uint32_t code, const Size &size)
+{
+    Glyph &glyph = _glyphs[code];
+    glyph = Glyph();
+    if (size.IsNull())
+        return glyph;
+
+    const PackedRect packed = _packer.Add(size);
+    if (packed.Page >= 0)
+    {
+        if (static_cast<size_t>(packed.Page) >= _pages.size())
+        {
+            const Size &page_size = _packer.GetPageSize();
+            _pages.emplace_back(BitmapHelper::CreateClearBitmap(page_size.Width, page_size.Height, 8));
+        }
+        glyph.Page = _pages[packed.Page].get();
+        glyph.Place = packed.Place;
+    }
+    else
+    {
+        // Too large for the common pages
+        _largePages.emplace_back(BitmapHelper::CreateClearBitmap(size.Width, size.Height, 8));
+        glyph.Page = _largePages.back().get();
+        glyph.Place = RectWH(size);
+    }
+    return glyph;
+}
+
+void GlyphAtlas::Clear()
+{
+    _glyphs.clear();
+    _pages.clear();
+    _largePages.clear();
+    _packer.Clear();
+}
+
+template <typename TPixel>
+static void DrawMask(const Bitmap *page, int sx, int sy, Bitmap *ds, int dx, int dy,
+    int width, int height, TPixel color)
+{
+    for (int y = 0; y < height; ++y)
+    {
+        const uint8_t *src = page->GetScanLine(sy + y) + sx;
+        TPixel *dst = reinterpret_cast<TPixel*>(ds->GetScanLineForWriting(dy + y)) + dx;
+        for (int x = 0; x < width; ++x)
+        {
+            if (src[x])
+                dst[x] = color;
+        }
+    }
+}
+
+static void DrawMask24(const Bitmap *page, int sx, int sy, Bitmap *ds, int dx, int dy,
+    int width, int height, color_t color)
+{
+    // Same byte order as the Allegro's 24-bit pixel writing
+    const uint8_t c0 = color & 0xFF, c1 = (color >> 8) & 0xFF, c2 = (color >> 16) & 0xFF;
+    for (int y = 0; y < height; ++y)
+    {
+        const uint8_t *src = page->GetScanLine(sy + y) + sx;
+        uint8_t *dst = ds->GetScanLineForWriting(dy + y) + dx * 3;
+        for (int x = 0; x < width; ++x, dst += 3)
+        {
+            if (src[x])
+            {
+                dst[0] = c0; dst[1] = c1; dst[2] = c2;
+            }
+        }
+    }
+}
+
+void GlyphAtlas::Draw(const Glyph &glyph, Bitmap *ds, int x, int y, const Rect &clip, color_t color)
+{
+    if (!glyph.Page)
+        return;
+    const Rect dst_rc = IntersectRects(IntersectRects(
+        RectWH(x, y, glyph.Place.GetWidth(), glyph.Place.GetHeight()), clip), RectWH(ds->GetSize()));
+    if (dst_rc.IsEmpty())
+        return;
+
+    const int sx = glyph.Place.Left + (dst_rc.Left - x);
+    const int sy = glyph.Place.Top + (dst_rc.Top - y);
+    const int w = dst_rc.GetWidth(), h = dst_rc.GetHeight();
+    switch (ds->GetBPP())
+    {
+    case 1: DrawMask<uint8_t>(glyph.Page, sx, sy, ds, dst_rc.Left, dst_rc.Top, w, h, static_cast<uint8_t>(color)); break;
+    case 2: DrawMask<uint16_t>(glyph.Page, sx, sy, ds, dst_rc.Left, dst_rc.Top, w, h, static_cast<uint16_t>(color)); break;
+    case 3: DrawMask24(glyph.Page, sx, sy, ds, dst_rc.Left, dst_rc.Top, w, h, color); break;
+    case 4: DrawMask<uint32_t>(glyph.Page, sx, sy, ds, dst_rc.Left, dst_rc.Top, w, h, static_cast<uint32_t>(color)); break;
+    default: break;
+    }
+}
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,77 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// GlyphAtlas keeps the rasterized glyphs of a font, so that each glyph is
+// only rasterized once, and then drawn by copying its pixels. The glyphs
+// are stored as 8-bit masks (0 is an empty pixel), packed on the atlas
+// pages; a glyph larger than a page gets a page of its own.
+//
+//=============================================================================
+#ifndef __AGS_CN_FONT__GLYPHATLAS_H
+#define __AGS_CN_FONT__GLYPHATLAS_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "gfx/bitmap.h"
+#include "util/rectpacker.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class GlyphAtlas
+{
+public:
+    // Location of the glyph's mask in the atlas
+    struct Glyph
+    {
+        Bitmap *Page = nullptr; // null for the empty glyphs
+        Rect    Place;          // position on the page
+    };
+
+    GlyphAtlas(const Size &page_size = Size(DefaultPageSize, DefaultPageSize));
+
+    // Gets the number of cached glyphs
+    size_t GetGlyphCount() const { return _glyphs.size(); }
+    // Gets the total number of pages, including the ones for large glyphs
+    size_t GetPageCount() const { return _pages.size() + _largePages.size(); }
+
+    // Finds the cached glyph, returns null if there's none
+    const Glyph *Find(uint32_t code) const;
+    // Allocates the cleared mask for the glyph of the given size; the caller
+    // should rasterize the glyph into the returned place right after.
+    // A glyph with zero size is also cached, but has no mask.
+    const Glyph &Add(uint32_t code, const Size &size);
+    // Removes all the glyphs
+    void Clear();
+
+    // Draws the glyph's mask with a solid color, so that its top-left corner
+    // is at (x, y); the drawing is restricted by the clip rect.
+    static void Draw(const Glyph &glyph, Bitmap *ds, int x, int y, const Rect &clip, color_t color);
+
+private:
+    static const int DefaultPageSize = 256;
+
+    RectPacker _packer;
+    std::vector<std::unique_ptr<Bitmap>> _pages;
+    std::vector<std::unique_ptr<Bitmap>> _largePages;
+    std::unordered_map<uint32_t, Glyph> _glyphs;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_FONT__GLYPHATLAS_H
@@ -46,6 +46,8 @@ public:
       const FontRenderParams *params, FontMetrics *metrics) override;
   void GetFontMetrics(int fontNumber, FontMetrics *metrics) override;
   void AdjustFontForAntiAlias(int fontNumber, bool aa_mode) override;
+  bool RenderTextOutline(const char * /*text*/, int /*fontNumber*/, BITMAP * /*destination*/,
+      int /*x*/, int /*y*/, int /*colour*/, int /*thickness*/, bool /*rounded*/) override { return false; }
 
   TTFFontRenderer(AGS::Common::AssetManager *amgr);
   virtual ~TTFFontRenderer();
@@ -13,6 +13,7 @@
 //=============================================================================
 #include "font/wfnfontrenderer.h"
 #include <algorithm>
+#include <cstring>
 #include "ac/common.h" // our_eip
 #include "core/assetmanager.h"
 #include "debug/out.h"
@@ -59,57 +60,132 @@ int WFNFontRenderer::GetTextHeight(const char *text, int fontNumber)
     return max_height * params.SizeMultiplier;
 }
 
-static int RenderChar(Bitmap *ds, const int at_x, const int at_y, Rect clip,
-    const WFNChar &wfn_char, const int scale, const color_t text_color);
+static const GlyphAtlas::Glyph &RasterizeGlyph(GlyphAtlas &atlas, int code,
+    const WFNChar &wfn_char, const int scale);
 
 void WFNFontRenderer::RenderText(const char *text, int fontNumber, BITMAP *destination, int x, int y, int colour)
 {
   int oldeip = get_our_eip();
   set_our_eip(415);
 
-  const WFNFont* font = _fontData[fontNumber].Font;
-  const FontRenderParams &params = _fontData[fontNumber].Params;
+  FontData &font_data = _fontData[fontNumber];
+  const WFNFont* font = font_data.Font;
+  const int scale = font_data.Params.SizeMultiplier;
   Bitmap ds(destination, true);
 
-  // NOTE: allegro's putpixel ignores clipping (optimization),
-  // so we'll have to accomodate for that ourselves
+  // NOTE: glyphs are copied directly to the bitmap's memory,
+  // so we'll have to accomodate for the clipping ourselves
   Rect clip = ds.GetClip();
   for (int code = ugetxc(&text); code; code = ugetxc(&text))
-    x += RenderChar(&ds, x, y, clip, font->GetChar(code), params.SizeMultiplier, colour);
+  {
+    const WFNChar &wfn_char = font->GetChar(code);
+    const GlyphAtlas::Glyph *glyph = font_data.Glyphs.Find(code);
+    if (!glyph)
+      glyph = &RasterizeGlyph(font_data.Glyphs, code, wfn_char, scale);
+    GlyphAtlas::Draw(*glyph, &ds, x, y, clip, colour);
+    x += wfn_char.Width * scale;
+  }
 
   set_our_eip(oldeip);
 }
 
-static int RenderChar(Bitmap *ds, const int at_x, const int at_y, Rect clip,
-    const WFNChar &wfn_char, const int scale, const color_t text_color)
+// Rasterizes the WFN character into the atlas, at the given scale
+static const GlyphAtlas::Glyph &RasterizeGlyph(GlyphAtlas &atlas, int code,
+    const WFNChar &wfn_char, const int scale)
 {
+  const GlyphAtlas::Glyph &glyph = atlas.Add(code, Size(wfn_char.Width * scale, wfn_char.Height * scale));
+  if (!glyph.Page)
+    return glyph;
+
   const int width = wfn_char.Width;
   const int height = wfn_char.Height;
   const unsigned char *actdata = wfn_char.Data;
   const int bytewid = wfn_char.GetRowByteCount();
+  for (int h = 0; h < height; ++h)
+  {
+    for (int sy = 0; sy < scale; ++sy)
+    {
+      uint8_t *row = glyph.Page->GetScanLineForWriting(glyph.Place.Top + h * scale + sy) + glyph.Place.Left;
+      for (int w = 0; w < width; ++w)
+      {
+        if (((actdata[h * bytewid + (w / 8)] & (0x80 >> (w % 8))) != 0))
+          memset(row + w * scale, 0xFF, scale);
+      }
+    }
+  }
+  return glyph;
+}
+
+// Rasterizes the outline of the glyph into the atlas, by spreading each pixel
+// of the glyph by the kernel offsets; the outline's origin is offset by
+// the thickness to the left and up from the glyph's origin
+static const GlyphAtlas::Glyph &RasterizeOutlineGlyph(GlyphAtlas &atlas, int code,
+    const GlyphAtlas::Glyph &glyph, int thickness, const std::vector<std::pair<int, int>> &kernel)
+{
+  if (!glyph.Page)
+    return atlas.Add(code, Size());
+
+  const GlyphAtlas::Glyph &outline = atlas.Add(code,
+      Size(glyph.Place.GetWidth() + 2 * thickness, glyph.Place.GetHeight() + 2 * thickness));
+  for (int h = 0; h < glyph.Place.GetHeight(); ++h)
+  {
+    const uint8_t *src_row = glyph.Page->GetScanLine(glyph.Place.Top + h) + glyph.Place.Left;
+    for (int w = 0; w < glyph.Place.GetWidth(); ++w)
+    {
+      if (!src_row[w])
+        continue;
+      for (const auto &off : kernel)
+      {
+        outline.Page->GetScanLineForWriting(outline.Place.Top + h + thickness + off.second)
+          [outline.Place.Left + w + thickness + off.first] = 0xFF;
+      }
+    }
+  }
+  return outline;
+}
 
-  int sx = std::max(at_x, clip.Left), ex = clip.Right + 1;
-  int sy = std::max(at_y, clip.Top), ey = clip.Bottom + 1;
-  int sw = std::max(0, clip.Left - at_x);
-  int sh = std::max(0, clip.Top - at_y);
-  for (int h = sh, y = sy; h < height && y < ey; ++h, y += scale)
+bool WFNFontRenderer::RenderTextOutline(const char *text, int fontNumber, BITMAP *destination,
+    int x, int y, int colour, int thickness, bool rounded)
+{
+  FontData &font_data = _fontData[fontNumber];
+  if ((font_data.OutlineThickness != thickness) || (font_data.OutlineRounded != rounded))
   {
-    for (int w = sw, x = sx; w < width && x < ex; ++w, x += scale)
+    // The rounded outline only includes the offsets which fit in the circle
+    // of radius (thickness + 0.5), same as when the outline is made of
+    // the text drawn multiple times
+    font_data.OutlineGlyphs.Clear();
+    font_data.OutlineKernel.clear();
+    for (int dy = -thickness; dy <= thickness; ++dy)
     {
-      if (((actdata[h * bytewid + (w / 8)] & (0x80 >> (w % 8))) != 0))
+      for (int dx = -thickness; dx <= thickness; ++dx)
       {
-        if (scale > 1)
-        {
-          ds->FillRect(RectWH(x, y, scale, scale), text_color);
-        } 
-        else
-        {
-          ds->PutPixel(x, y, text_color);
-        }
+        if (!rounded || (dx * dx + dy * dy <= thickness * (thickness + 1)))
+          font_data.OutlineKernel.push_back(std::make_pair(dx, dy));
       }
     }
+    font_data.OutlineThickness = thickness;
+    font_data.OutlineRounded = rounded;
   }
-  return width * scale;
+
+  const WFNFont* font = font_data.Font;
+  const int scale = font_data.Params.SizeMultiplier;
+  Bitmap ds(destination, true);
+  Rect clip = ds.GetClip();
+  for (int code = ugetxc(&text); code; code = ugetxc(&text))
+  {
+    const WFNChar &wfn_char = font->GetChar(code);
+    const GlyphAtlas::Glyph *outline = font_data.OutlineGlyphs.Find(code);
+    if (!outline)
+    {
+      const GlyphAtlas::Glyph *glyph = font_data.Glyphs.Find(code);
+      if (!glyph)
+        glyph = &RasterizeGlyph(font_data.Glyphs, code, wfn_char, scale);
+      outline = &RasterizeOutlineGlyph(font_data.OutlineGlyphs, code, *glyph, thickness, font_data.OutlineKernel);
+    }
+    GlyphAtlas::Draw(*outline, &ds, x - thickness, y - thickness, clip, colour);
+    x += wfn_char.Width * scale;
+  }
+  return true;
 }
 
 bool WFNFontRenderer::LoadFromDisk(int fontNumber, int fontSize)
@@ -128,14 +204,14 @@ bool WFNFontRenderer::LoadFromDiskEx(int fontNumber, int /*fontSize*/,
   String file_name;
 
   file_name.Format("agsfnt%d.wfn", fontNumber);
-  auto ffi = _amgr->OpenAsset(file_name);
+  auto ffi = _amgr->OpenAsset(file_name, kAssetOpen_ReadWhole);
   if (ffi == nullptr)
   {
     // actual font not found, try font 0 instead
     // FIXME: this should not be done here in this font renderer implementation,
     // but somewhere outside, when whoever calls this method
     file_name = "agsfnt0.wfn";
-    ffi = _amgr->OpenAsset(file_name);
+    ffi = _amgr->OpenAsset(file_name, kAssetOpen_ReadWhole);
     if (ffi == nullptr)
       return false;
   }
@@ -151,6 +227,8 @@ bool WFNFontRenderer::LoadFromDiskEx(int fontNumber, int /*fontSize*/,
   }
   _fontData[fontNumber].Font = font;
   _fontData[fontNumber].Params = params ? *params : FontRenderParams();
+  _fontData[fontNumber].Glyphs.Clear();
+  _fontData[fontNumber].OutlineGlyphs.Clear();
   if (src_filename)
     *src_filename = file_name;
   if (metrics)
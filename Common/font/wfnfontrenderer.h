@@ -15,8 +15,10 @@
 #define __AC_WFNFONTRENDERER_H
 
 #include <map>
+#include <vector>
 #include "core/assetmanager.h"
 #include "font/agsfontrenderer.h"
+#include "font/glyphatlas.h"
 
 class WFNFont;
 
@@ -45,6 +47,8 @@ public:
       const FontRenderParams *params, FontMetrics *metrics) override;
   void GetFontMetrics(int fontNumber, FontMetrics *metrics) override { *metrics = FontMetrics(); }
   void AdjustFontForAntiAlias(int /*fontNumber*/, bool /*aa_mode*/) override { /* do nothing */}
+  bool RenderTextOutline(const char *text, int fontNumber, BITMAP *destination,
+      int x, int y, int colour, int thickness, bool rounded) override;
 
   WFNFontRenderer(AGS::Common::AssetManager *mgr)
       : _amgr(mgr) {}
@@ -55,6 +59,15 @@ private:
   {
     WFNFont         *Font;
     FontRenderParams Params;
+    // Glyphs rasterized at the font's scale, on the first use
+    AGS::Common::GlyphAtlas Glyphs;
+    // Outline glyphs, made by dilating the regular glyphs on the first use;
+    // these are recreated if the requested outline changes
+    AGS::Common::GlyphAtlas OutlineGlyphs;
+    int  OutlineThickness = 0;
+    bool OutlineRounded = false;
+    // Offsets by which each glyph pixel is spread in its outline
+    std::vector<std::pair<int, int>> OutlineKernel;
   };
   std::map<int, FontData> _fontData;
   AGS::Common::AssetManager *_amgr = nullptr;
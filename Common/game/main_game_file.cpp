@@ -207,11 +207,11 @@ HGameFileError OpenMainGameFileFromDefaultAsset(MainGameSource &src, AssetManage
     src = MainGameSource();
     // Try to find and open main game file
     String filename = MainGameSource::DefaultFilename_v3;
-    auto in = mgr->OpenAsset(filename);
+    auto in = mgr->OpenAsset(filename, kAssetOpen_ReadWhole);
     if (!in)
     {
         filename = MainGameSource::DefaultFilename_v2;
-        in = mgr->OpenAsset(filename);
+        in = mgr->OpenAsset(filename, kAssetOpen_ReadWhole);
     }
     if (!in)
         return new MainGameFileError(kMGFErr_FileOpenFailed, String::FromFormat("Tried filenames: %s, %s.",
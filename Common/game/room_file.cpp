@@ -11,6 +11,7 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <chrono>
 #include "ac/common.h" // update_polled_stuff
 #include "ac/common_defines.h"
 #include "ac/gamestructdefines.h"
@@ -53,7 +54,7 @@ HRoomFileError OpenRoomFileFromAsset(const String &filename, RoomDataSource &src
     // Cleanup source struct
     src = RoomDataSource();
     // Try to find and open room file
-    auto in = mgr->OpenAsset(filename);
+    auto in = mgr->OpenAsset(filename, kAssetOpen_ReadWhole);
     if (in == nullptr)
         return new RoomFileError(kRoomFileErr_FileOpenFailed, String::FromFormat("Filename: %s.", filename.GetCStr()));
     src.Filename = filename;
@@ -80,9 +81,16 @@ void WriteRoomObject(const RoomObjectInfo &obj, Stream *out)
     out->WriteInt16(obj.IsOn ? 1 : 0);
 }
 
+// Returns the time passed since the given moment, in microseconds
+static uint32_t GetElapsedUs(const std::chrono::steady_clock::time_point &since)
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - since).count());
+}
+
 
 // Main room data
-HError ReadMainBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver)
+HError ReadMainBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver, RoomLoadTimes *times)
 {
     int bpp;
     if (data_ver >= kRoomVersion_208)
@@ -316,6 +324,7 @@ HError ReadMainBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver)
     }
 
     // Primary background (LZW or RLE compressed depending on format)
+    const auto images_start = std::chrono::steady_clock::now();
     if (data_ver >= kRoomVersion_pre114_5)
         room->BgFrames[0].Graphic =
             load_lzw(in, room->BackgroundBPP, &room->Palette);
@@ -330,6 +339,8 @@ HError ReadMainBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver)
     room->WalkAreaMask = load_rle_bitmap8(in);
     room->WalkBehindMask = load_rle_bitmap8(in);
     room->HotspotMask = load_rle_bitmap8(in);
+    if (times)
+        times->Images += GetElapsedUs(images_start);
     return HError::None();
 }
 
@@ -404,10 +415,12 @@ HError ReadAnimBgBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver)
             room->BgFrames[i].IsPaletteShared = in->ReadInt8() != 0;
     }
 
+    // Secondary frames are kept compressed, and decoded on first use,
+    // see RoomStruct::DecodeBgFrame()
     for (size_t i = 1; i < room->BgFrameCount; ++i)
     {
-        room->BgFrames[i].Graphic =
-            load_lzw(in, room->BackgroundBPP, &room->BgFrames[i].Palette);
+        RoomBgFrame &frame = room->BgFrames[i];
+        read_lzw_data(in, &frame.Palette, frame.PackedData, frame.UnpackedSize);
     }
     return HError::None();
 }
@@ -432,7 +445,7 @@ HError ReadPropertiesBlock(RoomStruct *room, Stream *in, RoomFileVersion /*data_
 }
 
 HError ReadRoomBlock(RoomStruct *room, Stream *in, RoomFileBlock block, const String &ext_id,
-    soff_t block_len, RoomFileVersion data_ver)
+    soff_t block_len, RoomFileVersion data_ver, RoomLoadTimes *times)
 {
     //
     // First check classic block types, identified with a numeric id
@@ -440,7 +453,7 @@ HError ReadRoomBlock(RoomStruct *room, Stream *in, RoomFileBlock block, const St
     switch (block)
     {
     case kRoomFblk_Main:
-        return ReadMainBlock(room, in, data_ver);
+        return ReadMainBlock(room, in, data_ver, times);
     case kRoomFblk_Script:
         in->Seek(block_len); // no longer read source script text into RoomStruct
         return HError::None();
@@ -481,11 +494,13 @@ HError ReadRoomBlock(RoomStruct *room, Stream *in, RoomFileBlock block, const St
 class RoomBlockReader : public DataExtReader
 {
 public:
-    RoomBlockReader(RoomStruct *room, RoomFileVersion data_ver, std::unique_ptr<Stream> &&in)
+    RoomBlockReader(RoomStruct *room, RoomFileVersion data_ver, std::unique_ptr<Stream> &&in,
+            RoomLoadTimes *times = nullptr)
         : DataExtReader(std::move(in),
             kDataExt_NumID8 | ((data_ver < kRoomVersion_350) ? kDataExt_File32 : kDataExt_File64))
         , _room(room)
         , _dataVer(data_ver)
+        , _times(times)
     {}
 
     // Helper function that extracts legacy room script
@@ -508,18 +523,20 @@ private:
         soff_t block_len, bool &read_next) override
     {
         read_next = true;
-        return ReadRoomBlock(_room, in, (RoomFileBlock)block_id, ext_id, block_len, _dataVer);
+        return ReadRoomBlock(_room, in, (RoomFileBlock)block_id, ext_id, block_len, _dataVer, _times);
     }
 
     RoomStruct *_room {};
     RoomFileVersion _dataVer {};
+    RoomLoadTimes *_times {};
 };
 
 
-HRoomFileError ReadRoomData(RoomStruct *room, std::unique_ptr<Stream> &&in, RoomFileVersion data_ver)
+HRoomFileError ReadRoomData(RoomStruct *room, std::unique_ptr<Stream> &&in, RoomFileVersion data_ver,
+    RoomLoadTimes *times)
 {
     room->DataVersion = data_ver;
-    RoomBlockReader reader(room, data_ver, std::move(in));
+    RoomBlockReader reader(room, data_ver, std::move(in), times);
     HError err = reader.Read();
     return err ? HRoomFileError::None() : new RoomFileError(kRoomFileErr_BlockListFailed, err);
 }
@@ -676,19 +693,47 @@ HRoomFileError UpdateRoomData(RoomStruct *room, RoomFileVersion data_ver, bool g
 }
 
 HError LoadRoom(const String &filename, RoomStruct *room, AssetManager *mgr,
-    bool game_is_hires, const std::vector<SpriteInfo> &sprinfos)
+    bool game_is_hires, const std::vector<SpriteInfo> &sprinfos, bool lazy_bg_frames, RoomLoadTimes *times)
+{
+    auto in = mgr->OpenAsset(filename, kAssetOpen_ReadWhole);
+    if (!in)
+    {
+        room->Free();
+        room->InitDefaults();
+        HRoomFileError err = new RoomFileError(kRoomFileErr_FileOpenFailed, String::FromFormat("Filename: %s.", filename.GetCStr()));
+        return new Error(String::FromFormat("Failed loading a room from file '%s'.", filename.GetCStr()), err);
+    }
+    return LoadRoom(filename, std::move(in), room, game_is_hires, sprinfos, lazy_bg_frames, times);
+}
+
+HError LoadRoom(const String &filename, std::unique_ptr<Stream> in, RoomStruct *room,
+    bool game_is_hires, const std::vector<SpriteInfo> &sprinfos, bool lazy_bg_frames, RoomLoadTimes *times)
 {
     room->Free();
     room->InitDefaults();
 
+    RoomLoadTimes stage_times;
     RoomDataSource src;
-    HRoomFileError err = OpenRoomFileFromAsset(filename, src, mgr);
+    src.Filename = filename;
+    src.InputStream = std::move(in);
+    auto stage_start = std::chrono::steady_clock::now();
+    HRoomFileError err = ReadRoomHeader(src);
     if (err)
     {
-        err = ReadRoomData(room, std::move(src.InputStream), src.DataVersion);
+        err = ReadRoomData(room, std::move(src.InputStream), src.DataVersion, &stage_times);
+        // the images are timed separately while reading the data
+        stage_times.Read = GetElapsedUs(stage_start) - stage_times.Images;
+        stage_start = std::chrono::steady_clock::now();
         if (err)
             err = UpdateRoomData(room, src.DataVersion, game_is_hires, sprinfos);
-    }
+        stage_times.Update = GetElapsedUs(stage_start);
+        stage_start = std::chrono::steady_clock::now();
+        if (err && (!lazy_bg_frames || (room->Options.Flags & kRoomFlag_PreloadAll) != 0))
+            room->DecodeAllBgFrames();
+        stage_times.Decode = GetElapsedUs(stage_start);
+    }
+    if (times)
+        *times = stage_times;
     if (!err)
         return new Error(String::FromFormat("Failed loading a room from file '%s'.", filename.GetCStr()), err);
     return HError::None();
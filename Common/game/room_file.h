@@ -100,18 +100,36 @@ struct RoomDataSource
     RoomDataSource();
 };
 
+// Time spent on the stages of loading a room, in microseconds
+struct RoomLoadTimes
+{
+    uint32_t Read = 0u;   // reading and parsing the room file, except for the images
+    uint32_t Images = 0u; // reading and decompressing the primary background and area masks
+    uint32_t Update = 0u; // upgrading the data, see UpdateRoomData
+    uint32_t Decode = 0u; // decoding the secondary background frames
+};
+
 
 // Opens room data for reading from an arbitrary file
 HRoomFileError OpenRoomFile(const String &filename, RoomDataSource &src);
 // Opens room data for reading from asset of a given name
 HRoomFileError OpenRoomFileFromAsset(const String &filename, RoomDataSource &src, AssetManager *mgr);
-// Reads room data
-HRoomFileError ReadRoomData(RoomStruct *room, std::unique_ptr<Stream> &&in, RoomFileVersion data_ver);
+// Reads room data; secondary background frames are left compressed,
+// call RoomStruct::DecodeBgFrame() or DecodeAllBgFrames() to get them
+HRoomFileError ReadRoomData(RoomStruct *room, std::unique_ptr<Stream> &&in, RoomFileVersion data_ver,
+    RoomLoadTimes *times = nullptr);
 // Applies necessary updates, conversions and fixups to the loaded data
 // making it compatible with current engine
 HRoomFileError UpdateRoomData(RoomStruct *room, RoomFileVersion data_ver, bool game_is_hires, const std::vector<SpriteInfo> &sprinfos);
-// Loads new room data into the given RoomStruct object and upgrade it to the latest version
-HError LoadRoom(const String &filename, RoomStruct *room, AssetManager *mgr, bool game_is_hires, const std::vector<SpriteInfo> &sprinfos);
+// Loads new room data into the given RoomStruct object and upgrade it to the latest version.
+// If lazy_bg_frames is set, then the secondary background frames are left compressed,
+// unless the room has kRoomFlag_PreloadAll flag. The optional times struct
+// receives the time spent on the loading stages.
+HError LoadRoom(const String &filename, RoomStruct *room, AssetManager *mgr, bool game_is_hires, const std::vector<SpriteInfo> &sprinfos,
+    bool lazy_bg_frames = false, RoomLoadTimes *times = nullptr);
+// Loads new room data from the already opened stream; filename is only used for the error messages
+HError LoadRoom(const String &filename, std::unique_ptr<Stream> in, RoomStruct *room, bool game_is_hires, const std::vector<SpriteInfo> &sprinfos,
+    bool lazy_bg_frames = false, RoomLoadTimes *times = nullptr);
 // Extracts text script from the room file, if it's available.
 // Historically, text sources were kept inside packed room files before AGS 3.*.
 HRoomFileError ExtractScriptText(String &script, std::unique_ptr<Stream> &&in, RoomFileVersion data_ver);
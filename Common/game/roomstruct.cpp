@@ -16,6 +16,7 @@
 #include "game/room_file.h"
 #include "game/roomstruct.h"
 #include "gfx/bitmap.h"
+#include "util/compress.h"
 
 namespace AGS
 {
@@ -34,6 +35,7 @@ RoomOptions::RoomOptions()
 
 RoomBgFrame::RoomBgFrame()
     : IsPaletteShared(false)
+    , UnpackedSize(0)
 {
     memset(Palette, 0, sizeof(Palette));
 }
@@ -105,7 +107,12 @@ RoomStruct::~RoomStruct()
 void RoomStruct::Free()
 {
     for (size_t i = 0; i < (size_t)MAX_ROOM_BGFRAMES; ++i)
+    {
         BgFrames[i].Graphic.reset();
+        BgFrames[i].PackedData.clear();
+        BgFrames[i].PackedData.shrink_to_fit();
+        BgFrames[i].UnpackedSize = 0;
+    }
     HotspotMask.reset();
     RegionMask.reset();
     WalkAreaMask.reset();
@@ -193,6 +200,29 @@ void RoomStruct::SetResolution(RoomResolutionType type)
     _resolution = type;
 }
 
+bool RoomStruct::DecodeBgFrame(size_t index)
+{
+    if (index >= BgFrameCount)
+        return false;
+    RoomBgFrame &frame = BgFrames[index];
+    if (frame.PackedData.empty())
+        return false;
+    // The frame could have been replaced meanwhile, then only drop the packed data
+    const bool do_decode = !frame.Graphic;
+    if (do_decode)
+        frame.Graphic = decode_lzw(frame.PackedData.data(), frame.PackedData.size(), frame.UnpackedSize, BackgroundBPP);
+    frame.PackedData.clear();
+    frame.PackedData.shrink_to_fit();
+    frame.UnpackedSize = 0;
+    return do_decode;
+}
+
+void RoomStruct::DecodeAllBgFrames()
+{
+    for (size_t i = 0; i < BgFrameCount; ++i)
+        DecodeBgFrame(i);
+}
+
 Bitmap *RoomStruct::GetMask(RoomAreaMask mask) const
 {
     switch (mask)
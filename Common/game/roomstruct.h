@@ -37,6 +37,7 @@
 #ifndef __AGS_CN_GAME__ROOMINFO_H
 #define __AGS_CN_GAME__ROOMINFO_H
 #include <memory>
+#include <vector>
 #include <allegro.h> // RGB
 #include "ac/common_defines.h"
 #include "game/interactions.h"
@@ -82,7 +83,10 @@ enum RoomVolumeMod
 // Extended room boolean options
 enum RoomFlags
 {
-    kRoomFlag_BkgFrameLocked = 0x01
+    kRoomFlag_BkgFrameLocked = 0x01,
+    // Decode all the background frames when the room is loaded,
+    // instead of decoding each one on first use
+    kRoomFlag_PreloadAll     = 0x02
 };
 
 // Flag tells that walkable area does not have continious zoom
@@ -141,6 +145,9 @@ struct RoomBgFrame
     RGB         Palette[256];
     // Tells if this frame should keep previous frame palette instead of using its own
     bool        IsPaletteShared;
+    // Compressed frame image, kept until the frame is decoded on first use
+    std::vector<uint8_t> PackedData;
+    size_t      UnpackedSize;
 
     RoomBgFrame();
 };
@@ -293,6 +300,12 @@ public:
     // Set legacy resolution type
     void            SetResolution(RoomResolutionType type);
 
+    // Decodes the background frame if it was loaded compressed;
+    // returns whether the frame was decoded by this call
+    bool    DecodeBgFrame(size_t index);
+    // Decodes all the background frames that were loaded compressed
+    void    DecodeAllBgFrames();
+
     // Gets bitmap of particular mask layer
     Bitmap *GetMask(RoomAreaMask mask) const;
     // Gets mask's scale relative to the room's background size
@@ -12,11 +12,17 @@
 //
 //=============================================================================
 
+#include <algorithm>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <unordered_map>
+#include <vector>
 #include <string.h> // memcpy
 #include <aastr.h>
+#include <allegro/internal/aintern.h>
 #include "gfx/allegrobitmap.h"
+#include "gfx/bitmap_transform.h"
 #include "util/filestream.h"
 #include "debug/assert.h"
 
@@ -27,22 +33,185 @@ namespace AGS
 namespace Common
 {
 
+//=============================================================================
+// Pool of the aligned pixel buffers
+//=============================================================================
+
+// Keeps the pixel buffers of the destroyed aligned bitmaps, so that the
+// bitmaps which are recreated often (e.g. every time an object's image
+// changes) do not allocate and free the large memory blocks each time.
+// The buffers are grouped in classes by size, which lets to reuse them
+// for the bitmaps of slightly different sizes.
+class PixelBufferPool
+{
+public:
+    // Gets a buffer of at least the given size, aligned to BitmapRowAlignment;
+    // returns the actual buffer's size in "alloc_size"
+    uint8_t *Acquire(size_t size, size_t &alloc_size)
+    {
+        alloc_size = GetSizeClass(size);
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            auto it = _free.find(alloc_size);
+            if (it != _free.end() && !it->second.empty())
+            {
+                uint8_t *buf = it->second.back();
+                it->second.pop_back();
+                _freeSize -= alloc_size;
+                return buf;
+            }
+        }
+        return AllocAligned(alloc_size);
+    }
+
+    // Puts the buffer back into the pool, or frees it if the pool is full
+    void Release(uint8_t *buf, size_t alloc_size)
+    {
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            if (_freeSize + alloc_size <= MaxFreeSize)
+            {
+                _free[alloc_size].push_back(buf);
+                _freeSize += alloc_size;
+                return;
+            }
+        }
+        FreeAligned(buf);
+    }
+
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        for (auto &cl : _free)
+        {
+            for (uint8_t *buf : cl.second)
+                FreeAligned(buf);
+        }
+        _free.clear();
+        _freeSize = 0;
+    }
+
+    size_t GetFreeSize()
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        return _freeSize;
+    }
+
+private:
+    // Max total size of the buffers kept for reuse
+    static const size_t MaxFreeSize = 32 * 1024 * 1024;
+
+    // Rounds the size up to 256 bytes for the small buffers, and to 1/8th of
+    // the nearest lower power of two for the large ones; this wastes at most
+    // 12.5% of memory per buffer.
+    static size_t GetSizeClass(size_t size)
+    {
+        if (size <= 4096)
+            return (std::max<size_t>(size, 1) + 255) & ~static_cast<size_t>(255);
+        size_t pow2 = 4096;
+        while (pow2 <= (size - 1) / 2)
+            pow2 *= 2;
+        const size_t step = pow2 / 8;
+        return (size + step - 1) & ~(step - 1);
+    }
+
+    // The aligned allocation is done by hand, as C++11 does not have one;
+    // the original pointer is stored right before the aligned block
+    static uint8_t *AllocAligned(size_t size)
+    {
+        uint8_t *raw = static_cast<uint8_t*>(malloc(size + BitmapRowAlignment + sizeof(void*)));
+        if (!raw)
+            return nullptr;
+        const uintptr_t addr = reinterpret_cast<uintptr_t>(raw + sizeof(void*));
+        uint8_t *buf = reinterpret_cast<uint8_t*>(
+            (addr + BitmapRowAlignment - 1) & ~static_cast<uintptr_t>(BitmapRowAlignment - 1));
+        reinterpret_cast<void**>(buf)[-1] = raw;
+        return buf;
+    }
+
+    static void FreeAligned(uint8_t *buf)
+    {
+        free(reinterpret_cast<void**>(buf)[-1]);
+    }
+
+    std::mutex _mutex;
+    std::unordered_map<size_t, std::vector<uint8_t*>> _free;
+    size_t _freeSize = 0;
+};
+
+// NOTE: the pool is never deleted, because the static Bitmap objects across
+// the program may be destroyed after it otherwise
+static PixelBufferPool &GetPixelBufferPool()
+{
+    static PixelBufferPool *pool = new PixelBufferPool();
+    return *pool;
+}
+
+// Creates Allegro's memory bitmap, which scanlines are placed in the given
+// buffer, starting at the aligned offsets. The BITMAP's "dat" is left null,
+// so that destroy_bitmap() only frees the bitmap struct itself, same as with
+// sub-bitmaps.
+static BITMAP *CreateAlignedBitmap(int color_depth, int width, int height,
+    uint8_t *&pixel_buf, size_t &buf_size)
+{
+    GFX_VTABLE *vtable = _get_vtable(color_depth);
+    if (!vtable || width < 0 || height <= 0)
+        return nullptr;
+    const size_t stride = (width * BYTES_PER_PIXEL(color_depth) + BitmapRowAlignment - 1)
+        & ~static_cast<size_t>(BitmapRowAlignment - 1);
+    // Allegro's 24-bit code may read 4 bytes when accessing the last pixel
+    const size_t padding = (color_depth == 24) ? 1 : 0;
+    pixel_buf = GetPixelBufferPool().Acquire(stride * height + padding, buf_size);
+    if (!pixel_buf)
+        return nullptr;
+    // Allegro expects at least two line pointers, see create_bitmap_ex
+    BITMAP *bitmap = static_cast<BITMAP*>(_AL_MALLOC(sizeof(BITMAP) + sizeof(char*) * std::max(2, height)));
+    if (!bitmap)
+    {
+        GetPixelBufferPool().Release(pixel_buf, buf_size);
+        pixel_buf = nullptr;
+        return nullptr;
+    }
+
+    bitmap->w = bitmap->cr = width;
+    bitmap->h = bitmap->cb = height;
+    bitmap->clip = TRUE;
+    bitmap->cl = bitmap->ct = 0;
+    bitmap->vtable = vtable;
+    bitmap->dat = nullptr;
+    bitmap->id = 0;
+    bitmap->extra = nullptr;
+    bitmap->x_ofs = 0;
+    bitmap->y_ofs = 0;
+    bitmap->seg = _default_ds();
+    for (int i = 0; i < height; ++i)
+        bitmap->line[i] = pixel_buf + i * stride;
+    return bitmap;
+}
+
+
 Bitmap::Bitmap()
     : _alBitmap(nullptr)
     , _isDataOwner(false)
+    , _pixelBuf(nullptr)
+    , _pixelBufSize(0)
 {
 }
 
-Bitmap::Bitmap(int width, int height, int color_depth)
+Bitmap::Bitmap(int width, int height, int color_depth, BitmapAllocation alloc)
     : _alBitmap(nullptr)
     , _isDataOwner(false)
+    , _pixelBuf(nullptr)
+    , _pixelBufSize(0)
 {
-    Create(width, height, color_depth);
+    Create(width, height, color_depth, alloc);
 }
 
 Bitmap::Bitmap(Bitmap *src, const Rect &rc)
     : _alBitmap(nullptr)
     , _isDataOwner(false)
+    , _pixelBuf(nullptr)
+    , _pixelBufSize(0)
 {
     CreateSubBitmap(src, rc);
 }
@@ -50,6 +219,8 @@ Bitmap::Bitmap(Bitmap *src, const Rect &rc)
 Bitmap::Bitmap(BITMAP *al_bmp, bool shared_data)
     : _alBitmap(nullptr)
     , _isDataOwner(false)
+    , _pixelBuf(nullptr)
+    , _pixelBufSize(0)
 {
     WrapAllegroBitmap(al_bmp, shared_data);
 }
@@ -63,10 +234,15 @@ Bitmap::~Bitmap()
 // Creation and destruction
 //=============================================================================
 
-bool Bitmap::Create(int width, int height, int color_depth)
+bool Bitmap::Create(int width, int height, int color_depth, BitmapAllocation alloc)
 {
     Destroy();
-    if (color_depth)
+    if (alloc == kBitmapAlloc_Aligned)
+    {
+        _alBitmap = CreateAlignedBitmap(color_depth ? color_depth : get_color_depth(),
+            width, height, _pixelBuf, _pixelBufSize);
+    }
+    else if (color_depth)
     {
         _alBitmap = create_bitmap_ex(color_depth, width, height);
     }
@@ -78,9 +254,9 @@ bool Bitmap::Create(int width, int height, int color_depth)
     return _alBitmap != nullptr;
 }
 
-bool Bitmap::CreateTransparent(int width, int height, int color_depth)
+bool Bitmap::CreateTransparent(int width, int height, int color_depth, BitmapAllocation alloc)
 {
-    if (Create(width, height, color_depth))
+    if (Create(width, height, color_depth, alloc))
     {
         clear_to_color(_alBitmap, bitmap_mask_color(_alBitmap));
         return true;
@@ -127,6 +303,8 @@ bool Bitmap::WrapAllegroBitmap(BITMAP *al_bmp, bool shared_data)
 
 void Bitmap::ForgetAllegroBitmap()
 {
+    // the aligned bitmap's pixels cannot be freed by Allegro
+    assert(_pixelBuf == nullptr);
     _alBitmap = nullptr;
     _isDataOwner = false;
 }
@@ -137,8 +315,14 @@ void Bitmap::Destroy()
     {
         destroy_bitmap(_alBitmap);
     }
+    if (_pixelBuf)
+    {
+        GetPixelBufferPool().Release(_pixelBuf, _pixelBufSize);
+    }
     _alBitmap = nullptr;
     _isDataOwner = false;
+    _pixelBuf = nullptr;
+    _pixelBufSize = 0;
 }
 
 bool Bitmap::SaveToFile(const char *filename, const void *palette)
@@ -213,6 +397,9 @@ void Bitmap::MaskedBlit(Bitmap *src, int dst_x, int dst_y)
 void Bitmap::StretchBlt(Bitmap *src, const Rect &dst_rc, BitmapMaskOption mask)
 {
 	BITMAP *al_src_bmp = src->_alBitmap;
+	if (BitmapTransform::StretchNearest(_alBitmap, al_src_bmp, RectWH(0, 0, al_src_bmp->w, al_src_bmp->h),
+			dst_rc, mask == kBitmap_Transparency))
+		return;
 	// WARNING: For some evil reason Allegro expects dest and src bitmaps in different order for blit and draw_sprite
 	if (mask == kBitmap_Transparency)
 	{
@@ -230,6 +417,8 @@ void Bitmap::StretchBlt(Bitmap *src, const Rect &dst_rc, BitmapMaskOption mask)
 void Bitmap::StretchBlt(Bitmap *src, const Rect &src_rc, const Rect &dst_rc, BitmapMaskOption mask)
 {
 	BITMAP *al_src_bmp = src->_alBitmap;
+	if (BitmapTransform::StretchNearest(_alBitmap, al_src_bmp, src_rc, dst_rc, mask == kBitmap_Transparency))
+		return;
 	if (mask == kBitmap_Transparency)
 	{
 		masked_stretch_blit(al_src_bmp, _alBitmap,
@@ -294,6 +483,8 @@ void Bitmap::LitBlendBlt(Bitmap *src, int dst_x, int dst_y, int light_amount)
 void Bitmap::FlipBlt(Bitmap *src, int dst_x, int dst_y, GraphicFlip flip)
 {	
 	BITMAP *al_src_bmp = src->_alBitmap;
+	if ((flip != kFlip_None) && BitmapTransform::FlipSprite(_alBitmap, al_src_bmp, dst_x, dst_y, flip))
+		return;
 	switch (flip)
 	{
 	case kFlip_Horizontal:
@@ -314,12 +505,20 @@ void Bitmap::FlipBlt(Bitmap *src, int dst_x, int dst_y, GraphicFlip flip)
 void Bitmap::RotateBlt(Bitmap *src, int dst_x, int dst_y, fixed_t angle)
 {
 	BITMAP *al_src_bmp = src->_alBitmap;
+	// Same pivot as rotate_sprite uses, which is the sprite's center
+	if (BitmapTransform::PivotSprite(_alBitmap, al_src_bmp,
+			(dst_x << 16) + (al_src_bmp->w * 0x10000) / 2, (dst_y << 16) + (al_src_bmp->h * 0x10000) / 2,
+			al_src_bmp->w << 15, al_src_bmp->h << 15, angle))
+		return;
 	rotate_sprite(_alBitmap, al_src_bmp, dst_x, dst_y, angle);
 }
 
 void Bitmap::RotateBlt(Bitmap *src, int dst_x, int dst_y, int pivot_x, int pivot_y, fixed_t angle)
 {	
 	BITMAP *al_src_bmp = src->_alBitmap;
+	if (BitmapTransform::PivotSprite(_alBitmap, al_src_bmp, dst_x << 16, dst_y << 16,
+			pivot_x << 16, pivot_y << 16, angle))
+		return;
 	pivot_sprite(_alBitmap, al_src_bmp, dst_x, dst_y, pivot_x, pivot_y, angle);
 }
 
@@ -496,6 +695,16 @@ Bitmap *CreateRawBitmapWrapper(BITMAP *al_bmp)
 	return bitmap;
 }
 
+void ClearBitmapPool()
+{
+    GetPixelBufferPool().Clear();
+}
+
+size_t GetBitmapPoolSize()
+{
+    return GetPixelBufferPool().GetFreeSize();
+}
+
 } // namespace BitmapHelper
 
 
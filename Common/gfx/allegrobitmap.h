@@ -35,7 +35,7 @@ class Bitmap
 {
 public:
     Bitmap();
-    Bitmap(int width, int height, int color_depth = 0);
+    Bitmap(int width, int height, int color_depth = 0, BitmapAllocation alloc = kBitmapAlloc_Packed);
     Bitmap(Bitmap *src, const Rect &rc);
     Bitmap(BITMAP *al_bmp, bool shared_data);
     ~Bitmap();
@@ -47,9 +47,11 @@ public:
     // TODO: color_depth = 0 is used to call Allegro's create_bitmap, which uses
     // some global color depth setting; not sure if this is OK to use for generic class,
     // revise this in future
-    bool    Create(int width, int height, int color_depth = 0);
+    // NOTE: the kBitmapAlloc_Aligned bitmaps take their pixel memory from the
+    // shared pool, and return it there when destroyed.
+    bool    Create(int width, int height, int color_depth = 0, BitmapAllocation alloc = kBitmapAlloc_Packed);
     // Create Bitmap and clear to transparent color
-    bool    CreateTransparent(int width, int height, int color_depth = 0);
+    bool    CreateTransparent(int width, int height, int color_depth = 0, BitmapAllocation alloc = kBitmapAlloc_Packed);
     // Creates a sub-bitmap of the given bitmap; the sub-bitmap is a reference to
     // particular region inside a parent.
     // WARNING: the parent bitmap MUST be kept in memory for as long as sub-bitmap exists!
@@ -62,7 +64,8 @@ public:
     // TODO: this is a temporary solution for plugin support
     // Wraps a raw allegro BITMAP object, optionally owns it (will delete on disposal)
     bool    WrapAllegroBitmap(BITMAP *al_bmp, bool shared_data);
-    // Releases a reference to raw allegro BITMAP object without deleting it
+    // Releases a reference to raw allegro BITMAP object without deleting it;
+    // must not be used with the bitmaps created with kBitmapAlloc_Aligned
     void    ForgetAllegroBitmap();
     // Deallocate bitmap
     void	Destroy();
@@ -135,10 +138,24 @@ public:
     {
         return GetWidth() * GetBPP();
     }
+    // Gets the distance in bytes between the starts of two consecutive
+    // scanlines; this is larger than the line length for the aligned bitmaps
+    // and sub-bitmaps.
+    inline int  GetStride() const
+    {
+        return _alBitmap->h > 1 ?
+            static_cast<int>(_alBitmap->line[1] - _alBitmap->line[0]) : GetLineLength();
+    }
+    // Tells if the bitmap was allocated with the aligned padded scanlines
+    inline bool IsAligned() const
+    {
+        return _pixelBuf != nullptr;
+    }
 
 	// TODO: replace with byte *
 	// Gets a pointer to underlying graphic data
 	// FIXME: actually not a very good idea, since there's no 100% guarantee the scanline positions in memory are sequential
+	// NOTE: the data is only contiguous in the packed bitmaps, see GetStride()
     inline const unsigned char *GetData() const
     {
         return _alBitmap->line[0];
@@ -207,6 +224,16 @@ public:
     // done in such cases.
     void	PutPixel(int x, int y, color_t color);
     int		GetPixel(int x, int y) const;
+    // Gets the pixel of the 8-bit bitmap directly from its scan line,
+    // for the frequent lookups, such as in the room masks;
+    // returns -1 if the coordinates are out of bounds, same as GetPixel.
+    inline int GetPixel8(int x, int y) const
+    {
+        assert(GetColorDepth() == 8);
+        if (x < 0 || x >= _alBitmap->w || y < 0 || y >= _alBitmap->h)
+            return -1;
+        return _alBitmap->line[y][x];
+    }
 
     //=========================================================================
     // Vector drawing operations
@@ -242,6 +269,9 @@ public:
 private:
 	BITMAP			*_alBitmap;
 	bool			_isDataOwner;
+	// Pooled pixel buffer of the aligned bitmap
+	uint8_t			*_pixelBuf;
+	size_t			_pixelBufSize;
 };
 
 
@@ -253,6 +283,11 @@ namespace BitmapHelper
 	Bitmap *CreateRawBitmapOwner(BITMAP *al_bmp);
 	// NOTE: the resulting object __does not own__ bitmap data
 	Bitmap *CreateRawBitmapWrapper(BITMAP *al_bmp);
+	// Frees the pixel memory kept in the pool of the aligned bitmaps;
+	// the bitmaps which currently exist are not affected
+	void    ClearBitmapPool();
+	// Gets the amount of pixel memory which is kept in the pool, in bytes
+	size_t  GetBitmapPoolSize();
 } // namespace BitmapHelper
 
 } // namespace Common
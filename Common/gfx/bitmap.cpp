@@ -14,7 +14,8 @@
 
 #include <array>
 #include <memory>
-#include "gfx/bitmap.h"
+#include "gfx/bitmap.h"
+#include "gfx/pixel_convert.h"
 #include "util/memory.h"
 #include "util/memorystream.h"
 #include "util/file.h"
@@ -30,10 +31,10 @@ namespace Common
 namespace BitmapHelper
 {
 
-Bitmap *CreateBitmap(int width, int height, int color_depth)
+Bitmap *CreateBitmap(int width, int height, int color_depth, BitmapAllocation alloc)
 {
 	Bitmap *bitmap = new Bitmap();
-	if (!bitmap->Create(width, height, color_depth))
+	if (!bitmap->Create(width, height, color_depth, alloc))
 	{
 		delete bitmap;
 		bitmap = nullptr;
@@ -53,10 +54,10 @@ Bitmap *CreateClearBitmap(int width, int height, int color_depth, int clear_colo
     return bitmap;
 }
 
-Bitmap *CreateTransparentBitmap(int width, int height, int color_depth)
+Bitmap *CreateTransparentBitmap(int width, int height, int color_depth, BitmapAllocation alloc)
 {
     Bitmap *bitmap = new Bitmap();
-	if (!bitmap->CreateTransparent(width, height, color_depth))
+	if (!bitmap->CreateTransparent(width, height, color_depth, alloc))
 	{
 		delete bitmap;
 		bitmap = nullptr;
@@ -143,13 +144,7 @@ void ReplaceAlphaWithRGBMask(Bitmap *bmp)
         return; // no alpha channel
 
     for (int i = 0; i < bmp->GetHeight(); ++i)
-    {
-        uint32_t *line = reinterpret_cast<uint32_t*>(bmp->GetScanLineForWriting(i));
-        uint32_t *line_end = line + bmp->GetWidth();
-        for (uint32_t *px = line; px != line_end; ++px)
-            if (geta32(*px) == 0)
-                *px = MASK_COLOR_32;
-    }
+        PixelConvert::ReplaceAlphaWithMask32(reinterpret_cast<uint32_t*>(bmp->GetScanLineForWriting(i)), bmp->GetWidth());
 }
 
 // Functor that copies the "mask color" pixels from source to dest
@@ -220,15 +215,19 @@ struct PixelTransSkip32
 // - one that tells whether to skip current pixel;
 // - another that copies the color from src to dest
 template <class FnPxProc, class FnSkip>
-void ApplyMask(uint8_t *dst, const uint8_t *src, size_t pitch, size_t height,
-    FnPxProc proc, FnSkip skip, uint32_t mask_color, bool dst_has_alpha, bool mask_has_alpha)
+void ApplyMask(Bitmap *dst, const Bitmap *mask, FnPxProc proc, FnSkip skip,
+    uint32_t mask_color, bool dst_has_alpha, bool mask_has_alpha)
 {
-    for (size_t y = 0; y < height; ++y)
+    const size_t line_len = mask->GetLineLength();
+    // the scanlines are not necessarily contiguous, process them one by one
+    for (int y = 0; y < mask->GetHeight(); ++y)
     {
-        for (size_t x = 0; x < pitch; x += FnPxProc::BPP, src += FnPxProc::BPP, dst += FnPxProc::BPP)
+        uint8_t *dst_ptr = dst->GetScanLineForWriting(y);
+        const uint8_t *src_ptr = mask->GetScanLine(y);
+        for (size_t x = 0; x < line_len; x += FnPxProc::BPP, src_ptr += FnPxProc::BPP, dst_ptr += FnPxProc::BPP)
         {
-            if (!skip(dst, mask_color, dst_has_alpha))
-                proc(dst, src, mask_color, mask_has_alpha);
+            if (!skip(dst_ptr, mask_color, dst_has_alpha))
+                proc(dst_ptr, src_ptr, mask_color, mask_has_alpha);
         }
     }
 }
@@ -236,20 +235,16 @@ void ApplyMask(uint8_t *dst, const uint8_t *src, size_t pitch, size_t height,
 void CopyTransparency(Bitmap *dst, const Bitmap *mask, bool dst_has_alpha, bool mask_has_alpha)
 {
     color_t mask_color     = mask->GetMaskColor();
-    uint8_t *dst_ptr       = dst->GetDataForWriting();
-    const uint8_t *src_ptr = mask->GetData();
     const size_t bpp       = mask->GetBPP();
-    const size_t pitch     = mask->GetLineLength();
-    const size_t height    = mask->GetHeight();
 
     if (bpp == 1)
-        ApplyMask(dst_ptr, src_ptr, pitch, height, PixelTransCpy8(),  PixelNoSkip(), mask_color, dst_has_alpha, mask_has_alpha);
+        ApplyMask(dst, mask, PixelTransCpy8(),  PixelNoSkip(), mask_color, dst_has_alpha, mask_has_alpha);
     else if (bpp == 2)
-        ApplyMask(dst_ptr, src_ptr, pitch, height, PixelTransCpy16(), PixelNoSkip(), mask_color, dst_has_alpha, mask_has_alpha);
+        ApplyMask(dst, mask, PixelTransCpy16(), PixelNoSkip(), mask_color, dst_has_alpha, mask_has_alpha);
     else if (bpp == 3)
-        ApplyMask(dst_ptr, src_ptr, pitch, height, PixelTransCpy24(), PixelNoSkip(), mask_color, dst_has_alpha, mask_has_alpha);
+        ApplyMask(dst, mask, PixelTransCpy24(), PixelNoSkip(), mask_color, dst_has_alpha, mask_has_alpha);
     else
-        ApplyMask(dst_ptr, src_ptr, pitch, height, PixelTransCpy32(), PixelTransSkip32(), mask_color, dst_has_alpha, mask_has_alpha);
+        ApplyMask(dst, mask, PixelTransCpy32(), PixelTransSkip32(), mask_color, dst_has_alpha, mask_has_alpha);
 }
 
 void ReadPixelsFromMemory(Bitmap *dst, const uint8_t *src_buffer, const size_t src_pitch, const size_t src_px_offset)
@@ -258,7 +253,12 @@ void ReadPixelsFromMemory(Bitmap *dst, const uint8_t *src_buffer, const size_t s
     const size_t src_px_pitch = src_pitch / bpp;
     if (src_px_offset >= src_px_pitch)
         return; // nothing to copy
-    Memory::BlockCopy(dst->GetDataForWriting(), dst->GetLineLength(), 0, src_buffer, src_pitch, src_px_offset * bpp, dst->GetHeight());
+    // NOTE: copy scanline by scanline, because the bitmap may have padded rows
+    const size_t src_offset = src_px_offset * bpp;
+    const size_t copy_len = std::min<size_t>(dst->GetLineLength(), src_pitch - src_offset);
+    const uint8_t *src = src_buffer + src_offset;
+    for (int y = 0; y < dst->GetHeight(); ++y, src += src_pitch)
+        memcpy(dst->GetScanLineForWriting(y), src, copy_len);
 }
 
 //=============================================================================
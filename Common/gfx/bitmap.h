@@ -35,6 +35,20 @@ enum BitmapMaskOption
 	kBitmap_Transparency
 };
 
+// Pixel memory allocation mode for the new bitmaps
+enum BitmapAllocation
+{
+    // The scanlines follow each other without gaps, in one memory block
+    kBitmapAlloc_Packed,
+    // Each scanline begins at the address aligned to BitmapRowAlignment
+    // bytes, and the scanlines are padded to keep this alignment; this lets
+    // the row-based kernels use the aligned SIMD loads and stores
+    kBitmapAlloc_Aligned
+};
+
+// Scanline alignment of the kBitmapAlloc_Aligned bitmaps, in bytes
+const int BitmapRowAlignment = 32;
+
 } // namespace Common
 } // namespace AGS
 
@@ -59,11 +73,13 @@ namespace BitmapHelper
     // NOTE: in all of these color_depth may be passed as 0 in which case a default
     // color depth will be used (as previously set for the system).
     // Creates a new bitmap of the given format; the pixel contents are undefined.
-    Bitmap *CreateBitmap(int width, int height, int color_depth = 0);
+    Bitmap *CreateBitmap(int width, int height, int color_depth = 0,
+        BitmapAllocation alloc = kBitmapAlloc_Packed);
     // Creates a new bitmap and clears it with the given color
     Bitmap *CreateClearBitmap(int width, int height, int color_depth = 0, int clear_color = 0);
     // Creates a new bitmap and clears it with the transparent color
-    Bitmap *CreateTransparentBitmap(int width, int height, int color_depth = 0);
+    Bitmap *CreateTransparentBitmap(int width, int height, int color_depth = 0,
+        BitmapAllocation alloc = kBitmapAlloc_Packed);
     // Creates a sub-bitmap of the given bitmap; the sub-bitmap is a reference to
     // particular region inside a parent.
     // WARNING: the parent bitmap MUST be kept in memory for as long as sub-bitmap exists!
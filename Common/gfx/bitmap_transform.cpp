@@ -0,0 +1,499 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gfx/bitmap_transform.h"
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define AGS_TRANSFORM_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AGS_TRANSFORM_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace BitmapTransform
+{
+
+namespace
+{
+
+// Copies a row of pixels, skipping the ones of the mask color
+template <typename T>
+inline void copy_row_masked(T *dst, const T *src, int count, T mask)
+{
+    for (int i = 0; i < count; ++i)
+        dst[i] = (src[i] != mask) ? src[i] : dst[i];
+}
+
+// Copies a row of pixels in the reverse order, optionally skipping the ones
+// of the mask color; src_end points past the first pixel to copy
+template <typename T>
+inline void copy_row_reversed(T *dst, const T *src_end, int count, bool masked, T mask)
+{
+    if (!masked)
+    {
+        for (int i = 0; i < count; ++i)
+            dst[i] = src_end[-1 - i];
+        return;
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        const T c = src_end[-1 - i];
+        dst[i] = (c != mask) ? c : dst[i];
+    }
+}
+
+#if AGS_TRANSFORM_SSE2
+
+template <>
+inline void copy_row_masked<uint32_t>(uint32_t *dst, const uint32_t *src, int count, uint32_t mask)
+{
+    const __m128i vmask = _mm_set1_epi32(static_cast<int>(mask));
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        const __m128i m = _mm_cmpeq_epi32(s, vmask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+            _mm_or_si128(_mm_and_si128(m, d), _mm_andnot_si128(m, s)));
+    }
+    for (; i < count; ++i)
+    {
+        if (src[i] != mask)
+            dst[i] = src[i];
+    }
+}
+
+template <>
+inline void copy_row_reversed<uint32_t>(uint32_t *dst, const uint32_t *src_end, int count, bool masked, uint32_t mask)
+{
+    const __m128i vmask = _mm_set1_epi32(static_cast<int>(mask));
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_end - i - 4));
+        s = _mm_shuffle_epi32(s, _MM_SHUFFLE(0, 1, 2, 3));
+        if (masked)
+        {
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            const __m128i m = _mm_cmpeq_epi32(s, vmask);
+            s = _mm_or_si128(_mm_and_si128(m, d), _mm_andnot_si128(m, s));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+    }
+    for (; i < count; ++i)
+    {
+        const uint32_t c = src_end[-1 - i];
+        if (!masked || (c != mask))
+            dst[i] = c;
+    }
+}
+
+#elif AGS_TRANSFORM_NEON
+
+template <>
+inline void copy_row_masked<uint32_t>(uint32_t *dst, const uint32_t *src, int count, uint32_t mask)
+{
+    const uint32x4_t vmask = vdupq_n_u32(mask);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t s = vld1q_u32(src + i);
+        const uint32x4_t d = vld1q_u32(dst + i);
+        vst1q_u32(dst + i, vbslq_u32(vceqq_u32(s, vmask), d, s));
+    }
+    for (; i < count; ++i)
+    {
+        if (src[i] != mask)
+            dst[i] = src[i];
+    }
+}
+
+template <>
+inline void copy_row_reversed<uint32_t>(uint32_t *dst, const uint32_t *src_end, int count, bool masked, uint32_t mask)
+{
+    const uint32x4_t vmask = vdupq_n_u32(mask);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32x4_t s = vrev64q_u32(vld1q_u32(src_end - i - 4));
+        s = vcombine_u32(vget_high_u32(s), vget_low_u32(s));
+        if (masked)
+            s = vbslq_u32(vceqq_u32(s, vmask), vld1q_u32(dst + i), s);
+        vst1q_u32(dst + i, s);
+    }
+    for (; i < count; ++i)
+    {
+        const uint32_t c = src_end[-1 - i];
+        if (!masked || (c != mask))
+            dst[i] = c;
+    }
+}
+
+#endif // AGS_TRANSFORM_NEON
+
+// Interpolates between two 32-bit pixels, weight is in the 0-256 range
+inline uint32_t lerp_pixel(uint32_t a, uint32_t b, uint32_t w)
+{
+    const uint32_t iw = 256 - w;
+    const uint32_t rb = (((a & 0xFF00FF) * iw + (b & 0xFF00FF) * w) >> 8) & 0xFF00FF;
+    const uint32_t ag = (((a >> 8) & 0xFF00FF) * iw + ((b >> 8) & 0xFF00FF) * w) & 0xFF00FF00;
+    return rb | ag;
+}
+
+// Interpolates between two rows of 32-bit pixels, weight is in the 1-255 range
+inline void lerp_row(uint32_t *dst, const uint32_t *a, const uint32_t *b, int count, uint32_t w)
+{
+    int i = 0;
+#if AGS_TRANSFORM_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vw = _mm_set1_epi16(static_cast<short>(w));
+    const __m128i viw = _mm_set1_epi16(static_cast<short>(256 - w));
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const __m128i lo = _mm_srli_epi16(_mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), viw),
+            _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), vw)), 8);
+        const __m128i hi = _mm_srli_epi16(_mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), viw),
+            _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), vw)), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#elif AGS_TRANSFORM_NEON
+    const uint8x8_t vw = vdup_n_u8(static_cast<uint8_t>(w));
+    const uint8x8_t viw = vdup_n_u8(static_cast<uint8_t>(256 - w));
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint8x16_t va = vreinterpretq_u8_u32(vld1q_u32(a + i));
+        const uint8x16_t vb = vreinterpretq_u8_u32(vld1q_u32(b + i));
+        const uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(va), viw), vget_low_u8(vb), vw);
+        const uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(va), viw), vget_high_u8(vb), vw);
+        vst1q_u32(dst + i, vreinterpretq_u32_u8(vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8))));
+    }
+#endif
+    for (; i < count; ++i)
+        dst[i] = lerp_pixel(a[i], b[i], w);
+}
+
+// Fills the source pixel indexes for the destination range [beg, end) of
+// the line [d, d + dlen) stretched from [s, s + slen); follows the steps of
+// Allegro's stretch_blit to get exactly the same pixels
+void get_nearest_steps(int s, int slen, int d, int dlen, int beg, int end, std::vector<int> &out)
+{
+    const int sinc = slen / dlen;
+    const int cdec = slen - sinc * dlen;
+    const int cinc = dlen - cdec;
+    int c = cinc;
+    out.resize(end - beg);
+    for (int i = d; i < end; ++i)
+    {
+        if (i >= beg)
+            out[i - beg] = s;
+        s += sinc;
+        if (c <= 0)
+        {
+            s++;
+            c += cinc;
+        }
+        else
+        {
+            c -= cdec;
+        }
+    }
+}
+
+// A pair of the source pixels and the weight of the second one
+struct BilinearStep
+{
+    int I0 = 0;
+    int I1 = 0;
+    uint32_t W = 0u;
+};
+
+// Fills the source pixels for the destination range [beg, end) of the line
+// [0, dlen) stretched from [0, slen); the pixel centers are matched
+void get_bilinear_steps(int slen, int dlen, int beg, int end, std::vector<BilinearStep> &out)
+{
+    out.resize(end - beg);
+    for (int i = beg; i < end; ++i)
+    {
+        int64_t f = (static_cast<int64_t>(2 * i + 1) * slen * 0x10000) / (2 * dlen) - 0x8000;
+        f = std::max<int64_t>(0, f);
+        BilinearStep &step = out[i - beg];
+        step.I0 = static_cast<int>(f >> 16);
+        step.W = static_cast<uint32_t>(f >> 8) & 0xFF;
+        if (step.I0 >= slen - 1)
+        {
+            step.I0 = slen - 1;
+            step.W = 0u;
+        }
+        step.I1 = std::min(step.I0 + 1, slen - 1);
+    }
+}
+
+// Calculates the destination range, clipped against the bitmap's clipping
+// rectangle; returns false if nothing is visible
+inline bool clip_dest(BITMAP *dst, int &x1, int &y1, int &x2, int &y2)
+{
+    if (dst->clip)
+    {
+        x1 = std::max(x1, dst->cl);
+        y1 = std::max(y1, dst->ct);
+        x2 = std::min(x2, dst->cr);
+        y2 = std::min(y2, dst->cb);
+    }
+    else
+    {
+        x1 = std::max(x1, 0);
+        y1 = std::max(y1, 0);
+        x2 = std::min(x2, dst->w);
+        y2 = std::min(y2, dst->h);
+    }
+    return (x1 < x2) && (y1 < y2);
+}
+
+template <typename T>
+void stretch_nearest(BITMAP *dst, BITMAP *src, const Rect &src_rc, const Rect &dst_rc, bool masked)
+{
+    int x1 = dst_rc.Left, y1 = dst_rc.Top, x2 = dst_rc.Right + 1, y2 = dst_rc.Bottom + 1;
+    if (!clip_dest(dst, x1, y1, x2, y2))
+        return;
+    std::vector<int> cols, rows;
+    get_nearest_steps(src_rc.Left, src_rc.GetWidth(), dst_rc.Left, dst_rc.GetWidth(), x1, x2, cols);
+    get_nearest_steps(src_rc.Top, src_rc.GetHeight(), dst_rc.Top, dst_rc.GetHeight(), y1, y2, rows);
+
+    // Each source row is only fetched once, and then copied to all of the
+    // destination rows it is stretched to
+    const int count = x2 - x1;
+    std::vector<T> line(count);
+    const T mask = static_cast<T>(bitmap_mask_color(dst));
+    int last_sy = -1;
+    for (int y = y1; y < y2; ++y)
+    {
+        const int sy = rows[y - y1];
+        if (sy != last_sy)
+        {
+            const T *src_line = reinterpret_cast<const T*>(src->line[sy]);
+            for (int i = 0; i < count; ++i)
+                line[i] = src_line[cols[i]];
+            last_sy = sy;
+        }
+        T *dst_line = reinterpret_cast<T*>(dst->line[y]) + x1;
+        if (masked)
+            copy_row_masked(dst_line, line.data(), count, mask);
+        else
+            memcpy(dst_line, line.data(), count * sizeof(T));
+    }
+}
+
+template <typename T>
+void flip_sprite(BITMAP *dst, BITMAP *src, int dst_x, int dst_y, bool hflip, bool vflip)
+{
+    int x1 = dst_x, y1 = dst_y, x2 = dst_x + src->w, y2 = dst_y + src->h;
+    if (!clip_dest(dst, x1, y1, x2, y2))
+        return;
+    const int count = x2 - x1;
+    const T mask = static_cast<T>(bitmap_mask_color(src));
+    for (int y = y1; y < y2; ++y)
+    {
+        const int sy = vflip ? (src->h - 1 - (y - dst_y)) : (y - dst_y);
+        const T *src_line = reinterpret_cast<const T*>(src->line[sy]);
+        T *dst_line = reinterpret_cast<T*>(dst->line[y]) + x1;
+        if (hflip)
+            copy_row_reversed(dst_line, src_line + src->w - (x1 - dst_x), count, true, mask);
+        else
+            copy_row_masked(dst_line, src_line + (x1 - dst_x), count, mask);
+    }
+}
+
+// Draws a sprite rotated by a multiple of a right angle; the destination
+// rectangle is already known, and (xo, yo) is where the sprite's top-left
+// corner ends; (c, s) are the cosine and sine of the angle
+template <typename T>
+void pivot_sprite(BITMAP *dst, BITMAP *src, int x1, int y1, int x2, int y2,
+    int xo, int yo, int c, int s)
+{
+    if (!clip_dest(dst, x1, y1, x2, y2))
+        return;
+    const int count = x2 - x1;
+    const T mask = static_cast<T>(bitmap_mask_color(dst));
+    for (int y = y1; y < y2; ++y)
+    {
+        // Rotate the center of the first pixel back to the sprite; the pixel
+        // centers are always at the halves, so the result is never ambiguous
+        const int sx = (2 * ((x1 - xo) * c + (y - yo) * s) + c + s) / 2;
+        const int sy = (2 * ((y - yo) * c - (x1 - xo) * s) + c - s) / 2;
+        T *dst_line = reinterpret_cast<T*>(dst->line[y]) + x1;
+        if (s == 0)
+        {
+            // Rows are rotated to rows, either forwards or backwards
+            const T *src_line = reinterpret_cast<const T*>(src->line[sy]);
+            if (c > 0)
+                copy_row_masked(dst_line, src_line + sx, count, mask);
+            else
+                copy_row_reversed(dst_line, src_line + sx + 1, count, true, mask);
+        }
+        else
+        {
+            // Rows are rotated to columns, moving up or down the source
+            for (int i = 0; i < count; ++i)
+            {
+                const T px = reinterpret_cast<const T*>(src->line[sy - i * s])[sx];
+                if (px != mask)
+                    dst_line[i] = px;
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool StretchNearest(BITMAP *dst, BITMAP *src, const Rect &src_rc, const Rect &dst_rc, bool masked)
+{
+    if ((bitmap_color_depth(dst) != bitmap_color_depth(src)) || is_same_bitmap(dst, src))
+        return false;
+    if ((src_rc.GetWidth() <= 0) || (src_rc.GetHeight() <= 0) ||
+        (dst_rc.GetWidth() <= 0) || (dst_rc.GetHeight() <= 0))
+        return true; // nothing to draw
+    switch (bitmap_color_depth(dst))
+    {
+    case 8: stretch_nearest<uint8_t>(dst, src, src_rc, dst_rc, masked); return true;
+    case 15:
+    case 16: stretch_nearest<uint16_t>(dst, src, src_rc, dst_rc, masked); return true;
+    case 32: stretch_nearest<uint32_t>(dst, src, src_rc, dst_rc, masked); return true;
+    default: return false;
+    }
+}
+
+bool StretchBilinear(BITMAP *dst, BITMAP *src, const Rect &src_rc, const Rect &dst_rc)
+{
+    if ((bitmap_color_depth(dst) != 32) || (bitmap_color_depth(src) != 32) || is_same_bitmap(dst, src))
+        return false;
+    const Rect srect = IntersectRects(src_rc, RectWH(0, 0, src->w, src->h));
+    const int sw = srect.GetWidth(), sh = srect.GetHeight();
+    const int dw = dst_rc.GetWidth(), dh = dst_rc.GetHeight();
+    if ((sw <= 0) || (sh <= 0) || (dw <= 0) || (dh <= 0))
+        return true; // nothing to draw
+    int x1 = dst_rc.Left, y1 = dst_rc.Top, x2 = dst_rc.Right + 1, y2 = dst_rc.Bottom + 1;
+    if (!clip_dest(dst, x1, y1, x2, y2))
+        return true;
+    std::vector<BilinearStep> cols, rows;
+    get_bilinear_steps(sw, dw, x1 - dst_rc.Left, x2 - dst_rc.Left, cols);
+    get_bilinear_steps(sh, dh, y1 - dst_rc.Top, y2 - dst_rc.Top, rows);
+
+    // First interpolate between the two source rows, then along the result;
+    // the destination rows which have the same source rows and weight are
+    // just copied from the previous one
+    const int count = x2 - x1;
+    std::vector<uint32_t> line(sw);
+    const uint32_t *prev_line = nullptr;
+    const BilinearStep *prev_step = nullptr;
+    for (int y = y1; y < y2; ++y)
+    {
+        const BilinearStep &step = rows[y - y1];
+        uint32_t *dst_line = reinterpret_cast<uint32_t*>(dst->line[y]) + x1;
+        if (prev_step && (step.I0 == prev_step->I0) && (step.W == prev_step->W))
+        {
+            memcpy(dst_line, prev_line, count * sizeof(uint32_t));
+            continue;
+        }
+        const uint32_t *row0 = reinterpret_cast<const uint32_t*>(src->line[srect.Top + step.I0]) + srect.Left;
+        const uint32_t *row1 = reinterpret_cast<const uint32_t*>(src->line[srect.Top + step.I1]) + srect.Left;
+        const uint32_t *row = row0;
+        if (step.W > 0)
+        {
+            lerp_row(line.data(), row0, row1, sw, step.W);
+            row = line.data();
+        }
+        for (int i = 0; i < count; ++i)
+        {
+            const BilinearStep &col = cols[i];
+            dst_line[i] = lerp_pixel(row[col.I0], row[col.I1], col.W);
+        }
+        prev_line = dst_line;
+        prev_step = &step;
+    }
+    return true;
+}
+
+bool FlipSprite(BITMAP *dst, BITMAP *src, int dst_x, int dst_y, GraphicFlip flip)
+{
+    if ((bitmap_color_depth(dst) != bitmap_color_depth(src)) || is_same_bitmap(dst, src))
+        return false;
+    const bool hflip = (flip == kFlip_Horizontal) || (flip == kFlip_Both);
+    const bool vflip = (flip == kFlip_Vertical) || (flip == kFlip_Both);
+    switch (bitmap_color_depth(dst))
+    {
+    case 8: flip_sprite<uint8_t>(dst, src, dst_x, dst_y, hflip, vflip); return true;
+    case 15:
+    case 16: flip_sprite<uint16_t>(dst, src, dst_x, dst_y, hflip, vflip); return true;
+    case 32: flip_sprite<uint32_t>(dst, src, dst_x, dst_y, hflip, vflip); return true;
+    default: return false;
+    }
+}
+
+bool PivotSprite(BITMAP *dst, BITMAP *src, fixed_t x, fixed_t y, fixed_t cx, fixed_t cy, fixed_t angle)
+{
+    // Allegro's angles have 256 units per full circle, so the right angle is 64
+    if (((angle & 0x3FFFFF) != 0) ||
+        (bitmap_color_depth(dst) != bitmap_color_depth(src)) || is_same_bitmap(dst, src))
+        return false;
+    static const int Cos[4] = { 1, 0, -1, 0 };
+    static const int Sin[4] = { 0, 1, 0, -1 };
+    const int quarter = (angle >> 22) & 3;
+    const int c = Cos[quarter];
+    const int s = Sin[quarter];
+
+    // Sprite corners, calculated same way as Allegro does; with the exact
+    // sine and cosine all of them are at the whole pixels if the pivot
+    // points are, in which case Allegro covers exactly the pixels inside
+    const fixed_t w = src->w << 16, h = src->h << 16;
+    const fixed_t xofs = x - cx * c + cy * s;
+    const fixed_t yofs = y - cx * s - cy * c;
+    const fixed_t xs[4] = { xofs, xofs + w * c, xofs + w * c - h * s, xofs - h * s };
+    const fixed_t ys[4] = { yofs, yofs + w * s, yofs + w * s + h * c, yofs + h * c };
+    for (int i = 0; i < 4; ++i)
+    {
+        if (((xs[i] | ys[i]) & 0xFFFF) != 0)
+            return false;
+    }
+    const int x1 = *std::min_element(xs, xs + 4) >> 16;
+    const int x2 = *std::max_element(xs, xs + 4) >> 16;
+    const int y1 = *std::min_element(ys, ys + 4) >> 16;
+    const int y2 = *std::max_element(ys, ys + 4) >> 16;
+    const int xo = xofs >> 16, yo = yofs >> 16;
+    switch (bitmap_color_depth(dst))
+    {
+    case 8: pivot_sprite<uint8_t>(dst, src, x1, y1, x2, y2, xo, yo, c, s); return true;
+    case 15:
+    case 16: pivot_sprite<uint16_t>(dst, src, x1, y1, x2, y2, xo, yo, c, s); return true;
+    case 32: pivot_sprite<uint32_t>(dst, src, x1, y1, x2, y2, xo, yo, c, s); return true;
+    default: return false;
+    }
+}
+
+} // namespace BitmapTransform
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,68 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Bitmap transformation kernels: scaling, flipping and rotation.
+//
+// The nearest-neighbour scaling, flipping and rotation produce exactly the
+// same pixels as the respective Allegro functions, but work on whole rows:
+// the source coordinates are precomputed once per call, repeating source
+// rows are only fetched once, and the 32-bit rows are copied and masked
+// with SIMD where it's available. The functions which reproduce Allegro
+// return false for the cases they do not support (e.g. different color
+// depths of the source and destination), and the caller is supposed to
+// fall back to Allegro then.
+//
+// These functions are thread-safe, unlike Allegro's stretch_blit, which
+// keeps its state in a global variable.
+//
+//=============================================================================
+#ifndef __AGS_CN_GFX__BITMAPTRANSFORM_H
+#define __AGS_CN_GFX__BITMAPTRANSFORM_H
+
+#include <allegro.h> // BITMAP
+#include "core/types.h"
+#include "gfx/gfx_def.h"
+#include "util/geometry.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace BitmapTransform
+{
+    // Stretches the source rectangle into the destination rectangle using
+    // nearest-neighbour sampling, same as Allegro's stretch_blit, or
+    // masked_stretch_blit if "masked" is set. The source rectangle must be
+    // inside the source bitmap.
+    bool StretchNearest(BITMAP *dst, BITMAP *src, const Rect &src_rc, const Rect &dst_rc, bool masked);
+    // Stretches the source rectangle of a 32-bit bitmap into the destination
+    // rectangle using bilinear filtering; all the four channels (including
+    // alpha) are interpolated, and the destination pixels are replaced.
+    // The source rectangle is clamped to the source bitmap.
+    bool StretchBilinear(BITMAP *dst, BITMAP *src, const Rect &src_rc, const Rect &dst_rc);
+    // Draws a flipped image skipping the mask color pixels, same as Allegro's
+    // draw_sprite_h_flip, draw_sprite_v_flip and draw_sprite_vh_flip.
+    bool FlipSprite(BITMAP *dst, BITMAP *src, int dst_x, int dst_y, GraphicFlip flip);
+    // Draws a rotated image skipping the mask color pixels, same as Allegro's
+    // pivot_scaled_sprite with the unit scale; the arguments are in the 16.16
+    // fixed point format. Only supports rotation by the multiples of a right
+    // angle, with the sprite corners ending at the whole pixel positions.
+    bool PivotSprite(BITMAP *dst, BITMAP *src, fixed_t x, fixed_t y, fixed_t cx, fixed_t cy, fixed_t angle);
+} // namespace BitmapTransform
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_GFX__BITMAPTRANSFORM_H
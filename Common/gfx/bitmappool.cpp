@@ -0,0 +1,140 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gfx/bitmappool.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+void BitmapPoolReturner::operator()(Bitmap *bmp) const
+{
+    if (Pool)
+        Pool->Release(bmp);
+    else
+        delete bmp;
+}
+
+PooledBitmap BitmapPool::Acquire(int width, int height, int color_depth)
+{
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        auto it = _buckets.find(MakeKey(width, height, color_depth));
+        if (it != _buckets.end() && !it->second.empty())
+        {
+            // the most recently released is taken first
+            Bitmap *bmp = it->second.back().Bmp.release();
+            it->second.pop_back();
+            _size -= bmp->GetDataSize();
+            return PooledBitmap(bmp, BitmapPoolReturner(this));
+        }
+    }
+    return PooledBitmap(BitmapHelper::CreateBitmap(width, height, color_depth, kBitmapAlloc_Aligned),
+        BitmapPoolReturner(this));
+}
+
+PooledBitmap BitmapPool::AcquireTransparent(int width, int height, int color_depth)
+{
+    PooledBitmap bmp = Acquire(width, height, color_depth);
+    if (bmp)
+        bmp->ClearTransparent();
+    return bmp;
+}
+
+void BitmapPool::Release(Bitmap *bmp)
+{
+    if (!bmp)
+        return;
+    const size_t bmp_size = bmp->GetDataSize();
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        if (bmp_size <= _maxSize)
+        {
+            FreeOldest(_maxSize - bmp_size);
+            Entry entry;
+            entry.Bmp.reset(bmp);
+            entry.Stamp = ++_stamp;
+            _buckets[MakeKey(bmp->GetWidth(), bmp->GetHeight(), bmp->GetColorDepth())].push_back(std::move(entry));
+            _size += bmp_size;
+            return;
+        }
+    }
+    delete bmp;
+}
+
+size_t BitmapPool::GetSize()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    return _size;
+}
+
+void BitmapPool::SetMaxSize(size_t max_size)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    _maxSize = max_size;
+    FreeOldest(_maxSize);
+}
+
+size_t BitmapPool::Shrink(size_t size)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    return FreeOldest(_size > size ? _size - size : 0u);
+}
+
+void BitmapPool::Clear()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    _buckets.clear();
+    _size = 0u;
+}
+
+size_t BitmapPool::FreeOldest(size_t size_limit)
+{
+    size_t freed = 0u;
+    while (_size > size_limit)
+    {
+        // The pool holds few bitmaps, so the oldest one is simply searched for
+        std::vector<Entry> *oldest_bucket = nullptr;
+        size_t oldest_index = 0u;
+        for (auto &bucket : _buckets)
+        {
+            for (size_t i = 0; i < bucket.second.size(); ++i)
+            {
+                if (!oldest_bucket || bucket.second[i].Stamp < (*oldest_bucket)[oldest_index].Stamp)
+                {
+                    oldest_bucket = &bucket.second;
+                    oldest_index = i;
+                }
+            }
+        }
+        if (!oldest_bucket)
+            break;
+        const size_t bmp_size = (*oldest_bucket)[oldest_index].Bmp->GetDataSize();
+        oldest_bucket->erase(oldest_bucket->begin() + oldest_index);
+        _size -= bmp_size;
+        freed += bmp_size;
+    }
+    return freed;
+}
+
+// NOTE: the pool is never deleted, because the static pooled bitmaps across
+// the program may be destroyed after it otherwise
+BitmapPool &BitmapPool::Global()
+{
+    static BitmapPool *global_pool = new BitmapPool();
+    return *global_pool;
+}
+
+} // namespace Common
+} // namespace AGS
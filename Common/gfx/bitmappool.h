@@ -0,0 +1,116 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// BitmapPool keeps the bitmaps which were used for the transient work, such
+// as the screen copies and the transition frames, so that the next time
+// a bitmap of the same size is needed, it's taken from the pool instead of
+// allocating several megabytes of memory again.
+//
+// The bitmaps are leased as PooledBitmap, which is a unique_ptr that returns
+// the bitmap into the pool when destroyed. The pool keeps the bitmaps in
+// buckets by their size and color depth; when it exceeds its max size,
+// the bitmaps which were not used for the longest time are freed.
+//
+// The pooled bitmaps use the aligned storage (see kBitmapAlloc_Aligned), so
+// the pixel memory of the freed ones is still recycled by the bitmaps of
+// other sizes.
+//
+//=============================================================================
+#ifndef __AGS_CN_GFX__BITMAPPOOL_H
+#define __AGS_CN_GFX__BITMAPPOOL_H
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "gfx/bitmap.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class BitmapPool;
+
+// Returns the bitmap into the pool; deletes it if there's no pool
+struct BitmapPoolReturner
+{
+    BitmapPool *Pool = nullptr;
+
+    BitmapPoolReturner() = default;
+    BitmapPoolReturner(BitmapPool *owner) : Pool(owner) {}
+    void operator()(Bitmap *bmp) const;
+};
+
+// The bitmap leased from the pool
+typedef std::unique_ptr<Bitmap, BitmapPoolReturner> PooledBitmap;
+
+class BitmapPool
+{
+public:
+    // Default max total size of the pooled bitmaps, in bytes
+    static const size_t DefaultMaxSize = 32 * 1024 * 1024;
+
+    BitmapPool(size_t max_size = DefaultMaxSize) : _maxSize(max_size) {}
+    ~BitmapPool() = default;
+
+    // Gets a bitmap of the given size and color depth, either from the pool
+    // or a new one; the pixel contents are undefined
+    PooledBitmap Acquire(int width, int height, int color_depth);
+    // Same as Acquire, but clears the bitmap with the transparent color
+    PooledBitmap AcquireTransparent(int width, int height, int color_depth);
+    // Puts the bitmap into the pool, or deletes it if it does not fit
+    void Release(Bitmap *bmp);
+
+    // Gets the total size of the pooled bitmaps, in bytes
+    size_t GetSize();
+    // Sets the max total size of the pooled bitmaps, in bytes
+    void   SetMaxSize(size_t max_size);
+    // Frees the bitmaps which were not used for the longest time, until at
+    // least the given amount of memory is freed; returns the freed size
+    size_t Shrink(size_t size);
+    // Frees all the pooled bitmaps
+    void   Clear();
+
+    // Gets the pool shared by the whole program
+    static BitmapPool &Global();
+
+private:
+    struct Entry
+    {
+        std::unique_ptr<Bitmap> Bmp;
+        uint64_t Stamp = 0u; // when the bitmap was put into the pool
+    };
+
+    static uint64_t MakeKey(int width, int height, int color_depth)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(width)) << 32)
+            | (static_cast<uint64_t>(static_cast<uint16_t>(height)) << 16)
+            | static_cast<uint64_t>(static_cast<uint16_t>(color_depth));
+    }
+    // Frees the oldest bitmaps until the total size fits the given limit;
+    // must be called with the lock held
+    size_t FreeOldest(size_t size_limit);
+
+    std::mutex _mutex;
+    std::unordered_map<uint64_t, std::vector<Entry>> _buckets;
+    size_t _maxSize = 0u;
+    size_t _size = 0u;
+    uint64_t _stamp = 0u;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_GFX__BITMAPPOOL_H
@@ -0,0 +1,104 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gfx/bitmask.h"
+#include <algorithm>
+#include "gfx/bitmap.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+template <typename TPixel>
+static void MakeMaskRow(const uint8_t *src_line, int width, TPixel mask_color, TPixel color_bits, uint64_t *dst)
+{
+    const TPixel *src = reinterpret_cast<const TPixel*>(src_line);
+    for (int x = 0; x < width; ++x)
+    {
+        if ((src[x] & color_bits) != mask_color)
+            dst[x >> 6] |= (uint64_t)1u << (x & 63);
+    }
+}
+
+BitMask::BitMask(const Bitmap *bmp)
+    : _width(bmp->GetWidth())
+    , _height(bmp->GetHeight())
+    , _stride((bmp->GetWidth() + 63) / 64)
+    , _bits(_stride * _height)
+{
+    const int bpp = bmp->GetBPP();
+    const color_t mask_color = bmp->GetMaskColor();
+    for (int y = 0; y < _height; ++y)
+    {
+        const uint8_t *src = bmp->GetScanLine(y);
+        uint64_t *dst = &_bits[y * _stride];
+        switch (bpp)
+        {
+        case 1: MakeMaskRow<uint8_t>(src, _width, static_cast<uint8_t>(mask_color), 0xFF, dst); break;
+        case 2: MakeMaskRow<uint16_t>(src, _width, static_cast<uint16_t>(mask_color), 0xFFFF, dst); break;
+        case 4: // the alpha channel is ignored, like when testing single pixels
+            MakeMaskRow<uint32_t>(src, _width, static_cast<uint32_t>(mask_color) & 0xFFFFFF, 0xFFFFFF, dst); break;
+        default:
+            for (int x = 0; x < _width; ++x)
+            {
+                if ((static_cast<color_t>(bmp->GetPixel(x, y)) & 0xFFFFFF) != (mask_color & 0xFFFFFF))
+                    dst[x >> 6] |= (uint64_t)1u << (x & 63);
+            }
+            break;
+        }
+    }
+}
+
+uint64_t BitMask::GetBits(int y, int x) const
+{
+    if ((x >= _width) || (x <= -64))
+        return 0u;
+    const uint64_t *row = &_bits[y * _stride];
+    if (x < 0)
+        return row[0] << (-x);
+    const int word = x >> 6, shift = x & 63;
+    uint64_t bits = row[word] >> shift;
+    if ((shift > 0) && (word + 1 < _stride))
+        bits |= row[word + 1] << (64 - shift);
+    return bits;
+}
+
+bool BitMask::Overlaps(const BitMask &other, int ox, int oy, const Rect &area) const
+{
+    const Rect rc = IntersectRects(IntersectRects(area, RectWH(0, 0, _width, _height)),
+        RectWH(ox, oy, other._width, other._height));
+    if (rc.IsEmpty())
+        return false;
+
+    const int first_word = rc.Left >> 6, last_word = rc.Right >> 6;
+    for (int y = rc.Top; y <= rc.Bottom; ++y)
+    {
+        const uint64_t *row = &_bits[y * _stride];
+        for (int w = first_word; w <= last_word; ++w)
+        {
+            uint64_t bits = row[w];
+            // cut off the pixels outside of the tested columns
+            if (w == first_word)
+                bits &= ~(uint64_t)0u << (rc.Left & 63);
+            if ((w == last_word) && ((rc.Right & 63) < 63))
+                bits &= ~(~(uint64_t)0u << ((rc.Right & 63) + 1));
+            if (bits & other.GetBits(y - oy, w * 64 - ox))
+                return true;
+        }
+    }
+    return false;
+}
+
+} // namespace Common
+} // namespace AGS
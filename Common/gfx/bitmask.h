@@ -0,0 +1,79 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// BitMask is a packed 1-bit opacity mask of an image, where each set bit
+// is a pixel that is not of the image's mask color. The rows are stored
+// as 64-bit words, so that the overlap of two masks is tested 64 pixels
+// at a time.
+//
+//=============================================================================
+#ifndef __AGS_CN_GFX__BITMASK_H
+#define __AGS_CN_GFX__BITMASK_H
+
+#include <vector>
+#include "core/types.h"
+#include "util/geometry.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class Bitmap;
+
+class BitMask
+{
+public:
+    BitMask() = default;
+    // Creates the mask of the bitmap's opaque pixels
+    explicit BitMask(const Bitmap *bmp);
+
+    int  GetWidth() const { return _width; }
+    int  GetHeight() const { return _height; }
+    // Gets the memory used by the mask bits, in bytes
+    size_t GetMemorySize() const { return _bits.size() * sizeof(uint64_t); }
+
+    // Tells if the pixel is opaque; the pixels outside of the mask are not
+    bool IsSet(int x, int y) const
+    {
+        if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height))
+            return false;
+        return ((_bits[y * _stride + (x >> 6)] >> (x & 63)) & 1u) != 0;
+    }
+
+    // Tells if any opaque pixel inside the area of this mask coincides with
+    // an opaque pixel of the other mask, when the other mask's top-left
+    // corner is placed at (ox, oy) in this mask's coordinates
+    bool Overlaps(const BitMask &other, int ox, int oy, const Rect &area) const;
+    // Same as above, for the whole area of this mask
+    bool Overlaps(const BitMask &other, int ox, int oy) const
+    {
+        return Overlaps(other, ox, oy, RectWH(0, 0, _width, _height));
+    }
+
+private:
+    // Gets 64 bits of the row, starting with the given pixel; the pixels
+    // outside of the mask are read as zero bits
+    uint64_t GetBits(int y, int x) const;
+
+    int _width = 0;
+    int _height = 0;
+    int _stride = 0; // row length, in 64-bit words
+    std::vector<uint64_t> _bits;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_GFX__BITMASK_H
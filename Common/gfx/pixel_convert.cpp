@@ -0,0 +1,300 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gfx/pixel_convert.h"
+#include <allegro.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define AGS_PIXELCONVERT_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AGS_PIXELCONVERT_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace PixelConvert
+{
+
+namespace
+{
+
+// Expands the 5 and 6-bit channels to 8 bits by replicating the high bits,
+// which gives the same values as Allegro's _rgb_scale_5 and _rgb_scale_6
+inline uint32_t scale5(uint32_t c) { return (c << 3) | (c >> 2); }
+inline uint32_t scale6(uint32_t c) { return (c << 2) | (c >> 4); }
+
+inline uint32_t make_pixel(uint32_t r, uint32_t g, uint32_t b, uint32_t a, const ChannelShifts &dst)
+{
+    return (r << dst.R) | (g << dst.G) | (b << dst.B) | (a << dst.A);
+}
+
+} // namespace
+
+RowConverter::RowConverter(int src_depth, const ChannelShifts &dst_shifts, AlphaMode alpha)
+    : _srcDepth(src_depth)
+    , _src16(_rgb_r_shift_16, _rgb_g_shift_16, _rgb_b_shift_16, 0)
+    , _src32(_rgb_r_shift_32, _rgb_g_shift_32, _rgb_b_shift_32, _rgb_a_shift_32)
+    , _dst(dst_shifts)
+    , _alpha(alpha)
+{
+    if (src_depth == 8)
+    {
+        for (int c = 0; c < 256; ++c)
+            _palette[c] = make_pixel(getr8(c), getg8(c), getb8(c), 0xFF, _dst);
+        if (alpha == kAlpha_MaskColor)
+            _palette[MASK_COLOR_8] = 0;
+    }
+}
+
+void RowConverter::Convert(uint32_t *dst, const uint8_t *src, int count) const
+{
+    switch (_srcDepth)
+    {
+    case 8: Convert8(dst, src, count); break;
+    case 16: Convert16(dst, reinterpret_cast<const uint16_t*>(src), count); break;
+    case 32: Convert32(dst, reinterpret_cast<const uint32_t*>(src), count); break;
+    default: break;
+    }
+}
+
+void RowConverter::Convert8(uint32_t *dst, const uint8_t *src, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        dst[i] = _palette[src[i]];
+}
+
+void RowConverter::Convert16(uint32_t *dst, const uint16_t *src, int count) const
+{
+    const bool masked = _alpha == kAlpha_MaskColor;
+    const uint32_t alpha_bits = 0xFFu << _dst.A;
+    int i = 0;
+#if AGS_PIXELCONVERT_SSE2
+    const __m128i src_r = _mm_cvtsi32_si128(_src16.R), src_g = _mm_cvtsi32_si128(_src16.G),
+        src_b = _mm_cvtsi32_si128(_src16.B);
+    const __m128i dst_r = _mm_cvtsi32_si128(_dst.R), dst_g = _mm_cvtsi32_si128(_dst.G),
+        dst_b = _mm_cvtsi32_si128(_dst.B);
+    const __m128i bits5 = _mm_set1_epi16(0x1F), bits6 = _mm_set1_epi16(0x3F);
+    const __m128i vmask = _mm_set1_epi16(static_cast<short>(MASK_COLOR_16));
+    const __m128i valpha = _mm_set1_epi32(static_cast<int>(alpha_bits));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i r5 = _mm_and_si128(_mm_srl_epi16(s, src_r), bits5);
+        const __m128i g6 = _mm_and_si128(_mm_srl_epi16(s, src_g), bits6);
+        const __m128i b5 = _mm_and_si128(_mm_srl_epi16(s, src_b), bits5);
+        const __m128i r = _mm_or_si128(_mm_slli_epi16(r5, 3), _mm_srli_epi16(r5, 2));
+        const __m128i g = _mm_or_si128(_mm_slli_epi16(g6, 2), _mm_srli_epi16(g6, 4));
+        const __m128i b = _mm_or_si128(_mm_slli_epi16(b5, 3), _mm_srli_epi16(b5, 2));
+        __m128i lo = _mm_or_si128(_mm_or_si128(
+            _mm_sll_epi32(_mm_unpacklo_epi16(r, zero), dst_r),
+            _mm_sll_epi32(_mm_unpacklo_epi16(g, zero), dst_g)),
+            _mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(b, zero), dst_b), valpha));
+        __m128i hi = _mm_or_si128(_mm_or_si128(
+            _mm_sll_epi32(_mm_unpackhi_epi16(r, zero), dst_r),
+            _mm_sll_epi32(_mm_unpackhi_epi16(g, zero), dst_g)),
+            _mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(b, zero), dst_b), valpha));
+        if (masked)
+        {
+            const __m128i m = _mm_cmpeq_epi16(s, vmask);
+            lo = _mm_andnot_si128(_mm_unpacklo_epi16(m, m), lo);
+            hi = _mm_andnot_si128(_mm_unpackhi_epi16(m, m), hi);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), hi);
+    }
+#elif AGS_PIXELCONVERT_NEON
+    const int16x8_t src_r = vdupq_n_s16(static_cast<int16_t>(-_src16.R)),
+        src_g = vdupq_n_s16(static_cast<int16_t>(-_src16.G)), src_b = vdupq_n_s16(static_cast<int16_t>(-_src16.B));
+    const int32x4_t dst_r = vdupq_n_s32(_dst.R), dst_g = vdupq_n_s32(_dst.G), dst_b = vdupq_n_s32(_dst.B);
+    const uint16x8_t bits5 = vdupq_n_u16(0x1F), bits6 = vdupq_n_u16(0x3F);
+    const uint16x8_t vmask = vdupq_n_u16(MASK_COLOR_16);
+    const uint32x4_t valpha = vdupq_n_u32(alpha_bits);
+    for (; i + 8 <= count; i += 8)
+    {
+        const uint16x8_t s = vld1q_u16(src + i);
+        const uint16x8_t r5 = vandq_u16(vshlq_u16(s, src_r), bits5);
+        const uint16x8_t g6 = vandq_u16(vshlq_u16(s, src_g), bits6);
+        const uint16x8_t b5 = vandq_u16(vshlq_u16(s, src_b), bits5);
+        const uint16x8_t r = vorrq_u16(vshlq_n_u16(r5, 3), vshrq_n_u16(r5, 2));
+        const uint16x8_t g = vorrq_u16(vshlq_n_u16(g6, 2), vshrq_n_u16(g6, 4));
+        const uint16x8_t b = vorrq_u16(vshlq_n_u16(b5, 3), vshrq_n_u16(b5, 2));
+        uint32x4_t lo = vorrq_u32(vorrq_u32(
+            vshlq_u32(vmovl_u16(vget_low_u16(r)), dst_r),
+            vshlq_u32(vmovl_u16(vget_low_u16(g)), dst_g)),
+            vorrq_u32(vshlq_u32(vmovl_u16(vget_low_u16(b)), dst_b), valpha));
+        uint32x4_t hi = vorrq_u32(vorrq_u32(
+            vshlq_u32(vmovl_u16(vget_high_u16(r)), dst_r),
+            vshlq_u32(vmovl_u16(vget_high_u16(g)), dst_g)),
+            vorrq_u32(vshlq_u32(vmovl_u16(vget_high_u16(b)), dst_b), valpha));
+        if (masked)
+        {
+            // the comparison gives all ones, which stay so when sign-extended
+            const int16x8_t m = vreinterpretq_s16_u16(vceqq_u16(s, vmask));
+            lo = vbicq_u32(lo, vreinterpretq_u32_s32(vmovl_s16(vget_low_s16(m))));
+            hi = vbicq_u32(hi, vreinterpretq_u32_s32(vmovl_s16(vget_high_s16(m))));
+        }
+        vst1q_u32(dst + i, lo);
+        vst1q_u32(dst + i + 4, hi);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        const uint32_t c = src[i];
+        if (masked && (c == MASK_COLOR_16))
+        {
+            dst[i] = 0;
+            continue;
+        }
+        dst[i] = make_pixel(scale5((c >> _src16.R) & 0x1F), scale6((c >> _src16.G) & 0x3F),
+            scale5((c >> _src16.B) & 0x1F), 0xFF, _dst);
+    }
+}
+
+void RowConverter::Convert32(uint32_t *dst, const uint32_t *src, int count) const
+{
+    const bool masked = _alpha == kAlpha_MaskColor;
+    const bool src_alpha = _alpha == kAlpha_Source;
+    const uint32_t alpha_bits = 0xFFu << _dst.A;
+    int i = 0;
+#if AGS_PIXELCONVERT_SSE2
+    const __m128i src_r = _mm_cvtsi32_si128(_src32.R), src_g = _mm_cvtsi32_si128(_src32.G),
+        src_b = _mm_cvtsi32_si128(_src32.B), src_a = _mm_cvtsi32_si128(_src32.A);
+    const __m128i dst_r = _mm_cvtsi32_si128(_dst.R), dst_g = _mm_cvtsi32_si128(_dst.G),
+        dst_b = _mm_cvtsi32_si128(_dst.B), dst_a = _mm_cvtsi32_si128(_dst.A);
+    const __m128i bits8 = _mm_set1_epi32(0xFF);
+    const __m128i vmask = _mm_set1_epi32(MASK_COLOR_32);
+    const __m128i valpha = _mm_set1_epi32(static_cast<int>(alpha_bits));
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i d = _mm_or_si128(_mm_or_si128(
+            _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(s, src_r), bits8), dst_r),
+            _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(s, src_g), bits8), dst_g)),
+            _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(s, src_b), bits8), dst_b));
+        if (src_alpha)
+            d = _mm_or_si128(d, _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(s, src_a), bits8), dst_a));
+        else
+            d = _mm_or_si128(d, valpha);
+        if (masked)
+            d = _mm_andnot_si128(_mm_cmpeq_epi32(s, vmask), d);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), d);
+    }
+#elif AGS_PIXELCONVERT_NEON
+    const int32x4_t src_r = vdupq_n_s32(-_src32.R), src_g = vdupq_n_s32(-_src32.G),
+        src_b = vdupq_n_s32(-_src32.B), src_a = vdupq_n_s32(-_src32.A);
+    const int32x4_t dst_r = vdupq_n_s32(_dst.R), dst_g = vdupq_n_s32(_dst.G),
+        dst_b = vdupq_n_s32(_dst.B), dst_a = vdupq_n_s32(_dst.A);
+    const uint32x4_t bits8 = vdupq_n_u32(0xFF);
+    const uint32x4_t vmask = vdupq_n_u32(MASK_COLOR_32);
+    const uint32x4_t valpha = vdupq_n_u32(alpha_bits);
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t s = vld1q_u32(src + i);
+        uint32x4_t d = vorrq_u32(vorrq_u32(
+            vshlq_u32(vandq_u32(vshlq_u32(s, src_r), bits8), dst_r),
+            vshlq_u32(vandq_u32(vshlq_u32(s, src_g), bits8), dst_g)),
+            vshlq_u32(vandq_u32(vshlq_u32(s, src_b), bits8), dst_b));
+        if (src_alpha)
+            d = vorrq_u32(d, vshlq_u32(vandq_u32(vshlq_u32(s, src_a), bits8), dst_a));
+        else
+            d = vorrq_u32(d, valpha);
+        if (masked)
+            d = vbicq_u32(d, vceqq_u32(s, vmask));
+        vst1q_u32(dst + i, d);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        const uint32_t c = src[i];
+        if (masked && (c == MASK_COLOR_32))
+        {
+            dst[i] = 0;
+            continue;
+        }
+        dst[i] = make_pixel((c >> _src32.R) & 0xFF, (c >> _src32.G) & 0xFF, (c >> _src32.B) & 0xFF,
+            src_alpha ? ((c >> _src32.A) & 0xFF) : 0xFF, _dst);
+    }
+}
+
+void SwapRedBlue32(uint32_t *row, int count)
+{
+    int i = 0;
+#if AGS_PIXELCONVERT_SSE2
+    const __m128i ag_bits = _mm_set1_epi32(static_cast<int>(0xFF00FF00u));
+    const __m128i b_bits = _mm_set1_epi32(0xFF);
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        const __m128i d = _mm_or_si128(_mm_and_si128(s, ag_bits), _mm_or_si128(
+            _mm_and_si128(_mm_srli_epi32(s, 16), b_bits), _mm_slli_epi32(_mm_and_si128(s, b_bits), 16)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), d);
+    }
+#elif AGS_PIXELCONVERT_NEON
+    const uint32x4_t ag_bits = vdupq_n_u32(0xFF00FF00u);
+    const uint32x4_t b_bits = vdupq_n_u32(0xFF);
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t s = vld1q_u32(row + i);
+        vst1q_u32(row + i, vorrq_u32(vandq_u32(s, ag_bits), vorrq_u32(
+            vandq_u32(vshrq_n_u32(s, 16), b_bits), vshlq_n_u32(vandq_u32(s, b_bits), 16))));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        const uint32_t c = row[i];
+        row[i] = (c & 0xFF00FF00u) | ((c >> 16) & 0xFF) | ((c & 0xFF) << 16);
+    }
+}
+
+void ReplaceAlphaWithMask32(uint32_t *row, int count)
+{
+    const uint32_t alpha_bits = 0xFFu << _rgb_a_shift_32;
+    int i = 0;
+#if AGS_PIXELCONVERT_SSE2
+    const __m128i valpha = _mm_set1_epi32(static_cast<int>(alpha_bits));
+    const __m128i vmask = _mm_set1_epi32(MASK_COLOR_32);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        const __m128i m = _mm_cmpeq_epi32(_mm_and_si128(s, valpha), zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i),
+            _mm_or_si128(_mm_and_si128(m, vmask), _mm_andnot_si128(m, s)));
+    }
+#elif AGS_PIXELCONVERT_NEON
+    const uint32x4_t valpha = vdupq_n_u32(alpha_bits);
+    const uint32x4_t vmask = vdupq_n_u32(MASK_COLOR_32);
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t s = vld1q_u32(row + i);
+        // vtstq sets the lanes which have any alpha bits
+        vst1q_u32(row + i, vbslq_u32(vtstq_u32(s, valpha), s, vmask));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        if ((row[i] & alpha_bits) == 0)
+            row[i] = MASK_COLOR_32;
+    }
+}
+
+} // namespace PixelConvert
+
+} // namespace Common
+} // namespace AGS
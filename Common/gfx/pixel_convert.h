@@ -0,0 +1,94 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Pixel format conversion kernels: convert the rows of Allegro's 8, 16 and
+// 32-bit pixels into the 32-bit pixels with the given channel positions,
+// such as the ones of the textures, and fix up the 32-bit pixels in place.
+//
+// The results are exactly the same as of converting each pixel with Allegro's
+// getr/getg/getb/geta functions. The 16 and 32-bit rows are converted with
+// SIMD where it's available; the 8-bit ones are looked up in the table made
+// from the current palette.
+//
+//=============================================================================
+#ifndef __AGS_CN_GFX__PIXELCONVERT_H
+#define __AGS_CN_GFX__PIXELCONVERT_H
+
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace PixelConvert
+{
+    // How the alpha of the converted pixels is set
+    enum AlphaMode
+    {
+        // All the pixels are opaque
+        kAlpha_Opaque,
+        // The pixels of the mask color become fully transparent black,
+        // the rest are opaque
+        kAlpha_MaskColor,
+        // The alpha is copied from the source pixels; only the 32-bit
+        // pixels have it, the others are opaque
+        kAlpha_Source
+    };
+
+    // Bit positions of the channels in the 32-bit destination pixel
+    struct ChannelShifts
+    {
+        int R = 16, G = 8, B = 0, A = 24;
+
+        ChannelShifts() = default;
+        ChannelShifts(int r, int g, int b, int a) : R(r), G(g), B(b), A(a) {}
+    };
+
+    // Converts the rows of pixels of the given source color depth. Reads
+    // Allegro's pixel format and palette when created, so is meant to be
+    // created for each bitmap conversion, and not kept for long.
+    class RowConverter
+    {
+    public:
+        RowConverter(int src_depth, const ChannelShifts &dst_shifts, AlphaMode alpha);
+
+        // Converts the count of pixels from the source row into the destination one
+        void Convert(uint32_t *dst, const uint8_t *src, int count) const;
+
+    private:
+        void Convert8(uint32_t *dst, const uint8_t *src, int count) const;
+        void Convert16(uint32_t *dst, const uint16_t *src, int count) const;
+        void Convert32(uint32_t *dst, const uint32_t *src, int count) const;
+
+        int _srcDepth = 0;
+        ChannelShifts _src16;
+        ChannelShifts _src32;
+        ChannelShifts _dst;
+        AlphaMode _alpha = kAlpha_Opaque;
+        // The converted palette colors, for the 8-bit pixels
+        uint32_t _palette[256] = {};
+    };
+
+    // Swaps the red and blue channels of the 32-bit pixels with the default
+    // channel positions, that is the 1st and 3rd bytes of each pixel in memory
+    void SwapRedBlue32(uint32_t *row, int count);
+    // Replaces the 32-bit pixels which have zero alpha with the mask color
+    void ReplaceAlphaWithMask32(uint32_t *row, int count);
+} // namespace PixelConvert
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_GFX__PIXELCONVERT_H
@@ -36,6 +36,18 @@ GUIInvWindow::GUIInvWindow()
     _scEventCount = 0;
 }
 
+void GUIInvWindow::OnSpriteUpdated(int sprnum)
+{
+    for (auto &pic : _cellPics)
+    {
+        if (pic == sprnum)
+        {
+            pic = -2;
+            MarkChanged();
+        }
+    }
+}
+
 void GUIInvWindow::OnMouseEnter()
 {
     IsMouseOver = true;
@@ -14,6 +14,7 @@
 #ifndef __AC_GUIINV_H
 #define __AC_GUIINV_H
 
+#include <memory>
 #include <vector>
 #include "gui/guiobject.h"
 
@@ -34,6 +35,9 @@ public:
     // Operations
     // This function has distinct implementations in Engine and Editor
     void Draw(Bitmap *ds, int x = 0, int y = 0) override;
+    // Tells that the sprite's image was changed, and the cells displaying it
+    // have to be redrawn
+    void OnSpriteUpdated(int sprnum);
 
     // Events
     void OnMouseEnter() override;
@@ -59,6 +63,22 @@ public:
 
 private:
     void CalculateNumCells();
+    // Draws the visible items directly on the destination surface
+    void DrawItems(Bitmap *ds, int x, int y, int cell_w, int cell_h, int last_item);
+    // Tells if the visible items may be drawn through the cached grid image
+    bool CanUseCellCache(int cell_w, int cell_h, int last_item) const;
+    // Redraws the cells of the cached grid image whose items have changed
+    void UpdateCellCache(int color_depth, int cell_w, int cell_h, int last_item);
+
+    // Cached grid image with the visible items, and the sprites drawn in
+    // each of its cells (-1 for the empty cell, -2 for the cell which has to be
+    // redrawn); lets redraw only the cells whose items have changed.
+    // Used by the engine only.
+    std::shared_ptr<Bitmap> _cellCache;
+    std::vector<int> _cellPics;
+    int _cellCacheTop = 0;
+    int _cellCacheW = 0;
+    int _cellCacheH = 0;
 };
 
 } // namespace Common
@@ -125,6 +125,16 @@ int GUIListBox::AddItem(const String &text)
     return ItemCount - 1;
 }
 
+void GUIListBox::AddItems(const std::vector<String> &items)
+{
+    if (items.empty())
+        return;
+    Items.insert(Items.end(), items.begin(), items.end());
+    SavedGameIndex.resize(Items.size(), -1);
+    ItemCount = static_cast<int32_t>(Items.size());
+    MarkChanged();
+}
+
 void GUIListBox::Clear()
 {
     if (Items.empty())
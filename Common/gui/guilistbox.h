@@ -37,6 +37,8 @@ public:
 
     // Operations
     int  AddItem(const String &text);
+    // Appends a number of items at once, marks the control changed only once
+    void AddItems(const std::vector<String> &items);
     void Clear();
     Rect CalcGraphicRect(bool clipped) override;
     void Draw(Bitmap *ds, int x = 0, int y = 0) override;
@@ -58,7 +58,9 @@ void GUIMain::InitDefaults()
     _flags        = kGUIMain_DefFlags;
     _hasChanged   = true;
     _hasControlsChanged = true;
+    _hasControlsLayoutChanged = true;
     _polling      = false;
+    _ctrlGridValid = false;
 
     X             = 0;
     Y             = 0;
@@ -95,6 +97,27 @@ int GUIMain::FindControlAt(int atx, int aty, int leeway, bool must_be_clickable)
 
 int32_t GUIMain::FindControlAtLocal(int atx, int aty, int leeway, bool must_be_clickable) const
 {
+    // Only test the controls registered in the grid cell under the point
+    if ((leeway == 0) && (atx >= 0) && (aty >= 0) && (atx < Width) && (aty < Height) &&
+        (_ctrlDrawOrder.size() == _controls.size()))
+    {
+        if (!_ctrlGridValid || !(_ctrlGridGuiSize == Size(Width, Height)))
+            RebuildControlGrid();
+        const auto &cell = _ctrlGrid[(aty / ControlGridCellSize) * _ctrlGridCells.Width + atx / ControlGridCellSize];
+        GUI::HitTestStats.Queries++;
+        GUI::HitTestStats.Skipped += _controls.size() - cell.size();
+        for (const int ctrl_index : cell)
+        {
+            GUI::HitTestStats.Tested++;
+            const GUIObject *obj = _controls[ctrl_index];
+            if (!obj->IsClickable() && must_be_clickable)
+                continue;
+            if (obj->IsOverControl(atx, aty, 0))
+                return ctrl_index;
+        }
+        return -1;
+    }
+
     if (loaded_game_file_version <= kGameVersion_262)
     {
         // Ignore draw order On 2.6.2 and lower
@@ -124,6 +147,36 @@ int32_t GUIMain::FindControlAtLocal(int atx, int aty, int leeway, bool must_be_c
     return -1;
 }
 
+void GUIMain::RebuildControlGrid() const
+{
+    const int cell_size = ControlGridCellSize;
+    const int cols = std::max(1, (Width + cell_size - 1) / cell_size);
+    const int rows = std::max(1, (Height + cell_size - 1) / cell_size);
+    _ctrlGrid.resize(cols * rows);
+    for (auto &cell : _ctrlGrid)
+        cell.clear();
+    _ctrlGridCells = Size(cols, rows);
+    _ctrlGridGuiSize = Size(Width, Height);
+
+    // Ignore draw order on 2.6.2 and lower, otherwise test from the topmost control
+    const bool use_draw_order = loaded_game_file_version > kGameVersion_262;
+    const Rect gui_rc = RectWH(0, 0, Width, Height);
+    for (size_t i = 0; i < _controls.size(); ++i)
+    {
+        const int ctrl_index = use_draw_order ? _ctrlDrawOrder[_controls.size() - 1 - i] : i;
+        const GUIObject *obj = _controls[ctrl_index];
+        if (!obj->IsVisible())
+            continue;
+        const Rect rc = IntersectRects(RectWH(obj->X, obj->Y, obj->GetWidth(), obj->GetHeight()), gui_rc);
+        if (rc.IsEmpty())
+            continue;
+        for (int cy = rc.Top / cell_size; cy <= rc.Bottom / cell_size; ++cy)
+            for (int cx = rc.Left / cell_size; cx <= rc.Right / cell_size; ++cx)
+                _ctrlGrid[cy * cols + cx].push_back(ctrl_index);
+    }
+    _ctrlGridValid = true;
+}
+
 int GUIMain::GetControlCount() const
 {
     return (int32_t)_controls.size();
@@ -181,12 +234,20 @@ void GUIMain::MarkControlChanged()
     _hasControlsChanged = true;
 }
 
+void GUIMain::MarkControlLayoutChanged()
+{
+    _hasControlsChanged = true;
+    _hasControlsLayoutChanged = true;
+}
+
 void GUIMain::NotifyControlPosition()
 {
     // Force it to re-check for which control is under the mouse
     MouseWasAt.X = -1;
     MouseWasAt.Y = -1;
     _hasControlsChanged = true; // for software render, and in case of shape change
+    _hasControlsLayoutChanged = true;
+    _ctrlGridValid = false;
 }
 
 void GUIMain::NotifyControlState(int objid, bool mark_changed)
@@ -194,6 +255,8 @@ void GUIMain::NotifyControlState(int objid, bool mark_changed)
     MouseWasAt.X = -1;
     MouseWasAt.Y = -1;
     _hasControlsChanged |= mark_changed;
+    _hasControlsLayoutChanged |= mark_changed;
+    _ctrlGridValid = false; // visibility may have changed
     // Update cursor-over-control state, if necessary
     const int overctrl = MouseOverCtrl;
     if (!_polling &&
@@ -211,6 +274,7 @@ void GUIMain::ClearChanged()
 {
     _hasChanged = false;
     _hasControlsChanged = false;
+    _hasControlsLayoutChanged = false;
 }
 
 void GUIMain::ResetOverControl()
@@ -227,12 +291,14 @@ void GUIMain::AddControl(GUIControlType type, int id, GUIObject *control)
 {
     _ctrlRefs.emplace_back(type, id);
     _controls.push_back(control);
+    _ctrlGridValid = false;
 }
 
 void GUIMain::RemoveAllControls()
 {
     _ctrlRefs.clear();
     _controls.clear();
+    _ctrlGridValid = false;
 }
 
 bool GUIMain::BringControlToFront(int index)
@@ -284,7 +350,33 @@ void GUIMain::DrawWithControls(Bitmap *ds)
     DrawControls(ds);
 }
 
+void GUIMain::DrawWithControls(Bitmap *ds, const Rect &area)
+{
+    const Rect draw_area = IntersectRects(area, RectWH(ds->GetSize()));
+    if (draw_area.IsEmpty())
+        return;
+    ds->SetClip(draw_area);
+    ds->FillRect(draw_area, ds->GetMaskColor());
+    DrawSelf(ds);
+    DrawControls(ds, draw_area);
+    ds->ResetClip();
+}
+
 void GUIMain::DrawControls(Bitmap *ds)
+{
+    DrawControls(ds, RectWH(ds->GetSize()));
+}
+
+Rect GUIMain::GetControlDrawRect(int index) const
+{
+    GUIObject *obj = _controls[index];
+    const Rect rc = obj->CalcGraphicRect(GUI::Options.ClipControls && obj->IsContentClipped());
+    // Include the control's own bounds, for the highlight and outline marks
+    return SumRects(RectWH(obj->X + rc.Left, obj->Y + rc.Top, rc.GetWidth(), rc.GetHeight()),
+        RectWH(obj->X, obj->Y, obj->GetWidth(), obj->GetHeight()));
+}
+
+void GUIMain::DrawControls(Bitmap *ds, const Rect &area)
 {
     if ((GUI::Context.DisabledState != kGuiDis_Undefined) && (GUI::Options.DisabledStyle == kGuiDis_Blackout))
         return; // don't draw GUI controls
@@ -301,14 +393,16 @@ void GUIMain::DrawControls(Bitmap *ds)
             continue;
         if (!objToDraw->IsEnabled() && (GUI::Options.DisabledStyle == kGuiDis_Blackout))
             continue;
+        if (!AreRectsIntersecting(GetControlDrawRect(_ctrlDrawOrder[ctrl_index]), area))
+            continue;
 
         // Depending on draw properties - draw directly on the gui surface, or use a buffer
         if (objToDraw->GetTransparency() == 0)
         {
             if (GUI::Options.ClipControls && objToDraw->IsContentClipped())
-                ds->SetClip(RectWH(objToDraw->X, objToDraw->Y, obj_size.Width, obj_size.Height));
+                ds->SetClip(IntersectRects(RectWH(objToDraw->X, objToDraw->Y, obj_size.Width, obj_size.Height), area));
             else
-                ds->ResetClip();
+                ds->SetClip(area);
             objToDraw->Draw(ds, objToDraw->X, objToDraw->Y);
         }
         else
@@ -450,6 +544,7 @@ void GUIMain::ResortZOrder()
     _ctrlDrawOrder.resize(ctrl_sort.size());
     for (size_t i = 0; i < ctrl_sort.size(); ++i)
         _ctrlDrawOrder[i] = ctrl_sort[i]->Id;
+    _ctrlGridValid = false;
 }
 
 void GUIMain::SetClickable(bool on)
@@ -662,6 +757,8 @@ void GUIMain::WriteToFile(Stream *out) const
 
 void GUIMain::ReadFromSavegame(Common::Stream *in, GuiSvgVersion svg_version)
 {
+    // Controls are restored separately, and may change their position
+    _ctrlGridValid = false;
     // Properties
     _flags = in->ReadInt32();
     X = in->ReadInt32();
@@ -724,6 +821,7 @@ namespace GUI
 {
 
 GuiVersion GameGuiVersion = kGuiVersion_Initial;
+GuiHitTestStats HitTestStats;
 
 Line CalcFontGraphicalVExtent(int font)
 {
@@ -123,12 +123,18 @@ public:
     // Tells if GUI has graphically changed recently
     bool    HasChanged() const { return _hasChanged; }
     bool    HasControlsChanged() const { return _hasControlsChanged; }
+    // Tells if any of the controls changed in a way that requires to redraw
+    // the whole GUI, rather than only the changed controls
+    bool    HasControlsLayoutChanged() const { return _hasControlsLayoutChanged; }
     // Manually marks GUI as graphically changed.
     // NOTE: this only matters if GUI's own graphic changes (content, size etc),
     // but not its state (visible) or texture drawing mode (transparency, etc).
     void    MarkChanged();
     // Marks GUI as having any of its controls changed its looks.
     void    MarkControlChanged();
+    // Marks GUI as having any of its controls changed its drawing properties
+    // (transparency, etc), which affects anything drawn behind or above it.
+    void    MarkControlLayoutChanged();
     // Clears changed flag
     void    ClearChanged();
     // Notify GUI about any of its controls changing its location.
@@ -162,7 +168,12 @@ public:
     bool    BringControlToFront(int index);
     void    DrawSelf(Bitmap *ds);
     void    DrawWithControls(Bitmap *ds);
+    // Redraws only the given area of the GUI surface, with the controls in it
+    void    DrawWithControls(Bitmap *ds, const Rect &area);
     void    DrawControls(Bitmap *ds);
+    void    DrawControls(Bitmap *ds, const Rect &area);
+    // Returns the area covered by the control when it's drawn on the GUI surface
+    Rect    GetControlDrawRect(int index) const;
     // Polls GUI state, providing current cursor (mouse) coordinates
     void    Poll(int mx, int my);
     // Reconnects this GUIMain with the child controls from the global guiobject collection
@@ -199,6 +210,8 @@ private:
     void    DrawBlob(Bitmap *ds, int x, int y, color_t draw_color);
     // Same as FindControlAt but expects local space coordinates
     int32_t FindControlAtLocal(int atx, int aty, int leeway, bool must_be_clickable) const;
+    // Rebuilds the grid of controls, used for finding controls at the given point
+    void    RebuildControlGrid() const;
 
     // TODO: all members are currently public; hide them later
 public:
@@ -231,6 +244,7 @@ private:
     int32_t _flags;         // style and behavior flags
     bool    _hasChanged;    // flag tells whether GUI has graphically changed recently
     bool    _hasControlsChanged;
+    bool    _hasControlsLayoutChanged;
     bool    _polling;       // inside the polling process
 
     // Array of types and control indexes in global GUI object arrays;
@@ -241,6 +255,16 @@ private:
     std::vector<GUIObject*> _controls;
     // Sorted array of controls in z-order.
     std::vector<int32_t>    _ctrlDrawOrder;
+
+    // Size of the control grid's cell, in pixels
+    static const int ControlGridCellSize = 32;
+    // Uniform grid over the GUI's area; each cell lists the visible controls
+    // that overlap it, in the order in which they have to be tested for hits.
+    // Rebuilt on demand after the controls change position or state.
+    mutable std::vector<std::vector<int32_t>> _ctrlGrid;
+    mutable Size _ctrlGridCells;   // grid size, in cells
+    mutable Size _ctrlGridGuiSize; // GUI size the grid was built for
+    mutable bool _ctrlGridValid;
 };
 
 
@@ -257,6 +281,14 @@ struct GuiOptions
 
 class SpriteCache;
 
+// Statistics of the control lookups under a point
+struct GuiHitTestStats
+{
+    uint32_t Queries = 0u; // lookups made using the control grid
+    uint32_t Tested = 0u;  // controls tested for hits
+    uint32_t Skipped = 0u; // controls skipped, because they were not in the grid cell
+};
+
 // Global GUI context, affects controls behavior (drawing, updating)
 struct GuiContext
 {
@@ -276,6 +308,7 @@ namespace GUI
     extern GuiVersion GameGuiVersion;
     extern GuiOptions Options;
     extern GuiContext Context;
+    extern GuiHitTestStats HitTestStats;
 
     // Tells if the given control is considered enabled, taking global flag into account
     inline bool IsGUIEnabled(GUIObject *g)
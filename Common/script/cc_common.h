@@ -52,6 +52,8 @@ void cc_error(const ScriptError &err);
 // Project-dependent script error formatting
 AGS::Common::String cc_format_error(const AGS::Common::String &message);
 
-extern int currentline;
+// Current line of the compiled or executed script; this and the last error
+// are kept per thread, which lets compile several scripts in parallel
+extern thread_local int currentline;
 
 #endif // __CC_ERROR_H
@@ -23,7 +23,7 @@
 using namespace AGS::Common;
 
 // currently executed line
-int currentline;
+thread_local int currentline;
 // script file format signature
 const char scfilesig[5] = "SCOM";
 
@@ -0,0 +1,92 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "gtest/gtest.h"
+#include "debug/asyncoutput.h"
+#include "util/memory_compat.h"
+
+using namespace AGS::Common;
+
+// Output handler recording the printed texts; may be held closed,
+// which makes PrintMessage wait until it's opened
+class TestOutput : public IOutputHandler
+{
+public:
+    TestOutput(std::vector<String> &texts, bool open = true)
+        : _texts(texts), _open(open) {}
+
+    void OnRegister() override {}
+    void PrintMessage(const DebugMessage &msg) override
+    {
+        std::unique_lock<std::mutex> lk(_mutex);
+        _cv.wait(lk, [this]() { return _open; });
+        _texts.push_back(msg.Text);
+    }
+
+    void Open()
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _open = true;
+        _cv.notify_all();
+    }
+
+private:
+    std::vector<String> &_texts;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _open;
+};
+
+TEST(AsyncOutput, WritesInOrder) {
+    std::vector<String> texts;
+    {
+        AsyncOutput out(std::make_unique<TestOutput>(texts), 16);
+        for (int i = 0; i < 1000; ++i)
+        {
+            out.PrintMessage(DebugMessage(String::FromFormat("%d", i), kDbgGroup_Main, "", kDbgMsg_Info));
+            if (out.GetMessagesDropped() > 0)
+                break;
+        }
+        // whatever was not dropped is written in order
+    }
+    const size_t dropped_warning = texts.size() > 0 && texts.back().StartsWith("WARNING") ? 1 : 0;
+    for (size_t i = 0; i < texts.size() - dropped_warning; ++i)
+        ASSERT_STREQ(texts[i].GetCStr(), String::FromFormat("%d", (int)i).GetCStr());
+}
+
+#if !defined(AGS_DISABLE_THREADS)
+TEST(AsyncOutput, CountsDropped) {
+    std::vector<String> texts;
+    uint32_t dropped = 0u;
+    {
+        auto handler = std::make_unique<TestOutput>(texts, false);
+        TestOutput *handler_ptr = handler.get();
+        AsyncOutput out(std::move(handler), 4);
+        // The writer is held by the closed output, so the queue fills up
+        for (int i = 0; i < 20; ++i)
+            out.PrintMessage(DebugMessage(String::FromFormat("%d", i), kDbgGroup_Main, "", kDbgMsg_Info));
+        dropped = out.GetMessagesDropped();
+        handler_ptr->Open();
+    }
+    // Written messages are followed by the dropped messages warning
+    ASSERT_GT(dropped, 0u);
+    ASSERT_EQ(texts.size(), 20u - dropped + 1u);
+    for (size_t i = 0; i < texts.size() - 1; ++i)
+        ASSERT_STREQ(texts[i].GetCStr(), String::FromFormat("%d", (int)i).GetCStr());
+    ASSERT_TRUE(texts.back().StartsWith("WARNING"));
+    ASSERT_TRUE(texts.back().FindString(String::FromFormat(" %u messages", dropped)) != String::NoIndex);
+}
+#endif
@@ -0,0 +1,89 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+
+TEST(Bitmap, AlignedAllocation) {
+    const int depths[] = { 8, 16, 24, 32 };
+    for (const int depth : depths)
+    {
+        std::unique_ptr<Bitmap> bmp(BitmapHelper::CreateBitmap(13, 7, depth, kBitmapAlloc_Aligned));
+        ASSERT_TRUE(bmp);
+        ASSERT_TRUE(bmp->IsAligned());
+        ASSERT_EQ(bmp->GetLineLength(), 13 * (depth / 8));
+        ASSERT_EQ(bmp->GetStride() % BitmapRowAlignment, 0);
+        ASSERT_GE(bmp->GetStride(), bmp->GetLineLength());
+        for (int y = 0; y < bmp->GetHeight(); ++y)
+        {
+            ASSERT_EQ(reinterpret_cast<uintptr_t>(bmp->GetScanLine(y)) % BitmapRowAlignment, 0u);
+            ASSERT_EQ(bmp->GetScanLine(y), bmp->GetData() + y * bmp->GetStride());
+        }
+
+        // Drawing and blitting to and from the aligned bitmap work as usual
+        std::unique_ptr<Bitmap> packed(BitmapHelper::CreateBitmap(13, 7, depth));
+        ASSERT_FALSE(packed->IsAligned());
+        ASSERT_EQ(packed->GetStride(), packed->GetLineLength());
+        for (int y = 0; y < 7; ++y)
+            for (int x = 0; x < 13; ++x)
+                packed->PutPixel(x, y, (x * 7 + y * 3) & 0x7F);
+        bmp->Blit(packed.get());
+        for (int y = 0; y < 7; ++y)
+            for (int x = 0; x < 13; ++x)
+                ASSERT_EQ(bmp->GetPixel(x, y), packed->GetPixel(x, y));
+    }
+}
+
+TEST(Bitmap, AlignedAllocationPool) {
+    BitmapHelper::ClearBitmapPool();
+    ASSERT_EQ(BitmapHelper::GetBitmapPoolSize(), 0u);
+    std::unique_ptr<Bitmap> bmp(BitmapHelper::CreateTransparentBitmap(100, 50, 32, kBitmapAlloc_Aligned));
+    ASSERT_TRUE(bmp);
+    ASSERT_EQ(static_cast<color_t>(bmp->GetPixel(99, 49)), bmp->GetMaskColor());
+    const unsigned char *data = bmp->GetData();
+    bmp.reset();
+    ASSERT_GE(BitmapHelper::GetBitmapPoolSize(), 100u * 50u * 4u);
+
+    // Same or slightly smaller bitmap reuses the released memory
+    bmp.reset(BitmapHelper::CreateBitmap(99, 50, 32, kBitmapAlloc_Aligned));
+    ASSERT_EQ(bmp->GetData(), data);
+    ASSERT_EQ(BitmapHelper::GetBitmapPoolSize(), 0u);
+    bmp.reset();
+    BitmapHelper::ClearBitmapPool();
+    ASSERT_EQ(BitmapHelper::GetBitmapPoolSize(), 0u);
+}
+
+TEST(Bitmap, ReadPixelsAndTransparencyStrided) {
+    std::unique_ptr<Bitmap> bmp(BitmapHelper::CreateBitmap(5, 4, 32, kBitmapAlloc_Aligned));
+    ASSERT_GT(bmp->GetStride(), bmp->GetLineLength());
+    std::vector<uint32_t> pixels(5 * 4);
+    for (size_t i = 0; i < pixels.size(); ++i)
+        pixels[i] = 0xFF000000u | static_cast<uint32_t>(i);
+    BitmapHelper::ReadPixelsFromMemory(bmp.get(), reinterpret_cast<const uint8_t*>(pixels.data()), 5 * 4);
+    for (int y = 0; y < 4; ++y)
+        for (int x = 0; x < 5; ++x)
+            ASSERT_EQ(static_cast<uint32_t>(bmp->GetPixel(x, y)), pixels[y * 5 + x]);
+
+    // The mask's transparent pixels are copied into the matching rows
+    std::unique_ptr<Bitmap> mask(BitmapHelper::CreateBitmap(5, 4, 32));
+    mask->Clear(0xFF000000u);
+    mask->PutPixel(4, 3, mask->GetMaskColor());
+    BitmapHelper::CopyTransparency(bmp.get(), mask.get(), false, false);
+    ASSERT_EQ(static_cast<color_t>(bmp->GetPixel(4, 3)), bmp->GetMaskColor());
+    ASSERT_EQ(static_cast<uint32_t>(bmp->GetPixel(3, 3)), pixels[3 * 5 + 3]);
+    ASSERT_EQ(static_cast<uint32_t>(bmp->GetPixel(4, 2)), pixels[2 * 5 + 4]);
+}
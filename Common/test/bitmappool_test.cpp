@@ -0,0 +1,77 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gtest/gtest.h"
+#include "gfx/bitmappool.h"
+
+using namespace AGS::Common;
+
+TEST(BitmapPool, ReusesBySize) {
+    BitmapPool pool;
+    const Bitmap *first = nullptr;
+    {
+        PooledBitmap bmp = pool.Acquire(100, 50, 32);
+        ASSERT_TRUE(bmp);
+        ASSERT_EQ(bmp->GetWidth(), 100);
+        ASSERT_EQ(bmp->GetHeight(), 50);
+        ASSERT_EQ(bmp->GetColorDepth(), 32);
+        first = bmp.get();
+        ASSERT_EQ(pool.GetSize(), 0u);
+    }
+    // The lease returns the bitmap into the pool
+    ASSERT_EQ(pool.GetSize(), 100u * 50u * 4u);
+
+    // Bitmap of another size or color depth is not taken from the pool
+    PooledBitmap other = pool.Acquire(50, 100, 32);
+    ASSERT_NE(other.get(), first);
+    PooledBitmap other_depth = pool.Acquire(100, 50, 16);
+    ASSERT_NE(other_depth.get(), first);
+    ASSERT_EQ(pool.GetSize(), 100u * 50u * 4u);
+
+    // Same size is
+    PooledBitmap same = pool.AcquireTransparent(100, 50, 32);
+    ASSERT_EQ(same.get(), first);
+    ASSERT_EQ(static_cast<color_t>(same->GetPixel(99, 49)), same->GetMaskColor());
+    ASSERT_EQ(pool.GetSize(), 0u);
+}
+
+TEST(BitmapPool, FreesOldest) {
+    // Bitmaps of 10x10, 10x11, 10x12 take 400, 440 and 480 bytes
+    BitmapPool pool(1000u);
+    PooledBitmap a = pool.Acquire(10, 10, 32);
+    PooledBitmap b = pool.Acquire(10, 11, 32);
+    PooledBitmap c = pool.Acquire(10, 12, 32);
+    const Bitmap *a_ptr = a.get();
+    b.reset();
+    a.reset();
+    ASSERT_EQ(pool.GetSize(), 840u);
+    // The bitmap released first is freed to make room for the new one
+    c.reset();
+    ASSERT_EQ(pool.GetSize(), 880u);
+    ASSERT_EQ(pool.Acquire(10, 10, 32).get(), a_ptr);
+    ASSERT_EQ(pool.GetSize(), 880u); // the temporary lease came back
+
+    // Shrinking frees the oldest first too, which is now the 10x12 one
+    ASSERT_EQ(pool.Shrink(1u), 480u);
+    ASSERT_EQ(pool.GetSize(), 400u);
+    ASSERT_EQ(pool.Acquire(10, 10, 32).get(), a_ptr);
+    pool.Clear();
+    ASSERT_EQ(pool.GetSize(), 0u);
+}
+
+TEST(BitmapPool, NoPoolDeletes) {
+    // The default-constructed lease simply owns the bitmap
+    PooledBitmap bmp(BitmapHelper::CreateBitmap(10, 10, 32));
+    ASSERT_TRUE(bmp);
+    bmp.reset();
+}
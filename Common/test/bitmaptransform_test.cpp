@@ -0,0 +1,217 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gtest/gtest.h"
+#include "gfx/bitmap_transform.h"
+
+using namespace AGS::Common;
+
+// Simple deterministic random numbers, so that the failures are reproducible
+static uint32_t NextRandom(uint32_t &state)
+{
+    state = state * 1103515245u + 12345u;
+    return (state >> 8) & 0xFFFFFF;
+}
+
+static int RandomRange(uint32_t &state, int min, int max)
+{
+    return min + static_cast<int>(NextRandom(state) % static_cast<uint32_t>(max - min + 1));
+}
+
+// Fills the bitmap with the random pixels, a quarter of which are transparent
+static void FillRandom(BITMAP *bmp, uint32_t &state)
+{
+    const int mask = bitmap_mask_color(bmp);
+    const int depth = bitmap_color_depth(bmp);
+    const uint32_t value_mask = (depth == 32) ? 0xFFFFFFFFu : ((1u << depth) - 1);
+    for (int y = 0; y < bmp->h; ++y)
+    {
+        for (int x = 0; x < bmp->w; ++x)
+        {
+            const uint32_t r = NextRandom(state);
+            putpixel(bmp, x, y, (r % 4 == 0) ? mask :
+                static_cast<int>((r * 2654435761u) & value_mask));
+        }
+    }
+}
+
+static bool SameBitmaps(BITMAP *b1, BITMAP *b2)
+{
+    const size_t line_size = b1->w * ((bitmap_color_depth(b1) + 7) / 8);
+    for (int y = 0; y < b1->h; ++y)
+    {
+        if (memcmp(b1->line[y], b2->line[y], line_size) != 0)
+            return false;
+    }
+    return true;
+}
+
+// Creates the pair of identical destination bitmaps with the random clipping
+static void CreateDestPair(int depth, int w, int h, uint32_t &state, BITMAP *&d1, BITMAP *&d2)
+{
+    d1 = create_bitmap_ex(depth, w, h);
+    d2 = create_bitmap_ex(depth, w, h);
+    FillRandom(d1, state);
+    blit(d1, d2, 0, 0, 0, 0, w, h);
+    const int cl = RandomRange(state, 0, w / 2), ct = RandomRange(state, 0, h / 2);
+    const int cr = RandomRange(state, cl, w - 1), cb = RandomRange(state, ct, h - 1);
+    set_clip_rect(d1, cl, ct, cr, cb);
+    set_clip_rect(d2, cl, ct, cr, cb);
+}
+
+static const int TestDepths[] = { 8, 16, 32 };
+
+TEST(BitmapTransform, StretchNearest) {
+    uint32_t state = 1u;
+    for (const int depth : TestDepths)
+    {
+        for (int i = 0; i < 200; ++i)
+        {
+            BITMAP *src = create_bitmap_ex(depth, RandomRange(state, 1, 40), RandomRange(state, 1, 40));
+            FillRandom(src, state);
+            BITMAP *d1, *d2;
+            CreateDestPair(depth, 64, 64, state, d1, d2);
+            const int sx = RandomRange(state, 0, src->w - 1), sy = RandomRange(state, 0, src->h - 1);
+            const int sw = RandomRange(state, 1, src->w - sx), sh = RandomRange(state, 1, src->h - sy);
+            const int dx = RandomRange(state, -20, 60), dy = RandomRange(state, -20, 60);
+            const int dw = RandomRange(state, 1, 90), dh = RandomRange(state, 1, 90);
+            const bool masked = (i % 2) == 0;
+
+            if (masked)
+                masked_stretch_blit(src, d1, sx, sy, sw, sh, dx, dy, dw, dh);
+            else
+                stretch_blit(src, d1, sx, sy, sw, sh, dx, dy, dw, dh);
+            ASSERT_TRUE(BitmapTransform::StretchNearest(d2, src,
+                RectWH(sx, sy, sw, sh), RectWH(dx, dy, dw, dh), masked));
+            ASSERT_TRUE(SameBitmaps(d1, d2)) << "depth " << depth << ", case " << i;
+            destroy_bitmap(src);
+            destroy_bitmap(d1);
+            destroy_bitmap(d2);
+        }
+    }
+}
+
+TEST(BitmapTransform, FlipSprite) {
+    uint32_t state = 2u;
+    const GraphicFlip flips[] = { kFlip_Horizontal, kFlip_Vertical, kFlip_Both };
+    for (const int depth : TestDepths)
+    {
+        for (int i = 0; i < 150; ++i)
+        {
+            BITMAP *src = create_bitmap_ex(depth, RandomRange(state, 1, 40), RandomRange(state, 1, 40));
+            FillRandom(src, state);
+            BITMAP *d1, *d2;
+            CreateDestPair(depth, 48, 48, state, d1, d2);
+            const int dx = RandomRange(state, -30, 50), dy = RandomRange(state, -30, 50);
+            const GraphicFlip flip = flips[i % 3];
+
+            switch (flip)
+            {
+            case kFlip_Horizontal: draw_sprite_h_flip(d1, src, dx, dy); break;
+            case kFlip_Vertical: draw_sprite_v_flip(d1, src, dx, dy); break;
+            default: draw_sprite_vh_flip(d1, src, dx, dy); break;
+            }
+            ASSERT_TRUE(BitmapTransform::FlipSprite(d2, src, dx, dy, flip));
+            ASSERT_TRUE(SameBitmaps(d1, d2)) << "depth " << depth << ", case " << i;
+            destroy_bitmap(src);
+            destroy_bitmap(d1);
+            destroy_bitmap(d2);
+        }
+    }
+}
+
+TEST(BitmapTransform, PivotSprite) {
+    // Allegro's rotation reports the division overflows to allegro_errno
+    install_allegro(SYSTEM_NONE, &errno, atexit);
+    uint32_t state = 3u;
+    const int angles[] = { 0, 64, 128, 192, -64, 320 };
+    for (const int depth : TestDepths)
+    {
+        for (int i = 0; i < 150; ++i)
+        {
+            BITMAP *src = create_bitmap_ex(depth, RandomRange(state, 1, 40), RandomRange(state, 1, 40));
+            FillRandom(src, state);
+            BITMAP *d1, *d2;
+            CreateDestPair(depth, 64, 64, state, d1, d2);
+            const int x = RandomRange(state, -10, 70), y = RandomRange(state, -10, 70);
+            const int cx = RandomRange(state, 0, src->w), cy = RandomRange(state, 0, src->h);
+            const fixed angle = itofix(angles[i % 6]);
+
+            pivot_sprite(d1, src, x, y, cx, cy, angle);
+            ASSERT_TRUE(BitmapTransform::PivotSprite(d2, src, itofix(x), itofix(y), itofix(cx), itofix(cy), angle));
+            ASSERT_TRUE(SameBitmaps(d1, d2)) << "depth " << depth << ", case " << i;
+            // rotate_sprite pivots around the center, which is at the whole
+            // pixel for the even sizes
+            if ((src->w % 2 == 0) && (src->h % 2 == 0))
+            {
+                rotate_sprite(d1, src, x, y, angle);
+                ASSERT_TRUE(BitmapTransform::PivotSprite(d2, src, itofix(x + src->w / 2), itofix(y + src->h / 2),
+                    itofix(src->w / 2), itofix(src->h / 2), angle));
+                ASSERT_TRUE(SameBitmaps(d1, d2)) << "depth " << depth << ", case " << i;
+            }
+            destroy_bitmap(src);
+            destroy_bitmap(d1);
+            destroy_bitmap(d2);
+        }
+    }
+
+    // Other angles, and corners in between the pixels are not supported
+    BITMAP *src = create_bitmap_ex(32, 5, 4);
+    BITMAP *dst = create_bitmap_ex(32, 16, 16);
+    ASSERT_FALSE(BitmapTransform::PivotSprite(dst, src, 0, 0, 0, 0, itofix(10)));
+    ASSERT_FALSE(BitmapTransform::PivotSprite(dst, src, itofix(8), itofix(8), 5 << 15, 4 << 15, itofix(64)));
+    destroy_bitmap(src);
+    destroy_bitmap(dst);
+}
+
+TEST(BitmapTransform, StretchBilinear) {
+    BITMAP *src = create_bitmap_ex(32, 4, 3);
+    BITMAP *dst = create_bitmap_ex(32, 16, 16);
+    clear_to_color(dst, 0);
+
+    // Same size gives the exact copy
+    uint32_t state = 4u;
+    FillRandom(src, state);
+    ASSERT_TRUE(BitmapTransform::StretchBilinear(dst, src, RectWH(0, 0, 4, 3), RectWH(2, 2, 4, 3)));
+    for (int y = 0; y < 3; ++y)
+        for (int x = 0; x < 4; ++x)
+            ASSERT_EQ(getpixel(dst, x + 2, y + 2), getpixel(src, x, y));
+
+    // Solid color stays the same, and nothing is drawn outside
+    clear_to_color(src, 0x80A0B0C0);
+    clear_to_color(dst, 0);
+    ASSERT_TRUE(BitmapTransform::StretchBilinear(dst, src, RectWH(0, 0, 4, 3), RectWH(1, 1, 13, 7)));
+    for (int y = 0; y < 16; ++y)
+        for (int x = 0; x < 16; ++x)
+            ASSERT_EQ(static_cast<uint32_t>(getpixel(dst, x, y)),
+                (x >= 1 && x < 14 && y >= 1 && y < 8) ? 0x80A0B0C0u : 0u);
+
+    // Pixels in between the source pixels are interpolated
+    putpixel(src, 0, 0, 0xFF000000);
+    putpixel(src, 1, 0, 0xFFFFFFFF);
+    ASSERT_TRUE(BitmapTransform::StretchBilinear(dst, src, RectWH(0, 0, 2, 1), RectWH(0, 0, 4, 1)));
+    ASSERT_EQ(static_cast<uint32_t>(getpixel(dst, 0, 0)), 0xFF000000u);
+    ASSERT_EQ(static_cast<uint32_t>(getpixel(dst, 1, 0)), 0xFF3F3F3Fu);
+    ASSERT_EQ(static_cast<uint32_t>(getpixel(dst, 2, 0)), 0xFFBFBFBFu);
+    ASSERT_EQ(static_cast<uint32_t>(getpixel(dst, 3, 0)), 0xFFFFFFFFu);
+
+    // Only 32-bit bitmaps are supported
+    BITMAP *src8 = create_bitmap_ex(8, 4, 4);
+    ASSERT_FALSE(BitmapTransform::StretchBilinear(dst, src8, RectWH(0, 0, 4, 4), RectWH(0, 0, 8, 8)));
+    destroy_bitmap(src8);
+    destroy_bitmap(src);
+    destroy_bitmap(dst);
+}
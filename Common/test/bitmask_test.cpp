@@ -0,0 +1,82 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <memory>
+#include "gtest/gtest.h"
+#include "gfx/bitmap.h"
+#include "gfx/bitmask.h"
+
+using namespace AGS::Common;
+
+// Pattern of opaque pixels, used for all the tested images
+static bool IsOpaque(int x, int y)
+{
+    return ((x * 7 + y * 3) % 5) == 0;
+}
+
+static Bitmap *CreatePattern(int width, int height, int depth)
+{
+    Bitmap *bmp = BitmapHelper::CreateTransparentBitmap(width, height, depth);
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+            if (IsOpaque(x, y))
+                bmp->PutPixel(x, y, (depth == 8) ? 5 : 0x123456);
+    return bmp;
+}
+
+TEST(BitMask, Create) {
+    const int depths[] = { 8, 16, 24, 32 };
+    for (const int depth : depths)
+    {
+        std::unique_ptr<Bitmap> bmp(CreatePattern(70, 5, depth));
+        BitMask mask(bmp.get());
+        ASSERT_EQ(mask.GetWidth(), 70);
+        ASSERT_EQ(mask.GetHeight(), 5);
+        for (int y = -1; y <= 5; ++y)
+            for (int x = -1; x <= 70; ++x)
+                ASSERT_EQ(mask.IsSet(x, y), (x >= 0) && (y >= 0) && (x < 70) && (y < 5) && IsOpaque(x, y))
+                    << "depth " << depth << ", pixel " << x << "," << y;
+    }
+}
+
+TEST(BitMask, Overlaps) {
+    std::unique_ptr<Bitmap> bmp_a(CreatePattern(130, 9, 8));
+    std::unique_ptr<Bitmap> bmp_b(BitmapHelper::CreateTransparentBitmap(67, 4, 8));
+    // sparse pattern for the second mask, so that many placements do not overlap
+    for (int y = 0; y < 4; ++y)
+        for (int x = 0; x < 67; ++x)
+            if (((x + y) % 23) == 0)
+                bmp_b->PutPixel(x, y, 1);
+    const BitMask a(bmp_a.get()), b(bmp_b.get());
+
+    const Rect areas[] = { RectWH(0, 0, 130, 9), RectWH(63, 2, 3, 4), RectWH(1, 0, 127, 9) };
+    for (const Rect &area : areas)
+    {
+        for (int oy = -5; oy <= 10; ++oy)
+        {
+            for (int ox = -70; ox <= 132; ++ox)
+            {
+                bool expect = false;
+                for (int y = area.Top; (y <= area.Bottom) && !expect; ++y)
+                    for (int x = area.Left; (x <= area.Right) && !expect; ++x)
+                        expect = a.IsSet(x, y) && b.IsSet(x - ox, y - oy);
+                ASSERT_EQ(a.Overlaps(b, ox, oy, area), expect)
+                    << "offset " << ox << "," << oy << ", area " << area.Left << "," << area.Top;
+            }
+        }
+    }
+
+    // Empty masks never overlap
+    ASSERT_FALSE(BitMask().Overlaps(a, 0, 0));
+    ASSERT_FALSE(a.Overlaps(BitMask(), 0, 0));
+}
@@ -0,0 +1,214 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <algorithm>
+#include <string.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "gfx/bitmap.h"
+#include "util/compress.h"
+#include "util/compressedblockstream.h"
+#include "util/memory_compat.h"
+#include "util/memorystream.h"
+
+using namespace AGS::Common;
+
+static void TestLZ4RoundTrip(const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> packed;
+    Stream out(std::make_unique<VectorStream>(packed, kStream_Write));
+    ASSERT_TRUE(lz4_compress(data.data(), data.size(), 1, &out));
+    out.Close();
+    ASSERT_FALSE(packed.empty());
+
+    std::vector<uint8_t> unpacked(data.size());
+    Stream in(std::make_unique<VectorStream>(packed));
+    ASSERT_TRUE(lz4_decompress(unpacked.data(), unpacked.size(), 1, &in, packed.size()));
+    ASSERT_EQ(in.GetPosition(), static_cast<soff_t>(packed.size()));
+    ASSERT_EQ(unpacked, data);
+}
+
+TEST(Compress, LZ4) {
+    std::vector<uint8_t> data;
+    TestLZ4RoundTrip(data);
+    data.assign(7, 0x5A);
+    TestLZ4RoundTrip(data);
+    // Long runs and repeated patterns, which give long and overlapping matches
+    data.assign(100000, 0);
+    for (size_t i = 50000; i < data.size(); ++i)
+        data[i] = static_cast<uint8_t>(i % 3);
+    TestLZ4RoundTrip(data);
+    // Pseudo-random data, which does not compress
+    uint32_t seed = 12345;
+    for (auto &b : data)
+    {
+        seed = seed * 1103515245u + 12345u;
+        b = static_cast<uint8_t>(seed >> 16);
+    }
+    TestLZ4RoundTrip(data);
+    // Image-like data: rows with gradients and repeated spans
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<uint8_t>((i % 320) < 200 ? (i % 320) / 8 : (i / 320));
+    TestLZ4RoundTrip(data);
+
+    // Compresses the repetitive data
+    std::vector<uint8_t> packed;
+    Stream out(std::make_unique<VectorStream>(packed, kStream_Write));
+    ASSERT_TRUE(lz4_compress(data.data(), data.size(), 1, &out));
+    out.Close();
+    ASSERT_LT(packed.size(), data.size() / 4);
+
+    // Rejects the truncated input, and the wrong output size
+    std::vector<uint8_t> unpacked(data.size());
+    Stream in(std::make_unique<VectorStream>(packed));
+    ASSERT_FALSE(lz4_decompress(unpacked.data(), unpacked.size(), 1, &in, packed.size() / 2));
+    in.Seek(0, kSeekBegin);
+    ASSERT_FALSE(lz4_decompress(unpacked.data(), unpacked.size() - 1, 1, &in, packed.size()));
+    in.Seek(0, kSeekBegin);
+    ASSERT_FALSE(lz4_decompress(unpacked.data(), unpacked.size() + 1, 1, &in, packed.size()));
+}
+
+TEST(Compress, LZ4BlockStream) {
+    // Half of the data compresses well, and another half is pseudo-random
+    std::vector<uint8_t> data(10000);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (i < data.size() / 2) ? static_cast<uint8_t>(i / 100) : static_cast<uint8_t>(seed >> 16);
+    }
+    std::vector<uint8_t> packed;
+    {
+        Stream src(std::make_unique<VectorStream>(data));
+        Stream out(std::make_unique<VectorStream>(packed, kStream_Write));
+        out.WriteInt32(0xABCD); // compressed data does not have to start at zero
+        const soff_t wrote = CompressedBlockStream::Compress(&src, data.size(), &out, 1024);
+        ASSERT_EQ(wrote, static_cast<soff_t>(packed.size() - sizeof(int32_t)));
+    }
+    ASSERT_LT(packed.size(), data.size() * 3 / 4);
+
+    auto base = std::make_unique<Stream>(std::make_unique<VectorStream>(packed));
+    ASSERT_EQ(base->ReadInt32(), 0xABCD);
+    auto in = CompressedBlockStream::Open(std::move(base));
+    ASSERT_TRUE(in);
+    ASSERT_TRUE(in->CanRead());
+    ASSERT_TRUE(in->CanSeek());
+    ASSERT_FALSE(in->CanWrite());
+    ASSERT_EQ(in->GetLength(), static_cast<soff_t>(data.size()));
+    // Read sequentially, in chunks crossing the block boundaries
+    std::vector<uint8_t> unpacked(data.size());
+    for (size_t pos = 0; pos < data.size(); pos += 700)
+        ASSERT_EQ(in->Read(&unpacked[pos], std::min<size_t>(700, data.size() - pos)),
+            std::min<size_t>(700, data.size() - pos));
+    ASSERT_EQ(unpacked, data);
+    ASSERT_TRUE(in->EOS());
+    ASSERT_EQ(in->ReadByte(), -1);
+    // Random access
+    const size_t positions[] = { 9999, 0, 5000, 1023, 1024, 7777, 3 };
+    for (const auto pos : positions)
+    {
+        ASSERT_EQ(in->Seek(pos, kSeekBegin), static_cast<soff_t>(pos));
+        ASSERT_EQ(in->ReadByte(), data[pos]);
+    }
+    ASSERT_EQ(in->Seek(-10, kSeekEnd), static_cast<soff_t>(data.size() - 10));
+    ASSERT_EQ(in->Read(&unpacked[0], 100), 10u);
+    ASSERT_TRUE(std::equal(data.end() - 10, data.end(), unpacked.begin()));
+    in.reset();
+
+    // Empty data
+    packed.clear();
+    {
+        Stream src(std::make_unique<VectorStream>(data));
+        Stream out(std::make_unique<VectorStream>(packed, kStream_Write));
+        ASSERT_GT(CompressedBlockStream::Compress(&src, 0, &out), 0);
+    }
+    in = CompressedBlockStream::Open(std::make_unique<Stream>(std::make_unique<VectorStream>(packed)));
+    ASSERT_TRUE(in);
+    ASSERT_EQ(in->GetLength(), 0);
+    ASSERT_TRUE(in->EOS());
+
+    // Truncated data is rejected
+    packed.resize(12);
+    ASSERT_FALSE(CompressedBlockStream::Open(std::make_unique<Stream>(std::make_unique<VectorStream>(packed))));
+}
+
+// Makes the image-like test data, with runs and varying spans
+static std::vector<uint8_t> MakeImageData(size_t size)
+{
+    std::vector<uint8_t> data(size);
+    uint32_t seed = 777;
+    for (size_t i = 0; i < size; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        if ((i % 256) < 100)
+            data[i] = static_cast<uint8_t>(i / 256); // runs
+        else if ((i % 256) < 180)
+            data[i] = static_cast<uint8_t>(seed >> 16); // noise
+        else
+            data[i] = static_cast<uint8_t>(i % 5); // short pattern
+    }
+    return data;
+}
+
+TEST(Compress, RLE) {
+    const std::vector<uint8_t> data = MakeImageData(64000);
+    for (int bpp : { 1, 2, 4 })
+    {
+        std::vector<uint8_t> packed;
+        Stream out(std::make_unique<VectorStream>(packed, kStream_Write));
+        ASSERT_TRUE(rle_compress(data.data(), data.size(), bpp, &out));
+        out.WriteInt32(0x12345678); // trailing data must be left intact
+        out.Close();
+        const size_t packed_sz = packed.size() - sizeof(int32_t);
+
+        std::vector<uint8_t> unpacked(data.size());
+        Stream in(std::make_unique<VectorStream>(packed));
+        ASSERT_TRUE(rle_decompress(unpacked.data(), unpacked.size(), bpp, &in, packed_sz));
+        ASSERT_EQ(in.GetPosition(), static_cast<soff_t>(packed_sz));
+        ASSERT_EQ(in.ReadInt32(), 0x12345678);
+        ASSERT_EQ(unpacked, data);
+    }
+}
+
+TEST(Compress, RLEBitmap8) {
+    const std::vector<uint8_t> data = MakeImageData(320 * 200);
+    std::unique_ptr<Bitmap> bmp(BitmapHelper::CreateBitmap(320, 200, 8));
+    memcpy(bmp->GetDataForWriting(), data.data(), data.size());
+    std::vector<uint8_t> packed;
+    Stream out(std::make_unique<VectorStream>(packed, kStream_Write));
+    save_rle_bitmap8(&out, bmp.get());
+    save_rle_bitmap8(&out, bmp.get());
+    out.Close();
+
+    Stream in(std::make_unique<VectorStream>(packed));
+    skip_rle_bitmap8(&in);
+    ASSERT_EQ(in.GetPosition(), static_cast<soff_t>(packed.size() / 2));
+    std::unique_ptr<Bitmap> bmp2 = load_rle_bitmap8(&in);
+    ASSERT_TRUE(bmp2);
+    ASSERT_TRUE(in.EOS());
+    ASSERT_EQ(memcmp(bmp2->GetData(), data.data(), data.size()), 0);
+}
+
+TEST(Compress, LZW) {
+    const std::vector<uint8_t> data = MakeImageData(64000);
+    std::vector<uint8_t> packed;
+    Stream out(std::make_unique<VectorStream>(packed, kStream_Write));
+    ASSERT_TRUE(lzw_compress(data.data(), data.size(), 1, &out));
+    out.Close();
+    ASSERT_LT(packed.size(), data.size());
+
+    std::vector<uint8_t> unpacked(data.size());
+    Stream in(std::make_unique<VectorStream>(packed));
+    ASSERT_TRUE(lzw_decompress(unpacked.data(), unpacked.size(), 1, &in, packed.size()));
+    ASSERT_EQ(unpacked, data);
+}
@@ -0,0 +1,52 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gtest/gtest.h"
+#include "debug/debugmanager.h"
+#include "debug/messagebuffer.h"
+#include "util/memory_compat.h"
+
+using namespace AGS::Common;
+
+TEST(DebugManager, IsEnabled) {
+    DebugManager mgr(false);
+    // No outputs
+    ASSERT_FALSE(mgr.IsEnabled(kDbgGroup_Main, kDbgMsg_Error));
+
+    std::vector<std::pair<DebugGroupID, MessageType>> filters;
+    filters.push_back(std::make_pair(DebugGroupID(kDbgGroup_Main), kDbgMsg_Info));
+    filters.push_back(std::make_pair(DebugGroupID("custom"), kDbgMsg_Debug));
+    mgr.RegisterOutput("test1", std::make_unique<MessageBuffer>(), kDbgMsg_Warn, &filters);
+    ASSERT_TRUE(mgr.IsEnabled(kDbgGroup_Main, kDbgMsg_Info));
+    ASSERT_FALSE(mgr.IsEnabled(kDbgGroup_Main, kDbgMsg_Debug));
+    ASSERT_TRUE(mgr.IsEnabled(kDbgGroup_Game, kDbgMsg_Warn));
+    ASSERT_FALSE(mgr.IsEnabled(kDbgGroup_Game, kDbgMsg_Info));
+
+    // A group registered after the output gets its filter resolved
+    MessageGroupHandle custom = mgr.RegisterGroup(DebugGroupID(kDbgGroup_RoomLoad + 1, "custom"), "Custom");
+    ASSERT_TRUE(mgr.IsEnabled(custom, kDbgMsg_Debug));
+
+    // The most verbose of the outputs counts
+    mgr.RegisterOutput("test2", std::make_unique<MessageBuffer>(), kDbgMsg_All, nullptr);
+    ASSERT_TRUE(mgr.IsEnabled(kDbgGroup_Main, kDbgMsg_Debug));
+    mgr.SetOutputFilters("test2", kDbgMsg_Error, nullptr);
+    ASSERT_FALSE(mgr.IsEnabled(kDbgGroup_Main, kDbgMsg_Debug));
+    ASSERT_TRUE(mgr.IsEnabled(kDbgGroup_Game, kDbgMsg_Warn));
+    mgr.UnregisterOutput("test1");
+    ASSERT_FALSE(mgr.IsEnabled(kDbgGroup_Game, kDbgMsg_Warn));
+    ASSERT_TRUE(mgr.IsEnabled(kDbgGroup_Game, kDbgMsg_Error));
+    ASSERT_FALSE(mgr.IsEnabled(custom, kDbgMsg_Debug));
+
+    mgr.UnregisterAll();
+    ASSERT_FALSE(mgr.IsEnabled(kDbgGroup_Main, kDbgMsg_Error));
+}
@@ -0,0 +1,79 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <thread>
+#include "gtest/gtest.h"
+#include "debug/eventtrace.h"
+#include "util/file.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
+
+#if (AGS_PLATFORM_TEST_FILE_IO) && (EVENT_TRACE)
+
+static const char *TraceFile = "trace_test.json";
+
+static size_t CountOf(const String &text, const char *what)
+{
+    size_t count = 0;
+    for (size_t at = text.FindString(what); at != String::NoIndex; at = text.FindString(what, at + 1))
+        count++;
+    return count;
+}
+
+TEST(EventTrace, RecordsZones) {
+    {
+        AGS_TRACE_ZONE("NotRecorded");
+    }
+    ASSERT_TRUE(EventTrace::Start(TraceFile));
+    EventTrace::SetThreadName("Main");
+    {
+        AGS_TRACE_ZONE("Outer");
+        AGS_TRACE_ZONE_DETAIL("Inner", "quote\" and slash\\");
+    }
+    std::thread worker([]()
+    {
+        EventTrace::SetThreadName("Worker");
+        // more than fits in the thread's buffer
+        for (int i = 0; i < 3000; ++i)
+        {
+            AGS_TRACE_ZONE("Work");
+        }
+    });
+    worker.join();
+    EventTrace::Stop();
+    {
+        AGS_TRACE_ZONE("NotRecorded");
+    }
+
+    String trace;
+    {
+        auto in = File::OpenFileRead(TraceFile);
+        ASSERT_TRUE(in != nullptr);
+        trace = String::FromStream(in.get());
+    }
+    File::DeleteFile(TraceFile);
+    ASSERT_TRUE(trace.StartsWith("["));
+    trace.TrimRight();
+    ASSERT_EQ(trace.GetLast(), ']');
+    ASSERT_EQ(CountOf(trace, "\"ph\":\"X\""), 3002u);
+    ASSERT_EQ(CountOf(trace, "\"name\":\"Work\""), 3000u);
+    ASSERT_EQ(CountOf(trace, "NotRecorded"), 0u);
+    ASSERT_EQ(CountOf(trace, R"("args":{"detail":"quote\" and slash\\"})"), 1u);
+    ASSERT_EQ(CountOf(trace, R"("args":{"name":"Main"})"), 1u);
+    ASSERT_EQ(CountOf(trace, R"("args":{"name":"Worker"})"), 1u);
+    // each event is on its own line, separated by commas
+    ASSERT_EQ(CountOf(trace, "},\n{"), 3002u + 1u /* process */ + 2u /* threads */ - 1u);
+}
+
+#endif // AGS_PLATFORM_TEST_FILE_IO && EVENT_TRACE
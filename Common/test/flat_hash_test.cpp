@@ -0,0 +1,97 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <unordered_map>
+#include "gtest/gtest.h"
+#include "util/flat_hash.h"
+#include "util/string.h"
+#include "util/string_types.h"
+
+using namespace AGS::Common;
+
+TEST(FlatHash, MapBasic) {
+    FlatHashMap<String, String> map;
+    ASSERT_TRUE(map.empty());
+    ASSERT_TRUE(map.find("key") == map.end());
+    map["key1"] = "value1";
+    map["key2"] = "value2";
+    map["key1"] = "value3";
+    ASSERT_EQ(map.size(), 2u);
+    ASSERT_EQ(map.count("key1"), 1u);
+    ASSERT_EQ(map.count("key3"), 0u);
+    ASSERT_STREQ(map.find("key1")->second.GetCStr(), "value3");
+    ASSERT_STREQ(map.find("key2")->second.GetCStr(), "value2");
+    ASSERT_FALSE(map.insert(std::make_pair(String("key2"), String("value4"))).second);
+    ASSERT_STREQ(map.find("key2")->second.GetCStr(), "value2");
+    map.erase(map.find("key1"));
+    ASSERT_EQ(map.size(), 1u);
+    ASSERT_TRUE(map.find("key1") == map.end());
+    ASSERT_EQ(map.erase(String("key2")), 1u);
+    ASSERT_TRUE(map.empty());
+    ASSERT_TRUE(map.begin() == map.end());
+}
+
+TEST(FlatHash, MapCaseInsensitive) {
+    FlatHashMap<String, int, HashStrNoCase, StrEqNoCase> map;
+    map["Key"] = 1;
+    map["KEY"] = 2;
+    ASSERT_EQ(map.size(), 1u);
+    ASSERT_EQ(map.find("key")->second, 2);
+}
+
+TEST(FlatHash, MapManyItems) {
+    // Compare against the standard container while adding and removing
+    // many items, which makes the table grow and shift probe sequences
+    FlatHashMap<String, int> map;
+    std::unordered_map<String, int> ref_map;
+    for (int i = 0; i < 2000; ++i)
+    {
+        const String key = String::FromFormat("item%d", i);
+        map[key] = i;
+        ref_map[key] = i;
+    }
+    for (int i = 0; i < 2000; i += 3)
+    {
+        const String key = String::FromFormat("item%d", i);
+        map.erase(key);
+        ref_map.erase(key);
+    }
+    ASSERT_EQ(map.size(), ref_map.size());
+    for (const auto &item : ref_map)
+    {
+        auto it = map.find(item.first);
+        ASSERT_TRUE(it != map.end());
+        ASSERT_EQ(it->second, item.second);
+    }
+    size_t iter_count = 0u;
+    for (auto it = map.begin(); it != map.end(); ++it, ++iter_count)
+        ASSERT_EQ(ref_map.count(it->first), 1u);
+    ASSERT_EQ(iter_count, ref_map.size());
+
+    map.clear();
+    ASSERT_TRUE(map.empty());
+    ASSERT_TRUE(map.find("item1") == map.end());
+}
+
+TEST(FlatHash, Set) {
+    FlatHashSet<String> set;
+    set.reserve(100);
+    ASSERT_TRUE(set.insert("item1").second);
+    ASSERT_TRUE(set.insert("item2").second);
+    ASSERT_FALSE(set.insert("item1").second);
+    ASSERT_EQ(set.size(), 2u);
+    ASSERT_EQ(set.count("item2"), 1u);
+    set.erase(set.find("item2"));
+    ASSERT_EQ(set.count("item2"), 0u);
+    ASSERT_STREQ(set.begin()->GetCStr(), "item1");
+}
@@ -0,0 +1,81 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <memory>
+#include "gtest/gtest.h"
+#include "font/glyphatlas.h"
+
+using namespace AGS::Common;
+
+// Fills the glyph's mask with a checkerboard
+static void FillChecker(const GlyphAtlas::Glyph &glyph)
+{
+    for (int y = 0; y < glyph.Place.GetHeight(); ++y)
+        for (int x = 0; x < glyph.Place.GetWidth(); ++x)
+            glyph.Page->PutPixel(glyph.Place.Left + x, glyph.Place.Top + y, ((x + y) % 2) ? 0xFF : 0);
+}
+
+TEST(GlyphAtlas, AddAndFind) {
+    GlyphAtlas atlas(Size(16, 16));
+    ASSERT_EQ(atlas.Find('A'), nullptr);
+    const GlyphAtlas::Glyph &a = atlas.Add('A', Size(8, 10));
+    ASSERT_NE(a.Page, nullptr);
+    ASSERT_EQ(a.Page->GetColorDepth(), 8);
+    ASSERT_EQ(a.Place.GetWidth(), 8);
+    ASSERT_EQ(a.Place.GetHeight(), 10);
+    ASSERT_EQ(atlas.Find('A'), &a);
+
+    // Empty glyphs are cached, but have no mask
+    const GlyphAtlas::Glyph &space = atlas.Add(' ', Size(0, 10));
+    ASSERT_EQ(space.Page, nullptr);
+    ASSERT_EQ(atlas.Find(' '), &space);
+
+    // Glyph larger than a page gets a page of its own
+    const GlyphAtlas::Glyph &large = atlas.Add('W', Size(20, 12));
+    ASSERT_NE(large.Page, nullptr);
+    ASSERT_NE(large.Page, a.Page);
+    ASSERT_EQ(large.Place, RectWH(0, 0, 20, 12));
+    ASSERT_EQ(atlas.GetGlyphCount(), 3u);
+    ASSERT_EQ(atlas.GetPageCount(), 2u);
+
+    atlas.Clear();
+    ASSERT_EQ(atlas.Find('A'), nullptr);
+    ASSERT_EQ(atlas.GetGlyphCount(), 0u);
+    ASSERT_EQ(atlas.GetPageCount(), 0u);
+}
+
+TEST(GlyphAtlas, Draw) {
+    const int depths[] = { 8, 16, 24, 32 };
+    for (const int depth : depths)
+    {
+        GlyphAtlas atlas;
+        atlas.Add('B', Size(3, 3)); // occupy the page's corner
+        const GlyphAtlas::Glyph &glyph = atlas.Add('A', Size(5, 4));
+        FillChecker(glyph);
+
+        const color_t color = (depth == 8) ? 15 : ((depth == 16) ? 0x3456 : 0x123456);
+        std::unique_ptr<Bitmap> ds(BitmapHelper::CreateClearBitmap(10, 10, depth));
+        const Rect clip(3, 0, 9, 9);
+        GlyphAtlas::Draw(glyph, ds.get(), 2, 7, clip, color);
+        for (int y = 0; y < 10; ++y)
+        {
+            for (int x = 0; x < 10; ++x)
+            {
+                const bool in_glyph = (x >= 2) && (x < 7) && (y >= 7) && (y < 11);
+                const bool set = in_glyph && (x >= clip.Left) && ((x - 2 + y - 7) % 2);
+                ASSERT_EQ(static_cast<color_t>(ds->GetPixel(x, y)), set ? color : 0)
+                    << "depth " << depth << ", pixel " << x << "," << y;
+            }
+        }
+    }
+}
@@ -0,0 +1,103 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <atomic>
+#include <vector>
+#include "gtest/gtest.h"
+#include "util/jobscheduler.h"
+
+using namespace AGS::Common;
+
+TEST(JobScheduler, ParallelForRunsEachJobOnce) {
+    const size_t worker_counts[] = { 0, 1, 3 };
+    for (const size_t workers : worker_counts)
+    {
+        JobScheduler sched(workers);
+#if defined(AGS_DISABLE_THREADS)
+        ASSERT_EQ(sched.GetThreadCount(), 1u);
+#else
+        ASSERT_EQ(sched.GetThreadCount(), workers + 1);
+#endif
+        // Repeated batches of different sizes reuse the same threads
+        for (size_t job_count = 0; job_count < 50; job_count += 7)
+        {
+            std::vector<std::atomic<int>> runs(job_count);
+            for (auto &r : runs)
+                r = 0;
+            sched.ParallelFor("test", job_count, [&runs](size_t i) { runs[i]++; });
+            for (size_t i = 0; i < job_count; ++i)
+                ASSERT_EQ(runs[i].load(), 1) << "workers " << workers << ", job " << i;
+        }
+    }
+}
+
+TEST(JobScheduler, WaitsForSubmittedJobs) {
+    const size_t worker_counts[] = { 0, 1, 3 };
+    for (const size_t workers : worker_counts)
+    {
+        JobScheduler sched(workers);
+        std::vector<std::atomic<int>> runs(100);
+        for (auto &r : runs)
+            r = 0;
+        std::vector<JobHandle> jobs;
+        for (size_t i = 0; i < runs.size(); ++i)
+            jobs.push_back(sched.Submit("test", [&runs, i]() { runs[i]++; }));
+        for (const auto &job : jobs)
+        {
+            sched.Wait(job);
+            ASSERT_TRUE(job->IsDone());
+        }
+        for (size_t i = 0; i < runs.size(); ++i)
+            ASSERT_EQ(runs[i].load(), 1) << "workers " << workers << ", job " << i;
+    }
+}
+
+TEST(JobScheduler, NestedJobs) {
+    // The jobs submitting and waiting for more jobs must not lock up,
+    // even when there are more of them than the workers
+    const size_t worker_counts[] = { 0, 1, 2 };
+    for (const size_t workers : worker_counts)
+    {
+        JobScheduler sched(workers);
+        std::atomic<int> leaf_runs{0};
+        sched.ParallelFor("outer", 8, [&sched, &leaf_runs](size_t)
+        {
+            std::vector<JobHandle> inner;
+            for (int i = 0; i < 4; ++i)
+                inner.push_back(sched.Submit("inner", [&leaf_runs]() { leaf_runs++; }));
+            for (const auto &job : inner)
+                sched.Wait(job);
+        });
+        ASSERT_EQ(leaf_runs.load(), 32) << "workers " << workers;
+    }
+}
+
+TEST(JobScheduler, ResolveThreadCount) {
+#if defined(AGS_DISABLE_THREADS)
+    ASSERT_EQ(JobScheduler::ResolveThreadCount(4, 2), 1u);
+#else
+    ASSERT_EQ(JobScheduler::ResolveThreadCount(3, 2), 3u);
+    ASSERT_EQ(JobScheduler::ResolveThreadCount(1, 4), 1u);
+    const size_t auto_count = JobScheduler::ResolveThreadCount(0, 2);
+    ASSERT_GE(auto_count, 1u);
+    ASSERT_LE(auto_count, 2u);
+#endif
+}
+
+TEST(JobScheduler, GlobalRunsInlineUntilCreated) {
+    ASSERT_EQ(JobScheduler::Global().GetThreadCount(), 1u);
+    int runs = 0;
+    JobHandle job = JobScheduler::Global().Submit("test", [&runs]() { runs++; });
+    ASSERT_TRUE(job->IsDone());
+    ASSERT_EQ(runs, 1);
+}
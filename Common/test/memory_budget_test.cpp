@@ -0,0 +1,77 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gtest/gtest.h"
+#include "util/memory_budget.h"
+
+using namespace AGS::Common;
+
+// Test consumer, which frees the memory in blocks of the given size
+struct TestConsumer
+{
+    size_t Size;
+    size_t Block;
+    size_t Shrinks = 0u;
+
+    TestConsumer(size_t size, size_t block = 1u) : Size(size), Block(block) {}
+
+    size_t Shrink(size_t size)
+    {
+        Shrinks++;
+        size_t freed = 0u;
+        while (freed < size && Size >= Block)
+        {
+            Size -= Block;
+            freed += Block;
+        }
+        return freed;
+    }
+};
+
+TEST(MemoryBudget, ShrinksInPriorityOrder) {
+    TestConsumer sprites(600, 100), sounds(300, 50), fixed(200);
+    const int h_sprites = MemoryBudget::Register("sprites", 2,
+        [&]() { return sprites.Size; }, [&](size_t size) { return sprites.Shrink(size); });
+    const int h_sounds = MemoryBudget::Register("sounds", 1,
+        [&]() { return sounds.Size; }, [&](size_t size) { return sounds.Shrink(size); });
+    const int h_fixed = MemoryBudget::Register("fixed", 0, [&]() { return fixed.Size; });
+    ASSERT_EQ(MemoryBudget::GetTotalSize(), 1100u);
+
+    // Without a budget nothing is freed
+    ASSERT_EQ(MemoryBudget::Update(), 0u);
+    // Within the budget nothing is freed
+    MemoryBudget::SetBudget(1600);
+    ASSERT_EQ(MemoryBudget::Update(), 0u);
+    ASSERT_EQ(sounds.Shrinks, 0u);
+
+    // The excess and 1/16th of the budget (350) is freed, lower priority first
+    MemoryBudget::SetBudget(800);
+    ASSERT_EQ(MemoryBudget::Update(), 400u);
+    ASSERT_EQ(sounds.Size, 0u);
+    ASSERT_EQ(sprites.Size, 500u);
+    ASSERT_EQ(fixed.Size, 200u);
+
+    // Low memory makes everyone free a half
+    MemoryBudget::SetBudget(0);
+    ASSERT_EQ(MemoryBudget::OnLowMemory(), 300u);
+    ASSERT_EQ(sprites.Size, 200u);
+    ASSERT_EQ(fixed.Size, 200u);
+
+    String report = MemoryBudget::GetReport();
+    ASSERT_TRUE(report.FindString("sprites 0,") != String::NoIndex);
+
+    MemoryBudget::Unregister(h_sprites);
+    MemoryBudget::Unregister(h_sounds);
+    MemoryBudget::Unregister(h_fixed);
+    ASSERT_EQ(MemoryBudget::GetTotalSize(), 0u);
+}
@@ -0,0 +1,130 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <errno.h>
+#include <stdlib.h>
+#include <vector>
+#include <allegro.h>
+#include "gtest/gtest.h"
+#include "gfx/pixel_convert.h"
+
+using namespace AGS::Common;
+using namespace AGS::Common::PixelConvert;
+
+// Simple deterministic random numbers, so that the failures are reproducible
+static uint32_t NextRandom(uint32_t &state)
+{
+    state = state * 1103515245u + 12345u;
+    return (state >> 8) & 0xFFFFFF;
+}
+
+// Makes the row of random pixels of the given color depth, every 4th is transparent
+static std::vector<uint32_t> MakeRow(int depth, int count, uint32_t &state)
+{
+    const uint32_t mask = (depth == 8) ? MASK_COLOR_8 : (depth == 16) ? MASK_COLOR_16 : MASK_COLOR_32;
+    const uint32_t value_mask = (depth == 32) ? 0xFFFFFFFFu : ((1u << depth) - 1);
+    std::vector<uint32_t> row(count);
+    for (auto &px : row)
+    {
+        const uint32_t r = NextRandom(state);
+        px = (r % 4 == 0) ? mask : ((r * 2654435761u) & value_mask);
+    }
+    return row;
+}
+
+// Converts the pixel the way the renderers did before, with Allegro's functions
+static uint32_t ConvertPixel(int depth, uint32_t c, const ChannelShifts &dst, AlphaMode alpha)
+{
+    const uint32_t mask = (depth == 8) ? MASK_COLOR_8 : (depth == 16) ? MASK_COLOR_16 : MASK_COLOR_32;
+    if ((alpha == kAlpha_MaskColor) && (c == mask))
+        return 0;
+    const uint32_t r = getr_depth(depth, c), g = getg_depth(depth, c), b = getb_depth(depth, c);
+    const uint32_t a = ((alpha == kAlpha_Source) && (depth == 32)) ? geta32(c) : 0xFF;
+    return (r << dst.R) | (g << dst.G) | (b << dst.B) | (a << dst.A);
+}
+
+TEST(PixelConvert, RowConverter) {
+    install_allegro(SYSTEM_NONE, &errno, atexit);
+    PALETTE pal;
+    for (int c = 0; c < 256; ++c)
+    {
+        pal[c].r = c % 64;
+        pal[c].g = (c * 7) % 64;
+        pal[c].b = 63 - c % 64;
+    }
+    select_palette(pal);
+
+    const ChannelShifts layouts[] = {
+        ChannelShifts(16, 8, 0, 24), // ARGB
+        ChannelShifts(0, 8, 16, 24)  // ABGR
+    };
+    const AlphaMode modes[] = { kAlpha_Opaque, kAlpha_MaskColor, kAlpha_Source };
+    uint32_t state = 1u;
+    for (const int depth : { 8, 16, 32 })
+    {
+        for (const auto &layout : layouts)
+        {
+            for (const AlphaMode mode : modes)
+            {
+                // odd counts test the remaining pixels after the SIMD loop
+                for (const int count : { 1, 7, 37, 256 })
+                {
+                    const std::vector<uint32_t> values = MakeRow(depth, count, state);
+                    std::vector<uint8_t> src(count * 4);
+                    for (int i = 0; i < count; ++i)
+                    {
+                        if (depth == 8)
+                            src[i] = static_cast<uint8_t>(values[i]);
+                        else if (depth == 16)
+                            reinterpret_cast<uint16_t*>(src.data())[i] = static_cast<uint16_t>(values[i]);
+                        else
+                            reinterpret_cast<uint32_t*>(src.data())[i] = values[i];
+                    }
+                    std::vector<uint32_t> dst(count);
+                    RowConverter(depth, layout, mode).Convert(dst.data(), src.data(), count);
+                    for (int i = 0; i < count; ++i)
+                        ASSERT_EQ(dst[i], ConvertPixel(depth, values[i], layout, mode))
+                            << "depth " << depth << ", mode " << mode << ", pixel " << i;
+                }
+            }
+        }
+    }
+    unselect_palette();
+}
+
+TEST(PixelConvert, SwapRedBlue32) {
+    uint32_t state = 2u;
+    std::vector<uint32_t> row = MakeRow(32, 37, state);
+    const std::vector<uint32_t> orig = row;
+    SwapRedBlue32(row.data(), static_cast<int>(row.size()));
+    for (size_t i = 0; i < row.size(); ++i)
+    {
+        const uint8_t *s = reinterpret_cast<const uint8_t*>(&orig[i]);
+        const uint8_t *d = reinterpret_cast<const uint8_t*>(&row[i]);
+        ASSERT_EQ(d[0], s[2]);
+        ASSERT_EQ(d[1], s[1]);
+        ASSERT_EQ(d[2], s[0]);
+        ASSERT_EQ(d[3], s[3]);
+    }
+}
+
+TEST(PixelConvert, ReplaceAlphaWithMask32) {
+    uint32_t state = 3u;
+    std::vector<uint32_t> row = MakeRow(32, 37, state);
+    for (size_t i = 0; i < row.size(); i += 3)
+        row[i] &= 0x00FFFFFFu; // make some pixels fully transparent
+    const std::vector<uint32_t> orig = row;
+    ReplaceAlphaWithMask32(row.data(), static_cast<int>(row.size()));
+    for (size_t i = 0; i < row.size(); ++i)
+        ASSERT_EQ(row[i], (geta32(orig[i]) == 0) ? static_cast<uint32_t>(MASK_COLOR_32) : orig[i]);
+}
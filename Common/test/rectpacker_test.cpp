@@ -0,0 +1,95 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <vector>
+#include "gtest/gtest.h"
+#include "util/rectpacker.h"
+
+using namespace AGS::Common;
+
+// Tests that the rectangles are within their pages, and do not overlap
+// (including the padding)
+static void CheckPlacement(const std::vector<PackedRect> &rects, const Size &page_size, int padding)
+{
+    for (size_t i = 0; i < rects.size(); ++i)
+    {
+        const auto &r = rects[i];
+        ASSERT_GE(r.Page, 0);
+        ASSERT_GE(r.Place.Left, 0);
+        ASSERT_GE(r.Place.Top, 0);
+        ASSERT_LT(r.Place.Right, page_size.Width);
+        ASSERT_LT(r.Place.Bottom, page_size.Height);
+        for (size_t j = i + 1; j < rects.size(); ++j)
+        {
+            if (rects[j].Page != r.Page)
+                continue;
+            const Rect &a = r.Place;
+            const Rect &b = rects[j].Place;
+            const bool apart = (a.Right + padding < b.Left) || (b.Right + padding < a.Left) ||
+                (a.Bottom + padding < b.Top) || (b.Bottom + padding < a.Top);
+            ASSERT_TRUE(apart);
+        }
+    }
+}
+
+TEST(RectPacker, Add) {
+    RectPacker packer(Size(64, 64));
+    // Four quarters fill a page exactly
+    for (int i = 0; i < 4; ++i)
+    {
+        PackedRect r = packer.Add(Size(32, 32));
+        ASSERT_EQ(r.Page, 0);
+        ASSERT_EQ(r.Place.GetWidth(), 32);
+    }
+    ASSERT_FLOAT_EQ(packer.GetOccupancy(), 1.f);
+    // Next one goes to a new page
+    ASSERT_EQ(packer.Add(Size(10, 10)).Page, 1);
+    ASSERT_EQ(packer.GetPageCount(), 2u);
+    // Too large or empty cannot be placed
+    ASSERT_EQ(packer.Add(Size(65, 10)).Page, -1);
+    ASSERT_EQ(packer.Add(Size(0, 10)).Page, -1);
+    packer.Clear();
+    ASSERT_EQ(packer.GetPageCount(), 0u);
+}
+
+TEST(RectPacker, ClearPage) {
+    RectPacker packer(Size(64, 64), 0, 2);
+    ASSERT_EQ(packer.Add(Size(64, 64)).Page, 0);
+    ASSERT_EQ(packer.Add(Size(64, 64)).Page, 1);
+    // Both pages are full, and no more allowed
+    ASSERT_EQ(packer.Add(Size(8, 8)).Page, -1);
+    ASSERT_EQ(packer.GetPageCount(), 2u);
+    // Cleared page is reused from the start
+    packer.ClearPage(0);
+    ASSERT_FLOAT_EQ(packer.GetOccupancy(), 0.5f);
+    PackedRect r = packer.Add(Size(8, 8));
+    ASSERT_EQ(r.Page, 0);
+    ASSERT_EQ(r.Place.Left, 0);
+    ASSERT_EQ(r.Place.Top, 0);
+    ASSERT_EQ(packer.GetPageCount(), 2u);
+}
+
+TEST(RectPacker, Pack) {
+    std::vector<Size> sizes;
+    for (int i = 0; i < 200; ++i)
+        sizes.push_back(Size(4 + (i * 7) % 29, 4 + (i * 13) % 23));
+    const Size page_size(128, 128);
+    auto rects = RectPacker::Pack(sizes, page_size, 1);
+    ASSERT_EQ(rects.size(), sizes.size());
+    CheckPlacement(rects, page_size, 1);
+    for (size_t i = 0; i < rects.size(); ++i)
+    {
+        ASSERT_EQ(rects[i].Place.GetWidth(), sizes[i].Width);
+        ASSERT_EQ(rects[i].Place.GetHeight(), sizes[i].Height);
+    }
+}
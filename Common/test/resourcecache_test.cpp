@@ -0,0 +1,190 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gtest/gtest.h"
+#include "util/resourcecache.h"
+
+using namespace AGS::Common;
+
+// Test cache, where the item's value is also its size
+class TestCache : public ResourceCache<int, int>
+{
+public:
+    TestCache(size_t max_size) : ResourceCache(max_size) {}
+
+protected:
+    size_t CalcSize(const int &item) override { return item; }
+};
+
+TEST(ResourceCache, LRU) {
+    TestCache cache(100);
+    for (int i = 1; i <= 4; ++i)
+        cache.Put(i, 25);
+    ASSERT_EQ(cache.GetCacheSize(), 100u);
+    ASSERT_EQ(cache.Get(1), 25);
+    cache.Put(5, 25);
+    ASSERT_TRUE(cache.Exists(1));
+    ASSERT_FALSE(cache.Exists(2));
+    ASSERT_TRUE(cache.Exists(3));
+    ASSERT_EQ(cache.Get(2), 0);
+    ASSERT_EQ(cache.GetHitCount(), 1u);
+    ASSERT_EQ(cache.GetMissCount(), 1u);
+
+    // Locked items are not disposed
+    cache.Lock(3);
+    cache.Put(6, 50);
+    ASSERT_TRUE(cache.Exists(3));
+    ASSERT_FALSE(cache.Exists(4));
+    ASSERT_FALSE(cache.Exists(1));
+    ASSERT_EQ(cache.GetCacheSize(), 100u);
+    ASSERT_EQ(cache.GetLockedSize(), 25u);
+    cache.DisposeFreeItems();
+    ASSERT_TRUE(cache.Exists(3));
+    ASSERT_FALSE(cache.Exists(6));
+    ASSERT_EQ(cache.GetCacheSize(), 25u);
+}
+
+TEST(ResourceCache, SLRU) {
+    TestCache cache(100);
+    cache.SetPolicy(kCachePolicy_SLRU);
+    cache.Put(1, 25);
+    cache.Put(2, 25);
+    cache.Get(1);
+    cache.Get(2);
+    // A scan of items used only once does not push out the reused ones
+    for (int i = 3; i <= 10; ++i)
+        cache.Put(i, 25);
+    ASSERT_TRUE(cache.Exists(1));
+    ASSERT_TRUE(cache.Exists(2));
+    ASSERT_TRUE(cache.Exists(9));
+    ASSERT_TRUE(cache.Exists(10));
+    ASSERT_FALSE(cache.Exists(8));
+    ASSERT_EQ(cache.GetCacheSize(), 100u);
+
+    // Protected segment is limited, and its oldest items go back to probation
+    cache.Get(9);
+    cache.Get(10);
+    cache.Put(11, 25);
+    ASSERT_FALSE(cache.Exists(1));
+    ASSERT_TRUE(cache.Exists(2));
+    ASSERT_TRUE(cache.Exists(11));
+
+    // Locking and releasing the probation item
+    cache.Lock(11);
+    cache.Put(12, 50);
+    ASSERT_TRUE(cache.Exists(11));
+    ASSERT_EQ(cache.GetLockedSize(), 25u);
+    cache.Release(11);
+    ASSERT_EQ(cache.GetLockedSize(), 0u);
+
+    // Switching policy keeps the items
+    const size_t size = cache.GetCacheSize();
+    cache.SetPolicy(kCachePolicy_LRU);
+    ASSERT_EQ(cache.GetCacheSize(), size);
+    ASSERT_TRUE(cache.Exists(11));
+    ASSERT_TRUE(cache.Exists(12));
+    cache.DisposeFreeItems();
+    ASSERT_EQ(cache.GetCacheSize(), 0u);
+}
+
+TEST(ResourceCache, CostAware) {
+    TestCache cache(100);
+    cache.SetPolicy(kCachePolicy_Cost);
+    cache.Put(1, 25, 0u, 1000);
+    cache.Put(2, 25, 0u, 10);
+    cache.Put(3, 25, 0u, 500);
+    cache.Put(4, 25, 0u, 100);
+    // The cheapest items are disposed first
+    cache.Put(5, 25, 0u, 2000);
+    ASSERT_FALSE(cache.Exists(2));
+    cache.Put(6, 25, 0u, 2000);
+    ASSERT_FALSE(cache.Exists(4));
+    ASSERT_TRUE(cache.Exists(1));
+    ASSERT_TRUE(cache.Exists(3));
+    // Cost is compared per size unit
+    cache.Put(7, 50, 0u, 1200);
+    ASSERT_FALSE(cache.Exists(3));
+    ASSERT_FALSE(cache.Exists(1));
+    ASSERT_TRUE(cache.Exists(5));
+    ASSERT_TRUE(cache.Exists(6));
+    ASSERT_EQ(cache.GetCacheSize(), 100u);
+}
+
+TEST(ResourceCache, ReuseNodes) {
+    TestCache cache(100);
+    cache.Reserve(10);
+    // Keep replacing items, locking and releasing some of them
+    for (int i = 0; i < 1000; ++i)
+    {
+        cache.Put(i, 10 + i % 4);
+        if (i % 7 == 0)
+            cache.Lock(i);
+        if (i % 7 == 3)
+            cache.Release(i - 3);
+        if (i % 5 == 0)
+            cache.Get(i - 2);
+        ASSERT_LE(cache.GetCacheSize(), 100u);
+    }
+    ASSERT_TRUE(cache.Exists(999));
+    // Every item is still reachable for disposal
+    cache.DisposeFreeItems();
+    ASSERT_EQ(cache.GetCacheSize(), cache.GetLockedSize());
+    cache.Clear();
+    ASSERT_EQ(cache.GetCacheSize(), 0u);
+    cache.Put(1, 50);
+    cache.Put(2, 50);
+    cache.Put(3, 50);
+    ASSERT_FALSE(cache.Exists(1));
+    ASSERT_EQ(cache.GetCacheSize(), 100u);
+}
+
+TEST(ResourceCache, Stats) {
+    TestCache cache(100);
+    for (int i = 1; i <= 6; ++i)
+        cache.Put(i, 25);
+    cache.Get(6);
+    cache.Get(1);
+    const auto &stats = cache.GetStats();
+    ASSERT_EQ(stats.Hits, 1u);
+    ASSERT_EQ(stats.Misses, 1u);
+    ASSERT_EQ(stats.Evictions, 2u);
+
+    ResourceCacheStats load_stats;
+    load_stats.AddLoad(100, 50);
+    load_stats.AddLoad(200, 100);
+    load_stats.AddLoad(300, 1000000);
+    ASSERT_EQ(load_stats.Loads, 3u);
+    ASSERT_EQ(load_stats.LoadedSize, 600u);
+    ASSERT_EQ(load_stats.LoadTime[0], 1u);
+    ASSERT_EQ(load_stats.LoadTime[1], 1u);
+    ASSERT_EQ(load_stats.LoadTime[ResourceCacheStats::LoadTimeBucketCount - 1], 1u);
+    cache.ResetStats();
+    ASSERT_EQ(cache.GetStats().Hits, 0u);
+}
+
+TEST(ResourceCache, Shrink) {
+    TestCache cache(100);
+    for (int i = 1; i <= 4; ++i)
+        cache.Put(i, 25);
+    cache.Lock(1);
+    // Frees whole items, the oldest first
+    ASSERT_EQ(cache.Shrink(30), 50u);
+    ASSERT_FALSE(cache.Exists(2));
+    ASSERT_FALSE(cache.Exists(3));
+    ASSERT_TRUE(cache.Exists(4));
+    // Locked items are kept
+    ASSERT_EQ(cache.Shrink(100), 25u);
+    ASSERT_TRUE(cache.Exists(1));
+    ASSERT_EQ(cache.GetCacheSize(), 25u);
+    ASSERT_EQ(cache.Shrink(100), 0u);
+}
@@ -0,0 +1,304 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/gamestructdefines.h"
+#include "ac/spritecache.h"
+#include "ac/spritefile.h"
+#include "gfx/bitmap.h"
+#include "util/memory_compat.h"
+#include "util/memorystream.h"
+
+using namespace AGS::Common;
+
+// Reimplementation of project-dependent functions from Common
+void __my_setcolor(int *ctset, int newcol, int /*wantColDep*/)
+{
+    *ctset = newcol;
+}
+
+static const sprkey_t TestSpriteCount = 16;
+
+// Writes a sprite file, where each sprite is filled with its own index
+static void WriteTestSpriteFile(std::vector<uint8_t> &buf, SpriteCompression compress = kSprCompress_None)
+{
+    SpriteFileWriter writer(std::unique_ptr<Stream>(new Stream(std::make_unique<VectorStream>(buf, kStream_Write))));
+    writer.Begin(0, compress, TestSpriteCount - 1);
+    for (sprkey_t i = 0; i < TestSpriteCount; ++i)
+    {
+        std::unique_ptr<Bitmap> image(BitmapHelper::CreateBitmap(4 + i, 4, 8));
+        image->Clear(i);
+        writer.WriteBitmap(image.get());
+    }
+    writer.Finalize();
+}
+
+TEST(SpriteCache, Prefetch) {
+    std::vector<uint8_t> buf;
+    WriteTestSpriteFile(buf);
+
+    std::vector<SpriteInfo> infos;
+    SpriteCache cache(infos, SpriteCache::Callbacks());
+    HError err = cache.InitFile(std::unique_ptr<Stream>(new Stream(std::make_unique<VectorStream>(buf))), nullptr);
+    ASSERT_TRUE(err);
+    ASSERT_EQ(cache.GetSpriteSlotCount(), static_cast<size_t>(TestSpriteCount));
+
+    std::vector<sprkey_t> request;
+    for (sprkey_t i = 1; i < TestSpriteCount; ++i)
+        request.push_back(i);
+    request.push_back(TestSpriteCount + 10); // non-existing sprite is ignored
+    cache.PrefetchSprites(request);
+    cache.PrefetchSprites(request); // repeated requests are ignored
+
+    // Accessing sprites either waits for them, or loads them right away
+    for (sprkey_t i = TestSpriteCount - 1; i > TestSpriteCount / 2; --i)
+    {
+        Bitmap *image = cache[i];
+        ASSERT_EQ(image->GetWidth(), 4 + i);
+        ASSERT_EQ(image->GetPixel(0, 0), i);
+    }
+    cache.ProcessPrefetchedSprites();
+    for (sprkey_t i = 1; i < TestSpriteCount; ++i)
+    {
+        Bitmap *image = cache[i];
+        ASSERT_TRUE(cache.IsSpriteLoaded(i));
+        ASSERT_EQ(image->GetWidth(), 4 + i);
+        ASSERT_EQ(image->GetPixel(0, 0), i);
+    }
+
+    // Prefetched sprites are discarded when the cache is reset
+    cache.DisposeAllCached();
+    cache.PrefetchSprites(request);
+    cache.StopPrefetch();
+    ASSERT_EQ(cache[5]->GetPixel(0, 0), 5);
+    cache.PrefetchSprites(request);
+    cache.Reset();
+    ASSERT_EQ(cache.GetSpriteSlotCount(), 0u);
+}
+
+TEST(SpriteCache, CompressedSprites) {
+    const SpriteCompression compress[] = { kSprCompress_RLE, kSprCompress_LZW,
+        kSprCompress_Deflate, kSprCompress_LZ4 };
+    for (const auto c : compress)
+    {
+        std::vector<uint8_t> buf;
+        WriteTestSpriteFile(buf, c);
+
+        std::vector<SpriteInfo> infos;
+        SpriteCache cache(infos, SpriteCache::Callbacks());
+        HError err = cache.InitFile(std::unique_ptr<Stream>(new Stream(std::make_unique<VectorStream>(buf))), nullptr);
+        ASSERT_TRUE(err);
+        ASSERT_EQ(cache.GetSpriteCompression(), c);
+        for (sprkey_t i = 0; i < TestSpriteCount; ++i)
+        {
+            Bitmap *image = cache[i];
+            ASSERT_EQ(image->GetWidth(), 4 + i);
+            ASSERT_EQ(image->GetPixel(3 + i, 3), i);
+        }
+    }
+}
+
+TEST(SpriteCache, PrecacheMany) {
+    const SpriteCompression compress[] = { kSprCompress_None, kSprCompress_LZW, kSprCompress_LZ4 };
+    const size_t threads[] = { 1u, 4u };
+    for (const auto c : compress)
+    {
+        for (const auto thread_count : threads)
+        {
+            std::vector<uint8_t> buf;
+            WriteTestSpriteFile(buf, c);
+
+            std::vector<SpriteInfo> infos;
+            SpriteCache cache(infos, SpriteCache::Callbacks());
+            cache.SetDecodeThreadCount(thread_count);
+            HError err = cache.InitFile(std::unique_ptr<Stream>(new Stream(std::make_unique<VectorStream>(buf))), nullptr);
+            ASSERT_TRUE(err);
+            // Some of the sprites may already be loaded or prefetched
+            cache.PrecacheSprite(3);
+            std::vector<sprkey_t> prefetch = { 5, 6 };
+            cache.PrefetchSprites(prefetch);
+
+            std::vector<sprkey_t> request;
+            for (sprkey_t i = TestSpriteCount - 1; i > 0; --i)
+                request.push_back(i);
+            request.push_back(7); // repeated sprite is loaded once
+            request.push_back(TestSpriteCount + 10); // non-existing sprite is ignored
+            cache.PrecacheSprites(request);
+            for (sprkey_t i = 1; i < TestSpriteCount; ++i)
+                ASSERT_TRUE(cache.IsSpriteLoaded(i));
+            ASSERT_EQ(cache.GetStats().Loads, static_cast<uint64_t>(TestSpriteCount - 1));
+            for (sprkey_t i = 1; i < TestSpriteCount; ++i)
+            {
+                Bitmap *image = cache[i];
+                ASSERT_EQ(image->GetWidth(), 4 + i);
+                ASSERT_EQ(image->GetPixel(3 + i, 3), i);
+            }
+        }
+    }
+}
+
+TEST(SpriteCache, KeepIndexed) {
+    // Write 32-bit sprites with few colors, which are stored as indexed
+    std::vector<uint8_t> buf;
+    {
+        SpriteFileWriter writer(std::unique_ptr<Stream>(new Stream(std::make_unique<VectorStream>(buf, kStream_Write))));
+        writer.Begin(kSprStore_OptimizeForSize, kSprCompress_None, 1);
+        for (sprkey_t i = 0; i < 2; ++i)
+        {
+            std::unique_ptr<Bitmap> image(BitmapHelper::CreateBitmap(40, 20, 32));
+            image->Clear(0xFF102030);
+            image->FillRect(Rect(5, 5, 14, 14), 0x80A0B0C0 + i);
+            writer.WriteBitmap(image.get());
+        }
+        writer.Finalize();
+    }
+
+    std::vector<SpriteInfo> infos;
+    SpriteCache cache(infos, SpriteCache::Callbacks());
+    cache.SetKeepIndexed(true);
+    HError err = cache.InitFile(std::unique_ptr<Stream>(new Stream(std::make_unique<VectorStream>(buf))), nullptr);
+    ASSERT_TRUE(err);
+    cache.PrecacheSprite(1);
+    ASSERT_TRUE(cache.IsSpriteLoaded(1));
+    ASSERT_TRUE(cache.IsSpriteIndexed(1));
+    const size_t size_before = cache.GetCacheSize();
+
+    // Temporary copy is expanded, but the cache keeps the indexed sprite
+    std::unique_ptr<Bitmap> copy = cache.LoadSpriteNoCache(1);
+    ASSERT_TRUE(copy);
+    ASSERT_EQ(copy->GetColorDepth(), 32);
+    ASSERT_EQ(static_cast<uint32_t>(copy->GetPixel(0, 0)), 0xFF102030u);
+    ASSERT_EQ(static_cast<uint32_t>(copy->GetPixel(10, 10)), 0x80A0B0C1u);
+    ASSERT_TRUE(cache.IsSpriteIndexed(1));
+
+    // Accessing the sprite expands it in the cache
+    Bitmap *image = cache[1];
+    ASSERT_EQ(image->GetColorDepth(), 32);
+    ASSERT_EQ(static_cast<uint32_t>(image->GetPixel(14, 14)), 0x80A0B0C1u);
+    ASSERT_EQ(static_cast<uint32_t>(image->GetPixel(15, 15)), 0xFF102030u);
+    ASSERT_FALSE(cache.IsSpriteIndexed(1));
+    ASSERT_EQ(cache.GetCacheSize(), size_before + 40 * 20 * 3);
+}
+
+TEST(SpriteCache, SpriteMask) {
+    std::vector<SpriteInfo> infos;
+    SpriteCache cache(infos, SpriteCache::Callbacks());
+    ASSERT_EQ(cache.GetSpriteMask(1), nullptr);
+
+    std::unique_ptr<Bitmap> image(BitmapHelper::CreateTransparentBitmap(10, 8, 32));
+    image->PutPixel(3, 4, 0x102030);
+    ASSERT_TRUE(cache.SetSprite(1, std::move(image)));
+    const BitMask *mask = cache.GetSpriteMask(1);
+    ASSERT_NE(mask, nullptr);
+    ASSERT_EQ(mask->GetWidth(), 10);
+    ASSERT_EQ(mask->GetHeight(), 8);
+    ASSERT_TRUE(mask->IsSet(3, 4));
+    ASSERT_FALSE(mask->IsSet(4, 4));
+    ASSERT_EQ(cache.GetSpriteMask(1), mask); // same mask is returned until invalidated
+
+    // The mask is made again after the image was modified
+    cache[1]->PutPixel(4, 4, 0x102030);
+    cache.InvalidateSpriteMask(1);
+    ASSERT_TRUE(cache.GetSpriteMask(1)->IsSet(4, 4));
+
+    // Replaced sprite gets its own mask
+    ASSERT_TRUE(cache.SetSprite(1, std::unique_ptr<Bitmap>(BitmapHelper::CreateTransparentBitmap(5, 5, 32))));
+    ASSERT_EQ(cache.GetSpriteMask(1)->GetWidth(), 5);
+    ASSERT_FALSE(cache.GetSpriteMask(1)->IsSet(3, 4));
+    cache.DisposeSprite(1);
+    ASSERT_EQ(cache.GetSpriteMask(1), nullptr);
+}
+
+// Writes a sprite file with sprites of various sizes and contents,
+// using the given number of threads
+static void WriteVariedSpriteFile(std::vector<uint8_t> &buf, int store_flags, SpriteCompression compress,
+    int thread_count, const std::vector<std::unique_ptr<Bitmap>> &images)
+{
+    SpriteFileWriter writer(std::unique_ptr<Stream>(new Stream(std::make_unique<VectorStream>(buf, kStream_Write))),
+        thread_count);
+    writer.Begin(store_flags, compress, static_cast<sprkey_t>(images.size()) - 1);
+    const uint8_t raw_data[] = { 4, 0, 0, 0, 1, 2, 3, 4 }; // data size and pixels
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        if (!images[i])
+        {
+            if (i % 2 == 0)
+                writer.WriteEmptySlot();
+            else
+                writer.WriteRawData(SpriteDatHeader(1, kSprFmt_Undefined, 0, compress, 2, 2), raw_data, sizeof(raw_data));
+        }
+        else if (i % 3 == 0)
+        {
+            std::unique_ptr<Bitmap> copy(BitmapHelper::CreateBitmapCopy(images[i].get()));
+            writer.WriteBitmap(std::move(copy));
+        }
+        else
+        {
+            writer.QueueBitmap(images[i].get());
+        }
+    }
+    writer.Finalize();
+}
+
+TEST(SpriteFile, ParallelWrite) {
+    // The sprites written on multiple threads must be same as written on one
+    std::vector<std::unique_ptr<Bitmap>> images;
+    for (int i = 0; i < 40; ++i)
+    {
+        if (i % 7 == 5)
+        {
+            images.emplace_back();
+            continue;
+        }
+        const int depth = (i % 3 == 0) ? 8 : ((i % 3 == 1) ? 16 : 32);
+        std::unique_ptr<Bitmap> image(BitmapHelper::CreateBitmap(8 + i * 3, 6 + i, depth));
+        image->Clear(i);
+        for (int y = 0; y < image->GetHeight(); y += 2)
+            image->FillRect(Rect(0, y, (y * 7 + i) % image->GetWidth(), y), (y * 31 + i) & 0xFF);
+        images.push_back(std::move(image));
+    }
+
+    const SpriteCompression compress[] = { kSprCompress_None, kSprCompress_RLE, kSprCompress_LZW,
+        kSprCompress_Deflate, kSprCompress_LZ4 };
+    const int store_flags[] = { 0, kSprStore_OptimizeForSize };
+    for (const auto c : compress)
+    {
+        for (const auto flags : store_flags)
+        {
+            std::vector<uint8_t> serial, parallel;
+            WriteVariedSpriteFile(serial, flags, c, 1, images);
+            WriteVariedSpriteFile(parallel, flags, c, 4, images);
+            ASSERT_EQ(serial.size(), parallel.size());
+            // Sprite file ID is made of the current time, skip it
+            const size_t id_offset = 2 + 13 + 1;
+            std::fill(serial.begin() + id_offset, serial.begin() + id_offset + 4, 0);
+            std::fill(parallel.begin() + id_offset, parallel.begin() + id_offset + 4, 0);
+            ASSERT_EQ(serial, parallel);
+
+            std::vector<SpriteInfo> infos;
+            SpriteCache cache(infos, SpriteCache::Callbacks());
+            HError err = cache.InitFile(std::unique_ptr<Stream>(new Stream(std::make_unique<VectorStream>(parallel))), nullptr);
+            ASSERT_TRUE(err);
+            for (size_t i = 0; i < images.size(); ++i)
+            {
+                if (!images[i])
+                    continue;
+                Bitmap *image = cache[i];
+                ASSERT_EQ(image->GetWidth(), images[i]->GetWidth());
+                ASSERT_EQ(image->GetPixel(image->GetWidth() - 1, 1), images[i]->GetPixel(image->GetWidth() - 1, 1));
+            }
+        }
+    }
+}
@@ -0,0 +1,73 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <memory>
+#include <thread>
+#include "gtest/gtest.h"
+#include "util/spsc_queue.h"
+
+using namespace AGS::Common;
+
+TEST(SpscQueue, PushPop) {
+    SpscQueue<std::unique_ptr<int>> queue(3);
+    ASSERT_EQ(queue.GetCapacity(), 3u);
+    ASSERT_TRUE(queue.IsEmpty());
+    std::unique_ptr<int> item;
+    ASSERT_FALSE(queue.TryPop(item));
+
+    // Items wrap around the ring buffer in order
+    int next_push = 0, next_pop = 0;
+    for (int round = 0; round < 4; ++round)
+    {
+        while (queue.TryPush(std::unique_ptr<int>(new int(next_push))))
+            next_push++;
+        ASSERT_EQ(next_push - next_pop, 3);
+        ASSERT_FALSE(queue.IsEmpty());
+        for (int i = 0; i < 2; ++i)
+        {
+            ASSERT_TRUE(queue.TryPop(item));
+            ASSERT_EQ(*item, next_pop++);
+        }
+    }
+    while (queue.TryPop(item))
+        ASSERT_EQ(*item, next_pop++);
+    ASSERT_EQ(next_pop, next_push);
+    ASSERT_TRUE(queue.IsEmpty());
+}
+
+#if !defined(AGS_DISABLE_THREADS)
+TEST(SpscQueue, TwoThreads) {
+    SpscQueue<int> queue(16);
+    const int count = 100000;
+    std::thread producer([&queue]()
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            int item = i;
+            while (!queue.TryPush(std::move(item)))
+                std::this_thread::yield();
+        }
+    });
+    int expect = 0;
+    while (expect < count)
+    {
+        int item;
+        if (queue.TryPop(item))
+            ASSERT_EQ(item, expect++);
+        else
+            std::this_thread::yield();
+    }
+    producer.join();
+    ASSERT_TRUE(queue.IsEmpty());
+}
+#endif
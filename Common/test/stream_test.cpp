@@ -18,6 +18,7 @@
 #include "util/bufferedstream.h"
 #include "util/file.h"
 #include "util/filestream.h"
+#include "util/mappedfilestream.h"
 #include "util/memory_compat.h"
 #include "util/memorystream.h"
 #include "util/string_utils.h"
@@ -208,6 +209,103 @@ TEST(Stream, VectorStream) {
     in.Close();
 }
 
+TEST(Stream, OwnedMemoryStream) {
+    std::vector<uint8_t> membuf;
+    {
+        Stream out(std::make_unique<VectorStream>(membuf, kStream_Write));
+        out.WriteInt8(1);
+        out.WriteInt16(2);
+        out.WriteInt32(3);
+        out.WriteInt64(4);
+        out.WriteFloat32(5.5f);
+        out.WriteInt16(6);
+    }
+    const size_t data_len = membuf.size();
+    // Memory-backed stream reads the values directly from its buffer
+    auto in = Stream::WrapMemory(std::make_unique<OwnedMemoryStream>(std::move(membuf), "test.dat"));
+    ASSERT_TRUE(in->CanRead());
+    ASSERT_TRUE(in->CanSeek());
+    ASSERT_FALSE(in->CanWrite());
+    ASSERT_NE(in->GetMemoryBuffer(), nullptr);
+    ASSERT_STREQ(in->GetPath(), "test.dat");
+    ASSERT_EQ(in->GetLength(), data_len);
+    ASSERT_EQ(in->ReadInt8(), 1);
+    ASSERT_EQ(in->ReadInt16(), 2);
+    ASSERT_EQ(in->ReadInt32(), 3);
+    ASSERT_EQ(in->ReadInt64(), 4);
+    ASSERT_EQ(in->ReadFloat32(), 5.5f);
+    // the direct reads and the stream's position are kept in sync
+    const soff_t pos = in->GetPosition();
+    ASSERT_EQ(pos, data_len - sizeof(int16_t));
+    ASSERT_EQ(in->Seek(-static_cast<soff_t>(sizeof(float)), kSeekCurrent), pos - sizeof(float));
+    ASSERT_EQ(in->ReadFloat32(), 5.5f);
+    ASSERT_EQ(in->ReadInt16(), 6);
+    ASSERT_TRUE(in->EOS());
+    // partial value at the end is read as far as there's data
+    ASSERT_EQ(in->Seek(-1, kSeekEnd), data_len - 1);
+    ASSERT_EQ(in->ReadInt16(), 0);
+    ASSERT_EQ(in->GetPosition(), data_len);
+    ASSERT_EQ(in->ReadInt32(), 0);
+    in->Close();
+    ASSERT_EQ(in->GetMemoryBuffer(), nullptr);
+}
+
+// Memory stream which counts the read calls, for testing the buffering
+class CountingStream : public VectorStream
+{
+public:
+    CountingStream(const std::vector<uint8_t> &cbuf, size_t &reads, size_t &bytes)
+        : VectorStream(cbuf), _reads(reads), _bytes(bytes) {}
+
+    size_t Read(void *buffer, size_t size) override
+    {
+        size_t sz = VectorStream::Read(buffer, size);
+        _reads++;
+        _bytes += sz;
+        return sz;
+    }
+
+private:
+    size_t &_reads;
+    size_t &_bytes;
+};
+
+TEST(Stream, BufferedStreamReadAhead) {
+    std::vector<uint8_t> membuf(1024 * 1024);
+    for (size_t i = 0; i < membuf.size(); ++i)
+        membuf[i] = static_cast<uint8_t>(i * 7 + i / 256);
+
+    // Sequential reading increases the read-ahead
+    size_t reads = 0, bytes = 0;
+    Stream in(std::make_unique<BufferedStream>(std::make_unique<CountingStream>(membuf, reads, bytes)));
+    uint8_t chunk[16];
+    for (size_t pos = 0; pos < membuf.size(); pos += sizeof(chunk))
+    {
+        ASSERT_EQ(in.Read(chunk, sizeof(chunk)), sizeof(chunk));
+        ASSERT_EQ(chunk[5], membuf[pos + 5]);
+    }
+    ASSERT_TRUE(in.EOS());
+    ASSERT_EQ(bytes, membuf.size());
+    ASSERT_LT(reads, membuf.size() / BufferedStream::BufferSize / 4);
+
+    // Random reading decreases the read-ahead back to the buffer size
+    const size_t buffer_size = 512;
+    reads = 0, bytes = 0;
+    Stream in2(std::make_unique<BufferedStream>(std::make_unique<CountingStream>(membuf, reads, bytes), buffer_size));
+    for (size_t i = 0; i < 64; ++i)
+        ASSERT_EQ(in2.ReadByte(), membuf[i]);
+    size_t random_reads = 0;
+    for (size_t i = 0; i < 100; ++i)
+    {
+        const size_t pos = (i * 104729u) % (membuf.size() - sizeof(chunk));
+        in2.Seek(pos, kSeekBegin);
+        ASSERT_EQ(in2.Read(chunk, sizeof(chunk)), sizeof(chunk));
+        ASSERT_EQ(chunk[0], membuf[pos]);
+        random_reads++;
+    }
+    ASSERT_LE(bytes, buffer_size * (random_reads + 1));
+}
+
 TEST(Stream, DataStreamSection) {
     // Storage buffer
     std::vector<uint8_t> membuf;
@@ -671,4 +769,63 @@ TEST_F(FileBasedTest, BufferedSectionStream) {
     File::DeleteFile(DummyFile);
 }
 
+TEST_F(FileBasedTest, MappedFileStream) {
+    if (!MappedFileStream::IsSupported())
+        return;
+    //-------------------------------------------------------------------------
+    // Write data into the temp file; make section start not page-aligned
+    Stream out(std::make_unique<FileStream>(DummyFile, kFile_CreateAlways, kStream_Write));
+    out.WriteByteCount(0xFF, 4097);
+    const auto section_start = out.GetPosition();
+    out.WriteInt32(4);
+    out.WriteInt32(5);
+    out.WriteInt32(6);
+    out.WriteInt32(7);
+    const auto section_end = out.GetPosition();
+    out.WriteByteCount(0xFF, 16);
+    out.Close();
+
+    //-------------------------------------------------------------------------
+    // Read data back from the mapped section
+    auto in = MappedFileStream::OpenFile(DummyFile, section_start, section_end);
+    ASSERT_TRUE(in);
+    ASSERT_TRUE(in->CanRead());
+    ASSERT_TRUE(in->CanSeek());
+    ASSERT_FALSE(in->CanWrite());
+    ASSERT_EQ(in->GetPosition(), 0);
+    ASSERT_EQ(in->GetLength(), section_end - section_start);
+    ASSERT_EQ(in->ReadInt32(), 4);
+    ASSERT_EQ(in->ReadInt32(), 5);
+    // the data is accessible in place
+    const uint8_t *mem_buf = in->GetMemoryBuffer();
+    ASSERT_NE(mem_buf, nullptr);
+    ASSERT_EQ(mem_buf[0], 4);
+    ASSERT_EQ(mem_buf[3 * sizeof(int32_t)], 7);
+    ASSERT_EQ(in->Seek(3 * sizeof(int32_t), kSeekBegin), 3 * sizeof(int32_t));
+    ASSERT_EQ(in->ReadInt32(), 7);
+    ASSERT_TRUE(in->EOS());
+    // reading past section end - results in no data
+    ASSERT_EQ(in->ReadByte(), -1);
+    ASSERT_EQ(in->GetPosition(), section_end - section_start);
+    ASSERT_EQ(in->Seek(0, kSeekBegin), 0);
+    ASSERT_EQ(in->ReadInt32(), 4);
+    in->Close();
+    ASSERT_EQ(in->GetMemoryBuffer(), nullptr);
+    in.reset();
+
+    // Map the whole file
+    in = MappedFileStream::OpenFile(DummyFile);
+    ASSERT_TRUE(in);
+    ASSERT_EQ(in->GetLength(), section_end + 16);
+    ASSERT_EQ(in->Seek(section_start, kSeekBegin), section_start);
+    ASSERT_EQ(in->ReadInt32(), 4);
+    in.reset();
+
+    // Empty sections and missing files are not mapped
+    ASSERT_FALSE(MappedFileStream::OpenFile(DummyFile, section_start, section_start));
+    ASSERT_FALSE(MappedFileStream::OpenFile("nonexistent.dat"));
+
+    File::DeleteFile(DummyFile);
+}
+
 #endif // AGS_PLATFORM_TEST_FILE_IO
@@ -56,6 +56,57 @@ TEST(String, Internal) {
     ASSERT_TRUE(strcmp(s4.GetCStr(), "12345123456789012345") == 0);
 }
 
+TEST(String, LocalBuffer) {
+    // Short strings are kept in the local buffer, and copied on assignment
+    String s1 = "abcdefghijklmno";
+    ASSERT_TRUE(s1.GetLength() == String::LocalCapacity);
+    ASSERT_TRUE(s1.IsLocalBuffer());
+    String s2 = s1;
+    ASSERT_TRUE(s2.IsLocalBuffer());
+    ASSERT_TRUE(s1.GetCStr() != s2.GetCStr());
+    ASSERT_TRUE(s1.GetRefCount() == 1);
+    ASSERT_TRUE(strcmp(s2.GetCStr(), "abcdefghijklmno") == 0);
+    String s3 = std::move(s2);
+    ASSERT_TRUE(s3.IsLocalBuffer());
+    ASSERT_TRUE(s2.IsEmpty());
+    ASSERT_TRUE(strcmp(s3.GetCStr(), "abcdefghijklmno") == 0);
+
+    // Growing past the local capacity moves the data into a shared buffer
+    s3.AppendChar('p');
+    ASSERT_FALSE(s3.IsLocalBuffer());
+    String s4 = s3;
+    ASSERT_TRUE(s3.GetRefCount() == 2);
+    ASSERT_TRUE(s3.GetCStr() == s4.GetCStr());
+    ASSERT_TRUE(strcmp(s4.GetCStr(), "abcdefghijklmnop") == 0);
+
+    // Modifications which fit use the space around the data in place
+    String s5 = "world";
+    s5.Prepend("hello ");
+    ASSERT_TRUE(s5.IsLocalBuffer());
+    ASSERT_TRUE(strcmp(s5.GetCStr(), "hello world") == 0);
+    s5.ClipLeft(6);
+    s5.Prepend("big ");
+    s5.Append("!");
+    ASSERT_TRUE(s5.IsLocalBuffer());
+    ASSERT_TRUE(strcmp(s5.GetCStr(), "big world!") == 0);
+
+    // Compacting a shortened string brings it back into the local buffer
+    s4.TruncateToLeft(3);
+    ASSERT_FALSE(s4.IsLocalBuffer());
+    s4.Compact();
+    ASSERT_TRUE(s4.IsLocalBuffer());
+    ASSERT_TRUE(strcmp(s4.GetCStr(), "abc") == 0);
+    ASSERT_TRUE(strcmp(s3.GetCStr(), "abcdefghijklmnop") == 0);
+
+    // Modifying a short wrapped string makes a local copy
+    const char *cstr = "literal";
+    String s6 = String::Wrapper(cstr);
+    s6.SetAt(0, 'L');
+    ASSERT_TRUE(s6.IsLocalBuffer());
+    ASSERT_TRUE(strcmp(s6.GetCStr(), "Literal") == 0);
+    ASSERT_TRUE(strcmp(cstr, "literal") == 0);
+}
+
 TEST(String, Compare) {
     String s1 = "abcdabcdabcd";
     String s2 = "abcdbfghijklmn";
@@ -49,3 +49,33 @@ TEST(UTF8, GetCharBack) {
     TestGetCharBack(reinterpret_cast<const char*>(test_str3), reinterpret_cast<const char*>(first_char_bytes3));
     TestGetCharBack(reinterpret_cast<const char*>(test_str4), reinterpret_cast<const char*>(first_char_bytes4));
 }
+
+TEST(UTF8, AsciiPrefixLength) {
+    // long enough to cover both the vectorized and the per-byte parts
+    const char *ascii_str = "The quick brown fox jumps over the lazy dog";
+    const size_t ascii_len = strlen(ascii_str);
+    for (size_t len = 0; len <= ascii_len; ++len)
+        ASSERT_EQ(Utf8::AsciiPrefixLength(ascii_str, len), len);
+
+    char buf[64];
+    for (size_t pos = 0; pos < ascii_len; ++pos)
+    {
+        memcpy(buf, ascii_str, ascii_len + 1);
+        buf[pos] = static_cast<char>(0xE2);
+        ASSERT_EQ(Utf8::AsciiPrefixLength(buf, ascii_len), pos);
+        ASSERT_EQ(Utf8::AsciiPrefixLength(buf, pos), pos);
+    }
+}
+
+TEST(UTF8, GetLength) {
+    ASSERT_EQ(Utf8::GetLength(""), 0u);
+    ASSERT_EQ(Utf8::GetLength("latin"), 5u);
+    // 0xE2, 0x80, 0x80 - unicode symbol 0x2000 (non printable)
+    const uint8_t test_str1[] =
+    { 0xE2, 0x80, 0x80, 'l', 'a', 't', 'i', 'n', 0xE2, 0x80, 0x80, 0 };
+    ASSERT_EQ(Utf8::GetLength(reinterpret_cast<const char*>(test_str1)), 7u);
+    const uint8_t test_str2[] =
+    { 'T', 'h', 'e', ' ', 'q', 'u', 'i', 'c', 'k', ' ', 'b', 'r', 'o', 'w', 'n', ' ', 'f', 'o', 'x',
+      0xE3, 0x81, 0x93, 0xE3, 0x82, 0x93, 'j', 'u', 'm', 'p', 's', 0 };
+    ASSERT_EQ(Utf8::GetLength(reinterpret_cast<const char*>(test_str2)), 26u);
+}
@@ -96,6 +96,22 @@ soff_t GetAAssetSize(const String &filename)
     return len;
 }
 
+int OpenAAssetFileDescriptor(const String &filename, soff_t &start, soff_t &length)
+{
+    AAssetManager* mgr = GetAAssetManager();
+    if(mgr == nullptr) return -1;
+    String a_filename = Path::GetPathInForeignAsset(filename);
+    AAsset *asset = AAssetManager_open(mgr, a_filename.GetCStr(), AASSET_MODE_UNKNOWN);
+    if (!asset) return -1;
+    off64_t a_start = 0, a_length = 0;
+    int fd = AAsset_openFileDescriptor64(asset, &a_start, &a_length);
+    AAsset_close(asset);
+    if (fd < 0) return -1;
+    start = a_start;
+    length = a_length;
+    return fd;
+}
+
 
 AndroidADir::AndroidADir(AndroidADir &&aadir)
 {
@@ -41,6 +41,11 @@ AAssetManager *GetAAssetManager();
 bool           GetAAssetExists(const String &filename);
 // Gets the Android Asset's size, returns -1 if such asset was not found
 soff_t         GetAAssetSize(const String &filename);
+// Opens the file descriptor of the package containing the Android Asset,
+// and tells where the asset's data is in it. Only the assets stored
+// uncompressed may be opened this way; returns -1 if the asset was not
+// found or is compressed. The descriptor must be closed by the caller.
+int            OpenAAssetFileDescriptor(const String &filename, soff_t &start, soff_t &length);
 
 // AndroidDir wraps Android Asset directory and ensures its disposal
 class AndroidADir
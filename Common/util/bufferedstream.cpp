@@ -28,8 +28,9 @@ namespace Common
 //-----------------------------------------------------------------------------
 
 const size_t BufferedStream::BufferSize;
+const size_t BufferedStream::MaxReadAhead;
 
-void BufferedStream::Open(std::unique_ptr<IStreamBase> &&base_stream)
+void BufferedStream::Open(std::unique_ptr<IStreamBase> &&base_stream, size_t buffer_size)
 {
     if (!base_stream)
         throw std::runtime_error("Base stream invalid.");
@@ -42,13 +43,15 @@ void BufferedStream::Open(std::unique_ptr<IStreamBase> &&base_stream)
     _base = std::move(base_stream);
     _start = 0;
     _end = end_pos;
+    _bufferSize = buffer_size > 0u ? buffer_size : BufferSize;
+    _readAhead = _bufferSize;
 }
 
 void BufferedStream::OpenSection(std::unique_ptr<IStreamBase> &&base_stream,
-    soff_t start_pos, soff_t end_pos)
+    soff_t start_pos, soff_t end_pos, size_t buffer_size)
 {
     assert(start_pos <= end_pos);
-    Open(std::move(base_stream));
+    Open(std::move(base_stream), buffer_size);
     start_pos = std::min(start_pos, end_pos);
     _start = std::min(start_pos, _end);
     _end = std::min(end_pos, _end);
@@ -62,14 +65,20 @@ BufferedStream::~BufferedStream()
 
 void BufferedStream::FillBufferFromPosition(soff_t position)
 {
+    if (position == _lastReadEnd)
+        _readAhead = std::max(_bufferSize, std::min(_readAhead * 2, MaxReadAhead));
+    else
+        _readAhead = std::max(_bufferSize, _readAhead / 2);
+
     _base->Seek(position, kSeekBegin);
     // remember to restrict to the end position!
     size_t fill_size = static_cast<size_t>(
-        std::min<uint64_t>(BufferSize, static_cast<uint64_t>(_end - position)));
+        std::min<uint64_t>(_readAhead, static_cast<uint64_t>(_end - position)));
     _buffer.resize(fill_size);
     auto sz = _base->Read(_buffer.data(), fill_size);
     _buffer.resize(sz);
     _bufferPosition = position;
+    _lastReadEnd = position + sz;
 }
 
 void BufferedStream::FlushBuffer(soff_t position)
@@ -115,9 +124,9 @@ bool BufferedStream::Flush()
 
 size_t BufferedStream::Read(void *buffer, size_t size)
 {
-    // If the read size is larger than the internal buffer size,
+    // If the read size is larger than the current read-ahead size,
     // then read directly into the user buffer and bail out.
-    if (size >= BufferSize)
+    if (size >= _readAhead)
     {
         _base->Seek(_position, kSeekBegin);
         // remember to restrict to the end position!
@@ -125,6 +134,7 @@ size_t BufferedStream::Read(void *buffer, size_t size)
             std::min<uint64_t>(size, static_cast<uint64_t>(_end - _position)));
         size_t sz = _base->Read(buffer, fill_size);
         _position += sz;
+        _lastReadEnd = _position;
         return sz;
     }
 
@@ -169,12 +179,12 @@ size_t BufferedStream::Write(const void *buffer, size_t size)
     {
         if (_position < _bufferPosition || // seeked before buffer pos
             _position > _bufferPosition + static_cast<soff_t>(_buffer.size()) || // seeked beyond buffer pos
-            _position >= _bufferPosition + static_cast<soff_t>(BufferSize)) // seeked, or exceeded buffer limit
+            _position >= _bufferPosition + static_cast<soff_t>(_bufferSize)) // seeked, or exceeded buffer limit
         {
             FlushBuffer(_position);
         }
         size_t pos_in_buff = static_cast<size_t>(_position - _bufferPosition);
-        size_t chunk_sz = std::min(size, BufferSize - pos_in_buff);
+        size_t chunk_sz = std::min(size, _bufferSize - pos_in_buff);
         if (_buffer.size() < pos_in_buff + chunk_sz)
             _buffer.resize(pos_in_buff + chunk_sz);
         memcpy(_buffer.data() + pos_in_buff, from, chunk_sz);
@@ -20,6 +20,13 @@
 // BufferedStream optionally supports limiting the stream operations
 // to an arbitrary offset range.
 //
+// The read-ahead size adapts to the access pattern: it starts with the
+// buffer size given on construction, doubles each time the buffer is
+// refilled right where the previous read ended (up to MaxReadAhead),
+// and halves back towards the initial size each time it's refilled
+// elsewhere after a seek. Thus sequential readers make few large reads,
+// while random readers do not read more than they were configured for.
+//
 //=============================================================================
 #ifndef __AGS_CN_UTIL__BUFFEREDSTREAM_H
 #define __AGS_CN_UTIL__BUFFEREDSTREAM_H
@@ -35,13 +42,19 @@ namespace Common
 class BufferedStream : public StreamBase
 {
 public:
-    // Needs tuning depending on the platform.
+    // Default buffer size; needs tuning depending on the platform.
     static const size_t BufferSize = 1024u * 8;
-    BufferedStream(std::unique_ptr<IStreamBase> &&base_stream)
-        { Open(std::move(base_stream)); }
+    // Maximal size of the read-ahead on sequential reading
+    static const size_t MaxReadAhead = 1024u * 256;
+
+    // Constructs a BufferedStream with the given initial buffer size,
+    // pass 0 to use the default one
+    BufferedStream(std::unique_ptr<IStreamBase> &&base_stream, size_t buffer_size = 0u)
+        { Open(std::move(base_stream), buffer_size); }
     // Constructs a BufferedStream limited by an arbitrary offset range
-    BufferedStream(std::unique_ptr<IStreamBase> &&base_stream, soff_t start_pos, soff_t end_pos)
-        { OpenSection(std::move(base_stream), start_pos, end_pos); }
+    BufferedStream(std::unique_ptr<IStreamBase> &&base_stream, soff_t start_pos, soff_t end_pos,
+            size_t buffer_size = 0u)
+        { OpenSection(std::move(base_stream), start_pos, end_pos, buffer_size); }
 
     ~BufferedStream();
 
@@ -67,9 +80,12 @@ public:
     soff_t  Seek(soff_t offset, StreamSeek origin) override;
 
 private:
-    void Open(std::unique_ptr<IStreamBase> &&base_stream);
-    void OpenSection(std::unique_ptr<IStreamBase> &&base_stream, soff_t start_pos, soff_t end_pos);
-    // Reads a chunk of file into the buffer, starting from the given offset
+    void Open(std::unique_ptr<IStreamBase> &&base_stream, size_t buffer_size);
+    void OpenSection(std::unique_ptr<IStreamBase> &&base_stream, soff_t start_pos, soff_t end_pos,
+        size_t buffer_size);
+    // Reads a chunk of file into the buffer, starting from the given offset;
+    // adjusts the read-ahead size depending on whether this continues
+    // the previous read
     void FillBufferFromPosition(soff_t position);
     // Writes a buffer into the file, and reposition to the new offset
     void FlushBuffer(soff_t position);
@@ -80,6 +96,9 @@ private:
     soff_t _position = 0; // absolute read/write offset
     soff_t _bufferPosition = 0; // buffer's location relative to file
     std::vector<uint8_t> _buffer;
+    size_t _bufferSize = BufferSize; // initial read-ahead and write buffer size
+    size_t _readAhead = BufferSize; // current read-ahead size
+    soff_t _lastReadEnd = -1; // absolute offset where the last device read ended
 };
 
 } // namespace Common
@@ -12,21 +12,37 @@
 //
 //=============================================================================
 #include "util/compress.h"
+#include <algorithm>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <vector>
 #include <miniz.h>
 #include "ac/common.h"	// quit, update_polled_stuff
 #include "gfx/bitmap.h"
+#include "util/lz4.h"
 #include "util/lzw.h"
 #include "util/memory_compat.h"
-#include "util/memorystream.h"
-#if AGS_PLATFORM_ENDIAN_BIG
 #include "util/bbop.h"
-#endif
+#include "util/memorystream.h"
 
 using namespace AGS::Common;
 
+// Returns a pointer to the next in_sz bytes of a memory-backed stream
+// and advances the stream past them; returns null if the data cannot be
+// accessed in place, in which case the stream is not changed
+static const uint8_t *GetInPlaceData(Stream *in, size_t in_sz)
+{
+    const uint8_t *mem_buf = in->GetMemoryBuffer();
+    if (!mem_buf)
+        return nullptr;
+    const soff_t pos = in->GetPosition();
+    if (pos < 0 || static_cast<uint64_t>(in->GetLength() - pos) < in_sz)
+        return nullptr;
+    in->Seek(in_sz, kSeekCurrent);
+    return mem_buf + pos;
+}
+
 //-----------------------------------------------------------------------------
 // RLE
 //-----------------------------------------------------------------------------
@@ -142,80 +158,86 @@ static void cpackbitl32(const uint32_t *line, size_t size, Stream *out)
   } // end while
 }
 
-static int cunpackbitl(uint8_t *line, size_t size, Stream *in)
-{
-  size_t n = 0;                  // number of bytes decoded
-
-  while (n < size) {
-    int ix = in->ReadByte();     // get index byte
-
-    signed char cx = ix;
-    if (cx == -128)
-      cx = 0;
-
-    if (cx < 0) {                //.............run
-      int i = 1 - cx;
-      char ch = in->ReadInt8();
-      while (i--) {
-        // test for buffer overflow
-        if (n >= size)
-          return -1;
-
-        line[n++] = ch;
-      }
-    } else {                     //.....................seq
-      int i = cx + 1;
-      while (i--) {
-        // test for buffer overflow
-        if (n >= size)
-          return -1;
-
-        line[n++] = in->ReadByte();
-      }
-    }
-  }
+static inline uint8_t PixelFromLE(uint8_t v) { return v; }
+static inline uint16_t PixelFromLE(uint16_t v) { return static_cast<uint16_t>(BBOp::Int16FromLE(v)); }
+static inline uint32_t PixelFromLE(uint32_t v) { return static_cast<uint32_t>(BBOp::Int32FromLE(v)); }
 
-  return 0;
+// Copies pixels from the little-endian data
+template <typename T>
+static inline void CopyPixelsLE(T *dst, const uint8_t *src, size_t count)
+{
+  memcpy(dst, src, count * sizeof(T));
+#if AGS_PLATFORM_ENDIAN_BIG
+  for (size_t i = 0; i < count; ++i)
+    dst[i] = PixelFromLE(dst[i]);
+#endif
 }
 
-static int cunpackbitl16(uint16_t *line, size_t size, Stream *in)
+// Unpacks RLE data from the memory buffer; runs are filled and sequences
+// are copied as a whole. Returns -1 if the unpacked data does not fit into
+// the line, 0 otherwise. Stops if the src data ends prematurely;
+// src_used is assigned the number of bytes read from src.
+template <typename T>
+static int cunpackbitl_mem(T *line, size_t size, const uint8_t *src, size_t src_sz, size_t &src_used)
 {
-  size_t n = 0;                  // number of bytes decoded
+  const uint8_t *ptr = src;
+  const uint8_t *const end = src + src_sz;
+  size_t n = 0;                  // number of pixels decoded
+  int result = 0;
 
-  while (n < size) {
-    int ix = in->ReadByte();     // get index byte
-
-    signed char cx = ix;
+  while ((n < size) && (ptr < end)) {
+    signed char cx = static_cast<signed char>(*(ptr++)); // get index byte
     if (cx == -128)
       cx = 0;
 
     if (cx < 0) {                //.............run
-      int i = 1 - cx;
-      unsigned short ch = in->ReadInt16();
-      while (i--) {
-        // test for buffer overflow
-        if (n >= size)
-          return -1;
-
-        line[n++] = ch;
+      if (static_cast<size_t>(end - ptr) < sizeof(T))
+        break;
+      T ch;
+      CopyPixelsLE(&ch, ptr, 1);
+      ptr += sizeof(T);
+      size_t count = 1 - cx;
+      // test for buffer overflow
+      if (count > size - n) {
+        count = size - n;
+        result = -1;
       }
+      std::fill_n(line + n, count, ch);
+      n += count;
     } else {                     //.....................seq
-      int i = cx + 1;
-      while (i--) {
-        // test for buffer overflow
-        if (n >= size)
-          return -1;
-
-        line[n++] = in->ReadInt16();
+      size_t count = cx + 1;
+      // test for buffer overflow
+      if (count > size - n) {
+        count = size - n;
+        result = -1;
       }
+      count = std::min(count, static_cast<size_t>(end - ptr) / sizeof(T));
+      CopyPixelsLE(line + n, ptr, count);
+      ptr += count * sizeof(T);
+      n += count;
     }
+
+    if (result < 0)
+      break;
   }
 
-  return 0;
+  src_used = ptr - src;
+  return result;
 }
 
-static int cunpackbitl32(uint32_t *line, size_t size, Stream *in)
+static int cunpackbitl(uint8_t *line, size_t size, Stream *in)
 {
+  // Unpack right from the stream's memory, if it's available
+  const uint8_t *mem_buf = in->GetMemoryBuffer();
+  const soff_t pos = in->GetPosition();
+  if (mem_buf && (pos >= 0) && (pos <= in->GetLength())) {
+    size_t src_used;
+    int result = cunpackbitl_mem(line, size, mem_buf + pos,
+      static_cast<size_t>(in->GetLength() - pos), src_used);
+    in->Seek(src_used, kSeekCurrent);
+    return result;
+  }
+
   size_t n = 0;                  // number of bytes decoded
 
   while (n < size) {
@@ -226,24 +248,24 @@ static int cunpackbitl32(uint32_t *line, size_t size, Stream *in)
       cx = 0;
 
     if (cx < 0) {                //.............run
-      int i = 1 - cx;
-      unsigned int ch = in->ReadInt32();
-      while (i--) {
-        // test for buffer overflow
-        if (n >= size)
-          return -1;
-
-        line[n++] = ch;
+      size_t count = 1 - cx;
+      char ch = in->ReadInt8();
+      // test for buffer overflow
+      if (count > size - n) {
+        memset(line + n, ch, size - n);
+        return -1;
       }
+      memset(line + n, ch, count);
+      n += count;
     } else {                     //.....................seq
-      int i = cx + 1;
-      while (i--) {
-        // test for buffer overflow
-        if (n >= size)
-          return -1;
-
-        line[n++] = (unsigned int)in->ReadInt32();
+      size_t count = cx + 1;
+      // test for buffer overflow
+      if (count > size - n) {
+        in->Read(line + n, size - n);
+        return -1;
       }
+      in->Read(line + n, count);
+      n += count;
     }
   }
 
@@ -262,13 +284,23 @@ bool rle_compress(const uint8_t *data, size_t data_sz, int image_bpp, Stream *ou
     return true;
 }
 
-bool rle_decompress(uint8_t *data, size_t data_sz, int image_bpp, Stream *in)
+bool rle_decompress(uint8_t *data, size_t data_sz, int image_bpp, Stream *in, size_t in_sz)
 {
+    std::vector<uint8_t> in_buf;
+    const uint8_t *in_data = GetInPlaceData(in, in_sz);
+    if (!in_data)
+    {
+        in_buf.resize(in_sz);
+        in_sz = in->Read(in_buf.data(), in_sz);
+        in_data = in_buf.data();
+    }
+    // NOTE: the overflowing data is tolerated, for the sake of the old games
+    size_t in_used;
     switch (image_bpp)
     {
-    case 1: cunpackbitl(data, data_sz, in); break;
-    case 2: cunpackbitl16(reinterpret_cast<uint16_t*>(data), data_sz / sizeof(uint16_t), in); break;
-    case 4: cunpackbitl32(reinterpret_cast<uint32_t*>(data), data_sz / sizeof(uint32_t), in); break;
+    case 1: cunpackbitl_mem(data, data_sz, in_data, in_sz, in_used); break;
+    case 2: cunpackbitl_mem(reinterpret_cast<uint16_t*>(data), data_sz / sizeof(uint16_t), in_data, in_sz, in_used); break;
+    case 4: cunpackbitl_mem(reinterpret_cast<uint32_t*>(data), data_sz / sizeof(uint32_t), in_data, in_sz, in_used); break;
     default: assert(0); break;
     }
     return true;
@@ -357,6 +389,9 @@ bool lzw_decompress(uint8_t *data, size_t data_sz, int /*image_bpp*/, Stream *in
         in->Read(data, data_sz);
         return true;
     }
+    const uint8_t *in_data = GetInPlaceData(in, in_sz);
+    if (in_data)
+        return lzwexpand(in_data, in_sz, data, data_sz);
     std::vector<uint8_t> in_buf(in_sz);
     in->Read(in_buf.data(), in_sz);
     return lzwexpand(in_buf.data(), in_sz, data, data_sz);
@@ -403,22 +438,27 @@ void save_lzw(Stream *out, const Bitmap *bmpp, const RGB (*pal)[256])
   out->Seek(toret, kSeekBegin);
 }
 
-std::unique_ptr<Bitmap> load_lzw(Stream *in, int dst_bpp, RGB (*pal)[256])
+void read_lzw_data(Stream *in, RGB (*pal)[256], std::vector<uint8_t> &data, size_t &uncomp_sz)
 {
   // NOTE: old format saves full RGB struct here (4 bytes, including the filler)
   if (pal)
     in->Read(*pal, sizeof(RGB) * 256);
   else
     in->Seek(sizeof(RGB) * 256);
-  const size_t uncomp_sz = in->ReadInt32();
+  uncomp_sz = in->ReadInt32();
   const size_t comp_sz = in->ReadInt32();
   const soff_t end_pos = in->GetPosition() + comp_sz;
+  data.resize(comp_sz);
+  in->Read(data.data(), comp_sz);
+  if (in->GetPosition() != end_pos)
+    in->Seek(end_pos, kSeekBegin);
+}
 
+std::unique_ptr<Bitmap> decode_lzw(const uint8_t *data, size_t data_sz, size_t uncomp_sz, int dst_bpp)
+{
   // First decompress data into the memory buffer
-  std::vector<uint8_t> inbuf(comp_sz);
   std::vector<uint8_t> membuf(uncomp_sz);
-  in->Read(inbuf.data(), comp_sz);
-  lzwexpand(inbuf.data(), comp_sz, membuf.data(), uncomp_sz);
+  lzwexpand(data, data_sz, membuf.data(), uncomp_sz);
 
   // Open same buffer for reading and get params and pixels
   Stream mem_in(std::make_unique<VectorStream>(membuf));
@@ -436,13 +476,17 @@ std::unique_ptr<Bitmap> load_lzw(Stream *in, int dst_bpp, RGB (*pal)[256])
   case 4: mem_in.ReadArrayOfInt32(reinterpret_cast<int32_t*>(bmp_data), num_pixels); break;
   default: assert(0); break;
   }
-
-  if (in->GetPosition() != end_pos)
-    in->Seek(end_pos, kSeekBegin);
-
   return bmm;
 }
 
+std::unique_ptr<Bitmap> load_lzw(Stream *in, int dst_bpp, RGB (*pal)[256])
+{
+  std::vector<uint8_t> data;
+  size_t uncomp_sz;
+  read_lzw_data(in, pal, data, uncomp_sz);
+  return decode_lzw(data.data(), data.size(), uncomp_sz, dst_bpp);
+}
+
 //-----------------------------------------------------------------------------
 // Deflate
 //-----------------------------------------------------------------------------
@@ -521,7 +565,30 @@ bool deflate_compress(const uint8_t* data, size_t data_sz, int /*image_bpp*/, St
 
 bool inflate_decompress(uint8_t* data, size_t data_sz, int /*image_bpp*/, Stream* in, size_t in_sz)
 {
+    const uint8_t *in_data = GetInPlaceData(in, in_sz);
+    if (in_data)
+        return z_inflate(in_data, in_sz, data, data_sz);
     std::vector<uint8_t> in_buf(in_sz);
     in->Read(in_buf.data(), in_sz);
     return z_inflate(in_buf.data(), in_sz, data, data_sz);
 }
+
+
+//-----------------------------------------------------------------------------
+// LZ4
+//-----------------------------------------------------------------------------
+
+bool lz4_compress(const uint8_t *data, size_t data_sz, int /*image_bpp*/, Stream *out)
+{
+    return lz4compress(data, data_sz, out);
+}
+
+bool lz4_decompress(uint8_t *data, size_t data_sz, int /*image_bpp*/, Stream *in, size_t in_sz)
+{
+    const uint8_t *in_data = GetInPlaceData(in, in_sz);
+    if (in_data)
+        return lz4expand(in_data, in_sz, data, data_sz);
+    std::vector<uint8_t> in_buf(in_sz);
+    in->Read(in_buf.data(), in_sz);
+    return lz4expand(in_buf.data(), in_sz, data, data_sz);
+}
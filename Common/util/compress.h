@@ -25,7 +25,7 @@ using namespace AGS; // FIXME later
 
 // RLE compression
 bool rle_compress(const uint8_t *data, size_t data_sz, int image_bpp, Common::Stream *out);
-bool rle_decompress(uint8_t *data, size_t data_sz, int image_bpp, Common::Stream *in);
+bool rle_decompress(uint8_t *data, size_t data_sz, int image_bpp, Common::Stream *in, size_t in_sz);
 // Packs a 8-bit bitmap using RLE compression, and writes into stream along with the palette
 void save_rle_bitmap8(Common::Stream *out, const Common::Bitmap *bmp, const RGB (*pal)[256] = nullptr);
 // Reads a 8-bit bitmap with palette from the stream and unpacks from RLE
@@ -40,9 +40,18 @@ bool lzw_decompress(uint8_t *data, size_t data_sz, int image_bpp, Common::Stream
 void save_lzw(Common::Stream *out, const Common::Bitmap *bmpp, const RGB (*pal)[256] = nullptr);
 // Loads bitmap decompressing
 std::unique_ptr<Common::Bitmap> load_lzw(Common::Stream *in, int dst_bpp, RGB (*pal)[256] = nullptr);
+// Reads the bitmap saved by save_lzw, with an optional palette, but keeps its data compressed;
+// the data may be decompressed later with decode_lzw
+void read_lzw_data(Common::Stream *in, RGB (*pal)[256], std::vector<uint8_t> &data, size_t &uncomp_sz);
+// Decompresses the bitmap data read by read_lzw_data
+std::unique_ptr<Common::Bitmap> decode_lzw(const uint8_t *data, size_t data_sz, size_t uncomp_sz, int dst_bpp);
 
 // Deflate compression
 bool deflate_compress(const uint8_t* data, size_t data_sz, int image_bpp, Common::Stream* out);
 bool inflate_decompress(uint8_t* data, size_t data_sz, int image_bpp, Common::Stream* in, size_t in_sz);
 
+// LZ4 compression
+bool lz4_compress(const uint8_t *data, size_t data_sz, int image_bpp, Common::Stream *out);
+bool lz4_decompress(uint8_t *data, size_t data_sz, int image_bpp, Common::Stream *in, size_t in_sz);
+
 #endif // __AC_COMPRESS_H
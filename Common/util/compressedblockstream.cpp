@@ -0,0 +1,221 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "util/compressedblockstream.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string.h>
+#include "util/lz4.h"
+#include "util/memory_compat.h"
+#include "util/memorystream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+CompressedBlockStream::CompressedBlockStream(std::unique_ptr<Stream> &&base)
+    : StreamBase(base ? base->GetPath() : "")
+{
+    if (!base || !base->CanRead() || !base->CanSeek())
+        throw std::runtime_error("Base stream invalid.");
+    const soff_t header_pos = base->GetPosition();
+    _length = base->ReadInt64();
+    _blockSize = static_cast<uint32_t>(base->ReadInt32());
+    const size_t block_count = static_cast<uint32_t>(base->ReadInt32());
+    if (_length < 0 || _blockSize == 0 ||
+        block_count != static_cast<size_t>((_length + _blockSize - 1) / _blockSize))
+        throw std::runtime_error("Invalid compressed data header.");
+    // Test that the offsets table fits before allocating it
+    _dataStart = header_pos + 16 + (block_count + 1) * sizeof(int64_t);
+    if (base->GetLength() < _dataStart)
+        throw std::runtime_error("Compressed data is truncated.");
+    _blockOffsets.resize(block_count + 1);
+    for (auto &off : _blockOffsets)
+        off = base->ReadInt64();
+    for (size_t i = 0; i < block_count; ++i)
+    {
+        if (_blockOffsets[i] < 0 || _blockOffsets[i] > _blockOffsets[i + 1])
+            throw std::runtime_error("Invalid compressed block offsets.");
+    }
+    if (_blockOffsets.back() > base->GetLength() - _dataStart)
+        throw std::runtime_error("Compressed data is truncated.");
+    _base = std::move(base);
+}
+
+std::unique_ptr<Stream> CompressedBlockStream::Open(std::unique_ptr<Stream> &&base)
+{
+    std::unique_ptr<CompressedBlockStream> cs;
+    try
+    {
+        cs.reset(new CompressedBlockStream(std::move(base)));
+    }
+    catch (const std::runtime_error&)
+    {
+        return nullptr;
+    }
+    return std::make_unique<Stream>(std::move(cs));
+}
+
+soff_t CompressedBlockStream::Compress(Stream *in, soff_t in_size, Stream *out, size_t block_size)
+{
+    if (in_size < 0 || block_size == 0 || block_size > UINT32_MAX)
+        return -1;
+    const size_t block_count = static_cast<size_t>((in_size + block_size - 1) / block_size);
+    if (block_count > UINT32_MAX)
+        return -1;
+    const soff_t start_pos = out->GetPosition();
+    out->WriteInt64(in_size);
+    out->WriteInt32(static_cast<uint32_t>(block_size));
+    out->WriteInt32(static_cast<uint32_t>(block_count));
+    // Reserve the offsets table, and fill it after the blocks are written
+    const soff_t table_pos = out->GetPosition();
+    for (size_t i = 0; i <= block_count; ++i)
+        out->WriteInt64(0);
+    const soff_t data_pos = out->GetPosition();
+
+    std::vector<soff_t> offsets;
+    offsets.reserve(block_count + 1);
+    std::vector<uint8_t> raw(std::min<soff_t>(block_size, in_size));
+    std::vector<uint8_t> packed;
+    for (size_t i = 0; i < block_count; ++i)
+    {
+        const size_t raw_size = static_cast<size_t>(
+            std::min<soff_t>(block_size, in_size - static_cast<soff_t>(i * block_size)));
+        if (in->Read(raw.data(), raw_size) != raw_size)
+            return -1;
+        offsets.push_back(out->GetPosition() - data_pos);
+        packed.clear();
+        {
+            Stream packed_out(std::make_unique<VectorStream>(packed, kStream_Write));
+            if (!lz4compress(raw.data(), raw_size, &packed_out))
+                return -1;
+        }
+        // Store the block raw if it did not compress
+        if (packed.size() < raw_size)
+            out->Write(packed.data(), packed.size());
+        else
+            out->Write(raw.data(), raw_size);
+    }
+    offsets.push_back(out->GetPosition() - data_pos);
+
+    const soff_t end_pos = out->GetPosition();
+    out->Seek(table_pos, kSeekBegin);
+    for (const auto off : offsets)
+        out->WriteInt64(off);
+    out->Seek(end_pos, kSeekBegin);
+    return end_pos - start_pos;
+}
+
+StreamMode CompressedBlockStream::GetMode() const
+{
+    return _base ? static_cast<StreamMode>(kStream_Read | kStream_Seek) : kStream_None;
+}
+
+size_t CompressedBlockStream::Read(void *buffer, size_t len)
+{
+    uint8_t *dst = static_cast<uint8_t*>(buffer);
+    size_t total = 0;
+    while ((total < len) && (_position < _length) && LoadBlock())
+    {
+        const size_t block_off = static_cast<size_t>(_position - static_cast<soff_t>(_blockIndex * _blockSize));
+        const size_t chunk = std::min(len - total, _block.size() - block_off);
+        memcpy(dst + total, _block.data() + block_off, chunk);
+        total += chunk;
+        _position += chunk;
+    }
+    return total;
+}
+
+int32_t CompressedBlockStream::ReadByte()
+{
+    uint8_t b;
+    return (Read(&b, 1) == 1) ? b : -1;
+}
+
+soff_t CompressedBlockStream::Seek(soff_t offset, StreamSeek origin)
+{
+    soff_t want_pos = -1;
+    switch (origin)
+    {
+    case kSeekBegin:    want_pos = 0 + offset; break;
+    case kSeekCurrent:  want_pos = _position + offset; break;
+    case kSeekEnd:      want_pos = _length + offset; break;
+    default: return -1;
+    }
+    // the block is only loaded when reading
+    _position = std::min(std::max<soff_t>(0, want_pos), _length);
+    return _position;
+}
+
+void CompressedBlockStream::Close()
+{
+    _base.reset();
+    _blockOffsets.clear();
+    _block.clear();
+    _packed.clear();
+    _blockIndex = SIZE_MAX;
+    _length = 0;
+    _position = 0;
+}
+
+bool CompressedBlockStream::LoadBlock()
+{
+    const size_t index = static_cast<size_t>(_position / _blockSize);
+    if (index == _blockIndex)
+        return true;
+    _blockIndex = SIZE_MAX;
+    const size_t raw_size = static_cast<size_t>(
+        std::min<soff_t>(_blockSize, _length - static_cast<soff_t>(index * _blockSize)));
+    const soff_t packed_pos = _dataStart + _blockOffsets[index];
+    const size_t packed_size = static_cast<size_t>(_blockOffsets[index + 1] - _blockOffsets[index]);
+    if (packed_size == 0 || packed_size > raw_size)
+        return false; // malformed block
+
+    _block.resize(raw_size);
+    // Use the base stream's data in place, if it's available in memory
+    const uint8_t *packed = _base->GetMemoryBuffer();
+    if (packed)
+    {
+        packed += packed_pos;
+    }
+    else
+    {
+        if (_base->Seek(packed_pos, kSeekBegin) != packed_pos)
+            return false;
+        uint8_t *dst = _block.data();
+        if (packed_size < raw_size)
+        {
+            _packed.resize(packed_size);
+            dst = _packed.data();
+        }
+        if (_base->Read(dst, packed_size) != packed_size)
+            return false;
+        packed = dst;
+    }
+
+    if (packed_size == raw_size)
+    {
+        if (packed != _block.data())
+            memcpy(_block.data(), packed, raw_size);
+    }
+    else if (!lz4expand(packed, packed_size, _block.data(), raw_size))
+    {
+        return false;
+    }
+    _blockIndex = index;
+    return true;
+}
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,95 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// CompressedBlockStream is a read-only seekable stream over the data
+// compressed in independent blocks. Seeking only has to decompress the
+// one block containing the new position, so the stream suits the consumers
+// which read the data out of order (e.g. the audio decoders).
+//
+// The compressed data begins with a header:
+//   int64          - uncompressed size
+//   uint32         - uncompressed block size (except the last block)
+//   uint32         - number of blocks (N)
+//   int64[N + 1]   - offsets of the blocks, relative to the end of header;
+//                    the last one tells the total size of the blocks
+// which is followed by the blocks in LZ4 block format. The blocks which
+// could not be compressed are stored raw, and are told apart by their
+// stored size being equal to the uncompressed one.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__COMPRESSEDBLOCKSTREAM_H
+#define __AGS_CN_UTIL__COMPRESSEDBLOCKSTREAM_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "util/stream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class CompressedBlockStream : public StreamBase
+{
+public:
+    // Default uncompressed size of a block
+    static const size_t DefaultBlockSize = 64 * 1024;
+
+    // Opens the compressed data, starting at the base stream's current
+    // position, and reads its header. The constructor may raise
+    // std::runtime_error if the header is malformed.
+    CompressedBlockStream(std::unique_ptr<Stream> &&base);
+    ~CompressedBlockStream() override = default;
+
+    // Opens the compressed data from the base stream; returns null on failure
+    static std::unique_ptr<Stream> Open(std::unique_ptr<Stream> &&base);
+    // Compresses in_size bytes read from the input stream, and writes them
+    // along with the header to the output stream; returns the number of
+    // bytes written, or -1 on failure
+    static soff_t Compress(Stream *in, soff_t in_size, Stream *out, size_t block_size = DefaultBlockSize);
+
+    StreamMode GetMode() const override;
+    bool    EOS() const override { return _position >= _length; }
+    soff_t  GetLength() const override { return _length; }
+    soff_t  GetPosition() const override { return _position; }
+
+    size_t  Read(void *buffer, size_t len) override;
+    int32_t ReadByte() override;
+    size_t  Write(const void * /*buffer*/, size_t /*len*/) override { return 0; }
+    int32_t WriteByte(uint8_t /*b*/) override { return -1; }
+    soff_t  Seek(soff_t offset, StreamSeek origin = kSeekCurrent) override;
+    bool    Flush() override { return false; }
+    void    Close() override;
+
+private:
+    // Makes sure that the block containing the current position is loaded
+    bool    LoadBlock();
+
+    std::unique_ptr<Stream> _base;
+    soff_t  _dataStart = 0; // position of the first block in the base stream
+    soff_t  _length = 0;
+    soff_t  _position = 0;
+    size_t  _blockSize = 0;
+    std::vector<soff_t> _blockOffsets;
+    // Currently loaded block
+    size_t  _blockIndex = SIZE_MAX;
+    std::vector<uint8_t> _block;
+    std::vector<uint8_t> _packed; // temporary buffer for a compressed block
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__COMPRESSEDBLOCKSTREAM_H
@@ -0,0 +1,64 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "core/platform.h"
+#if AGS_PLATFORM_OS_EMSCRIPTEN
+#include "util/emscripten_file.h"
+#include <emscripten.h>
+
+// The remote files are handled by the functions of Module, which are
+// defined in Emscripten/asset_streaming.js; if the launcher does not
+// include these, then there are no remote files.
+EM_JS(double, ags_remote_file_size, (const char *filename), {
+    if (typeof Module['agsRemoteFileSize'] !== 'function')
+        return -1;
+    return Module['agsRemoteFileSize'](UTF8ToString(filename));
+});
+
+// Suspends the program until the block is fetched, which requires ASYNCIFY
+EM_ASYNC_JS(int, ags_read_remote_block, (const char *filename, int block_index, int block_size, uint8_t *buf), {
+    try {
+        const data = await Module['agsReadRemoteBlock'](UTF8ToString(filename), block_index, block_size);
+        HEAPU8.set(data, buf);
+        return data.length;
+    } catch (e) {
+        console.error('ERROR: failed to read remote file ' + UTF8ToString(filename) + ': ' + e);
+        return -1;
+    }
+});
+
+namespace AGS
+{
+namespace Common
+{
+
+bool GetRemoteFileExists(const String &filename)
+{
+    return ags_remote_file_size(filename.GetCStr()) >= 0.0;
+}
+
+soff_t GetRemoteFileSize(const String &filename)
+{
+    return static_cast<soff_t>(ags_remote_file_size(filename.GetCStr()));
+}
+
+int ReadRemoteFileBlock(const String &filename, int block_index, uint8_t *buf)
+{
+    return ags_read_remote_block(filename.GetCStr(), block_index,
+        static_cast<int>(RemoteFileBlockSize), buf);
+}
+
+} // namespace Common
+} // namespace AGS
+
+#endif // AGS_PLATFORM_OS_EMSCRIPTEN
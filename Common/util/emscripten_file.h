@@ -0,0 +1,53 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+//  Emscripten-specific implementation of some of the File routines;
+//  gives access to the remote files, which the web launcher registers
+//  instead of loading them into the memory filesystem before the start.
+//  The remote files are read in blocks with the HTTP range requests,
+//  see Emscripten/asset_streaming.js.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__EMSCRIPTEN_FILE_H
+#define __AGS_CN_UTIL__EMSCRIPTEN_FILE_H
+
+#include "core/platform.h"
+#if AGS_PLATFORM_OS_EMSCRIPTEN
+#include "core/types.h"
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+// Size of the block in which the remote files are fetched and cached
+const size_t RemoteFileBlockSize = 256 * 1024;
+
+// Tells if the remote file of the given name is registered
+bool           GetRemoteFileExists(const String &filename);
+// Gets the remote file's size, returns -1 if such file is not registered
+soff_t         GetRemoteFileSize(const String &filename);
+// Reads the block of remote file into the buffer, which must have at least
+// RemoteFileBlockSize bytes; waits until the block is fetched.
+// Returns the number of bytes read, which is less than the block size only
+// for the last block of the file, or -1 on error.
+int            ReadRemoteFileBlock(const String &filename, int block_index, uint8_t *buf);
+
+} // namespace Common
+} // namespace AGS
+
+#endif // AGS_PLATFORM_OS_EMSCRIPTEN
+
+#endif // __AGS_CN_UTIL__EMSCRIPTEN_FILE_H
@@ -0,0 +1,136 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "core/platform.h"
+#if AGS_PLATFORM_OS_EMSCRIPTEN
+#include "util/fetch_stream.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "util/emscripten_file.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+FetchStream::FetchStream(const String &file_name)
+    : StreamBase(file_name)
+{
+    _length = GetRemoteFileSize(file_name);
+    if (_length < 0)
+        throw std::runtime_error("Error opening remote file.");
+    _mode = static_cast<StreamMode>(kStream_Read | kStream_Seek);
+}
+
+FetchStream::~FetchStream()
+{
+    Close();
+}
+
+bool FetchStream::GetError() const
+{
+    bool err = _error;
+    _error = false;
+    return err;
+}
+
+bool FetchStream::LoadBlock()
+{
+    const int block_index = static_cast<int>(_pos / RemoteFileBlockSize);
+    if (block_index == _blockIndex)
+        return true;
+    _block.resize(RemoteFileBlockSize);
+    const int read_size = ReadRemoteFileBlock(_path, block_index, _block.data());
+    if (read_size < 0)
+    {
+        _blockIndex = -1;
+        _error = true;
+        return false;
+    }
+    _blockIndex = block_index;
+    _blockLength = static_cast<size_t>(read_size);
+    return true;
+}
+
+size_t FetchStream::Read(void *buffer, size_t size)
+{
+    uint8_t *dst = static_cast<uint8_t*>(buffer);
+    size_t total = 0u;
+    while ((total < size) && (_pos < _length))
+    {
+        if (!LoadBlock())
+            break;
+        const size_t block_off = static_cast<size_t>(_pos - static_cast<soff_t>(_blockIndex) * RemoteFileBlockSize);
+        if (block_off >= _blockLength)
+            break; // the file is shorter than it was registered
+        const size_t chunk = std::min(size - total, _blockLength - block_off);
+        memcpy(dst + total, _block.data() + block_off, chunk);
+        total += chunk;
+        _pos += chunk;
+    }
+    return total;
+}
+
+int32_t FetchStream::ReadByte()
+{
+    uint8_t ch;
+    auto read_size = Read(&ch, 1);
+    return (read_size == 1) ? ch : EOF;
+}
+
+size_t FetchStream::Write(const void * /*buffer*/, size_t /*size*/)
+{
+    return 0;
+}
+
+int32_t FetchStream::WriteByte(uint8_t /*b*/)
+{
+    return -1;
+}
+
+soff_t FetchStream::Seek(soff_t offset, StreamSeek origin)
+{
+    soff_t pos;
+    switch (origin)
+    {
+    case kSeekBegin:    pos = offset; break;
+    case kSeekCurrent:  pos = _pos + offset; break;
+    case kSeekEnd:      pos = _length + offset; break;
+    default: return -1;
+    }
+    if (pos < 0 || pos > _length)
+        return -1;
+    _pos = pos;
+    return _pos;
+}
+
+bool FetchStream::Flush()
+{
+    return false;
+}
+
+void FetchStream::Close()
+{
+    _block.clear();
+    _block.shrink_to_fit();
+    _blockIndex = -1;
+    _blockLength = 0u;
+    _mode = kStream_None;
+}
+
+} // namespace Common
+} // namespace AGS
+
+#endif // AGS_PLATFORM_OS_EMSCRIPTEN
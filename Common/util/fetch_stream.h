@@ -0,0 +1,77 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// FetchStream is a read-only stream over the remote file on the web port,
+// see util/emscripten_file.h. The file is read in blocks, which are fetched
+// on demand; the stream keeps the last read block, while the rest of caching
+// is done by the web side.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__FETCHSTREAM_H
+#define __AGS_CN_UTIL__FETCHSTREAM_H
+
+#include "core/platform.h"
+
+#if AGS_PLATFORM_OS_EMSCRIPTEN
+#include <vector>
+#include "util/stream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class FetchStream : public StreamBase
+{
+public:
+    // Opens the remote file for reading;
+    // the constructor may raise std::runtime_error if there's no such file
+    FetchStream(const String &file_name);
+    ~FetchStream() override;
+
+    StreamMode GetMode() const override { return _mode; }
+    bool    GetError() const override;
+    bool    EOS() const override { return _pos >= _length; }
+    soff_t  GetLength() const override { return _length; }
+    soff_t  GetPosition() const override { return _pos; }
+
+    size_t  Read(void *buffer, size_t size) override;
+    int32_t ReadByte() override;
+    size_t  Write(const void *buffer, size_t size) override;
+    int32_t WriteByte(uint8_t b) override;
+
+    soff_t  Seek(soff_t offset, StreamSeek origin) override;
+
+    bool    Flush() override;
+    void    Close() override;
+
+private:
+    // Makes sure that the block containing the current position is loaded
+    bool    LoadBlock();
+
+    StreamMode _mode = kStream_None;
+    soff_t  _length = 0;
+    soff_t  _pos = 0;
+    std::vector<uint8_t> _block;
+    int     _blockIndex = -1; // index of the loaded block, -1 if none
+    size_t  _blockLength = 0u; // valid data in the loaded block
+    mutable bool _error = false;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // AGS_PLATFORM_OS_EMSCRIPTEN
+
+#endif // __AGS_CN_UTIL__FETCHSTREAM_H
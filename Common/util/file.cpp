@@ -27,6 +27,10 @@
 #include "util/aasset_stream.h"
 #include "util/android_file.h"
 #endif
+#if AGS_PLATFORM_OS_EMSCRIPTEN
+#include "util/emscripten_file.h"
+#include "util/fetch_stream.h"
+#endif
 #include "util/memory_compat.h"
 
 namespace AGS
@@ -47,7 +51,10 @@ bool File::IsFile(const String &filename)
 #if AGS_PLATFORM_OS_ANDROID
     if (!res)
         res = GetAAssetExists(filename);
-#endif // AGS_PLATFORM_OS_ANDROID
+#elif AGS_PLATFORM_OS_EMSCRIPTEN
+    if (!res)
+        res = GetRemoteFileExists(filename);
+#endif
     return res;
 }
 
@@ -59,7 +66,10 @@ bool File::IsFileOrDir(const String &filename)
 #if AGS_PLATFORM_OS_ANDROID
     if (!res)
         res = GetAAssetExists(filename);
-#endif // AGS_PLATFORM_OS_ANDROID
+#elif AGS_PLATFORM_OS_EMSCRIPTEN
+    if (!res)
+        res = GetRemoteFileExists(filename);
+#endif
     return res;
 }
 
@@ -69,10 +79,18 @@ soff_t File::GetFileSize(const String &filename)
 #if AGS_PLATFORM_OS_ANDROID
     if (size < 0)
         size = GetAAssetSize(filename);
+#elif AGS_PLATFORM_OS_EMSCRIPTEN
+    if (size < 0)
+        size = GetRemoteFileSize(filename);
 #endif
     return size;
 }
 
+int64_t File::GetFileTime(const String &filename)
+{
+    return ags_file_mtime(filename.GetCStr());
+}
+
 bool File::TestReadFile(const String &filename)
 {
     FILE *test_file = ags_fopen(filename.GetCStr(), "rb");
@@ -234,27 +252,40 @@ std::unique_ptr<IStreamBase> OpenFileStream(const String &filename, FileOpenMode
         {
             fs = nullptr;
         }
+#elif AGS_PLATFORM_OS_EMSCRIPTEN
+        // strictly for read-only streams: look into the remote files too
+        try
+        {
+            if ((work_mode & kStream_Write) == 0)
+                fs.reset(new FetchStream(filename));
+        }
+        catch (std::runtime_error)
+        {
+            fs = nullptr;
+        }
 #endif
     }
     return std::move(fs);
 }
 
-std::unique_ptr<Stream> File::OpenFile(const String &filename, FileOpenMode open_mode, StreamMode work_mode)
+std::unique_ptr<Stream> File::OpenFile(const String &filename, FileOpenMode open_mode, StreamMode work_mode,
+    size_t buffer_size)
 {
     auto fs = OpenFileStream(filename, open_mode, work_mode);
     if (!fs)
         return nullptr;
     // Create a BufferedStream instance, wrapping the selected device impl
-    return std::make_unique<Stream>(std::make_unique<BufferedStream>(std::move(fs)));
+    return std::make_unique<Stream>(std::make_unique<BufferedStream>(std::move(fs), buffer_size));
 }
 
-std::unique_ptr<Stream> File::OpenFile(const String &filename, soff_t start_off, soff_t end_off)
+std::unique_ptr<Stream> File::OpenFile(const String &filename, soff_t start_off, soff_t end_off,
+    size_t buffer_size)
 {
     auto fs = OpenFileStream(filename, kFile_Open, kStream_Read);
     if (!fs)
         return nullptr;
     // Create a BufferedStream instance, wrapping the selected device impl
-    return std::make_unique<Stream>(std::make_unique<BufferedStream>(std::move(fs), start_off, end_off));
+    return std::make_unique<Stream>(std::make_unique<BufferedStream>(std::move(fs), start_off, end_off, buffer_size));
 }
 
 std::unique_ptr<Stream> File::OpenStdin()
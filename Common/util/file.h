@@ -58,6 +58,9 @@ namespace File
     bool        IsFileOrDir(const String &filename);
     // Returns size of a file, or -1 if no such file found
     soff_t      GetFileSize(const String &filename);
+    // Returns last modification time of a file, in seconds since the epoch,
+    // or -1 if no such file found
+    int64_t     GetFileTime(const String &filename);
     // Tests if file could be opened for reading
     bool        TestReadFile(const String &filename);
     // Opens a file for writing or creates new one if it does not exist; deletes file if it was created during test
@@ -76,10 +79,13 @@ namespace File
     // Gets C-style file mode from FileOpenMode and FileWorkMode
     String      GetCMode(FileOpenMode open_mode, StreamMode work_mode);
 
-    // Opens file in the given mode
-    std::unique_ptr<Stream> OpenFile(const String &filename, FileOpenMode open_mode, StreamMode work_mode);
+    // Opens file in the given mode; optionally tells the initial size of
+    // the stream's buffer, 0 for default (see BufferedStream)
+    std::unique_ptr<Stream> OpenFile(const String &filename, FileOpenMode open_mode, StreamMode work_mode,
+        size_t buffer_size = 0u);
     // Opens file for reading restricted to the arbitrary offset range
-    std::unique_ptr<Stream> OpenFile(const String &filename, soff_t start_off, soff_t end_off);
+    std::unique_ptr<Stream> OpenFile(const String &filename, soff_t start_off, soff_t end_off,
+        size_t buffer_size = 0u);
     // Convenience helpers
     // Create a totally new file, overwrite existing one
     inline std::unique_ptr<Stream> CreateFile(const String &filename)
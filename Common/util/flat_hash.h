@@ -0,0 +1,297 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// FlatHashMap and FlatHashSet are unordered associative containers which
+// store their items in a single contiguous array, using open addressing
+// with linear probing. Each slot caches the hash of its key, which lets
+// skip most of the key comparisons, and rehash without calling the hasher.
+//
+// These containers provide a subset of std::unordered_map/set interface.
+// The differences are:
+// * any insertion and erasure may move other items within the table,
+//   which invalidates all the iterators and references to items;
+// * erase() does not return the next iterator;
+// * the keys are stored as non-const, but must not be modified.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__FLATHASH_H
+#define __AGS_CN_UTIL__FLATHASH_H
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace AGS
+{
+namespace Common
+{
+
+template <typename TKey, typename TValue, typename TKeyOf,
+          typename THash, typename TEqual>
+class FlatHashTable
+{
+    struct Slot
+    {
+        size_t Hash = 0u; // 0 means an empty slot
+        TValue Value = TValue();
+    };
+
+    template <typename TSlot, typename TItem>
+    class Iterator
+    {
+        friend class FlatHashTable;
+    public:
+        Iterator() = default;
+        Iterator(TSlot *slot, TSlot *end) : _slot(slot), _end(end) { SkipEmpty(); }
+        // Allow conversion from non-const to const iterator
+        template <typename TOtherSlot, typename TOtherItem>
+        Iterator(const Iterator<TOtherSlot, TOtherItem> &other) : _slot(other._slot), _end(other._end) {}
+
+        TItem &operator *() const { return _slot->Value; }
+        TItem *operator ->() const { return &_slot->Value; }
+        Iterator &operator ++() { ++_slot; SkipEmpty(); return *this; }
+        Iterator operator ++(int) { Iterator it = *this; ++(*this); return it; }
+        bool operator ==(const Iterator &other) const { return _slot == other._slot; }
+        bool operator !=(const Iterator &other) const { return _slot != other._slot; }
+
+    private:
+        template <typename, typename> friend class Iterator;
+
+        void SkipEmpty() { while (_slot != _end && _slot->Hash == 0u) ++_slot; }
+
+        TSlot *_slot = nullptr;
+        TSlot *_end = nullptr;
+    };
+
+public:
+    typedef TKey key_type;
+    typedef TValue value_type;
+    typedef Iterator<Slot, TValue> iterator;
+    typedef Iterator<const Slot, const TValue> const_iterator;
+
+    FlatHashTable() = default;
+
+    iterator begin() { return iterator(SlotsBegin(), SlotsEnd()); }
+    iterator end() { return iterator(SlotsEnd(), SlotsEnd()); }
+    const_iterator begin() const { return const_iterator(SlotsBegin(), SlotsEnd()); }
+    const_iterator end() const { return const_iterator(SlotsEnd(), SlotsEnd()); }
+
+    size_t size() const { return _count; }
+    bool empty() const { return _count == 0u; }
+
+    // Removes all items, but keeps the allocated table
+    void clear()
+    {
+        for (auto &slot : _slots)
+            slot = Slot();
+        _count = 0u;
+    }
+
+    // Makes sure that the table may store at least this number of items
+    // without reallocation
+    void reserve(size_t count)
+    {
+        const size_t capacity = CapacityFor(count);
+        if (capacity > _slots.size())
+            Rehash(capacity);
+    }
+
+    iterator find(const TKey &key)
+    {
+        const size_t index = FindIndex(key, MakeHash(key));
+        return index != NoIndex ? iterator(&_slots[index], SlotsEnd()) : end();
+    }
+
+    const_iterator find(const TKey &key) const
+    {
+        const size_t index = FindIndex(key, MakeHash(key));
+        return index != NoIndex ? const_iterator(&_slots[index], SlotsEnd()) : end();
+    }
+
+    size_t count(const TKey &key) const
+    {
+        return FindIndex(key, MakeHash(key)) != NoIndex ? 1u : 0u;
+    }
+
+    std::pair<iterator, bool> insert(const TValue &value)
+    {
+        const TKey &key = TKeyOf::Get(value);
+        const size_t hash = MakeHash(key);
+        size_t index = FindIndex(key, hash);
+        if (index != NoIndex)
+            return std::make_pair(iterator(&_slots[index], SlotsEnd()), false);
+        index = InsertNew(hash);
+        _slots[index].Value = value;
+        return std::make_pair(iterator(&_slots[index], SlotsEnd()), true);
+    }
+
+    void erase(const_iterator it)
+    {
+        if (it._slot == nullptr || it._slot == it._end)
+            return;
+        const size_t mask = _slots.size() - 1;
+        size_t hole = it._slot - SlotsBegin();
+        // Backward shift deletion: move the following items of the
+        // same probe sequence back, so that no gaps are left in it
+        for (size_t next = (hole + 1) & mask; _slots[next].Hash != 0u; next = (next + 1) & mask)
+        {
+            const size_t home = _slots[next].Hash & mask;
+            const bool can_move = (hole <= next) ?
+                (home <= hole || home > next) :
+                (home <= hole && home > next);
+            if (can_move)
+            {
+                _slots[hole] = std::move(_slots[next]);
+                hole = next;
+            }
+        }
+        _slots[hole] = Slot();
+        _count--;
+    }
+
+    size_t erase(const TKey &key)
+    {
+        const_iterator it = find(key);
+        if (it == end())
+            return 0u;
+        erase(it);
+        return 1u;
+    }
+
+protected:
+    // Finds the item, or adds a default one with the given key
+    TValue &FindOrInsert(const TKey &key, const TValue &def_value)
+    {
+        const size_t hash = MakeHash(key);
+        size_t index = FindIndex(key, hash);
+        if (index == NoIndex)
+        {
+            index = InsertNew(hash);
+            _slots[index].Value = def_value;
+        }
+        return _slots[index].Value;
+    }
+
+private:
+    static const size_t NoIndex = SIZE_MAX;
+    static const size_t MinCapacity = 8u;
+
+    Slot *SlotsBegin() { return _slots.empty() ? nullptr : &_slots.front(); }
+    Slot *SlotsEnd() { return SlotsBegin() + _slots.size(); }
+    const Slot *SlotsBegin() const { return _slots.empty() ? nullptr : &_slots.front(); }
+    const Slot *SlotsEnd() const { return SlotsBegin() + _slots.size(); }
+
+    static size_t MakeHash(const TKey &key)
+    {
+        const size_t hash = THash()(key);
+        return hash != 0u ? hash : 1u;
+    }
+
+    // Returns the power-of-two table size, which keeps the load under 3/4
+    static size_t CapacityFor(size_t count)
+    {
+        size_t capacity = MinCapacity;
+        while (capacity * 3 < count * 4)
+            capacity *= 2;
+        return capacity;
+    }
+
+    size_t FindIndex(const TKey &key, size_t hash) const
+    {
+        if (_count == 0u)
+            return NoIndex;
+        const size_t mask = _slots.size() - 1;
+        for (size_t index = hash & mask; _slots[index].Hash != 0u; index = (index + 1) & mask)
+        {
+            if (_slots[index].Hash == hash && TEqual()(TKeyOf::Get(_slots[index].Value), key))
+                return index;
+        }
+        return NoIndex;
+    }
+
+    // Reserves a free slot for the new item with the given hash
+    size_t InsertNew(size_t hash)
+    {
+        if (CapacityFor(_count + 1) > _slots.size())
+            Rehash(_slots.size() * 2 > MinCapacity ? _slots.size() * 2 : MinCapacity);
+        const size_t mask = _slots.size() - 1;
+        size_t index = hash & mask;
+        while (_slots[index].Hash != 0u)
+            index = (index + 1) & mask;
+        _slots[index].Hash = hash;
+        _count++;
+        return index;
+    }
+
+    void Rehash(size_t capacity)
+    {
+        std::vector<Slot> old_slots(capacity);
+        std::swap(_slots, old_slots);
+        const size_t mask = _slots.size() - 1;
+        for (auto &slot : old_slots)
+        {
+            if (slot.Hash == 0u)
+                continue;
+            size_t index = slot.Hash & mask;
+            while (_slots[index].Hash != 0u)
+                index = (index + 1) & mask;
+            _slots[index] = std::move(slot);
+        }
+    }
+
+    std::vector<Slot> _slots;
+    size_t _count = 0u;
+};
+
+
+// Key extractors for the map and set items
+template <typename TKey, typename TMapped>
+struct FlatHashMapKeyOf
+{
+    static const TKey &Get(const std::pair<TKey, TMapped> &value) { return value.first; }
+};
+
+template <typename TKey>
+struct FlatHashSetKeyOf
+{
+    static const TKey &Get(const TKey &value) { return value; }
+};
+
+
+template <typename TKey, typename TMapped,
+          typename THash = std::hash<TKey>, typename TEqual = std::equal_to<TKey>>
+class FlatHashMap : public FlatHashTable<TKey, std::pair<TKey, TMapped>,
+    FlatHashMapKeyOf<TKey, TMapped>, THash, TEqual>
+{
+public:
+    typedef TMapped mapped_type;
+
+    TMapped &operator [](const TKey &key)
+    {
+        return this->FindOrInsert(key, std::make_pair(key, TMapped())).second;
+    }
+};
+
+template <typename TKey,
+          typename THash = std::hash<TKey>, typename TEqual = std::equal_to<TKey>>
+class FlatHashSet : public FlatHashTable<TKey, TKey,
+    FlatHashSetKeyOf<TKey>, THash, TEqual>
+{
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__FLATHASH_H
@@ -0,0 +1,218 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "util/jobscheduler.h"
+#include <algorithm>
+#include "debug/eventtrace.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+// The scheduler and the index of the worker running on this thread, if any
+static thread_local const JobScheduler *tl_scheduler = nullptr;
+static thread_local size_t tl_worker = 0u;
+
+static std::unique_ptr<JobScheduler> global_scheduler;
+// The scheduler without workers, used when the shared one was not created
+static JobScheduler inline_scheduler(0u);
+
+JobScheduler::JobScheduler(size_t worker_count)
+{
+#if !defined(AGS_DISABLE_THREADS)
+    for (size_t i = 0; i < worker_count; ++i)
+        _workers.emplace_back(new Worker());
+    for (size_t i = 0; i < worker_count; ++i)
+        _workers[i]->Thread = std::thread(&JobScheduler::WorkerThread, this, i);
+#else
+    (void)worker_count;
+#endif
+}
+
+JobScheduler::~JobScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _quit = true;
+    }
+    _wakeCv.notify_all();
+    for (auto &w : _workers)
+        w->Thread.join();
+}
+
+JobHandle JobScheduler::Submit(const char *name, std::function<void()> job)
+{
+    JobHandle task(new JobTask(name, std::move(job)));
+    if (_workers.empty())
+    {
+        RunJob(*task);
+        return task;
+    }
+    // The worker keeps its own jobs, the rest are spread among all
+    const size_t index = (tl_scheduler == this) ?
+        tl_worker : (_nextWorker.fetch_add(1u, std::memory_order_relaxed) % _workers.size());
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        {
+            std::lock_guard<std::mutex> wlk(_workers[index]->Mutex);
+            _workers[index]->Jobs.push_back(task);
+        }
+        _queued++;
+    }
+    _wakeCv.notify_one();
+    _doneCv.notify_all(); // the waiting threads may run it too
+    return task;
+}
+
+void JobScheduler::Wait(const JobHandle &job)
+{
+    if (!job)
+        return;
+    const size_t own_index = (tl_scheduler == this) ? tl_worker : _workers.size();
+    while (!job->IsDone())
+    {
+        JobHandle other = TakeJob(own_index);
+        if (other)
+        {
+            RunJob(*other);
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(_mutex);
+        _doneCv.wait(lk, [this, &job]() { return job->IsDone() || (_queued > 0u); });
+    }
+}
+
+void JobScheduler::ParallelFor(const char *name, size_t job_count, const std::function<void(size_t)> &job,
+    size_t max_threads)
+{
+    if (job_count == 0u)
+        return;
+    std::atomic<size_t> next_job{0u};
+    const auto run_jobs = [&next_job, job_count, &job]()
+    {
+        for (size_t i = next_job++; i < job_count; i = next_job++)
+            job(i);
+    };
+    // Every thread takes the jobs one by one, until none left
+    std::vector<JobHandle> runners;
+    const size_t runner_count = std::max<size_t>(1u, std::min({ job_count, GetThreadCount(), max_threads })) - 1u;
+    for (size_t i = 0; i < runner_count; ++i)
+        runners.push_back(Submit(name, run_jobs));
+    {
+        AGS_TRACE_ZONE(name);
+        run_jobs();
+    }
+    for (const auto &r : runners)
+        Wait(r);
+}
+
+size_t JobScheduler::ResolveThreadCount(int count, size_t max_auto)
+{
+#if defined(AGS_DISABLE_THREADS)
+    (void)count; (void)max_auto;
+    return 1u;
+#else
+    if (count > 0)
+        return static_cast<size_t>(count);
+    return std::min<size_t>(max_auto, std::max(1u, std::thread::hardware_concurrency()));
+#endif
+}
+
+void JobScheduler::InitGlobal(size_t worker_count)
+{
+    global_scheduler.reset();
+    global_scheduler.reset(new JobScheduler(worker_count));
+}
+
+void JobScheduler::ShutdownGlobal()
+{
+    global_scheduler.reset();
+}
+
+JobScheduler &JobScheduler::Global()
+{
+    return global_scheduler ? *global_scheduler : inline_scheduler;
+}
+
+JobHandle JobScheduler::TakeJob(size_t worker_index)
+{
+    JobHandle job;
+    const size_t count = _workers.size();
+    if (worker_index < count)
+    {
+        // own jobs are taken from the back, the latest first
+        Worker &w = *_workers[worker_index];
+        std::lock_guard<std::mutex> lk(w.Mutex);
+        if (!w.Jobs.empty())
+        {
+            job = std::move(w.Jobs.back());
+            w.Jobs.pop_back();
+        }
+    }
+    for (size_t i = 1; !job && (i <= count); ++i)
+    {
+        // other workers' jobs are stolen from the front, the oldest first
+        Worker &w = *_workers[(worker_index + i) % count];
+        std::lock_guard<std::mutex> lk(w.Mutex);
+        if (!w.Jobs.empty())
+        {
+            job = std::move(w.Jobs.front());
+            w.Jobs.pop_front();
+        }
+    }
+    if (job)
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _queued--;
+    }
+    return job;
+}
+
+void JobScheduler::RunJob(JobTask &job)
+{
+    {
+        AGS_TRACE_ZONE(job._name);
+        job._fn();
+    }
+    job._fn = nullptr; // release whatever the job holds
+    {
+        // the waiting thread checks the job under the lock
+        std::lock_guard<std::mutex> lk(_mutex);
+        job._done.store(true, std::memory_order_release);
+    }
+    _doneCv.notify_all();
+}
+
+void JobScheduler::WorkerThread(size_t index)
+{
+    tl_scheduler = this;
+    tl_worker = index;
+    EventTrace::SetThreadName("Job worker");
+    for (;;)
+    {
+        JobHandle job = TakeJob(index);
+        if (job)
+        {
+            RunJob(*job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(_mutex);
+        _wakeCv.wait(lk, [this]() { return _quit || (_queued > 0u); });
+        if (_quit && (_queued == 0u))
+            return; // all the queued jobs are done before quitting
+    }
+}
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,135 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// JobScheduler runs the jobs on a fixed number of worker threads. Each worker
+// has its own queue: it takes the jobs from its back, and when it runs out
+// of them, steals the jobs from the front of the other workers' queues.
+// The jobs submitted by the other threads are spread among the workers.
+//
+// A thread waiting for a job keeps running the queued jobs meanwhile, so the
+// jobs may wait for the other jobs which they have submitted themselves.
+// The jobs should not block on anything else for long though, such as a slow
+// file read, as that takes a worker away from everyone.
+//
+// Each job is recorded as a zone of the event trace, under the name given
+// when it was submitted.
+//
+// The engine shares one scheduler among its subsystems, see Global().
+//
+// When the engine is built with AGS_DISABLE_THREADS, or when there are no
+// workers, no threads are created and each job runs right when submitted.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__JOBSCHEDULER_H
+#define __AGS_CN_UTIL__JOBSCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+// A submitted job, which may be waited for
+class JobTask
+{
+public:
+    // Tells if the job has completed
+    bool IsDone() const { return _done.load(std::memory_order_acquire); }
+
+private:
+    friend class JobScheduler;
+    JobTask(const char *name, std::function<void()> &&fn)
+        : _name(name), _fn(std::move(fn)) {}
+
+    const char *_name;
+    std::function<void()> _fn;
+    std::atomic<bool> _done{false};
+};
+
+typedef std::shared_ptr<JobTask> JobHandle;
+
+class JobScheduler
+{
+public:
+    // Creates the scheduler with the given number of worker threads
+    JobScheduler(size_t worker_count);
+    // Waits for all the queued jobs, and stops the workers
+    ~JobScheduler();
+
+    // Gets the total number of threads which run the jobs,
+    // including the one waiting for them
+    size_t GetThreadCount() const { return _workers.size() + 1; }
+
+    // Schedules the job; the name must be a static string
+    JobHandle Submit(const char *name, std::function<void()> job);
+    // Waits for the job to complete, running the other queued jobs meanwhile
+    void Wait(const JobHandle &job);
+    // Runs the job for each index in [0, job_count) range, on the calling
+    // thread and up to (max_threads - 1) workers, and returns when all
+    // of them are done
+    void ParallelFor(const char *name, size_t job_count, const std::function<void(size_t)> &job,
+        size_t max_threads = SIZE_MAX);
+
+    // Resolves the thread count requested by the user: 0 means choose
+    // automatically, using up to "max_auto" hardware threads
+    static size_t ResolveThreadCount(int count, size_t max_auto);
+
+    // Creates the scheduler shared by the engine
+    static void InitGlobal(size_t worker_count);
+    // Destroys the shared scheduler, waiting for its jobs
+    static void ShutdownGlobal();
+    // Gets the shared scheduler; if it was not created, returns
+    // the one running each job right away
+    static JobScheduler &Global();
+
+private:
+    struct Worker
+    {
+        std::mutex Mutex;
+        std::deque<JobHandle> Jobs;
+        std::thread Thread;
+    };
+
+    // Takes a job, preferring the given worker's queue; returns null if none
+    JobHandle TakeJob(size_t worker_index);
+    // Runs the job and notifies the waiting threads
+    void RunJob(JobTask &job);
+    void WorkerThread(size_t index);
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    // Guards the counter of the queued jobs, for the waiting threads
+    std::mutex _mutex;
+    // Wakes the idle workers
+    std::condition_variable _wakeCv;
+    // Wakes the threads waiting for a job
+    std::condition_variable _doneCv;
+    size_t _queued = 0u;
+    // Next worker to give the job submitted from outside
+    std::atomic<size_t> _nextWorker{0u};
+    bool _quit = false;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__JOBSCHEDULER_H
@@ -0,0 +1,192 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// LZ4 block compression.
+//
+// Each sequence starts with a token, which high 4 bits are the number of
+// literals and low 4 bits are the match length minus 4; value 15 in either
+// means that the length continues in the following bytes, each adding up
+// to 255. The token is followed by the literals, 16-bit little-endian match
+// offset and the rest of the match length. The last sequence has only
+// literals. The format requires that the last 5 bytes are always literals,
+// and that the last match starts at least 12 bytes before the end.
+//
+//=============================================================================
+#include "util/lz4.h"
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+using namespace AGS::Common;
+
+static const size_t MinMatch = 4;
+static const size_t LastLiterals = 5;
+static const size_t MatchSafeDistance = 12;
+static const size_t MaxOffset = 65535;
+static const size_t LengthMask = 15;
+static const int HashLog = 14;
+
+static inline uint32_t Read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t HashSequence(uint32_t seq)
+{
+    return (seq * 2654435761u) >> (32 - HashLog);
+}
+
+static void WriteLength(std::vector<uint8_t> &buf, size_t len)
+{
+    for (; len >= 255; len -= 255)
+        buf.push_back(255);
+    buf.push_back(static_cast<uint8_t>(len));
+}
+
+// Writes a sequence of literals followed by a match;
+// match_len 0 means the last sequence, which only has literals
+static void WriteSequence(std::vector<uint8_t> &buf, const uint8_t *lit, size_t lit_len,
+    size_t offset, size_t match_len)
+{
+    const size_t ml = match_len > 0 ? match_len - MinMatch : 0;
+    buf.push_back(static_cast<uint8_t>((std::min(lit_len, LengthMask) << 4) | std::min(ml, LengthMask)));
+    if (lit_len >= LengthMask)
+        WriteLength(buf, lit_len - LengthMask);
+    buf.insert(buf.end(), lit, lit + lit_len);
+    if (match_len == 0)
+        return;
+    buf.push_back(static_cast<uint8_t>(offset & 0xFF));
+    buf.push_back(static_cast<uint8_t>((offset >> 8) & 0xFF));
+    if (ml >= LengthMask)
+        WriteLength(buf, ml - LengthMask);
+}
+
+bool lz4compress(const uint8_t *src, size_t src_sz, Stream *out)
+{
+    std::vector<uint8_t> buf;
+    buf.reserve(src_sz + src_sz / 255 + 16);
+    const uint8_t *const src_end = src + src_sz;
+    const uint8_t *anchor = src; // start of the pending literals
+    if (src_sz > MatchSafeDistance)
+    {
+        // Positions of the last met 4-byte sequences, by their hash
+        std::vector<uint32_t> table(1 << HashLog, 0u);
+        const uint8_t *const match_limit = src_end - MatchSafeDistance;
+        const uint8_t *const copy_limit = src_end - LastLiterals;
+        const uint8_t *ip = src;
+        while (ip < match_limit)
+        {
+            const uint32_t seq = Read32(ip);
+            const uint32_t h = HashSequence(seq);
+            const uint8_t *ref = src + table[h];
+            table[h] = static_cast<uint32_t>(ip - src);
+            if ((ref >= ip) || (static_cast<size_t>(ip - ref) > MaxOffset) || (Read32(ref) != seq))
+            {
+                // skip faster through the data which does not compress
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+            // Extend the match backwards over the pending literals, and forwards
+            while ((ip > anchor) && (ref > src) && (ip[-1] == ref[-1]))
+            {
+                --ip;
+                --ref;
+            }
+            const uint8_t *mp = ip + MinMatch;
+            const uint8_t *mr = ref + MinMatch;
+            while ((mp < copy_limit) && (*mp == *mr))
+            {
+                ++mp;
+                ++mr;
+            }
+            WriteSequence(buf, anchor, ip - anchor, ip - ref, mp - ip);
+            ip = mp;
+            anchor = ip;
+        }
+    }
+    WriteSequence(buf, anchor, src_end - anchor, 0, 0);
+    out->Write(buf.data(), buf.size());
+    return true;
+}
+
+static inline bool ReadLength(const uint8_t *&ip, const uint8_t *src_end, size_t &len)
+{
+    uint8_t b;
+    do
+    {
+        if (ip == src_end)
+            return false;
+        b = *(ip++);
+        len += b;
+    }
+    while (b == 255);
+    return true;
+}
+
+bool lz4expand(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz)
+{
+    const uint8_t *ip = src;
+    const uint8_t *const src_end = src + src_sz;
+    uint8_t *op = dst;
+    uint8_t *const dst_end = dst + dst_sz;
+    while (ip < src_end)
+    {
+        const uint8_t token = *(ip++);
+        // Literals
+        size_t lit_len = token >> 4;
+        if ((lit_len == LengthMask) && !ReadLength(ip, src_end, lit_len))
+            return false;
+        if ((lit_len > static_cast<size_t>(src_end - ip)) || (lit_len > static_cast<size_t>(dst_end - op)))
+            return false;
+        memcpy(op, ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+        if (ip == src_end)
+            break; // last sequence
+        // Match
+        if (src_end - ip < 2)
+            return false;
+        const size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if ((offset == 0) || (offset > static_cast<size_t>(op - dst)))
+            return false;
+        size_t match_len = token & LengthMask;
+        if ((match_len == LengthMask) && !ReadLength(ip, src_end, match_len))
+            return false;
+        match_len += MinMatch;
+        if (match_len > static_cast<size_t>(dst_end - op))
+            return false;
+        const uint8_t *ref = op - offset;
+        if (offset >= match_len)
+        {
+            memcpy(op, ref, match_len);
+            op += match_len;
+        }
+        else
+        {
+            // Overlapping match repeats the pattern; the already copied part
+            // is a repetition too, so the chunk size may double on each step
+            uint8_t *const match_end = op + match_len;
+            while (op < match_end)
+            {
+                const size_t n = std::min<size_t>(op - ref, match_end - op);
+                memcpy(op, ref, n);
+                op += n;
+            }
+        }
+    }
+    return op == dst_end;
+}
@@ -0,0 +1,34 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// LZ4 (un)compression functions.
+//
+// Produces and reads the data in the standard LZ4 block format, which
+// trades some compression ratio for a very fast decompression:
+// the decoder only copies the literals and the earlier decoded bytes.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__LZ4_H
+#define __AGS_CN_UTIL__LZ4_H
+
+#include "core/types.h"
+#include "util/stream.h"
+
+// Compresses src data as a single LZ4 block, and writes it into out stream.
+bool lz4compress(const uint8_t *src, size_t src_sz, AGS::Common::Stream *out);
+// Expands LZ4-compressed block from src to dst. Fails if the block is
+// malformed, or if it does not decompress into exactly dst_sz bytes.
+bool lz4expand(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz);
+
+#endif // __AGS_CN_UTIL__LZ4_H
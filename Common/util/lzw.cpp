@@ -17,14 +17,12 @@
 //=============================================================================
 #include "util/lzw.h"
 #include <stdlib.h>
+#include <string.h>
 #include "util/bbop.h"
 #include "util/stream.h"
 
 using namespace AGS::Common;
 
-int insert(int, int);
-void _delete(int);
-
 #define N 4096
 #define F 16
 #define THRESHOLD 3
@@ -36,13 +34,19 @@ void _delete(int);
 #define root (node+1+N+N+N)
 #define NIL -1
 
-uint8_t *lzbuffer;
-int *node;
-int pos;
-size_t outbytes = 0;
+// The compression state, kept per call so that the sprites
+// may be compressed on several threads at once
+struct LzwState
+{
+  uint8_t *lzbuffer = nullptr;
+  int *node = nullptr;
+  int pos = 0;
+};
 
-int insert(int i, int run)
+static int insert(LzwState &st, int i, int run)
 {
+  const uint8_t *lzbuffer = st.lzbuffer;
+  int *node = st.node;
   int c, j, k, l, n, match;
   int *p;
 
@@ -57,7 +61,7 @@ int insert(int i, int run)
 
     if (n > match) {
       match = n;
-      pos = j;
+      st.pos = j;
     }
 
     if (c < 0) {
@@ -81,8 +85,9 @@ int insert(int i, int run)
   return match;
 }
 
-void _delete(int z)
+static void _delete(LzwState &st, int z)
 {
+  int *node = st.node;
   int j;
 
   if (dad[z] != NIL) {
@@ -118,12 +123,13 @@ bool lzwcompress(Stream *lzw_in, Stream *out)
   int ch, i, run, len, match, size, mask;
   uint8_t buf[17];
 
-  lzbuffer = (uint8_t *)malloc(N + F + (N + 1 + N + N + 256) * sizeof(int));       // 28.5 k !
+  LzwState st;
+  uint8_t *lzbuffer = st.lzbuffer = (uint8_t *)malloc(N + F + (N + 1 + N + N + 256) * sizeof(int));       // 28.5 k !
   if (lzbuffer == nullptr) {
     return false;
   }
 
-  node = (int *)(lzbuffer + N + F);
+  int *node = st.node = (int *)(lzbuffer + N + F);
   for (i = 0; i < 256; i++)
     root[i] = NIL;
 
@@ -144,14 +150,14 @@ bool lzwcompress(Stream *lzw_in, Stream *out)
   do {
     ch = lzw_in->ReadByte();
     if (i >= N - F) {
-      _delete(i + F - N);
+      _delete(st, i + F - N);
       lzbuffer[i + F] = lzbuffer[i + F - N] = static_cast<uint8_t>(ch);
     } else {
-      _delete(i + F);
+      _delete(st, i + F);
       lzbuffer[i + F] = static_cast<uint8_t>(ch);
     }
 
-    match = insert(i, run);
+    match = insert(st, i, run);
     if (ch == -1) {
       run--;
       len--;
@@ -161,7 +167,7 @@ bool lzwcompress(Stream *lzw_in, Stream *out)
       if (match >= THRESHOLD) {
         buf[0] |= mask;
         // possible fix: change int* to short* ??
-        *(short *)(buf + size) = static_cast<short>(((match - 3) << 12) | ((i - pos - 1) & (N - 1)));
+        *(short *)(buf + size) = static_cast<short>(((match - 3) << 12) | ((i - st.pos - 1) & (N - 1)));
         size += 2;
         len -= match;
       } else {
@@ -171,7 +177,6 @@ bool lzwcompress(Stream *lzw_in, Stream *out)
 
       if (!((mask += mask) & 0xFF)) {
         out->Write(buf, size);
-        outbytes += size;
         size = mask = 1;
         buf[0] = 0;
       }
@@ -181,7 +186,6 @@ bool lzwcompress(Stream *lzw_in, Stream *out)
 
   if (size > 1) {
     out->Write(buf, size);
-    outbytes += size;
   }
 
   free(lzbuffer);
@@ -190,48 +194,48 @@ bool lzwcompress(Stream *lzw_in, Stream *out)
 
 bool lzwexpand(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz)
 {
-  int bits, ch, i, j, len, mask;
   uint8_t *dst_ptr = dst;
   const uint8_t *src_ptr = src;
 
   if (dst_sz == 0)
     return false; // nowhere to expand to
 
-  lzbuffer = (uint8_t *)malloc(N);
-  if (lzbuffer == nullptr) {
-    return false; // not enough memory
-  }
-  i = N - F;
-
-  // Read from the src and expand, until either src or dst runs out of space
+  // The references are resolved right in the dst buffer, which holds all of
+  // the expanded data, so no separate sliding window is required
   while ((static_cast<size_t>(src_ptr - src) < src_sz) &&
          (static_cast<size_t>(dst_ptr - dst) < dst_sz)) {
-    bits = *(src_ptr++);
-    for (mask = 0x01; mask & 0xFF; mask <<= 1) {
+    int bits = *(src_ptr++);
+    for (int mask = 0x01; mask & 0xFF; mask <<= 1) {
       if (bits & mask) {
         if (static_cast<size_t>(src_ptr - src) > (src_sz - sizeof(int16_t)))
           break;
 
-        short jshort = 0;
-        jshort = BBOp::Int16FromLE(*(reinterpret_cast<const int16_t*>(src_ptr)));
+        const int j = BBOp::Int16FromLE(*(reinterpret_cast<const int16_t*>(src_ptr)));
         src_ptr += sizeof(int16_t);
-        j = jshort;
 
-        len = ((j >> 12) & 15) + 3;
-        j = (i - j - 1) & (N - 1);
+        size_t len = ((j >> 12) & 15) + 3;
+        const size_t dist = (j & (N - 1)) + 1;
 
         if (static_cast<size_t>(dst_ptr - dst) > (dst_sz - len))
           break; // not enough dest buffer
 
-        while (len--) {
-          *(dst_ptr++) = (lzbuffer[i] = lzbuffer[j]);
-          j = (j + 1) & (N - 1);
-          i = (i + 1) & (N - 1);
+        const size_t dst_done = dst_ptr - dst;
+        if (dist > dst_done) {
+          // a reference before the data start, only possible in broken data
+          for (; len > 0 && dist > static_cast<size_t>(dst_ptr - dst); --len)
+            *(dst_ptr++) = 0;
+        }
+        const uint8_t *ref = dst_ptr - dist;
+        if (dist >= len) {
+          memcpy(dst_ptr, ref, len);
+          dst_ptr += len;
+        } else {
+          // overlapping reference repeats the last dist bytes
+          for (; len > 0; --len)
+            *(dst_ptr++) = *(ref++);
         }
       } else {
-        ch = *(src_ptr++);
-        *(dst_ptr++) = (lzbuffer[i] = static_cast<uint8_t>(ch));
-        i = (i + 1) & (N - 1);
+        *(dst_ptr++) = *(src_ptr++);
       }
 
       if ((static_cast<size_t>(dst_ptr - dst) >= dst_sz) ||
@@ -241,6 +245,5 @@ bool lzwexpand(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz)
     } // end for mask
   }
 
-  free(lzbuffer);
   return (src_ptr - src) == src_sz;
 }
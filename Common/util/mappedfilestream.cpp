@@ -0,0 +1,199 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "util/mappedfilestream.h"
+#include <stdexcept>
+#include "core/platform.h"
+#if AGS_PLATFORM_OS_WINDOWS
+#include <io.h>
+#include "platform/windows/windows.h"
+#define AGS_MAPPED_FILES (1)
+#elif AGS_PLATFORM_OS_LINUX || AGS_PLATFORM_OS_MACOS || AGS_PLATFORM_OS_ANDROID \
+    || AGS_PLATFORM_OS_IOS || AGS_PLATFORM_OS_FREEBSD
+#include <sys/mman.h>
+#include <unistd.h>
+#define AGS_MAPPED_FILES (1)
+#else
+#define AGS_MAPPED_FILES (0)
+#endif
+#if AGS_PLATFORM_OS_ANDROID
+#include "util/android_file.h"
+#endif
+#include "util/file.h"
+#include "util/memory_compat.h"
+#include "util/stdio_compat.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+#if AGS_MAPPED_FILES
+// Returns the alignment required for the mapped view's file offset
+static soff_t GetMapAlignment()
+{
+#if AGS_PLATFORM_OS_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+#else
+    return sysconf(_SC_PAGESIZE);
+#endif
+}
+#endif
+
+MappedFileStream::MappedFileStream(const String &file_name, soff_t start_off, soff_t end_off)
+    : MemoryStream(nullptr, 0u)
+{
+#if AGS_MAPPED_FILES
+    if ((start_off < 0) || (end_off <= start_off) ||
+        (static_cast<uint64_t>(end_off - start_off) > SIZE_MAX))
+        throw std::runtime_error("Invalid file section");
+
+    FILE *file = ags_fopen(file_name.GetCStr(), "rb");
+#if AGS_PLATFORM_OS_ANDROID
+    // The uncompressed Android Assets are mapped directly from the package
+    if (!file)
+    {
+        MapAAsset(file_name, start_off, end_off);
+        return;
+    }
+#endif
+    if (!file)
+        throw std::runtime_error("Error opening file");
+    ags_fseek(file, 0, SEEK_END);
+    const soff_t file_size = ags_ftell(file);
+    if (end_off > file_size)
+    {
+        fclose(file);
+        throw std::runtime_error("File section is out of range");
+    }
+
+    const soff_t map_off = start_off - (start_off % GetMapAlignment());
+    const size_t map_size = static_cast<size_t>(end_off - map_off);
+    void *map_base = nullptr;
+#if AGS_PLATFORM_OS_WINDOWS
+    HANDLE file_handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file)));
+    HANDLE mapping = CreateFileMappingW(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping)
+    {
+        map_base = MapViewOfFile(mapping, FILE_MAP_READ,
+            static_cast<DWORD>(static_cast<uint64_t>(map_off) >> 32),
+            static_cast<DWORD>(map_off & 0xFFFFFFFF), map_size);
+        CloseHandle(mapping); // the mapped view keeps the mapping alive
+    }
+#else
+    map_base = mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fileno(file), map_off);
+    if (map_base == MAP_FAILED)
+        map_base = nullptr;
+#endif
+    // the mapped view stays valid after the file is closed
+    fclose(file);
+    if (!map_base)
+        throw std::runtime_error("Error mapping file");
+    SetMapping(file_name, map_base, map_size, start_off - map_off, end_off - start_off);
+#else
+    throw std::runtime_error("Memory mapped files are not supported");
+#endif
+}
+
+void MappedFileStream::SetMapping(const String &file_name, void *map_base, size_t map_size,
+    soff_t data_off, soff_t data_size)
+{
+    _mapBase = map_base;
+    _mapSize = map_size;
+    _cbuf = static_cast<const uint8_t*>(map_base) + data_off;
+    _buf_sz = static_cast<size_t>(data_size);
+    _len = _buf_sz;
+    _mode = static_cast<StreamMode>(kStream_Read | kStream_Seek);
+    _path = file_name;
+}
+
+#if AGS_PLATFORM_OS_ANDROID
+void MappedFileStream::MapAAsset(const String &file_name, soff_t start_off, soff_t end_off)
+{
+    soff_t asset_start = 0, asset_length = 0;
+    const int fd = OpenAAssetFileDescriptor(file_name, asset_start, asset_length);
+    if (fd < 0)
+        throw std::runtime_error("Error opening asset, or asset is compressed");
+    if (end_off > asset_length)
+    {
+        close(fd);
+        throw std::runtime_error("File section is out of range");
+    }
+
+    // The asset's data is at the arbitrary offset in the package
+    const soff_t pkg_off = asset_start + start_off;
+    const soff_t map_off = pkg_off - (pkg_off % GetMapAlignment());
+    const size_t map_size = static_cast<size_t>(asset_start + end_off - map_off);
+    void *map_base = mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, map_off);
+    close(fd); // the mapped view stays valid after the file is closed
+    if (map_base == MAP_FAILED)
+        throw std::runtime_error("Error mapping asset");
+    SetMapping(file_name, map_base, map_size, pkg_off - map_off, end_off - start_off);
+}
+#endif
+
+MappedFileStream::~MappedFileStream()
+{
+    Unmap();
+}
+
+std::unique_ptr<Stream> MappedFileStream::OpenFile(const String &file_name)
+{
+    const soff_t file_size = File::GetFileSize(file_name);
+    if (file_size <= 0)
+        return nullptr;
+    return OpenFile(file_name, 0, file_size);
+}
+
+std::unique_ptr<Stream> MappedFileStream::OpenFile(const String &file_name, soff_t start_off, soff_t end_off)
+{
+    std::unique_ptr<MappedFileStream> ms;
+    try
+    {
+        ms.reset(new MappedFileStream(file_name, start_off, end_off));
+    }
+    catch (const std::runtime_error&)
+    {
+        return nullptr;
+    }
+    return Stream::WrapMemory(std::move(ms));
+}
+
+bool MappedFileStream::IsSupported()
+{
+    return AGS_MAPPED_FILES != 0;
+}
+
+void MappedFileStream::Close()
+{
+    MemoryStream::Close();
+    Unmap();
+}
+
+void MappedFileStream::Unmap()
+{
+    if (!_mapBase)
+        return;
+#if AGS_PLATFORM_OS_WINDOWS
+    UnmapViewOfFile(_mapBase);
+#elif AGS_MAPPED_FILES
+    munmap(_mapBase, _mapSize);
+#endif
+    _mapBase = nullptr;
+    _mapSize = 0u;
+}
+
+} // namespace Common
+} // namespace AGS
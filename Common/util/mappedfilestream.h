@@ -0,0 +1,76 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// MappedFileStream is a read-only stream over the file (or its section)
+// mapped into memory. Reading from it does not require system calls,
+// and the stream's data may be accessed in place, see
+// Stream::GetMemoryBuffer().
+//
+// Memory mapping is supported on Windows and POSIX systems. On Android the
+// assets stored uncompressed in the package are mapped too, which lets read
+// the game data without copying it (the compressed ones are not mapped).
+// The mapping may fail for other reasons too (e.g. not enough address space
+// for a very large file on a 32-bit system), so the users should be prepared
+// to fall back to a regular file stream.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__MAPPEDFILESTREAM_H
+#define __AGS_CN_UTIL__MAPPEDFILESTREAM_H
+
+#include <memory>
+#include "core/platform.h"
+#include "util/memorystream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class MappedFileStream : public MemoryStream
+{
+public:
+    // Maps the section of file between start_off and end_off (exclusive)
+    // for reading; the stream's positions are relative to the section start.
+    // The constructor may raise std::runtime_error if the file could not be
+    // opened or mapped, or if the section is empty.
+    MappedFileStream(const String &file_name, soff_t start_off, soff_t end_off);
+    ~MappedFileStream() override;
+
+    // Opens the whole file or its section, mapped into memory;
+    // returns null on failure
+    static std::unique_ptr<Stream> OpenFile(const String &file_name);
+    static std::unique_ptr<Stream> OpenFile(const String &file_name, soff_t start_off, soff_t end_off);
+    // Tells if memory mapping is supported on this platform
+    static bool IsSupported();
+
+    void    Close() override;
+
+private:
+    // Assigns the mapped view, and the section of it with the stream's data
+    void    SetMapping(const String &file_name, void *map_base, size_t map_size,
+                       soff_t data_off, soff_t data_size);
+#if AGS_PLATFORM_OS_ANDROID
+    // Maps the section of the Android Asset, which must be stored uncompressed
+    void    MapAAsset(const String &file_name, soff_t start_off, soff_t end_off);
+#endif
+    void    Unmap();
+
+    void   *_mapBase = nullptr; // start of the mapped view, page aligned
+    size_t  _mapSize = 0u; // size of the mapped view
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__MAPPEDFILESTREAM_H
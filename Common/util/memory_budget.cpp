@@ -0,0 +1,141 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "util/memory_budget.h"
+#include <algorithm>
+#include <vector>
+#include "debug/out.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace MemoryBudget
+{
+
+struct Consumer
+{
+    int Handle = 0;
+    String Name;
+    int Priority = 0;
+    SizeFn GetSize;
+    ShrinkFn Shrink;
+};
+
+// Consumers, sorted by their priority
+static std::vector<Consumer> consumers;
+static int next_handle = 1;
+static size_t budget = 0u;
+
+int Register(const String &name, int priority, SizeFn get_size, ShrinkFn shrink)
+{
+    const int handle = next_handle++;
+    Consumer c;
+    c.Handle = handle;
+    c.Name = name;
+    c.Priority = priority;
+    c.GetSize = std::move(get_size);
+    c.Shrink = std::move(shrink);
+    auto it = std::upper_bound(consumers.begin(), consumers.end(), priority,
+        [](int prio, const Consumer &other) { return prio < other.Priority; });
+    consumers.insert(it, std::move(c));
+    return handle;
+}
+
+void Unregister(int handle)
+{
+    consumers.erase(std::remove_if(consumers.begin(), consumers.end(),
+        [handle](const Consumer &c) { return c.Handle == handle; }), consumers.end());
+}
+
+void SetBudget(size_t new_budget)
+{
+    budget = new_budget;
+}
+
+size_t GetBudget()
+{
+    return budget;
+}
+
+size_t GetTotalSize()
+{
+    size_t total = 0u;
+    for (const auto &c : consumers)
+        total += c.GetSize();
+    return total;
+}
+
+// Asks the consumers to free the given amount of memory, in priority order
+static size_t ShrinkBy(size_t size)
+{
+    size_t freed = 0u;
+    for (auto &c : consumers)
+    {
+        if (freed >= size)
+            break;
+        if (c.Shrink)
+            freed += c.Shrink(size - freed);
+    }
+    return freed;
+}
+
+size_t Update()
+{
+    if (budget == 0u)
+        return 0u;
+    const size_t total = GetTotalSize();
+    if (total <= budget)
+        return 0u;
+    // Free a bit more than the excess, so that the caches
+    // do not have to be shrunk again right away
+    const size_t excess = total - budget + budget / 16;
+    const size_t freed = ShrinkBy(excess);
+    Debug::Printf(kDbgMsg_Info, "Memory budget exceeded: used %zu KB of %zu KB, freed %zu KB",
+        total / 1024, budget / 1024, freed / 1024);
+    return freed;
+}
+
+size_t OnLowMemory()
+{
+    size_t freed = 0u;
+    for (auto &c : consumers)
+    {
+        if (c.Shrink)
+            freed += c.Shrink(c.GetSize() / 2);
+    }
+    Debug::Printf(kDbgMsg_Warn, "System is low on memory: freed %zu KB", freed / 1024);
+    return freed;
+}
+
+String GetReport()
+{
+    String report = "Memory use (KB):";
+    size_t total = 0u;
+    for (const auto &c : consumers)
+    {
+        const size_t size = c.GetSize();
+        total += size;
+        report.AppendFmt(" %s %zu,", c.Name.GetCStr(), size / 1024);
+    }
+    report.AppendFmt(" total %zu", total / 1024);
+    if (budget > 0u)
+        report.AppendFmt(" of budget %zu", budget / 1024);
+    return report;
+}
+
+} // namespace MemoryBudget
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,85 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// MemoryBudget is the registry of the program's large memory consumers,
+// such as the resource caches. Each consumer registers a function which
+// reports its current memory use, and optionally a function which frees
+// some of its memory on request.
+//
+// The registry lets print the memory use of all the consumers in one report,
+// and may keep their total within the global budget: when the budget is
+// exceeded, the consumers are asked to free the excess, in the order of their
+// priority, starting with the ones which data is cheaper to restore.
+// When the system reports low memory, every consumer is asked to free half
+// of its memory.
+//
+// The registry is meant to be used from the main thread only.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__MEMORYBUDGET_H
+#define __AGS_CN_UTIL__MEMORYBUDGET_H
+
+#include <functional>
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace MemoryBudget
+{
+    // Priorities of the engine's memory consumers
+    enum Priority
+    {
+        kPriority_Sounds         = 0,   // sound files, re-read from disk
+        kPriority_ScratchBitmaps = 5,   // pooled bitmaps for the transient drawing
+        kPriority_DecodedSounds  = 10,  // decoded short sounds
+        kPriority_Textures       = 20,  // textures, re-created from sprites
+        kPriority_Sprites        = 30,  // sprites, re-read and decoded from disk
+        kPriority_Fixed          = 100  // accounted only, cannot be freed
+    };
+
+    // Reports the consumer's current memory use, in bytes
+    typedef std::function<size_t()> SizeFn;
+    // Frees at least the given amount of memory, if possible;
+    // returns the amount of memory actually freed, in bytes
+    typedef std::function<size_t(size_t)> ShrinkFn;
+
+    // Registers the memory consumer; consumers with the lower priority are
+    // asked to free memory first. Consumers without a shrink function
+    // are only accounted. Returns the consumer's handle.
+    int  Register(const String &name, int priority, SizeFn get_size, ShrinkFn shrink = nullptr);
+    // Unregisters the consumer with the given handle
+    void Unregister(int handle);
+
+    // Sets the total memory budget, in bytes; 0 means no budget
+    void   SetBudget(size_t budget);
+    size_t GetBudget();
+    // Gets the total memory use of all the consumers
+    size_t GetTotalSize();
+    // Checks the total memory use, and if it exceeds the budget, makes the
+    // consumers free the excess; returns the amount of memory freed
+    size_t Update();
+    // Makes all the consumers free a half of their memory; to be called
+    // when the system is running low on memory; returns the amount freed
+    size_t OnLowMemory();
+    // Prints the memory use of each consumer
+    String GetReport();
+} // namespace MemoryBudget
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__MEMORYBUDGET_H
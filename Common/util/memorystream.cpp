@@ -155,6 +155,24 @@ VectorStream::VectorStream(std::vector<uint8_t> &buf, StreamMode mode)
     _mode = static_cast<StreamMode>(mode | kStream_Seek);
 }
 
+OwnedMemoryStream::OwnedMemoryStream(std::vector<uint8_t> &&data, const String &path)
+    : MemoryStream(nullptr, 0u)
+    , _data(std::move(data))
+{
+    _path = path;
+    _cbuf = _data.data();
+    _buf_sz = _data.size();
+    _len = _buf_sz;
+    _mode = static_cast<StreamMode>(kStream_Read | kStream_Seek);
+}
+
+void OwnedMemoryStream::Close()
+{
+    MemoryStream::Close();
+    _data.clear();
+    _data.shrink_to_fit();
+}
+
 void VectorStream::Close()
 {
     _vec = nullptr;
@@ -67,6 +67,8 @@ public:
     soff_t  Seek(soff_t offset, StreamSeek origin) override;
 
 protected:
+    friend class Stream; // for reading in place, see Stream::WrapMemory()
+
     const uint8_t           *_cbuf = nullptr; // readonly buffer ptr
     size_t                   _buf_sz = 0u; // hard buffer limit
     size_t                   _len = 0u; // calculated length of stream
@@ -98,6 +100,21 @@ private:
     std::vector<uint8_t> *_vec = nullptr; // writeable vector (may be null)
 };
 
+
+// OwnedMemoryStream is a read-only memory stream which owns its data
+class OwnedMemoryStream : public MemoryStream
+{
+public:
+    // Optional path is the name of the data's source, for diagnostics
+    OwnedMemoryStream(std::vector<uint8_t> &&data, const String &path = "");
+    ~OwnedMemoryStream() override = default;
+
+    void    Close() override;
+
+private:
+    std::vector<uint8_t> _data;
+};
+
 } // namespace Common
 } // namespace AGS
 
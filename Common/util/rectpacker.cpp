@@ -0,0 +1,175 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "util/rectpacker.h"
+#include <algorithm>
+#include <numeric>
+
+namespace AGS
+{
+namespace Common
+{
+
+// NOTE: the padding is added to the right and bottom of each rectangle,
+// and to the page as well, so that the last rectangles in a row or column
+// may touch the page's edges.
+
+RectPacker::RectPacker(const Size &page_size, int padding, size_t max_pages)
+    : _pageSize(page_size)
+    , _padding(std::max(0, padding))
+    , _maxPages(max_pages)
+{
+}
+
+float RectPacker::GetOccupancy() const
+{
+    if (_pages.empty())
+        return 0.f;
+    const uint64_t total = static_cast<uint64_t>(_pageSize.Width) * _pageSize.Height * _pages.size();
+    return total > 0 ? static_cast<float>(_usedArea) / total : 0.f;
+}
+
+PackedRect RectPacker::Add(const Size &size)
+{
+    PackedRect result;
+    if (size.Width <= 0 || size.Height <= 0 ||
+        size.Width > _pageSize.Width || size.Height > _pageSize.Height)
+        return result; // cannot be placed
+
+    const int width = size.Width + _padding;
+    const int height = size.Height + _padding;
+    for (size_t page = 0; page <= _pages.size(); ++page)
+    {
+        if (page == _pages.size())
+        {
+            if ((_maxPages > 0u) && (page == _maxPages))
+                break; // no more pages allowed
+            _pages.push_back(Page());
+            ResetPage(_pages.back());
+        }
+
+        auto &skyline = _pages[page].Line;
+        int y;
+        const int index = FindPosition(skyline, width, height, y);
+        if (index < 0)
+            continue;
+        const int x = skyline[index].X;
+        AddToSkyline(skyline, static_cast<size_t>(index), x, y, width, height);
+        const uint64_t area = static_cast<uint64_t>(size.Width) * size.Height;
+        _pages[page].UsedArea += area;
+        _usedArea += area;
+        result.Page = static_cast<int>(page);
+        result.Place = RectWH(x, y, size.Width, size.Height);
+        break;
+    }
+    return result;
+}
+
+void RectPacker::Clear()
+{
+    _pages.clear();
+    _usedArea = 0u;
+}
+
+void RectPacker::ClearPage(size_t page)
+{
+    if (page >= _pages.size())
+        return;
+    _usedArea -= _pages[page].UsedArea;
+    ResetPage(_pages[page]);
+}
+
+void RectPacker::ResetPage(Page &page)
+{
+    // A flat skyline, padded same as the rectangles
+    page.Line.clear();
+    page.Line.push_back({ 0, 0, _pageSize.Width + _padding });
+    page.UsedArea = 0u;
+}
+
+int RectPacker::FindPosition(const Skyline &skyline, int width, int height, int &y) const
+{
+    const int area_width = _pageSize.Width + _padding;
+    const int area_height = _pageSize.Height + _padding;
+    int best_index = -1;
+    int best_y = area_height;
+    for (size_t i = 0; i < skyline.size(); ++i)
+    {
+        if (skyline[i].X + width > area_width)
+            break; // the rest of segments are further to the right
+        // The rectangle rests on the highest of the segments below it
+        int top = skyline[i].Y;
+        for (size_t j = i + 1; (j < skyline.size()) && (skyline[j].X < skyline[i].X + width); ++j)
+            top = std::max(top, skyline[j].Y);
+        if ((top + height <= area_height) && (top < best_y))
+        {
+            best_index = static_cast<int>(i);
+            best_y = top;
+        }
+    }
+    y = best_y;
+    return best_index;
+}
+
+void RectPacker::AddToSkyline(Skyline &skyline, size_t index, int x, int y, int width, int height)
+{
+    skyline.insert(skyline.begin() + index, Segment{ x, y + height, width });
+    // Cut off the segments covered by the new one
+    const int right = x + width;
+    for (size_t i = index + 1; i < skyline.size();)
+    {
+        auto &seg = skyline[i];
+        if (seg.X >= right)
+            break;
+        const int cut = std::min(right - seg.X, seg.Width);
+        seg.X += cut;
+        seg.Width -= cut;
+        if (seg.Width > 0)
+            break;
+        skyline.erase(skyline.begin() + i);
+    }
+    // Merge the neighbouring segments of the same height
+    for (size_t i = 1; i < skyline.size();)
+    {
+        if (skyline[i - 1].Y == skyline[i].Y)
+        {
+            skyline[i - 1].Width += skyline[i].Width;
+            skyline.erase(skyline.begin() + i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+std::vector<PackedRect> RectPacker::Pack(const std::vector<Size> &sizes, const Size &page_size, int padding)
+{
+    // Place the taller rectangles first, and wider of the same height
+    std::vector<size_t> order(sizes.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b)
+        {
+            return sizes[a].Height != sizes[b].Height ? sizes[a].Height > sizes[b].Height :
+                sizes[a].Width > sizes[b].Width;
+        });
+
+    RectPacker packer(page_size, padding);
+    std::vector<PackedRect> result(sizes.size());
+    for (size_t i : order)
+        result[i] = packer.Add(sizes[i]);
+    return result;
+}
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,106 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// RectPacker arranges rectangles on the pages of a fixed size, such as
+// texture atlas pages, without overlapping. Uses the "skyline" method:
+// each page tracks the top outline of the placed rectangles, and a new
+// rectangle is put at the lowest position where it fits.
+//
+// Optional padding is a gap kept between the neighbouring rectangles,
+// which prevents texture filtering from mixing pixels of the neighbours.
+//
+// The packer does not track the individual rectangles, so these cannot be
+// removed one by one; instead a whole page may be cleared once none of its
+// rectangles are used anymore.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__RECTPACKER_H
+#define __AGS_CN_UTIL__RECTPACKER_H
+
+#include <vector>
+#include "core/types.h"
+#include "util/geometry.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+// Placement of the packed rectangle
+struct PackedRect
+{
+    int  Page = -1; // page index, or -1 if the rectangle could not be placed
+    Rect Place;     // position on the page
+};
+
+class RectPacker
+{
+public:
+    // Creates the packer; max_pages limits the number of pages, 0 = no limit
+    RectPacker(const Size &page_size, int padding = 0, size_t max_pages = 0u);
+
+    const Size &GetPageSize() const { return _pageSize; }
+    size_t      GetPageCount() const { return _pages.size(); }
+    // Gets the fraction of the pages' area occupied by rectangles
+    float       GetOccupancy() const;
+
+    // Places the rectangle of the given size on the first page that has room
+    // for it, adding a new page if necessary; fails if the rectangle is
+    // larger than a page, or if all the pages are full and no more allowed.
+    PackedRect  Add(const Size &size);
+    // Removes all pages
+    void        Clear();
+    // Removes all the rectangles from the page, keeping the page itself
+    void        ClearPage(size_t page);
+
+    // Packs the list of rectangles, placing larger ones first, which gives
+    // better density than packing in the arbitrary order. Returns placements
+    // in the order of the input sizes.
+    static std::vector<PackedRect> Pack(const std::vector<Size> &sizes,
+        const Size &page_size, int padding = 0);
+
+private:
+    // Segment of the page's skyline
+    struct Segment
+    {
+        int X, Y, Width;
+    };
+    typedef std::vector<Segment> Skyline;
+
+    struct Page
+    {
+        Skyline  Line;
+        uint64_t UsedArea = 0u;
+    };
+
+    // Finds the lowest position on the page for the rectangle of the given
+    // (padded) size; returns index of the starting skyline segment, or -1
+    int  FindPosition(const Skyline &skyline, int width, int height, int &y) const;
+    // Adds the placed rectangle to the page's skyline
+    void AddToSkyline(Skyline &skyline, size_t index, int x, int y, int width, int height);
+
+    // Resets the page's skyline to a flat line at the top
+    void ResetPage(Page &page);
+
+    Size    _pageSize;
+    int     _padding = 0;
+    size_t  _maxPages = 0u;
+    std::vector<Page> _pages;
+    uint64_t _usedArea = 0u;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__RECTPACKER_H
@@ -20,9 +20,19 @@
 // ResourceCache's implementations must provide a method for calculating an
 // item's size.
 //
+// The MRU list is intrusive: its nodes are kept in a single pool array, and
+// are linked by indexes, so that reordering and adding items does not
+// allocate memory, and the free nodes are reused.
+//
 // Supports copyable and movable items, have 2 variants of Put function for
 // each of them. This lets it store both std::shared_ptr and std::unique_ptr.
 //
+// The order in which the unlocked items are disposed is defined by the
+// eviction policy, see ResourceCachePolicy. Besides plain LRU, the cache
+// may keep the items used only once apart from the ones used repeatedly
+// (segmented LRU), or take into account the cost of re-creating an item,
+// which is passed along with the item into Put.
+//
 // TODO: support data Priority, which tells which items may be disposed
 // when adding new item and surpassing the cache limit.
 //
@@ -48,8 +58,9 @@
 #ifndef __AGS_CN_UTIL__RESOURCECACHE_H
 #define __AGS_CN_UTIL__RESOURCECACHE_H
 
-#include <list>
+#include <array>
 #include <unordered_map>
+#include <vector>
 #include "util/string.h"
 
 namespace AGS
@@ -57,6 +68,62 @@ namespace AGS
 namespace Common
 {
 
+// Eviction policy, defines which items are disposed first when the cache
+// has to free space for the new ones
+enum ResourceCachePolicy
+{
+    // Least recently used items are disposed first
+    kCachePolicy_LRU,
+    // Segmented LRU (a variant of LRU-2): new items are put into the
+    // "probation" segment, and move to the "protected" segment when used
+    // again; probation items are disposed first, so that a burst of items
+    // used only once does not push out the ones in frequent use.
+    kCachePolicy_SLRU,
+    // Of the several least recently used items the one with the lowest cost
+    // of re-creation per byte is disposed first; items without a known cost
+    // are considered the cheapest ones.
+    kCachePolicy_Cost,
+    kNumCachePolicies
+};
+
+// Statistics of the cache use, for diagnostics
+struct ResourceCacheStats
+{
+    // Number of the load time histogram buckets
+    static const size_t LoadTimeBucketCount = 9;
+
+    // Number of successful and failed item requests
+    uint64_t Hits = 0u;
+    uint64_t Misses = 0u;
+    // Number of items disposed to free space for the new ones
+    uint64_t Evictions = 0u;
+    // Number of the items loaded (created) for this cache, and their size
+    uint64_t Loads = 0u;
+    uint64_t LoadedSize = 0u;
+    // Histogram of item load times, see GetLoadTimeBound()
+    std::array<uint32_t, LoadTimeBucketCount> LoadTime {};
+
+    // Gets the upper bound of the load time histogram's bucket,
+    // in microseconds; the last bucket has no bound
+    static uint32_t GetLoadTimeBound(size_t bucket)
+    {
+        static const uint32_t bounds[LoadTimeBucketCount] =
+            { 100, 250, 500, 1000, 2500, 5000, 10000, 25000, UINT32_MAX };
+        return bucket < LoadTimeBucketCount ? bounds[bucket] : UINT32_MAX;
+    }
+
+    // Registers the item's load
+    void AddLoad(uint64_t size, uint32_t time_us)
+    {
+        Loads++;
+        LoadedSize += size;
+        size_t bucket = 0;
+        while ((bucket < LoadTimeBucketCount - 1) && (time_us >= GetLoadTimeBound(bucket)))
+            bucket++;
+        LoadTime[bucket]++;
+    }
+};
+
 template <typename TKey, typename TValue,
           typename TSize = size_t, typename HashFn = std::hash<TKey>>
 class ResourceCache
@@ -73,11 +140,12 @@ public:
         // They cannot be locked or released (considered permanently locked),
         // only removed by request.
         kCacheItem_External = 0x0002,
+        // Internal flag, marks the item in the probation segment (SLRU policy)
+        kCacheItem_Probation = 0x8000
     };
 
     ResourceCache(TSize max_size = 0u)
         : _maxSize(max_size)
-        , _sectionLocked(_mru.end())
     {}
 
     // Get the MRU cache size limit
@@ -88,12 +156,48 @@ public:
     inline size_t GetLockedSize() const { return _lockedSize; }
     // Get the summed size of external items (excluded from total cache size)
     inline size_t GetExternalSize() const { return _externalSize; }
+    // Get the eviction policy
+    inline ResourceCachePolicy GetPolicy() const { return _policy; }
+    // Get the number of successful and failed item requests, see Get()
+    inline uint64_t GetHitCount() const { return _stats.Hits; }
+    inline uint64_t GetMissCount() const { return _stats.Misses; }
+    // Get the cache use statistics
+    inline const ResourceCacheStats &GetStats() const { return _stats; }
+    // Resets the cache use statistics
+    void ResetStats() { _stats = ResourceCacheStats(); }
 
     // Set the MRU cache size limit
     void SetMaxCacheSize(TSize size)
     {
         _maxSize = size;
         FreeMem(0u); // makes sure it does not exceed max size
+        BalanceSegments();
+    }
+
+    // Set the eviction policy; the existing items are kept
+    void SetPolicy(ResourceCachePolicy policy)
+    {
+        if (_policy == policy)
+            return;
+        if (_policy == kCachePolicy_SLRU)
+        {
+            // Merge probation items back into the common list, as older ones
+            while (!_probation.IsEmpty())
+            {
+                const TMruIt node = _probation.Head;
+                _storage[_nodes[node].Key].Flags &= ~kCacheItem_Probation;
+                MoveNode(_mru, _sectionLocked, _probation, node);
+            }
+            _probationSize = 0u;
+        }
+        _policy = policy;
+    }
+
+    // Preallocates the space for the given number of items
+    void Reserve(size_t count)
+    {
+        _storage.reserve(count);
+        _nodes.reserve(count);
     }
 
     // Tells if particular key is in the cache
@@ -108,19 +212,35 @@ public:
     {
         auto it = _storage.find(key);
         if (it == _storage.end())
+        {
+            _stats.Misses++;
             return _dummy; // no such key
+        }
 
+        _stats.Hits++;
         // Unless locked, move the item ref to the beginning of the MRU list
-        const auto &item = it->second;
-        if ((item.Flags & kCacheItem_Locked) == 0)
-            _mru.splice(_mru.begin(), _mru, item.MruIt);
+        auto &item = it->second;
+        if ((item.Flags & kCacheItem_Probation) != 0)
+        {
+            // Used again, promote to the protected segment
+            item.Flags &= ~kCacheItem_Probation;
+            _probationSize -= item.Size;
+            MoveNode(_mru, _mru.Head, _probation, item.MruIt);
+            BalanceSegments();
+        }
+        else if ((item.Flags & kCacheItem_Locked) == 0)
+        {
+            MoveNode(_mru, _mru.Head, _mru, item.MruIt);
+        }
         return item.Value;
     }
 
     // Add particular item into the cache, disposes existing item if such key is already taken.
     // If a new item will exceed the cache size limit, cache will remove oldest items
     // in order to free mem.
-    void Put(const TKey &key, const TValue &value, uint32_t flags = 0u)
+    // Optional cost tells how expensive it is to re-create this item (e.g. the time
+    // it took to load), and is used by the cost-aware policy; 0 means unknown.
+    void Put(const TKey &key, const TValue &value, uint32_t flags = 0u, uint32_t cost = 0u)
     {
         if (_maxSize == 0)
             return; // cache is disabled
@@ -130,10 +250,10 @@ public:
             // Remove previous cached item
             RemoveImpl(it);
         }
-        PutImpl(key, TValue(value), flags); // make a temp local copy for safe std::move
+        PutImpl(key, TValue(value), flags, cost); // make a temp local copy for safe std::move
     }
 
-    void Put(const TKey &key, TValue &&value, uint32_t flags = 0u)
+    void Put(const TKey &key, TValue &&value, uint32_t flags = 0u, uint32_t cost = 0u)
     {
         if (_maxSize == 0)
             return; // cache is disabled
@@ -143,7 +263,7 @@ public:
             // Remove previous cached item
             RemoveImpl(it);
         }
-        PutImpl(key, std::move(value), flags);
+        PutImpl(key, std::move(value), flags, cost);
     }
 
     // Locks the item with the given key,
@@ -158,8 +278,17 @@ public:
             return; // already locked
 
         // Lock item and move to the locked section
+        if ((item.Flags & kCacheItem_Probation) != 0)
+        {
+            item.Flags &= ~kCacheItem_Probation;
+            _probationSize -= item.Size;
+            MoveNode(_mru, _sectionLocked, _probation, item.MruIt);
+        }
+        else
+        {
+            MoveNode(_mru, _sectionLocked, _mru, item.MruIt);
+        }
         item.Flags |= kCacheItem_Locked;
-        _mru.splice(_sectionLocked, _mru, item.MruIt); // CHECKME: TEST!!
         _sectionLocked = item.MruIt;
         _lockedSize += item.Size;
     }
@@ -181,9 +310,10 @@ public:
         // Unlock, and move the item to the beginning of the MRU list
         item.Flags &= ~kCacheItem_Locked;
         if (_sectionLocked == item.MruIt)
-            _sectionLocked = std::next(item.MruIt);
-        _mru.splice(_mru.begin(), _mru, item.MruIt); // CHECKME: TEST!!
+            _sectionLocked = _nodes[item.MruIt].Next;
+        MoveNode(_mru, _mru.Head, _mru, item.MruIt);
         _lockedSize -= item.Size;
+        BalanceSegments();
     }
 
     // Deletes the cached item
@@ -209,64 +339,178 @@ public:
     // Disposes all items that are not locked or external
     void DisposeFreeItems()
     {
-        for (auto mru_it = _sectionLocked; mru_it != _mru.end(); ++mru_it)
-        {
-            auto it = _storage.find(*mru_it);
-            assert(it != _storage.end());
-            auto &item = it->second;
-            _cacheSize -= item.Size;
-            _storage.erase(it);
-            _mru.erase(mru_it);
-        }
+        // Normal items are found in the probation list, and in the main MRU
+        // list before the locked section
+        while (!_probation.IsEmpty())
+            RemoveImpl(_storage.find(_nodes[_probation.Head].Key));
+        while (_mru.Head != _sectionLocked)
+            RemoveImpl(_storage.find(_nodes[_mru.Head].Key));
+    }
+
+    // Disposes the unlocked items in the eviction policy order, until at
+    // least the given amount of memory is freed, or there are no more items
+    // which may be disposed; returns the size of the disposed items
+    size_t Shrink(size_t size)
+    {
+        const size_t was_size = _cacheSize;
+        while (HasFreeItems() && (was_size - _cacheSize < size))
+            DisposeOldest();
+        return was_size - _cacheSize;
     }
 
     // Clear the cache, dispose all items
     void Clear()
     {
         _storage.clear();
-        _mru.clear();
-        _sectionLocked = _mru.end();
+        _nodes.clear();
+        _freeNode = NoNode;
+        _mru = TMruList();
+        _probation = TMruList();
+        _sectionLocked = NoNode;
         _cacheSize = 0u;
+        _probationSize = 0u;
         _lockedSize = 0u;
         _externalSize = 0u;
     }
 
 protected:
     struct TItem;
-    // MRU list type
-    typedef std::list<TKey> TMruList;
-    // MRU list reference type
-    typedef typename TMruList::iterator TMruIt;
+    // MRU list reference type, an index of the node in the pool
+    typedef uint32_t TMruIt;
     // Storage type
     typedef std::unordered_map<TKey, TItem, HashFn> TStorage;
 
+    // Null MRU list reference, also serves as the end of a list
+    static const TMruIt NoNode = UINT32_MAX;
+
     struct TItem
     {
-        TMruIt       MruIt; // MRU list reference
+        TMruIt       MruIt = NoNode; // MRU list reference
         TValue       Value;
         TSize        Size = 0u;
         uint32_t     Flags = 0u; // flags determine management rules for this item
+        uint32_t     Cost = 0u; // cost of re-creating this item, 0 if unknown
 
         TItem() = default;
         TItem(const TItem &item) = default;
         TItem(TItem &&item) = default;
-        TItem(const TMruIt &mru_it, const TValue &value, const TSize size, uint32_t flags)
-            : MruIt(mru_it), Value(value), Size(size), Flags(flags) {}
-        TItem(const TMruIt &mru_it, TValue &&value, const TSize size, uint32_t flags)
-            : MruIt(mru_it), Value(std::move(value)), Size(size), Flags(flags) {}
+        TItem(const TMruIt &mru_it, const TValue &value, const TSize size, uint32_t flags, uint32_t cost)
+            : MruIt(mru_it), Value(value), Size(size), Flags(flags), Cost(cost) {}
+        TItem(const TMruIt &mru_it, TValue &&value, const TSize size, uint32_t flags, uint32_t cost)
+            : MruIt(mru_it), Value(std::move(value)), Size(size), Flags(flags), Cost(cost) {}
         TItem &operator =(const TItem &item) = default;
         TItem &operator =(TItem &&item) = default;
     };
 
+    // Gets the cost of re-creating the item, which was passed into Put
+    uint32_t GetCost(const TKey &key) const
+    {
+        auto it = _storage.find(key);
+        return it != _storage.end() ? it->second.Cost : 0u;
+    }
+
+    // Registers the load of an item for the stats; the implementations
+    // should call this whenever they create a new item for the cache
+    void RecordLoad(uint64_t size, uint32_t time_us)
+    {
+        _stats.AddLoad(size, time_us);
+    }
+
     // Calculates item size; expects to return 0 if an item is invalid
     // and should not be added to the cache.
     virtual TSize CalcSize(const TValue &item) = 0;
 
 private:
+    // MRU list node; free nodes are chained using Next index
+    struct TMruNode
+    {
+        TKey   Key;
+        TMruIt Prev = NoNode;
+        TMruIt Next = NoNode;
+    };
+
+    // MRU list, which nodes are allocated in the cache's node pool
+    struct TMruList
+    {
+        TMruIt Head = NoNode;
+        TMruIt Tail = NoNode;
+
+        bool IsEmpty() const { return Head == NoNode; }
+    };
+
+    // Takes a free node from the pool, or adds a new one
+    TMruIt AllocNode(const TKey &key)
+    {
+        TMruIt node = _freeNode;
+        if (node != NoNode)
+        {
+            _freeNode = _nodes[node].Next;
+        }
+        else
+        {
+            node = static_cast<TMruIt>(_nodes.size());
+            _nodes.emplace_back();
+        }
+        _nodes[node].Key = key;
+        return node;
+    }
+    // Returns the unlinked node to the pool
+    void FreeNode(TMruIt node)
+    {
+        _nodes[node].Key = TKey();
+        _nodes[node].Prev = NoNode;
+        _nodes[node].Next = _freeNode;
+        _freeNode = node;
+    }
+    // Links the node into the list, before the given position;
+    // NoNode position means the end of the list
+    void LinkNode(TMruList &list, TMruIt before, TMruIt node)
+    {
+        auto &n = _nodes[node];
+        n.Next = before;
+        n.Prev = (before != NoNode) ? _nodes[before].Prev : list.Tail;
+        if (n.Prev != NoNode)
+            _nodes[n.Prev].Next = node;
+        else
+            list.Head = node;
+        if (before != NoNode)
+            _nodes[before].Prev = node;
+        else
+            list.Tail = node;
+    }
+    // Unlinks the node from the list
+    void UnlinkNode(TMruList &list, TMruIt node)
+    {
+        auto &n = _nodes[node];
+        if (n.Prev != NoNode)
+            _nodes[n.Prev].Next = n.Next;
+        else
+            list.Head = n.Next;
+        if (n.Next != NoNode)
+            _nodes[n.Next].Prev = n.Prev;
+        else
+            list.Tail = n.Prev;
+        n.Prev = n.Next = NoNode;
+    }
+    // Moves the node from the src list to the dst list, before the given position
+    void MoveNode(TMruList &dst, TMruIt before, TMruList &src, TMruIt node)
+    {
+        if (before == node)
+            return; // already in place
+        UnlinkNode(src, node);
+        LinkNode(dst, before, node);
+    }
+    // Returns the node preceding the given position in the list;
+    // NoNode position means the end of the list
+    TMruIt PrevNode(const TMruList &list, TMruIt pos) const
+    {
+        return (pos != NoNode) ? _nodes[pos].Prev : list.Tail;
+    }
+
     // Add particular item into the cache.
     // If a new item will exceed the cache size limit, cache will remove oldest items
     // in order to free mem.
-    void PutImpl(const TKey &key, TValue &&value, uint32_t flags)
+    void PutImpl(const TKey &key, TValue &&value, uint32_t flags, uint32_t cost)
     {
         // Request item's size, and test if it's a valid item
         TSize size = CalcSize(value);
@@ -289,24 +533,35 @@ private:
         }
 
         // Prepare a MRU slot, then add an item
-        TMruIt mru_it = _mru.end();
+        TMruIt mru_it = NoNode;
         // only normal items are added to MRU at all
         if ((flags & kCacheItem_External) == 0)
         {
+            mru_it = AllocNode(key);
             if ((flags & kCacheItem_Locked) == 0)
             {
-                // normal item, add to the list
-                mru_it = _mru.insert(_mru.begin(), key);
+                // normal item, add to the list;
+                // with segmented policy it has to stay in probation first
+                if (_policy == kCachePolicy_SLRU)
+                {
+                    LinkNode(_probation, _probation.Head, mru_it);
+                    flags |= kCacheItem_Probation;
+                    _probationSize += size;
+                }
+                else
+                {
+                    LinkNode(_mru, _mru.Head, mru_it);
+                }
             }
             else
             {
                 // locked item, add to the dedicated list section
-                mru_it = _mru.insert(_sectionLocked, key);
+                LinkNode(_mru, _sectionLocked, mru_it);
                 _sectionLocked = mru_it;
                 _lockedSize += size;
             }
         }
-        TItem item = TItem(mru_it, std::move(value), size, flags);
+        TItem item = TItem(mru_it, std::move(value), size, flags, cost);
         _storage[key] = std::move(item);
     }
     // Removes the item from the container
@@ -317,12 +572,21 @@ private:
         if ((item.Flags & kCacheItem_External) == 0)
         {
             TMruIt mru_it = item.MruIt;
-            if (_sectionLocked == mru_it)
-                _sectionLocked = std::next(mru_it);
             _cacheSize -= item.Size;
-            if ((item.Flags & kCacheItem_Locked) != 0)
-                _lockedSize -= item.Size;
-            _mru.erase(mru_it);
+            if ((item.Flags & kCacheItem_Probation) != 0)
+            {
+                _probationSize -= item.Size;
+                UnlinkNode(_probation, mru_it);
+            }
+            else
+            {
+                if (_sectionLocked == mru_it)
+                    _sectionLocked = _nodes[mru_it].Next;
+                if ((item.Flags & kCacheItem_Locked) != 0)
+                    _lockedSize -= item.Size;
+                UnlinkNode(_mru, mru_it);
+            }
+            FreeNode(mru_it);
         }
         else
         {
@@ -330,32 +594,89 @@ private:
         }
         _storage.erase(it);
     }
-    // Remove the oldest (least recently used) item in cache
+    // Tells if there are any items which may be disposed
+    bool HasFreeItems() const
+    {
+        return !_probation.IsEmpty() || (_mru.Head != _sectionLocked);
+    }
+    // Remove the oldest (least recently used) item in cache,
+    // or the one chosen by the eviction policy
     void DisposeOldest()
     {
-        assert(_mru.begin() != _sectionLocked);
-        if (_mru.begin() == _sectionLocked)
+        assert(HasFreeItems());
+        _stats.Evictions++;
+        if (!_probation.IsEmpty())
+        {
+            RemoveImpl(_storage.find(_nodes[_probation.Tail].Key));
+            return;
+        }
+        if (_mru.Head == _sectionLocked)
+            return;
+
+        TMruIt mru_it = PrevNode(_mru, _sectionLocked);
+        if (_policy == kCachePolicy_Cost)
+        {
+            // Look through several oldest items, and choose the one
+            // which is cheapest to re-create, per byte of its size
+            auto victim = _storage.find(_nodes[mru_it].Key);
+            double victim_rate = CostRate(victim->second);
+            for (int i = 1; (i < CostSampleCount) && (mru_it != _mru.Head); ++i)
+            {
+                mru_it = _nodes[mru_it].Prev;
+                auto it = _storage.find(_nodes[mru_it].Key);
+                const double rate = CostRate(it->second);
+                if (rate < victim_rate)
+                {
+                    victim = it;
+                    victim_rate = rate;
+                }
+            }
+            assert((victim->second.Flags & (kCacheItem_Locked | kCacheItem_External)) == 0);
+            RemoveImpl(victim);
             return;
+        }
+
         // Remove from the storage and mru list
-        auto mru_it = std::prev(_sectionLocked);
-        auto it = _storage.find(*mru_it);
+        auto it = _storage.find(_nodes[mru_it].Key);
         assert(it != _storage.end());
-        auto &item = it->second;
-        assert((item.Flags & (kCacheItem_Locked | kCacheItem_External)) == 0);
-        _cacheSize -= item.Size;
-        _storage.erase(it);
-        _mru.erase(mru_it);
+        assert((it->second.Flags & (kCacheItem_Locked | kCacheItem_External)) == 0);
+        RemoveImpl(it);
     }
     // Keep disposing oldest elements until cache has at least the given free space
     void FreeMem(size_t space)
     {
         // TODO: consider sprite cache's behavior where it would just clear
         // whole cache in case disposing one by one were taking too much iterations
-        while ((_mru.begin() != _sectionLocked) && (_cacheSize + space > _maxSize))
+        while (HasFreeItems() && (_cacheSize + space > _maxSize))
         {
             DisposeOldest();
         }
     }
+    // With segmented policy, keeps the protected segment within its limit,
+    // by demoting its oldest items back to probation
+    void BalanceSegments()
+    {
+        if (_policy != kCachePolicy_SLRU)
+            return;
+        const TSize max_protected = _maxSize / 4 * 3;
+        while ((_mru.Head != _sectionLocked) &&
+               (_cacheSize - _lockedSize - _probationSize > max_protected))
+        {
+            const TMruIt mru_it = PrevNode(_mru, _sectionLocked);
+            auto &item = _storage[_nodes[mru_it].Key];
+            item.Flags |= kCacheItem_Probation;
+            _probationSize += item.Size;
+            MoveNode(_probation, _probation.Head, _mru, mru_it);
+        }
+    }
+    // Cost of re-creating the item per its size unit
+    static double CostRate(const TItem &item)
+    {
+        return static_cast<double>(item.Cost) / item.Size;
+    }
+
+    // Number of oldest items looked through by the cost-aware policy
+    static const int CostSampleCount = 8;
 
 
     // Size of tracked data stored in this cache;
@@ -373,17 +694,30 @@ private:
     // the cache will try to free the space by removing oldest items.
     // "External" data does not count towards this limit.
     TSize _maxSize = 0u;
+    // Size of the items in the probation segment (SLRU policy),
+    // this size is *included* in _cacheSize.
+    TSize _probationSize = 0u;
+    // Eviction policy
+    ResourceCachePolicy _policy = kCachePolicy_LRU;
+    // Cache use statistics
+    ResourceCacheStats _stats;
+    // Pool of the MRU list nodes, and the head of the free nodes chain
+    std::vector<TMruNode> _nodes;
+    TMruIt   _freeNode = NoNode;
     // MRU list: the way to track which items were used recently.
     // When clearing up space for new items, cache first deletes the items
     // that were last time used long ago.
     TMruList _mru;
-    // A locked section border iterator, points to the *last* locked item
-    // starting from the end of the list, or equals _mru.end() if there's none.
-    TMruIt   _sectionLocked;
+    // A locked section border, points to the *last* locked item
+    // starting from the end of the list, or equals NoNode if there's none.
+    TMruIt   _sectionLocked = NoNode;
+    // Probation segment of the MRU list, used only by the SLRU policy:
+    // contains the normal items which were not requested since being added.
+    TMruList _probation;
     // Key-to-mru lookup map
     TStorage _storage;
     // Dummy value, return in case of a missing key
-    TValue  _dummy;
+    TValue  _dummy{};
 };
 
 } // namespace Common
@@ -0,0 +1,106 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// SpscQueue is a lock-free bounded queue for passing items from exactly one
+// producer thread to exactly one consumer thread. The items are kept in
+// a ring buffer allocated once on construction; neither side ever waits
+// for the other, a push to the full queue and a pop from the empty queue
+// simply fail.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__SPSCQUEUE_H
+#define __AGS_CN_UTIL__SPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace AGS
+{
+namespace Common
+{
+
+template <typename T>
+class SpscQueue
+{
+public:
+    // Creates the queue, which holds at least the given number of items
+    explicit SpscQueue(size_t capacity)
+    {
+        size_t size = 2u;
+        while (size < capacity + 1)
+            size <<= 1;
+        _items.resize(size);
+        _mask = size - 1;
+    }
+
+    // Gets the max number of items the queue may hold
+    size_t GetCapacity() const { return _mask; }
+    // Tells if the queue is empty; the result is only exact for the
+    // consumer, and may be outdated for the producer
+    bool IsEmpty() const
+    {
+        return _head.Value.load(std::memory_order_acquire) == _tail.Value.load(std::memory_order_acquire);
+    }
+
+    // Adds the item to the queue; returns false if the queue is full.
+    // May only be called by the producer.
+    bool TryPush(T &&item)
+    {
+        const size_t tail = _tail.Value.load(std::memory_order_relaxed);
+        const size_t next = (tail + 1) & _mask;
+        if (next == _head.Value.load(std::memory_order_acquire))
+            return false;
+        _items[tail] = std::move(item);
+        _tail.Value.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Takes the oldest item from the queue; returns false if the queue
+    // is empty. May only be called by the consumer.
+    bool TryPop(T &item)
+    {
+        const size_t head = _head.Value.load(std::memory_order_relaxed);
+        if (head == _tail.Value.load(std::memory_order_acquire))
+            return false;
+        item = std::move(_items[head]);
+        _items[head] = T(); // release any resources held by the item
+        _head.Value.store((head + 1) & _mask, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // Assumed cache line size
+    static const size_t CacheLineSize = 64u;
+    // Position in the ring buffer, padded on both sides so that it does
+    // not share a cache line with anything else. The padding is used instead
+    // of alignas, because the C++11 new does not support over-aligned types.
+    struct PaddedPosition
+    {
+        char Before[CacheLineSize];
+        std::atomic<size_t> Value{0u};
+        char After[CacheLineSize - sizeof(std::atomic<size_t>)];
+    };
+
+    std::vector<T> _items;
+    size_t _mask = 0u;
+    // The consumer's and producer's positions are kept apart
+    PaddedPosition _head;
+    PaddedPosition _tail;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__SPSCQUEUE_H
@@ -158,6 +158,25 @@ file_off_t ags_file_size(const char *path)
 #endif
 }
 
+int64_t ags_file_mtime(const char *path)
+{
+#if AGS_PLATFORM_OS_WINDOWS
+    WCHAR wstr[MAX_PATH_SZ];
+    MultiByteToWideChar(CP_UTF8, 0, path, -1, wstr, MAX_PATH_SZ);
+    struct _stat64 path_stat;
+    if (_wstat64(wstr, &path_stat) != 0) {
+        return -1;
+    }
+    return path_stat.st_mtime;
+#else
+    struct stat path_stat;
+    if (stat(path, &path_stat) != 0) {
+        return -1;
+    }
+    return path_stat.st_mtime;
+#endif
+}
+
 int ags_file_remove(const char *path)
 {
 #if AGS_PLATFORM_OS_WINDOWS
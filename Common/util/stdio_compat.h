@@ -38,6 +38,7 @@ int ags_file_exists(const char *path);
 int ags_directory_exists(const char *path);
 int ags_path_exists(const char *path);
 file_off_t ags_file_size(const char *path);
+int64_t ags_file_mtime(const char *path);
 
 int ags_file_remove(const char *path);
 int ags_file_rename(const char *src, const char *dst);
@@ -14,6 +14,7 @@
 #include "util/stream.h"
 #include <algorithm>
 #include <stdexcept>
+#include "util/memorystream.h"
 
 namespace AGS
 {
@@ -24,6 +25,16 @@ namespace Common
 // Stream
 //-----------------------------------------------------------------------------
 
+std::unique_ptr<Stream> Stream::WrapMemory(std::unique_ptr<MemoryStream> &&base)
+{
+    MemoryStream *ms = base.get();
+    std::unique_ptr<Stream> s(new Stream(std::move(base)));
+    s->_memBuf = ms->_cbuf;
+    s->_memLen = &ms->_len;
+    s->_memPos = &ms->_pos;
+    return s;
+}
+
 size_t Stream::ReadAndConvertArrayOfInt16(int16_t *buffer, size_t count)
 {
     count = ReadArray(buffer, sizeof(int16_t), count);
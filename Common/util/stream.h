@@ -27,6 +27,7 @@
 #ifndef __AGS_CN_UTIL__STREAM_H
 #define __AGS_CN_UTIL__STREAM_H
 
+#include <cstring>
 #include <memory>
 #include "util/bbop.h"
 #include "util/string.h"
@@ -172,6 +173,8 @@ private:
 // for reading and writing basic data types independently from system's endianess.
 // This class assumes little-endian data by default.
 // TODO: add big-endian read-write methods for the sake of completeness.
+class MemoryStream;
+
 class Stream final
 {
 public:
@@ -179,11 +182,22 @@ public:
     Stream(std::unique_ptr<IStreamBase> &&base)
         : _base(std::move(base)) {}
     Stream(Stream &&other)
-        : _base(std::move(other._base)) {}
+        : _base(std::move(other._base)), _memBuf(other._memBuf)
+        , _memLen(other._memLen), _memPos(other._memPos) { other.ResetMemory(); }
     ~Stream() = default;
 
+    // Constructs a stream over the read-only memory stream, which holds the
+    // whole stream's data. This lets read the data in place, and also lets
+    // the ReadX helpers take the values from memory without calling the
+    // stream base.
+    static std::unique_ptr<Stream> WrapMemory(std::unique_ptr<MemoryStream> &&base);
+
     IStreamBase *GetStreamBase() { return _base.get(); }
-    std::unique_ptr<IStreamBase> ReleaseStreamBase() { return std::move(_base); }
+    std::unique_ptr<IStreamBase> ReleaseStreamBase() { ResetMemory(); return std::move(_base); }
+    // Returns the buffer holding the whole stream's data, if this stream is
+    // backed by one, or null otherwise; the stream's position is an offset
+    // in this buffer
+    const uint8_t *GetMemoryBuffer() const { return _memBuf; }
 
     //-----------------------------------------------------
     // Helpers for learning the stream's state and capabilities
@@ -200,6 +214,10 @@ public:
     Stream &operator =(Stream &&other)
     {
         _base = std::move(other._base);
+        _memBuf = other._memBuf;
+        _memLen = other._memLen;
+        _memPos = other._memPos;
+        other.ResetMemory();
         return *this;
     }
 
@@ -252,40 +270,30 @@ public:
     // Flush stream buffer to the underlying device
     bool        Flush() { return _base->Flush(); }
     // Closes the stream
-    void        Close() { return _base->Close(); }
+    void        Close() { ResetMemory(); return _base->Close(); }
 
     //-------------------------------------------------------------------------
     // Following are helper methods for reading & writing particular values.
     //-------------------------------------------------------------------------
     int8_t ReadInt8()
     {
-        int8_t val = 0;
-        Read(&val, sizeof(int8_t));
-        return val;
+        return ReadValue<int8_t>();
     }
     int16_t ReadInt16()
     {
-        int16_t val = 0;
-        Read(&val, sizeof(int16_t));
-        return BBOp::Int16FromLE(val);
+        return BBOp::Int16FromLE(ReadValue<int16_t>());
     }
     int32_t ReadInt32()
     {
-        int32_t val = 0;
-        Read(&val, sizeof(int32_t));
-        return BBOp::Int32FromLE(val);
+        return BBOp::Int32FromLE(ReadValue<int32_t>());
     }
     int64_t ReadInt64()
     {
-        int64_t val = 0;
-        Read(&val, sizeof(int64_t));
-        return BBOp::Int64FromLE(val);
+        return BBOp::Int64FromLE(ReadValue<int64_t>());
     }
     float ReadFloat32()
     {
-        float val = 0.f;
-        Read(&val, sizeof(float));
-        return BBOp::Float32FromLE(val);
+        return BBOp::Float32FromLE(ReadValue<float>());
     }
     bool ReadBool()
     {
@@ -412,7 +420,36 @@ public:
     size_t WriteByteCount(uint8_t b, size_t count);
 
 private:
+    // Reads the value of basic type; takes it straight from memory when
+    // the stream is memory-backed and has enough data left
+    template <typename T>
+    T ReadValue()
+    {
+        T val = 0;
+        if (_memBuf && (*_memLen - *_memPos >= sizeof(T)))
+        {
+            memcpy(&val, _memBuf + *_memPos, sizeof(T));
+            *_memPos += sizeof(T);
+        }
+        else
+        {
+            Read(&val, sizeof(T));
+        }
+        return val;
+    }
+
+    void ResetMemory()
+    {
+        _memBuf = nullptr;
+        _memLen = nullptr;
+        _memPos = nullptr;
+    }
+
     std::unique_ptr<IStreamBase> _base;
+    // Data, length and position of the memory-backed stream base
+    const uint8_t *_memBuf = nullptr;
+    const size_t *_memLen = nullptr;
+    size_t *_memPos = nullptr;
 
     // Helper methods for reading/writing arrays of basic types and
     // converting their elements to opposite endianess (swapping bytes).
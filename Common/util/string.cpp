@@ -25,6 +25,9 @@ namespace AGS
 namespace Common
 {
 
+// Size of the stack buffer used to format the short strings in one pass
+static const size_t FormatBufferSize = 256;
+
 String::String()
     : _cstr(const_cast<char*>(""))
     , _len(0)
@@ -42,10 +45,16 @@ String::String(const String &str)
 
 String::String(String &&str)
 {
-    _cstr = str._cstr;
-    _len = str._len;
-    _buf = str._buf;
-    _bufHead = str._bufHead;
+    if (str.IsLocal())
+    {
+        CopyLocal(str);
+    }
+    else
+    {
+        _cstr = str._cstr;
+        _len = str._len;
+        _buf = str._buf;
+    }
     str._cstr = const_cast<char*>("");
     str._len = 0;
     str._buf = nullptr;
@@ -452,12 +461,13 @@ std::vector<String> String::Split(char separator) const
 
 void String::Reserve(size_t max_length)
 {
-    if (_bufHead)
+    if (HasBuffer())
     {
-        if (max_length > _bufHead->Capacity)
+        const size_t capacity = GetBufferCapacity();
+        if (max_length > capacity)
         {
             // grow by 50%
-            size_t grow_length = _bufHead->Capacity + (_bufHead->Capacity / 2);
+            size_t grow_length = capacity + (capacity / 2);
             Copy(std::max(max_length, grow_length));
         }
     }
@@ -474,7 +484,7 @@ void String::ReserveMore(size_t more_length)
 
 void String::Compact()
 {
-    if (_bufHead && _bufHead->Capacity > _len)
+    if (!IsLocal() && _bufHead && _bufHead->Capacity > _len)
     {
         Copy(_len);
     }
@@ -529,12 +539,21 @@ void String::AppendFmtv(const char *fcstr, va_list argptr)
     fcstr = fcstr ? fcstr : "";
     va_list argptr_cpy;
     va_copy(argptr_cpy, argptr);
-    size_t length = vsnprintf(nullptr, 0u, fcstr, argptr);
-    ReserveAndShift(false, length);
-    vsprintf(_cstr + _len, fcstr, argptr_cpy);
+    // Short results are formatted in one pass, through the stack buffer
+    char buf[FormatBufferSize];
+    size_t length = vsnprintf(buf, sizeof(buf), fcstr, argptr);
+    if (length < sizeof(buf))
+    {
+        Append(buf, length);
+    }
+    else
+    {
+        ReserveAndShift(false, length);
+        vsprintf(_cstr + _len, fcstr, argptr_cpy);
+        _len += length;
+        _cstr[_len] = 0;
+    }
     va_end(argptr_cpy);
-    _len += length;
-    _cstr[_len] = 0;
 }
 
 void String::ClipLeft(size_t count)
@@ -673,17 +692,26 @@ void String::FormatV(const char *fcstr, va_list argptr)
     fcstr = fcstr ? fcstr : "";
     va_list argptr_cpy;
     va_copy(argptr_cpy, argptr);
-    size_t length = vsnprintf(nullptr, 0u, fcstr, argptr);
-    ReserveAndShift(false, Math::Surplus(length, _len));
-    vsprintf(_cstr, fcstr, argptr_cpy);
+    // Short results are formatted in one pass, through the stack buffer
+    char buf[FormatBufferSize];
+    size_t length = vsnprintf(buf, sizeof(buf), fcstr, argptr);
+    if (length < sizeof(buf))
+    {
+        SetString(buf, length);
+    }
+    else
+    {
+        ReserveAndShift(false, Math::Surplus(length, _len));
+        vsprintf(_cstr, fcstr, argptr_cpy);
+        _len = length;
+        _cstr[_len] = 0;
+    }
     va_end(argptr_cpy);
-    _len = length;
-    _cstr[_len] = 0;
 }
 
 void String::Free()
 {
-    if (_bufHead)
+    if (!IsLocal() && _bufHead)
     {
         assert(_bufHead->RefCount > 0);
         _bufHead->RefCount--;
@@ -1059,6 +1087,11 @@ String &String::operator=(const String& str)
     if (_cstr != str._cstr)
     {
         Free();
+        if (str.IsLocal())
+        {
+            CopyLocal(str);
+            return *this;
+        }
         _buf = str._buf;
         _cstr = str._cstr;
         _len = str._len;
@@ -1073,10 +1106,16 @@ String &String::operator=(const String& str)
 String &String::operator=(String &&str)
 {
     Free();
-    _cstr = str._cstr;
-    _len = str._len;
-    _buf = str._buf;
-    _bufHead = str._bufHead;
+    if (str.IsLocal())
+    {
+        CopyLocal(str);
+    }
+    else
+    {
+        _cstr = str._cstr;
+        _len = str._len;
+        _buf = str._buf;
+    }
     str._cstr = const_cast<char*>("");
     str._len = 0;
     str._buf = nullptr;
@@ -1092,16 +1131,37 @@ String &String::operator=(const char *cstr)
 
 void String::Create(size_t max_length)
 {
-    _buf = new char[sizeof(String::BufHeader) + max_length + 1];
-    _bufHead->RefCount = 1;
-    _bufHead->Capacity = max_length;
+    if (max_length <= LocalCapacity)
+    {
+        _cstr = _local;
+    }
+    else
+    {
+        _buf = new char[sizeof(String::BufHeader) + max_length + 1];
+        _bufHead->RefCount = 1;
+        _bufHead->Capacity = max_length;
+        _cstr = _buf + sizeof(String::BufHeader);
+    }
     _len = 0;
-    _cstr = _buf + sizeof(String::BufHeader);
     _cstr[_len] = 0;
 }
 
 void String::Copy(size_t max_length, size_t offset)
 {
+    if (max_length <= LocalCapacity)
+    {
+        // the data may already be in the local buffer, so copy it aside first
+        char temp[LocalCapacity + 1];
+        size_t copy_length = std::min(_len, max_length);
+        memcpy(temp, _cstr, copy_length);
+        Free();
+        _cstr = _local + offset;
+        memcpy(_cstr, temp, copy_length);
+        _len = copy_length;
+        _cstr[_len] = 0;
+        return;
+    }
+
     char *new_data = new char[sizeof(String::BufHeader) + max_length + 1];
     // remember, that _cstr may point to any address in buffer
     char *cstr_head = new_data + sizeof(String::BufHeader) + offset;
@@ -1118,16 +1178,24 @@ void String::Copy(size_t max_length, size_t offset)
 
 void String::Align(size_t offset)
 {
-    char *cstr_head = _buf + sizeof(String::BufHeader) + offset;
+    char *cstr_head = GetBufferHead() + offset;
     memmove(cstr_head, _cstr, _len + 1);
     _cstr = cstr_head;
 }
 
+void String::CopyLocal(const String &str)
+{
+    memcpy(_local, str._local, sizeof(_local));
+    _cstr = _local + (str._cstr - str._local);
+    _len = str._len;
+}
+
 inline bool String::IsShared() const
 {
+    // local buffer == never shared
     // no allocated buffer == wrapping an external char[]
     // has buffer and refcount > 1 == shared string buffer
-    return !_bufHead || (_bufHead->RefCount > 1);
+    return !IsLocal() && (!_bufHead || (_bufHead->RefCount > 1));
 }
 
 void String::BecomeUnique()
@@ -1140,26 +1208,27 @@ void String::BecomeUnique()
 
 void String::ReserveAndShift(bool left, size_t more_length)
 {
-    if (_bufHead)
+    if (HasBuffer())
     {
+        const size_t capacity = GetBufferCapacity();
         size_t total_length = _len + more_length;
-        if (_bufHead->Capacity < total_length)
+        if (capacity < total_length)
         { // not enough capacity - reallocate buffer
             // grow by 50% or at least to total_size
-            size_t grow_length = _bufHead->Capacity + (_bufHead->Capacity >> 1);
+            size_t grow_length = capacity + (capacity >> 1);
             Copy(std::max(total_length, grow_length), left ? more_length : 0u);
         }
-        else if (_bufHead->RefCount > 1)
+        else if (IsShared())
         { // is a shared string - clone buffer
             Copy(total_length, left ? more_length : 0u);
         }
         else
         {
             // make sure we make use of all of our space
-            const char *cstr_head = _buf + sizeof(String::BufHeader);
+            const char *cstr_head = GetBufferHead();
             size_t free_space = left ?
                 _cstr - cstr_head :
-                (cstr_head + _bufHead->Capacity) - (_cstr + _len);
+                (cstr_head + capacity) - (_cstr + _len);
             if (free_space < more_length)
             {
                 Align((left ?
@@ -28,6 +28,11 @@
 // The class provides means to reserve large amount of buffer space before
 // making modifications, as well as compacting buffer to minimal size.
 //
+// Short strings are kept in a small buffer inside the String object itself,
+// and do not allocate any memory; such strings are copied on assignment
+// instead of sharing their data. Note that this means that the c-str pointer
+// of a short string is only valid for as long as this String object exists.
+//
 // String object's GetCStr method guarantees valid null-terminated char array.
 //
 // For all methods that expect C-string as parameter - if the null pointer is
@@ -56,6 +61,8 @@ class String
 {
 public:
     static const size_t NoIndex = SIZE_MAX;
+    // Maximal length of a string kept in the local buffer
+    static const size_t LocalCapacity = 15;
 
     // Standard constructor: intialize empty string
     String();
@@ -93,17 +100,22 @@ public:
 #if AGS_PLATFORM_TEST
     inline const char *GetBuffer() const
     {
-        return _buf;
+        return IsLocal() ? _local : _buf;
     }
 
     inline size_t GetCapacity() const
     {
-        return _bufHead ? _bufHead->Capacity : 0;
+        return IsLocal() ? LocalCapacity : (_bufHead ? _bufHead->Capacity : 0);
     }
 
     inline size_t GetRefCount() const
     {
-        return _bufHead ? _bufHead->RefCount : 0;
+        return IsLocal() ? 1 : (_bufHead ? _bufHead->RefCount : 0);
+    }
+
+    inline bool IsLocalBuffer() const
+    {
+        return IsLocal();
     }
 #endif
 
@@ -409,7 +421,29 @@ private:
     void    Copy(size_t buffer_length, size_t offset = 0);
     // Aligns data at given offset
     void    Align(size_t offset);
+    // Copies the other string's local buffer, which is never shared
+    void    CopyLocal(const String &str);
 
+    // Tells if the string data is kept in the local buffer
+    inline bool IsLocal() const
+    {
+        return (_cstr >= _local) && (_cstr < _local + sizeof(_local));
+    }
+    // Tells if this object owns a string buffer, either local or allocated
+    inline bool HasBuffer() const
+    {
+        return IsLocal() || _bufHead;
+    }
+    // Gets the beginning of the owned string buffer
+    inline char *GetBufferHead()
+    {
+        return IsLocal() ? _local : _buf + sizeof(BufHeader);
+    }
+    // Gets the capacity of the owned string buffer
+    inline size_t GetBufferCapacity() const
+    {
+        return IsLocal() ? LocalCapacity : _bufHead->Capacity;
+    }
     // Tells if this object shares its string buffer with others
     bool    IsShared() const;
     // Ensure this string is a writeable independent copy, with ref counter = 1
@@ -429,11 +463,13 @@ private:
         size_t  Capacity = 0; // available space, in characters
     };
 
-    // Union that groups mutually exclusive data (currently only ref counted buffer)
+    // Union that groups mutually exclusive data: either the ref counted
+    // buffer, or the local buffer, which is in use if the c-str points into it
     union
     {
         char      *_buf;     // reference-counted data (raw ptr)
         BufHeader *_bufHead; // the header of a reference-counted data
+        char      _local[LocalCapacity + 1]; // short string data
     };
 };
 
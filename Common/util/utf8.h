@@ -23,6 +23,14 @@
 #include <cstring>
 #include "core/types.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define AGS_UTF8_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AGS_UTF8_NEON 1
+#include <arm_neon.h>
+#endif
+
 namespace Utf8
 {
 
@@ -97,12 +105,57 @@ inline size_t SetChar(Rune u, char *c, size_t clen)
     return len;
 }
 
+// Returns the number of leading ASCII chars (below 0x80) among the first
+// clen bytes of the buffer; ASCII chars are always 1 byte long, so the
+// text may be skipped over by this amount without decoding it
+inline size_t AsciiPrefixLength(const char *c, size_t clen)
+{
+    size_t i = 0;
+#if AGS_UTF8_SSE2
+    for (; i + 16 <= clen; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i));
+        if (_mm_movemask_epi8(v) != 0)
+            break; // the exact position is found below
+    }
+#elif AGS_UTF8_NEON
+    for (; i + 16 <= clen; i += 16)
+    {
+        const uint8x16_t v = vandq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(c + i)), vdupq_n_u8(0x80));
+        const uint64x2_t v64 = vreinterpretq_u64_u8(v);
+        if ((vgetq_lane_u64(v64, 0) | vgetq_lane_u64(v64, 1)) != 0)
+            break;
+    }
+#else
+    for (; i + 8 <= clen; i += 8)
+    {
+        uint64_t v;
+        memcpy(&v, c + i, sizeof(v));
+        if ((v & 0x8080808080808080ULL) != 0)
+            break;
+    }
+#endif
+    for (; i < clen && (static_cast<unsigned char>(c[i]) & 0x80) == 0; ++i);
+    return i;
+}
+
 // Calculates utf8 string length in characters
 inline size_t GetLength(const char *c)
 {
+    const char *end = c + strlen(c);
     size_t len = 0;
     Rune r;
-    for (size_t chr_sz = 0; (chr_sz = GetChar(c, UtfSz, &r)) > 0; c += chr_sz, ++len);
+    for (;;)
+    {
+        const size_t ascii = AsciiPrefixLength(c, end - c);
+        c += ascii;
+        len += ascii;
+        const size_t chr_sz = GetChar(c, UtfSz, &r);
+        if (chr_sz == 0)
+            break;
+        c += chr_sz;
+        ++len;
+    }
     return len;
 }
 
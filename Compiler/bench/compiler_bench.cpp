@@ -0,0 +1,361 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Compiler benchmark: measures the speed of preprocessing, tokenizing,
+// compiling and optimizing of the large script inputs, and prints the
+// best time of several runs for each phase.
+//
+// Usage: compiler_bench [--iterations N] [--lines N] [<header.ash>]
+//
+// The inputs are the standard AGS script header (agsdefns.sh by default,
+// or the header given in the command line) and a generated script module
+// of the requested length.
+//
+// NOTE: the script compiler parses the tokens and generates the code in
+// a single pass, so the "compile" phase includes both, and also tokenizing
+// of the input once again; "tokenize" phase shows the tokenizer's share.
+//
+//=============================================================================
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "core/def_version.h"
+#include "preproc/preprocessor.h"
+#include "script/cc_common.h"
+#include "script/cc_internallist.h"
+#include "script/cs_compiler.h"
+#include "script/cs_optimizer.h"
+#include "script/cs_parser.h"
+#include "script/cc_symboltable.h"
+#include "util/file.h"
+#include "util/stream.h"
+#include "util/string.h"
+
+using namespace AGS::Common;
+
+extern int cc_tokenize(const char *inpl, ccInternalList *targ, ccCompiledScript *scrip);
+
+#ifndef AGS_BENCH_DEFAULT_HEADER
+#define AGS_BENCH_DEFAULT_HEADER "agsdefns.sh"
+#endif
+
+// Reimplementation of project-dependent functions from Common
+String cc_format_error(const String &message)
+{
+    if (currentline > 0)
+        return String::FromFormat("Error (line %d): %s", currentline, message.GetCStr());
+    return String::FromFormat("Error (line unknown): %s", message.GetCStr());
+}
+
+String cc_get_callstack(int max_lines)
+{
+    return "";
+}
+
+
+typedef std::chrono::steady_clock BenchClock;
+
+struct BenchInput
+{
+    String Name;
+    String Text;  // source text, before preprocessing
+    String Preprocessed;
+    size_t Lines = 0u;
+    size_t Tokens = 0u;
+};
+
+struct PhaseResult
+{
+    double BestSec = -1.0;
+
+    void Add(BenchClock::duration d)
+    {
+        const double sec = std::chrono::duration<double>(d).count();
+        if (BestSec < 0.0 || sec < BestSec)
+            BestSec = sec;
+    }
+};
+
+static size_t CountLines(const String &text)
+{
+    size_t lines = 1u;
+    for (const char *p = text.GetCStr(); *p; ++p)
+        if (*p == '\n') lines++;
+    return lines;
+}
+
+// Counts the real tokens in the tokenized script, skipping meta tags
+static size_t CountTokens(const ccInternalList &targ)
+{
+    size_t tokens = 0u;
+    for (int i = 0; i < targ.length; ++i)
+    {
+        if (targ.script[i] == SCODE_META)
+            i += 2; // skip the meta type and param
+        else
+            tokens++;
+    }
+    return tokens;
+}
+
+static void SetupPreprocessor(AGS::Preprocessor::Preprocessor &pp)
+{
+    // Same macros as agscc defines with its default options
+    pp.SetAppVersion(ACI_VERSION_STR);
+    pp.DefineMacro("AGS_NEW_STRINGS", "1");
+    pp.DefineMacro("AGS_SUPPORTS_IFVER", "1");
+    pp.DefineMacro("STRICT", "1");
+    pp.DefineMacro("LRPRECEDENCE", "1");
+    pp.DefineMacro("STRICT_STRINGS", "1");
+    pp.DefineMacro("STRICT_AUDIO", "1");
+    pp.DefineMacro("NEW_DIALOGOPTS_API", "1");
+    const char *script_apis[] = { "v321", "v330", "v334", "v335", "v340", "v341",
+        "v350", "v3507", "v351", "v360" };
+    for (const char *api : script_apis)
+        pp.DefineMacro(String::FromFormat("SCRIPT_API_%s", api), "1");
+}
+
+static void SetupCompiler()
+{
+    ccSetSoftwareVersion(ACI_VERSION_STR);
+    ccSetOption(SCOPT_EXPORTALL, 1);
+    ccSetOption(SCOPT_LINENUMBERS, 1);
+    ccSetOption(SCOPT_LEFTTORIGHT, 1);
+    ccSetOption(SCOPT_OLDSTRINGS, 0);
+}
+
+// Template of the generated script block, '@' is replaced by the block number
+static const char *ModuleBlock =
+    "// Generated block @\n"
+    "struct Item@\n"
+    "{\n"
+    "  int id;\n"
+    "  int weight;\n"
+    "  float scale;\n"
+    "  import int Total(int bonus);\n"
+    "};\n"
+    "\n"
+    "int Item@::Total(int bonus)\n"
+    "{\n"
+    "  return this.id + this.weight * 2 + bonus;\n"
+    "}\n"
+    "\n"
+    "int counts@[20];\n"
+    "Item@ items@[8];\n"
+    "\n"
+    "int Process@(int seed)\n"
+    "{\n"
+    "  int total = 0;\n"
+    "  for (int i = 0; i < 20; i++)\n"
+    "  {\n"
+    "    counts@[i] = seed * i + @;\n"
+    "    if (counts@[i] > 100)\n"
+    "      total += counts@[i] % 7;\n"
+    "    else\n"
+    "      total -= i;\n"
+    "  }\n"
+    "  int k = 0;\n"
+    "  while (k < 8)\n"
+    "  {\n"
+    "    items@[k].id = k;\n"
+    "    items@[k].weight = total / (k + 1);\n"
+    "    items@[k].scale = 0.5 * 2.0;\n"
+    "    total += items@[k].Total(seed - k);\n"
+    "    k++;\n"
+    "  }\n"
+    "  int grid = 0;\n"
+    "  for (int y = 0; y < 4; y++)\n"
+    "  {\n"
+    "    for (int x = 0; x < 5; x++)\n"
+    "    {\n"
+    "      grid += counts@[y * 5 + x] * (x - y);\n"
+    "    }\n"
+    "  }\n"
+    "  if (grid > total)\n"
+    "    total = grid;\n"
+    "  else if (grid == total)\n"
+    "    total += 1;\n"
+    "  else if (grid < 0)\n"
+    "    total = -grid;\n"
+    "  else\n"
+    "    total -= grid / 3;\n"
+    "  float sum = 0.0;\n"
+    "  for (int j = 0; j < 8; j += 2)\n"
+    "  {\n"
+    "    sum += items@[j].scale;\n"
+    "    items@[j + 1].weight += items@[j].weight;\n"
+    "  }\n"
+    "  if (sum > 4.0)\n"
+    "    total++;\n"
+    "  if (total > 1000 && seed != 0 || total < -1000)\n"
+    "    return (total << 1) ^ (seed & 0xFF);\n"
+    "  return total;\n"
+    "}\n"
+    "\n";
+
+// Generates a script module with the given number of lines, made of
+// the typical constructs: structs with member functions, global arrays,
+// loops, conditions and arithmetic expressions
+static String GenerateModule(size_t lines)
+{
+    const std::string block_template = ModuleBlock;
+    const size_t block_lines = CountLines(ModuleBlock) - 1;
+    std::string text;
+    for (int n = 0; n * block_lines < lines; ++n)
+    {
+        const std::string num = std::to_string(n);
+        for (char c : block_template)
+        {
+            if (c == '@')
+                text.append(num);
+            else
+                text.push_back(c);
+        }
+    }
+    return text.c_str();
+}
+
+static bool PrintError(const char *phase, const BenchInput &input)
+{
+    if (!cc_has_error())
+        return false;
+    fprintf(stderr, "%s failed for %s: %s\n", phase, input.Name.GetCStr(),
+        cc_get_error().ErrorString.GetCStr());
+    return true;
+}
+
+static void PrintResult(const BenchInput &input, const char *phase, const PhaseResult &res, bool has_tokens)
+{
+    const double sec = res.BestSec > 0.0 ? res.BestSec : 1e-9;
+    if (has_tokens)
+        printf("%-14s %-12s %10.3f %14.0f %14.0f\n", input.Name.GetCStr(), phase,
+            res.BestSec * 1000.0, input.Lines / sec, input.Tokens / sec);
+    else
+        printf("%-14s %-12s %10.3f %14.0f %14s\n", input.Name.GetCStr(), phase,
+            res.BestSec * 1000.0, input.Lines / sec, "-");
+}
+
+static bool RunBenchmark(BenchInput &input, int iterations)
+{
+    PhaseResult preprocess, tokenize, compile, optimize;
+    for (int iter = 0; iter < iterations; ++iter)
+    {
+        // Preprocessing
+        {
+            cc_clear_error();
+            AGS::Preprocessor::Preprocessor pp;
+            SetupPreprocessor(pp);
+            const auto start = BenchClock::now();
+            input.Preprocessed = pp.Preprocess(input.Text, input.Name);
+            preprocess.Add(BenchClock::now() - start);
+            if (PrintError("Preprocessing", input))
+                return false;
+        }
+
+        // Tokenizing alone
+        {
+            cc_clear_error();
+            ccCompiledScript scrip;
+            scrip.init();
+            sym.reset();
+            ccInternalList targ;
+            const auto start = BenchClock::now();
+            cc_tokenize(input.Preprocessed.GetCStr(), &targ, &scrip);
+            tokenize.Add(BenchClock::now() - start);
+            if (PrintError("Tokenizing", input))
+                return false;
+            input.Tokens = CountTokens(targ);
+            scrip.shutdown();
+        }
+
+        // Full compilation, and optimization of its result
+        {
+            cc_clear_error();
+            ccCompiledScript scrip;
+            scrip.init();
+            sym.reset();
+            scrip.start_new_section(input.Name.GetCStr());
+            auto start = BenchClock::now();
+            cc_compile(input.Preprocessed.GetCStr(), &scrip);
+            compile.Add(BenchClock::now() - start);
+            if (PrintError("Compiling", input))
+                return false;
+            start = BenchClock::now();
+            ccOptimizeCompiledScript(&scrip, 2);
+            optimize.Add(BenchClock::now() - start);
+            scrip.shutdown();
+        }
+    }
+
+    PrintResult(input, "preprocess", preprocess, false);
+    PrintResult(input, "tokenize", tokenize, true);
+    PrintResult(input, "compile", compile, true);
+    PrintResult(input, "optimize", optimize, false);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = 5;
+    size_t lines = 50000u;
+    String header_path = AGS_BENCH_DEFAULT_HEADER;
+    for (int i = 1; i < argc; ++i)
+    {
+        if ((strcmp(argv[i], "--iterations") == 0) && (i + 1 < argc))
+            iterations = std::max(1, atoi(argv[++i]));
+        else if ((strcmp(argv[i], "--lines") == 0) && (i + 1 < argc))
+            lines = static_cast<size_t>(std::max(1, atoi(argv[++i])));
+        else if (argv[i][0] == '-')
+        {
+            printf("Usage: compiler_bench [--iterations N] [--lines N] [<header.ash>]\n");
+            return 1;
+        }
+        else
+            header_path = argv[i];
+    }
+
+    SetupCompiler();
+
+    std::vector<BenchInput> inputs;
+    auto in = File::OpenFileRead(header_path);
+    if (!in)
+    {
+        fprintf(stderr, "Failed to open the header: %s\n", header_path.GetCStr());
+        return 1;
+    }
+    BenchInput header;
+    header.Name = "agsdefns.sh";
+    header.Text = String::FromStream(in.get());
+    header.Lines = CountLines(header.Text);
+    inputs.push_back(header);
+
+    BenchInput module;
+    module.Name = "generated.asc";
+    module.Text = GenerateModule(lines);
+    module.Lines = CountLines(module.Text);
+    inputs.push_back(module);
+
+    printf("Best of %d runs\n", iterations);
+    printf("%-14s %-12s %10s %14s %14s\n", "input", "phase", "time (ms)", "lines/s", "tokens/s");
+    for (auto &input : inputs)
+    {
+        if (!RunBenchmark(input, iterations))
+            return 1;
+    }
+    return 0;
+}
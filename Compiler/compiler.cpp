@@ -11,13 +11,18 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
-#include <utility>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
 
 #include "compiler.h"
 #include "script/cs_compiler.h"
 #include "script/cc_common.h"
 #include "script/cc_internal.h"
+#include "util/directory.h"
 #include "util/filestream.h"
 #include "util/file.h"
 #include "util/path.h"
@@ -65,10 +70,19 @@ std::vector<const char *> GetScriptAPIs()
 
 void CompilerOptions::PrintToStdout() const {
     printf("\n--- Compiler Settings ---\n");
-    printf("Input: %s\n", InputScriptFile.c_str());
+    printf("Input:");
+    bool comma = false;
+    for (const auto& input : InputScriptFiles)
+    {
+        if (comma) printf(", ");
+        printf("%s", input.c_str());
+        comma = true;
+    }
+    printf("\n");
     printf("Output: %s\n", OutputObjFile.c_str());
+    printf("Jobs: %d\n", Jobs);
     printf("Headers:");
-    bool comma = false;
+    comma = false;
     for (const auto& header : HeaderFiles)
     {
         if (comma) printf(", ");
@@ -84,6 +98,8 @@ void CompilerOptions::PrintToStdout() const {
         comma = true;
     }
     printf("\nVersion: %s\n", Version.c_str());
+    if (!CacheDir.empty()) printf("Cache: %s\n", CacheDir.c_str());
+    if (OptimizationLevel > 0) printf("Optimization level: %d\n", OptimizationLevel);
     printf("ScriptAPIVersion: %s\n", ScriptAPI.ScriptAPIVersion.c_str());
     printf("ScriptCompatLevel: %s\n", ScriptAPI.ScriptCompatLevel.c_str());
     printf("Flags: ");
@@ -102,10 +118,9 @@ void CompilerOptions::PrintToStdout() const {
 }
 
 
-int Compile(const CompilerOptions& comp_opts)
+// Configures macros for the preprocessor
+static void SetupPreprocessor(AGS::Preprocessor::Preprocessor &pp, const CompilerOptions& comp_opts)
 {
-    comp_opts.PrintToStdout();
-    AGS::Preprocessor::Preprocessor pp = AGS::Preprocessor::Preprocessor();
     std::vector<std::string> scriptAPIVersionMacros;
     std::vector<std::string> scriptCompatLevelMacros;
 
@@ -115,9 +130,6 @@ int Compile(const CompilerOptions& comp_opts)
         scriptCompatLevelMacros.emplace_back(std::string(PREFIX_SCRIPT_COMPAT) + ScriptAPIs[i]);
     }
 
-    //-----------------------------------------------------------------------//
-    // Configure macros
-    //-----------------------------------------------------------------------//
     pp.DefineMacro("AGS_NEW_STRINGS", "1");
     pp.DefineMacro("AGS_SUPPORTS_IFVER", "1");
 
@@ -167,6 +179,108 @@ int Compile(const CompilerOptions& comp_opts)
     {
         pp.DefineMacro(macro.first.c_str(), macro.second.c_str());
     }
+}
+
+// Serializes the console output of the compilation jobs
+static std::mutex OutputMutex;
+
+static void PrintError(const std::string &message)
+{
+    std::lock_guard<std::mutex> lk(OutputMutex);
+    std::cerr << message << std::endl;
+}
+
+// Preprocesses and compiles a single script, and writes the script object.
+// This may run on a worker thread: the headers are only read here, and
+// the rest of the compilation state is confined to the thread.
+static int CompileScript(const CompilerOptions& comp_opts, const std::string &input_file,
+    const std::string &output_file, const std::vector<std::pair<String, String>> &heads)
+{
+    if (input_file.empty())
+    {
+        PrintError("Error: empty script filename.");
+        return -1;
+    }
+
+    const char *src = input_file.c_str();
+    std::unique_ptr<Stream> in (File::OpenFileRead(src));
+    if (!in)
+    {
+        PrintError(std::string("Error: failed to open script for reading: ") + src);
+        return -1;
+    }
+    TextStreamReader sr(std::move(in));
+    String script_input = sr.ReadAll();
+
+    //-----------------------------------------------------------------------//
+    // Preprocess headers, for the macros that they define
+    //-----------------------------------------------------------------------//
+    // Strings are not safe to share between threads, so make own copies
+    AGS::Preprocessor::Preprocessor pp = AGS::Preprocessor::Preprocessor();
+    SetupPreprocessor(pp, comp_opts);
+    for(const auto& head: heads)
+    {
+        pp.Preprocess(String(head.first.GetCStr()), String(head.second.GetCStr()));
+    }
+
+    //-----------------------------------------------------------------------//
+    // Preprocess script
+    //-----------------------------------------------------------------------//
+    String script_pp = nullptr;
+    String filename = Path::GetFilename(input_file.c_str());
+    String script_name = Path::RemoveExtension(filename);
+
+    script_pp = pp.Preprocess(script_input,script_name);
+    if ((script_pp == nullptr) || (cc_has_error()))
+    {
+        const auto &error = cc_get_error();
+        PrintError(String::FromFormat("Error: preprocessor failed at %s, line %d : %s",
+            script_name.GetCStr(), error.Line, error.ErrorString.GetCStr()).GetCStr());
+        return -1;
+    }
+
+    if(comp_opts.PreprocessOnly)
+    {
+        std::unique_ptr<Stream> out (File::CreateFile(output_file.c_str()));
+        if (!out || !(out->CanWrite())) {
+            PrintError("Error: failed to open for writing: " + output_file);
+            return -1;
+        }
+        script_pp.Write(out.get());
+        return 0;
+    }
+
+    //-----------------------------------------------------------------------//
+    // Compile script
+    //-----------------------------------------------------------------------//
+    std::unique_ptr<ccScript> script(ccCompileText(script_pp.GetCStr(), script_name.GetCStr()));
+    if ((script == nullptr) || (cc_has_error()))
+    {
+        const auto &error = cc_get_error();
+        PrintError(String::FromFormat("Error: compile failed at %s, line %d : %s",
+            ccCurScriptName, error.Line, error.ErrorString.GetCStr()).GetCStr());
+        return -1;
+    }
+
+    //-----------------------------------------------------------------------//
+    // Write script object
+    //-----------------------------------------------------------------------//
+    if(!output_file.empty())
+    {
+        std::unique_ptr<Stream> out (File::CreateFile(output_file.c_str()));
+        if (!out || !(out->CanWrite())) {
+            PrintError("Error: failed to open for writing: " + output_file);
+            return -1;
+        }
+        script->Write(out.get());
+    }
+
+    return 0;
+}
+
+int Compile(const CompilerOptions& comp_opts)
+{
+    comp_opts.PrintToStdout();
 
     //-----------------------------------------------------------------------//
     // Configure compiler
@@ -183,10 +297,19 @@ int Compile(const CompilerOptions& comp_opts)
     ccSetOption(SCOPT_LEFTTORIGHT, comp_opts.Flags.LeftToRightPrecedence);
     ccSetOption(SCOPT_OLDSTRINGS, !comp_opts.Flags.EnforceNewStrings);
 
+    ccSetOptimizationLevel(comp_opts.OptimizationLevel);
+
     ccRemoveDefaultHeaders();
 
+    if (!comp_opts.CacheDir.empty() && !Directory::CreateDirectory(comp_opts.CacheDir.c_str()))
+    {
+        std::cerr << "Error: failed to create cache directory: " << comp_opts.CacheDir << std::endl;
+        return -1;
+    }
+    ccSetCompileCacheDir(comp_opts.CacheDir.c_str());
+
     //-----------------------------------------------------------------------//
-    // Read input files
+    // Read header files
     //-----------------------------------------------------------------------//
     std::vector<std::pair<String, String>> heads;
     for(const auto& header: comp_opts.HeaderFiles)
@@ -211,29 +334,13 @@ int Compile(const CompilerOptions& comp_opts)
         heads.emplace_back(sr.ReadAll(), headername);
     }
 
-    String script_input;
-    const char* src = nullptr;
-
-    if (comp_opts.InputScriptFile.empty())
-    {
-        std::cerr << "Error: empty script filename." << std::endl;
-        return -1;
-    }
-
-    src = comp_opts.InputScriptFile.c_str();
-    std::unique_ptr<Stream> in (File::OpenFileRead(src));
-    if (!in)
-    {
-        std::cerr << "Error: failed to open script for reading: " << src << std::endl;
-        return -1;
-    }
-    TextStreamReader sr(std::move(in));
-    script_input = sr.ReadAll();
-
     //-----------------------------------------------------------------------//
     // Preprocess headers and set them for use when compiling
     //-----------------------------------------------------------------------//
+    AGS::Preprocessor::Preprocessor pp = AGS::Preprocessor::Preprocessor();
+    SetupPreprocessor(pp, comp_opts);
     std::vector<std::pair<String, String>> preprocessed_heads;
+    preprocessed_heads.reserve(heads.size()); // header pointers must stay valid
     for(const auto& head: heads)
     {
         String preprocessed_header = pp.Preprocess(head.first,head.second);
@@ -241,58 +348,46 @@ int Compile(const CompilerOptions& comp_opts)
 
         ccAddDefaultHeader((char *) preprocessed_heads.back().first.GetCStr(), (char *) preprocessed_heads.back().second.GetCStr());
     }
-    heads.clear();
 
     //-----------------------------------------------------------------------//
-    // Preprocess script
+    // Compile scripts, running up to the given number of jobs in parallel
     //-----------------------------------------------------------------------//
-    String script_pp = nullptr;
-    String filename = Path::GetFilename(comp_opts.InputScriptFile.c_str());
-    String script_name = Path::RemoveExtension(filename);
-
-    script_pp = pp.Preprocess(script_input,script_name);
-    if ((script_pp == nullptr) || (cc_has_error()))
+    const size_t num_scripts = comp_opts.InputScriptFiles.size();
+    std::vector<std::string> output_files(num_scripts);
+    for (size_t i = 0; i < num_scripts; ++i)
     {
-        const auto &error = cc_get_error();
-        std::cerr << "Error: preprocessor failed at " << script_name.GetCStr() <<
-            ", line " << error.Line << " : " << error.ErrorString.GetCStr() << std::endl;
-        return -1;
+        if ((num_scripts == 1) && !comp_opts.OutputObjFile.empty())
+            output_files[i] = comp_opts.OutputObjFile;
+        else // no output file explicitly set, let's use input.o instead
+            output_files[i] = std::string(Path::RemoveExtension(comp_opts.InputScriptFiles[i].c_str()).GetCStr()) + ".o";
     }
 
-    if(comp_opts.PreprocessOnly)
+    const size_t num_jobs = std::min<size_t>(std::max(comp_opts.Jobs, 1), num_scripts);
+    if (num_jobs <= 1)
     {
-        std::unique_ptr<Stream> out (File::CreateFile(comp_opts.OutputObjFile.c_str()));
-        if (!out || !(out->CanWrite())) {
-            std::cerr << "Error: failed to open for writing: " << comp_opts.OutputObjFile << std::endl;
-            return -1;
+        for (size_t i = 0; i < num_scripts; ++i)
+        {
+            if (CompileScript(comp_opts, comp_opts.InputScriptFiles[i], output_files[i], heads) != 0)
+                return -1;
         }
-        script_pp.Write(out.get());
         return 0;
     }
 
-    //-----------------------------------------------------------------------//
-    // Compile script
-    //-----------------------------------------------------------------------//
-    ccScript* script = ccCompileText(script_pp.GetCStr(), script_name.GetCStr());
-    if ((script == nullptr) || (cc_has_error()))
-    {
-        const auto &error = cc_get_error();
-        std::cerr << "Error: compile failed at " << ccCurScriptName << ", line " << error.Line << " : " << error.ErrorString.GetCStr() << std::endl;
-        return -1;
-    }
-
-    //-----------------------------------------------------------------------//
-    // Write script object
-    //-----------------------------------------------------------------------//
-    if(!comp_opts.OutputObjFile.empty())
+    std::atomic<size_t> next_script(0);
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> jobs;
+    for (size_t j = 0; j < num_jobs; ++j)
     {
-        std::unique_ptr<Stream> out (File::CreateFile(comp_opts.OutputObjFile.c_str()));
-        if (!out || !(out->CanWrite())) {
-            std::cerr << "Error: failed to open for writing: " << comp_opts.OutputObjFile << std::endl;
-            return -1;
-        }
-        script->Write(out.get());
+        jobs.emplace_back([&]()
+        {
+            for (size_t i = next_script++; (i < num_scripts) && !failed; i = next_script++)
+            {
+                if (CompileScript(comp_opts, comp_opts.InputScriptFiles[i], output_files[i], heads) != 0)
+                    failed = true;
+            }
+        });
     }
-
-    return 0;
-}
\ No newline at end of file
+    for (auto &job : jobs)
+        job.join();
+    return failed ? -1 : 0;
+}
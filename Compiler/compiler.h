@@ -52,8 +52,11 @@ public:
     bool DebugMode = false; // build for debug
     std::vector<std::pair<std::string, std::string>> Macros{};
     std::vector<std::string> HeaderFiles{};
-    std::string InputScriptFile{};
-    std::string OutputObjFile{};
+    std::vector<std::string> InputScriptFiles{};
+    std::string OutputObjFile{}; // only used when compiling a single script
+    int Jobs = 1; // number of scripts to compile in parallel
+    int OptimizationLevel = 0; // compiled code optimization level
+    std::string CacheDir{}; // directory for caching compiled scripts
     std::string Version{};
     CompilerOptions() = default;
     ~CompilerOptions() = default;
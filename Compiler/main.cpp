@@ -18,13 +18,14 @@
 #include <map>
 #include "util/path.h"
 #include "util/cmdlineopts.h"
+#include "util/string_utils.h"
 #include "compiler.h"
 #include "core/def_version.h"
 
 using namespace AGS::Common;
 using namespace AGS::Common::CmdLineOpts;
 
-const char *HELP_STRING = R"EOS(Usage: agscc [options] <INPUT.asc>
+const char *HELP_STRING = R"EOS(Usage: agscc [options] <INPUT.asc> [<INPUT2.asc>...]
 -A <version>                 Script API Version               (default:Highest)
 -C <version>                 Script API Compatibility version (default:Highest)
 -H, --Headers <H1>[:<H2>...] Header Files in order  (; as separator in cmd.exe)
@@ -42,9 +43,14 @@ const char *HELP_STRING = R"EOS(Usage: agscc [options] <INPUT.asc>
 -fforcenewaudio[=0]          Enforce new audio system               (default:1)
 -foldcustomdialogopt[=0]     Use old custom dialog API
 -g                           Generate debug information
+-j <N>                       Compile up to N scripts in parallel    (default:1)
+-O<level>                    Optimize compiled code, level 0-2      (default:0)
 --tell-api-versions          Returns supported Script API Versions
 -o <OUT.o>, --output <OUT.o> Place output in specified file.  (default:INPUT.o)
+                             Only allowed when compiling one script
 --override-version <VERSION> Overrides editor version
+--cache-dir <DIR>            Reuse unchanged scripts compiled earlier,
+                             keeping the compiled scripts in DIR
 -h, --help                   Print this usage message
 )EOS";
 
@@ -173,6 +179,32 @@ ParsedOptions parser_to_compiler_opts(const ParseResult& parseResult)
             continue;
         }
 
+        if(opt_with_value.first == "-j")
+        {
+            compilerOptions.Jobs = StrUtil::StringToInt(opt_with_value.second, 0);
+            if (compilerOptions.Jobs < 1) {
+                std::cerr << "Error: invalid number of jobs " << opt_with_value.second.GetCStr() << std::endl;
+                return ParsedOptions(-1);
+            }
+            continue;
+        }
+
+        if(opt_with_value.first == "-O")
+        {
+            compilerOptions.OptimizationLevel = StrUtil::StringToInt(opt_with_value.second, -1);
+            if (compilerOptions.OptimizationLevel < 0 || compilerOptions.OptimizationLevel > 2) {
+                std::cerr << "Error: invalid optimization level " << opt_with_value.second.GetCStr() << std::endl;
+                return ParsedOptions(-1);
+            }
+            continue;
+        }
+
+        if(opt_with_value.first == "--cache-dir")
+        {
+            compilerOptions.CacheDir = opt_with_value.second.GetCStr();
+            continue;
+        }
+
         if(opt_with_value.first == "--override-version")
         {
             compilerOptions.Version = opt_with_value.second.GetCStr();
@@ -239,11 +271,19 @@ ParsedOptions parser_to_compiler_opts(const ParseResult& parseResult)
         }
     }
 
-    compilerOptions.InputScriptFile = parseResult.PosArgs[0].GetCStr();
+    for(const auto& pos_arg : parseResult.PosArgs)
+    {
+        compilerOptions.InputScriptFiles.push_back(pos_arg.GetCStr());
+    }
+
+    if((compilerOptions.InputScriptFiles.size() > 1) && !compilerOptions.OutputObjFile.empty()) {
+        std::cerr << "Error: cannot specify output file when compiling multiple scripts" << std::endl;
+        return ParsedOptions(-1);
+    }
 
-    if(compilerOptions.OutputObjFile.empty()) {
+    if((compilerOptions.InputScriptFiles.size() == 1) && compilerOptions.OutputObjFile.empty()) {
         // no output file explicitly set, let's use input.o instead
-        std::string filename = Path::RemoveExtension(compilerOptions.InputScriptFile.c_str()).GetCStr();
+        std::string filename = Path::RemoveExtension(compilerOptions.InputScriptFiles[0].c_str()).GetCStr();
         compilerOptions.OutputObjFile = filename + ".o";
     }
 
@@ -265,7 +305,7 @@ Copyright (c) 2021 AGS Team and contributors
 )EOS"
     );
 
-    ParseResult parseResult = Parse(argc,argv,{"-D", "-H", "--Headers", "-A", "-C", "-f"});
+    ParseResult parseResult = Parse(argc,argv,{"-D", "-H", "--Headers", "-A", "-C", "-f", "-j", "-O", "-o", "--output", "--override-version", "--cache-dir"});
     ParsedOptions parsedOptions = parser_to_compiler_opts(parseResult);
 
     if(parsedOptions.Exit) return parsedOptions.ErrorCode;
@@ -22,7 +22,7 @@
 
 using namespace AGS::Common;
 
-extern int currentline; // in script/script_common
+extern thread_local int currentline; // in script/script_common
 
 namespace AGS {
 namespace Preprocessor {
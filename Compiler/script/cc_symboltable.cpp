@@ -63,9 +63,6 @@ int SymbolTableEntry::get_propset() {
 }
 
 void symbolTable::reset() {
-	for (std::map<int, char*>::iterator it = nameGenCache.begin(); it != nameGenCache.end(); ++it) {
-		free(it->second);
-	}
 	nameGenCache.clear();
 
 	entries.clear();
@@ -206,18 +203,15 @@ std::string symbolTable::get_name_string(int idx) {
 }
 
 const char *symbolTable::get_name(int idx) {
-	if (nameGenCache.count(idx) > 0) {
-		return nameGenCache[idx];
+	auto it = nameGenCache.find(idx);
+	if (it != nameGenCache.end()) {
+		return it->second.c_str();
 	}
 
 	int actualIdx = idx & STYPE_MASK;
 	if (actualIdx < 0 || (size_t)actualIdx >= entries.size()) { return NULL; }
 
-	std::string resultString = get_name_string(idx);
-	char *result = (char *)malloc(resultString.length() + 1);
-	strcpy(result, resultString.c_str());
-	nameGenCache[idx] = result;
-	return result;
+	return nameGenCache.insert(std::make_pair(idx, get_name_string(idx))).first->second.c_str();
 }
 
 int symbolTable::add(const char*nta) {
@@ -256,4 +250,4 @@ int symbolTable::add_operator(const char *nta, int priority, int vcpucmd) {
     return nss;
 }
 
-symbolTable sym;
+thread_local symbolTable sym;
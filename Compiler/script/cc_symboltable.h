@@ -18,8 +18,8 @@
 #include "script/cc_treemap.h"
 
 #include <cstdint>
-#include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 // So there's another symbol definition in cc_symboldef.h
@@ -79,16 +79,17 @@ struct symbolTable {
 
 private:
 
-    std::map<int, char *> nameGenCache;
+    // generated names of the symbol types, which may include flags;
+    // the strings are stored in the map nodes, so their pointers are kept valid
+    std::unordered_map<int, std::string> nameGenCache;
 
     ccTreeMap symbolTree;
-    std::vector<char *> symbolTreeNames;
 
     int  add_operator(const char*, int priority, int vcpucmd); // adds new operator
     std::string get_name_string(int idx);
 };
 
 
-extern symbolTable sym;
+extern thread_local symbolTable sym;
 
 #endif //__CC_SYMBOLTABLE_H
@@ -12,26 +12,44 @@
 //
 //=============================================================================
 #include <cstring>
+#include <stdint.h>
+#include <stdlib.h>
 #include "cc_treemap.h"
 
-int ccTreeMap::findValue(const char *key) {
-	if (!key || strlen(key) <= 0) { return -1; }
-    std::string cppkey(key);
-    if (this->storage.count(cppkey) <= 0) { return -1; }
-    return this->storage[cppkey];
+size_t ccTreeMap::KeyHash::operator()(const char *key) const {
+    // FNV-1a
+    uint32_t hash = 2166136261U;
+    for (; *key; ++key)
+        hash = (hash ^ static_cast<uint8_t>(*key)) * 16777619U;
+    return hash;
+}
+
+int ccTreeMap::findValue(const char *key) const {
+    if (!key || !key[0]) { return -1; }
+    auto it = this->storage.find(key);
+    if (it == this->storage.end()) { return -1; }
+    return it->second;
 }
 
 void ccTreeMap::addEntry(const char* ntx, int p_value) {
-    // don't add if it's an empty string or if it's already here
-    if (!ntx || strlen(ntx) <= 0) { return; }
+    // don't add if it's an empty string
+    if (!ntx || !ntx[0]) { return; }
 
-    this->storage[std::string(ntx)] = p_value;
+    auto it = this->storage.find(ntx);
+    if (it != this->storage.end()) {
+        it->second = p_value;
+        return;
+    }
+    this->storage.insert(std::make_pair(strdup(ntx), p_value));
 }
 
 void ccTreeMap::clear() {
+    for (auto &entry : this->storage) {
+        free(const_cast<char*>(entry.first));
+    }
     this->storage.clear();
 }
 
 ccTreeMap::~ccTreeMap() {
-    this->storage.clear();
-}
\ No newline at end of file
+    clear();
+}
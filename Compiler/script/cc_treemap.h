@@ -18,18 +18,33 @@
 #ifndef __CC_TREEMAP_H
 #define __CC_TREEMAP_H
 
-#include <map>
-#include <string>
+#include <string.h>
+#include <unordered_map>
 
-// Mimics original interface but uses a std::map for storage
+// Mimics original interface but uses a hash table for storage.
+// The keys are copied once, when added, and are looked up by the C string
+// without making a temporary std::string.
 struct ccTreeMap {
-    int findValue(const char *key);
+    ccTreeMap() = default;
+    ccTreeMap(const ccTreeMap&) = delete;
+    ~ccTreeMap();
+
+    int findValue(const char *key) const;
     void addEntry(const char *ntx, int p_value);
     void clear();
-    ~ccTreeMap();
+
+    ccTreeMap &operator =(const ccTreeMap&) = delete;
 
 private:
-    std::map<std::string, int> storage;
+    struct KeyHash {
+        size_t operator()(const char *key) const;
+    };
+    struct KeyEqual {
+        bool operator()(const char *a, const char *b) const { return strcmp(a, b) == 0; }
+    };
+
+    // the keys are owned by the map
+    std::unordered_map<const char*, int, KeyHash, KeyEqual> storage;
 };
 
 #endif // __CC_TREEMAP_H
\ No newline at end of file
@@ -14,22 +14,145 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <memory>
+#include <string>
+#include "core/def_version.h"
 #include "script/cs_compiler.h"
 #include "script/cc_macrotable.h"
 #include "script/cc_compiledscript.h"
 #include "script/cc_symboltable.h"
 #include "script/cc_common.h"
 #include "script/cc_internal.h"
+#include "script/cs_optimizer.h"
 #include "script/cs_parser.h"
+#include "util/file.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
 
 const char *ccSoftwareVersion = "1.0";
-const char *ccCurScriptName = "";
+// The compilation state is confined to the thread, but the default headers,
+// macros and software version are shared and must be set before compiling
+thread_local const char *ccCurScriptName = "";
 
 std::vector<const char*> defaultheaders;
 std::vector<const char*> defaultHeaderNames;
 
 MacroTable predefinedMacros;
 
+int optimizationLevel = 0;
+std::string compileCacheDir;
+
+// Cached script file: signature, key hashes and input length, followed by the script
+static const char *CacheFileSig = "SCCH";
+static const int32_t CacheFileVersion = 2;
+// Version of the generated code; must be increased whenever the parser or
+// optimizer change the code they generate, so that the cached scripts
+// compiled by the older compiler are not reused
+static const int32_t CompilerCodeVersion = 1;
+
+// Two independent 64-bit hashes (FNV-1a and a multiply-xorshift one),
+// accumulated over all the compilation input; the second one is only
+// checked, to make the false match of a cached script unlikely
+struct CompileCacheKey
+{
+    uint64_t Hash = 14695981039346656037ULL;
+    uint64_t Check = 0x243F6A8885A308D3ULL;
+    uint64_t Length = 0u;
+
+    void Add(const char *data, size_t len)
+    {
+        for (size_t i = 0; i < len; ++i)
+        {
+            const uint8_t b = static_cast<uint8_t>(data[i]);
+            Hash = (Hash ^ b) * 1099511628211ULL;
+            Check = (Check + b + 1u) * 0x9E3779B97F4A7C15ULL;
+            Check ^= Check >> 29;
+        }
+        Length += len;
+    }
+
+    void Add(const char *str)
+    {
+        // include the terminator, which separates the consequent strings
+        if (str)
+            Add(str, strlen(str) + 1);
+        else
+            Add("", 1);
+    }
+};
+
+static CompileCacheKey MakeCompileCacheKey(const char *texo, const char *scriptName) {
+    CompileCacheKey key;
+    // the compiler's own identity, then the target version
+    key.Add(ACI_VERSION_STR);
+    key.Add(reinterpret_cast<const char*>(&CompilerCodeVersion), sizeof(CompilerCodeVersion));
+    key.Add(ccSoftwareVersion);
+    int options = 0;
+    for (int bit = 1; bit <= SCOPT_UTF8; bit <<= 1) {
+        if (ccGetOption(bit))
+            options |= bit;
+    }
+    key.Add(reinterpret_cast<const char*>(&options), sizeof(options));
+    key.Add(reinterpret_cast<const char*>(&optimizationLevel), sizeof(optimizationLevel));
+    for (size_t t = 0; t < defaultheaders.size(); t++) {
+        key.Add(defaultHeaderNames[t]);
+        key.Add(defaultheaders[t]);
+    }
+    key.Add(scriptName);
+    key.Add(texo);
+    return key;
+}
+
+static std::string GetCompileCachePath(const CompileCacheKey &key) {
+    char filename[32];
+    snprintf(filename, sizeof(filename), "%016llx.o", static_cast<unsigned long long>(key.Hash));
+    std::string path = compileCacheDir;
+    if (path.back() != '/' && path.back() != '\\')
+        path.push_back('/');
+    return path + filename;
+}
+
+static ccScript *ReadCachedScript(const CompileCacheKey &key) {
+    std::unique_ptr<Stream> in(File::OpenFileRead(GetCompileCachePath(key).c_str()));
+    if (!in)
+        return nullptr;
+    char sig[4];
+    if ((in->Read(sig, 4) != 4) || (memcmp(sig, CacheFileSig, 4) != 0) ||
+        (in->ReadInt32() != CacheFileVersion) ||
+        (static_cast<uint64_t>(in->ReadInt64()) != key.Hash) ||
+        (static_cast<uint64_t>(in->ReadInt64()) != key.Check) ||
+        (static_cast<uint64_t>(in->ReadInt64()) != key.Length))
+        return nullptr;
+    ccScript *script = ccScript::CreateFromStream(in.get());
+    // a broken cache file is not an error, the script will be compiled
+    cc_clear_error();
+    return script;
+}
+
+static void WriteCachedScript(const CompileCacheKey &key, ccScript *script) {
+    // Write into a temporary file first, as the same script may be compiled
+    // by several threads or processes at once
+    static thread_local int thread_tag;
+    const std::string path = GetCompileCachePath(key);
+    char tmp_suffix[40];
+    snprintf(tmp_suffix, sizeof(tmp_suffix), ".%p.tmp", static_cast<void*>(&thread_tag));
+    const std::string tmp_path = path + tmp_suffix;
+    {
+        std::unique_ptr<Stream> out(File::CreateFile(tmp_path.c_str()));
+        if (!out)
+            return;
+        out->Write(CacheFileSig, 4);
+        out->WriteInt32(CacheFileVersion);
+        out->WriteInt64(static_cast<int64_t>(key.Hash));
+        out->WriteInt64(static_cast<int64_t>(key.Check));
+        out->WriteInt64(static_cast<int64_t>(key.Length));
+        script->Write(out.get());
+    }
+    if (!File::RenameFile(tmp_path.c_str(), path.c_str()))
+        File::DeleteFile(tmp_path.c_str());
+}
+
 int ccAddDefaultHeader(const char* nhead, const char *nName)
 {
     defaultheaders.push_back(nhead);
@@ -46,17 +169,37 @@ void ccSetSoftwareVersion(const char *versionNumber) {
     ccSoftwareVersion = versionNumber;
 }
 
-ccScript* ccCompileText(const char *texo, const char *scriptName) {
-    ccCompiledScript *cctemp = new ccCompiledScript();
-    cctemp->init();
+void ccSetOptimizationLevel(int level) {
+    optimizationLevel = level;
+}
 
-    sym.reset();
+int ccGetOptimizationLevel() {
+    return optimizationLevel;
+}
+
+void ccSetCompileCacheDir(const char *dir) {
+    compileCacheDir = dir ? dir : "";
+}
 
+ccScript* ccCompileText(const char *texo, const char *scriptName) {
     if (scriptName == NULL)
         scriptName = "Main script";
 
     cc_clear_error();
 
+    CompileCacheKey cache_key;
+    if (!compileCacheDir.empty()) {
+        cache_key = MakeCompileCacheKey(texo, scriptName);
+        ccScript *cached = ReadCachedScript(cache_key);
+        if (cached)
+            return cached;
+    }
+
+    ccCompiledScript *cctemp = new ccCompiledScript();
+    cctemp->init();
+
+    sym.reset();
+
     for (size_t t=0;t<defaultheaders.size();t++) {
         if (defaultHeaderNames[t])
             ccCurScriptName = defaultHeaderNames[t];
@@ -123,6 +266,10 @@ ccScript* ccCompileText(const char *texo, const char *scriptName) {
         }
     }
 
+    ccOptimizeCompiledScript(cctemp, optimizationLevel);
+
     cctemp->free_extra();
+    if (!compileCacheDir.empty())
+        WriteCachedScript(cache_key, cctemp);
     return cctemp;
 }
@@ -36,6 +36,16 @@ extern void ccClearAllMacros();
 // set version for use with #ifversion macros
 extern void ccSetSoftwareVersion(const char *version);
 
+// set the compiled code optimization level, 0 disables optimization;
+// see cs_optimizer.h for the description of levels
+extern void ccSetOptimizationLevel(int level);
+extern int ccGetOptimizationLevel();
+
+// set the directory for caching the compiled scripts, or empty to disable caching;
+// the cached script is reused when the script, its name, all the default headers,
+// options, optimization level and software version are the same as when it was compiled
+extern void ccSetCompileCacheDir(const char *dir);
+
 // compile the script supplied, returns NULL on failure
 extern ccScript *ccCompileText(const char *script, const char *scriptName);
 
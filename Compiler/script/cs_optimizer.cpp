@@ -0,0 +1,671 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <limits.h>
+#include <vector>
+#include "script/cs_optimizer.h"
+#include "script/cc_compiledscript.h"
+#include "script/cc_internal.h"
+
+namespace
+{
+
+// Number of arguments of each instruction, matches the engine's table
+const int InstructionArgCount[CC_NUM_SCCMDS] = {
+    0, 2, 2, 2, 2, 0, 2, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 2, 1, 2, 2, 1, 2, 1, 1, 0,
+    1, 1, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 2, 2, 1, 0, 0, 1, 1, 3, 2
+};
+
+const int NoRef = -1;
+// Max number of optimization passes; normally it takes only a few
+// passes before there's nothing left to optimize
+const int MaxPasses = 16;
+// Max number of jumps followed when looking for the final jump destination
+const int MaxJumpChain = 16;
+
+struct Instruction
+{
+    int32_t Code = 0;
+    int32_t Args[3] = {};
+    int     ArgCount = 0;
+    int32_t Pos = 0; // original position in code
+    char    Fixups[3] = {}; // fixup type of each arg, FIXUP_NOFIXUP if none
+    // Index of the referenced instruction: either a jump target,
+    // or the code address written to the RefArg
+    int     Ref = NoRef;
+    int     RefArg = -1;
+    bool    Removed = false;
+};
+
+// Original fixup, refers either to the instruction's arg, or to global data
+struct FixupRef
+{
+    char    Type = FIXUP_NOFIXUP;
+    int     Instruction = NoRef;
+    int     Arg = 0;
+    int32_t DataPos = 0;
+};
+
+inline bool IsJump(int32_t code)
+{
+    return code == SCMD_JMP || code == SCMD_JZ || code == SCMD_JNZ;
+}
+
+// Tells if the register is a general purpose one, which may be freely
+// assigned without side effects
+inline bool IsGeneralReg(int32_t reg)
+{
+    return reg == SREG_AX || reg == SREG_BX || reg == SREG_CX || reg == SREG_DX;
+}
+
+// Tells if the instruction assigns a new value to the register without reading it
+inline bool OverwritesReg(const Instruction &ins, int32_t reg)
+{
+    switch (ins.Code)
+    {
+    case SCMD_LITTOREG:
+    case SCMD_POPREG:
+        return ins.Args[0] == reg;
+    case SCMD_REGTOREG:
+        return ins.Args[1] == reg && ins.Args[0] != reg;
+    default:
+        return false;
+    }
+}
+
+// Calculates the result of an operation on two integer literals,
+// using same rules as the script executor; returns false if the operation
+// cannot be folded, or should be kept for raising the runtime error
+bool FoldOperation(int32_t code, int32_t x, int32_t y, int32_t &result)
+{
+    const uint32_t ux = static_cast<uint32_t>(x);
+    const uint32_t uy = static_cast<uint32_t>(y);
+    switch (code)
+    {
+    case SCMD_ADD:
+    case SCMD_ADDREG:    result = static_cast<int32_t>(ux + uy); return true;
+    case SCMD_SUB:
+    case SCMD_SUBREG:    result = static_cast<int32_t>(ux - uy); return true;
+    case SCMD_MUL:
+    case SCMD_MULREG:    result = static_cast<int32_t>(ux * uy); return true;
+    case SCMD_DIVREG:
+        if (y == 0 || (x == INT32_MIN && y == -1))
+            return false;
+        result = x / y;
+        return true;
+    case SCMD_MODREG:
+        if (y == 0 || (x == INT32_MIN && y == -1))
+            return false;
+        result = x % y;
+        return true;
+    case SCMD_BITAND:    result = x & y; return true;
+    case SCMD_BITOR:     result = x | y; return true;
+    case SCMD_XORREG:    result = x ^ y; return true;
+    case SCMD_SHIFTLEFT:
+        if (y < 0 || y > 31)
+            return false;
+        result = static_cast<int32_t>(ux << y);
+        return true;
+    case SCMD_SHIFTRIGHT:
+        if (y < 0 || y > 31)
+            return false;
+        result = x >> y;
+        return true;
+    case SCMD_ISEQUAL:   result = (x == y) ? 1 : 0; return true;
+    case SCMD_NOTEQUAL:  result = (x != y) ? 1 : 0; return true;
+    case SCMD_GREATER:   result = (x > y) ? 1 : 0; return true;
+    case SCMD_LESSTHAN:  result = (x < y) ? 1 : 0; return true;
+    case SCMD_GTE:       result = (x >= y) ? 1 : 0; return true;
+    case SCMD_LTE:       result = (x <= y) ? 1 : 0; return true;
+    case SCMD_AND:       result = (x && y) ? 1 : 0; return true;
+    case SCMD_OR:        result = (x || y) ? 1 : 0; return true;
+    default:
+        return false;
+    }
+}
+
+
+class ScriptOptimizer
+{
+public:
+    ScriptOptimizer(ccCompiledScript *scrip, int level)
+        : _scrip(scrip), _level(level) {}
+
+    void Run()
+    {
+        if (!Decode())
+            return;
+        for (int pass = 0; pass < MaxPasses; ++pass)
+        {
+            if (!RunPass())
+                break;
+            Compact();
+        }
+        Encode();
+    }
+
+private:
+    // Reads the script code into the instruction list, resolving all the
+    // code references; returns false if the code has unexpected layout
+    bool Decode();
+    // Writes the instructions back to the script
+    void Encode();
+    // Applies the patterns to all the instructions, returns whether
+    // anything was changed
+    bool RunPass();
+    // Deletes the removed instructions from the list
+    void Compact();
+
+    bool ResolveAddress(int32_t addr, int &ref) const
+    {
+        if (addr < 0 || addr > _scrip->codesize || _posToIns[addr] == NoRef)
+            return false;
+        ref = _posToIns[addr];
+        return true;
+    }
+
+    int Count() const { return static_cast<int>(_code.size()); }
+    // Returns the first instruction starting at the given one, which is not removed
+    int AliveAt(int i) const
+    {
+        for (; i < Count() && _code[i].Removed; ++i);
+        return i;
+    }
+    int NextAlive(int i) const { return AliveAt(i + 1); }
+    // Returns the next instruction, if it's not referenced by anything,
+    // otherwise returns nullptr
+    Instruction *NextInSequence(int &i)
+    {
+        i = NextAlive(i);
+        return (i < Count() && !_leaders[i]) ? &_code[i] : nullptr;
+    }
+
+    void Remove(int i)
+    {
+        _code[i].Removed = true;
+        // whatever was referencing the removed instruction is now
+        // referencing the next one
+        if (_leaders[i])
+            _leaders[NextAlive(i)] = true;
+    }
+
+    void MarkLeaders();
+
+    bool RemoveSelfCopy(int i);
+    bool RemoveDeadStore(int i);
+    bool ReplacePushPop(int i);
+    bool FoldLiteral(int i);
+    bool RemoveJumpToNext(int i);
+    bool ThreadJump(int i);
+    bool MergeLineNumbers(int i);
+
+    ccCompiledScript *_scrip;
+    const int _level;
+    std::vector<Instruction> _code;
+    std::vector<int> _posToIns; // maps code position to instruction
+    std::vector<FixupRef> _fixups;
+    std::vector<int> _funcRefs;
+    std::vector<int> _sectionRefs;
+    std::vector<int> _exportRefs; // NoRef for the data exports
+    // Tells that the instruction may be reached other than from the previous one;
+    // has an extra element for the end of code
+    std::vector<bool> _leaders;
+};
+
+bool ScriptOptimizer::Decode()
+{
+    const int32_t codesize = _scrip->codesize;
+    _posToIns.assign(codesize + 1, NoRef);
+    std::vector<int> arg_owner(codesize, NoRef);
+    for (int32_t pc = 0; pc < codesize;)
+    {
+        Instruction ins;
+        ins.Code = _scrip->code[pc];
+        if (ins.Code < 0 || ins.Code >= CC_NUM_SCCMDS)
+            return false;
+        ins.ArgCount = InstructionArgCount[ins.Code];
+        if (pc + ins.ArgCount >= codesize)
+            return false;
+        ins.Pos = pc;
+        for (int a = 0; a < ins.ArgCount; ++a)
+        {
+            ins.Args[a] = _scrip->code[pc + 1 + a];
+            arg_owner[pc + 1 + a] = Count();
+        }
+        _posToIns[pc] = Count();
+        _code.push_back(ins);
+        pc += ins.ArgCount + 1;
+    }
+    _posToIns[codesize] = Count();
+
+    for (int i = 0; i < _scrip->numfixups; ++i)
+    {
+        FixupRef fixup;
+        fixup.Type = _scrip->fixuptypes[i];
+        if (fixup.Type == FIXUP_DATADATA)
+        {
+            fixup.DataPos = _scrip->fixups[i];
+            _fixups.push_back(fixup);
+            continue;
+        }
+        const int32_t pos = _scrip->fixups[i];
+        if (pos < 0 || pos >= codesize || arg_owner[pos] == NoRef)
+            return false;
+        Instruction &ins = _code[arg_owner[pos]];
+        fixup.Instruction = arg_owner[pos];
+        fixup.Arg = pos - ins.Pos - 1;
+        if (ins.Fixups[fixup.Arg] != FIXUP_NOFIXUP)
+            return false;
+        ins.Fixups[fixup.Arg] = fixup.Type;
+        _fixups.push_back(fixup);
+    }
+
+    for (int i = 0; i < Count(); ++i)
+    {
+        Instruction &ins = _code[i];
+        if (IsJump(ins.Code))
+        {
+            if ((ins.Fixups[0] != FIXUP_NOFIXUP) ||
+                !ResolveAddress(ins.Pos + 2 + ins.Args[0], ins.Ref))
+                return false;
+            continue;
+        }
+        for (int a = 0; a < ins.ArgCount; ++a)
+        {
+            if ((ins.Code == SCMD_THISBASE) || (ins.Fixups[a] == FIXUP_FUNCTION))
+            {
+                if ((ins.RefArg >= 0) || !ResolveAddress(ins.Args[a], ins.Ref))
+                    return false;
+                ins.RefArg = a;
+            }
+        }
+    }
+
+    _funcRefs.resize(_scrip->numfunctions);
+    for (int i = 0; i < _scrip->numfunctions; ++i)
+    {
+        if (!ResolveAddress(_scrip->funccodeoffs[i], _funcRefs[i]))
+            return false;
+    }
+    _sectionRefs.resize(_scrip->numSections);
+    for (int i = 0; i < _scrip->numSections; ++i)
+    {
+        if (!ResolveAddress(_scrip->sectionOffsets[i], _sectionRefs[i]))
+            return false;
+    }
+    _exportRefs.assign(_scrip->numexports, NoRef);
+    for (int i = 0; i < _scrip->numexports; ++i)
+    {
+        const int32_t etype = (_scrip->export_addr[i] >> 24L) & 0x000ff;
+        if ((etype == EXPORT_FUNCTION) &&
+            !ResolveAddress(_scrip->export_addr[i] & 0x00ffffff, _exportRefs[i]))
+            return false;
+    }
+    return true;
+}
+
+void ScriptOptimizer::Encode()
+{
+    std::vector<int32_t> new_pos(Count() + 1);
+    int32_t pc = 0;
+    for (int i = 0; i < Count(); ++i)
+    {
+        new_pos[i] = pc;
+        pc += _code[i].ArgCount + 1;
+    }
+    new_pos[Count()] = pc;
+
+    for (int i = 0; i < Count(); ++i)
+    {
+        Instruction &ins = _code[i];
+        if (IsJump(ins.Code))
+            ins.Args[0] = new_pos[ins.Ref] - (new_pos[i] + 2);
+        else if (ins.RefArg >= 0)
+            ins.Args[ins.RefArg] = new_pos[ins.Ref];
+        int32_t *code = &_scrip->code[new_pos[i]];
+        code[0] = ins.Code;
+        for (int a = 0; a < ins.ArgCount; ++a)
+            code[1 + a] = ins.Args[a];
+    }
+    _scrip->codesize = pc;
+
+    // Fixups keep their original order, their number may only decrease
+    int num_fixups = 0;
+    for (const auto &fixup : _fixups)
+    {
+        int32_t pos = fixup.DataPos;
+        if (fixup.Type != FIXUP_DATADATA)
+        {
+            // the instruction index was updated when compacting the code
+            if (fixup.Instruction == NoRef)
+                continue;
+            pos = new_pos[fixup.Instruction] + 1 + fixup.Arg;
+        }
+        _scrip->fixups[num_fixups] = pos;
+        _scrip->fixuptypes[num_fixups] = fixup.Type;
+        num_fixups++;
+    }
+    _scrip->numfixups = num_fixups;
+
+    for (int i = 0; i < _scrip->numfunctions; ++i)
+        _scrip->funccodeoffs[i] = new_pos[_funcRefs[i]];
+    for (int i = 0; i < _scrip->numSections; ++i)
+        _scrip->sectionOffsets[i] = new_pos[_sectionRefs[i]];
+    for (int i = 0; i < _scrip->numexports; ++i)
+    {
+        if (_exportRefs[i] != NoRef)
+            _scrip->export_addr[i] = (EXPORT_FUNCTION << 24L) | new_pos[_exportRefs[i]];
+    }
+}
+
+void ScriptOptimizer::MarkLeaders()
+{
+    _leaders.assign(Count() + 1, false);
+    for (const auto &ins : _code)
+    {
+        if (ins.Ref != NoRef)
+            _leaders[ins.Ref] = true;
+    }
+    for (int ref : _funcRefs)
+        _leaders[ref] = true;
+    for (int ref : _sectionRefs)
+        _leaders[ref] = true;
+    for (int ref : _exportRefs)
+    {
+        if (ref != NoRef)
+            _leaders[ref] = true;
+    }
+}
+
+bool ScriptOptimizer::RunPass()
+{
+    MarkLeaders();
+    bool changed = false;
+    for (int i = 0; i < Count(); ++i)
+    {
+        if (_code[i].Removed)
+            continue;
+        if (RemoveSelfCopy(i) || RemoveDeadStore(i) || ReplacePushPop(i) ||
+            FoldLiteral(i) || RemoveJumpToNext(i) || ThreadJump(i) ||
+            (_level >= 2 && MergeLineNumbers(i)))
+            changed = true;
+    }
+    return changed;
+}
+
+void ScriptOptimizer::Compact()
+{
+    // Removed instructions are mapped to the next remaining one
+    std::vector<int> old_to_new(Count() + 1);
+    int count = 0;
+    for (int i = 0; i < Count(); ++i)
+    {
+        old_to_new[i] = count;
+        if (!_code[i].Removed)
+            count++;
+    }
+    old_to_new[Count()] = count;
+
+    for (auto &fixup : _fixups)
+    {
+        if (fixup.Instruction == NoRef)
+            continue;
+        // the fixup is dropped along with its instruction
+        fixup.Instruction = _code[fixup.Instruction].Removed ?
+            NoRef : old_to_new[fixup.Instruction];
+    }
+    count = 0;
+    for (int i = 0; i < Count(); ++i)
+    {
+        if (_code[i].Removed)
+            continue;
+        _code[count] = _code[i];
+        if (_code[count].Ref != NoRef)
+            _code[count].Ref = old_to_new[_code[count].Ref];
+        count++;
+    }
+    _code.resize(count);
+    for (int &ref : _funcRefs)
+        ref = old_to_new[ref];
+    for (int &ref : _sectionRefs)
+        ref = old_to_new[ref];
+    for (int &ref : _exportRefs)
+    {
+        if (ref != NoRef)
+            ref = old_to_new[ref];
+    }
+}
+
+// REGTOREG r, r
+bool ScriptOptimizer::RemoveSelfCopy(int i)
+{
+    const Instruction &ins = _code[i];
+    if (ins.Code != SCMD_REGTOREG || ins.Args[0] != ins.Args[1])
+        return false;
+    Remove(i);
+    return true;
+}
+
+// LITTOREG r, x | REGTOREG x, r; followed by the instruction which overwrites r
+bool ScriptOptimizer::RemoveDeadStore(int i)
+{
+    const Instruction &ins = _code[i];
+    int32_t reg;
+    if (ins.Code == SCMD_LITTOREG)
+        reg = ins.Args[0];
+    else if (ins.Code == SCMD_REGTOREG)
+        reg = ins.Args[1];
+    else
+        return false;
+    // the next instruction may be a jump target, as the register
+    // is overwritten regardless of how it was reached
+    const int next = NextAlive(i);
+    if (!IsGeneralReg(reg) || next >= Count() || !OverwritesReg(_code[next], reg))
+        return false;
+    Remove(i);
+    return true;
+}
+
+// Saving a register on stack and restoring it into another register:
+//   PUSHREG a; POPREG b                  => REGTOREG a, b
+//   PUSHREG a; LITTOREG c, x; POPREG b   => REGTOREG a, b; LITTOREG c, x
+//   PUSHREG a; LOADSPOFFS n; MEMREAD c; POPREG b
+//                                        => REGTOREG a, b; LOADSPOFFS n-4; MEMREAD c
+bool ScriptOptimizer::ReplacePushPop(int i)
+{
+    Instruction &push = _code[i];
+    if (push.Code != SCMD_PUSHREG || push.Args[0] == SREG_SP)
+        return false;
+    int j = i;
+    Instruction *next = NextInSequence(j);
+    if (!next)
+        return false;
+    if (next->Code == SCMD_POPREG && next->Args[0] != SREG_SP)
+    {
+        const int32_t reg_from = push.Args[0], reg_to = next->Args[0];
+        if (reg_from == reg_to)
+        {
+            Remove(i);
+        }
+        else
+        {
+            push.Code = SCMD_REGTOREG;
+            push.ArgCount = 2;
+            push.Args[0] = reg_from;
+            push.Args[1] = reg_to;
+        }
+        Remove(j);
+        return true;
+    }
+
+    int k = j;
+    Instruction *next2 = NextInSequence(k);
+    if (!next2)
+        return false;
+    if (next->Code == SCMD_LITTOREG && next2->Code == SCMD_POPREG &&
+        IsGeneralReg(next2->Args[0]) && next->Args[0] != next2->Args[0])
+    {
+        const int32_t reg_from = push.Args[0], reg_to = next2->Args[0];
+        push.Code = SCMD_REGTOREG;
+        push.ArgCount = 2;
+        push.Args[0] = reg_from;
+        push.Args[1] = reg_to;
+        Remove(k);
+        return true;
+    }
+
+    int l = k;
+    Instruction *next3 = NextInSequence(l);
+    if (!next3)
+        return false;
+    // the stack offset must point below the pushed value
+    if (next->Code == SCMD_LOADSPOFFS && next->Args[0] > 4 && next->Fixups[0] == FIXUP_NOFIXUP &&
+        next2->Code == SCMD_MEMREAD && next3->Code == SCMD_POPREG &&
+        IsGeneralReg(next3->Args[0]) && next2->Args[0] != next3->Args[0])
+    {
+        const int32_t reg_from = push.Args[0], reg_to = next3->Args[0];
+        push.Code = SCMD_REGTOREG;
+        push.ArgCount = 2;
+        push.Args[0] = reg_from;
+        push.Args[1] = reg_to;
+        next->Args[0] -= 4;
+        Remove(l);
+        return true;
+    }
+    return false;
+}
+
+// Operations on literals:
+//   LITTOREG r, x; NOTREG r              => LITTOREG r, !x
+//   LITTOREG r, x; ADD r, y              => LITTOREG r, x+y (also SUB, MUL)
+//   LITTOREG r1, x; REGTOREG r1, r2; LITTOREG r1, y; OP r2, r1; REGTOREG r2, r1
+//                                        => LITTOREG r1, x OP y; REGTOREG r1, r2
+// the last one is how the binary operation looks like after ReplacePushPop
+bool ScriptOptimizer::FoldLiteral(int i)
+{
+    Instruction &lit = _code[i];
+    if (lit.Code != SCMD_LITTOREG || lit.Fixups[1] != FIXUP_NOFIXUP)
+        return false;
+    const int32_t reg = lit.Args[0];
+    if (!IsGeneralReg(reg))
+        return false;
+    int j = i;
+    Instruction *next = NextInSequence(j);
+    if (!next)
+        return false;
+
+    int32_t result;
+    if (next->Code == SCMD_NOTREG && next->Args[0] == reg)
+    {
+        lit.Args[1] = (lit.Args[1] == 0) ? 1 : 0;
+        Remove(j);
+        return true;
+    }
+    if ((next->Code == SCMD_ADD || next->Code == SCMD_SUB || next->Code == SCMD_MUL) &&
+        next->Args[0] == reg && next->Fixups[1] == FIXUP_NOFIXUP &&
+        FoldOperation(next->Code, lit.Args[1], next->Args[1], result))
+    {
+        lit.Args[1] = result;
+        Remove(j);
+        return true;
+    }
+
+    if (next->Code != SCMD_REGTOREG || next->Args[0] != reg || !IsGeneralReg(next->Args[1]) ||
+        next->Args[1] == reg)
+        return false;
+    const int32_t reg2 = next->Args[1];
+    int k = j, l, m;
+    Instruction *lit2 = NextInSequence(k);
+    if (!lit2 || lit2->Code != SCMD_LITTOREG || lit2->Args[0] != reg ||
+        lit2->Fixups[1] != FIXUP_NOFIXUP)
+        return false;
+    l = k;
+    Instruction *op = NextInSequence(l);
+    if (!op || op->ArgCount != 2 || op->Args[0] != reg2 || op->Args[1] != reg)
+        return false;
+    m = l;
+    Instruction *copy = NextInSequence(m);
+    if (!copy || copy->Code != SCMD_REGTOREG || copy->Args[0] != reg2 || copy->Args[1] != reg)
+        return false;
+    // only the operations on two registers
+    if (op->Code == SCMD_ADD || op->Code == SCMD_SUB || op->Code == SCMD_MUL ||
+        !FoldOperation(op->Code, lit.Args[1], lit2->Args[1], result))
+        return false;
+    lit.Args[1] = result;
+    Remove(k);
+    Remove(l);
+    Remove(m);
+    return true;
+}
+
+bool ScriptOptimizer::RemoveJumpToNext(int i)
+{
+    const Instruction &ins = _code[i];
+    if (!IsJump(ins.Code) || AliveAt(ins.Ref) != NextAlive(i))
+        return false;
+    Remove(i);
+    return true;
+}
+
+// Jump to another jump is replaced by the jump to the final destination.
+// The unconditional jumps are followed by any jump, the conditional ones
+// are also followed by the same conditional jumps, as the condition
+// does not change on the way.
+bool ScriptOptimizer::ThreadJump(int i)
+{
+    Instruction &ins = _code[i];
+    if (!IsJump(ins.Code))
+        return false;
+    const int target = AliveAt(ins.Ref);
+    // The executor counts the backward unconditional jumps for its loop check,
+    // so the final jump must make exactly as many of these as the original chain
+    int backward_jumps = (ins.Code == SCMD_JMP && target <= i) ? 1 : 0;
+    int dest = target;
+    for (int steps = 0; steps < MaxJumpChain && dest < Count(); ++steps)
+    {
+        const Instruction &jump = _code[dest];
+        if (jump.Code != SCMD_JMP && (ins.Code == SCMD_JMP || jump.Code != ins.Code))
+            break;
+        const int next_dest = AliveAt(jump.Ref);
+        if (next_dest == dest)
+            break;
+        if (jump.Code == SCMD_JMP && next_dest <= dest)
+            backward_jumps++;
+        dest = next_dest;
+    }
+    const int new_backward_jumps = (ins.Code == SCMD_JMP && dest <= i) ? 1 : 0;
+    if (dest == target || backward_jumps != new_backward_jumps)
+        return false;
+    ins.Ref = dest;
+    return true;
+}
+
+// LINENUM a; LINENUM b                   => LINENUM b
+bool ScriptOptimizer::MergeLineNumbers(int i)
+{
+    const int next = NextAlive(i);
+    if (_code[i].Code != SCMD_LINENUM || next >= Count() || _code[next].Code != SCMD_LINENUM)
+        return false;
+    Remove(i);
+    return true;
+}
+
+} // namespace
+
+void ccOptimizeCompiledScript(ccCompiledScript *scrip, int level)
+{
+    if (level <= 0)
+        return;
+    ScriptOptimizer(scrip, level).Run();
+}
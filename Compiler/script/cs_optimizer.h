@@ -0,0 +1,46 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Peephole optimizer for the compiled script code.
+//
+// The optimizer rewrites short instruction sequences produced by the code
+// generator into the equivalent shorter ones:
+// * folds the arithmetic and logical operations on two literals;
+// * replaces the push and pop of the same value with a register copy;
+// * removes the register writes which are overwritten right away;
+// * removes the jumps to the next instruction, and redirects the jumps
+//   which land on another jump to the final destination.
+// The sequences which contain a jump target are left untouched, so the
+// control flow is never changed.
+// Besides, when optimizing, the parser skips the static array bounds checks
+// for the indexes of simple "for" loops which cannot go out of bounds.
+//
+// Optimization levels:
+// 0 - no optimization;
+// 1 - all of the above;
+// 2 - also removes the line numbers which are immediately followed by
+//     another one, which may make stepping in the debugger less precise.
+//
+//=============================================================================
+#ifndef __CS_OPTIMIZER_H
+#define __CS_OPTIMIZER_H
+
+struct ccCompiledScript;
+
+// Optimizes the code of the successfully compiled script in place,
+// adjusting all the fixups, exports, function and section offsets.
+// If the code cannot be fully decoded, then it is left unchanged.
+extern void ccOptimizeCompiledScript(ccCompiledScript *scrip, int level);
+
+#endif // __CS_OPTIMIZER_H
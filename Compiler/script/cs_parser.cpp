@@ -23,14 +23,15 @@
 #include "script/cc_symboltable.h"
 #include "script/cc_common.h"
 #include "script/cc_internal.h"
+#include "script/cs_compiler.h"
 #include "cc_variablesymlist.h"
 #include "fmem.h"
 #include "util/utf8.h"
 
-extern int currentline;
+extern thread_local int currentline;
 
 char ccCopyright[]="ScriptCompiler32 v" SCOM_VERSIONSTR " (c) 2000-2007 Chris Jones and 2011-2024 others";
-static char scriptNameBuffer[256];
+static thread_local char scriptNameBuffer[256];
 
 int  evaluate_expression(ccInternalList*,ccCompiledScript*,int,bool insideBracketedDeclaration);
 int  evaluate_assignment(ccInternalList *targ, ccCompiledScript *scrip, bool expectCloseBracket, int cursym, int32_t lilen, int32_t *vnlist, bool insideBracketedDeclaration);
@@ -82,8 +83,8 @@ void clear_chunk_list(std::vector<ccChunk> *list) {
 
 static int is_part_of_symbol(char thischar, char startchar) {
     // workaround for strings
-    static int sayno_next_char = 0;
-    static int next_is_escaped = 0;
+    static thread_local int sayno_next_char = 0;
+    static thread_local int next_is_escaped = 0;
     if (sayno_next_char) {
         sayno_next_char = 0;
         return 0;
@@ -147,10 +148,10 @@ static int is_part_of_symbol(char thischar, char startchar) {
 
 // NOTE: global buffers meant to store parsed lines and symbols;
 // most of these were local char arrays of fixed size, refactored into global std::string for convenience
-std::string constructedMemberName;
-std::string thissymbol;
-std::string thissymbol_mangled;
-std::string constructedFunctionName;
+thread_local std::string constructedMemberName;
+thread_local std::string thissymbol;
+thread_local std::string thissymbol_mangled;
+thread_local std::string constructedFunctionName;
 
 const char *get_member_full_name(int structSym, int memberSym) {
 
@@ -463,6 +464,137 @@ int remove_locals(int from_level, int just_count, ccCompiledScript *scrip) {
     return totalsub;
 }
 
+// Index variable of the "for" loop, which is known to stay within the range
+// [0, Max) inside the loop body, so that the array bounds checks may be skipped
+struct LoopIndexRange
+{
+    int Sym;        // local int variable
+    int32_t Max;    // exclusive upper bound
+    int Level;      // nested level of the loop body
+};
+
+thread_local std::vector<LoopIndexRange> loopIndexRanges;
+
+// Reads the non-negative integer literal
+static bool get_literal_int_value(int symb, int32_t &value) {
+    if (sym.get_type(symb) != SYM_LITERALVALUE)
+        return false;
+    const char *str = sym.get_name(symb);
+    const bool is_hex = (str[0] == '0') && (str[1] == 'x' || str[1] == 'X');
+    errno = 0;
+    char *endptr = nullptr;
+    const long long val = strtoll(str, &endptr, is_hex ? 16 : 10);
+    if ((errno != 0) || (*endptr != 0) || (val < 0) || (val > INT32_MAX))
+        return false;
+    value = static_cast<int32_t>(val);
+    return true;
+}
+
+// Tells if the "for" loop, which header starts at the current list position,
+// has the form "for ([int] i = A; i < B; i++) { ... }", where A and B are
+// literals and A >= 0, the step "i += N" (if used) cannot overflow, and i is a local int variable which is not assigned
+// anywhere inside the loop body. In that case returns the variable and
+// the exclusive upper bound of its value inside the loop body.
+static bool find_for_loop_index_range(const ccInternalList *targ, int &var_sym, int32_t &max_value) {
+    // Collect the header tokens, up to the closing parenthesis
+    std::vector<int32_t> header;
+    int pos = targ->pos;
+    for (int depth = 0; pos < targ->length; ) {
+        if (targ->script[pos] == SCODE_META) {
+            pos += 3;
+            continue;
+        }
+        const int32_t symb = targ->script[pos++];
+        const int stype = sym.get_type(symb);
+        if (stype == SYM_OPENPARENTHESIS)
+            depth++;
+        else if ((stype == SYM_CLOSEPARENTHESIS) && (depth-- == 0))
+            break;
+        header.push_back(symb);
+    }
+
+    size_t at = 0;
+    if (!header.empty() && (sym.get_type(header[0]) == SYM_VARTYPE)) {
+        if (header[0] != sym.normalIntSym)
+            return false;
+        at = 1;
+    }
+    if (header.size() < at + 10)
+        return false;
+    const int var = header[at];
+    if (at == 0) {
+        // an existing variable, must be a plain local int
+        if ((sym.get_type(var) != SYM_LOCALVAR) || (sym.entries[var].vartype != sym.normalIntSym) ||
+            (sym.entries[var].flags & (SFLG_ARRAY | SFLG_POINTER | SFLG_DYNAMICARRAY | SFLG_STRUCTMEMBER)) != 0)
+            return false;
+    }
+    int32_t start, limit, step;
+    if ((sym.get_type(header[at + 1]) != SYM_ASSIGN) || !get_literal_int_value(header[at + 2], start) ||
+        (sym.get_type(header[at + 3]) != SYM_SEMICOLON))
+        return false;
+    const char *cmp_op = sym.get_name(header[at + 5]);
+    if ((header[at + 4] != var) || (sym.get_type(header[at + 5]) != SYM_OPERATOR) ||
+        ((strcmp(cmp_op, "<") != 0) && (strcmp(cmp_op, "<=") != 0)) ||
+        !get_literal_int_value(header[at + 6], limit) || (sym.get_type(header[at + 7]) != SYM_SEMICOLON))
+        return false;
+    if (strcmp(cmp_op, "<=") == 0) {
+        if (limit == INT32_MAX)
+            return false;
+        limit++;
+    }
+    // the index may only grow, with "i++" or "i += N"
+    if (header[at + 8] != var)
+        return false;
+    if ((header.size() == at + 10) && (sym.get_type(header[at + 9]) == SYM_SASSIGN) &&
+        (strcmp(sym.get_name(header[at + 9]), "++") == 0))
+        ;
+    else if ((header.size() == at + 11) && (sym.get_type(header[at + 9]) == SYM_MASSIGN) &&
+        (strcmp(sym.get_name(header[at + 9]), "+=") == 0) && get_literal_int_value(header[at + 10], step) &&
+        // the last step must not overflow, or the index would wrap to negative
+        (static_cast<int64_t>(limit) - 1 + step <= INT32_MAX))
+        ;
+    else
+        return false;
+
+    // Only the braced body is checked, as nested single statements
+    // may spread over several semicolons
+    for (; (pos < targ->length) && (targ->script[pos] == SCODE_META); pos += 3);
+    if ((pos >= targ->length) || (sym.get_type(targ->script[pos]) != SYM_OPENBRACE))
+        return false;
+    int32_t prev_sym = -1;
+    for (int depth = 0; pos < targ->length; ) {
+        if (targ->script[pos] == SCODE_META) {
+            pos += 3;
+            continue;
+        }
+        const int32_t symb = targ->script[pos++];
+        const int stype = sym.get_type(symb);
+        if (stype == SYM_OPENBRACE)
+            depth++;
+        else if ((stype == SYM_CLOSEBRACE) && (--depth == 0))
+            break;
+        if (((prev_sym == var) && ((stype == SYM_ASSIGN) || (stype == SYM_MASSIGN) || (stype == SYM_SASSIGN))) ||
+            ((symb == var) && (sym.get_type(prev_sym) == SYM_SASSIGN)))
+            return false;
+        prev_sym = symb;
+    }
+    var_sym = var;
+    max_value = limit;
+    return true;
+}
+
+// Tells if the array index, given as a list of symbols, is a loop index
+// which is known to be within the array bounds
+static bool is_array_index_in_bounds(const int32_t *index_syms, int index_len, int32_t arrsize) {
+    if (index_len != 1)
+        return false;
+    for (const auto &range : loopIndexRanges) {
+        if ((range.Sym == index_syms[0]) && (range.Max <= arrsize))
+            return true;
+    }
+    return false;
+}
+
 int deal_with_end_of_ifelse (char *nested_type, int32_t *nested_info, int32_t *nested_start,
                              ccCompiledScript*scrip,ccInternalList*targ,int*nestlevel, std::vector<ccChunk> *nested_chunk) {
      int nested_level = nestlevel[0];
@@ -504,6 +636,9 @@ int deal_with_end_of_ifelse (char *nested_type, int32_t *nested_info, int32_t *n
          if(nested_type[nestlevel[0]] == NEST_FOR)
          {
              nestlevel[0]--;
+             // the loop index ranges are only valid inside their loops
+             while (!loopIndexRanges.empty() && (loopIndexRanges.back().Level > nestlevel[0]))
+                 loopIndexRanges.pop_back();
              // find local variables that have just been removed
              int totalsub = remove_locals (nestlevel[0], 0, scrip);
 
@@ -1667,7 +1802,7 @@ int extractPathIntoParts(VariableSymlist *variablePath, int slilen, int32_t *sym
   return variablePathSize;
 }
 
-int readcmd_lastcalledwith=0;
+thread_local int readcmd_lastcalledwith=0;
 int get_readcmd_for_size(int sizz, int writeinstead) {
   int readcmd = SCMD_MEMREAD;
   if (writeinstead) {
@@ -1719,7 +1854,9 @@ int get_array_index_into_ax(ccCompiledScript *scrip, int32_t *symlist, int openB
   if (checkBounds) {
     // check the array bounds that have been calculated in AX,
     // before they are added to the overall offset
-    if ((sym.entries[arrSym].flags & SFLG_DYNAMICARRAY) == 0)
+    if (((sym.entries[arrSym].flags & SFLG_DYNAMICARRAY) == 0) &&
+        !is_array_index_in_bounds(&symlist[openBracketOffs + 1], closeBracketOffs - (openBracketOffs + 1),
+            sym.entries[arrSym].arrsize))
     {
       scrip->write_cmd2(SCMD_CHECKBOUNDS, SREG_AX, sym.entries[arrSym].arrsize);
     }
@@ -2056,7 +2193,7 @@ int do_variable_memory_access(ccCompiledScript *scrip, int variableSym,
 
 // If the variable being read is actually a property, not a
 // member variable, then read_variable_into_ax sets this
-int readonly_cannot_cause_error = 0;
+thread_local int readonly_cannot_cause_error = 0;
 
 int do_variable_ax(int slilen, int32_t *syml, ccCompiledScript*scrip, int writing, int mustBeWritable, bool negateLiteral = false) {
   // read the various types of values into AX
@@ -3371,6 +3508,7 @@ int parse_variable_declaration(int32_t cursym,int *next_type,int isglobal,
 int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
     ccInternalList targ;
     if (cc_tokenize(inpl,&targ,scrip)) return -1;
+    loopIndexRanges.clear();
 
     int aa,in_func = -1, nested_level = 0;
     int isMemberFunction = 0;
@@ -4559,6 +4697,10 @@ startvarbit:
                     return -1;
                 }
                 targ.getnext(); // Skip the (
+                int loopIndexSym = -1;
+                int32_t loopIndexMax = 0;
+                const bool hasLoopIndexRange = (ccGetOptimizationLevel() > 0) &&
+                    find_for_loop_index_range(&targ, loopIndexSym, loopIndexMax);
                 cursym = targ.getnext();
                 if (sym.get_type(cursym) != SYM_SEMICOLON) {
                     if(sym.get_type(cursym) == SYM_CLOSEPARENTHESIS) {
@@ -4686,6 +4828,8 @@ startvarbit:
                     nested_type[nested_level] = NEST_ELSESINGLE;
                 nested_info[nested_level] = scrip->codesize-1;
                 nested_start[nested_level] = oriaddr;
+                if (hasLoopIndexRange)
+                    loopIndexRanges.push_back({ loopIndexSym, loopIndexMax, nested_level });
                 continue;
             }
             else if (sym.get_type(cursym) == SYM_SWITCH) {
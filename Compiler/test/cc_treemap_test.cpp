@@ -11,6 +11,8 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <stdio.h>
+#include <string.h>
 #include "gtest/gtest.h"
 #include "script/cc_treemap.h"
 
@@ -68,3 +70,18 @@ TEST(TreeMap, Clear) {
 	symbolTree.clear();
 	ASSERT_TRUE (symbolTree.findValue("a") == -1);
 }
+
+TEST(TreeMap, KeysAreCopied) {
+	ccTreeMap symbolTree;
+	char key[16];
+	for (int i = 0; i < 1000; ++i) {
+		snprintf(key, sizeof(key), "sym%d", i);
+		symbolTree.addEntry(key, i);
+	}
+	strcpy(key, "changed");
+	for (int i = 0; i < 1000; ++i) {
+		snprintf(key, sizeof(key), "sym%d", i);
+		ASSERT_TRUE (symbolTree.findValue(key) == i);
+	}
+	ASSERT_TRUE (symbolTree.findValue("changed") == -1);
+}
@@ -0,0 +1,336 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <string.h>
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "script/cc_common.h"
+#include "script/cc_internal.h"
+#include "script/cs_compiler.h"
+
+namespace
+{
+
+const int ArgCount[CC_NUM_SCCMDS] = {
+    0, 2, 2, 2, 2, 0, 2, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 2, 1, 2, 2, 1, 2, 1, 1, 0,
+    1, 1, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 2, 2, 1, 0, 0, 1, 1, 3, 2
+};
+
+// Minimal script executor, only supports the integer operations and calls
+// of the functions within the same script. Global data is placed at address 0,
+// followed by the stack.
+class TestExecutor
+{
+public:
+    explicit TestExecutor(const ccScript *script)
+        : _script(script)
+        , _code(script->code, script->code + script->codesize)
+        , _memory(StackBase + StackSize)
+    {
+        memcpy(&_memory[0], script->globaldata, script->globaldatasize);
+        for (int i = 0; i < script->numfixups; ++i)
+        {
+            // global data and functions are already addressed relative to 0
+            if (script->fixuptypes[i] != FIXUP_GLOBALDATA && script->fixuptypes[i] != FIXUP_FUNCTION)
+                ADD_FAILURE() << "unsupported fixup type " << static_cast<int>(script->fixuptypes[i]);
+        }
+    }
+
+    int32_t Call(const char *func_name, const std::vector<int32_t> &args)
+    {
+        int32_t pc = -1;
+        for (int i = 0; i < _script->numexports; ++i)
+        {
+            if (strncmp(_script->exports[i], func_name, strlen(func_name)) == 0 &&
+                _script->exports[i][strlen(func_name)] == '$')
+                pc = _script->export_addr[i] & 0x00ffffff;
+        }
+        EXPECT_GE(pc, 0) << "function not found: " << func_name;
+        if (pc < 0)
+            return 0;
+
+        int32_t reg[CC_NUM_REGISTERS] = {};
+        reg[SREG_SP] = StackBase;
+        for (auto it = args.rbegin(); it != args.rend(); ++it)
+            Push(reg, *it);
+        Push(reg, ReturnToHost);
+        for (;;)
+        {
+            if (pc < 0 || pc >= static_cast<int32_t>(_code.size()))
+            {
+                ADD_FAILURE() << "pc out of range: " << pc;
+                return 0;
+            }
+            const int32_t op = _code[pc];
+            const int32_t arg1 = (ArgCount[op] > 0) ? _code[pc + 1] : 0;
+            const int32_t arg2 = (ArgCount[op] > 1) ? _code[pc + 2] : 0;
+            const int32_t next_pc = pc + ArgCount[op] + 1;
+            const uint32_t r1 = static_cast<uint32_t>(reg[arg1]);
+            const uint32_t r2 = static_cast<uint32_t>(reg[arg2]);
+            Executed++;
+            switch (op)
+            {
+            case SCMD_LINENUM:
+            case SCMD_THISBASE:
+            case SCMD_NUMFUNCARGS:
+            case SCMD_LOOPCHECKOFF:
+                break;
+            case SCMD_LITTOREG: reg[arg1] = arg2; break;
+            case SCMD_REGTOREG: reg[arg2] = reg[arg1]; break;
+            case SCMD_PUSHREG: Push(reg, reg[arg1]); break;
+            case SCMD_POPREG: reg[arg1] = Pop(reg); break;
+            case SCMD_ADD: reg[arg1] = static_cast<int32_t>(r1 + static_cast<uint32_t>(arg2)); break;
+            case SCMD_SUB: reg[arg1] = static_cast<int32_t>(r1 - static_cast<uint32_t>(arg2)); break;
+            case SCMD_MUL: reg[arg1] = static_cast<int32_t>(r1 * static_cast<uint32_t>(arg2)); break;
+            case SCMD_ADDREG: reg[arg1] = static_cast<int32_t>(r1 + r2); break;
+            case SCMD_SUBREG: reg[arg1] = static_cast<int32_t>(r1 - r2); break;
+            case SCMD_MULREG: reg[arg1] = static_cast<int32_t>(r1 * r2); break;
+            case SCMD_DIVREG: reg[arg1] = reg[arg1] / reg[arg2]; break;
+            case SCMD_MODREG: reg[arg1] = reg[arg1] % reg[arg2]; break;
+            case SCMD_BITAND: reg[arg1] = reg[arg1] & reg[arg2]; break;
+            case SCMD_BITOR: reg[arg1] = reg[arg1] | reg[arg2]; break;
+            case SCMD_XORREG: reg[arg1] = reg[arg1] ^ reg[arg2]; break;
+            case SCMD_SHIFTLEFT: reg[arg1] = static_cast<int32_t>(r1 << reg[arg2]); break;
+            case SCMD_SHIFTRIGHT: reg[arg1] = reg[arg1] >> reg[arg2]; break;
+            case SCMD_ISEQUAL: reg[arg1] = reg[arg1] == reg[arg2]; break;
+            case SCMD_NOTEQUAL: reg[arg1] = reg[arg1] != reg[arg2]; break;
+            case SCMD_GREATER: reg[arg1] = reg[arg1] > reg[arg2]; break;
+            case SCMD_LESSTHAN: reg[arg1] = reg[arg1] < reg[arg2]; break;
+            case SCMD_GTE: reg[arg1] = reg[arg1] >= reg[arg2]; break;
+            case SCMD_LTE: reg[arg1] = reg[arg1] <= reg[arg2]; break;
+            case SCMD_AND: reg[arg1] = reg[arg1] && reg[arg2]; break;
+            case SCMD_OR: reg[arg1] = reg[arg1] || reg[arg2]; break;
+            case SCMD_NOTREG: reg[arg1] = !reg[arg1]; break;
+            case SCMD_LOADSPOFFS: reg[SREG_MAR] = reg[SREG_SP] - arg1; break;
+            case SCMD_MEMREAD: reg[arg1] = Read(reg[SREG_MAR]); break;
+            case SCMD_MEMWRITE: Write(reg[SREG_MAR], reg[arg1]); break;
+            case SCMD_WRITELIT: Write(reg[SREG_MAR], arg2); break;
+            case SCMD_ZEROMEMORY: memset(&_memory[reg[SREG_MAR]], 0, arg1); break;
+            case SCMD_CHECKBOUNDS:
+                if (reg[arg1] < 0 || reg[arg1] >= arg2)
+                {
+                    ADD_FAILURE() << "index out of bounds: " << reg[arg1];
+                    return 0;
+                }
+                break;
+            case SCMD_JZ:
+                if (reg[SREG_AX] == 0)
+                    pc = next_pc + arg1;
+                else
+                    pc = next_pc;
+                continue;
+            case SCMD_JNZ:
+                if (reg[SREG_AX] != 0)
+                    pc = next_pc + arg1;
+                else
+                    pc = next_pc;
+                continue;
+            case SCMD_JMP:
+                if (arg1 < 0)
+                    BackwardJumps++;
+                pc = next_pc + arg1;
+                continue;
+            case SCMD_CALL:
+                Push(reg, next_pc);
+                pc = reg[arg1];
+                continue;
+            case SCMD_RET:
+                pc = Pop(reg);
+                if (pc == ReturnToHost)
+                    return reg[SREG_AX];
+                continue;
+            default:
+                ADD_FAILURE() << "unsupported instruction " << op << " at " << pc;
+                return 0;
+            }
+            pc = next_pc;
+        }
+    }
+
+    int32_t Read(int32_t addr) const
+    {
+        int32_t val;
+        memcpy(&val, &_memory[addr], sizeof(val));
+        return val;
+    }
+
+    size_t Executed = 0u;
+    size_t BackwardJumps = 0u;
+
+private:
+    static const int32_t StackBase = 0x1000;
+    static const int32_t StackSize = 0x1000;
+    static const int32_t ReturnToHost = -1;
+
+    void Write(int32_t addr, int32_t val) { memcpy(&_memory[addr], &val, sizeof(val)); }
+    void Push(int32_t *reg, int32_t val) { Write(reg[SREG_SP], val); reg[SREG_SP] += 4; }
+    int32_t Pop(int32_t *reg) { reg[SREG_SP] -= 4; return Read(reg[SREG_SP]); }
+
+    const ccScript *_script;
+    std::vector<int32_t> _code;
+    std::vector<uint8_t> _memory;
+};
+
+std::unique_ptr<ccScript> CompileWithLevel(const char *text, int level)
+{
+    const int old_exportall = ccGetOption(SCOPT_EXPORTALL);
+    const int old_linenumbers = ccGetOption(SCOPT_LINENUMBERS);
+    ccSetOption(SCOPT_EXPORTALL, 1);
+    ccSetOption(SCOPT_LINENUMBERS, 1);
+    ccSetOptimizationLevel(level);
+    std::unique_ptr<ccScript> script(ccCompileText(text, "Test"));
+    ccSetOptimizationLevel(0);
+    ccSetOption(SCOPT_EXPORTALL, old_exportall);
+    ccSetOption(SCOPT_LINENUMBERS, old_linenumbers);
+    EXPECT_TRUE(script != nullptr) << cc_get_error().ErrorString.GetCStr();
+    return script;
+}
+
+const char *CalcScript = ""
+    "int g;\n"
+    "int Twice(int q) { return q * 2; }\n"
+    "int Calc(int a, int b)\n"
+    "{\n"
+    "  int x = 1 + 2 * 3 - (20 / 4) % 3;\n"
+    "  int y = (7 << 2) | (64 >> 3) ^ (6 & 3);\n"
+    "  int z = !0 + (5 > 3) + (2 == 2) + (4 != 4) + (1 && 0) + (0 || 3) + (-8 >= -8) + (3 <= 2);\n"
+    "  int i;\n"
+    "  for (i = 0; i < 10; i++)\n"
+    "  {\n"
+    "    if (a > i && b != 0)\n"
+    "    {\n"
+    "      if (b > 5) x += a * 3;\n"
+    "      else x += b;\n"
+    "    }\n"
+    "    else x -= 1;\n"
+    "  }\n"
+    "  while (x > 100)\n"
+    "    x = x - 7;\n"
+    "  if (a == 0 || b == 0) y = Twice(y);\n"
+    "  g = x + y + z;\n"
+    "  return Twice(x) + y - z + b;\n"
+    "}\n";
+
+int CountInstructions(const ccScript *script, int32_t code)
+{
+    int count = 0;
+    for (int pc = 0; pc < script->codesize; pc += ArgCount[script->code[pc]] + 1)
+        count += (script->code[pc] == code) ? 1 : 0;
+    return count;
+}
+
+} // namespace
+
+TEST(Optimizer, SameResults) {
+    std::unique_ptr<ccScript> ref_script = CompileWithLevel(CalcScript, 0);
+    ASSERT_TRUE(ref_script != nullptr);
+    for (int level = 1; level <= 2; ++level)
+    {
+        std::unique_ptr<ccScript> script = CompileWithLevel(CalcScript, level);
+        ASSERT_TRUE(script != nullptr);
+        EXPECT_LT(script->codesize, ref_script->codesize);
+        EXPECT_LE(script->numfixups, ref_script->numfixups);
+        for (int a = -3; a <= 12; a += 3)
+        {
+            for (int b = -1; b <= 8; b += 3)
+            {
+                TestExecutor ref_exec(ref_script.get());
+                TestExecutor exec(script.get());
+                EXPECT_EQ(ref_exec.Call("Calc", { a, b }), exec.Call("Calc", { a, b }));
+                EXPECT_EQ(ref_exec.Read(0), exec.Read(0));
+                EXPECT_EQ(ref_exec.BackwardJumps, exec.BackwardJumps);
+                EXPECT_LT(exec.Executed, ref_exec.Executed);
+            }
+        }
+    }
+}
+
+TEST(Optimizer, FoldsConstants) {
+    const char *inpl = "int Get() { return (2 + 3 * 4) << 1; }";
+    std::unique_ptr<ccScript> script = CompileWithLevel(inpl, 1);
+    ASSERT_TRUE(script != nullptr);
+    bool found_result = false;
+    for (int pc = 0; pc < script->codesize; pc += ArgCount[script->code[pc]] + 1)
+    {
+        const int32_t op = script->code[pc];
+        EXPECT_TRUE(op != SCMD_ADDREG && op != SCMD_MULREG && op != SCMD_SHIFTLEFT &&
+            op != SCMD_PUSHREG && op != SCMD_POPREG) << "instruction " << op << " at " << pc;
+        if (op == SCMD_LITTOREG && script->code[pc + 2] == 28)
+            found_result = true;
+    }
+    EXPECT_TRUE(found_result);
+    EXPECT_EQ(28, TestExecutor(script.get()).Call("Get", {}));
+}
+
+TEST(Optimizer, KeepsDivisionByZero) {
+    const char *inpl = "int Get() { return 1 / 0; }";
+    std::unique_ptr<ccScript> script = CompileWithLevel(inpl, 1);
+    ASSERT_TRUE(script != nullptr);
+    EXPECT_EQ(1, CountInstructions(script.get(), SCMD_DIVREG));
+}
+
+TEST(Optimizer, SkipsLoopIndexBoundsChecks) {
+    const char *inpl = ""
+        "int arr[10];\n"
+        "int Fill(int n)\n"
+        "{\n"
+        "  int sum = 0;\n"
+        "  for (int i = 0; i < 10; i++) { arr[i] = i * n; }\n"
+        "  int j;\n"
+        "  for (j = 2; j <= 9; j += 2) { sum += arr[j]; }\n"
+        "  return sum;\n"
+        "}\n";
+    std::unique_ptr<ccScript> ref_script = CompileWithLevel(inpl, 0);
+    std::unique_ptr<ccScript> script = CompileWithLevel(inpl, 1);
+    ASSERT_TRUE(ref_script != nullptr);
+    ASSERT_TRUE(script != nullptr);
+    EXPECT_EQ(2, CountInstructions(ref_script.get(), SCMD_CHECKBOUNDS));
+    EXPECT_EQ(0, CountInstructions(script.get(), SCMD_CHECKBOUNDS));
+    EXPECT_EQ(60, TestExecutor(ref_script.get()).Call("Fill", { 3 }));
+    EXPECT_EQ(60, TestExecutor(script.get()).Call("Fill", { 3 }));
+}
+
+TEST(Optimizer, KeepsOtherBoundsChecks) {
+    const char *inpl = ""
+        "int arr[10];\n"
+        "int g;\n"
+        "void Fill()\n"
+        "{\n"
+        "  for (int i = 0; i <= 10; i++) { arr[i] = 0; }\n"
+        "  for (int j = 0; j < 10; j++) { arr[j] = 0; j++; }\n"
+        "  for (int k = 0; k < 10; k++) { arr[k + 1] = 0; }\n"
+        "  for (g = 0; g < 10; g++) { arr[g] = 0; }\n"
+        "  for (int m = 0; m < 10; m++) arr[m] = 0;\n"
+        "  int n = 0;\n"
+        "  for (int p = 0; p < 10; p++) { arr[n] = 0; }\n"
+        "}\n";
+    std::unique_ptr<ccScript> script = CompileWithLevel(inpl, 1);
+    ASSERT_TRUE(script != nullptr);
+    EXPECT_EQ(6, CountInstructions(script.get(), SCMD_CHECKBOUNDS));
+}
+
+TEST(Optimizer, KeepsBoundsChecksOnStepOverflow) {
+    // the second step wraps the index to negative, which is still below the limit
+    const char *inpl = ""
+        "int arr[10];\n"
+        "void Fill()\n"
+        "{\n"
+        "  for (int i = 9; i < 10; i += 2147483647) { arr[i] = 0; }\n"
+        "  for (int j = 9; j < 10; j += 2147483638) { arr[j] = 0; }\n"
+        "}\n";
+    std::unique_ptr<ccScript> script = CompileWithLevel(inpl, 1);
+    ASSERT_TRUE(script != nullptr);
+    EXPECT_EQ(1, CountInstructions(script.get(), SCMD_CHECKBOUNDS));
+}
@@ -579,6 +579,60 @@ builtin managed struct Set
 };
 #endif
 
+#ifdef SCRIPT_API_v362
+builtin struct Array
+{
+  /// Copies the range of elements from one array to another, or within the same array.
+  import static void CopyInts(int src[], int srcIndex, int dest[], int destIndex, int count); // $AUTOCOMPLETESTATICONLY$
+  /// Copies the range of elements from one array to another, or within the same array.
+  import static void CopyFloats(float src[], int srcIndex, float dest[], int destIndex, int count); // $AUTOCOMPLETESTATICONLY$
+  /// Copies the range of elements from one array to another, or within the same array.
+  import static void CopyStrings(String src[], int srcIndex, String dest[], int destIndex, int count); // $AUTOCOMPLETESTATICONLY$
+  /// Assigns the value to the range of array elements; by default to the whole array.
+  import static void FillInts(int arr[], int value, int index = 0, int count = -1); // $AUTOCOMPLETESTATICONLY$
+  /// Assigns the value to the range of array elements; by default to the whole array.
+  import static void FillFloats(float arr[], float value, int index = 0, int count = -1); // $AUTOCOMPLETESTATICONLY$
+  /// Assigns the value to the range of array elements; by default to the whole array.
+  import static void FillStrings(String arr[], String value, int index = 0, int count = -1); // $AUTOCOMPLETESTATICONLY$
+  /// Creates a new array of the given length, with the elements copied from the old one.
+  import static int[] ResizeInts(int arr[], int newLength); // $AUTOCOMPLETESTATICONLY$
+  /// Creates a new array of the given length, with the elements copied from the old one.
+  import static float[] ResizeFloats(float arr[], int newLength); // $AUTOCOMPLETESTATICONLY$
+  /// Creates a new array of the given length, with the elements copied from the old one.
+  import static String[] ResizeStrings(String arr[], int newLength); // $AUTOCOMPLETESTATICONLY$
+  /// Creates a copy of the array.
+  import static int[] CloneInts(int arr[]); // $AUTOCOMPLETESTATICONLY$
+  /// Creates a copy of the array.
+  import static float[] CloneFloats(float arr[]); // $AUTOCOMPLETESTATICONLY$
+  /// Creates a copy of the array.
+  import static String[] CloneStrings(String arr[]); // $AUTOCOMPLETESTATICONLY$
+};
+
+builtin managed struct StringBuilder
+{
+  /// Creates a new empty StringBuilder, optionally reserving space for the given number of bytes.
+  import static StringBuilder* Create(int capacity = 0); // $AUTOCOMPLETESTATICONLY$
+
+  /// Appends the text to the end of this builder.
+  import void Append(const string text);
+  /// Appends the character to the end of this builder.
+  import void AppendChar(int extraChar);
+  /// Appends the formatted text to the end of this builder.
+  import void AppendFormat(const string format, ...);
+  /// Removes all text from this builder.
+  import void Clear();
+  /// Inserts the text at the given character index.
+  import void Insert(int index, const string text);
+  /// Removes the given number of characters, starting at the character index.
+  import void Remove(int index, int count);
+  /// Creates a String containing the text of this builder.
+  import String ToString();
+
+  /// Gets the length of the text, in characters.
+  import readonly attribute int Length;
+};
+#endif
+
 builtin managed struct AudioClip;
 
 builtin managed struct ViewFrame {
@@ -707,6 +761,10 @@ builtin struct Room {
   /// Checks if the specified room exists
   import static bool Exists(int room);   // $AUTOCOMPLETESTATICONLY$
 #endif
+#ifdef SCRIPT_API_v362
+  /// Starts loading the specified room in background, so that changing to it is faster
+  import static void Preload(int room);   // $AUTOCOMPLETESTATICONLY$
+#endif
 };
 
 builtin struct Parser {
@@ -1277,6 +1335,14 @@ builtin managed struct File {
   import static String ResolvePath(const string filename);   // $AUTOCOMPLETESTATICONLY$
   /// Gets the path to opened file.
   readonly import attribute String Path;
+#endif
+#ifdef SCRIPT_API_v362
+  /// Reads up to count raw 32-bit ints from the file into the array (whole array if count is -1), returns the number of ints read.
+  import int ReadRawInts(int values[], int count = -1);
+  /// Writes up to count raw 32-bit ints from the array to the file (whole array if count is -1), returns the number of ints written.
+  import int WriteRawInts(int values[], int count = -1);
+  /// Reads all the remaining raw lines of text from the file; returns null if there are none.
+  import String[] ReadAllLines();
 #endif
   int reserved[2];   // $AUTOCOMPLETEIGNORE$
 };
@@ -1919,6 +1985,10 @@ builtin managed struct ListBox extends GUIControl {
 	/// Gets/sets regular list item's text color
 	import attribute int  TextColor;
 #endif
+#ifdef SCRIPT_API_v362
+	/// Adds all the strings from the array to the bottom of the list.
+	import void AddItems(String items[]);
+#endif
 };
 
 builtin managed struct GUI {
@@ -2307,6 +2377,20 @@ enum EngineValueID {
   ENGINE_VALUE_I_TEXCACHE_NORMAL,
   ENGINE_VALUE_I_FPS_MAX,
   ENGINE_VALUE_I_FPS,
+  ENGINE_VALUE_I_SPRCACHE_HITS,
+  ENGINE_VALUE_I_SPRCACHE_MISSES,
+  ENGINE_VALUE_I_SPRCACHE_EVICTIONS,
+  ENGINE_VALUE_I_SPRCACHE_LOADED,        // total size of loaded sprites (KB)
+  ENGINE_VALUE_I_SPRCACHE_LOADTIME_COUNT, // number of load time histogram buckets
+  ENGINE_VALUE_II_SPRCACHE_LOADTIME,     // number of sprite loads in the histogram bucket
+  ENGINE_VALUE_I_TEXCACHE_HITS,
+  ENGINE_VALUE_I_TEXCACHE_MISSES,
+  ENGINE_VALUE_I_TEXCACHE_EVICTIONS,
+  ENGINE_VALUE_I_AUDIO_UNDERRUNS,        // number of times a playing sound ran out of data
+  ENGINE_VALUE_I_AUDIO_QUEUED,           // max sound data queued for output by a sound (ms)
+  ENGINE_VALUE_I_AUDIO_START_LATENCY,    // average delay before the played sound's output starts (ms)
+  ENGINE_VALUE_I_AUDIO_START_LATENCY_MAX, // max delay before the played sound's output starts (ms)
+  ENGINE_VALUE_I_AUDIO_VIRTUAL_VOICES,   // number of playing sounds which are not output due to the voice limit
   ENGINE_VALUE_LAST                      // in case user wants to iterate them
 };
 #endif
@@ -2808,6 +2892,8 @@ builtin managed struct Character {
 #ifdef SCRIPT_API_v362
   /// Moves the character in a straight line as far as possible towards the co-ordinates, without walking animation. Useful for keyboard movement.
   import function MoveStraight(int x, int y, BlockingStyle=eNoBlock);
+  /// Starts all the characters in the array walking to the same co-ordinates on walkable areas, in the background. They do not block each other's way.
+  import static void WalkGroup(Character* characters[], int x, int y); // $AUTOCOMPLETESTATICONLY$
 #endif
 #ifdef STRICT
   /// The character's current X-position.
@@ -36,7 +36,8 @@ SpriteFileWriter::SpriteFileWriter(System::String ^filename)
 {
     AGSString fn = TextHelper::ConvertUTF8(filename);
     std::unique_ptr<AGSStream> out(AGS::Common::File::CreateFile(fn));
-    _nativeWriter = new AGS::Common::SpriteFileWriter(std::move(out));
+    // Let the native writer compress the sprites on all the available cores
+    _nativeWriter = new AGS::Common::SpriteFileWriter(std::move(out), 0);
 }
 
 SpriteFileWriter::~SpriteFileWriter()
@@ -55,7 +56,7 @@ void SpriteFileWriter::WriteBitmap(System::Drawing::Bitmap ^image)
     int importedColourDepth;
     std::unique_ptr<AGSBitmap> native_bmp(CreateBlockFromBitmap(image, imgPalBuf, true, true, &importedColourDepth));
     pre_save_sprite(native_bmp.get()); // RGB swaps
-    _nativeWriter->WriteBitmap(native_bmp.get());
+    _nativeWriter->WriteBitmap(std::move(native_bmp));
 }
 
 void SpriteFileWriter::WriteBitmap(System::Drawing::Bitmap ^image, AGS::Types::SpriteImportTransparency transparency,
@@ -64,7 +65,7 @@ void SpriteFileWriter::WriteBitmap(System::Drawing::Bitmap ^image, AGS::Types::S
     std::unique_ptr<AGSBitmap> native_bmp(CreateNativeBitmap(image, (int)transparency, remapColours,
         useRoomBackgroundColours, alphaChannel, nullptr));
     pre_save_sprite(native_bmp.get()); // RGB swaps
-    _nativeWriter->WriteBitmap(native_bmp.get());
+    _nativeWriter->WriteBitmap(std::move(native_bmp));
 }
 
 void SpriteFileWriter::WriteEmptySlot()
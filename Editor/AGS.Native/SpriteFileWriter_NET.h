@@ -34,14 +34,16 @@ public:
 
     // Initializes new sprite file with the given settings
     void Begin(int store_flags, AGS::Types::SpriteCompression compress);
-    // Writes bitmap into the file without any additional convertions
+    // Writes bitmap into the file without any additional convertions;
+    // the native writer compresses the bitmaps in background, see End()
     void WriteBitmap(System::Drawing::Bitmap ^image);
     // Converts bitmap according to the sprite's properties, and writes into the file
     void WriteBitmap(System::Drawing::Bitmap ^image, AGS::Types::SpriteImportTransparency transparency,
         bool remapColours, bool useRoomBackgroundColours, bool alphaChannel);
     // Writes an empty slot marker
     void WriteEmptySlot();
-    // Finalizes current format; no further writing is possible after this
+    // Writes the remaining bitmaps, and finalizes current format;
+    // no further writing is possible after this
     void End();
 
 private:
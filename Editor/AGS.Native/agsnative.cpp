@@ -3642,6 +3642,7 @@ void convert_room_from_native(const RoomStruct &rs, Room ^room, System::Text::En
     room->ColorDepth = rs.BgFrames[0].Graphic->GetColorDepth();
     room->BackgroundAnimationDelay = rs.BgAnimSpeed;
     room->BackgroundAnimationEnabled = (rs.Options.Flags & kRoomFlag_BkgFrameLocked) == 0;
+    room->PreloadAllBackgrounds = (rs.Options.Flags & kRoomFlag_PreloadAll) != 0;
     room->BackgroundCount = rs.BgFrameCount;
     room->Resolution = (AGS::Types::RoomResolution)rs.GetResolutionType();
     room->MaskResolution = rs.MaskResolution;
@@ -3836,6 +3837,8 @@ void convert_room_to_native(Room ^room, RoomStruct &rs)
     rs.Options.Flags = 0;
     if (!room->BackgroundAnimationEnabled)
         rs.Options.Flags |= kRoomFlag_BkgFrameLocked;
+    if (room->PreloadAllBackgrounds)
+        rs.Options.Flags |= kRoomFlag_PreloadAll;
 
 	rs.MessageCount = room->Messages->Count;
 	for (size_t i = 0; i < rs.MessageCount; ++i)
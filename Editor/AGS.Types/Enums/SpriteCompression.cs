@@ -7,6 +7,7 @@ namespace AGS.Types
         None,
         RLE,
         LZW,
-        Deflate
+        Deflate,
+        LZ4
     }
 }
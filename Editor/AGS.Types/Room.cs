@@ -42,6 +42,7 @@ namespace AGS.Types
         private int _height;
         private int _backgroundAnimationDelay = 5;
         private bool _backgroundAnimEnabled = true;
+        private bool _preloadAllBackgrounds;
         private int _backgroundCount;
         private int _gameId;
         private bool _modified;
@@ -306,6 +307,15 @@ namespace AGS.Types
             set { _backgroundAnimEnabled = value; }
         }
 
+        [Description("Whether all the background frames are decoded when the room is loaded, instead of each one on first use")]
+        [DefaultValue(false)]
+        [Category("Settings")]
+        public bool PreloadAllBackgrounds
+        {
+            get { return _preloadAllBackgrounds; }
+            set { _preloadAllBackgrounds = value; }
+        }
+
         [Obsolete]
         [Browsable(false)]
         // NOTE: have to keep setter here because we load old rooms before upgrading them
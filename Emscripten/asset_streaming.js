@@ -0,0 +1,120 @@
+// Streaming of the large game files, such as the game data and the audio
+// and speech packages: instead of being loaded whole before the game starts,
+// these are registered as the remote files, and the engine reads them in
+// blocks with the HTTP range requests, only when it needs the data.
+// The fetched blocks are kept in a small memory cache, and in IndexedDB,
+// so that the next visits to the game page do not download them again.
+// The server must support the range requests (most static servers do).
+
+var agsRemoteFiles = {};
+var agsBlockCache = new Map(); // recently read blocks, in the order of use
+var agsBlockCacheMax = 32;
+var agsBlockDB = null;
+var agsBlockDBName = 'ags_remote_blocks';
+
+function agsNormalizePath(path) {
+  path = path.replace(/\\/g, '/').replace(/\/\.\//g, '/').replace(/\/+/g, '/');
+  if (path.startsWith('./'))
+    path = path.substring(1);
+  if (!path.startsWith('/'))
+    path = '/' + path;
+  return path;
+}
+
+function agsOpenBlockDB() {
+  if (agsBlockDB)
+    return agsBlockDB;
+  agsBlockDB = new Promise(function(resolve) {
+    if (typeof indexedDB === 'undefined') {
+      resolve(null);
+      return;
+    }
+    var req = indexedDB.open(agsBlockDBName, 1);
+    req.onupgradeneeded = function() {
+      req.result.createObjectStore('blocks');
+    };
+    req.onsuccess = function() { resolve(req.result); };
+    req.onerror = function() { resolve(null); }; // e.g. private browsing mode
+  });
+  return agsBlockDB;
+}
+
+function agsBlockDBGet(key) {
+  return agsOpenBlockDB().then(function(db) {
+    if (!db)
+      return null;
+    return new Promise(function(resolve) {
+      var req = db.transaction('blocks', 'readonly').objectStore('blocks').get(key);
+      req.onsuccess = function() { resolve(req.result ? new Uint8Array(req.result) : null); };
+      req.onerror = function() { resolve(null); };
+    });
+  });
+}
+
+function agsBlockDBPut(key, data) {
+  agsOpenBlockDB().then(function(db) {
+    if (db)
+      db.transaction('blocks', 'readwrite').objectStore('blocks').put(data.buffer, key);
+  });
+}
+
+function agsBlockCacheAdd(key, data) {
+  agsBlockCache.delete(key);
+  agsBlockCache.set(key, data);
+  if (agsBlockCache.size > agsBlockCacheMax)
+    agsBlockCache.delete(agsBlockCache.keys().next().value);
+}
+
+// Registers the remote file, which is accessible to the engine by the given
+// path, and is downloaded from the url; calls back with true on success
+Module['agsAddRemoteFile'] = function(path, url, callback) {
+  fetch(url, { method: 'HEAD' }).then(function(response) {
+    var size = parseInt(response.headers.get('Content-Length'));
+    if (!response.ok || isNaN(size)) {
+      callback(false);
+      return;
+    }
+    // The blocks of the changed file must not be taken from the cache
+    var version = response.headers.get('ETag') || response.headers.get('Last-Modified') || '';
+    agsRemoteFiles[agsNormalizePath(path)] = { url: url, size: size, version: version + ':' + size };
+    callback(true);
+  }).catch(function() {
+    callback(false);
+  });
+};
+
+// Returns the size of the remote file, or -1 if there is no such file
+Module['agsRemoteFileSize'] = function(path) {
+  var file = agsRemoteFiles[agsNormalizePath(path)];
+  return file ? file.size : -1;
+};
+
+// Reads the block of the remote file, resolves with Uint8Array of its data
+Module['agsReadRemoteBlock'] = async function(path, index, block_size) {
+  var file = agsRemoteFiles[agsNormalizePath(path)];
+  if (!file)
+    throw new Error('remote file is not registered');
+  var key = file.url + '#' + file.version + '#' + block_size + '#' + index;
+  var data = agsBlockCache.get(key);
+  if (data) {
+    agsBlockCacheAdd(key, data); // mark as recently used
+    return data;
+  }
+  data = await agsBlockDBGet(key);
+  if (!data) {
+    var start = index * block_size;
+    var end = Math.min(start + block_size, file.size) - 1;
+    if (end < start)
+      return new Uint8Array(0);
+    var response = await fetch(file.url, { headers: { 'Range': 'bytes=' + start + '-' + end } });
+    if (!response.ok)
+      throw new Error('HTTP status ' + response.status);
+    data = new Uint8Array(await response.arrayBuffer());
+    // The server which ignores ranges sends the whole file
+    if (response.status !== 206)
+      data = data.slice(start, end + 1);
+    agsBlockDBPut(key, data);
+  }
+  agsBlockCacheAdd(key, data);
+  return data;
+};
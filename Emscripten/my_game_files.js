@@ -1,3 +1,8 @@
 var gamefiles = ['acsetup.cfg','my_ags_game.ags'];
 // fill this array with ALL your game files
 // and put them in the same location
+
+// optionally, list the large files (such as the game's .ags file, audio.vox
+// and speech.vox) here instead, to have them read on demand while the game
+// runs, rather than loaded whole before it starts
+var streamfiles = [];
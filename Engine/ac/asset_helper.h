@@ -38,6 +38,15 @@ AssetPath get_audio_clip_assetpath(int bundling_type, const String &filename);
 // Returns the path to the voice-over asset
 AssetPath get_voice_over_assetpath(const String &filename);
 
+// Starts recording the first use of each game asset into the text file,
+// one line per asset: "<time in ms> <room number> <asset name>";
+// the room number is -1 until the first room is loaded
+bool asset_trace_start(const String &filename);
+// Stops recording the asset trace and closes the file
+void asset_trace_stop();
+// Sets the room number written to the asset trace for the next assets
+void asset_trace_set_room(int room);
+
 // Custom AGS PACKFILE user object
 // TODO: it is preferrable to let our Stream define custom readable window instead,
 // keeping this as simple as possible for now (we may require a stream classes overhaul).
@@ -15,9 +15,11 @@
 // AGS Character functions
 //
 //=============================================================================
+#include <algorithm>
 #include <cstdio>
 #include "ac/character.h"
 #include "ac/common.h"
+#include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/display.h"
 #include "ac/draw.h"
@@ -56,6 +58,7 @@
 #include "gfx/graphicsdriver.h"
 #include "script/runtimescriptvalue.h"
 #include "ac/dynobj/cc_character.h"
+#include "ac/dynobj/cc_dynamicarray.h"
 #include "ac/dynobj/cc_inventory.h"
 #include "ac/dynobj/dynobj_manager.h"
 #include "script/script_runtime.h"
@@ -100,6 +103,7 @@ int loops_per_character, text_lips_offset, char_speaking = -1;
 int char_thinking = -1;
 const char *text_lips_text = nullptr;
 std::vector<SpeechLipSyncLine> splipsync;
+SpeechLipSyncIndex splipsync_index;
 int numLipLines = 0, curLipLine = -1, curLipLinePhoneme = 0;
 
 // **** CHARACTER: FUNCTIONS ****
@@ -167,6 +171,7 @@ void Character_AddInventory(CharacterInfo *chaa, ScriptInvItem *invi, int addInd
 
 void Character_AddWaypoint(CharacterInfo *chaa, int x, int y) {
 
+    complete_character_walk(chaa->index_id);
     if (chaa->room != displayed_room)
         quit("!MoveCharacterPath: specified character not in current room");
 
@@ -558,13 +563,14 @@ int Character_IsCollidingWithObject(CharacterInfo *chin, ScriptObject *objid) {
     if (objs[objid->id].on != 1)
         return 0;
 
-    Bitmap *checkblk = GetObjectImage(objid->id);
+    bool obj_original, char_original;
+    Bitmap *checkblk = GetObjectImage(objid->id, &obj_original);
     int objWidth = checkblk->GetWidth();
     int objHeight = checkblk->GetHeight();
     int o1x = objs[objid->id].x;
     int o1y = objs[objid->id].y - game_to_data_coord(objHeight);
 
-    Bitmap *charpic = GetCharacterImage(chin->index_id);
+    Bitmap *charpic = GetCharacterImage(chin->index_id, &char_original);
 
     int charWidth = charpic->GetWidth();
     int charHeight = charpic->GetHeight();
@@ -581,6 +587,17 @@ int Character_IsCollidingWithObject(CharacterInfo *chin, ScriptObject *objid) {
             // check if they're on a transparent bit of the object
             int stxp = data_to_game_coord(o2x - o1x);
             int styp = data_to_game_coord(o2y - o1y);
+            // the original sprites have their cached bit masks, which let
+            // to test a whole row of the char's feet at once
+            if (obj_original && char_original && (get_fixed_pixel_size(1) == 1))
+            {
+                const int sppic = views[chin->view].loops[chin->loop].frames[chin->frame].pic;
+                const BitMask *charmask = spriteset.GetSpriteMask(sppic);
+                const BitMask *objmask = spriteset.GetSpriteMask(objs[objid->id].num);
+                if (charmask && objmask)
+                    return charmask->Overlaps(*objmask, -stxp, charHeight - 5 - styp,
+                        Rect(0, charHeight - 5, charWidth - 1, charHeight - 1)) ? 1 : 0;
+            }
             int maskcol = checkblk->GetMaskColor ();
             int maskcolc = charpic->GetMaskColor ();
             int thispix, thispixc;
@@ -930,6 +947,7 @@ void Character_SetSpeed(CharacterInfo *chaa, int xspeed, int yspeed) {
 
     if ((xspeed == 0) || (yspeed == 0))
         quit("!SetCharacterSpeedEx: invalid speed value");
+    complete_character_walk(chaa->index_id);
     if ((chaa->walking > 0) && (loaded_game_file_version < kGameVersion_361))
     {
         debug_script_warn("Character_SetSpeed: cannot change speed while walking");
@@ -958,6 +976,7 @@ void Character_SetSpeed(CharacterInfo *chaa, int xspeed, int yspeed) {
 void Character_StopMoving(CharacterInfo *charp) {
 
     int chaa = charp->index_id;
+    cancel_route(chaa + CHMLSOFFS);
     if (chaa == play.skip_until_char_stops)
         EndSkippingUntilCharStops();
 
@@ -1056,6 +1075,30 @@ void Character_WalkStraight(CharacterInfo *chaa, int xx, int yy, int blocking) {
     walk_or_move_character_straight(chaa, xx, yy, blocking, 1 /* use ANYWHERE */, true /* walk */);
 }
 
+void Character_WalkGroup(void *chars_arr, int x, int y) {
+    if (!chars_arr) {
+        debug_script_warn("Character.WalkGroup: null array passed");
+        return;
+    }
+    std::vector<void*> char_objs;
+    DynamicArrayHelpers::ReadObjectArray(chars_arr, char_objs);
+    std::vector<int> chars;
+    for (void *obj : char_objs) {
+        const CharacterInfo *chaa = static_cast<const CharacterInfo*>(obj);
+        if (!chaa)
+            continue;
+        if (chaa->on != 1) {
+            debug_script_warn("Character.WalkGroup: character '%s' is turned off and cannot be moved", chaa->scrname);
+            continue;
+        }
+        if (chaa->room != displayed_room)
+            quit("!Character.WalkGroup: specified character not in current room");
+        if (std::find(chars.begin(), chars.end(), chaa->index_id) == chars.end())
+            chars.push_back(chaa->index_id);
+    }
+    walk_character_group(chars, x, y, true);
+}
+
 void Character_MoveStraight(CharacterInfo *chaa, int xx, int yy, int blocking) {
 
     if (chaa->room != displayed_room)
@@ -1406,12 +1449,14 @@ void Character_SetLoop(CharacterInfo *chaa, int newval) {
 }
 
 int Character_GetMoving(CharacterInfo *chaa) {
+    complete_character_walk(chaa->index_id);
     if (chaa->walking)
         return 1;
     return 0;
 }
 
 int Character_GetDestinationX(CharacterInfo *chaa) {
+    complete_character_walk(chaa->index_id);
     if (chaa->walking) {
         MoveList *cmls = &mls[chaa->walking % TURNING_AROUND];
         return cmls->pos[cmls->numstage - 1].X;
@@ -1421,6 +1466,7 @@ int Character_GetDestinationX(CharacterInfo *chaa) {
 }
 
 int Character_GetDestinationY(CharacterInfo *chaa) {
+    complete_character_walk(chaa->index_id);
     if (chaa->walking) {
         MoveList *cmls = &mls[chaa->walking % TURNING_AROUND];
         return cmls->pos[cmls->numstage - 1].Y;
@@ -1695,7 +1741,58 @@ int Character_GetSpeakingFrame(CharacterInfo *chaa) {
 // order of loops to turn character in circle from down to down
 int turnlooporder[8] = {0, 6, 1, 7, 3, 5, 2, 4};
 
-void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims) {
+// Character state saved when the walk is requested, applied when it starts
+struct WalkStartState
+{
+    int   WaitWas = 0;
+    int   AnimWaitWas = 0;
+    float StepFrac = 0.f;
+    bool  AutoWalkAnims = false;
+    int   IgnoreWalls = 0;
+    // position of the character by the time of the request, and destination
+    int   FromX = 0, FromY = 0;
+    int   ToX = 0, ToY = 0;
+};
+
+// Walks waiting for the asynchronous route search, per character
+static std::vector<WalkStartState> pending_walks;
+
+static void start_character_walk(int chac, int mslot, const WalkStartState &state)
+{
+    CharacterInfo *chin = &game.chars[chac];
+    if (mslot>0) {
+        chin->walking = mslot;
+        mls[mslot].direct = state.IgnoreWalls;
+        convert_move_path_to_room_resolution(&mls[mslot]);
+
+        if (state.StepFrac > 0.f)
+        {
+            mls[mslot].SetPixelUnitFraction(state.StepFrac);
+        }
+
+        // cancel any pending waits on current animations
+        // or if they were already moving, keep the current wait - 
+        // this prevents a glitch if MoveCharacter is called when they
+        // are already moving
+        if (state.AutoWalkAnims)
+        {
+            chin->walkwait = state.WaitWas;
+            charextra[chac].animwait = state.AnimWaitWas;
+
+            if (mls[mslot].pos[0] != mls[mslot].pos[1]) {
+                fix_player_sprite(&mls[mslot],chin);
+            }
+        }
+        else
+            chin->flags |= CHF_MOVENOTWALK;
+    }
+    else if (state.AutoWalkAnims) // pathfinder couldn't get a route, stand them still
+        chin->frame = 0;
+}
+
+// Stops the character's current move and prepares them for the new walk;
+// returns false if the character is already at the destination
+static bool begin_character_walk(int chac, int tox, int toy, int ignwal, bool autoWalkAnims, WalkStartState &state) {
     CharacterInfo*chin=&game.chars[chac];
     if (chin->room!=displayed_room)
         quit("!MoveCharacter: character not in current room");
@@ -1705,7 +1802,7 @@ void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims) {
     if ((tox == chin->x) && (toy == chin->y)) {
         StopMoving(chac);
         debug_script_log("%s already at destination, not moving", chin->scrname);
-        return;
+        return false;
     }
 
     if ((chin->animating) && (autoWalkAnims))
@@ -1719,21 +1816,26 @@ void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims) {
     // but save their frame first so that if they're already
     // moving it looks smoother
     int oldframe = chin->frame;
-    int waitWas = 0, animWaitWas = 0;
-    float wasStepFrac = 0.f;
+    state = WalkStartState();
+    state.AutoWalkAnims = autoWalkAnims;
+    state.IgnoreWalls = ignwal;
+    state.ToX = tox;
+    state.ToY = toy;
     // if they are currently walking, save the current Wait
     if (chin->walking)
     {
-        waitWas = chin->walkwait;
-        animWaitWas = charextra[chac].animwait;
+        state.WaitWas = chin->walkwait;
+        state.AnimWaitWas = charextra[chac].animwait;
         const auto &movelist = mls[chin->walking % TURNING_AROUND];
         // We set (fraction + 1), because movelist is always +1 ahead of current character pos;
         if (movelist.onpart > 0.f)
-            wasStepFrac = movelist.GetPixelUnitFraction() + movelist.GetStepLength();
+            state.StepFrac = movelist.GetPixelUnitFraction() + movelist.GetStepLength();
     }
 
     StopMoving (chac);
     chin->frame = oldframe;
+    state.FromX = chin->x;
+    state.FromY = chin->y;
     // use toxPassedIn cached variable so the hi-res co-ordinates
     // are still displayed as such
     debug_script_log("%s: Start move to %d,%d", chin->scrname, tox, toy);
@@ -1744,43 +1846,88 @@ void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims) {
     {
         debug_script_warn("MoveCharacter: called for '%s' with walk speed 0", chin->scrname);
     }
+    return true;
+}
+
+void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims, bool async) {
+    WalkStartState state;
+    if (!begin_character_walk(chac, tox, toy, ignwal, autoWalkAnims, state))
+        return;
 
+    CharacterInfo*chin=&game.chars[chac];
+    int move_speed_x, move_speed_y;
+    chin->get_effective_walkspeeds(move_speed_x, move_speed_y);
     // Convert src and dest coords to the mask resolution, for pathfinder
     const int src_x = room_to_mask_coord(chin->x);
     const int src_y = room_to_mask_coord(chin->y);
     const int dst_x = room_to_mask_coord(tox);
     const int dst_y = room_to_mask_coord(toy);
 
+    if (async && find_route_async(src_x, src_y, dst_x, dst_y, move_speed_x, move_speed_y,
+        prepare_walkable_areas(chac), chac+CHMLSOFFS, 1, ignwal))
+    {
+        if (pending_walks.size() < static_cast<size_t>(game.numcharacters))
+            pending_walks.resize(game.numcharacters);
+        pending_walks[chac] = state;
+        return;
+    }
+
     int mslot = find_route(src_x, src_y, dst_x, dst_y, move_speed_x, move_speed_y,
         prepare_walkable_areas(chac), chac+CHMLSOFFS, 1, ignwal);
-    if (mslot>0) {
-        chin->walking = mslot;
-        mls[mslot].direct = ignwal;
-        convert_move_path_to_room_resolution(&mls[mslot]);
+    start_character_walk(chac, mslot, state);
+}
 
-        if (wasStepFrac > 0.f)
-        {
-            mls[mslot].SetPixelUnitFraction(wasStepFrac);
+void walk_character_group(const std::vector<int> &chars, int tox, int toy, bool autoWalkAnims) {
+    std::vector<int> group;
+    std::vector<WalkStartState> states;
+    std::vector<RouteSource> sources;
+    for (int chac : chars) {
+        // non-blocking characters use the unobstructed walkable areas
+        if (game.chars[chac].flags & CHF_NOBLOCKING) {
+            walk_character(chac, tox, toy, 0, autoWalkAnims);
+            continue;
         }
+        WalkStartState state;
+        if (!begin_character_walk(chac, tox, toy, 0, autoWalkAnims, state))
+            continue;
 
-        // cancel any pending waits on current animations
-        // or if they were already moving, keep the current wait - 
-        // this prevents a glitch if MoveCharacter is called when they
-        // are already moving
-        if (autoWalkAnims)
-        {
-            chin->walkwait = waitWas;
-            charextra[chac].animwait = animWaitWas;
+        RouteSource src;
+        src.X = room_to_mask_coord(game.chars[chac].x);
+        src.Y = room_to_mask_coord(game.chars[chac].y);
+        game.chars[chac].get_effective_walkspeeds(src.MoveSpeedX, src.MoveSpeedY);
+        src.MoveList = chac + CHMLSOFFS;
+        group.push_back(chac);
+        states.push_back(state);
+        sources.push_back(src);
+    }
+    if (group.empty())
+        return;
 
-            if (mls[mslot].pos[0] != mls[mslot].pos[1]) {
-                fix_player_sprite(&mls[mslot],chin);
-            }
-        }
-        else
-            chin->flags |= CHF_MOVENOTWALK;
+    std::vector<int> mslots;
+    find_routes_to(sources, room_to_mask_coord(tox), room_to_mask_coord(toy),
+        prepare_walkable_areas_for_group(group), mslots);
+    for (size_t i = 0; i < group.size(); ++i)
+        start_character_walk(group[i], mslots[i], states[i]);
+}
+
+void complete_character_walk(int chac)
+{
+    const int movlst = chac + CHMLSOFFS;
+    if (!is_route_pending(movlst))
+        return;
+
+    const WalkStartState state = pending_walks[chac];
+    const CharacterInfo *chin = &game.chars[chac];
+    if ((chin->x != state.FromX) || (chin->y != state.FromY) || (chin->room != displayed_room))
+    {
+        // character was relocated meanwhile, the route is no longer valid
+        cancel_route(movlst);
+        if (chin->room == displayed_room)
+            walk_character(chac, state.ToX, state.ToY, state.IgnoreWalls, state.AutoWalkAnims);
+        return;
     }
-    else if (autoWalkAnims) // pathfinder couldn't get a route, stand them still
-        chin->frame = 0;
+
+    start_character_walk(chac, complete_route(movlst), state);
 }
 
 int find_looporder_index (int curloop) {
@@ -1998,7 +2145,7 @@ int find_nearest_walkable_area_within(int *xx, int *yy, int range, int step)
     for (ex = startx; ex < xwidth; ex += step) {
         for (ey = starty; ey < yheight; ey += step) {
             // non-walkalbe, so don't go here
-            if (thisroom.WalkAreaMask->GetPixel(ex,ey) == 0) continue;
+            if (thisroom.WalkAreaMask->GetPixel8(ex,ey) == 0) continue;
             // off a screen edge, don't move them there
             if ((ex <= leftEdge) || (ex >= rightEdge) ||
                 (ey <= topEdge) || (ey >= bottomEdge))
@@ -2020,7 +2167,7 @@ int find_nearest_walkable_area_within(int *xx, int *yy, int range, int step)
 
 void find_nearest_walkable_area (int *xx, int *yy) {
 
-    int pixValue = thisroom.WalkAreaMask->GetPixel(room_to_mask_coord(xx[0]), room_to_mask_coord(yy[0]));
+    int pixValue = thisroom.WalkAreaMask->GetPixel8(room_to_mask_coord(xx[0]), room_to_mask_coord(yy[0]));
     // only fix this code if the game was built with 2.61 or above
     if (pixValue == 0 || (loaded_game_file_version >= kGameVersion_261 && pixValue < 1))
     {
@@ -2063,10 +2210,12 @@ void walk_or_move_character(CharacterInfo *chaa, int x, int y, int blocking, int
         return;
     }
 
+    // only non-blocking walks may wait for the route search in background
+    const bool async = usetup.AsyncPathfinder && (blocking != BLOCKING) && (blocking != 1);
     if ((direct == ANYWHERE) || (direct == 1))
         walk_character(chaa->index_id, x, y, 1, isWalk);
     else if ((direct == WALKABLE_AREAS) || (direct == 0))
-        walk_character(chaa->index_id, x, y, 0, isWalk);
+        walk_character(chaa->index_id, x, y, 0, isWalk, async);
     else
         quit("!Character.Walk: Direct must be ANYWHERE or WALKABLE_AREAS");
 
@@ -2205,6 +2354,8 @@ void animate_character(CharacterInfo *chap, int loopn, int sppd, int rept,
         chap->scrname, chap->view+1, loopn, sppd, rept, sframe);
 
     Character_StopMoving(chap);
+    // start loading the rest of the animation frames in background
+    prefetch_view(chap->view, loopn, loopn);
 
     chap->set_animating(rept != 0, direction == 0, sppd);
     chap->loop=loopn;
@@ -2323,6 +2474,11 @@ int is_pos_on_character(int xx,int yy) {
         if (usehit==0) usehit= game.SpriteInfos[sppic].Height;
         int xxx = chin->x - game_to_data_coord(usewid) / 2;
         int yyy = charextra[cc].GetEffectiveY(chin) - game_to_data_coord(usehit);
+        const int bbox_wid = game_to_data_coord(usewid), bbox_hit = game_to_data_coord(usehit);
+        // test the bounding box before getting the image, which may be costly
+        if ((bbox_wid > 0) && (bbox_hit > 0) &&
+            !isposinbox(xx, yy, xxx, yyy, xxx + bbox_wid, yyy + bbox_hit))
+            continue;
         int mirrored = views[chin->view].loops[chin->loop].frames[chin->frame].flags & VFLG_FLIPSPRITE;
 
         bool is_original;
@@ -2331,8 +2487,7 @@ int is_pos_on_character(int xx,int yy) {
             mirrored = 0; // transformed image is already flipped
 
         if (is_pos_in_sprite(xx,yy,xxx,yyy, theImage,
-            game_to_data_coord(usewid),
-            game_to_data_coord(usehit), mirrored, is_original) == FALSE)
+            bbox_wid, bbox_hit, mirrored, is_original) == FALSE)
             continue;
 
         int use_base = chin->get_baseline();
@@ -2480,11 +2635,12 @@ void _displayspeech(const char*texx, int aschar, int xx, int yy, int widd, int i
     if (play.bgspeech_stay_on_display == 0)
     {
         // remove any background speech
-        auto &overs = get_overlays();
-        for (auto &over : overs)
+        const auto &overs = get_overlays();
+        const std::vector<int> ids = get_overlay_ids(); // copy, as it changes while removing
+        for (int type : ids)
         {
-            if (over.timeout > 0)
-                remove_screen_overlay(over.type);
+            if (overs[type].timeout > 0)
+                remove_screen_overlay(type);
         }
     }
     said_text = 1;
@@ -3413,6 +3569,12 @@ RuntimeScriptValue Sc_Character_Walk(void *self, const RuntimeScriptValue *param
 }
 
 // void (CharacterInfo *chaa, int xx, int yy, int blocking)
+// void (void *chars_arr, int x, int y)
+RuntimeScriptValue Sc_Character_WalkGroup(const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_SCALL_VOID_POBJ_PINT2(Character_WalkGroup, void);
+}
+
 RuntimeScriptValue Sc_Character_WalkStraight(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
     API_OBJCALL_VOID_PINT3(CharacterInfo, Character_WalkStraight);
@@ -4027,105 +4189,106 @@ void RegisterCharacterAPI(ScriptAPIVersion base_api, ScriptAPIVersion /*compat_a
         { "Character::UnlockView^1",              API_FN_PAIR(Character_UnlockViewEx) },
         { "Character::Walk^4",                    API_FN_PAIR(Character_Walk) },
         { "Character::WalkStraight^3",            API_FN_PAIR(Character_WalkStraight) },
+        { "Character::WalkGroup^3",               API_FN_PAIR(Character_WalkGroup) },
         
         { "Character::get_ActiveInventory",       API_FN_PAIR(Character_GetActiveInventory) },
         { "Character::set_ActiveInventory",       API_FN_PAIR(Character_SetActiveInventory) },
-        { "Character::get_Animating",             API_FN_PAIR(Character_GetAnimating) },
-        { "Character::get_AnimationSpeed",        API_FN_PAIR(Character_GetAnimationSpeed) },
-        { "Character::set_AnimationSpeed",        API_FN_PAIR(Character_SetAnimationSpeed) },
-        { "Character::get_AnimationVolume",       API_FN_PAIR(Character_GetAnimationVolume) },
-        { "Character::set_AnimationVolume",       API_FN_PAIR(Character_SetAnimationVolume) },
-        { "Character::get_Baseline",              API_FN_PAIR(Character_GetBaseline) },
-        { "Character::set_Baseline",              API_FN_PAIR(Character_SetBaseline) },
-        { "Character::get_BlinkInterval",         API_FN_PAIR(Character_GetBlinkInterval) },
-        { "Character::set_BlinkInterval",         API_FN_PAIR(Character_SetBlinkInterval) },
-        { "Character::get_BlinkView",             API_FN_PAIR(Character_GetBlinkView) },
-        { "Character::set_BlinkView",             API_FN_PAIR(Character_SetBlinkView) },
-        { "Character::get_BlinkWhileThinking",    API_FN_PAIR(Character_GetBlinkWhileThinking) },
-        { "Character::set_BlinkWhileThinking",    API_FN_PAIR(Character_SetBlinkWhileThinking) },
-        { "Character::get_BlockingHeight",        API_FN_PAIR(Character_GetBlockingHeight) },
-        { "Character::set_BlockingHeight",        API_FN_PAIR(Character_SetBlockingHeight) },
-        { "Character::get_BlockingWidth",         API_FN_PAIR(Character_GetBlockingWidth) },
-        { "Character::set_BlockingWidth",         API_FN_PAIR(Character_SetBlockingWidth) },
-        { "Character::get_Clickable",             API_FN_PAIR(Character_GetClickable) },
-        { "Character::set_Clickable",             API_FN_PAIR(Character_SetClickable) },
-        { "Character::get_DestinationX",          API_FN_PAIR(Character_GetDestinationX) },
-        { "Character::get_DestinationY",          API_FN_PAIR(Character_GetDestinationY) },
-        { "Character::get_DiagonalLoops",         API_FN_PAIR(Character_GetDiagonalWalking) },
-        { "Character::set_DiagonalLoops",         API_FN_PAIR(Character_SetDiagonalWalking) },
-        { "Character::get_Frame",                 API_FN_PAIR(Character_GetFrame) },
-        { "Character::set_Frame",                 API_FN_PAIR(Character_SetFrame) },
-        { "Character::get_ID",                    API_FN_PAIR(Character_GetID) },
-        { "Character::get_IdleView",              API_FN_PAIR(Character_GetIdleView) },
-        { "Character::get_IdleAnimationDelay",    API_FN_PAIR(Character_GetIdleAnimationDelay) },
-        { "Character::set_IdleAnimationDelay",    API_FN_PAIR(Character_SetIdleAnimationDelay) },
+        { "Character::get_Animating",             API_FN_FAST(Character_GetAnimating) },
+        { "Character::get_AnimationSpeed",        API_FN_FAST(Character_GetAnimationSpeed) },
+        { "Character::set_AnimationSpeed",        API_FN_FAST(Character_SetAnimationSpeed) },
+        { "Character::get_AnimationVolume",       API_FN_FAST(Character_GetAnimationVolume) },
+        { "Character::set_AnimationVolume",       API_FN_FAST(Character_SetAnimationVolume) },
+        { "Character::get_Baseline",              API_FN_FAST(Character_GetBaseline) },
+        { "Character::set_Baseline",              API_FN_FAST(Character_SetBaseline) },
+        { "Character::get_BlinkInterval",         API_FN_FAST(Character_GetBlinkInterval) },
+        { "Character::set_BlinkInterval",         API_FN_FAST(Character_SetBlinkInterval) },
+        { "Character::get_BlinkView",             API_FN_FAST(Character_GetBlinkView) },
+        { "Character::set_BlinkView",             API_FN_FAST(Character_SetBlinkView) },
+        { "Character::get_BlinkWhileThinking",    API_FN_FAST(Character_GetBlinkWhileThinking) },
+        { "Character::set_BlinkWhileThinking",    API_FN_FAST(Character_SetBlinkWhileThinking) },
+        { "Character::get_BlockingHeight",        API_FN_FAST(Character_GetBlockingHeight) },
+        { "Character::set_BlockingHeight",        API_FN_FAST(Character_SetBlockingHeight) },
+        { "Character::get_BlockingWidth",         API_FN_FAST(Character_GetBlockingWidth) },
+        { "Character::set_BlockingWidth",         API_FN_FAST(Character_SetBlockingWidth) },
+        { "Character::get_Clickable",             API_FN_FAST(Character_GetClickable) },
+        { "Character::set_Clickable",             API_FN_FAST(Character_SetClickable) },
+        { "Character::get_DestinationX",          API_FN_FAST(Character_GetDestinationX) },
+        { "Character::get_DestinationY",          API_FN_FAST(Character_GetDestinationY) },
+        { "Character::get_DiagonalLoops",         API_FN_FAST(Character_GetDiagonalWalking) },
+        { "Character::set_DiagonalLoops",         API_FN_FAST(Character_SetDiagonalWalking) },
+        { "Character::get_Frame",                 API_FN_FAST(Character_GetFrame) },
+        { "Character::set_Frame",                 API_FN_FAST(Character_SetFrame) },
+        { "Character::get_ID",                    API_FN_FAST(Character_GetID) },
+        { "Character::get_IdleView",              API_FN_FAST(Character_GetIdleView) },
+        { "Character::get_IdleAnimationDelay",    API_FN_FAST(Character_GetIdleAnimationDelay) },
+        { "Character::set_IdleAnimationDelay",    API_FN_FAST(Character_SetIdleAnimationDelay) },
         { "Character::geti_InventoryQuantity",    API_FN_PAIR(Character_GetIInventoryQuantity) },
         { "Character::seti_InventoryQuantity",    API_FN_PAIR(Character_SetIInventoryQuantity) },
-        { "Character::get_IgnoreLighting",        API_FN_PAIR(Character_GetIgnoreLighting) },
-        { "Character::set_IgnoreLighting",        API_FN_PAIR(Character_SetIgnoreLighting) },
-        { "Character::get_IgnoreScaling",         API_FN_PAIR(Character_GetIgnoreScaling) },
-        { "Character::set_IgnoreScaling",         API_FN_PAIR(Character_SetIgnoreScaling) },
-        { "Character::get_IgnoreWalkbehinds",     API_FN_PAIR(Character_GetIgnoreWalkbehinds) },
-        { "Character::set_IgnoreWalkbehinds",     API_FN_PAIR(Character_SetIgnoreWalkbehinds) },
-        { "Character::get_Loop",                  API_FN_PAIR(Character_GetLoop) },
-        { "Character::set_Loop",                  API_FN_PAIR(Character_SetLoop) },
-        { "Character::get_ManualScaling",         API_FN_PAIR(Character_GetIgnoreScaling) },
-        { "Character::set_ManualScaling",         API_FN_PAIR(Character_SetManualScaling) },
-        { "Character::get_MovementLinkedToAnimation",API_FN_PAIR(Character_GetMovementLinkedToAnimation) },
-        { "Character::set_MovementLinkedToAnimation",API_FN_PAIR(Character_SetMovementLinkedToAnimation) },
-        { "Character::get_Moving",                API_FN_PAIR(Character_GetMoving) },
+        { "Character::get_IgnoreLighting",        API_FN_FAST(Character_GetIgnoreLighting) },
+        { "Character::set_IgnoreLighting",        API_FN_FAST(Character_SetIgnoreLighting) },
+        { "Character::get_IgnoreScaling",         API_FN_FAST(Character_GetIgnoreScaling) },
+        { "Character::set_IgnoreScaling",         API_FN_FAST(Character_SetIgnoreScaling) },
+        { "Character::get_IgnoreWalkbehinds",     API_FN_FAST(Character_GetIgnoreWalkbehinds) },
+        { "Character::set_IgnoreWalkbehinds",     API_FN_FAST(Character_SetIgnoreWalkbehinds) },
+        { "Character::get_Loop",                  API_FN_FAST(Character_GetLoop) },
+        { "Character::set_Loop",                  API_FN_FAST(Character_SetLoop) },
+        { "Character::get_ManualScaling",         API_FN_FAST(Character_GetIgnoreScaling) },
+        { "Character::set_ManualScaling",         API_FN_FAST(Character_SetManualScaling) },
+        { "Character::get_MovementLinkedToAnimation",API_FN_FAST(Character_GetMovementLinkedToAnimation) },
+        { "Character::set_MovementLinkedToAnimation",API_FN_FAST(Character_SetMovementLinkedToAnimation) },
+        { "Character::get_Moving",                API_FN_FAST(Character_GetMoving) },
         { "Character::get_Name",                  API_FN_PAIR(Character_GetName) },
         { "Character::set_Name",                  API_FN_PAIR(Character_SetName) },
-        { "Character::get_NormalView",            API_FN_PAIR(Character_GetNormalView) },
-        { "Character::get_PreviousRoom",          API_FN_PAIR(Character_GetPreviousRoom) },
-        { "Character::get_Room",                  API_FN_PAIR(Character_GetRoom) },
-        { "Character::get_ScaleMoveSpeed",        API_FN_PAIR(Character_GetScaleMoveSpeed) },
-        { "Character::set_ScaleMoveSpeed",        API_FN_PAIR(Character_SetScaleMoveSpeed) },
-        { "Character::get_ScaleVolume",           API_FN_PAIR(Character_GetScaleVolume) },
-        { "Character::set_ScaleVolume",           API_FN_PAIR(Character_SetScaleVolume) },
-        { "Character::get_Scaling",               API_FN_PAIR(Character_GetScaling) },
-        { "Character::set_Scaling",               API_FN_PAIR(Character_SetScaling) },
+        { "Character::get_NormalView",            API_FN_FAST(Character_GetNormalView) },
+        { "Character::get_PreviousRoom",          API_FN_FAST(Character_GetPreviousRoom) },
+        { "Character::get_Room",                  API_FN_FAST(Character_GetRoom) },
+        { "Character::get_ScaleMoveSpeed",        API_FN_FAST(Character_GetScaleMoveSpeed) },
+        { "Character::set_ScaleMoveSpeed",        API_FN_FAST(Character_SetScaleMoveSpeed) },
+        { "Character::get_ScaleVolume",           API_FN_FAST(Character_GetScaleVolume) },
+        { "Character::set_ScaleVolume",           API_FN_FAST(Character_SetScaleVolume) },
+        { "Character::get_Scaling",               API_FN_FAST(Character_GetScaling) },
+        { "Character::set_Scaling",               API_FN_FAST(Character_SetScaling) },
         { "Character::get_ScriptName",            API_FN_PAIR(Character_GetScriptName) },
-        { "Character::get_Solid",                 API_FN_PAIR(Character_GetSolid) },
-        { "Character::set_Solid",                 API_FN_PAIR(Character_SetSolid) },
-        { "Character::get_Speaking",              API_FN_PAIR(Character_GetSpeaking) },
-        { "Character::get_SpeakingFrame",         API_FN_PAIR(Character_GetSpeakingFrame) },
-        { "Character::get_SpeechAnimationDelay",  API_FN_PAIR(GetCharacterSpeechAnimationDelay) },
-        { "Character::set_SpeechAnimationDelay",  API_FN_PAIR(Character_SetSpeechAnimationDelay) },
-        { "Character::get_SpeechColor",           API_FN_PAIR(Character_GetSpeechColor) },
-        { "Character::set_SpeechColor",           API_FN_PAIR(Character_SetSpeechColor) },
-        { "Character::get_SpeechView",            API_FN_PAIR(Character_GetSpeechView) },
-        { "Character::set_SpeechView",            API_FN_PAIR(Character_SetSpeechView) },
-        { "Character::get_Thinking",              API_FN_PAIR(Character_GetThinking) },
-        { "Character::get_ThinkingFrame",         API_FN_PAIR(Character_GetThinkingFrame) },
-        { "Character::get_ThinkView",             API_FN_PAIR(Character_GetThinkView) },
-        { "Character::set_ThinkView",             API_FN_PAIR(Character_SetThinkView) },
-        { "Character::get_Transparency",          API_FN_PAIR(Character_GetTransparency) },
-        { "Character::set_Transparency",          API_FN_PAIR(Character_SetTransparency) },
-        { "Character::get_TurnBeforeWalking",     API_FN_PAIR(Character_GetTurnBeforeWalking) },
-        { "Character::set_TurnBeforeWalking",     API_FN_PAIR(Character_SetTurnBeforeWalking) },
-        { "Character::get_View",                  API_FN_PAIR(Character_GetView) },
-        { "Character::get_WalkSpeedX",            API_FN_PAIR(Character_GetWalkSpeedX) },
-        { "Character::get_WalkSpeedY",            API_FN_PAIR(Character_GetWalkSpeedY) },
-        { "Character::get_X",                     API_FN_PAIR(Character_GetX) },
-        { "Character::set_X",                     API_FN_PAIR(Character_SetX) },
-        { "Character::get_x",                     API_FN_PAIR(Character_GetX) },
-        { "Character::set_x",                     API_FN_PAIR(Character_SetX) },
-        { "Character::get_Y",                     API_FN_PAIR(Character_GetY) },
-        { "Character::set_Y",                     API_FN_PAIR(Character_SetY) },
-        { "Character::get_y",                     API_FN_PAIR(Character_GetY) },
-        { "Character::set_y",                     API_FN_PAIR(Character_SetY) },
-        { "Character::get_Z",                     API_FN_PAIR(Character_GetZ) },
-        { "Character::set_Z",                     API_FN_PAIR(Character_SetZ) },
-        { "Character::get_z",                     API_FN_PAIR(Character_GetZ) },
-        { "Character::set_z",                     API_FN_PAIR(Character_SetZ) },
-        { "Character::get_HasExplicitLight",      API_FN_PAIR(Character_GetHasExplicitLight) },
-        { "Character::get_LightLevel",            API_FN_PAIR(Character_GetLightLevel) },
-        { "Character::get_TintBlue",              API_FN_PAIR(Character_GetTintBlue) },
-        { "Character::get_TintGreen",             API_FN_PAIR(Character_GetTintGreen) },
-        { "Character::get_TintRed",               API_FN_PAIR(Character_GetTintRed) },
-        { "Character::get_TintSaturation",        API_FN_PAIR(Character_GetTintSaturation) },
-        { "Character::get_TintLuminance",         API_FN_PAIR(Character_GetTintLuminance) },
+        { "Character::get_Solid",                 API_FN_FAST(Character_GetSolid) },
+        { "Character::set_Solid",                 API_FN_FAST(Character_SetSolid) },
+        { "Character::get_Speaking",              API_FN_FAST(Character_GetSpeaking) },
+        { "Character::get_SpeakingFrame",         API_FN_FAST(Character_GetSpeakingFrame) },
+        { "Character::get_SpeechAnimationDelay",  API_FN_FAST(GetCharacterSpeechAnimationDelay) },
+        { "Character::set_SpeechAnimationDelay",  API_FN_FAST(Character_SetSpeechAnimationDelay) },
+        { "Character::get_SpeechColor",           API_FN_FAST(Character_GetSpeechColor) },
+        { "Character::set_SpeechColor",           API_FN_FAST(Character_SetSpeechColor) },
+        { "Character::get_SpeechView",            API_FN_FAST(Character_GetSpeechView) },
+        { "Character::set_SpeechView",            API_FN_FAST(Character_SetSpeechView) },
+        { "Character::get_Thinking",              API_FN_FAST(Character_GetThinking) },
+        { "Character::get_ThinkingFrame",         API_FN_FAST(Character_GetThinkingFrame) },
+        { "Character::get_ThinkView",             API_FN_FAST(Character_GetThinkView) },
+        { "Character::set_ThinkView",             API_FN_FAST(Character_SetThinkView) },
+        { "Character::get_Transparency",          API_FN_FAST(Character_GetTransparency) },
+        { "Character::set_Transparency",          API_FN_FAST(Character_SetTransparency) },
+        { "Character::get_TurnBeforeWalking",     API_FN_FAST(Character_GetTurnBeforeWalking) },
+        { "Character::set_TurnBeforeWalking",     API_FN_FAST(Character_SetTurnBeforeWalking) },
+        { "Character::get_View",                  API_FN_FAST(Character_GetView) },
+        { "Character::get_WalkSpeedX",            API_FN_FAST(Character_GetWalkSpeedX) },
+        { "Character::get_WalkSpeedY",            API_FN_FAST(Character_GetWalkSpeedY) },
+        { "Character::get_X",                     API_FN_FAST(Character_GetX) },
+        { "Character::set_X",                     API_FN_FAST(Character_SetX) },
+        { "Character::get_x",                     API_FN_FAST(Character_GetX) },
+        { "Character::set_x",                     API_FN_FAST(Character_SetX) },
+        { "Character::get_Y",                     API_FN_FAST(Character_GetY) },
+        { "Character::set_Y",                     API_FN_FAST(Character_SetY) },
+        { "Character::get_y",                     API_FN_FAST(Character_GetY) },
+        { "Character::set_y",                     API_FN_FAST(Character_SetY) },
+        { "Character::get_Z",                     API_FN_FAST(Character_GetZ) },
+        { "Character::set_Z",                     API_FN_FAST(Character_SetZ) },
+        { "Character::get_z",                     API_FN_FAST(Character_GetZ) },
+        { "Character::set_z",                     API_FN_FAST(Character_SetZ) },
+        { "Character::get_HasExplicitLight",      API_FN_FAST(Character_GetHasExplicitLight) },
+        { "Character::get_LightLevel",            API_FN_FAST(Character_GetLightLevel) },
+        { "Character::get_TintBlue",              API_FN_FAST(Character_GetTintBlue) },
+        { "Character::get_TintGreen",             API_FN_FAST(Character_GetTintGreen) },
+        { "Character::get_TintRed",               API_FN_FAST(Character_GetTintRed) },
+        { "Character::get_TintSaturation",        API_FN_FAST(Character_GetTintSaturation) },
+        { "Character::get_TintLuminance",         API_FN_FAST(Character_GetTintLuminance) },
     };
 
     ccAddExternalFunctions(character_api);
@@ -18,6 +18,7 @@
 #ifndef __AGS_EE_AC__CHARACTER_H
 #define __AGS_EE_AC__CHARACTER_H
 
+#include <vector>
 #include "ac/characterinfo.h"
 #include "ac/characterextras.h"
 #include "ac/dynobj/scriptobject.h"
@@ -77,6 +78,7 @@ void    Character_UnlockViewEx(CharacterInfo *chaa, int stopMoving);
 void    Character_Walk(CharacterInfo *chaa, int x, int y, int blocking, int direct);
 void    Character_Move(CharacterInfo *chaa, int x, int y, int blocking, int direct);
 void    Character_WalkStraight(CharacterInfo *chaa, int xx, int yy, int blocking);
+void    Character_WalkGroup(void *chars_arr, int x, int y);
 
 void    Character_RunInteraction(CharacterInfo *chaa, int mood);
 
@@ -173,7 +175,14 @@ void animate_character(CharacterInfo *chap, int loopn, int sppd, int rept,
     int noidleoverride = 0, int direction = 0, int sframe = 0, int volume = 100);
 // Clears up animation parameters
 void stop_character_anim(CharacterInfo *chap);
-void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims);
+// Starts the character walk; if async is set, then the route may be searched
+// on the worker thread, and the walk starts when complete_character_walk is called
+void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims, bool async = false);
+// Starts the walk of many characters to the same destination, on walkable areas;
+// the group members do not block each other's way
+void walk_character_group(const std::vector<int> &chars, int tox, int toy, bool autoWalkAnims);
+// Starts the character walk which route was searched asynchronously, if any
+void complete_character_walk(int chac);
 int  find_looporder_index (int curloop);
 // returns 0 to use diagonal, 1 to not
 int  useDiagonal (CharacterInfo *char1);
@@ -188,7 +197,6 @@ int  doNextCharMoveStep (CharacterInfo *chi, int &char_index, CharacterExtras *c
 bool is_char_walking_ndirect(CharacterInfo *chi);
 int  find_nearest_walkable_area_within(int *xx, int *yy, int range, int step);
 void find_nearest_walkable_area (int *xx, int *yy);
-void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims);
 void FindReasonableLoopForCharacter(CharacterInfo *chap);
 // Start character walk or move
 void walk_or_move_character(CharacterInfo *chaa, int x, int y, int blocking, int direct, bool isWalk);
@@ -34,11 +34,12 @@ namespace AGS { namespace Common { class Stream; } }
 using namespace AGS; // FIXME later
 
 // The CharacterInfo struct size is fixed because it's exposed to script
-// and plugin API, therefore new stuff has to go here
+// and plugin API, therefore new stuff has to go here.
+// NOTE: the fields used by the per-frame character updates are kept at the
+// start of the struct, so that they share the cache lines; the large inventory
+// order array is at the end, as it's only accessed by the inventory functions.
 struct CharacterExtras
 {
-    short invorder[MAX_INVORDER]{};
-    short invorder_count = 0;
     // TODO: implement full AABB and keep updated, so that engine could rely on these cached values all time;
     // TODO: consider having both fixed AABB and volatile one that changes with animation frame (unless you change how anims work)
     short width = 0;
@@ -63,6 +64,9 @@ struct CharacterExtras
     // zoom factor of sprite offsets, fixed at 100 in backwards compatible mode
     int   zoom_offs = 100;
 
+    short invorder_count = 0;
+    short invorder[MAX_INVORDER]{};
+
     int GetEffectiveY(CharacterInfo *chi) const; // return Y - Z
 
     // Calculate wanted frame sound volume based on multiple factors
@@ -11,8 +11,10 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
 #include <stack>
 #include <stdio.h>
+#include <unordered_map>
 #include "ac/dialog.h"
 #include "ac/common.h"
 #include "ac/character.h"
@@ -337,56 +339,6 @@ int run_dialog_script(int dialogID, int offse, int optionIndex) {
   return result;
 }
 
-int write_dialog_options(Bitmap *ds, bool ds_has_alpha, int dlgxp, int curyp, int numdisp, int mouseison, int areawid,
-    int bullet_wid, int usingfont, DialogTopic*dtop, int*disporder, short*dispyp,
-    int linespacing, int utextcol, int padding) {
-  int ww;
-
-  color_t text_color;
-  for (ww=0;ww<numdisp;ww++) {
-
-    if ((dtop->optionflags[disporder[ww]] & DFLG_HASBEENCHOSEN) &&
-        (play.read_dialog_option_colour >= 0)) {
-      // 'read' colour
-      text_color = ds->GetCompatibleColor(play.read_dialog_option_colour);
-    }
-    else {
-      // 'unread' colour
-      text_color = ds->GetCompatibleColor(playerchar->talkcolor);
-    }
-
-    if (mouseison==ww) {
-      if (text_color == ds->GetCompatibleColor(utextcol))
-        text_color = ds->GetCompatibleColor(13); // the normal colour is the same as highlight col
-      else text_color = ds->GetCompatibleColor(utextcol);
-    }
-
-    const char *draw_text = skip_voiceover_token(get_translation(dtop->optionnames[disporder[ww]]));
-    break_up_text_into_lines(draw_text, Lines, areawid-(2*padding+2+bullet_wid), usingfont);
-    dispyp[ww]=curyp;
-    if (game.dialog_bullet > 0)
-    {
-        draw_gui_sprite_v330(ds, game.dialog_bullet, dlgxp, curyp, ds_has_alpha);
-    }
-    if (game.options[OPT_DIALOGNUMBERED] == kDlgOptNumbering) {
-      char tempbfr[20];
-      int actualpicwid = 0;
-      if (game.dialog_bullet > 0)
-        actualpicwid = game.SpriteInfos[game.dialog_bullet].Width+3;
-
-      snprintf(tempbfr, sizeof(tempbfr), "%d.", ww + 1);
-      wouttext_outline (ds, dlgxp + actualpicwid, curyp, usingfont, text_color, tempbfr);
-    }
-    for (size_t cc=0;cc<Lines.Count();cc++) {
-      wouttext_outline(ds, dlgxp+((cc==0) ? 0 : 9)+bullet_wid, curyp, usingfont, text_color, Lines[cc].GetCStr());
-      curyp+=linespacing;
-    }
-    if (ww < numdisp-1)
-      curyp += data_to_game_coord(game.options[OPT_DIALOGGAP]);
-  }
-  return curyp;
-}
-
 void draw_gui_for_dialog_options(Bitmap *ds, GUIMain *guib, int dlgxp, int dlgyp) {
   if (guib->BgColor != 0) {
     color_t draw_color = ds->GetCompatibleColor(guib->BgColor);
@@ -437,7 +389,26 @@ public:
     int GetChosenOption() const { return chose; }
 
 private:
+    // Option texts broken into lines of a certain width
+    struct WrappedOptions
+    {
+        std::vector<std::vector<String>> Lines; // per displayed option
+        int LongestLine = 0;
+    };
+
     void CalcOptionsHeight();
+    // Gets the displayed option texts broken into lines of the given width;
+    // these are kept while the options are shown, as the texts don't change
+    const WrappedOptions &GetWrappedOptions(int width);
+    // Draws all the displayed options, starting at the given position;
+    // returns the position below the last one
+    int WriteOptions(Bitmap *ds, bool ds_has_alpha, int x, int y, int utextcol);
+    // Draws one displayed option at the given position; returns the position below it
+    int WriteOption(Bitmap *ds, bool ds_has_alpha, int x, int y, int index, int utextcol);
+    // Redraws only the options which highlight has changed over the saved
+    // background, and updates the texture; returns false if the options
+    // have to be redrawn fully instead
+    bool RedrawHighlight(int old_option, int new_option);
     // Process all the buffered input events; returns if handled
     bool RunControls();
     // Process single key event; returns if handled
@@ -483,6 +454,13 @@ private:
     bool wantRefresh; // FIXME: merge with needRedraw? or better names
     bool usingCustomRendering;
     bool newCustomRender; // using newer (post-3.5.0 render API)
+    // Option texts broken into lines, by the line width
+    std::unordered_map<int, WrappedOptions> wrappedOptions;
+    // Copy of the default options' background, without the option texts
+    std::unique_ptr<Bitmap> optionsBg;
+    int optionsX; // position of the default options' texts
+    int optionsBottom; // bottom of the default options' area
+    bool optionsHaveAlpha;
     int orixp;
     int oriyp;
     int areawid;
@@ -500,11 +478,10 @@ private:
 void DialogOptions::CalcOptionsHeight()
 {
     needheight = 0;
+    const WrappedOptions &wrapped = GetWrappedOptions(areawid-(2*padding+2+bullet_wid));
     for (int i = 0; i < numdisp; ++i)
     {
-        const char *draw_text = skip_voiceover_token(get_translation(dtop->optionnames[disporder[i]]));
-        break_up_text_into_lines(draw_text, Lines, areawid-(2*padding+2+bullet_wid), usingfont);
-        needheight += get_text_lines_surf_height(usingfont, Lines.Count()) + data_to_game_coord(game.options[OPT_DIALOGGAP]);
+        needheight += get_text_lines_surf_height(usingfont, wrapped.Lines[i].size()) + data_to_game_coord(game.options[OPT_DIALOGGAP]);
     }
     if (parserInput)
     {
@@ -512,6 +489,107 @@ void DialogOptions::CalcOptionsHeight()
     }
 }
 
+const DialogOptions::WrappedOptions &DialogOptions::GetWrappedOptions(int width)
+{
+    auto it = wrappedOptions.find(width);
+    if (it != wrappedOptions.end())
+        return it->second;
+    WrappedOptions &wrapped = wrappedOptions[width];
+    wrapped.Lines.resize(numdisp);
+    for (int i = 0; i < numdisp; ++i)
+    {
+        const char *draw_text = skip_voiceover_token(get_translation(dtop->optionnames[disporder[i]]));
+        break_up_text_into_lines(draw_text, Lines, width, usingfont);
+        for (size_t cc = 0; cc < Lines.Count(); ++cc)
+            wrapped.Lines[i].push_back(Lines[cc]);
+        wrapped.LongestLine = std::max(wrapped.LongestLine, longestline);
+    }
+    return wrapped;
+}
+
+int DialogOptions::WriteOptions(Bitmap *ds, bool ds_has_alpha, int x, int y, int utextcol)
+{
+    for (int ww = 0; ww < numdisp; ++ww)
+    {
+        dispyp[ww] = y;
+        y = WriteOption(ds, ds_has_alpha, x, y, ww, utextcol);
+        if (ww < numdisp - 1)
+            y += data_to_game_coord(game.options[OPT_DIALOGGAP]);
+    }
+    return y;
+}
+
+int DialogOptions::WriteOption(Bitmap *ds, bool ds_has_alpha, int x, int y, int index, int utextcol)
+{
+    color_t text_color;
+    if ((dtop->optionflags[disporder[index]] & DFLG_HASBEENCHOSEN) &&
+        (play.read_dialog_option_colour >= 0)) {
+      // 'read' colour
+      text_color = ds->GetCompatibleColor(play.read_dialog_option_colour);
+    }
+    else {
+      // 'unread' colour
+      text_color = ds->GetCompatibleColor(playerchar->talkcolor);
+    }
+
+    if (mouseison == index) {
+      if (text_color == ds->GetCompatibleColor(utextcol))
+        text_color = ds->GetCompatibleColor(13); // the normal colour is the same as highlight col
+      else text_color = ds->GetCompatibleColor(utextcol);
+    }
+
+    const std::vector<String> &lines = GetWrappedOptions(areawid-(2*padding+2+bullet_wid)).Lines[index];
+    if (game.dialog_bullet > 0)
+    {
+        draw_gui_sprite_v330(ds, game.dialog_bullet, x, y, ds_has_alpha);
+    }
+    if (game.options[OPT_DIALOGNUMBERED] == kDlgOptNumbering) {
+      char tempbfr[20];
+      int actualpicwid = 0;
+      if (game.dialog_bullet > 0)
+        actualpicwid = game.SpriteInfos[game.dialog_bullet].Width+3;
+
+      snprintf(tempbfr, sizeof(tempbfr), "%d.", index + 1);
+      wouttext_outline (ds, x + actualpicwid, y, usingfont, text_color, tempbfr);
+    }
+    for (size_t cc = 0; cc < lines.size(); ++cc) {
+      wouttext_outline(ds, x+((cc==0) ? 0 : 9)+bullet_wid, y, usingfont, text_color, lines[cc].GetCStr());
+      y += linespacing;
+    }
+    return y;
+}
+
+bool DialogOptions::RedrawHighlight(int old_option, int new_option)
+{
+    // Only the default options may be redrawn alone, and not the parser
+    if (usingCustomRendering || !optionsBg || !ddb ||
+        (old_option < -1) || (old_option >= numdisp) ||
+        (new_option < -1) || (new_option >= numdisp))
+        return false;
+
+    const Rect dirty_rc = RectWH(dirtyx, dirtyy, subBitmap->GetWidth(), subBitmap->GetHeight());
+    for (const int opt : { old_option, new_option })
+    {
+        if (opt < 0)
+            continue;
+        // The option's area spans the whole options' width, and down to the next option
+        const int bottom = (opt + 1 < numdisp) ? dispyp[opt + 1] : optionsBottom;
+        const Rect rc = ClampToRect(dirty_rc, Rect(dirty_rc.Left, dispyp[opt], dirty_rc.Right, bottom - 1));
+        if (rc.IsEmpty())
+            continue;
+        tempScrn->Blit(optionsBg.get(), rc.Left, rc.Top, rc.Left, rc.Top, rc.GetWidth(), rc.GetHeight());
+        // Draw the neighbours too, clipped to the area, in case their texts overlap it
+        Bitmap area(tempScrn.get(), rc);
+        for (int i = std::max(0, opt - 1); i <= std::min(numdisp - 1, opt + 1); ++i)
+            WriteOption(&area, optionsHaveAlpha, optionsX - rc.Left, dispyp[i] - rc.Top, i, forecol);
+        subBitmap->Blit(tempScrn.get(), rc.Left, rc.Top, rc.Left - dirtyx, rc.Top - dirtyy, rc.GetWidth(), rc.GetHeight());
+    }
+    gfxDriver->UpdateDDBFromBitmap(ddb, subBitmap.get(), optionsHaveAlpha);
+    if (runGameLoopsInBackground)
+        render_graphics(ddb, dirtyx, dirtyy);
+    return true;
+}
+
 DialogOptions::DialogOptions(DialogTopic *dtop_, int dlgnum_, bool runGameLoopsInBackground_)
     : dtop(dtop_)
     , dlgnum(dlgnum_)
@@ -526,6 +604,7 @@ DialogOptions::~DialogOptions()
     parserInput.reset();
     subBitmap.reset();
     tempScrn.reset();
+    optionsBg.reset();
 }
 
 void DialogOptions::Show()
@@ -559,6 +638,11 @@ void DialogOptions::Begin()
     subBitmap = nullptr;
     parserInput = nullptr;
     said_text = 0;
+    wrappedOptions.clear();
+    optionsBg = nullptr;
+    optionsX = 0;
+    optionsBottom = 0;
+    optionsHaveAlpha = false;
 
     if (game.dialog_bullet > 0)
         bullet_wid = game.SpriteInfos[game.dialog_bullet].Width+3;
@@ -703,12 +787,7 @@ void DialogOptions::Draw()
       areawid = data_to_game_coord(play.max_dialogoption_width);
       int biggest = 0;
       padding = guis[game.options[OPT_DIALOGIFACE]].Padding;
-      for (int i = 0; i < numdisp; ++i) {
-        const char *draw_text = skip_voiceover_token(get_translation(dtop->optionnames[disporder[i]]));
-        break_up_text_into_lines(draw_text, Lines, areawid-((2*padding+2)+bullet_wid), usingfont);
-        if (longestline > biggest)
-          biggest = longestline;
-      }
+      biggest = GetWrappedOptions(areawid-((2*padding+2)+bullet_wid)).LongestLine;
       if (biggest < areawid - ((2*padding+6)+bullet_wid))
         areawid = biggest + ((2*padding+6)+bullet_wid);
 
@@ -744,12 +823,16 @@ void DialogOptions::Draw()
       // TODO: here we rely on draw_text_window always assigning new bitmap to text_window_ds;
       // should make this more explicit
       delete text_window_ds;
+      recycle_bitmap(optionsBg, ds->GetColorDepth(), ds->GetWidth(), ds->GetHeight());
+      optionsBg->Blit(ds);
 
       // Ignore the dialog_options_x/y offsets when using a text window
       txoffs += xspos;
       tyoffs += yspos;
       dlgyp = tyoffs;
-      curyp = write_dialog_options(ds, options_surface_has_alpha, txoffs,tyoffs,numdisp,mouseison,areawid,bullet_wid,usingfont,dtop,disporder,dispyp,linespacing,forecol,padding);
+      optionsX = txoffs;
+      curyp = WriteOptions(ds, options_surface_has_alpha, txoffs, tyoffs, forecol);
+      optionsBottom = curyp;
       if (parserInput)
         parserInput->X = txoffs;
     }
@@ -796,8 +879,11 @@ void DialogOptions::Draw()
       if (dlgyp < dirtyy)
         dirtyy = dlgyp;
 
-      curyp = dlgyp;
-      curyp = write_dialog_options(ds, options_surface_has_alpha, dlgxp,curyp,numdisp,mouseison,areawid,bullet_wid,usingfont,dtop,disporder,dispyp,linespacing,forecol,padding);
+      recycle_bitmap(optionsBg, ds->GetColorDepth(), ds->GetWidth(), ds->GetHeight());
+      optionsBg->Blit(ds);
+      optionsX = dlgxp;
+      curyp = WriteOptions(ds, options_surface_has_alpha, dlgxp, dlgyp, forecol);
+      optionsBottom = curyp;
 
       if (parserInput)
         parserInput->X = dlgxp;
@@ -824,6 +910,7 @@ void DialogOptions::Draw()
     }
 
     wantRefresh = false;
+    optionsHaveAlpha = options_surface_has_alpha;
 
     recycle_bitmap(subBitmap,
         gfxDriver->GetCompatibleBitmapFormat(tempScrn->GetColorDepth()), dirtywidth, dirtyheight);
@@ -889,7 +976,7 @@ bool DialogOptions::Run()
     }
 
     // Handle mouse over options
-    int mousewason = mouseison;
+    const int mousewason = mouseison;
     mouseison = -1;
     if (newCustomRender)
     {
@@ -951,12 +1038,9 @@ bool DialogOptions::Run()
         // could be set by setting ActiveOptionID, or calling Update()
         needRedraw |= ccDialogOptionsRendering.needRepaint;
     }
-    else
-    {
-        // Default rendering and old-style custom rendering:
-        // test if an active option has changed
-        needRedraw |= (mousewason != mouseison);
-    }
+    // Default rendering and old-style custom rendering:
+    // test if an active option has changed
+    const bool highlight_changed = !newCustomRender && (mousewason != mouseison);
 
     // Handle new parser's state
     if (parserInput && parserInput->IsActivated)
@@ -995,8 +1079,10 @@ bool DialogOptions::Run()
     if (chose >= 0)
         return false;
 
-    // Redraw if needed
-    if (needRedraw)
+    // Redraw if needed; if only the highlight has changed,
+    // then try redrawing only the affected options
+    if (needRedraw ||
+        (highlight_changed && !RedrawHighlight(mousewason, mouseison)))
         Draw();
 
     // Go for another options loop round
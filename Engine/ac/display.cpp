@@ -13,7 +13,8 @@
 //=============================================================================
 
 #include <math.h>
-
+#include <array>
+#include <list>
 #include <stdio.h>
 #include "ac/display.h"
 #include "ac/common.h"
@@ -139,6 +140,113 @@ private:
 
 
 
+// Describes everything that the composed textual image depends on, except
+// the fonts, which changes clear the cache
+struct TextualImageKey
+{
+    String Text;
+    int Font = 0;
+    int Width = 0;
+    int AsSpeech = 0;
+    int IsThought = 0;
+    int Gui = 0; // text window gui, speech or thought
+    int CustomTextWindow = 0;
+    int SpeechType = 0;
+    int AntiAlias = 0;
+    int TextAlign = 0;
+    int SpeechTextAlign = 0;
+    // Text window gui's looks
+    int GuiBgColor = 0, GuiFgColor = 0, GuiPadding = 0;
+    // Text window gui's background and border sprites
+    std::array<int, 9> GuiPics{};
+    // Top bar settings
+    bool HasTopBar = false;
+    String TopBarText;
+    int TopBarFont = 0, TopBarHeight = 0;
+    int TopBarBackColor = 0, TopBarBorderColor = 0, TopBarBorderWidth = 0, TopBarTextColor = 0;
+
+    bool operator ==(const TextualImageKey &other) const
+    {
+        return Font == other.Font && Width == other.Width && AsSpeech == other.AsSpeech &&
+            IsThought == other.IsThought && Gui == other.Gui &&
+            CustomTextWindow == other.CustomTextWindow && SpeechType == other.SpeechType &&
+            AntiAlias == other.AntiAlias && TextAlign == other.TextAlign &&
+            SpeechTextAlign == other.SpeechTextAlign && GuiBgColor == other.GuiBgColor &&
+            GuiFgColor == other.GuiFgColor && GuiPadding == other.GuiPadding &&
+            GuiPics == other.GuiPics && HasTopBar == other.HasTopBar &&
+            TopBarFont == other.TopBarFont && TopBarHeight == other.TopBarHeight &&
+            TopBarBackColor == other.TopBarBackColor && TopBarBorderColor == other.TopBarBorderColor &&
+            TopBarBorderWidth == other.TopBarBorderWidth && TopBarTextColor == other.TopBarTextColor &&
+            Text == other.Text && TopBarText == other.TopBarText;
+    }
+};
+
+struct TextualImageEntry
+{
+    TextualImageKey Key;
+    std::unique_ptr<Bitmap> Image;
+    int OffX = 0, OffY = 0; // image offset from the requested position
+    bool AlphaChannel = false;
+};
+
+// Recently composed textual images, the most recently used first;
+// lets reuse them when the same message is displayed repeatedly
+static std::list<TextualImageEntry> TextualImageCache;
+static const size_t TextualImageCacheSize = 8;
+
+static TextualImageKey make_textual_image_key(const char *text, int usingfont, int wii,
+    int asspch, int isThought, int usingGui, const TopBarSettings *topbar)
+{
+    TextualImageKey key;
+    key.Text = text;
+    key.Font = usingfont;
+    key.Width = wii;
+    key.AsSpeech = asspch;
+    key.IsThought = isThought;
+    key.Gui = usingGui;
+    key.CustomTextWindow = game.options[OPT_TWCUSTOM];
+    key.SpeechType = game.options[OPT_SPEECHTYPE];
+    key.AntiAlias = game.options[OPT_ANTIALIASFONTS];
+    key.TextAlign = play.text_align;
+    key.SpeechTextAlign = play.speech_text_align;
+
+    const int tw_gui = (usingGui >= 0) ? usingGui : game.options[OPT_TWCUSTOM];
+    if ((tw_gui > 0) && (tw_gui < game.numgui) && guis[tw_gui].IsTextWindow())
+    {
+        const GUIMain &gui = guis[tw_gui];
+        key.GuiBgColor = gui.BgColor;
+        key.GuiFgColor = gui.FgColor;
+        key.GuiPadding = gui.Padding;
+        key.GuiPics[0] = gui.BgImage;
+        for (int i = 0; i < 8; ++i)
+            key.GuiPics[i + 1] = get_but_pic(&guis[tw_gui], i);
+    }
+
+    if (topbar)
+    {
+        key.HasTopBar = true;
+        key.TopBarText = topbar->Text;
+        key.TopBarFont = topbar->Font;
+        key.TopBarHeight = topbar->Height;
+        key.TopBarBackColor = play.top_bar_backcolor;
+        key.TopBarBorderColor = play.top_bar_bordercolor;
+        key.TopBarBorderWidth = play.top_bar_borderwidth;
+        key.TopBarTextColor = play.top_bar_textcolor;
+    }
+    return key;
+}
+
+void invalidate_textual_image_cache(int sprnum)
+{
+    if (sprnum < 0)
+    {
+        TextualImageCache.clear();
+        return;
+    }
+    TextualImageCache.remove_if([sprnum](const TextualImageEntry &e)
+        { return std::find(e.Key.GuiPics.begin(), e.Key.GuiPics.end(), sprnum) != e.Key.GuiPics.end(); });
+}
+
 // Generates a textual image and returns a disposable bitmap
 Bitmap *create_textual_image(const char *text, int asspch, int isThought,
     int &xx, int &yy, int &adjustedXX, int &adjustedYY, int wii, int usingfont, int allowShrink,
@@ -218,6 +326,25 @@ Bitmap *create_textual_image(const char *text, int asspch, int isThought,
     }
     else if (xx<0) xx = ui_view.GetWidth() / 2 - wii / 2;
 
+    // Reuse the image composed for the same message earlier, if there's one
+    const bool is_empty = (strlen(todis) < 1) || (strcmp(todis, "  ") == 0) || (wii == 0);
+    TextualImageKey cache_key;
+    if (!is_empty)
+    {
+        cache_key = make_textual_image_key(todis, usingfont, wii, asspch, isThought, usingGui, topbar);
+        for (auto it = TextualImageCache.begin(); it != TextualImageCache.end(); ++it)
+        {
+            if (!(it->Key == cache_key))
+                continue;
+            TextualImageCache.splice(TextualImageCache.begin(), TextualImageCache, it);
+            const auto &entry = TextualImageCache.front();
+            adjustedXX = xx + entry.OffX;
+            adjustedYY = yy + entry.OffY;
+            alphaChannel = entry.AlphaChannel;
+            return BitmapHelper::CreateBitmapCopy(entry.Image.get());
+        }
+    }
+
     const int extraHeight = paddingDoubledScaled;
     color_t text_color = MakeColor(15);
     const int bmp_width = std::max(2, wii);
@@ -235,7 +362,7 @@ Bitmap *create_textual_image(const char *text, int asspch, int isThought,
     adjustedXX = xx;
     adjustedYY = yy;
 
-    if ((strlen(todis) < 1) || (strcmp(todis, "  ") == 0) || (wii == 0));
+    if (is_empty);
     // if it's an empty speech line, don't draw anything
     else if (asspch) { //text_color = ds->GetCompatibleColor(12);
         int ttxleft = 0, ttxtop = paddingScaled, oriwid = wii - padding * 2;
@@ -298,6 +425,18 @@ Bitmap *create_textual_image(const char *text, int asspch, int isThought,
             wouttext_aligned(text_window_ds, xoffs, yoffs + ee * disp.Linespacing, oriwid, usingfont, text_color, Lines[ee].GetCStr(), play.text_align);
     }
 
+    if (!is_empty)
+    {
+        TextualImageEntry entry;
+        entry.Key = std::move(cache_key);
+        entry.Image.reset(BitmapHelper::CreateBitmapCopy(text_window_ds));
+        entry.OffX = adjustedXX - xx;
+        entry.OffY = adjustedYY - yy;
+        entry.AlphaChannel = alphaChannel;
+        TextualImageCache.push_front(std::move(entry));
+        if (TextualImageCache.size() > TextualImageCacheSize)
+            TextualImageCache.pop_back();
+    }
     return text_window_ds;
 }
 
@@ -552,6 +691,15 @@ void wouttextxy_AutoOutline(Bitmap *ds, size_t font, int32_t color, const char *
     if (thickness <= 0)
         return;
 
+    // If the font renderer caches outline glyphs, then the outline is drawn
+    // in one pass; move start of text so that the outline doesn't drop off the bitmap
+    if (wouttextxy_outline(ds, xxp + thickness, yyp + thickness, font, color, texx))
+    {
+        xxp += thickness;
+        yyp += thickness;
+        return;
+    }
+
     // 16-bit games should use 32-bit stencils to keep anti-aliasing working
     // because 16-bit blending works correctly if there's an actual color
     // on the destination bitmap (and our intermediate bitmaps are transparent).
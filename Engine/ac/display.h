@@ -64,6 +64,9 @@ struct DisplayVars
 Common::Bitmap *create_textual_image(const char *text, int asspch, int isThought,
     int &xx, int &yy, int &adjustedXX, int &adjustedYY, int wii, int usingfont, int allowShrink,
     bool &alphaChannel, const TopBarSettings *topbar);
+// Removes the cached textual images which use the given sprite,
+// or all of them if sprnum is negative
+void invalidate_textual_image_cache(int sprnum = -1);
 // Creates a textual overlay using the given parameters;
 // Pass yy = -1 to find Y co-ord automatically
 // allowShrink = 0 for none, 1 for leftwards, 2 for rightwards
@@ -13,6 +13,7 @@
 //=============================================================================
 #include <stdio.h>
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include "aastr.h"
 #include "core/platform.h"
@@ -43,12 +44,16 @@
 #include "ac/sprite.h"
 #include "ac/string.h"
 #include "ac/system.h"
+#include "ac/timer.h"
 #include "ac/viewframe.h"
 #include "ac/walkablearea.h"
 #include "ac/walkbehind.h"
+#include "ac/dynobj/dynobj_manager.h"
+#include "ac/dynobj/managedobjectpool.h"
 #include "ac/dynobj/scriptsystem.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "debug/eventtrace.h"
 #include "font/fonts.h"
 #include "gui/guimain.h"
 #include "gui/guiobject.h"
@@ -56,12 +61,19 @@
 #include "plugin/agsplugin_evts.h"
 #include "plugin/plugin_engine.h"
 #include "ac/spritecache.h"
+#include "gfx/bitmappool.h"
 #include "gfx/gfx_util.h"
 #include "gfx/graphicsdriver.h"
+#include "gfx/pixel_convert.h"
 #include "gfx/ali3dexception.h"
 #include "gfx/blender.h"
+#include "main/benchmark.h"
 #include "main/game_run.h"
+#include "main/video_capture.h"
 #include "media/audio/audio_system.h"
+#include "util/file.h"
+#include "util/jobscheduler.h"
+#include "util/memory_budget.h"
 #include "util/wgt2allg.h"
 
 using namespace AGS::Common;
@@ -101,6 +113,19 @@ struct DrawState
     // Whether there are currently remnants of a on-screen effect
     bool ScreenIsDirty = false;
 
+    // Whether to interpolate the positions of the room entities and cameras
+    // between the game ticks, rendering extra frames in between
+    bool FrameInterpolation = false;
+    // Counter of the frames rendered after the game updates;
+    // the interpolated frames rendered in between are not counted
+    uint32_t RenderTick = 0u;
+    // Whether the current frame is rendered in between the game ticks
+    bool InterpFrame = false;
+    // Progress from the previous tick's positions to the current ones
+    float InterpAlpha = 1.f;
+    // The room for which the positions are recorded
+    int InterpRoom = -1;
+
     // A map of shared "control blocks" per each sprite used
     // when preparing object textures. "Control block" is currently just
     // an integer which lets to check whether the object texture is in sync
@@ -115,9 +140,43 @@ struct DrawState
     // kinds of renderers, thus saving on 1 extra notification mechanism.
     std::unordered_map<sprkey_t, std::shared_ptr<uint32_t>>
         SpriteNotifyMap;
+    // The areas of the shared textures which have to be updated from their
+    // sprites before the next render. Script may change a dynamic sprite
+    // several times during a game tick (transform it, draw on it and so forth),
+    // so the changes are accumulated, and each texture is updated only once.
+    std::unordered_map<uint32_t, Rect> TextureUpdates;
+    // Sprites which textures are created ahead of their use, in the free time
+    // of the next frames, and the number of frames left until the queue is dropped
+    std::vector<std::pair<uint32_t, TextureCategory>> TextureUploads;
+    int TextureUploadFrames = 0;
 };
 
+// Number of frames during which the queued texture uploads wait
+// for their sprites to be loaded
+static const int TextureUploadQueueFrames = 120;
+
 DrawState drawstate;
+
+// Position of the room entity or camera at the last two render ticks
+struct InterpPosition
+{
+    Point Prev;
+    Point Cur;
+    uint32_t Tick = 0u; // render tick at which Cur was recorded
+};
+
+static std::vector<InterpPosition> char_interp;
+static std::vector<InterpPosition> obj_interp;
+static std::vector<InterpPosition> cam_interp;
+
+// Forgets the recorded positions, e.g. when the room changes
+static void reset_interp_positions()
+{
+    char_interp.clear();
+    obj_interp.clear();
+    cam_interp.clear();
+}
+
 RGB palette[256];
 COLOR_MAP maincoltable;
 
@@ -187,6 +246,9 @@ struct ObjTexture
 struct ObjectCache
 {
     std::unique_ptr<Bitmap> image;
+    // Scaled and flipped image before the tint or light was applied;
+    // lets to only reapply the tint when it changes (software mode)
+    std::unique_ptr<Bitmap> untinted;
     bool  in_use = false; // CHECKME: possibly may be removed
     int   sppic = 0;
     // TODO: pickout tint settings, maybe even share with Char/Obj structs,
@@ -195,6 +257,9 @@ struct ObjectCache
     short lightlev = 0, zoom = 0;
     bool  mirrored = 0;
     int   x = 0, y = 0;
+    // The image construction was skipped, because the entity was not seen
+    // by any room camera; the image has to be updated before use
+    bool  culled = false;
 
     ObjectCache() = default;
     ObjectCache(int pic_, int tintr_, int tintg_, int tintb_, int tint_amnt_, int tint_light_,
@@ -212,6 +277,7 @@ struct ObjectCache
 // * A short-term cache of texture references, which keeps only weak refs to the textures
 //   that are currently in use. This short-term cache lets to keep reusing same texture
 //   so long as there's at least one object on screen that uses it.
+// Textures of the sprites locked in the sprite cache are locked in the MRU cache too.
 // NOTE: because of this two-component structure, TextureCache has to override
 // number of ResourceCache's parent methods. This design may probably be improved.
 class TextureCache :
@@ -238,11 +304,11 @@ public:
         const auto found = _txRefs.find(sprite_id);
         if (found != _txRefs.end())
         {
-            txdata = found->second.lock();
+            txdata = found->second.Ref.lock();
             // If found, then cache the texture again, and return
             if (txdata)
             {
-                Put(sprite_id, txdata);
+                Put(sprite_id, txdata, GetLockFlag(sprite_id));
                 return txdata;
             }
         }
@@ -250,20 +316,29 @@ public:
     }
 
     // Gets existing texture, or load a sprite and create texture from it;
-    // optionally, if "source" bitmap is provided, then use it
-    std::shared_ptr<Texture> GetOrLoad(uint32_t sprite_id, Bitmap *source, bool has_alpha, bool opaque)
+    // optionally, if "source" bitmap is provided, then use it.
+    // The texture is accounted in the category of the last requesting element.
+    std::shared_ptr<Texture> GetOrLoad(uint32_t sprite_id, Bitmap *source, bool has_alpha, bool opaque,
+        TextureCategory category)
     {
         assert(sprite_id != UINT32_MAX); // only valid sprite IDs may be stored
         if (sprite_id == UINT32_MAX)
             return nullptr;
+        if ((sprite_id < game.SpriteInfos.size()) && game.SpriteInfos[sprite_id].IsDynamicSprite())
+            category = kTexCategory_Dynamic;
 
         // Try getting existing texture first
         auto txdata = Get(sprite_id);
         if (txdata)
+        {
+            _txRefs[sprite_id].Category = category;
             return txdata;
+        }
 
         // If not in any cache, then try loading the sprite's bitmap,
-        // and create a texture data from it
+        // and create a texture data from it; the time this takes is
+        // the texture's cost for the cache
+        const auto load_start = std::chrono::steady_clock::now();
         Bitmap *bitmap = source;
         std::unique_ptr<Bitmap> tmp_source;
         if (!source)
@@ -278,7 +353,16 @@ public:
 
             if (_spriteset.IsSpriteLoaded(sprite_id) || !skip_rawcache)
             { // if it's already there, or we are not allowed to skip, then cache normally
-                bitmap = _spriteset[sprite_id];
+                _spriteset.PrecacheSprite(sprite_id);
+                if (_spriteset.IsSpriteIndexed(sprite_id))
+                { // keep the indexed sprite compact, and only expand a temporary copy
+                    tmp_source = _spriteset.LoadSpriteNoCache(sprite_id);
+                    bitmap = tmp_source.get();
+                }
+                else
+                {
+                    bitmap = _spriteset[sprite_id];
+                }
             }
             else
             { // if skipping, ask it to only load, but not keep in raw cache
@@ -294,11 +378,45 @@ public:
             return nullptr;
 
         txdata->ID = sprite_id;
-        _txRefs[sprite_id] = txdata;
-        Put(sprite_id, txdata);
+        _txRefs[sprite_id] = TexDataRef(txdata, category);
+        const int64_t load_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - load_start).count();
+        const uint32_t cost = static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(load_us, 1), UINT32_MAX));
+        RecordLoad(txdata->GetMemSize(), cost);
+        Put(sprite_id, txdata, GetLockFlag(sprite_id), cost);
         return txdata;
     }
 
+    // Locks or unlocks the cached texture, if it's present
+    void SetLocked(uint32_t sprite_id, bool locked)
+    {
+        if (locked)
+            Lock(sprite_id);
+        else
+            Release(sprite_id);
+    }
+
+    // Calculates the total size of the existing shared textures per category;
+    // forgets the references to the textures which no longer exist
+    std::array<size_t, kNumTexCategories> GetCategorySizes()
+    {
+        std::array<size_t, kNumTexCategories> sizes{};
+        for (auto it = _txRefs.begin(); it != _txRefs.end();)
+        {
+            auto txdata = it->second.Ref.lock();
+            if (txdata)
+            {
+                sizes[it->second.Category] += txdata->GetMemSize();
+                ++it;
+            }
+            else
+            {
+                it = _txRefs.erase(it);
+            }
+        }
+        return sizes;
+    }
+
     // Deletes the cached item
     void Dispose(const uint32_t &sprite_id)
     {
@@ -324,6 +442,12 @@ private:
         return item ? item->GetMemSize() : 0u;
     }
 
+    // Gets the cache flag which locks the texture if its sprite is locked
+    uint32_t GetLockFlag(uint32_t sprite_id) const
+    {
+        return _spriteset.IsSpriteLocked(sprite_id) ? static_cast<uint32_t>(kCacheItem_Locked) : 0u;
+    }
+
     // Marks a shared texture with the invalid sprite ID,
     // this logically disconnects this texture from the cache,
     // and the game objects will be forced to recreate it on the next update
@@ -332,7 +456,7 @@ private:
         const auto found = _txRefs.find(sprite_id);
         if (found != _txRefs.end())
         {
-            auto txdata = found->second.lock();
+            auto txdata = found->second.Ref.lock();
             if (txdata)
                 txdata->ID = UINT32_MAX;
             _txRefs.erase(sprite_id);
@@ -345,7 +469,15 @@ private:
     // Texture short-term cache:
     // - caches textures while they are in the immediate use;
     // - this lets to share same texture data among multiple sprites on screen.
-    typedef std::weak_ptr<Texture> TexDataRef;
+    struct TexDataRef
+    {
+        std::weak_ptr<Texture> Ref;
+        TextureCategory Category = kTexCategory_Room;
+
+        TexDataRef() = default;
+        TexDataRef(const std::shared_ptr<Texture> &txdata, TextureCategory category)
+            : Ref(txdata), Category(category) {}
+    };
     std::unordered_map<uint32_t, TexDataRef> _txRefs;
 } texturecache(spriteset);
 
@@ -363,6 +495,9 @@ std::vector<IDriverDependantBitmap*> gui_render_tex;
 std::vector<ObjTexture> guiobjbg;
 // first control texture index of each GUI
 std::vector<int> guiobjddbref;
+// GUI control areas, as they were last drawn on their GUI's surface
+// (when GUI is drawn along with its controls)
+std::vector<Rect> guiobjrc;
 // Overlays textures
 std::vector<ObjTexture> overtxs;
 // For debugging room masks
@@ -400,6 +535,20 @@ struct RoomCameraDrawData
 };
 std::vector<RoomCameraDrawData> CameraDrawData;
 
+// Render target of a room camera, for the hardware renderers. The room is
+// rendered on it once for all the viewports which show the same camera, and
+// the target is kept while nothing in the camera's view changes.
+struct RoomCameraTexture
+{
+    std::weak_ptr<Camera> Owner; // the camera which last used this slot
+    IDriverDependantBitmap *Ddb = nullptr;
+    bool     Use = false;    // whether the target is used in the current frame
+    bool     Valid = false;  // whether the target has the frame rendered
+    uint64_t ViewHash = 0u;  // hash of what camera saw in the last frame
+    uint64_t FrameHash = 0u; // hash of what is rendered on the target
+};
+std::vector<RoomCameraTexture> CameraTextures;
+
 
 // Describes a texture or node description, for sorting and passing into renderer
 struct SpriteListEntry
@@ -432,25 +581,11 @@ void setpal() {
 
 // PSP: convert 32 bit RGB to BGR.
 Bitmap *convert_32_to_32bgr(Bitmap *tempbl) {
-
-    int i = 0;
-    int j = 0;
-    unsigned char* current;
-    while (i < tempbl->GetHeight())
+    for (int i = 0; i < tempbl->GetHeight(); ++i)
     {
-        current = tempbl->GetScanLineForWriting(i);
-        while (j < tempbl->GetWidth())
-        {
-            current[0] ^= current[2];
-            current[2] ^= current[0];
-            current[0] ^= current[2];
-            current += 4;
-            j++;
-        }
-        i++;
-        j = 0;
+        PixelConvert::SwapRedBlue32(reinterpret_cast<uint32_t*>(tempbl->GetScanLineForWriting(i)),
+            tempbl->GetWidth());
     }
-
     return tempbl;
 }
 
@@ -552,28 +687,19 @@ PBitmap PrepareSpriteForUse(PBitmap bitmap, bool has_alpha)
     return new_bitmap == bitmap.get() ? bitmap : PBitmap(new_bitmap); // if bitmap is same, don't create new smart ptr!
 }
 
-Bitmap *CopyScreenIntoBitmap(int width, int height, const Rect *src_rect,
-    bool at_native_res, uint32_t batch_skip_filter)
+// Copies the screenshot made in the renderer's format into the destination
+// bitmap, converting the color depth and stretching it when necessary
+static void ConvertScreenCopy(Bitmap *screen_copy, Bitmap *dst)
 {
-    Bitmap *dst = new Bitmap(width, height, game.GetColorDepth());
-    GraphicResolution want_fmt;
-    // If the size and color depth are supported, then we may copy right into our final bitmap
-    if (gfxDriver->GetCopyOfScreenIntoBitmap(dst, src_rect, at_native_res, &want_fmt, batch_skip_filter))
-        return dst;
-
-    // Otherwise we might need to copy between few bitmaps...
-    // Get screenshot in the suitable format
-    std::unique_ptr<Bitmap> buf_screenfmt(new Bitmap(want_fmt.Width, want_fmt.Height, want_fmt.ColorDepth));
-    gfxDriver->GetCopyOfScreenIntoBitmap(buf_screenfmt.get(), src_rect, at_native_res);
     // If color depth does not match, and we must stretch-blit, then we need another helper bmp,
     // because Allegro does not support stretching with mismatching color depths
-    std::unique_ptr<Bitmap> buf_fixdepth;
-    Bitmap *blit_from = buf_screenfmt.get();
+    PooledBitmap buf_fixdepth;
+    Bitmap *blit_from = screen_copy;
     if ((dst->GetSize() != blit_from->GetSize())
-        && (want_fmt.ColorDepth != game.GetColorDepth()))
+        && (screen_copy->GetColorDepth() != game.GetColorDepth()))
     {
-        buf_fixdepth.reset(new Bitmap(want_fmt.Width, want_fmt.Height, game.GetColorDepth()));
-        buf_fixdepth->Blit(buf_screenfmt.get());
+        buf_fixdepth = BitmapPool::Global().Acquire(screen_copy->GetWidth(), screen_copy->GetHeight(), game.GetColorDepth());
+        buf_fixdepth->Blit(screen_copy);
         blit_from = buf_fixdepth.get();
     }
 
@@ -586,6 +712,43 @@ Bitmap *CopyScreenIntoBitmap(int width, int height, const Rect *src_rect,
     {
         dst->StretchBlt(blit_from, RectWH(dst->GetSize()));
     }
+}
+
+Bitmap *CopyScreenIntoBitmap(int width, int height, const Rect *src_rect,
+    bool at_native_res, uint32_t batch_skip_filter)
+{
+    Bitmap *dst = new Bitmap(width, height, game.GetColorDepth());
+    CopyScreenIntoBitmap(dst, src_rect, at_native_res, batch_skip_filter);
+    return dst;
+}
+
+void CopyScreenIntoBitmap(Bitmap *dst, const Rect *src_rect,
+    bool at_native_res, uint32_t batch_skip_filter)
+{
+    GraphicResolution want_fmt;
+    // If the size and color depth are supported, then we may copy right into our final bitmap
+    if (gfxDriver->GetCopyOfScreenIntoBitmap(dst, src_rect, at_native_res, &want_fmt, batch_skip_filter))
+        return;
+
+    // Otherwise we might need to copy between few bitmaps...
+    // Get screenshot in the suitable format
+    PooledBitmap buf_screenfmt = BitmapPool::Global().Acquire(want_fmt.Width, want_fmt.Height, want_fmt.ColorDepth);
+    gfxDriver->GetCopyOfScreenIntoBitmap(buf_screenfmt.get(), src_rect, at_native_res);
+    ConvertScreenCopy(buf_screenfmt.get(), dst);
+}
+
+uint32_t BeginCopyScreenIntoBitmap(const Rect *src_rect, bool at_native_res, uint32_t batch_skip_filter)
+{
+    return gfxDriver->BeginScreenCopy(src_rect, at_native_res, batch_skip_filter);
+}
+
+Bitmap *EndCopyScreenIntoBitmap(uint32_t handle, int width, int height)
+{
+    std::unique_ptr<Bitmap> buf_screenfmt = gfxDriver->EndScreenCopy(handle);
+    if (!buf_screenfmt)
+        return nullptr;
+    Bitmap *dst = new Bitmap(width, height, game.GetColorDepth());
+    ConvertScreenCopy(buf_screenfmt.get(), dst);
     return dst;
 }
 
@@ -726,6 +889,23 @@ int MakeColor(int color_index)
     return real_color;
 }
 
+// Max number of threads chosen automatically for constructing the images
+static const size_t MaxAutoPrepareThreads = 4u;
+// Number of threads which construct the room entities' images in software mode
+static size_t objgfx_threads = 1u;
+
+// Texture cache's handle in the memory budget, 0 if not registered
+static int texturecache_budget_handle = 0;
+
+static void setup_objgfx_workers(int thread_count)
+{
+    const size_t count = JobScheduler::ResolveThreadCount(thread_count, MaxAutoPrepareThreads);
+    if (objgfx_threads == count)
+        return;
+    objgfx_threads = count;
+    Debug::Printf("Preparing room sprites with %zu thread(s)", count);
+}
+
 void init_draw_method()
 {
     drawstate.SoftwareRender = !gfxDriver->HasAcceleratedTransform();
@@ -734,21 +914,42 @@ void init_draw_method()
     if (drawstate.SoftwareRender)
     {
         drawstate.WalkBehindMethod = DrawOverCharSprite;
+        gfxDriver->SetRenderThreadCount(usetup.SoftwareRenderThreads);
+        setup_objgfx_workers(usetup.SpritePrepareThreads);
+        set_invalid_regions_tiled(usetup.DirtyTiles);
     }
     else
     {
         drawstate.WalkBehindMethod = DrawAsSeparateSprite;
+        gfxDriver->SetCompactOpaqueTextures(usetup.CompactOpaqueTextures);
+        gfxDriver->SetTextureAtlas(usetup.TextureAtlas);
+        gfxDriver->UseStateSorting(usetup.SpriteStateSorting);
+        gfxDriver->UseIdleFrameSkip(usetup.IdleFrameSkip);
         create_blank_image(game.GetColorDepth());
         size_t tx_cache_size = usetup.TextureCacheSize * 1024;
         // If graphics driver can report available texture memory,
-        // then limit the setting by, let's say, 66% of it (we use it for other things)
+        // then limit the setting by the configured share of it (we use it for other things)
         uint64_t avail_tx_mem = gfxDriver->GetAvailableTextureMemory();
-        if (avail_tx_mem > 0)
-            tx_cache_size = std::min<size_t>(SIZE_MAX, std::min<uint64_t>(tx_cache_size, avail_tx_mem * 0.66));
+        if ((avail_tx_mem > 0) && (usetup.TextureVramBudget > 0))
+            tx_cache_size = std::min<size_t>(SIZE_MAX, std::min<uint64_t>(tx_cache_size,
+                avail_tx_mem * std::min(usetup.TextureVramBudget, 100) / 100));
         texturecache.SetMaxCacheSize(tx_cache_size);
+        texturecache.SetPolicy(usetup.TextureCachePolicy);
         Debug::Printf("Texture cache set: %zu KB", tx_cache_size / 1024);
+        if (texturecache_budget_handle == 0)
+            texturecache_budget_handle = MemoryBudget::Register("textures", MemoryBudget::kPriority_Textures,
+                []() { return texturecache.GetCacheSize(); },
+                [](size_t size) { return texturecache.Shrink(size); });
     }
 
+    // Interpolated frames are only supported by the renderers which redraw
+    // the whole frame, as the dirty regions are tracked once per game tick
+    drawstate.FrameInterpolation = usetup.FrameInterpolation && drawstate.FullFrameRedraw;
+    if (usetup.FrameInterpolation && !drawstate.FullFrameRedraw)
+        Debug::Printf(kDbgMsg_Warn, "Frame interpolation is not supported by the software renderer");
+    drawstate.InterpRoom = -1;
+    reset_interp_positions();
+
     on_mainviewport_changed();
     init_room_drawdata();
     if (gfxDriver->UsesMemoryBackBuffer())
@@ -757,9 +958,13 @@ void init_draw_method()
 
 void dispose_draw_method()
 {
+    MemoryBudget::Unregister(texturecache_budget_handle);
+    texturecache_budget_handle = 0;
     dispose_room_drawdata();
     dispose_invalid_regions(false);
     destroy_blank_image();
+    objgfx_threads = 1u;
+    BitmapHelper::ClearBitmapPool();
 }
 
 void init_game_drawdata()
@@ -783,6 +988,7 @@ void init_game_drawdata()
         guio_num += gui.GetControlCount();
     }
     guiobjbg.resize(guio_num);
+    guiobjrc.resize(guio_num);
 }
 
 extern void dispose_engine_overlay();
@@ -805,6 +1011,7 @@ void dispose_game_drawdata()
     gui_render_tex.clear();
     guiobjbg.clear();
     guiobjddbref.clear();
+    guiobjrc.clear();
 
     dispose_engine_overlay();
 }
@@ -815,6 +1022,16 @@ static void dispose_debug_room_drawdata()
     debugMoveListObj = ObjTexture();
 }
 
+static void dispose_camera_textures()
+{
+    for (auto &camtex : CameraTextures)
+    {
+        if (camtex.Ddb)
+            gfxDriver->DestroyDDB(camtex.Ddb);
+    }
+    CameraTextures.clear();
+}
+
 void dispose_room_drawdata()
 {
     CameraDrawData.clear();
@@ -848,17 +1065,21 @@ void clear_drawobj_cache()
         tex = nullptr;
     }
     for (auto &o : guiobjbg) o = ObjTexture();
+    for (auto &rc : guiobjrc) rc = Rect();
     overtxs.clear();
+    dispose_camera_textures();
 
     // Clear sprite update notification blocks
     drawstate.SpriteNotifyMap.clear();
 
     dispose_debug_room_drawdata();
+    // the cached images of the previous room are unlikely to be reused
+    BitmapHelper::ClearBitmapPool();
 }
 
 void release_drawobj_rendertargets()
 {
-    if ((gui_render_tex.size() == 0) ||
+    if (((gui_render_tex.size() == 0) && (CameraTextures.size() == 0)) ||
         !gfxDriver->ShouldReleaseRenderTargets())
         return;
 
@@ -869,6 +1090,7 @@ void release_drawobj_rendertargets()
             gfxDriver->DestroyDDB(tex);
         tex = nullptr;
     }
+    dispose_camera_textures();
 }
 
 void on_mainviewport_changed()
@@ -1023,8 +1245,15 @@ void detect_roomviewport_overlaps(size_t z_index)
     }
 }
 
+static void invalidate_camera_texture(int cam_index)
+{
+    if ((cam_index >= 0) && (static_cast<size_t>(cam_index) < CameraTextures.size()))
+        CameraTextures[cam_index].Valid = false;
+}
+
 void on_roomcamera_changed(Camera *cam)
 {
+    invalidate_camera_texture(cam->GetID());
     if (drawstate.FullFrameRedraw || (displayed_room < 0))
         return;
     if (cam->HasChangedSize())
@@ -1056,15 +1285,8 @@ void reset_drawobj_for_overlay(int objnum)
     }
 }
 
-void notify_sprite_changed(int sprnum, bool deleted)
+static void notify_sprite_users(int sprnum)
 {
-    assert(sprnum >= 0 && static_cast<uint32_t>(sprnum) < game.SpriteInfos.size());
-    // Update texture cache (regen texture or clear from cache)
-    if (deleted)
-        clear_shared_texture(sprnum);
-    else
-        update_shared_texture(sprnum);
-
     // For texture-based renderers updating a shared texture will already
     // update all the related drawn objects on screen; software renderer
     // will need to know to redraw active cached sprite for objects.
@@ -1072,16 +1294,32 @@ void notify_sprite_changed(int sprnum, bool deleted)
     // because it makes the code simpler, and also it makes it simpler to
     // notify texture-based ones in a specific case when a deleted sprite
     // was replaced by another of same ID.
+    auto it_notify = drawstate.SpriteNotifyMap.find(sprnum);
+    if (it_notify != drawstate.SpriteNotifyMap.end())
     {
-        auto it_notify = drawstate.SpriteNotifyMap.find(sprnum);
-        if (it_notify != drawstate.SpriteNotifyMap.end())
-        {
-            *it_notify->second = UINT32_MAX;
-            drawstate.SpriteNotifyMap.erase(sprnum);
-        }
+        *it_notify->second = UINT32_MAX;
+        drawstate.SpriteNotifyMap.erase(sprnum);
     }
 }
 
+void notify_sprite_changed(int sprnum, bool deleted)
+{
+    assert(sprnum >= 0 && static_cast<uint32_t>(sprnum) < game.SpriteInfos.size());
+    // Update texture cache (regen texture or clear from cache)
+    if (deleted)
+        clear_shared_texture(sprnum);
+    else
+        update_shared_texture(sprnum);
+    notify_sprite_users(sprnum);
+}
+
+void notify_sprite_changed(int sprnum, const Rect &area)
+{
+    assert(sprnum >= 0 && static_cast<uint32_t>(sprnum) < game.SpriteInfos.size());
+    update_shared_texture(sprnum, area);
+    notify_sprite_users(sprnum);
+}
+
 void texturecache_get_state(size_t &max_size, size_t &cur_size, size_t &locked_size, size_t &ext_size)
 {
     max_size = texturecache.GetMaxCacheSize();
@@ -1090,46 +1328,190 @@ void texturecache_get_state(size_t &max_size, size_t &cur_size, size_t &locked_s
     ext_size = texturecache.GetExternalSize();
 }
 
+const ResourceCacheStats &texturecache_get_stats()
+{
+    return texturecache.GetStats();
+}
+
 size_t texturecache_get_size()
 {
     return texturecache.GetCacheSize();
 }
 
+// Adds the size of the object's own texture, which is not shared
+// through the texture cache, to the given category
+static void add_own_texture_size(const ObjTexture &obj, TextureCategory category,
+    std::array<size_t, kNumTexCategories> &sizes)
+{
+    if (!obj.Ddb || (obj.SpriteID != UINT32_MAX))
+        return;
+    sizes[category] += static_cast<size_t>(obj.Ddb->GetWidth()) * obj.Ddb->GetHeight() *
+        ((obj.Ddb->GetColorDepth() + 7) / 8);
+}
+
+std::array<size_t, kNumTexCategories> texturecache_get_category_sizes()
+{
+    auto sizes = texturecache.GetCategorySizes();
+    for (size_t i = 0; i < actsps.size(); ++i)
+        add_own_texture_size(actsps[i], (i < ACTSP_OBJSOFF) ? kTexCategory_Room : kTexCategory_Character, sizes);
+    for (const auto &obj : walkbehindobj)
+        add_own_texture_size(obj, kTexCategory_Room, sizes);
+    for (const auto &obj : guibg)
+        add_own_texture_size(obj, kTexCategory_GUI, sizes);
+    for (const auto &obj : guiobjbg)
+        add_own_texture_size(obj, kTexCategory_GUI, sizes);
+    for (const auto &obj : overtxs)
+        add_own_texture_size(obj, kTexCategory_GUI, sizes);
+    return sizes;
+}
+
+void texturecache_set_locked(uint32_t sprite_id, bool locked)
+{
+    texturecache.SetLocked(sprite_id, locked);
+}
+
 void texturecache_clear()
 {
     texturecache.Clear();
+    drawstate.TextureUpdates.clear();
+    drawstate.TextureUploads.clear();
 }
 
 void update_shared_texture(uint32_t sprite_id)
+{
+    update_shared_texture(sprite_id, RectWH(0, 0, game.SpriteInfos[sprite_id].Width, game.SpriteInfos[sprite_id].Height));
+}
+
+void update_shared_texture(uint32_t sprite_id, const Rect &area)
 {
     auto txdata = texturecache.Get(sprite_id);
     if (!txdata)
+    {
+        drawstate.TextureUpdates.erase(sprite_id);
         return;
+    }
 
     const auto &res = txdata->Res;
     if (res.Width == game.SpriteInfos[sprite_id].Width &&
         res.Height == game.SpriteInfos[sprite_id].Height)
     {
-        gfxDriver->UpdateTexture(txdata.get(), spriteset[sprite_id],
-            (game.SpriteInfos[sprite_id].Flags & SPF_ALPHACHANNEL) != 0, false);
+        // Schedule the update, merging with the one already pending
+        auto it_update = drawstate.TextureUpdates.find(sprite_id);
+        if (it_update != drawstate.TextureUpdates.end())
+            it_update->second = SumRects(it_update->second, area);
+        else
+            drawstate.TextureUpdates.insert(std::make_pair(sprite_id, area));
     }
     else
     {
         // Remove texture from cache, assume it will be recreated on demand
+        drawstate.TextureUpdates.erase(sprite_id);
         texturecache.Dispose(sprite_id);
     }
 }
 
+// Updates the area of the shared texture from the sprite's pixels
+static void sync_shared_texture(uint32_t sprite_id, const Rect &area)
+{
+    auto txdata = texturecache.Get(sprite_id);
+    if (!txdata)
+        return;
+
+    const auto &res = txdata->Res;
+    if (res.Width != game.SpriteInfos[sprite_id].Width ||
+        res.Height != game.SpriteInfos[sprite_id].Height)
+    {
+        texturecache.Dispose(sprite_id);
+        return;
+    }
+
+    const bool has_alpha = (game.SpriteInfos[sprite_id].Flags & SPF_ALPHACHANNEL) != 0;
+    const Rect full_area = RectWH(0, 0, res.Width, res.Height);
+    const Rect upd_area = IntersectRects(area, full_area);
+    if (upd_area == full_area)
+        gfxDriver->UpdateTexture(txdata.get(), spriteset[sprite_id], has_alpha, false);
+    else if (!upd_area.IsEmpty())
+        gfxDriver->UpdateTextureArea(txdata.get(), spriteset[sprite_id], has_alpha, false, upd_area);
+}
+
+void sync_shared_texture(uint32_t sprite_id)
+{
+    auto it_update = drawstate.TextureUpdates.find(sprite_id);
+    if (it_update == drawstate.TextureUpdates.end())
+        return;
+    const Rect area = it_update->second;
+    drawstate.TextureUpdates.erase(it_update);
+    sync_shared_texture(sprite_id, area);
+}
+
+void sync_shared_textures()
+{
+    if (drawstate.TextureUpdates.empty())
+        return;
+    AGS_TRACE_ZONE("sync_shared_textures");
+    for (const auto &update : drawstate.TextureUpdates)
+        sync_shared_texture(update.first, update.second);
+    drawstate.TextureUpdates.clear();
+}
+
 void clear_shared_texture(uint32_t sprite_id)
 {
+    drawstate.TextureUpdates.erase(sprite_id);
     texturecache.Dispose(sprite_id);
 }
 
-void texturecache_precache(uint32_t sprite_id)
+void texturecache_precache(uint32_t sprite_id, TextureCategory category)
 {
     bool has_alpha = (sprite_id < game.SpriteInfos.size()) ?
         ((game.SpriteInfos[sprite_id].Flags & SPF_ALPHACHANNEL) != 0) : false;
-    texturecache.GetOrLoad(sprite_id, nullptr, has_alpha, false);
+    texturecache.GetOrLoad(sprite_id, nullptr, has_alpha, false, category);
+}
+
+void texturecache_queue_uploads(const std::vector<int32_t> &sprites, TextureCategory category)
+{
+    if (drawstate.SoftwareRender || (usetup.TextureUploadTime <= 0))
+        return;
+    for (const auto sprite_id : sprites)
+    {
+        if ((sprite_id > 0) && (static_cast<uint32_t>(sprite_id) < game.SpriteInfos.size()) &&
+            !texturecache.Exists(static_cast<uint32_t>(sprite_id)))
+            drawstate.TextureUploads.push_back(std::make_pair(static_cast<uint32_t>(sprite_id), category));
+    }
+    drawstate.TextureUploadFrames = TextureUploadQueueFrames;
+}
+
+void texturecache_process_uploads()
+{
+    if (drawstate.TextureUploads.empty())
+        return;
+    AGS_TRACE_ZONE("texturecache_process_uploads");
+    // The sprites are uploaded only after they are loaded into the sprite cache,
+    // and only into the free cache space, so that this never disposes the textures
+    // which are in use; the ones which do not get there in time are dropped
+    const auto time_limit = std::chrono::milliseconds(usetup.TextureUploadTime);
+    const auto start = std::chrono::steady_clock::now();
+    size_t keep = 0u;
+    for (size_t i = 0; i < drawstate.TextureUploads.size(); ++i)
+    {
+        const auto &upload = drawstate.TextureUploads[i];
+        const uint32_t sprite_id = upload.first;
+        if ((sprite_id >= game.SpriteInfos.size()) || texturecache.Exists(sprite_id))
+            continue; // already there, or the sprite is gone
+        if (!spriteset.IsSpriteLoaded(sprite_id) ||
+            (std::chrono::steady_clock::now() - start >= time_limit))
+        {
+            drawstate.TextureUploads[keep++] = upload; // retry on the next frame
+            continue;
+        }
+        const auto &info = game.SpriteInfos[sprite_id];
+        const size_t tx_size = static_cast<size_t>(info.Width) * info.Height * 4;
+        if (texturecache.GetCacheSize() + tx_size > texturecache.GetMaxCacheSize())
+            continue;
+        texturecache_precache(sprite_id, upload.second);
+    }
+    drawstate.TextureUploads.resize(keep);
+    if (--drawstate.TextureUploadFrames <= 0)
+        drawstate.TextureUploads.clear();
 }
 
 void mark_screen_dirty()
@@ -1149,6 +1531,13 @@ void invalidate_screen()
 
 void invalidate_camera_frame(int index)
 {
+    if (drawstate.FullFrameRedraw)
+    {
+        auto view = play.GetRoomViewport(index);
+        if (view && view->GetCamera())
+            invalidate_camera_texture(view->GetCamera()->GetID());
+        return;
+    }
     invalidate_all_camera_rects(index);
 }
 
@@ -1205,6 +1594,89 @@ static void render_black_borders()
 extern volatile bool game_update_suspend;
 extern volatile bool want_exit, abort_engine;
 
+// Render stage times of the frame in progress, and of the last rendered one
+static RenderStageTimes render_times;
+static RenderStageTimes last_render_times;
+// Sprite sorting stats of the frame in progress, and of the last rendered one
+static SpriteSortStats sort_stats;
+static SpriteSortStats last_sort_stats;
+
+// Render trace records the stage times and renderer statistics of each frame
+struct RenderTrace
+{
+    std::unique_ptr<Stream> Out;
+    AGS_Clock::time_point StartTime;
+    uint32_t Frame = 0u;
+};
+static std::unique_ptr<RenderTrace> render_trace;
+
+static uint32_t elapsed_us(AGS_Clock::time_point since)
+{
+    return static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(AGS_Clock::now() - since).count());
+}
+
+const RenderStageTimes &get_render_stage_times()
+{
+    return last_render_times;
+}
+
+const SpriteSortStats &get_sprite_sort_stats()
+{
+    return last_sort_stats;
+}
+
+bool render_trace_start(const String &filename)
+{
+    render_trace_stop();
+    auto out = File::CreateFile(filename);
+    if (!out)
+    {
+        Debug::Printf(kDbgMsg_Error, "Failed to open render trace file for writing: %s", filename.GetCStr());
+        return false;
+    }
+    const char *header = "frame,time_ms,overlays_us,room_us,ui_us,render_us,"
+        "sprites,draw_calls,upload_bytes,gpu_us,sort_sprites,sort_moves,sort_full,viewports_us\n";
+    out->Write(header, strlen(header));
+    render_trace.reset(new RenderTrace());
+    render_trace->Out = std::move(out);
+    render_trace->StartTime = AGS_Clock::now();
+    Debug::Printf(kDbgMsg_Info, "Recording render trace to: %s", filename.GetCStr());
+    return true;
+}
+
+void render_trace_stop()
+{
+    render_trace.reset();
+}
+
+// Completes the frame's timing, and writes it to the trace if one is recorded
+static void end_render_times()
+{
+    last_render_times = render_times;
+    render_times.Overlays = render_times.Room = render_times.UI = render_times.Render = 0u;
+    render_times.Viewports.clear();
+    last_sort_stats = sort_stats;
+    sort_stats = SpriteSortStats();
+    if (!render_trace)
+        return;
+
+    const RenderStats rstats = gfxDriver->GetRenderStats();
+    const RenderStageTimes &times = last_render_times;
+    // Viewports are listed in one column, as their number may change
+    const SpriteSortStats &sorts = last_sort_stats;
+    String line = String::FromFormat("%u,%lld,%u,%u,%u,%u,%u,%u,%llu,%u,%u,%u,%u,",
+        render_trace->Frame++,
+        static_cast<long long>(ToMilliseconds(AGS_Clock::now() - render_trace->StartTime)),
+        times.Overlays, times.Room, times.UI, times.Render,
+        rstats.Sprites, rstats.DrawCalls, static_cast<unsigned long long>(rstats.UploadBytes), rstats.GpuTimeUs,
+        sorts.Sprites, sorts.Moves, sorts.FullSorts);
+    for (size_t i = 0; i < times.Viewports.size(); ++i)
+        line.AppendFmt(i == 0 ? "%u" : " %u", times.Viewports[i]);
+    line.AppendChar('\n');
+    render_trace->Out->Write(line.GetCStr(), line.GetLength());
+}
+
 void render_to_screen()
 {
     // Stage: final plugin callback (still drawn on game screen)
@@ -1230,6 +1702,10 @@ void render_to_screen()
             System_SetVSyncInternal(new_vsync);
     }
 
+    sync_shared_textures();
+
+    const auto render_start = AGS_Clock::now();
+    AGS_TRACE_ZONE("Render");
     bool succeeded = false;
     while (!succeeded && !want_exit && !abort_engine)
     {
@@ -1265,6 +1741,11 @@ void render_to_screen()
             } while (game_update_suspend && (!want_exit) && (!abort_engine));
         }
     }
+    render_times.Render = elapsed_us(render_start);
+    end_render_times();
+
+    if (succeeded)
+        video_capture_frame();
 }
 
 // Blanks out borders around main viewport in case it became smaller (e.g. after loading another room)
@@ -1298,7 +1779,7 @@ void draw_sprite_support_alpha(Bitmap *ds, bool ds_has_alpha, int xpos, int ypos
     else if (src_has_alpha && alpha == 0xFF)
     {
         set_alpha_blender();
-        ds->TransBlendBlt(image, xpos, ypos);
+        draw_trans_sprite32(ds->GetAllegroBitmap(), image->GetAllegroBitmap(), xpos, ypos);
     }
     else
     {
@@ -1330,7 +1811,7 @@ IDriverDependantBitmap* recycle_ddb_bitmap(IDriverDependantBitmap *ddb,
 }
 
 IDriverDependantBitmap* recycle_ddb_sprite(IDriverDependantBitmap *ddb, uint32_t sprite_id,
-    Common::Bitmap *source, bool has_alpha, bool opaque)
+    Common::Bitmap *source, bool has_alpha, bool opaque, TextureCategory category)
 {
     // If sprite_id is not cachable, then fallback to a simpler variant
     if (drawstate.SoftwareRender || sprite_id == UINT32_MAX)
@@ -1340,10 +1821,14 @@ IDriverDependantBitmap* recycle_ddb_sprite(IDriverDependantBitmap *ddb, uint32_t
         return recycle_ddb_bitmap(ddb, source, has_alpha, opaque);
     }
 
+    // Apply the pending changes to the sprite's texture, if there are any
+    if (!drawstate.TextureUpdates.empty())
+        sync_shared_texture(sprite_id);
+
     if (ddb && ddb->GetRefID() == sprite_id)
         return ddb; // texture in sync
 
-    auto txdata = texturecache.GetOrLoad(sprite_id, source, has_alpha, opaque);
+    auto txdata = texturecache.GetOrLoad(sprite_id, source, has_alpha, opaque, category);
     if (!txdata)
     {
         // On failure - invalidate ddb (we don't want to draw old pixels)
@@ -1369,9 +1854,10 @@ IDriverDependantBitmap* recycle_render_target(IDriverDependantBitmap *ddb, int w
 }
 
 // FIXME: make has_alpha and opaque properties of ObjTexture?!
-static void sync_object_texture(ObjTexture &obj, bool has_alpha = false, bool opaque = false)
+static void sync_object_texture(ObjTexture &obj, bool has_alpha = false, bool opaque = false,
+    TextureCategory category = kTexCategory_Room)
 {
-    obj.Ddb = recycle_ddb_sprite(obj.Ddb, obj.SpriteID, obj.Bmp.get(), has_alpha, opaque);
+    obj.Ddb = recycle_ddb_sprite(obj.Ddb, obj.SpriteID, obj.Bmp.get(), has_alpha, opaque, category);
 
     // Handle notification control block for the dynamic sprites
     if ((obj.SpriteID != UINT32_MAX) && game.SpriteInfos[obj.SpriteID].IsDynamicSprite())
@@ -1470,11 +1956,78 @@ static bool spritelistentry_room_less(const SpriteListEntry &e1, const SpriteLis
     return e1.zorder < e2.zorder;
 }
 
+// Keeps the sorted order of a sprite list between the frames. The list is
+// gathered in the same order each frame, so if its size did not change, the
+// previous order is used as a starting point, and only fixed where the
+// z-orders changed (insertion sort), which normally takes a few moves.
+struct SpriteListOrder
+{
+    std::vector<uint32_t> Order; // sprlist indexes, in the drawing order
+};
+static SpriteListOrder room_sprlist_order;
+static SpriteListOrder ui_sprlist_order;
+// Max element moves per sprite allowed for the incremental sort,
+// after which it is considered faster to sort the list from scratch
+static const uint32_t MaxSortMovesPerSprite = 8u;
+
+// Sorts the sprlist indexes in the drawing order; the index is used as a last
+// comparison key, to make the order strict, and same as a stable sort's.
+template <typename TLess>
+static void sort_sprite_list(SpriteListOrder &list, TLess less)
+{
+    const uint32_t count = static_cast<uint32_t>(sprlist.size());
+    auto &order = list.Order;
+    const auto index_less = [less](uint32_t i1, uint32_t i2)
+    {
+        const SpriteListEntry &e1 = sprlist[i1];
+        const SpriteListEntry &e2 = sprlist[i2];
+        if (less(e1, e2)) return true;
+        if (less(e2, e1)) return false;
+        return i1 < i2;
+    };
+
+    sort_stats.Sprites += count;
+    if (order.size() == count)
+    {
+        const uint32_t max_moves = count * MaxSortMovesPerSprite;
+        uint32_t moves = 0u;
+        for (uint32_t i = 1; (i < count) && (moves <= max_moves); ++i)
+        {
+            const uint32_t item = order[i];
+            uint32_t j = i;
+            for (; (j > 0) && index_less(item, order[j - 1]); --j)
+                order[j] = order[j - 1];
+            order[j] = item;
+            moves += i - j;
+        }
+        sort_stats.Moves += moves;
+        if (moves <= max_moves)
+        {
+            sort_stats.IncrementalSorts++;
+            return;
+        }
+    }
+    else
+    {
+        order.resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+            order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), index_less);
+    sort_stats.FullSorts++;
+}
+
 // copy the sorted sprites into the Things To Draw list
 static void draw_sprite_list(bool is_room)
 {
-    std::sort(sprlist.begin(), sprlist.end(), is_room ? spritelistentry_room_less : spritelistentry_less);
-    thingsToDrawList.insert(thingsToDrawList.end(), sprlist.begin(), sprlist.end());
+    SpriteListOrder &list = is_room ? room_sprlist_order : ui_sprlist_order;
+    if (is_room)
+        sort_sprite_list(list, spritelistentry_room_less);
+    else
+        sort_sprite_list(list, spritelistentry_less);
+    thingsToDrawList.reserve(thingsToDrawList.size() + sprlist.size());
+    for (const uint32_t index : list.Order)
+        thingsToDrawList.push_back(sprlist[index]);
 }
 
 // Push the gathered list of sprites into the active graphic renderer
@@ -1526,7 +2079,7 @@ void draw_gui_sprite(Bitmap *ds, bool use_alpha, int x, int y, Bitmap *sprite, b
             set_additive_alpha_blender();
         else
             set_opaque_alpha_blender();
-        ds->TransBlendBlt(sprite, x, y);
+        draw_trans_sprite32(ds->GetAllegroBitmap(), sprite->GetAllegroBitmap(), x, y);
     }
     else
     {
@@ -1540,7 +2093,8 @@ void draw_gui_sprite_v330(Bitmap *ds, int pic, int x, int y, bool use_alpha, Ble
 }
 
 
-// Avoid freeing and reallocating the memory if possible
+// Avoid freeing and reallocating the memory if possible;
+// the new bitmaps have aligned rows, and take their memory from the pool
 Bitmap *recycle_bitmap(Bitmap *bimp, int coldep, int wid, int hit, bool make_transparent)
 {
     if (bimp != nullptr)
@@ -1559,8 +2113,8 @@ Bitmap *recycle_bitmap(Bitmap *bimp, int coldep, int wid, int hit, bool make_tra
 
         delete bimp;
     }
-    bimp = make_transparent ? BitmapHelper::CreateTransparentBitmap(wid, hit,coldep) :
-        BitmapHelper::CreateBitmap(wid, hit,coldep);
+    bimp = make_transparent ? BitmapHelper::CreateTransparentBitmap(wid, hit, coldep, kBitmapAlloc_Aligned) :
+        BitmapHelper::CreateBitmap(wid, hit, coldep, kBitmapAlloc_Aligned);
     return bimp;
 }
 
@@ -1591,17 +2145,12 @@ void get_local_tint(int xpp, int ypp, bool use_region_tint,
         if ((play.ground_level_areas_disabled & GLED_EFFECTS) == 0) {
             // check if the player is on a region, to find its
             // light/tint level
-            onRegion = GetRegionIDAtRoom(xpp, ypp);
-            if (onRegion == 0) {
-                // when walking, he might just be off a walkable area
-                onRegion = GetRegionIDAtRoom(xpp - 3, ypp);
-                if (onRegion == 0)
-                    onRegion = GetRegionIDAtRoom(xpp + 3, ypp);
-                if (onRegion == 0)
-                    onRegion = GetRegionIDAtRoom(xpp, ypp - 3);
-                if (onRegion == 0)
-                    onRegion = GetRegionIDAtRoom(xpp, ypp + 3);
-            }
+            // when walking, he might just be off a walkable area,
+            // so look around too
+            const Point pts[] = { Point(xpp, ypp),
+                Point(xpp - 3, ypp), Point(xpp + 3, ypp),
+                Point(xpp, ypp - 3), Point(xpp, ypp + 3) };
+            onRegion = GetFirstRegionIDAtRoom(pts, 5);
         }
 
         if ((onRegion > 0) && (onRegion < MAX_ROOM_REGIONS)) {
@@ -1739,7 +2288,6 @@ static Bitmap *transform_sprite(Bitmap *src, bool src_has_alpha, std::unique_ptr
         return src; // No transform: return source image
 
     recycle_bitmap(dst, src->GetColorDepth(), dst_sz.Width, dst_sz.Height, true);
-    set_our_eip(339);
 
     // If scaled: first scale then optionally mirror
     if (src->GetSize() != dst_sz)
@@ -1779,19 +2327,55 @@ static Bitmap *transform_sprite(Bitmap *src, bool src_has_alpha, std::unique_ptr
     return dst.get(); // return transformed result
 }
 
-// Draws the specified 'sppic' sprite onto ObjTexture 'actsp' at the
-// specified width and height, and flips the sprite if necessary.
+// Draws the specified 'sppic' sprite, which image is 'src', onto ObjTexture
+// 'actsp' at the specified width and height, and flips the sprite if necessary.
 // Returns 1 if something was drawn to actsps; returns 0 if no
 // scaling or stretching was required, in which case nothing was done.
 // Used for software render mode only.
-static bool scale_and_flip_sprite(ObjTexture &actsp, int sppic, int width, int height, bool hmirror)
+static bool scale_and_flip_sprite(ObjTexture &actsp, int sppic, Bitmap *src, int width, int height, bool hmirror)
 {
-    Bitmap *src = spriteset[sppic];
     Bitmap *result = transform_sprite(src, (game.SpriteInfos[sppic].Flags & SPF_ALPHACHANNEL) != 0,
         actsp.Bmp, Size(width, height), hmirror ? kFlip_Horizontal : kFlip_None);
     return result != src;
 }
 
+// Tint and light parameters of the room entity's image
+struct ObjectTint
+{
+    int Red = 0, Green = 0, Blue = 0;
+    int Level = 0; // tint saturation
+    int Light = 0; // tint luminance
+    int LightLevel = 0; // light level, used when there's no tint
+};
+
+// Gets the tint and light which should be applied to the room entity
+static void get_object_tint(int tint_flags, // OBJF_* flags related to using tint and light fx
+    const ObjectCache &objsrc, ObjectTint &tint)
+{
+    tint = ObjectTint();
+    if (tint_flags & OBJF_HASTINT)
+    {
+        // object specific tint, use it
+        tint.Red = objsrc.tintr;
+        tint.Green = objsrc.tintg;
+        tint.Blue = objsrc.tintb;
+        tint.Level = objsrc.tintamnt;
+        tint.Light = objsrc.tintlight;
+        tint.LightLevel = 0;
+    }
+    else if (tint_flags & OBJF_HASLIGHT)
+    {
+        tint.LightLevel = objsrc.tintlight;
+    }
+    else
+    {
+        // get the ambient or region tint
+        get_local_tint(objsrc.x, objsrc.y, (tint_flags & OBJF_USEREGIONTINTS) != 0,
+            &tint.Level, &tint.Red, &tint.Green, &tint.Blue,
+            &tint.Light, &tint.LightLevel);
+    }
+}
+
 // Prepares the ObjTexture 'actsp' for an arbitrary room entity.
 // Records visual parameters in ObjectCache 'objsav'.
 // Returns true if actsp's raw image was not changed and actsps is still
@@ -1801,9 +2385,14 @@ static bool scale_and_flip_sprite(ObjTexture &actsp, int sppic, int width, int h
 // require preparing the raw bitmap.
 // Except if alwaysUseSoftware is set, in which case even HW renderers
 // construct the image in software mode as well.
+// NOTE: the function is called on the worker threads for the images which
+// do not need the global drawing state, see can_construct_gfx_in_parallel();
+// it must not access the sprite cache then, so the caller may pass the
+// already resolved sprite image.
 static bool construct_object_gfx(const ViewFrame *vf, int pic,
+    Bitmap *sprite, // sprite image, resolved from the sprite cache if null
     const Size &scale_size,
-    int tint_flags, // OBJF_* flags related to using tint and light fx
+    const ObjectTint &tint, // tint and light fx
     const ObjectCache &objsrc, // source item to acquire values from
     ObjectCache &objsav, // cache item to use
     ObjTexture &actsp, // object texture to draw upon
@@ -1812,31 +2401,12 @@ static bool construct_object_gfx(const ViewFrame *vf, int pic,
 {
     const bool use_hw_transform = !force_software && !drawstate.SoftwareRender;
 
-    int tint_red, tint_green, tint_blue;
-    int tint_level, tint_light, light_level;
-    tint_red = tint_green = tint_blue = tint_level = tint_light = light_level = 0;
-
-    if (tint_flags & OBJF_HASTINT)
-    {
-        // object specific tint, use it
-        tint_red = objsrc.tintr;
-        tint_green = objsrc.tintg;
-        tint_blue = objsrc.tintb;
-        tint_level = objsrc.tintamnt;
-        tint_light = objsrc.tintlight;
-        light_level = 0;
-    }
-    else if (tint_flags & OBJF_HASLIGHT)
-    {
-        light_level = objsrc.tintlight;
-    }
-    else
-    {
-        // get the ambient or region tint
-        get_local_tint(objsrc.x, objsrc.y, (tint_flags & OBJF_USEREGIONTINTS) != 0,
-            &tint_level, &tint_red, &tint_green, &tint_blue,
-            &tint_light, &light_level);
-    }
+    const int tint_red = tint.Red;
+    const int tint_green = tint.Green;
+    const int tint_blue = tint.Blue;
+    const int tint_level = tint.Level;
+    const int tint_light = tint.Light;
+    const int light_level = tint.LightLevel;
 
     // check whether the image should be flipped
     bool is_mirrored = false;
@@ -1911,23 +2481,57 @@ static bool construct_object_gfx(const ViewFrame *vf, int pic,
         return false; // image was modified
     }
 
+    // If only the tint or light has changed, then we may reuse the scaled image
+    Bitmap *untinted = nullptr;
+    if ((objsav.sppic == specialpic) &&
+        (!actsp.IsChangeNotified()) &&
+        (objsav.zoom == objsrc.zoom) &&
+        (objsav.mirrored == is_mirrored))
+    {
+        if (objsav.untinted)
+            untinted = objsav.untinted.get();
+        else if (objsav.image && (objsav.tintamnt == 0) && (objsav.lightlev == 0))
+            untinted = objsav.image.get();
+    }
+
     // Not cached, so draw the image
-    Bitmap *sprite = spriteset[pic];
+    if (!sprite)
+        sprite = spriteset[pic];
     const int coldept = sprite->GetColorDepth();
     const int src_sprwidth = sprite->GetWidth();
     const int src_sprheight = sprite->GetHeight();
     bool actsps_used = false;
-    // draw the base sprite, scaled and flipped as appropriate
-    actsps_used = scale_and_flip_sprite(actsp, pic, scale_size.Width, scale_size.Height, is_mirrored);
-    if (!actsps_used)
+    if (untinted)
+    {
+        recycle_bitmap(actsp.Bmp, untinted->GetColorDepth(), untinted->GetWidth(), untinted->GetHeight());
+        actsp.Bmp->Blit(untinted, 0, 0);
+        actsps_used = true;
+    }
+    else
     {
-        // ensure actsps exists // CHECKME: why do we need this in hardware accel mode too?
-        recycle_bitmap(actsp.Bmp, coldept, src_sprwidth, src_sprheight);
+        // draw the base sprite, scaled and flipped as appropriate
+        actsps_used = scale_and_flip_sprite(actsp, pic, sprite, scale_size.Width, scale_size.Height, is_mirrored);
+        if (!actsps_used)
+        {
+            // ensure actsps exists // CHECKME: why do we need this in hardware accel mode too?
+            recycle_bitmap(actsp.Bmp, coldept, src_sprwidth, src_sprheight);
+        }
     }
 
     // apply tints or lightenings where appropriate, else just copy the source bitmap
     if ((tint_level > 0) || (light_level != 0))
     {
+        // keep the scaled image for the future tint changes
+        if (!actsps_used)
+        {
+            objsav.untinted.reset();
+        }
+        else if (untinted != objsav.untinted.get())
+        {
+            recycle_bitmap(objsav.untinted, actsp.Bmp->GetColorDepth(), actsp.Bmp->GetWidth(), actsp.Bmp->GetHeight());
+            objsav.untinted->Blit(actsp.Bmp.get(), 0, 0);
+        }
+
         // direct read from source bitmap, where possible
         Bitmap *blit_from = nullptr;
         if (!actsps_used)
@@ -1937,10 +2541,15 @@ static bool construct_object_gfx(const ViewFrame *vf, int pic,
             tint_green, tint_blue, tint_light, coldept,
             blit_from);
     }
-    else if (!actsps_used)
+    else
     {
-        // no scaling, flipping or tinting was done, so just blit it normally
-        actsp.Bmp->Blit(sprite, 0, 0);
+        // the cached image will be untinted itself
+        objsav.untinted.reset();
+        if (!actsps_used)
+        {
+            // no scaling, flipping or tinting was done, so just blit it normally
+            actsp.Bmp->Blit(sprite, 0, 0);
+        }
     }
 
     // Create the cached image and store it
@@ -1973,7 +2582,7 @@ void prepare_and_add_object_gfx(
     ObjTexture &actsp, bool actsp_modified,
     const Size &scale_size,
     int atx, int aty, int &usebasel, bool use_walkbehinds,
-    int transparency, bool hw_accel)
+    int transparency, bool hw_accel, TextureCategory tex_category)
 {
     // Handle the walk-behinds, according to the WalkBehindMethod.
     // This potentially may edit actsp's raw bitmap if actsp_modified is set.
@@ -1998,7 +2607,8 @@ void prepare_and_add_object_gfx(
     // Sync object texture with the raw sprite bitmap.
     if ((actsp.Ddb == nullptr) || (actsp_modified))
     {
-        sync_object_texture(actsp, (game.SpriteInfos[actsp.SpriteID].Flags & SPF_ALPHACHANNEL) != 0);
+        sync_object_texture(actsp, (game.SpriteInfos[actsp.SpriteID].Flags & SPF_ALPHACHANNEL) != 0,
+            false, tex_category);
     }
 
     // Now when we have a ready texture, assign texture properties
@@ -2027,37 +2637,236 @@ void prepare_and_add_object_gfx(
     actsp.Ddb->SetAlpha(GfxDef::LegacyTrans255ToAlpha255(transparency));
 }
 
-// Prepares a actsps element for RoomObject; updates object cache.
-// Software mode draws an actual bitmap in actsp, hardware mode only
-// assigns parameters, which may further be assigned to a texture.
-bool construct_object_gfx(int objid, bool force_software)
+// Parameters of the room entity's image construction, and its result;
+// see construct_object_gfx()
+struct ObjectGfxJob
+{
+    int ID = 0; // object or character index, for diagnostics
+    const ViewFrame *Vf = nullptr;
+    int Pic = 0;
+    Bitmap *Sprite = nullptr;
+    Size ScaleSize;
+    ObjectTint Tint;
+    ObjectCache Src;
+    ObjectCache *Sav = nullptr;
+    ObjTexture *Actsp = nullptr;
+    TextureCategory TexCategory = kTexCategory_Room;
+    bool OptimizeByPos = false;
+    bool ForceSoftware = false;
+    // Whether the raw image was redrawn
+    bool Modified = false;
+    // Parameters of adding the prepared texture to the sprite list
+    int Atx = 0, Aty = 0, Baseline = 0;
+    bool UseWalkbehinds = true;
+    int Transparency = 0;
+};
+
+// Min number of images to construct in parallel, for which running them
+// on the worker threads is worth it
+static const size_t MinParallelGfxJobs = 4u;
+// Image construction jobs, reused between the frames
+static std::vector<ObjectGfxJob> objgfx_jobs;
+static std::vector<size_t> objgfx_parallel;
+
+// Room areas seen by the visible room cameras, for culling the room entities
+static std::vector<Rect> visible_room_areas;
+
+static void run_object_gfx_job(ObjectGfxJob &job)
+{
+    job.Modified = !construct_object_gfx(job.Vf, job.Pic, job.Sprite, job.ScaleSize, job.Tint,
+        job.Src, *job.Sav, *job.Actsp, job.OptimizeByPos, job.ForceSoftware);
+    job.Sav->culled = false;
+}
+
+// Records the position of the indexed entity at the current render tick,
+// and returns the position to draw it at in the current frame
+static Point interpolate_position(std::vector<InterpPosition> &list, size_t index, const Point &pos)
+{
+    if (!drawstate.FrameInterpolation)
+        return pos;
+    if (list.size() <= index)
+        list.resize(index + 1);
+    InterpPosition &ip = list[index];
+    if (ip.Tick != drawstate.RenderTick)
+    {
+        // the previous position is only valid if recorded at the previous tick
+        ip.Prev = (ip.Tick + 1 == drawstate.RenderTick) ? ip.Cur : pos;
+        ip.Cur = pos;
+        ip.Tick = drawstate.RenderTick;
+    }
+    // Don't interpolate a jump across the quarter of the screen, most likely
+    // this is an instant change of position rather than a movement
+    const int dx = pos.X - ip.Prev.X, dy = pos.Y - ip.Prev.Y;
+    const Size &game_res = game.GetGameRes();
+    if ((std::abs(dx) > game_res.Width / 4) || (std::abs(dy) > game_res.Height / 4))
+        return pos;
+    return Point(ip.Prev.X + static_cast<int>(std::lround(dx * drawstate.InterpAlpha)),
+        ip.Prev.Y + static_cast<int>(std::lround(dy * drawstate.InterpAlpha)));
+}
+
+// Gets the rect of the camera to draw the room with in the current frame
+static Rect get_camera_draw_rect(const Camera &camera)
+{
+    const Rect &rc = camera.GetRect();
+    if (!drawstate.FrameInterpolation)
+        return rc;
+    const Point pos = interpolate_position(cam_interp, camera.GetID(), rc.GetLT());
+    return RectWH(pos.X, pos.Y, rc.GetWidth(), rc.GetHeight());
+}
+
+// Gathers the rects of the room cameras shown in the visible viewports
+static void update_visible_room_areas()
+{
+    visible_room_areas.clear();
+    for (const auto &viewport : play.GetRoomViewportsZOrdered())
+    {
+        if (!viewport->IsVisible())
+            continue;
+        auto camera = viewport->GetCamera();
+        if (camera)
+            visible_room_areas.push_back(get_camera_draw_rect(*camera));
+    }
+}
+
+// Tells if the room entity is outside of all the visible room areas,
+// in which case its image does not have to be constructed until seen again
+static bool is_object_gfx_culled(const ObjectGfxJob &job)
+{
+    if (visible_room_areas.empty() || job.ScaleSize.IsNull())
+        return false; // no cameras, or unknown size: don't risk it
+    const Rect bounds = RectWH(job.Atx, job.Aty, job.ScaleSize.Width, job.ScaleSize.Height);
+    for (const auto &area : visible_room_areas)
+    {
+        if (AreRectsIntersecting(bounds, area))
+            return false;
+    }
+    return true;
+}
+
+// Drops the last added job if its entity is not seen by any camera;
+// the entity's cache is marked, so that the image is updated when requested
+static void cull_last_object_gfx_job(size_t &job_count)
+{
+    ObjectGfxJob &job = objgfx_jobs[job_count - 1];
+    if (!is_object_gfx_culled(job))
+        return;
+    job.Sav->culled = true;
+    job_count--;
+}
+
+// Tells if the image may be constructed on a worker thread. The tinting,
+// anti-aliased scaling and the palette selection use the global Allegro
+// state, as does the stretching of 24-bit sprites, so these must be done
+// on the main thread.
+static bool can_construct_gfx_in_parallel(const ObjectGfxJob &job)
+{
+    if ((job.Tint.Level > 0) || (job.Tint.LightLevel != 0) || (in_new_room > 0))
+        return false;
+    if (job.Sprite->GetSize() == job.ScaleSize)
+        return true;
+    const bool has_alpha = (game.SpriteInfos[job.Pic].Flags & SPF_ALPHACHANNEL) != 0;
+    return (job.Sprite->GetColorDepth() != 24) && !(IS_ANTIALIAS_SPRITES && !has_alpha);
+}
+
+// Constructs the images of the listed room entities; in software mode
+// distributes them among the worker threads where possible
+static void construct_objects_gfx(std::vector<ObjectGfxJob> &jobs)
+{
+    set_our_eip(339);
+    bool parallel = (objgfx_threads > 1u) && drawstate.SoftwareRender && (jobs.size() >= MinParallelGfxJobs);
+    if (parallel)
+    {
+        // Sprite cache is not thread-safe, so resolve all the sprites here;
+        // if loading some of them have evicted the others from the cache,
+        // then the earlier pointers are no longer valid, and the images
+        // have to be constructed one by one
+        const uint64_t evictions = spriteset.GetStats().Evictions;
+        for (auto &job : jobs)
+            job.Sprite = spriteset[job.Pic];
+        if (spriteset.GetStats().Evictions != evictions)
+        {
+            parallel = false;
+            for (auto &job : jobs)
+                job.Sprite = nullptr;
+        }
+    }
+
+    objgfx_parallel.clear();
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        if (parallel && can_construct_gfx_in_parallel(jobs[i]))
+            objgfx_parallel.push_back(i);
+        else
+            run_object_gfx_job(jobs[i]);
+    }
+    if (objgfx_parallel.size() >= MinParallelGfxJobs)
+    {
+        JobScheduler::Global().ParallelFor("Object gfx", objgfx_parallel.size(),
+            [&jobs](size_t i) { run_object_gfx_job(jobs[objgfx_parallel[i]]); }, objgfx_threads);
+    }
+    else
+    {
+        for (size_t i : objgfx_parallel)
+            run_object_gfx_job(jobs[i]);
+    }
+}
+
+// Prepares the textures of the constructed images, and adds them to the sprite list
+static void add_objects_gfx(const std::vector<ObjectGfxJob> &jobs)
+{
+    const bool hw_accel = !drawstate.SoftwareRender;
+    for (const auto &job : jobs)
+    {
+        eip_guinum = job.ID;
+        int usebasel = job.Baseline;
+        // Prepare the object texture
+        prepare_and_add_object_gfx(*job.Sav, *job.Actsp, job.Modified,
+            job.ScaleSize, job.Atx, job.Aty, usebasel,
+            job.UseWalkbehinds, job.Transparency, hw_accel, job.TexCategory);
+        // Finally, add the texture to the draw list
+        add_to_sprite_list(job.Actsp->Ddb, job.Atx, job.Aty, usebasel, false);
+    }
+}
+
+// Fills the image construction parameters for RoomObject
+static void init_object_gfx_job(int objid, bool force_software, ObjectGfxJob &job)
 {
     const RoomObject &obj = objs[objid];
     if (!spriteset.DoesSpriteExist(obj.num))
         quitprintf("There was an error drawing object %d. Its current sprite, %d, is invalid.", objid, obj.num);
 
-    ObjectCache objsrc(obj.num, obj.tint_r, obj.tint_g, obj.tint_b,
+    job.ID = objid;
+    job.Vf = (obj.view != UINT16_MAX) ? &views[obj.view].loops[obj.loop].frames[obj.frame] : nullptr;
+    job.Pic = obj.num;
+    job.Sprite = nullptr;
+    job.ScaleSize = Size(obj.last_width, obj.last_height);
+    job.Src = ObjectCache(obj.num, obj.tint_r, obj.tint_g, obj.tint_b,
         obj.tint_level, obj.tint_light, 0 /* skip */, obj.zoom, false /* skip */,
         obj.x, obj.y);
+    get_object_tint(obj.flags & OBJF_TINTLIGHTMASK, job.Src, job.Tint);
+    job.Sav = &objcache[objid];
+    job.Actsp = &actsps[objid];
+    job.OptimizeByPos = true;
+    job.ForceSoftware = force_software;
+}
 
-    return construct_object_gfx(
-        (obj.view != UINT16_MAX) ? &views[obj.view].loops[obj.loop].frames[obj.frame] : nullptr,
-        obj.num,
-        Size(obj.last_width, obj.last_height),
-        obj.flags & OBJF_TINTLIGHTMASK,
-        objsrc,
-        objcache[objid],
-        actsps[objid],
-        true,
-        force_software);
+// Prepares a actsps element for RoomObject; updates object cache.
+// Software mode draws an actual bitmap in actsp, hardware mode only
+// assigns parameters, which may further be assigned to a texture.
+bool construct_object_gfx(int objid, bool force_software)
+{
+    ObjectGfxJob job;
+    init_object_gfx_job(objid, force_software, job);
+    run_object_gfx_job(job);
+    return !job.Modified;
 }
 
 void prepare_objects_for_drawing()
 {
     set_our_eip(32);
 
-    const bool hw_accel = !drawstate.SoftwareRender;
-
+    objgfx_jobs.resize(croom->numobj);
+    size_t job_count = 0;
     for (uint32_t objid = 0; objid < croom->numobj; ++objid)
     {
         const RoomObject &obj = objs[objid];
@@ -2067,23 +2876,23 @@ void prepare_objects_for_drawing()
             continue; // offscreen
 
         eip_guinum = objid;
-        const ObjectCache &objsav = objcache[objid];
-        ObjTexture &actsp = actsps[objid];
-
+        ObjectGfxJob &job = objgfx_jobs[job_count++];
+        init_object_gfx_job(objid, false, job);
         // Calculate sprite top-left position in the room and baseline
-        const int atx = data_to_game_coord(obj.x);
-        const int aty = data_to_game_coord(obj.y) - obj.last_height;
-        int usebasel = obj.get_baseline();
-
-        // Generate raw bitmap in ObjTexture and store parameters in ObjectCache.
-        bool actsp_modified = !construct_object_gfx(objid, false);
-        // Prepare the object texture
-        prepare_and_add_object_gfx(objsav, actsp, actsp_modified,
-            Size(obj.last_width, obj.last_height), atx, aty, usebasel,
-            (obj.flags & OBJF_NOWALKBEHINDS) == 0, obj.transparent, hw_accel);
-        // Finally, add the texture to the draw list
-        add_to_sprite_list(actsp.Ddb, atx, aty, usebasel, false);
+        const Point pos = interpolate_position(obj_interp, objid,
+            Point(data_to_game_coord(obj.x), data_to_game_coord(obj.y) - obj.last_height));
+        job.Atx = pos.X;
+        job.Aty = pos.Y;
+        job.Baseline = obj.get_baseline();
+        job.UseWalkbehinds = (obj.flags & OBJF_NOWALKBEHINDS) == 0;
+        job.Transparency = obj.transparent;
+        cull_last_object_gfx_job(job_count);
     }
+    objgfx_jobs.resize(job_count);
+
+    // Generate raw bitmaps in ObjTexture and store parameters in ObjectCache.
+    construct_objects_gfx(objgfx_jobs);
+    add_objects_gfx(objgfx_jobs);
 }
 
 
@@ -2127,16 +2936,14 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
 
         // customized trans blender to preserve alpha channel
         set_my_trans_blender (0, 0, 0, light_level);
-        ds->TransBlendBlt (finaltarget, 0, 0);
+        draw_trans_sprite32(ds->GetAllegroBitmap(), finaltarget->GetAllegroBitmap(), 0, 0);
         delete finaltarget;
     }
 }
 
 
-// Prepares a actsps element for Character; updates character cache.
-// Software mode draws an actual bitmap in actsp, hardware mode only
-// assigns parameters, which may further be assigned to a texture.
-bool construct_char_gfx(int charid, bool force_software)
+// Fills the image construction parameters for Character
+static void init_char_gfx_job(int charid, bool force_software, ObjectGfxJob &job)
 {
     const CharacterInfo &chin = game.chars[charid];
     const CharacterExtras &chex = charextra[charid];
@@ -2145,28 +2952,40 @@ bool construct_char_gfx(int charid, bool force_software)
     if (!spriteset.DoesSpriteExist(pic))
         quitprintf("There was an error drawing character %d. Its current frame's sprite, %d, is invalid.", charid, pic);
 
-    ObjectCache chsrc(pic, chex.tint_r, chex.tint_g, chex.tint_b,
+    job.ID = charid;
+    job.Vf = vf;
+    job.Pic = pic;
+    job.Sprite = nullptr;
+    job.ScaleSize = Size(chex.width, chex.height);
+    job.Src = ObjectCache(pic, chex.tint_r, chex.tint_g, chex.tint_b,
         chex.tint_level, chex.tint_light, 0 /* skip */, chex.zoom, false /* skip */,
         chin.x, chin.y);
+    get_object_tint(CharFlagsToObjFlags(chin.flags) & OBJF_TINTLIGHTMASK, job.Src, job.Tint);
+    job.Sav = &charcache[charid];
+    job.Actsp = &actsps[charid + ACTSP_OBJSOFF];
+    job.TexCategory = kTexCategory_Character;
+    job.OptimizeByPos = false; // characters cannot optimize by pos, probably because of z coord and view offsets (?)
+    job.ForceSoftware = force_software;
+}
 
-    return construct_object_gfx(
-        vf,
-        pic,
-        Size(chex.width, chex.height),
-        CharFlagsToObjFlags(chin.flags) & OBJF_TINTLIGHTMASK,
-        chsrc,
-        charcache[charid],
-        actsps[charid + ACTSP_OBJSOFF],
-        false, // characters cannot optimize by pos, probably because of z coord and view offsets (?)
-        force_software);
+// Prepares a actsps element for Character; updates character cache.
+// Software mode draws an actual bitmap in actsp, hardware mode only
+// assigns parameters, which may further be assigned to a texture.
+bool construct_char_gfx(int charid, bool force_software)
+{
+    ObjectGfxJob job;
+    init_char_gfx_job(charid, force_software, job);
+    run_object_gfx_job(job);
+    return !job.Modified;
 }
 
 void prepare_characters_for_drawing()
 {
     set_our_eip(33);
-    const bool hw_accel = !drawstate.SoftwareRender;
 
     // draw characters
+    objgfx_jobs.resize(game.numcharacters);
+    size_t job_count = 0;
     for (int charid = 0; charid < game.numcharacters; ++charid)
     {
         const CharacterInfo &chin = game.chars[charid];
@@ -2177,32 +2996,36 @@ void prepare_characters_for_drawing()
 
         eip_guinum = charid;
         const CharacterExtras &chex = charextra[charid];
-        const ObjectCache &chsav = charcache[charid];
-        ObjTexture &actsp = actsps[charid + ACTSP_OBJSOFF];
-
+        ObjectGfxJob &job = objgfx_jobs[job_count++];
+        init_char_gfx_job(charid, false, job);
         // Calculate sprite top-left position in the room and baseline
-        const int atx = chin.actx + chin.pic_xoffs * chex.zoom_offs / 100;
-        const int aty = chin.acty + chin.pic_yoffs * chex.zoom_offs / 100;
-        int usebasel = chin.get_baseline();
-
-        // Generate raw bitmap in ObjTexture and store parameters in ObjectCache.
-        bool actsp_modified = !construct_char_gfx(charid, false);
-        // Prepare the object texture
-        prepare_and_add_object_gfx(chsav, actsp, actsp_modified,
-            Size(chex.width, chex.height), atx, aty, usebasel,
-            (chin.flags & CHF_NOWALKBEHINDS) == 0, chin.transparency, hw_accel);
-        // Finally, add the texture to the draw list
-        add_to_sprite_list(actsp.Ddb, atx, aty, usebasel, false);
+        const Point pos = interpolate_position(char_interp, charid,
+            Point(chin.actx + chin.pic_xoffs * chex.zoom_offs / 100, chin.acty + chin.pic_yoffs * chex.zoom_offs / 100));
+        job.Atx = pos.X;
+        job.Aty = pos.Y;
+        job.Baseline = chin.get_baseline();
+        job.UseWalkbehinds = (chin.flags & CHF_NOWALKBEHINDS) == 0;
+        job.Transparency = chin.transparency;
+        cull_last_object_gfx_job(job_count);
     }
+    objgfx_jobs.resize(job_count);
+
+    // Generate raw bitmaps in ObjTexture and store parameters in ObjectCache.
+    construct_objects_gfx(objgfx_jobs);
+    add_objects_gfx(objgfx_jobs);
 }
 
 Bitmap *get_cached_character_image(int charid)
 {
+    if (charcache[charid].culled)
+        construct_char_gfx(charid, false);
     return actsps[charid + ACTSP_OBJSOFF].Bmp.get();
 }
 
 Bitmap *get_cached_object_image(int objid)
 {
+    if (objcache[objid].culled)
+        construct_object_gfx(objid, false);
     return actsps[objid].Bmp.get();
 }
 
@@ -2220,9 +3043,9 @@ void add_walkbehind_image(size_t index, Common::Bitmap *bmp, int x, int y)
 static void add_roomovers_for_drawing()
 {
     const auto &overs = get_overlays();
-    for (const auto &over : overs)
+    for (int type : get_overlay_ids())
     {
-        if (over.type < 0) continue; // empty slot
+        const auto &over = overs[type];
         if (!over.IsRoomLayer()) continue; // not a room layer
         if (over.transparency == 255) continue; // skip fully transparent
         Point pos = get_overlay_position(over);
@@ -2258,6 +3081,7 @@ void prepare_room_sprites()
 
     if ((debug_flags & DBG_NOOBJECTS) == 0)
     {
+        update_visible_room_areas();
         prepare_objects_for_drawing();
         prepare_characters_for_drawing();
         add_roomovers_for_drawing();
@@ -2354,7 +3178,10 @@ struct DrawFPS
     IDriverDependantBitmap* ddb = nullptr;
     std::unique_ptr<Bitmap> bmp;
     int font = -1; // in case normal font changes at runtime
-} gl_DrawFPS;
+} gl_DrawFPS, gl_DrawManagedStats;
+
+// Number of created managed objects, recorded when the stats were last drawn
+static uint32_t last_managed_created;
 
 void dispose_engine_overlay()
 {
@@ -2363,6 +3190,11 @@ void dispose_engine_overlay()
         gfxDriver->DestroyDDB(gl_DrawFPS.ddb);
     gl_DrawFPS.ddb = nullptr;
     gl_DrawFPS.font = -1;
+    gl_DrawManagedStats.bmp.reset();
+    if (gl_DrawManagedStats.ddb)
+        gfxDriver->DestroyDDB(gl_DrawManagedStats.ddb);
+    gl_DrawManagedStats.ddb = nullptr;
+    gl_DrawManagedStats.font = -1;
 }
 
 void draw_fps(const Rect &viewport)
@@ -2405,6 +3237,39 @@ void draw_fps(const Rect &viewport)
     invalidate_sprite_glob(1, yp, gl_DrawFPS.ddb);
 }
 
+// Draws managed objects statistics, one line above the fps display
+void draw_managed_stats(const Rect &viewport)
+{
+    const int font = FONT_NORMAL;
+    auto &statsDisplay = gl_DrawManagedStats.bmp;
+    const int line_height = get_font_surface_height(font) + get_fixed_pixel_size(5);
+    if (statsDisplay == nullptr || gl_DrawManagedStats.font != font)
+    {
+        recycle_bitmap(statsDisplay, game.GetColorDepth(), viewport.GetWidth(), line_height);
+        gl_DrawManagedStats.font = font;
+    }
+
+    statsDisplay->ClearTransparent();
+    const color_t text_color = statsDisplay->GetCompatibleColor(14);
+    uint32_t live_objects = 0u;
+    for (const auto &stats : pool.GetTypeStats())
+        live_objects += stats.second.count;
+    const uint32_t created = pool.GetTotalCreated();
+    const ManagedMemoryStats &mem = ccGetManagedMemoryStats();
+    char stats_buffer[120];
+    snprintf(stats_buffer, sizeof(stats_buffer), "Managed: %u objects, +%u/frame, %zu KB",
+        live_objects, created - last_managed_created, (mem.PooledBytes + mem.LargeBytes) / 1024);
+    last_managed_created = created;
+
+    int text_off = get_font_surface_extent(font).first;
+    wouttext_outline(statsDisplay.get(), 1, 1 - text_off, font, text_color, stats_buffer);
+
+    gl_DrawManagedStats.ddb = recycle_ddb_bitmap(gl_DrawManagedStats.ddb, gl_DrawManagedStats.bmp.get());
+    int yp = viewport.GetHeight() - line_height * 2;
+    gfxDriver->DrawSprite(1, yp, gl_DrawManagedStats.ddb);
+    invalidate_sprite_glob(1, yp, gl_DrawManagedStats.ddb);
+}
+
 // Draw GUI controls as separate sprites, each on their own texture
 static void construct_guictrl_tex(GUIMain &gui)
 {
@@ -2427,12 +3292,47 @@ static void construct_guictrl_tex(GUIMain &gui)
         recycle_bitmap(objbg.Bmp, game.GetColorDepth(), obj_surf.GetWidth(), obj_surf.GetHeight(), true);
         obj->Draw(objbg.Bmp.get(), -obj_surf.Left, -obj_surf.Top);
 
-        sync_object_texture(objbg, obj->HasAlphaChannel());
+        sync_object_texture(objbg, obj->HasAlphaChannel(), false, kTexCategory_GUI);
         objbg.Off = Point(obj_surf.GetLT());
         obj->ClearChanged();
     }
 }
 
+// Remembers the areas of the GUI controls drawn on the GUI surface
+static void store_guictrl_rects(GUIMain &gui)
+{
+    const int draw_index = guiobjddbref[gui.ID];
+    for (int i = 0; i < gui.GetControlCount(); ++i)
+    {
+        guiobjrc[draw_index + i] = gui.GetControlDrawRect(i);
+        gui.GetControl(i)->ClearChanged();
+    }
+}
+
+// Redraws only the changed GUI controls on the GUI surface, along with anything
+// behind and in front of them; returns the bounds of the redrawn area
+static Rect redraw_changed_guictrls(GUIMain &gui, Bitmap *ds)
+{
+    Rect dirty_rc;
+    const int draw_index = guiobjddbref[gui.ID];
+    for (int i = 0; i < gui.GetControlCount(); ++i)
+    {
+        GUIObject *obj = gui.GetControl(i);
+        if (!obj->HasChanged())
+            continue;
+
+        // The control's graphic may have changed its size, so erase the old area too
+        Rect &last_rc = guiobjrc[draw_index + i];
+        const Rect rc = gui.GetControlDrawRect(i);
+        const Rect area = last_rc.IsEmpty() ? rc : SumRects(last_rc, rc);
+        gui.DrawWithControls(ds, area);
+        last_rc = rc;
+        dirty_rc = dirty_rc.IsEmpty() ? area : SumRects(dirty_rc, area);
+        obj->ClearChanged();
+    }
+    return IntersectRects(dirty_rc, RectWH(ds->GetSize()));
+}
+
 // Push gui bg & controls textures for the render to the corresponding render target
 static void draw_gui_controls_batch(int gui_id)
 {
@@ -2489,9 +3389,9 @@ void draw_gui_and_overlays()
 
     // Add active overlays to the sprite list
     const auto &overs = get_overlays();
-    for (const auto &over : overs)
+    for (int type : get_overlay_ids())
     {
-        if (over.type < 0) continue; // empty slot
+        const auto &over = overs[type];
         if (over.IsRoomLayer()) continue; // not a ui layer
         if (over.transparency == 255) continue; // skip fully transparent
         Point pos = get_overlay_position(over);
@@ -2522,23 +3422,36 @@ void draw_gui_and_overlays()
                 eip_guinum = index;
                 set_our_eip(372);
                 const bool draw_with_controls = !draw_controls_as_textures;
-                if (gui.HasChanged() || (draw_with_controls && gui.HasControlsChanged()))
+                auto &gbg = guibg[index];
+                const bool is_alpha = gui.HasAlphaChannel();
+                // old-style (pre-3.0.2) GUI alpha rendering
+                const bool repair_alpha = is_alpha &&
+                    (game.options[OPT_NEWGUIALPHA] == kGuiAlphaRender_Legacy) && (gui.BgImage > 0);
+                // If only some controls changed their looks, then redraw and
+                // update only the part of the GUI which they cover
+                if (draw_with_controls && !gui.HasChanged() && !gui.HasControlsLayoutChanged() &&
+                    !repair_alpha && gbg.Ddb && gbg.Bmp && (gbg.Bmp->GetSize() == Size(gui.Width, gui.Height)))
+                {
+                    const Rect dirty_rc = redraw_changed_guictrls(gui, gbg.Bmp.get());
+                    if (!dirty_rc.IsEmpty())
+                        gfxDriver->UpdateDDBRegion(gbg.Ddb, gbg.Bmp.get(), is_alpha, dirty_rc);
+                }
+                else if (gui.HasChanged() || (draw_with_controls && gui.HasControlsChanged()))
                 {
-                    auto &gbg = guibg[index];
                     recycle_bitmap(gbg.Bmp, game.GetColorDepth(), gui.Width, gui.Height, true);
                     if (draw_with_controls)
+                    {
                         gui.DrawWithControls(gbg.Bmp.get());
+                        store_guictrl_rects(gui);
+                    }
                     else
+                    {
                         gui.DrawSelf(gbg.Bmp.get());
+                    }
 
-                    const bool is_alpha = gui.HasAlphaChannel();
-                    if (is_alpha)
+                    if (repair_alpha)
                     {
-                        if ((game.options[OPT_NEWGUIALPHA] == kGuiAlphaRender_Legacy) && (gui.BgImage > 0))
-                        {
-                            // old-style (pre-3.0.2) GUI alpha rendering
-                            repair_alpha_channel(gbg.Bmp.get(), spriteset[gui.BgImage]);
-                        }
+                        repair_alpha_channel(gbg.Bmp.get(), spriteset[gui.BgImage]);
                     }
                     sync_object_texture(gbg, is_alpha);
                 }
@@ -2633,6 +3546,105 @@ void GfxDriverOnInitCallback(void *data)
     pl_run_plugin_init_gfx_hooks(gfxDriver->GetDriverID(), data);
 }
 
+// Adds the pair of values to the FNV-1a-like hash
+static void hash_add(uint64_t &hash, int a, int b)
+{
+    hash = (hash ^ (static_cast<uint32_t>(a) | (static_cast<uint64_t>(static_cast<uint32_t>(b)) << 32))) * 1099511628211ull;
+}
+
+static void hash_add(uint64_t &hash, uint64_t v)
+{
+    hash = (hash ^ v) * 1099511628211ull;
+}
+
+// Hashes the room sprite list, which is the same for all the cameras;
+// tells if there are any plugin callbacks, which may draw anything
+static uint64_t hash_room_sprite_list(bool &has_callbacks)
+{
+    uint64_t hash = 14695981039346656037ull;
+    has_callbacks = false;
+    for (const auto &t : thingsToDrawList)
+    {
+        if (!t.ddb)
+        {
+            has_callbacks |= t.renderStage >= 0;
+            continue;
+        }
+        hash_add(hash, reinterpret_cast<uintptr_t>(t.ddb));
+        hash_add(hash, t.x, t.y);
+        hash_add(hash, gfxDriver->GetDDBStateHash(t.ddb));
+    }
+    return hash;
+}
+
+// Renders the room on the cameras' textures, where these are of use: for the
+// cameras shown by multiple viewports, and for the ones which view did not
+// change since the last frame; unchanged textures are not rendered again.
+static void construct_room_camera_textures()
+{
+    for (auto &camtex : CameraTextures)
+        camtex.Use = false;
+    // Count the viewports which show each camera
+    std::vector<int> view_counts;
+    for (const auto &viewport : play.GetRoomViewportsZOrdered())
+    {
+        auto camera = viewport->GetCamera();
+        if (!viewport->IsVisible() || !camera)
+            continue;
+        const size_t cam_index = camera->GetID();
+        if (view_counts.size() <= cam_index)
+            view_counts.resize(cam_index + 1);
+        view_counts[cam_index]++;
+    }
+    if (view_counts.empty())
+        return;
+
+    // Sync the pending sprite updates now, or they would not be noticed
+    // before the cached camera frames are drawn
+    sync_shared_textures();
+    bool has_callbacks;
+    const uint64_t list_hash = hash_room_sprite_list(has_callbacks);
+    if (CameraTextures.size() < view_counts.size())
+        CameraTextures.resize(view_counts.size());
+    for (size_t cam_index = 0; cam_index < view_counts.size(); ++cam_index)
+    {
+        if (view_counts[cam_index] == 0)
+            continue;
+        auto camera = play.GetRoomCamera(cam_index);
+        auto &camtex = CameraTextures[cam_index];
+        if (camtex.Owner.lock() != camera)
+        {
+            camtex.Owner = camera;
+            camtex.Valid = false;
+            camtex.ViewHash = 0u;
+        }
+
+        const Rect cam_rc = get_camera_draw_rect(*camera);
+        uint64_t view_hash = list_hash;
+        hash_add(view_hash, cam_rc.Left, cam_rc.Top);
+        hash_add(view_hash, cam_rc.GetWidth(), cam_rc.GetHeight());
+        // Plugin callbacks may draw different things each time
+        camtex.Use = !has_callbacks && ((view_counts[cam_index] > 1) || (view_hash == camtex.ViewHash));
+        camtex.ViewHash = view_hash;
+        if (!camtex.Use)
+        {
+            camtex.Valid = false;
+            continue;
+        }
+
+        camtex.Ddb = recycle_render_target(camtex.Ddb, cam_rc.GetWidth(), cam_rc.GetHeight(),
+            game.GetColorDepth(), false);
+        if (camtex.Valid && (camtex.FrameHash == view_hash))
+            continue; // keep the last rendered frame
+        gfxDriver->BeginSpriteBatch(camtex.Ddb, RectWH(cam_rc.GetSize()),
+            SpriteTransform(-cam_rc.Left, -cam_rc.Top));
+        put_sprite_list_on_screen(true);
+        gfxDriver->EndSpriteBatch();
+        camtex.Valid = true;
+        camtex.FrameHash = view_hash;
+    }
+}
+
 // Schedule room rendering: background, objects, characters
 static void construct_room_view()
 {
@@ -2640,6 +3652,8 @@ static void construct_room_view()
     prepare_room_sprites();
     // reset the Baselines Changed flag now that we've drawn stuff
     walk_behind_baselines_changed = 0;
+    if (drawstate.FullFrameRedraw)
+        construct_room_camera_textures();
 
     for (const auto &viewport : play.GetRoomViewportsZOrdered())
     {
@@ -2649,14 +3663,25 @@ static void construct_room_view()
         if (!camera)
             continue;
 
+        const auto view_start = AGS_Clock::now();
         const Rect &view_rc = viewport->GetRect();
-        const Rect &cam_rc = camera->GetRect();
+        const Rect cam_rc = get_camera_draw_rect(*camera);
         const float view_sx = (float)view_rc.GetWidth() / (float)cam_rc.GetWidth();
         const float view_sy = (float)view_rc.GetHeight() / (float)cam_rc.GetHeight();
         const SpriteTransform view_trans(view_rc.Left, view_rc.Top, view_sx, view_sy);
         const SpriteTransform cam_trans(-cam_rc.Left, -cam_rc.Top);
 
-        if (drawstate.FullFrameRedraw)
+        const auto *camtex = (static_cast<size_t>(camera->GetID()) < CameraTextures.size()) ?
+            &CameraTextures[camera->GetID()] : nullptr;
+        if (drawstate.FullFrameRedraw && camtex && camtex->Use)
+        {
+            // The room was rendered on the camera's texture, which is
+            // stretched over the viewport
+            gfxDriver->BeginSpriteBatch(view_rc, view_trans);
+            gfxDriver->DrawSprite(0, 0, camtex->Ddb);
+            gfxDriver->EndSpriteBatch();
+        }
+        else if (drawstate.FullFrameRedraw)
         {
             // For hw renderer we draw everything as a sprite stack;
             // viewport-camera pair is done as 2 nested scene nodes,
@@ -2698,6 +3723,7 @@ static void construct_room_view()
             gfxDriver->EndSpriteBatch();
             gfxDriver->EndSpriteBatch();
         }
+        render_times.Viewports.push_back(elapsed_us(view_start));
     }
 
     clear_draw_list();
@@ -2727,10 +3753,9 @@ static void construct_overlays()
             overcache.resize(overs.size(), Point(INT32_MIN, INT32_MIN));
     }
 
-    for (size_t i = 0; i < overs.size(); ++i)
+    for (int i : get_overlay_ids())
     {
         auto &over = overs[i];
-        if (over.type < 0) continue; // empty slot
         if (over.transparency == 255) continue; // skip fully transparent
 
         auto &overtx = overtxs[i];
@@ -2753,6 +3778,7 @@ static void construct_overlays()
             Bitmap *use_bmp = nullptr;
             if (is_software_mode)
             {
+                set_our_eip(339);
                 use_bmp = transform_sprite(over.GetImage(), over.HasAlphaChannel(), overtx.Bmp, Size(over.scaleWidth, over.scaleHeight));
                 if (crop_walkbehinds && over.IsRoomLayer())
                 {
@@ -2767,7 +3793,8 @@ static void construct_overlays()
                 }
             }
 
-            sync_object_texture(overtx, over.HasAlphaChannel());
+            sync_object_texture(overtx, over.HasAlphaChannel(), false,
+                over.IsRoomLayer() ? kTexCategory_Room : kTexCategory_GUI);
             over.ClearChanged();
         }
 
@@ -2780,6 +3807,7 @@ static void construct_overlays()
 
 void construct_game_scene(bool full_redraw)
 {
+    AGS_TRACE_ZONE("construct_game_scene");
     set_our_eip(3);
 
     // React to changes to viewports and cameras (possibly from script) just before the render
@@ -2795,7 +3823,9 @@ void construct_game_scene(bool full_redraw)
         invalidate_screen();
 
     // Overlays may be both in rooms and ui layer, prepare their textures beforehand
+    auto stage_start = AGS_Clock::now();
     construct_overlays();
+    render_times.Overlays = elapsed_us(stage_start);
 
     // TODO: move to game update! don't call update during rendering pass!
     // IMPORTANT: keep the order same because sometimes script may depend on it
@@ -2812,7 +3842,9 @@ void construct_game_scene(bool full_redraw)
     {
         if (displayed_room >= 0)
         {
+            stage_start = AGS_Clock::now();
             construct_room_view();
+            render_times.Room = elapsed_us(stage_start);
         }
         else if (!drawstate.FullFrameRedraw)
         {
@@ -2827,11 +3859,17 @@ void construct_game_scene(bool full_redraw)
     // Stage: UI overlay
     if (play.screen_is_faded_out == 0)
     {
+        stage_start = AGS_Clock::now();
         construct_ui_view();
+        render_times.UI = elapsed_us(stage_start);
     }
 
     // End the parent scene node
     gfxDriver->EndSpriteBatch();
+
+    // Apply the remaining sprite changes (e.g. done by the plugin hooks)
+    // to the textures, before they are rendered
+    sync_shared_textures();
 }
 
 void construct_game_screen_overlay(bool draw_mouse)
@@ -2845,9 +3883,11 @@ void construct_game_screen_overlay(bool draw_mouse)
     }
 
     // Mouse cursor
+    const bool show_mouse = (play.screen_is_faded_out == 0) && draw_mouse && !play.mouse_cursor_hidden;
+    show_hardware_cursor(show_mouse);
     if (play.screen_is_faded_out == 0)
     {
-        if (draw_mouse && !play.mouse_cursor_hidden)
+        if (show_mouse && !is_hardware_cursor_active())
         {
             // Exclusive sub-batch for mouse cursor, to let filter it out (CHECKME later?)
             gfxDriver->BeginSpriteBatch(Rect(), SpriteTransform(), kFlip_None, nullptr, RENDER_BATCH_MOUSE_CURSOR);
@@ -2883,6 +3923,8 @@ void construct_engine_overlay()
 
     if (display_fps != kFPS_Hide)
         draw_fps(viewport);
+    if (display_managed_stats)
+        draw_managed_stats(viewport);
 
     gfxDriver->EndSpriteBatch();
 }
@@ -2985,16 +4027,36 @@ void update_room_debug()
 }
 
 // Draw everything 
-void render_graphics(IDriverDependantBitmap *extraBitmap, int extraX, int extraY)
+// Tells if the game frame should not be rendered now
+static bool is_render_skipped()
 {
     // Don't render if skipping cutscene
     if (play.fast_forward)
-        return;
+        return true;
     // Don't render if we've just entered new room and are before fade-in
     // TODO: find out why this is not skipped for 8-bit games
-    if ((in_new_room > 0) & (game.color_depth > 1))
+    return (in_new_room > 0) & (game.color_depth > 1);
+}
+
+void render_graphics(IDriverDependantBitmap *extraBitmap, int extraX, int extraY)
+{
+    AGS_TRACE_ZONE("render_graphics");
+    BenchmarkStageScope bench_scope(kBenchStage_Render);
+    if (is_render_skipped())
         return;
 
+    if (drawstate.FrameInterpolation)
+    {
+        if (drawstate.InterpRoom != displayed_room)
+        {
+            reset_interp_positions();
+            drawstate.InterpRoom = displayed_room;
+        }
+        if (!drawstate.InterpFrame)
+            drawstate.RenderTick++;
+        drawstate.InterpAlpha = getFrameProgress();
+    }
+
     // TODO: find out if it's okay to move shake to update function
     update_shakescreen();
 
@@ -3024,3 +4086,18 @@ void render_graphics(IDriverDependantBitmap *extraBitmap, int extraX, int extraY
 
     drawstate.ScreenIsDirty = false;
 }
+
+bool is_frame_interpolation_on()
+{
+    return drawstate.FrameInterpolation;
+}
+
+bool render_graphics_interpolated(IDriverDependantBitmap *extraBitmap, int extraX, int extraY)
+{
+    if (!drawstate.FrameInterpolation || is_render_skipped())
+        return false;
+    drawstate.InterpFrame = true;
+    render_graphics(extraBitmap, extraX, extraY);
+    drawstate.InterpFrame = false;
+    return true;
+}
@@ -14,13 +14,16 @@
 #ifndef __AGS_EE_AC__DRAW_H
 #define __AGS_EE_AC__DRAW_H
 
+#include <array>
 #include <memory>
+#include <vector>
 #include "core/types.h"
 #include "ac/common_defines.h"
 #include "ac/runtime_defines.h"
 #include "gfx/bitmap.h"
 #include "gfx/gfx_def.h"
 #include "game/roomstruct.h"
+#include "util/resourcecache.h"
 
 namespace AGS
 {
@@ -41,6 +44,17 @@ using namespace AGS; // FIXME later
 #define RENDER_BATCH_MOUSE_CURSOR    0x0002
 #define RENDER_SHOT_SKIP_ON_FADE     (RENDER_BATCH_ENGINE_OVERLAY | RENDER_BATCH_MOUSE_CURSOR)
 
+// Kinds of the game elements which the textures are made for;
+// used to report the texture memory taken by each of them
+enum TextureCategory
+{
+    kTexCategory_Room,      // room backgrounds, objects, walk-behinds, overlays
+    kTexCategory_Character,
+    kTexCategory_GUI,       // GUI, controls and screen overlays
+    kTexCategory_Dynamic,   // dynamic sprites, whatever they are drawn as
+    kNumTexCategories
+};
+
 // Converts AGS color index to the actual bitmap color using game's color depth
 int MakeColor(int color_index);
 
@@ -83,21 +97,45 @@ void mark_object_changed(int objid);
 void reset_drawobj_for_overlay(int objnum);
 // Marks all game objects which reference this sprite for redraw
 void notify_sprite_changed(int sprnum, bool deleted);
+// Same as above, but only the given area of the sprite's pixels was changed
+void notify_sprite_changed(int sprnum, const Rect &area);
 
 // Get current texture cache's stats: max size, current normal items size,
 // size of locked items (included into cur_size),
 // size of external items (excluded from cur_size)
 void texturecache_get_state(size_t &max_size, size_t &cur_size, size_t &locked_size, size_t &ext_size);
+// Get texture cache's use stats: requests, evictions and texture loads
+const AGS::Common::ResourceCacheStats &texturecache_get_stats();
 // Returns current cache size
 size_t texturecache_get_size();
+// Get the total size of the existing textures per each category; this includes
+// the shared textures still used on screen after leaving the cache, and the
+// game objects' own textures
+std::array<size_t, kNumTexCategories> texturecache_get_category_sizes();
+// Locks or unlocks the sprite's texture in the cache, following the
+// sprite's lock in the sprite cache; locked textures are never disposed
+void texturecache_set_locked(uint32_t sprite_id, bool locked);
 // Completely resets texture cache
 void texturecache_clear();
-// Update shared and cached texture from the sprite's pixels
+// Update shared and cached texture from the sprite's pixels;
+// the update is deferred until the texture is used for rendering
 void update_shared_texture(uint32_t sprite_id);
+// Update only the given area of the shared texture from the sprite's pixels
+void update_shared_texture(uint32_t sprite_id, const Rect &area);
+// Applies the pending update of the shared texture immediately
+void sync_shared_texture(uint32_t sprite_id);
+// Applies all the pending updates of the shared textures
+void sync_shared_textures();
 // Remove a texture from cache
 void clear_shared_texture(uint32_t sprite_id);
 // Prepares a texture for the given sprite and stores in the cache
-void texturecache_precache(uint32_t sprite_id);
+void texturecache_precache(uint32_t sprite_id, TextureCategory category = kTexCategory_Room);
+// Queues the textures to be created ahead of their use, for the sprites
+// which are being prefetched; see texturecache_process_uploads()
+void texturecache_queue_uploads(const std::vector<int32_t> &sprites, TextureCategory category);
+// Creates the queued textures for the sprites which are already loaded,
+// as many as fit into the per-frame time limit and the free cache space
+void texturecache_process_uploads();
 
 // whether there are currently remnants of a DisplaySpeech
 void mark_screen_dirty();
@@ -118,12 +156,18 @@ Common::Bitmap *recycle_bitmap(Common::Bitmap *bimp, int coldep, int wid, int hi
 void recycle_bitmap(std::unique_ptr<Common::Bitmap> &bimp, int coldep, int wid, int hit, bool make_transparent = false);
 Engine::IDriverDependantBitmap* recycle_ddb_bitmap(Engine::IDriverDependantBitmap *ddb, Common::Bitmap *source, bool has_alpha = false, bool opaque = false);
 Engine::IDriverDependantBitmap* recycle_ddb_sprite(Engine::IDriverDependantBitmap *ddb, uint32_t sprite_id,
-    Common::Bitmap *source, bool has_alpha = false, bool opaque = false);
+    Common::Bitmap *source, bool has_alpha = false, bool opaque = false,
+    TextureCategory category = kTexCategory_Room);
 Engine::IDriverDependantBitmap* recycle_render_target(Engine::IDriverDependantBitmap *ddb, int width, int height, int col_depth, bool opaque = false);
 // Updates shakescreen render offset
 void update_shakescreen();
 // Draw everything 
 void render_graphics(Engine::IDriverDependantBitmap *extraBitmap = nullptr, int extraX = 0, int extraY = 0);
+// Tells if the frames are rendered in between the game ticks
+bool is_frame_interpolation_on();
+// Draws a frame in between the game ticks, interpolating the movement of the
+// room entities and cameras; returns false if the frame was not rendered
+bool render_graphics_interpolated(Engine::IDriverDependantBitmap *extraBitmap = nullptr, int extraX = 0, int extraY = 0);
 // Construct game scene, scheduling drawing list for the renderer
 void construct_game_scene(bool full_redraw = false);
 // Construct final game screen elements; updates and draws mouse cursor
@@ -149,6 +193,32 @@ void draw_gui_sprite(Common::Bitmap *ds, bool use_alpha, int xpos, int ypos,
 
 // Render game on screen
 void render_to_screen();
+
+// CPU time spent on the render stages of the last frame, in microseconds
+struct RenderStageTimes
+{
+    uint32_t Overlays = 0u; // preparing the overlay textures
+    uint32_t Room = 0u;     // constructing all the room viewports
+    uint32_t UI = 0u;       // constructing the GUI layer
+    uint32_t Render = 0u;   // renderer's work, including the present
+    std::vector<uint32_t> Viewports; // per visible room viewport, in z-order
+};
+// Gets the render stage times of the last rendered frame
+const RenderStageTimes &get_render_stage_times();
+// Sprite list sorting work of the last frame, summed for room and GUI lists
+struct SpriteSortStats
+{
+    uint32_t Sprites = 0u;          // number of sorted sprites
+    uint32_t Moves = 0u;            // sprite moves done by the incremental sorts
+    uint32_t IncrementalSorts = 0u; // lists fixed up starting from the last frame's order
+    uint32_t FullSorts = 0u;        // lists sorted from scratch
+};
+// Gets the sprite list sorting stats of the last rendered frame
+const SpriteSortStats &get_sprite_sort_stats();
+// Starts writing the render stage times and renderer statistics of each
+// frame into the CSV file
+bool render_trace_start(const Common::String &filename);
+void render_trace_stop();
 void GfxDriverOnInitCallback(void *data);
 bool GfxDriverSpriteEvtCallback(int evt, int data);
 void putpixel_compensate (Common::Bitmap *g, int xx,int yy, int col);
@@ -215,6 +285,17 @@ Common::PBitmap PrepareSpriteForUse(Common::PBitmap bitmap, bool has_alpha);
 // of the requested width and height and game's native color depth.
 Common::Bitmap *CopyScreenIntoBitmap(int width, int height, const Rect *src_rect = nullptr,
     bool at_native_res = false, uint32_t batch_skip_filter = 0u);
+// Same as above, but copies the screenshot into the given bitmap, which size
+// and color depth are used as the requested format.
+void CopyScreenIntoBitmap(Common::Bitmap *dst, const Rect *src_rect = nullptr,
+    bool at_native_res = false, uint32_t batch_skip_filter = 0u);
+// Begins an asynchronous screenshot of the last screen render; returns the request handle,
+// or 0 on failure. The renderer may transfer the pixels while the game continues.
+uint32_t BeginCopyScreenIntoBitmap(const Rect *src_rect = nullptr,
+    bool at_native_res = false, uint32_t batch_skip_filter = 0u);
+// Completes the asynchronous screenshot, waiting for it if necessary, and returns
+// it as a bitmap of the requested width and height and game's native color depth.
+Common::Bitmap *EndCopyScreenIntoBitmap(uint32_t handle, int width, int height);
 
 
 // TODO: hide these behind some kind of an interface
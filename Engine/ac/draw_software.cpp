@@ -36,6 +36,7 @@
 //
 //=============================================================================
 
+#include <algorithm>
 #include <string.h>
 #include <vector>
 #include "ac/draw_software.h"
@@ -69,6 +70,34 @@ struct IRRow
     IRRow();
 };
 
+// Tile grid: an alternative to the spans, which splits the surface into
+// square tiles, and marks every tile touched by the invalidated rectangle
+// with a bit. Marking is cheap regardless of how many rectangles there are,
+// and it never degenerates to the whole surface redraw; the price is that
+// the redrawn area is aligned to the tile borders.
+struct DirtyTiles
+{
+    static const int TileShift = 5; // 32 x 32 tiles
+    static const int TileSize = 1 << TileShift;
+
+    int Cols = 0;
+    int Rows = 0;
+    int WordsPerRow = 0;
+    // One bit per tile, each row of tiles begins with a new word
+    std::vector<uint64_t> Bits;
+
+    void Init(const Size &surf_size);
+    void Clear();
+    // Marks the tiles touched by the given rectangle, which must be inside the surface
+    void Mark(int x1, int y1, int x2, int y2);
+    // Gets the dirty tiles merged into rectangles (in tile units):
+    // runs of tiles in each row, and the equal runs in adjacent rows
+    void GetRects(std::vector<Rect> &rects) const;
+
+private:
+    bool IsSet(const uint64_t *row, int tx) const { return (row[tx >> 6] >> (tx & 63)) & 1; }
+};
+
 struct DirtyRects
 {
     // Size of the surface managed by this dirty rects object
@@ -84,6 +113,8 @@ struct DirtyRects
     std::vector<IRRow> DirtyRows;
     Rect DirtyRegions[MAXDIRTYREGIONS];
     size_t NumDirtyRegions;
+    // Dirty tiles, used instead of the rows if the tile grid is enabled
+    DirtyTiles Tiles;
 
     DirtyRects();
     bool IsInit() const;
@@ -97,6 +128,12 @@ struct DirtyRects
 };
 
 
+// Whether to track the dirty regions using the tile grid
+static bool UseDirtyTiles = false;
+// Redrawn regions statistics
+static InvalidRegionStats RegionStats;
+
+
 IRSpan::IRSpan()
     : x1(0), x2(0)
 {
@@ -119,6 +156,81 @@ int IRSpan::mergeSpan(int tx1, int tx2)
     return 1;
 }
 
+void DirtyTiles::Init(const Size &surf_size)
+{
+    Cols = (surf_size.Width + TileSize - 1) >> TileShift;
+    Rows = (surf_size.Height + TileSize - 1) >> TileShift;
+    WordsPerRow = (Cols + 63) / 64;
+    Bits.assign(WordsPerRow * Rows, 0u);
+}
+
+void DirtyTiles::Clear()
+{
+    std::fill(Bits.begin(), Bits.end(), 0u);
+}
+
+void DirtyTiles::Mark(int x1, int y1, int x2, int y2)
+{
+    const int tx1 = x1 >> TileShift, tx2 = x2 >> TileShift;
+    const int ty1 = y1 >> TileShift, ty2 = y2 >> TileShift;
+    const int w1 = tx1 >> 6, w2 = tx2 >> 6;
+    const uint64_t mask1 = ~0ull << (tx1 & 63);
+    const uint64_t mask2 = ~0ull >> (63 - (tx2 & 63));
+    for (int ty = ty1; ty <= ty2; ++ty)
+    {
+        uint64_t *row = &Bits[ty * WordsPerRow];
+        if (w1 == w2)
+        {
+            row[w1] |= mask1 & mask2;
+            continue;
+        }
+        row[w1] |= mask1;
+        for (int w = w1 + 1; w < w2; ++w)
+            row[w] = ~0ull;
+        row[w2] |= mask2;
+    }
+}
+
+void DirtyTiles::GetRects(std::vector<Rect> &rects) const
+{
+    // Runs of the previous row, which may continue in the next one;
+    // Rect's Top is the row this run started at
+    std::vector<Rect> open, next;
+    for (int ty = 0; ty <= Rows; ++ty)
+    {
+        next.clear();
+        if (ty < Rows)
+        {
+            const uint64_t *row = &Bits[ty * WordsPerRow];
+            for (int tx = 0; tx < Cols;)
+            {
+                if ((row[tx >> 6] >> (tx & 63)) == 0u)
+                {
+                    tx = (tx | 63) + 1; // skip the rest of the empty word
+                    continue;
+                }
+                for (; !IsSet(row, tx); ++tx);
+                const int run_start = tx;
+                for (; (tx < Cols) && IsSet(row, tx); ++tx);
+                next.push_back(Rect(run_start, ty, tx - 1, ty));
+            }
+        }
+
+        // Continue the open runs which are same in this row, close the rest
+        size_t i = 0;
+        for (auto &run : next)
+        {
+            for (; (i < open.size()) && (open[i].Left < run.Left); ++i)
+                rects.push_back(Rect(open[i].Left, open[i].Top, open[i].Right, ty - 1));
+            if ((i < open.size()) && (open[i].Left == run.Left) && (open[i].Right == run.Right))
+                run.Top = open[i++].Top;
+        }
+        for (; i < open.size(); ++i)
+            rects.push_back(Rect(open[i].Left, open[i].Top, open[i].Right, ty - 1));
+        std::swap(open, next);
+    }
+}
+
 DirtyRects::DirtyRects()
     : NumDirtyRegions(0)
 {
@@ -137,6 +249,7 @@ void DirtyRects::Init(const Size &surf_size, const Rect &viewport)
         Destroy();
         SurfaceSize = surf_size;
         DirtyRows.resize(height);
+        Tiles.Init(surf_size);
 
         NumDirtyRegions = WHOLESCREENDIRTY;
         for (int i = 0; i < height; ++i)
@@ -156,6 +269,7 @@ void DirtyRects::SetSurfaceOffsets(int x, int y)
 void DirtyRects::Destroy()
 {
     DirtyRows.clear();
+    Tiles = DirtyTiles();
     NumDirtyRegions = 0;
 }
 
@@ -165,6 +279,7 @@ void DirtyRects::Reset()
 
     for (size_t i = 0; i < DirtyRows.size(); ++i)
         DirtyRows[i].numSpans = 0;
+    Tiles.Clear();
 }
 
 // Dirty rects for the game screen background (black screen);
@@ -179,6 +294,27 @@ std::vector<DirtyRects> RoomCamRects;
 std::vector<std::pair<int, int>> RoomCamPositions;
 
 
+void set_invalid_regions_tiled(bool tiled)
+{
+    if (UseDirtyTiles == tiled)
+        return;
+    UseDirtyTiles = tiled;
+    // the regions collected so far are kept only by the previous method
+    BlackRects.NumDirtyRegions = WHOLESCREENDIRTY;
+    for (auto &rects : RoomCamRects)
+        rects.NumDirtyRegions = WHOLESCREENDIRTY;
+}
+
+const InvalidRegionStats &get_invalid_region_stats()
+{
+    return RegionStats;
+}
+
+void reset_invalid_region_stats()
+{
+    RegionStats = InvalidRegionStats();
+}
+
 void dispose_invalid_regions(bool /* room_only */)
 {
     RoomCamRects.clear();
@@ -278,6 +414,14 @@ void invalidate_rect_on_surf(int x1, int y1, int x2, int y2, DirtyRects &rects)
     if (y2 >= surfsz.Height) y2 = surfsz.Height - 1;
     if (x1 < 0) x1 = 0;
     if (y1 < 0) y1 = 0;
+
+    if (UseDirtyTiles)
+    {
+        rects.Tiles.Mark(x1, y1, x2, y2);
+        rects.NumDirtyRegions = 1; // only tells that there's something to redraw
+        return;
+    }
+
     rects.NumDirtyRegions++;
 
     // ** Span code
@@ -393,6 +537,28 @@ void invalidate_rect_global(int x1, int y1, int x2, int y2)
         invalidate_rect_ds(rects, x1, y1, x2, y2, false);
 }
 
+// Gets the dirty tiles merged into rectangles, in surface coordinates
+static void get_dirty_tile_rects(const DirtyRects &rects, std::vector<Rect> &tile_rects)
+{
+    tile_rects.clear();
+    rects.Tiles.GetRects(tile_rects);
+    const int tile_size = DirtyTiles::TileSize;
+    for (auto &r : tile_rects)
+    {
+        r = Rect(r.Left * tile_size, r.Top * tile_size,
+            std::min((r.Right + 1) * tile_size, rects.SurfaceSize.Width) - 1,
+            std::min((r.Bottom + 1) * tile_size, rects.SurfaceSize.Height) - 1);
+    }
+}
+
+// Counts the redrawn pixels of the dirty rects surface
+static void add_region_stats(const DirtyRects &rects, uint64_t redrawn_pixels)
+{
+    RegionStats.Updates++;
+    RegionStats.RedrawnPixels += redrawn_pixels;
+    RegionStats.SurfacePixels += static_cast<uint64_t>(rects.SurfaceSize.Width) * rects.SurfaceSize.Height;
+}
+
 // Note that this function is denied to perform any kind of scaling or other transformation
 // other than blitting with offset. This is mainly because destination could be a 32-bit virtual screen
 // while room background was 16-bit and Allegro lib does not support stretching between colour depths.
@@ -411,9 +577,21 @@ void update_invalid_region(Bitmap *ds, Bitmap *src, const DirtyRects &rects, boo
     const int dst_x = no_transform ? 0 : rects.Viewport.Left;
     const int dst_y = no_transform ? 0 : rects.Viewport.Top;
 
+    uint64_t redrawn_pixels = 0u;
     if (rects.NumDirtyRegions == WHOLESCREENDIRTY)
     {
         ds->Blit(src, src_x, src_y, dst_x, dst_y, rects.SurfaceSize.Width, rects.SurfaceSize.Height);
+        redrawn_pixels = static_cast<uint64_t>(rects.SurfaceSize.Width) * rects.SurfaceSize.Height;
+    }
+    else if (UseDirtyTiles)
+    {
+        static std::vector<Rect> tile_rects;
+        get_dirty_tile_rects(rects, tile_rects);
+        for (const auto &r : tile_rects)
+        {
+            ds->Blit(src, r.Left + src_x, r.Top + src_y, r.Left + dst_x, r.Top + dst_y, r.GetWidth(), r.GetHeight());
+            redrawn_pixels += static_cast<uint64_t>(r.GetWidth()) * r.GetHeight();
+        }
     }
     else
     {
@@ -435,6 +613,7 @@ void update_invalid_region(Bitmap *ds, Bitmap *src, const DirtyRects &rects, boo
                     int tx1 = dirty_row.span[k].x1;
                     int tx2 = dirty_row.span[k].x2;
                     memcpy(&dst_scanline[(tx1 + dst_x) * bypp], &src_scanline[(tx1 + src_x) * bypp], ((tx2 - tx1) + 1) * bypp);
+                    redrawn_pixels += (tx2 - tx1) + 1;
                 }
             }
         }
@@ -455,10 +634,12 @@ void update_invalid_region(Bitmap *ds, Bitmap *src, const DirtyRects &rects, boo
                     int tx1 = dirty_row.span[k].x1;
                     int tx2 = dirty_row.span[k].x2;
                     ds->Blit(src, tx1 + src_x, i + src_y, tx1 + dst_x, i + dst_y, (tx2 - tx1) + 1, rowsInOne);
+                    redrawn_pixels += ((tx2 - tx1) + 1) * rowsInOne;
                 }
             }
         }
     }
+    add_region_stats(rects, redrawn_pixels);
 }
 
 void update_invalid_region(Bitmap *ds, color_t fill_color, const DirtyRects &rects)
@@ -469,6 +650,13 @@ void update_invalid_region(Bitmap *ds, color_t fill_color, const DirtyRects &rec
     {
         ds->FillRect(rects.Viewport, fill_color);
     }
+    else if (UseDirtyTiles)
+    {
+        static std::vector<Rect> tile_rects;
+        get_dirty_tile_rects(rects, tile_rects);
+        for (const auto &r : tile_rects)
+            ds->FillRect(rects.Room2Screen.ScaleRange(r), fill_color);
+    }
     else
     {
         const std::vector<IRRow> &dirtyRow = rects.DirtyRows;
@@ -23,6 +23,19 @@
 #include "gfx/ddb.h"
 #include "util/geometry.h"
 
+// Statistics of the room regions redrawn by the software renderer
+struct InvalidRegionStats
+{
+    uint32_t Updates = 0u; // number of surface updates
+    uint64_t RedrawnPixels = 0u; // pixels redrawn in these updates
+    uint64_t SurfacePixels = 0u; // total pixels of the updated surfaces
+};
+
+// Selects the dirty regions tracking method: the tile grid, or the spans per row
+void set_invalid_regions_tiled(bool tiled);
+// Gets the redrawn regions statistics collected since the last reset
+const InvalidRegionStats &get_invalid_region_stats();
+void reset_invalid_region_stats();
 // Sets global viewport offset (used for legacy letterbox)
 void set_invalidrects_globaloffs(int x, int y);
 // Inits dirty rects array for the given room camera/viewport pair
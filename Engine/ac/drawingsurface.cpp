@@ -11,6 +11,7 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
 #include "ac/draw.h"
 #include "ac/drawingsurface.h"
 #include "ac/common.h"
@@ -70,7 +71,11 @@ void DrawingSurface_Release(ScriptDrawingSurface* sds)
     {
         if (sds->modified)
         {
-            game_sprite_updated(sds->dynamicSpriteNumber);
+            // Update only the modified part of the sprite's texture, if known
+            if (sds->modifiedArea.IsEmpty())
+                game_sprite_updated(sds->dynamicSpriteNumber);
+            else
+                game_sprite_updated(sds->dynamicSpriteNumber, sds->modifiedArea);
         }
 
         sds->dynamicSpriteNumber = -1;
@@ -81,6 +86,25 @@ void DrawingSurface_Release(ScriptDrawingSurface* sds)
         sds->dynamicSurfaceNumber = -1;
     }
     sds->modified = 0;
+    sds->modifiedArea = Rect();
+}
+
+// Gets the area of the surface which may be touched by the lines of text
+// printed at the given range of y positions. The glyphs may stick out of the
+// formal font height, and the outline adds its thickness around them, so this
+// takes the font's graphical extent and the full rows of the surface.
+static Rect GetTextRowsArea(const Bitmap *ds, int font, int first_y, int last_y)
+{
+    std::pair<int, int> extent = get_font_surface_extent(font);
+    const int outline_font = get_font_outline(font);
+    if (outline_font >= 0)
+    {
+        const std::pair<int, int> outline_extent = get_font_surface_extent(outline_font);
+        extent.first = std::min(extent.first, outline_extent.first);
+        extent.second = std::max(extent.second, outline_extent.second);
+    }
+    const int margin = get_font_outline_thickness(font) + 1;
+    return Rect(0, first_y + extent.first - margin, ds->GetWidth() - 1, last_y + extent.second + margin);
 }
 
 void ScriptDrawingSurface::PointToGameResolution(int *xcoord, int *ycoord)
@@ -191,7 +215,7 @@ void DrawingSurface_DrawImageImpl(ScriptDrawingSurface* sds, Bitmap* src,
     draw_sprite_support_alpha(ds, sds->hasAlphaChannel != 0, dst_x, dst_y, src, src_has_alpha,
         kBlendMode_Alpha, GfxDef::Trans100ToAlpha255(trans));
 
-    sds->FinishedDrawing();
+    sds->FinishedDrawing(RectWH(dst_x, dst_y, src->GetWidth(), src->GetHeight()));
 
     if (needToFreeBitmap)
         delete src;
@@ -298,7 +322,7 @@ void DrawingSurface_DrawCircle(ScriptDrawingSurface *sds, int x, int y, int radi
 
     Bitmap *ds = sds->StartDrawing();
     ds->FillCircle(Circle(x, y, radius), sds->currentColour);
-    sds->FinishedDrawing();
+    sds->FinishedDrawing(Rect(x - radius, y - radius, x + radius, y + radius));
 }
 
 void DrawingSurface_DrawRectangle(ScriptDrawingSurface *sds, int x1, int y1, int x2, int y2)
@@ -308,7 +332,7 @@ void DrawingSurface_DrawRectangle(ScriptDrawingSurface *sds, int x1, int y1, int
 
     Bitmap *ds = sds->StartDrawing();
     ds->FillRect(Rect(x1,y1,x2,y2), sds->currentColour);
-    sds->FinishedDrawing();
+    sds->FinishedDrawing(Rect(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2)));
 }
 
 void DrawingSurface_DrawTriangle(ScriptDrawingSurface *sds, int x1, int y1, int x2, int y2, int x3, int y3)
@@ -319,7 +343,8 @@ void DrawingSurface_DrawTriangle(ScriptDrawingSurface *sds, int x1, int y1, int
 
     Bitmap *ds = sds->StartDrawing();
     ds->DrawTriangle(Triangle(x1,y1,x2,y2,x3,y3), sds->currentColour);
-    sds->FinishedDrawing();
+    sds->FinishedDrawing(Rect(std::min({x1, x2, x3}), std::min({y1, y2, y3}),
+        std::max({x1, x2, x3}), std::max({y1, y2, y3})));
 }
 
 void DrawingSurface_DrawString(ScriptDrawingSurface *sds, int xx, int yy, int font, const char* text)
@@ -334,7 +359,7 @@ void DrawingSurface_DrawString(ScriptDrawingSurface *sds, int xx, int yy, int fo
     }
     String res_str = GUI::ApplyTextDirection(text);
     wouttext_outline(ds, xx, yy, font, text_color, res_str.GetCStr());
-    sds->FinishedDrawing();
+    sds->FinishedDrawing(GetTextRowsArea(ds, font, yy, yy));
 }
 
 void DrawingSurface_DrawStringWrapped_Old(ScriptDrawingSurface *sds, int xx, int yy, int wid, int font, int alignment, const char *msg) {
@@ -359,7 +384,7 @@ void DrawingSurface_DrawStringWrapped(ScriptDrawingSurface *sds, int xx, int yy,
             xx, xx + wid - 1, yy + linespacing*i, (FrameAlignment)alignment);
     }
 
-    sds->FinishedDrawing();
+    sds->FinishedDrawing(GetTextRowsArea(ds, font, yy, yy + linespacing * (static_cast<int>(Lines.Count()) - 1)));
 }
 
 void DrawingSurface_DrawMessageWrapped(ScriptDrawingSurface *sds, int xx, int yy, int wid, int font, int msgm)
@@ -390,7 +415,9 @@ void DrawingSurface_DrawLine(ScriptDrawingSurface *sds, int fromx, int fromy, in
             ds->DrawLine (Line(fromx + xx, fromy + yy, tox + xx, toy + yy), draw_color);
         }
     }
-    sds->FinishedDrawing();
+    const int off_min = -(thickness / 2), off_max = thickness - 1 - (thickness / 2);
+    sds->FinishedDrawing(Rect(std::min(fromx, tox) + off_min, std::min(fromy, toy) + off_min,
+        std::max(fromx, tox) + off_max, std::max(fromy, toy) + off_max));
 }
 
 void DrawingSurface_DrawPixel(ScriptDrawingSurface *sds, int x, int y) {
@@ -408,7 +435,7 @@ void DrawingSurface_DrawPixel(ScriptDrawingSurface *sds, int x, int y) {
             ds->PutPixel(x + ii, y + jj, draw_color);
         }
     }
-    sds->FinishedDrawing();
+    sds->FinishedDrawing(RectWH(x, y, thickness, thickness));
 }
 
 int DrawingSurface_GetPixel(ScriptDrawingSurface *sds, int x, int y) {
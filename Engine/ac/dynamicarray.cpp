@@ -0,0 +1,175 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Dynamic array script API: bulk operations over the whole arrays or their
+// ranges, which would otherwise require per-element loops in script.
+//
+// The script has no generic array type, so the functions are declared for
+// each of the supported element types (int, float and String). All of these
+// have 4-byte elements, so the same implementation serves them, except Fill,
+// which has to convert the value.
+//
+//=============================================================================
+#include <algorithm>
+#include <string.h>
+#include "ac/common.h" // quit
+#include "ac/dynobj/cc_dynamicarray.h"
+#include "ac/dynobj/dynobj_manager.h"
+#include "script/script_api.h"
+#include "script/script_runtime.h"
+
+using namespace AGS::Common;
+
+// Size of the elements of the arrays supported by the script API
+static const uint32_t ArrayElemSize = sizeof(int32_t);
+
+static void ValidateArray(const char *apiname, const void *arr)
+{
+    if (!arr)
+        quit(String::FromFormat("!%s: null array", apiname).GetCStr());
+    const uint32_t elem_size = DynamicArrayHelpers::GetElemSize(arr);
+    if ((elem_size != 0) && (elem_size != ArrayElemSize))
+        quit(String::FromFormat("!%s: unsupported array element type", apiname).GetCStr());
+}
+
+static void ValidateArrayRange(const char *apiname, const void *arr, int index, int count)
+{
+    const uint32_t length = DynamicArrayHelpers::GetElemCount(arr);
+    if ((index < 0) || (count < 0) || ((uint32_t)index > length) || ((uint32_t)count > length - index))
+        quit(String::FromFormat("!%s: range %d..%d is outside of the array of length %u",
+            apiname, index, index + count, length).GetCStr());
+}
+
+void Array_Copy(void *src, int src_index, void *dst, int dst_index, int count)
+{
+    ValidateArray("Array.Copy", src);
+    ValidateArray("Array.Copy", dst);
+    ValidateArrayRange("Array.Copy", src, src_index, count);
+    ValidateArrayRange("Array.Copy", dst, dst_index, count);
+    DynamicArrayHelpers::Copy(src, src_index, dst, dst_index, count);
+}
+
+// Fills the array with a raw value, which may be a managed handle;
+// negative count means up to the end of the array
+void Array_Fill(void *arr, int32_t value, int index, int count)
+{
+    ValidateArray("Array.Fill", arr);
+    if (count < 0)
+        count = DynamicArrayHelpers::GetElemCount(arr) - std::max(0, index);
+    ValidateArrayRange("Array.Fill", arr, index, count);
+    DynamicArrayHelpers::Fill(arr, index, count, value);
+}
+
+void Array_FillInts(void *arr, int value, int index, int count)
+{
+    Array_Fill(arr, value, index, count);
+}
+
+void Array_FillFloats(void *arr, float value, int index, int count)
+{
+    int32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    Array_Fill(arr, bits, index, count);
+}
+
+void Array_FillStrings(void *arr, const char *value, int index, int count)
+{
+    Array_Fill(arr, value ? ccGetObjectHandleFromAddress(const_cast<char*>(value)) : 0, index, count);
+}
+
+void *Array_Resize(void *arr, int new_length)
+{
+    ValidateArray("Array.Resize", arr);
+    if (new_length < 0)
+        quit("!Array.Resize: invalid length");
+    return DynamicArrayHelpers::Resize(arr, new_length, ArrayElemSize).Obj;
+}
+
+void *Array_Clone(void *arr)
+{
+    ValidateArray("Array.Clone", arr);
+    return DynamicArrayHelpers::Clone(arr, ArrayElemSize).Obj;
+}
+
+//=============================================================================
+//
+// Script API Functions
+//
+//=============================================================================
+
+// void (void *src, int src_index, void *dst, int dst_index, int count)
+RuntimeScriptValue Sc_Array_Copy(const RuntimeScriptValue *params, int32_t param_count)
+{
+    ASSERT_PARAM_COUNT(Array_Copy, 5);
+    Array_Copy(params[0].Ptr, params[1].IValue, params[2].Ptr, params[3].IValue, params[4].IValue);
+    return RuntimeScriptValue((int32_t)0);
+}
+
+// void (void *arr, int value, int index, int count)
+RuntimeScriptValue Sc_Array_FillInts(const RuntimeScriptValue *params, int32_t param_count)
+{
+    ASSERT_PARAM_COUNT(Array_FillInts, 4);
+    Array_FillInts(params[0].Ptr, params[1].IValue, params[2].IValue, params[3].IValue);
+    return RuntimeScriptValue((int32_t)0);
+}
+
+// void (void *arr, float value, int index, int count)
+RuntimeScriptValue Sc_Array_FillFloats(const RuntimeScriptValue *params, int32_t param_count)
+{
+    ASSERT_PARAM_COUNT(Array_FillFloats, 4);
+    Array_FillFloats(params[0].Ptr, params[1].FValue, params[2].IValue, params[3].IValue);
+    return RuntimeScriptValue((int32_t)0);
+}
+
+// void (void *arr, const char *value, int index, int count)
+RuntimeScriptValue Sc_Array_FillStrings(const RuntimeScriptValue *params, int32_t param_count)
+{
+    ASSERT_PARAM_COUNT(Array_FillStrings, 4);
+    Array_FillStrings(params[0].Ptr, static_cast<const char*>(params[1].Ptr), params[2].IValue, params[3].IValue);
+    return RuntimeScriptValue((int32_t)0);
+}
+
+// void* (void *arr, int new_length)
+RuntimeScriptValue Sc_Array_Resize(const RuntimeScriptValue *params, int32_t param_count)
+{
+    ASSERT_PARAM_COUNT(Array_Resize, 2);
+    return RuntimeScriptValue().SetScriptObject(Array_Resize(params[0].Ptr, params[1].IValue), &globalDynamicArray);
+}
+
+// void* (void *arr)
+RuntimeScriptValue Sc_Array_Clone(const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_SCALL_OBJ_POBJ(void, globalDynamicArray, Array_Clone, void);
+}
+
+
+void RegisterDynamicArrayAPI()
+{
+    ScFnRegister array_api[] = {
+        { "Array::CopyInts^5",      API_FN_PAIR(Array_Copy) },
+        { "Array::CopyFloats^5",    API_FN_PAIR(Array_Copy) },
+        { "Array::CopyStrings^5",   API_FN_PAIR(Array_Copy) },
+        { "Array::FillInts^4",      API_FN_PAIR(Array_FillInts) },
+        { "Array::FillFloats^4",    API_FN_PAIR(Array_FillFloats) },
+        { "Array::FillStrings^4",   API_FN_PAIR(Array_FillStrings) },
+        { "Array::ResizeInts^2",    API_FN_PAIR(Array_Resize) },
+        { "Array::ResizeFloats^2",  API_FN_PAIR(Array_Resize) },
+        { "Array::ResizeStrings^2", API_FN_PAIR(Array_Resize) },
+        { "Array::CloneInts^1",     API_FN_PAIR(Array_Clone) },
+        { "Array::CloneFloats^1",   API_FN_PAIR(Array_Clone) },
+        { "Array::CloneStrings^1",  API_FN_PAIR(Array_Clone) },
+    };
+
+    ccAddExternalFunctions(array_api);
+}
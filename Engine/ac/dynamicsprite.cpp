@@ -22,6 +22,7 @@
 #include "ac/global_game.h"
 #include "ac/math.h"    // M_PI
 #include "ac/path_helper.h"
+#include "ac/room.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
 #include "ac/system.h"
@@ -437,6 +438,7 @@ ScriptDynamicSprite* DynamicSprite_CreateFromBackground(int frame, int x1, int y
     data_to_game_coords(&x1, &y1);
     data_to_game_coords(&width, &height);
     // create a new sprite as a copy of the existing one
+    ensure_room_bg_frame(frame);
     std::unique_ptr<Bitmap> new_pic(BitmapHelper::CreateBitmap(width, height, thisroom.BgFrames[frame].Graphic->GetColorDepth()));
     if (!new_pic)
         return nullptr;
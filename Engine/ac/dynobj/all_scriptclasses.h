@@ -31,6 +31,7 @@
 #include "ac/dynobj/scriptoverlay.h"
 #include "ac/dynobj/scriptregion.h"
 #include "ac/dynobj/scriptstring.h"
+#include "ac/dynobj/scriptstringbuilder.h"
 #include "ac/dynobj/scriptsystem.h"
 #include "ac/dynobj/scriptviewframe.h"
 
@@ -83,6 +83,11 @@ void CCBasicObject::WriteFloat(void *address, intptr_t offset, float val)
     *(float*)(static_cast<uint8_t*>(address) + offset) = val;
 }
 
+bool CCBasicObject::SerializeToStream(void* /*address*/, Stream* /*out*/)
+{
+    return false;
+}
+
 
 int AGSCCDynamicObject::Serialize(void *address, uint8_t *buffer, int bufsize) {
     // If the required space is larger than the provided buffer,
@@ -97,5 +102,20 @@ int AGSCCDynamicObject::Serialize(void *address, uint8_t *buffer, int bufsize) {
     return static_cast<int32_t>(mems.GetPosition());
 }
 
+bool AGSCCDynamicObject::SerializeToStream(void *address, Stream *out) {
+    const size_t req_size = CalcSerializeSize(address);
+    assert(req_size <= INT32_MAX); // dynamic object API does not support size > int32
+    out->WriteInt32(static_cast<int32_t>(req_size));
+    const soff_t data_pos = out->GetPosition();
+    Serialize(address, out);
+    // The calculated size is allowed to be larger than the actual data,
+    // in which case pad the data, since the size has already been written
+    const size_t data_sz = static_cast<size_t>(out->GetPosition() - data_pos);
+    assert(data_sz <= req_size);
+    for (size_t i = data_sz; i < req_size; ++i)
+        out->WriteInt8(0);
+    return true;
+}
+
 
 AGSCCStaticObject GlobalStaticManager;
@@ -67,6 +67,9 @@ public:
     void WriteInt16(void *address, intptr_t offset, int16_t val) override;
     void WriteInt32(void *address, intptr_t offset, int32_t val) override;
     void WriteFloat(void *address, intptr_t offset, float val) override;
+
+    // Streaming serialization is not supported by default
+    bool SerializeToStream(void* /*address*/, AGS::Common::Stream* /*out*/) override;
 };
 
 
@@ -82,6 +85,8 @@ public:
 
     // TODO: pass savegame format version
     int Serialize(void *address, uint8_t *buffer, int bufsize) override;
+    // Serialize the object directly into the stream
+    bool SerializeToStream(void *address, AGS::Common::Stream *out) override;
     // Try unserializing the object from the given input stream
     virtual void Unserialize(int index, AGS::Common::Stream *in, size_t data_sz) = 0;
 
@@ -12,6 +12,8 @@
 //
 //=============================================================================
 #include "cc_dynamicarray.h"
+#include <algorithm>
+#include <assert.h>
 #include <string.h>
 #include "ac/dynobj/dynobj_manager.h"
 #include "ac/dynobj/scriptstring.h"
@@ -48,7 +50,7 @@ int CCDynamicArray::Dispose(void *address, bool force)
         }
     }
 
-    delete[] (static_cast<uint8_t*>(address) - MemHeaderSz);
+    ccFreeObjectMemory(static_cast<uint8_t*>(address) - MemHeaderSz, GetHeader(address).TotalSize + MemHeaderSz);
     return 1;
 }
 
@@ -68,17 +70,26 @@ void CCDynamicArray::Serialize(const void *address, Stream *out)
 
 void CCDynamicArray::Unserialize(int index, Stream *in, size_t data_sz)
 {
-    uint8_t *new_arr = new uint8_t[(data_sz - FileHeaderSz) + MemHeaderSz];
+    // NOTE: the allocated size must match the header's TotalSize, as it's used
+    // to free the memory; normally TotalSize equals to the size of saved data
+    const uint32_t elem_count = in->ReadInt32();
+    const uint32_t total_size = in->ReadInt32();
+    const size_t read_size = std::min<size_t>(total_size, data_sz - FileHeaderSz);
+    uint8_t *new_arr = static_cast<uint8_t*>(ccAllocObjectMemory(total_size + MemHeaderSz));
     Header &hdr = reinterpret_cast<Header&>(*new_arr);
-    hdr.ElemCount = in->ReadInt32();
-    hdr.TotalSize = in->ReadInt32();
-    in->Read(new_arr + MemHeaderSz, data_sz - FileHeaderSz);
-    ccRegisterUnserializedObject(index, &new_arr[MemHeaderSz], this);
+    hdr.ElemCount = elem_count;
+    hdr.TotalSize = total_size;
+    in->Read(new_arr + MemHeaderSz, read_size);
+    if (read_size < total_size)
+        memset(new_arr + MemHeaderSz + read_size, 0, total_size - read_size);
+    else if (read_size < data_sz - FileHeaderSz)
+        in->Seek(data_sz - FileHeaderSz - read_size);
+    hdr.Handle = ccRegisterUnserializedObject(index, &new_arr[MemHeaderSz], this);
 }
 
 /* static */ DynObjectRef CCDynamicArray::Create(int numElements, int elementSize, bool isManagedType)
 {
-    uint8_t *new_arr = new uint8_t[numElements * elementSize + MemHeaderSz];
+    uint8_t *new_arr = static_cast<uint8_t*>(ccAllocObjectMemory(numElements * elementSize + MemHeaderSz));
     memset(new_arr, 0, numElements * elementSize + MemHeaderSz);
     Header &hdr = reinterpret_cast<Header&>(*new_arr);
     hdr.ElemCount = numElements | (ARRAY_MANAGED_TYPE_FLAG * isManagedType);
@@ -87,9 +98,10 @@ void CCDynamicArray::Unserialize(int index, Stream *in, size_t data_sz)
     int32_t handle = ccRegisterManagedObject(obj_ptr, &globalDynamicArray);
     if (handle == 0)
     {
-        delete[] new_arr;
+        ccFreeObjectMemory(new_arr, numElements * elementSize + MemHeaderSz);
         return DynObjectRef();
     }
+    hdr.Handle = handle;
     return DynObjectRef(handle, obj_ptr, &globalDynamicArray);
 }
 
@@ -115,3 +127,138 @@ DynObjectRef DynamicArrayHelpers::CreateStringArray(const std::vector<const char
     }
     return arr;
 }
+
+void DynamicArrayHelpers::ReadStringArray(const void *arr, std::vector<AGS::Common::String> &items)
+{
+    const auto &hdr = CCDynamicArray::GetHeader(arr);
+    assert(hdr.ElemCount & ARRAY_MANAGED_TYPE_FLAG);
+    const uint32_t count = hdr.ElemCount & ~ARRAY_MANAGED_TYPE_FLAG;
+    const int32_t *slots = static_cast<const int32_t*>(arr);
+    items.reserve(items.size() + count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const char *s = static_cast<const char*>(ccGetObjectAddressFromHandle(slots[i]));
+        items.push_back(s);
+    }
+}
+
+void DynamicArrayHelpers::ReadObjectArray(const void *arr, std::vector<void*> &objs)
+{
+    const auto &hdr = CCDynamicArray::GetHeader(arr);
+    assert(hdr.ElemCount & ARRAY_MANAGED_TYPE_FLAG);
+    const uint32_t count = hdr.ElemCount & ~ARRAY_MANAGED_TYPE_FLAG;
+    const int32_t *slots = static_cast<const int32_t*>(arr);
+    objs.reserve(objs.size() + count);
+    for (uint32_t i = 0; i < count; ++i)
+        objs.push_back(ccGetObjectAddressFromHandle(slots[i]));
+}
+
+uint32_t DynamicArrayHelpers::GetElemCount(const void *arr)
+{
+    return CCDynamicArray::GetHeader(arr).ElemCount & ~ARRAY_MANAGED_TYPE_FLAG;
+}
+
+uint32_t DynamicArrayHelpers::GetElemSize(const void *arr)
+{
+    const auto &hdr = CCDynamicArray::GetHeader(arr);
+    const uint32_t count = hdr.ElemCount & ~ARRAY_MANAGED_TYPE_FLAG;
+    return (count > 0) ? hdr.TotalSize / count : 0u;
+}
+
+bool DynamicArrayHelpers::IsManagedArray(const void *arr)
+{
+    return (CCDynamicArray::GetHeader(arr).ElemCount & ARRAY_MANAGED_TYPE_FLAG) != 0;
+}
+
+// Adds a reference to each of the non-null handles
+static void AddHandleRefs(const int32_t *handles, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (handles[i] > 0)
+            ccAddObjectReference(handles[i]);
+    }
+}
+
+// Releases a reference of each of the non-null handles
+static void ReleaseHandleRefs(const int32_t *handles, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (handles[i] > 0)
+            ccReleaseObjectReference(handles[i]);
+    }
+}
+
+DynObjectRef DynamicArrayHelpers::Resize(const void *arr, uint32_t elem_count, uint32_t elem_size)
+{
+    const bool is_managed = IsManagedArray(arr);
+    DynObjectRef new_arr = globalDynamicArray.Create(elem_count, elem_size, is_managed);
+    if (!new_arr.Obj)
+        return new_arr;
+    const uint32_t copy_count = std::min(elem_count, GetElemCount(arr));
+    memcpy(new_arr.Obj, arr, copy_count * elem_size);
+    if (is_managed)
+        AddHandleRefs(static_cast<const int32_t*>(arr), copy_count);
+    return new_arr;
+}
+
+DynObjectRef DynamicArrayHelpers::Clone(const void *arr, uint32_t elem_size)
+{
+    return Resize(arr, GetElemCount(arr), elem_size);
+}
+
+void DynamicArrayHelpers::Copy(const void *src, uint32_t src_index, void *dst, uint32_t dst_index, uint32_t count)
+{
+    if (count == 0)
+        return;
+    const uint32_t elem_size = GetElemSize(src);
+    const uint8_t *src_ptr = static_cast<const uint8_t*>(src) + src_index * elem_size;
+    uint8_t *dst_ptr = static_cast<uint8_t*>(dst) + dst_index * elem_size;
+    if (IsManagedArray(dst))
+    {
+        // Add refs to the copied objects first, in case some of them are
+        // also among the overwritten ones
+        AddHandleRefs(reinterpret_cast<const int32_t*>(src_ptr), count);
+        ReleaseHandleRefs(reinterpret_cast<const int32_t*>(dst_ptr), count);
+    }
+    memmove(dst_ptr, src_ptr, count * elem_size);
+}
+
+void DynamicArrayHelpers::Fill(void *arr, uint32_t index, uint32_t count, int32_t value)
+{
+    if (count == 0)
+        return;
+    const uint32_t elem_size = GetElemSize(arr);
+    uint8_t *ptr = static_cast<uint8_t*>(arr) + index * elem_size;
+    if (IsManagedArray(arr))
+    {
+        int32_t *handles = reinterpret_cast<int32_t*>(ptr);
+        if (value > 0)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+                ccAddObjectReference(value);
+        }
+        ReleaseHandleRefs(handles, count);
+        std::fill(handles, handles + count, value);
+        return;
+    }
+
+    if ((value == 0) || (elem_size == sizeof(uint8_t)))
+    {
+        memset(ptr, value, count * elem_size);
+        return;
+    }
+    switch (elem_size)
+    {
+    case sizeof(int16_t):
+        std::fill(reinterpret_cast<int16_t*>(ptr), reinterpret_cast<int16_t*>(ptr) + count, static_cast<int16_t>(value));
+        break;
+    case sizeof(int32_t):
+        std::fill(reinterpret_cast<int32_t*>(ptr), reinterpret_cast<int32_t*>(ptr) + count, value);
+        break;
+    default:
+        assert(false); // unsupported element size
+        break;
+    }
+}
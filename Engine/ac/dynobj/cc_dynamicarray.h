@@ -17,6 +17,7 @@
 #include <vector>
 #include "ac/dynobj/cc_agsdynamicobject.h"
 #include "util/stream.h"
+#include "util/string.h"
 
 
 #define ARRAY_MANAGED_TYPE_FLAG    0x80000000
@@ -32,6 +33,9 @@ public:
         uint32_t ElemCount = 0u;
         // TODO: refactor and store "elem size" instead
         uint32_t TotalSize = 0u;
+        // Handle of this object in the managed pool, for the quick
+        // address-to-handle conversion; 0 if not registered
+        int32_t Handle = 0;
     };
 
     CCDynamicArray() = default;
@@ -42,6 +46,11 @@ public:
         return reinterpret_cast<const Header&>(*(static_cast<const uint8_t*>(address) - MemHeaderSz));
     }
 
+    inline static Header &GetHeader(void *address)
+    {
+        return reinterpret_cast<Header&>(*(static_cast<uint8_t*>(address) - MemHeaderSz));
+    }
+
     // Create managed array object and return a pointer to the beginning of a buffer
     static DynObjectRef Create(int numElements, int elementSize, bool isManagedType);
 
@@ -71,6 +80,35 @@ namespace DynamicArrayHelpers
 {
     // Create array of managed strings
     DynObjectRef CreateStringArray(const std::vector<const char*>);
+    // Reads the contents of the array of managed strings;
+    // the null elements are read as empty strings
+    void ReadStringArray(const void *arr, std::vector<AGS::Common::String> &items);
+    // Reads the addresses of the objects in the array of managed handles;
+    // the null elements are read as null pointers
+    void ReadObjectArray(const void *arr, std::vector<void*> &objs);
+
+    // Bulk array operations; these expect that the indexes and counts are
+    // already validated, and that the arrays have the same element type.
+    // The arrays of managed handles have their elements' refs updated.
+    //
+    // Gets the number of elements in the array
+    uint32_t GetElemCount(const void *arr);
+    // Gets the size of the array's element, or 0 if it's not known
+    // (the array is empty)
+    uint32_t GetElemSize(const void *arr);
+    // Tells if this is an array of managed handles
+    bool IsManagedArray(const void *arr);
+    // Creates a new array of the given number of elements, copying as many
+    // of the existing elements as fit; the extra elements are zeroed
+    DynObjectRef Resize(const void *arr, uint32_t elem_count, uint32_t elem_size);
+    // Creates an exact copy of the array
+    DynObjectRef Clone(const void *arr, uint32_t elem_size);
+    // Copies the range of elements to another (or the same) array;
+    // the ranges are allowed to overlap
+    void Copy(const void *src, uint32_t src_index, void *dst, uint32_t dst_index, uint32_t count);
+    // Assigns the value to the range of elements; the value is truncated to
+    // the element's size, for the managed arrays it is a handle
+    void Fill(void *arr, uint32_t index, uint32_t count, int32_t value);
 };
 
 #endif
\ No newline at end of file
@@ -25,6 +25,7 @@
 #include <utility>
 #include "core/types.h"
 
+namespace AGS { namespace Common { class Stream; } }
 
 struct IScriptObject;
 
@@ -93,6 +94,11 @@ struct IScriptObject
     virtual void    WriteInt32(void *address, intptr_t offset, int32_t val)   = 0;
     virtual void    WriteFloat(void *address, intptr_t offset, float val)     = 0;
 
+    // Serializes the object directly into the stream, writing the data size
+    // followed by the data itself. Returns false if the object does not support
+    // streaming, in which case it has to be serialized into a buffer instead.
+    virtual bool    SerializeToStream(void *address, AGS::Common::Stream *out) = 0;
+
 protected:
     IScriptObject() = default;
     ~IScriptObject() = default;
@@ -103,6 +109,8 @@ struct ICCObjectCollectionReader
 {
     // TODO: pass savegame format version
     virtual void Unserialize(int32_t handle, const char *objectType, const char *serializedData, int dataSize) = 0;
+    // Unserializes the object reading exactly data_sz bytes from the stream
+    virtual void Unserialize(int32_t handle, const char *objectType, AGS::Common::Stream *in, size_t data_sz) = 0;
 };
 
 // The interface of a script objects deserializer that handles a single type.
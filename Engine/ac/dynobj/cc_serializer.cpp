@@ -12,6 +12,7 @@
 //
 //=============================================================================
 #include <string.h>
+#include <vector>
 #include "ac/dynobj/cc_serializer.h"
 #include "ac/dynobj/all_dynamicclasses.h"
 #include "ac/dynobj/all_scriptclasses.h"
@@ -53,13 +54,22 @@ void AGSDeSerializer::Unserialize(int index, const char *objectType, const char
         quitprintf("Unserialise: invalid data size (%d) for object type '%s'", dataSize, objectType);
         return; // TODO: don't quit, return error
     }
-    // Note that while our builtin classes may accept Stream object,
-    // classes registered by plugin cannot, because streams are not (yet)
-    // part of the plugin API.
     size_t data_sz = static_cast<size_t>(dataSize);
     assert(data_sz <= INT32_MAX); // dynamic object API does not support size > int32
     Stream mems(std::make_unique<MemoryStream>(reinterpret_cast<const uint8_t*>(serializedData), dataSize));
+    Unserialize(index, objectType, &mems, data_sz);
+}
+
+void AGSDeSerializer::Unserialize(int index, const char *objectType, Stream *in, size_t data_sz) {
 
+    if (data_sz > INT32_MAX)
+    {
+        quitprintf("Unserialise: invalid data size (%zu) for object type '%s'", data_sz, objectType);
+        return; // TODO: don't quit, return error
+    }
+    // Note that while our builtin classes may accept Stream object,
+    // classes registered by plugin cannot, because streams are not (yet)
+    // part of the plugin API.
     // TODO: consider this: there are object types that are part of the
     // script's foundation, because they are created by the bytecode ops:
     // such as DynamicArray and UserObject. *Maybe* these should be moved
@@ -68,38 +78,38 @@ void AGSDeSerializer::Unserialize(int index, const char *objectType, const char
     // TODO: should we support older save versions here (DynArray, UserObj)?
     // might have to use older class names to distinguish save formats
     if (strcmp(objectType, CCDynamicArray::TypeName) == 0) {
-        globalDynamicArray.Unserialize(index, &mems, data_sz);
+        globalDynamicArray.Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, ScriptUserObject::TypeName) == 0) {
         ScriptUserObject *suo = new ScriptUserObject();
-        suo->Unserialize(index, &mems, data_sz);
+        suo->Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "GUIObject") == 0) {
-        ccDynamicGUIObject.Unserialize(index, &mems, data_sz);
+        ccDynamicGUIObject.Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "Character") == 0) {
-        ccDynamicCharacter.Unserialize(index, &mems, data_sz);
+        ccDynamicCharacter.Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "Hotspot") == 0) {
-        ccDynamicHotspot.Unserialize(index, &mems, data_sz);
+        ccDynamicHotspot.Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "Region") == 0) {
-        ccDynamicRegion.Unserialize(index, &mems, data_sz);
+        ccDynamicRegion.Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "Inventory") == 0) {
-        ccDynamicInv.Unserialize(index, &mems, data_sz);
+        ccDynamicInv.Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "Dialog") == 0) {
-        ccDynamicDialog.Unserialize(index, &mems, data_sz);
+        ccDynamicDialog.Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "GUI") == 0) {
-        ccDynamicGUI.Unserialize(index, &mems, data_sz);
+        ccDynamicGUI.Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "Object") == 0) {
-        ccDynamicObject.Unserialize(index, &mems, data_sz);
+        ccDynamicObject.Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "String") == 0) {
-        myScriptStringImpl.Unserialize(index, &mems, data_sz);
+        myScriptStringImpl.Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "File") == 0) {
         // files cannot be restored properly -- so just recreate
@@ -109,23 +119,27 @@ void AGSDeSerializer::Unserialize(int index, const char *objectType, const char
     }
     else if (strcmp(objectType, "Overlay") == 0) {
         ScriptOverlay *scf = new ScriptOverlay();
-        scf->Unserialize(index, &mems, data_sz);
+        scf->Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "DateTime") == 0) {
         ScriptDateTime *scf = new ScriptDateTime();
-        scf->Unserialize(index, &mems, data_sz);
+        scf->Unserialize(index, in, data_sz);
+    }
+    else if (strcmp(objectType, "StringBuilder") == 0) {
+        ScriptStringBuilder *scf = new ScriptStringBuilder();
+        scf->Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "ViewFrame") == 0) {
         ScriptViewFrame *scf = new ScriptViewFrame();
-        scf->Unserialize(index, &mems, data_sz);
+        scf->Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "DynamicSprite") == 0) {
         ScriptDynamicSprite *scf = new ScriptDynamicSprite();
-        scf->Unserialize(index, &mems, data_sz);
+        scf->Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "DrawingSurface") == 0) {
         ScriptDrawingSurface *sds = new ScriptDrawingSurface();
-        sds->Unserialize(index, &mems, data_sz);
+        sds->Unserialize(index, in, data_sz);
 
         if (sds->isLinkedBitmapOnly)
         {
@@ -134,38 +148,41 @@ void AGSDeSerializer::Unserialize(int index, const char *objectType, const char
     }
     else if (strcmp(objectType, "DialogOptionsRendering") == 0)
     {
-        ccDialogOptionsRendering.Unserialize(index, &mems, data_sz);
+        ccDialogOptionsRendering.Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "StringDictionary") == 0)
     {
-        Dict_Unserialize(index, &mems, data_sz);
+        Dict_Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "StringSet") == 0)
     {
-        Set_Unserialize(index, &mems, data_sz);
+        Set_Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "Viewport2") == 0)
     {
-        Viewport_Unserialize(index, &mems, data_sz);
+        Viewport_Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "Camera2") == 0)
     {
-        Camera_Unserialize(index, &mems, data_sz);
+        Camera_Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "AudioChannel") == 0)
     {
-        ccDynamicAudio.Unserialize(index, &mems, data_sz);
+        ccDynamicAudio.Unserialize(index, in, data_sz);
     }
     else if (strcmp(objectType, "AudioClip") == 0)
     {
-        ccDynamicAudioClip.Unserialize(index, &mems, data_sz);
+        ccDynamicAudioClip.Unserialize(index, in, data_sz);
     }
     else
     {
         // check if the type is read by a plugin
         for (const auto &pr : pluginReaders) {
             if (pr.Type == objectType) {
-                pr.Reader->Unserialize(index, serializedData, dataSize);
+                std::vector<char> data(data_sz);
+                if (data_sz > 0)
+                    in->Read(data.data(), data_sz);
+                pr.Reader->Unserialize(index, data.data(), static_cast<int>(data_sz));
                 return;
             }
         }
@@ -20,6 +20,7 @@
 struct AGSDeSerializer : ICCObjectCollectionReader {
 
     void Unserialize(int index, const char *objectType, const char *serializedData, int dataSize) override;
+    void Unserialize(int index, const char *objectType, AGS::Common::Stream *in, size_t data_sz) override;
 };
 
 extern AGSDeSerializer ccUnserializer;
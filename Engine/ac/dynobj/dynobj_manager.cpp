@@ -12,9 +12,15 @@
 //
 //=============================================================================
 #include "ac/dynobj/dynobj_manager.h"
+#include <algorithm>
+#include <memory>
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
+#include "ac/dynobj/cc_dynamicarray.h"
 #include "ac/dynobj/managedobjectpool.h"
+#include "ac/dynobj/scriptstring.h"
+#include "ac/dynobj/scriptuserobject.h"
 #include "debug/out.h"
 #include "script/cc_common.h"
 #include "util/stream.h"
@@ -79,6 +85,23 @@ int32_t ccGetObjectHandleFromAddress(void *address) {
     return handl;
 }
 
+int32_t ccGetObjectHandleFromAddress(void *address, IScriptObject *manager) {
+    if (address == nullptr)
+        return 0;
+
+    // engine-allocated managed objects keep their handles in the header
+    int32_t handl = 0;
+    if (manager == &globalDynamicArray)
+        handl = CCDynamicArray::GetHeader(address).Handle;
+    else if (manager == &globalDynamicStruct)
+        handl = ScriptUserObject::GetHeader(address).Handle;
+    else if (manager == &myScriptStringImpl)
+        handl = ScriptString::GetHeader(address).Handle;
+    if (handl > 0)
+        return handl;
+    return ccGetObjectHandleFromAddress(address);
+}
+
 void *ccGetObjectAddressFromHandle(int32_t handle) {
     if (handle == 0) {
         return nullptr;
@@ -126,3 +149,108 @@ int ccReleaseObjectReference(int32_t handle) {
 
     return pool.SubRef(handle);
 }
+
+
+// Size-classed memory pools for the managed objects' data.
+// Each size class keeps a list of freed blocks, and allocates new blocks
+// sequentially from its current slab. Slabs are never released, but their
+// blocks are reused by the objects of the same size class.
+const size_t MEMPOOL_GRANULARITY = 16; // also a block's alignment
+const size_t MEMPOOL_MAX_BLOCK = 512;
+const size_t MEMPOOL_SLAB_SIZE = 64 * 1024;
+const size_t MEMPOOL_NUM_CLASSES = MEMPOOL_MAX_BLOCK / MEMPOOL_GRANULARITY;
+
+struct MemPoolFreeBlock
+{
+    MemPoolFreeBlock *Next;
+};
+
+struct MemPoolSizeClass
+{
+    MemPoolFreeBlock *FreeList = nullptr;
+    uint8_t *SlabPos = nullptr; // next unused block in the current slab
+    uint8_t *SlabEnd = nullptr;
+};
+
+static MemPoolSizeClass MemPoolClasses[MEMPOOL_NUM_CLASSES];
+static std::vector<std::unique_ptr<uint8_t[]>> MemPoolSlabs;
+static ManagedMemoryStats MemStats;
+
+void *ccAllocObjectMemory(size_t size) {
+    if (size == 0)
+        size = 1;
+    if (size > MEMPOOL_MAX_BLOCK) {
+        MemStats.LargeBlocks++;
+        MemStats.LargeBytes += size;
+        return new uint8_t[size];
+    }
+
+    const size_t class_idx = (size - 1) / MEMPOOL_GRANULARITY;
+    const size_t block_size = (class_idx + 1) * MEMPOOL_GRANULARITY;
+    MemPoolSizeClass &sc = MemPoolClasses[class_idx];
+    MemStats.PooledBlocks++;
+    MemStats.PooledBytes += block_size;
+    if (sc.FreeList) {
+        MemPoolFreeBlock *block = sc.FreeList;
+        sc.FreeList = block->Next;
+        return block;
+    }
+
+    if (static_cast<size_t>(sc.SlabEnd - sc.SlabPos) < block_size) {
+        const size_t slab_size = (MEMPOOL_SLAB_SIZE / block_size) * block_size;
+        MemPoolSlabs.emplace_back(new uint8_t[slab_size]);
+        sc.SlabPos = MemPoolSlabs.back().get();
+        sc.SlabEnd = sc.SlabPos + slab_size;
+        MemStats.SlabBytes += slab_size;
+    }
+    void *block = sc.SlabPos;
+    sc.SlabPos += block_size;
+    return block;
+}
+
+void ccFreeObjectMemory(void *mem, size_t size) {
+    if (mem == nullptr)
+        return;
+    if (size == 0)
+        size = 1;
+    if (size > MEMPOOL_MAX_BLOCK) {
+        MemStats.LargeBlocks--;
+        MemStats.LargeBytes -= size;
+        delete[] static_cast<uint8_t*>(mem);
+        return;
+    }
+
+    const size_t class_idx = (size - 1) / MEMPOOL_GRANULARITY;
+    MemPoolSizeClass &sc = MemPoolClasses[class_idx];
+    MemPoolFreeBlock *block = static_cast<MemPoolFreeBlock*>(mem);
+    block->Next = sc.FreeList;
+    sc.FreeList = block;
+    MemStats.PooledBlocks--;
+    MemStats.PooledBytes -= (class_idx + 1) * MEMPOOL_GRANULARITY;
+}
+
+const ManagedMemoryStats &ccGetManagedMemoryStats() {
+    return MemStats;
+}
+
+String ccGetManagedObjectsReport() {
+    using namespace std::chrono;
+    std::vector<ManagedObjectPool::TypeMemoryUsage> usage;
+    pool.GetTypeMemoryUsage(usage);
+    std::sort(usage.begin(), usage.end(),
+        [](const ManagedObjectPool::TypeMemoryUsage &a, const ManagedObjectPool::TypeMemoryUsage &b)
+        { return a.count > b.count; });
+
+    String report = String::FromFormat("Managed objects: total created: %u\n", pool.GetTotalCreated());
+    for (const auto &u : usage)
+        report.AppendFmt("  %s: %u objects, %zu bytes\n", u.type, u.count, u.dataSize);
+    const ManagedMemoryStats &mem = MemStats;
+    report.AppendFmt("Memory: pooled %zu blocks, %zu bytes (%zu bytes reserved); large %zu blocks, %zu bytes\n",
+        mem.PooledBlocks, mem.PooledBytes, mem.SlabBytes, mem.LargeBlocks, mem.LargeBytes);
+    const auto &gc = pool.GetGCStats();
+    report.AppendFmt("Garbage collection: cycles: %u, steps: %u, disposed: %u, total time: %lld us, max pause: %lld us",
+        gc.cycles, gc.slices, gc.removed,
+        static_cast<long long>(duration_cast<microseconds>(gc.totalTime).count()),
+        static_cast<long long>(duration_cast<microseconds>(gc.maxPause).count()));
+    return report;
+}
@@ -21,6 +21,7 @@
 #define __AGS_EE_DYNOBJ__DYNOBJMANAGER_H
 
 #include "core/types.h"
+#include "util/string.h"
 #include "script/runtimescriptvalue.h"
 #include "ac/dynobj/cc_scriptobject.h"
 
@@ -45,10 +46,35 @@ extern int   ccUnserializeAllObjects(Common::Stream *in, ICCObjectCollectionRead
 extern void  ccAttemptDisposeObject(int32_t handle);
 // translate between object handles and memory addresses
 extern int32_t ccGetObjectHandleFromAddress(void *address);
+// same as above, but takes advantage of knowing the object's manager,
+// which lets to read the handle directly from engine-allocated objects
+extern int32_t ccGetObjectHandleFromAddress(void *address, IScriptObject *manager);
 extern void *ccGetObjectAddressFromHandle(int32_t handle);
 extern ScriptValueType ccGetObjectAddressAndManagerFromHandle(int32_t handle, void *&object, IScriptObject *&manager);
 
 extern int ccAddObjectReference(int32_t handle);
 extern int ccReleaseObjectReference(int32_t handle);
 
+// Memory usage of the managed objects' data
+struct ManagedMemoryStats
+{
+    size_t SlabBytes = 0u;      // memory reserved for the pooled blocks
+    size_t PooledBlocks = 0u;   // number of used pooled blocks
+    size_t PooledBytes = 0u;    // memory in used pooled blocks
+    size_t LargeBlocks = 0u;    // number of blocks too large for the pools
+    size_t LargeBytes = 0u;     // memory in large blocks
+};
+
+// Allocates memory for the managed object's data; small blocks are taken
+// from the size-classed pools, larger ones are allocated from the system.
+// The memory is not initialized.
+extern void *ccAllocObjectMemory(size_t size);
+// Frees memory allocated by ccAllocObjectMemory; must be passed the same size
+extern void  ccFreeObjectMemory(void *mem, size_t size);
+// Returns current managed objects' memory usage
+extern const ManagedMemoryStats &ccGetManagedMemoryStats();
+// Returns a text report on the managed objects, their numbers and memory
+// usage per type, and the garbage collection statistics
+extern Common::String ccGetManagedObjectsReport();
+
 #endif // __AGS_EE_DYNOBJ__DYNOBJMANAGER_H
@@ -11,9 +11,13 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
 #include <vector>
 #include <string.h>
 #include "ac/dynobj/managedobjectpool.h"
+#include "ac/dynobj/cc_dynamicarray.h"
+#include "ac/dynobj/scriptstring.h"
+#include "ac/dynobj/scriptuserobject.h"
 #include "debug/out.h"
 #include "util/string_utils.h"               // fputstring, etc
 #include "script/cc_common.h"
@@ -24,6 +28,8 @@ using namespace AGS::Common;
 const auto OBJECT_CACHE_MAGIC_NUMBER = 0xa30b;
 const auto SERIALIZE_BUFFER_SIZE = 10240;
 const auto GARBAGE_COLLECTION_INTERVAL = 1024;
+// Max number of handles checked by a single incremental garbage collection step
+const auto GARBAGE_COLLECTION_STEP = 4096;
 const auto RESERVED_SIZE = 2048;
 
 int ManagedObjectPool::Remove(ManagedObject &o, bool force) {
@@ -33,6 +39,7 @@ int ManagedObjectPool::Remove(ManagedObject &o, bool force) {
 
     available_ids.push(o.handle);
     handleByAddress.erase(o.addr);
+    typeStats[o.callback].count--;
     ManagedObjectLog("Line %d Disposed managed object handle=%d", currentline, o.handle);
     o = ManagedObject();
     return 1;
@@ -114,9 +121,30 @@ int ManagedObjectPool::RemoveObject(void *address) {
 
 void ManagedObjectPool::RunGarbageCollectionIfAppropriate()
 {
-    if (objectCreationCounter <= GARBAGE_COLLECTION_INTERVAL) { return; }
-    RunGarbageCollection();
-    objectCreationCounter = 0;
+    if (gcNextHandle == 0)
+    {
+        if (objectCreationCounter <= GARBAGE_COLLECTION_INTERVAL) { return; }
+        // begin new collection cycle
+        gcNextHandle = 1;
+        objectCreationCounter = 0;
+    }
+
+    const auto start = AGS_Clock::now();
+    const uint32_t removed = RunGarbageCollectionStep(GARBAGE_COLLECTION_STEP);
+    const auto pause = AGS_Clock::now() - start;
+    gcStats.slices++;
+    gcStats.removed += removed;
+    gcStats.totalTime += pause;
+    gcStats.maxPause = std::max(gcStats.maxPause, pause);
+    if (gcNextHandle == 0)
+    {
+        gcStats.cycles++;
+        DEBUG_PRINTF(kDbgGroup_ManObj, kDbgMsg_Debug,
+            "Garbage collection: cycles: %u, steps: %u, disposed: %u, total time: %lld us, max pause: %lld us",
+            gcStats.cycles, gcStats.slices, gcStats.removed,
+            static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(gcStats.totalTime).count()),
+            static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(gcStats.maxPause).count()));
+    }
 }
 
 void ManagedObjectPool::RunGarbageCollection()
@@ -128,9 +156,73 @@ void ManagedObjectPool::RunGarbageCollection()
             Remove(o);
         }
     }
+    // this also completes any incremental collection in progress
+    gcNextHandle = 0;
     ManagedObjectLog("Ran garbage collection");
 }
 
+uint32_t ManagedObjectPool::RunGarbageCollectionStep(int32_t max_handles)
+{
+    uint32_t removed = 0u;
+    const int32_t end_handle = std::min(nextHandle, gcNextHandle + max_handles);
+    for (int i = gcNextHandle; i < end_handle; i++) {
+        auto & o = objects[i];
+        if (!o.isUsed()) { continue; }
+        if (o.refCount < 1) {
+            removed += Remove(o);
+        }
+    }
+    gcNextHandle = (end_handle < nextHandle) ? end_handle : 0;
+    ManagedObjectLog("Ran garbage collection step, disposed %u objects", removed);
+    return removed;
+}
+
+size_t ManagedObjectPool::GetObjectDataSize(int32_t handle) const
+{
+    if (handle < 1 || (size_t)handle >= objects.size() || !objects[handle].isUsed())
+        return 0u;
+    const auto &o = objects[handle];
+    if (o.callback == &globalDynamicArray)
+        return CCDynamicArray::GetHeader(o.addr).TotalSize;
+    if (o.callback == &globalDynamicStruct)
+        return ScriptUserObject::GetHeader(o.addr).Size;
+    if (o.callback == &myScriptStringImpl)
+        return ScriptString::GetHeader(o.addr).Length + 1;
+    return 0u;
+}
+
+size_t ManagedObjectPool::GetTotalDataSize() const
+{
+    size_t total = 0u;
+    for (int i = 1; i < nextHandle; i++) {
+        if (objects[i].isUsed())
+            total += GetObjectDataSize(i);
+    }
+    return total;
+}
+
+void ManagedObjectPool::GetTypeMemoryUsage(std::vector<TypeMemoryUsage> &usage) const
+{
+    // Accumulate per manager first, then merge managers of the same type
+    std::unordered_map<IScriptObject*, size_t> mgr_size;
+    for (int i = 1; i < nextHandle; i++) {
+        if (!objects[i].isUsed()) { continue; }
+        mgr_size[objects[i].callback] += GetObjectDataSize(i);
+    }
+    for (const auto &stats : typeStats) {
+        if (stats.second.count == 0) { continue; }
+        const char *type_name = stats.first->GetType();
+        auto it = std::find_if(usage.begin(), usage.end(),
+            [type_name](const TypeMemoryUsage &u) { return strcmp(u.type, type_name) == 0; });
+        if (it == usage.end()) {
+            it = usage.insert(usage.end(), TypeMemoryUsage());
+            it->type = type_name;
+        }
+        it->count += stats.second.count;
+        it->dataSize += mgr_size[stats.first];
+    }
+}
+
 int ManagedObjectPool::Add(int handle, void *address, IScriptObject *callback, ScriptValueType obj_type)
 {
     auto &o = objects[handle];
@@ -139,6 +231,10 @@ int ManagedObjectPool::Add(int handle, void *address, IScriptObject *callback, S
     o = ManagedObject(obj_type, handle, address, callback);
 
     handleByAddress.insert({address, handle});
+    TypeStats &stats = typeStats[callback];
+    stats.count++;
+    stats.created++;
+    totalCreated++;
     ManagedObjectLog("Allocated managed object type=%s, handle=%d, addr=%08X", callback->GetType(), handle, address);
     return handle;
 }
@@ -177,8 +273,7 @@ void ManagedObjectPool::WriteToDisk(Stream *out) {
     // use this opportunity to clean up any non-referenced pointers
     RunGarbageCollection();
 
-    std::vector<uint8_t> serializeBuffer;
-    serializeBuffer.resize(SERIALIZE_BUFFER_SIZE);
+    std::vector<uint8_t> serializeBuffer; // allocated only if needed
 
     out->WriteInt32(OBJECT_CACHE_MAGIC_NUMBER);
     out->WriteInt32(2);  // version
@@ -200,7 +295,16 @@ void ManagedObjectPool::WriteToDisk(Stream *out) {
         out->WriteInt32(o.handle);
         // write the type of the object
         StrUtil::WriteCStr(o.callback->GetType(), out);
-        // now write the object data
+        // now write the object data; builtin objects are written directly
+        // into the stream, while plugin objects may only use a buffer
+        if ((o.obj_type != kScValPluginObject) && o.callback->SerializeToStream(o.addr, out)) {
+            out->WriteInt32(o.refCount);
+            ManagedObjectLog("Wrote handle = %d", o.handle);
+            continue;
+        }
+        if (serializeBuffer.empty()) {
+            serializeBuffer.resize(SERIALIZE_BUFFER_SIZE);
+        }
         int bytesWritten = o.callback->Serialize(o.addr, &serializeBuffer.front(), serializeBuffer.size());
         if ((bytesWritten < 0) && ((size_t)(-bytesWritten) > serializeBuffer.size()))
         {
@@ -224,8 +328,6 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectCollectionReader *reade
     }
 
     char typeNameBuffer[200];
-    std::vector<char> serializeBuffer;
-    serializeBuffer.resize(SERIALIZE_BUFFER_SIZE);
 
     auto version = in->ReadInt32();
 
@@ -238,12 +340,12 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectCollectionReader *reade
                     StrUtil::ReadCStr(typeNameBuffer, in, sizeof(typeNameBuffer));
                     if (typeNameBuffer[0] != 0) {
                         size_t numBytes = in->ReadInt32();
-                        if (numBytes > serializeBuffer.size()) {
-                            serializeBuffer.resize(numBytes);
-                        }
-                        in->Read(&serializeBuffer.front(), numBytes);
                         // Delegate work to ICCObjectReader
-                        reader->Unserialize(i, typeNameBuffer, &serializeBuffer.front(), numBytes);
+                        const soff_t end_pos = in->GetPosition() + numBytes;
+                        reader->Unserialize(i, typeNameBuffer, in, numBytes);
+                        if (in->GetPosition() != end_pos) {
+                            in->Seek(end_pos, kSeekBegin);
+                        }
                         objects[i].refCount = in->ReadInt32();
                         ManagedObjectLog("Read handle = %d", objects[i].handle);
                     }
@@ -260,12 +362,13 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectCollectionReader *reade
                     StrUtil::ReadCStr(typeNameBuffer, in, sizeof(typeNameBuffer));
                     assert (typeNameBuffer[0] != 0);
                     size_t numBytes = in->ReadInt32();
-                    if (numBytes > serializeBuffer.size()) {
-                        serializeBuffer.resize(numBytes);
+                    // Delegate work to ICCObjectReader, which reads the data from the stream;
+                    // make sure that we continue right after the object's data
+                    const soff_t end_pos = in->GetPosition() + numBytes;
+                    reader->Unserialize(handle, typeNameBuffer, in, numBytes);
+                    if (in->GetPosition() != end_pos) {
+                        in->Seek(end_pos, kSeekBegin);
                     }
-                    in->Read(&serializeBuffer.front(), numBytes);
-                    // Delegate work to ICCObjectReader
-                    reader->Unserialize(handle, typeNameBuffer, &serializeBuffer.front(), numBytes);
                     objects[handle].refCount = in->ReadInt32();
                     ManagedObjectLog("Read handle = %d", objects[i].handle);
                 }
@@ -279,6 +382,7 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectCollectionReader *reade
     // re-adjust next handles. (in case saved in random order)
     available_ids = std::queue<int32_t>();
     nextHandle = 1;
+    gcNextHandle = 0;
 
     for (const auto &o : objects) {
         if (o.isUsed()) { 
@@ -303,6 +407,7 @@ void ManagedObjectPool::reset() {
     }
     available_ids = std::queue<int32_t>();
     nextHandle = 1;
+    gcNextHandle = 0;
 }
 
 ManagedObjectPool::ManagedObjectPool() : objectCreationCounter(0), nextHandle(1), available_ids(), objects(RESERVED_SIZE, ManagedObject()), handleByAddress() {
@@ -20,6 +20,7 @@
 #include <unordered_map>
 
 #include "core/platform.h"
+#include "ac/timer.h"
 #include "script/runtimescriptvalue.h"
 #include "ac/dynobj/cc_scriptobject.h"   // IScriptObject
 
@@ -27,6 +28,30 @@ namespace AGS { namespace Common { class Stream; }}
 using namespace AGS; // FIXME later
 
 struct ManagedObjectPool final {
+public:
+    // Garbage collection statistics
+    struct GCStats {
+        uint32_t cycles = 0u;       // completed collection cycles
+        uint32_t slices = 0u;       // collection steps run
+        uint32_t removed = 0u;      // total number of disposed objects
+        AGS_Clock::duration totalTime = AGS_Clock::duration::zero(); // total time spent
+        AGS_Clock::duration maxPause = AGS_Clock::duration::zero();  // longest single step
+    };
+
+    // Object statistics per manager (which normally corresponds to the object type)
+    struct TypeStats {
+        uint32_t count = 0u;    // number of live objects
+        uint32_t created = 0u;  // total number of created objects
+    };
+    typedef std::unordered_map<IScriptObject*, TypeStats> TypeStatsMap;
+
+    // Memory used by the objects of certain type
+    struct TypeMemoryUsage {
+        const char *type = nullptr;
+        uint32_t count = 0u;    // number of live objects
+        size_t dataSize = 0u;   // size of the objects' data, where known
+    };
+
 private:
     // TODO: find out if we can make handle size_t
     struct ManagedObject {
@@ -45,6 +70,12 @@ private:
     };
 
     int objectCreationCounter;  // used to do garbage collection every so often
+    // Next handle to check by the incremental garbage collection,
+    // 0 means that there's no collection cycle in progress
+    int32_t gcNextHandle {};
+    GCStats gcStats;
+    TypeStatsMap typeStats;
+    uint32_t totalCreated {}; // total number of created objects
 
     int32_t nextHandle {}; // TODO: manage nextHandle's going over INT32_MAX !
     std::queue<int32_t> available_ids;
@@ -54,6 +85,9 @@ private:
     int  Add(int handle, void *address, IScriptObject *callback, ScriptValueType obj_type);
     int  Remove(ManagedObject &o, bool force = false);
     void RunGarbageCollection();
+    // Checks up to max_handles objects, continuing from the last checked one;
+    // returns the number of disposed objects
+    uint32_t RunGarbageCollectionStep(int32_t max_handles);
 
 public:
 
@@ -64,7 +98,18 @@ public:
     void* HandleToAddress(int32_t handle);
     ScriptValueType HandleToAddressAndManager(int32_t handle, void *&object, IScriptObject *&manager);
     int RemoveObject(void *address);
+    // Runs a step of the incremental garbage collection, if one is in progress,
+    // or if there have been enough new objects created since the last one
     void RunGarbageCollectionIfAppropriate();
+    const GCStats &GetGCStats() const { return gcStats; }
+    const TypeStatsMap &GetTypeStats() const { return typeStats; }
+    uint32_t GetTotalCreated() const { return totalCreated; }
+    // Returns the size of the object's data, if it's known by the engine, or 0
+    size_t GetObjectDataSize(int32_t handle) const;
+    // Calculates the number of objects and their data size per object type
+    void GetTypeMemoryUsage(std::vector<TypeMemoryUsage> &usage) const;
+    // Calculates the total data size of all objects, where known
+    size_t GetTotalDataSize() const;
     int AddObject(void *address, IScriptObject *callback, ScriptValueType obj_type);
     int AddUnserializedObject(void *address, IScriptObject *callback, ScriptValueType obj_type, int handle);
     void WriteToDisk(Common::Stream *out);
@@ -79,7 +124,7 @@ extern ManagedObjectPool pool;
 
 // Extreme(!!) verbosity managed memory pool log
 #if DEBUG_MANAGED_OBJECTS
-#define ManagedObjectLog(...) Debug::Printf(kDbgGroup_ManObj, kDbgMsg_Debug, __VA_ARGS__)
+#define ManagedObjectLog(...) DEBUG_PRINTF(kDbgGroup_ManObj, kDbgMsg_Debug, __VA_ARGS__)
 #else
 #define ManagedObjectLog(...)
 #endif
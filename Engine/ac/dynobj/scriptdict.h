@@ -13,7 +13,7 @@
 //=============================================================================
 //
 // Managed script object wrapping std::map<String, String> and
-// unordered_map<String, String>.
+// FlatHashMap<String, String>.
 //
 // TODO: support wrapping non-owned Dictionary, passed by the reference, -
 // that would let expose internal engine's dicts using same interface.
@@ -26,9 +26,9 @@
 #define __AC_SCRIPTDICT_H
 
 #include <map>
-#include <unordered_map>
 #include <string.h>
 #include "ac/dynobj/cc_agsdynamicobject.h"
+#include "util/flat_hash.h"
 #include "util/stream.h"
 #include "util/string.h"
 #include "util/string_types.h"
@@ -111,11 +111,13 @@ public:
     int GetItemCount() override { return _dic.size(); }
     void GetKeys(std::vector<const char*> &buf) const override
     {
+        buf.reserve(buf.size() + _dic.size());
         for (auto it = _dic.begin(); it != _dic.end(); ++it)
             buf.push_back(it->first.GetCStr());
     }
     void GetValues(std::vector<const char*> &buf) const override
     {
+        buf.reserve(buf.size() + _dic.size());
         for (auto it = _dic.begin(); it != _dic.end(); ++it)
             buf.push_back(it->second.GetCStr());
     }
@@ -174,7 +176,7 @@ private:
 
 typedef ScriptDictImpl< std::map<String, String>, true, true > ScriptDict;
 typedef ScriptDictImpl< std::map<String, String, StrLessNoCase>, true, false > ScriptDictCI;
-typedef ScriptDictImpl< std::unordered_map<String, String>, false, true > ScriptHashDict;
-typedef ScriptDictImpl< std::unordered_map<String, String, HashStrNoCase, StrEqNoCase>, false, false > ScriptHashDictCI;
+typedef ScriptDictImpl< FlatHashMap<String, String>, false, true > ScriptHashDict;
+typedef ScriptDictImpl< FlatHashMap<String, String, HashStrNoCase, StrEqNoCase>, false, false > ScriptHashDictCI;
 
 #endif // __AC_SCRIPTDICT_H
@@ -17,6 +17,7 @@
 #include "ac/drawingsurface.h"
 #include "ac/gamestate.h"
 #include "ac/gamesetupstruct.h"
+#include "ac/room.h"
 #include "ac/spritecache.h"
 #include "ac/runtime_defines.h"
 #include "ac/dynobj/dynobj_manager.h"
@@ -33,7 +34,10 @@ Bitmap* ScriptDrawingSurface::GetBitmapSurface()
 {
     // TODO: consider creating weak_ptr here, and store one in the DrawingSurface!
     if (roomBackgroundNumber >= 0)
+    {
+        ensure_room_bg_frame(roomBackgroundNumber);
         return thisroom.BgFrames[roomBackgroundNumber].Graphic.get();
+    }
     else if (dynamicSpriteNumber >= 0)
         return spriteset[dynamicSpriteNumber];
     else if (dynamicSurfaceNumber >= 0)
@@ -56,8 +60,24 @@ void ScriptDrawingSurface::FinishedDrawingReadOnly()
 }
 
 void ScriptDrawingSurface::FinishedDrawing()
+{
+    Bitmap *ds = GetBitmapSurface();
+    FinishedDrawing(RectWH(0, 0, ds->GetWidth(), ds->GetHeight()));
+}
+
+void ScriptDrawingSurface::FinishedDrawing(const Rect &area)
 {
     FinishedDrawingReadOnly();
+    Bitmap *ds = GetBitmapSurface();
+    const Rect clip_area = IntersectRects(area, RectWH(0, 0, ds->GetWidth(), ds->GetHeight()));
+    if (clip_area.IsEmpty())
+        return; // nothing was drawn
+    // NOTE: if the surface was modified, but the area is not known
+    // (e.g. restored from a save), then keep it empty, meaning "whole surface"
+    if (!modified)
+        modifiedArea = clip_area;
+    else if (!modifiedArea.IsEmpty())
+        modifiedArea = SumRects(modifiedArea, clip_area);
     modified = 1;
 }
 
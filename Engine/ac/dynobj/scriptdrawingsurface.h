@@ -33,6 +33,10 @@ struct ScriptDrawingSurface final : AGSCCDynamicObject {
     int highResCoordinates;
     int modified;
     int hasAlphaChannel;
+    // The area of the surface modified since it was acquired; lets to update
+    // only the changed part of the sprite's texture when the surface is released.
+    // Empty area along with the "modified" flag means the whole surface.
+    Rect modifiedArea;
     //Common::Bitmap* abufBackup;
 
     int Dispose(void *address, bool force) override;
@@ -44,7 +48,10 @@ struct ScriptDrawingSurface final : AGSCCDynamicObject {
     void SizeToGameResolution(int *width, int *height);
     void SizeToGameResolution(int *adjustValue);
     void SizeToDataResolution(int *adjustValue);
+    // Marks the whole surface as modified
     void FinishedDrawing();
+    // Marks the given area of the surface as modified
+    void FinishedDrawing(const Rect &area);
     void FinishedDrawingReadOnly();
 
     ScriptDrawingSurface();
@@ -12,7 +12,7 @@
 //
 //=============================================================================
 //
-// Managed script object wrapping std::set<String> and unordered_set<String>.
+// Managed script object wrapping std::set<String> and FlatHashSet<String>.
 //
 // TODO: support wrapping non-owned Set, passed by the reference, -
 // that would let expose internal engine's sets using same interface.
@@ -25,9 +25,9 @@
 #define __AC_SCRIPTSET_H
 
 #include <set>
-#include <unordered_set>
 #include <string.h>
 #include "ac/dynobj/cc_agsdynamicobject.h"
+#include "util/flat_hash.h"
 #include "util/stream.h"
 #include "util/string.h"
 #include "util/string_types.h"
@@ -97,6 +97,7 @@ public:
     int GetItemCount() const override { return _set.size(); }
     void GetItems(std::vector<const char*> &buf) const override
     {
+        buf.reserve(buf.size() + _set.size());
         for (auto it = _set.begin(); it != _set.end(); ++it)
             buf.push_back(it->GetCStr());
     }
@@ -144,7 +145,7 @@ private:
 
 typedef ScriptSetImpl< std::set<String>, true, true > ScriptSet;
 typedef ScriptSetImpl< std::set<String, StrLessNoCase>, true, false > ScriptSetCI;
-typedef ScriptSetImpl< std::unordered_set<String>, false, true > ScriptHashSet;
-typedef ScriptSetImpl< std::unordered_set<String, HashStrNoCase, StrEqNoCase>, false, false > ScriptHashSetCI;
+typedef ScriptSetImpl< FlatHashSet<String>, false, true > ScriptHashSet;
+typedef ScriptSetImpl< FlatHashSet<String, HashStrNoCase, StrEqNoCase>, false, false > ScriptHashSetCI;
 
 #endif // __AC_SCRIPTSET_H
@@ -14,15 +14,33 @@
 #include "ac/dynobj/scriptstring.h"
 #include <stdlib.h>
 #include <string.h>
+#include <unordered_map>
 #include <allegro.h>
 #include "ac/string.h"
 #include "ac/dynobj/dynobj_manager.h"
 #include "util/stream.h"
+#include "util/string_types.h"
 
 using namespace AGS::Common;
 
 ScriptString myScriptStringImpl;
 
+// Hashing and comparison of the interned strings' texts
+struct InternedHash
+{
+    size_t operator()(const char *text) const { return FNV::Hash(text, strlen(text)); }
+};
+
+struct InternedEq
+{
+    bool operator()(const char *a, const char *b) const { return strcmp(a, b) == 0; }
+};
+
+// Interned strings, maps a string's text to the string object;
+// the key points to the text of the object itself
+static std::unordered_map<const char*, char*, InternedHash, InternedEq> InternedStrings;
+static ScriptString::Stats StringStats;
+
 const char *ScriptString::GetType()
 {
     return "String";
@@ -30,7 +48,16 @@ const char *ScriptString::GetType()
 
 int ScriptString::Dispose(void *address, bool /*force*/)
 {
-    delete[] (static_cast<uint8_t*>(address) - MemHeaderSz);
+    if (GetHeader(address).Length <= InternMaxLength)
+    {
+        auto it = InternedStrings.find(static_cast<const char*>(address));
+        if (it != InternedStrings.end() && it->second == address)
+        {
+            InternedStrings.erase(it);
+            StringStats.InternedLive--;
+        }
+    }
+    ccFreeObjectMemory(static_cast<uint8_t*>(address) - MemHeaderSz, GetHeader(address).Length + 1 + MemHeaderSz);
     return 1;
 }
 
@@ -50,7 +77,7 @@ void ScriptString::Serialize(const void* address, Stream *out)
 void ScriptString::Unserialize(int index, Stream *in, size_t /*data_sz*/)
 {
     size_t len = in->ReadInt32();
-    uint8_t *buf = new uint8_t[len + 1 + MemHeaderSz];
+    uint8_t *buf = static_cast<uint8_t*>(ccAllocObjectMemory(len + 1 + MemHeaderSz));
     char *text_ptr = reinterpret_cast<char*>(buf + MemHeaderSz);
     in->Read(text_ptr, len + 1); // it was writing trailing 0 for some reason
     text_ptr[len] = 0; // for safety
@@ -59,49 +86,95 @@ void ScriptString::Unserialize(int index, Stream *in, size_t /*data_sz*/)
     hdr.ULength = ustrlen(text_ptr);
     hdr.LastCharIdx = 0u;
     hdr.LastCharOff = 0u;
-    ccRegisterUnserializedObject(index, text_ptr, this);
+    hdr.Handle = ccRegisterUnserializedObject(index, text_ptr, this);
 }
 
 DynObjectRef ScriptString::CreateObject(uint8_t *buf)
 {
     char *text_ptr = reinterpret_cast<char*>(buf + MemHeaderSz);
+    Header *header = reinterpret_cast<Header*>(buf);
     int32_t handle = ccRegisterManagedObject(text_ptr, &myScriptStringImpl);
     if (handle == 0)
     {
-        delete[] buf;
+        ccFreeObjectMemory(buf, header->Length + 1 + MemHeaderSz);
         return DynObjectRef();
     }
+    header->Handle = handle;
+    StringStats.Created++;
+    if (header->Length <= InternMaxLength)
+    {
+        InternedStrings.insert(std::make_pair(text_ptr, text_ptr));
+        StringStats.InternedLive++;
+    }
     return DynObjectRef(handle, text_ptr, &myScriptStringImpl);
 }
 
+DynObjectRef ScriptString::FindInterned(const char *text, size_t len)
+{
+    if (len > InternMaxLength)
+        return DynObjectRef();
+    auto it = InternedStrings.find(text);
+    if (it == InternedStrings.end())
+        return DynObjectRef();
+    StringStats.Interned++;
+    return DynObjectRef(GetHeader(it->second).Handle, it->second, &myScriptStringImpl);
+}
+
+const ScriptString::Stats &ScriptString::GetStats()
+{
+    return StringStats;
+}
+
+ScriptString::Buffer::~Buffer()
+{
+    ccFreeObjectMemory(_buf, _sz);
+}
+
+ScriptString::Buffer::Buffer(Buffer &&buf)
+    : _buf(buf._buf), _sz(buf._sz)
+{
+    buf._buf = nullptr;
+    buf._sz = 0u;
+}
+
 ScriptString::Buffer ScriptString::CreateBuffer(size_t len, size_t ulen)
 {
     assert(ulen <= len);
-    std::unique_ptr<uint8_t[]> buf(new uint8_t[len + 1 + MemHeaderSz]);
-    auto *header = reinterpret_cast<Header*>(buf.get());
+    uint8_t *buf = static_cast<uint8_t*>(ccAllocObjectMemory(len + 1 + MemHeaderSz));
+    auto *header = reinterpret_cast<Header*>(buf);
     header->Length = len;
     header->ULength = ulen;
     header->LastCharIdx = 0;
     header->LastCharOff = 0;
-    return Buffer(std::move(buf), len + 1 + MemHeaderSz);
+    header->Handle = 0;
+    return Buffer(buf, len + 1 + MemHeaderSz);
 }
 
 DynObjectRef ScriptString::Create(const char *text)
 {
-    int len, ulen;
-    ustrlen2(text, &len, &ulen);
+    size_t len, ulen;
+    GetTextLength(text, len, ulen);
+    DynObjectRef interned = FindInterned(text, len);
+    if (interned.Obj)
+        return interned;
     auto buf = CreateBuffer(len, ulen);
     memcpy(buf.Get(), text, len + 1);
-    return CreateObject(buf._buf.release());
+    return CreateObject(buf.Release());
 }
 
 DynObjectRef ScriptString::Create(Buffer &&strbuf)
 {
-    uint8_t *buf = strbuf._buf.release();
+    uint8_t *buf = strbuf.Release();
     auto *header = reinterpret_cast<Header*>(buf);
     char *text_ptr = reinterpret_cast<char*>(buf + MemHeaderSz);
     if ((header->Length > 0) && (header->ULength == 0u))
         header->ULength = ustrlen(text_ptr);
     text_ptr[header->Length] = 0; // for safety
+    DynObjectRef interned = FindInterned(text_ptr, header->Length);
+    if (interned.Obj)
+    {
+        ccFreeObjectMemory(buf, header->Length + 1 + MemHeaderSz);
+        return interned;
+    }
     return CreateObject(buf);
 }
@@ -14,7 +14,6 @@
 #ifndef __AC_SCRIPTSTRING_H
 #define __AC_SCRIPTSTRING_H
 
-#include <memory>
 #include "ac/dynobj/cc_agsdynamicobject.h"
 
 struct ScriptString final : AGSCCDynamicObject
@@ -30,6 +29,9 @@ public:
         // NOTE: intentionally limited to 64k chars/bytes to save bit of mem.
         uint16_t LastCharIdx = 0u;
         uint16_t LastCharOff = 0u;
+        // Handle of this object in the managed pool, for the quick
+        // address-to-handle conversion; 0 if not registered
+        int32_t Handle = 0;
     };
 
     struct Buffer
@@ -37,21 +39,38 @@ public:
         friend ScriptString;
     public:
         Buffer() = default;
-        ~Buffer() = default;
-        Buffer(Buffer &&buf) = default;
+        ~Buffer();
+        Buffer(Buffer &&buf);
         // Returns a pointer to the beginning of a text buffer
-        char *Get() { return reinterpret_cast<char*>(_buf.get() + MemHeaderSz); }
+        char *Get() { return reinterpret_cast<char*>(_buf + MemHeaderSz); }
         // Returns size allocated for a text content (includes null pointer)
         size_t GetSize() const { return _sz - MemHeaderSz; }
 
     private:
-        Buffer(std::unique_ptr<uint8_t[]> &&buf, size_t buf_sz)
-            : _buf(std::move(buf)), _sz(buf_sz) {}
+        Buffer(uint8_t *buf, size_t buf_sz)
+            : _buf(buf), _sz(buf_sz) {}
+        Buffer(const Buffer&) = delete;
+        Buffer &operator =(const Buffer&) = delete;
 
-        std::unique_ptr<uint8_t[]> _buf;
-        size_t _sz;
+        // Releases the ownership over the buffer
+        uint8_t *Release() { uint8_t *buf = _buf; _buf = nullptr; _sz = 0u; return buf; }
+
+        // NOTE: the buffer is allocated by the managed objects' allocator
+        uint8_t *_buf = nullptr;
+        size_t _sz = 0u;
+    };
+
+
+    // String creation statistics
+    struct Stats
+    {
+        uint32_t Created = 0u;  // number of created string objects
+        uint32_t Interned = 0u; // number of times an existing string was reused
+        uint32_t InternedLive = 0u; // number of live interned strings
     };
 
+    // Max length of a string (in bytes) which may be interned
+    static const size_t InternMaxLength = 64u;
 
     ScriptString() = default;
     ~ScriptString() = default;
@@ -76,6 +95,12 @@ public:
     // Create a new script string by taking ownership over the given buffer;
     // passed buffer variable becomes invalid after this call.
     static DynObjectRef Create(Buffer &&strbuf);
+    // NOTE: script strings are immutable, so the short ones are interned:
+    // if there's already a live string with the same text, then the Create
+    // functions return that string instead of allocating a new one.
+
+    // Returns string creation statistics
+    static const Stats &GetStats();
 
     const char *GetType() override;
     int Dispose(void *address, bool force) override;
@@ -89,6 +114,8 @@ private:
     static const size_t FileHeaderSz = sizeof(uint32_t);
 
     static DynObjectRef CreateObject(uint8_t *buf);
+    // Looks up for the interned string with the given text
+    static DynObjectRef FindInterned(const char *text, size_t len);
 
     // Savegame serialization
     // Calculate and return required space for serialization, in bytes
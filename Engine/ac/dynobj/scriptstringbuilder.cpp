@@ -0,0 +1,89 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <algorithm>
+#include "ac/dynobj/scriptstringbuilder.h"
+#include "ac/string.h"
+#include "ac/dynobj/dynobj_manager.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
+
+ScriptStringBuilder::ScriptStringBuilder(size_t capacity)
+{
+    _text.reserve(capacity);
+}
+
+int ScriptStringBuilder::Dispose(void* /*address*/, bool /*force*/)
+{
+    delete this;
+    return 1;
+}
+
+const char *ScriptStringBuilder::GetType()
+{
+    return "StringBuilder";
+}
+
+size_t ScriptStringBuilder::CalcSerializeSize(const void* /*address*/)
+{
+    return sizeof(int32_t) + _text.size();
+}
+
+void ScriptStringBuilder::Serialize(const void* /*address*/, Stream *out)
+{
+    out->WriteInt32(static_cast<int32_t>(_text.size()));
+    out->Write(_text.c_str(), _text.size());
+}
+
+void ScriptStringBuilder::Unserialize(int index, Stream *in, size_t /*data_sz*/)
+{
+    const size_t len = static_cast<uint32_t>(in->ReadInt32());
+    _text.resize(len);
+    in->Read(&_text[0], len);
+    size_t text_len;
+    GetTextLength(_text.c_str(), text_len, _ulength);
+    ccRegisterUnserializedObject(index, this, this);
+}
+
+size_t ScriptStringBuilder::GetOffset(size_t index) const
+{
+    return GetTextOffset(_text.c_str(), _text.size(), index);
+}
+
+void ScriptStringBuilder::Append(const char *text, size_t len, size_t ulen)
+{
+    // std::string grows its capacity geometrically
+    _text.append(text, len);
+    _ulength += ulen;
+}
+
+void ScriptStringBuilder::Insert(size_t index, const char *text, size_t len, size_t ulen)
+{
+    _text.insert(GetOffset(index), text, len);
+    _ulength += ulen;
+}
+
+void ScriptStringBuilder::Remove(size_t index, size_t count)
+{
+    const size_t start = GetOffset(index);
+    const size_t end = start + GetTextOffset(_text.c_str() + start, _text.size() - start, count);
+    _text.erase(start, end - start);
+    _ulength -= std::min(count, _ulength - index);
+}
+
+void ScriptStringBuilder::Clear()
+{
+    _text.clear();
+    _ulength = 0u;
+}
@@ -0,0 +1,70 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// ScriptStringBuilder is a mutable text buffer for the script. Unlike
+// appending to the script String, which creates a new string copy each time,
+// appending to the builder extends its buffer in place, with the amortized
+// growth, so that building a long text by pieces takes linear time.
+//
+// The builder keeps track of both the length in bytes and in characters,
+// the character indexes are used by the script API, same as with Strings.
+//
+//=============================================================================
+#ifndef __AGS_EE_DYNOBJ__SCRIPTSTRINGBUILDER_H
+#define __AGS_EE_DYNOBJ__SCRIPTSTRINGBUILDER_H
+
+#include <string>
+#include "ac/dynobj/cc_agsdynamicobject.h"
+
+struct ScriptStringBuilder final : AGSCCDynamicObject
+{
+public:
+    ScriptStringBuilder() = default;
+    ScriptStringBuilder(size_t capacity);
+
+    int Dispose(void *address, bool force) override;
+    const char *GetType() override;
+    void Unserialize(int index, AGS::Common::Stream *in, size_t data_sz) override;
+
+    // Gets the text, always null-terminated
+    const char *GetCStr() const { return _text.c_str(); }
+    // Gets the length of text in bytes
+    size_t GetLength() const { return _text.size(); }
+    // Gets the length of text in characters
+    size_t GetULength() const { return _ulength; }
+
+    // Appends the text of the given length in bytes (len) and characters (ulen)
+    void Append(const char *text, size_t len, size_t ulen);
+    // Inserts the text at the given character index
+    void Insert(size_t index, const char *text, size_t len, size_t ulen);
+    // Removes the given number of characters starting with the character index
+    void Remove(size_t index, size_t count);
+    // Clears the text, but keeps the allocated buffer for reuse
+    void Clear();
+
+protected:
+    // Calculate and return required space for serialization, in bytes
+    size_t CalcSerializeSize(const void *address) override;
+    // Write object data into the provided stream
+    void Serialize(const void *address, AGS::Common::Stream *out) override;
+
+private:
+    // Gets the byte offset of the character index
+    size_t GetOffset(size_t index) const;
+
+    std::string _text;
+    size_t _ulength = 0u;
+};
+
+#endif // __AGS_EE_DYNOBJ__SCRIPTSTRINGBUILDER_H
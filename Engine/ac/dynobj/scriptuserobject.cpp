@@ -28,7 +28,7 @@ const char *ScriptUserObject::GetType()
 
 /* static */ DynObjectRef ScriptUserObject::Create(size_t size)
 {
-    uint8_t *new_data = new uint8_t[size + MemHeaderSz];
+    uint8_t *new_data = static_cast<uint8_t*>(ccAllocObjectMemory(size + MemHeaderSz));
     memset(new_data, 0, size + MemHeaderSz);
     Header &hdr = reinterpret_cast<Header&>(*new_data);
     hdr.Size = size;
@@ -36,15 +36,16 @@ const char *ScriptUserObject::GetType()
     int32_t handle = ccRegisterManagedObject(obj_ptr, &globalDynamicStruct);
     if (handle == 0)
     {
-        delete[] new_data;
+        ccFreeObjectMemory(new_data, size + MemHeaderSz);
         return DynObjectRef();
     }
+    hdr.Handle = handle;
     return DynObjectRef(handle, obj_ptr, &globalDynamicStruct);
 }
 
 int ScriptUserObject::Dispose(void *address, bool /*force*/)
 {
-    delete[] (static_cast<uint8_t*>(address) - MemHeaderSz);
+    ccFreeObjectMemory(static_cast<uint8_t*>(address) - MemHeaderSz, GetHeader(address).Size + MemHeaderSz);
     return 1;
 }
 
@@ -63,11 +64,11 @@ void ScriptUserObject::Serialize(const void *address, AGS::Common::Stream *out)
 
 void ScriptUserObject::Unserialize(int index, Stream *in, size_t data_sz)
 {
-    uint8_t *new_data = new uint8_t[(data_sz - FileHeaderSz) + MemHeaderSz];
+    uint8_t *new_data = static_cast<uint8_t*>(ccAllocObjectMemory((data_sz - FileHeaderSz) + MemHeaderSz));
     Header &hdr = reinterpret_cast<Header&>(*new_data);
     hdr.Size = data_sz - FileHeaderSz;
     in->Read(new_data + MemHeaderSz, data_sz - FileHeaderSz);
-    ccRegisterUnserializedObject(index, &new_data[MemHeaderSz], this);
+    hdr.Handle = ccRegisterUnserializedObject(index, &new_data[MemHeaderSz], this);
 }
 
 ScriptUserObject globalDynamicStruct;
@@ -36,6 +36,9 @@ public:
         // enough. Since this interface is also a part of Plugin API, we would
         // need more significant change to program before we could use different
         // approach.
+        // Handle of this object in the managed pool, for the quick
+        // address-to-handle conversion; 0 if not registered
+        int32_t Handle = 0;
     };
 
     ScriptUserObject() = default;
@@ -46,6 +49,11 @@ public:
         return reinterpret_cast<const Header&>(*(static_cast<const uint8_t*>(address) - MemHeaderSz));
     }
 
+    inline static Header &GetHeader(void *address)
+    {
+        return reinterpret_cast<Header&>(*(static_cast<uint8_t*>(address) - MemHeaderSz));
+    }
+
     // Create managed struct object and return a pointer to the beginning of a buffer
     static DynObjectRef Create(size_t size);
 
@@ -33,6 +33,7 @@
 #include "plugin/plugin_engine.h"
 #include "script/script.h"
 #include "gfx/bitmap.h"
+#include "gfx/bitmappool.h"
 #include "gfx/ddb.h"
 #include "gfx/graphicsdriver.h"
 #include "media/audio/audio_system.h"
@@ -52,12 +53,15 @@ extern int displayed_room;
 extern ScriptHotspot scrHotspot[MAX_ROOM_HOTSPOTS];
 extern CCHotspot ccDynamicHotspot;
 // FIXME: refactor further to get rid of this extern, maybe move part of the code to screen.cpp?
-extern std::unique_ptr<Bitmap> saved_viewport_bitmap;
+extern PooledBitmap saved_viewport_bitmap;
 
 int in_enters_screen=0,done_es_error = 0;
 int in_leaves_screen = -1;
 
 std::vector<EventHappened> events;
+// The events being processed; swapped with the queue on each pass, so that
+// both keep their capacity, and the processing does not allocate memory
+static std::vector<EventHappened> events_processing;
 
 int inside_processevent=0;
 int eventClaimed = EVENT_NONE;
@@ -65,7 +69,7 @@ int eventClaimed = EVENT_NONE;
 const char *tsnames[kTS_Num] = {nullptr, REP_EXEC_NAME, "on_key_press", "on_mouse_click", "on_text_input" };
 
 
-int run_claimable_event(const char *tsname, bool includeRoom, int numParams, const RuntimeScriptValue *params, bool *eventWasClaimed) {
+int run_claimable_event(ClaimableScriptEvent &evt, bool includeRoom, int numParams, const RuntimeScriptValue *params, bool *eventWasClaimed) {
     *eventWasClaimed = true;
     // Run the room script function, and if it is not claimed,
     // then run the main one
@@ -75,8 +79,11 @@ int run_claimable_event(const char *tsname, bool includeRoom, int numParams, con
     eventClaimed = EVENT_INPROGRESS;
     int toret;
 
-    if (includeRoom && roominst) {
-        toret = RunScriptFunction(roominst.get(), tsname, numParams, params);
+    // The functions are looked up once per script, and the modules
+    // which don't have the function are skipped
+    if (includeRoom && roominst &&
+        ResolveScriptFunction(roominst.get(), evt.functionName, evt.roomFunction).IsValid()) {
+        toret = RunScriptFunction(roominst.get(), evt.roomFunction, evt.functionName, numParams, params);
 
         if (eventClaimed == EVENT_CLAIMED) {
             eventClaimed = eventClaimedOldValue;
@@ -85,8 +92,11 @@ int run_claimable_event(const char *tsname, bool includeRoom, int numParams, con
     }
 
     // run script modules
-    for (auto &module_inst : moduleInst) {
-        toret = RunScriptFunction(module_inst.get(), tsname, numParams, params);
+    for (size_t i = 0; i < moduleInst.size(); ++i) {
+        ccInstance *module_inst = moduleInst[i].get();
+        if (!ResolveScriptFunction(module_inst, evt.functionName, evt.moduleFunction[i]).IsValid())
+            continue;
+        toret = RunScriptFunction(module_inst, evt.moduleFunction[i], evt.functionName, numParams, params);
 
         if (eventClaimed == EVENT_CLAIMED) {
             eventClaimed = eventClaimedOldValue;
@@ -236,26 +246,30 @@ void processallevents() {
         return;
     }
 
-    // Make a copy of the events to process them safely.
+    if (events.empty())
+        return;
+
+    // Move the events out of the queue to process them safely.
     // WARNING: engine may actually add more events to the global events array,
     // and they must NOT be processed here, but instead discarded at the end
     // of this function; otherwise game may glitch.
     // TODO: need to redesign engine events system?
-    std::vector<EventHappened> evtcopy = events;
+    std::swap(events, events_processing);
 
     int room_was = play.room_changes;
 
     inside_processevent++;
 
-    for (size_t i = 0; i < evtcopy.size(); ++i) {
+    for (size_t i = 0; i < events_processing.size(); ++i) {
 
-        process_event(&evtcopy[i]);
+        process_event(&events_processing[i]);
 
         if (room_was != play.room_changes)
             break;  // changed room, so discard other events
     }
 
     events.clear();
+    events_processing.clear();
     inside_processevent--;
 }
 
@@ -21,6 +21,8 @@
 #include "ac/runtime_defines.h"
 #include "script/runtimescriptvalue.h"
 
+struct ClaimableScriptEvent;
+
 // parameters to run_on_event
 #define GE_LEAVE_ROOM    1
 #define GE_ENTER_ROOM    2
@@ -101,7 +103,7 @@ struct EventHappened
         : type(type_), data1(data1_), data2(data2_), data3(data3_), player(player_) {}
 };
 
-int run_claimable_event(const char *tsname, bool includeRoom, int numParams, const RuntimeScriptValue *params, bool *eventWasClaimed);
+int run_claimable_event(ClaimableScriptEvent &evt, bool includeRoom, int numParams, const RuntimeScriptValue *params, bool *eventWasClaimed);
 // runs the global script on_event fnuction
 void run_on_event (int evtype, RuntimeScriptValue &wparam);
 void run_room_event(int id);
@@ -11,6 +11,9 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
+#include <atomic>
+#include <unordered_set>
 #include "ac/asset_helper.h"
 #include "ac/audiocliptype.h"
 #include "ac/file.h"
@@ -22,6 +25,8 @@
 #include "ac/path_helper.h"
 #include "ac/runtime_defines.h"
 #include "ac/string.h"
+#include "ac/timer.h"
+#include "ac/dynobj/cc_dynamicarray.h"
 #include "ac/dynobj/dynobj_manager.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
@@ -34,6 +39,7 @@
 #include "util/directory.h"
 #include "util/path.h"
 #include "util/string.h"
+#include "util/string_types.h"
 #include "util/string_utils.h"
 
 using namespace AGS::Common;
@@ -108,44 +114,85 @@ void File_WriteRawLine(sc_File *fil, const char *towrite) {
   FileWriteRawLine(fil->handle, towrite);
 }
 
+// Gets the number of elements in the int array, which the script function
+// is going to process, limited by the actual array's length
+static uint32_t GetIntArrayCount(void *arr, int count, const char *api_name) {
+    if (!arr) {
+        debug_script_warn("%s: array is null", api_name);
+        return 0u;
+    }
+    const auto &hdr = CCDynamicArray::GetHeader(arr);
+    const uint32_t arr_len = hdr.ElemCount & ~ARRAY_MANAGED_TYPE_FLAG;
+    if ((hdr.ElemCount & ARRAY_MANAGED_TYPE_FLAG) || (arr_len > 0 && hdr.TotalSize / arr_len != sizeof(int32_t))) {
+        debug_script_warn("%s: array is not of int type", api_name);
+        return 0u;
+    }
+    if (count < 0)
+        return arr_len;
+    if (static_cast<uint32_t>(count) > arr_len)
+        debug_script_warn("%s: count %d exceeds array length %u", api_name, count, arr_len);
+    return std::min(static_cast<uint32_t>(count), arr_len);
+}
+
+int File_WriteRawInts(sc_File *fil, void *arr, int count) {
+  const uint32_t num = GetIntArrayCount(arr, count, "File.WriteRawInts");
+  Stream *out = get_file_stream(fil->handle, "File.WriteRawInts");
+  return static_cast<int>(out->WriteArrayOfInt32(static_cast<const int32_t*>(arr), num));
+}
+
+// Size of the chunk in which the raw lines are read and scanned for linebreaks;
+// kept small, so that the reads are served from the stream's buffer
+static const size_t RawLineReadChunk = 128;
+
 // Reads line of chars until linebreak is met or buffer is filled;
 // returns whether reached the end of line (false in case not enough buffer);
 // guarantees null-terminator in the buffer.
 static bool File_ReadRawLineImpl(sc_File *fil, char* buffer, size_t buf_len) {
     if (buf_len == 0) return false;
     Stream *in = get_file_stream(fil->handle, "File.ReadRawLine");
-    for (size_t i = 0; i < buf_len - 1; ++i)
+    // Read the chars in chunks, and seek back past the end of line if read too far
+    const size_t max_len = buf_len - 1;
+    size_t len = 0;
+    while (len < max_len)
     {
-        int c = in->ReadByte();
-        if (c < 0 || c == '\n') // EOF or LF
+        char *chunk = buffer + len;
+        const size_t read_sz = in->Read(chunk, std::min(max_len - len, RawLineReadChunk));
+        if (read_sz == 0)
+            break; // EOF
+        char *eol = std::find_if(chunk, chunk + read_sz, [](char c) { return c == '\n' || c == '\r'; });
+        if (eol == chunk + read_sz)
         {
-            buffer[i] = 0;
-            return true;
+            len += read_sz;
+            continue;
         }
-        if (c == '\r') // CR or CRLF
+        size_t consumed = eol - chunk + 1;
+        if (*eol == '\r') // CR or CRLF
         {
-            c = in->ReadByte();
             // Look for '\n', but it may be missing, which is also a valid case
-            if (c >= 0 && c != '\n') in->Seek(-1, kSeekCurrent);
-            buffer[i] = 0;
-            return true;
+            if (consumed < read_sz)
+            {
+                if (eol[1] == '\n') consumed++;
+            }
+            else
+            {
+                int c = in->ReadByte();
+                if (c >= 0 && c != '\n') in->Seek(-1, kSeekCurrent);
+            }
         }
-        buffer[i] = c;
+        if (consumed < read_sz)
+            in->Seek(-static_cast<soff_t>(read_sz - consumed), kSeekCurrent);
+        *eol = 0;
+        return true;
     }
-    buffer[buf_len - 1] = 0;
-    return false; // not enough buffer
-}
-
-void File_ReadRawLine(sc_File *fil, char* buffer) {
-  size_t buflen = check_scstrcapacity(buffer);
-  File_ReadRawLineImpl(fil, buffer, buflen);
-  commit_scstr_update(buffer);
+    buffer[len] = 0;
+    return len < max_len; // EOF, or not enough buffer
 }
 
-const char* File_ReadRawLineBack(sc_File *fil) {
+// Reads the whole line of chars, of any length
+static String File_ReadRawLineString(sc_File *fil) {
   char readbuffer[MAX_MAXSTRLEN];
   if (File_ReadRawLineImpl(fil, readbuffer, MAX_MAXSTRLEN))
-    return CreateNewScriptString(readbuffer);
+    return readbuffer;
   String sbuf = readbuffer;
   bool done = false;
   while (!done)
@@ -153,7 +200,32 @@ const char* File_ReadRawLineBack(sc_File *fil) {
     done = File_ReadRawLineImpl(fil, readbuffer, MAX_MAXSTRLEN);
     sbuf.Append(readbuffer);
   };
-  return CreateNewScriptString(sbuf.GetCStr());
+  return sbuf;
+}
+
+void File_ReadRawLine(sc_File *fil, char* buffer) {
+  size_t buflen = check_scstrcapacity(buffer);
+  File_ReadRawLineImpl(fil, buffer, buflen);
+  commit_scstr_update(buffer);
+}
+
+const char* File_ReadRawLineBack(sc_File *fil) {
+  return CreateNewScriptString(File_ReadRawLineString(fil).GetCStr());
+}
+
+void *File_ReadAllLines(sc_File *fil) {
+  Stream *in = get_file_stream(fil->handle, "File.ReadAllLines");
+  std::vector<String> lines;
+  while (!in->EOS())
+    lines.push_back(File_ReadRawLineString(fil));
+  if (lines.size() == 0)
+    return nullptr;
+  std::vector<const char*> items;
+  items.reserve(lines.size());
+  for (const auto &line : lines)
+    items.push_back(line.GetCStr());
+  DynObjectRef arr = DynamicArrayHelpers::CreateStringArray(items);
+  return arr.Obj;
 }
 
 void File_ReadString(sc_File *fil, char *toread) {
@@ -190,6 +262,12 @@ int File_ReadRawInt(sc_File *fil) {
   return FileReadRawInt(fil->handle);
 }
 
+int File_ReadRawInts(sc_File *fil, void *arr, int count) {
+  const uint32_t num = GetIntArrayCount(arr, count, "File.ReadRawInts");
+  Stream *in = get_file_stream(fil->handle, "File.ReadRawInts");
+  return static_cast<int>(in->ReadArrayOfInt32(static_cast<int32_t*>(arr), num));
+}
+
 int File_Seek(sc_File *fil, int offset, int origin)
 {
     Stream *in = get_file_stream(fil->handle, "File.Seek");
@@ -665,6 +743,60 @@ AssetPath get_voice_over_assetpath(const String &filename)
     return AssetPath(filename, "voice");
 }
 
+// Asset trace records the first use of each asset, along with the time
+// and the room it was used in
+struct AssetTrace
+{
+    std::unique_ptr<Stream> Out;
+    std::unordered_set<String, HashStrNoCase, StrEqNoCase> Used;
+    AGS_Clock::time_point StartTime;
+};
+static std::unique_ptr<AssetTrace> asset_trace;
+static std::atomic<int> asset_trace_room(-1);
+
+// NOTE: called under the AssetManager's lock, possibly from its background
+// reading thread, so the asset names are deep copied here
+static void asset_trace_on_open(const String &asset_name)
+{
+    if (!asset_trace->Used.insert(String(asset_name.GetCStr())).second)
+        return;
+    const String line = String::FromFormat("%lld %d %s\n",
+        static_cast<long long>(ToMilliseconds(AGS_Clock::now() - asset_trace->StartTime)),
+        asset_trace_room.load(), asset_name.GetCStr());
+    asset_trace->Out->Write(line.GetCStr(), line.GetLength());
+}
+
+bool asset_trace_start(const String &filename)
+{
+    asset_trace_stop();
+    auto out = File::CreateFile(filename);
+    if (!out)
+    {
+        Debug::Printf(kDbgMsg_Error, "Failed to open asset trace file for writing: %s", filename.GetCStr());
+        return false;
+    }
+    asset_trace.reset(new AssetTrace());
+    asset_trace->Out = std::move(out);
+    asset_trace->StartTime = AGS_Clock::now();
+    asset_trace_room = -1;
+    AssetMgr->SetOpenCallback(asset_trace_on_open);
+    Debug::Printf(kDbgMsg_Info, "Recording asset trace to: %s", filename.GetCStr());
+    return true;
+}
+
+void asset_trace_stop()
+{
+    if (!asset_trace)
+        return;
+    AssetMgr->SetOpenCallback(nullptr);
+    asset_trace.reset();
+}
+
+void asset_trace_set_room(int room)
+{
+    asset_trace_room = room;
+}
+
 //=============================================================================
 
 // ScriptFileHandle is a wrapper over a Stream object, prepared for script.
@@ -810,6 +942,18 @@ RuntimeScriptValue Sc_File_ReadRawLineBack(void *self, const RuntimeScriptValue
     API_OBJCALL_OBJ(sc_File, const char, myScriptStringImpl, File_ReadRawLineBack);
 }
 
+// void* (sc_File *fil)
+RuntimeScriptValue Sc_File_ReadAllLines(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_OBJ(sc_File, void, globalDynamicArray, File_ReadAllLines);
+}
+
+// int (sc_File *fil, void *arr, int count)
+RuntimeScriptValue Sc_File_ReadRawInts(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_INT_POBJ_PINT(sc_File, File_ReadRawInts, void);
+}
+
 // void (sc_File *fil, char *toread)
 RuntimeScriptValue Sc_File_ReadString(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -839,6 +983,12 @@ RuntimeScriptValue Sc_File_WriteRawInt(void *self, const RuntimeScriptValue *par
     API_OBJCALL_VOID_PINT(sc_File, File_WriteRawInt);
 }
 
+// int (sc_File *fil, void *arr, int count)
+RuntimeScriptValue Sc_File_WriteRawInts(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_INT_POBJ_PINT(sc_File, File_WriteRawInts, void);
+}
+
 // void (sc_File *fil, const char *towrite)
 RuntimeScriptValue Sc_File_WriteRawLine(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -888,9 +1038,11 @@ void RegisterFileAPI()
         { "File::ResolvePath^1",      API_FN_PAIR(File_ResolvePath) },
 
         { "File::Close^0",            API_FN_PAIR(File_Close) },
+        { "File::ReadAllLines^0",     API_FN_PAIR(File_ReadAllLines) },
         { "File::ReadInt^0",          API_FN_PAIR(File_ReadInt) },
         { "File::ReadRawChar^0",      API_FN_PAIR(File_ReadRawChar) },
         { "File::ReadRawInt^0",       API_FN_PAIR(File_ReadRawInt) },
+        { "File::ReadRawInts^2",      API_FN_PAIR(File_ReadRawInts) },
         { "File::ReadRawLine^1",      API_FN_PAIR(File_ReadRawLine) },
         { "File::ReadRawLineBack^0",  API_FN_PAIR(File_ReadRawLineBack) },
         { "File::ReadString^1",       API_FN_PAIR(File_ReadString) },
@@ -898,6 +1050,7 @@ void RegisterFileAPI()
         { "File::WriteInt^1",         API_FN_PAIR(File_WriteInt) },
         { "File::WriteRawChar^1",     API_FN_PAIR(File_WriteRawChar) },
         { "File::WriteRawInt^1",      API_FN_PAIR(File_WriteRawInt) },
+        { "File::WriteRawInts^2",     API_FN_PAIR(File_WriteRawInts) },
         { "File::WriteRawLine^1",     API_FN_PAIR(File_WriteRawLine) },
         { "File::WriteString^1",      API_FN_PAIR(File_WriteString) },
         { "File::Seek^2",             API_FN_PAIR(File_Seek) },
@@ -33,8 +33,11 @@ void	File_WriteInt(sc_File *fil, int towrite);
 void	File_WriteRawChar(sc_File *fil, int towrite);
 void	File_WriteRawInt(sc_File *fil, int towrite);
 void	File_WriteRawLine(sc_File *fil, const char *towrite);
+int     File_WriteRawInts(sc_File *fil, void *arr, int count);
 void	File_ReadRawLine(sc_File *fil, char* buffer);
 const char* File_ReadRawLineBack(sc_File *fil);
+void   *File_ReadAllLines(sc_File *fil);
+int     File_ReadRawInts(sc_File *fil, void *arr, int count);
 void	File_ReadString(sc_File *fil, char *toread);
 const char* File_ReadStringBack(sc_File *fil);
 int		File_ReadInt(sc_File *fil);
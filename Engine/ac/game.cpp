@@ -19,6 +19,7 @@
 #include "ac/button.h"
 #include "ac/character.h"
 #include "ac/dialog.h"
+#include "ac/display.h"
 #include "ac/draw.h"
 #include "ac/dynamicsprite.h"
 #include "ac/event.h"
@@ -39,6 +40,7 @@
 #include "ac/overlay.h"
 #include "ac/path_helper.h"
 #include "ac/sys_events.h"
+#include "ac/room_preload.h"
 #include "ac/roomstatus.h"
 #include "ac/sprite.h"
 #include "ac/spritecache.h"
@@ -54,6 +56,7 @@
 #include "device/mousew32.h"
 #include "font/fonts.h"
 #include "game/savegame.h"
+#include "game/savegame_index.h"
 #include "gfx/bitmap.h"
 #include "gfx/graphicsdriver.h"
 #include "gui/guibutton.h"
@@ -73,6 +76,8 @@
 #include "script/script_runtime.h"
 #include "util/directory.h"
 #include "util/file.h"
+#include "util/memory_compat.h"
+#include "util/memorystream.h"
 #include "util/path.h"
 
 using namespace AGS::Common;
@@ -81,6 +86,7 @@ using namespace AGS::Engine;
 extern ScriptSystem scsystem;
 extern ScriptAudioChannel scrAudioChannel[MAX_GAME_CHANNELS];
 extern std::vector<SpeechLipSyncLine> splipsync;
+extern SpeechLipSyncIndex splipsync_index;
 extern int numLipLines, curLipLine, curLipLinePhoneme;
 
 extern int obj_lowest_yp, char_lowest_yp;
@@ -117,7 +123,8 @@ AGS::Common::SpriteCache::Callbacks spritecallbacks = {
     get_new_size_for_sprite,
     initialize_sprite,
     post_init_sprite,
-    nullptr
+    nullptr,
+    on_sprite_lock_changed
 };
 SpriteCache spriteset(game.SpriteInfos, spritecallbacks);
 
@@ -466,6 +473,7 @@ void free_do_once_tokens()
 void unload_game()
 {
     dispose_game_drawdata();
+    invalidate_textual_image_cache();
     // NOTE: fonts should be freed prior to stopping plugins,
     // as plugins may provide font renderer interface.
     free_all_fonts();
@@ -484,6 +492,7 @@ void unload_game()
     mls.clear();
     views.clear();
     splipsync.clear();
+    splipsync_index.clear();
     numLipLines = 0;
     curLipLine = -1;
 
@@ -493,9 +502,12 @@ void unload_game()
     guis.clear();
     scrGui.clear();
 
-    get_overlays().clear();
+    clear_overlays();
 
     resetRoomStatuses();
+    room_preload_shutdown();
+    ShutdownSavegameWrites();
+    ShutdownSaveIndex();
 
     // Free game state and game struct
     play = GamePlayState();
@@ -923,20 +935,25 @@ void skip_serialized_bitmap(Stream *in)
     in->Seek(picwid * pichit * bpp);
 }
 
-Bitmap *create_savegame_screenshot()
+// Begins making the savegame screenshot, returns the screen copy handle
+static uint32_t begin_savegame_screenshot()
 {
     if ((play.screenshot_width < 16) || (play.screenshot_height < 16))
         quit("!Invalid game.screenshot_width/height, must be from 16x16 to screen res");
 
-    int usewid = data_to_game_coord(play.screenshot_width);
-    int usehit = data_to_game_coord(play.screenshot_height);
     // NOTE: be aware that by the historical logic AGS makes a screenshot
     // of a "main viewport", that may be smaller in legacy "letterbox" mode.
     const Rect &viewport = play.GetMainViewport();
-    usewid = std::min(usewid, viewport.GetWidth());
-    usehit = std::min(usehit, viewport.GetHeight());
+    return BeginCopyScreenIntoBitmap(&viewport);
+}
 
-    return CopyScreenIntoBitmap(usewid, usehit, &viewport);
+// Completes the savegame screenshot, and returns it in the final size
+static Bitmap *end_savegame_screenshot(uint32_t screen_copy)
+{
+    const Rect &viewport = play.GetMainViewport();
+    const int usewid = std::min(data_to_game_coord(play.screenshot_width), viewport.GetWidth());
+    const int usehit = std::min(data_to_game_coord(play.screenshot_height), viewport.GetHeight());
+    return EndCopyScreenIntoBitmap(screen_copy, usewid, usehit);
 }
 
 void save_game(int slotn, const char*descript) {
@@ -950,7 +967,14 @@ void save_game(int slotn, const char*descript) {
         return;
     }
 
+    // Request the screenshot first, letting the renderer transfer
+    // its pixels while we check and prepare the save
+    uint32_t screen_copy = 0u;
+    if (game.options[OPT_SAVESCREENSHOT] != 0)
+        screen_copy = begin_savegame_screenshot();
+
     if (platform->GetDiskFreeSpaceMB() < 2) {
+        gfxDriver->EndScreenCopy(screen_copy); // discard
         Display("ERROR: There is not enough disk space free to save the game. Clear some disk space and try again.");
         return;
     }
@@ -958,20 +982,48 @@ void save_game(int slotn, const char*descript) {
     VALIDATE_STRING(descript);
     String nametouse = get_save_game_path(slotn);
     std::unique_ptr<Bitmap> screenShot;
-    if (game.options[OPT_SAVESCREENSHOT] != 0)
-        screenShot.reset(create_savegame_screenshot());
-
-    std::unique_ptr<Stream> out(StartSavegame(nametouse, descript, screenShot.get()));
+    if (screen_copy > 0u)
+        screenShot.reset(end_savegame_screenshot(screen_copy));
+
+    // Don't let the previous save be written over the new one
+    WaitSavegameWrites();
+    InvalidateSaveIndex(nametouse);
+    PrepareDeltaSave(nametouse);
+    std::unique_ptr<Stream> out(File::CreateFile(nametouse));
     if (out == nullptr)
     {
         Display("ERROR: Unable to open savegame file for writing!");
         return;
     }
 
-    // Save dynamic game data
-    SaveGameState(out.get());
-    // call "After Save" event callback
-    run_on_event(GE_SAVE_GAME, RuntimeScriptValue().SetInt32(slotn));
+    // Save dynamic game data into memory, and let it be written to disk
+    // in background; the "After Save" event is run when the write is done
+    std::vector<uint8_t> data;
+    {
+        Stream mem_out(std::make_unique<VectorStream>(data, kStream_Write));
+        StartSavegame(&mem_out, descript, screenShot.get());
+        SaveGameState(&mem_out, nametouse);
+    }
+    screenShot.reset();
+    WriteSavegameAsync(std::move(out), std::move(data), slotn, nametouse);
+    // without the threads the save is already complete
+    update_savegame_writes();
+}
+
+void update_savegame_writes()
+{
+    int slot;
+    HSaveError err;
+    while (PollSavegameWrites(slot, err))
+    {
+        if (!err)
+        {
+            Debug::Printf(kDbgMsg_Error, "Failed to save the game to slot %d: %s", slot, err->FullMessage().GetCStr());
+            continue;
+        }
+        // call "After Save" event callback
+        run_on_event(GE_SAVE_GAME, RuntimeScriptValue().SetInt32(slot));
+    }
 }
 
 int gameHasBeenRestored = 0;
@@ -979,32 +1031,15 @@ int oldeip;
 
 bool read_savedgame_description(const String &savedgame, String &description)
 {
-    SavegameDescription desc;
-    HSaveError err = OpenSavegame(savedgame, desc, kSvgDesc_UserText);
-    if (!err)
-    {
-        Debug::Printf(kDbgMsg_Error, "Unable to read save's description.\n%s", err->FullMessage().GetCStr());
-        return false;
-    }
-    description = desc.UserText;
-    return true;
+    return ReadIndexedSaveDescription(savedgame, description);
 }
 
 std::unique_ptr<Bitmap> read_savedgame_screenshot(const String &savedgame)
 {
-    SavegameDescription desc;
-    HSaveError err = OpenSavegame(savedgame, desc, kSvgDesc_UserImage);
-    if (!err)
-    {
-        Debug::Printf(kDbgMsg_Error, "Unable to read save's screenshot.\n%s", err->FullMessage().GetCStr());
-        return {};
-    }
-    if (desc.UserImage)
-    {
-        desc.UserImage.reset(PrepareSpriteForUse(desc.UserImage.release(), false));
-        return std::move(desc.UserImage);
-    }
-    return {};
+    std::unique_ptr<Bitmap> image = ReadIndexedSaveImage(savedgame);
+    if (image)
+        image.reset(PrepareSpriteForUse(image.release(), false));
+    return image;
 }
 
 
@@ -1079,7 +1114,7 @@ HSaveError load_game(const String &path, int slotNumber, bool &data_overwritten)
     }
 
     // do the actual restore
-    err = RestoreGameState(src.InputStream.get(), src.Version);
+    err = RestoreGameState(src.InputStream.get(), src.Version, src.Filename);
     data_overwritten = true;
     if (!err)
         return err;
@@ -1223,7 +1258,7 @@ int __GetLocationType(int xxx,int yyy, int allowHotspot0) {
 
     data_to_game_coords(&xxx, &yyy);
 
-    int wbat = thisroom.WalkBehindMask->GetPixel(xxx, yyy);
+    int wbat = thisroom.WalkBehindMask->GetPixel8(xxx, yyy);
 
     if (wbat <= 0) wbat = 0;
     else wbat = croom->walkbehind_base[wbat];
@@ -1426,10 +1461,11 @@ void get_message_text (int msnum, char *buffer, char giveErr) {
     replace_tokens(get_translation(thisroom.Messages[msnum].GetCStr()), buffer, maxlen);
 }
 
-void game_sprite_updated(int sprnum, bool deleted)
+// Updates the game objects which reference the sprite, except the draw system
+static void notify_sprite_users(int sprnum)
 {
-    // Notify draw system about dynamic sprite change
-    notify_sprite_changed(sprnum, deleted);
+    // The sprite's collision mask has to be remade from the new pixels
+    spriteset.InvalidateSpriteMask(sprnum);
 
     // GUI still have a special draw route, so cannot rely on object caches;
     // will have to do a per-GUI and per-control check.
@@ -1458,6 +1494,26 @@ void game_sprite_updated(int sprnum, bool deleted)
             slider.MarkChanged();
         }
     }
+    // gui inventory windows
+    for (auto &inv : guiinv)
+    {
+        inv.OnSpriteUpdated(sprnum);
+    }
+    // text windows of the cached messages
+    invalidate_textual_image_cache(sprnum);
+}
+
+void game_sprite_updated(int sprnum, bool deleted)
+{
+    // Notify draw system about dynamic sprite change
+    notify_sprite_changed(sprnum, deleted);
+    notify_sprite_users(sprnum);
+}
+
+void game_sprite_updated(int sprnum, const Rect &area)
+{
+    notify_sprite_changed(sprnum, area);
+    notify_sprite_users(sprnum);
 }
 
 void precache_view(int view, int first_loop, int last_loop, bool with_sounds)
@@ -1475,28 +1531,32 @@ void precache_view(int view, int first_loop, int last_loop, bool with_sounds)
     const size_t txcache_before = texturecache_get_size();
     int total_frames = 0, total_sounds = 0;
 
-    int64_t dur_sp_load = 0, dur_tx_make = 0, dur_sound_load = 0;
+    // Load all the view's sprites at once, which lets decode them in parallel
+    std::vector<sprkey_t> sprites;
+    get_view_sprites(view, first_loop, last_loop, sprites);
+    const auto tp_sp_start = AGS_FastClock::now();
+    spriteset.PrecacheSprites(sprites);
+    int64_t dur_sp_load = ToMilliseconds(AGS_FastClock::now() - tp_sp_start);
+
+    int64_t dur_tx_make = 0, dur_sound_load = 0;
     for (int i = first_loop; i <= last_loop; ++i)
     {
         for (int j = 0; j < views[view].loops[i].numFrames; ++j, ++total_frames)
         {
             const auto &frame = views[view].loops[i].frames[j];
             const auto tp_detail1 = AGS_FastClock::now();
-            spriteset.PrecacheSprite(frame.pic);
+            texturecache_precache(frame.pic, kTexCategory_Character);
             const auto tp_detail2 = AGS_FastClock::now();
-            texturecache_precache(frame.pic);
-            const auto tp_detail3 = AGS_FastClock::now();
 
             if (with_sounds && frame.audioclip >= 0)
             {
                 ScriptAudioClip *clip = &game.audioClips[frame.audioclip];
                 auto assetpath = get_audio_clip_assetpath(clip->bundlingType, clip->fileName);
                 soundcache_precache(assetpath);
-                dur_sound_load += ToMilliseconds(AGS_FastClock::now() - tp_detail3);
+                dur_sound_load += ToMilliseconds(AGS_FastClock::now() - tp_detail2);
                 total_sounds++;
             }
-            dur_sp_load += ToMilliseconds(tp_detail2 - tp_detail1);
-            dur_tx_make += ToMilliseconds(tp_detail3 - tp_detail2);
+            dur_tx_make += ToMilliseconds(tp_detail2 - tp_detail1);
         }
     }
 
@@ -1511,6 +1571,31 @@ void precache_view(int view, int first_loop, int last_loop, bool with_sounds)
         spcache_before / 1024u, spcache_after / 1024u, txcache_before / 1024u, txcache_after / 1024u);
 }
 
+void get_view_sprites(int view, int first_loop, int last_loop, std::vector<int32_t> &sprites)
+{
+    if (view < 0 || view >= game.numviews)
+        return;
+    if (first_loop > last_loop)
+        return;
+
+    first_loop = Math::Clamp(first_loop, 0, views[view].numLoops - 1);
+    last_loop = Math::Clamp(last_loop, 0, views[view].numLoops - 1);
+    for (int i = first_loop; i <= last_loop; ++i)
+    {
+        for (int j = 0; j < views[view].loops[i].numFrames; ++j)
+            sprites.push_back(views[view].loops[i].frames[j].pic);
+    }
+}
+
+void prefetch_view(int view, int first_loop, int last_loop)
+{
+    std::vector<sprkey_t> sprites;
+    get_view_sprites(view, first_loop, last_loop, sprites);
+    spriteset.PrefetchSprites(sprites);
+    // NOTE: the textures are recategorized when attached by the room objects
+    texturecache_queue_uploads(sprites, kTexCategory_Character);
+}
+
 //=============================================================================
 //
 // Script API Functions
@@ -19,8 +19,10 @@
 #define __AGS_EE_AC__GAME_H
 
 #include <memory>
+#include <vector>
 #include "ac/dynobj/scriptviewframe.h"
 #include "main/game_file.h"
+#include "util/geometry.h"
 #include "util/string.h"
 
 // Forward declaration
@@ -161,7 +163,11 @@ bool do_save_game_dialog();
 void free_do_once_tokens();
 // Free all the memory associated with the game
 void unload_game();
+// Saves the game; the game state is captured immediately, but the file
+// is written in background, see update_savegame_writes()
 void save_game(int slotn, const char*descript);
+// Runs the "After Save" events for the savegames which were written to disk
+void update_savegame_writes();
 bool read_savedgame_description(const Common::String &savedgame, Common::String &description);
 std::unique_ptr<Common::Bitmap> read_savedgame_screenshot(const Common::String &savedgame);
 // Tries to restore saved game and displays an error on failure; if the error occured
@@ -198,8 +204,14 @@ void get_message_text (int msnum, char *buffer, char giveErr = 1);
 // Notifies the game objects that certain sprite was updated.
 // This make them update their render states, caches, and so on.
 void game_sprite_updated(int sprnum, bool deleted = false);
+// Notifies the game objects that only the given area of the sprite was updated.
+void game_sprite_updated(int sprnum, const Rect &area);
 // Precaches sprites for a view, within a selected range of loops.
 void precache_view(int view, int first_loop = 0, int last_loop = INT32_MAX, bool with_sounds = false);
+// Requests background loading of the view's sprites, ones not in cache yet
+void prefetch_view(int view, int first_loop = 0, int last_loop = INT32_MAX);
+// Appends the sprites of the view's loops to the list
+void get_view_sprites(int view, int first_loop, int last_loop, std::vector<int32_t> &sprites);
 
 // Global AssetManager instance.
 extern std::unique_ptr<AGS::Common::AssetManager> AssetMgr;
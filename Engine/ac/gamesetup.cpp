@@ -28,6 +28,7 @@ GameSetup::GameSetup()
     mouse_ctrl_when = kMouseCtrl_Fullscreen;
     mouse_ctrl_enabled = true;
     mouse_speed_def = kMouseSpeed_CurrentDisplay;
+    mouse_hw_cursor = false;
     touch_emulate_mouse = kTouchMouse_OneFingerDrag;
     touch_motion_relative = false;
     RenderAtScreenRes = false;
@@ -17,6 +17,7 @@
 #include "ac/game_version.h"
 #include "ac/sys_events.h"
 #include "main/graphics_mode.h"
+#include "util/resourcecache.h"
 #include "util/string.h"
 
 
@@ -63,6 +64,8 @@ struct GameSetup
     static const size_t DefTexCacheSize = (128 * 1024); // 128 MB
     static const size_t DefSoundLoadAtOnce = 1024; // 1 MB
     static const size_t DefSoundCache = 1024u * 32; // 32 MB
+    static const size_t DefSoundPcmCache = 1024u * 8; // 8 MB
+    static const int DefSoundPcmMaxLength = 3000; // 3 seconds
 
 
     bool  audio_enabled;
@@ -91,6 +94,8 @@ struct GameSetup
     MouseControlWhen mouse_ctrl_when;
     bool  mouse_ctrl_enabled;
     MouseSpeedDef mouse_speed_def;
+    // let the system draw the mouse cursor, instead of the renderer
+    bool  mouse_hw_cursor;
     // touch-to-mouse emulation mode (how the touches are handled overall)
     TouchMouseEmulation touch_emulate_mouse;
     // touch control abs/relative mode
@@ -99,13 +104,57 @@ struct GameSetup
     bool  RenderAtScreenRes; // render sprites at screen resolution, as opposed to native one
     size_t SpriteCacheSize = DefSpriteCacheSize; // in KB
     size_t TextureCacheSize = DefTexCacheSize; // in KB
+    int   TextureVramBudget = 66; // max share of the reported video memory for the texture cache, in %, 0 = don't limit
+    int   TextureUploadTime = 2; // time per frame for creating the textures ahead of their use, in ms, 0 = disabled
+    size_t MemoryBudget = 0u; // total limit of the resource caches and other data, in KB, 0 = none
+    bool  SpriteCacheIndexed = false; // keep the indexed sprites in cache without expanding
+    bool  CompactOpaqueTextures = false; // store opaque textures in a 16-bit format
+    bool  TextureAtlas = false; // place small textures together on shared atlas textures
+    bool  SpriteStateSorting = false; // reorder non-overlapping sprites by texture and blend mode
+    bool  IdleFrameSkip = false; // don't render frames which are same as the last one
+    int   SoftwareRenderThreads = 0; // threads compositing sprites in software renderer, 0 = auto
+    int   SpritePrepareThreads = 0; // threads preparing object images in software mode, 0 = auto
+    int   JobThreads = 0; // threads running the engine's parallel jobs, including the main one, 0 = auto
+    bool  DirtyTiles = false; // track dirty regions in software renderer using a tile grid
+    bool  FramePacing = false; // wait for the next frame precisely, finishing with a spin
+    bool  FrameInterpolation = false; // render extra frames between the game ticks, interpolating the movement
+    AGS::Common::ResourceCachePolicy SpriteCachePolicy = AGS::Common::kCachePolicy_LRU;
+    AGS::Common::ResourceCachePolicy TextureCachePolicy = AGS::Common::kCachePolicy_LRU;
     size_t SoundLoadAtOnceSize = DefSoundLoadAtOnce; // threshold for loading sounds immediately, in KB
     size_t SoundCacheSize = DefSoundCache; // sound cache limit, in KB
+    size_t SoundPcmCacheSize = DefSoundPcmCache; // decoded sound cache limit, in KB
+    int   SoundPcmMaxLength = DefSoundPcmMaxLength; // max duration of a sound in the decoded cache, in ms
+    int   SoundBufferCount = 2; // number of sound buffers queued for output by each sound
+    size_t SoundBufferSize = 64; // size of the sound data decoded at once, in KB
+    int   SoundPollInterval = 50; // max interval between the audio thread's polls, in ms
+    bool  SoundHighPriority = false; // run the audio thread with a higher priority
+    int   SoundMaxVoices = 0; // max number of real (decoded) playing sounds, 0 = unlimited
+    int   SoundDecodeThreads = 0; // threads decoding the sounds ahead of output, 0 = auto
     bool  clear_cache_on_room_change; // for low-end devices: clear resource caches on room change
     bool  load_latest_save; // load latest saved game on launch
     ScreenRotation rotation;
     bool  show_fps;
+    String script_profile_path; // optional path to write script profiler reports to
+    int   script_profile_interval = 1; // script profiler's call stack sampling interval, in ms
+    String asset_trace_path; // optional path to write the assets' first use trace to
+    String render_trace_path; // optional path to write the per-frame render timing to
+    String event_trace_path; // optional path to write the engine event trace to
+    uint32_t benchmark_ticks = 0u; // run the game for this number of ticks as fast as possible, and quit
+    String benchmark_out_path; // optional path to write the benchmark's per-tick timing to
+    String benchmark_baseline_path; // optional path to the earlier benchmark's timing, to compare with
+    String video_capture_path; // optional path to record the rendered frames to
+    bool  video_capture_uncapped = false; // run the game as fast as possible while capturing
+    String input_record_path; // optional path to record the player input to
+    String input_replay_path; // optional path to replay the recorded player input from
+    int   cache_stats_interval = 0; // period of logging the resource cache stats, in seconds
+    bool  StartupProfile = false; // log the time taken by each engine startup stage
     bool  multitasking = false; // whether run on background, when game is switched out
+    bool  HierarchicalPathfinder = false; // find routes through the map sectors first
+    bool  AsyncPathfinder = false; // find routes for the non-blocking walks on a worker thread
+    bool  RoomPreload = false; // preload the rooms predicted by the exits used before
+    bool  CompressSaves = false; // compress the saved game components
+    int   DeltaSaves = 0; // number of delta saves to make after each full save to a slot
+    bool  ScriptJit = false; // compile the frequently called script functions to native code
 
     DisplayModeSetup Screen;
     String software_render_driver;
@@ -35,6 +35,7 @@ using namespace AGS::Common;
 extern GameSetupStruct game;
 extern RoomStruct thisroom;
 extern std::vector<SpeechLipSyncLine> splipsync;
+extern SpeechLipSyncIndex splipsync_index;
 extern int numLipLines, curLipLine, curLipLinePhoneme;
 
 void StopAmbientSound (int channel) {
@@ -471,26 +472,48 @@ String get_cue_filename(int charid, int sndid)
     return String::FromFormat("%s%s%d", asset_path.GetCStr(), script_name.GetCStr(), sndid);
 }
 
-// Play voice-over clip on the common channel;
+// Number of the character's following voice lines to precache when
+// the speech starts; the voice numbers are usually given in the order
+// of the lines, so the next lines are likely to be spoken soon
+static const int VoicePrecacheLines = 3;
+
+// Finds the voice-over clip's asset;
 // voice_name should be bare clip name without extension
-static bool play_voice_clip_on_channel(const String &voice_name)
+static bool find_voice_clip_asset(const String &voice_name, AssetPath &apath)
 {
-    stop_and_destroy_channel(SCHAN_SPEECH);
-
     // TODO: perhaps a better algorithm, allow any extension / sound format?
     // e.g. make a hashmap matching a voice name to a asset name
     std::array<const char*, 3> exts = {{ "mp3", "ogg", "wav" }};
-    AssetPath apath = get_voice_over_assetpath(voice_name);
-    bool found = false;
+    apath = get_voice_over_assetpath(voice_name);
     for (auto *ext : exts)
     {
         apath.Name.Format("%s.%s", voice_name.GetCStr(), ext);
-        found = AssetMgr->DoesAssetExist(apath);
-        if (found)
-            break;
+        if (AssetMgr->DoesAssetExist(apath))
+            return true;
     }
+    return false;
+}
+
+// Requests the character's voice lines following the given one
+// to be read into the sound cache in the background
+static void precache_next_voice_lines(int charid, int sndid)
+{
+    for (int i = 1; i <= VoicePrecacheLines; ++i)
+    {
+        AssetPath apath;
+        if (find_voice_clip_asset(get_cue_filename(charid, sndid + i), apath))
+            soundcache_precache(apath);
+    }
+}
 
-    if (!found) {
+// Play voice-over clip on the common channel;
+// voice_name should be bare clip name without extension
+static bool play_voice_clip_on_channel(const String &voice_name)
+{
+    stop_and_destroy_channel(SCHAN_SPEECH);
+
+    AssetPath apath;
+    if (!find_voice_clip_asset(voice_name, apath)) {
         debug_script_warn("Speech file not found: '%s'", voice_name.GetCStr());
         return false;
     }
@@ -556,15 +579,10 @@ bool play_voice_speech(int charid, int sndid)
     if (!play_voice_clip_impl(voice_file, true, true))
         return false;
 
-    int ii;  // Compare the base file name to the .pam file name
-    curLipLine = -1;  // See if we have voice lip sync for this line
+    // See if we have voice lip sync for this line
     curLipLinePhoneme = -1;
-    for (ii = 0; ii < numLipLines; ii++) {
-        if (voice_file.CompareNoCase(splipsync[ii].filename) == 0) {
-            curLipLine = ii;
-            break;
-        }
-    }
+    const auto lip_it = splipsync_index.find(voice_file);
+    curLipLine = (lip_it != splipsync_index.end()) ? lip_it->second : -1;
     // if the lip-sync is being used for voice sync, disable
     // the text-related lipsync
     if (numLipLines > 0)
@@ -576,6 +594,8 @@ bool play_voice_speech(int charid, int sndid)
         game.options[OPT_SPEECHTYPE] = 1;
         play.no_textbg_when_voice = 2;
     }
+
+    precache_next_voice_lines(charid, sndid);
     return true;
 }
 
@@ -589,7 +609,10 @@ bool play_voice_nonblocking(int charid, int sndid, bool as_speech)
         return false;
 
     String voice_file = get_cue_filename(charid, sndid);
-    return play_voice_clip_impl(voice_file, as_speech, false);
+    if (!play_voice_clip_impl(voice_file, as_speech, false))
+        return false;
+    precache_next_voice_lines(charid, sndid);
+    return true;
 }
 
 void stop_voice_speech()
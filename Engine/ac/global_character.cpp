@@ -37,6 +37,7 @@
 #include "debug/debug_log.h"
 #include "game/roomstruct.h"
 #include "main/game_run.h"
+#include "main/update.h"
 #include "script/script.h"
 
 using namespace AGS::Common;
@@ -551,11 +552,11 @@ int DisplaySpeechBackground(int charid, const char*speel) {
     // remove any previous background speech for this character
     // TODO: have a map character -> bg speech over?
     const auto &overs = get_overlays();
-    for (size_t i = 0; i < overs.size(); ++i)
+    for (int type : get_overlay_ids())
     {
-        if (overs[i].bgSpeechForChar == charid)
+        if (overs[type].bgSpeechForChar == charid)
         {
-            remove_screen_overlay(i);
+            remove_screen_overlay(type);
             break;
         }
     }
@@ -566,5 +567,6 @@ int DisplaySpeechBackground(int charid, const char*speel) {
     auto *over = get_overlay(ovrl);
     over->bgSpeechForChar = charid;
     over->timeout = GetTextDisplayTime(speel, 1);
+    schedule_overlay_timer(ovrl);
     return ovrl;
 }
@@ -11,6 +11,7 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <inttypes.h>
 #include "ac/global_debug.h"
 #include "ac/common.h"
 #include "ac/characterinfo.h"
@@ -26,8 +27,10 @@
 #include "ac/sys_events.h"
 #include "ac/translation.h"
 #include "ac/walkablearea.h"
+#include "ac/dynobj/dynobj_manager.h"
 #include "gfx/gfxfilter.h"
 #include "gui/guidialog.h"
+#include "gui/guimain.h"
 #include "script/cc_common.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
@@ -37,6 +40,7 @@
 #include "gfx/bitmap.h"
 #include "gfx/graphicsdriver.h"
 #include "main/graphics_mode.h"
+#include "util/memory_budget.h"
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
@@ -52,6 +56,58 @@ extern int displayed_room, starting_room;
 RoomAreaMask debugLastRoomMask = kRoomAreaNone;
 int debugLastMoveChar = -1;
 
+// Returns the percent of the cache requests which found the item
+static unsigned GetHitRate(uint64_t hits, uint64_t misses)
+{
+    return (hits + misses) > 0 ? static_cast<unsigned>(hits * 100 / (hits + misses)) : 0;
+}
+
+// Prints the cache stats, followed by the load time histogram
+static void PrintCacheStats(String &out, const char *name, const ResourceCacheStats &stats)
+{
+    out.AppendFmt("%s: hits %" PRIu64 ", misses %" PRIu64 " (%u%% hits), evictions %" PRIu64
+        ", loaded %" PRIu64 " (%" PRIu64 " KB)\n  load time (ms):",
+        name, stats.Hits, stats.Misses, GetHitRate(stats.Hits, stats.Misses), stats.Evictions,
+        stats.Loads, stats.LoadedSize / 1024u);
+    for (size_t i = 0; i < ResourceCacheStats::LoadTimeBucketCount; ++i)
+    {
+        if (i < ResourceCacheStats::LoadTimeBucketCount - 1)
+            out.AppendFmt(" <%.2f: %u", ResourceCacheStats::GetLoadTimeBound(i) / 1000.f, stats.LoadTime[i]);
+        else
+            out.AppendFmt(" more: %u", stats.LoadTime[i]);
+    }
+}
+
+String GetCacheStats()
+{
+    String stats;
+    PrintCacheStats(stats, "Sprite cache", spriteset.GetStats());
+    stats.AppendChar('\n');
+    PrintCacheStats(stats, "Texture cache", texturecache_get_stats());
+    const auto tx_sizes = texturecache_get_category_sizes();
+    stats.AppendFmt("\nTextures KB: room %zu, characters %zu, GUI %zu, dynamic %zu",
+        tx_sizes[kTexCategory_Room] / 1024, tx_sizes[kTexCategory_Character] / 1024,
+        tx_sizes[kTexCategory_GUI] / 1024, tx_sizes[kTexCategory_Dynamic] / 1024);
+    const RenderStats rstats = gfxDriver->GetRenderStats();
+    stats.AppendFmt("\nLast frame: sprites %u, draw calls %u, uploaded KB %llu, GPU time %.2f ms",
+        rstats.Sprites, rstats.DrawCalls, static_cast<unsigned long long>(rstats.UploadBytes / 1024),
+        rstats.GpuTimeUs / 1000.f);
+    const RenderStageTimes &times = get_render_stage_times();
+    stats.AppendFmt("\nLast frame CPU ms: overlays %.2f, room %.2f, ui %.2f, render %.2f",
+        times.Overlays / 1000.f, times.Room / 1000.f, times.UI / 1000.f, times.Render / 1000.f);
+    for (size_t i = 0; i < times.Viewports.size(); ++i)
+        stats.AppendFmt("%s%.2f", i == 0 ? "; viewports: " : ", ", times.Viewports[i] / 1000.f);
+    const SpriteSortStats &sorts = get_sprite_sort_stats();
+    stats.AppendFmt("\nLast frame sorting: sprites %u, moves %u, incremental %u, full %u",
+        sorts.Sprites, sorts.Moves, sorts.IncrementalSorts, sorts.FullSorts);
+    const GuiHitTestStats &hits = GUI::HitTestStats;
+    stats.AppendFmt("\nGUI control lookups: %u, controls tested %u, skipped %u",
+        hits.Queries, hits.Tested, hits.Skipped);
+    stats.AppendChar('\n');
+    stats.Append(MemoryBudget::GetReport());
+    return stats;
+}
+
 String GetRuntimeInfo()
 {
     DisplayMode mode = gfxDriver->GetDisplayMode();
@@ -65,12 +121,13 @@ String GetRuntimeInfo()
     size_t max_txcached, total_txcached, total_txlocked, total_txext;
     texturecache_get_state(max_txcached, total_txcached, total_txlocked, total_txext);
     const unsigned tx_filled = max_txcached > 0 ? (uint64_t)total_txcached * 100 / max_txcached : 0;
+    const auto &tx_stats = texturecache_get_stats();
     String runtimeInfo = String::FromFormat(
         "%s\nEngine version %s\n"
         "Game resolution %d x %d (%d-bit)\n"
         "Running %d x %d at %d-bit%s\nGFX: %s; %s\nDraw frame %d x %d\n"
-        "Sprite cache KB: %zu / %zu (%u%%), locked: %zu, ext: %zu\n"
-        "Texture cache KB: %zu / %zu (%u%%)",
+        "Sprite cache KB: %zu / %zu (%u%%), locked: %zu, ext: %zu, hits: %u%%\n"
+        "Texture cache KB: %zu / %zu (%u%%), hits: %u%%",
         get_engine_name(),
         get_engine_version_and_build().GetCStr(),
         game.GetGameRes().Width, game.GetGameRes().Height, game.GetColorDepth(),
@@ -79,12 +136,13 @@ String GetRuntimeInfo()
         gfxDriver->GetDriverName(), filter->GetInfo().Name.GetCStr(),
         render_frame.GetWidth(), render_frame.GetHeight(),
         total_normspr / 1024, max_normspr / 1024, norm_spr_filled, total_lockspr / 1024, total_extspr / 1024,
-        total_txcached / 1024, max_txcached / 1024, tx_filled);
+        GetHitRate(spriteset.GetHitCount(), spriteset.GetMissCount()),
+        total_txcached / 1024, max_txcached / 1024, tx_filled, GetHitRate(tx_stats.Hits, tx_stats.Misses));
     if (play.separate_music_lib)
         runtimeInfo.Append("[AUDIO.VOX enabled");
     if (play.voice_avail)
         runtimeInfo.Append("[SPEECH.VOX enabled");
-    if (get_translation_tree().size() > 0) {
+    if (has_translation_texts()) {
         runtimeInfo.Append("[Using translation ");
         runtimeInfo.Append(get_translation_name());
     }
@@ -145,6 +203,11 @@ void script_debug(int cmdd,int dataa) {
         debugLastMoveChar = dataa == debugLastMoveChar ? -1 : dataa;
         debug_draw_movelist(dataa);
     }
+    else if (cmdd == 6) {
+        // show managed objects statistics on screen, and print them to the log
+        display_managed_stats = dataa != 0;
+        Debug::Printf(kDbgGroup_ManObj, kDbgMsg_Info, "%s", ccGetManagedObjectsReport().GetCStr());
+    }
     else if (cmdd == 99)
         ccSetOption(SCOPT_DEBUGRUN, dataa);
     else quit("!Debug: unknown command code");
@@ -22,6 +22,8 @@
 #include "util/string.h"
 
 AGS::Common::String GetRuntimeInfo();
+// Formats the sprite and texture cache use statistics
+AGS::Common::String GetCacheStats();
 void script_debug(int cmdd,int dataa);
 
 #endif // __AGS_EE_AC__GLOBALDEBUG_H
@@ -20,6 +20,7 @@
 #include "ac/gamestate.h"
 #include "ac/global_drawingsurface.h"
 #include "ac/global_translation.h"
+#include "ac/room.h"
 #include "ac/string.h"
 #include "debug/debug_log.h"
 #include "font/fonts.h"
@@ -83,6 +84,7 @@ void RawDrawFrameTransparent (int frame, int translev) {
         (translev < 0) || (translev > 99))
         quit("!RawDrawFrameTransparent: invalid parameter (transparency must be 0-99, frame a valid BG frame)");
 
+    ensure_room_bg_frame(frame);
     PBitmap bg = thisroom.BgFrames[frame].Graphic;
     if (bg->GetColorDepth() <= 8)
         quit("!RawDrawFrameTransparent: 256-colour backgrounds not supported");
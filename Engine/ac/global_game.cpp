@@ -45,6 +45,8 @@
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
 #include "font/fonts.h"
+#include "game/savegame.h"
+#include "game/savegame_index.h"
 #include "gui/guidialog.h"
 #include "main/engine.h"
 #include "main/game_start.h"
@@ -123,7 +125,10 @@ void RestoreGameSlot(int slnum) {
 void DeleteSaveSlot (int slnum) {
     String nametouse;
     nametouse = get_save_game_path(slnum);
+    WaitSavegameWrites();
     File::DeleteFile(nametouse);
+    DeleteDeltaSave(nametouse);
+    InvalidateSaveIndex(nametouse);
     if ((slnum >= 1) && (slnum <= MAXSAVEGAMES)) {
         String thisname;
         for (int i = MAXSAVEGAMES; i > slnum; i--) {
@@ -131,6 +136,8 @@ void DeleteSaveSlot (int slnum) {
             if (Common::File::IsFile(thisname)) {
                 // Rename the highest save game to fill in the gap
                 File::RenameFile(thisname, nametouse);
+                RenameDeltaSave(thisname, nametouse);
+                InvalidateSaveIndex(thisname);
                 break;
             }
         }
@@ -218,6 +225,8 @@ void FillSaveList(std::vector<SaveListItem> &saves, unsigned top_index, size_t m
         if (saves.size() >= max_count)
             break;
     }
+    // keep the descriptions read from the save files for the next time
+    FlushSaveIndex();
 }
 
 int GetLastSaveSlot()
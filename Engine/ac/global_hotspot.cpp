@@ -24,6 +24,7 @@
 #include "ac/global_translation.h"
 #include "ac/hotspot.h"
 #include "ac/properties.h"
+#include "ac/room_preload.h"
 #include "ac/roomstatus.h"
 #include "ac/string.h"
 #include "ac/dynobj/cc_hotspot.h"
@@ -109,6 +110,9 @@ void RunHotspotInteraction (int hotspothere, int mood) {
     }
     const int anyclick_evt = 5; // TODO: make global constant (hotspot any-click evt)
 
+    // The hotspot may lead to another room
+    room_preload_on_hotspot(hotspothere);
+
     // For USE verb: remember active inventory
     if (mood == MODE_USE)
     {
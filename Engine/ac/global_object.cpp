@@ -29,6 +29,7 @@
 #include "ac/properties.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
+#include "ac/route_finder.h"
 #include "ac/string.h"
 #include "ac/viewframe.h"
 #include "ac/dynobj/cc_object.h"
@@ -81,6 +82,10 @@ int GetObjectIDAtRoom(int roomx, int roomy)
         int isflipped = 0;
         int spWidth = game_to_data_coord(objs[aa].get_width());
         int spHeight = game_to_data_coord(objs[aa].get_height());
+        // test the bounding box before getting the image, which may be costly
+        if ((spWidth > 0) && (spHeight > 0) &&
+            !isposinbox(roomx, roomy, xxx, yyy - spHeight, xxx + spWidth, yyy))
+            continue;
         if (objs[aa].view != RoomObject::NoView)
             isflipped = views[objs[aa].view].loops[objs[aa].loop].frames[objs[aa].frame].flags & VFLG_FLIPSPRITE;
 
@@ -250,6 +255,9 @@ void AnimateObjectImpl(int obn, int loopn, int spdd, int rept, int direction, in
     debug_script_log("Obj %d start anim view %d loop %d, speed %d, repeat %d, frame %d",
         obn, obj.view + 1, loopn, spdd, rept, sframe);
 
+    // start loading the rest of the animation frames in background
+    prefetch_view(obj.view, loopn, loopn);
+
     obj.set_animating(rept, direction == 0, spdd);
     obj.loop = (uint16_t)loopn;
     obj.frame = (uint16_t)SetFirstAnimFrame(obj.view, loopn, sframe, direction);
@@ -314,6 +322,7 @@ void MergeObject(int obn) {
 void StopObjectMoving(int objj) {
     if (!is_valid_object(objj))
         quit("!StopObjectMoving: invalid object number");
+    cancel_route(objj + 1);
     objs[objj].moving = 0;
 
     debug_script_log("Object %d stop moving", objj);
@@ -379,6 +388,7 @@ int IsObjectAnimating(int objj) {
 
 int IsObjectMoving(int objj) {
     if (!is_valid_object(objj)) quit("!IsObjectMoving: invalid object number");
+    complete_object_move(objj);
     return (objs[objj].moving > 0) ? 1 : 0;
 }
 
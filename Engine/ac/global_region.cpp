@@ -32,31 +32,49 @@ extern RoomStatus*croom;
 extern ScriptRegion scrRegion[MAX_ROOM_REGIONS];
 extern CCRegion ccDynamicRegion;
 
-int GetRegionIDAtRoom(int xxx, int yyy) {
-    // if the co-ordinates are off the edge of the screen,
-    // correct them to be just within
-    // this fixes walk-off-screen problems
+// Gets the enabled region ID at the given room coordinates, looked up in the mask
+static inline int GetRegionIDAtMask(const Bitmap *mask, int xxx, int yyy, bool clamp) {
     xxx = room_to_mask_coord(xxx);
     yyy = room_to_mask_coord(yyy);
 
-    if (loaded_game_file_version >= kGameVersion_262) // Version 2.6.2+
+    if (clamp)
     {
-        if (xxx >= thisroom.RegionMask->GetWidth())
-            xxx = thisroom.RegionMask->GetWidth() - 1;
-        if (yyy >= thisroom.RegionMask->GetHeight())
-            yyy = thisroom.RegionMask->GetHeight() - 1;
+        if (xxx >= mask->GetWidth())
+            xxx = mask->GetWidth() - 1;
+        if (yyy >= mask->GetHeight())
+            yyy = mask->GetHeight() - 1;
         if (xxx < 0)
             xxx = 0;
         if (yyy < 0)
             yyy = 0;
     }
 
-    int hsthere = thisroom.RegionMask->GetPixel (xxx, yyy);
+    int hsthere = mask->GetPixel8(xxx, yyy);
     if (hsthere <= 0 || hsthere >= MAX_ROOM_REGIONS) return 0;
     if (croom->region_enabled[hsthere] == 0) return 0;
     return hsthere;
 }
 
+int GetRegionIDAtRoom(int xxx, int yyy) {
+    // if the co-ordinates are off the edge of the screen,
+    // correct them to be just within
+    // this fixes walk-off-screen problems
+    return GetRegionIDAtMask(thisroom.RegionMask.get(), xxx, yyy,
+        loaded_game_file_version >= kGameVersion_262); // Version 2.6.2+
+}
+
+int GetFirstRegionIDAtRoom(const Point *pts, size_t count) {
+    const Bitmap *mask = thisroom.RegionMask.get();
+    const bool clamp = loaded_game_file_version >= kGameVersion_262;
+    for (size_t i = 0; i < count; ++i)
+    {
+        int region = GetRegionIDAtMask(mask, pts[i].X, pts[i].Y, clamp);
+        if (region > 0)
+            return region;
+    }
+    return 0;
+}
+
 void SetAreaLightLevel(int area, int brightness) {
     if ((area < 0) || (area > MAX_ROOM_REGIONS))
         quit("!SetAreaLightLevel: invalid region");
@@ -18,9 +18,14 @@
 #ifndef __AGS_EE_AC__GLOBALREGION_H
 #define __AGS_EE_AC__GLOBALREGION_H
 
+#include "util/geometry.h"
+
 // Gets region ID at the given room coordinates;
 // if region is disabled or non-existing, returns 0 (no area)
 int  GetRegionIDAtRoom(int xxx, int yyy);
+// Gets the first region ID found at the given list of room coordinates;
+// returns 0 if there's no enabled region at any of them
+int  GetFirstRegionIDAtRoom(const Point *pts, size_t count);
 void SetAreaLightLevel(int area, int brightness);
 void SetRegionTint (int area, int red, int green, int blue, int amount, int luminance = 100);
 void DisableRegion(int hsnum);
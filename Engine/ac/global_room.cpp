@@ -164,6 +164,7 @@ void ResetRoom(int nrnum) {
         roomstat->FreeScriptData();
         roomstat->FreeProperties();
         roomstat->beenhere = 0;
+        packRoomStatus(nrnum);
     }
 
     debug_script_log("Room %d reset to original state", nrnum);
@@ -172,10 +173,7 @@ void ResetRoom(int nrnum) {
 int HasPlayerBeenInRoom(int roomnum) {
     if ((roomnum < 0) || (roomnum >= MAX_ROOMS))
         return 0;
-    if (isRoomStatusValid(roomnum))
-        return getRoomStatus(roomnum)->beenhere;
-    else
-        return 0;
+    return getRoomStatusBeenHere(roomnum);
 }
 
 void CallRoomScript (int value) {
@@ -193,10 +191,7 @@ int HasBeenToRoom (int roomnum) {
     if ((roomnum < 0) || (roomnum >= MAX_ROOMS))
         quit("!HasBeenToRoom: invalid room number specified");
 
-    if (isRoomStatusValid(roomnum))
-        return getRoomStatus(roomnum)->beenhere;
-    else
-        return 0;
+    return getRoomStatusBeenHere(roomnum);
 }
 
 void GetRoomPropertyText (const char *property, char *bufer)
@@ -15,12 +15,14 @@
 #include "ac/runtime_defines.h"
 #include "ac/common.h"
 #include "ac/gamestate.h"
+#include "main/update.h"
 
 
 void script_SetTimer(int tnum,int timeout) {
     if ((tnum < 1) || (tnum >= MAX_TIMERS))
         quit("!StartTimer: invalid timer number");
     play.script_timers[tnum] = timeout;
+    schedule_script_timer(tnum, timeout);
 }
 
 int IsTimerExpired(int tnum) {
@@ -43,16 +43,15 @@ const char *get_translation (const char *text) {
     }
 #endif
 
-    const auto &transtree = get_translation_tree();
-    const auto it = transtree.find(String::Wrapper(text));
-    if (it != transtree.end())
-        return it->second.GetCStr();
+    const char *translated = find_translation(text);
+    if (translated)
+        return translated;
     // return the original text
     return text;
 }
 
 int IsTranslationAvailable () {
-    if (get_translation_tree().size() > 0)
+    if (has_translation_texts())
         return 1;
     return 0;
 }
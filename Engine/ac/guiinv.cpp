@@ -11,6 +11,8 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
+#include <stdlib.h>
 #include "gui/guiinv.h"
 #include "gui/guimain.h"
 #include "ac/draw.h"
@@ -22,6 +24,7 @@
 
 
 extern GameSetupStruct game;
+extern AGS::Common::SpriteCache spriteset;
 
 
 namespace AGS
@@ -62,33 +65,120 @@ void GUIInvWindow::Draw(Bitmap *ds, int x, int y)
         TopItem = play.inv_top;
 
     // draw the items
-    const int leftmost_x = x;
-    int at_x = x;
-    int at_y = y;
+    const int cell_w = data_to_game_coord(ItemWidth);
+    const int cell_h = data_to_game_coord(ItemHeight);
     int lastItem = TopItem + (ColCount * RowCount);
     if (lastItem > charextra[GetCharacterId()].invorder_count)
         lastItem = charextra[GetCharacterId()].invorder_count;
 
-    for (int item = TopItem; item < lastItem; ++item)
+    if (CanUseCellCache(cell_w, cell_h, lastItem))
+    {
+        UpdateCellCache(ds->GetColorDepth(), cell_w, cell_h, lastItem);
+        draw_gui_sprite(ds, true, x, y, _cellCache.get(), true, kBlendMode_Alpha, 0xFF);
+    }
+    else
+    {
+        _cellCache.reset();
+        _cellPics.clear();
+        DrawItems(ds, x, y, cell_w, cell_h, lastItem);
+    }
+
+    if (!enabled &&
+        GUI::Options.DisabledStyle == kGuiDis_Greyout &&
+        play.inventory_greys_out == 1)
+    {
+        // darken the inventory when disabled
+        GUI::DrawDisabledEffect(ds, RectWH(x, y, _width, _height));
+    }
+}
+
+void GUIInvWindow::DrawItems(Bitmap *ds, int x, int y, int cell_w, int cell_h, int last_item)
+{
+    const int leftmost_x = x;
+    int at_x = x;
+    int at_y = y;
+    for (int item = TopItem; item < last_item; ++item)
     {
         // draw inv graphic
         draw_gui_sprite(ds, game.invinfo[charextra[GetCharacterId()].invorder[item]].pic, at_x, at_y, true);
-        at_x += data_to_game_coord(ItemWidth);
+        at_x += cell_w;
 
         // go to next row when appropriate
         if ((item - TopItem) % ColCount == (ColCount - 1))
         {
             at_x = leftmost_x;
-            at_y += data_to_game_coord(ItemHeight);
+            at_y += cell_h;
         }
     }
+}
 
-    if (!enabled &&
-        GUI::Options.DisabledStyle == kGuiDis_Greyout &&
-        play.inventory_greys_out == 1)
+bool GUIInvWindow::CanUseCellCache(int cell_w, int cell_h, int last_item) const
+{
+    if ((cell_w <= 0) || (cell_h <= 0) || (ColCount <= 0) || (RowCount <= 0))
+        return false;
+    // Only the "proper" alpha blending gives the same result when the items
+    // are first drawn on a transparent surface, and that surface is drawn after
+    if ((game.GetColorDepth() == 32) && (game.options[OPT_NEWGUIALPHA] != kGuiAlphaRender_Proper))
+        return false;
+    // Items larger than a cell overlap their neighbours, so cannot be redrawn separately
+    for (int item = TopItem; item < last_item; ++item)
     {
-        // darken the inventory when disabled
-        GUI::DrawDisabledEffect(ds, RectWH(x, y, _width, _height));
+        const int pic = game.invinfo[charextra[GetCharacterId()].invorder[item]].pic;
+        if (!spriteset.DoesSpriteExist(pic) ||
+            (game.SpriteInfos[pic].Width > cell_w) || (game.SpriteInfos[pic].Height > cell_h))
+            return false;
+    }
+    return true;
+}
+
+void GUIInvWindow::UpdateCellCache(int color_depth, int cell_w, int cell_h, int last_item)
+{
+    const int cell_count = ColCount * RowCount;
+    if (!_cellCache || (_cellCache->GetColorDepth() != color_depth) ||
+        (_cellCacheW != cell_w) || (_cellCacheH != cell_h) ||
+        (_cellCache->GetWidth() != ColCount * cell_w) || (_cellCache->GetHeight() != RowCount * cell_h))
+    {
+        _cellCache.reset(BitmapHelper::CreateTransparentBitmap(ColCount * cell_w, RowCount * cell_h, color_depth));
+        _cellPics.assign(cell_count, -1);
+        _cellCacheW = cell_w;
+        _cellCacheH = cell_h;
+    }
+    else if ((RowCount > 1) && (abs(TopItem - _cellCacheTop) == ColCount))
+    {
+        // Scrolled by one row: shift the cached image, and only the newly
+        // revealed row will have to be drawn
+        const int move_h = (RowCount - 1) * cell_h;
+        if (TopItem > _cellCacheTop)
+        {
+            _cellCache->Blit(_cellCache.get(), 0, cell_h, 0, 0, _cellCache->GetWidth(), move_h);
+            std::copy(_cellPics.begin() + ColCount, _cellPics.end(), _cellPics.begin());
+            std::fill(_cellPics.end() - ColCount, _cellPics.end(), -2);
+        }
+        else
+        {
+            _cellCache->Blit(_cellCache.get(), 0, 0, 0, cell_h, _cellCache->GetWidth(), move_h);
+            std::copy_backward(_cellPics.begin(), _cellPics.end() - ColCount, _cellPics.end());
+            std::fill(_cellPics.begin(), _cellPics.begin() + ColCount, -2);
+        }
+    }
+    _cellCacheTop = TopItem;
+
+    // Redraw the cells which items have changed; -2 marks the cell with
+    // unknown contents, which has to be cleared even if it stays empty
+    const color_t mask_color = _cellCache->GetMaskColor();
+    for (int cell = 0; cell < cell_count; ++cell)
+    {
+        const int item = TopItem + cell;
+        const int pic = (item < last_item) ?
+            game.invinfo[charextra[GetCharacterId()].invorder[item]].pic : -1;
+        if (_cellPics[cell] == pic)
+            continue;
+        const int at_x = (cell % ColCount) * cell_w;
+        const int at_y = (cell / ColCount) * cell_h;
+        _cellCache->FillRect(RectWH(at_x, at_y, cell_w, cell_h), mask_color);
+        if (pic >= 0)
+            draw_gui_sprite(_cellCache.get(), pic, at_x, at_y, true);
+        _cellPics[cell] = pic;
     }
 }
 
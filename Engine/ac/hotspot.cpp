@@ -136,7 +136,7 @@ bool Hotspot_SetTextProperty(ScriptHotspot *hss, const char *property, const cha
 }
 
 int get_hotspot_at(int xpp,int ypp) {
-    int onhs=thisroom.HotspotMask->GetPixel(room_to_mask_coord(xpp), room_to_mask_coord(ypp));
+    int onhs=thisroom.HotspotMask->GetPixel8(room_to_mask_coord(xpp), room_to_mask_coord(ypp));
     if (onhs <= 0 || onhs >= MAX_ROOM_HOTSPOTS) return 0;
     if (!croom->hotspot[onhs].Enabled) return 0;
     return onhs;
@@ -14,7 +14,9 @@
 #ifndef __AC_LIPSYNC_H
 #define __AC_LIPSYNC_H
 
+#include <unordered_map>
 #include <vector>
+#include "util/string_types.h"
 
 struct SpeechLipSyncLine {
     char  filename[14];
@@ -23,4 +25,8 @@ struct SpeechLipSyncLine {
     short numPhonemes;
 };
 
+// Index of the lip sync lines, by the voice file name (case-insensitive)
+typedef std::unordered_map<AGS::Common::String, int,
+    AGS::Common::HashStrNoCase, AGS::Common::StrEqNoCase> SpeechLipSyncIndex;
+
 #endif // __AC_LIPSYNC_H
\ No newline at end of file
@@ -23,6 +23,7 @@
 #include "ac/gui.h"
 #include "ac/path_helper.h"
 #include "ac/string.h"
+#include "ac/dynobj/cc_dynamicarray.h"
 #include "core/assetmanager.h"
 #include "debug/debug_log.h"
 #include "util/directory.h"
@@ -40,6 +41,16 @@ int ListBox_AddItem(GUIListBox *lbb, const char *text) {
   return 1;
 }
 
+void ListBox_AddItems(GUIListBox *lbb, void *items_arr) {
+  if (!items_arr) {
+    debug_script_warn("ListBox.AddItems: null array passed");
+    return;
+  }
+  std::vector<String> items;
+  DynamicArrayHelpers::ReadStringArray(items_arr, items);
+  lbb->AddItems(items);
+}
+
 int ListBox_InsertItemAt(GUIListBox *lbb, int index, const char *text) {
   if (lbb->InsertItem(index, text) < 0)
     return 0;
@@ -82,11 +93,7 @@ void ListBox_FillDirList(GUIListBox *listbox, const char *filemask) {
     files.erase(std::unique(files.begin(), files.end(), StrEqNoCase()), files.end());
   }
 
-  // TODO: method for adding item batch to speed up update
-  for (auto it = files.cbegin(); it != files.cend(); ++it)
-  {
-    listbox->AddItem(*it);
-  }
+  listbox->AddItems(files);
 }
 
 int ListBox_GetSaveGameSlots(GUIListBox *listbox, int index) {
@@ -104,11 +111,14 @@ int ListBox_FillSaveGameList(GUIListBox *listbox) {
 
   // fill in the list box
   listbox->Clear();
-  // TODO: method for adding item batch to speed up update
+  std::vector<String> descs;
+  descs.reserve(saves.size());
   for (const auto &item : saves)
+    descs.push_back(item.Description);
+  listbox->AddItems(descs);
+  for (size_t n = 0; n < saves.size(); ++n)
   {
-    listbox->AddItem(item.Description);
-    listbox->SavedGameIndex[listbox->ItemCount - 1] = item.Slot;
+    listbox->SavedGameIndex[n] = saves[n].Slot;
   }
 
   // update the global savegameindex[] array for backward compatibilty
@@ -356,6 +366,12 @@ RuntimeScriptValue Sc_ListBox_AddItem(void *self, const RuntimeScriptValue *para
     API_OBJCALL_INT_POBJ(GUIListBox, ListBox_AddItem, const char);
 }
 
+// void (GUIListBox *lbb, void *items_arr)
+RuntimeScriptValue Sc_ListBox_AddItems(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_VOID_POBJ(GUIListBox, ListBox_AddItems, void);
+}
+
 // void (GUIListBox *listbox)
 RuntimeScriptValue Sc_ListBox_Clear(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -570,6 +586,7 @@ void RegisterListBoxAPI()
 {
     ScFnRegister listbox_api[] = {
         { "ListBox::AddItem^1",           API_FN_PAIR(ListBox_AddItem) },
+        { "ListBox::AddItems^1",          API_FN_PAIR(ListBox_AddItems) },
         { "ListBox::Clear^0",             API_FN_PAIR(ListBox_Clear) },
         { "ListBox::FillDirList^1",       API_FN_PAIR(ListBox_FillDirList) },
         { "ListBox::FillSaveGameList^0",  API_FN_PAIR(ListBox_FillSaveGameList) },
@@ -23,6 +23,7 @@
 using AGS::Common::GUIListBox;
 
 int			ListBox_AddItem(GUIListBox *lbb, const char *text);
+void		ListBox_AddItems(GUIListBox *lbb, void *items_arr);
 int			ListBox_InsertItemAt(GUIListBox *lbb, int index, const char *text);
 void		ListBox_Clear(GUIListBox *listbox);
 void		ListBox_FillDirList(GUIListBox *listbox, const char *filemask);
@@ -34,7 +34,11 @@
 #include "ac/spritecache.h"
 #include "gfx/graphicsdriver.h"
 #include "gfx/gfxfilter.h"
+#include "gfx/pixel_convert.h"
+#include "main/graphics_mode.h"
 #include "platform/base/agsplatformdriver.h"
+#include "platform/base/sys_main.h"
+#include "util/math.h"
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
@@ -56,6 +60,11 @@ std::unique_ptr<Bitmap> blank_mouse_cursor;
 int mouse_cur_pic = 0;
 bool alpha_blend_cursor = false;
 IDriverDependantBitmap *mouse_cur_ddb = nullptr;
+// Hardware cursor: the current cursor graphic is given to the system,
+// which draws the cursor over the game window
+static bool hw_cursor_active = false;
+static bool hw_cursor_shown = false;
+static int hw_cursor_hotx = 0, hw_cursor_hoty = 0;
 
 // The Mouse:: functions are static so the script doesn't pass
 // in an object parameter
@@ -103,10 +112,68 @@ void SetMouseBounds(int x1, int y1, int x2, int y2)
     Mouse::SetMoveLimit(Rect(x1, y1, x2, y2));
 }
 
+// Makes the system cursor from the cursor graphic, scaled same as the game
+static void update_hardware_cursor(Bitmap *use_bmp)
+{
+    if (!usetup.mouse_hw_cursor || !use_bmp)
+        return;
+
+    const int src_w = use_bmp->GetWidth(), src_h = use_bmp->GetHeight();
+    const int dst_w = std::max(1, GameScaling.X.ScaleDistance(src_w));
+    const int dst_h = std::max(1, GameScaling.Y.ScaleDistance(src_h));
+    const PixelConvert::RowConverter conv(use_bmp->GetColorDepth(), PixelConvert::ChannelShifts(16, 8, 0, 24),
+        alpha_blend_cursor ? PixelConvert::kAlpha_Source : PixelConvert::kAlpha_MaskColor);
+    std::vector<uint32_t> row(src_w);
+    std::vector<uint32_t> pixels(dst_w * dst_h);
+    for (int y = 0, last_sy = -1; y < dst_h; ++y)
+    {
+        const int sy = y * src_h / dst_h;
+        if (sy != last_sy)
+            conv.Convert(row.data(), use_bmp->GetScanLine(sy), src_w);
+        last_sy = sy;
+        uint32_t *dst = &pixels[y * dst_w];
+        for (int x = 0; x < dst_w; ++x)
+            dst[x] = row[x * src_w / dst_w];
+    }
+
+    const int dst_hotx = Math::Clamp(GameScaling.X.ScaleDistance(hotx), 0, dst_w - 1);
+    const int dst_hoty = Math::Clamp(GameScaling.Y.ScaleDistance(hoty), 0, dst_h - 1);
+    hw_cursor_active = sys_window_set_cursor(pixels.data(), dst_w, dst_h, dst_hotx, dst_hoty);
+    hw_cursor_hotx = hotx;
+    hw_cursor_hoty = hoty;
+    if (!hw_cursor_active)
+        show_hardware_cursor(false); // fallback to the renderer's cursor
+}
+
 // mouse cursor functions:
 void update_cached_mouse_cursor(Bitmap *use_bmp) 
 {
     mouse_cur_ddb = recycle_ddb_bitmap(mouse_cur_ddb, use_bmp, alpha_blend_cursor);
+    update_hardware_cursor(use_bmp);
+}
+
+void refresh_hardware_cursor()
+{
+    if (!mouse_cur_ddb)
+        return; // no cursor set yet
+    if (dotted_mouse_cursor)
+        update_hardware_cursor(dotted_mouse_cursor.get());
+    else
+        update_hardware_cursor((mouse_cur_pic >= 0) ? spriteset[mouse_cur_pic] : blank_mouse_cursor.get());
+}
+
+bool is_hardware_cursor_active()
+{
+    return hw_cursor_active;
+}
+
+void show_hardware_cursor(bool on)
+{
+    on &= hw_cursor_active;
+    if (on == hw_cursor_shown)
+        return;
+    sys_window_show_cursor(on);
+    hw_cursor_shown = on;
 }
 
 // set_mouse_cursor: changes visual appearance to specified cursor
@@ -120,6 +187,9 @@ void set_mouse_cursor(int newcurs, bool force_update)
         newcurs == cur_cursor && game.mcurs[newcurs].view >= 0 &&
         (mouse_frame > 0 || mouse_delay > 0))
     {
+        // the hotspot could have changed though
+        if ((hotspotx != hw_cursor_hotx) || (hotspoty != hw_cursor_hoty))
+            refresh_hardware_cursor();
         return;
     }
 
@@ -55,6 +55,13 @@ int GetMouseCursor();
 void update_script_mouse_coords();
 void update_inv_cursor(int invnum);
 void set_new_cursor_graphic (int spriteslot);
+// Remakes the hardware cursor from the current cursor graphic,
+// e.g. after the game scaling has changed
+void refresh_hardware_cursor();
+// Tells whether the mouse cursor is drawn by the system, and not the renderer
+bool is_hardware_cursor_active();
+// Shows or hides the hardware cursor, if it's active
+void show_hardware_cursor(bool on);
 int find_next_enabled_cursor(int startwith);
 int find_previous_enabled_cursor(int startwith);
 
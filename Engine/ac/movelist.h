@@ -38,15 +38,11 @@ enum MoveListSvgVersion
     kMoveSvgVersion_36109, // skip empty lists, progress as float
 };
 
+// NOTE: the stepping state, which is updated each game frame, is kept before
+// the per-stage arrays, so that it fits in a single cache line.
 struct MoveList
 {
     int     numstage = 0;
-    // Waypoints, per stage
-    Point   pos[MAXNEEDSTAGES];
-    // xpermove and ypermove contain number of pixels done per a single step
-    // along x and y axes; i.e. this is a movement vector, per path stage
-    fixed   xpermove[MAXNEEDSTAGES]{};
-    fixed   ypermove[MAXNEEDSTAGES]{};
     int     onstage = 0; // current path stage
     Point   from; // current stage's starting position
     // Steps made during current stage;
@@ -62,6 +58,13 @@ struct MoveList
     fixed   fin_move = 0;
     float   fin_from_part = 0.f;
 
+    // Waypoints, per stage
+    Point   pos[MAXNEEDSTAGES];
+    // xpermove and ypermove contain number of pixels done per a single step
+    // along x and y axes; i.e. this is a movement vector, per path stage
+    fixed   xpermove[MAXNEEDSTAGES]{};
+    fixed   ypermove[MAXNEEDSTAGES]{};
+
     const Point &GetLastPos() const { return numstage > 0 ? pos[numstage - 1] : pos[0]; }
 
     // Gets a movelist's step length, in coordinate units
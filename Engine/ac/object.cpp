@@ -13,6 +13,7 @@
 //=============================================================================
 #include "ac/object.h"
 #include "ac/common.h"
+#include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/draw.h"
 #include "ac/character.h"
@@ -314,7 +315,9 @@ void Object_Move(ScriptObject *objj, int x, int y, int speed, int blocking, int
     else
         quit("Object.Move: invalid DIRECT parameter");
 
-    move_object(objj->id, x, y, speed, direct);
+    // only non-blocking moves may wait for the route search in background
+    const bool async = usetup.AsyncPathfinder && (blocking != BLOCKING) && (blocking != 1);
+    move_object(objj->id, x, y, speed, direct, async);
 
     if ((blocking == BLOCKING) || (blocking == 1))
         GameLoopUntilNotMoving(&objs[objj->id].moving);
@@ -427,7 +430,28 @@ int Object_GetIgnoreWalkbehinds(ScriptObject *chaa) {
     return 0;
 }
 
-void move_object(int objj,int tox,int toy,int spee,int ignwal) {
+// Object state saved when the move is requested
+struct ObjectMoveState
+{
+    int FromX = 0, FromY = 0;
+    int ToX = 0, ToY = 0;
+    int Speed = 0;
+    int IgnoreWalls = 0;
+};
+
+// Moves waiting for the asynchronous route search, per room object
+static std::vector<ObjectMoveState> pending_moves;
+
+static void start_object_move(int objj, int mslot, int ignwal)
+{
+    if (mslot>0) {
+        objs[objj].moving = mslot;
+        mls[mslot].direct = ignwal;
+        convert_move_path_to_room_resolution(&mls[mslot]);
+    }
+}
+
+void move_object(int objj,int tox,int toy,int spee,int ignwal, bool async) {
 
     if (!is_valid_object(objj))
         quit("!MoveObject: invalid object number");
@@ -449,12 +473,41 @@ void move_object(int objj,int tox,int toy,int spee,int ignwal) {
     const int dst_x = room_to_mask_coord(tox);
     const int dst_y = room_to_mask_coord(toy);
 
+    if (async && !ignwal && find_route_async(src_x, src_y, dst_x, dst_y, spee, spee,
+        prepare_walkable_areas(-1), objj+1, 1, ignwal))
+    {
+        if (pending_moves.size() <= static_cast<size_t>(objj))
+            pending_moves.resize(objj + 1);
+        ObjectMoveState &state = pending_moves[objj];
+        state.FromX = objs[objj].x;
+        state.FromY = objs[objj].y;
+        state.ToX = tox;
+        state.ToY = toy;
+        state.Speed = spee;
+        state.IgnoreWalls = ignwal;
+        return;
+    }
+
     int mslot = find_route(src_x, src_y, dst_x, dst_y, spee, spee, prepare_walkable_areas(-1), objj+1, 1, ignwal);
-    if (mslot>0) {
-        objs[objj].moving = mslot;
-        mls[mslot].direct = ignwal;
-        convert_move_path_to_room_resolution(&mls[mslot]);
+    start_object_move(objj, mslot, ignwal);
+}
+
+void complete_object_move(int objj)
+{
+    const int movlst = objj + 1;
+    if (!is_route_pending(movlst))
+        return;
+
+    const ObjectMoveState state = pending_moves[objj];
+    if ((objs[objj].x != state.FromX) || (objs[objj].y != state.FromY))
+    {
+        // object was relocated meanwhile, the route is no longer valid
+        cancel_route(movlst);
+        move_object(objj, state.ToX, state.ToY, state.Speed, state.IgnoreWalls);
+        return;
     }
+
+    start_object_move(objj, complete_route(movlst), state.IgnoreWalls);
 }
 
 void Object_RunInteraction(ScriptObject *objj, int mode) {
@@ -1215,54 +1268,54 @@ void RegisterObjectAPI()
         { "Object::StopAnimating^0",          API_FN_PAIR(Object_StopAnimating) },
         { "Object::StopMoving^0",             API_FN_PAIR(Object_StopMoving) },
         { "Object::Tint^5",                   API_FN_PAIR(Object_Tint) },
-        { "Object::get_Animating",            API_FN_PAIR(Object_GetAnimating) },
-        { "Object::get_AnimationVolume",      API_FN_PAIR(Object_GetAnimationVolume) },
-        { "Object::set_AnimationVolume",      API_FN_PAIR(Object_SetAnimationVolume) },
-        { "Object::get_Baseline",             API_FN_PAIR(Object_GetBaseline) },
-        { "Object::set_Baseline",             API_FN_PAIR(Object_SetBaseline) },
-        { "Object::get_BlockingHeight",       API_FN_PAIR(Object_GetBlockingHeight) },
-        { "Object::set_BlockingHeight",       API_FN_PAIR(Object_SetBlockingHeight) },
-        { "Object::get_BlockingWidth",        API_FN_PAIR(Object_GetBlockingWidth) },
-        { "Object::set_BlockingWidth",        API_FN_PAIR(Object_SetBlockingWidth) },
-        { "Object::get_Clickable",            API_FN_PAIR(Object_GetClickable) },
-        { "Object::set_Clickable",            API_FN_PAIR(Object_SetClickable) },
-        { "Object::get_Frame",                API_FN_PAIR(Object_GetFrame) },
-        { "Object::get_Graphic",              API_FN_PAIR(Object_GetGraphic) },
-        { "Object::set_Graphic",              API_FN_PAIR(Object_SetGraphic) },
-        { "Object::get_ID",                   API_FN_PAIR(Object_GetID) },
-        { "Object::get_IgnoreScaling",        API_FN_PAIR(Object_GetIgnoreScaling) },
-        { "Object::set_IgnoreScaling",        API_FN_PAIR(Object_SetIgnoreScaling) },
-        { "Object::get_IgnoreWalkbehinds",    API_FN_PAIR(Object_GetIgnoreWalkbehinds) },
-        { "Object::set_IgnoreWalkbehinds",    API_FN_PAIR(Object_SetIgnoreWalkbehinds) },
-        { "Object::get_Loop",                 API_FN_PAIR(Object_GetLoop) },
-        { "Object::get_ManualScaling",        API_FN_PAIR(Object_GetIgnoreScaling) },
-        { "Object::set_ManualScaling",        API_FN_PAIR(Object_SetManualScaling) },
-        { "Object::get_Moving",               API_FN_PAIR(Object_GetMoving) },
+        { "Object::get_Animating",            API_FN_FAST(Object_GetAnimating) },
+        { "Object::get_AnimationVolume",      API_FN_FAST(Object_GetAnimationVolume) },
+        { "Object::set_AnimationVolume",      API_FN_FAST(Object_SetAnimationVolume) },
+        { "Object::get_Baseline",             API_FN_FAST(Object_GetBaseline) },
+        { "Object::set_Baseline",             API_FN_FAST(Object_SetBaseline) },
+        { "Object::get_BlockingHeight",       API_FN_FAST(Object_GetBlockingHeight) },
+        { "Object::set_BlockingHeight",       API_FN_FAST(Object_SetBlockingHeight) },
+        { "Object::get_BlockingWidth",        API_FN_FAST(Object_GetBlockingWidth) },
+        { "Object::set_BlockingWidth",        API_FN_FAST(Object_SetBlockingWidth) },
+        { "Object::get_Clickable",            API_FN_FAST(Object_GetClickable) },
+        { "Object::set_Clickable",            API_FN_FAST(Object_SetClickable) },
+        { "Object::get_Frame",                API_FN_FAST(Object_GetFrame) },
+        { "Object::get_Graphic",              API_FN_FAST(Object_GetGraphic) },
+        { "Object::set_Graphic",              API_FN_FAST(Object_SetGraphic) },
+        { "Object::get_ID",                   API_FN_FAST(Object_GetID) },
+        { "Object::get_IgnoreScaling",        API_FN_FAST(Object_GetIgnoreScaling) },
+        { "Object::set_IgnoreScaling",        API_FN_FAST(Object_SetIgnoreScaling) },
+        { "Object::get_IgnoreWalkbehinds",    API_FN_FAST(Object_GetIgnoreWalkbehinds) },
+        { "Object::set_IgnoreWalkbehinds",    API_FN_FAST(Object_SetIgnoreWalkbehinds) },
+        { "Object::get_Loop",                 API_FN_FAST(Object_GetLoop) },
+        { "Object::get_ManualScaling",        API_FN_FAST(Object_GetIgnoreScaling) },
+        { "Object::set_ManualScaling",        API_FN_FAST(Object_SetManualScaling) },
+        { "Object::get_Moving",               API_FN_FAST(Object_GetMoving) },
         { "Object::get_Name",                 API_FN_PAIR(Object_GetName_New) },
         { "Object::set_Name",                 API_FN_PAIR(Object_SetName) },
-        { "Object::get_Scaling",              API_FN_PAIR(Object_GetScaling) },
-        { "Object::set_Scaling",              API_FN_PAIR(Object_SetScaling) },
+        { "Object::get_Scaling",              API_FN_FAST(Object_GetScaling) },
+        { "Object::set_Scaling",              API_FN_FAST(Object_SetScaling) },
         { "Object::get_ScriptName",           API_FN_PAIR(Object_GetScriptName) },
-        { "Object::get_Solid",                API_FN_PAIR(Object_GetSolid) },
-        { "Object::set_Solid",                API_FN_PAIR(Object_SetSolid) },
-        { "Object::get_Transparency",         API_FN_PAIR(Object_GetTransparency) },
-        { "Object::set_Transparency",         API_FN_PAIR(Object_SetTransparency) },
-        { "Object::get_View",                 API_FN_PAIR(Object_GetView) },
-        { "Object::get_Visible",              API_FN_PAIR(Object_GetVisible) },
-        { "Object::set_Visible",              API_FN_PAIR(Object_SetVisible) },
-        { "Object::get_X",                    API_FN_PAIR(Object_GetX) },
-        { "Object::set_X",                    API_FN_PAIR(Object_SetX) },
-        { "Object::get_Y",                    API_FN_PAIR(Object_GetY) },
-        { "Object::set_Y",                    API_FN_PAIR(Object_SetY) },
-        { "Object::get_HasExplicitLight",     API_FN_PAIR(Object_HasExplicitLight) },
-        { "Object::get_HasExplicitTint",      API_FN_PAIR(Object_HasExplicitTint) },
-        { "Object::get_LightLevel",           API_FN_PAIR(Object_GetLightLevel) },
-        { "Object::set_LightLevel",           API_FN_PAIR(Object_SetLightLevel) },
-        { "Object::get_TintBlue",             API_FN_PAIR(Object_GetTintBlue) },
-        { "Object::get_TintGreen",            API_FN_PAIR(Object_GetTintGreen) },
-        { "Object::get_TintRed",              API_FN_PAIR(Object_GetTintRed) },
-        { "Object::get_TintSaturation",       API_FN_PAIR(Object_GetTintSaturation) },
-        { "Object::get_TintLuminance",        API_FN_PAIR(Object_GetTintLuminance) },
+        { "Object::get_Solid",                API_FN_FAST(Object_GetSolid) },
+        { "Object::set_Solid",                API_FN_FAST(Object_SetSolid) },
+        { "Object::get_Transparency",         API_FN_FAST(Object_GetTransparency) },
+        { "Object::set_Transparency",         API_FN_FAST(Object_SetTransparency) },
+        { "Object::get_View",                 API_FN_FAST(Object_GetView) },
+        { "Object::get_Visible",              API_FN_FAST(Object_GetVisible) },
+        { "Object::set_Visible",              API_FN_FAST(Object_SetVisible) },
+        { "Object::get_X",                    API_FN_FAST(Object_GetX) },
+        { "Object::set_X",                    API_FN_FAST(Object_SetX) },
+        { "Object::get_Y",                    API_FN_FAST(Object_GetY) },
+        { "Object::set_Y",                    API_FN_FAST(Object_SetY) },
+        { "Object::get_HasExplicitLight",     API_FN_FAST(Object_HasExplicitLight) },
+        { "Object::get_HasExplicitTint",      API_FN_FAST(Object_HasExplicitTint) },
+        { "Object::get_LightLevel",           API_FN_FAST(Object_GetLightLevel) },
+        { "Object::set_LightLevel",           API_FN_FAST(Object_SetLightLevel) },
+        { "Object::get_TintBlue",             API_FN_FAST(Object_GetTintBlue) },
+        { "Object::get_TintGreen",            API_FN_FAST(Object_GetTintGreen) },
+        { "Object::get_TintRed",              API_FN_FAST(Object_GetTintRed) },
+        { "Object::get_TintSaturation",       API_FN_FAST(Object_GetTintSaturation) },
+        { "Object::get_TintLuminance",        API_FN_FAST(Object_GetTintLuminance) },
     };
 
     ccAddExternalFunctions(object_api);
@@ -87,7 +87,11 @@ void    update_object_scale(int objid);
 // Deduces arbitrary object's scale, accounting for both manual scaling and the room region effects
 void    update_object_scale(int &res_zoom, int &res_width, int &res_height,
             int objx, int objy, int sprnum, int own_zoom, bool use_region_scaling);
-void    move_object(int objj,int tox,int toy,int spee,int ignwal);
+// Starts the object move; if async is set, then the route may be searched
+// on the worker thread, and the move starts when complete_object_move is called
+void    move_object(int objj,int tox,int toy,int spee,int ignwal, bool async = false);
+// Starts the object move which route was searched asynchronously, if any
+void    complete_object_move(int objj);
 void    get_object_blocking_rect(int objid, int *x1, int *y1, int *width, int *y2);
 int     isposinbox(int mmx,int mmy,int lf,int tp,int rt,int bt);
 // xx,yy is the position in room co-ordinates that we are checking
@@ -32,6 +32,7 @@
 #include "debug/debug_log.h"
 #include "gfx/graphicsdriver.h"
 #include "gfx/bitmap.h"
+#include "main/update.h"
 #include "script/runtimescriptvalue.h"
 
 using namespace AGS::Common;
@@ -48,6 +49,23 @@ extern IGraphicsDriver *gfxDriver;
 // which handles this kind of storage; share with ManagedPool's handles?
 std::vector<ScreenOverlay> screenover;
 std::queue<int32_t> over_free_ids;
+// IDs of the existing overlays, in ascending order; lets to iterate over
+// them without checking all the empty slots left by the removed ones
+std::vector<int> over_active_ids;
+
+static void add_active_overlay_id(int type)
+{
+    auto it = std::lower_bound(over_active_ids.begin(), over_active_ids.end(), type);
+    if ((it == over_active_ids.end()) || (*it != type))
+        over_active_ids.insert(it, type);
+}
+
+static void remove_active_overlay_id(int type)
+{
+    auto it = std::lower_bound(over_active_ids.begin(), over_active_ids.end(), type);
+    if ((it != over_active_ids.end()) && (*it == type))
+        over_active_ids.erase(it);
+}
 
 
 void Overlay_Remove(ScriptOverlay *sco) {
@@ -395,11 +413,13 @@ void remove_screen_overlay(int type)
         invalidate_and_subref(over);
     }
     dispose_overlay(over);
+    get_game_timers().Cancel(TimerWheel::MakeKey(kGameTimer_Overlay, type));
 
     // Don't erase vector elements, instead set invalid and record free index
     screenover[type] = ScreenOverlay();
     if (type >= OVER_FIRSTFREE)
         over_free_ids.push(type);
+    remove_active_overlay_id(type);
 
     reset_drawobj_for_overlay(type);
 
@@ -411,8 +431,16 @@ void remove_screen_overlay(int type)
 
 void remove_all_overlays()
 {
-    for (auto &over : screenover)
-        remove_screen_overlay(over.type);
+    const std::vector<int> ids = over_active_ids; // copy, as it changes while removing
+    for (int type : ids)
+        remove_screen_overlay(type);
+}
+
+void clear_overlays()
+{
+    screenover.clear();
+    over_active_ids.clear();
+    while (!over_free_ids.empty()) { over_free_ids.pop(); }
 }
 
 ScreenOverlay *get_overlay(int type)
@@ -481,6 +509,7 @@ size_t add_screen_overlay_impl(bool roomlayer, int x, int y, int type, int sprnu
     }
     over.MarkChanged();
     screenover[type] = std::move(over);
+    add_active_overlay_id(type);
     play.overlay_count++;
     return type;
 }
@@ -549,12 +578,14 @@ void restore_overlays()
 {
     // Will have to readjust free ids records, as overlays may be restored in any random slots
     while (!over_free_ids.empty()) { over_free_ids.pop(); }
+    over_active_ids.clear();
     for (size_t i = 0; i < screenover.size(); ++i)
     {
         auto &over = screenover[i];
         if (over.type >= 0)
         {
             over.MarkChanged(); // force recreate texture on next draw
+            over_active_ids.push_back(i);
         }
         else if (i >= OVER_FIRSTFREE)
         {
@@ -568,6 +599,11 @@ std::vector<ScreenOverlay> &get_overlays()
     return screenover;
 }
 
+const std::vector<int> &get_overlay_ids()
+{
+    return over_active_ids;
+}
+
 //=============================================================================
 //
 // Script API Functions
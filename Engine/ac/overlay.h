@@ -46,6 +46,8 @@ size_t add_screen_overlay(bool roomlayer, int x, int y, int type, Common::Bitmap
 size_t add_screen_overlay(bool roomlayer, int x, int y, int type, Common::Bitmap *piccy, int pic_offx, int pic_offy, bool has_alpha);
 void remove_screen_overlay(int type);
 void remove_all_overlays();
+// Disposes the overlays storage, without running any removal logic
+void clear_overlays();
 // Creates and registers a managed script object for existing overlay object;
 // optionally adds an internal engine reference to prevent object's disposal
 ScriptOverlay* create_scriptoverlay(ScreenOverlay &over, bool internal_ref = false);
@@ -56,6 +58,9 @@ void restore_overlays();
 // but unfortunately some batch operations on overlays are currently performed
 // by external code...
 std::vector<ScreenOverlay> &get_overlays();
+// Returns a ref to the list of existing overlay IDs (indexes in the overlays
+// list), in ascending order; this list changes when overlays are added or removed
+const std::vector<int> &get_overlay_ids();
 
 
 #endif // __AGS_EE_AC__OVERLAY_H
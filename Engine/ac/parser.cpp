@@ -55,15 +55,12 @@ int Said (const char *checkwords) {
 //=============================================================================
 
 int find_word_in_dictionary (const char *lookfor) {
-    int j;
     if (game.dict == nullptr)
         return -1;
 
-    for (j = 0; j < game.dict->num_words; j++) {
-        if (ags_stricmp(lookfor, game.dict->word[j]) == 0) {
-            return game.dict->wordnum[j];
-        }
-    }
+    const int index = game.dict->find_index(lookfor);
+    if (index >= 0)
+        return game.dict->wordnum[index];
     if (lookfor[0] != 0) {
         // If the word wasn't found, but it ends in 'S', see if there's
         // a non-plural version
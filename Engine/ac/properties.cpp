@@ -26,69 +26,72 @@ extern GameSetupStruct game;
 
 // begin custom property functions
 
-bool get_property_desc(PropertyDesc &desc, const char *property, PropertyType want_type)
+// Finds the property's description in the schema, and validates its type
+static const PropertyDesc *get_property_desc(const char *property, PropertyType want_type)
 {
-    PropertySchema::const_iterator sch_it = game.propSchema.find(property);
+    // wrap the name to avoid allocating a String for each lookup
+    const String prop_name = String::Wrapper(property);
+    PropertySchema::const_iterator sch_it = game.propSchema.find(prop_name);
     if (sch_it == game.propSchema.end())
         quitprintf("!Did not find property '%s' in the schema. Make sure you are using the property's name, and not its description, when calling this command.", property);
 
-    desc = sch_it->second;
+    const PropertyDesc &desc = sch_it->second;
     if (want_type == kPropertyString && desc.Type != kPropertyString)
         quitprintf("!Property '%s' isn't a text property.  Use GetProperty/SetProperty for non-text properties", property);
     else if (want_type != kPropertyString && desc.Type == kPropertyString)
         quitprintf("!Property '%s' is a text property.  Use GetTextProperty/SetTextProperty for text properties", property);
-    return true;
+    return &desc;
 }
 
-String get_property_value(const StringIMap &st_prop, const StringIMap &rt_prop, const char *property, const String def_val)
+static const String &get_property_value(const StringIMap &st_prop, const StringIMap &rt_prop, const PropertyDesc &desc)
 {
     // First check runtime properties, then static properties;
     // if no matching entry was found, use default schema value
-    StringIMap::const_iterator it = rt_prop.find(property);
+    StringIMap::const_iterator it = rt_prop.find(desc.Name);
     if (it != rt_prop.end())
         return it->second;
-    it = st_prop.find(property);
+    it = st_prop.find(desc.Name);
     if (it != st_prop.end())
         return it->second;
-    return def_val;
+    return desc.DefaultValue;
 }
 
 // Get an integer property
 int get_int_property(const StringIMap &st_prop, const StringIMap &rt_prop, const char *property)
 {
-    PropertyDesc desc;
-    if (!get_property_desc(desc, property, kPropertyInteger))
+    const PropertyDesc *desc = get_property_desc(property, kPropertyInteger);
+    if (!desc)
         return 0;
-    return StrUtil::StringToInt(get_property_value(st_prop, rt_prop, property, desc.DefaultValue));
+    return StrUtil::StringToInt(get_property_value(st_prop, rt_prop, *desc));
 }
 
 // Get a string property
 void get_text_property(const StringIMap &st_prop, const StringIMap &rt_prop, const char *property, char *bufer)
 {
-    PropertyDesc desc;
-    if (!get_property_desc(desc, property, kPropertyString))
+    const PropertyDesc *desc = get_property_desc(property, kPropertyString);
+    if (!desc)
         return;
 
-    String val = get_property_value(st_prop, rt_prop, property, desc.DefaultValue);
+    const String &val = get_property_value(st_prop, rt_prop, *desc);
     snprintf(bufer, MAX_MAXSTRLEN, "%s", val.GetCStr());
 }
 
 const char* get_text_property_dynamic_string(const StringIMap &st_prop, const StringIMap &rt_prop, const char *property)
 {
-    PropertyDesc desc;
-    if (!get_property_desc(desc, property, kPropertyString))
+    const PropertyDesc *desc = get_property_desc(property, kPropertyString);
+    if (!desc)
         return nullptr;
 
-    String val = get_property_value(st_prop, rt_prop, property, desc.DefaultValue);
+    const String &val = get_property_value(st_prop, rt_prop, *desc);
     return CreateNewScriptString(val);
 }
 
 bool set_int_property(StringIMap &rt_prop, const char *property, int value)
 {
-    PropertyDesc desc;
-    if (get_property_desc(desc, property, kPropertyInteger))
+    const PropertyDesc *desc = get_property_desc(property, kPropertyInteger);
+    if (desc)
     {
-        rt_prop[desc.Name] = StrUtil::IntToString(value);
+        rt_prop[desc->Name] = StrUtil::IntToString(value);
         return true;
     }
     return false;
@@ -96,10 +99,10 @@ bool set_int_property(StringIMap &rt_prop, const char *property, int value)
 
 bool set_text_property(StringIMap &rt_prop, const char *property, const char* value)
 {
-    PropertyDesc desc;
-    if (get_property_desc(desc, property, kPropertyString))
+    const PropertyDesc *desc = get_property_desc(property, kPropertyString);
+    if (desc)
     {
-        rt_prop[desc.Name] = value;
+        rt_prop[desc->Name] = value;
         return true;
     }
     return false;
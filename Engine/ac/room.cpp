@@ -16,6 +16,7 @@
 
 #include "core/platform.h"
 #include "util/string_utils.h" //strlwr()
+#include "ac/asset_helper.h"
 #include "ac/common.h"
 #include "ac/character.h"
 #include "ac/characterextras.h"
@@ -38,6 +39,8 @@
 #include "ac/region.h"
 #include "ac/sys_events.h"
 #include "ac/room.h"
+#include "ac/room_loadstats.h"
+#include "ac/room_preload.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
 #include "ac/screen.h"
@@ -49,10 +52,12 @@
 #include "ac/dynobj/scripthotspot.h"
 #include "ac/dynobj/dynobj_manager.h"
 #include "ac/dynobj/all_dynamicclasses.h"
+#include "gui/guibutton.h"
 #include "gui/guimain.h"
 #include "script/cc_instance.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
+#include "debug/eventtrace.h"
 #include "debug/out.h"
 #include "game/room_file.h"
 #include "game/room_version.h"
@@ -70,6 +75,7 @@
 #include "gfx/gfxfilter.h"
 #include "media/audio/audio_system.h"
 #include "main/game_run.h"
+#include "main/update.h"
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
@@ -203,6 +209,16 @@ bool Room_Exists(int room)
     return AssetMgr->DoesAssetExist(room_filename);
 }
 
+void Room_Preload(int room)
+{
+    if ((room < 0) || !AssetMgr->DoesAssetExist(get_room_filename(room)))
+    {
+        debug_script_warn("Room.Preload: room %d does not exist", room);
+        return;
+    }
+    room_preload_request(room);
+}
+
 ScriptDrawingSurface *GetDrawingSurfaceForWalkableArea()
 {
     return Room_GetDrawingSurfaceForMask(kRoomAreaWalkable);
@@ -237,7 +253,11 @@ void convert_room_background_to_game_res()
     const int bkg_height = data_to_game_coord(thisroom.Height);
 
     for (size_t i = 0; i < thisroom.BgFrameCount; ++i)
-        thisroom.BgFrames[i].Graphic = FixBitmap(thisroom.BgFrames[i].Graphic, bkg_width, bkg_height);
+    {
+        // Frames which are not decoded yet are fixed by ensure_room_bg_frame()
+        if (thisroom.BgFrames[i].Graphic)
+            thisroom.BgFrames[i].Graphic = FixBitmap(thisroom.BgFrames[i].Graphic, bkg_width, bkg_height);
+    }
 
     // Fix masks to match resized room background
     // Walk-behind is always 1:1 with room background size
@@ -273,6 +293,7 @@ void unload_old_room() {
 
     debug_script_log("Unloading room %d", displayed_room);
 
+    cancel_pending_routes();
     dispose_room_drawdata();
 
     for (uint32_t ff=0;ff<croom->numobj;ff++)
@@ -295,7 +316,7 @@ void unload_old_room() {
     if (croom==nullptr) ;
     else if (roominst!=nullptr) {
         save_room_data_segment();
-        FreeRoomScriptInstance();
+        CacheRoomScriptInstance(displayed_room);
     }
     else croom->tsdatasize=0;
     memset(&play.walkable_areas_on[0],1,MAX_WALK_AREAS);
@@ -331,6 +352,9 @@ void unload_old_room() {
         ccRemoveExternalSymbol(thisroom.Hotspots[ff].ScriptName);
     }
 
+    // keep the status of the room which we leave packed, until we return
+    if (croom != &troom)
+        packRoomStatus(displayed_room);
     croom_ptr_clear();
 
     // clear the draw caches to save memory, since many of the the involved
@@ -452,17 +476,82 @@ HError LoadRoomScript(RoomStruct *room, int newnum)
     return HError::None();
 }
 
+// Requests background loading of the sprites which are going to be displayed
+// right after entering the room: the ones of the room objects, of characters
+// present in the room and of the displayed GUIs; their textures are created
+// as soon as the sprites are loaded
+static void prefetch_room_sprites()
+{
+    std::vector<sprkey_t> obj_sprites, char_sprites, gui_sprites;
+    for (uint32_t i = 0; i < croom->numobj; ++i)
+    {
+        const RoomObject &obj = objs[i];
+        if (!obj.on)
+            continue;
+        obj_sprites.push_back(obj.num);
+        if (obj.view != RoomObject::NoView)
+            get_view_sprites(obj.view, obj.loop, obj.loop, obj_sprites);
+    }
+    for (int i = 0; i < game.numcharacters; ++i)
+    {
+        const CharacterInfo &chi = game.chars[i];
+        if ((chi.room != displayed_room) || !chi.on)
+            continue;
+        get_view_sprites(chi.view, 0, INT32_MAX, char_sprites);
+    }
+    for (const auto &gui : guis)
+    {
+        if (!gui.IsDisplayed())
+            continue;
+        gui_sprites.push_back(gui.BgImage);
+        for (int i = 0; i < gui.GetControlCount(); ++i)
+        {
+            if (gui.GetControlType(i) != kGUIButton)
+                continue;
+            const GUIButton *but = static_cast<const GUIButton*>(gui.GetControl(i));
+            gui_sprites.push_back(but->GetNormalImage());
+            gui_sprites.push_back(but->GetMouseOverImage());
+            gui_sprites.push_back(but->GetPushedImage());
+        }
+    }
+    std::vector<sprkey_t> sprites;
+    sprites.reserve(obj_sprites.size() + char_sprites.size() + gui_sprites.size());
+    sprites.insert(sprites.end(), obj_sprites.begin(), obj_sprites.end());
+    sprites.insert(sprites.end(), char_sprites.begin(), char_sprites.end());
+    sprites.insert(sprites.end(), gui_sprites.begin(), gui_sprites.end());
+    spriteset.PrefetchSprites(sprites);
+    texturecache_queue_uploads(obj_sprites, kTexCategory_Room);
+    texturecache_queue_uploads(char_sprites, kTexCategory_Character);
+    texturecache_queue_uploads(gui_sprites, kTexCategory_GUI);
+}
+
 static void reset_temp_room()
 {
     troom = RoomStatus();
 }
 
+String get_room_filename(int room)
+{
+    String room_filename = String::FromFormat("room%d.crm", room);
+    if (room == 0) {
+        // support both room0.crm and intro.crm
+        // 2.70: Renamed intro.crm to room0.crm, to stop it causing confusion
+        if ((loaded_game_file_version < kGameVersion_270 && AssetMgr->DoesAssetExist("intro.crm")) ||
+            (loaded_game_file_version >= kGameVersion_270 && !AssetMgr->DoesAssetExist(room_filename)))
+        {
+            room_filename = "intro.crm";
+        }
+    }
+    return room_filename;
+}
+
 // forchar = playerchar on NewRoom, or NULL if restore saved game
 void load_new_room(int newnum, CharacterInfo*forchar) {
+    AGS_TRACE_ZONE("load_new_room");
 
     debug_script_log("Loading room %d", newnum);
+    room_load_stats_begin(newnum);
 
-    String room_filename;
     done_es_error = 0;
     play.room_changes ++;
     // TODO: find out why do we need to temporarily lower color depth to 8-bit.
@@ -471,22 +560,25 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
     // lead to unexpected errors.
     set_color_depth(8);
     displayed_room=newnum;
+    asset_trace_set_room(newnum);
 
-    room_filename.Format("room%d.crm", newnum);
-    if (newnum == 0) {
-        // support both room0.crm and intro.crm
-        // 2.70: Renamed intro.crm to room0.crm, to stop it causing confusion
-        if ((loaded_game_file_version < kGameVersion_270 && AssetMgr->DoesAssetExist("intro.crm")) ||
-            (loaded_game_file_version >= kGameVersion_270 && !AssetMgr->DoesAssetExist(room_filename)))
-        {
-            room_filename = "intro.crm";
-        }
-    }
+    const String room_filename = get_room_filename(newnum);
 
-    // load the room from disk
+    // load the room from disk, unless it was preloaded in background
     set_our_eip(200);
     thisroom.GameID = NO_GAME_ID_IN_ROOM_FILE;
-    HError err = LoadRoom(room_filename, &thisroom, AssetMgr.get(), game.IsLegacyHiRes(), game.SpriteInfos);
+    HError err = HError::None();
+    RoomLoadTimes load_times;
+    bool preloaded;
+    {
+        RoomLoadTimer timer(kRoomLoad_Read); // waiting for the preloaded room, if any
+        preloaded = room_preload_take(newnum, thisroom);
+    }
+    if (!preloaded)
+    {
+        err = LoadRoom(room_filename, &thisroom, AssetMgr.get(), game.IsLegacyHiRes(), game.SpriteInfos, true /* lazy bg frames */, &load_times);
+        room_load_stats_add(load_times);
+    }
     if (!err)
     {
         quitprintf("Unable to load the room file '%s'. Error: %s", room_filename.GetCStr(), err->FullMessage().GetCStr());
@@ -529,8 +621,14 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
         }
     }
 
-    for (size_t i = 0; i < thisroom.BgFrameCount; ++i) {
-        thisroom.BgFrames[i].Graphic = PrepareSpriteForUse(thisroom.BgFrames[i].Graphic, false);
+    {
+        RoomLoadTimer timer(kRoomLoad_Convert);
+        for (size_t i = 0; i < thisroom.BgFrameCount; ++i) {
+            if (thisroom.BgFrames[i].Graphic)
+                thisroom.BgFrames[i].Graphic = PrepareSpriteForUse(thisroom.BgFrames[i].Graphic, false);
+        }
+        // The current frame may be other than the first one, e.g. when restoring a save
+        ensure_room_bg_frame(play.bg_frame);
     }
 
     set_our_eip(202);
@@ -544,7 +642,10 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
 
     set_color_depth(game.GetColorDepth());
     // Make sure the room gfx and masks are matching game's native res
-    convert_room_background_to_game_res();
+    {
+        RoomLoadTimer timer(kRoomLoad_Convert);
+        convert_room_background_to_game_res();
+    }
 
     // walkable_areas_temp is used by the pathfinder to generate a
     // copy of the walkable areas - allocate it here to save time later
@@ -735,7 +836,10 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
     roominst=nullptr;
     if (debug_flags & DBG_NOSCRIPT) ;
     else if (thisroom.CompiledScript!=nullptr) {
-        compile_room_script();
+        RoomLoadTimer timer(kRoomLoad_Script);
+        // Reuse the script instance if the room was visited recently
+        if (!RestoreCachedRoomScriptInstance(newnum, thisroom.CompiledScript.get()))
+            compile_room_script();
         if (croom->tsdatasize>0) {
             if (croom->tsdatasize != roominst->globaldatasize)
                 quit("room script data segment size has changed");
@@ -884,6 +988,7 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
         play.UpdateRoomCameras(); // update auto tracking
     }
     init_room_drawdata();
+    prefetch_room_sprites();
 
     set_our_eip(212);
     invalidate_screen();
@@ -906,6 +1011,7 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
     debug_script_log("Now in room %d", displayed_room);
     GUIE::MarkAllGUIForUpdate(true, true);
     pl_run_plugin_hooks(AGSE_ENTERROOM, displayed_room);
+    room_load_stats_loaded(preloaded);
 }
 
 // new_room: changes the current room number, and loads the new room from disk
@@ -917,6 +1023,8 @@ void new_room(int newnum,CharacterInfo*forchar) {
     // we are currently running Leaves Screen scripts
     in_leaves_screen = newnum;
 
+    room_preload_on_leave_room(newnum);
+
     // player leaves screen event
     run_room_event(EVROM_LEAVE);
     // Run the global OnRoomLeave event
@@ -962,6 +1070,7 @@ void set_room_placeholder()
     thisroom.RegionMask = dummy_bg;
     thisroom.WalkAreaMask = dummy_bg;
     thisroom.WalkBehindMask = dummy_bg;
+    invalidate_walkable_areas_temp();
 
     reset_temp_room();
     croom = &troom;
@@ -970,7 +1079,7 @@ void set_room_placeholder()
 int find_highest_room_entered() {
     int qq,fndas=-1;
     for (qq=0;qq<MAX_ROOMS;qq++) {
-        if (isRoomStatusValid(qq) && (getRoomStatus(qq)->beenhere != 0))
+        if (getRoomStatusBeenHere(qq) != 0)
             fndas = qq;
     }
     return fndas;
@@ -993,10 +1102,14 @@ void check_new_room() {
         int newroom_was = in_new_room;
         in_new_room = 0;
         play.disabled_user_interface ++;
-        process_event(&evh);
+        {
+            RoomLoadTimer timer(kRoomLoad_Events);
+            process_event(&evh);
+        }
         play.disabled_user_interface --;
         in_new_room = newroom_was;
     }
+    room_load_stats_end();
 }
 
 void compile_room_script() {
@@ -1017,15 +1130,25 @@ void compile_room_script() {
     if (roominstFork == nullptr)
         quitprintf("Unable to create forked room instance:\n%s", cc_get_error().ErrorString.GetCStr());
 
-    repExecAlways.roomHasFunction = true;
-    lateRepExecAlways.roomHasFunction = true;
-    getDialogOptionsDimensionsFunc.roomHasFunction = true;
+    ResolveRoomScriptCallbacks();
+}
+
+void ensure_room_bg_frame(int frame)
+{
+    if (frame < 0 || !thisroom.DecodeBgFrame(frame))
+        return;
+    RoomBgFrame &bg = thisroom.BgFrames[frame];
+    bg.Graphic = PrepareSpriteForUse(bg.Graphic, false);
+    if (game.AllowRelativeRes() && thisroom.IsRelativeRes())
+        bg.Graphic = FixBitmap(bg.Graphic, data_to_game_coord(thisroom.Width), data_to_game_coord(thisroom.Height));
 }
 
 int bg_just_changed = 0;
 
 void on_background_frame_change () {
 
+    ensure_room_bg_frame(play.bg_frame);
+
     invalidate_screen();
     mark_current_background_dirty();
 
@@ -1222,6 +1345,11 @@ RuntimeScriptValue Sc_Room_Exists(const RuntimeScriptValue *params, int32_t para
     API_SCALL_BOOL_PINT(Room_Exists);
 }
 
+RuntimeScriptValue Sc_Room_Preload(const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_SCALL_VOID_PINT(Room_Preload);
+}
+
 void RegisterRoomAPI()
 {
     ScFnRegister room_api[] = {
@@ -1243,6 +1371,7 @@ void RegisterRoomAPI()
         { "Room::get_TopEdge",                        API_FN_PAIR(Room_GetTopEdge) },
         { "Room::get_Width",                          API_FN_PAIR(Room_GetWidth) },
         { "Room::Exists",                             API_FN_PAIR(Room_Exists) },
+        { "Room::Preload^1",                          API_FN_PAIR(Room_Preload) },
     };
 
     ccAddExternalFunctions(room_api);
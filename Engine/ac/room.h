@@ -45,6 +45,8 @@ ScriptDrawingSurface *Region_GetDrawingSurface();
 
 //=============================================================================
 
+// Gets the name of the room file
+AGS::Common::String get_room_filename(int room);
 void  save_room_data_segment ();
 void  unload_old_room();
 void  load_new_room(int newnum,CharacterInfo*forchar);
@@ -56,6 +58,9 @@ int   find_highest_room_entered();
 void  first_room_initialization();
 void  check_new_room();
 void  compile_room_script();
+// Decodes the room background frame if it was left compressed when the room
+// was loaded, and converts it for use in game
+void  ensure_room_bg_frame(int frame);
 void  on_background_frame_change ();
 // Clear the current room pointer if room status is no longer valid
 void  croom_ptr_clear();
@@ -0,0 +1,116 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/room_loadstats.h"
+#include <algorithm>
+#include "debug/out.h"
+
+using namespace AGS::Common;
+
+static const char *StageNames[kNumRoomLoadStages] =
+    { "read", "images", "update", "decode", "convert", "script", "setup", "events" };
+
+// The room load being timed
+static bool load_active = false;
+static int load_room = -1;
+static bool load_preloaded = false;
+static AGS_Clock::time_point load_start;
+static uint32_t load_times[kNumRoomLoadStages];
+
+// Totals over all the loaded rooms
+struct RoomLoadTotals
+{
+    uint32_t Count = 0u;
+    uint64_t Total[kNumRoomLoadStages] = {};
+    uint32_t Max[kNumRoomLoadStages] = {};
+    int      SlowestRoom = -1;
+    uint32_t SlowestTime = 0u;
+};
+static RoomLoadTotals totals;
+
+void room_load_stats_begin(int room)
+{
+    load_active = true;
+    load_room = room;
+    load_preloaded = false;
+    load_start = AGS_Clock::now();
+    std::fill(load_times, load_times + kNumRoomLoadStages, 0u);
+}
+
+void room_load_stats_add(RoomLoadStage stage, uint32_t us)
+{
+    if (load_active)
+        load_times[stage] += us;
+}
+
+void room_load_stats_add(const RoomLoadTimes &times)
+{
+    room_load_stats_add(kRoomLoad_Read, times.Read);
+    room_load_stats_add(kRoomLoad_Images, times.Images);
+    room_load_stats_add(kRoomLoad_Update, times.Update);
+    room_load_stats_add(kRoomLoad_Decode, times.Decode);
+}
+
+void room_load_stats_loaded(bool preloaded)
+{
+    if (!load_active)
+        return;
+    load_preloaded = preloaded;
+    const uint32_t elapsed = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(AGS_Clock::now() - load_start).count());
+    uint32_t attributed = 0u;
+    for (int i = 0; i < kNumRoomLoadStages; ++i)
+        attributed += load_times[i];
+    load_times[kRoomLoad_Setup] += elapsed - std::min(elapsed, attributed);
+}
+
+void room_load_stats_end()
+{
+    if (!load_active)
+        return;
+    load_active = false;
+
+    uint32_t total = 0u;
+    String breakdown;
+    for (int i = 0; i < kNumRoomLoadStages; ++i)
+    {
+        total += load_times[i];
+        breakdown.AppendFmt(" %s %.2f", StageNames[i], load_times[i] / 1000.0);
+        totals.Total[i] += load_times[i];
+        totals.Max[i] = std::max(totals.Max[i], load_times[i]);
+    }
+    totals.Count++;
+    if (total >= totals.SlowestTime)
+    {
+        totals.SlowestRoom = load_room;
+        totals.SlowestTime = total;
+    }
+    Debug::Printf(kDbgGroup_RoomLoad, kDbgMsg_Debug, "Room %d%s loaded in %.2f ms:%s",
+        load_room, load_preloaded ? " (preloaded)" : "", total / 1000.0, breakdown.GetCStr());
+}
+
+void room_load_stats_report()
+{
+    if (totals.Count == 0)
+        return;
+    uint64_t total = 0u;
+    for (int i = 0; i < kNumRoomLoadStages; ++i)
+        total += totals.Total[i];
+    Debug::Printf(kDbgGroup_RoomLoad, kDbgMsg_Info, "Room loads: %u, average %.2f ms, slowest room %d (%.2f ms)",
+        totals.Count, total / 1000.0 / totals.Count, totals.SlowestRoom, totals.SlowestTime / 1000.0);
+    for (int i = 0; i < kNumRoomLoadStages; ++i)
+    {
+        Debug::Printf(kDbgGroup_RoomLoad, kDbgMsg_Info, "  %-8s total %10.2f ms, average %8.2f ms, max %8.2f ms",
+            StageNames[i], totals.Total[i] / 1000.0, totals.Total[i] / 1000.0 / totals.Count, totals.Max[i] / 1000.0);
+    }
+}
@@ -0,0 +1,72 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Room load time instrumentation. The time spent on each stage of entering
+// a room is printed into the "roomload" log group after the room is set up,
+// and the totals over all the loaded rooms are printed when the game quits.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__ROOMLOADSTATS_H
+#define __AGS_EE_AC__ROOMLOADSTATS_H
+
+#include <cstdint>
+#include "ac/timer.h"
+#include "game/room_file.h"
+
+enum RoomLoadStage
+{
+    kRoomLoad_Read,     // reading and parsing the room file
+    kRoomLoad_Images,   // decompressing the primary background and masks
+    kRoomLoad_Update,   // upgrading the room data
+    kRoomLoad_Decode,   // decoding the secondary background frames
+    kRoomLoad_Convert,  // converting the backgrounds and masks for the game
+    kRoomLoad_Script,   // creating the room script instance
+    kRoomLoad_Setup,    // the rest of the room setup
+    kRoomLoad_Events,   // running the "room load" event handlers
+    kNumRoomLoadStages
+};
+
+// Starts timing the load of the given room
+void room_load_stats_begin(int room);
+// Adds the time spent on a stage of the current room load
+void room_load_stats_add(RoomLoadStage stage, uint32_t us);
+// Adds the stage times recorded by the room file loader
+void room_load_stats_add(const AGS::Common::RoomLoadTimes &times);
+// Marks the end of the room setup; the time since the load began which
+// was not attributed to any other stage is counted as the setup
+void room_load_stats_loaded(bool preloaded);
+// Finishes timing the current room load and prints its breakdown;
+// does nothing if no room load is being timed
+void room_load_stats_end();
+// Prints the stage totals over all the rooms loaded in this session
+void room_load_stats_report();
+
+// Measures the time of a room load stage in its scope
+class RoomLoadTimer
+{
+public:
+    RoomLoadTimer(RoomLoadStage stage)
+        : _stage(stage), _start(AGS_Clock::now()) {}
+    ~RoomLoadTimer()
+    {
+        room_load_stats_add(_stage, static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(AGS_Clock::now() - _start).count()));
+    }
+
+private:
+    RoomLoadStage _stage;
+    AGS_Clock::time_point _start;
+};
+
+#endif // __AGS_EE_AC__ROOMLOADSTATS_H
@@ -0,0 +1,254 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/room_preload.h"
+#include <map>
+#include <memory>
+#include <vector>
+#if !defined(AGS_DISABLE_THREADS)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+#include "ac/character.h"
+#include "ac/game.h"
+#include "ac/gamesetup.h"
+#include "ac/gamesetupstruct.h"
+#include "ac/gamestate.h"
+#include "ac/global_hotspot.h"
+#include "ac/hotspot.h"
+#include "ac/mouse.h"
+#include "ac/movelist.h"
+#include "ac/room.h"
+#include "ac/route_finder.h"
+#include "ac/runtime_defines.h"
+#include "core/assetmanager.h"
+#include "debug/debug_log.h"
+#include "debug/out.h"
+#include "game/room_file.h"
+#include "util/memorystream.h"
+
+using namespace AGS::Common;
+
+extern GameSetupStruct game;
+
+// Room exits: the edges are 0-3 (left, right, bottom, top),
+// same as the edge event indexes, and the hotspots follow them
+static const int ExitHotspotBase = 4;
+
+struct RoomPreloadRequest
+{
+    int Room = -1;
+    String Filename;
+    AssetReadFuture Read;
+    // The game data used when loading a room, copied for the worker
+    bool GameIsHires = false;
+    std::vector<SpriteInfo> SpriteInfos;
+    // Result
+    bool Done = false;
+    HError Err = HError::None();
+    std::unique_ptr<RoomStruct> Data;
+};
+
+// The last requested room
+static std::shared_ptr<RoomPreloadRequest> preload_request;
+// The exits used to leave the rooms, mapped by the room and exit
+static std::map<std::pair<int, int>, int> room_exits;
+// The hotspot the player has interacted with in the current room
+static int last_hotspot = 0;
+#if !defined(AGS_DISABLE_THREADS)
+static std::shared_ptr<RoomPreloadRequest> preload_queued;
+static std::mutex preload_mutex;
+static std::condition_variable preload_wake_cv;
+static std::condition_variable preload_done_cv;
+static std::thread preload_thread;
+static bool preload_thread_quit = false;
+
+static void preload_thread_func()
+{
+    std::unique_lock<std::mutex> lk(preload_mutex);
+    while (true)
+    {
+        preload_wake_cv.wait(lk, []() { return preload_thread_quit || preload_queued; });
+        if (preload_thread_quit)
+            break;
+        std::shared_ptr<RoomPreloadRequest> req = std::move(preload_queued);
+        lk.unlock();
+
+        // The room file is read by the asset manager's own thread
+        AssetReadResult read = req->Read.get();
+        std::unique_ptr<RoomStruct> room(new RoomStruct());
+        HError err = HError::None();
+        if (read.Data)
+        {
+            std::unique_ptr<Stream> in(new Stream(std::unique_ptr<VectorStream>(new VectorStream(*read.Data))));
+            err = LoadRoom(req->Filename, std::move(in), room.get(), req->GameIsHires, req->SpriteInfos);
+        }
+        else
+        {
+            err = new Error(String::FromFormat("Failed to read the room file '%s'.", req->Filename.GetCStr()));
+        }
+
+        lk.lock();
+        req->Err = err;
+        req->Data = std::move(room);
+        req->Done = true;
+        preload_done_cv.notify_all();
+    }
+}
+#endif
+
+void room_preload_request(int room)
+{
+#if defined(AGS_DISABLE_THREADS)
+    (void)room;
+#else
+    if ((room < 0) || (room == displayed_room) || !AssetMgr)
+        return;
+    if (preload_request && (preload_request->Room == room))
+        return; // already requested
+    const String filename = get_room_filename(room);
+    if (!AssetMgr->DoesAssetExist(filename))
+        return;
+
+    auto req = std::make_shared<RoomPreloadRequest>();
+    req->Room = room;
+    req->Filename = filename;
+    req->Read = AssetMgr->ReadAssetAsync(AssetPath(filename), 0, -1, kAssetRead_Low);
+    req->GameIsHires = game.IsLegacyHiRes();
+    req->SpriteInfos = game.SpriteInfos;
+    debug_script_log("Preloading room %d", room);
+
+    if (!preload_thread.joinable())
+        preload_thread = std::thread(preload_thread_func);
+    {
+        // the previous request, if not started yet, is simply replaced;
+        // if it's in progress, then the worker will finish it unclaimed
+        std::lock_guard<std::mutex> lk(preload_mutex);
+        preload_queued = req;
+    }
+    preload_request = req;
+    preload_wake_cv.notify_one();
+#endif
+}
+
+bool room_preload_take(int room, RoomStruct &room_data)
+{
+#if defined(AGS_DISABLE_THREADS)
+    (void)room; (void)room_data;
+    return false;
+#else
+    if (!preload_request || (preload_request->Room != room))
+        return false;
+    std::shared_ptr<RoomPreloadRequest> req = std::move(preload_request);
+    {
+        std::unique_lock<std::mutex> lk(preload_mutex);
+        preload_done_cv.wait(lk, [&req]() { return req->Done; });
+    }
+    if (!req->Err)
+    {
+        // let the normal loading report the error
+        Debug::Printf(kDbgMsg_Warn, "Failed to preload room %d: %s", room, req->Err->FullMessage().GetCStr());
+        return false;
+    }
+    room_data = *req->Data;
+    return true;
+#endif
+}
+
+void room_preload_shutdown()
+{
+#if !defined(AGS_DISABLE_THREADS)
+    if (preload_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lk(preload_mutex);
+            preload_thread_quit = true;
+            preload_queued.reset();
+        }
+        preload_wake_cv.notify_one();
+        preload_thread.join();
+        preload_thread_quit = false;
+    }
+#endif
+    preload_request.reset();
+    room_exits.clear();
+    last_hotspot = 0;
+}
+
+void room_preload_on_hotspot(int hotspot)
+{
+    last_hotspot = hotspot;
+}
+
+// Gets the exit at the given room position: an edge, if the position is
+// beyond one, or a hotspot; returns -1 if there's none
+static int get_room_exit_at(int x, int y)
+{
+    if (x <= thisroom.Edges.Left)
+        return 0;
+    if (x >= thisroom.Edges.Right)
+        return 1;
+    if (y >= thisroom.Edges.Bottom)
+        return 2;
+    if (y <= thisroom.Edges.Top)
+        return 3;
+    const int hotspot = get_hotspot_at(x, y);
+    return (hotspot > 0) ? ExitHotspotBase + hotspot : -1;
+}
+
+void room_preload_on_leave_room(int new_room)
+{
+    const int old_room = displayed_room;
+    const int hotspot = last_hotspot;
+    last_hotspot = 0;
+    if ((old_room < 0) || (new_room < 0) || (old_room == new_room) || !playerchar)
+        return;
+    // prefer the edge the player's standing beyond, then the hotspot
+    // the player has interacted with, as the player may be standing
+    // next to it rather than on it
+    int exit_id = get_room_exit_at(playerchar->x, playerchar->y);
+    if (((exit_id < 0) || (exit_id >= ExitHotspotBase)) && (hotspot > 0))
+        exit_id = ExitHotspotBase + hotspot;
+    if (exit_id >= 0)
+        room_exits[std::make_pair(old_room, exit_id)] = new_room;
+}
+
+void room_preload_update()
+{
+    if (!usetup.RoomPreload || room_exits.empty() || (displayed_room < 0) || !playerchar)
+        return;
+    // the exit which the player is walking to
+    int exit_id = -1;
+    if (playerchar->walking > 0)
+    {
+        const int move_id = playerchar->walking % TURNING_AROUND;
+        if (!is_route_pending(move_id) && (mls[move_id].numstage > 0))
+        {
+            const Point dest = mls[move_id].GetLastPos();
+            exit_id = get_room_exit_at(dest.X, dest.Y);
+        }
+    }
+    // or the hotspot under the cursor, which the player may be about to click
+    if (exit_id < 0)
+    {
+        const int hotspot = GetHotspotIDAtScreen(mousex, mousey);
+        if (hotspot > 0)
+            exit_id = ExitHotspotBase + hotspot;
+    }
+    if (exit_id < 0)
+        return;
+    const auto it = room_exits.find(std::make_pair(displayed_room, exit_id));
+    if (it != room_exits.end())
+        room_preload_request(it->second);
+}
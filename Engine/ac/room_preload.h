@@ -0,0 +1,48 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Background room preloading. The room file is read and parsed on a worker
+// thread, which also decodes the room backgrounds and masks, so that the
+// room change only has to take the ready room data.
+//
+// The room to preload is either requested by the script, or predicted from
+// the room exits which the player have used before: when the player walks
+// towards an edge, or points at a hotspot, which have led to another room,
+// then that room is preloaded.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__ROOMPRELOAD_H
+#define __AGS_EE_AC__ROOMPRELOAD_H
+
+#include "game/roomstruct.h"
+#include "util/error.h"
+
+// Requests the room to be preloaded in background; only one room is kept
+// preloaded, so requesting another room discards the previous one
+void room_preload_request(int room);
+// Takes the preloaded room data, waiting if it is still being loaded;
+// returns false if this room was not preloaded or failed to load
+bool room_preload_take(int room, AGS::Common::RoomStruct &room_data);
+// Discards the preloaded room and the remembered exits, stops the worker thread
+void room_preload_shutdown();
+// Remembers the hotspot which the player has interacted with,
+// as it may be the one which leads to another room
+void room_preload_on_hotspot(int hotspot);
+// Remembers the room exit which the player has used to leave the current room
+void room_preload_on_leave_room(int new_room);
+// Predicts the next room from the player's movement and the mouse cursor,
+// and requests it to be preloaded; does nothing unless enabled in setup
+void room_preload_update();
+
+#endif // __AGS_EE_AC__ROOMPRELOAD_H
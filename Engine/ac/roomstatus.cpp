@@ -18,6 +18,9 @@
 #include "ac/roomstatus.h"
 #include "game/customproperties.h"
 #include "game/savegame_components.h"
+#include "util/compress.h"
+#include "util/memory_compat.h"
+#include "util/memorystream.h"
 #include "util/string_utils.h"
 
 using namespace AGS::Common;
@@ -178,17 +181,48 @@ void RoomStatus::WriteToSavegame(Stream *out, GameDataVersion data_ver) const
     out->WriteInt32(0);
 }
 
-std::unique_ptr<RoomStatus> room_statuses[MAX_ROOMS];
+// RoomStatusSlot keeps the room status either unpacked, or packed as
+// the LZ4-compressed data in the savegame format
+struct RoomStatusSlot
+{
+    std::unique_ptr<RoomStatus> Status;
+    std::vector<uint8_t> Packed;
+    size_t UnpackedSize = 0u;
+    int BeenHere = 0; // a copy of the packed status' beenhere
+
+    bool IsValid() const { return Status || (UnpackedSize > 0); }
+};
+
+RoomStatusSlot room_statuses[MAX_ROOMS];
+
+// Decompresses the packed room status data
+static bool unpackRoomStatusData(const RoomStatusSlot &slot, std::vector<uint8_t> &data)
+{
+    data.resize(slot.UnpackedSize);
+    auto in = Stream::WrapMemory(std::make_unique<MemoryStream>(slot.Packed.data(), slot.Packed.size()));
+    return lz4_decompress(data.data(), data.size(), 1, in.get(), slot.Packed.size());
+}
 
 // Replaces all accesses to the roomstats array
 RoomStatus* getRoomStatus(int room)
 {
-    if (!room_statuses[room])
+    auto &slot = room_statuses[room];
+    if (!slot.Status)
     {
         // First access, allocate and initialise the status
-        room_statuses[room].reset(new RoomStatus());
+        slot.Status.reset(new RoomStatus());
+        if (slot.UnpackedSize > 0)
+        {
+            std::vector<uint8_t> data;
+            if (!unpackRoomStatusData(slot, data))
+                quitprintf("Failed to unpack the state of room %d", room);
+            auto in = Stream::WrapMemory(std::make_unique<MemoryStream>(data.data(), data.size()));
+            slot.Status->ReadFromSavegame(in.get(), loaded_game_file_version, kRoomStatSvgVersion_Current);
+            slot.Packed = {};
+            slot.UnpackedSize = 0u;
+        }
     }
-    return room_statuses[room].get();
+    return slot.Status.get();
 }
 
 // Used in places where it is only important to know whether the player
@@ -197,13 +231,59 @@ RoomStatus* getRoomStatus(int room)
 // a room if the status is already initialised.
 bool isRoomStatusValid(int room)
 {
-    return (room_statuses[room] != nullptr);
+    return room_statuses[room].IsValid();
+}
+
+int getRoomStatusBeenHere(int room)
+{
+    const auto &slot = room_statuses[room];
+    if (slot.Status)
+        return slot.Status->beenhere;
+    return slot.BeenHere;
+}
+
+void packRoomStatus(int room)
+{
+    auto &slot = room_statuses[room];
+    if (!slot.Status)
+        return; // not unpacked, or not valid
+    std::vector<uint8_t> data;
+    {
+        Stream out(std::make_unique<VectorStream>(data, kStream_Write));
+        slot.Status->WriteToSavegame(&out, loaded_game_file_version);
+    }
+    std::vector<uint8_t> packed;
+    {
+        Stream out(std::make_unique<VectorStream>(packed, kStream_Write));
+        if (!lz4_compress(data.data(), data.size(), 1, &out))
+            return; // keep unpacked
+    }
+    packed.shrink_to_fit();
+    slot.Packed = std::move(packed);
+    slot.UnpackedSize = data.size();
+    slot.BeenHere = slot.Status->beenhere;
+    slot.Status.reset();
+}
+
+void writeRoomStatusToSavegame(int room, Stream *out)
+{
+    const auto &slot = room_statuses[room];
+    if (slot.Status)
+    {
+        slot.Status->WriteToSavegame(out, loaded_game_file_version);
+        return;
+    }
+    // The packed data is already in the savegame format
+    std::vector<uint8_t> data;
+    if (!unpackRoomStatusData(slot, data))
+        quitprintf("Failed to unpack the state of room %d", room);
+    out->Write(data.data(), data.size());
 }
 
 void resetRoomStatuses()
 {
     for (int i = 0; i < MAX_ROOMS; i++)
     {
-        room_statuses[i].reset();
+        room_statuses[i] = RoomStatusSlot();
     }
 }
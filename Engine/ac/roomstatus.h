@@ -92,13 +92,24 @@ struct RoomStatus
     void WriteToSavegame(Common::Stream *out, GameDataVersion data_ver) const;
 };
 
-// Replaces all accesses to the roomstats array
+// Replaces all accesses to the roomstats array;
+// unpacks the room status if it was packed
 RoomStatus* getRoomStatus(int room);
 // Used in places where it is only important to know whether the player
 // had previously entered the room. In this case it is not necessary
 // to initialise the status because a player can only have been in
 // a room if the status is already initialised.
 bool isRoomStatusValid(int room);
+// Gets the room status' "beenhere" value, without unpacking the status;
+// returns 0 if there's no valid status
+int  getRoomStatusBeenHere(int room);
+// Packs the status of the room which the player is not in into the
+// compressed serialized form, to save memory; the pointers to this room
+// status become invalid
+void packRoomStatus(int room);
+// Writes the room status to the savegame, a packed status is written
+// directly from its packed data
+void writeRoomStatusToSavegame(int room, Stream *out);
 void resetRoomStatuses();
 
 #endif // __AGS_EE_AC__ROOMSTATUS_H
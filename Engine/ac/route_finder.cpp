@@ -24,7 +24,7 @@ class IRouteFinder
 public:
     virtual ~IRouteFinder() = default;
 
-    virtual void init_pathfinder() = 0;
+    virtual void init_pathfinder(bool hierarchical) = 0;
     virtual void shutdown_pathfinder() = 0;
     virtual void set_wallscreen(Bitmap *wallscreen) = 0;
     virtual int can_see_from(int x1, int y1, int x2, int y2) = 0;
@@ -34,14 +34,33 @@ public:
     // Append a waypoint to the move list, skip pathfinding
     virtual bool add_waypoint_direct(MoveList * mlsp, short x, short y, int move_speed_x, int move_speed_y) = 0;
     virtual void recalculate_move_speeds(MoveList *mlsp, int old_speed_x, int old_speed_y, int new_speed_x, int new_speed_y) = 0;
+    virtual int get_expanded_nodes() = 0;
+    // Routes from many starting points to the same destination
+    virtual void find_routes_to(const std::vector<RouteSource> &sources, short xx, short yy,
+        Bitmap *onscreen, std::vector<int> &results)
+    {
+        results.resize(sources.size());
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            const RouteSource &src = sources[i];
+            results[i] = find_route(src.X, src.Y, xx, yy, src.MoveSpeedX, src.MoveSpeedY, onscreen, src.MoveList, 1);
+        }
+    }
+    // Asynchronous route search
+    virtual bool find_route_async(short srcx, short srcy, short xx, short yy, int move_speed_x, int move_speed_y,
+        Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0) = 0;
+    virtual bool is_route_pending(int movlst) = 0;
+    virtual int complete_route(int movlst) = 0;
+    virtual void cancel_route(int movlst) = 0;
+    virtual void get_pending_routes(std::vector<int> &movlsts) = 0;
 };
 
 class AGSRouteFinder : public IRouteFinder 
 {
 public:
-    void init_pathfinder() override
+    void init_pathfinder(bool hierarchical) override
     { 
-        AGS::Engine::RouteFinder::init_pathfinder(); 
+        AGS::Engine::RouteFinder::init_pathfinder(hierarchical); 
     }
     void shutdown_pathfinder() override
     { 
@@ -73,12 +92,43 @@ public:
     {
         AGS::Engine::RouteFinder::recalculate_move_speeds(mlsp, old_speed_x, old_speed_y, new_speed_x, new_speed_y);
     }
+    int get_expanded_nodes() override
+    {
+        return AGS::Engine::RouteFinder::get_expanded_nodes();
+    }
+    void find_routes_to(const std::vector<RouteSource> &sources, short xx, short yy,
+        Bitmap *onscreen, std::vector<int> &results) override
+    {
+        AGS::Engine::RouteFinder::find_routes_to(sources, xx, yy, onscreen, results);
+    }
+    bool find_route_async(short srcx, short srcy, short xx, short yy, int move_speed_x, int move_speed_y,
+        Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0) override
+    {
+        return AGS::Engine::RouteFinder::find_route_async(srcx, srcy, xx, yy,
+            move_speed_x, move_speed_y, onscreen, movlst, nocross, ignore_walls);
+    }
+    bool is_route_pending(int movlst) override
+    {
+        return AGS::Engine::RouteFinder::is_route_pending(movlst);
+    }
+    int complete_route(int movlst) override
+    {
+        return AGS::Engine::RouteFinder::complete_route(movlst);
+    }
+    void cancel_route(int movlst) override
+    {
+        AGS::Engine::RouteFinder::cancel_route(movlst);
+    }
+    void get_pending_routes(std::vector<int> &movlsts) override
+    {
+        AGS::Engine::RouteFinder::get_pending_routes(movlsts);
+    }
 };
 
 class AGSLegacyRouteFinder : public IRouteFinder 
 {
 public:
-    void init_pathfinder() override
+    void init_pathfinder(bool /*hierarchical*/) override
     { 
         AGS::Engine::RouteFinderLegacy::init_pathfinder(); 
     }
@@ -112,11 +162,24 @@ public:
     {
         assert(false); // not supported
     }
+    int get_expanded_nodes() override
+    {
+        return AGS::Engine::RouteFinderLegacy::get_expanded_nodes();
+    }
+    bool find_route_async(short /*srcx*/, short /*srcy*/, short /*xx*/, short /*yy*/, int /*move_speed_x*/, int /*move_speed_y*/,
+        Bitmap * /*onscreen*/, int /*movlst*/, int /*nocross*/ = 0, int /*ignore_walls*/ = 0) override
+    {
+        return false; // not supported
+    }
+    bool is_route_pending(int /*movlst*/) override { return false; }
+    int complete_route(int /*movlst*/) override { return 0; }
+    void cancel_route(int /*movlst*/) override {}
+    void get_pending_routes(std::vector<int> &movlsts) override { movlsts.clear(); }
 };
 
 std::unique_ptr<IRouteFinder> route_finder_impl;
 
-void init_pathfinder(GameDataVersion game_file_version)
+void init_pathfinder(GameDataVersion game_file_version, bool hierarchical)
 {
     if (game_file_version >= kGameVersion_350) 
     {
@@ -129,7 +192,7 @@ void init_pathfinder(GameDataVersion game_file_version)
         route_finder_impl.reset(new AGSLegacyRouteFinder());
     }
 
-    route_finder_impl->init_pathfinder();
+    route_finder_impl->init_pathfinder(hierarchical);
 }
 
 void shutdown_pathfinder()
@@ -169,3 +232,41 @@ void recalculate_move_speeds(MoveList *mlsp, int old_speed_x, int old_speed_y, i
 {
     route_finder_impl->recalculate_move_speeds(mlsp, old_speed_x, old_speed_y, new_speed_x, new_speed_y);
 }
+
+int get_route_expanded_nodes()
+{
+    return route_finder_impl->get_expanded_nodes();
+}
+
+void find_routes_to(const std::vector<RouteSource> &sources, short xx, short yy,
+    Bitmap *onscreen, std::vector<int> &results)
+{
+    route_finder_impl->find_routes_to(sources, xx, yy, onscreen, results);
+}
+
+bool find_route_async(short srcx, short srcy, short xx, short yy, int move_speed_x, int move_speed_y,
+    Bitmap *onscreen, int movlst, int nocross, int ignore_walls)
+{
+    return route_finder_impl->find_route_async(srcx, srcy, xx, yy, move_speed_x, move_speed_y,
+        onscreen, movlst, nocross, ignore_walls);
+}
+
+bool is_route_pending(int movlst)
+{
+    return route_finder_impl->is_route_pending(movlst);
+}
+
+int complete_route(int movlst)
+{
+    return route_finder_impl->complete_route(movlst);
+}
+
+void cancel_route(int movlst)
+{
+    route_finder_impl->cancel_route(movlst);
+}
+
+void get_pending_routes(std::vector<int> &movlsts)
+{
+    route_finder_impl->get_pending_routes(movlsts);
+}
@@ -15,13 +15,16 @@
 #ifndef __AC_ROUTEFND_H
 #define __AC_ROUTEFND_H
 
+#include <vector>
 #include "ac/game_version.h"
 
 // Forward declaration
 namespace AGS { namespace Common { class Bitmap; }}
 struct MoveList;
 
-void init_pathfinder(GameDataVersion game_file_version);
+// Inits the path finder for the game; hierarchical search is only supported
+// by the pathfinder of the 3.5.0+ games
+void init_pathfinder(GameDataVersion game_file_version, bool hierarchical = false);
 void shutdown_pathfinder();
 
 void set_wallscreen(AGS::Common::Bitmap *wallscreen);
@@ -34,5 +37,38 @@ int find_route(short srcx, short srcy, short xx, short yy, int move_speed_x, int
 // Append a waypoint to the move list, skip pathfinding
 bool add_waypoint_direct(MoveList * mlsp, short x, short y, int move_speed_x, int move_speed_y);
 void recalculate_move_speeds(MoveList *mlsp, int old_speed_x, int old_speed_y, int new_speed_x, int new_speed_y);
+// Gets the number of nodes expanded by the last find_route call, for diagnostics
+int get_route_expanded_nodes();
+
+// Starting point and speed for a route searched by find_routes_to
+struct RouteSource
+{
+    short X = 0, Y = 0;
+    int MoveSpeedX = 0, MoveSpeedY = 0;
+    int MoveList = 0; // move list index to write the route to
+};
+
+// Finds the routes from many starting points to the same destination; the
+// pathfinder may calculate a single distance field from the destination, and
+// derive all the routes from it. Writes the move list index of each source to
+// results, or 0 if no route was found; destination on a wall is approached.
+void find_routes_to(const std::vector<RouteSource> &sources, short xx, short yy,
+    AGS::Common::Bitmap *onscreen, std::vector<int> &results);
+
+// Asynchronous route search: the route is found on a worker thread, using
+// the copy of the walkable mask, and written into the move list by complete_route.
+// Returns false if the current pathfinder does not support this, in which case
+// the caller should use find_route instead.
+bool find_route_async(short srcx, short srcy, short xx, short yy, int move_speed_x, int move_speed_y,
+    AGS::Common::Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0);
+// Tells if there's a route search requested for the move list
+bool is_route_pending(int movlst);
+// Waits for the requested route search to finish, and fills the move list;
+// returns movlst, or 0 if no route was found or nothing was requested
+int complete_route(int movlst);
+// Discards the requested route search
+void cancel_route(int movlst);
+// Gets the move lists which have route searches requested, in ascending order
+void get_pending_routes(std::vector<int> &movlsts);
 
 #endif // __AC_ROUTEFND_H
@@ -20,6 +20,14 @@
 
 #include <string.h>
 #include <math.h>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#if !defined(AGS_DISABLE_THREADS)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
 
 #include "ac/common.h"   // quit()
 #include "ac/movelist.h"     // MoveList
@@ -40,18 +48,49 @@ namespace Engine {
 namespace RouteFinder {
 
 static const int MAXNAVPOINTS = MAXNEEDSTAGES;
-static Point navpoints[MAXNAVPOINTS];
-static int num_navpoints;
 static Navigation nav;
 static Bitmap *wallscreen;
 static int lastcx, lastcy;
+static bool hierarchical_nav;
 
-void init_pathfinder()
+// Asynchronous route request, processed by the worker thread
+struct RouteRequest
 {
+  short srcx = 0, srcy = 0, xx = 0, yy = 0;
+  int move_speed_x = 0, move_speed_y = 0;
+  int nocross = 0, ignore_walls = 0;
+  // copy of the walkable mask
+  int width = 0, height = 0;
+  std::vector<unsigned char> mask;
+  // result
+  bool done = false;
+  bool found = false;
+  MoveList mlist;
+};
+
+// Requests by the move list index, both pending and complete
+static std::unordered_map<int, std::shared_ptr<RouteRequest>> route_requests;
+#if !defined(AGS_DISABLE_THREADS)
+static std::deque<std::shared_ptr<RouteRequest>> route_queue;
+static std::mutex route_mutex;
+static std::condition_variable route_wake_cv;
+static std::condition_variable route_done_cv;
+static std::thread route_thread;
+static bool route_thread_quit;
+#endif
+
+static void stop_route_thread();
+
+void init_pathfinder(bool hierarchical)
+{
+  hierarchical_nav = hierarchical;
+  nav.SetHierarchical(hierarchical);
 }
 
 void shutdown_pathfinder()
 {
+  stop_route_thread();
+  route_requests.clear();
 }
 
 void set_wallscreen(Bitmap *wallscreen_) 
@@ -87,18 +126,9 @@ void get_lastcpos(int &lastcx_, int &lastcy_)
   lastcy_ = lastcy;
 }
 
-// new routing using JPS
-static int find_route_jps(int fromx, int fromy, int destx, int desty)
+static void cpath_to_navpoints(const Navigation &nav_map, const std::vector<int> &cpath,
+  Point *navpoints, int &num_navpoints)
 {
-  sync_nav_wallscreen();
-
-  static std::vector<int> path, cpath;
-  path.clear();
-  cpath.clear();
-
-  if (nav.NavigateRefined(fromx, fromy, destx, desty, path, cpath) == Navigation::NAV_UNREACHABLE)
-    return 0;
-
   num_navpoints = 0;
 
   // new behavior: cut path if too complex rather than abort with error message
@@ -107,11 +137,25 @@ static int find_route_jps(int fromx, int fromy, int destx, int desty)
   for (int i = 0; i<count; i++)
   {
     int x, y;
-    nav.UnpackSquare(cpath[i], x, y);
+    nav_map.UnpackSquare(cpath[i], x, y);
 
     navpoints[num_navpoints++] = { x, y };
   }
+}
 
+// new routing using JPS
+static int find_route_jps(Navigation &nav_map, int fromx, int fromy, int destx, int desty,
+  std::vector<int> &path, std::vector<int> &cpath, Point *navpoints, int &num_navpoints)
+{
+  nav_map.UpdateMapCaches();
+
+  path.clear();
+  cpath.clear();
+
+  if (nav_map.NavigateRefined(fromx, fromy, destx, desty, path, cpath) == Navigation::NAV_UNREACHABLE)
+    return 0;
+
+  cpath_to_navpoints(nav_map, cpath, navpoints, num_navpoints);
   return 1;
 }
 
@@ -257,27 +301,42 @@ void recalculate_move_speeds(MoveList *mlsp, int old_speed_x, int old_speed_y, i
 }
 
 
-int find_route(short srcx, short srcy, short xx, short yy, int move_speed_x, int move_speed_y,
-    Bitmap *onscreen, int move_id, int nocross, int ignore_walls)
-{
-  wallscreen = onscreen;
+static bool make_move_list(Point *navpoints, int num_navpoints, short srcx, short srcy,
+    int move_speed_x, int move_speed_y, MoveList &mlist);
 
-  num_navpoints = 0;
+// Finds the route on the navigation's current map, and fills the move list;
+// lastcx_, lastcy_ receive the last passable point on the straight line
+static bool calc_route(Navigation &nav_map, short srcx, short srcy, short xx, short yy,
+    int move_speed_x, int move_speed_y, int nocross, int ignore_walls,
+    int &lastcx_, int &lastcy_, std::vector<int> &path, std::vector<int> &cpath, MoveList &mlist)
+{
+  Point navpoints[MAXNAVPOINTS];
+  int num_navpoints = 0;
 
-  if (ignore_walls || can_see_from(srcx, srcy, xx, yy))
+  lastcx_ = srcx;
+  lastcy_ = srcy;
+  if (ignore_walls || ((srcx == xx) && (srcy == yy)) ||
+      !nav_map.TraceLine(srcx, srcy, xx, yy, lastcx_, lastcy_))
   {
     num_navpoints = 2;
     navpoints[0] = { srcx, srcy };
     navpoints[1] = { xx, yy };
   } else {
-    if ((nocross == 0) && (wallscreen->GetPixel(xx, yy) == 0))
-      return 0; // clicked on a wall
+    if ((nocross == 0) && nav_map.IsWall(xx, yy))
+      return false; // clicked on a wall
 
-    find_route_jps(srcx, srcy, xx, yy);
+    find_route_jps(nav_map, srcx, srcy, xx, yy, path, cpath, navpoints, num_navpoints);
   }
 
+  return make_move_list(navpoints, num_navpoints, srcx, srcy, move_speed_x, move_speed_y, mlist);
+}
+
+// Fills the move list with the found navigation points
+static bool make_move_list(Point *navpoints, int num_navpoints, short srcx, short srcy,
+    int move_speed_x, int move_speed_y, MoveList &mlist)
+{
   if (!num_navpoints)
-    return 0;
+    return false;
 
   // FIXME: really necessary?
   if (num_navpoints == 1)
@@ -286,10 +345,10 @@ int find_route(short srcx, short srcy, short xx, short yy, int move_speed_x, int
   assert(num_navpoints <= MAXNAVPOINTS);
 
 #ifdef DEBUG_PATHFINDER
-  AGS::Common::Debug::Printf("Route from %d,%d to %d,%d - %d stages", srcx,srcy,xx,yy,num_navpoints);
+  AGS::Common::Debug::Printf("Route from %d,%d - %d stages", srcx,srcy,num_navpoints);
 #endif
 
-  MoveList mlist;
+  mlist = MoveList();
   mlist.numstage = num_navpoints;
   memcpy(&mlist.pos[0], &navpoints[0], sizeof(Point) * num_navpoints);
 #ifdef DEBUG_PATHFINDER
@@ -302,10 +361,198 @@ int find_route(short srcx, short srcy, short xx, short yy, int move_speed_x, int
     calculate_move_stage(&mlist, i, fix_speed_x, fix_speed_y);
 
   mlist.from = { srcx, srcy };
+  return true;
+}
+
+int find_route(short srcx, short srcy, short xx, short yy, int move_speed_x, int move_speed_y,
+    Bitmap *onscreen, int move_id, int nocross, int ignore_walls)
+{
+  wallscreen = onscreen;
+  sync_nav_wallscreen();
+  nav.ResetStats();
+
+  static std::vector<int> path, cpath;
+  MoveList mlist;
+  if (!calc_route(nav, srcx, srcy, xx, yy, move_speed_x, move_speed_y, nocross, ignore_walls,
+      lastcx, lastcy, path, cpath, mlist))
+    return 0;
+
   mls[move_id] = mlist;
   return move_id;
 }
 
+int get_expanded_nodes()
+{
+  return nav.GetExpandedNodes();
+}
+
+void find_routes_to(const std::vector<RouteSource> &sources, short xx, short yy,
+    Bitmap *onscreen, std::vector<int> &results)
+{
+  wallscreen = onscreen;
+  sync_nav_wallscreen();
+  nav.UpdateMapCaches();
+
+  // the field is calculated once, and then each route is made by descending it
+  const bool use_field = (sources.size() > 1) && nav.BuildFlowField(xx, yy);
+
+  static std::vector<int> path, cpath;
+  results.resize(sources.size());
+  for (size_t i = 0; i < sources.size(); ++i)
+  {
+    const RouteSource &src = sources[i];
+    MoveList mlist;
+    bool found = false;
+    if (use_field && (nav.NavigateFlowRefined(src.X, src.Y, path, cpath) != Navigation::NAV_UNREACHABLE))
+    {
+      Point navpoints[MAXNAVPOINTS];
+      int num_navpoints = 0;
+      cpath_to_navpoints(nav, cpath, navpoints, num_navpoints);
+      found = make_move_list(navpoints, num_navpoints, src.X, src.Y, src.MoveSpeedX, src.MoveSpeedY, mlist);
+    }
+    // the regular search takes them as close as possible to the unreachable target
+    if (!found)
+      found = calc_route(nav, src.X, src.Y, xx, yy, src.MoveSpeedX, src.MoveSpeedY, 1, 0,
+        lastcx, lastcy, path, cpath, mlist);
+
+    results[i] = found ? src.MoveList : 0;
+    if (found)
+      mls[src.MoveList] = mlist;
+  }
+}
+
+#if !defined(AGS_DISABLE_THREADS)
+static void route_thread_func()
+{
+  // the worker has its own navigation data, as the requests come with
+  // their own copies of the mask
+  Navigation wnav;
+  wnav.SetHierarchical(hierarchical_nav);
+  std::vector<int> path, cpath;
+
+  std::unique_lock<std::mutex> lk(route_mutex);
+  for (;;)
+  {
+    route_wake_cv.wait(lk, []() { return route_thread_quit || !route_queue.empty(); });
+    if (route_thread_quit)
+      return;
+
+    std::shared_ptr<RouteRequest> req = route_queue.front();
+    route_queue.pop_front();
+    lk.unlock();
+
+    wnav.Resize(req->width, req->height);
+    for (int y = 0; y < req->height; y++)
+      wnav.SetMapRow(y, &req->mask[y * req->width]);
+    int lx, ly;
+    const bool found = calc_route(wnav, req->srcx, req->srcy, req->xx, req->yy,
+      req->move_speed_x, req->move_speed_y, req->nocross, req->ignore_walls, lx, ly, path, cpath, req->mlist);
+
+    lk.lock();
+    req->found = found;
+    req->done = true;
+    route_done_cv.notify_all();
+  }
+}
+#endif
+
+static void stop_route_thread()
+{
+#if !defined(AGS_DISABLE_THREADS)
+  if (!route_thread.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lk(route_mutex);
+    route_thread_quit = true;
+    route_queue.clear();
+  }
+  route_wake_cv.notify_all();
+  route_thread.join();
+  route_thread_quit = false;
+#endif
+}
+
+bool find_route_async(short srcx, short srcy, short xx, short yy, int move_speed_x, int move_speed_y,
+    Bitmap *onscreen, int move_id, int nocross, int ignore_walls)
+{
+#if defined(AGS_DISABLE_THREADS)
+  return false;
+#else
+  cancel_route(move_id);
+
+  auto req = std::make_shared<RouteRequest>();
+  req->srcx = srcx; req->srcy = srcy;
+  req->xx = xx; req->yy = yy;
+  req->move_speed_x = move_speed_x; req->move_speed_y = move_speed_y;
+  req->nocross = nocross; req->ignore_walls = ignore_walls;
+  req->width = onscreen->GetWidth();
+  req->height = onscreen->GetHeight();
+  req->mask.resize(req->width * req->height);
+  for (int y = 0; y < req->height; y++)
+    memcpy(&req->mask[y * req->width], onscreen->GetScanLine(y), req->width);
+
+  if (!route_thread.joinable())
+    route_thread = std::thread(route_thread_func);
+  {
+    std::lock_guard<std::mutex> lk(route_mutex);
+    route_queue.push_back(req);
+  }
+  route_requests[move_id] = req;
+  route_wake_cv.notify_one();
+  return true;
+#endif
+}
+
+bool is_route_pending(int move_id)
+{
+  return route_requests.count(move_id) > 0;
+}
+
+int complete_route(int move_id)
+{
+  auto it = route_requests.find(move_id);
+  if (it == route_requests.end())
+    return 0;
+  std::shared_ptr<RouteRequest> req = it->second;
+  route_requests.erase(it);
+
+#if !defined(AGS_DISABLE_THREADS)
+  {
+    std::unique_lock<std::mutex> lk(route_mutex);
+    route_done_cv.wait(lk, [&req]() { return req->done; });
+  }
+#endif
+  if (!req->found)
+    return 0;
+  mls[move_id] = req->mlist;
+  return move_id;
+}
+
+void cancel_route(int move_id)
+{
+  auto it = route_requests.find(move_id);
+  if (it == route_requests.end())
+    return;
+#if !defined(AGS_DISABLE_THREADS)
+  {
+    // if it's in progress, then the worker will simply finish it unclaimed
+    std::lock_guard<std::mutex> lk(route_mutex);
+    auto qit = std::find(route_queue.begin(), route_queue.end(), it->second);
+    if (qit != route_queue.end())
+      route_queue.erase(qit);
+  }
+#endif
+  route_requests.erase(it);
+}
+
+void get_pending_routes(std::vector<int> &move_ids)
+{
+  move_ids.clear();
+  for (const auto &req : route_requests)
+    move_ids.push_back(req.first);
+  std::sort(move_ids.begin(), move_ids.end());
+}
+
 bool add_waypoint_direct(MoveList * mlsp, short x, short y, int move_speed_x, int move_speed_y)
 {
   if (mlsp->numstage >= MAXNEEDSTAGES)
@@ -15,7 +15,9 @@
 #ifndef __AC_ROUTE_FINDER_IMPL
 #define __AC_ROUTE_FINDER_IMPL
 
+#include <vector>
 #include "ac/game_version.h"
+#include "ac/route_finder.h"
 
 // Forward declaration
 namespace AGS { namespace Common { class Bitmap; }}
@@ -25,7 +27,9 @@ namespace AGS {
 namespace Engine {
 namespace RouteFinder {
 
-void init_pathfinder();
+// Inits the path finder; hierarchical enables the search through the map sectors
+// first, which is faster in the very large rooms
+void init_pathfinder(bool hierarchical);
 void shutdown_pathfinder();
 
 void set_wallscreen(AGS::Common::Bitmap *wallscreen);
@@ -36,6 +40,16 @@ void get_lastcpos(int &lastcx, int &lastcy);
 int find_route(short srcx, short srcy, short xx, short yy, int move_speed_x, int move_speed_y,
     AGS::Common::Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0);
 bool add_waypoint_direct(MoveList * mlsp, short x, short y, int move_speed_x, int move_speed_y);
+// Gets the number of nodes expanded by the last find_route call
+int get_expanded_nodes();
+void find_routes_to(const std::vector<RouteSource> &sources, short xx, short yy,
+    AGS::Common::Bitmap *onscreen, std::vector<int> &results);
+bool find_route_async(short srcx, short srcy, short xx, short yy, int move_speed_x, int move_speed_y,
+    AGS::Common::Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0);
+bool is_route_pending(int movlst);
+int complete_route(int movlst);
+void cancel_route(int movlst);
+void get_pending_routes(std::vector<int> &movlsts);
 void recalculate_move_speeds(MoveList *mlsp, int old_speed_x, int old_speed_y, int new_speed_x, int new_speed_y);
 
 } // namespace RouteFinder
@@ -46,6 +46,7 @@ namespace RouteFinderLegacy {
 static int *pathbackx = nullptr;
 static int *pathbacky = nullptr;
 static int waspossible = 1;
+static int expanded_nodes = 0;
 static int suggestx;
 static int suggesty;
 
@@ -285,6 +286,7 @@ static int try_this_square(int srcx, int srcy, int tox, int toy)
     return 0;
 
   nesting++;
+  expanded_nodes++;
   if (can_see_from(srcx, srcy, tox, toy)) {
     finalpartx = srcx;
     finalparty = srcy;
@@ -463,6 +465,7 @@ static int find_route_dijkstra(int fromx, int fromy, int destx, int desty, const
       if (visited[n] == -1)
         continue;
 
+      expanded_nodes++;
       i = visited[n] % wallscreen->GetWidth();
       j = visited[n] / wallscreen->GetWidth();
       granularity = walk_area_granularity[wallscreen->GetScanLine(j)[i]];
@@ -753,6 +756,7 @@ int find_route(short srcx, short srcy, short xx, short yy, int move_speed_x, int
 #endif
   wallscreen = onscreen;
   leftorright = 0;
+  expanded_nodes = 0;
   int aaa;
 
   if (wallscreen->GetHeight() > beenhere_array_size)
@@ -900,6 +904,11 @@ bool add_waypoint_direct(MoveList * mlsp, short x, short y, int move_speed_x, in
   return true;
 }
 
+int get_expanded_nodes()
+{
+  return expanded_nodes;
+}
+
 void shutdown_pathfinder()
 {
   if (pathbackx != nullptr) 
@@ -34,6 +34,8 @@ void get_lastcpos(int &lastcx, int &lastcy);
 int find_route(short srcx, short srcy, short xx, short yy, int move_speed_x, int move_speed_y,
     AGS::Common::Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0);
 bool add_waypoint_direct(MoveList * mlsp, short x, short y, int move_speed_x, int move_speed_y);
+// Gets the number of nodes expanded by the last find_route call
+int get_expanded_nodes();
 
 } // namespace RouteFinderLegacy
 } // namespace Engine
@@ -23,6 +23,7 @@
 #include <functional>
 #include <assert.h>
 #include <stddef.h>
+#include <string.h>
 #include <math.h>
 
 // TODO: this could be cleaned up/simplified ...
@@ -54,11 +55,33 @@ public:
 
 	NavResult Navigate(int sx, int sy, int ex, int ey, std::vector<int> &opath);
 
+	// calculates the distance field from the target over the whole map,
+	// which lets find the paths from any number of starting points to it
+	bool BuildFlowField(int ex, int ey);
+	// finds the path to the flow field's target, by descending the field
+	NavResult NavigateFlowRefined(int sx, int sy, std::vector<int> &opath, std::vector<int> &ncpath);
+
 	bool TraceLine(int srcx, int srcy, int targx, int targy, int &lastValidX, int &lastValidY) const;
 	bool TraceLine(int srcx, int srcy, int targx, int targy, std::vector<int> *rpath = nullptr) const;
 
 	inline void SetMapRow(int y, const unsigned char *row) {map[y] = row;}
 
+	// enables the hierarchical search, which first finds the route through
+	// the map sectors, and then refines it with the regular search
+	void SetHierarchical(bool on);
+
+	// updates the precomputed jump tables and sectors after the map rows were set;
+	// only the parts affected by the changed map pixels are recalculated
+	void UpdateMapCaches();
+
+	// number of the nodes taken from the open list by the searches,
+	// since the last ResetStats call; for diagnostics
+	inline int GetExpandedNodes() const { return expandedNodes; }
+	inline void ResetStats() { expandedNodes = 0; }
+
+	// tells if the cell is inside the map and not walkable
+	inline bool IsWall(int x, int y) const { return !Outside(x, y) && !Walkable(x, y); }
+
 	inline static int PackSquare(int x, int y);
 	inline static void UnpackSquare(int sq, int &x, int &y);
 
@@ -132,7 +155,64 @@ private:
 	// orthogonal only (this should correspond to what AGS is doing)
 	bool nodiag;
 
+	// precomputed orthogonal jumps (JPS+): for each cell and each of the
+	// 4 directions (+x, -x, +y, -y) the number of steps to the next jump point
+	// (marked with JUMP_FLAG), or to the last passable cell before the wall
+	static const unsigned short JUMP_FLAG = 0x8000;
+	static const unsigned short JUMP_DIST_MASK = 0x7fff;
+	std::vector<unsigned short> jumpTable[4];
+	bool jumpTablesValid;
+	// copy of the map the cached data was calculated for
+	std::vector<unsigned char> mapCopy;
+	bool mapCopyValid;
+
+	// hierarchical search (HPA*): the map is split into the square sectors,
+	// the connected walkable regions of each sector are found, and linked with
+	// the regions of the neighbouring sectors through the portals on the borders
+	static const int SECTOR_SIZE = 64;
+
+	struct Portal
+	{
+		// the cell on this side of the border
+		int cell;
+		// the region this portal belongs to
+		int region;
+		// the portal on the other side of the border
+		int link;
+	};
+
+	bool hierarchical;
+	bool sectorsValid;
+	int sectorsX;
+	int sectorsY;
+	// region index local to the cell's sector, 0 for the unwalkable cells
+	std::vector<unsigned short> cellRegion;
+	// number of regions in each sector
+	std::vector<unsigned short> sectorRegions;
+	// first global region id of each sector
+	std::vector<int> sectorRegionBase;
+	std::vector<Portal> portals;
+	// portals of each global region
+	std::vector<std::vector<int> > regionPortals;
+	// temporary buffers for the sector search
+	std::vector<int> fillStack;
+	std::vector<float> portalCost;
+	std::vector<int> portalPrev;
+	std::vector<tFrameId> portalFrame;
+	tFrameId portalFrameId;
+	std::vector<int> sectorPath;
+	std::vector<int> localPath;
+
+	// distance field towards the flow target, in FLOW_ORTHO_COST units per cell
+	static const int FLOW_ORTHO_COST = 5;
+	static const int FLOW_DIAG_COST = 7;
+	static const int FLOW_UNREACHABLE = 0x7fffffff;
+	std::vector<int> flowDist;
+	int flowTarget;
+	bool flowValid;
+
 	bool navLock;
+	int expandedNodes;
 
 	void IncFrameId();
 
@@ -145,6 +225,17 @@ private:
 
 	void AddPruned(int *buf, int &bcount, int x, int y) const;
 	bool HasForcedNeighbor(int x, int y, int dx, int dy) const;
+	void CalcJumpRow(int y);
+	void CalcJumpColumn(int x);
+	void UpdateJumpTables(int x0, int y0, int x1, int y1);
+	void UpdateSectors(int x0, int y0, int x1, int y1);
+	void LabelSector(int sx, int sy);
+	void FindPortals();
+	int GetRegion(int x, int y) const;
+	bool FindSectorPath(int sx, int sy, int ex, int ey);
+	NavResult NavigateHierarchical(int sx, int sy, int ex, int ey, std::vector<int> &opath);
+	// optimizes the found grid path, and makes the navpoint-compressed path
+	void RefinePath(int sx, int sy, std::vector<int> &opath, std::vector<int> &ncpath);
 	int FindJump(int x, int y, int dx, int dy, int ex, int ey);
 	int FindOrthoJump(int x, int y, int dx, int dy, int ex, int ey);
 
@@ -180,6 +271,7 @@ private:
 // this means that the maximum routing bitmap size we can handle is 23169x23169; should be more than enough!
 const float Navigation::DIST_SCALE_PACK = 2.0f;
 const float Navigation::DIST_SCALE_UNPACK = 1.0f / Navigation::DIST_SCALE_PACK;
+const int Navigation::FLOW_UNREACHABLE;
 
 Navigation::Navigation()
 	: mapWidth(0)
@@ -189,7 +281,17 @@ Navigation::Navigation()
 	, closest(0)
 	// no diagonal route - this should correspond to what AGS does
 	, nodiag(true)
+	, jumpTablesValid(false)
+	, mapCopyValid(false)
+	, hierarchical(false)
+	, sectorsValid(false)
+	, sectorsX(0)
+	, sectorsY(0)
+	, portalFrameId(0)
+	, flowTarget(-1)
+	, flowValid(false)
 	, navLock(false)
+	, expandedNodes(0)
 {
 }
 
@@ -202,6 +304,29 @@ void Navigation::Resize(int width, int height)
 
 	map.resize(mapHeight);
 	mapNodes.resize(size);
+
+	if (mapCopyValid && mapCopy.size() == (size_t)size)
+		return; // same size, changes will be detected by UpdateMapCaches
+	mapCopyValid = false;
+	mapCopy.clear();
+	jumpTablesValid = false;
+	for (int i = 0; i < 4; i++)
+		jumpTable[i].clear();
+	sectorsValid = false;
+	cellRegion.clear();
+	flowValid = false;
+}
+
+void Navigation::SetHierarchical(bool on)
+{
+	hierarchical = on;
+	if (!on)
+	{
+		sectorsValid = false;
+		cellRegion.clear();
+		portals.clear();
+		regionPortals.clear();
+	}
 }
 
 void Navigation::IncFrameId()
@@ -281,10 +406,457 @@ bool Navigation::HasForcedNeighbor(int x, int y, int dx, int dy) const
 		(!Passable(x, y - dy) && Passable(x + dx, y - dy));
 }
 
+void Navigation::CalcJumpRow(int y)
+{
+	unsigned short *fwd = &jumpTable[0][y*mapWidth];
+	unsigned short *back = &jumpTable[1][y*mapWidth];
+
+	unsigned short next = 0;
+	for (int x = mapWidth-1; x >= 0; x--)
+	{
+		fwd[x] = next;
+		if (!Walkable(x, y))
+			next = 0;
+		else if (HasForcedNeighbor(x, y, 1, 0))
+			next = 1 | JUMP_FLAG;
+		else
+			next = (next & JUMP_FLAG) | ((next & JUMP_DIST_MASK) + 1);
+	}
+
+	next = 0;
+	for (int x = 0; x < mapWidth; x++)
+	{
+		back[x] = next;
+		if (!Walkable(x, y))
+			next = 0;
+		else if (HasForcedNeighbor(x, y, -1, 0))
+			next = 1 | JUMP_FLAG;
+		else
+			next = (next & JUMP_FLAG) | ((next & JUMP_DIST_MASK) + 1);
+	}
+}
+
+void Navigation::CalcJumpColumn(int x)
+{
+	unsigned short *fwd = &jumpTable[2][x];
+	unsigned short *back = &jumpTable[3][x];
+
+	unsigned short next = 0;
+	for (int y = mapHeight-1; y >= 0; y--)
+	{
+		fwd[y*mapWidth] = next;
+		if (!Walkable(x, y))
+			next = 0;
+		else if (HasForcedNeighbor(x, y, 0, 1))
+			next = 1 | JUMP_FLAG;
+		else
+			next = (next & JUMP_FLAG) | ((next & JUMP_DIST_MASK) + 1);
+	}
+
+	next = 0;
+	for (int y = 0; y < mapHeight; y++)
+	{
+		back[y*mapWidth] = next;
+		if (!Walkable(x, y))
+			next = 0;
+		else if (HasForcedNeighbor(x, y, 0, -1))
+			next = 1 | JUMP_FLAG;
+		else
+			next = (next & JUMP_FLAG) | ((next & JUMP_DIST_MASK) + 1);
+	}
+}
+
+void Navigation::UpdateMapCaches()
+{
+	const int size = mapWidth*mapHeight;
+	int x0 = 0, y0 = 0, x1 = mapWidth-1, y1 = mapHeight-1;
+	if (!mapCopyValid)
+	{
+		mapCopy.resize(size);
+		for (int y = 0; y < mapHeight; y++)
+			memcpy(&mapCopy[y*mapWidth], map[y], mapWidth);
+		mapCopyValid = true;
+		jumpTablesValid = false;
+		sectorsValid = false;
+	}
+	else
+	{
+		// find the bounds of the changed area, and update the map copy
+		x0 = mapWidth; y0 = mapHeight; x1 = -1; y1 = -1;
+		for (int y = 0; y < mapHeight; y++)
+		{
+			unsigned char *copy = &mapCopy[y*mapWidth];
+			if (memcmp(copy, map[y], mapWidth) == 0)
+				continue;
+			int l = 0, r = mapWidth-1;
+			while (copy[l] == map[y][l]) l++;
+			while (copy[r] == map[y][r]) r--;
+			x0 = std::min(x0, l); x1 = std::max(x1, r);
+			y0 = std::min(y0, y); y1 = std::max(y1, y);
+			memcpy(copy, map[y], mapWidth);
+		}
+	}
+
+	if (x1 >= 0)
+		flowValid = false;
+	UpdateJumpTables(x0, y0, x1, y1);
+	if (hierarchical)
+		UpdateSectors(x0, y0, x1, y1);
+}
+
+void Navigation::UpdateJumpTables(int x0, int y0, int x1, int y1)
+{
+	// the distances must fit into the table entries
+	if (mapWidth > JUMP_DIST_MASK || mapHeight > JUMP_DIST_MASK)
+	{
+		jumpTablesValid = false;
+		return;
+	}
+
+	if (!jumpTablesValid)
+	{
+		for (int i = 0; i < 4; i++)
+			jumpTable[i].resize(mapWidth*mapHeight);
+		x0 = 0; y0 = 0; x1 = mapWidth-1; y1 = mapHeight-1;
+	}
+	else if (x1 < 0)
+	{
+		return; // nothing changed
+	}
+	else
+	{
+		// forced neighbors depend on the adjacent rows and columns
+		x0 = std::max(0, x0-1); x1 = std::min(mapWidth-1, x1+1);
+		y0 = std::max(0, y0-1); y1 = std::min(mapHeight-1, y1+1);
+	}
+
+	for (int y = y0; y <= y1; y++)
+		CalcJumpRow(y);
+	for (int x = x0; x <= x1; x++)
+		CalcJumpColumn(x);
+	jumpTablesValid = true;
+}
+
+void Navigation::UpdateSectors(int x0, int y0, int x1, int y1)
+{
+	if (!sectorsValid)
+	{
+		sectorsX = (mapWidth + SECTOR_SIZE - 1) / SECTOR_SIZE;
+		sectorsY = (mapHeight + SECTOR_SIZE - 1) / SECTOR_SIZE;
+		cellRegion.resize(mapWidth*mapHeight);
+		sectorRegions.resize(sectorsX*sectorsY);
+		x0 = 0; y0 = 0; x1 = mapWidth-1; y1 = mapHeight-1;
+	}
+	else if (x1 < 0)
+	{
+		return; // nothing changed
+	}
+
+	for (int sy = y0 / SECTOR_SIZE; sy <= y1 / SECTOR_SIZE; sy++)
+		for (int sx = x0 / SECTOR_SIZE; sx <= x1 / SECTOR_SIZE; sx++)
+			LabelSector(sx, sy);
+	FindPortals();
+	sectorsValid = true;
+}
+
+void Navigation::LabelSector(int sx, int sy)
+{
+	const int left = sx * SECTOR_SIZE;
+	const int top = sy * SECTOR_SIZE;
+	const int right = std::min(left + SECTOR_SIZE, mapWidth);
+	const int bottom = std::min(top + SECTOR_SIZE, mapHeight);
+
+	for (int y = top; y < bottom; y++)
+		for (int x = left; x < right; x++)
+			cellRegion[y*mapWidth+x] = 0;
+
+	// flood fill the orthogonally connected cells, which matches the
+	// reachability of the nodiag search
+	unsigned short count = 0;
+	for (int y = top; y < bottom; y++)
+	{
+		for (int x = left; x < right; x++)
+		{
+			if (!Walkable(x, y) || cellRegion[y*mapWidth+x])
+				continue;
+
+			const unsigned short region = ++count;
+			cellRegion[y*mapWidth+x] = region;
+			fillStack.clear();
+			fillStack.push_back(PackSquare(x, y));
+			while (!fillStack.empty())
+			{
+				int cx, cy;
+				UnpackSquare(fillStack.back(), cx, cy);
+				fillStack.pop_back();
+
+				static const int offs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+				for (int i = 0; i < 4; i++)
+				{
+					const int nx = cx + offs[i][0];
+					const int ny = cy + offs[i][1];
+					if (nx < left || nx >= right || ny < top || ny >= bottom)
+						continue;
+					unsigned short &nregion = cellRegion[ny*mapWidth+nx];
+					if (nregion || !Walkable(nx, ny))
+						continue;
+					nregion = region;
+					fillStack.push_back(PackSquare(nx, ny));
+				}
+			}
+		}
+	}
+	sectorRegions[sy*sectorsX+sx] = count;
+}
+
+int Navigation::GetRegion(int x, int y) const
+{
+	const unsigned short region = cellRegion[y*mapWidth+x];
+	if (!region)
+		return -1;
+	return sectorRegionBase[(y / SECTOR_SIZE) * sectorsX + x / SECTOR_SIZE] + region - 1;
+}
+
+void Navigation::FindPortals()
+{
+	int regionCount = 0;
+	sectorRegionBase.resize(sectorsX*sectorsY);
+	for (int i = 0; i < sectorsX*sectorsY; i++)
+	{
+		sectorRegionBase[i] = regionCount;
+		regionCount += sectorRegions[i];
+	}
+
+	portals.clear();
+	regionPortals.resize(regionCount);
+	for (auto &rp : regionPortals)
+		rp.clear();
+
+	// each run of the cell pairs on the sector border, connecting the same
+	// two regions, makes a pair of portals in the middle of the run
+	for (int vert = 0; vert < 2; vert++)
+	{
+		const int borders = vert ? sectorsY : sectorsX;
+		const int length = vert ? mapWidth : mapHeight;
+		for (int b = 1; b < borders; b++)
+		{
+			const int pos = b * SECTOR_SIZE;
+			int runStart = -1, runA = -1, runB = -1;
+			for (int i = 0; i <= length; i++)
+			{
+				int ra = -1, rb = -1;
+				if (i < length)
+				{
+					ra = vert ? GetRegion(i, pos-1) : GetRegion(pos-1, i);
+					rb = vert ? GetRegion(i, pos) : GetRegion(pos, i);
+				}
+				if (ra >= 0 && rb >= 0 && ra == runA && rb == runB)
+					continue;
+
+				if (runStart >= 0)
+				{
+					const int mid = (runStart + i - 1) / 2;
+					const int pa = (int)portals.size();
+					Portal a, pb;
+					a.cell = vert ? PackSquare(mid, pos-1) : PackSquare(pos-1, mid);
+					a.region = runA;
+					a.link = pa + 1;
+					pb.cell = vert ? PackSquare(mid, pos) : PackSquare(pos, mid);
+					pb.region = runB;
+					pb.link = pa;
+					portals.push_back(a);
+					portals.push_back(pb);
+					regionPortals[runA].push_back(pa);
+					regionPortals[runB].push_back(pa + 1);
+				}
+
+				if (ra >= 0 && rb >= 0)
+				{
+					runStart = i; runA = ra; runB = rb;
+				}
+				else
+				{
+					runStart = -1; runA = -1; runB = -1;
+				}
+			}
+		}
+	}
+}
+
+bool Navigation::FindSectorPath(int sx, int sy, int ex, int ey)
+{
+	// A* over the portals; the costs inside the regions are approximated
+	// by the straight distance, the exact route is found by the refinement
+	const int startRegion = GetRegion(sx, sy);
+	const int endRegion = GetRegion(ex, ey);
+	const int count = (int)portals.size();
+	const int goal = count;
+
+	if (portalFrame.size() != (size_t)count + 1)
+	{
+		portalCost.assign(count + 1, 0.f);
+		portalPrev.assign(count + 1, -1);
+		portalFrame.assign(count + 1, 0);
+	}
+
+	if (++portalFrameId == 0)
+	{
+		std::fill(portalFrame.begin(), portalFrame.end(), 0);
+		portalFrameId = 1;
+	}
+
+	while (!pq.empty())
+		pq.pop();
+
+	auto dist = [](int ax, int ay, int bx, int by)
+	{
+		const float dx = (float)(ax - bx), dy = (float)(ay - by);
+		return sqrtf(dx*dx + dy*dy);
+	};
+
+	auto visit = [&](int node, int prev, float cost)
+	{
+		if (portalFrame[node] == portalFrameId && portalCost[node] <= cost)
+			return;
+		portalFrame[node] = portalFrameId;
+		portalCost[node] = cost;
+		portalPrev[node] = prev;
+		float heur = 0.f;
+		if (node != goal)
+		{
+			int x, y;
+			UnpackSquare(portals[node].cell, x, y);
+			heur = dist(x, y, ex, ey);
+		}
+		pq.push(Entry(cost + heur, node));
+	};
+
+	for (int p : regionPortals[startRegion])
+	{
+		int x, y;
+		UnpackSquare(portals[p].cell, x, y);
+		visit(p, -1, dist(sx, sy, x, y));
+	}
+
+	bool found = false;
+	while (!pq.empty())
+	{
+		Entry e = pq.top();
+		pq.pop();
+		const int node = e.index;
+		if (node == goal)
+		{
+			found = true;
+			break;
+		}
+
+		const Portal &portal = portals[node];
+		const float cost = portalCost[node];
+		int x, y;
+		UnpackSquare(portal.cell, x, y);
+
+		// already reached with a lower cost
+		if (e.cost > cost + dist(x, y, ex, ey) + 0.001f)
+			continue;
+
+		visit(portal.link, node, cost + 1.f);
+		for (int p : regionPortals[portal.region])
+		{
+			if (p == node)
+				continue;
+			int px, py;
+			UnpackSquare(portals[p].cell, px, py);
+			visit(p, node, cost + dist(x, y, px, py));
+		}
+		if (portal.region == endRegion)
+			visit(goal, node, cost + dist(x, y, ex, ey));
+	}
+
+	if (!found)
+		return false;
+
+	sectorPath.clear();
+	for (int node = portalPrev[goal]; node >= 0; node = portalPrev[node])
+		sectorPath.push_back(portals[node].cell);
+	std::reverse(sectorPath.begin(), sectorPath.end());
+	return true;
+}
+
+Navigation::NavResult Navigation::NavigateHierarchical(int sx, int sy, int ex, int ey, std::vector<int> &opath)
+{
+	if (!sectorsValid || !Passable(sx, sy) || !Passable(ex, ey) ||
+		GetRegion(sx, sy) == GetRegion(ex, ey))
+		return Navigate(sx, sy, ex, ey, opath);
+
+	// try ray first, if reachable, no need for any search
+	if (!TraceLine(sx, sy, ex, ey, &opath))
+		return NAV_STRAIGHT;
+
+	// the regular search handles the routing towards the unreachable target
+	if (!FindSectorPath(sx, sy, ex, ey))
+		return Navigate(sx, sy, ex, ey, opath);
+
+	sectorPath.push_back(PackSquare(ex, ey));
+	opath.clear();
+	opath.push_back(PackSquare(sx, sy));
+	for (int i = 0, fx = sx, fy = sy; i < (int)sectorPath.size(); i++)
+	{
+		int tx, ty;
+		UnpackSquare(sectorPath[i], tx, ty);
+		if (fx == tx && fy == ty)
+			continue;
+
+		localPath.clear();
+		const NavResult res = Navigate(fx, fy, tx, ty, localPath);
+		if (res == NAV_UNREACHABLE || localPath.empty() || localPath.back() != sectorPath[i])
+			return Navigate(sx, sy, ex, ey, opath); // should not happen, but just in case
+
+		opath.insert(opath.end(), localPath.begin() + 1, localPath.end());
+		fx = tx;
+		fy = ty;
+	}
+	return NAV_PATH;
+}
+
 int Navigation::FindOrthoJump(int x, int y, int dx, int dy, int ex, int ey)
 {
 	assert((!dx || !dy) && (dx || dy));
 
+	if (jumpTablesValid)
+	{
+		const int dir = dx ? (dx > 0 ? 0 : 1) : (dy > 0 ? 2 : 3);
+		const unsigned short jump = jumpTable[dir][y*mapWidth+x];
+		const int steps = jump & JUMP_DIST_MASK;
+		if (!steps)
+			return -1;
+
+		// the target is found before the jump point
+		const int tsteps = dx ? (ey == y ? (ex - x) * dx : -1) : (ex == x ? (ey - y) * dy : -1);
+		if (tsteps > 0 && tsteps <= steps)
+		{
+			if (closest > 0)
+			{
+				closest = 0;
+				cnode = PackSquare(ex, ey);
+			}
+			return PackSquare(ex, ey);
+		}
+
+		// the cell of the passed segment closest to the target
+		const int jx = x + dx*steps;
+		const int jy = y + dy*steps;
+		const int cx = iclamp(ex, std::min(x+dx, jx), std::max(x+dx, jx));
+		const int cy = iclamp(ey, std::min(y+dy, jy), std::max(y+dy, jy));
+		const int edist = ClosestDist(cx - ex, cy - ey);
+		if (edist < closest)
+		{
+			closest = edist;
+			cnode = PackSquare(cx, cy);
+		}
+
+		return (jump & JUMP_FLAG) ? PackSquare(jx, jy) : -1;
+	}
+
 	for (;;)
 	{
 		x += dx;
@@ -381,6 +953,7 @@ Navigation::NavResult Navigation::Navigate(int sx, int sy, int ex, int ey, std::
 	{
 		Entry e = pq.top();
 		pq.pop();
+		expandedNodes++;
 
 		int x, y;
 		UnpackSquare(e.index, x, y);
@@ -664,12 +1237,123 @@ Navigation::NavResult Navigation::Navigate(int sx, int sy, int ex, int ey, std::
 	return NAV_PATH;
 }
 
+bool Navigation::BuildFlowField(int ex, int ey)
+{
+	if (!Passable(ex, ey))
+		return false;
+	if (flowValid && flowTarget == PackSquare(ex, ey))
+		return true;
+
+	// Dijkstra from the target over the whole map
+	flowDist.assign(mapWidth*mapHeight, FLOW_UNREACHABLE);
+	flowDist[ey*mapWidth+ex] = 0;
+
+	while (!pq.empty())
+		pq.pop();
+	pq.push(Entry(0.0f, PackSquare(ex, ey)));
+
+	while (!pq.empty())
+	{
+		Entry e = pq.top();
+		pq.pop();
+
+		int x, y;
+		UnpackSquare(e.index, x, y);
+		const int dist = flowDist[y*mapWidth+x];
+		if (e.cost > (float)dist)
+			continue; // already reached by a shorter path
+
+		for (int ny = y-1; ny <= y+1; ny++)
+		{
+			for (int nx = x-1; nx <= x+1; nx++)
+			{
+				if ((nx == x && ny == y) || !Passable(nx, ny))
+					continue;
+
+				const bool diag = nx != x && ny != y;
+				if (diag && nodiag && !Reachable(x, y, nx, ny))
+					continue;
+
+				const int ndist = dist + (diag ? FLOW_DIAG_COST : FLOW_ORTHO_COST);
+				int &cur = flowDist[ny*mapWidth+nx];
+				if (ndist < cur)
+				{
+					cur = ndist;
+					pq.push(Entry((float)ndist, PackSquare(nx, ny)));
+				}
+			}
+		}
+	}
+
+	flowTarget = PackSquare(ex, ey);
+	flowValid = true;
+	return true;
+}
+
+Navigation::NavResult Navigation::NavigateFlowRefined(int sx, int sy, std::vector<int> &opath,
+	std::vector<int> &ncpath)
+{
+	opath.clear();
+	ncpath.clear();
+
+	if (!flowValid || !Passable(sx, sy) || flowDist[sy*mapWidth+sx] == FLOW_UNREACHABLE)
+		return NAV_UNREACHABLE;
+
+	int ex, ey;
+	UnpackSquare(flowTarget, ex, ey);
+
+	// try ray first, if reachable, no need for the field at all
+	if (!TraceLine(sx, sy, ex, ey, &opath))
+	{
+		ncpath.push_back(opath[0]);
+		ncpath.push_back(opath.back());
+		return NAV_STRAIGHT;
+	}
+
+	// descend the field, the distance decreases with every step
+	opath.clear();
+	opath.push_back(PackSquare(sx, sy));
+	for (int x = sx, y = sy; x != ex || y != ey;)
+	{
+		int best = flowDist[y*mapWidth+x];
+		int bx = x, by = y;
+		for (int ny = y-1; ny <= y+1; ny++)
+		{
+			for (int nx = x-1; nx <= x+1; nx++)
+			{
+				if ((nx == x && ny == y) || !Passable(nx, ny))
+					continue;
+				if (nodiag && nx != x && ny != y && !Reachable(x, y, nx, ny))
+					continue;
+				if (flowDist[ny*mapWidth+nx] < best)
+				{
+					best = flowDist[ny*mapWidth+nx];
+					bx = nx;
+					by = ny;
+				}
+			}
+		}
+
+		assert(bx != x || by != y);
+		if (bx == x && by == y)
+			return NAV_UNREACHABLE; // should not happen
+		x = bx;
+		y = by;
+		opath.push_back(PackSquare(x, y));
+	}
+
+	RefinePath(sx, sy, opath, ncpath);
+	return NAV_PATH;
+}
+
 Navigation::NavResult Navigation::NavigateRefined(int sx, int sy, int ex, int ey,
 	std::vector<int> &opath, std::vector<int> &ncpath)
 {
 	ncpath.clear();
 
-	NavResult res = Navigate(sx, sy, ex, ey, opath);
+	NavResult res = hierarchical ?
+		NavigateHierarchical(sx, sy, ex, ey, opath) :
+		Navigate(sx, sy, ex, ey, opath);
 
 	if (res != NAV_PATH)
 	{
@@ -682,6 +1366,12 @@ Navigation::NavResult Navigation::NavigateRefined(int sx, int sy, int ex, int ey
 		return res;
 	}
 
+	RefinePath(sx, sy, opath, ncpath);
+	return NAV_PATH;
+}
+
+void Navigation::RefinePath(int sx, int sy, std::vector<int> &opath, std::vector<int> &ncpath)
+{
 	fpath.clear();
 	ncpathIndex.clear();
 
@@ -806,7 +1496,7 @@ Navigation::NavResult Navigation::NavigateRefined(int sx, int sy, int ex, int ey
 	}
 
 	if (!adjusted)
-		return NAV_PATH;
+		return;
 
 	// final step (if necessary) is to reconstruct path from compressed path
 
@@ -826,8 +1516,6 @@ Navigation::NavResult Navigation::NavigateRefined(int sx, int sy, int ex, int ey
 		for (int j=1; j<(int)rayPath.size(); j++)
 			opath.push_back(rayPath[j]);
 	}
-
-	return NAV_PATH;
 }
 
 bool Navigation::TraceLine(int srcx, int srcy, int targx, int targy, int &lastValidX, int &lastValidY) const
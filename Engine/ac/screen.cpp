@@ -29,6 +29,8 @@
 #include "plugin/agsplugin_evts.h"
 #include "plugin/plugin_engine.h"
 #include "gfx/bitmap.h"
+#include "gfx/bitmappool.h"
+#include "gfx/blender.h"
 #include "gfx/graphicsdriver.h"
 
 using namespace AGS::Common;
@@ -40,7 +42,7 @@ extern AGSPlatformDriver *platform;
 extern int displayed_room;
 extern RGB palette[256];
 
-std::unique_ptr<Bitmap> saved_viewport_bitmap;
+PooledBitmap saved_viewport_bitmap;
 RGB old_palette[256];
 
 
@@ -56,7 +58,9 @@ RGB old_palette[256];
 // but these were not supposed to get on screen until before fade-in.
 //
 // This special fade-out behavior may be deprecated later if wanted.
-static std::unique_ptr<Bitmap> game_frame_to_bmp(bool for_fadein)
+// The frame bitmap is leased from the global pool, so that the transitions
+// which follow each other do not allocate the frame every time.
+static PooledBitmap game_frame_to_bmp(bool for_fadein)
 {
     get_palette(old_palette);
     const auto &view = play.GetMainViewport();
@@ -67,12 +71,13 @@ static std::unique_ptr<Bitmap> game_frame_to_bmp(bool for_fadein)
         construct_game_screen_overlay(false);
         gfxDriver->RenderToBackBuffer();
     }
-    return std::unique_ptr<Bitmap>(
-        CopyScreenIntoBitmap(view.GetWidth(), view.GetHeight(),
-        &view, true /* always in native res */, RENDER_SHOT_SKIP_ON_FADE));
+    PooledBitmap frame = BitmapPool::Global().Acquire(view.GetWidth(), view.GetHeight(), game.GetColorDepth());
+    CopyScreenIntoBitmap(frame.get(), &view, true /* always in native res */, RENDER_SHOT_SKIP_ON_FADE);
+    return frame;
 }
 
-static IDriverDependantBitmap* get_frame_for_transition_in(bool opaque)
+// Fixes up the saved frame for the transition in
+static void fix_frame_for_transition_in()
 {
     assert(saved_viewport_bitmap);
     if (!saved_viewport_bitmap)
@@ -85,12 +90,18 @@ static IDriverDependantBitmap* get_frame_for_transition_in(bool opaque)
     const Rect &viewport = play.GetMainViewport();
     if (saved_viewport_bitmap->GetHeight() != viewport.GetHeight())
     {
-        Bitmap *fix_frame = BitmapHelper::CreateBitmap(saved_viewport_bitmap->GetWidth(), viewport.GetHeight(), saved_viewport_bitmap->GetColorDepth());
+        PooledBitmap fix_frame = BitmapPool::Global().Acquire(saved_viewport_bitmap->GetWidth(), viewport.GetHeight(), saved_viewport_bitmap->GetColorDepth());
+        fix_frame->Clear();
         fix_frame->Blit(saved_viewport_bitmap.get(),
             0, 0, 0, (viewport.GetHeight() - saved_viewport_bitmap->GetHeight()) / 2,
             saved_viewport_bitmap->GetWidth(), saved_viewport_bitmap->GetHeight());
-        saved_viewport_bitmap.reset(fix_frame);
+        saved_viewport_bitmap = std::move(fix_frame);
     }
+}
+
+static IDriverDependantBitmap* get_frame_for_transition_in(bool opaque)
+{
+    fix_frame_for_transition_in();
     return gfxDriver->CreateDDBFromBitmap(saved_viewport_bitmap.get(), false, opaque);
 }
 
@@ -281,7 +292,7 @@ public:
         {
             _bmpBuff->Fill(_clearCol);
             set_trans_blender(0, 0, 0, _fadein ? _alpha : 255 - _alpha);
-            _bmpBuff->TransBlendBlt(_bmpFrame.get(), _view.Left, _view.Top);
+            draw_trans_sprite32(_bmpBuff->GetAllegroBitmap(), _bmpFrame->GetAllegroBitmap(), _view.Left, _view.Top);
             render_to_screen();
         }
         else
@@ -326,7 +337,7 @@ private:
 
     // High-color state
     Bitmap *_bmpBuff = nullptr;
-    std::unique_ptr<Bitmap> _bmpFrame;
+    PooledBitmap _bmpFrame;
     int _clearCol = 0;
 
     // 256-color state
@@ -485,7 +496,7 @@ public:
 
 private:
     Bitmap *_bmpBuff = nullptr;
-    std::unique_ptr<Bitmap> _bmpFrame;
+    PooledBitmap _bmpFrame;
     int _yspeed = 0;
     int _boxWidth = 0;
     int _boxHeight = 0;
@@ -564,7 +575,19 @@ public:
         play.screen_is_faded_out = 0; // force all game elements to draw
         _view = play.GetMainViewport();
         _sprTrans = play.GetGlobalTransform(gfxDriver->RequiresFullRedrawEachFrame());
-        _shot_ddb = get_frame_for_transition_in(false /* transparent */);
+        // The 8-bit frame must be reuploaded anyway, as its palette changes
+        _alphaTest = (game.color_depth > 1) && gfxDriver->SupportsAlphaTest();
+        if (_alphaTest)
+        {
+            fix_frame_for_transition_in();
+            PooledBitmap frame = make_dissolve_frame(saved_viewport_bitmap.get());
+            _shot_ddb = gfxDriver->CreateDDBFromBitmap(frame.get(), true);
+            gfxDriver->SetDDBAlphaTest(_shot_ddb, 1);
+        }
+        else
+        {
+            _shot_ddb = get_frame_for_transition_in(false /* transparent */);
+        }
         _step = 0;
     }
     // End the state, release all resources
@@ -594,7 +617,13 @@ public:
             fade_interpolate(old_palette, palette, _interpal, _step * 4, 0, 255);
             set_palette_range(_interpal, 0, 255, 0);
         }
-        // do the dissolving
+        // do the dissolving: either raise the alpha test threshold,
+        // hiding the pixels of the next pattern step, or erase them
+        if (_alphaTest)
+        {
+            gfxDriver->SetDDBAlphaTest(_shot_ddb, (_step + 1) * 16 + 15);
+            return ++_step < 16;
+        }
         int maskCol = saved_viewport_bitmap->GetMaskColor();
         for (int x = 0; x < _view.GetWidth(); x += 4)
         {
@@ -609,7 +638,38 @@ public:
     }
 
 private:
+    // Makes a 32-bit copy of the frame, which alpha tells at which step
+    // of the dissolving the pixel disappears: the pixel hidden at step N
+    // has alpha of N * 16 + 15, so that it's the only one failing the alpha
+    // test at this step; the transparent pixels get zero alpha.
+    PooledBitmap make_dissolve_frame(Bitmap *src)
+    {
+        int rank[16];
+        for (int i = 0; i < 16; ++i)
+            rank[_pattern[i]] = i;
+        const int src_depth = src->GetColorDepth();
+        const int mask_col = src->GetMaskColor();
+        PooledBitmap frame = BitmapPool::Global().Acquire(src->GetWidth(), src->GetHeight(), 32);
+        frame->Blit(src, 0, 0, 0, 0, src->GetWidth(), src->GetHeight());
+        for (int y = 0; y < frame->GetHeight(); ++y)
+        {
+            const uint8_t *src_row = src->GetScanLine(y);
+            uint32_t *row = reinterpret_cast<uint32_t*>(frame->GetScanLineForWriting(y));
+            for (int x = 0; x < frame->GetWidth(); ++x)
+            {
+                const int src_col = (src_depth == 32) ? reinterpret_cast<const uint32_t*>(src_row)[x] :
+                    reinterpret_cast<const uint16_t*>(src_row)[x];
+                const uint32_t alpha = (src_col == mask_col) ? 0u :
+                    static_cast<uint32_t>(rank[(x % 4) * 4 + (y % 4)] * 16 + 15);
+                row[x] = (row[x] & 0x00FFFFFFu) | (alpha << 24);
+            }
+        }
+        return frame;
+    }
+
     IDriverDependantBitmap *_shot_ddb = nullptr;
+    // Dissolve with the driver's alpha test instead of updating the frame
+    bool _alphaTest = false;
     int _step = 0;
     const int _pattern[16] = {0,4,14,9,5,11,2,8,10,3,12,7,15,6,13,1};
     Rect _view;
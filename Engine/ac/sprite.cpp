@@ -138,3 +138,8 @@ void post_init_sprite(sprkey_t index)
 {
     pl_run_plugin_hooks(AGSE_SPRITELOAD, index);
 }
+
+void on_sprite_lock_changed(sprkey_t index, bool locked)
+{
+    texturecache_set_locked(static_cast<uint32_t>(index), locked);
+}
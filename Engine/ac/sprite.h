@@ -27,5 +27,7 @@ Size get_new_size_for_sprite(const Size &size, const uint32_t sprite_flags);
 // or if failed to properly initialize one.
 Common::Bitmap *initialize_sprite(Common::sprkey_t index, Common::Bitmap *image, uint32_t &sprite_flags);
 void post_init_sprite(Common::sprkey_t index);
+// Keeps the sprite's texture locked in the texture cache while the sprite is locked
+void on_sprite_lock_changed(Common::sprkey_t index, bool locked);
 
 #endif // __AGS_EE_AC__SPRITE_H
@@ -26,6 +26,7 @@
 #include "debug/debug_log.h"
 #include "script/runtimescriptvalue.h"
 #include "util/string_compat.h"
+#include "util/utf8.h"
 
 using namespace AGS::Common;
 
@@ -46,14 +47,59 @@ int String_IsNullOrEmpty(const char *thisString)
     return 0;
 }
 
+void GetTextLength(const char *text, size_t &len, size_t &ulen)
+{
+    const char *s = text;
+    const char *end = text + strlen(text);
+    size_t chars = 0;
+    for (;;)
+    {
+        const size_t ascii = Utf8::AsciiPrefixLength(s, end - s);
+        s += ascii;
+        chars += ascii;
+        if (s == end)
+            break;
+        const char *next = s;
+        if (!ugetxc(&next))
+        {
+            s = next - 1; // same as ustrlen2 when a sequence decodes into 0
+            break;
+        }
+        s = next;
+        chars++;
+    }
+    len = s - text;
+    ulen = chars;
+}
+
+size_t GetTextOffset(const char *text, size_t len, size_t index)
+{
+    const char *s = text;
+    const char *end = text + len;
+    while ((index > 0) && (s < end))
+    {
+        const size_t ascii = Utf8::AsciiPrefixLength(s, std::min<size_t>(end - s, index));
+        s += ascii;
+        index -= ascii;
+        if ((index == 0) || (s == end))
+            break;
+        const char *next = s;
+        if (!ugetxc(&next))
+            break;
+        s = next;
+        index--;
+    }
+    return s - text;
+}
+
 const char* String_Copy(const char *srcString) {
     return CreateNewScriptString(srcString);
 }
 
 const char* String_Append(const char *thisString, const char *extrabit) {
     const auto &header = ScriptString::GetHeader(thisString);
-    int str2_len, str2_ulen;
-    ustrlen2(extrabit, &str2_len, &str2_ulen);
+    size_t str2_len, str2_ulen;
+    GetTextLength(extrabit, str2_len, str2_ulen);
     auto buf = ScriptString::CreateBuffer(header.Length + str2_len, header.ULength + str2_ulen);
     memcpy(buf.Get(), thisString, header.Length);
     memcpy(buf.Get() + header.Length, extrabit, str2_len + 1);
@@ -75,7 +121,7 @@ const char* String_ReplaceCharAt(const char *thisString, int index, int newChar)
     if ((index < 0) || ((size_t)index >= header.ULength))
         quit("!String.ReplaceCharAt: index outside range of string");
 
-    size_t off = uoffset(thisString, index);
+    size_t off = GetTextOffset(thisString, header.Length, index);
     int old_char = ugetc(thisString + off);
     size_t old_chw = ucwidth(old_char);
     char new_chr[5]{};
@@ -95,7 +141,7 @@ const char* String_Truncate(const char *thisString, int length) {
     if ((size_t)length >= header.ULength)
         return thisString;
 
-    size_t new_len = uoffset(thisString, length);
+    size_t new_len = GetTextOffset(thisString, header.Length, length);
     auto buf = ScriptString::CreateBuffer(new_len, length); // arg is a text length
     memcpy(buf.Get(), thisString, new_len);
     buf.Get()[new_len] = 0;
@@ -109,8 +155,8 @@ const char* String_Substring(const char *thisString, int index, int length) {
     if ((index < 0) || ((size_t)index > header.ULength))
         quit("!String.Substring: invalid index");
     size_t sublen = std::min<uint32_t>(length, header.ULength - index);
-    size_t start = uoffset(thisString, index);
-    size_t end = uoffset(thisString + start, sublen) + start;
+    size_t start = GetTextOffset(thisString, header.Length, index);
+    size_t end = GetTextOffset(thisString + start, header.Length - start, sublen) + start;
     size_t copylen = end - start;
 
     auto buf = ScriptString::CreateBuffer(copylen, sublen);
@@ -164,8 +210,8 @@ const char* String_Replace(const char *thisString, const char *lookForText, cons
     typedef const char* (*fn_strstr)(const char *, const char *);
     fn_strstr pfn_strstr = 
         caseSensitive ? reinterpret_cast<fn_strstr>(ags_strstr) : reinterpret_cast<fn_strstr>(ustrcasestr);
-    int match_len, match_ulen;
-    ustrlen2(lookForText, &match_len, &match_ulen);
+    size_t match_len, match_ulen;
+    GetTextLength(lookForText, match_len, match_ulen);
 
     // Record positions of matches
     std::vector<size_t> matches; // TODO: use optimized container to avoid extra allocs on heap
@@ -176,8 +222,8 @@ const char* String_Replace(const char *thisString, const char *lookForText, cons
     if (matches.size() == 0)
         return thisString; // nothing to replace, return original string
 
-    int replace_len, replace_ulen;
-    ustrlen2(replaceWithText, &replace_len, &replace_ulen);
+    size_t replace_len, replace_ulen;
+    GetTextLength(replaceWithText, replace_len, replace_ulen);
     size_t final_len = this_header.Length - match_len * matches.size() + replace_len * matches.size();
     size_t final_ulen = this_header.ULength - match_ulen * matches.size() + replace_ulen * matches.size();
     auto buf = ScriptString::CreateBuffer(final_len, final_ulen);
@@ -223,12 +269,13 @@ int String_GetChars(const char *thisString, int index) {
     }
     else if (header.LastCharIdx <= index)
     {
-        off = uoffset(thisString + header.LastCharOff, index - header.LastCharIdx) + header.LastCharOff;
+        off = GetTextOffset(thisString + header.LastCharOff, header.Length - header.LastCharOff,
+            index - header.LastCharIdx) + header.LastCharOff;
     }
     // TODO: support faster reverse iteration too? that would require reverse-dir uoffset
     else
     {
-        off = uoffset(thisString, index);
+        off = GetTextOffset(thisString, header.Length, index);
     }
     // NOTE: works up to 64k chars/bytes, then stops; this is intentional to save a bit of mem
     if (off <= UINT16_MAX)
@@ -0,0 +1,182 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <string.h>
+#include <allegro.h> // usetc
+#include "ac/stringbuilder.h"
+#include "ac/common.h" // quit
+#include "ac/global_translation.h"
+#include "ac/string.h"
+#include "ac/dynobj/dynobj_manager.h"
+#include "ac/dynobj/scriptstring.h"
+
+ScriptStringBuilder *StringBuilder_Create(int capacity)
+{
+    if (capacity < 0)
+        quit("!StringBuilder.Create: invalid capacity");
+    ScriptStringBuilder *sb = new ScriptStringBuilder(capacity);
+    ccRegisterManagedObject(sb, sb);
+    return sb;
+}
+
+void StringBuilder_Append(ScriptStringBuilder *sb, const char *text)
+{
+    if (!text)
+        return;
+    size_t len, ulen;
+    GetTextLength(text, len, ulen);
+    sb->Append(text, len, ulen);
+}
+
+void StringBuilder_AppendChar(ScriptStringBuilder *sb, int chr)
+{
+    if (chr == 0)
+        return; // the text must not contain a null character
+    char buf[5]{};
+    size_t chw = usetc(buf, chr);
+    sb->Append(buf, chw, 1);
+}
+
+void StringBuilder_Insert(ScriptStringBuilder *sb, int index, const char *text)
+{
+    if ((index < 0) || ((size_t)index > sb->GetULength()))
+        quit("!StringBuilder.Insert: index outside range of text");
+    if (!text)
+        return;
+    size_t len, ulen;
+    GetTextLength(text, len, ulen);
+    sb->Insert(index, text, len, ulen);
+}
+
+void StringBuilder_Remove(ScriptStringBuilder *sb, int index, int count)
+{
+    if ((index < 0) || ((size_t)index > sb->GetULength()))
+        quit("!StringBuilder.Remove: index outside range of text");
+    if (count < 0)
+        quit("!StringBuilder.Remove: invalid count");
+    sb->Remove(index, count);
+}
+
+void StringBuilder_Clear(ScriptStringBuilder *sb)
+{
+    sb->Clear();
+}
+
+const char *StringBuilder_ToString(ScriptStringBuilder *sb)
+{
+    auto buf = ScriptString::CreateBuffer(sb->GetLength(), sb->GetULength());
+    memcpy(buf.Get(), sb->GetCStr(), sb->GetLength() + 1);
+    return CreateNewScriptString(std::move(buf));
+}
+
+int StringBuilder_GetLength(ScriptStringBuilder *sb)
+{
+    return sb->GetULength();
+}
+
+//=============================================================================
+//
+// Script API Functions
+//
+//=============================================================================
+
+#include "script/script_api.h"
+#include "script/script_runtime.h"
+
+// ScriptStringBuilder* (int capacity)
+RuntimeScriptValue Sc_StringBuilder_Create(const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_SCALL_OBJAUTO_PINT(ScriptStringBuilder, StringBuilder_Create);
+}
+
+// void (ScriptStringBuilder *sb, const char *text)
+RuntimeScriptValue Sc_StringBuilder_Append(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_VOID_POBJ(ScriptStringBuilder, StringBuilder_Append, const char);
+}
+
+// void (ScriptStringBuilder *sb, int chr)
+RuntimeScriptValue Sc_StringBuilder_AppendChar(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_VOID_PINT(ScriptStringBuilder, StringBuilder_AppendChar);
+}
+
+// void (ScriptStringBuilder *sb, const char *format, ...)
+RuntimeScriptValue Sc_StringBuilder_AppendFormat(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_SCRIPT_SPRINTF(StringBuilder_AppendFormat, 1);
+    StringBuilder_Append((ScriptStringBuilder*)self, scsf_buffer);
+    return RuntimeScriptValue((int32_t)0);
+}
+
+// void (ScriptStringBuilder *sb, int index, const char *text)
+RuntimeScriptValue Sc_StringBuilder_Insert(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_VOID_PINT_POBJ(ScriptStringBuilder, StringBuilder_Insert, const char);
+}
+
+// void (ScriptStringBuilder *sb, int index, int count)
+RuntimeScriptValue Sc_StringBuilder_Remove(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_VOID_PINT2(ScriptStringBuilder, StringBuilder_Remove);
+}
+
+// void (ScriptStringBuilder *sb)
+RuntimeScriptValue Sc_StringBuilder_Clear(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_VOID(ScriptStringBuilder, StringBuilder_Clear);
+}
+
+// const char* (ScriptStringBuilder *sb)
+RuntimeScriptValue Sc_StringBuilder_ToString(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_OBJ(ScriptStringBuilder, const char, myScriptStringImpl, StringBuilder_ToString);
+}
+
+// int (ScriptStringBuilder *sb)
+RuntimeScriptValue Sc_StringBuilder_GetLength(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_INT(ScriptStringBuilder, StringBuilder_GetLength);
+}
+
+//=============================================================================
+//
+// Exclusive variadic API implementation for Plugins
+//
+//=============================================================================
+
+// void (ScriptStringBuilder *sb, const char *format, ...)
+void ScPl_StringBuilder_AppendFormat(ScriptStringBuilder *sb, const char *texx, ...)
+{
+    API_PLUGIN_SCRIPT_SPRINTF(texx);
+    StringBuilder_Append(sb, scsf_buffer);
+}
+
+
+void RegisterStringBuilderAPI()
+{
+    ScFnRegister stringbuilder_api[] = {
+        { "StringBuilder::Create^1",        API_FN_PAIR(StringBuilder_Create) },
+
+        { "StringBuilder::Append^1",        API_FN_PAIR(StringBuilder_Append) },
+        { "StringBuilder::AppendChar^1",    API_FN_PAIR(StringBuilder_AppendChar) },
+        { "StringBuilder::AppendFormat^101", Sc_StringBuilder_AppendFormat, ScPl_StringBuilder_AppendFormat },
+        { "StringBuilder::Clear^0",         API_FN_PAIR(StringBuilder_Clear) },
+        { "StringBuilder::Insert^2",        API_FN_PAIR(StringBuilder_Insert) },
+        { "StringBuilder::Remove^2",        API_FN_PAIR(StringBuilder_Remove) },
+        { "StringBuilder::ToString^0",      API_FN_PAIR(StringBuilder_ToString) },
+        { "StringBuilder::get_Length",      API_FN_PAIR(StringBuilder_GetLength) },
+    };
+
+    ccAddExternalFunctions(stringbuilder_api);
+}
@@ -0,0 +1,32 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// StringBuilder script API.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__STRINGBUILDER_H
+#define __AGS_EE_AC__STRINGBUILDER_H
+
+#include "ac/dynobj/scriptstringbuilder.h"
+
+ScriptStringBuilder *StringBuilder_Create(int capacity);
+void        StringBuilder_Append(ScriptStringBuilder *sb, const char *text);
+void        StringBuilder_AppendChar(ScriptStringBuilder *sb, int chr);
+void        StringBuilder_Insert(ScriptStringBuilder *sb, int index, const char *text);
+void        StringBuilder_Remove(ScriptStringBuilder *sb, int index, int count);
+void        StringBuilder_Clear(ScriptStringBuilder *sb);
+const char *StringBuilder_ToString(ScriptStringBuilder *sb);
+int         StringBuilder_GetLength(ScriptStringBuilder *sb);
+
+#endif // __AGS_EE_AC__STRINGBUILDER_H
@@ -12,8 +12,10 @@
 //
 //=============================================================================
 #include "ac/sys_events.h"
+#include <algorithm>
 #include <chrono>
 #include <deque>
+#include <iterator>
 #include <math.h>
 #include <SDL.h>
 #include "core/platform.h"
@@ -28,6 +30,9 @@
 #include "platform/base/agsplatformdriver.h"
 #include "platform/base/sys_main.h"
 #include "main/engine.h"
+#include "util/file.h"
+#include "util/memory_budget.h"
+#include "util/stream.h"
 #include "util/string_utils.h"
 #include "util/utf8.h"
 
@@ -335,6 +340,8 @@ SDL_Event ags_get_next_inputevent()
     return {};
 }
 
+static const Uint8 *sys_evt_get_key_state();
+
 int ags_iskeydown(eAGSKeyCode ags_key)
 {
     // old input handling: update key state in realtime
@@ -344,7 +351,7 @@ int ags_iskeydown(eAGSKeyCode ags_key)
     if (game.options[OPT_KEYHANDLEAPI] == 0)
         SDL_PumpEvents();
 
-    const Uint8 *state = SDL_GetKeyboardState(NULL);
+    const Uint8 *state = sys_evt_get_key_state();
     SDL_Scancode scan[3];
     if (!ags_key_to_sdl_scan(ags_key, scan))
         return 0;
@@ -992,6 +999,10 @@ void sys_evt_process_one(const SDL_Event &event) {
             _on_quit_callback();
         }
         break;
+    case SDL_APP_LOWMEMORY:
+        Debug::Printf(kDbgMsg_Warn, "SDL event: system is low on memory");
+        MemoryBudget::OnLowMemory();
+        break;
     // WINDOW
     case SDL_WINDOWEVENT:
         switch (event.window.event)
@@ -1011,6 +1022,11 @@ void sys_evt_process_one(const SDL_Event &event) {
         case SDL_WINDOWEVENT_CLOSE:
             Debug::Printf("Window event: close");
             break;
+        case SDL_WINDOWEVENT_EXPOSED:
+            // window contents have to be redrawn
+            if (gfxDriver)
+                gfxDriver->InvalidateFrame();
+            break;
         case SDL_WINDOWEVENT_SIZE_CHANGED:
             Debug::Printf("Window event: size changed (%d, %d)", event.window.data1, event.window.data2);
             engine_on_window_changed(Size(event.window.data1, event.window.data2));
@@ -1054,9 +1070,307 @@ void sys_evt_process_one(const SDL_Event &event) {
     }
 }
 
+// Input recording and replay
+static const String InputRecordSignature = "AGSInputRecord";
+enum InputRecordVersion
+{
+    kInputRecord_Initial = 1,
+    kInputRecord_Touch   = 2, // touch events, end of record marker
+    kInputRecord_Current = kInputRecord_Touch
+};
+// Event type marking the end of record, written along with the last tick
+static const Uint32 InputRecordEnd = SDL_FIRSTEVENT;
+
+// Recorded input event, and the game tick it was processed at
+struct RecordedEvent
+{
+    uint32_t Tick = 0u;
+    SDL_Event Event = {};
+};
+
+static std::unique_ptr<Stream> input_record;
+static std::deque<RecordedEvent> input_replay;
+static bool input_replaying = false;
+static bool input_replay_finished = false;
+// The tick the recording was stopped at
+static uint32_t input_replay_end = 0u;
+static uint32_t input_tick = 0u;
+// Key states set by the replayed events
+static Uint8 replay_key_state[SDL_NUM_SCANCODES] = {};
+
+static const Uint8 *sys_evt_get_key_state()
+{
+    return input_replaying ? replay_key_state : SDL_GetKeyboardState(NULL);
+}
+
+// Tells if this is a real input event, which may be recorded or replaced by the replay.
+// The events pushed by the engine itself have no window ID.
+static bool is_real_input_event(const SDL_Event &event)
+{
+    switch (event.type)
+    {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP: return event.key.windowID != 0;
+    case SDL_TEXTINPUT: return event.text.windowID != 0;
+    case SDL_MOUSEMOTION: return event.motion.windowID != 0;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP: return event.button.windowID != 0;
+    case SDL_MOUSEWHEEL: return event.wheel.windowID != 0;
+    case SDL_FINGERDOWN:
+    case SDL_FINGERUP:
+    case SDL_FINGERMOTION: return true;
+    default: return false;
+    }
+}
+
+// Converts the window coordinate to the game one, and back
+static int window_to_game_coord(int v, int frame_off, int frame_len, int game_len)
+{
+    return frame_len > 0 ? (v - frame_off) * game_len / frame_len : v;
+}
+
+static int game_to_window_coord(int v, int frame_off, int frame_len, int game_len)
+{
+    // aim at the center of the game pixel
+    return game_len > 0 ? frame_off + (v * frame_len + frame_len / 2) / game_len : v;
+}
+
+static void write_input_event(Stream *out, const SDL_Event &event)
+{
+    const Rect frame = gfxDriver ? gfxDriver->GetRenderDestination() : Rect();
+    const Size game_res = game.GetGameRes();
+    out->WriteInt32(input_tick);
+    out->WriteInt32(event.type);
+    switch (event.type)
+    {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        out->WriteInt32(event.key.keysym.scancode);
+        out->WriteInt32(event.key.keysym.sym);
+        out->WriteInt32(event.key.keysym.mod);
+        out->WriteInt8(event.key.repeat);
+        break;
+    case SDL_TEXTINPUT:
+        StrUtil::WriteString(event.text.text, out);
+        break;
+    case SDL_MOUSEMOTION:
+        out->WriteInt32(window_to_game_coord(event.motion.x, frame.Left, frame.GetWidth(), game_res.Width));
+        out->WriteInt32(window_to_game_coord(event.motion.y, frame.Top, frame.GetHeight(), game_res.Height));
+        out->WriteInt32(window_to_game_coord(event.motion.xrel, 0, frame.GetWidth(), game_res.Width));
+        out->WriteInt32(window_to_game_coord(event.motion.yrel, 0, frame.GetHeight(), game_res.Height));
+        out->WriteInt32(event.motion.state);
+        break;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+        out->WriteInt32(event.button.button);
+        out->WriteInt32(window_to_game_coord(event.button.x, frame.Left, frame.GetWidth(), game_res.Width));
+        out->WriteInt32(window_to_game_coord(event.button.y, frame.Top, frame.GetHeight(), game_res.Height));
+        out->WriteInt8(event.button.clicks);
+        break;
+    case SDL_MOUSEWHEEL:
+        out->WriteInt32(event.wheel.x);
+        out->WriteInt32(event.wheel.y);
+        out->WriteInt32(event.wheel.direction);
+        break;
+    // the touch positions are already relative to the window size
+    case SDL_FINGERDOWN:
+    case SDL_FINGERUP:
+    case SDL_FINGERMOTION:
+        out->WriteInt64(event.tfinger.fingerId);
+        out->WriteFloat32(event.tfinger.x);
+        out->WriteFloat32(event.tfinger.y);
+        out->WriteFloat32(event.tfinger.dx);
+        out->WriteFloat32(event.tfinger.dy);
+        out->WriteFloat32(event.tfinger.pressure);
+        break;
+    default:
+        break;
+    }
+}
+
+// Reads the event, keeping the mouse positions in game coordinates
+static bool read_input_event(Stream *in, RecordedEvent &rec)
+{
+    rec.Tick = in->ReadInt32();
+    SDL_Event &event = rec.Event;
+    event = {};
+    event.type = in->ReadInt32();
+    switch (event.type)
+    {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        event.key.keysym.scancode = static_cast<SDL_Scancode>(in->ReadInt32());
+        event.key.keysym.sym = in->ReadInt32();
+        event.key.keysym.mod = static_cast<Uint16>(in->ReadInt32());
+        event.key.repeat = in->ReadInt8();
+        event.key.state = event.type == SDL_KEYDOWN ? SDL_PRESSED : SDL_RELEASED;
+        break;
+    case SDL_TEXTINPUT:
+        snprintf(event.text.text, sizeof(event.text.text), "%s", StrUtil::ReadString(in).GetCStr());
+        break;
+    case SDL_MOUSEMOTION:
+        event.motion.x = in->ReadInt32();
+        event.motion.y = in->ReadInt32();
+        event.motion.xrel = in->ReadInt32();
+        event.motion.yrel = in->ReadInt32();
+        event.motion.state = in->ReadInt32();
+        break;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+        event.button.button = static_cast<Uint8>(in->ReadInt32());
+        event.button.x = in->ReadInt32();
+        event.button.y = in->ReadInt32();
+        event.button.clicks = in->ReadInt8();
+        event.button.state = event.type == SDL_MOUSEBUTTONDOWN ? SDL_PRESSED : SDL_RELEASED;
+        break;
+    case SDL_MOUSEWHEEL:
+        event.wheel.x = in->ReadInt32();
+        event.wheel.y = in->ReadInt32();
+        event.wheel.direction = in->ReadInt32();
+        break;
+    case SDL_FINGERDOWN:
+    case SDL_FINGERUP:
+    case SDL_FINGERMOTION:
+        event.tfinger.fingerId = in->ReadInt64();
+        event.tfinger.x = in->ReadFloat32();
+        event.tfinger.y = in->ReadFloat32();
+        event.tfinger.dx = in->ReadFloat32();
+        event.tfinger.dy = in->ReadFloat32();
+        event.tfinger.pressure = in->ReadFloat32();
+        break;
+    case InputRecordEnd:
+        break;
+    default:
+        return false; // unknown event, the record is broken
+    }
+    return !in->GetError();
+}
+
+// Converts the replayed event's mouse position to the window coordinates
+static void replay_to_window_coords(SDL_Event &event)
+{
+    const Rect frame = gfxDriver ? gfxDriver->GetRenderDestination() : Rect();
+    const Size game_res = game.GetGameRes();
+    switch (event.type)
+    {
+    case SDL_MOUSEMOTION:
+        event.motion.x = game_to_window_coord(event.motion.x, frame.Left, frame.GetWidth(), game_res.Width);
+        event.motion.y = game_to_window_coord(event.motion.y, frame.Top, frame.GetHeight(), game_res.Height);
+        event.motion.xrel = event.motion.xrel * frame.GetWidth() / std::max(1, game_res.Width);
+        event.motion.yrel = event.motion.yrel * frame.GetHeight() / std::max(1, game_res.Height);
+        break;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+        event.button.x = game_to_window_coord(event.button.x, frame.Left, frame.GetWidth(), game_res.Width);
+        event.button.y = game_to_window_coord(event.button.y, frame.Top, frame.GetHeight(), game_res.Height);
+        break;
+    default:
+        break;
+    }
+}
+
+bool sys_evt_start_recording(const String &path, int randseed)
+{
+    sys_evt_stop_input_record();
+    input_record = File::CreateFile(path);
+    if (!input_record)
+    {
+        Debug::Printf(kDbgMsg_Error, "Failed to open the input record file for writing: %s", path.GetCStr());
+        return false;
+    }
+    InputRecordSignature.WriteCount(input_record.get(), InputRecordSignature.GetLength());
+    input_record->WriteInt32(kInputRecord_Current);
+    input_record->WriteInt32(randseed);
+    Debug::Printf(kDbgMsg_Info, "Recording the input into: %s", path.GetCStr());
+    return true;
+}
+
+bool sys_evt_start_replay(const String &path, int &randseed)
+{
+    sys_evt_stop_input_record();
+    std::unique_ptr<Stream> in(File::OpenFileRead(path));
+    if (!in)
+    {
+        Debug::Printf(kDbgMsg_Error, "Failed to open the input record file: %s", path.GetCStr());
+        return false;
+    }
+    const bool has_sig = String::FromStreamCount(in.get(), InputRecordSignature.GetLength()) == InputRecordSignature;
+    const int version = has_sig ? in->ReadInt32() : 0;
+    if (version < kInputRecord_Initial || version > kInputRecord_Current)
+    {
+        Debug::Printf(kDbgMsg_Error, "Not a supported input record file: %s", path.GetCStr());
+        return false;
+    }
+    randseed = in->ReadInt32();
+    RecordedEvent rec;
+    input_replay_end = 0u;
+    while (!in->EOS() && read_input_event(in.get(), rec))
+    {
+        input_replay_end = rec.Tick;
+        if (rec.Event.type == InputRecordEnd)
+            break;
+        input_replay.push_back(rec);
+    }
+    input_replaying = true;
+    input_replay_finished = false;
+    std::fill(std::begin(replay_key_state), std::end(replay_key_state), 0);
+    Debug::Printf(kDbgMsg_Info, "Replaying %zu input events from: %s", input_replay.size(), path.GetCStr());
+    return true;
+}
+
+void sys_evt_stop_input_record()
+{
+    if (input_record)
+    {
+        input_record->WriteInt32(input_tick);
+        input_record->WriteInt32(InputRecordEnd);
+    }
+    input_record.reset();
+    input_replay.clear();
+    input_replaying = false;
+}
+
+void sys_evt_next_tick()
+{
+    input_tick++;
+    if (!input_replaying)
+        return;
+    while (!input_replay.empty() && input_replay.front().Tick <= input_tick)
+    {
+        SDL_Event event = input_replay.front().Event;
+        input_replay.pop_front();
+        replay_to_window_coords(event);
+        if (((event.type == SDL_KEYDOWN) || (event.type == SDL_KEYUP)) &&
+            (event.key.keysym.scancode >= 0) && (event.key.keysym.scancode < SDL_NUM_SCANCODES))
+            replay_key_state[event.key.keysym.scancode] = event.type == SDL_KEYDOWN;
+        sys_evt_process_one(event);
+    }
+    if (input_replay.empty() && input_tick >= input_replay_end)
+    {
+        // the real input is accepted again
+        Debug::Printf(kDbgMsg_Info, "Input replay finished at tick %u", input_tick);
+        input_replaying = false;
+        input_replay_finished = true;
+    }
+}
+
+bool sys_evt_is_replay_finished()
+{
+    return input_replay_finished;
+}
+
 void sys_evt_process_pending(void) {
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
+        if (input_replaying || input_record)
+        {
+            if (is_real_input_event(event))
+            {
+                if (input_replaying)
+                    continue; // the real input is replaced by the replay
+                write_input_event(input_record.get(), event);
+            }
+        }
         sys_evt_process_one(event);
     }
 }
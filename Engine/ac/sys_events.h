@@ -19,6 +19,7 @@
 #define __AGS_EE_AC__SYS_EVENTS_H
 #include <SDL_keyboard.h>
 #include "ac/keycode.h"
+#include "util/string.h"
 
 // Internal AGS device and event type, made as flags
 // NOTE: this matches InputType in script (with a 24-bit shift)
@@ -165,4 +166,29 @@ void sys_evt_process_pending(void);
 // Flushes system events following window initialization.
 void sys_flush_events(void);
 
+
+// Input recording and replay.
+//
+// The input events are recorded along with the number of the game tick
+// when they were processed, and replayed at the same ticks; the mouse
+// positions are recorded in the game coordinates, and the touch positions
+// relative to the window. Events generated by the engine itself, such as
+// the simulated key presses or the mouse emulated by touch, are not recorded.
+// The record ends with the tick it was stopped at, after which the replay
+// finishes and the real input is accepted again.
+//
+// Starts writing the processed input events into the file;
+// the random seed is saved along, for the replay
+bool sys_evt_start_recording(const AGS::Common::String &path, int randseed);
+// Starts replaying the input events from the file; the real input is ignored
+// while replaying. Returns the random seed the recording was made with.
+bool sys_evt_start_replay(const AGS::Common::String &path, int &randseed);
+// Stops recording or replaying the input
+void sys_evt_stop_input_record();
+// Advances the game tick counter; when replaying, processes the events
+// recorded at the new tick
+void sys_evt_next_tick();
+// Tells if the input replay has reached the end of record
+bool sys_evt_is_replay_finished();
+
 #endif // __AGS_EE_AC__SYS_EVENTS_H
@@ -11,6 +11,7 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
 #include <SDL.h>
 #include "ac/common.h"
 #include "ac/draw.h"
@@ -237,6 +238,12 @@ const char* System_GetEngineString(int value_id, int index)
     return CreateNewScriptString(value.GetCStr());
 }
 
+// Clamps the statistics counter to the script's int range
+static int StatToInt(uint64_t stat)
+{
+    return static_cast<int>(std::min<uint64_t>(stat, INT32_MAX));
+}
+
 bool GetEngineInteger(int &value, EngineValueID value_id, int index)
 {
     switch (value_id)
@@ -269,6 +276,36 @@ bool GetEngineInteger(int &value, EngineValueID value_id, int index)
         value = std::isnan(fps) ? -1 : static_cast<int>(std::round(fps));
         return true;
     }
+    case ENGINE_VALUE_I_SPRCACHE_HITS:
+        value = StatToInt(spriteset.GetStats().Hits); return true;
+    case ENGINE_VALUE_I_SPRCACHE_MISSES:
+        value = StatToInt(spriteset.GetStats().Misses); return true;
+    case ENGINE_VALUE_I_SPRCACHE_EVICTIONS:
+        value = StatToInt(spriteset.GetStats().Evictions); return true;
+    case ENGINE_VALUE_I_SPRCACHE_LOADED:
+        value = StatToInt(spriteset.GetStats().LoadedSize / 1024u); return true;
+    case ENGINE_VALUE_I_SPRCACHE_LOADTIME_COUNT:
+        value = static_cast<int>(ResourceCacheStats::LoadTimeBucketCount); return true;
+    case ENGINE_VALUE_II_SPRCACHE_LOADTIME:
+        if (index < 0 || static_cast<size_t>(index) >= ResourceCacheStats::LoadTimeBucketCount)
+            return false;
+        value = StatToInt(spriteset.GetStats().LoadTime[index]); return true;
+    case ENGINE_VALUE_I_TEXCACHE_HITS:
+        value = StatToInt(texturecache_get_stats().Hits); return true;
+    case ENGINE_VALUE_I_TEXCACHE_MISSES:
+        value = StatToInt(texturecache_get_stats().Misses); return true;
+    case ENGINE_VALUE_I_TEXCACHE_EVICTIONS:
+        value = StatToInt(texturecache_get_stats().Evictions); return true;
+    case ENGINE_VALUE_I_AUDIO_UNDERRUNS:
+        value = usetup.audio_enabled ? StatToInt(audio_core_get_stats().Underruns) : 0; return true;
+    case ENGINE_VALUE_I_AUDIO_QUEUED:
+        value = usetup.audio_enabled ? audio_core_get_stats().QueuedMs : 0; return true;
+    case ENGINE_VALUE_I_AUDIO_START_LATENCY:
+        value = usetup.audio_enabled ? audio_core_get_stats().StartLatencyMs : 0; return true;
+    case ENGINE_VALUE_I_AUDIO_START_LATENCY_MAX:
+        value = usetup.audio_enabled ? audio_core_get_stats().MaxStartLatencyMs : 0; return true;
+    case ENGINE_VALUE_I_AUDIO_VIRTUAL_VOICES:
+        value = usetup.audio_enabled ? audio_core_get_stats().VirtualVoices : 0; return true;
     default: return false;
     }
 }
@@ -333,6 +370,20 @@ String GetEngineValueName(EngineValueID value_id)
     case ENGINE_VALUE_I_TEXCACHE_NORMAL: return "Texture cache: normal size (KB)";
     case ENGINE_VALUE_I_FPS_MAX: return "FPS cap";
     case ENGINE_VALUE_I_FPS: return "FPS real";
+    case ENGINE_VALUE_I_SPRCACHE_HITS: return "Sprite cache: hits";
+    case ENGINE_VALUE_I_SPRCACHE_MISSES: return "Sprite cache: misses";
+    case ENGINE_VALUE_I_SPRCACHE_EVICTIONS: return "Sprite cache: evictions";
+    case ENGINE_VALUE_I_SPRCACHE_LOADED: return "Sprite cache: loaded size (KB)";
+    case ENGINE_VALUE_I_SPRCACHE_LOADTIME_COUNT: return "Sprite cache: load time histogram size";
+    case ENGINE_VALUE_II_SPRCACHE_LOADTIME: return "Sprite cache: load time histogram";
+    case ENGINE_VALUE_I_TEXCACHE_HITS: return "Texture cache: hits";
+    case ENGINE_VALUE_I_TEXCACHE_MISSES: return "Texture cache: misses";
+    case ENGINE_VALUE_I_TEXCACHE_EVICTIONS: return "Texture cache: evictions";
+    case ENGINE_VALUE_I_AUDIO_UNDERRUNS: return "Audio: underruns";
+    case ENGINE_VALUE_I_AUDIO_QUEUED: return "Audio: max queued data (ms)";
+    case ENGINE_VALUE_I_AUDIO_START_LATENCY: return "Audio: average start latency (ms)";
+    case ENGINE_VALUE_I_AUDIO_START_LATENCY_MAX: return "Audio: max start latency (ms)";
+    case ENGINE_VALUE_I_AUDIO_VIRTUAL_VOICES: return "Audio: virtual voices";
     default: return "";
     }
 }
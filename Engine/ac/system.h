@@ -67,6 +67,20 @@ enum EngineValueID
     ENGINE_VALUE_I_TEXCACHE_NORMAL,
     ENGINE_VALUE_I_FPS_MAX,
     ENGINE_VALUE_I_FPS,
+    ENGINE_VALUE_I_SPRCACHE_HITS,
+    ENGINE_VALUE_I_SPRCACHE_MISSES,
+    ENGINE_VALUE_I_SPRCACHE_EVICTIONS,
+    ENGINE_VALUE_I_SPRCACHE_LOADED,        // total size of loaded sprites (KB)
+    ENGINE_VALUE_I_SPRCACHE_LOADTIME_COUNT, // number of load time histogram buckets
+    ENGINE_VALUE_II_SPRCACHE_LOADTIME,     // number of sprite loads in the histogram bucket
+    ENGINE_VALUE_I_TEXCACHE_HITS,
+    ENGINE_VALUE_I_TEXCACHE_MISSES,
+    ENGINE_VALUE_I_TEXCACHE_EVICTIONS,
+    ENGINE_VALUE_I_AUDIO_UNDERRUNS,        // number of times a playing sound ran out of data
+    ENGINE_VALUE_I_AUDIO_QUEUED,           // max sound data queued for output by a sound (ms)
+    ENGINE_VALUE_I_AUDIO_START_LATENCY,    // average delay before the played sound's output starts (ms)
+    ENGINE_VALUE_I_AUDIO_START_LATENCY_MAX, // max delay before the played sound's output starts (ms)
+    ENGINE_VALUE_I_AUDIO_VIRTUAL_VOICES,   // number of playing sounds which are not output due to the voice limit
     ENGINE_VALUE_LAST                      // in case user wants to iterate them
 };
 
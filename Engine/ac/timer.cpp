@@ -13,8 +13,12 @@
 //=============================================================================
 #include "ac/timer.h"
 #include "core/platform.h"
+#include <algorithm>
+#include <algorithm>
+#include <cmath>
 #include <thread>
 #include "ac/sys_events.h"
+#include "debug/eventtrace.h"
 #include "platform/base/agsplatformdriver.h"
 #if defined(AGS_DISABLE_THREADS)
 #include "media/audio/audio_core.h"
@@ -29,19 +33,62 @@ extern volatile bool want_exit, abort_engine;
 namespace {
 
 const auto MAXIMUM_FALL_BEHIND = 3; // number of full frames
+// Time before the next frame to spin through in the precise pacing mode
+const auto PACING_SPIN_TAIL = std::chrono::milliseconds(2);
 
 auto tick_duration = std::chrono::microseconds(1000000LL/40);
 auto framerate = 0;
 auto framerate_maxed = false;
+auto framerate_uncapped = false;
 
 auto last_tick_time = AGS_Clock::now();
 auto next_frame_timestamp = AGS_Clock::now();
+auto precise_pacing = false;
+
+// Frame time statistics, accumulated with Welford's algorithm
+struct FrameTimeAccum
+{
+    AGS_Clock::time_point LastFrame;
+    uint32_t Frames = 0u;
+    double Mean = 0.0;
+    double M2 = 0.0; // sum of squared differences from the mean
+    double Max = 0.0;
+} frame_time_accum;
+
+void add_frame_time(AGS_Clock::time_point now)
+{
+    auto &acc = frame_time_accum;
+    if (acc.LastFrame != AGS_Clock::time_point())
+    {
+        const double ms = std::chrono::duration<double, std::milli>(now - acc.LastFrame).count();
+        acc.Frames++;
+        const double delta = ms - acc.Mean;
+        acc.Mean += delta / acc.Frames;
+        acc.M2 += delta * (ms - acc.Mean);
+        acc.Max = std::max(acc.Max, ms);
+    }
+    acc.LastFrame = now;
+}
+
+void wait_until(AGS_Clock::time_point when)
+{
+    if (!precise_pacing)
+    {
+        std::this_thread::sleep_for(when - AGS_Clock::now());
+        return;
+    }
+    const auto sleep_until = when - PACING_SPIN_TAIL;
+    if (AGS_Clock::now() < sleep_until)
+        std::this_thread::sleep_until(sleep_until);
+    while (AGS_Clock::now() < when)
+        std::this_thread::yield();
+}
 
 }
 
 std::chrono::microseconds GetFrameDuration()
 {
-    if (framerate_maxed) {
+    if (framerate_maxed || framerate_uncapped) {
         return std::chrono::microseconds(0);
     }
     return tick_duration;
@@ -66,8 +113,52 @@ bool isTimerFpsMaxed()
     return framerate_maxed;
 }
 
+void setTimerUncapped(bool uncapped)
+{
+    framerate_uncapped = uncapped;
+}
+
+void setFramePacing(bool precise)
+{
+    precise_pacing = precise;
+}
+
+float getFrameProgress()
+{
+    const auto frameDuration = GetFrameDuration();
+    if (frameDuration <= std::chrono::microseconds::zero())
+        return 1.f;
+    const float progress = std::chrono::duration<float>(AGS_Clock::now() - last_tick_time).count() /
+        std::chrono::duration<float>(frameDuration).count();
+    return std::min(1.f, std::max(0.f, progress));
+}
+
+AGS_Clock::time_point getNextFrameTime()
+{
+    return next_frame_timestamp;
+}
+
+FrameTimeStats getFrameTimeStats()
+{
+    const auto &acc = frame_time_accum;
+    FrameTimeStats stats;
+    stats.Frames = acc.Frames;
+    stats.MeanMs = static_cast<float>(acc.Mean);
+    stats.StdDevMs = acc.Frames > 1 ? static_cast<float>(std::sqrt(acc.M2 / (acc.Frames - 1))) : 0.f;
+    stats.MaxMs = static_cast<float>(acc.Max);
+    return stats;
+}
+
+void resetFrameTimeStats()
+{
+    const auto last_frame = frame_time_accum.LastFrame;
+    frame_time_accum = FrameTimeAccum();
+    frame_time_accum.LastFrame = last_frame;
+}
+
 void WaitForNextFrame()
 {
+    AGS_TRACE_ZONE("WaitForNextFrame");
     // Do the last polls on this frame, if necessary
 #if defined(AGS_DISABLE_THREADS)
     audio_core_entry_poll();
@@ -80,11 +171,13 @@ void WaitForNextFrame()
     if (frameDuration <= std::chrono::milliseconds::zero()) {
         last_tick_time = next_frame_timestamp;
         next_frame_timestamp = now;
+        add_frame_time(now);
 
         // suspend while the game is being switched out
         while (game_update_suspend && (!want_exit) && (!abort_engine)) {
             sys_evt_process_pending();
             platform->YieldCPU();
+            frame_time_accum.LastFrame = AGS_Clock::time_point(); // don't count the pause
         }
         return;
     }
@@ -100,17 +193,19 @@ void WaitForNextFrame()
         // pass the time as negative in Emscripten Platform Driver
         platform->Delay(-std::chrono::duration_cast<std::chrono::milliseconds>(frame_time_remaining).count());
 #else
-        std::this_thread::sleep_for(frame_time_remaining);
+        wait_until(next_frame_timestamp);
 #endif
     }
 
     last_tick_time = next_frame_timestamp;
     next_frame_timestamp += frameDuration;
+    add_frame_time(AGS_Clock::now());
 
     // suspend while the game is being switched out
     while (game_update_suspend && (!want_exit) && (!abort_engine)) {
         sys_evt_process_pending();
         platform->YieldCPU();
+        frame_time_accum.LastFrame = AGS_Clock::time_point(); // don't count the pause
     }
 }
 
@@ -118,4 +213,5 @@ void skipMissedTicks()
 {
     last_tick_time = AGS_Clock::now();
     next_frame_timestamp = AGS_Clock::now();
+    frame_time_accum.LastFrame = AGS_Clock::time_point();
 }
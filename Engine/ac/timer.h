@@ -20,6 +20,7 @@
 
 #include <type_traits>
 #include <chrono>
+#include <cstdint>
 
 // use high resolution clock only if we know it is monotonic/steady.
 // refer to https://stackoverflow.com/a/38253266/84262
@@ -37,11 +38,37 @@ inline int64_t ToMilliseconds(TDur dur)
 
 // Sleeps for time remaining until the next game frame, updates next frame timestamp
 extern void WaitForNextFrame();
+// Sets whether to wait for the next frame precisely: the wait sleeps for the
+// most of the remaining time, and spins through the last few milliseconds,
+// which the system sleep may otherwise overshoot
+extern void setFramePacing(bool precise);
+
+// Gets the time passed since the last game frame, as a fraction of the
+// frame duration, in the range of [0; 1]; returns 1 in maxed FPS mode
+extern float getFrameProgress();
+// Gets the time when the next game frame is due
+extern AGS_Clock::time_point getNextFrameTime();
+
+// Statistics of the actual time between the frames
+struct FrameTimeStats
+{
+    uint32_t Frames = 0u;
+    float MeanMs = 0.f;
+    float StdDevMs = 0.f; // standard deviation of the frame time
+    float MaxMs = 0.f;
+};
+// Gets the frame time statistics, collected since the last reset
+extern FrameTimeStats getFrameTimeStats();
+extern void resetFrameTimeStats();
 
 // Sets real FPS to the given number of frames per second; pass 1000+ for maxed FPS mode
 extern int setTimerFps(int new_fps);
 // Tells whether maxed FPS mode is currently set
 extern bool isTimerFpsMaxed();
+// Sets whether to run the frames without waiting, regardless of the game
+// speed set by the game; unlike the maxed FPS, this does not change
+// the game's idea of its frame rate
+extern void setTimerUncapped(bool uncapped);
 // If more than N frames, just skip all, start a fresh.
 extern void skipMissedTicks();
 
@@ -25,6 +25,7 @@
 #include "core/assetmanager.h"
 #include "debug/out.h"
 #include "game/tra_file.h"
+#include "util/flat_hash.h"
 #include "util/stream.h"
 #include "util/string_utils.h"
 
@@ -36,9 +37,66 @@ String trans_name;
 String trans_filename;
 Translation trans;
 
+// A reference to a text in the translation's text pool
+struct TextRef
+{
+    const char *Text;
+    size_t Len;
+};
+
+struct HashTextRef
+{
+    size_t operator()(const TextRef &ref) const { return FNV::Hash(ref.Text, ref.Len); }
+};
+
+struct TextRefEqual
+{
+    bool operator()(const TextRef &ref1, const TextRef &ref2) const
+    {
+        return ref1.Len == ref2.Len && memcmp(ref1.Text, ref2.Text, ref1.Len) == 0;
+    }
+};
+
+// The translation texts, packed one after another, each null-terminated
+static std::vector<char> trans_texts;
+// The translation lookup table, keyed by source texts, pointing into the pool
+static FlatHashMap<TextRef, TextRef, HashTextRef, TextRefEqual> trans_table;
+
+// Packs the translation dictionary into the text pool and the lookup table,
+// and frees the dictionary
+static void compile_translation_table(StringMap &dict)
+{
+    size_t pool_size = 0u;
+    for (const auto &item : dict)
+        pool_size += item.first.GetLength() + item.second.GetLength() + 2;
+    trans_texts.resize(pool_size);
+    trans_table.reserve(dict.size());
+    // the pool is allocated once, so that the references into it stay valid
+    char *pool = trans_texts.data();
+    size_t off = 0u;
+    for (const auto &item : dict)
+    {
+        TextRef src { pool + off, item.first.GetLength() };
+        memcpy(pool + off, item.first.GetCStr(), src.Len + 1);
+        off += src.Len + 1;
+        TextRef dst { pool + off, item.second.GetLength() };
+        memcpy(pool + off, item.second.GetCStr(), dst.Len + 1);
+        off += dst.Len + 1;
+        trans_table.insert(std::make_pair(src, dst));
+    }
+    StringMap().swap(dict);
+}
+
+static void free_translation_table()
+{
+    trans_table = {};
+    std::vector<char>().swap(trans_texts);
+}
+
 
 void close_translation () {
     trans = Translation();
+    free_translation_table();
     trans_name = "";
     trans_filename = "";
 
@@ -56,7 +114,7 @@ bool init_translation(const String &lang, const String &fallback_lang)
     trans_name = lang;
     trans_filename = String::FromFormat("%s.tra", lang.GetCStr());
 
-    auto in = AssetMgr->OpenAsset(trans_filename);
+    auto in = AssetMgr->OpenAsset(trans_filename, kAssetOpen_ReadWhole);
     if (in == nullptr)
     {
         Debug::Printf(kDbgMsg_Error, "Cannot open translation: %s", trans_filename.GetCStr());
@@ -64,13 +122,14 @@ bool init_translation(const String &lang, const String &fallback_lang)
     }
 
     trans = Translation();
+    free_translation_table();
 
     // First test if the translation is meant for this game
     HError err = TestTraGameID(game.uniqueid, game.gamename, std::move(in));
     if (err)
     {
         // If successful, then read translation data fully
-        in = AssetMgr->OpenAsset(trans_filename);
+        in = AssetMgr->OpenAsset(trans_filename, kAssetOpen_ReadWhole);
         err = ReadTraData(trans, std::move(in));
     }
 
@@ -146,6 +205,8 @@ bool init_translation(const String &lang, const String &fallback_lang)
         }
     }
 
+    compile_translation_table(trans.Dict);
+
     Debug::Printf(kDbgMsg_Info, "Translation initialized: %s (format: %s)", trans_name.GetCStr(), encoding_msg.GetCStr());
     return true;
 }
@@ -160,7 +221,13 @@ String get_translation_path()
     return trans_filename;
 }
 
-const StringMap& get_translation_tree()
+bool has_translation_texts()
+{
+    return !trans_table.empty();
+}
+
+const char *find_translation(const char *text)
 {
-    return trans.Dict;
+    const auto it = trans_table.find(TextRef { text, strlen(text) });
+    return (it != trans_table.end()) ? it->second.Text : nullptr;
 }
@@ -21,7 +21,6 @@
 #include "util/string_types.h"
 
 using AGS::Common::String;
-using AGS::Common::StringMap;
 
 void close_translation ();
 bool init_translation (const String &lang, const String &fallback_lang);
@@ -29,7 +28,9 @@ bool init_translation (const String &lang, const String &fallback_lang);
 String get_translation_name();
 // Returns fill path to the translation file, or empty string if default translation is used
 String get_translation_path();
-// Returns translation map for reading only
-const StringMap &get_translation_tree();
+// Tells whether current translation has any translated texts
+bool has_translation_texts();
+// Returns the translation of the given text, or null if it has none
+const char *find_translation(const char *text);
 
 #endif // __AGS_EE_AC__TRANSLATION_H
@@ -12,6 +12,7 @@
 //
 //=============================================================================
 
+#include <algorithm>
 #include "ac/common.h"
 #include "ac/object.h"
 #include "ac/character.h"
@@ -34,6 +35,11 @@ extern RoomStatus*croom;
 extern RoomObject*objs;
 
 Bitmap *walkareabackup=nullptr, *walkable_areas_temp = nullptr;
+// Parts of walkable_areas_temp which were cut out by the last preparation,
+// in mask coordinates; only these are copied back from the room mask
+// before the next preparation, unless the whole temp mask is invalidated
+static std::vector<Rect> walkable_temp_cuts;
+static bool walkable_temp_valid = false;
 
 void redo_walkable_areas()
 {
@@ -48,11 +54,35 @@ void redo_walkable_areas()
                 walls_scanline[w] = 0;
         }
     }
+    invalidate_walkable_areas_temp();
+}
+
+void invalidate_walkable_areas_temp()
+{
+    walkable_temp_valid = false;
+    walkable_temp_cuts.clear();
+}
+
+// Restores the temp mask to the room's walkable areas
+static void reset_walkable_areas_temp()
+{
+    Bitmap *mask = thisroom.WalkAreaMask.get();
+    if (!walkable_temp_valid || (walkable_areas_temp->GetSize() != mask->GetSize()))
+    {
+        walkable_areas_temp->Blit(mask, 0,0,0,0,mask->GetWidth(),mask->GetHeight());
+        walkable_temp_valid = true;
+    }
+    else
+    {
+        for (const auto &rc : walkable_temp_cuts)
+            walkable_areas_temp->Blit(mask, rc.Left, rc.Top, rc.Left, rc.Top, rc.GetWidth(), rc.GetHeight());
+    }
+    walkable_temp_cuts.clear();
 }
 
 int get_walkable_area_pixel(int x, int y)
 {
-    return thisroom.WalkAreaMask->GetPixel(room_to_mask_coord(x), room_to_mask_coord(y));
+    return thisroom.WalkAreaMask->GetPixel8(room_to_mask_coord(x), room_to_mask_coord(y));
 }
 
 int get_area_scaling (int onarea, int xx, int yy) {
@@ -118,6 +148,10 @@ void remove_walkable_areas_from_temp(int fromx, int cwidth, int starty, int endy
     if (starty < 0)
         starty = 0;
 
+    const Rect cut = IntersectRects(Rect(fromx, starty, fromx + cwidth - 1, endy), RectWH(walkable_areas_temp->GetSize()));
+    if (!cut.IsEmpty())
+        walkable_temp_cuts.push_back(cut);
+
     for (; cwidth > 0; cwidth --) {
         for (yyy = starty; yyy <= endy; yyy++)
             walkable_areas_temp->PutPixel (fromx, yyy, 0);
@@ -132,30 +166,37 @@ int is_point_in_rect(int x, int y, int left, int top, int right, int bottom) {
     return 0;
 }
 
-Bitmap *prepare_walkable_areas (int sourceChar) {
-    // copy the walkable areas to the temp bitmap
-    walkable_areas_temp->Blit(thisroom.WalkAreaMask.get(), 0,0,0,0,thisroom.WalkAreaMask->GetWidth(),thisroom.WalkAreaMask->GetHeight());
-    // if the character who's moving doesn't block, don't bother checking
-    if (sourceChar < 0) ;
-    else if (game.chars[sourceChar].flags & CHF_NOBLOCKING)
-        return walkable_areas_temp;
+// Tells if any of the moving characters is standing on the character ww
+static bool is_any_char_on_another(const int *chars, size_t count, int ww) {
+    for (size_t i = 0; i < count; ++i)
+        if (is_char_on_another(chars[i], ww, nullptr, nullptr))
+            return true;
+    return false;
+}
 
+// Makes the areas under the solid characters and objects unwalkable,
+// except for the moving characters themselves, and anything they stand on
+static Bitmap *remove_blocking_from_walkable_areas(const int *chars, size_t count) {
     // for each character in the current room, make the area under them unwalkable
     for (int ww = 0; ww < game.numcharacters; ww++) {
         if (game.chars[ww].on != 1) continue;
         if (game.chars[ww].room != displayed_room) continue;
-        if (ww == sourceChar) continue;
+        if (std::find(chars, chars + count, ww) != chars + count) continue;
         if (game.chars[ww].flags & CHF_NOBLOCKING) continue;
         if (room_to_mask_coord(game.chars[ww].y) >= walkable_areas_temp->GetHeight()) continue;
         if (room_to_mask_coord(game.chars[ww].x) >= walkable_areas_temp->GetWidth()) continue;
         if ((game.chars[ww].y < 0) || (game.chars[ww].x < 0)) continue;
 
         CharacterInfo *char1 = &game.chars[ww];
-        int cwidth, fromx;
+        int cwidth, fromx, y1, y2;
+        get_char_blocking_rect(ww, &fromx, &y1, &cwidth, &y2);
 
-        if (is_char_on_another(sourceChar, ww, &fromx, &cwidth))
+        if (is_any_char_on_another(chars, count, ww))
             continue;
-        if ((sourceChar >= 0) && (is_char_on_another(ww, sourceChar, nullptr, nullptr)))
+        bool on_moving_char = false;
+        for (size_t i = 0; (i < count) && !on_moving_char; ++i)
+            on_moving_char = is_char_on_another(ww, chars[i], nullptr, nullptr) != 0;
+        if (on_moving_char)
             continue;
 
         remove_walkable_areas_from_temp(fromx, cwidth, char1->get_blocking_top(), char1->get_blocking_bottom());
@@ -175,9 +216,11 @@ Bitmap *prepare_walkable_areas (int sourceChar) {
 
         // if the character is currently standing on the object, ignore
         // it so as to allow him to escape
-        if ((sourceChar >= 0) &&
-            (is_point_in_rect(game.chars[sourceChar].x, game.chars[sourceChar].y, 
-            x1, y1, x1 + width, y2)))
+        bool under_moving_char = false;
+        for (size_t i = 0; (i < count) && !under_moving_char; ++i)
+            under_moving_char = is_point_in_rect(game.chars[chars[i]].x, game.chars[chars[i]].y,
+                x1, y1, x1 + width, y2) != 0;
+        if (under_moving_char)
             continue;
 
         remove_walkable_areas_from_temp(x1, width, y1, y2);
@@ -186,6 +229,24 @@ Bitmap *prepare_walkable_areas (int sourceChar) {
     return walkable_areas_temp;
 }
 
+Bitmap *prepare_walkable_areas (int sourceChar) {
+    // restore the walkable areas in the temp bitmap
+    reset_walkable_areas_temp();
+    // if the character who's moving doesn't block, don't bother checking
+    if (sourceChar < 0)
+        return remove_blocking_from_walkable_areas(nullptr, 0);
+    else if (game.chars[sourceChar].flags & CHF_NOBLOCKING)
+        return walkable_areas_temp;
+    return remove_blocking_from_walkable_areas(&sourceChar, 1);
+}
+
+Bitmap *prepare_walkable_areas_for_group(const std::vector<int> &chars) {
+    reset_walkable_areas_temp();
+    if (chars.empty())
+        return remove_blocking_from_walkable_areas(nullptr, 0);
+    return remove_blocking_from_walkable_areas(&chars[0], chars.size());
+}
+
 // return the walkable area at the character's feet, taking into account
 // that he might just be off the edge of one
 int get_walkable_area_at_location(int xx, int yy) {
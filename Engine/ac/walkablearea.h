@@ -18,14 +18,25 @@
 #ifndef __AGS_EE_AC__WALKABLEAREA_H
 #define __AGS_EE_AC__WALKABLEAREA_H
 
+#include <vector>
+
 void  redo_walkable_areas();
+// Tells that the room's walkable mask was changed, or may be changed
+// externally, so the whole temp mask must be copied again
+void  invalidate_walkable_areas_temp();
 int   get_walkable_area_pixel(int x, int y);
 int   get_area_scaling (int onarea, int xx, int yy);
 void  scale_sprite_size(int sppic, int zoom_level, int *newwidth, int *newheight);
 void  remove_walkable_areas_from_temp(int fromx, int cwidth, int starty, int endy);
 int   is_point_in_rect(int x, int y, int left, int top, int right, int bottom);
 // IMPORTANT: this function returns *global pointer*, do not delete the returned bitmap! -- subject to future refactor
+// Prepares the walkable areas for the character's route: the temp mask with
+// the other solid characters and objects cut out. The temp mask is kept
+// between the calls, and only the previously cut parts are restored.
 Common::Bitmap *prepare_walkable_areas (int sourceChar);
+// Prepares the walkable areas for the group of characters moving together,
+// the group members do not block each other
+Common::Bitmap *prepare_walkable_areas_for_group(const std::vector<int> &chars);
 int   get_walkable_area_at_location(int xx, int yy);
 int   get_walkable_area_at_character (int charnum);
 
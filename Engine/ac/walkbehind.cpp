@@ -27,14 +27,6 @@ extern RoomStruct thisroom;
 extern IGraphicsDriver *gfxDriver;
 extern RoomStatus *croom;
 
-// An info on vertical column of walk-behind mask, which may contain WB area
-struct WalkBehindColumn
-{
-    bool Exists = false; // whether any WB area is in this column
-    int Y1 = 0, Y2 = 0; // WB top and bottom Y coords
-};
-
-std::vector<WalkBehindColumn> walkBehindCols; // precalculated WB positions
 Rect walkBehindAABB[MAX_WALK_BEHINDS]; // WB bounding box
 int walkBehindsCachedForBgNum = 0; // WB textures are for this background
 bool noWalkBehindsAtAll = false; // quick report that no WBs in this room
@@ -98,43 +90,50 @@ bool walkbehinds_cropout(Bitmap *sprit, int sprx, int spry, int basel)
     if (noWalkBehindsAtAll)
         return false;
 
+    // Find which areas are in front of the sprite and overlap it,
+    // and the part of the sprite which they may cover
+    const Rect sprite_rc = RectWH(sprx, spry, sprit->GetWidth(), sprit->GetHeight());
+    Rect crop_rc(INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN);
+    bool front_area[256] {}; // indexed by the mask's pixel value
+    for (int wb = 1 /* 0 is "no area" */; wb < MAX_WALK_BEHINDS; ++wb)
+    {
+        if (croom->walkbehind_base[wb] <= basel)
+            continue;
+        const Rect rc = IntersectRects(sprite_rc, walkBehindAABB[wb]);
+        if (rc.IsEmpty())
+            continue;
+        front_area[wb] = true;
+        crop_rc = Rect(std::min(crop_rc.Left, rc.Left), std::min(crop_rc.Top, rc.Top),
+            std::max(crop_rc.Right, rc.Right), std::max(crop_rc.Bottom, rc.Bottom));
+    }
+    if (crop_rc.IsEmpty())
+        return false;
+
     const int maskcol = sprit->GetMaskColor();
     const int spcoldep = sprit->GetColorDepth();
-
+    const Bitmap *mask = thisroom.WalkBehindMask.get();
     bool pixels_changed = false;
-    // pass along the sprite's pixels, but skip those that lie outside the mask
-    for (int x = std::max(0, 0 - sprx);
-        (x < sprit->GetWidth()) && (x + sprx < thisroom.WalkBehindMask->GetWidth()); ++x)
+    // pass along the covered lines, and cut out the pixels of the front areas
+    for (int y = crop_rc.Top; y <= crop_rc.Bottom; ++y)
     {
-        // select the WB column at this x
-        const auto &wbcol = walkBehindCols[x + sprx];
-        // skip if no area, or sprite lies outside of all areas in this column
-        if ((!wbcol.Exists) ||
-            (wbcol.Y2 <= spry) ||
-            (wbcol.Y1 > spry + sprit->GetHeight()))
-            continue;
-
-        // ensure we only check within the valid areas (between Y1 and Y2)
-        // we assume that Y1 and Y2 are always within the mask
-        for (int y = std::max(0, wbcol.Y1 - spry);
-            (y < sprit->GetHeight()) && (y + spry < wbcol.Y2); ++y)
+        const uint8_t *check_line = mask->GetScanLine(y);
+        uint8_t *dst_line = sprit->GetScanLineForWriting(y - spry);
+        for (int x = crop_rc.Left; x <= crop_rc.Right; ++x)
         {
-            const int wb = thisroom.WalkBehindMask->GetScanLine(y + spry)[x + sprx];
-            if (wb < 1) continue; // "no area"
-            if (croom->walkbehind_base[wb] <= basel) continue;
+            if (!front_area[check_line[x]])
+                continue;
 
             pixels_changed = true;
-            uint8_t *dst_line = sprit->GetScanLineForWriting(y);
             switch (spcoldep)
             {
             case 8:
-                dst_line[x] = maskcol;
+                dst_line[x - sprx] = maskcol;
                 break;
             case 16:
-                reinterpret_cast<uint16_t*>(dst_line)[x] = maskcol;
+                reinterpret_cast<uint16_t*>(dst_line)[x - sprx] = maskcol;
                 break;
             case 32:
-                reinterpret_cast<uint32_t*>(dst_line)[x] = maskcol;
+                reinterpret_cast<uint32_t*>(dst_line)[x - sprx] = maskcol;
                 break;
             default:
                 assert(0);
@@ -148,7 +147,6 @@ bool walkbehinds_cropout(Bitmap *sprit, int sprx, int spry, int basel)
 void walkbehinds_recalc()
 {
     // Reset all data
-    walkBehindCols.clear();
     for (int wb = 0; wb < MAX_WALK_BEHINDS; ++wb)
     {
         walkBehindAABB[wb] = Rect(INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN);
@@ -157,27 +155,20 @@ void walkbehinds_recalc()
 
     // Recalculate everything; note that mask is always 8-bit
     const Bitmap *mask = thisroom.WalkBehindMask.get();
-    walkBehindCols.resize(mask->GetWidth());
-    for (int col = 0; col < mask->GetWidth(); ++col)
+    for (int y = 0; y < mask->GetHeight(); ++y)
     {
-        auto &wbcol = walkBehindCols[col];
-        for (int y = 0; y < mask->GetHeight(); ++y)
+        const uint8_t *check_line = mask->GetScanLine(y);
+        for (int x = 0; x < mask->GetWidth(); ++x)
         {
-            int wb = mask->GetScanLine(y)[col];
+            int wb = check_line[x];
             // Valid areas start with index 1, 0 = no area
             if ((wb >= 1) && (wb < MAX_WALK_BEHINDS))
             {
-                if (!wbcol.Exists)
-                {
-                    wbcol.Y1 = y;
-                    wbcol.Exists = true;
-                    noWalkBehindsAtAll = false;
-                }
-                wbcol.Y2 = y + 1; // +1 to allow bottom line of screen to work (CHECKME??)
+                noWalkBehindsAtAll = false;
                 // resize the bounding rect
-                walkBehindAABB[wb].Left = std::min(col, walkBehindAABB[wb].Left);
+                walkBehindAABB[wb].Left = std::min(x, walkBehindAABB[wb].Left);
                 walkBehindAABB[wb].Top = std::min(y, walkBehindAABB[wb].Top);
-                walkBehindAABB[wb].Right = std::max(col, walkBehindAABB[wb].Right);
+                walkBehindAABB[wb].Right = std::max(x, walkBehindAABB[wb].Right);
                 walkBehindAABB[wb].Bottom = std::max(y, walkBehindAABB[wb].Bottom);
             }
         }
@@ -0,0 +1,329 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Route finder benchmark: runs the same fixed set of find_route queries with
+// the legacy pathfinder, and with the current one (with and without the
+// hierarchical search), on each walkable mask; prints the timing percentiles,
+// average number of expanded nodes and the total length of the found paths.
+//
+// Usage: routefinder_bench [--queries N] [--seed N] [--output FILE] [mask ...]
+//
+// Masks are read from the room files (*.crm), or from the 8-bit images, where
+// each non-zero pixel is a walkable area. Without any masks, the benchmark
+// uses the generated ones. The --output file receives the results of each
+// query, which may be compared between the engine versions.
+//
+//=============================================================================
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+#include "ac/common.h"
+#include "ac/game_version.h"
+#include "ac/movelist.h"
+#include "ac/route_finder.h"
+#include "game/room_file.h"
+#include "game/roomstruct.h"
+#include "gfx/bitmap.h"
+#include "util/path.h"
+
+using namespace AGS::Common;
+
+// Reimplementation of project-dependent functions and variables from Engine
+GameDataVersion loaded_game_file_version = kGameVersion_Current;
+std::vector<MoveList> mls;
+
+void quit(const char *msg)
+{
+    fprintf(stderr, "Error: %s\n", msg);
+    exit(EXIT_FAILURE);
+}
+
+void quit(const String &msg)
+{
+    quit(msg.GetCStr());
+}
+
+void __my_setcolor(int *ctset, int newcol, int /*wantColDep*/)
+{
+    *ctset = newcol;
+}
+
+String cc_format_error(const String &message)
+{
+    return message;
+}
+
+String cc_get_callstack(int /*max_lines*/)
+{
+    return "";
+}
+
+
+typedef std::chrono::steady_clock BenchClock;
+
+struct RouteQuery
+{
+    int SrcX, SrcY;
+    int DstX, DstY;
+};
+
+struct QueryResult
+{
+    bool   Found = false;
+    double Usec = 0.0;
+    int    Nodes = 0;
+    float  Length = 0.f;
+};
+
+struct Pathfinder
+{
+    const char     *Name;
+    GameDataVersion Version;
+    bool            Hierarchical;
+};
+
+static const Pathfinder Pathfinders[] = {
+    { "legacy", kGameVersion_341, false },
+    { "jps", kGameVersion_Current, false },
+    { "jps-hierarchical", kGameVersion_Current, true }
+};
+
+// Generates a mask with the random rectangular obstacles, and a few large areas
+static Bitmap *GenerateMask(int width, int height, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    Bitmap *mask = BitmapHelper::CreateBitmap(width, height, 8);
+    mask->Clear(0);
+    mask->FillRect(Rect(1, 1, width - 2, height - 2), 1);
+    mask->FillRect(Rect(width / 2, 1, width - 2, height / 2), 2);
+    const int obstacles = width * height / 4000;
+    for (int i = 0; i < obstacles; ++i)
+    {
+        const int w = 2 + rng() % (width / 16);
+        const int h = 2 + rng() % (height / 16);
+        const int x = rng() % width;
+        const int y = rng() % height;
+        mask->FillRect(Rect(x, y, x + w - 1, y + h - 1), 0);
+    }
+    return mask;
+}
+
+// Loads the walkable mask from the room file or an image
+static Bitmap *LoadMask(const String &filename)
+{
+    if (Path::GetFileExtension(filename).CompareNoCase("crm") == 0)
+    {
+        RoomDataSource src;
+        HRoomFileError err = OpenRoomFile(filename, src);
+        RoomStruct room;
+        room.InitDefaults();
+        if (err)
+            err = ReadRoomData(&room, std::move(src.InputStream), src.DataVersion);
+        if (!err)
+        {
+            fprintf(stderr, "Failed to load room '%s': %s\n", filename.GetCStr(), err->FullMessage().GetCStr());
+            return nullptr;
+        }
+        // the mask is used in its own resolution, like the engine does
+        return room.WalkAreaMask ? BitmapHelper::CreateBitmapCopy(room.WalkAreaMask.get()) : nullptr;
+    }
+
+    std::unique_ptr<Bitmap> image(BitmapHelper::LoadFromFile(filename));
+    if (!image)
+    {
+        fprintf(stderr, "Failed to load image '%s'\n", filename.GetCStr());
+        return nullptr;
+    }
+    if (image->GetColorDepth() == 8)
+        return image.release();
+    Bitmap *mask = BitmapHelper::CreateBitmap(image->GetWidth(), image->GetHeight(), 8);
+    for (int y = 0; y < image->GetHeight(); ++y)
+        for (int x = 0; x < image->GetWidth(); ++x)
+            mask->PutPixel(x, y, (image->GetPixel(x, y) & 0xFFFFFF) ? 1 : 0);
+    return mask;
+}
+
+// Picks the random pairs of points on the walkable areas; the same seed
+// gives the same queries for the same mask
+static std::vector<RouteQuery> MakeQueries(const Bitmap *mask, int count, uint32_t seed)
+{
+    std::vector<int> walkable;
+    for (int y = 0; y < mask->GetHeight(); ++y)
+    {
+        const uint8_t *line = mask->GetScanLine(y);
+        for (int x = 0; x < mask->GetWidth(); ++x)
+            if (line[x])
+                walkable.push_back(y * mask->GetWidth() + x);
+    }
+    std::vector<RouteQuery> queries;
+    if (walkable.empty())
+        return queries;
+    std::mt19937 rng(seed);
+    const int w = mask->GetWidth();
+    for (int i = 0; i < count; ++i)
+    {
+        const int src = walkable[rng() % walkable.size()];
+        const int dst = walkable[rng() % walkable.size()];
+        queries.push_back({ src % w, src / w, dst % w, dst / w });
+    }
+    return queries;
+}
+
+static float GetPathLength(const MoveList &mlist)
+{
+    float len = 0.f;
+    for (int i = 1; i < mlist.numstage; ++i)
+    {
+        const float dx = static_cast<float>(mlist.pos[i].X - mlist.pos[i - 1].X);
+        const float dy = static_cast<float>(mlist.pos[i].Y - mlist.pos[i - 1].Y);
+        len += std::sqrt(dx * dx + dy * dy);
+    }
+    return len;
+}
+
+static double GetPercentile(std::vector<double> sorted, double pc)
+{
+    if (sorted.empty())
+        return 0.0;
+    const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(pc * sorted.size()));
+    return sorted[index];
+}
+
+static std::vector<QueryResult> RunQueries(const Pathfinder &pf, Bitmap *mask,
+    const std::vector<RouteQuery> &queries)
+{
+    loaded_game_file_version = pf.Version;
+    init_pathfinder(pf.Version, pf.Hierarchical);
+    set_wallscreen(mask);
+    std::vector<QueryResult> results;
+    const int move_id = 1;
+    for (const auto &q : queries)
+    {
+        mls[move_id] = MoveList();
+        const auto start = BenchClock::now();
+        const int found = find_route(q.SrcX, q.SrcY, q.DstX, q.DstY, 1, 1, mask, move_id, 1, 0);
+        QueryResult res;
+        res.Usec = std::chrono::duration<double>(BenchClock::now() - start).count() * 1000000.0;
+        res.Nodes = get_route_expanded_nodes();
+        // the route may end at the nearest reachable point instead
+        res.Found = (found != 0) && (mls[move_id].GetLastPos() == Point(q.DstX, q.DstY));
+        if (found)
+            res.Length = GetPathLength(mls[move_id]);
+        results.push_back(res);
+    }
+    shutdown_pathfinder();
+    return results;
+}
+
+static void PrintSummary(const char *name, const std::vector<QueryResult> &results)
+{
+    std::vector<double> times;
+    double nodes = 0.0, length = 0.0;
+    int found = 0;
+    for (const auto &r : results)
+    {
+        times.push_back(r.Usec);
+        nodes += r.Nodes;
+        length += r.Length;
+        found += r.Found ? 1 : 0;
+    }
+    std::sort(times.begin(), times.end());
+    const double count = std::max<size_t>(1u, results.size());
+    printf("%-18s %6d %10.1f %10.1f %10.1f %10.1f %10.0f %12.0f\n", name, found,
+        GetPercentile(times, 0.5), GetPercentile(times, 0.9), GetPercentile(times, 0.99),
+        times.empty() ? 0.0 : times.back(), nodes / count, length);
+}
+
+int main(int argc, char *argv[])
+{
+    int query_count = 200;
+    uint32_t seed = 1;
+    const char *output = nullptr;
+    std::vector<String> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        if ((strcmp(argv[i], "--queries") == 0) && (i + 1 < argc))
+            query_count = std::max(1, atoi(argv[++i]));
+        else if ((strcmp(argv[i], "--seed") == 0) && (i + 1 < argc))
+            seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc))
+            output = argv[++i];
+        else if (argv[i][0] != '-')
+            files.push_back(argv[i]);
+        else
+        {
+            printf("Usage: routefinder_bench [--queries N] [--seed N] [--output FILE] [mask ...]\n");
+            return 1;
+        }
+    }
+
+    std::vector<std::pair<String, std::unique_ptr<Bitmap>>> masks;
+    for (const auto &file : files)
+    {
+        std::unique_ptr<Bitmap> mask(LoadMask(file));
+        if (!mask)
+            return 1;
+        masks.emplace_back(file, std::move(mask));
+    }
+    if (files.empty())
+    {
+        masks.emplace_back("generated 320x200", std::unique_ptr<Bitmap>(GenerateMask(320, 200, seed)));
+        masks.emplace_back("generated 1280x720", std::unique_ptr<Bitmap>(GenerateMask(1280, 720, seed)));
+    }
+
+    FILE *out = output ? fopen(output, "w") : nullptr;
+    if (output && !out)
+    {
+        fprintf(stderr, "Failed to open '%s' for writing\n", output);
+        return 1;
+    }
+    if (out)
+        fprintf(out, "mask,pathfinder,query,srcx,srcy,dstx,dsty,found,nodes,length\n");
+
+    mls.resize(2);
+    for (const auto &m : masks)
+    {
+        Bitmap *mask = m.second.get();
+        const auto queries = MakeQueries(mask, query_count, seed);
+        printf("%s (%dx%d), %d queries\n", m.first.GetCStr(), mask->GetWidth(), mask->GetHeight(),
+            static_cast<int>(queries.size()));
+        printf("%-18s %6s %10s %10s %10s %10s %10s %12s\n", "pathfinder", "found",
+            "p50 (us)", "p90 (us)", "p99 (us)", "max (us)", "avg nodes", "total length");
+        for (const auto &pf : Pathfinders)
+        {
+            const auto results = RunQueries(pf, mask, queries);
+            PrintSummary(pf.Name, results);
+            if (!out)
+                continue;
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                const auto &q = queries[i];
+                fprintf(out, "%s,%s,%d,%d,%d,%d,%d,%d,%d,%.1f\n", m.first.GetCStr(), pf.Name,
+                    static_cast<int>(i), q.SrcX, q.SrcY, q.DstX, q.DstY, results[i].Found ? 1 : 0,
+                    results[i].Nodes, results[i].Length);
+            }
+        }
+        printf("\n");
+    }
+
+    if (out)
+        fclose(out);
+    return 0;
+}
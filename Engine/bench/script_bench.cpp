@@ -0,0 +1,337 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Script interpreter benchmark: compiles a set of script kernels with the
+// in-tree script compiler, each representing a typical kind of game script
+// workload, and runs them in the script interpreter. Prints the best time of
+// several runs for each kernel, the number of executed instructions and the
+// average time per instruction.
+//
+// Usage: engine_script_bench [--iterations N] [--loops N] [--optimize N]
+//        [kernel ...]
+//
+// --loops sets the number of loop iterations done by each kernel in one run,
+// --optimize sets the script compiler's optimization level. When the kernel
+// names are given, only these kernels are run.
+//
+// The number of instructions is counted in a separate run, with the script
+// profiler enabled, so that counting does not affect the timed runs.
+//
+//=============================================================================
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "core/def_version.h"
+#include "script/cc_common.h"
+#include "script/cc_instance.h"
+#include "script/cc_internal.h"
+#include "script/cs_compiler.h"
+#include "script/script_api.h"
+#include "script/script_profiler.h"
+#include "script/script_runtime.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+extern void RegisterStringAPI();
+
+
+// Script header, declaring the engine API used by the kernels
+static const char *BenchHeader =
+    "internalstring autoptr builtin managed struct String {\n"
+    "  import String  Append(const string appendText);\n"
+    "  import String  AppendChar(int extraChar);\n"
+    "  readonly import attribute int Length;\n"
+    "};\n"
+    "import int Bench_Add(int a, int b);\n"
+    "import int Bench_Mix(int value);\n";
+
+// Script kernels; each takes the number of loop iterations
+static const char *BenchScript =
+    "int IntLoops(int loops)\n"
+    "{\n"
+    "  int acc = 0;\n"
+    "  for (int i = 0; i < loops; i++)\n"
+    "  {\n"
+    "    acc += (i * 7) % 13 - (i >> 2);\n"
+    "    if (acc > 100000)\n"
+    "      acc -= 100000;\n"
+    "    else if (acc < -100000)\n"
+    "      acc += 100000;\n"
+    "  }\n"
+    "  return acc;\n"
+    "}\n"
+    "\n"
+    "int FloatMath(int loops)\n"
+    "{\n"
+    "  float x = 0.0;\n"
+    "  float v = 1.5;\n"
+    "  for (int i = 0; i < loops; i++)\n"
+    "  {\n"
+    "    x = x * 0.5 + v;\n"
+    "    v = v * 1.0001 - 0.0001;\n"
+    "    if (x > 1000.0)\n"
+    "      x = 0.0;\n"
+    "  }\n"
+    "  if (x > 1.0)\n"
+    "    return 1;\n"
+    "  return 0;\n"
+    "}\n"
+    "\n"
+    "struct Particle\n"
+    "{\n"
+    "  int x;\n"
+    "  int y;\n"
+    "  int vx;\n"
+    "  int vy;\n"
+    "};\n"
+    "\n"
+    "Particle particles[64];\n"
+    "\n"
+    "int StructFields(int loops)\n"
+    "{\n"
+    "  for (int k = 0; k < 64; k++)\n"
+    "  {\n"
+    "    particles[k].x = k;\n"
+    "    particles[k].y = 64 - k;\n"
+    "    particles[k].vx = k % 3 - 1;\n"
+    "    particles[k].vy = k % 5 - 2;\n"
+    "  }\n"
+    "  int sum = 0;\n"
+    "  for (int i = 0; i < loops; i++)\n"
+    "  {\n"
+    "    int k = i & 63;\n"
+    "    particles[k].x += particles[k].vx;\n"
+    "    particles[k].y += particles[k].vy;\n"
+    "    if (particles[k].x < 0 || particles[k].x > 320)\n"
+    "      particles[k].vx = -particles[k].vx;\n"
+    "    if (particles[k].y < 0 || particles[k].y > 200)\n"
+    "      particles[k].vy = -particles[k].vy;\n"
+    "    sum += particles[k].x + particles[k].y;\n"
+    "  }\n"
+    "  return sum;\n"
+    "}\n"
+    "\n"
+    "managed struct Vec2\n"
+    "{\n"
+    "  int x;\n"
+    "  int y;\n"
+    "};\n"
+    "\n"
+    "int ObjectChurn(int loops)\n"
+    "{\n"
+    "  int sum = 0;\n"
+    "  for (int i = 0; i < loops; i++)\n"
+    "  {\n"
+    "    Vec2 *v = new Vec2;\n"
+    "    v.x = i;\n"
+    "    v.y = i * 2;\n"
+    "    sum += v.x + v.y;\n"
+    "  }\n"
+    "  return sum;\n"
+    "}\n"
+    "\n"
+    "int StringBuild(int loops)\n"
+    "{\n"
+    "  String s = \"\";\n"
+    "  int total = 0;\n"
+    "  for (int i = 0; i < loops; i++)\n"
+    "  {\n"
+    "    s = s.AppendChar('a' + i % 26);\n"
+    "    if (s.Length >= 64)\n"
+    "    {\n"
+    "      s = s.Append(\"!\");\n"
+    "      total += s.Length;\n"
+    "      s = \"\";\n"
+    "    }\n"
+    "  }\n"
+    "  return total;\n"
+    "}\n"
+    "\n"
+    "int ArrayIter(int loops)\n"
+    "{\n"
+    "  int arr[] = new int[256];\n"
+    "  for (int k = 0; k < 256; k++)\n"
+    "    arr[k] = k;\n"
+    "  int sum = 0;\n"
+    "  for (int i = 0; i < loops; i++)\n"
+    "  {\n"
+    "    int k = i & 255;\n"
+    "    arr[k] = arr[k] + arr[255 - k];\n"
+    "    sum += arr[k] & 0xFF;\n"
+    "  }\n"
+    "  return sum;\n"
+    "}\n"
+    "\n"
+    "int ApiCalls(int loops)\n"
+    "{\n"
+    "  int acc = 0;\n"
+    "  for (int i = 0; i < loops; i++)\n"
+    "  {\n"
+    "    acc = Bench_Add(acc, i);\n"
+    "    acc = Bench_Mix(acc);\n"
+    "  }\n"
+    "  return acc;\n"
+    "}\n";
+
+static const char *KernelNames[] = {
+    "IntLoops", "FloatMath", "StructFields", "ObjectChurn",
+    "StringBuild", "ArrayIter", "ApiCalls"
+};
+
+
+// Stub engine API, called by the "ApiCalls" kernel: one function is called
+// through the regular "translator" function, and another is called directly
+int Bench_Add(int a, int b)
+{
+    return (a + b) & 0xFFFF;
+}
+
+int Bench_Mix(int value)
+{
+    return (value * 31) ^ (value >> 3);
+}
+
+RuntimeScriptValue Sc_Bench_Add(const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_SCALL_INT_PINT2(Bench_Add);
+}
+
+RuntimeScriptValue Sc_Bench_Mix(const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_SCALL_INT_PINT(Bench_Mix);
+}
+
+
+typedef std::chrono::steady_clock BenchClock;
+
+static bool PrintError(const char *phase)
+{
+    if (!cc_has_error())
+        return false;
+    fprintf(stderr, "%s failed: %s\n", phase, cc_get_error().ErrorString.GetCStr());
+    return true;
+}
+
+// Runs the kernel once, returns false on script error
+static bool RunKernel(ccInstance *inst, const ScriptFunctionRef &fn, int loops)
+{
+    cc_clear_error();
+    RuntimeScriptValue params[] = { RuntimeScriptValue().SetInt32(loops) };
+    return (inst->CallScriptFunction(fn, 1, params) == 0) && !cc_has_error();
+}
+
+static bool RunBenchmark(ccInstance *inst, const char *name, int iterations, int loops)
+{
+    const ScriptFunctionRef fn = inst->GetScriptFunction(name);
+    if (!fn.IsValid())
+    {
+        fprintf(stderr, "Kernel not found: %s\n", name);
+        return false;
+    }
+
+    // Count the instructions in a separate run, and also warm up
+    ScriptProfiler::Start("", UINT32_MAX);
+    const bool counted = RunKernel(inst, fn, loops);
+    const uint64_t instructions = ScriptProfiler::InstructionCount;
+    ScriptProfiler::Stop();
+    if (!counted)
+    {
+        PrintError(name);
+        return false;
+    }
+
+    double best = -1.0;
+    for (int iter = 0; iter < iterations; ++iter)
+    {
+        const auto start = BenchClock::now();
+        const bool ok = RunKernel(inst, fn, loops);
+        const double sec = std::chrono::duration<double>(BenchClock::now() - start).count();
+        if (!ok)
+        {
+            PrintError(name);
+            return false;
+        }
+        if (best < 0.0 || sec < best)
+            best = sec;
+    }
+
+    printf("%-14s %14llu %10.3f %12.2f\n", name, static_cast<unsigned long long>(instructions),
+        best * 1000.0, instructions > 0 ? best * 1000000000.0 / instructions : 0.0);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = 5;
+    int loops = 1000000;
+    int opt_level = ccGetOptimizationLevel();
+    std::vector<const char*> kernels;
+    for (int i = 1; i < argc; ++i)
+    {
+        if ((strcmp(argv[i], "--iterations") == 0) && (i + 1 < argc))
+            iterations = std::max(1, atoi(argv[++i]));
+        else if ((strcmp(argv[i], "--loops") == 0) && (i + 1 < argc))
+            loops = std::max(1, atoi(argv[++i]));
+        else if ((strcmp(argv[i], "--optimize") == 0) && (i + 1 < argc))
+            opt_level = std::max(0, atoi(argv[++i]));
+        else if (argv[i][0] == '-')
+        {
+            printf("Usage: engine_script_bench [--iterations N] [--loops N] [--optimize N] [kernel ...]\n");
+            return 1;
+        }
+        else
+            kernels.push_back(argv[i]);
+    }
+    if (kernels.empty())
+        kernels.assign(std::begin(KernelNames), std::end(KernelNames));
+
+    // Compile the kernels the way the Editor compiles the game scripts
+    ccSetSoftwareVersion(ACI_VERSION_STR);
+    ccSetOption(SCOPT_EXPORTALL, 1);
+    ccSetOption(SCOPT_LINENUMBERS, 1);
+    ccSetOption(SCOPT_LEFTTORIGHT, 1);
+    ccSetOption(SCOPT_OLDSTRINGS, 0);
+    ccSetOptimizationLevel(opt_level);
+    ccAddDefaultHeader(BenchHeader, "bench.ash");
+    PScript script(ccCompileText(BenchScript, "bench.asc"));
+    if (!script)
+    {
+        PrintError("Compiling");
+        return 1;
+    }
+
+    RegisterStringAPI();
+    ccAddExternalStaticFunction("Bench_Add", Sc_Bench_Add, (void*)Bench_Add);
+    ccAddExternalStaticFunction("Bench_Mix", Sc_Bench_Mix, ScriptAPIFastFn(Bench_Mix));
+    std::unique_ptr<ccInstance> inst(ccInstance::CreateFromScript(script));
+    if (!inst)
+    {
+        PrintError("Creating script instance");
+        return 1;
+    }
+
+    printf("Best of %d runs, %d loops per run, optimization level %d\n", iterations, loops, opt_level);
+    printf("%-14s %14s %10s %12s\n", "kernel", "instructions", "time (ms)", "ns/instr");
+    for (const char *name : kernels)
+    {
+        if (!RunBenchmark(inst.get(), name, iterations, loops))
+            return 1;
+    }
+    return 0;
+}
@@ -11,6 +11,8 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
+#include <chrono>
 #include <limits>
 #include <inttypes.h>
 #include <memory>
@@ -23,14 +25,20 @@
 #include "ac/common.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/gamestate.h"
+#include "ac/draw.h"
 #include "ac/runtime_defines.h"
+#include "ac/timer.h"
+#include "ac/dynobj/dynobj_manager.h"
 #include "debug/agseditordebugger.h"
+#include "debug/asyncoutput.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
 #include "debug/debugmanager.h"
 #include "debug/out.h"
 #include "debug/logfile.h"
 #include "debug/messagebuffer.h"
+#include "debug/socketagsdebugger.h"
+#include "gfx/graphicsdriver.h"
 #include "main/config.h"
 #include "main/game_run.h"
 #include "media/audio/audio_system.h"
@@ -52,6 +60,7 @@ extern int displayed_room;
 extern RoomStruct thisroom;
 extern volatile bool want_exit, abort_engine;
 extern GameSetupStruct game;
+extern IGraphicsDriver *gfxDriver;
 
 
 int editor_debugging_enabled = 0;
@@ -60,6 +69,8 @@ char editor_debugger_instance_token[100];
 IAGSEditorDebugger *editor_debugger = nullptr;
 int break_on_next_script_step = 0;
 volatile int game_paused_in_debugger = 0;
+// Period of sending the telemetry to the debugger, 0 if it did not ask for it
+static int debugger_telemetry_interval_ms = 0;
 
 #if AGS_PLATFORM_OS_WINDOWS
 
@@ -67,23 +78,26 @@ volatile int game_paused_in_debugger = 0;
 
 HWND editor_window_handle = 0;
 
+#endif
+
 IAGSEditorDebugger *GetEditorDebugger(const char *instanceToken)
 {
+#if AGS_HAS_SOCKET_DEBUGGER
+    if (SocketAGSDebugger::IsSocketAddress(instanceToken))
+        return new SocketAGSDebugger(instanceToken);
+#endif
+#if AGS_PLATFORM_OS_WINDOWS
     return new NamedPipesAGSDebugger(instanceToken);
-}
-
-#else   // AGS_PLATFORM_OS_WINDOWS
-
-IAGSEditorDebugger *GetEditorDebugger(const char* /*instanceToken*/)
-{
+#else
+    (void)instanceToken;
     return nullptr;
-}
-
 #endif
+}
 
 int debug_flags=0;
 
 FPSDisplayMode display_fps = kFPS_Hide;
+bool display_managed_stats = false;
 
 void send_message_to_debugger(IAGSEditorDebugger *ide_debugger,
     const std::vector<std::pair<String, String>>& tag_values, const String& command)
@@ -207,6 +221,7 @@ std::vector<String> parse_log_multigroup(const String &group_str)
         case 'c': grplist.emplace_back("sprcache"); break;
         case 'o': grplist.emplace_back("manobj"); break;
         case 'l': grplist.emplace_back("sdl"); break;
+        case 'r': grplist.emplace_back("roomload"); break;
         }
     }
     return grplist;
@@ -282,6 +297,9 @@ static void apply_log_config(const ConfigTree &cfg, const String &log_id,
         auto dbgout = create_log_output(log_id, path);
         if (!dbgout)
             return;
+        // Optionally pass the messages to the output on a writer thread
+        if (CfgReadBoolInt(cfg, "log", String::FromFormat("%s-async", log_id.GetCStr()), false))
+            dbgout = std::make_unique<AsyncOutput>(std::move(dbgout));
         DbgMgr.RegisterOutput(log_id, std::move(dbgout), def_verbosity, &group_filters);
     }
 }
@@ -327,6 +345,7 @@ void apply_debug_config(const ConfigTree &cfg)
 #else
           DbgGroupOption(kDbgGroup_ManObj, kDbgMsg_Info),
 #endif
+          DbgGroupOption(kDbgGroup_RoomLoad, kDbgMsg_Info),
         });
 
     // If the game was compiled in Debug mode *and* there's no regular file log,
@@ -382,6 +401,8 @@ static void debug_script_print_impl(const String &msg, MessageType mt)
 
 void debug_script_print(MessageType mt, const char *msg, ...)
 {
+    if (!Debug::IsEnabled(kDbgGroup_Game, mt))
+        return;
     va_list ap;
     va_start(ap, msg);
     String full_msg = String::FromFormatV(msg, ap);
@@ -391,6 +412,8 @@ void debug_script_print(MessageType mt, const char *msg, ...)
 
 void debug_script_warn(const char *msg, ...)
 {
+    if (!Debug::IsEnabled(kDbgGroup_Game, kDbgMsg_Warn))
+        return;
     va_list ap;
     va_start(ap, msg);
     String full_msg = String::FromFormatV(msg, ap);
@@ -400,6 +423,8 @@ void debug_script_warn(const char *msg, ...)
 
 void debug_script_log(const char *msg, ...)
 {
+    if (!Debug::IsEnabled(kDbgGroup_Game, kDbgMsg_Debug))
+        return;
     va_list ap;
     va_start(ap, msg);
     String full_msg = String::FromFormatV(msg, ap);
@@ -442,12 +467,7 @@ bool send_state_to_debugger(const char *msg)
 
 bool init_editor_debugging(const ConfigTree &cfg) 
 {
-#if AGS_PLATFORM_OS_WINDOWS
     editor_debugger = GetEditorDebugger(editor_debugger_instance_token);
-#else
-    // Editor isn't ported yet
-    editor_debugger = nullptr;
-#endif
 
     if (editor_debugger == nullptr)
         quit("editor_debugger is NULL but debugger enabled");
@@ -551,6 +571,17 @@ int check_for_messages_from_debugger()
             game_paused_in_debugger = 0;
             break_on_next_script_step = 1;
         }
+        else if (strncmp(msgPtr, "OBJSTATS", 8) == 0)
+        {
+            std::vector<std::pair<String, String>> stats_info = { { "Text", ccGetManagedObjectsReport() } };
+            send_message_to_debugger(editor_debugger, stats_info, "OBJSTATS");
+        }
+        else if (strncmp(msgPtr, "TELEMETRY", 9) == 0)
+        {
+            // Format:  TELEMETRY $intervalMs$
+            const char *interval = strchr(msgPtr, '$');
+            debugger_telemetry_interval_ms = interval ? std::max(0, atoi(interval + 1)) : 0;
+        }
         else if (strncmp(msgPtr, "EXIT", 4) == 0) 
         {
             want_exit = true;
@@ -568,13 +599,41 @@ int check_for_messages_from_debugger()
 
 
 
+void update_debugger_telemetry()
+{
+    if (!editor_debugging_initialized || debugger_telemetry_interval_ms <= 0 || !gfxDriver)
+        return;
+    static AGS_Clock::time_point last_time;
+    const auto now = AGS_Clock::now();
+    if (now - last_time < std::chrono::milliseconds(debugger_telemetry_interval_ms))
+        return;
+    last_time = now;
+
+    const RenderStageTimes &times = get_render_stage_times();
+    const RenderStats rstats = gfxDriver->GetRenderStats();
+    std::vector<std::pair<String, String>> telemetry = {
+        { "FPS", String::FromFormat("%.2f", get_real_fps()) },
+        { "OverlaysUs", StrUtil::IntToString(times.Overlays) },
+        { "RoomUs", StrUtil::IntToString(times.Room) },
+        { "UIUs", StrUtil::IntToString(times.UI) },
+        { "RenderUs", StrUtil::IntToString(times.Render) },
+        { "Sprites", StrUtil::IntToString(rstats.Sprites) },
+        { "DrawCalls", StrUtil::IntToString(rstats.DrawCalls) },
+        { "UploadBytes", String::FromFormat("%llu", static_cast<unsigned long long>(rstats.UploadBytes)) },
+        { "GpuUs", StrUtil::IntToString(rstats.GpuTimeUs) }
+    };
+    send_message_to_debugger(editor_debugger, telemetry, "TELEMETRY");
+}
+
+
 bool send_exception_to_debugger(const char *qmsg)
 {
-#if AGS_PLATFORM_OS_WINDOWS
     want_exit = false;
+#if AGS_PLATFORM_OS_WINDOWS
     // allow the editor to break with the error message
     if (editor_window_handle != NULL)
         SetForegroundWindow(editor_window_handle);
+#endif
 
     if (!send_state_to_debugger("ERROR", qmsg))
         return false;
@@ -583,9 +642,6 @@ bool send_exception_to_debugger(const char *qmsg)
     {
         platform->Delay(10);
     }
-#else
-    (void)qmsg;
-#endif
     return true;
 }
 
@@ -593,9 +649,9 @@ bool send_exception_to_debugger(const char *qmsg)
 void break_into_debugger() 
 {
 #if AGS_PLATFORM_OS_WINDOWS
-
     if (editor_window_handle != NULL)
         SetForegroundWindow(editor_window_handle);
+#endif
 
     send_state_to_debugger("BREAK");
     game_paused_in_debugger = 1;
@@ -605,8 +661,6 @@ void break_into_debugger()
         update_polled_stuff();
         platform->YieldCPU();
     }
-
-#endif
 }
 
 int scrDebugWait = 0;
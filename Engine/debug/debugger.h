@@ -29,6 +29,8 @@ extern int break_on_next_script_step;
 int check_for_messages_from_debugger();
 bool send_state_to_debugger(const char *msg);
 bool send_exception_to_debugger(const char *qmsg);
+// Sends the frame statistics to the debugger, if it has subscribed to them
+void update_debugger_telemetry();
 // Returns current script's location and callstack
 AGS::Common::String get_cur_script(int numberOfLinesOfCallStack);
 bool get_script_position(ScriptPosition &script_pos);
@@ -55,6 +57,8 @@ enum FPSDisplayMode
 };
 
 extern FPSDisplayMode display_fps;
+// Tells whether to display managed objects statistics on screen
+extern bool display_managed_stats;
 extern int debug_flags;
 
 #endif // __AC_DEBUGGER_H
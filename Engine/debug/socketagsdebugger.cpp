@@ -0,0 +1,250 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "debug/socketagsdebugger.h"
+
+#if AGS_HAS_SOCKET_DEBUGGER
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include "debug/out.h"
+
+using namespace AGS::Common;
+
+// Max amount of the data waiting to be sent; if the debugger does not read
+// the messages, the new ones are discarded rather than stored forever
+static const size_t MaxPendingOutput = 4u * 1024 * 1024;
+static const size_t ReadChunkSize = 4096u;
+
+#if defined(MSG_NOSIGNAL)
+static const int SendFlags = MSG_NOSIGNAL;
+#else
+static const int SendFlags = 0; // SO_NOSIGPIPE is set on the socket instead
+#endif
+
+bool SocketAGSDebugger::IsSocketAddress(const char *instanceToken)
+{
+    return (strncmp(instanceToken, "tcp:", 4) == 0) || (strncmp(instanceToken, "unix:", 5) == 0);
+}
+
+SocketAGSDebugger::SocketAGSDebugger(const char *address)
+    : _address(address)
+{
+}
+
+SocketAGSDebugger::~SocketAGSDebugger()
+{
+    Shutdown();
+}
+
+bool SocketAGSDebugger::Initialize()
+{
+    bool result = false;
+    if (_address.StartsWith("tcp:"))
+    {
+        // The port is after the last separator, so that the host could be an IPv6 address
+        const String addr = _address.Mid(4);
+        const size_t port_at = addr.FindCharReverse(':');
+        if (port_at != String::NoIndex)
+            result = ConnectTCP(addr.Left(port_at), addr.Mid(port_at + 1));
+    }
+    else if (_address.StartsWith("unix:"))
+    {
+        result = ConnectUnix(_address.Mid(5));
+    }
+
+    if (!result)
+    {
+        Debug::Printf(kDbgMsg_Error, "Failed to connect to the debugger at %s", _address.GetCStr());
+        Disconnect();
+        return false;
+    }
+
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+    int on = 1;
+    setsockopt(_socket, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+    // The connection is made blocking, but all the exchange is non-blocking
+    fcntl(_socket, F_SETFL, fcntl(_socket, F_GETFL, 0) | O_NONBLOCK);
+    Debug::Printf(kDbgMsg_Info, "Connected to the debugger at %s", _address.GetCStr());
+    return true;
+}
+
+bool SocketAGSDebugger::ConnectTCP(const String &host, const String &port)
+{
+    // Allow the IPv6 host in brackets, as in "tcp:[::1]:35000"
+    String hostname = host;
+    if (hostname.StartsWith("[") && hostname.GetLast() == ']')
+        hostname = hostname.Mid(1, hostname.GetLength() - 2);
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *addrs = nullptr;
+    if (getaddrinfo(hostname.GetCStr(), port.GetCStr(), &hints, &addrs) != 0)
+        return false;
+    for (addrinfo *ai = addrs; ai; ai = ai->ai_next)
+    {
+        _socket = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (_socket < 0)
+            continue;
+        if (connect(_socket, ai->ai_addr, ai->ai_addrlen) == 0)
+            break;
+        close(_socket);
+        _socket = -1;
+    }
+    freeaddrinfo(addrs);
+    if (_socket < 0)
+        return false;
+    // Messages are small and should reach the debugger without delay
+    int on = 1;
+    setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    return true;
+}
+
+bool SocketAGSDebugger::ConnectUnix(const String &path)
+{
+    sockaddr_un addr{};
+    if (path.IsEmpty() || path.GetLength() >= sizeof(addr.sun_path))
+        return false;
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.GetCStr(), path.GetLength());
+    _socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (_socket < 0)
+        return false;
+    return connect(_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+}
+
+void SocketAGSDebugger::Shutdown()
+{
+    if (_socket < 0)
+        return;
+    // Try to deliver the last messages, such as the error report
+    if (_outPos < _outBuf.size())
+    {
+        fcntl(_socket, F_SETFL, fcntl(_socket, F_GETFL, 0) & ~O_NONBLOCK);
+        FlushOutput();
+    }
+    Disconnect();
+}
+
+void SocketAGSDebugger::Disconnect()
+{
+    if (_socket >= 0)
+        close(_socket);
+    _socket = -1;
+    _outBuf.clear();
+    _outPos = 0u;
+}
+
+bool SocketAGSDebugger::SendMessageToEditor(const char *message)
+{
+    if (_socket < 0)
+        return false;
+    const size_t len = strlen(message) + 1; // including the terminator
+    if (_outBuf.size() - _outPos + len > MaxPendingOutput)
+        return false;
+    // Drop the already sent data before appending
+    if (_outPos > 0u)
+    {
+        _outBuf.erase(_outBuf.begin(), _outBuf.begin() + _outPos);
+        _outPos = 0u;
+    }
+    _outBuf.insert(_outBuf.end(), message, message + len);
+    FlushOutput();
+    return true;
+}
+
+void SocketAGSDebugger::FlushOutput()
+{
+    while (_socket >= 0 && _outPos < _outBuf.size())
+    {
+        const ssize_t sent = send(_socket, &_outBuf[_outPos], _outBuf.size() - _outPos, SendFlags);
+        if (sent > 0)
+        {
+            _outPos += sent;
+        }
+        else if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return; // try again on the next poll
+            Disconnect();
+        }
+    }
+    if (_outPos == _outBuf.size())
+    {
+        _outBuf.clear();
+        _outPos = 0u;
+    }
+}
+
+void SocketAGSDebugger::ReceiveInput()
+{
+    char buf[ReadChunkSize];
+    while (_socket >= 0)
+    {
+        const ssize_t got = recv(_socket, buf, sizeof(buf), 0);
+        if (got > 0)
+        {
+            _inBuf.insert(_inBuf.end(), buf, buf + got);
+        }
+        else if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return;
+            // the debugger has closed the connection, but the messages
+            // which are already received are still delivered
+            Debug::Printf(kDbgMsg_Warn, "The debugger at %s has disconnected", _address.GetCStr());
+            Disconnect();
+        }
+    }
+}
+
+bool SocketAGSDebugger::IsMessageAvailable()
+{
+    // This is polled regularly, so use it to push out the pending output
+    FlushOutput();
+    ReceiveInput();
+    return std::find(_inBuf.begin(), _inBuf.end(), '\0') != _inBuf.end();
+}
+
+char* SocketAGSDebugger::GetNextMessage()
+{
+    const auto end = std::find(_inBuf.begin(), _inBuf.end(), '\0');
+    if (end == _inBuf.end())
+        return nullptr;
+    const size_t len = end - _inBuf.begin() + 1; // including the terminator
+    char *msg = static_cast<char*>(malloc(len));
+    memcpy(msg, _inBuf.data(), len);
+    _inBuf.erase(_inBuf.begin(), _inBuf.begin() + len);
+    return msg;
+}
+
+#endif // AGS_HAS_SOCKET_DEBUGGER
@@ -0,0 +1,79 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// SocketAGSDebugger, the editor debugger connection over a TCP or a Unix
+// domain socket. The engine connects to the debugger, which listens on the
+// address passed with the "--enabledebugger" argument:
+//   tcp:HOST:PORT  - TCP connection, e.g. "tcp:127.0.0.1:35000";
+//   unix:PATH      - Unix domain socket, e.g. "unix:/tmp/ags_debugger".
+//
+// Messages are exchanged in both directions as the null-terminated texts,
+// in the same format as with the other debugger implementations.
+// After connecting, the socket is switched to non-blocking mode: the sent
+// messages are buffered and written as far as the socket accepts them, and
+// the received data is collected until a complete message arrives, so the
+// game is never stalled by a slow debugger.
+//
+// Currently supported on POSIX platforms only.
+//
+//=============================================================================
+#ifndef __AGS_EE_DEBUG__SOCKETAGSDEBUGGER_H
+#define __AGS_EE_DEBUG__SOCKETAGSDEBUGGER_H
+
+#include <vector>
+#include "core/platform.h"
+#include "debug/agseditordebugger.h"
+#include "util/string.h"
+
+#define AGS_HAS_SOCKET_DEBUGGER (!AGS_PLATFORM_OS_WINDOWS && !AGS_PLATFORM_OS_EMSCRIPTEN)
+
+#if AGS_HAS_SOCKET_DEBUGGER
+
+struct SocketAGSDebugger : IAGSEditorDebugger
+{
+public:
+    // Tells if the debugger instance token is a socket address
+    static bool IsSocketAddress(const char *instanceToken);
+
+    SocketAGSDebugger(const char *address);
+    ~SocketAGSDebugger() override;
+
+    bool Initialize() override;
+    void Shutdown() override;
+    bool SendMessageToEditor(const char *message) override;
+    bool IsMessageAvailable() override;
+    char* GetNextMessage() override;
+
+private:
+    bool ConnectTCP(const AGS::Common::String &host, const AGS::Common::String &port);
+    bool ConnectUnix(const AGS::Common::String &path);
+    // Writes as much of the pending output as the socket accepts
+    void FlushOutput();
+    // Reads all the data which has already arrived
+    void ReceiveInput();
+    // Closes the socket after an error or the remote disconnect
+    void Disconnect();
+
+    AGS::Common::String _address;
+    int _socket = -1;
+    // Data waiting to be sent, starting at _outPos
+    std::vector<char> _outBuf;
+    size_t _outPos = 0u;
+    // Received data, which may end with an incomplete message
+    std::vector<char> _inBuf;
+};
+
+#endif // AGS_HAS_SOCKET_DEBUGGER
+
+#endif // __AGS_EE_DEBUG__SOCKETAGSDEBUGGER_H
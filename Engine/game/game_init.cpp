@@ -11,6 +11,7 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <cstring>
 #include <vector>
 #include "ac/character.h"
 #include "ac/dialog.h"
@@ -43,8 +44,10 @@
 #include "platform/base/agsplatformdriver.h"
 #include "plugin/plugin_engine.h"
 #include "script/cc_common.h"
+#include "script/cc_jit.h"
 #include "script/exports.h"
 #include "script/script.h"
+#include "script/script_profiler.h"
 #include "script/script_runtime.h"
 #include "util/string_compat.h"
 #include "util/string_utils.h"
@@ -82,6 +85,7 @@ extern std::vector<String> old_speech_lines;
 
 // Lipsync
 extern std::vector<SpeechLipSyncLine> splipsync;
+extern SpeechLipSyncIndex splipsync_index;
 extern int numLipLines, curLipLine, curLipLinePhoneme;
 
 extern AGSCCStaticObject GlobalStaticManager;
@@ -307,48 +311,68 @@ HError InitAndRegisterGameEntities(GameSetupStruct &game)
     return HError::None();
 }
 
-void LoadFonts(GameSetupStruct &game, GameDataVersion data_ver)
+// Game data version of the fonts being loaded, for the compatibility fixups
+static GameDataVersion fonts_data_ver = kGameVersion_Current;
+
+// Applies the compatibility fixups to the freshly loaded font
+static void FixupFont(size_t font)
 {
-    for (int i = 0; i < game.numfonts; ++i) 
+    // Outline thickness corresponds to 1 game pixel by default;
+    // but if it's a scaled up bitmap font, then it equals to scale
+    if (fonts_data_ver < kGameVersion_360)
     {
-        FontInfo &finfo = game.fonts[i];
-        if (!load_font_size(i, finfo))
-            quitprintf("Unable to load font %d, no renderer could load a matching file", i);
-
-        const bool is_wfn = is_bitmap_font(i);
-        // Outline thickness corresponds to 1 game pixel by default;
-        // but if it's a scaled up bitmap font, then it equals to scale
-        if (data_ver < kGameVersion_360)
+        if (is_bitmap_font(font) && (get_font_outline(font) == FONT_OUTLINE_AUTO))
         {
-            if (is_wfn && (finfo.Outline == FONT_OUTLINE_AUTO))
-            {
-                set_font_outline(i, FONT_OUTLINE_AUTO, FontInfo::kSquared, get_font_scaling_mul(i));
-            }
+            set_font_outline(font, FONT_OUTLINE_AUTO, FontInfo::kSquared, get_font_scaling_mul(font));
         }
     }
 
-    // Additional fixups - after all the fonts are registered
-    for (int i = 0; i < game.numfonts; ++i)
+    if (!is_bitmap_font(font))
     {
-        if (!is_bitmap_font(i))
+        // Check for the LucasFan font since it comes with an outline font that
+        // is drawn incorrectly with Freetype versions > 2.1.3.
+        // A simple workaround is to disable outline fonts for it and use
+        // automatic outline drawing.
+        const int outline_font = get_font_outline(font);
+        if (outline_font < 0) return;
+        const char *name = get_font_name(font);
+        const char *outline_name = get_font_name(outline_font);
+        if ((ags_stricmp(name, "LucasFan-Font") == 0) && (ags_stricmp(outline_name, "Arcade") == 0))
+            set_font_outline(font, FONT_OUTLINE_AUTO);
+    }
+}
+
+void LoadFonts(GameSetupStruct &game, GameDataVersion data_ver)
+{
+    // The fonts are only registered here, and each is loaded from disk
+    // when it is first used for measuring or drawing text; the games
+    // often have many fonts, while only a few are needed on startup.
+    // The first font is loaded right away, as the engine tests it.
+    fonts_data_ver = data_ver;
+    set_font_load_callback(FixupFont);
+    for (int i = 0; i < game.numfonts; ++i) 
+    {
+        FontInfo &finfo = game.fonts[i];
+        if (i == 0)
         {
-            // Check for the LucasFan font since it comes with an outline font that
-            // is drawn incorrectly with Freetype versions > 2.1.3.
-            // A simple workaround is to disable outline fonts for it and use
-            // automatic outline drawing.
-            const int outline_font = get_font_outline(i);
-            if (outline_font < 0) continue;
-            const char *name = get_font_name(i);
-            const char *outline_name = get_font_name(outline_font);
-            if ((ags_stricmp(name, "LucasFan-Font") == 0) && (ags_stricmp(outline_name, "Arcade") == 0))
-                set_font_outline(i, FONT_OUTLINE_AUTO);
+            if (!load_font_size(i, finfo))
+                quitprintf("Unable to load font %d, no renderer could load a matching file", i);
+            continue;
         }
+        // The WFN renderer falls back to the first font's file
+        if (!AssetMgr->DoesAssetExist(String::FromFormat("agsfnt%d.ttf", i)) &&
+            !AssetMgr->DoesAssetExist(String::FromFormat("agsfnt%d.wfn", i)) &&
+            !AssetMgr->DoesAssetExist("agsfnt0.wfn"))
+            quitprintf("Unable to load font %d, no renderer could load a matching file", i);
+        register_font_deferred(i, finfo);
     }
+    if (game.numfonts > 0)
+        FixupFont(0);
 }
 
 void LoadLipsyncData()
 {
-    auto speechsync = AssetMgr->OpenAsset("syncdata.dat", "voice");
+    auto speechsync = AssetMgr->OpenAsset("syncdata.dat", "voice", kAssetOpen_ReadWhole);
     if (!speechsync)
         return;
     // this game has voice lip sync
@@ -368,6 +392,9 @@ void LoadLipsyncData()
             speechsync->ReadArrayOfInt32(&splipsync[ee].endtimeoffs.front(), splipsync[ee].numPhonemes);
             splipsync[ee].frame.resize(splipsync[ee].numPhonemes);
             speechsync->ReadArrayOfInt16(&splipsync[ee].frame.front(), splipsync[ee].numPhonemes);
+            // the first line of the same name is used, as the lookup did before
+            splipsync_index.emplace(String(splipsync[ee].filename,
+                strnlen(splipsync[ee].filename, sizeof(splipsync[ee].filename))), ee);
         }
     }
     Debug::Printf(kDbgMsg_Info, "Lipsync data found and loaded");
@@ -564,6 +591,9 @@ HGameInitError InitGameState(const LoadedGameEntities &ents, GameDataVersion dat
     // require access to script API at initialization time.
     //
     ccSetScriptAliveTimer(1000 / 60u, 1000u, 150000u);
+    ScriptJit::SetEnabled(usetup.ScriptJit);
+    if (!usetup.script_profile_path.IsEmpty())
+        ScriptProfiler::Start(usetup.script_profile_path, std::max(0, usetup.script_profile_interval));
     setup_script_exports(base_api, compat_api);
 
     //
@@ -11,6 +11,13 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <deque>
+#include <unordered_map>
+#if !defined(AGS_DISABLE_THREADS)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
 #include "ac/button.h"
 #include "ac/character.h"
 #include "ac/common.h"
@@ -57,7 +64,10 @@
 #include "script/cc_common.h"
 #include "util/file.h"
 #include "util/memory_compat.h"
+#include "util/memorystream.h"
+#include "util/path.h"
 #include "util/stream.h"
+#include "util/string_types.h"
 #include "util/string_utils.h"
 
 using namespace Common;
@@ -90,6 +100,7 @@ SavegameDescription::SavegameDescription()
     : LegacyID(0)
     , MainDataVersion(kGameVersion_Undefined)
     , ColorDepth(0)
+    , UserImageOffset(0)
 {
 }
 
@@ -165,6 +176,10 @@ String GetSavegameErrorText(SavegameErrorType err)
         return "Saved with the engine running at a different colour depth.";
     case kSvgErr_GameObjectInitFailed:
         return "Game object initialization failed after save restoration.";
+    case kSvgErr_FileWriteFailed:
+        return "Failed to write the savegame file.";
+    case kSvgErr_BaseSaveMismatch:
+        return "The base save of this delta save is missing or does not match it.";
     default:
         return "Unknown error.";
     }
@@ -224,6 +239,7 @@ HSaveError ReadDescription(Stream *in, SavegameVersion &svg_ver, SavegameDescrip
         desc.UserText = StrUtil::ReadString(in);
     else
         StrUtil::SkipString(in);
+    desc.UserImageOffset = in->GetPosition();
     if (elems & kSvgDesc_UserImage)
         desc.UserImage.reset(RestoreSaveImage(in));
     else
@@ -254,6 +270,8 @@ SavegameVersion CheckSaveSignature(Stream *in)
 
 HSaveError OpenSavegameBase(const String &filename, SavegameSource *src, SavegameDescription *desc, SavegameDescElem elems)
 {
+    // the save may still be written in background
+    WaitSavegameWrites();
     UStream in(File::OpenFileRead(filename));
     if (!in.get())
         return new SavegameError(kSvgErr_FileOpenFailed, String::FromFormat("Requested filename: %s.", filename.GetCStr()));
@@ -296,6 +314,7 @@ HSaveError OpenSavegameBase(const String &filename, SavegameSource *src, Savegam
         }
         if (elems & kSvgDesc_UserText)
             desc->UserText = temp_desc.UserText;
+        desc->UserImageOffset = temp_desc.UserImageOffset;
         if (elems & kSvgDesc_UserImage)
             desc->UserImage.reset(temp_desc.UserImage.release());
     }
@@ -315,6 +334,7 @@ HSaveError OpenSavegame(const String &filename, SavegameDescription &desc, Saveg
 // Prepares engine for actual save restore (stops processes, cleans up memory)
 void DoBeforeRestore(PreservedParams &pp)
 {
+    cancel_pending_routes();
     pp.SpeechVOX = play.voice_avail;
     pp.MusicVOX = play.separate_music_lib;
     memcpy(pp.GameOptions, game.options, GameSetupStruct::MAX_OPTIONS * sizeof(int));
@@ -632,6 +652,7 @@ HSaveError DoAfterRestore(const PreservedParams &pp, RestoredData &r_data)
     restore_characters();
     restore_overlays();
     restore_movelists();
+    restore_game_timers();
 
     prepare_gui_runtime(false /* not startup */);
 
@@ -669,12 +690,12 @@ HSaveError DoAfterRestore(const PreservedParams &pp, RestoredData &r_data)
     return HSaveError::None();
 }
 
-HSaveError RestoreGameState(Stream *in, SavegameVersion svg_version)
+HSaveError RestoreGameState(Stream *in, SavegameVersion svg_version, const String &filename)
 {
     PreservedParams pp;
     RestoredData r_data;
     DoBeforeRestore(pp);
-    HSaveError err = SavegameComponents::ReadAll(in, svg_version, pp, r_data);
+    HSaveError err = SavegameComponents::ReadAll(in, svg_version, filename, pp, r_data);
     if (!err)
         return err;
     return DoAfterRestore(pp, r_data);
@@ -714,12 +735,8 @@ void WriteDescription(Stream *out, const String &user_text, const Bitmap *user_i
     WriteSaveImage(out, user_image);
 }
 
-std::unique_ptr<Stream> StartSavegame(const String &filename, const String &user_text, const Bitmap *user_image)
+void StartSavegame(Stream *out, const String &user_text, const Bitmap *user_image)
 {
-    auto out = File::CreateFile(filename);
-    if (!out)
-        return nullptr;
-
     // Savegame signature
     out->Write(SavegameSource::Signature.GetCStr(), SavegameSource::Signature.GetLength());
 
@@ -727,12 +744,15 @@ std::unique_ptr<Stream> StartSavegame(const String &filename, const String &user
     pl_run_plugin_hooks(AGSE_PRESAVEGAME, 0);
 
     // Write descrition block
-    WriteDescription(out.get(), user_text, user_image);
-    return out;
+    WriteDescription(out, user_text, user_image);
 }
 
 void DoBeforeSave()
 {
+    // the move lists must be up to date
+    complete_pending_routes();
+    // the timers' remaining time must be written into the game state
+    sync_game_timers_to_state();
     if (play.cur_music_number >= 0)
     {
         if (IsMusicPlaying() == 0)
@@ -751,10 +771,204 @@ void DoBeforeSave()
     }
 }
 
-void SaveGameState(Stream *out)
+// The delta saves state of a save file
+struct DeltaSaveFile
+{
+    bool HasFull = false; // a full save was made to this file in this session
+    int  DeltasSinceFull = 0; // number of delta saves made since the full one
+    bool NextIsDelta = false; // the next save will be a delta
+    SavegameComponents::DeltaSaveBase Base; // the last full save
+};
+
+// The delta saves state of the files saved in this session
+static std::unordered_map<String, DeltaSaveFile> delta_files;
+
+static String GetDeltaBaseFilename(const String &filename)
+{
+    return String::FromFormat("%s.base", filename.GetCStr());
+}
+
+void PrepareDeltaSave(const String &filename)
+{
+    if (usetup.DeltaSaves <= 0)
+        return;
+    DeltaSaveFile &df = delta_files[filename];
+    df.NextIsDelta = df.HasFull && (df.DeltasSinceFull < usetup.DeltaSaves);
+    if (df.NextIsDelta && (df.DeltasSinceFull == 0))
+    {
+        // The file still contains the full save: keep it as the new base
+        const String base_path = GetDeltaBaseFilename(filename);
+        if (File::IsFile(filename) && File::DeleteFile(base_path) &&
+            File::RenameFile(filename, base_path))
+        {
+            df.Base.Filename = Path::GetFilename(base_path);
+        }
+        else
+        {
+            Debug::Printf(kDbgMsg_Warn, "Failed to move the base save to %s, making a full save", base_path.GetCStr());
+            df.NextIsDelta = false;
+        }
+    }
+}
+
+void SaveGameState(Stream *out, const String &filename)
 {
     DoBeforeSave();
-    SavegameComponents::WriteAllCommon(out);
+    if (filename.IsEmpty() || (usetup.DeltaSaves <= 0))
+    {
+        SavegameComponents::WriteAllCommon(out, usetup.CompressSaves);
+        return;
+    }
+
+    DeltaSaveFile &df = delta_files[filename];
+    if (df.NextIsDelta)
+    {
+        SavegameComponents::WriteAllCommon(out, usetup.CompressSaves, &df.Base);
+        df.DeltasSinceFull++;
+    }
+    else
+    {
+        SavegameComponents::WriteAllCommon(out, usetup.CompressSaves, nullptr, &df.Base.Digests);
+        df.HasFull = true;
+        df.DeltasSinceFull = 0;
+    }
+    df.NextIsDelta = false;
+}
+
+// A complete savegame waiting to be written to disk
+struct SavegameWrite
+{
+    int Slot = -1;
+    String Filename;
+    std::unique_ptr<Stream> Out;
+    std::vector<uint8_t> Data;
+    HSaveError Err = HSaveError::None();
+};
+
+static void WriteSavegameData(SavegameWrite &sw)
+{
+    const bool ok = (sw.Out->Write(sw.Data.data(), sw.Data.size()) == sw.Data.size())
+        && sw.Out->Flush();
+    sw.Out.reset();
+    sw.Data = std::vector<uint8_t>();
+    if (!ok)
+        sw.Err = new SavegameError(kSvgErr_FileWriteFailed);
+}
+
+// The writes which are complete, and not polled yet
+static std::deque<std::unique_ptr<SavegameWrite>> save_done;
+#if !defined(AGS_DISABLE_THREADS)
+static std::deque<std::unique_ptr<SavegameWrite>> save_queue;
+// Number of the queued writes, including the one being written
+static size_t save_pending = 0u;
+static std::mutex save_mutex;
+static std::condition_variable save_wake_cv;
+static std::condition_variable save_done_cv;
+static std::thread save_thread;
+static bool save_thread_quit = false;
+
+static void SavegameWriteThread()
+{
+    std::unique_lock<std::mutex> lk(save_mutex);
+    while (true)
+    {
+        save_wake_cv.wait(lk, []() { return save_thread_quit || !save_queue.empty(); });
+        // finish all the queued writes before quitting
+        if (save_queue.empty())
+            break;
+        std::unique_ptr<SavegameWrite> sw = std::move(save_queue.front());
+        save_queue.pop_front();
+        lk.unlock();
+
+        WriteSavegameData(*sw);
+
+        lk.lock();
+        save_done.push_back(std::move(sw));
+        save_pending--;
+        save_done_cv.notify_all();
+    }
+}
+#endif
+
+void WriteSavegameAsync(std::unique_ptr<Stream> &&out, std::vector<uint8_t> &&data, int slot, const String &filename)
+{
+    std::unique_ptr<SavegameWrite> sw(new SavegameWrite());
+    sw->Slot = slot;
+    sw->Filename = filename;
+    sw->Out = std::move(out);
+    sw->Data = std::move(data);
+#if defined(AGS_DISABLE_THREADS)
+    WriteSavegameData(*sw);
+    save_done.push_back(std::move(sw));
+#else
+    if (!save_thread.joinable())
+        save_thread = std::thread(SavegameWriteThread);
+    {
+        std::lock_guard<std::mutex> lk(save_mutex);
+        save_queue.push_back(std::move(sw));
+        save_pending++;
+    }
+    save_wake_cv.notify_one();
+#endif
+}
+
+bool PollSavegameWrites(int &slot, HSaveError &err)
+{
+#if !defined(AGS_DISABLE_THREADS)
+    std::lock_guard<std::mutex> lk(save_mutex);
+#endif
+    if (save_done.empty())
+        return false;
+    slot = save_done.front()->Slot;
+    err = save_done.front()->Err;
+    // the file's contents are unknown now, so the next save must be full
+    if (!err)
+        delta_files.erase(save_done.front()->Filename);
+    save_done.pop_front();
+    return true;
+}
+
+void WaitSavegameWrites()
+{
+#if !defined(AGS_DISABLE_THREADS)
+    std::unique_lock<std::mutex> lk(save_mutex);
+    save_done_cv.wait(lk, []() { return save_pending == 0u; });
+#endif
+}
+
+void ShutdownSavegameWrites()
+{
+#if !defined(AGS_DISABLE_THREADS)
+    if (save_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lk(save_mutex);
+            save_thread_quit = true;
+        }
+        save_wake_cv.notify_one();
+        save_thread.join();
+        save_thread_quit = false;
+    }
+#endif
+    save_done.clear();
+    delta_files.clear();
+}
+
+void DeleteDeltaSave(const String &filename)
+{
+    delta_files.erase(filename);
+    File::DeleteFile(GetDeltaBaseFilename(filename));
+}
+
+void RenameDeltaSave(const String &old_name, const String &new_name)
+{
+    delta_files.erase(old_name);
+    delta_files.erase(new_name);
+    const String old_base = GetDeltaBaseFilename(old_name);
+    const String new_base = GetDeltaBaseFilename(new_name);
+    File::DeleteFile(new_base);
+    if (File::IsFile(old_base))
+        File::RenameFile(old_base, new_base);
 }
 
 void ReadPluginSaveData(Stream *in, PluginSvgVersion svg_ver, soff_t max_size)
@@ -16,6 +16,7 @@
 #define __AGS_EE_GAME__SAVEGAME_H
 
 #include <memory>
+#include <vector>
 #include "ac/game_version.h"
 #include "util/error.h"
 #include "util/version.h"
@@ -44,6 +45,8 @@ typedef std::shared_ptr<Stream> PStream;
 // 8      last old style saved game format (of AGS 3.2.1)
 // 9      first new style (self-descriptive block-based) format version
 // Since 3.6.0: value is defined as AGS version represented as NN,NN,NN,NN.
+// 3.6.1.16 - components may have their data compressed
+// 3.6.1.17 - delta saves, which refer to the unchanged components of a base save
 //-----------------------------------------------------------------------------
 enum SavegameVersion
 {
@@ -57,7 +60,9 @@ enum SavegameVersion
     kSvgVersion_360_beta  = 3060023,
     kSvgVersion_360_final = 3060041,
     kSvgVersion_361       = 3060115,
-    kSvgVersion_Current   = kSvgVersion_361,
+    kSvgVersion_Cmp_Compressed = 3060116,
+    kSvgVersion_Cmp_Delta = 3060117,
+    kSvgVersion_Current   = kSvgVersion_Cmp_Delta,
     kSvgVersion_LowestSupported = kSvgVersion_Components // change if support dropped
 };
 
@@ -85,6 +90,8 @@ enum SavegameErrorType
     kSvgErr_InconsistentPlugin,
     kSvgErr_DifferentColorDepth,
     kSvgErr_GameObjectInitFailed,
+    kSvgErr_FileWriteFailed,
+    kSvgErr_BaseSaveMismatch,
     kNumSavegameError
 };
 
@@ -148,6 +155,8 @@ struct SavegameDescription
     
     String              UserText;
     std::unique_ptr<Bitmap> UserImage;
+    // Position of the user image in the save file
+    soff_t              UserImageOffset;
 
     SavegameDescription();
 };
@@ -158,12 +167,41 @@ HSaveError     OpenSavegame(const String &filename, SavegameSource &src,
                             SavegameDescription &desc, SavegameDescElem elems = kSvgDesc_All);
 // Opens savegame and reads the savegame description
 HSaveError     OpenSavegame(const String &filename, SavegameDescription &desc, SavegameDescElem elems = kSvgDesc_All);
-// Reads the game data from the save stream and reinitializes game state
-HSaveError     RestoreGameState(Stream *in, SavegameVersion svg_version);
-// Opens savegame for writing and puts in savegame description
-std::unique_ptr<Stream> StartSavegame(const String &filename, const String &user_text, const Bitmap *user_image);
-// Prepares game for saving state and writes game data into the save stream
-void           SaveGameState(Stream *out);
+// Reads the game data from the save stream and reinitializes game state;
+// the save's filename is used to find the base save of a delta save
+HSaveError     RestoreGameState(Stream *in, SavegameVersion svg_version, const String &filename);
+// Reads the user image, found at the UserImageOffset in the save file
+Bitmap        *RestoreSaveImage(Stream *in);
+// Writes savegame signature and description into the stream
+void           StartSavegame(Stream *out, const String &user_text, const Bitmap *user_image);
+// Prepares the save file for the next save in the delta saves mode:
+// decides whether the next save will be a full or a delta one, and if latter
+// moves the last full save of this file aside, to serve as the delta's base
+void           PrepareDeltaSave(const String &filename);
+// Prepares game for saving state and writes game data into the save stream;
+// the components are compressed if it is enabled in the game setup.
+// If the filename is set and the delta saves are enabled, then writes either
+// a full or a delta save, as decided by PrepareDeltaSave for that file.
+void           SaveGameState(Stream *out, const String &filename = "");
+
+// Writes the complete savegame data, made by StartSavegame and SaveGameState
+// in memory, into the opened savegame file on a background thread;
+// the completion is reported by PollSavegameWrites.
+void           WriteSavegameAsync(std::unique_ptr<Stream> &&out, std::vector<uint8_t> &&data,
+                                  int slot, const String &filename);
+// Gets the result of the next completed savegame write;
+// returns false if there are none
+bool           PollSavegameWrites(int &slot, HSaveError &err);
+// Waits until all the pending savegame writes are complete;
+// must be called before accessing any savegame file
+void           WaitSavegameWrites();
+// Completes the pending savegame writes and stops the writing thread
+void           ShutdownSavegameWrites();
+// Deletes the base save of the given save file, if there's one,
+// and forgets the file's delta saves state
+void           DeleteDeltaSave(const String &filename);
+// Moves the base save along with the renamed save file
+void           RenameDeltaSave(const String &old_name, const String &new_name);
 
 } // namespace Engine
 } // namespace AGS
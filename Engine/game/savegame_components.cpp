@@ -48,6 +48,10 @@
 #include "plugin/plugin_engine.h"
 #include "script/cc_common.h"
 #include "script/script.h"
+#include "util/compress.h"
+#include "util/jobscheduler.h"
+#include "util/memorystream.h"
+#include "util/path.h"
 #include "util/filestream.h" // TODO: needed only because plugins expect file handle
 #include "media/audio/audio_system.h"
 
@@ -72,6 +76,20 @@ namespace SavegameComponents
 
 const String ComponentListTag = "Components";
 
+// Component data decoded ahead, waiting to be applied to the game state
+struct ComponentStaging
+{
+    virtual ~ComponentStaging() = default;
+};
+
+// How the component data is stored
+enum ComponentStorage
+{
+    kSvgCmpStore_Raw     = 0, // uncompressed
+    kSvgCmpStore_Deflate = 1, // compressed with deflate
+    kSvgCmpStore_Base    = 2  // not stored, found in the base save
+};
+
 void WriteFormatTag(Stream *out, const String &tag, bool open = true)
 {
     String full_tag = String::FromFormat(open ? "<%s>" : "</%s>", tag.GetCStr());
@@ -829,21 +847,45 @@ HSaveError WriteDynamicSprites(Stream *out)
     return HSaveError::None();
 }
 
-HSaveError ReadDynamicSprites(Stream *in, int32_t /*cmp_ver*/, soff_t cmp_size, const PreservedParams& /*pp*/, RestoredData& /*r_data*/)
+struct DynamicSpritesStaging : ComponentStaging
+{
+    struct Sprite
+    {
+        int ID = 0;
+        int Flags = 0;
+        std::unique_ptr<Bitmap> Image;
+    };
+
+    int TopIndex = 0;
+    std::vector<Sprite> Sprites;
+};
+
+HSaveError DecodeDynamicSprites(Stream *in, int32_t /*cmp_ver*/, soff_t cmp_size, std::unique_ptr<ComponentStaging> &staging)
 {
     HSaveError err;
+    std::unique_ptr<DynamicSpritesStaging> sprites(new DynamicSpritesStaging());
     const int spr_count = in->ReadInt32();
-    // ensure the sprite set is at least large enough
-    // to accomodate top dynamic sprite index
-    const int top_index = in->ReadInt32();
-    spriteset.EnlargeTo(top_index);
-    for (int i = 0; i < spr_count; ++i)
+    sprites->TopIndex = in->ReadInt32();
+    sprites->Sprites.resize(spr_count);
+    for (auto &spr : sprites->Sprites)
     {
-        int id = in->ReadInt32();
-        int flags = in->ReadInt32();
-        std::unique_ptr<Bitmap> image(read_serialized_bitmap(in));
-        add_dynamic_sprite(id, std::move(image), (flags & SPF_ALPHACHANNEL) != 0, flags);
+        spr.ID = in->ReadInt32();
+        spr.Flags = in->ReadInt32();
+        spr.Image.reset(read_serialized_bitmap(in));
     }
+    staging = std::move(sprites);
+    return err;
+}
+
+HSaveError ApplyDynamicSprites(ComponentStaging &staging, int32_t /*cmp_ver*/, const PreservedParams& /*pp*/, RestoredData& /*r_data*/)
+{
+    HSaveError err;
+    auto &sprites = static_cast<DynamicSpritesStaging&>(staging);
+    // ensure the sprite set is at least large enough
+    // to accomodate top dynamic sprite index
+    spriteset.EnlargeTo(sprites.TopIndex);
+    for (auto &spr : sprites.Sprites)
+        add_dynamic_sprite(spr.ID, std::move(spr.Image), (spr.Flags & SPF_ALPHACHANNEL) != 0, spr.Flags);
     return err;
 }
 
@@ -908,23 +950,34 @@ HSaveError WriteDynamicSurfaces(Stream *out)
     return HSaveError::None();
 }
 
-HSaveError ReadDynamicSurfaces(Stream *in, int32_t /*cmp_ver*/, soff_t cmp_size, const PreservedParams& /*pp*/, RestoredData &r_data)
+struct DynamicSurfacesStaging : ComponentStaging
+{
+    std::vector<std::unique_ptr<Bitmap>> Surfaces;
+};
+
+HSaveError DecodeDynamicSurfaces(Stream *in, int32_t /*cmp_ver*/, soff_t cmp_size, std::unique_ptr<ComponentStaging> &staging)
 {
     HSaveError err;
     if (!AssertCompatLimit(err, in->ReadInt32(), MAX_DYNAMIC_SURFACES, "Dynamic Surfaces"))
         return err;
-    // Load the surfaces into a temporary array since ccUnserialiseObjects will destroy them otherwise
-    r_data.DynamicSurfaces.resize(MAX_DYNAMIC_SURFACES);
+    std::unique_ptr<DynamicSurfacesStaging> surfs(new DynamicSurfacesStaging());
+    surfs->Surfaces.resize(MAX_DYNAMIC_SURFACES);
     for (int i = 0; i < MAX_DYNAMIC_SURFACES; ++i)
     {
-        if (in->ReadInt8() == 0)
-            r_data.DynamicSurfaces[i] = nullptr;
-        else
-            r_data.DynamicSurfaces[i].reset(read_serialized_bitmap(in));
+        if (in->ReadInt8() != 0)
+            surfs->Surfaces[i].reset(read_serialized_bitmap(in));
     }
+    staging = std::move(surfs);
     return err;
 }
 
+HSaveError ApplyDynamicSurfaces(ComponentStaging &staging, int32_t /*cmp_ver*/, const PreservedParams& /*pp*/, RestoredData &r_data)
+{
+    // Load the surfaces into a temporary array since ccUnserialiseObjects will destroy them otherwise
+    r_data.DynamicSurfaces = std::move(static_cast<DynamicSurfacesStaging&>(staging).Surfaces);
+    return HSaveError::None();
+}
+
 HSaveError WriteScriptModules(Stream *out)
 {
     // write the data segment of the global script
@@ -980,12 +1033,11 @@ HSaveError WriteRoomStates(Stream *out)
     {
         if (isRoomStatusValid(i))
         {
-            RoomStatus *roomstat = getRoomStatus(i);
-            if (roomstat->beenhere)
+            if (getRoomStatusBeenHere(i))
             {
                 out->WriteInt32(i);
                 WriteFormatTag(out, "RoomState", true);
-                roomstat->WriteToSavegame(out, loaded_game_file_version);
+                writeRoomStatusToSavegame(i, out);
                 WriteFormatTag(out, "RoomState", false);
             }
             else
@@ -1015,6 +1067,8 @@ HSaveError ReadRoomStates(Stream *in, int32_t cmp_ver, soff_t cmp_size, const Pr
             roomstat->ReadFromSavegame(in, loaded_game_file_version, (RoomStatSvgVersion)cmp_ver);
             if (!AssertFormatTagStrict(err, in, "RoomState", false))
                 return err;
+            // keep packed until the player enters the room
+            packRoomStatus(id);
         }
     }
     return HSaveError::None();
@@ -1183,6 +1237,11 @@ struct ComponentHandler
     int32_t            LowestVersion; // lowest supported version that the engine can read
     HSaveError       (*Serialize)  (Stream*);
     HSaveError       (*Unserialize)(Stream*, int32_t cmp_ver, soff_t cmp_size, const PreservedParams&, RestoredData&);
+    // Optional alternative to Unserialize: decodes the data into the staging
+    // object without touching the game state, which lets this run on a worker
+    // thread; the staged data is then applied to the game in the list order
+    HSaveError       (*Decode)     (Stream*, int32_t cmp_ver, soff_t cmp_size, std::unique_ptr<ComponentStaging>&);
+    HSaveError       (*Apply)      (ComponentStaging&, int32_t cmp_ver, const PreservedParams&, RestoredData&);
 };
 
 // Array of supported components
@@ -1195,121 +1254,155 @@ ComponentHandler ComponentHandlers[] =
         kGSSvgVersion_361_14,
         kGSSvgVersion_Initial,
         WriteGameState,
-        ReadGameState
+        ReadGameState,
+        nullptr,
+        nullptr
     },
     {
         "Audio",
         kAudioSvgVersion_36009,
         kAudioSvgVersion_Initial,
         WriteAudio,
-        ReadAudio
+        ReadAudio,
+        nullptr,
+        nullptr
     },
     {
         "Characters",
         kCharSvgVersion_36115,
         kCharSvgVersion_350, // skip pre-alpha 3.5.0 ver
         WriteCharacters,
-        ReadCharacters
+        ReadCharacters,
+        nullptr,
+        nullptr
     },
     {
         "Dialogs",
         0,
         0,
         WriteDialogs,
-        ReadDialogs
+        ReadDialogs,
+        nullptr,
+        nullptr
     },
     {
         "GUI",
         kGuiSvgVersion_36025,
         kGuiSvgVersion_Initial,
         WriteGUI,
-        ReadGUI
+        ReadGUI,
+        nullptr,
+        nullptr
     },
     {
         "Inventory Items",
         0,
         0,
         WriteInventory,
-        ReadInventory
+        ReadInventory,
+        nullptr,
+        nullptr
     },
     {
         "Mouse Cursors",
         kCursorSvgVersion_36016,
         kCursorSvgVersion_Initial,
         WriteMouseCursors,
-        ReadMouseCursors
+        ReadMouseCursors,
+        nullptr,
+        nullptr
     },
     {
         "Views",
         0,
         0,
         WriteViews,
-        ReadViews
+        ReadViews,
+        nullptr,
+        nullptr
     },
     {
         "Dynamic Sprites",
         0,
         0,
         WriteDynamicSprites,
-        ReadDynamicSprites
+        nullptr,
+        DecodeDynamicSprites,
+        ApplyDynamicSprites
     },
     {
         "Overlays",
         kOverSvgVersion_36108,
         kOverSvgVersion_Initial,
         WriteOverlays,
-        ReadOverlays
+        ReadOverlays,
+        nullptr,
+        nullptr
     },
     {
         "Dynamic Surfaces",
         0,
         0,
         WriteDynamicSurfaces,
-        ReadDynamicSurfaces
+        nullptr,
+        DecodeDynamicSurfaces,
+        ApplyDynamicSurfaces
     },
     {
         "Script Modules",
         0,
         0,
         WriteScriptModules,
-        ReadScriptModules
+        ReadScriptModules,
+        nullptr,
+        nullptr
     },
     {
         "Room States",
         kRoomStatSvgVersion_36109,
         kRoomStatSvgVersion_350, // skip pre-alpha 3.5.0 ver
         WriteRoomStates,
-        ReadRoomStates
+        ReadRoomStates,
+        nullptr,
+        nullptr
     },
     {
         "Loaded Room State",
         kRoomStatSvgVersion_36109, // must correspond to "Room States"
         kRoomStatSvgVersion_350, // skip pre-alpha 3.5.0 ver
         WriteThisRoom,
-        ReadThisRoom
+        ReadThisRoom,
+        nullptr,
+        nullptr
     },
     {
         "Move Lists",
         kMoveSvgVersion_36109,
         kMoveSvgVersion_350, // skip pre-alpha 3.5.0 ver
         WriteMoveLists,
-        ReadMoveLists
+        ReadMoveLists,
+        nullptr,
+        nullptr
     },
     {
         "Managed Pool",
         0,
         0,
         WriteManagedPool,
-        ReadManagedPool
+        ReadManagedPool,
+        nullptr,
+        nullptr
     },
     {
         "Plugin Data",
         kPluginSvgVersion_36115,
         kPluginSvgVersion_Initial,
         WritePluginData,
-        ReadPluginData
+        ReadPluginData,
+        nullptr,
+        nullptr
     },
-    { nullptr, 0, 0, nullptr, nullptr } // end of array
+    { nullptr, 0, 0, nullptr, nullptr, nullptr, nullptr } // end of array
 };
 
 
@@ -1330,6 +1423,9 @@ struct SvgCmpReadHelper
                                     // will be applied after loading is done
     // The map of serialization handlers, one per supported component type ID
     HandlersMap            Handlers;
+    // The base save of a delta save, and the offsets of its components
+    std::unique_ptr<Stream> BaseIn;
+    std::map<String, soff_t> BaseComponents;
 
     SvgCmpReadHelper(SavegameVersion svg_version, const PreservedParams &pp, RestoredData &r_data)
         : Version(svg_version)
@@ -1347,78 +1443,330 @@ struct ComponentInfo
     soff_t  Offset;     // offset at which an opening tag is located
     soff_t  DataOffset; // offset at which component data begins
     soff_t  DataSize;   // expected size of component data
+    int32_t Storage;    // how the data is stored
+    soff_t  RawSize;    // size of the uncompressed data
 
-    ComponentInfo() : Version(-1), Offset(0), DataOffset(0), DataSize(0) {}
+    ComponentInfo() : Version(-1), Offset(0), DataOffset(0), DataSize(0)
+        , Storage(kSvgCmpStore_Raw), RawSize(0) {}
 };
 
-HSaveError ReadComponent(Stream *in, SvgCmpReadHelper &hlp, ComponentInfo &info)
+// Reads the component's header, up to its data
+HSaveError ReadComponentHeader(Stream *in, SavegameVersion svg_version, ComponentInfo &info)
 {
     info = ComponentInfo(); // reset in case of early error
     info.Offset = in->GetPosition();
     if (!ReadFormatTag(in, info.Name, true))
         return new SavegameError(kSvgErr_ComponentOpeningTagFormat);
     info.Version = in->ReadInt32();
-    info.DataSize = hlp.Version >= kSvgVersion_Cmp_64bit ? in->ReadInt64() : in->ReadInt32();
+    if (svg_version >= kSvgVersion_Cmp_Compressed)
+    {
+        info.Storage = in->ReadInt8();
+        if (info.Storage == kSvgCmpStore_Deflate)
+            info.RawSize = in->ReadInt64();
+        else if (info.Storage != kSvgCmpStore_Raw && info.Storage != kSvgCmpStore_Base)
+            return new SavegameError(kSvgErr_InconsistentFormat, String::FromFormat("Unknown storage type: %d", info.Storage));
+    }
+    info.DataSize = svg_version >= kSvgVersion_Cmp_64bit ? in->ReadInt64() : in->ReadInt32();
     info.DataOffset = in->GetPosition();
+    return HSaveError::None();
+}
 
-    const ComponentHandler *handler = nullptr;
+HSaveError ReadComponentData(Stream *in, SvgCmpReadHelper &hlp, ComponentInfo &info,
+    const ComponentHandler *&handler, std::vector<uint8_t> &data);
+
+// Reads the component data referenced by a delta save from its base save
+HSaveError ReadBaseComponentData(SvgCmpReadHelper &hlp, const ComponentInfo &info, std::vector<uint8_t> &data)
+{
+    auto it = hlp.BaseComponents.find(info.Name);
+    if (!hlp.BaseIn || it == hlp.BaseComponents.end())
+        return new SavegameError(kSvgErr_BaseSaveMismatch, String::FromFormat("Component not found: %s", info.Name.GetCStr()));
+    hlp.BaseIn->Seek(it->second, kSeekBegin);
+    ComponentInfo base_info;
+    const ComponentHandler *handler;
+    HSaveError err = ReadComponentData(hlp.BaseIn.get(), hlp, base_info, handler, data);
+    if (!err)
+        return err;
+    if (base_info.Version != info.Version)
+        return new SavegameError(kSvgErr_BaseSaveMismatch, String::FromFormat("Component %s version: %d, in base: %d",
+            info.Name.GetCStr(), info.Version, base_info.Version));
+    return HSaveError::None();
+}
+
+// Reads the component into memory, decompressing it or finding it in the
+// base save as necessary; also finds the handler which supports this component
+HSaveError ReadComponentData(Stream *in, SvgCmpReadHelper &hlp, ComponentInfo &info,
+    const ComponentHandler *&handler, std::vector<uint8_t> &data)
+{
+    HSaveError err = ReadComponentHeader(in, hlp.Version, info);
+    if (!err)
+        return err;
+
+    handler = nullptr;
     std::map<String, ComponentHandler>::const_iterator it_hdr = hlp.Handlers.find(info.Name);
     if (it_hdr != hlp.Handlers.end())
         handler = &it_hdr->second;
 
-    if (!handler || !handler->Unserialize)
+    if (!handler || (!handler->Unserialize && !handler->Decode))
         return new SavegameError(kSvgErr_UnsupportedComponent);
     if (info.Version > handler->Version || info.Version < handler->LowestVersion)
         return new SavegameError(kSvgErr_UnsupportedComponentVersion, String::FromFormat("Saved version: %d, supported: %d - %d", info.Version, handler->LowestVersion, handler->Version));
-    HSaveError err = handler->Unserialize(in, info.Version, info.DataSize, hlp.PP, hlp.RData);
-    if (!err)
-        return err;
-    if (in->GetPosition() - info.DataOffset != info.DataSize)
-        return new SavegameError(kSvgErr_ComponentSizeMismatch, String::FromFormat("Expected: %jd, actual: %jd",
-            static_cast<intmax_t>(info.DataSize), static_cast<intmax_t>(in->GetPosition() - info.DataOffset)));
+
+    switch (info.Storage)
+    {
+    case kSvgCmpStore_Base:
+        if (!AssertFormatTag(in, info.Name, false))
+            return new SavegameError(kSvgErr_ComponentClosingTagFormat);
+        return ReadBaseComponentData(hlp, info, data);
+    case kSvgCmpStore_Deflate:
+        data.resize(static_cast<size_t>(info.RawSize));
+        if (!inflate_decompress(data.data(), data.size(), 0, in, static_cast<size_t>(info.DataSize)))
+            return new SavegameError(kSvgErr_InconsistentFormat, "Failed to decompress component data.");
+        if (in->GetPosition() - info.DataOffset != info.DataSize)
+            in->Seek(info.DataOffset + info.DataSize, kSeekBegin);
+        break;
+    default:
+        data.resize(static_cast<size_t>(info.DataSize));
+        if (in->Read(data.data(), data.size()) != data.size())
+            return new SavegameError(kSvgErr_ComponentSizeMismatch, String::FromFormat("Expected: %jd, actual: %jd",
+                static_cast<intmax_t>(info.DataSize), static_cast<intmax_t>(in->GetPosition() - info.DataOffset)));
+        break;
+    }
     if (!AssertFormatTag(in, info.Name, false))
         return new SavegameError(kSvgErr_ComponentClosingTagFormat);
     return HSaveError::None();
 }
 
-HSaveError ReadAll(Stream *in, SavegameVersion svg_version, const PreservedParams &pp, RestoredData &r_data)
+inline HSaveError AssertComponentSize(Stream *in, soff_t size)
+{
+    if (in->GetPosition() != size)
+        return new SavegameError(kSvgErr_ComponentSizeMismatch, String::FromFormat("Expected: %jd, actual: %jd",
+            static_cast<intmax_t>(size), static_cast<intmax_t>(in->GetPosition())));
+    return HSaveError::None();
+}
+
+// A component read into memory, waiting to be unserialized
+struct ComponentRead
+{
+    ComponentInfo            Info;
+    const ComponentHandler  *Handler = nullptr;
+    std::vector<uint8_t>     Data;
+    // The results of decoding, for components which support it
+    std::unique_ptr<ComponentStaging> Staging;
+    HSaveError               DecodeErr;
+    JobHandle                DecodeJob;
+
+    ~ComponentRead()
+    {
+        JobScheduler::Global().Wait(DecodeJob);
+    }
+
+    void Decode()
+    {
+        Stream data_in(std::make_unique<VectorStream>(Data));
+        DecodeErr = Handler->Decode(&data_in, Info.Version, Data.size(), Staging);
+        if (DecodeErr)
+            DecodeErr = AssertComponentSize(&data_in, Data.size());
+    }
+};
+
+// Unserializes the component read into memory, or applies its decoded data
+HSaveError UnserializeComponent(ComponentRead &cmp, SvgCmpReadHelper &hlp)
+{
+    if (cmp.Handler->Decode)
+    {
+        JobScheduler::Global().Wait(cmp.DecodeJob);
+        if (!cmp.DecodeErr)
+            return cmp.DecodeErr;
+        return cmp.Handler->Apply(*cmp.Staging, cmp.Info.Version, hlp.PP, hlp.RData);
+    }
+
+    Stream data_in(std::make_unique<VectorStream>(cmp.Data));
+    HSaveError err = cmp.Handler->Unserialize(&data_in, cmp.Info.Version, cmp.Data.size(), hlp.PP, hlp.RData);
+    if (!err)
+        return err;
+    return AssertComponentSize(&data_in, cmp.Data.size());
+}
+
+// Opens the base save of a delta save, and finds where its components are
+HSaveError OpenBaseSave(const String &filename, SvgCmpReadHelper &hlp)
+{
+    SavegameSource src;
+    SavegameDescription desc;
+    HSaveError err = OpenSavegame(filename, src, desc, kSvgDesc_None);
+    if (!err)
+        return new SavegameError(kSvgErr_BaseSaveMismatch, String::FromFormat("Base save: %s", filename.GetCStr()), err);
+    // The base is made by the same engine right before the delta
+    if (src.Version != hlp.Version)
+        return new SavegameError(kSvgErr_BaseSaveMismatch, String::FromFormat("Base save version: %d, expected: %d", src.Version, hlp.Version));
+
+    Stream *in = src.InputStream.get();
+    if (!AssertFormatTag(in, ComponentListTag, true))
+        return new SavegameError(kSvgErr_ComponentListOpeningTagFormat);
+    // The base may not be a delta itself
+    if (!String::FromStream(in).IsEmpty())
+        return new SavegameError(kSvgErr_BaseSaveMismatch, "Base save is a delta save.");
+    while (!in->EOS())
+    {
+        soff_t off = in->GetPosition();
+        if (AssertFormatTag(in, ComponentListTag, false))
+        {
+            hlp.BaseIn = std::move(src.InputStream);
+            return HSaveError::None();
+        }
+        in->Seek(off, kSeekBegin);
+
+        ComponentInfo info;
+        err = ReadComponentHeader(in, src.Version, info);
+        if (!err)
+            return err;
+        if (info.Storage == kSvgCmpStore_Base)
+            return new SavegameError(kSvgErr_BaseSaveMismatch, "Base save is a delta save.");
+        in->Seek(info.DataSize, kSeekCurrent);
+        if (!AssertFormatTag(in, info.Name, false))
+            return new SavegameError(kSvgErr_ComponentClosingTagFormat);
+        hlp.BaseComponents[info.Name] = info.Offset;
+    }
+    return new SavegameError(kSvgErr_ComponentListClosingTagMissing);
+}
+
+inline HSaveError ComponentError(size_t idx, const ComponentInfo &info, HSaveError err)
+{
+    return new SavegameError(kSvgErr_ComponentUnserialization,
+        String::FromFormat("(#%d) %s, version %i, at offset %lld.",
+        idx, info.Name.IsEmpty() ? "unknown" : info.Name.GetCStr(), info.Version, info.Offset),
+        err);
+}
+
+HSaveError ReadAll(Stream *in, SavegameVersion svg_version, const String &filename,
+                   const PreservedParams &pp, RestoredData &r_data)
 {
     // Prepare a helper struct we will be passing to the block reading proc
     SvgCmpReadHelper hlp(svg_version, pp, r_data);
     GenerateHandlersMap(hlp.Handlers);
 
-    size_t idx = 0;
     if (!AssertFormatTag(in, ComponentListTag, true))
         return new SavegameError(kSvgErr_ComponentListOpeningTagFormat);
+    if (svg_version >= kSvgVersion_Cmp_Delta)
+    {
+        String base_name = String::FromStream(in);
+        if (!base_name.IsEmpty())
+        {
+            HSaveError err = OpenBaseSave(Path::ConcatPaths(Path::GetParent(filename), base_name), hlp);
+            if (!err)
+                return err;
+        }
+    }
+
+    // Read all the components into memory first, and start decoding those
+    // which support that on the worker threads
+    std::vector<std::unique_ptr<ComponentRead>> components;
+    bool list_end = false;
     do
     {
-        // Look out for the end of the component list:
-        // this is the only way how this function ends with success
+        // Look out for the end of the component list
         soff_t off = in->GetPosition();
         if (AssertFormatTag(in, ComponentListTag, false))
-            return HSaveError::None();
+        {
+            list_end = true;
+            break;
+        }
         // If the list's end was not detected, then seek back and continue reading
         in->Seek(off, kSeekBegin);
 
-        ComponentInfo info;
-        HSaveError err = ReadComponent(in, hlp, info);
+        std::unique_ptr<ComponentRead> cmp(new ComponentRead());
+        HSaveError err = ReadComponentData(in, hlp, cmp->Info, cmp->Handler, cmp->Data);
         if (!err)
+            return ComponentError(components.size(), cmp->Info, err);
+        if (cmp->Handler->Decode)
         {
-            return new SavegameError(kSvgErr_ComponentUnserialization,
-                String::FromFormat("(#%d) %s, version %i, at offset %lld.",
-                idx, info.Name.IsEmpty() ? "unknown" : info.Name.GetCStr(), info.Version, info.Offset),
-                err);
+            ComponentRead *decode_cmp = cmp.get();
+            cmp->DecodeJob = JobScheduler::Global().Submit("Decode save component",
+                [decode_cmp]() { decode_cmp->Decode(); });
         }
-        idx++;
+        components.push_back(std::move(cmp));
     }
     while (!in->EOS());
-    return new SavegameError(kSvgErr_ComponentListClosingTagMissing);
+    if (!list_end)
+        return new SavegameError(kSvgErr_ComponentListClosingTagMissing);
+
+    // Unserialize the components in the order of the list
+    for (size_t idx = 0; idx < components.size(); ++idx)
+    {
+        HSaveError err = UnserializeComponent(*components[idx], hlp);
+        if (!err)
+            return ComponentError(idx, components[idx]->Info, err);
+        components[idx].reset(); // free the data early
+    }
+    return HSaveError::None();
+}
+
+// Calculates a 64-bit FNV-1a hash of the component data
+uint64_t HashComponentData(const std::vector<uint8_t> &data)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint8_t b : data)
+        hash = (hash ^ b) * 1099511628211ULL;
+    return hash;
 }
 
-HSaveError WriteComponent(Stream *out, ComponentHandler &hdlr)
+HSaveError WriteComponent(Stream *out, ComponentHandler &hdlr, bool compress,
+                          const DeltaSaveBase *base, ComponentDigests *digests)
 {
     WriteFormatTag(out, hdlr.Name, true);
     out->WriteInt32(hdlr.Version);
+    if (compress || base || digests)
+    {
+        // Serialize the data into memory first, to see if it has changed
+        // since the base save, and if it becomes smaller when compressed
+        std::vector<uint8_t> raw_data;
+        HSaveError err;
+        {
+            Stream raw_out(std::make_unique<VectorStream>(raw_data, kStream_Write));
+            err = hdlr.Serialize(&raw_out);
+        }
+        ComponentDigest digest;
+        digest.Hash = HashComponentData(raw_data);
+        digest.Size = raw_data.size();
+        if (digests)
+            (*digests)[hdlr.Name] = digest;
+        if (err && base)
+        {
+            const auto it = base->Digests.find(hdlr.Name);
+            if (it != base->Digests.end() && it->second == digest)
+            {
+                out->WriteInt8(kSvgCmpStore_Base);
+                out->WriteInt64(0);
+                WriteFormatTag(out, hdlr.Name, false);
+                return err;
+            }
+        }
+
+        std::vector<uint8_t> comp_data;
+        if (compress)
+        {
+            Stream comp_out(std::make_unique<VectorStream>(comp_data, kStream_Write));
+            if (!deflate_compress(raw_data.data(), raw_data.size(), 0, &comp_out))
+                comp_data.clear();
+        }
+        if (!comp_data.empty() && comp_data.size() < raw_data.size())
+        {
+            out->WriteInt8(kSvgCmpStore_Deflate);
+            out->WriteInt64(raw_data.size());
+            out->WriteInt64(comp_data.size());
+            out->Write(comp_data.data(), comp_data.size());
+        }
+        else
+        {
+            out->WriteInt8(kSvgCmpStore_Raw);
+            out->WriteInt64(raw_data.size());
+            out->Write(raw_data.data(), raw_data.size());
+        }
+        if (err)
+            WriteFormatTag(out, hdlr.Name, false);
+        return err;
+    }
+
+    out->WriteInt8(kSvgCmpStore_Raw);
     soff_t ref_pos = out->GetPosition();
     out->WriteInt64(0); // placeholder for the component size
     HSaveError err = hdlr.Serialize(out);
@@ -1431,12 +1779,14 @@ HSaveError WriteComponent(Stream *out, ComponentHandler &hdlr)
     return err;
 }
 
-HSaveError WriteAllCommon(Stream *out)
+HSaveError WriteAllCommon(Stream *out, bool compress, const DeltaSaveBase *base, ComponentDigests *digests)
 {
     WriteFormatTag(out, ComponentListTag, true);
+    // the base save's file name, or none if this is a full save
+    (base ? base->Filename : String()).Write(out);
     for (int type = 0; !ComponentHandlers[type].Name.IsEmpty(); ++type)
     {
-        HSaveError err = WriteComponent(out, ComponentHandlers[type]);
+        HSaveError err = WriteComponent(out, ComponentHandlers[type], compress, base, digests);
         if (!err)
         {
             return new SavegameError(kSvgErr_ComponentSerialization,
@@ -14,8 +14,10 @@
 #ifndef __AGS_EE_GAME__SAVEGAMECOMPONENTS_H
 #define __AGS_EE_GAME__SAVEGAMECOMPONENTS_H
 
+#include <unordered_map>
 #include "game/savegame.h"
 #include "util/stream.h"
+#include "util/string_types.h"
 
 namespace AGS
 {
@@ -33,10 +35,37 @@ struct RestoredData;
 
 namespace SavegameComponents
 {
-    // Reads all available components from the stream
-    HSaveError    ReadAll(Stream *in, SavegameVersion svg_version, const PreservedParams &pp, RestoredData &r_data);
-    // Writes a full list of common components to the stream
-    HSaveError    WriteAllCommon(Stream *out);
+    // Digest of the component's data, used to tell if it has changed
+    struct ComponentDigest
+    {
+        uint64_t Hash = 0u;
+        soff_t   Size = 0;
+
+        bool operator ==(const ComponentDigest &other) const
+            { return Hash == other.Hash && Size == other.Size; }
+    };
+    typedef std::unordered_map<String, ComponentDigest> ComponentDigests;
+
+    // Describes a full save which the delta saves refer to
+    struct DeltaSaveBase
+    {
+        // Base save's file name, located in the same directory as the delta
+        String           Filename;
+        // Digests of the components stored in the base save
+        ComponentDigests Digests;
+    };
+
+    // Reads all available components from the stream; the save's filename
+    // is used to locate the base save, if this is a delta save
+    HSaveError    ReadAll(Stream *in, SavegameVersion svg_version, const String &filename,
+                          const PreservedParams &pp, RestoredData &r_data);
+    // Writes a full list of common components to the stream;
+    // optionally compresses each component's data. If the base is provided,
+    // then writes only the components which differ from the base save, and
+    // references to the base for the rest. If the digests are requested,
+    // then fills them for every written component.
+    HSaveError    WriteAllCommon(Stream *out, bool compress = false,
+                                 const DeltaSaveBase *base = nullptr, ComponentDigests *digests = nullptr);
 
     // Utility functions for reading and writing legacy interactions,
     // or their "times run" counters separately.
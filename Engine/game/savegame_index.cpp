@@ -0,0 +1,190 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "game/savegame_index.h"
+#include <unordered_map>
+#include "debug/out.h"
+#include "game/savegame.h"
+#include "util/file.h"
+#include "util/path.h"
+#include "util/stream.h"
+#include "util/string_types.h"
+#include "util/string_utils.h"
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+
+static const String SaveIndexFilename = "agssave_index.dat";
+static const String SaveIndexSignature = "AGSSaveIndex";
+enum SaveIndexVersion
+{
+    kSaveIndex_Initial = 1,
+    kSaveIndex_Current = kSaveIndex_Initial
+};
+
+// Cached description of a save file
+struct SaveIndexEntry
+{
+    int64_t Time = -1;  // file modification time
+    soff_t  Size = -1;  // file size
+    String  UserText;
+    soff_t  UserImageOffset = 0;
+};
+
+// Index of a save directory, keyed by the save file names
+struct SaveIndex
+{
+    std::unordered_map<String, SaveIndexEntry> Entries;
+    bool Changed = false;
+};
+
+// The indexes of the save directories used in this session
+static std::unordered_map<String, SaveIndex> save_indexes;
+
+static void ReadSaveIndex(const String &dir, SaveIndex &index)
+{
+    std::unique_ptr<Stream> in(File::OpenFileRead(Path::ConcatPaths(dir, SaveIndexFilename)));
+    if (!in)
+        return;
+    if (String::FromStreamCount(in.get(), SaveIndexSignature.GetLength()) != SaveIndexSignature)
+        return;
+    if (in->ReadInt32() != kSaveIndex_Current)
+        return; // the index is simply rebuilt
+    const uint32_t count = in->ReadInt32();
+    for (uint32_t i = 0; i < count && !in->EOS(); ++i)
+    {
+        String name = StrUtil::ReadString(in.get());
+        SaveIndexEntry entry;
+        entry.Time = in->ReadInt64();
+        entry.Size = in->ReadInt64();
+        entry.UserText = StrUtil::ReadString(in.get());
+        entry.UserImageOffset = in->ReadInt64();
+        index.Entries[name] = entry;
+    }
+}
+
+static void WriteSaveIndex(const String &dir, const SaveIndex &index)
+{
+    const String path = Path::ConcatPaths(dir, SaveIndexFilename);
+    std::unique_ptr<Stream> out(File::CreateFile(path));
+    if (!out)
+    {
+        Debug::Printf(kDbgMsg_Warn, "Failed to write the savegame index: %s", path.GetCStr());
+        return;
+    }
+    SaveIndexSignature.WriteCount(out.get(), SaveIndexSignature.GetLength());
+    out->WriteInt32(kSaveIndex_Current);
+    out->WriteInt32(static_cast<int32_t>(index.Entries.size()));
+    for (const auto &e : index.Entries)
+    {
+        StrUtil::WriteString(e.first, out.get());
+        out->WriteInt64(e.second.Time);
+        out->WriteInt64(e.second.Size);
+        StrUtil::WriteString(e.second.UserText, out.get());
+        out->WriteInt64(e.second.UserImageOffset);
+    }
+}
+
+static SaveIndex &GetSaveIndex(const String &dir)
+{
+    auto it = save_indexes.find(dir);
+    if (it != save_indexes.end())
+        return it->second;
+    SaveIndex &index = save_indexes[dir];
+    ReadSaveIndex(dir, index);
+    return index;
+}
+
+// Finds the up-to-date index entry of the save file, indexing it if necessary
+static const SaveIndexEntry *GetSaveIndexEntry(const String &filename)
+{
+    // the save may still be written in background
+    WaitSavegameWrites();
+    const int64_t time = File::GetFileTime(filename);
+    const soff_t size = File::GetFileSize(filename);
+    if (time < 0 || size < 0)
+        return nullptr;
+
+    SaveIndex &index = GetSaveIndex(Path::GetParent(filename));
+    const String name = Path::GetFilename(filename);
+    auto it = index.Entries.find(name);
+    if (it != index.Entries.end() && it->second.Time == time && it->second.Size == size)
+        return &it->second;
+
+    SavegameDescription desc;
+    HSaveError err = OpenSavegame(filename, desc, kSvgDesc_UserText);
+    if (!err)
+    {
+        Debug::Printf(kDbgMsg_Error, "Unable to read save's description.\n%s", err->FullMessage().GetCStr());
+        return nullptr;
+    }
+    SaveIndexEntry &entry = index.Entries[name];
+    entry.Time = time;
+    entry.Size = size;
+    entry.UserText = desc.UserText;
+    entry.UserImageOffset = desc.UserImageOffset;
+    index.Changed = true;
+    return &entry;
+}
+
+bool ReadIndexedSaveDescription(const String &filename, String &description)
+{
+    const SaveIndexEntry *entry = GetSaveIndexEntry(filename);
+    if (!entry)
+        return false;
+    description = entry->UserText;
+    return true;
+}
+
+std::unique_ptr<Bitmap> ReadIndexedSaveImage(const String &filename)
+{
+    const SaveIndexEntry *entry = GetSaveIndexEntry(filename);
+    if (!entry)
+        return {};
+    std::unique_ptr<Stream> in(File::OpenFileRead(filename));
+    if (!in || in->Seek(entry->UserImageOffset, kSeekBegin) != entry->UserImageOffset)
+        return {};
+    return std::unique_ptr<Bitmap>(RestoreSaveImage(in.get()));
+}
+
+void InvalidateSaveIndex(const String &filename)
+{
+    auto it = save_indexes.find(Path::GetParent(filename));
+    if (it == save_indexes.end())
+        return;
+    it->second.Changed |= it->second.Entries.erase(Path::GetFilename(filename)) > 0;
+}
+
+void FlushSaveIndex()
+{
+    for (auto &index : save_indexes)
+    {
+        if (!index.second.Changed)
+            continue;
+        WriteSaveIndex(index.first, index.second);
+        index.second.Changed = false;
+    }
+}
+
+void ShutdownSaveIndex()
+{
+    FlushSaveIndex();
+    save_indexes.clear();
+}
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,52 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Savegame index: a small file kept in the save directory, which caches
+// the user descriptions of the save files and the positions of their user
+// images. The entries are validated by the file's modification time and
+// size, so listing the saves does not have to open every save file.
+//
+//=============================================================================
+#ifndef __AGS_EE_GAME__SAVEGAMEINDEX_H
+#define __AGS_EE_GAME__SAVEGAMEINDEX_H
+
+#include <memory>
+#include "gfx/bitmap.h"
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+using Common::Bitmap;
+using Common::String;
+
+// Reads the savegame's user description, from the index if the file
+// has not changed since it was indexed, otherwise from the file itself
+bool ReadIndexedSaveDescription(const String &filename, String &description);
+// Reads the savegame's user image, using the index to locate it in the file
+std::unique_ptr<Bitmap> ReadIndexedSaveImage(const String &filename);
+// Forgets the index entry of the save file; must be called whenever
+// the file is written, renamed or deleted
+void InvalidateSaveIndex(const String &filename);
+// Writes the changed indexes into their save directories
+void FlushSaveIndex();
+// Flushes and forgets all the loaded indexes
+void ShutdownSaveIndex();
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GAME__SAVEGAMEINDEX_H
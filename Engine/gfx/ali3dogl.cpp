@@ -16,6 +16,7 @@
 #if AGS_HAS_OPENGL
 #include "gfx/ali3dogl.h"
 #include <algorithm>
+#include <cstddef>
 #include <stack>
 #include <SDL.h>
 #include "ac/sys_events.h"
@@ -27,7 +28,10 @@
 #include "gfx/gfxfilter_aaogl.h"
 #include "platform/base/agsplatformdriver.h"
 #include "platform/base/sys_main.h"
+#include "util/file.h"
 #include "util/matrix.h"
+#include "util/stream.h"
+#include "util/string_utils.h"
 
 // OpenGL Mathematics Library. We could include only the features we need to decrease compilation time.
 #include "glm/glm.hpp"
@@ -50,6 +54,25 @@ const char* fbo_extension_string = "GL_OES_framebuffer_object";
 
 #endif //AGS_OPENGL_ES2
 
+// From GL_ARB_timer_query, which is not in the generated GL 2.1 loader
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+// From GL_ARB_get_program_binary and GL_OES_get_program_binary,
+// which are not in the generated loaders
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+typedef void (APIENTRYP AGS_PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (APIENTRYP AGS_PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void (APIENTRYP AGS_PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+
 // Necessary to update textures from 8-bit bitmaps
 extern RGB palette[256];
 
@@ -71,26 +94,101 @@ Rect TopDownRect(const Rect &rect, int surface_height)
 }
 
 
+OGLTextureAtlas::OGLTextureAtlas(const Size &page_size, size_t max_pages, bool compact)
+    : _packer(page_size, 0, max_pages)
+    , _compact(compact)
+{
+    _pages.reserve(max_pages);
+}
+
+OGLTextureAtlas::~OGLTextureAtlas()
+{
+    for (size_t i = 0; i < _pages.size(); ++i)
+    {
+        // The pages may share one texture, as the layers of a texture array
+        if ((i == 0) || (_pages[i].Texture != _pages[i - 1].Texture))
+            glDeleteTextures(1, &_pages[i].Texture);
+    }
+}
+
+int OGLTextureAtlas::Add(OGLTextureTile &tile)
+{
+    const PackedRect packed = _packer.Add(Size(tile.allocWidth, tile.allocHeight));
+    if (packed.Page < 0)
+        return -1;
+    if (static_cast<size_t>(packed.Page) == _pages.size())
+    {
+        Page page;
+        page.Texture = CreatePageTexture(_pages.size(), page.Layer);
+        _pages.push_back(page);
+    }
+
+    Page &page = _pages[packed.Page];
+    page.UseCount++;
+    tile.texture = page.Texture;
+    tile.texLayer = page.Layer;
+    tile.texX = packed.Place.Left;
+    tile.texY = packed.Place.Top;
+    return packed.Page;
+}
+
+unsigned int OGLTextureAtlas::CreatePageTexture(size_t /*page*/, int &layer)
+{
+    const Size &page_size = _packer.GetPageSize();
+    unsigned int texture = 0u;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    if (_compact)
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, page_size.Width, page_size.Height, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, nullptr);
+    else
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, page_size.Width, page_size.Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    layer = -1;
+    return texture;
+}
+
+void OGLTextureAtlas::Release(int page)
+{
+    assert(page >= 0 && static_cast<size_t>(page) < _pages.size());
+    assert(_pages[page].UseCount > 0u);
+    // The page's space is reused only once all of its areas are free,
+    // as the packer does not track the individual areas
+    if (--_pages[page].UseCount == 0u)
+        _packer.ClearPage(page);
+}
+
 OGLTexture::~OGLTexture()
 {
     if (_tiles)
     {
-        for (size_t i = 0; i < _numTiles; ++i)
-            glDeleteTextures(1, &(_tiles[i].texture));
+        // The atlas page's texture is deleted by the atlas itself
+        if (!_atlas)
+        {
+            for (size_t i = 0; i < _numTiles; ++i)
+                glDeleteTextures(1, &(_tiles[i].texture));
+        }
         delete[] _tiles;
     }
     if (_vertex)
     {
         delete[] _vertex;
     }
+    if (_atlas)
+    {
+        _atlas->Release(_atlasPage);
+    }
 }
 
 size_t OGLTexture::GetMemSize() const
 {
     // FIXME: a proper size in video memory, check OpenGL docs
+    const size_t bpp = _yuv ? 1 : (_compact ? 2 : 4);
     size_t sz = 0u;
     for (size_t i = 0; i < _numTiles; ++i)
-        sz += _tiles[i].allocWidth * _tiles[i].allocHeight * 4;
+        sz += _tiles[i].allocWidth * _tiles[i].allocHeight * bpp;
     return sz;
 }
 
@@ -223,13 +321,24 @@ bool OGLGraphicsDriver::FirstTimeInit()
     TestRenderToTexture();
 
     // https://registry.khronos.org/OpenGL/extensions/ARB/ARB_texture_non_power_of_two.txt
-    const char *exts = (const char*)glGetString(GL_EXTENSIONS);
-    _glCapsNonPowerOfTwo = strstr(exts, "GL_ARB_texture_non_power_of_two") != nullptr;
+    _glCapsNonPowerOfTwo = SDL_GL_ExtensionSupported("GL_ARB_texture_non_power_of_two");
 
     if(!CreateShaders()) { // requires glad Load successful
         SDL_SetError("Failed to create Shaders.");
         return false;
     }
+    // Vertex buffer for the batched sprites; if not available,
+    // the sprites are drawn one by one from the client memory
+    glGenBuffers(1, &_quadVbo);
+#if !AGS_OPENGL_ES2
+    // Pixel buffers for the texture uploads (unsupported by GLES 2)
+    if (GLAD_GL_VERSION_2_1)
+        glGenBuffers(UploadPboCount, _uploadPbo);
+    // Timer queries for measuring the GPU time
+    // https://registry.khronos.org/OpenGL/extensions/ARB/ARB_timer_query.txt
+    if (SDL_GL_ExtensionSupported("GL_ARB_timer_query") || SDL_GL_ExtensionSupported("GL_EXT_timer_query"))
+        glGenQueries(GpuTimerCount, _gpuTimers);
+#endif
 
     _firstTimeInit = true;
     return true;
@@ -265,7 +374,7 @@ void OGLGraphicsDriver::InitGlParams(const DisplayMode &mode)
   glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
   glClear(GL_COLOR_BUFFER_BIT);
 
-  _capsVsync = SDL_GL_SetSwapInterval(mode.Vsync ? 1 : 0) == 0;
+  _capsVsync = SetSwapInterval(mode.Vsync);
   if (mode.Vsync && !_capsVsync)
     Debug::Printf(kDbgMsg_Warn, "OGL: SetVsync (%d) failed: %s", mode.Vsync, SDL_GetError());
 
@@ -273,9 +382,8 @@ void OGLGraphicsDriver::InitGlParams(const DisplayMode &mode)
   _stageMatrixes.View = glm::mat4(1.0);
 }
 
-bool OGLGraphicsDriver::CreateWindowAndGlContext(const DisplayMode &mode)
+void OGLGraphicsDriver::SetContextAttributes()
 {
-  // First setup GL attributes before creating SDL GL window
   if (SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_COMPATIBILITY) != 0)
     SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Error occured setting attribute SDL_GL_CONTEXT_PROFILE_MASK: %s", SDL_GetError());
   if (SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2) != 0)
@@ -290,6 +398,27 @@ bool OGLGraphicsDriver::CreateWindowAndGlContext(const DisplayMode &mode)
   if (SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1) != 0)
     SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Error occured setting attribute SDL_GL_CONTEXT_MINOR_VERSION: %s", SDL_GetError());
 #endif
+}
+
+bool OGLGraphicsDriver::LoadGlFunctions()
+{
+#if AGS_OPENGL_ES2
+    if (!gladLoadGLES2Loader((GLADloadproc) SDL_GL_GetProcAddress)) {
+        Debug::Printf(kDbgMsg_Error, "Failed to load glad with gladLoadGLES2Loader");
+    }
+#else
+  if (!gladLoadGL()) {
+    Debug::Printf(kDbgMsg_Error, "Failed to load GL.");
+    return false;
+  }
+#endif
+  return true;
+}
+
+bool OGLGraphicsDriver::CreateWindowAndGlContext(const DisplayMode &mode)
+{
+  // First setup GL attributes before creating SDL GL window
+  SetContextAttributes();
   // minimum number of bits for the depth buffer
   if (SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 0) != 0)
     SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Error occured setting attribute SDL_GL_DEPTH_SIZE: %s", SDL_GetError());
@@ -322,16 +451,12 @@ bool OGLGraphicsDriver::CreateWindowAndGlContext(const DisplayMode &mode)
     sys_window_destroy();
     return false;
   }
-#if AGS_OPENGL_ES2
-    if (!gladLoadGLES2Loader((GLADloadproc) SDL_GL_GetProcAddress)) {
-        Debug::Printf(kDbgMsg_Error, "Failed to load glad with gladLoadGLES2Loader");
-    }
-#else
-  if (!gladLoadGL()) {
-    Debug::Printf(kDbgMsg_Error, "Failed to load GL.");
+  if (!LoadGlFunctions()) {
+    SDL_GL_MakeCurrent(nullptr, nullptr);
+    SDL_GL_DeleteContext(sdlgl_ctx);
+    sys_window_destroy();
     return false;
   }
-#endif
   _sdlWindow = sdl_window;
   _sdlGlContext = sdlgl_ctx;
 #if AGS_PLATFORM_OS_IOS
@@ -399,11 +524,179 @@ void OGLGraphicsDriver::TestRenderToTexture()
 bool CreateTransparencyShader(ShaderProgram &prg);
 bool CreateTintShader(ShaderProgram &prg);
 bool CreateLightShader(ShaderProgram &prg);
-bool CreateShaderProgram(ShaderProgram &prg, const char *name, const char *vertex_shader_src, const char *fragment_shader_src);
-void DeleteShaderProgram(ShaderProgram &prg);
+bool CreateYUVShader(ShaderProgram &prg);
+bool CreateAlphaTestShader(ShaderProgram &prg);
 void OutputShaderError(GLuint obj_id, const String &obj_name, bool is_shader);
 
 
+// Linked shader program binaries, which are saved to a file, and let skip
+// compiling the shaders on the next run with the same driver.
+// https://registry.khronos.org/OpenGL/extensions/ARB/ARB_get_program_binary.txt
+// https://registry.khronos.org/OpenGL/extensions/OES/OES_get_program_binary.txt
+struct ShaderBinaryCache
+{
+    struct Entry
+    {
+        uint32_t SourceHash = 0u; // hash of the shader sources
+        GLenum Format = 0u;
+        std::vector<uint8_t> Data;
+    };
+
+    AGS_PFNGLGETPROGRAMBINARYPROC GetProgramBinary = nullptr;
+    AGS_PFNGLPROGRAMBINARYPROC ProgramBinary = nullptr;
+    AGS_PFNGLPROGRAMPARAMETERIPROC ProgramParameteri = nullptr;
+    // Identifies the driver, the binaries are only valid for the same one
+    String DriverID;
+    std::unordered_map<String, Entry> Programs;
+    bool Changed = false;
+
+    bool IsEnabled() const { return GetProgramBinary && ProgramBinary; }
+};
+
+static ShaderBinaryCache shader_cache;
+static const char *ShaderCacheSignature = "AGSGLSHADERS";
+static const int32_t ShaderCacheVersion = 1;
+
+// Hashes the shader sources with FNV-1a, which result is same on any system
+static uint32_t HashShaderSources(const char *vertex_shader_src, const char *fragment_shader_src)
+{
+  uint32_t hash = 2166136261u;
+  for (const char *src : { vertex_shader_src, "\n", fragment_shader_src })
+    for (const char *c = src; *c; ++c)
+      hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+  return hash;
+}
+
+static void InitShaderCache(const String &cache_file)
+{
+  shader_cache = ShaderBinaryCache();
+  if (cache_file.IsEmpty())
+    return;
+
+  GLint num_formats = 0;
+#if AGS_OPENGL_ES2
+  if (SDL_GL_ExtensionSupported("GL_OES_get_program_binary"))
+  {
+    shader_cache.GetProgramBinary = (AGS_PFNGLGETPROGRAMBINARYPROC)SDL_GL_GetProcAddress("glGetProgramBinaryOES");
+    shader_cache.ProgramBinary = (AGS_PFNGLPROGRAMBINARYPROC)SDL_GL_GetProcAddress("glProgramBinaryOES");
+  }
+#else
+  if (SDL_GL_ExtensionSupported("GL_ARB_get_program_binary"))
+  {
+    shader_cache.GetProgramBinary = (AGS_PFNGLGETPROGRAMBINARYPROC)SDL_GL_GetProcAddress("glGetProgramBinary");
+    shader_cache.ProgramBinary = (AGS_PFNGLPROGRAMBINARYPROC)SDL_GL_GetProcAddress("glProgramBinary");
+    shader_cache.ProgramParameteri = (AGS_PFNGLPROGRAMPARAMETERIPROC)SDL_GL_GetProcAddress("glProgramParameteri");
+  }
+#endif
+  if (shader_cache.IsEnabled())
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+  if (num_formats <= 0)
+  {
+    shader_cache = ShaderBinaryCache();
+    Debug::Printf("OGL: shader program binaries are not supported by the driver");
+    return;
+  }
+
+  shader_cache.DriverID = String::FromFormat("%s|%s|%s",
+    (const char*)glGetString(GL_VENDOR), (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION));
+
+  auto in = File::OpenFileRead(cache_file);
+  if (!in)
+    return;
+  char sig[16] = {};
+  in->Read(sig, strlen(ShaderCacheSignature));
+  if ((strcmp(sig, ShaderCacheSignature) != 0) || (in->ReadInt32() != ShaderCacheVersion) ||
+      (StrUtil::ReadString(in.get()) != shader_cache.DriverID))
+  {
+    Debug::Printf("OGL: shader cache is made by another driver or engine version, and will be replaced");
+    return;
+  }
+  const int32_t count = in->ReadInt32();
+  for (int32_t i = 0; i < count && !in->EOS(); ++i)
+  {
+    const String name = StrUtil::ReadString(in.get());
+    ShaderBinaryCache::Entry entry;
+    entry.SourceHash = static_cast<uint32_t>(in->ReadInt32());
+    entry.Format = static_cast<GLenum>(in->ReadInt32());
+    const int32_t size = in->ReadInt32();
+    if ((size <= 0) || (size > in->GetLength() - in->GetPosition()))
+      break; // corrupt file
+    entry.Data.resize(size);
+    in->Read(entry.Data.data(), size);
+    shader_cache.Programs[name] = std::move(entry);
+  }
+}
+
+static void SaveShaderCache(const String &cache_file)
+{
+  if (!shader_cache.Changed)
+    return;
+  auto out = File::CreateFile(cache_file);
+  if (!out)
+  {
+    Debug::Printf(kDbgMsg_Warn, "OGL: failed to write the shader cache: %s", cache_file.GetCStr());
+    return;
+  }
+  out->Write(ShaderCacheSignature, strlen(ShaderCacheSignature));
+  out->WriteInt32(ShaderCacheVersion);
+  StrUtil::WriteString(shader_cache.DriverID, out.get());
+  out->WriteInt32(static_cast<int32_t>(shader_cache.Programs.size()));
+  for (const auto &prg : shader_cache.Programs)
+  {
+    StrUtil::WriteString(prg.first, out.get());
+    out->WriteInt32(static_cast<int32_t>(prg.second.SourceHash));
+    out->WriteInt32(static_cast<int32_t>(prg.second.Format));
+    out->WriteInt32(static_cast<int32_t>(prg.second.Data.size()));
+    out->Write(prg.second.Data.data(), prg.second.Data.size());
+  }
+  shader_cache.Changed = false;
+}
+
+// Tries to create the program from the cached binary, returns 0 on failure
+static GLuint LoadCachedShaderProgram(const char *name, uint32_t src_hash)
+{
+  if (!shader_cache.IsEnabled())
+    return 0u;
+  const auto it = shader_cache.Programs.find(String::Wrapper(name));
+  if ((it == shader_cache.Programs.end()) || (it->second.SourceHash != src_hash))
+    return 0u;
+
+  GLuint program = glCreateProgram();
+  shader_cache.ProgramBinary(program, it->second.Format, it->second.Data.data(),
+    static_cast<GLsizei>(it->second.Data.size()));
+  GLint result = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &result);
+  if (result == GL_FALSE)
+  {
+    // The driver may reject the binary for any reason, e.g. after an update
+    glDeleteProgram(program);
+    shader_cache.Programs.erase(it);
+    return 0u;
+  }
+  return program;
+}
+
+// Stores the linked program's binary in the cache
+static void StoreShaderProgramBinary(GLuint program, const char *name, uint32_t src_hash)
+{
+  if (!shader_cache.IsEnabled())
+    return;
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+  ShaderBinaryCache::Entry entry;
+  entry.SourceHash = src_hash;
+  entry.Data.resize(length);
+  GLsizei written = 0;
+  shader_cache.GetProgramBinary(program, length, &written, &entry.Format, entry.Data.data());
+  if (written <= 0)
+    return;
+  entry.Data.resize(written);
+  shader_cache.Programs[name] = std::move(entry);
+  shader_cache.Changed = true;
+}
+
 bool OGLGraphicsDriver::CreateShaders()
 {
 #if AGS_OPENGL_ES2
@@ -414,10 +707,24 @@ bool OGLGraphicsDriver::CreateShaders()
     Debug::Printf(kDbgMsg_Error, "ERROR: Shaders require a minimum of OpenGL 2.0 support.");
     return false;
   }
+  InitShaderCache(_shaderCacheFile);
+  const bool shaders_created = CreateShaderPrograms();
+  if (shaders_created)
+    SaveShaderCache(_shaderCacheFile);
+  shader_cache.Programs.clear(); // don't keep the binaries in memory
+  return shaders_created;
+}
+
+bool OGLGraphicsDriver::CreateShaderPrograms()
+{
   bool shaders_created = true;
   shaders_created &= CreateTransparencyShader(_transparencyShader);
   shaders_created &= CreateTintShader(_tintShader);
   shaders_created &= CreateLightShader(_lightShader);
+  // YUV shader is optional: without it the video decoder converts frames to RGB
+  CreateYUVShader(_yuvShader);
+  // Alpha test shader is optional: without it the dissolve transition is done on CPU
+  CreateAlphaTestShader(_alphaTestShader);
   return shaders_created;
 }
 
@@ -572,6 +879,77 @@ void main()
 )EOS";
 
 
+// Converts the YUV 4:2:0 frame to RGB, using BT.601 coefficients.
+// The Y, U and V planes are stored in a single luminance texture,
+// see YUVFrameLayout; the sprite's texture coordinates cover the Y plane.
+
+// Uniforms:
+// textID - texture index (usually 0),
+// yRange - clamping range of the Y plane coordinates (min.xy, max.xy),
+// chromaRange - clamping range of the chroma planes coordinates,
+//   relative to the plane's origin (min.xy, max.xy),
+// chromaOrigin - origins of the U and V planes on the texture,
+// alpha - color alpha value.
+
+static const auto yuv_fragment_shader_src = ""
+#if AGS_OPENGL_ES2
+"#version 100 \n"
+"precision mediump float; \n"
+#else
+"#version 120 \n"
+#endif
+R"EOS(
+uniform sampler2D textID;
+uniform vec4 yRange;
+uniform vec4 chromaRange;
+uniform vec4 chromaOrigin;
+uniform float alpha;
+
+varying vec2 v_TexCoord;
+
+void main()
+{
+    // clamping keeps the linear filter from blending the neighbouring planes
+    vec2 y_coord = clamp(v_TexCoord, yRange.xy, yRange.zw);
+    vec2 c_coord = clamp(v_TexCoord * 0.5, chromaRange.xy, chromaRange.zw);
+    float y = 1.164 * (texture2D(textID, y_coord).r - 0.0625);
+    float u = texture2D(textID, chromaOrigin.xy + c_coord).r - 0.5;
+    float v = texture2D(textID, chromaOrigin.zw + c_coord).r - 0.5;
+    gl_FragColor = vec4(y + 1.596 * v, y - 0.391 * u - 0.813 * v, y + 2.018 * u, alpha);
+}
+)EOS";
+
+
+// Draws only the pixels which alpha is at least the threshold, and draws these
+// opaque.
+
+// Uniforms:
+// textID - texture index (usually 0),
+// threshold - min alpha of the pixels to draw, in 0-255 range.
+
+static const auto alphatest_fragment_shader_src = ""
+#if AGS_OPENGL_ES2
+"#version 100 \n"
+"precision mediump float; \n"
+#else
+"#version 120 \n"
+#endif
+R"EOS(
+uniform sampler2D textID;
+uniform float threshold;
+
+varying vec2 v_TexCoord;
+
+void main()
+{
+    vec4 src_col = texture2D(textID, v_TexCoord);
+    if (src_col.w * 255.0 + 0.5 < threshold)
+        discard;
+    gl_FragColor = vec4(src_col.xyz, 1.0);
+}
+)EOS";
+
+
 bool CreateTransparencyShader(ShaderProgram &prg)
 {
   if(!CreateShaderProgram(prg, "Transparency", default_vertex_shader_src, transparency_fragment_shader_src)) return false;
@@ -604,10 +982,40 @@ bool CreateLightShader(ShaderProgram &prg)
   return true;
 }
 
+bool CreateYUVShader(ShaderProgram &prg)
+{
+  if(!CreateShaderProgram(prg, "YUV", default_vertex_shader_src, yuv_fragment_shader_src)) return false;
+  prg.MVPMatrix = glGetUniformLocation(prg.Program, "uMVPMatrix");
+  prg.TextureId = glGetUniformLocation(prg.Program, "textID");
+  prg.Arg[0] = glGetUniformLocation(prg.Program, "yRange");
+  prg.Arg[1] = glGetUniformLocation(prg.Program, "chromaRange");
+  prg.Arg[2] = glGetUniformLocation(prg.Program, "chromaOrigin");
+  prg.Alpha = glGetUniformLocation(prg.Program, "alpha");
+  return true;
+}
+
+bool CreateAlphaTestShader(ShaderProgram &prg)
+{
+  if(!CreateShaderProgram(prg, "AlphaTest", default_vertex_shader_src, alphatest_fragment_shader_src)) return false;
+  prg.MVPMatrix = glGetUniformLocation(prg.Program, "uMVPMatrix");
+  prg.TextureId = glGetUniformLocation(prg.Program, "textID");
+  prg.Arg[0] = glGetUniformLocation(prg.Program, "threshold");
+  prg.Alpha = glGetUniformLocation(prg.Program, "alpha"); // not present, makes setting it a no-op
+  return true;
+}
+
 
 
 bool CreateShaderProgram(ShaderProgram &prg, const char *name, const char *vertex_shader_src, const char *fragment_shader_src)
 {
+  const uint32_t src_hash = HashShaderSources(vertex_shader_src, fragment_shader_src);
+  prg.Program = LoadCachedShaderProgram(name, src_hash);
+  if (prg.Program)
+  {
+    Debug::Printf("OGL: %s shader program loaded from the cache", name);
+    return true;
+  }
+
   GLint result;
 
   GLint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
@@ -634,6 +1042,8 @@ bool CreateShaderProgram(ShaderProgram &prg, const char *name, const char *verte
   GLuint program = glCreateProgram();
   glAttachShader(program, vertex_shader);
   glAttachShader(program, fragment_shader);
+  if (shader_cache.ProgramParameteri)
+    shader_cache.ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
   glLinkProgram(program);
   glGetProgramiv(program, GL_LINK_STATUS, &result);
   if(result == GL_FALSE)
@@ -650,6 +1060,7 @@ bool CreateShaderProgram(ShaderProgram &prg, const char *name, const char *verte
   glDetachShader(program, fragment_shader);
   glDeleteShader(fragment_shader);
 
+  StoreShaderProgramBinary(program, name, src_hash);
   prg.Program = program;
   Debug::Printf("OGL: %s shader program created successfully", name);
   return true;
@@ -854,6 +1265,26 @@ void OGLGraphicsDriver::UnInit()
   DeleteShaderProgram(_transparencyShader);
   DeleteShaderProgram(_tintShader);
   DeleteShaderProgram(_lightShader);
+  DeleteShaderProgram(_yuvShader);
+  DeleteShaderProgram(_alphaTestShader);
+  DeleteScreenCopies();
+  if (_quadVbo > 0u)
+    glDeleteBuffers(1, &_quadVbo);
+  _quadVbo = 0u;
+  _quadVertices.clear();
+  if (_uploadPbo[0] > 0u)
+    glDeleteBuffers(UploadPboCount, _uploadPbo);
+  std::fill(std::begin(_uploadPbo), std::end(_uploadPbo), 0u);
+  _uploadBuffer.clear();
+  _atlas[0].reset();
+  _atlas[1].reset();
+#if !AGS_OPENGL_ES2
+  if (_gpuTimers[0] > 0u)
+    glDeleteQueries(GpuTimerCount, _gpuTimers);
+#endif
+  std::fill(std::begin(_gpuTimers), std::end(_gpuTimers), 0u);
+  std::fill(std::begin(_gpuTimerIssued), std::end(_gpuTimerIssued), false);
+  _lastGpuTimeUs = 0u;
 
   DeleteWindowAndGlContext();
   sys_window_destroy();
@@ -896,9 +1327,7 @@ void OGLGraphicsDriver::GetCopyOfScreenIntoDDB(IDriverDependantBitmap *target, u
     }
 }
 
-bool OGLGraphicsDriver::GetCopyOfScreenIntoBitmap(Bitmap *destination,
-    const Rect *src_rect, bool at_native_res,
-    GraphicResolution *want_fmt, uint32_t batch_skip_filter)
+Rect OGLGraphicsDriver::GetScreenReadRect(const Rect *src_rect, bool &at_native_res) const
 {
   // Currently don't support copying in screen resolution when we are rendering in native
   if (_doRenderToTexture)
@@ -907,20 +1336,11 @@ bool OGLGraphicsDriver::GetCopyOfScreenIntoBitmap(Bitmap *destination,
   Rect copy_from = src_rect ? *src_rect : _srcRect;
   if (!at_native_res)
     copy_from = _scaling.ScaleRange(copy_from);
+  return copy_from;
+}
 
-  // TODO: following implementation currently only reads GL pixels in 32-bit RGBA.
-  // this **should** work regardless of actual display mode because OpenGL is
-  // responsible to convert and fill pixel buffer correctly.
-  // If you like to support writing directly into 16-bit bitmap, please take
-  // care of ammending the pixel reading code below.
-  const int read_in_colordepth = 32;
-  if (destination->GetColorDepth() != read_in_colordepth || destination->GetSize() != copy_from.GetSize())
-  {
-    if (want_fmt)
-      *want_fmt = GraphicResolution(copy_from.GetWidth(), copy_from.GetHeight(), read_in_colordepth);
-    return false;
-  }
-
+void OGLGraphicsDriver::PrepareScreenRead(bool at_native_res, uint32_t batch_skip_filter)
+{
   // If we are rendering sprites at the screen resolution, and requested native res,
   // re-render last frame to the native surface
   // Also force re-render last frame if we require batch filtering
@@ -944,15 +1364,13 @@ bool OGLGraphicsDriver::GetCopyOfScreenIntoBitmap(Bitmap *destination,
     glReadBuffer(GL_FRONT);
 #endif
   }
+}
 
-  // Retrieve the backbuffer pixels
-  const int bpp = read_in_colordepth / 8;
-  const int buf_sz = copy_from.GetWidth() * copy_from.GetHeight() * bpp;
-  std::vector<uint8_t> buffer(buf_sz);
-  glReadPixels(copy_from.Left, copy_from.Top, copy_from.GetWidth(), copy_from.GetHeight(), GL_RGBA, GL_UNSIGNED_BYTE, &buffer.front());
-
-  // Now convert from OGL RGBA to Allegro RGBA pixel format
-  uint8_t* sourcePtr = &buffer.front();
+// Converts the pixels read from GL, in bottom-up RGBA, to the Allegro's RGBA bitmap
+static void ConvertScreenPixels(const uint8_t *src, int src_width, Bitmap *destination)
+{
+  const int bpp = 4;
+  const uint8_t* sourcePtr = src;
   for (int y = destination->GetHeight() - 1; y >= 0; y--)
   {
     unsigned int * destPtr = reinterpret_cast<unsigned int*>(&destination->GetScanLineForWriting(y)[0]);
@@ -960,131 +1378,167 @@ bool OGLGraphicsDriver::GetCopyOfScreenIntoBitmap(Bitmap *destination,
     {
       destPtr[dx] = makeacol32(sourcePtr[sx + 0], sourcePtr[sx + 1], sourcePtr[sx + 2], sourcePtr[sx + 3]);
     }
-    sourcePtr += copy_from.GetWidth() * bpp;
+    sourcePtr += src_width * bpp;
+  }
+}
+
+bool OGLGraphicsDriver::GetCopyOfScreenIntoBitmap(Bitmap *destination,
+    const Rect *src_rect, bool at_native_res,
+    GraphicResolution *want_fmt, uint32_t batch_skip_filter)
+{
+  const Rect copy_from = GetScreenReadRect(src_rect, at_native_res);
+
+  // TODO: following implementation currently only reads GL pixels in 32-bit RGBA.
+  // this **should** work regardless of actual display mode because OpenGL is
+  // responsible to convert and fill pixel buffer correctly.
+  // If you like to support writing directly into 16-bit bitmap, please take
+  // care of ammending the pixel reading code below.
+  const int read_in_colordepth = 32;
+  if (destination->GetColorDepth() != read_in_colordepth || destination->GetSize() != copy_from.GetSize())
+  {
+    if (want_fmt)
+      *want_fmt = GraphicResolution(copy_from.GetWidth(), copy_from.GetHeight(), read_in_colordepth);
+    return false;
   }
 
+  PrepareScreenRead(at_native_res, batch_skip_filter);
+
+  // Retrieve the backbuffer pixels
+  const int bpp = read_in_colordepth / 8;
+  const int buf_sz = copy_from.GetWidth() * copy_from.GetHeight() * bpp;
+  std::vector<uint8_t> buffer(buf_sz);
+  glReadPixels(copy_from.Left, copy_from.Top, copy_from.GetWidth(), copy_from.GetHeight(), GL_RGBA, GL_UNSIGNED_BYTE, &buffer.front());
+
+  // Now convert from OGL RGBA to Allegro RGBA pixel format
+  ConvertScreenPixels(&buffer.front(), copy_from.GetWidth(), destination);
   return true;
 }
 
-void OGLGraphicsDriver::Render()
+uint32_t OGLGraphicsDriver::BeginScreenCopy(const Rect *src_rect, bool at_native_res, uint32_t batch_skip_filter)
 {
-    Render(0, 0, kFlip_None);
+#if AGS_OPENGL_ES2
+  // Pixel buffer objects are not supported by GLES 2
+  return VideoMemoryGraphicsDriver::BeginScreenCopy(src_rect, at_native_res, batch_skip_filter);
+#else
+  if (!GLAD_GL_VERSION_2_1)
+    return VideoMemoryGraphicsDriver::BeginScreenCopy(src_rect, at_native_res, batch_skip_filter);
+
+  const Rect copy_from = GetScreenReadRect(src_rect, at_native_res);
+  if (copy_from.IsEmpty())
+    return 0u;
+  PrepareScreenRead(at_native_res, batch_skip_filter);
+
+  // Read the pixels into the pixel buffer; this lets the call return
+  // without waiting for the transfer to complete
+  ScreenCopyRequest req;
+  req.ReadSize = copy_from.GetSize();
+  req.Frame = _frameCount;
+  glGenBuffers(1, &req.Pbo);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, req.Pbo);
+  glBufferData(GL_PIXEL_PACK_BUFFER, req.ReadSize.Width * req.ReadSize.Height * 4, nullptr, GL_STREAM_READ);
+  glReadPixels(copy_from.Left, copy_from.Top, copy_from.GetWidth(), copy_from.GetHeight(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  const uint32_t handle = NewScreenCopyHandle();
+  _screenCopyRequests[handle] = req;
+  return handle;
+#endif
 }
 
-void OGLGraphicsDriver::Render(int /*xoff*/, int /*yoff*/, GraphicFlip /*flip*/)
+bool OGLGraphicsDriver::IsScreenCopyReady(uint32_t handle)
 {
-    RenderAndPresent(true);
+  auto it = _screenCopyRequests.find(handle);
+  if (it == _screenCopyRequests.end())
+    return VideoMemoryGraphicsDriver::IsScreenCopyReady(handle);
+  // GL 2.1 has no sync objects, so tell by the presented frames,
+  // expecting the transfer to complete along with them
+  return (_frameCount - it->second.Frame) >= ScreenCopyFrameDelay;
 }
 
-void OGLGraphicsDriver::RenderToBackBuffer()
+std::unique_ptr<Bitmap> OGLGraphicsDriver::EndScreenCopy(uint32_t handle)
 {
-    RenderImpl(true);
+  auto it = _screenCopyRequests.find(handle);
+  if (it == _screenCopyRequests.end())
+    return VideoMemoryGraphicsDriver::EndScreenCopy(handle);
+
+  const ScreenCopyRequest req = it->second;
+  _screenCopyRequests.erase(it);
+  std::unique_ptr<Bitmap> copy;
+#if !AGS_OPENGL_ES2
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, req.Pbo);
+  // Mapping waits for the transfer, if it has not completed yet
+  const uint8_t *pixels = static_cast<const uint8_t*>(glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY));
+  if (pixels)
+  {
+    copy.reset(new Bitmap(req.ReadSize.Width, req.ReadSize.Height, 32));
+    ConvertScreenPixels(pixels, req.ReadSize.Width, copy.get());
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  glDeleteBuffers(1, &req.Pbo);
+#endif
+  return copy;
 }
 
-void OGLGraphicsDriver::Render(IDriverDependantBitmap *target)
+void OGLGraphicsDriver::DeleteScreenCopies()
 {
-    OGLBitmap *bitmap = (OGLBitmap*)target;
-    Size surf_sz(bitmap->_width, bitmap->_height);
+  for (auto &req : _screenCopyRequests)
+    glDeleteBuffers(1, &req.second.Pbo);
+  _screenCopyRequests.clear();
+}
+
+void OGLGraphicsDriver::Render()
+{
+    Render(0, 0, kFlip_None);
+}
+
+void OGLGraphicsDriver::Render(int /*xoff*/, int /*yoff*/, GraphicFlip /*flip*/)
+{
+    RenderAndPresent(true);
+}
+
+void OGLGraphicsDriver::RenderToBackBuffer()
+{
+    RenderImpl(true);
+}
+
+void OGLGraphicsDriver::Render(IDriverDependantBitmap *target)
+{
+    OGLBitmap *bitmap = (OGLBitmap*)target;
+    Size surf_sz(bitmap->_width, bitmap->_height);
     BackbufferState backbuffer = BackbufferState(bitmap->_fbo, surf_sz, surf_sz,
         RectWH(0, 0, surf_sz.Width, surf_sz.Height),
         glm::ortho(0.0f, (float)surf_sz.Width, 0.0f, (float)surf_sz.Height, 0.0f, 1.0f),
         PlaneScaling(), GL_NEAREST, GL_CLAMP);
     RenderToSurface(&backbuffer, true);
+    InvalidateFrame(); // the texture may be displayed in the next frame
 }
 
 void OGLGraphicsDriver::RenderSprite(const OGLDrawListEntry *drawListEntry,
     const glm::mat4 &projection, const glm::mat4 &matGlobal,
     const SpriteColorTransform &color, const Size &rend_sz)
 {
-    RenderTexture(drawListEntry->ddb, drawListEntry->x, drawListEntry->y, projection, matGlobal, color, rend_sz);
-}
-
-void OGLGraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw_y,
-    const glm::mat4 &projection, const glm::mat4 &matGlobal,
-    const SpriteColorTransform &color, const Size &rend_sz)
-{
-  const int alpha = (color.Alpha * bmpToDraw->_alpha) / 255;
-
-  ShaderProgram program;
-
-  const bool do_tint = bmpToDraw->_tintSaturation > 0 && _tintShader.Program > 0;
-  const bool do_light = bmpToDraw->_tintSaturation == 0 && bmpToDraw->_lightLevel > 0 && _lightShader.Program > 0;
-  if (do_tint)
-  {
-    // Use tinting shader
-    program = _tintShader;
-    glUseProgram(_tintShader.Program);
-
-    float rgb[3];
-    float sat_trs_lum[3]; // saturation / transparency / luminance
-    if (_legacyPixelShader)
+    // Only the sprites drawn with the default shader may be batched,
+    // the tint, light, YUV and alpha test shaders have per-sprite parameters
+    if ((_quadVbo > 0u) && (GetSpriteShader(drawListEntry->ddb) == kShader_Transparency))
     {
-      rgb_to_hsv(bmpToDraw->_red, bmpToDraw->_green, bmpToDraw->_blue, &rgb[0], &rgb[1], &rgb[2]);
-      rgb[0] /= 360.0; // In HSV, Hue is 0-360
+        BatchTexture(drawListEntry->ddb, drawListEntry->x, drawListEntry->y, projection, matGlobal, color, rend_sz);
     }
     else
     {
-      rgb[0] = (float)bmpToDraw->_red / 255.0;
-      rgb[1] = (float)bmpToDraw->_green / 255.0;
-      rgb[2] = (float)bmpToDraw->_blue / 255.0;
+        FlushQuadBatch();
+        RenderTexture(drawListEntry->ddb, drawListEntry->x, drawListEntry->y, projection, matGlobal, color, rend_sz);
     }
+}
 
-    sat_trs_lum[0] = (float)bmpToDraw->_tintSaturation / 255.0;
-
-    if (bmpToDraw->_lightLevel > 0)
-      sat_trs_lum[2] = (float)bmpToDraw->_lightLevel / 255.0;
-    else
-      sat_trs_lum[2] = 1.0f;
-
-    glUniform3f(_tintShader.TintHSV, rgb[0], rgb[1], rgb[2]);
-    glUniform1f(_tintShader.TintAmount, sat_trs_lum[0]);
-    glUniform1f(_tintShader.TintLuminance, sat_trs_lum[2]);
-  }
-  else if (do_light)
-  {
-    // Use light shader
-    program = _lightShader;
-    glUseProgram(_lightShader.Program);
-    float light_lev = 1.0f;
-
-    // Light level parameter in DDB is weird, it is measured in units of
-    // 1/255 (although effectively 1/250, see draw.cpp), but contains two
-    // ranges: 1-255 is darker range and 256-511 is brighter range.
-    // (light level of 0 means "default color")
-    if ((bmpToDraw->_lightLevel > 0) && (bmpToDraw->_lightLevel < 256))
-    {
-      // darkening the sprite... this stupid calculation is for
-      // consistency with the allegro software-mode code that does
-      // a trans blend with a (8,8,8) sprite
-      light_lev = -((bmpToDraw->_lightLevel * 192) / 256 + 64) / 255.f; // darker, uses MODULATE op
-    }
-    else if (bmpToDraw->_lightLevel > 256)
-    {
-      light_lev = ((bmpToDraw->_lightLevel - 256) / 2) / 255.f; // brighter, uses ADD op
-    }
-
-    glUniform1f(_lightShader.LightingAmount, light_lev);
-  }
-  else
-  {
-    // Use default processing
-    program = _transparencyShader;
-    glUseProgram(_transparencyShader.Program);
-  }
-
-  glUniform1i(program.TextureId, 0);
-  glUniform1f(program.Alpha, alpha / 255.0f);
-
-  float width = bmpToDraw->GetWidthToRender();
-  float height = bmpToDraw->GetHeightToRender();
-  float xProportion = width / (float)bmpToDraw->_width;
-  float yProportion = height / (float)bmpToDraw->_height;
-
-  const auto *txdata = bmpToDraw->_data.get();
-  for (size_t ti = 0; ti < txdata->_numTiles; ++ti)
-  {
-    width = txdata->_tiles[ti].width * xProportion;
-    height = txdata->_tiles[ti].height * yProportion;
+glm::mat4 OGLGraphicsDriver::GetTileTransform(const OGLBitmap *bmpToDraw, size_t ti, int draw_x, int draw_y,
+    const glm::mat4 &projection, const glm::mat4 &matGlobal, const Size &rend_sz)
+{
+    const float xProportion = bmpToDraw->GetWidthToRender() / (float)bmpToDraw->_width;
+    const float yProportion = bmpToDraw->GetHeightToRender() / (float)bmpToDraw->_height;
+    const auto *txdata = bmpToDraw->_data.get();
+    const float width = txdata->_tiles[ti].width * xProportion;
+    const float height = txdata->_tiles[ti].height * yProportion;
     float xOffs;
     float yOffs = txdata->_tiles[ti].y * yProportion;
     if (bmpToDraw->_flipped)
@@ -1119,15 +1573,116 @@ void OGLGraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw
     transform = transform * matGlobal;
     // Self sprite transform (first scale, then rotate and then translate, reversed)
     transform = glmex::transform2d(transform, thisX, thisY, widthToScale, heightToScale, 0.f);
+    return transform;
+}
 
-    glUniformMatrix4fv(program.MVPMatrix, 1, GL_FALSE, glm::value_ptr(transform));
+VideoMemoryGraphicsDriver::DrawState OGLGraphicsDriver::GetDrawState(const OGLBitmap *ddb) const
+{
+    // Sprites which use different shaders, or have different shader or
+    // texture parameters, may not be drawn together
+    const uint32_t shader = ddb->_data->_yuv ? 3u :
+        ((ddb->_tintSaturation > 0 && _tintShader.Program > 0) ? 1u :
+        ((ddb->_tintSaturation == 0 && ddb->_lightLevel > 0 && _lightShader.Program > 0) ? 2u : 0u));
+    const uint32_t blend = static_cast<uint32_t>(ddb->_renderHint) | (shader << 4) |
+        (UseLinearFilter(ddb) ? (1u << 6) : 0u) | (static_cast<uint32_t>(ddb->_alpha & 0xFF) << 8) |
+        (static_cast<uint32_t>(ddb->_alphaTest & 0x1FF) << 16);
+    // Textures placed on the same atlas page count as the same texture
+    const OGLTexture *txdata = ddb->_data.get();
+    const void *texture = txdata->_atlas ? txdata->_atlas->GetPageKey(txdata->_atlasPage) : txdata;
+    return DrawState(texture, blend);
+}
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, txdata->_tiles[ti].texture);
+OGLGraphicsDriver::ShaderKind OGLGraphicsDriver::GetSpriteShader(const OGLBitmap *bmpToDraw) const
+{
+    if ((bmpToDraw->_alphaTest > 0) && (_alphaTestShader.Program > 0))
+        return kShader_AlphaTest;
+    if (bmpToDraw->_data->_yuv)
+        return kShader_YUV;
+    if ((bmpToDraw->_tintSaturation > 0) && (_tintShader.Program > 0))
+        return kShader_Tint;
+    if ((bmpToDraw->_tintSaturation == 0) && (bmpToDraw->_lightLevel > 0) && (_lightShader.Program > 0))
+        return kShader_Light;
+    return kShader_Transparency;
+}
+
+void OGLGraphicsDriver::SetTintShaderArgs(const ShaderProgram &program, int red, int green, int blue,
+    int saturation, int light_level)
+{
+    float rgb[3];
+    float sat_trs_lum[3]; // saturation / transparency / luminance
+    if (_legacyPixelShader)
+    {
+      rgb_to_hsv(red, green, blue, &rgb[0], &rgb[1], &rgb[2]);
+      rgb[0] /= 360.0; // In HSV, Hue is 0-360
+    }
+    else
+    {
+      rgb[0] = (float)red / 255.0;
+      rgb[1] = (float)green / 255.0;
+      rgb[2] = (float)blue / 255.0;
+    }
+
+    sat_trs_lum[0] = (float)saturation / 255.0;
+
+    if (light_level > 0)
+      sat_trs_lum[2] = (float)light_level / 255.0;
+    else
+      sat_trs_lum[2] = 1.0f;
+
+    glUniform3f(program.TintHSV, rgb[0], rgb[1], rgb[2]);
+    glUniform1f(program.TintAmount, sat_trs_lum[0]);
+    glUniform1f(program.TintLuminance, sat_trs_lum[2]);
+}
+
+void OGLGraphicsDriver::SetLightShaderArgs(const ShaderProgram &program, int light_level)
+{
+    float light_lev = 1.0f;
 
-    if ((_smoothScaling) && bmpToDraw->_useResampler && (bmpToDraw->_stretchToHeight > 0) &&
+    // Light level parameter in DDB is weird, it is measured in units of
+    // 1/255 (although effectively 1/250, see draw.cpp), but contains two
+    // ranges: 1-255 is darker range and 256-511 is brighter range.
+    // (light level of 0 means "default color")
+    if ((light_level > 0) && (light_level < 256))
+    {
+      // darkening the sprite... this stupid calculation is for
+      // consistency with the allegro software-mode code that does
+      // a trans blend with a (8,8,8) sprite
+      light_lev = -((light_level * 192) / 256 + 64) / 255.f; // darker, uses MODULATE op
+    }
+    else if (light_level > 256)
+    {
+      light_lev = ((light_level - 256) / 2) / 255.f; // brighter, uses ADD op
+    }
+
+    glUniform1f(program.LightingAmount, light_lev);
+}
+
+void OGLGraphicsDriver::SetYUVShaderArgs(const ShaderProgram &program, const OGLTexture *txdata)
+{
+    // Texture coordinates of the planes; the ranges are half a texel
+    // inside the planes, so that the linear filter stays within them
+    const auto &tile = txdata->_tiles[0];
+    const float tex_w = static_cast<float>(tile.allocWidth);
+    const float tex_h = static_cast<float>(tile.allocHeight);
+    const YUVFrameLayout layout(txdata->Res);
+    const Point u_at = layout.GetUOrigin(), v_at = layout.GetVOrigin();
+    glUniform4f(program.Arg[0], 0.5f / tex_w, 0.5f / tex_h,
+        (layout.Frame.Width - 0.5f) / tex_w, (layout.Frame.Height - 0.5f) / tex_h);
+    glUniform4f(program.Arg[1], 0.5f / tex_w, 0.5f / tex_h,
+        (layout.Chroma.Width - 0.5f) / tex_w, (layout.Chroma.Height - 0.5f) / tex_h);
+    glUniform4f(program.Arg[2], u_at.X / tex_w, u_at.Y / tex_h, v_at.X / tex_w, v_at.Y / tex_h);
+}
+
+bool OGLGraphicsDriver::UseLinearFilter(const OGLBitmap *bmpToDraw) const
+{
+    return (_smoothScaling) && bmpToDraw->_useResampler && (bmpToDraw->_stretchToHeight > 0) &&
         ((bmpToDraw->_stretchToHeight != bmpToDraw->_height) ||
-         (bmpToDraw->_stretchToWidth != bmpToDraw->_width)))
+         (bmpToDraw->_stretchToWidth != bmpToDraw->_width));
+}
+
+void OGLGraphicsDriver::SetTextureFilter(bool linear)
+{
+    if (linear)
     {
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -1141,6 +1696,150 @@ void OGLGraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _currentBackbuffer->TxClamp);
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, _currentBackbuffer->TxClamp);
     }
+}
+
+void OGLGraphicsDriver::BatchTexture(OGLBitmap *bmpToDraw, int draw_x, int draw_y,
+    const glm::mat4 &projection, const glm::mat4 &matGlobal,
+    const SpriteColorTransform &color, const Size &rend_sz)
+{
+    QuadBatchState state;
+    state.Alpha = (color.Alpha * bmpToDraw->_alpha) / 255;
+    state.Linear = UseLinearFilter(bmpToDraw);
+    state.RenderHint = bmpToDraw->_renderHint;
+
+    // Each tile is two triangles, same as the triangle strip of 4 vertices
+    static const int StripToTriangles[6] = { 0, 1, 2, 2, 1, 3 };
+    const auto *txdata = bmpToDraw->_data.get();
+    for (size_t ti = 0; ti < txdata->_numTiles; ++ti)
+    {
+        state.Texture = txdata->_tiles[ti].texture;
+        if (!_quadVertices.empty() && !(state == _quadBatch))
+            FlushQuadBatch();
+        _quadBatch = state;
+
+        // Vertices are transformed here, as every sprite has its own matrix
+        const glm::mat4 transform = GetTileTransform(bmpToDraw, ti, draw_x, draw_y, projection, matGlobal, rend_sz);
+        const OGLCUSTOMVERTEX *vertices = (txdata->_vertex != nullptr) ? &txdata->_vertex[ti * 4] : defaultVertices;
+        for (int vi : StripToTriangles)
+        {
+            const glm::vec4 pos = transform * glm::vec4(vertices[vi].position.x, vertices[vi].position.y, 0.f, 1.f);
+            OGLCUSTOMVERTEX v;
+            v.position.x = pos.x;
+            v.position.y = pos.y;
+            v.tu = vertices[vi].tu;
+            v.tv = vertices[vi].tv;
+            _quadVertices.push_back(v);
+        }
+    }
+    _renderStats.Sprites++;
+}
+
+void OGLGraphicsDriver::FlushQuadBatch()
+{
+    if (_quadVertices.empty())
+        return;
+
+    const ShaderProgram &program = _transparencyShader;
+    glUseProgram(program.Program);
+    glUniform1i(program.TextureId, 0);
+    glUniform1f(program.Alpha, _quadBatch.Alpha / 255.0f);
+    // The vertices are already transformed
+    glUniformMatrix4fv(program.MVPMatrix, 1, GL_FALSE, glm::value_ptr(glmex::identity()));
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _quadBatch.Texture);
+    SetTextureFilter(_quadBatch.Linear);
+
+    // Re-specifying the whole buffer lets the driver allocate a new storage
+    // instead of waiting for the previous draw to complete
+    glBindBuffer(GL_ARRAY_BUFFER, _quadVbo);
+    glBufferData(GL_ARRAY_BUFFER, _quadVertices.size() * sizeof(OGLCUSTOMVERTEX), _quadVertices.data(), GL_STREAM_DRAW);
+
+    glEnableVertexAttribArray(0);
+    GLint a_Position = glGetAttribLocation(program.Program, "a_Position");
+    glVertexAttribPointer(a_Position, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX),
+        reinterpret_cast<const void*>(offsetof(OGLCUSTOMVERTEX, position)));
+
+    glEnableVertexAttribArray(1);
+    GLint a_TexCoord = glGetAttribLocation(program.Program, "a_TexCoord");
+    glVertexAttribPointer(a_TexCoord, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX),
+        reinterpret_cast<const void*>(offsetof(OGLCUSTOMVERTEX, tu)));
+
+    // Treat special render modes
+    switch (_quadBatch.RenderHint)
+    {
+    case kTxHint_PremulAlpha:
+        glBlendColor(_quadBatch.Alpha / 255.0f, _quadBatch.Alpha / 255.0f, _quadBatch.Alpha / 255.0f, 1.0);
+        SetBlendOpRGB(GL_FUNC_ADD, GL_CONSTANT_COLOR, GL_ONE_MINUS_SRC_ALPHA);
+        break;
+    default: break;
+    }
+
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(_quadVertices.size()));
+    _renderStats.DrawCalls++;
+
+    // Restore default blending mode, and the client-side vertex arrays
+    SetBlendOpRGB(GL_FUNC_ADD, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+    _quadVertices.clear();
+}
+
+void OGLGraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw_y,
+    const glm::mat4 &projection, const glm::mat4 &matGlobal,
+    const SpriteColorTransform &color, const Size &rend_sz)
+{
+  const int alpha = (color.Alpha * bmpToDraw->_alpha) / 255;
+
+  ShaderProgram program;
+
+  switch (GetSpriteShader(bmpToDraw))
+  {
+  case kShader_AlphaTest:
+    // Use alpha test shader
+    program = _alphaTestShader;
+    glUseProgram(_alphaTestShader.Program);
+    glUniform1f(_alphaTestShader.Arg[0], static_cast<float>(bmpToDraw->_alphaTest));
+    break;
+  case kShader_YUV:
+    // Use YUV conversion shader
+    program = _yuvShader;
+    glUseProgram(_yuvShader.Program);
+    SetYUVShaderArgs(_yuvShader, bmpToDraw->_data.get());
+    break;
+  case kShader_Tint:
+    // Use tinting shader
+    program = _tintShader;
+    glUseProgram(_tintShader.Program);
+    SetTintShaderArgs(_tintShader, bmpToDraw->_red, bmpToDraw->_green, bmpToDraw->_blue,
+        bmpToDraw->_tintSaturation, bmpToDraw->_lightLevel);
+    break;
+  case kShader_Light:
+    // Use light shader
+    program = _lightShader;
+    glUseProgram(_lightShader.Program);
+    SetLightShaderArgs(_lightShader, bmpToDraw->_lightLevel);
+    break;
+  default:
+    // Use default processing
+    program = _transparencyShader;
+    glUseProgram(_transparencyShader.Program);
+    break;
+  }
+
+  glUniform1i(program.TextureId, 0);
+  glUniform1f(program.Alpha, alpha / 255.0f);
+
+  const auto *txdata = bmpToDraw->_data.get();
+  for (size_t ti = 0; ti < txdata->_numTiles; ++ti)
+  {
+    const glm::mat4 transform = GetTileTransform(bmpToDraw, ti, draw_x, draw_y, projection, matGlobal, rend_sz);
+    glUniformMatrix4fv(program.MVPMatrix, 1, GL_FALSE, glm::value_ptr(transform));
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, txdata->_tiles[ti].texture);
+
+    SetTextureFilter(UseLinearFilter(bmpToDraw));
 
     if (txdata->_vertex != nullptr)
     {
@@ -1174,21 +1873,71 @@ void OGLGraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw
     }
 
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    _renderStats.DrawCalls++;
 
     // Restore default blending mode
     SetBlendOpRGB(GL_FUNC_ADD, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   }
   glUseProgram(0);
+  _renderStats.Sprites++;
 }
 
 void OGLGraphicsDriver::RenderAndPresent(bool clearDrawListAfterwards)
 {
+    if (IsSameAsLastFrame(_spriteList, _smoothScaling | (_doRenderToTexture << 1)))
+    {
+        // Keep the last presented frame on screen
+        if (clearDrawListAfterwards)
+        {
+            BackupDrawLists();
+            ClearDrawLists();
+        }
+        ResetFxPool();
+        EndFrameStats();
+        return;
+    }
     RenderImpl(clearDrawListAfterwards);
     SDL_GL_SwapWindow(_sdlWindow);
+    _frameCount++;
+}
+
+void OGLGraphicsDriver::BeginGpuTimer()
+{
+#if !AGS_OPENGL_ES2
+    if (_gpuTimers[0] == 0u)
+        return;
+    // Read the result of this query's previous use, if it's ready by now
+    const GLuint query = _gpuTimers[_gpuTimerIndex];
+    if (_gpuTimerIssued[_gpuTimerIndex])
+    {
+        GLuint available = 0u;
+        glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            GLuint time_ns = 0u;
+            glGetQueryObjectuiv(query, GL_QUERY_RESULT, &time_ns);
+            _lastGpuTimeUs = time_ns / 1000u;
+        }
+    }
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    _gpuTimerIssued[_gpuTimerIndex] = true;
+#endif
+}
+
+void OGLGraphicsDriver::EndGpuTimer()
+{
+#if !AGS_OPENGL_ES2
+    if (_gpuTimers[0] == 0u)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    _gpuTimerIndex = (_gpuTimerIndex + 1) % GpuTimerCount;
+#endif
+    _renderStats.GpuTimeUs = _lastGpuTimeUs;
 }
 
 void OGLGraphicsDriver::RenderImpl(bool clearDrawListAfterwards)
 {
+    BeginGpuTimer();
     if (_doRenderToTexture)
     {
         RenderToSurface(&_nativeBackbuffer, clearDrawListAfterwards);
@@ -1205,6 +1954,8 @@ void OGLGraphicsDriver::RenderImpl(bool clearDrawListAfterwards)
         RenderTexture(_nativeSurface, 0, 0, _screenBackbuffer.Projection, glmex::identity(), SpriteColorTransform(), _srcRect.GetSize());
         glFinish();
     }
+    EndGpuTimer();
+    EndFrameStats();
 }
 
 void OGLGraphicsDriver::RenderToSurface(BackbufferState *state, bool clearDrawListAfterwards)
@@ -1212,6 +1963,8 @@ void OGLGraphicsDriver::RenderToSurface(BackbufferState *state, bool clearDrawLi
     SetBackbufferState(state, true);
     // Save Projection
     _stageMatrixes.Projection = _currentBackbuffer->Projection;
+    if (_stateSorting)
+        SortDrawListByState(_spriteList, [this](const OGLBitmap *ddb) { return GetDrawState(ddb); });
     RenderSpriteBatches();
     glFinish();
 
@@ -1406,6 +2159,7 @@ size_t OGLGraphicsDriver::RenderSpriteBatch(const OGLSpriteBatch &batch, size_t
         case DRAWENTRY_STAGECALLBACK:
             // raw-draw plugin support
             int sx, sy;
+            FlushQuadBatch(); // plugin may render on its own
             if (auto *ddb = DoSpriteEvtCallback(e.x, 0, sx, sy))
             {
                 auto stageEntry = OGLDrawListEntry((OGLBitmap*)ddb, batch.ID, sx, sy);
@@ -1417,6 +2171,7 @@ size_t OGLGraphicsDriver::RenderSpriteBatch(const OGLSpriteBatch &batch, size_t
             break;
         }
     }
+    FlushQuadBatch();
     return from;
 }
 
@@ -1582,7 +2337,19 @@ void OGLGraphicsDriver::DestroyDDB(IDriverDependantBitmap* ddb)
 }
 
 
-void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, const Bitmap *bitmap, bool has_alpha, bool opaque)
+// Converts the RGBA pixels to 16-bit RGB 5:6:5 in place
+static void ConvertToRGB565(uint8_t *buf, size_t pixel_count)
+{
+  const uint32_t *src = reinterpret_cast<const uint32_t*>(buf);
+  uint16_t *dst = reinterpret_cast<uint16_t*>(buf);
+  for (size_t i = 0; i < pixel_count; ++i)
+  {
+    const uint32_t c = src[i]; // R is in the lowest byte
+    dst[i] = static_cast<uint16_t>(((c & 0xF8) << 8) | ((c >> 5) & 0x7E0) | ((c >> 19) & 0x1F));
+  }
+}
+
+void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, const Bitmap *bitmap, bool has_alpha, bool opaque, bool compact)
 {
   const int textureWidth = tile->allocWidth;
   const int textureHeight = tile->allocHeight;
@@ -1602,7 +2369,11 @@ void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, const Bitmap *
   }
 
   const bool usingLinearFiltering = _filter->UseLinearFiltering();
-  uint8_t *origPtr = new uint8_t[sizeof(int) * tileWidth * tileHeight];
+  // The staging buffer is kept between the calls, to avoid reallocating it
+  const size_t buf_size = sizeof(int) * tileWidth * tileHeight;
+  if (_uploadBuffer.size() < buf_size)
+    _uploadBuffer.resize(buf_size);
+  uint8_t *origPtr = _uploadBuffer.data();
   const int pitch = tileWidth * sizeof(int);
   uint8_t *memPtr = origPtr + pitch * tiley + tilex * sizeof(int);
 
@@ -1661,10 +2432,122 @@ void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, const Bitmap *
     }
   }
 
+  if (compact)
+  {
+    ConvertToRGB565(origPtr, tileWidth * tileHeight);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    UploadTexturePixels(tile, tile->texX, tile->texY, tileWidth, tileHeight, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, origPtr, buf_size / 2);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  }
+  else
+  {
+    UploadTexturePixels(tile, tile->texX, tile->texY, tileWidth, tileHeight, GL_RGBA, GL_UNSIGNED_BYTE, origPtr, buf_size);
+  }
+}
+
+void OGLGraphicsDriver::UpdateTextureSubRegion(OGLTextureTile *tile, const Bitmap *bitmap, const Rect &area,
+    bool has_alpha, bool opaque, bool compact)
+{
+  const Rect tile_rc = RectWH(tile->x, tile->y, tile->width, tile->height);
+  const Rect rc = IntersectRects(area, tile_rc);
+  if (rc.IsEmpty())
+    return;
+
+  // The tile's edge pixels are also copied to the padding around the tile
+  // (see UpdateTextureRegion), so update the whole tile if these are touched
+  const bool pad_x = tile->allocWidth > tile->width;
+  const bool pad_y = tile->allocHeight > tile->height;
+  if ((pad_x && ((rc.Left == tile_rc.Left) || (rc.Right == tile_rc.Right))) ||
+      (pad_y && ((rc.Top == tile_rc.Top) || (rc.Bottom == tile_rc.Bottom))))
+  {
+    UpdateTextureRegion(tile, bitmap, has_alpha, opaque, compact);
+    return;
+  }
+  const int tilex = pad_x ? std::min(tile->allocWidth - tile->width - 1, 1) : 0;
+  const int tiley = pad_y ? std::min(tile->allocHeight - tile->height - 1, 1) : 0;
+
+  // Linear filtering conversion looks at the neighbouring pixels,
+  // so convert a 1 pixel wider area, and then only upload the requested one
+  const bool usingLinearFiltering = _filter->UseLinearFiltering();
+  const Rect conv_rc = usingLinearFiltering ?
+    IntersectRects(Rect(rc.Left - 1, rc.Top - 1, rc.Right + 1, rc.Bottom + 1), tile_rc) : rc;
+  const size_t conv_size = sizeof(int) * conv_rc.GetWidth() * conv_rc.GetHeight();
+  if (_uploadBuffer.size() < conv_size)
+    _uploadBuffer.resize(conv_size);
+  uint8_t *buf = _uploadBuffer.data();
+  const int conv_pitch = conv_rc.GetWidth() * sizeof(int);
+
+  TextureTile conv_tile;
+  conv_tile.x = conv_rc.Left;
+  conv_tile.y = conv_rc.Top;
+  conv_tile.width = conv_rc.GetWidth();
+  conv_tile.height = conv_rc.GetHeight();
+  assert(!opaque || !has_alpha); // has_alpha is meaningless with opaque
+  if (opaque)
+    BitmapToVideoMemOpaque(bitmap, &conv_tile, buf, conv_pitch);
+  else
+    BitmapToVideoMem(bitmap, has_alpha, &conv_tile, buf, conv_pitch, usingLinearFiltering);
+
+  // Pack the requested area's rows together; the rows only move backwards
+  const int width = rc.GetWidth(), height = rc.GetHeight();
+  const int pitch = width * sizeof(int);
+  if (!(conv_rc == rc))
+  {
+    const uint8_t *src = buf + (rc.Top - conv_rc.Top) * conv_pitch + (rc.Left - conv_rc.Left) * sizeof(int);
+    for (int y = 0; y < height; ++y, src += conv_pitch)
+      memmove(buf + y * pitch, src, pitch);
+  }
+
+  const int tex_x = tile->texX + tilex + (rc.Left - tile->x);
+  const int tex_y = tile->texY + tiley + (rc.Top - tile->y);
+  const size_t size = pitch * height;
+  if (compact)
+  {
+    ConvertToRGB565(buf, width * height);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    UploadTexturePixels(tile, tex_x, tex_y, width, height, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, buf, size / 2);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  }
+  else
+  {
+    UploadTexturePixels(tile, tex_x, tex_y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, buf, size);
+  }
+}
+
+void OGLGraphicsDriver::UploadTexturePixels(const OGLTextureTile *tile, int x, int y, int width, int height,
+    GLenum format, GLenum type, const uint8_t *pixels, size_t size)
+{
   glBindTexture(GL_TEXTURE_2D, tile->texture);
-  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tileWidth, tileHeight, GL_RGBA, GL_UNSIGNED_BYTE, origPtr);
+  const void *data = BeginPixelUpload(pixels, size);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, format, type, data);
+  EndPixelUpload(size);
+}
+
+const void *OGLGraphicsDriver::BeginPixelUpload(const uint8_t *pixels, size_t size)
+{
+#if !AGS_OPENGL_ES2
+  if (_uploadPbo[0] > 0u)
+  {
+    // Copy the pixels to the next buffer in the ring, and let the driver
+    // transfer them to the texture in the background. Re-specifying the
+    // buffer's storage avoids waiting for its previous upload to complete.
+    const GLuint pbo = _uploadPbo[_uploadPboIndex];
+    _uploadPboIndex = (_uploadPboIndex + 1) % UploadPboCount;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, pixels, GL_STREAM_DRAW);
+    return nullptr;
+  }
+#endif
+  return pixels;
+}
 
-  delete []origPtr;
+void OGLGraphicsDriver::EndPixelUpload(size_t size)
+{
+#if !AGS_OPENGL_ES2
+  if (_uploadPbo[0] > 0u)
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+#endif
+  _renderStats.UploadBytes += size;
 }
 
 void OGLGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* ddb, const Bitmap *bitmap, bool has_alpha)
@@ -1675,6 +2558,22 @@ void OGLGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* ddb, const B
   target->_hasAlpha = has_alpha;
 }
 
+void OGLGraphicsDriver::UpdateDDBRegion(IDriverDependantBitmap* ddb, const Bitmap *bitmap, bool has_alpha, const Rect &area)
+{
+  OGLBitmap *target = (OGLBitmap*)ddb;
+  OGLTexture *ogldata = target->_data.get();
+  // Changing the alpha mode requires to convert all the pixels anew
+  if (!ogldata || (has_alpha != target->_hasAlpha) ||
+      (ogldata->Res.ColorDepth != bitmap->GetColorDepth()) ||
+      (ogldata->Res.Width != bitmap->GetWidth()) || (ogldata->Res.Height != bitmap->GetHeight()))
+  {
+    UpdateDDBFromBitmap(ddb, bitmap, has_alpha);
+    return;
+  }
+
+  UpdateTextureArea(ogldata, bitmap, has_alpha, target->_opaque, area);
+}
+
 void OGLGraphicsDriver::UpdateTexture(Texture *txdata, const Bitmap *bitmap, bool has_alpha, bool opaque)
 {
   const int color_depth = bitmap->GetColorDepth();
@@ -1689,8 +2588,31 @@ void OGLGraphicsDriver::UpdateTexture(Texture *txdata, const Bitmap *bitmap, boo
   auto *ogldata = reinterpret_cast<OGLTexture*>(txdata);
   for (size_t i = 0; i < ogldata->_numTiles; ++i)
   {
-    UpdateTextureRegion(&ogldata->_tiles[i], bitmap, has_alpha, opaque);
+    UpdateTextureRegion(&ogldata->_tiles[i], bitmap, has_alpha, opaque, ogldata->_compact);
+  }
+  txdata->Touch();
+
+  if (color_depth == 8)
+      unselect_palette();
+}
+
+void OGLGraphicsDriver::UpdateTextureArea(Texture *txdata, const Bitmap *bitmap, bool has_alpha, bool opaque, const Rect &area)
+{
+  const int color_depth = bitmap->GetColorDepth();
+  if (bitmap->GetColorDepth() != txdata->Res.ColorDepth)
+    throw Ali3DException("UpdateTextureArea: mismatched colour depths");
+  if (txdata->Res.Width != bitmap->GetWidth() || txdata->Res.Height != bitmap->GetHeight())
+    throw Ali3DException("UpdateTextureArea: mismatched bitmap size");
+
+  if (color_depth == 8)
+      select_palette(palette);
+
+  auto *ogldata = reinterpret_cast<OGLTexture*>(txdata);
+  for (size_t i = 0; i < ogldata->_numTiles; ++i)
+  {
+    UpdateTextureSubRegion(&ogldata->_tiles[i], bitmap, area, has_alpha, opaque, ogldata->_compact);
   }
+  txdata->Touch();
 
   if (color_depth == 8)
       unselect_palette();
@@ -1725,10 +2647,9 @@ int OGLGraphicsDriver::GetCompatibleBitmapFormat(int color_depth)
 uint64_t OGLGraphicsDriver::GetAvailableTextureMemory()
 {
     GLint mem[4]{}; // ATI requires array of 4 ints
-    const char *exts = (const char*)glGetString(GL_EXTENSIONS);
-    if (strstr(exts, "GL_NVX_gpu_memory_info") != nullptr)
+    if (SDL_GL_ExtensionSupported("GL_NVX_gpu_memory_info"))
         glGetIntegerv(GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &mem[0]);
-    else if (strstr(exts, "GL_ATI_meminfo") != nullptr)
+    else if (SDL_GL_ExtensionSupported("GL_ATI_meminfo"))
         glGetIntegerv(TEXTURE_FREE_MEMORY_ATI, &mem[0]);
     return static_cast<uint64_t>(mem[0]) * 1024u; // retrieved mem is in KB
 }
@@ -1790,15 +2711,120 @@ IDriverDependantBitmap* OGLGraphicsDriver::CreateRenderTargetDDB(int width, int
     return ddb;
 }
 
+Size OGLGraphicsDriver::GetMaxYUVFrameSize()
+{
+    if (_yuvShader.Program == 0)
+        return Size();
+    // All the planes must fit in a single texture
+    GLint max_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    return Size(max_size, max_size * 2 / 3);
+}
+
+IDriverDependantBitmap *OGLGraphicsDriver::CreateYUVFrameDDB(int width, int height)
+{
+    const Size max_size = GetMaxYUVFrameSize();
+    if ((width <= 0) || (height <= 0) || (width > max_size.Width) || (height > max_size.Height))
+        return nullptr;
+
+    const Size planes_sz = YUVFrameLayout(Size(width, height)).GetBitmapSize();
+    int alloc_width = planes_sz.Width, alloc_height = planes_sz.Height;
+    AdjustSizeToNearestSupportedByCard(&alloc_width, &alloc_height);
+
+    auto *txdata = new OGLTexture(GraphicResolution(width, height, 32), false);
+    txdata->_yuv = true;
+    txdata->_numTiles = 1;
+    txdata->_tiles = new OGLTextureTile[1];
+    OGLTextureTile &tile = txdata->_tiles[0];
+    tile.x = 0;
+    tile.y = 0;
+    tile.width = width;
+    tile.height = height;
+    tile.allocWidth = alloc_width;
+    tile.allocHeight = alloc_height;
+    // The vertices only cover the Y plane, the shader finds the chroma planes itself
+    txdata->_vertex = new OGLCUSTOMVERTEX[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        txdata->_vertex[i] = defaultVertices[i];
+        txdata->_vertex[i].tu *= (float)width / (float)alloc_width;
+        txdata->_vertex[i].tv *= (float)height / (float)alloc_height;
+    }
+
+    glGenTextures(1, &tile.texture);
+    glBindTexture(GL_TEXTURE_2D, tile.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    glTexImage2D(GL_TEXTURE_2D, 0, _singleChannelFormat, alloc_width, alloc_height, 0, _singleChannelFormat, GL_UNSIGNED_BYTE, nullptr);
+
+    OGLBitmap *ddb = new OGLBitmap(width, height, 32, true);
+    ddb->_data.reset(txdata);
+    return ddb;
+}
+
+void OGLGraphicsDriver::UpdateYUVFrameDDB(IDriverDependantBitmap *ddb, const Bitmap *planes)
+{
+    OGLTexture *txdata = ((OGLBitmap*)ddb)->_data.get();
+    if (!txdata || !txdata->_yuv || (planes->GetColorDepth() != 8))
+        return;
+    const Size planes_sz = YUVFrameLayout(txdata->Res).GetBitmapSize();
+    if (planes->GetSize() != planes_sz)
+        throw Ali3DException("UpdateYUVFrameDDB: mismatched bitmap size");
+
+    // The planes are uploaded as they are, only the rows are packed if necessary
+    const size_t size = planes_sz.Width * planes_sz.Height;
+    const uint8_t *pixels = planes->GetData();
+    if (planes->GetStride() != planes->GetLineLength())
+    {
+        if (_uploadBuffer.size() < size)
+            _uploadBuffer.resize(size);
+        for (int y = 0; y < planes_sz.Height; ++y)
+            memcpy(_uploadBuffer.data() + y * planes_sz.Width, planes->GetScanLine(y), planes_sz.Width);
+        pixels = _uploadBuffer.data();
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    UploadTexturePixels(&txdata->_tiles[0], 0, 0, planes_sz.Width, planes_sz.Height, _singleChannelFormat, GL_UNSIGNED_BYTE, pixels, size);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    txdata->Touch();
+    InvalidateFrame(); // texture contents change
+}
+
+bool OGLGraphicsDriver::SupportsAlphaTest()
+{
+    return _alphaTestShader.Program > 0;
+}
+
+void OGLGraphicsDriver::SetDDBAlphaTest(IDriverDependantBitmap *ddb, int threshold)
+{
+    ((OGLBitmap*)ddb)->_alphaTest = std::max(0, threshold);
+}
+
+uint64_t OGLGraphicsDriver::GetDDBStateHash(IDriverDependantBitmap *ddb)
+{
+    return HashDDBState((OGLBitmap*)ddb);
+}
+
 std::shared_ptr<Texture> OGLGraphicsDriver::GetTexture(IDriverDependantBitmap *ddb)
 {
     return std::static_pointer_cast<Texture>((reinterpret_cast<OGLBitmap*>(ddb))->_data);
 }
 
-Texture *OGLGraphicsDriver::CreateTexture(int width, int height, int color_depth, bool /*opaque*/, bool as_render_target)
+Texture *OGLGraphicsDriver::CreateTexture(int width, int height, int color_depth, bool opaque, bool as_render_target)
 {
   assert(width > 0);
   assert(height > 0);
+  // Small textures are placed on the shared atlas pages, if there's room
+  if (_useTextureAtlas && !as_render_target &&
+      (width <= AtlasMaxTextureSize) && (height <= AtlasMaxTextureSize))
+  {
+    OGLTexture *txdata = CreateAtlasTexture(width, height, color_depth, _compactOpaqueTextures && opaque);
+    if (txdata)
+      return txdata;
+  }
+
   int allocatedWidth = width;
   int allocatedHeight = height;
   AdjustSizeToNearestSupportedByCard(&allocatedWidth, &allocatedHeight);
@@ -1837,6 +2863,9 @@ Texture *OGLGraphicsDriver::CreateTexture(int width, int height, int color_depth
   AdjustSizeToNearestSupportedByCard(&tileAllocatedWidth, &tileAllocatedHeight);
 
   auto *txdata = new OGLTexture(GraphicResolution(width, height, color_depth), as_render_target);
+  // Opaque textures do not need an alpha channel, and may be stored in 16-bit;
+  // render targets are kept in the full format, as the game renders on them
+  txdata->_compact = _compactOpaqueTextures && opaque && !as_render_target;
   int numTiles = tilesAcross * tilesDown;
   OGLTextureTile *tiles = new OGLTextureTile[numTiles];
   OGLCUSTOMVERTEX *vertices = nullptr;
@@ -1932,7 +2961,10 @@ Texture *OGLGraphicsDriver::CreateTexture(int width, int height, int color_depth
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
       // NOTE: pay attention that the texture format depends on the **display mode**'s format,
       // rather than source bitmap's color depth!
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, thisAllocatedWidth, thisAllocatedHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+      if (txdata->_compact)
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, thisAllocatedWidth, thisAllocatedHeight, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, nullptr);
+      else
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, thisAllocatedWidth, thisAllocatedHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
     }
   }
 
@@ -1941,6 +2973,57 @@ Texture *OGLGraphicsDriver::CreateTexture(int width, int height, int color_depth
   return txdata;
 }
 
+std::shared_ptr<OGLTextureAtlas> OGLGraphicsDriver::CreateTextureAtlas(const Size &page_size, bool compact)
+{
+  return std::make_shared<OGLTextureAtlas>(page_size, AtlasMaxPages, compact);
+}
+
+OGLTexture *OGLGraphicsDriver::CreateAtlasTexture(int width, int height, int color_depth, bool compact)
+{
+  auto &atlas = _atlas[compact ? 1 : 0];
+  if (!atlas)
+  {
+    int max_size = AtlasPageSize;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    const int page_size = std::min(AtlasPageSize, max_size);
+    atlas = CreateTextureAtlas(Size(page_size, page_size), compact);
+  }
+
+  // The texture is allocated with a 1 pixel border, to which its edge pixels
+  // are copied (see UpdateTextureRegion), so that the linear filtering would
+  // not mix in the neighbouring textures
+  OGLTextureTile tile;
+  tile.width = width;
+  tile.height = height;
+  tile.allocWidth = width + 2;
+  tile.allocHeight = height + 2;
+  const int page = atlas->Add(tile);
+  if (page < 0)
+    return nullptr;
+
+  auto *txdata = new OGLTexture(GraphicResolution(width, height, color_depth), false);
+  txdata->_compact = compact;
+  txdata->_atlas = atlas;
+  txdata->_atlasPage = page;
+  txdata->_numTiles = 1;
+  txdata->_tiles = new OGLTextureTile[1];
+  txdata->_tiles[0] = tile;
+  // Texture coordinates of the image within the page
+  const Size &page_size = atlas->GetPageSize();
+  const float u1 = (float)(tile.texX + 1) / (float)page_size.Width;
+  const float v1 = (float)(tile.texY + 1) / (float)page_size.Height;
+  const float u2 = (float)(tile.texX + 1 + width) / (float)page_size.Width;
+  const float v2 = (float)(tile.texY + 1 + height) / (float)page_size.Height;
+  txdata->_vertex = new OGLCUSTOMVERTEX[4];
+  for (int i = 0; i < 4; ++i)
+  {
+    txdata->_vertex[i] = defaultVertices[i];
+    txdata->_vertex[i].tu = (defaultVertices[i].tu > 0.f) ? u2 : u1;
+    txdata->_vertex[i].tv = (defaultVertices[i].tv > 0.f) ? v2 : v1;
+  }
+  return txdata;
+}
+
 void OGLGraphicsDriver::SetScreenFade(int red, int green, int blue)
 {
     assert(_actSpriteBatch != UINT32_MAX);
@@ -1963,9 +3046,22 @@ void OGLGraphicsDriver::SetScreenTint(int red, int green, int blue)
 }
 
 
+bool OGLGraphicsDriver::SetSwapInterval(bool vsync)
+{
+    // Adaptive vsync is requested with a negative swap interval, see
+    // https://registry.khronos.org/OpenGL/extensions/EXT/EXT_swap_control_tear.txt
+    if (vsync && _adaptiveVsync)
+    {
+        if (SDL_GL_SetSwapInterval(-1) == 0)
+            return true;
+        Debug::Printf(kDbgMsg_Warn, "OGL: adaptive vsync is not supported: %s", SDL_GetError());
+    }
+    return SDL_GL_SetSwapInterval(vsync ? 1 : 0) == 0;
+}
+
 bool OGLGraphicsDriver::SetVsyncImpl(bool enabled, bool &vsync_res)
 {
-    if (SDL_GL_SetSwapInterval(enabled) != 0)
+    if (!SetSwapInterval(enabled))
     {
         Debug::Printf(kDbgMsg_Warn, "OGL: SetVsync (%d) failed: %s", enabled, SDL_GetError());
         return false;
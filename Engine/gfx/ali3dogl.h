@@ -20,6 +20,7 @@
 #define __AGS_EE_GFX__ALI3DOGL_H
 
 #include <memory>
+#include <unordered_map>
 
 #include "glm/glm.hpp"
 
@@ -27,6 +28,7 @@
 #include "gfx/ddb.h"
 #include "gfx/gfxdriverfactorybase.h"
 #include "gfx/gfxdriverbase.h"
+#include "util/rectpacker.h"
 #include "util/string.h"
 #include "util/version.h"
 
@@ -41,6 +43,7 @@ namespace OGL
 {
 
 using Common::Bitmap;
+using Common::RectPacker;
 using Common::String;
 using Common::Version;
 
@@ -60,6 +63,52 @@ struct OGLCUSTOMVERTEX
 struct OGLTextureTile : public TextureTile
 {
     unsigned int texture = 0;
+    // Position of the allocated area in the texture, if the texture is shared
+    int texX = 0, texY = 0;
+    // Layer of the texture array, or -1 if the texture is not an array
+    int texLayer = -1;
+};
+
+// Shared textures on which the small textures are placed together, so that
+// the sprites using these may be drawn in one batch
+class OGLTextureAtlas
+{
+public:
+    OGLTextureAtlas(const Size &page_size, size_t max_pages, bool compact);
+    virtual ~OGLTextureAtlas();
+
+    const Size &GetPageSize() const { return _packer.GetPageSize(); }
+    // Gets the unique key of the page, for telling the draw states apart
+    virtual const void *GetPageKey(int page) const { return &_pages[page]; }
+
+    // Allocates the area of the tile's allocated size on one of the pages;
+    // sets the tile's texture, position and layer, and returns the page index,
+    // or -1 if no room left
+    int  Add(OGLTextureTile &tile);
+    // Tells that the area allocated on the page is no longer used
+    void Release(int page);
+
+protected:
+    bool IsCompact() const { return _compact; }
+    // Creates the texture for the new page; returns the texture, and the
+    // layer of it which holds the page, or -1 if it's not a texture array
+    virtual unsigned int CreatePageTexture(size_t page, int &layer);
+
+private:
+    OGLTextureAtlas(const OGLTextureAtlas&) = delete;
+    OGLTextureAtlas &operator=(const OGLTextureAtlas&) = delete;
+
+    struct Page
+    {
+        unsigned int Texture = 0u;
+        int Layer = -1;
+        size_t UseCount = 0u; // number of the areas used on this page
+    };
+
+    RectPacker _packer;
+    // NOTE: reserved for the max pages, as the page keys are their addresses
+    std::vector<Page> _pages;
+    bool _compact = false;
 };
 
 // Full OpenGL texture data
@@ -68,6 +117,14 @@ struct OGLTexture : Texture
     OGLCUSTOMVERTEX *_vertex = nullptr;
     OGLTextureTile *_tiles = nullptr;
     size_t _numTiles = 0;
+    // Texture is stored in a compact 16-bit RGB format
+    bool _compact = false;
+    // Texture holds the YUV 4:2:0 planes in a single luminance channel,
+    // see YUVFrameLayout; these are converted to RGB by a shader
+    bool _yuv = false;
+    // Atlas which page this texture is placed on, if any
+    std::shared_ptr<OGLTextureAtlas> _atlas;
+    int _atlasPage = -1;
 
     OGLTexture(const GraphicResolution &res, bool rt)
         : Texture(res, rt) {}
@@ -130,6 +187,8 @@ public:
     int _tintSaturation;
     int _lightLevel;
     int _alpha;
+    // Min alpha of the pixels to draw opaque, or 0 to draw with blending
+    int _alphaTest;
 
     OGLBitmap(int width, int height, int colDepth, bool opaque)
     {
@@ -145,6 +204,7 @@ public:
         _tintSaturation = 0;
         _lightLevel = 0;
         _alpha = 255;
+        _alphaTest = 0;
         _opaque = opaque;
     }
 
@@ -219,6 +279,10 @@ struct ShaderProgram
     GLuint LightingAmount = 0;
 };
 
+// Compiles and links the shader program, or loads it from the shader cache
+bool CreateShaderProgram(ShaderProgram &prg, const char *name, const char *vertex_shader_src, const char *fragment_shader_src);
+void DeleteShaderProgram(ShaderProgram &prg);
+
 class OGLGfxFilter;
 
 class OGLGraphicsDriver : public VideoMemoryGraphicsDriver
@@ -248,12 +312,20 @@ public:
     IDriverDependantBitmap* CreateDDB(int width, int height, int color_depth, bool opaque) override;
     IDriverDependantBitmap* CreateRenderTargetDDB(int width, int height, int color_depth, bool opaque) override;
     void UpdateDDBFromBitmap(IDriverDependantBitmap* ddb, const Bitmap *bitmap, bool has_alpha) override;
+    void UpdateDDBRegion(IDriverDependantBitmap* ddb, const Bitmap *bitmap, bool has_alpha, const Rect &area) override;
     void DestroyDDB(IDriverDependantBitmap* ddb) override;
+    Size GetMaxYUVFrameSize() override;
+    IDriverDependantBitmap *CreateYUVFrameDDB(int width, int height) override;
+    void UpdateYUVFrameDDB(IDriverDependantBitmap *ddb, const Bitmap *planes) override;
+    bool SupportsAlphaTest() override;
+    void SetDDBAlphaTest(IDriverDependantBitmap *ddb, int threshold) override;
+    uint64_t GetDDBStateHash(IDriverDependantBitmap *ddb) override;
     
     // Create texture data with the given parameters
     Texture *CreateTexture(int width, int height, int color_depth, bool opaque, bool as_render_target = false) override;
     // Update texture data from the given bitmap
     void UpdateTexture(Texture *txdata, const Bitmap *bitmap, bool has_alpha, bool opaque) override;
+    void UpdateTextureArea(Texture *txdata, const Bitmap *bitmap, bool has_alpha, bool opaque, const Rect &area) override;
     // Retrieve shared texture data object from the given DDB
     std::shared_ptr<Texture> GetTexture(IDriverDependantBitmap *ddb) override;
 
@@ -270,11 +342,17 @@ public:
     void GetCopyOfScreenIntoDDB(IDriverDependantBitmap *target, uint32_t batch_skip_filter = 0u) override;
     bool GetCopyOfScreenIntoBitmap(Bitmap *destination, const Rect *src_rect, bool at_native_res,
         GraphicResolution *want_fmt, uint32_t batch_skip_filter = 0u) override;
+    uint32_t BeginScreenCopy(const Rect *src_rect, bool at_native_res, uint32_t batch_skip_filter = 0u) override;
+    bool IsScreenCopyReady(uint32_t handle) override;
+    std::unique_ptr<Bitmap> EndScreenCopy(uint32_t handle) override;
     bool DoesSupportVsyncToggle() override { return _capsVsync; }
     void RenderSpritesAtScreenResolution(bool enabled) override;
     bool SupportsGammaControl() override;
     void SetGamma(int newGamma) override;
     void UseSmoothScaling(bool enabled) override { _smoothScaling = enabled; }
+    void SetCompactOpaqueTextures(bool enabled) override { _compactOpaqueTextures = enabled; }
+    void SetTextureAtlas(bool enabled) override { _useTextureAtlas = enabled; }
+    void SetShaderCacheFile(const String &path) override { _shaderCacheFile = path; }
 
     typedef std::shared_ptr<OGLGfxFilter> POGLFilter;
 
@@ -291,7 +369,16 @@ protected:
 
     size_t GetLastDrawEntryIndex() override { return _spriteList.size(); }
 
-private:
+    // Shaders which the sprites are drawn with
+    enum ShaderKind
+    {
+        kShader_Transparency,
+        kShader_Tint,
+        kShader_Light,
+        kShader_YUV,
+        kShader_AlphaTest
+    };
+
     POGLFilter _filter {};
 
     bool _firstTimeInit;
@@ -304,6 +391,61 @@ private:
     ShaderProgram _tintShader;
     ShaderProgram _lightShader;
     ShaderProgram _transparencyShader;
+    // Optional shader converting YUV frames to RGB
+    ShaderProgram _yuvShader;
+    // Optional shader drawing the pixels which pass the alpha test opaque
+    ShaderProgram _alphaTestShader;
+
+    // Render state shared by all the quads in the batch
+    struct QuadBatchState
+    {
+        GLuint Texture = 0u;
+        bool Linear = false;
+        int Alpha = 0;
+        TextureHint RenderHint = kTxHint_Normal;
+
+        bool operator ==(const QuadBatchState &other) const
+        {
+            return Texture == other.Texture && Linear == other.Linear &&
+                Alpha == other.Alpha && RenderHint == other.RenderHint;
+        }
+    };
+
+    // Asynchronous screen copy, read into the pixel buffer
+    struct ScreenCopyRequest
+    {
+        GLuint Pbo = 0u;
+        Size ReadSize;
+        uint32_t Frame = 0u; // frame counter at the time of request
+    };
+    // Number of frames after which the screen copy is considered complete
+    static const uint32_t ScreenCopyFrameDelay = 2u;
+
+    // Ring of the pixel buffers for the texture uploads
+    static const size_t UploadPboCount = 3u;
+    GLuint _uploadPbo[UploadPboCount] {};
+    size_t _uploadPboIndex = 0u;
+    // Staging buffer for converting the bitmap pixels
+    std::vector<uint8_t> _uploadBuffer;
+
+    // Ring of the timer queries, measuring the GPU time of the recent frames;
+    // a query's result is read when it's back in turn, so that the
+    // render does not have to wait for the GPU
+    static const size_t GpuTimerCount = 3u;
+    GLuint _gpuTimers[GpuTimerCount] {};
+    bool _gpuTimerIssued[GpuTimerCount] {};
+    size_t _gpuTimerIndex = 0u;
+    uint32_t _lastGpuTimeUs = 0u;
+
+    // Counter of the presented frames
+    uint32_t _frameCount = 0u;
+    std::unordered_map<uint32_t, ScreenCopyRequest> _screenCopyRequests;
+
+    // Streaming vertex buffer for the batched quads
+    GLuint _quadVbo = 0u;
+    QuadBatchState _quadBatch;
+    // Pretransformed vertices of the batched quads, as triangle lists
+    std::vector<OGLCUSTOMVERTEX> _quadVertices;
 
     int device_screen_physical_width;
     int device_screen_physical_height;
@@ -312,6 +454,21 @@ private:
     GLint _screenFramebuffer = 0u;
     // Capability flags
     bool _glCapsNonPowerOfTwo = false;
+    // Pixel format of the single channel textures, such as the YUV planes
+    GLenum _singleChannelFormat = GL_LUMINANCE;
+    // Store opaque textures in 16-bit RGB format
+    bool _compactOpaqueTextures = false;
+    // Place the small textures on the shared atlas pages
+    bool _useTextureAtlas = false;
+    // Atlases for the full and compact texture formats, created on demand
+    std::shared_ptr<OGLTextureAtlas> _atlas[2];
+    // Size of the atlas pages, and max number of pages per atlas
+    static const int AtlasPageSize = 1024;
+    static const size_t AtlasMaxPages = 4u;
+    // Max size of the texture to place on the atlas
+    static const int AtlasMaxTextureSize = 128;
+    // File to save the linked shader program binaries to
+    String _shaderCacheFile;
     // These two flags define whether driver can, and should (respectively)
     // render sprites to texture, and then texture to screen, as opposed to
     // rendering to screen directly. This is known as supersampling mode
@@ -372,11 +529,15 @@ private:
     void ResetAllBatches() override;
 
     // Sets up GL objects not related to particular display mode
-    bool FirstTimeInit();
+    virtual bool FirstTimeInit();
     // Initializes Gl rendering context
     bool InitGlScreen(const DisplayMode &mode);
     bool CreateWindowAndGlContext(const DisplayMode &mode);
     void DeleteWindowAndGlContext();
+    // Sets the GL profile and version to request when creating the context
+    virtual void SetContextAttributes();
+    // Loads the GL functions for the current context
+    virtual bool LoadGlFunctions();
     // Sets up general rendering parameters
     void InitGlParams(const DisplayMode &mode);
     void SetupDefaultVertices();
@@ -384,19 +545,62 @@ private:
     void TestRenderToTexture();
     // Create shader programs for sprite tinting and changing light level
     bool CreateShaders();
+    // Creates the shader programs, called by CreateShaders
+    virtual bool CreateShaderPrograms();
     // Configure native resolution render target, that is used in render-to-texture mode
     void SetupNativeTarget();
     // Unset parameters and release resources related to the display mode
     void ReleaseDisplayMode();
+    // Sets the swap interval for the vsync mode, trying adaptive vsync if requested
+    bool SetSwapInterval(bool vsync);
     void AdjustSizeToNearestSupportedByCard(int *width, int *height);
-    void UpdateTextureRegion(OGLTextureTile *tile, const Bitmap *bitmap, bool has_alpha, bool opaque);
+    // Creates the atlas for the small textures of the full or compact format
+    virtual std::shared_ptr<OGLTextureAtlas> CreateTextureAtlas(const Size &page_size, bool compact);
+    // Creates the texture on the atlas page, returns null if there's no room
+    OGLTexture *CreateAtlasTexture(int width, int height, int color_depth, bool compact);
+    void UpdateTextureRegion(OGLTextureTile *tile, const Bitmap *bitmap, bool has_alpha, bool opaque, bool compact);
+    // Updates the part of the tile's texture, which corresponds to the given bitmap area
+    void UpdateTextureSubRegion(OGLTextureTile *tile, const Bitmap *bitmap, const Rect &area, bool has_alpha, bool opaque, bool compact);
+    // Uploads the pixels to the tile's texture, using the pixel buffers if available
+    virtual void UploadTexturePixels(const OGLTextureTile *tile, int x, int y, int width, int height,
+        GLenum format, GLenum type, const uint8_t *pixels, size_t size);
+    // Prepares the pixels for the upload; returns the data pointer to pass
+    // to the GL upload function, which is null if the pixel buffer is used
+    const void *BeginPixelUpload(const uint8_t *pixels, size_t size);
+    void EndPixelUpload(size_t size);
     void CreateVirtualScreen();
-    void RenderSprite(const OGLDrawListEntry *entry, const glm::mat4 &projection, const glm::mat4 &matGlobal,
+    // Begins and ends the GPU timer query around the frame's render
+    void BeginGpuTimer();
+    void EndGpuTimer();
+    virtual void RenderSprite(const OGLDrawListEntry *entry, const glm::mat4 &projection, const glm::mat4 &matGlobal,
         const SpriteColorTransform &color, const Size &rend_sz);
     // Renders given texture onto the current render target
-    void RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw_y,
+    virtual void RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw_y,
+        const glm::mat4 &projection, const glm::mat4 &matGlobal,
+        const SpriteColorTransform &color, const Size &rend_sz);
+    // Adds given texture to the quad batch, flushing the batch first
+    // if the texture or the render state differ from the batched ones
+    void BatchTexture(OGLBitmap *bmpToDraw, int draw_x, int draw_y,
         const glm::mat4 &projection, const glm::mat4 &matGlobal,
         const SpriteColorTransform &color, const Size &rend_sz);
+    // Draws all the batched quads with a single call, and clears the batch
+    virtual void FlushQuadBatch();
+    // Calculates the full transform of the texture's tile
+    glm::mat4 GetTileTransform(const OGLBitmap *bmpToDraw, size_t tile_index, int draw_x, int draw_y,
+        const glm::mat4 &projection, const glm::mat4 &matGlobal, const Size &rend_sz);
+    // Gets the render state of the texture, for the draw list sorting
+    DrawState GetDrawState(const OGLBitmap *ddb) const;
+    // Chooses the shader to draw the texture with
+    ShaderKind GetSpriteShader(const OGLBitmap *bmpToDraw) const;
+    // Set the parameters of the tint, light and YUV shaders respectively
+    void SetTintShaderArgs(const ShaderProgram &program, int red, int green, int blue,
+        int saturation, int light_level);
+    void SetLightShaderArgs(const ShaderProgram &program, int light_level);
+    void SetYUVShaderArgs(const ShaderProgram &program, const OGLTexture *txdata);
+    // Tells whether the texture should be drawn with the linear filtering
+    bool UseLinearFilter(const OGLBitmap *bmpToDraw) const;
+    // Sets the filtering parameters of the currently bound texture
+    void SetTextureFilter(bool linear);
     void SetupViewport();
 
     // Sets uniform GL blend settings, same for both RGB and alpha component
@@ -429,6 +633,13 @@ private:
     // Configures rendering mode for the render target, depending on its properties
     void SetRenderTarget(const OGLSpriteBatch *batch, Size &surface_sz, Size &rend_sz, glm::mat4 &projection, bool clear);
     void RenderSpriteBatches();
+    // Gets the screen rectangle to read the pixels from, in the read buffer's coordinates
+    Rect GetScreenReadRect(const Rect *src_rect, bool &at_native_res) const;
+    // Sets up the read buffer for reading the screen pixels,
+    // re-renders the last frame if required
+    void PrepareScreenRead(bool at_native_res, uint32_t batch_skip_filter);
+    // Deletes all the pending screen copy requests
+    void DeleteScreenCopies();
     size_t RenderSpriteBatch(const OGLSpriteBatch &batch, size_t from, const glm::mat4 &projection,
         const Size &rend_sz);
 };
@@ -0,0 +1,671 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gfx/ogl_headers.h"
+
+#if AGS_HAS_OPENGL
+#include "gfx/ali3dogl3.h"
+#include <algorithm>
+#include <SDL.h>
+#include "debug/out.h"
+#include "gfx/gfxfilter_ogl.h"
+#include "gfx/gfxfilter_aaogl.h"
+
+#include "glm/glm.hpp"
+#include "glm/ext.hpp"
+#include "glad/glad.h"
+
+// From GL 3.x and GLES 3.0, which are not in the generated loaders
+#ifndef GL_TEXTURE_2D_ARRAY
+#define GL_TEXTURE_2D_ARRAY 0x8C1A
+#endif
+#ifndef GL_UNIFORM_BUFFER
+#define GL_UNIFORM_BUFFER 0x8A11
+#endif
+#ifndef GL_INVALID_INDEX
+#define GL_INVALID_INDEX 0xFFFFFFFFu
+#endif
+
+
+namespace AGS
+{
+namespace Engine
+{
+namespace OGL
+{
+
+using namespace AGS::Common;
+
+
+bool GL3Functions::Load()
+{
+    GenVertexArrays = (AGS_PFNGLGENVERTEXARRAYSPROC)SDL_GL_GetProcAddress("glGenVertexArrays");
+    DeleteVertexArrays = (AGS_PFNGLDELETEVERTEXARRAYSPROC)SDL_GL_GetProcAddress("glDeleteVertexArrays");
+    BindVertexArray = (AGS_PFNGLBINDVERTEXARRAYPROC)SDL_GL_GetProcAddress("glBindVertexArray");
+    DrawArraysInstanced = (AGS_PFNGLDRAWARRAYSINSTANCEDPROC)SDL_GL_GetProcAddress("glDrawArraysInstanced");
+    GetUniformBlockIndex = (AGS_PFNGLGETUNIFORMBLOCKINDEXPROC)SDL_GL_GetProcAddress("glGetUniformBlockIndex");
+    UniformBlockBinding = (AGS_PFNGLUNIFORMBLOCKBINDINGPROC)SDL_GL_GetProcAddress("glUniformBlockBinding");
+    BindBufferBase = (AGS_PFNGLBINDBUFFERBASEPROC)SDL_GL_GetProcAddress("glBindBufferBase");
+    TexImage3D = (AGS_PFNGLTEXIMAGE3DPROC)SDL_GL_GetProcAddress("glTexImage3D");
+    TexSubImage3D = (AGS_PFNGLTEXSUBIMAGE3DPROC)SDL_GL_GetProcAddress("glTexSubImage3D");
+    return GenVertexArrays && DeleteVertexArrays && BindVertexArray && DrawArraysInstanced &&
+        GetUniformBlockIndex && UniformBlockBinding && BindBufferBase && TexImage3D && TexSubImage3D;
+}
+
+
+OGLTextureArrayAtlas::OGLTextureArrayAtlas(const Size &page_size, size_t max_pages, bool compact,
+        AGS_PFNGLTEXIMAGE3DPROC tex_image_3d)
+    : OGLTextureAtlas(page_size, max_pages, compact)
+    , _maxPages(max_pages)
+    , _texImage3D(tex_image_3d)
+{
+}
+
+unsigned int OGLTextureArrayAtlas::CreatePageTexture(size_t page, int &layer)
+{
+    // The storage of a texture array may not be extended,
+    // so the layers for all the pages are allocated with the first one
+    if (page == 0)
+    {
+        const Size &page_size = GetPageSize();
+        glGenTextures(1, &_texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _texture);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        if (IsCompact())
+            _texImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB, page_size.Width, page_size.Height, static_cast<GLsizei>(_maxPages),
+                0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, nullptr);
+        else
+            _texImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, page_size.Width, page_size.Height, static_cast<GLsizei>(_maxPages),
+                0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    layer = static_cast<int>(page);
+    return _texture;
+}
+
+
+OGL3GraphicsDriver::OGL3GraphicsDriver()
+{
+#if !AGS_OPENGL_ES2
+    // Luminance textures are not supported by the core profile
+    _singleChannelFormat = GL_RED;
+#endif
+}
+
+OGL3GraphicsDriver::~OGL3GraphicsDriver()
+{
+    // The rest is released by the base driver, which also deletes the context
+    DeleteShaderProgram(_transparencyArrayShader);
+    DeleteShaderProgram(_tintArrayShader);
+    DeleteShaderProgram(_lightArrayShader);
+    DeleteShaderProgram(_alphaTestArrayShader);
+    if (_cornerVao > 0u)
+        _gl.DeleteVertexArrays(1, &_cornerVao);
+    if (_cornerVbo > 0u)
+        glDeleteBuffers(1, &_cornerVbo);
+    if (_quadUbo > 0u)
+        glDeleteBuffers(1, &_quadUbo);
+}
+
+void OGL3GraphicsDriver::SetContextAttributes()
+{
+#if AGS_OPENGL_ES2
+  const int profile = SDL_GL_CONTEXT_PROFILE_ES, major = 3, minor = 0;
+#else
+  const int profile = SDL_GL_CONTEXT_PROFILE_CORE, major = 3, minor = 3;
+#endif
+  if (SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, profile) != 0)
+    SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Error occured setting attribute SDL_GL_CONTEXT_PROFILE_MASK: %s", SDL_GetError());
+  if (SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, major) != 0)
+    SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Error occured setting attribute SDL_GL_CONTEXT_MAJOR_VERSION: %s", SDL_GetError());
+  if (SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, minor) != 0)
+    SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Error occured setting attribute SDL_GL_CONTEXT_MINOR_VERSION: %s", SDL_GetError());
+#if AGS_OPENGL_ES2
+  if (SDL_GL_SetAttribute(SDL_GL_CONTEXT_EGL, 1) != 0)
+    Debug::Printf(kDbgMsg_Warn, "Error occured setting attribute SDL_GL_CONTEXT_EGL: %s", SDL_GetError());
+#endif
+}
+
+bool OGL3GraphicsDriver::LoadGlFunctions()
+{
+  if (!OGLGraphicsDriver::LoadGlFunctions())
+    return false;
+
+#if AGS_OPENGL_ES2
+  const bool version_supported = GLVersion.major >= 3;
+#else
+  const bool version_supported = (GLVersion.major > 3) || ((GLVersion.major == 3) && (GLVersion.minor >= 3));
+#endif
+  if (!version_supported)
+  {
+    Debug::Printf(kDbgMsg_Error, "OGL3: OpenGL version %d.%d is too old for this driver", GLVersion.major, GLVersion.minor);
+    return false;
+  }
+  if (!_gl.Load())
+  {
+    Debug::Printf(kDbgMsg_Error, "OGL3: failed to load the OpenGL 3 functions");
+    return false;
+  }
+
+#if !AGS_OPENGL_ES2
+  // The framebuffer objects are in the core since GL 3.0, but the loader
+  // only looks for the extension, which the core profile does not list
+  if (!GLAD_GL_EXT_framebuffer_object)
+  {
+    glad_glGenFramebuffersEXT = (PFNGLGENFRAMEBUFFERSEXTPROC)SDL_GL_GetProcAddress("glGenFramebuffers");
+    glad_glDeleteFramebuffersEXT = (PFNGLDELETEFRAMEBUFFERSEXTPROC)SDL_GL_GetProcAddress("glDeleteFramebuffers");
+    glad_glBindFramebufferEXT = (PFNGLBINDFRAMEBUFFEREXTPROC)SDL_GL_GetProcAddress("glBindFramebuffer");
+    glad_glCheckFramebufferStatusEXT = (PFNGLCHECKFRAMEBUFFERSTATUSEXTPROC)SDL_GL_GetProcAddress("glCheckFramebufferStatus");
+    glad_glFramebufferTexture2DEXT = (PFNGLFRAMEBUFFERTEXTURE2DEXTPROC)SDL_GL_GetProcAddress("glFramebufferTexture2D");
+    GLAD_GL_EXT_framebuffer_object = glad_glGenFramebuffersEXT && glad_glDeleteFramebuffersEXT &&
+        glad_glBindFramebufferEXT && glad_glCheckFramebufferStatusEXT && glad_glFramebufferTexture2DEXT;
+  }
+#endif
+  return true;
+}
+
+bool OGL3GraphicsDriver::FirstTimeInit()
+{
+  if (!OGLGraphicsDriver::FirstTimeInit())
+    return false;
+  // Non power of two textures are in the core of all the supported versions
+  _glCapsNonPowerOfTwo = true;
+
+  // Corners of the unit quad, as a triangle strip;
+  // the vertex shader places them at the corners of each quad instance
+  static const float corners[] = { 0.f, 0.f,  1.f, 0.f,  0.f, 1.f,  1.f, 1.f };
+  _gl.GenVertexArrays(1, &_cornerVao);
+  _gl.BindVertexArray(_cornerVao);
+  glGenBuffers(1, &_cornerVbo);
+  glBindBuffer(GL_ARRAY_BUFFER, _cornerVbo);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+  _gl.BindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  glGenBuffers(1, &_quadUbo);
+  _quads.reserve(MaxBatchQuads);
+  return true;
+}
+
+
+// Reads the quad instance's data from the uniform buffer, and places the
+// corner of the unit quad at the corresponding corner of the instance.
+
+// Uniforms:
+// Quads - quads of the batch: their transforms, the positions and texture
+//   coordinates of their corners (left-top and right-bottom), and the texture
+//   array layers.
+
+static const auto quad_vertex_shader_src = ""
+#if AGS_OPENGL_ES2
+"#version 300 es \n"
+#else
+"#version 330 core \n"
+#endif
+R"EOS(
+layout(location = 0) in vec2 a_Corner;
+
+struct Quad
+{
+  mat4 Transform;
+  vec4 Position;
+  vec4 TexCoord;
+  vec4 Layer;
+};
+
+layout(std140) uniform Quads
+{
+  Quad u_Quads[128];
+};
+
+out vec2 v_TexCoord;
+flat out float v_Layer;
+
+void main() {
+  Quad q = u_Quads[gl_InstanceID];
+  v_TexCoord = mix(q.TexCoord.xy, q.TexCoord.zw, a_Corner);
+  v_Layer = q.Layer.x;
+  gl_Position = q.Transform * vec4(mix(q.Position.xy, q.Position.zw, a_Corner), 0.0, 1.0);
+}
+
+)EOS";
+
+
+// Header of the fragment shaders; the shaders read the texture with SAMPLE,
+// which is defined for either the 2D texture or the texture array.
+static const auto fragment_shader_version_src = ""
+#if AGS_OPENGL_ES2
+"#version 300 es \n"
+"precision mediump float; \n"
+"precision mediump sampler2DArray; \n"
+#else
+"#version 330 core \n"
+#endif
+;
+
+static const auto fragment_shader_header_src = R"EOS(
+#ifdef TEXTURE_ARRAY
+uniform sampler2DArray textID;
+#define SAMPLE(uv) texture(textID, vec3(uv, v_Layer))
+#else
+uniform sampler2D textID;
+#define SAMPLE(uv) texture(textID, uv)
+#endif
+
+in vec2 v_TexCoord;
+flat in float v_Layer;
+out vec4 fragColor;
+)EOS";
+
+
+// The fragment shaders below do the same as the ones of the OpenGL driver,
+// see the uniforms description there.
+
+static const auto transparency_fragment_shader_src = R"EOS(
+uniform float alpha;
+
+void main()
+{
+  vec4 src_col = SAMPLE(v_TexCoord);
+  fragColor = vec4(src_col.xyz, src_col.w * alpha);
+}
+)EOS";
+
+
+static const auto tint_fragment_shader_src = R"EOS(
+uniform vec3 tintHSV;
+uniform float tintAmount;
+uniform float tintLuminance;
+uniform float alpha;
+
+vec3 rgb2hsv(vec3 c)
+{
+    vec4 K = vec4(0.0, -1.0 / 3.0, 2.0 / 3.0, -1.0);
+    vec4 p = mix(vec4(c.bg, K.wz), vec4(c.gb, K.xy), step(c.b, c.g));
+    vec4 q = mix(vec4(p.xyw, c.r), vec4(c.r, p.yzx), step(p.x, c.r));
+
+    float d = q.x - min(q.w, q.y);
+    const float e = 1.0e-10;
+    return vec3(abs(q.z + (q.w - q.y) / (6.0 * d + e)), d / (q.x + e), q.x);
+}
+
+vec3 hsv2rgb(vec3 c)
+{
+    vec4 K = vec4(1.0, 2.0 / 3.0, 1.0 / 3.0, 3.0);
+    vec3 p = abs(fract(c.xxx + K.xyz) * 6.0 - K.www);
+    return c.z * mix(K.xxx, clamp(p - K.xxx, 0.0, 1.0), c.y);
+}
+
+float getValue(vec3 color)
+{
+    float colorMax = max (color[0], color[1]);
+    colorMax = max (colorMax, color[2]);
+    return colorMax;
+}
+
+void main()
+{
+    vec4 src_col = SAMPLE(v_TexCoord);
+
+    float lum = getValue(src_col.xyz);
+    lum = max(lum - (1.0 - tintLuminance), 0.0);
+    vec3 new_col = (hsv2rgb(vec3(tintHSV[0], tintHSV[1], lum)) * tintAmount + src_col.xyz * (1.0 - tintAmount));
+    fragColor = vec4(new_col, src_col.w * alpha);
+}
+)EOS";
+
+
+static const auto light_fragment_shader_src = R"EOS(
+uniform float light;
+uniform float alpha;
+
+void main()
+{
+    vec4 src_col = SAMPLE(v_TexCoord);
+
+    if (light >= 0.0)
+        fragColor = vec4(src_col.xyz + vec3(light, light, light), src_col.w * alpha);
+    else
+        fragColor = vec4(src_col.xyz * abs(light), src_col.w * alpha);
+}
+)EOS";
+
+
+static const auto yuv_fragment_shader_src = R"EOS(
+uniform vec4 yRange;
+uniform vec4 chromaRange;
+uniform vec4 chromaOrigin;
+uniform float alpha;
+
+void main()
+{
+    // clamping keeps the linear filter from blending the neighbouring planes
+    vec2 y_coord = clamp(v_TexCoord, yRange.xy, yRange.zw);
+    vec2 c_coord = clamp(v_TexCoord * 0.5, chromaRange.xy, chromaRange.zw);
+    float y = 1.164 * (SAMPLE(y_coord).r - 0.0625);
+    float u = SAMPLE(chromaOrigin.xy + c_coord).r - 0.5;
+    float v = SAMPLE(chromaOrigin.zw + c_coord).r - 0.5;
+    fragColor = vec4(y + 1.596 * v, y - 0.391 * u - 0.813 * v, y + 2.018 * u, alpha);
+}
+)EOS";
+
+
+static const auto alphatest_fragment_shader_src = R"EOS(
+uniform float threshold;
+
+void main()
+{
+    vec4 src_col = SAMPLE(v_TexCoord);
+    if (src_col.w * 255.0 + 0.5 < threshold)
+        discard;
+    fragColor = vec4(src_col.xyz, 1.0);
+}
+)EOS";
+
+
+bool OGL3GraphicsDriver::CreateQuadShader(ShaderProgram &prg, const char *name,
+    const char *fragment_shader_src, bool texture_array)
+{
+  const String prg_name = String::FromFormat("%s%s", name, texture_array ? "Array" : "");
+  const String fragment_src = String::FromFormat("%s%s%s%s", fragment_shader_version_src,
+    texture_array ? "#define TEXTURE_ARRAY\n" : "", fragment_shader_header_src, fragment_shader_src);
+  if (!CreateShaderProgram(prg, prg_name.GetCStr(), quad_vertex_shader_src, fragment_src.GetCStr()))
+    return false;
+
+  // The quads are read from the uniform buffer bound at the index 0
+  const GLuint quads_block = _gl.GetUniformBlockIndex(prg.Program, "Quads");
+  if (quads_block == GL_INVALID_INDEX)
+  {
+    Debug::Printf(kDbgMsg_Error, "ERROR: OpenGL: %s program has no quads uniform block", prg_name.GetCStr());
+    DeleteShaderProgram(prg);
+    return false;
+  }
+  _gl.UniformBlockBinding(prg.Program, quads_block, 0);
+
+  prg.TextureId = glGetUniformLocation(prg.Program, "textID");
+  prg.Alpha = glGetUniformLocation(prg.Program, "alpha");
+  prg.TintHSV = glGetUniformLocation(prg.Program, "tintHSV");
+  prg.TintAmount = glGetUniformLocation(prg.Program, "tintAmount");
+  prg.TintLuminance = glGetUniformLocation(prg.Program, "tintLuminance");
+  prg.LightingAmount = glGetUniformLocation(prg.Program, "light");
+  return true;
+}
+
+bool OGL3GraphicsDriver::CreateShaderPrograms()
+{
+  bool shaders_created = true;
+  shaders_created &= CreateQuadShader(_transparencyShader, "Transparency", transparency_fragment_shader_src, false);
+  shaders_created &= CreateQuadShader(_transparencyArrayShader, "Transparency", transparency_fragment_shader_src, true);
+  shaders_created &= CreateQuadShader(_tintShader, "Tinting", tint_fragment_shader_src, false);
+  shaders_created &= CreateQuadShader(_tintArrayShader, "Tinting", tint_fragment_shader_src, true);
+  shaders_created &= CreateQuadShader(_lightShader, "Lighting", light_fragment_shader_src, false);
+  shaders_created &= CreateQuadShader(_lightArrayShader, "Lighting", light_fragment_shader_src, true);
+  // YUV shader is optional: without it the video decoder converts frames to RGB;
+  // the YUV frames are never placed on the atlas, so there's no array variant
+  if (CreateQuadShader(_yuvShader, "YUV", yuv_fragment_shader_src, false))
+  {
+    _yuvShader.Arg[0] = glGetUniformLocation(_yuvShader.Program, "yRange");
+    _yuvShader.Arg[1] = glGetUniformLocation(_yuvShader.Program, "chromaRange");
+    _yuvShader.Arg[2] = glGetUniformLocation(_yuvShader.Program, "chromaOrigin");
+  }
+  // Alpha test shader is optional: without it the dissolve transition is done on CPU
+  if (CreateQuadShader(_alphaTestShader, "AlphaTest", alphatest_fragment_shader_src, false) &&
+      CreateQuadShader(_alphaTestArrayShader, "AlphaTest", alphatest_fragment_shader_src, true))
+  {
+    _alphaTestShader.Arg[0] = glGetUniformLocation(_alphaTestShader.Program, "threshold");
+    _alphaTestArrayShader.Arg[0] = glGetUniformLocation(_alphaTestArrayShader.Program, "threshold");
+  }
+  else
+  {
+    DeleteShaderProgram(_alphaTestShader);
+    DeleteShaderProgram(_alphaTestArrayShader);
+  }
+  return shaders_created;
+}
+
+const ShaderProgram &OGL3GraphicsDriver::GetShaderProgram(ShaderKind shader, bool texture_array) const
+{
+  switch (shader)
+  {
+  case kShader_Tint: return texture_array ? _tintArrayShader : _tintShader;
+  case kShader_Light: return texture_array ? _lightArrayShader : _lightShader;
+  case kShader_YUV: return _yuvShader;
+  case kShader_AlphaTest: return texture_array ? _alphaTestArrayShader : _alphaTestShader;
+  default: return texture_array ? _transparencyArrayShader : _transparencyShader;
+  }
+}
+
+std::shared_ptr<OGLTextureAtlas> OGL3GraphicsDriver::CreateTextureAtlas(const Size &page_size, bool compact)
+{
+  return std::make_shared<OGLTextureArrayAtlas>(page_size, AtlasMaxPages, compact, _gl.TexImage3D);
+}
+
+void OGL3GraphicsDriver::UploadTexturePixels(const OGLTextureTile *tile, int x, int y, int width, int height,
+    GLenum format, GLenum type, const uint8_t *pixels, size_t size)
+{
+  if (tile->texLayer < 0)
+  {
+    OGLGraphicsDriver::UploadTexturePixels(tile, x, y, width, height, format, type, pixels, size);
+    return;
+  }
+  glBindTexture(GL_TEXTURE_2D_ARRAY, tile->texture);
+  const void *data = BeginPixelUpload(pixels, size);
+  _gl.TexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, x, y, tile->texLayer, width, height, 1, format, type, data);
+  EndPixelUpload(size);
+}
+
+void OGL3GraphicsDriver::RenderSprite(const OGLDrawListEntry *drawListEntry,
+    const glm::mat4 &projection, const glm::mat4 &matGlobal,
+    const SpriteColorTransform &color, const Size &rend_sz)
+{
+    BatchQuads(drawListEntry->ddb, drawListEntry->x, drawListEntry->y, projection, matGlobal, color, rend_sz);
+}
+
+void OGL3GraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw_y,
+    const glm::mat4 &projection, const glm::mat4 &matGlobal,
+    const SpriteColorTransform &color, const Size &rend_sz)
+{
+    BatchQuads(bmpToDraw, draw_x, draw_y, projection, matGlobal, color, rend_sz);
+    FlushQuadBatch();
+}
+
+void OGL3GraphicsDriver::BatchQuads(OGLBitmap *bmpToDraw, int draw_x, int draw_y,
+    const glm::mat4 &projection, const glm::mat4 &matGlobal,
+    const SpriteColorTransform &color, const Size &rend_sz)
+{
+    InstanceBatchState state;
+    state.Shader = GetSpriteShader(bmpToDraw);
+    state.Alpha = (color.Alpha * bmpToDraw->_alpha) / 255;
+    state.Linear = UseLinearFilter(bmpToDraw);
+    state.RenderHint = bmpToDraw->_renderHint;
+    // Only the parameters used by the shader are set, so that
+    // the rest do not break the batch
+    switch (state.Shader)
+    {
+    case kShader_Tint:
+        state.Red = bmpToDraw->_red;
+        state.Green = bmpToDraw->_green;
+        state.Blue = bmpToDraw->_blue;
+        state.TintSaturation = bmpToDraw->_tintSaturation;
+        state.LightLevel = bmpToDraw->_lightLevel;
+        break;
+    case kShader_Light:
+        state.LightLevel = bmpToDraw->_lightLevel;
+        break;
+    case kShader_YUV:
+        state.YUVFrame = bmpToDraw->_data.get();
+        break;
+    case kShader_AlphaTest:
+        state.AlphaTest = bmpToDraw->_alphaTest;
+        break;
+    default: break;
+    }
+
+    const auto *txdata = bmpToDraw->_data.get();
+    for (size_t ti = 0; ti < txdata->_numTiles; ++ti)
+    {
+        const OGLTextureTile &tile = txdata->_tiles[ti];
+        state.Texture = tile.texture;
+        state.Layered = tile.texLayer >= 0;
+        if (!_quads.empty() && (!(state == _instanceBatch) || (_quads.size() == MaxBatchQuads)))
+            FlushQuadBatch();
+        _instanceBatch = state;
+
+        // The quad is a rectangle, so only its opposite corners are passed
+        const OGLCUSTOMVERTEX *vertices = (txdata->_vertex != nullptr) ? &txdata->_vertex[ti * 4] : defaultVertices;
+        QuadInstance quad;
+        quad.Transform = GetTileTransform(bmpToDraw, ti, draw_x, draw_y, projection, matGlobal, rend_sz);
+        quad.Position = glm::vec4(vertices[0].position.x, vertices[0].position.y, vertices[3].position.x, vertices[3].position.y);
+        quad.TexCoord = glm::vec4(vertices[0].tu, vertices[0].tv, vertices[3].tu, vertices[3].tv);
+        quad.Layer = glm::vec4(static_cast<float>(std::max(0, tile.texLayer)), 0.f, 0.f, 0.f);
+        _quads.push_back(quad);
+    }
+    _renderStats.Sprites++;
+}
+
+void OGL3GraphicsDriver::SetQuadTextureFilter(GLenum target, bool linear)
+{
+    const GLint filter = linear ? GL_LINEAR : _currentBackbuffer->Filter;
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, filter);
+    // GL_CLAMP is not supported by the core profile;
+    // with the nearest filter it's same as GL_CLAMP_TO_EDGE
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void OGL3GraphicsDriver::FlushQuadBatch()
+{
+    if (_quads.empty())
+        return;
+
+    const InstanceBatchState &state = _instanceBatch;
+    const ShaderProgram &program = GetShaderProgram(state.Shader, state.Layered);
+    glUseProgram(program.Program);
+    glUniform1i(program.TextureId, 0);
+    glUniform1f(program.Alpha, state.Alpha / 255.0f);
+    switch (state.Shader)
+    {
+    case kShader_Tint:
+        SetTintShaderArgs(program, state.Red, state.Green, state.Blue, state.TintSaturation, state.LightLevel);
+        break;
+    case kShader_Light:
+        SetLightShaderArgs(program, state.LightLevel);
+        break;
+    case kShader_YUV:
+        SetYUVShaderArgs(program, state.YUVFrame);
+        break;
+    case kShader_AlphaTest:
+        glUniform1f(program.Arg[0], static_cast<float>(state.AlphaTest));
+        break;
+    default: break;
+    }
+
+    const GLenum target = state.Layered ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(target, state.Texture);
+    SetQuadTextureFilter(target, state.Linear);
+
+    // Re-specifying the whole buffer lets the driver allocate a new storage
+    // instead of waiting for the previous draw to complete
+    glBindBuffer(GL_UNIFORM_BUFFER, _quadUbo);
+    glBufferData(GL_UNIFORM_BUFFER, MaxBatchQuads * sizeof(QuadInstance), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, _quads.size() * sizeof(QuadInstance), _quads.data());
+    _gl.BindBufferBase(GL_UNIFORM_BUFFER, 0, _quadUbo);
+
+    // Treat special render modes
+    switch (state.RenderHint)
+    {
+    case kTxHint_PremulAlpha:
+        glBlendColor(state.Alpha / 255.0f, state.Alpha / 255.0f, state.Alpha / 255.0f, 1.0);
+        SetBlendOpRGB(GL_FUNC_ADD, GL_CONSTANT_COLOR, GL_ONE_MINUS_SRC_ALPHA);
+        break;
+    default: break;
+    }
+
+    _gl.BindVertexArray(_cornerVao);
+    _gl.DrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(_quads.size()));
+    _renderStats.DrawCalls++;
+
+    // Restore default blending mode
+    SetBlendOpRGB(GL_FUNC_ADD, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    _gl.BindVertexArray(0);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindTexture(target, 0);
+    glUseProgram(0);
+    _quads.clear();
+}
+
+
+OGL3GraphicsFactory *OGL3GraphicsFactory::_factory = nullptr;
+
+OGL3GraphicsFactory::~OGL3GraphicsFactory()
+{
+    _factory = nullptr;
+}
+
+size_t OGL3GraphicsFactory::GetFilterCount() const
+{
+    return 2;
+}
+
+const GfxFilterInfo *OGL3GraphicsFactory::GetFilterInfo(size_t index) const
+{
+    switch (index)
+    {
+    case 0:
+        return &OGLGfxFilter::FilterInfo;
+    case 1:
+        return &AAOGLGfxFilter::FilterInfo;
+    default:
+        return nullptr;
+    }
+}
+
+String OGL3GraphicsFactory::GetDefaultFilterID() const
+{
+    return OGLGfxFilter::FilterInfo.Id;
+}
+
+/* static */ OGL3GraphicsFactory *OGL3GraphicsFactory::GetFactory()
+{
+    if (!_factory)
+        _factory = new OGL3GraphicsFactory();
+    return _factory;
+}
+
+OGL3GraphicsDriver *OGL3GraphicsFactory::EnsureDriverCreated()
+{
+    if (!_driver)
+        _driver = new OGL3GraphicsDriver();
+    return _driver;
+}
+
+OGLGfxFilter *OGL3GraphicsFactory::CreateFilter(const String &id)
+{
+    if (OGLGfxFilter::FilterInfo.Id.CompareNoCase(id) == 0)
+        return new OGLGfxFilter();
+    else if (AAOGLGfxFilter::FilterInfo.Id.CompareNoCase(id) == 0)
+        return new AAOGLGfxFilter();
+    return nullptr;
+}
+
+} // namespace OGL
+} // namespace Engine
+} // namespace AGS
+
+#endif // AGS_HAS_OPENGL
@@ -0,0 +1,207 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// OpenGL 3.3 core / OpenGL ES 3.0 graphics factory.
+//
+// Draws the sprites as instanced quads: the transforms and texture coordinates
+// of the quads are passed in a uniform buffer, and a batch of the quads with
+// the same render state is drawn with one call, whichever shader it uses.
+// The texture atlas pages are the layers of a single texture array, so that
+// the sprites placed on any of these may be drawn together.
+// If these GL versions are not supported, the engine falls back to the
+// OpenGL 2.1 / ES 2.0 driver.
+//
+//=============================================================================
+
+#ifndef __AGS_EE_GFX__ALI3DOGL3_H
+#define __AGS_EE_GFX__ALI3DOGL3_H
+
+#include "gfx/ali3dogl.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace OGL
+{
+
+// GL 3 functions, which are not in the generated GL 2.1 / GLES 2 loaders
+typedef void (APIENTRYP AGS_PFNGLGENVERTEXARRAYSPROC)(GLsizei n, GLuint *arrays);
+typedef void (APIENTRYP AGS_PFNGLDELETEVERTEXARRAYSPROC)(GLsizei n, const GLuint *arrays);
+typedef void (APIENTRYP AGS_PFNGLBINDVERTEXARRAYPROC)(GLuint array);
+typedef void (APIENTRYP AGS_PFNGLDRAWARRAYSINSTANCEDPROC)(GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
+typedef GLuint (APIENTRYP AGS_PFNGLGETUNIFORMBLOCKINDEXPROC)(GLuint program, const GLchar *uniformBlockName);
+typedef void (APIENTRYP AGS_PFNGLUNIFORMBLOCKBINDINGPROC)(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+typedef void (APIENTRYP AGS_PFNGLBINDBUFFERBASEPROC)(GLenum target, GLuint index, GLuint buffer);
+typedef void (APIENTRYP AGS_PFNGLTEXIMAGE3DPROC)(GLenum target, GLint level, GLint internalformat,
+    GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void *pixels);
+typedef void (APIENTRYP AGS_PFNGLTEXSUBIMAGE3DPROC)(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset,
+    GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void *pixels);
+
+struct GL3Functions
+{
+    AGS_PFNGLGENVERTEXARRAYSPROC GenVertexArrays = nullptr;
+    AGS_PFNGLDELETEVERTEXARRAYSPROC DeleteVertexArrays = nullptr;
+    AGS_PFNGLBINDVERTEXARRAYPROC BindVertexArray = nullptr;
+    AGS_PFNGLDRAWARRAYSINSTANCEDPROC DrawArraysInstanced = nullptr;
+    AGS_PFNGLGETUNIFORMBLOCKINDEXPROC GetUniformBlockIndex = nullptr;
+    AGS_PFNGLUNIFORMBLOCKBINDINGPROC UniformBlockBinding = nullptr;
+    AGS_PFNGLBINDBUFFERBASEPROC BindBufferBase = nullptr;
+    AGS_PFNGLTEXIMAGE3DPROC TexImage3D = nullptr;
+    AGS_PFNGLTEXSUBIMAGE3DPROC TexSubImage3D = nullptr;
+
+    // Loads the functions for the current context, returns false if any is missing
+    bool Load();
+};
+
+// Texture atlas which pages are the layers of a single texture array
+class OGLTextureArrayAtlas : public OGLTextureAtlas
+{
+public:
+    OGLTextureArrayAtlas(const Size &page_size, size_t max_pages, bool compact,
+        AGS_PFNGLTEXIMAGE3DPROC tex_image_3d);
+
+    // All the pages are in the same texture, and may be drawn together
+    const void *GetPageKey(int /*page*/) const override { return this; }
+
+protected:
+    unsigned int CreatePageTexture(size_t page, int &layer) override;
+
+private:
+    const size_t _maxPages;
+    AGS_PFNGLTEXIMAGE3DPROC _texImage3D;
+    unsigned int _texture = 0u;
+};
+
+
+class OGL3GraphicsDriver : public OGLGraphicsDriver
+{
+public:
+    const char *GetDriverID() override { return "OGL3"; }
+    const char *GetDriverName() override { return "OpenGL 3"; }
+
+    OGL3GraphicsDriver();
+    ~OGL3GraphicsDriver() override;
+
+protected:
+    bool FirstTimeInit() override;
+    void SetContextAttributes() override;
+    bool LoadGlFunctions() override;
+    bool CreateShaderPrograms() override;
+    std::shared_ptr<OGLTextureAtlas> CreateTextureAtlas(const Size &page_size, bool compact) override;
+    void UploadTexturePixels(const OGLTextureTile *tile, int x, int y, int width, int height,
+        GLenum format, GLenum type, const uint8_t *pixels, size_t size) override;
+    // Adds the sprite to the instanced quad batch
+    void RenderSprite(const OGLDrawListEntry *entry, const glm::mat4 &projection, const glm::mat4 &matGlobal,
+        const SpriteColorTransform &color, const Size &rend_sz) override;
+    // Renders given texture onto the current render target, without waiting
+    // for the other sprites
+    void RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw_y,
+        const glm::mat4 &projection, const glm::mat4 &matGlobal,
+        const SpriteColorTransform &color, const Size &rend_sz) override;
+    // Draws all the batched quads with a single instanced call, and clears the batch
+    void FlushQuadBatch() override;
+
+private:
+    // Quad's data in the uniform buffer, laid out by the std140 rules
+    struct QuadInstance
+    {
+        glm::mat4 Transform;
+        glm::vec4 Position; // left-top and right-bottom corners
+        glm::vec4 TexCoord; // left-top and right-bottom texture coordinates
+        glm::vec4 Layer;    // texture array layer, in x
+    };
+    // Max quads drawn by one call; the uniform buffer's size must fit in
+    // the min GL_MAX_UNIFORM_BLOCK_SIZE, which is 16 KB
+    static const size_t MaxBatchQuads = 128u;
+
+    // Render state shared by all the quads in the batch
+    struct InstanceBatchState
+    {
+        GLuint Texture = 0u;
+        bool Layered = false; // texture is a texture array
+        ShaderKind Shader = kShader_Transparency;
+        bool Linear = false;
+        int Alpha = 0;
+        TextureHint RenderHint = kTxHint_Normal;
+        // Parameters of the shader, which are not per quad
+        int Red = 0, Green = 0, Blue = 0, TintSaturation = 0;
+        int LightLevel = 0;
+        int AlphaTest = 0;
+        const OGLTexture *YUVFrame = nullptr;
+
+        bool operator ==(const InstanceBatchState &other) const
+        {
+            return Texture == other.Texture && Layered == other.Layered &&
+                Shader == other.Shader && Linear == other.Linear &&
+                Alpha == other.Alpha && RenderHint == other.RenderHint &&
+                Red == other.Red && Green == other.Green && Blue == other.Blue &&
+                TintSaturation == other.TintSaturation && LightLevel == other.LightLevel &&
+                AlphaTest == other.AlphaTest && YUVFrame == other.YUVFrame;
+        }
+    };
+
+    // Creates the quad shader program, for the 2D textures or texture arrays
+    bool CreateQuadShader(ShaderProgram &prg, const char *name, const char *fragment_shader_src, bool texture_array);
+    // Gets the shader program of the given kind
+    const ShaderProgram &GetShaderProgram(ShaderKind shader, bool texture_array) const;
+    // Adds the texture's tiles to the quad batch, flushing the batch first
+    // if the render state differs from the batched one, or the batch is full
+    void BatchQuads(OGLBitmap *bmpToDraw, int draw_x, int draw_y,
+        const glm::mat4 &projection, const glm::mat4 &matGlobal,
+        const SpriteColorTransform &color, const Size &rend_sz);
+    // Sets the filtering parameters of the currently bound texture
+    void SetQuadTextureFilter(GLenum target, bool linear);
+
+    GL3Functions _gl;
+    // Shader programs for the texture arrays; the ones for the 2D textures
+    // are the base driver's
+    ShaderProgram _transparencyArrayShader;
+    ShaderProgram _tintArrayShader;
+    ShaderProgram _lightArrayShader;
+    ShaderProgram _alphaTestArrayShader;
+    // Vertex array of the unit quad's corners, shared by all the instances
+    GLuint _cornerVao = 0u;
+    GLuint _cornerVbo = 0u;
+    // Uniform buffer for the batched quads
+    GLuint _quadUbo = 0u;
+    InstanceBatchState _instanceBatch;
+    std::vector<QuadInstance> _quads;
+};
+
+
+class OGL3GraphicsFactory : public GfxDriverFactoryBase<OGL3GraphicsDriver, OGLGfxFilter>
+{
+public:
+    ~OGL3GraphicsFactory() override;
+
+    size_t               GetFilterCount() const override;
+    const GfxFilterInfo *GetFilterInfo(size_t index) const override;
+    String               GetDefaultFilterID() const override;
+
+    static OGL3GraphicsFactory  *GetFactory();
+
+private:
+    OGL3GraphicsDriver  *EnsureDriverCreated() override;
+    OGLGfxFilter        *CreateFilter(const String &id) override;
+
+    static OGL3GraphicsFactory *_factory;
+};
+
+} // namespace OGL
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__ALI3DOGL3_H
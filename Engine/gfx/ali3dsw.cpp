@@ -13,13 +13,16 @@
 //=============================================================================
 #include "gfx/ali3dsw.h"
 #include <algorithm>
+#include <functional>
 #include <stack>
 #include "ac/sys_events.h"
 #include "gfx/ali3dexception.h"
+#include "gfx/blender.h"
 #include "gfx/gfxfilter_sdl_renderer.h"
 #include "gfx/gfx_util.h"
 #include "platform/base/agsplatformdriver.h"
 #include "platform/base/sys_main.h"
+#include "util/jobscheduler.h"
 #include "ac/timer.h"
 
 namespace AGS
@@ -31,7 +34,19 @@ namespace ALSW
 
 using namespace Common;
 
-static uint32_t _trans_alpha_blender32(uint32_t x, uint32_t y, uint32_t n);
+extern "C" {
+    // Standard Allegro 4 trans and alpha blenders for 32-bit color mode
+    uint32_t _blender_trans24(uint32_t x, uint32_t y, uint32_t n);
+    uint32_t _blender_alpha32(uint32_t x, uint32_t y, uint32_t n);
+}
+
+
+// Max number of threads chosen automatically
+static const size_t MaxAutoRenderThreads = 4u;
+// Min height of a surface band, in pixels
+static const int MinRenderBandHeight = 32;
+// Min number of pixels in the sprites to make running them in bands worth it
+static const size_t MinBandRunPixels = 64 * 1024;
 
 
 // ----------------------------------------------------------------------------
@@ -127,6 +142,19 @@ bool SDLRendererGraphicsDriver::SetDisplayMode(const DisplayMode &mode)
 
   _capsVsync = true; // reset vsync flag, allow to try setting again
 
+  InitWindow(mode);
+
+#if AGS_PLATFORM_MOBILE
+  SDL_RenderSetLogicalSize(_renderer,mode.Width,mode.Height);
+#endif
+
+  OnInit();
+  OnModeSet(mode);
+  return true;
+}
+
+void SDLRendererGraphicsDriver::InitWindow(const DisplayMode &mode)
+{
   SDL_Window *window = sys_get_window();
   if (!window)
   {
@@ -162,14 +190,6 @@ bool SDLRendererGraphicsDriver::SetDisplayMode(const DisplayMode &mode)
   {
     sys_window_set_style(mode.Mode, Size(mode.Width, mode.Height));
   }
-
-#if AGS_PLATFORM_MOBILE
-  SDL_RenderSetLogicalSize(_renderer,mode.Width,mode.Height);
-#endif
-
-  OnInit();
-  OnModeSet(mode);
-  return true;
 }
 
 void SDLRendererGraphicsDriver::UpdateDeviceScreen(const Size &screen_sz)
@@ -264,6 +284,15 @@ SDLRendererGraphicsDriver::~SDLRendererGraphicsDriver()
   SDLRendererGraphicsDriver::UnInit();
 }
 
+void SDLRendererGraphicsDriver::SetRenderThreadCount(int count)
+{
+  const size_t thread_count = JobScheduler::ResolveThreadCount(count, MaxAutoRenderThreads);
+  if (_bandCount == thread_count)
+    return;
+  _bandCount = thread_count;
+  Debug::Printf("Software renderer: compositing with %zu thread(s)", thread_count);
+}
+
 void SDLRendererGraphicsDriver::UnInit()
 {
   OnUnInit();
@@ -560,6 +589,16 @@ size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch,
 {
   for (; (from < _spriteList.size()) && (_spriteList[from].node == batch.ID); ++from)
   {
+    if (_bandCount > 1u)
+    {
+      const size_t run_end = RenderSpriteRunInBands(batch, from, surface, surf_offx, surf_offy);
+      if (run_end > from)
+      {
+        from = run_end - 1;
+        continue;
+      }
+    }
+
     const auto &sprite = _spriteList[from];
     if (sprite.ddb == nullptr)
     {
@@ -599,7 +638,7 @@ size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch,
       else
         set_blender_mode(nullptr, nullptr, _trans_alpha_blender32, 0, 0, 0, bitmap->_alpha);
 
-      surface->TransBlendBlt(bitmap->_bmp, drawAtX, drawAtY);
+      draw_trans_sprite32(surface->GetAllegroBitmap(), bitmap->_bmp->GetAllegroBitmap(), drawAtX, drawAtY);
     }
     else
     {
@@ -611,6 +650,106 @@ size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch,
   return from;
 }
 
+size_t SDLRendererGraphicsDriver::RenderSpriteRunInBands(const ALSpriteBatch &batch, size_t from,
+    Bitmap *surface, int surf_offx, int surf_offy)
+{
+  BITMAP *al_surf = surface->GetAllegroBitmap();
+  if ((surface->GetColorDepth() != 32) || !al_surf->clip)
+    return from;
+
+  // Gather the sprites which are drawn same as RenderSpriteBatch does,
+  // but without touching the global blender or the whole surface
+  _bandOps.clear();
+  size_t run_pixels = 0u;
+  size_t end = from;
+  for (; (end < _spriteList.size()) && (_spriteList[end].node == batch.ID); ++end)
+  {
+    const auto &sprite = _spriteList[end];
+    ALSoftwareBitmap *bitmap = sprite.ddb;
+    if ((bitmap == nullptr) || (bitmap == reinterpret_cast<ALSoftwareBitmap*>(DRAWENTRY_TINT)))
+      break; // callbacks and tint work with the whole surface
+    if (bitmap->_alpha == 0)
+      continue; // fully transparent, do nothing
+    if ((bitmap->_opaque) && (bitmap->_bmp == surface) && (bitmap->_alpha == 255))
+      continue;
+    if ((bitmap->_bmp == surface) || (bitmap->_bmp->GetColorDepth() != 32))
+      break;
+
+    BandDrawOp op;
+    if (bitmap->_opaque)
+    {
+      op.Type = BandDrawOp::kBlit;
+    }
+    else if (bitmap->_hasAlpha)
+    {
+      op.Type = BandDrawOp::kBlend;
+      op.Blender = (bitmap->_alpha == 255) ? _blender_alpha32 : _trans_alpha_blender32;
+    }
+    else if (bitmap->_alpha < 255)
+    {
+      // same as GfxUtil::DrawSpriteWithTransparency does
+      op.Type = BandDrawOp::kBlend;
+      op.Blender = _blender_trans24;
+    }
+    else
+    {
+      op.Type = BandDrawOp::kMaskedBlit;
+    }
+    op.Alpha = bitmap->_alpha;
+    op.Bmp = bitmap->_bmp;
+    op.X = sprite.x + surf_offx;
+    op.Y = sprite.y + surf_offy;
+    _bandOps.push_back(op);
+    run_pixels += op.Bmp->GetWidth() * op.Bmp->GetHeight();
+  }
+
+  const auto draw_ops = [this](BITMAP *dst, int off_y)
+  {
+    for (const auto &op : _bandOps)
+    {
+      BITMAP *src = op.Bmp->GetAllegroBitmap();
+      switch (op.Type)
+      {
+      case BandDrawOp::kBlit:
+        blit(src, dst, 0, 0, op.X, op.Y - off_y, src->w, src->h);
+        break;
+      case BandDrawOp::kMaskedBlit:
+        masked_blit(src, dst, 0, 0, op.X, op.Y - off_y, src->w, src->h);
+        break;
+      case BandDrawOp::kBlend:
+        draw_trans_sprite32(dst, src, op.X, op.Y - off_y, op.Blender, op.Alpha);
+        break;
+      }
+    }
+  };
+
+  // Split the clipped rows of surface into bands, if the run is large enough
+  const int clip_top = al_surf->ct;
+  const int clip_height = al_surf->cb - al_surf->ct;
+  const size_t band_count = (run_pixels < MinBandRunPixels) ? 1u :
+    std::min<size_t>(_bandCount, std::max(0, clip_height / MinRenderBandHeight));
+  if (band_count < 2u)
+  {
+    draw_ops(al_surf, 0);
+    return end;
+  }
+
+  // Each band is a sub-bitmap with its own clipping, sharing the surface pixels
+  const auto band_top = [clip_top, clip_height, band_count](size_t band)
+    { return clip_top + static_cast<int>(clip_height * band / band_count); };
+  _bandSurfaces.resize(band_count);
+  for (size_t band = 0; band < band_count; ++band)
+  {
+    const int top = band_top(band), height = band_top(band + 1) - top;
+    _bandSurfaces[band].reset(BitmapHelper::CreateSubBitmap(surface, RectWH(0, top, al_surf->w, height)));
+    _bandSurfaces[band]->SetClip(Rect(al_surf->cl, 0, al_surf->cr - 1, height - 1));
+  }
+  JobScheduler::Global().ParallelFor("Render band", band_count, [this, &draw_ops, &band_top](size_t band)
+    { draw_ops(_bandSurfaces[band]->GetAllegroBitmap(), band_top(band)); });
+  _bandSurfaces.clear();
+  return end;
+}
+
 void SDLRendererGraphicsDriver::BlitToTexture()
 {
     void *pixels = nullptr;
@@ -767,28 +906,6 @@ bool SDLRendererGraphicsDriver::GetCopyOfScreenIntoBitmap(Bitmap *destination, c
   return true;
 }
 
-// add the alpha values together, used for compositing alpha images
-// TODO: why is this here, move to gfx/blender? check if there's already similar function there
-static uint32_t _trans_alpha_blender32(uint32_t x, uint32_t y, uint32_t n)
-{
-   uint32_t res, g;
-
-   n = (n * geta32(x)) / 256;
-
-   if (n)
-      n++;
-
-   res = ((x & 0xFF00FF) - (y & 0xFF00FF)) * n / 256 + y;
-   y &= 0xFF00;
-   x &= 0xFF00;
-   g = (x - y) * n / 256 + y;
-
-   res &= 0xFF00FF;
-   g &= 0xFF00;
-
-   return res | g;
-}
-
 bool SDLRendererGraphicsDriver::SetVsyncImpl(bool enabled, bool &vsync_res)
 {
     #if SDL_VERSION_ATLEAST(2, 0, 18)
@@ -855,6 +972,56 @@ SDLRendererGfxFilter *SDLRendererGraphicsFactory::CreateFilter(const String &id)
     return nullptr;
 }
 
+
+void NullGraphicsDriver::InitWindow(const DisplayMode & /*mode*/)
+{
+  // No window and no SDL renderer, the frames are never presented
+  _capsVsync = false;
+}
+
+NullGraphicsFactory *NullGraphicsFactory::_factory = nullptr;
+
+NullGraphicsFactory::~NullGraphicsFactory()
+{
+    _factory = nullptr;
+}
+
+size_t NullGraphicsFactory::GetFilterCount() const
+{
+    return 1;
+}
+
+const GfxFilterInfo *NullGraphicsFactory::GetFilterInfo(size_t index) const
+{
+    return index == 0 ? &SDLRendererGfxFilter::FilterInfo : nullptr;
+}
+
+String NullGraphicsFactory::GetDefaultFilterID() const
+{
+    return SDLRendererGfxFilter::FilterInfo.Id;
+}
+
+/* static */ NullGraphicsFactory *NullGraphicsFactory::GetFactory()
+{
+    if (!_factory)
+        _factory = new NullGraphicsFactory();
+    return _factory;
+}
+
+NullGraphicsDriver *NullGraphicsFactory::EnsureDriverCreated()
+{
+    if (!_driver)
+        _driver = new NullGraphicsDriver();
+    return _driver;
+}
+
+SDLRendererGfxFilter *NullGraphicsFactory::CreateFilter(const String &id)
+{
+    if (SDLRendererGfxFilter::FilterInfo.Id.CompareNoCase(id) == 0)
+        return new SDLRendererGfxFilter();
+    return nullptr;
+}
+
 } // namespace ALSW
 } // namespace Engine
 } // namespace AGS
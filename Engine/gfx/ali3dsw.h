@@ -24,6 +24,7 @@
 #ifndef __AGS_EE_GFX__ALI3DSW_H
 #define __AGS_EE_GFX__ALI3DSW_H
 #include <memory>
+#include <vector>
 #include <SDL.h>
 #include "core/platform.h"
 #include "gfx/bitmap.h"
@@ -180,6 +181,9 @@ public:
     IDriverDependantBitmap* CreateDDBFromBitmap(const Bitmap *bitmap, bool has_alpha, bool opaque) override;
     IDriverDependantBitmap* CreateRenderTargetDDB(int width, int height, int color_depth, bool opaque) override;
     void UpdateDDBFromBitmap(IDriverDependantBitmap* ddb, const Bitmap *bitmap, bool has_alpha) override;
+    // Software DDB references the bitmap, so there's nothing to copy
+    void UpdateDDBRegion(IDriverDependantBitmap* ddb, const Bitmap *bitmap, bool has_alpha, const Rect&) override
+        { UpdateDDBFromBitmap(ddb, bitmap, has_alpha); }
     void DestroyDDB(IDriverDependantBitmap* ddb) override;
 
     // Create texture data with the given parameters
@@ -188,6 +192,7 @@ public:
     Texture *CreateTexture(const Bitmap*, bool, bool) override { return nullptr; /* not supported */ }
     // Update texture data from the given bitmap
     void UpdateTexture(Texture *txdata, const Bitmap*, bool, bool) override { /* not supported */}
+    void UpdateTextureArea(Texture *txdata, const Bitmap*, bool, bool, const Rect&) override { /* not supported */}
     // Retrieve shared texture object from the given DDB
     std::shared_ptr<Texture> GetTexture(IDriverDependantBitmap *ddb) override { return nullptr; /* not supported */ }
 
@@ -212,6 +217,10 @@ public:
     bool SupportsGammaControl() override ;
     void SetGamma(int newGamma) override;
     void UseSmoothScaling(bool /*enabled*/) override { }
+    void SetTextureAtlas(bool /*enabled*/) override { }
+    void UseStateSorting(bool /*enabled*/) override { }
+    void UseIdleFrameSkip(bool /*enabled*/) override { }
+    void SetRenderThreadCount(int count) override;
     bool DoesSupportVsyncToggle() override { return (SDL_VERSION_ATLEAST(2, 0, 18)) && _capsVsync; }
     void RenderSpritesAtScreenResolution(bool /*enabled*/) override { }
     Bitmap *GetMemoryBackBuffer() override;
@@ -228,6 +237,9 @@ public:
 protected:
     bool SetVsyncImpl(bool vsync, bool &vsync_res) override;
     size_t GetLastDrawEntryIndex() override { return _spriteList.size(); }
+    // Creates the window and the SDL renderer for the display mode,
+    // or updates the existing window
+    virtual void InitWindow(const DisplayMode &mode);
 
 private:
     PSDLRenderFilter _filter;
@@ -262,6 +274,24 @@ private:
     // List of sprites to render
     std::vector<ALDrawListEntry> _spriteList;
 
+    // A sprite drawing operation which may be run on a band of the surface
+    struct BandDrawOp
+    {
+        enum OpType { kBlit, kMaskedBlit, kBlend };
+        OpType Type = kBlit;
+        Bitmap *Bmp = nullptr;
+        int X = 0, Y = 0;
+        uint32_t(*Blender)(uint32_t, uint32_t, uint32_t) = nullptr;
+        uint32_t Alpha = 0u;
+    };
+
+    // Number of horizontal bands the sprites are composited in, in parallel
+    // on the engine's job threads; 1 means composite on the calling thread
+    size_t _bandCount = 1u;
+    // Band drawing operations and band surfaces, reused between the runs
+    std::vector<BandDrawOp> _bandOps;
+    std::vector<std::unique_ptr<Bitmap>> _bandSurfaces;
+
     void InitSpriteBatch(size_t index, const SpriteBatchDesc &desc) override;
     void ResetAllBatches() override;
 
@@ -272,6 +302,10 @@ private:
     void ReleaseDisplayMode();
     // Renders single sprite batch on the precreated surface
     size_t RenderSpriteBatch(const ALSpriteBatch &batch, size_t from, Common::Bitmap *surface, int surf_offx, int surf_offy);
+    // Renders the run of the batch's simple sprites (starting at the given one) which
+    // may be drawn on the surface's horizontal bands in parallel; returns the index
+    // of the first sprite not rendered, which equals "from" if there's no such run
+    size_t RenderSpriteRunInBands(const ALSpriteBatch &batch, size_t from, Common::Bitmap *surface, int surf_offx, int surf_offy);
 
     // Copy raw screen bitmap pixels to the SDL texture
     void BlitToTexture();
@@ -298,6 +332,39 @@ private:
     static SDLRendererGraphicsFactory *_factory;
 };
 
+
+// Null graphics driver, composes the frames in memory same as the software
+// driver, but has no window and never presents them. Meant for running the
+// game headless, e.g. for benchmarking.
+class NullGraphicsDriver : public SDLRendererGraphicsDriver
+{
+public:
+    const char *GetDriverID() override { return "Null"; }
+    const char *GetDriverName() override { return "Null renderer (no output)"; }
+
+protected:
+    void InitWindow(const DisplayMode &mode) override;
+};
+
+
+class NullGraphicsFactory : public GfxDriverFactoryBase<NullGraphicsDriver, SDLRendererGfxFilter>
+{
+public:
+    ~NullGraphicsFactory() override;
+
+    size_t               GetFilterCount() const override;
+    const GfxFilterInfo *GetFilterInfo(size_t index) const override;
+    String               GetDefaultFilterID() const override;
+
+    static NullGraphicsFactory *GetFactory();
+
+private:
+    NullGraphicsDriver   *EnsureDriverCreated() override;
+    SDLRendererGfxFilter *CreateFilter(const String &id) override;
+
+    static NullGraphicsFactory *_factory;
+};
+
 } // namespace ALSW
 } // namespace Engine
 } // namespace AGS
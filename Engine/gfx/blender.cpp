@@ -12,10 +12,25 @@
 //
 //=============================================================================
 #include "gfx/blender.h"
+#include <assert.h>
 #include <allegro.h>
 #include "core/types.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define AGS_BLENDER_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AGS_BLENDER_NEON 1
+#include <arm_neon.h>
+#endif
+
 extern "C" {
+    // Current Allegro 4 blender, used by draw_trans_sprite in 32-bit mode
+    extern BLENDER_FUNC _blender_func32;
+    extern int _blender_alpha;
+    // Standard Allegro 4 trans and alpha blenders for 32-bit color mode
+    uint32_t _blender_trans24(uint32_t x, uint32_t y, uint32_t n);
+    uint32_t _blender_alpha32(uint32_t x, uint32_t y, uint32_t n);
     // Fallback routine for when we don't have anything better to do.
     uint32_t _blender_black(uint32_t x, uint32_t y, uint32_t n);
     // Standard Allegro 4 trans blenders for 16 and 15-bit color modes
@@ -248,6 +263,26 @@ uint32_t _argb2rgb_blender(uint32_t src_col, uint32_t dst_col, uint32_t src_alph
    return res | g;
 }
 
+uint32_t _trans_alpha_blender32(uint32_t x, uint32_t y, uint32_t n)
+{
+   uint32_t res, g;
+
+   n = (n * geta32(x)) / 256;
+
+   if (n)
+      n++;
+
+   res = ((x & 0xFF00FF) - (y & 0xFF00FF)) * n / 256 + y;
+   y &= 0xFF00;
+   x &= 0xFF00;
+   g = (x - y) * n / 256 + y;
+
+   res &= 0xFF00FF;
+   g &= 0xFF00;
+
+   return res | g;
+}
+
 // Based on _blender_alpha16, but keep source pixel if dest is transparent
 uint32_t skiptranspixels_blender_alpha16(uint32_t x, uint32_t y, uint32_t n)
 {
@@ -291,3 +326,336 @@ void set_argb2any_blender()
         _blender_alpha15, skiptranspixels_blender_alpha16, _blender_alpha24,
         0, 0, 0, 0xff); // TODO: do we need to support proper 15- and 24-bit here?
 }
+
+
+//-----------------------------------------------------------------------------
+// Row blending
+//
+// The blend ops below reproduce the 32-bit blenders above exactly, including
+// the unsigned overflows of their intermediate values, but process the whole
+// rows of pixels, several pixels at a time where the CPU supports that.
+// Every op is written once over the "pixel vector" helpers: a plain scalar
+// one, and SSE2 or NEON ones where available.
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+// 0x10000 / a, for the final alpha factors in argb2argb blending
+struct AlphaRecipTable
+{
+    uint32_t Value[257];
+    AlphaRecipTable()
+    {
+        Value[0] = 0x10000; // never used, final alpha is never zero
+        for (uint32_t a = 1; a <= 256; ++a)
+            Value[a] = 0x10000 / a;
+    }
+};
+
+const AlphaRecipTable AlphaRecip;
+
+inline uint32_t alpha_recip(uint32_t a)
+{
+    return a <= 256 ? AlphaRecip.Value[a] : 0x10000 / a;
+}
+
+// Scalar pixel helpers, one pixel at a time
+struct PixScalar
+{
+    typedef uint32_t T;
+    static const int Lanes = 1;
+    static T load(const uint32_t *p) { return *p; }
+    static void store(uint32_t *p, T v) { *p = v; }
+    static T set1(uint32_t v) { return v; }
+    static T add(T a, T b) { return a + b; }
+    static T sub(T a, T b) { return a - b; }
+    static T mul(T a, T b) { return a * b; }
+    static T and_(T a, T b) { return a & b; }
+    static T or_(T a, T b) { return a | b; }
+    static T andnot(T m, T v) { return ~m & v; }
+    static T srl8(T a) { return a >> 8; }
+    static T srl24(T a) { return a >> 24; }
+    static T sll24(T a) { return a << 24; }
+    static T eq(T a, T b) { return a == b ? 0xFFFFFFFF : 0; }
+    static T gt(T a, T b) { return a > b ? 0xFFFFFFFF : 0; }
+    static T select(T m, T a, T b) { return m ? a : b; }
+    static T recip(T a) { return alpha_recip(a); }
+};
+
+#if AGS_BLENDER_SSE2
+// SSE2 pixel helpers, 4 pixels at a time
+struct PixSSE2
+{
+    typedef __m128i T;
+    static const int Lanes = 4;
+    static T load(const uint32_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(uint32_t *p, T v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static T set1(uint32_t v) { return _mm_set1_epi32(static_cast<int>(v)); }
+    static T add(T a, T b) { return _mm_add_epi32(a, b); }
+    static T sub(T a, T b) { return _mm_sub_epi32(a, b); }
+    // SSE2 has no 32-bit low multiplication, so combine two 32x32->64 ones
+    static T mul(T a, T b)
+    {
+        const __m128i even = _mm_mul_epu32(a, b);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+    static T and_(T a, T b) { return _mm_and_si128(a, b); }
+    static T or_(T a, T b) { return _mm_or_si128(a, b); }
+    static T andnot(T m, T v) { return _mm_andnot_si128(m, v); }
+    static T srl8(T a) { return _mm_srli_epi32(a, 8); }
+    static T srl24(T a) { return _mm_srli_epi32(a, 24); }
+    static T sll24(T a) { return _mm_slli_epi32(a, 24); }
+    static T eq(T a, T b) { return _mm_cmpeq_epi32(a, b); }
+    // NOTE: signed comparison, only used for the small values
+    static T gt(T a, T b) { return _mm_cmpgt_epi32(a, b); }
+    static T select(T m, T a, T b) { return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b)); }
+    static T recip(T a)
+    {
+        alignas(16) uint32_t v[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(v), a);
+        return _mm_set_epi32(static_cast<int>(alpha_recip(v[3])), static_cast<int>(alpha_recip(v[2])),
+                             static_cast<int>(alpha_recip(v[1])), static_cast<int>(alpha_recip(v[0])));
+    }
+};
+typedef PixSSE2 PixVector;
+#elif AGS_BLENDER_NEON
+// NEON pixel helpers, 4 pixels at a time
+struct PixNEON
+{
+    typedef uint32x4_t T;
+    static const int Lanes = 4;
+    static T load(const uint32_t *p) { return vld1q_u32(p); }
+    static void store(uint32_t *p, T v) { vst1q_u32(p, v); }
+    static T set1(uint32_t v) { return vdupq_n_u32(v); }
+    static T add(T a, T b) { return vaddq_u32(a, b); }
+    static T sub(T a, T b) { return vsubq_u32(a, b); }
+    static T mul(T a, T b) { return vmulq_u32(a, b); }
+    static T and_(T a, T b) { return vandq_u32(a, b); }
+    static T or_(T a, T b) { return vorrq_u32(a, b); }
+    static T andnot(T m, T v) { return vbicq_u32(v, m); }
+    static T srl8(T a) { return vshrq_n_u32(a, 8); }
+    static T srl24(T a) { return vshrq_n_u32(a, 24); }
+    static T sll24(T a) { return vshlq_n_u32(a, 24); }
+    static T eq(T a, T b) { return vceqq_u32(a, b); }
+    static T gt(T a, T b) { return vcgtq_u32(a, b); }
+    static T select(T m, T a, T b) { return vbslq_u32(m, a, b); }
+    static T recip(T a)
+    {
+        uint32_t v[4];
+        vst1q_u32(v, a);
+        for (int i = 0; i < 4; ++i)
+            v[i] = alpha_recip(v[i]);
+        return vld1q_u32(v);
+    }
+};
+typedef PixNEON PixVector;
+#else
+typedef PixScalar PixVector;
+#endif
+
+// Src alpha multiplier, as used by argb2rgb and argb2argb blenders
+inline uint32_t src_alpha_factor(uint32_t blend_alpha)
+{
+    return blend_alpha > 0 ? (blend_alpha & 0xFF) + 1 : 256;
+}
+
+// Combines src and dst RGB proportionally to the alpha, which is either
+// src alpha multiplied by a factor, or a constant; final alpha is zero,
+// or kept from dst. Covers _blender_alpha32, _blender_trans24,
+// _argb2rgb_blender, _trans_alpha_blender32 and _myblender_alpha_trans24.
+template <bool SrcAlpha, bool KeepDstAlpha>
+struct RgbLerpOp
+{
+    uint32_t K; // src alpha factor (* K / 256), or the constant alpha
+
+    template <class V>
+    typename V::T Blend(typename V::T src, typename V::T dst) const
+    {
+        typedef typename V::T T;
+        const T rb_mask = V::set1(0xFF00FF);
+        const T g_mask = V::set1(0xFF00);
+        T a = SrcAlpha ? V::srl8(V::mul(V::srl24(src), V::set1(K))) : V::set1(K);
+        a = V::add(a, V::andnot(V::eq(a, V::set1(0)), V::set1(1))); // if (a) a++
+        const T res = V::add(V::srl8(V::mul(V::sub(V::and_(src, rb_mask), V::and_(dst, rb_mask)), a)), dst);
+        const T dst_g = V::and_(dst, g_mask);
+        const T g = V::add(V::srl8(V::mul(V::sub(V::and_(src, g_mask), dst_g), a)), dst_g);
+        const T out = V::or_(V::and_(res, rb_mask), V::and_(g, g_mask));
+        return KeepDstAlpha ? V::or_(out, V::and_(dst, V::set1(0xFF000000))) : out;
+    }
+};
+
+// Same as argb2argb_blend_core, with the src alpha either taken from src
+// multiplied by a factor, or a constant. Covers _argb2argb_blender and
+// _rgb2argb_blender.
+template <bool SrcAlpha>
+struct ArgbBlendOp
+{
+    uint32_t K; // src alpha factor (* K / 256), or the constant alpha
+
+    template <class V>
+    typename V::T Blend(typename V::T src, typename V::T dst) const
+    {
+        typedef typename V::T T;
+        const T rb_mask = V::set1(0xFF00FF);
+        const T g_mask = V::set1(0xFF00);
+        const T one = V::set1(1);
+        const T full = V::set1(256);
+        T src_alpha = SrcAlpha ? V::srl8(V::mul(V::srl24(src), V::set1(K))) : V::set1(K);
+        const T skip = V::eq(src_alpha, V::set1(0));
+        src_alpha = V::add(src_alpha, one);
+        T dst_alpha = V::srl24(dst);
+        dst_alpha = V::add(dst_alpha, V::andnot(V::eq(dst_alpha, V::set1(0)), one));
+
+        T dst_g = V::srl8(V::mul(V::and_(dst, g_mask), dst_alpha));
+        T dst_rb = V::srl8(V::mul(V::and_(dst, rb_mask), dst_alpha));
+        dst_g = V::and_(V::add(V::srl8(V::mul(V::sub(V::and_(src, g_mask), V::and_(dst_g, g_mask)), src_alpha)), dst_g), g_mask);
+        dst_rb = V::and_(V::add(V::srl8(V::mul(V::sub(V::and_(src, rb_mask), V::and_(dst_rb, rb_mask)), src_alpha)), dst_rb), rb_mask);
+
+        const T final_alpha = V::sub(full, V::srl8(V::mul(V::sub(full, src_alpha), V::sub(full, dst_alpha))));
+        const T factor = V::recip(final_alpha);
+        dst_g = V::and_(V::srl8(V::mul(dst_g, factor)), g_mask);
+        dst_rb = V::and_(V::srl8(V::mul(dst_rb, factor)), rb_mask);
+        const T out = V::or_(V::or_(dst_rb, dst_g), V::sll24(V::sub(final_alpha, one)));
+        return V::select(skip, dst, out);
+    }
+};
+
+// Copies src with the opaque alpha: _opaque_alpha_blender, and
+// _rgb2argb_blender with no blend alpha
+struct OpaqueCopyOp
+{
+    template <class V>
+    typename V::T Blend(typename V::T src, typename V::T /*dst*/) const
+    {
+        return V::or_(src, V::set1(0xFF000000));
+    }
+};
+
+// Copies src with the sum of alphas: _additive_alpha_copysrc_blender
+struct AdditiveCopyOp
+{
+    template <class V>
+    typename V::T Blend(typename V::T src, typename V::T dst) const
+    {
+        typedef typename V::T T;
+        const T max_alpha = V::set1(0xFF);
+        T alpha = V::add(V::srl24(src), V::srl24(dst));
+        alpha = V::select(V::gt(alpha, max_alpha), max_alpha, alpha);
+        return V::or_(V::sll24(alpha), V::and_(src, V::set1(0x00FFFFFF)));
+    }
+};
+
+template <class V, class Op>
+inline void blend_pixels(const Op &op, const uint32_t *src, uint32_t *dst)
+{
+    const typename V::T s = V::load(src);
+    const typename V::T d = V::load(dst);
+    // mask color pixels are skipped, as draw_trans_sprite does
+    V::store(dst, V::select(V::eq(s, V::set1(MASK_COLOR_32)), d, op.template Blend<V>(s, d)));
+}
+
+// Calls any blender for each pixel, as draw_trans_sprite does
+struct CallbackOp
+{
+    BLENDER_FUNC Blender;
+    uint32_t Alpha;
+
+    template <class V>
+    typename V::T Blend(typename V::T src, typename V::T dst) const
+    {
+        return Blender(src, dst, Alpha);
+    }
+};
+
+template <class Op>
+void blend_rows(const Op &op, BITMAP *dst, BITMAP *src,
+    int dst_x, int dst_y, int src_x, int src_y, int w, int h)
+{
+    for (int y = 0; y < h; ++y)
+    {
+        const uint32_t *s = reinterpret_cast<const uint32_t*>(src->line[src_y + y]) + src_x;
+        uint32_t *d = reinterpret_cast<uint32_t*>(dst->line[dst_y + y]) + dst_x;
+        int x = 0;
+        for (; x + PixVector::Lanes <= w; x += PixVector::Lanes)
+            blend_pixels<PixVector>(op, s + x, d + x);
+        for (; x < w; ++x)
+            blend_pixels<PixScalar>(op, s + x, d + x);
+    }
+}
+
+template <>
+void blend_rows(const CallbackOp &op, BITMAP *dst, BITMAP *src,
+    int dst_x, int dst_y, int src_x, int src_y, int w, int h)
+{
+    for (int y = 0; y < h; ++y)
+    {
+        const uint32_t *s = reinterpret_cast<const uint32_t*>(src->line[src_y + y]) + src_x;
+        uint32_t *d = reinterpret_cast<uint32_t*>(dst->line[dst_y + y]) + dst_x;
+        for (int x = 0; x < w; ++x)
+            blend_pixels<PixScalar>(op, s + x, d + x);
+    }
+}
+
+} // namespace
+
+void draw_trans_sprite32(BITMAP *dst, BITMAP *src, int dx, int dy)
+{
+    if ((bitmap_color_depth(dst) != 32) || (bitmap_color_depth(src) != 32))
+        draw_trans_sprite(dst, src, dx, dy);
+    else
+        draw_trans_sprite32(dst, src, dx, dy, _blender_func32, static_cast<uint32_t>(_blender_alpha));
+}
+
+void draw_trans_sprite32(BITMAP *dst, BITMAP *src, int dx, int dy, BLENDER_FUNC blender, uint32_t alpha)
+{
+    assert((bitmap_color_depth(dst) == 32) && (bitmap_color_depth(src) == 32));
+    // Clip exactly like the Allegro's sprite drawing does
+    int w, h, sxbeg, sybeg, dxbeg, dybeg;
+    if (dst->clip)
+    {
+        int tmp = dst->cl - dx;
+        sxbeg = ((tmp < 0) ? 0 : tmp);
+        dxbeg = sxbeg + dx;
+        tmp = dst->cr - dx;
+        w = ((tmp > src->w) ? src->w : tmp) - sxbeg;
+        tmp = dst->ct - dy;
+        sybeg = ((tmp < 0) ? 0 : tmp);
+        dybeg = sybeg + dy;
+        tmp = dst->cb - dy;
+        h = ((tmp > src->h) ? src->h : tmp) - sybeg;
+        if ((w <= 0) || (h <= 0))
+            return;
+    }
+    else
+    {
+        w = src->w;
+        h = src->h;
+        sxbeg = sybeg = 0;
+        dxbeg = dx;
+        dybeg = dy;
+    }
+
+    if (blender == _blender_alpha32)
+        blend_rows(RgbLerpOp<true, false>{256}, dst, src, dxbeg, dybeg, sxbeg, sybeg, w, h);
+    else if (blender == _argb2rgb_blender)
+        blend_rows(RgbLerpOp<true, false>{src_alpha_factor(alpha)}, dst, src, dxbeg, dybeg, sxbeg, sybeg, w, h);
+    else if (blender == _trans_alpha_blender32)
+        blend_rows(RgbLerpOp<true, false>{alpha}, dst, src, dxbeg, dybeg, sxbeg, sybeg, w, h);
+    else if (blender == _blender_trans24)
+        blend_rows(RgbLerpOp<false, false>{alpha}, dst, src, dxbeg, dybeg, sxbeg, sybeg, w, h);
+    else if (blender == _myblender_alpha_trans24)
+        blend_rows(RgbLerpOp<false, true>{alpha}, dst, src, dxbeg, dybeg, sxbeg, sybeg, w, h);
+    else if (blender == _argb2argb_blender)
+        blend_rows(ArgbBlendOp<true>{src_alpha_factor(alpha)}, dst, src, dxbeg, dybeg, sxbeg, sybeg, w, h);
+    else if ((blender == _rgb2argb_blender) && (alpha != 0) && (alpha != 0xFF))
+        blend_rows(ArgbBlendOp<false>{alpha}, dst, src, dxbeg, dybeg, sxbeg, sybeg, w, h);
+    else if ((blender == _rgb2argb_blender) || (blender == _opaque_alpha_blender))
+        blend_rows(OpaqueCopyOp(), dst, src, dxbeg, dybeg, sxbeg, sybeg, w, h);
+    else if (blender == _additive_alpha_copysrc_blender)
+        blend_rows(AdditiveCopyOp(), dst, src, dxbeg, dybeg, sxbeg, sybeg, w, h);
+    else
+        blend_rows(CallbackOp{blender, alpha}, dst, src, dxbeg, dybeg, sxbeg, sybeg, w, h);
+}
@@ -20,6 +20,8 @@
 
 #include "core/types.h"
 
+struct BITMAP;
+
 //
 // Allegro's standard alpha blenders result in:
 // - src and dst RGB are combined proportionally to src alpha
@@ -54,6 +56,8 @@ uint32_t _argb2rgb_blender(uint32_t src_col, uint32_t dst_col, uint32_t src_alph
 uint32_t _rgb2argb_blender(uint32_t src_col, uint32_t dst_col, uint32_t src_alpha);
 // Sets the alpha channel to opaque. Used when drawing a non-alpha sprite onto an alpha-sprite.
 uint32_t _opaque_alpha_blender(uint32_t src_col, uint32_t dst_col, uint32_t src_alpha);
+// Argb2rgb blender which multiplies src alpha by the custom alpha parameter.
+uint32_t _trans_alpha_blender32(uint32_t src_col, uint32_t dst_col, uint32_t src_alpha);
 
 // Additive alpha blender plain copies src over, applying a summ of src and
 // dst alpha values.
@@ -63,4 +67,16 @@ void set_opaque_alpha_blender();
 // Sets argb2argb for 32-bit mode, and provides appropriate funcs for blending 32-bit onto 15/16/24-bit destination
 void set_argb2any_blender();
 
+// Draws a 32-bit sprite onto a 32-bit bitmap using the current blender,
+// same as Allegro's draw_trans_sprite does; but for the known 32-bit blenders
+// processes whole rows at once (several pixels at a time on SSE2 and NEON
+// capable CPUs), instead of calling the blender for each pixel.
+// Falls back to draw_trans_sprite in all other cases.
+void draw_trans_sprite32(BITMAP *dst, BITMAP *src, int dx, int dy);
+// Same as above, but uses the given 32-bit blender and alpha instead of the
+// current ones, and does not touch any global state, so may be called from
+// several threads at once. Both bitmaps must be 32-bit.
+void draw_trans_sprite32(BITMAP *dst, BITMAP *src, int dx, int dy,
+    uint32_t(*blender)(uint32_t, uint32_t, uint32_t), uint32_t alpha);
+
 #endif // __AC_BLENDER_H
@@ -22,6 +22,7 @@
 #ifndef __AGS_EE_GFX__DDB_H
 #define __AGS_EE_GFX__DDB_H
 
+#include <atomic>
 #include <memory>
 #include "gfx/gfxdefines.h"
 
@@ -42,15 +43,27 @@ struct Texture
     uint32_t ID = UINT32_MAX; // optional ID, may refer to sprite ID
     const GraphicResolution Res;
     const bool RenderTarget = false; // TODO: replace with flags later
+    // Unique stamp of the texture's contents, changes whenever its pixels
+    // are updated; lets tell if the texture was changed since it was drawn
+    uint32_t Stamp = NextStamp();
 
     virtual ~Texture() = default;
     virtual size_t GetMemSize() const = 0;
+    // Marks that the texture's pixels were updated
+    void Touch() { Stamp = NextStamp(); }
 
 protected:
     Texture(const GraphicResolution &res, bool rt)
         : Res(res), RenderTarget(rt) {}
     Texture(uint32_t id, const GraphicResolution &res, bool rt)
         : ID(id), Res(res), RenderTarget(rt) {}
+
+private:
+    static uint32_t NextStamp()
+    {
+        static std::atomic<uint32_t> stamp{0u};
+        return ++stamp;
+    }
 };
 
 
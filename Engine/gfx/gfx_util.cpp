@@ -95,7 +95,7 @@ void DrawSpriteBlend(Bitmap *ds, const Point &ds_at, Bitmap *sprite,
         // set blenders if applicable and tell if succeeded
         SetBlender(blend_mode, dst_has_alpha, src_has_alpha, blend_alpha))
     {
-        ds->TransBlendBlt(sprite, ds_at.X, ds_at.Y);
+        draw_trans_sprite32(ds->GetAllegroBitmap(), sprite->GetAllegroBitmap(), ds_at.X, ds_at.Y);
     }
     else
     {
@@ -155,7 +155,7 @@ void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int al
     if ((alpha < 0xFF) && (surface_depth > 8) && (sprite_depth > 8))
     {
         set_trans_blender(0, 0, 0, alpha);
-        ds->TransBlendBlt(sprite, x, y);
+        draw_trans_sprite32(ds->GetAllegroBitmap(), sprite->GetAllegroBitmap(), x, y);
     }
     else
     {
@@ -14,6 +14,7 @@
 #ifndef __AGS_EE_GFX__GFXDEFINES_H
 #define __AGS_EE_GFX__GFXDEFINES_H
 
+#include <algorithm>
 #include "core/types.h"
 #include "util/geometry.h"
 
@@ -67,6 +68,24 @@ struct DisplayMode : public GraphicResolution
     {}
 };
 
+// YUVFrameLayout describes how the YUV 4:2:0 video frame is stored in an
+// 8-bit bitmap: the full size Y plane is at the top, and the half size
+// U and V planes are below it, side by side.
+struct YUVFrameLayout
+{
+    Size Frame;  // image size, also the size of the Y plane
+    Size Chroma; // size of the U and V planes
+
+    YUVFrameLayout(const Size &frame)
+        : Frame(frame), Chroma((frame.Width + 1) / 2, (frame.Height + 1) / 2) {}
+
+    // Gets the size of the bitmap holding all the planes
+    inline Size GetBitmapSize() const
+        { return Size(std::max(Frame.Width, Chroma.Width * 2), Frame.Height + Chroma.Height); }
+    inline Point GetUOrigin() const { return Point(0, Frame.Height); }
+    inline Point GetVOrigin() const { return Point(Chroma.Width, Frame.Height); }
+};
+
 } // namespace Engine
 } // namespace AGS
 
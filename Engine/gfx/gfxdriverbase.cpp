@@ -127,6 +127,53 @@ void GraphicsDriverBase::ClearDrawLists()
     _spriteBatchRange.clear();
 }
 
+void GraphicsDriverBase::EndFrameStats()
+{
+    _lastRenderStats = _renderStats;
+    _renderStats = RenderStats();
+}
+
+uint32_t GraphicsDriverBase::NewScreenCopyHandle()
+{
+    if (++_lastScreenCopy == 0u)
+        ++_lastScreenCopy; // 0 is reserved for the failure
+    return _lastScreenCopy;
+}
+
+uint32_t GraphicsDriverBase::BeginScreenCopy(const Rect *src_rect, bool at_native_res, uint32_t batch_skip_filter)
+{
+    const Rect copy_rect = src_rect ? *src_rect : _srcRect;
+    std::unique_ptr<Bitmap> copy(new Bitmap(copy_rect.GetWidth(), copy_rect.GetHeight(), 32));
+    GraphicResolution want_fmt;
+    if (!GetCopyOfScreenIntoBitmap(copy.get(), src_rect, at_native_res, &want_fmt, batch_skip_filter))
+    {
+        // Retry with the format that the renderer supports
+        if (want_fmt.Width <= 0 || want_fmt.Height <= 0)
+            return 0u;
+        copy.reset(new Bitmap(want_fmt.Width, want_fmt.Height, want_fmt.ColorDepth));
+        if (!GetCopyOfScreenIntoBitmap(copy.get(), src_rect, at_native_res, nullptr, batch_skip_filter))
+            return 0u;
+    }
+    const uint32_t handle = NewScreenCopyHandle();
+    _screenCopies[handle] = std::move(copy);
+    return handle;
+}
+
+bool GraphicsDriverBase::IsScreenCopyReady(uint32_t handle)
+{
+    return _screenCopies.count(handle) > 0;
+}
+
+std::unique_ptr<Bitmap> GraphicsDriverBase::EndScreenCopy(uint32_t handle)
+{
+    auto it = _screenCopies.find(handle);
+    if (it == _screenCopies.end())
+        return nullptr;
+    std::unique_ptr<Bitmap> copy = std::move(it->second);
+    _screenCopies.erase(it);
+    return copy;
+}
+
 void GraphicsDriverBase::OnInit()
 {
 }
@@ -140,12 +187,14 @@ void GraphicsDriverBase::OnModeSet(const DisplayMode &mode)
     _mode = mode;
     // Adjust some generic parameters as necessary
     _mode.Vsync &= _capsVsync;
+    _lastFrameValid = false;
 }
 
 void GraphicsDriverBase::OnModeReleased()
 {
     _mode = DisplayMode();
     _dstRect = Rect();
+    _lastFrameValid = false;
 }
 
 void GraphicsDriverBase::OnScalingChanged()
@@ -156,6 +205,7 @@ void GraphicsDriverBase::OnScalingChanged()
     else
         _filterRect = Rect();
     _scaling.Init(_srcRect.GetSize(), _dstRect);
+    _lastFrameValid = false;
 }
 
 void GraphicsDriverBase::OnSetNativeRes(const GraphicResolution &native_res)
@@ -174,6 +224,7 @@ void GraphicsDriverBase::OnSetRenderFrame(const Rect &dst_rect)
 void GraphicsDriverBase::OnSetFilter()
 {
     _filterRect = GetGraphicsFilter()->SetTranslation(Size(_srcRect.GetSize()), _dstRect);
+    _lastFrameValid = false;
 }
 
 
@@ -228,6 +279,16 @@ IDriverDependantBitmap *VideoMemoryGraphicsDriver::CreateDDBFromBitmap(const Bit
     return ddb;
 }
 
+void VideoMemoryGraphicsDriver::UpdateDDBRegion(IDriverDependantBitmap *ddb, const Bitmap *bitmap, bool has_alpha, const Rect& /*area*/)
+{
+    UpdateDDBFromBitmap(ddb, bitmap, has_alpha);
+}
+
+void VideoMemoryGraphicsDriver::UpdateTextureArea(Texture *txdata, const Bitmap *bmp, bool has_alpha, bool opaque, const Rect& /*area*/)
+{
+    UpdateTexture(txdata, bmp, has_alpha, opaque);
+}
+
 Texture *VideoMemoryGraphicsDriver::CreateTexture(const Bitmap *bmp, bool has_alpha, bool opaque)
 {
     Texture *txdata = CreateTexture(bmp->GetWidth(), bmp->GetHeight(), bmp->GetColorDepth(), opaque);
@@ -236,6 +297,44 @@ Texture *VideoMemoryGraphicsDriver::CreateTexture(const Bitmap *bmp, bool has_al
     return txdata;
 }
 
+void VideoMemoryGraphicsDriver::SortDrawItemsByState(const std::vector<DrawOrderItem> &items, std::vector<size_t> &order)
+{
+    // How far back an item may look for the group with the same state;
+    // limits the time of sorting the long lists of mismatching items
+    const size_t MaxLookBack = 64u;
+
+    order.clear();
+    size_t barrier_pos = 0u; // items may not be moved before this position
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        const auto &item = items[i];
+        if (item.Barrier)
+        {
+            order.push_back(i);
+            barrier_pos = order.size();
+            continue;
+        }
+
+        // Look for the last item with the same state, which may be reached
+        // without passing any item that overlaps this one
+        size_t insert_at = order.size();
+        const size_t stop_at = std::max(barrier_pos,
+            order.size() > MaxLookBack ? order.size() - MaxLookBack : 0u);
+        for (size_t pos = order.size(); pos > stop_at; --pos)
+        {
+            const auto &prev = items[order[pos - 1]];
+            if (prev.State == item.State)
+            {
+                insert_at = pos;
+                break;
+            }
+            if (AreRectsIntersecting(prev.Bounds, item.Bounds))
+                break;
+        }
+        order.insert(order.begin() + insert_at, i);
+    }
+}
+
 void VideoMemoryGraphicsDriver::SetStageScreen(const Size &sz, int x, int y)
 {
     SetStageScreen(_actSpriteBatch, sz, x, y);
@@ -392,74 +491,23 @@ template <typename T> void get_pixel_if_not_transparent(const T *pixel, T *red,
     ( (((a) & 0xFF) << _vmem_a_shift_32) | (((r) & 0xFF) << _vmem_r_shift_32) | (((g) & 0xFF) << _vmem_g_shift_32) | (((b) & 0xFF) << _vmem_b_shift_32) )
 
 
-// Template helper function which converts bitmap to a video memory buffer,
-// applies transparency and optionally copyies the source alpha channel (if available).
-template <typename T, bool HasAlpha> void
-VideoMemoryGraphicsDriver::BitmapToVideoMemImpl(
+// Helper function which converts bitmap to a video memory buffer; the alpha
+// mode tells whether to apply transparency, copy the source alpha channel,
+// or make all the pixels opaque. The rows are converted by the SIMD kernels.
+void VideoMemoryGraphicsDriver::BitmapToVideoMemImpl(
         const Bitmap *bitmap, const TextureTile *tile,
-        uint8_t *dst_ptr, const int dst_pitch)
-{
-    // tell the compiler these won't change mid loop execution
-    const int t_width = tile->width;
-    const int t_height = tile->height;
-    const int t_x = tile->x;
-    const int t_y = tile->y;
-
-    const int idst_pitch = dst_pitch * sizeof(uint8_t) / sizeof(uint32_t); // destination is always 32-bit
-    auto idst = reinterpret_cast<uint32_t*>(dst_ptr);
-
-    for (int y = 0; y < t_height; y++)
+        uint8_t *dst_ptr, const int dst_pitch,
+        PixelConvert::AlphaMode alpha)
+{
+    const int src_bpp = bitmap->GetBPP();
+    const PixelConvert::RowConverter conv(bitmap->GetColorDepth(),
+        PixelConvert::ChannelShifts(_vmem_r_shift_32, _vmem_g_shift_32, _vmem_b_shift_32, _vmem_a_shift_32),
+        alpha);
+    for (int y = 0; y < tile->height; y++)
     {
-        const uint8_t *scanline_at = bitmap->GetScanLine(y + t_y);
-        for (int x = 0; x < t_width; x++)
-        {
-            auto srcData = (const T *) &scanline_at[(x + t_x) * sizeof(T)];
-            const T src_color = srcData[0];
-            if (HasAlpha)
-            {
-                idst[x] = VMEMCOLOR_RGBA(algetr<T>(src_color), algetg<T>(src_color), algetb<T>(src_color),
-                    algeta<T>(src_color));
-            }
-            else if (is_color_mask<T>(src_color))
-            {
-                idst[x] = 0;
-            }
-            else
-            {
-                idst[x] = VMEMCOLOR_RGBA(algetr<T>(src_color), algetg<T>(src_color), algetb<T>(src_color),
-                    0xFF);
-            }
-        }
-        idst += idst_pitch;
-    }
-}
-
-// Template helper function which converts bitmap to a video memory buffer,
-// assuming that the destination is always opaque (alpha channel is filled with 0xFF)
-template <typename T> void
-VideoMemoryGraphicsDriver::BitmapToVideoMemOpaqueImpl(
-        const Bitmap *bitmap, const TextureTile *tile,
-        uint8_t *dst_ptr, const int dst_pitch)
-{
-    // tell the compiler these won't change mid loop execution
-    const int t_width = tile->width;
-    const int t_height = tile->height;
-    const int t_x = tile->x;
-    const int t_y = tile->y;
-
-    const int idst_pitch = dst_pitch * sizeof(uint8_t) / sizeof(uint32_t); // destination is always 32-bit
-    auto idst = reinterpret_cast<uint32_t*>(dst_ptr);
-
-    for (int y = 0; y < t_height; y++)
-    {
-        const uint8_t* scanline_at = bitmap->GetScanLine(y + t_y);
-        for (int x = 0; x < t_width; x++)
-        {
-            auto srcData = (const T *)&scanline_at[(x + t_x) * sizeof(T)];
-            const T src_color = srcData[0];
-            idst[x] = VMEMCOLOR_RGBA(algetr<T>(src_color), algetg<T>(src_color), algetb<T>(src_color), 0xFF);
-        }
-        idst += idst_pitch;
+        conv.Convert(reinterpret_cast<uint32_t*>(dst_ptr),
+            bitmap->GetScanLine(y + tile->y) + tile->x * src_bpp, tile->width);
+        dst_ptr += dst_pitch;
     }
 }
 
@@ -539,13 +587,14 @@ VideoMemoryGraphicsDriver::BitmapToVideoMemLinearImpl(
 void VideoMemoryGraphicsDriver::BitmapToVideoMem(const Bitmap *bitmap, const bool has_alpha, const TextureTile *tile,
     uint8_t *dst_ptr, const int dst_pitch, const bool usingLinearFiltering)
 {
+    _lastFrameValid = false; // texture contents change
     switch (bitmap->GetColorDepth())
     {
         case 8:
             if (usingLinearFiltering) {
                 BitmapToVideoMemLinearImpl<uint8_t, false>(bitmap, tile, dst_ptr, dst_pitch);
             } else {
-                BitmapToVideoMemImpl<uint8_t, false>(bitmap, tile, dst_ptr, dst_pitch);
+                BitmapToVideoMemImpl(bitmap, tile, dst_ptr, dst_pitch, PixelConvert::kAlpha_MaskColor);
             }
 
             break;
@@ -553,7 +602,7 @@ void VideoMemoryGraphicsDriver::BitmapToVideoMem(const Bitmap *bitmap, const boo
             if (usingLinearFiltering) {
                 BitmapToVideoMemLinearImpl<uint16_t, false>(bitmap, tile, dst_ptr, dst_pitch);
             } else {
-                BitmapToVideoMemImpl<uint16_t, false>(bitmap, tile, dst_ptr, dst_pitch);
+                BitmapToVideoMemImpl(bitmap, tile, dst_ptr, dst_pitch, PixelConvert::kAlpha_MaskColor);
             }
             break;
         case 32:
@@ -564,11 +613,8 @@ void VideoMemoryGraphicsDriver::BitmapToVideoMem(const Bitmap *bitmap, const boo
                     BitmapToVideoMemLinearImpl<uint32_t, false>(bitmap, tile, dst_ptr, dst_pitch);
                 }
             } else {
-                if (has_alpha) {
-                    BitmapToVideoMemImpl<uint32_t, true>(bitmap, tile, dst_ptr, dst_pitch);
-                } else {
-                    BitmapToVideoMemImpl<uint32_t, false>(bitmap, tile, dst_ptr, dst_pitch);
-                }
+                BitmapToVideoMemImpl(bitmap, tile, dst_ptr, dst_pitch,
+                    has_alpha ? PixelConvert::kAlpha_Source : PixelConvert::kAlpha_MaskColor);
             }
             break;
         default:
@@ -579,20 +625,8 @@ void VideoMemoryGraphicsDriver::BitmapToVideoMem(const Bitmap *bitmap, const boo
 void VideoMemoryGraphicsDriver::BitmapToVideoMemOpaque(const Bitmap *bitmap, const TextureTile *tile,
     uint8_t *dst_ptr, const int dst_pitch)
 {
-    switch (bitmap->GetColorDepth())
-    {
-        case 8:
-            BitmapToVideoMemOpaqueImpl<uint8_t>(bitmap, tile, dst_ptr, dst_pitch);
-            break;
-        case 16:
-            BitmapToVideoMemOpaqueImpl<uint16_t>(bitmap, tile, dst_ptr, dst_pitch);
-            break;
-        case 32:
-            BitmapToVideoMemOpaqueImpl<uint32_t>(bitmap, tile, dst_ptr, dst_pitch);
-            break;
-        default:
-            break;
-    }
+    _lastFrameValid = false; // texture contents change
+    BitmapToVideoMemImpl(bitmap, tile, dst_ptr, dst_pitch, PixelConvert::kAlpha_Opaque);
 }
 
 
@@ -18,12 +18,15 @@
 #ifndef __AGS_EE_GFX__GFXDRIVERBASE_H
 #define __AGS_EE_GFX__GFXDRIVERBASE_H
 
+#include <algorithm>
 #include <memory>
+#include <string.h>
 #include <unordered_map>
 #include <vector>
 #include "gfx/ddb.h"
 #include "gfx/gfx_def.h"
 #include "gfx/graphicsdriver.h"
+#include "gfx/pixel_convert.h"
 #include "util/scaling.h"
 #include "util/resourcecache.h"
 
@@ -121,6 +124,7 @@ public:
 
     bool        SetVsync(bool enabled) override;
     bool        GetVsync() const override;
+    void        UseAdaptiveVsync(bool enabled) override { _adaptiveVsync = enabled; }
 
     void        BeginSpriteBatch(const Rect &viewport, const SpriteTransform &transform,
                     Common::GraphicFlip flip = Common::kFlip_None, PBitmap surface = nullptr, uint32_t filter_flags = 0) override;
@@ -132,6 +136,30 @@ public:
     void        SetCallbackOnInit(GFXDRV_CLIENTCALLBACKINITGFX callback) override { _initGfxCallback = callback; }
     void        SetCallbackOnSpriteEvt(GFXDRV_CLIENTCALLBACKEVT callback) override { _spriteEvtCallback = callback; }
 
+    RenderStats GetRenderStats() const override { return _lastRenderStats; }
+
+    void        InvalidateFrame() override { _lastFrameValid = false; }
+
+    // YUV frames are not supported by default
+    Size        GetMaxYUVFrameSize() override { return Size(); }
+    IDriverDependantBitmap *CreateYUVFrameDDB(int /*width*/, int /*height*/) override { return nullptr; }
+    void        UpdateYUVFrameDDB(IDriverDependantBitmap* /*ddb*/, const Bitmap* /*planes*/) override {}
+    // Alpha test is not supported by default
+    bool        SupportsAlphaTest() override { return false; }
+    void        SetDDBAlphaTest(IDriverDependantBitmap* /*ddb*/, int /*threshold*/) override {}
+    // DDB state is not tracked by default
+    uint64_t    GetDDBStateHash(IDriverDependantBitmap* /*ddb*/) override { return 0u; }
+    // Shaders are not cached by default
+    void        SetShaderCacheFile(const String& /*path*/) override {}
+    // Compact texture formats are not used by default
+    void        SetCompactOpaqueTextures(bool /*enabled*/) override {}
+
+    // Default screen copy implementation makes a copy right away,
+    // and keeps it until requested
+    uint32_t    BeginScreenCopy(const Rect *src_rect, bool at_native_res, uint32_t batch_skip_filter = 0u) override;
+    bool        IsScreenCopyReady(uint32_t handle) override;
+    std::unique_ptr<Bitmap> EndScreenCopy(uint32_t handle) override;
+
 protected:
     // Special internal values, applied to DrawListEntry
     static const uintptr_t DRAWENTRY_STAGECALLBACK = 0x0;
@@ -167,6 +195,10 @@ protected:
 
     void BeginSpriteBatch(const SpriteBatchDesc &desc);
     void OnScalingChanged();
+    // Saves the statistics of the finished frame, and resets the counters
+    void EndFrameStats();
+    // Generates a new screen copy request handle
+    uint32_t NewScreenCopyHandle();
 
     DisplayMode         _mode;          // display mode settings
     Rect                _srcRect;       // rendering source rect
@@ -177,6 +209,7 @@ protected:
 
     // Capability flags
     bool                _capsVsync = false; // is vsync available
+    bool                _adaptiveVsync = false; // use adaptive vsync when enabling vsync
 
     // Callbacks
     GFXDRV_CLIENTCALLBACKEVT _spriteEvtCallback;
@@ -192,6 +225,18 @@ protected:
     // The index of a currently rendered sprite batch
     // (or -1 / UINT32_MAX if we are outside of the render pass)
     uint32_t _rendSpriteBatch;
+
+    // Rendering statistics of the current frame, and of the last finished one
+    RenderStats _renderStats;
+    RenderStats _lastRenderStats;
+    // Tells if the last presented frame is still valid, and may be kept
+    // on screen instead of rendering the same frame again
+    bool _lastFrameValid = false;
+
+private:
+    // Screen copies made by the default implementation, waiting to be retrieved
+    std::unordered_map<uint32_t, std::unique_ptr<Bitmap>> _screenCopies;
+    uint32_t _lastScreenCopy = 0u;
 };
 
 
@@ -285,16 +330,139 @@ public:
 
     // Creates new DDB and copy bitmap contents over
     IDriverDependantBitmap *CreateDDBFromBitmap(const Bitmap *bitmap, bool has_alpha, bool opaque = false) override;
+    // Updates the DDB's area; the default implementation updates whole DDB
+    void UpdateDDBRegion(IDriverDependantBitmap *ddb, const Bitmap *bitmap, bool has_alpha, const Rect &area) override;
 
     // Create texture data with the given parameters
     Texture *CreateTexture(int width, int height, int color_depth, bool opaque = false, bool as_render_target = false) override = 0;
     // Create texture and initialize its pixels from the given bitmap
     Texture *CreateTexture(const Bitmap *bmp, bool has_alpha, bool opaque = false) override;
+    // Updates the texture's area; the default implementation updates whole texture
+    void UpdateTextureArea(Texture *txdata, const Bitmap *bmp, bool has_alpha, bool opaque, const Rect &area) override;
 
     // Sets stage screen parameters for the current batch.
     void SetStageScreen(const Size &sz, int x = 0, int y = 0) override;
 
+    void UseStateSorting(bool enabled) override { _stateSorting = enabled; }
+    void UseIdleFrameSkip(bool enabled) override { _idleFrameSkip = enabled; InvalidateFrame(); }
+    void SetRenderThreadCount(int /*count*/) override { }
+
 protected:
+    // Render state of a draw list entry, used for the state sorting;
+    // the entries with equal states may be drawn together
+    struct DrawState
+    {
+        const void *Texture = nullptr;
+        uint32_t Blend = 0u; // blend mode and shader, in a driver-specific form
+
+        DrawState() = default;
+        DrawState(const void *texture, uint32_t blend)
+            : Texture(texture), Blend(blend) {}
+        bool operator ==(const DrawState &other) const
+            { return Texture == other.Texture && Blend == other.Blend; }
+    };
+
+    // Describes a draw list entry for the purpose of the state sorting
+    struct DrawOrderItem
+    {
+        Rect Bounds; // entry's bounds, in the batch coordinates
+        DrawState State;
+        bool Barrier = false; // entry may not be moved, nor passed by the others
+    };
+
+    // Calculates the new order of the draw items, grouping those with equal
+    // state, while keeping the relative order of any overlapping items;
+    // fills the order array with the indexes of the items.
+    static void SortDrawItemsByState(const std::vector<DrawOrderItem> &items, std::vector<size_t> &order);
+    // Reorders the entries of each sprite batch in the draw list by their
+    // render state, see SortDrawItemsByState. The get_state functor must
+    // return DrawState for the given DDB.
+    template <class T_DDB, class T_GetState>
+    void SortDrawListByState(std::vector<SpriteDrawListEntry<T_DDB>> &list, T_GetState get_state)
+    {
+        for (size_t from = 0; from < list.size();)
+        {
+            // Find the range of entries belonging to the same batch
+            size_t to = from + 1;
+            for (; (to < list.size()) && (list[to].node == list[from].node); ++to);
+            if (to - from > 2)
+            {
+                _sortItems.resize(to - from);
+                for (size_t i = from; i < to; ++i)
+                {
+                    const auto &e = list[i];
+                    auto &item = _sortItems[i - from];
+                    // Special entries are never moved
+                    item.Barrier = reinterpret_cast<uintptr_t>(e.ddb) <= DRAWENTRY_TINT;
+                    if (!item.Barrier)
+                    {
+                        item.Bounds = RectWH(e.x, e.y, e.ddb->GetWidthToRender(), e.ddb->GetHeightToRender());
+                        item.State = get_state(e.ddb);
+                    }
+                }
+                SortDrawItemsByState(_sortItems, _sortOrder);
+                std::vector<SpriteDrawListEntry<T_DDB>> sorted;
+                sorted.reserve(to - from);
+                for (size_t i : _sortOrder)
+                    sorted.push_back(list[from + i]);
+                std::copy(sorted.begin(), sorted.end(), list.begin() + from);
+            }
+            from = to;
+        }
+    }
+
+    // Tells if the draw lists would produce the same image as the last
+    // presented frame, so that its render and present may be skipped.
+    // The draw lists are compared by their signature, made of the sprite
+    // batches, sprite entries and the sprites' own draw parameters, along
+    // with the driver's render settings passed in render_flags.
+    // Remembers the new signature for the next frame.
+    template <class T_DDB>
+    bool IsSameAsLastFrame(const std::vector<SpriteDrawListEntry<T_DDB>> &list, uint32_t render_flags)
+    {
+        DrawListHash hash;
+        hash.Add(render_flags);
+        for (const auto &desc : _spriteBatchDesc)
+        {
+            hash.Add(desc.Parent);
+            hash.Add(desc.Viewport.Left); hash.Add(desc.Viewport.Top);
+            hash.Add(desc.Viewport.Right); hash.Add(desc.Viewport.Bottom);
+            hash.Add(desc.Transform.X); hash.Add(desc.Transform.Y);
+            hash.Add(desc.Transform.ScaleX); hash.Add(desc.Transform.ScaleY);
+            hash.Add(desc.Transform.Rotate); hash.Add(desc.Transform.Color.Alpha);
+            hash.Add(desc.Flip);
+            hash.Add(desc.RenderTarget);
+            hash.Add(desc.FilterFlags);
+        }
+        // Plugins may draw anything during their stage callbacks
+        bool has_callbacks = false;
+        for (const auto &e : list)
+        {
+            hash.Add(e.node); hash.Add(e.x); hash.Add(e.y); hash.Add(e.skip);
+            hash.Add(e.ddb);
+            if (reinterpret_cast<uintptr_t>(e.ddb) <= DRAWENTRY_TINT)
+            {
+                has_callbacks |= reinterpret_cast<uintptr_t>(e.ddb) == DRAWENTRY_STAGECALLBACK;
+                continue;
+            }
+            AddDDBToHash(hash, e.ddb);
+        }
+        const bool same = _idleFrameSkip && _lastFrameValid && (hash.Value == _lastFrameHash);
+        _lastFrameHash = hash.Value;
+        _lastFrameValid = !has_callbacks;
+        return same;
+    }
+
+    // Hashes the DDB's texture contents and drawing parameters
+    template <class T_DDB>
+    static uint64_t HashDDBState(const T_DDB *ddb)
+    {
+        DrawListHash hash;
+        AddDDBToHash(hash, ddb);
+        hash.Add(ddb->_data ? ddb->_data->Stamp : 0u);
+        return hash.Value;
+    }
+
     // Stage screens are raw bitmap buffers meant to be sent to plugins on demand
     // at certain drawing stages. If used at least once these buffers are then
     // rendered as additional sprites in their respected order.
@@ -330,6 +498,10 @@ protected:
     // Stage matrixes are used to let plugins with hardware acceleration know model matrix;
     // these matrixes are filled compatible with each given renderer
     RenderMatrixes _stageMatrixes;
+    // Reorder the draw lists by the render state before rendering
+    bool _stateSorting = false;
+    // Skip rendering the frames which are same as the last presented one
+    bool _idleFrameSkip = false;
 
     // Color component shifts in video bitmap format (set by implementations)
     int _vmem_a_shift_32;
@@ -338,6 +510,45 @@ protected:
     int _vmem_b_shift_32;
 
 private:
+    // FNV-1a hash of the draw lists' contents
+    struct DrawListHash
+    {
+        uint64_t Value = 14695981039346656037ull;
+
+        void Add(uint32_t v)
+        {
+            for (int i = 0; i < 4; ++i, v >>= 8)
+                Value = (Value ^ (v & 0xFF)) * 1099511628211ull;
+        }
+        void Add(int v) { Add(static_cast<uint32_t>(v)); }
+        void Add(bool v) { Add(static_cast<uint32_t>(v)); }
+        void Add(float v) { uint32_t u; memcpy(&u, &v, sizeof(u)); Add(u); }
+        void Add(const void *p)
+        {
+            const uint64_t v = reinterpret_cast<uintptr_t>(p);
+            Add(static_cast<uint32_t>(v)); Add(static_cast<uint32_t>(v >> 32));
+        }
+    };
+
+    template <class T_DDB>
+    static void AddDDBToHash(DrawListHash &hash, const T_DDB *ddb)
+    {
+        hash.Add(ddb->_data.get());
+        hash.Add(ddb->_flipped);
+        hash.Add(ddb->_stretchToWidth); hash.Add(ddb->_stretchToHeight);
+        hash.Add(ddb->_useResampler);
+        hash.Add(ddb->_red); hash.Add(ddb->_green); hash.Add(ddb->_blue);
+        hash.Add(ddb->_tintSaturation); hash.Add(ddb->_lightLevel);
+        hash.Add(ddb->_alpha); hash.Add(ddb->_alphaTest);
+        hash.Add(ddb->_renderHint);
+        hash.Add(ddb->_hasAlpha); hash.Add(ddb->_opaque);
+    }
+    uint64_t _lastFrameHash = 0u;
+
+    // Temporary buffers for the state sorting
+    std::vector<DrawOrderItem> _sortItems;
+    std::vector<size_t> _sortOrder;
+
     // Stage virtual screens are used to let plugins draw custom graphics
     // in between render stages (between room and GUI, after GUI, and so on).
     // TODO: possibly may be optimized further by having only 1 bitmap/ddb
@@ -365,17 +576,11 @@ private:
     std::vector<ScreenFx> _fxPool;
     size_t _fxIndex; // next free pool item
 
-    // specialized method to convert bitmap to video memory depending on bit depth
-    template <typename T, bool HasAlpha> void
-    BitmapToVideoMemImpl(
-            const Bitmap *bitmap, const TextureTile *tile,
-            uint8_t *dst_ptr, const int dst_pitch
-    );
-
-    template <typename T> void
-    BitmapToVideoMemOpaqueImpl(
+    // converts bitmap to video memory row by row, setting alpha as requested
+    void BitmapToVideoMemImpl(
             const Bitmap *bitmap, const TextureTile *tile,
-            uint8_t *dst_ptr, const int dst_pitch
+            uint8_t *dst_ptr, const int dst_pitch,
+            Common::PixelConvert::AlphaMode alpha
     );
 
     template <typename T, bool HasAlpha> void
@@ -21,6 +21,7 @@
 
 #if AGS_HAS_OPENGL
 #include "gfx/ali3dogl.h"
+#include "gfx/ali3dogl3.h"
 #include "gfx/gfxfilter_ogl.h"
 #endif
 
@@ -40,6 +41,7 @@ void GetGfxDriverFactoryNames(StringV &ids)
     ids.push_back("D3D9");
 #endif
 #if AGS_HAS_OPENGL
+    ids.push_back("OGL3");
     ids.push_back("OGL");
 #endif
     ids.push_back("Software");
@@ -52,11 +54,17 @@ IGfxDriverFactory *GetGfxDriverFactory(const String id)
         return D3D::D3DGraphicsFactory::GetFactory();
 #endif
 #if AGS_HAS_OPENGL
+    if (id.CompareNoCase("OGL3") == 0)
+        return OGL::OGL3GraphicsFactory::GetFactory();
     if (id.CompareNoCase("OGL") == 0)
         return OGL::OGLGraphicsFactory::GetFactory();
 #endif
     if (id.CompareNoCase("Software") == 0)
         return ALSW::SDLRendererGraphicsFactory::GetFactory();
+    // the null driver is not listed among the drivers, as it's not
+    // meant for playing, but may be requested explicitly
+    if (id.CompareNoCase("Null") == 0)
+        return ALSW::NullGraphicsFactory::GetFactory();
     SDL_SetError("No graphics factory with such id: %s", id.GetCStr());
     return nullptr;
 }
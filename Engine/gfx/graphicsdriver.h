@@ -25,6 +25,7 @@
 #include "gfx/gfxdefines.h"
 #include "gfx/gfxmodelist.h"
 #include "util/geometry.h"
+#include "util/string.h"
 
 namespace AGS
 {
@@ -43,6 +44,7 @@ class IGfxFilter;
 typedef std::shared_ptr<IGfxFilter> PGfxFilter;
 using Common::Bitmap;
 using Common::PBitmap;
+using Common::String;
 
 enum TintMethod
 {
@@ -82,6 +84,18 @@ struct RenderMatrixes
     glm::mat4 Projection;
 };
 
+// Rendering statistics of a single frame
+struct RenderStats
+{
+    uint32_t Sprites = 0u;   // number of the sprites drawn
+    uint32_t DrawCalls = 0u; // number of the draw calls issued to the GPU
+    uint64_t UploadBytes = 0u; // size of the texture data uploaded since the previous frame
+    // GPU time spent on rendering, in microseconds; since the GPU works
+    // asynchronously, this is measured for one of the few preceding frames.
+    // Zero if the driver does not support the GPU timing.
+    uint32_t GpuTimeUs = 0u;
+};
+
 
 typedef void (*GFXDRV_CLIENTCALLBACK)();
 typedef bool (*GFXDRV_CLIENTCALLBACKEVT)(int evt, int data);
@@ -138,6 +152,8 @@ public:
   virtual int  GetCompatibleBitmapFormat(int color_depth) = 0;
   // Returns available texture memory in bytes, or 0 if this query is not supported
   virtual uint64_t GetAvailableTextureMemory() = 0;
+  // Returns the rendering statistics of the last rendered frame
+  virtual RenderStats GetRenderStats() const = 0;
 
   // Creates a "raw" DDB, without pixel initialization.
   virtual IDriverDependantBitmap *CreateDDB(int width, int height, int color_depth, bool opaque = false) = 0;
@@ -150,8 +166,29 @@ public:
   // Updates DBB using the given bitmap; if bitmap has a different resolution,
   // then creates a new texture data and attaches to DDB
   virtual void UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, const Bitmap *bitmap, bool has_alpha) = 0;
+  // Updates only the given area of DBB using the given bitmap; the bitmap must have
+  // the same size and format as DDB. The driver may choose to update more than this.
+  virtual void UpdateDDBRegion(IDriverDependantBitmap* bitmapToUpdate, const Bitmap *bitmap, bool has_alpha, const Rect &area) = 0;
   // Destroy the DDB; note that this does not dispose the texture unless there's no more refs to it
   virtual void DestroyDDB(IDriverDependantBitmap* bitmap) = 0;
+  // Returns the max size of YUV 4:2:0 video frames which the driver can draw,
+  // converting them to RGB itself; returns an empty size if not supported.
+  virtual Size GetMaxYUVFrameSize() = 0;
+  // Creates DDB for drawing YUV video frames of the given size
+  virtual IDriverDependantBitmap *CreateYUVFrameDDB(int width, int height) = 0;
+  // Updates YUV frame DDB from the 8-bit bitmap, holding the frame's planes
+  // as described by YUVFrameLayout
+  virtual void UpdateYUVFrameDDB(IDriverDependantBitmap *ddb, const Bitmap *planes) = 0;
+  // Tells if the driver can draw DDBs with an alpha test, see SetDDBAlphaTest
+  virtual bool SupportsAlphaTest() = 0;
+  // Sets the DDB to draw only the pixels which alpha is at least the given
+  // threshold (1-255, or higher to draw none), and draw these opaque;
+  // the threshold of 0 disables the test.
+  virtual void SetDDBAlphaTest(IDriverDependantBitmap *ddb, int threshold) = 0;
+  // Returns the hash of the DDB's texture contents and drawing parameters;
+  // lets tell if the DDB would be drawn differently than when it was hashed
+  // before. Only the drivers which require full redraw each frame track this.
+  virtual uint64_t GetDDBStateHash(IDriverDependantBitmap *ddb) = 0;
 
   // Create texture data with the given parameters
   virtual Texture *CreateTexture(int width, int height, int color_depth, bool opaque = false, bool as_render_target = false) = 0;
@@ -159,6 +196,9 @@ public:
   virtual Texture *CreateTexture(const Bitmap *bmp, bool has_alpha = true, bool opaque = false) = 0;
   // Update texture data from the given bitmap
   virtual void UpdateTexture(Texture *txdata, const Bitmap *bmp, bool has_alpha, bool opaque = false) = 0;
+  // Updates only the given area of texture data from the bitmap of the same size;
+  // the driver may choose to update more than this
+  virtual void UpdateTextureArea(Texture *txdata, const Bitmap *bmp, bool has_alpha, bool opaque, const Rect &area) = 0;
   // Retrieve shared texture object from the given DDB
   virtual std::shared_ptr<Texture> GetTexture(IDriverDependantBitmap *ddb) = 0;
 
@@ -218,12 +258,29 @@ public:
   // must be given in *native* coordinates.
   virtual bool GetCopyOfScreenIntoBitmap(Bitmap *destination, const Rect *src_rect, bool at_native_res,
       GraphicResolution *want_fmt = nullptr, uint32_t batch_skip_filter = 0u) = 0;
+  // Begins an asynchronous copy of the game screen, see GetCopyOfScreenIntoBitmap
+  // for the meaning of parameters. The copy corresponds to the last screen render,
+  // but the renderer may transfer its pixels in the background, letting the caller
+  // retrieve them a frame or two later without stalling the GPU.
+  // Returns the handle of the copy request, or 0 on failure.
+  virtual uint32_t BeginScreenCopy(const Rect *src_rect, bool at_native_res, uint32_t batch_skip_filter = 0u) = 0;
+  // Tells if the screen copy may be retrieved without waiting for it
+  virtual bool IsScreenCopyReady(uint32_t handle) = 0;
+  // Retrieves the screen copy and disposes the request, waiting for the copy
+  // to complete if necessary. Returns the bitmap in the renderer's preferred
+  // pixel format, or null on failure.
+  virtual std::unique_ptr<Bitmap> EndScreenCopy(uint32_t handle) = 0;
   // Tells if the renderer supports toggling vsync after initializing the mode.
   virtual bool DoesSupportVsyncToggle() = 0;
   // Toggles vertical sync mode, if renderer supports one; returns the *new state*.
   virtual bool SetVsync(bool enabled) = 0;
   // Tells if the renderer currently has vsync enabled.
   virtual bool GetVsync() const = 0;
+  // Sets whether to use adaptive vsync, where the frames which missed
+  // the display refresh are presented right away instead of waiting for
+  // the next one. Has effect only if the renderer supports it, and until the
+  // next vsync mode change.
+  virtual void UseAdaptiveVsync(bool enabled) = 0;
   // Enables or disables rendering mode that draws sprite list directly into
   // the final resolution, as opposed to drawing to native-resolution buffer
   // and scaling to final frame. The effect may be that sprites that are
@@ -232,6 +289,32 @@ public:
   // rendered in the high-res mode.
   virtual void RenderSpritesAtScreenResolution(bool enabled) = 0;
   virtual void UseSmoothScaling(bool enabled) = 0;
+  // Enables or disables storing opaque textures in a compact pixel format,
+  // using less video memory at the cost of a reduced color precision.
+  // Affects only the textures created after this call.
+  virtual void SetCompactOpaqueTextures(bool enabled) = 0;
+  // Enables or disables placing the small textures together on the shared
+  // atlas textures, which lets the sprites using them be drawn in one batch.
+  // Affects only the textures created after this call.
+  virtual void SetTextureAtlas(bool enabled) = 0;
+  // Enables or disables reordering of the sprites within each sprite batch,
+  // grouping together those which share the texture and the blending mode;
+  // only the sprites which do not overlap each other may swap their places.
+  virtual void UseStateSorting(bool enabled) = 0;
+  // Enables or disables skipping the render and present of the frames which
+  // would look exactly same as the last presented one; the renderer compares
+  // the draw lists and tracks the texture updates for this purpose.
+  virtual void UseIdleFrameSkip(bool enabled) = 0;
+  // Sets the number of threads which the software renderer uses to composite
+  // sprites in parallel; 0 means choose by the number of CPU cores.
+  virtual void SetRenderThreadCount(int count) = 0;
+  // Sets the file where the renderer may save its compiled shaders, and read
+  // them from on the next run, instead of compiling again; empty path disables
+  // this. Must be called before the display mode is set.
+  virtual void SetShaderCacheFile(const String &path) = 0;
+  // Tells that the last presented frame may no longer be shown on screen
+  // (e.g. the window contents were damaged), and the next one must be rendered.
+  virtual void InvalidateFrame() = 0;
   virtual bool SupportsGammaControl() = 0;
   virtual void SetGamma(int newGamma) = 0;
   // Returns the virtual screen. Will return NULL if renderer does not support memory backbuffer.
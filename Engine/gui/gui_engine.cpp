@@ -123,7 +123,7 @@ void GUIObject::MarkChanged()
 void GUIObject::MarkParentChanged()
 {
     if (ParentId >= 0)
-        guis[ParentId].MarkControlChanged();
+        guis[ParentId].MarkControlLayoutChanged();
 }
 
 void GUIObject::MarkPositionChanged(bool self_changed)
@@ -0,0 +1,223 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "main/benchmark.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "ac/timer.h"
+#include "debug/out.h"
+#include "util/file.h"
+#include "util/stream.h"
+#include "util/textstreamreader.h"
+
+using namespace AGS::Common;
+
+static const char *BenchStageNames[kNumBenchStages] = { "update", "script", "render" };
+
+struct BenchmarkState
+{
+    uint32_t Ticks = 0u; // number of ticks to run
+    std::unique_ptr<Stream> Out;
+    // Times of an earlier run, to compare with
+    std::vector<uint32_t> BaseTimes[kNumBenchStages + 1];
+    bool Started = false; // started counting the time
+    bool Summarized = false;
+    BenchmarkStage Stage = kBenchStage_Update;
+    AGS_Clock::time_point StageStart;
+    AGS_Clock::time_point StartTime;
+    // Times of the current tick, in microseconds
+    uint32_t TickTimes[kNumBenchStages] = {};
+    // Times of all the completed ticks, per stage and total
+    std::vector<uint32_t> Times[kNumBenchStages + 1];
+};
+
+static std::unique_ptr<BenchmarkState> bench;
+
+// Adds the time passed since the last stage switch to the current stage
+static void count_stage_time(AGS_Clock::time_point now)
+{
+    bench->TickTimes[bench->Stage] += static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(now - bench->StageStart).count());
+    bench->StageStart = now;
+}
+
+// Summary of the times of one stage, in milliseconds
+struct BenchmarkStats
+{
+    float Mean = 0.f, Median = 0.f, P95 = 0.f, P99 = 0.f, Max = 0.f;
+};
+
+static BenchmarkStats calc_stats(std::vector<uint32_t> times)
+{
+    BenchmarkStats stats;
+    if (times.empty())
+        return stats;
+    std::sort(times.begin(), times.end());
+    uint64_t sum = 0u;
+    for (const auto t : times)
+        sum += t;
+    const auto percentile = [&times](float p)
+        { return times[std::min(times.size() - 1, static_cast<size_t>(times.size() * p))] / 1000.f; };
+    stats.Mean = sum / 1000.f / times.size();
+    stats.Median = percentile(0.5f);
+    stats.P95 = percentile(0.95f);
+    stats.P99 = percentile(0.99f);
+    stats.Max = times.back() / 1000.f;
+    return stats;
+}
+
+// Reads the per-tick times from the CSV file written by an earlier benchmark
+static bool read_baseline(const String &path, std::vector<uint32_t> (&times)[kNumBenchStages + 1])
+{
+    std::unique_ptr<Stream> in(File::OpenFileRead(path));
+    if (!in)
+        return false;
+    TextStreamReader reader(std::move(in));
+    reader.ReadLine(); // header
+    while (!reader.EOS())
+    {
+        const String line = reader.ReadLine();
+        unsigned tick, t[kNumBenchStages + 1];
+        if (sscanf(line.GetCStr(), "%u,%u,%u,%u,%u", &tick, &t[0], &t[1], &t[2], &t[3]) != 5)
+            continue;
+        for (int i = 0; i <= kNumBenchStages; ++i)
+            times[i].push_back(t[i]);
+    }
+    return !times[kNumBenchStages].empty();
+}
+
+static float change_pc(float value, float base)
+{
+    return base > 0.f ? (value - base) * 100.f / base : 0.f;
+}
+
+static void print_summary()
+{
+    bench->Summarized = true;
+    const size_t ticks = bench->Times[kNumBenchStages].size();
+    Debug::Printf(kDbgMsg_Alert, "Benchmark: %zu ticks in %.2f s", ticks,
+        std::chrono::duration<float>(AGS_Clock::now() - bench->StartTime).count());
+    if (ticks == 0u)
+        return;
+    const bool has_baseline = !bench->BaseTimes[kNumBenchStages].empty();
+    if (has_baseline)
+        Debug::Printf(kDbgMsg_Alert, "Compared with the baseline of %zu ticks", bench->BaseTimes[kNumBenchStages].size());
+    for (int i = 0; i <= kNumBenchStages; ++i)
+    {
+        const char *name = i < kNumBenchStages ? BenchStageNames[i] : "total";
+        const BenchmarkStats s = calc_stats(bench->Times[i]);
+        Debug::Printf(kDbgMsg_Alert, "  %-6s ms: mean %.3f, median %.3f, 95%% %.3f, 99%% %.3f, max %.3f",
+            name, s.Mean, s.Median, s.P95, s.P99, s.Max);
+        if (!has_baseline)
+            continue;
+        const BenchmarkStats b = calc_stats(bench->BaseTimes[i]);
+        Debug::Printf(kDbgMsg_Alert, "  %-6s vs baseline: mean %+.1f%%, median %+.1f%%, 95%% %+.1f%%, 99%% %+.1f%%, max %+.1f%%",
+            name, change_pc(s.Mean, b.Mean), change_pc(s.Median, b.Median), change_pc(s.P95, b.P95),
+            change_pc(s.P99, b.P99), change_pc(s.Max, b.Max));
+    }
+}
+
+bool benchmark_start(uint32_t ticks, const String &out_path, const String &baseline_path)
+{
+    benchmark_stop();
+    // the baseline is read first, in case it's the same file as the output
+    std::vector<uint32_t> base_times[kNumBenchStages + 1];
+    if (!baseline_path.IsEmpty() && !read_baseline(baseline_path, base_times))
+        Debug::Printf(kDbgMsg_Error, "Failed to read the benchmark baseline: %s", baseline_path.GetCStr());
+    std::unique_ptr<Stream> out;
+    if (!out_path.IsEmpty())
+    {
+        out = File::CreateFile(out_path);
+        if (!out)
+        {
+            Debug::Printf(kDbgMsg_Error, "Failed to open benchmark file for writing: %s", out_path.GetCStr());
+            return false;
+        }
+        const char *header = "tick,update_us,script_us,render_us,total_us\n";
+        out->Write(header, strlen(header));
+    }
+    bench.reset(new BenchmarkState());
+    bench->Ticks = ticks;
+    bench->Out = std::move(out);
+    for (int i = 0; i <= kNumBenchStages; ++i)
+        bench->BaseTimes[i] = std::move(base_times[i]);
+    Debug::Printf(kDbgMsg_Info, "Benchmark set to run for %u ticks", ticks);
+    return true;
+}
+
+void benchmark_stop()
+{
+    if (bench && !bench->Summarized)
+        print_summary();
+    bench.reset();
+}
+
+bool benchmark_is_running()
+{
+    return bench != nullptr;
+}
+
+BenchmarkStage benchmark_enter_stage(BenchmarkStage stage)
+{
+    const BenchmarkStage prev = bench->Stage;
+    if (!bench->Started)
+    {
+        // the time is counted from the first game update
+        if (stage != kBenchStage_Update)
+            return prev;
+        bench->Started = true;
+        bench->StartTime = bench->StageStart = AGS_Clock::now();
+    }
+    count_stage_time(AGS_Clock::now());
+    bench->Stage = stage;
+    return prev;
+}
+
+void benchmark_leave_stage(BenchmarkStage prev)
+{
+    if (!bench->Started)
+        return;
+    count_stage_time(AGS_Clock::now());
+    bench->Stage = prev;
+}
+
+bool benchmark_end_tick()
+{
+    if (!bench || !bench->Started || bench->Summarized)
+        return false;
+    count_stage_time(AGS_Clock::now());
+    uint32_t total = 0u;
+    for (int i = 0; i < kNumBenchStages; ++i)
+    {
+        bench->Times[i].push_back(bench->TickTimes[i]);
+        total += bench->TickTimes[i];
+    }
+    bench->Times[kNumBenchStages].push_back(total);
+    const size_t tick = bench->Times[kNumBenchStages].size();
+    if (bench->Out)
+    {
+        String line = String::FromFormat("%zu,%u,%u,%u,%u\n", tick,
+            bench->TickTimes[kBenchStage_Update], bench->TickTimes[kBenchStage_Script],
+            bench->TickTimes[kBenchStage_Render], total);
+        bench->Out->Write(line.GetCStr(), line.GetLength());
+    }
+    std::fill(std::begin(bench->TickTimes), std::end(bench->TickTimes), 0u);
+    if (tick < bench->Ticks)
+        return false;
+    print_summary();
+    bench->Out.reset();
+    return true;
+}
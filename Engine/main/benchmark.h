@@ -0,0 +1,73 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Benchmark mode: runs the game for the given number of ticks, measuring
+// the time spent in the game update, the scripts and the rendering on each
+// tick. The times are counted from the first game update; a stage nested in
+// another one, such as the game update run by a blocking script function,
+// is not counted for the outer stage. The per-tick times are written into
+// the CSV file, and their summary is printed into the log at the end,
+// along with the change from the baseline, if the times of an earlier run
+// were given.
+//
+//=============================================================================
+#ifndef __AGS_EE_MAIN__BENCHMARK_H
+#define __AGS_EE_MAIN__BENCHMARK_H
+
+#include <cstdint>
+#include "util/string.h"
+
+enum BenchmarkStage
+{
+    kBenchStage_Update,
+    kBenchStage_Script,
+    kBenchStage_Render,
+    kNumBenchStages
+};
+
+// Starts the benchmark which runs for the given number of ticks;
+// the per-tick times are written into the file, if the path is set;
+// the baseline is the file written by an earlier benchmark, if set
+bool benchmark_start(uint32_t ticks, const AGS::Common::String &out_path,
+    const AGS::Common::String &baseline_path);
+// Stops the benchmark, printing the summary if it was not done yet
+void benchmark_stop();
+// Tells if the benchmark is running
+bool benchmark_is_running();
+// Switches the stage which the time is counted for; returns the previous one
+BenchmarkStage benchmark_enter_stage(BenchmarkStage stage);
+// Returns to the previous stage
+void benchmark_leave_stage(BenchmarkStage prev);
+// Completes the game tick; returns true when all the ticks are done
+bool benchmark_end_tick();
+
+// Counts the time for the stage, while in scope
+class BenchmarkStageScope
+{
+public:
+    BenchmarkStageScope(BenchmarkStage stage)
+        : _active(benchmark_is_running())
+        , _prev(_active ? benchmark_enter_stage(stage) : kBenchStage_Update) {}
+    ~BenchmarkStageScope()
+    {
+        if (_active)
+            benchmark_leave_stage(_prev);
+    }
+
+private:
+    const bool _active;
+    const BenchmarkStage _prev;
+};
+
+#endif // __AGS_EE_MAIN__BENCHMARK_H
@@ -331,6 +331,9 @@ void apply_config(const ConfigTree &cfg)
 
         usetup.Screen.Params.RefreshRate = CfgReadInt(cfg, "graphics", "refresh");
         usetup.Screen.Params.VSync = CfgReadBoolInt(cfg, "graphics", "vsync");
+        usetup.Screen.Params.AdaptiveVSync = CfgReadBoolInt(cfg, "graphics", "adaptive_vsync");
+        usetup.FramePacing = CfgReadBoolInt(cfg, "graphics", "frame_pacing", usetup.FramePacing);
+        usetup.FrameInterpolation = CfgReadBoolInt(cfg, "graphics", "frame_interpolation", usetup.FrameInterpolation);
         usetup.RenderAtScreenRes = CfgReadBoolInt(cfg, "graphics", "render_at_screenres");
         usetup.enable_antialiasing = CfgReadBoolInt(cfg, "graphics", "antialias", usetup.enable_antialiasing);
         usetup.software_render_driver = CfgReadString(cfg, "graphics", "software_driver");
@@ -346,6 +349,21 @@ void apply_config(const ConfigTree &cfg)
         usetup.user_data_dir = CfgReadString(cfg, "misc", "user_data_dir");
         usetup.shared_data_dir = CfgReadString(cfg, "misc", "shared_data_dir");
         usetup.show_fps = CfgReadBoolInt(cfg, "misc", "show_fps");
+        usetup.script_profile_path = CfgReadString(cfg, "misc", "script_profile");
+        usetup.script_profile_interval = CfgReadInt(cfg, "misc", "script_profile_interval", usetup.script_profile_interval);
+        usetup.asset_trace_path = CfgReadString(cfg, "misc", "asset_trace");
+        usetup.render_trace_path = CfgReadString(cfg, "misc", "render_trace");
+        usetup.event_trace_path = CfgReadString(cfg, "misc", "event_trace");
+        usetup.benchmark_ticks = static_cast<uint32_t>(std::max(0, CfgReadInt(cfg, "misc", "benchmark_ticks")));
+        usetup.benchmark_out_path = CfgReadString(cfg, "misc", "benchmark_out");
+        usetup.benchmark_baseline_path = CfgReadString(cfg, "misc", "benchmark_baseline");
+        usetup.video_capture_path = CfgReadString(cfg, "misc", "video_capture");
+        usetup.video_capture_uncapped = CfgReadBoolInt(cfg, "misc", "video_capture_uncapped");
+        usetup.input_record_path = CfgReadString(cfg, "misc", "input_record");
+        usetup.input_replay_path = CfgReadString(cfg, "misc", "input_replay");
+        usetup.cache_stats_interval = CfgReadInt(cfg, "misc", "cache_stats_interval", usetup.cache_stats_interval);
+        usetup.StartupProfile = CfgReadBoolInt(cfg, "misc", "startup_profile", usetup.StartupProfile);
+        usetup.JobThreads = CfgReadInt(cfg, "misc", "job_threads", usetup.JobThreads);
 
         // Translation / localization
         usetup.translation = CfgReadString(cfg, "language", "translation");
@@ -354,8 +372,32 @@ void apply_config(const ConfigTree &cfg)
         usetup.clear_cache_on_room_change = CfgReadBoolInt(cfg, "misc", "clear_cache_on_room_change", usetup.clear_cache_on_room_change);
         usetup.SpriteCacheSize = CfgReadInt(cfg, "graphics", "sprite_cache_size", usetup.SpriteCacheSize);
         usetup.TextureCacheSize = CfgReadInt(cfg, "graphics", "texture_cache_size", usetup.TextureCacheSize);
+        usetup.TextureVramBudget = CfgReadInt(cfg, "graphics", "texture_vram_budget", 0, 100, usetup.TextureVramBudget);
+        usetup.TextureUploadTime = CfgReadInt(cfg, "graphics", "texture_upload_time", usetup.TextureUploadTime);
+        usetup.MemoryBudget = CfgReadInt(cfg, "misc", "memory_budget", usetup.MemoryBudget);
+        usetup.SpriteCacheIndexed = CfgReadBoolInt(cfg, "graphics", "sprite_cache_indexed", usetup.SpriteCacheIndexed);
+        const CstrArr<kNumCachePolicies> cache_policies{ "lru", "slru", "cost" };
+        usetup.SpriteCachePolicy = StrUtil::ParseEnum<ResourceCachePolicy>(
+            CfgReadString(cfg, "graphics", "sprite_cache_policy"), cache_policies, usetup.SpriteCachePolicy);
+        usetup.TextureCachePolicy = StrUtil::ParseEnum<ResourceCachePolicy>(
+            CfgReadString(cfg, "graphics", "texture_cache_policy"), cache_policies, usetup.TextureCachePolicy);
+        usetup.CompactOpaqueTextures = CfgReadBoolInt(cfg, "graphics", "compact_opaque_textures", usetup.CompactOpaqueTextures);
+        usetup.TextureAtlas = CfgReadBoolInt(cfg, "graphics", "texture_atlas", usetup.TextureAtlas);
+        usetup.SpriteStateSorting = CfgReadBoolInt(cfg, "graphics", "sprite_state_sorting", usetup.SpriteStateSorting);
+        usetup.IdleFrameSkip = CfgReadBoolInt(cfg, "graphics", "idle_frame_skip", usetup.IdleFrameSkip);
+        usetup.SoftwareRenderThreads = CfgReadInt(cfg, "graphics", "software_render_threads", usetup.SoftwareRenderThreads);
+        usetup.SpritePrepareThreads = CfgReadInt(cfg, "graphics", "sprite_prepare_threads", usetup.SpritePrepareThreads);
+        usetup.DirtyTiles = CfgReadBoolInt(cfg, "graphics", "dirty_tiles", usetup.DirtyTiles);
         usetup.SoundCacheSize = CfgReadInt(cfg, "sound", "cache_size", usetup.SoundCacheSize);
         usetup.SoundLoadAtOnceSize = CfgReadInt(cfg, "sound", "stream_threshold", usetup.SoundLoadAtOnceSize);
+        usetup.SoundPcmCacheSize = CfgReadInt(cfg, "sound", "pcm_cache_size", usetup.SoundPcmCacheSize);
+        usetup.SoundPcmMaxLength = CfgReadInt(cfg, "sound", "pcm_cache_max_length", usetup.SoundPcmMaxLength);
+        usetup.SoundBufferCount = CfgReadInt(cfg, "sound", "buffer_count", usetup.SoundBufferCount);
+        usetup.SoundBufferSize = CfgReadInt(cfg, "sound", "buffer_size", usetup.SoundBufferSize);
+        usetup.SoundPollInterval = CfgReadInt(cfg, "sound", "poll_interval", usetup.SoundPollInterval);
+        usetup.SoundHighPriority = CfgReadString(cfg, "sound", "thread_priority", "normal").CompareNoCase("high") == 0;
+        usetup.SoundMaxVoices = CfgReadInt(cfg, "sound", "max_voices", usetup.SoundMaxVoices);
+        usetup.SoundDecodeThreads = CfgReadInt(cfg, "sound", "decode_threads", usetup.SoundDecodeThreads);
 
         // Mouse options
         usetup.mouse_auto_lock = CfgReadBoolInt(cfg, "mouse", "auto_lock");
@@ -370,6 +412,7 @@ void apply_config(const ConfigTree &cfg)
         mouse_str = CfgReadString(cfg, "mouse", "speed_def", "current_display");
         usetup.mouse_speed_def = StrUtil::ParseEnum<MouseSpeedDef>(
             mouse_str, CstrArr<kNumMouseSpeedDefs>{ "absolute", "current_display" }, usetup.mouse_speed_def);
+        usetup.mouse_hw_cursor = CfgReadBoolInt(cfg, "mouse", "hardware_cursor", usetup.mouse_hw_cursor);
 
         // Touch options
         usetup.touch_emulate_mouse = StrUtil::ParseEnum<TouchMouseEmulation>(
@@ -379,6 +422,12 @@ void apply_config(const ConfigTree &cfg)
 
         // Various system options
         usetup.multitasking = CfgReadInt(cfg, "misc", "background", 0) != 0;
+        usetup.HierarchicalPathfinder = CfgReadBoolInt(cfg, "misc", "hierarchical_pathfinder", usetup.HierarchicalPathfinder);
+        usetup.AsyncPathfinder = CfgReadBoolInt(cfg, "misc", "async_pathfinder", usetup.AsyncPathfinder);
+        usetup.RoomPreload = CfgReadBoolInt(cfg, "misc", "room_preload", usetup.RoomPreload);
+        usetup.CompressSaves = CfgReadBoolInt(cfg, "misc", "compress_saves", usetup.CompressSaves);
+        usetup.DeltaSaves = CfgReadInt(cfg, "misc", "delta_saves", usetup.DeltaSaves);
+        usetup.ScriptJit = CfgReadBoolInt(cfg, "misc", "script_jit", usetup.ScriptJit);
 
         // User's overrides and hacks
         usetup.override_multitasking = CfgReadInt(cfg, "override", "multitasking", -1);
@@ -21,6 +21,10 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdexcept>
+#include <vector>
+#if !defined(AGS_DISABLE_THREADS)
+#include <thread>
+#endif
 #if AGS_PLATFORM_OS_WINDOWS
 #include <process.h>  // _spawnl
 #endif
@@ -46,21 +50,27 @@
 #include "ac/roomstatus.h"
 #include "ac/speech.h"
 #include "ac/spritecache.h"
+#include "ac/timer.h"
 #include "ac/translation.h"
 #include "ac/viewframe.h"
+#include "ac/dynobj/managedobjectpool.h"
 #include "ac/dynobj/scriptobject.h"
 #include "ac/dynobj/scriptsystem.h"
 #include "core/assetmanager.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
+#include "debug/eventtrace.h"
 #include "debug/out.h"
 #include "device/mousew32.h"
 #include "font/agsfontrenderer.h"
 #include "font/fonts.h"
+#include "game/roomstruct.h"
+#include "gfx/bitmappool.h"
 #include "gfx/graphicsdriver.h"
 #include "gfx/gfxdriverfactory.h"
 #include "gfx/ddb.h"
 #include "media/audio/sound.h"
+#include "main/benchmark.h"
 #include "main/config.h"
 #include "main/game_file.h"
 #include "main/game_start.h"
@@ -68,12 +78,15 @@
 #include "main/engine_setup.h"
 #include "main/graphics_mode.h"
 #include "main/main.h"
+#include "main/video_capture.h"
 #include "media/audio/audio_core.h"
 #include "platform/base/sys_main.h"
 #include "platform/base/agsplatformdriver.h"
 #include "script/script_runtime.h"
 #include "util/directory.h"
 #include "util/error.h"
+#include "util/jobscheduler.h"
+#include "util/memory_budget.h"
 #include "util/path.h"
 #include "util/string_utils.h"
 
@@ -86,6 +99,7 @@ extern bool justRunSetup;
 extern GameSetupStruct game;
 extern int proper_exit;
 extern SpriteCache spriteset;
+extern RoomStruct thisroom;
 extern ScriptObject scrObj[MAX_ROOM_OBJECTS];
 extern std::vector<ViewStruct> views;
 extern int displayed_room;
@@ -99,6 +113,9 @@ extern CharacterInfo*playerchar;
 
 ResourcePaths ResPaths;
 
+// Max number of threads chosen automatically for the parallel jobs
+static const size_t MaxAutoJobThreads = 8u;
+
 t_engine_pre_init_callback engine_pre_init_callback = nullptr;
 
 bool engine_init_backend()
@@ -376,7 +393,14 @@ void engine_init_audio()
         if (res)
         {
             try {
-                audio_core_init(); // audio core system
+                AudioCoreConfig config;
+                config.BufferCount = usetup.SoundBufferCount;
+                config.BufferSize = usetup.SoundBufferSize * 1024;
+                config.PollIntervalMs = usetup.SoundPollInterval;
+                config.HighPriority = usetup.SoundHighPriority;
+                config.MaxVoices = usetup.SoundMaxVoices;
+                config.DecodeThreads = usetup.SoundDecodeThreads;
+                audio_core_init(config); // audio core system
             }
             catch (std::runtime_error& ex) {
                 Debug::Printf(kDbgMsg_Error, "Failed to initialize audio system: %s", ex.what());
@@ -389,6 +413,7 @@ void engine_init_audio()
     if (usetup.audio_enabled)
     {
         soundcache_set_rules(usetup.SoundLoadAtOnceSize * 1024, usetup.SoundCacheSize * 1024);
+        soundcache_set_pcm_rules(usetup.SoundPcmCacheSize * 1024, usetup.SoundPcmMaxLength);
     }
     else
     {
@@ -430,7 +455,7 @@ void engine_init_exit_handler()
 
 void engine_init_pathfinder()
 {
-    init_pathfinder(loaded_game_file_version);
+    init_pathfinder(loaded_game_file_version, usetup.HierarchicalPathfinder);
 }
 
 void engine_pre_init_gfx()
@@ -569,28 +594,99 @@ void show_preload()
     }
 }
 
-HError engine_init_sprites()
+// The result of opening the sprite file, which is done alongside the game data load
+static HError sprite_open_err;
+#if !defined(AGS_DISABLE_THREADS)
+static std::thread sprite_open_thread;
+#endif
+
+static void engine_open_sprite_file(std::unique_ptr<Stream> sprite_file, std::unique_ptr<Stream> index_file)
+{
+    sprite_open_err = spriteset.OpenFile(std::move(sprite_file), std::move(index_file));
+}
+
+// Begins opening the sprite file and reading its index on a worker thread;
+// this only reads the file, and does not depend on the game data
+void engine_begin_open_sprites()
 {
     spriteset.Reset();
-    Debug::Printf(kDbgMsg_Info, "Initialize sprites");
+    Debug::Printf(kDbgMsg_Info, "Open sprite file");
     auto sprite_file = AssetMgr->OpenAsset(SpriteFile::DefaultSpriteFileName);
     if (!sprite_file)
     {
-        return new Error(String::FromFormat("Failed to open spriteset file '%s'.",
+        sprite_open_err = new Error(String::FromFormat("Failed to open spriteset file '%s'.",
             SpriteFile::DefaultSpriteFileName.GetCStr()));
+        return;
     }
     auto index_file = AssetMgr->OpenAsset(SpriteFile::DefaultSpriteIndexName);
-    HError err = spriteset.InitFile(std::move(sprite_file), std::move(index_file));
-    if (!err) 
+#if !defined(AGS_DISABLE_THREADS)
+    sprite_open_thread = std::thread(engine_open_sprite_file, std::move(sprite_file), std::move(index_file));
+#else
+    engine_open_sprite_file(std::move(sprite_file), std::move(index_file));
+#endif
+}
+
+// Waits for the sprite file to be opened
+void engine_end_open_sprites()
+{
+#if !defined(AGS_DISABLE_THREADS)
+    if (sprite_open_thread.joinable())
+        sprite_open_thread.join();
+#endif
+}
+
+HError engine_init_sprites()
+{
+    Debug::Printf(kDbgMsg_Info, "Initialize sprites");
+    if (!sprite_open_err)
     {
-        return err;
+        return sprite_open_err;
     }
+    spriteset.InitFromFile();
     if (usetup.SpriteCacheSize > 0)
         spriteset.SetMaxCacheSize(usetup.SpriteCacheSize * 1024);
+    spriteset.SetKeepIndexed(usetup.SpriteCacheIndexed);
+    spriteset.SetCachePolicy(usetup.SpriteCachePolicy);
     Debug::Printf("Sprite cache set: %zu KB", spriteset.GetMaxCacheSize() / 1024);
+    MemoryBudget::Register("sprites", MemoryBudget::kPriority_Sprites,
+        []() { return spriteset.GetCacheSize(); },
+        [](size_t size) { return spriteset.ShrinkCache(size); });
     return HError::None();
 }
 
+// Gets the memory taken by the current room's images
+static size_t get_room_data_size()
+{
+    size_t size = 0u;
+    for (size_t i = 0; i < thisroom.BgFrameCount; ++i)
+    {
+        const auto &frame = thisroom.BgFrames[i];
+        size += frame.PackedData.size();
+        if (frame.Graphic)
+            size += frame.Graphic->GetDataSize();
+    }
+    for (const auto &mask : { thisroom.HotspotMask, thisroom.RegionMask, thisroom.WalkAreaMask, thisroom.WalkBehindMask })
+    {
+        if (mask)
+            size += mask->GetDataSize();
+    }
+    return size;
+}
+
+// Registers the engine's data which is only accounted, and sets the memory budget
+static void engine_init_memory_budget()
+{
+    MemoryBudget::Register("script objects", MemoryBudget::kPriority_Fixed,
+        []() { return pool.GetTotalDataSize(); });
+    MemoryBudget::Register("room", MemoryBudget::kPriority_Fixed, get_room_data_size);
+    MemoryBudget::Register("scratch bitmaps", MemoryBudget::kPriority_ScratchBitmaps,
+        []() { return BitmapPool::Global().GetSize(); },
+        [](size_t size) { return BitmapPool::Global().Shrink(size); });
+    MemoryBudget::SetBudget(usetup.MemoryBudget * 1024);
+    if (usetup.MemoryBudget > 0)
+        Debug::Printf("Memory budget set: %zu KB", usetup.MemoryBudget);
+}
+
 // TODO: this should not be a part of "engine_" function group,
 // move this elsewhere (InitGameState?).
 void engine_init_game_settings()
@@ -598,8 +694,18 @@ void engine_init_game_settings()
     set_our_eip(-7);
     Debug::Printf("Initialize game settings");
 
-    // Initialize randomizer
-    play.randseed = time(nullptr);
+    // Initialize randomizer; the input replay requires the recorded seed,
+    // and the benchmark and the uncapped video capture use a fixed one
+    // to make the runs comparable
+    int randseed = static_cast<int>(time(nullptr));
+    if (!usetup.input_replay_path.IsEmpty())
+        sys_evt_start_replay(usetup.input_replay_path, randseed);
+    else if ((usetup.benchmark_ticks > 0) ||
+        (!usetup.video_capture_path.IsEmpty() && usetup.video_capture_uncapped))
+        randseed = 0;
+    if (!usetup.input_record_path.IsEmpty())
+        sys_evt_start_recording(usetup.input_record_path, randseed);
+    play.randseed = randseed;
     srand(play.randseed);
 
     if (usetup.audio_enabled)
@@ -1169,16 +1275,48 @@ void engine_init_editor_debugging(const ConfigTree &cfg)
 // TODO: this function is still a big mess, engine/system-related initialization
 // is mixed with game-related data adjustments. Divide it in parts, move game
 // data init into either InitGameState() or other game method as appropriate.
+// Startup stage timing, printed when the "startup_profile" option is enabled
+static AGS_Clock::time_point startup_start;
+static AGS_Clock::time_point startup_mark;
+static std::vector<std::pair<const char*, uint32_t>> startup_stages;
+
+static void startup_stage_done(const char *stage)
+{
+    const auto now = AGS_Clock::now();
+    startup_stages.emplace_back(stage, static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(now - startup_mark).count()));
+    startup_mark = now;
+}
+
+static void print_startup_profile()
+{
+    if (!usetup.StartupProfile)
+        return;
+    const auto total = std::chrono::duration_cast<std::chrono::microseconds>(AGS_Clock::now() - startup_start).count();
+    Debug::Printf(kDbgMsg_Info, "Engine startup took %.2f ms:", total / 1000.0);
+    for (const auto &stage : startup_stages)
+        Debug::Printf(kDbgMsg_Info, "  %-16s %8.2f ms", stage.first, stage.second / 1000.0);
+}
+
 int initialize_engine(const ConfigTree &startup_opts)
 {
+    startup_start = startup_mark = AGS_Clock::now();
     if (engine_pre_init_callback) {
         engine_pre_init_callback();
     }
 
     //-----------------------------------------------------
     // Install backend
+    // the null graphics driver does not need a real video device
+    if (CfgReadString(startup_opts, "graphics", "driver").CompareNoCase("Null") == 0)
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
     if (!engine_init_backend())
         return EXIT_ERROR;
+    startup_stage_done("backend");
+
+    const size_t job_threads = JobScheduler::ResolveThreadCount(usetup.JobThreads, MaxAutoJobThreads);
+    JobScheduler::InitGlobal(job_threads - 1);
+    Debug::Printf(kDbgMsg_Info, "Running the parallel jobs on %zu thread(s)", job_threads);
 
     //-----------------------------------------------------
     // Connect to the external debugger, if required;
@@ -1188,6 +1326,7 @@ int initialize_engine(const ConfigTree &startup_opts)
         !(justTellInfo || justRunSetup))
     {
         engine_init_editor_debugging(startup_opts);
+        startup_stage_done("debugger");
     }
 
     //-----------------------------------------------------
@@ -1202,6 +1341,7 @@ int initialize_engine(const ConfigTree &startup_opts)
         return EXIT_ERROR;
     ConfigTree cfg;
     engine_prepare_config(cfg, startup_opts);
+    startup_stage_done("locate data");
     // Test if need to run built-in setup program (where available)
     if (!justTellInfo && justRunSetup)
     {
@@ -1211,6 +1351,7 @@ int initialize_engine(const ConfigTree &startup_opts)
     }
     // Set up game options from user config
     engine_set_config(cfg);
+    startup_stage_done("config");
     if (justTellInfo)
     {
         engine_print_info(tellInfoKeys, &cfg);
@@ -1235,12 +1376,32 @@ int initialize_engine(const ConfigTree &startup_opts)
 
     engine_assign_assetpaths();
 
+    if (!usetup.asset_trace_path.IsEmpty())
+        asset_trace_start(usetup.asset_trace_path);
+    if (!usetup.render_trace_path.IsEmpty())
+        render_trace_start(usetup.render_trace_path);
+    if (!usetup.event_trace_path.IsEmpty())
+    {
+        EventTrace::SetThreadName("Game");
+        EventTrace::Start(usetup.event_trace_path);
+    }
+    if (usetup.benchmark_ticks > 0)
+    {
+        setTimerUncapped(true);
+        benchmark_start(usetup.benchmark_ticks, usetup.benchmark_out_path, usetup.benchmark_baseline_path);
+    }
+    if (!usetup.video_capture_path.IsEmpty() && usetup.video_capture_uncapped)
+        setTimerUncapped(true);
+    setFramePacing(usetup.FramePacing);
+    startup_stage_done("asset paths");
+
     //-----------------------------------------------------
     // Begin setting up systems
 
     set_our_eip(-194);
 
     engine_init_fonts();
+    startup_stage_done("fonts");
 
     set_our_eip(-195);
 
@@ -1253,6 +1414,7 @@ int initialize_engine(const ConfigTree &startup_opts)
     set_our_eip(-198);
 
     engine_init_audio();
+    startup_stage_done("audio");
 
     set_our_eip(-199);
 
@@ -1269,7 +1431,11 @@ int initialize_engine(const ConfigTree &startup_opts)
     set_our_eip(-20);
     set_our_eip(-19);
 
+    // The sprite file is opened in parallel with the game data load
+    engine_begin_open_sprites();
     int res = engine_load_game_data();
+    engine_end_open_sprites();
+    startup_stage_done("game data");
     if (res != 0)
         return res;
 
@@ -1293,6 +1459,7 @@ int initialize_engine(const ConfigTree &startup_opts)
     // Attempt to initialize graphics mode
     if (!engine_try_set_gfxmode_any(usetup.Screen))
         return EXIT_ERROR;
+    startup_stage_done("graphics");
 
     // Configure game window after renderer was initialized
     engine_setup_window();
@@ -1302,16 +1469,24 @@ int initialize_engine(const ConfigTree &startup_opts)
     sys_window_show_cursor(false); // hide the system cursor
 
     show_preload();
+    startup_stage_done("splash");
     HError err = engine_init_sprites();
     if (!err)
     {
         platform->DisplayAlert("Could not load sprite set file:\n%s", err->FullMessage().GetCStr());
         return EXIT_ERROR;
     }
+    startup_stage_done("sprites");
+    engine_init_memory_budget();
 
     // TODO: move *init_game_settings to game init code unit
     engine_init_game_settings();
     engine_prepare_to_start_game();
+    startup_stage_done("game settings");
+    print_startup_profile();
+
+    if (!usetup.video_capture_path.IsEmpty())
+        video_capture_start(usetup.video_capture_path);
 
     initialize_start_and_play_game(override_start_room, loadSaveGameOnStartup);
 
@@ -209,6 +209,8 @@ void on_coordinates_scaling_changed()
 {
     // Reset mouse graphic area and bounds
     Mouse::UpdateGraphicArea();
+    // Remake the system cursor in the new scale
+    refresh_hardware_cursor();
     // If mouse bounds do not have valid values yet, then limit cursor to viewport
     if (play.mboundx1 == 0 && play.mboundy1 == 0 && play.mboundx2 == 0 && play.mboundy2 == 0)
         Mouse::SetMoveLimit(play.GetMainViewport());
@@ -26,6 +26,7 @@
 #include "ac/gamesetupstruct.h"
 #include "ac/gamestructdefines.h"
 #include "ac/gui.h"
+#include "ac/timer.h"
 #include "ac/viewframe.h"
 #include "core/assetmanager.h"
 #include "debug/debug_log.h"
@@ -133,7 +134,7 @@ static inline HError MakeScriptLoadError(const char *name)
 HError LoadGameScripts(LoadedGameEntities &ents)
 {
     // Global script
-    auto in = AssetMgr->OpenAsset("GlobalScript.o");
+    auto in = AssetMgr->OpenAsset("GlobalScript.o", kAssetOpen_ReadWhole);
     if (in)
     {
         PScript script(ccScript::CreateFromStream(in.get()));
@@ -142,7 +143,7 @@ HError LoadGameScripts(LoadedGameEntities &ents)
         ents.GlobalScript = script;
     }
     // Dialog script
-    in = AssetMgr->OpenAsset("DialogScript.o");
+    in = AssetMgr->OpenAsset("DialogScript.o", kAssetOpen_ReadWhole);
     if (in)
     {
         PScript script(ccScript::CreateFromStream(in.get()));
@@ -153,7 +154,7 @@ HError LoadGameScripts(LoadedGameEntities &ents)
     // Script modules
     // First load a modules list
     std::vector<String> modules;
-    in = AssetMgr->OpenAsset("ScriptModules.lst");
+    in = AssetMgr->OpenAsset("ScriptModules.lst", kAssetOpen_ReadWhole);
     if (in)
     {
         TextStreamReader reader(std::move(in));
@@ -165,7 +166,7 @@ HError LoadGameScripts(LoadedGameEntities &ents)
     // Now run by the list and try loading everything
     for (size_t i = 0; i < modules.size(); ++i)
     {
-        in = AssetMgr->OpenAsset(modules[i]);
+        in = AssetMgr->OpenAsset(modules[i], kAssetOpen_ReadWhole);
         if (in)
         {
             PScript script(ccScript::CreateFromStream(in.get()));
@@ -177,8 +178,19 @@ HError LoadGameScripts(LoadedGameEntities &ents)
     return HError::None();
 }
 
+// Returns the time passed since the mark in microseconds, and moves the mark
+static uint32_t load_stage_time(AGS_Clock::time_point &mark)
+{
+    const auto now = AGS_Clock::now();
+    const uint32_t us = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(now - mark).count());
+    mark = now;
+    return us;
+}
+
 HError load_game_file()
 {
+    auto mark = AGS_Clock::now();
     MainGameSource src;
     LoadedGameEntities ents(game);
     HError err = (HError)OpenMainGameFileFromDefaultAsset(src, AssetMgr.get());
@@ -187,6 +199,7 @@ HError load_game_file()
     err = (HError)ReadGameData(ents, std::move(src.InputStream), src.DataVersion);
     if (!err)
         return err;
+    const uint32_t read_time = load_stage_time(mark);
 
     //-------------------------------------------------------------------------
     // Data overrides: for compatibility mode and custom engine support
@@ -219,12 +232,18 @@ HError load_game_file()
     // Search the asset locations for old-style audio files and recreate clips array;
     // we do this separately after UpdateGameData, because this involves scanning enviroment.
     ScanOldStyleAudio(AssetMgr.get(), ents.Game, ents.Views, src.DataVersion);
+    const uint32_t update_time = load_stage_time(mark);
     err = LoadGameScripts(ents);
     if (!err)
         return err;
+    const uint32_t scripts_time = load_stage_time(mark);
     err = (HError)InitGameState(ents, src.DataVersion);
     if (!err)
         return err;
+    const uint32_t init_time = load_stage_time(mark);
+    if (usetup.StartupProfile)
+        Debug::Printf(kDbgMsg_Info, "Game data (version %d) loaded: read %.2f ms, upgrade %.2f ms, scripts %.2f ms, init %.2f ms",
+            src.DataVersion, read_time / 1000.0, update_time / 1000.0, scripts_time / 1000.0, init_time / 1000.0);
 
     GUIE::MarkAllGUIForUpdate(true, true);
     return HError::None();
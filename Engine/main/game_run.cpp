@@ -25,6 +25,7 @@
 #include "ac/characterextras.h"
 #include "ac/characterinfo.h"
 #include "ac/draw.h"
+#include "ac/draw_software.h"
 #include "ac/event.h"
 #include "ac/game.h"
 #include "ac/gamesetup.h"
@@ -43,7 +44,9 @@
 #include "ac/overlay.h"
 #include "ac/spritecache.h"
 #include "ac/sys_events.h"
+#include "ac/timer.h"
 #include "ac/room.h"
+#include "ac/room_preload.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
 #include "ac/viewframe.h"
@@ -51,20 +54,24 @@
 #include "ac/walkbehind.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "debug/eventtrace.h"
 #include "device/mousew32.h"
 #include "gui/animatingguibutton.h"
 #include "gui/guiinv.h"
 #include "gui/guimain.h"
 #include "gui/guitextbox.h"
+#include "main/benchmark.h"
 #include "main/engine.h"
 #include "main/game_run.h"
 #include "main/update.h"
+#include "main/video_capture.h"
 #include "media/audio/audio_system.h"
 #include "platform/base/agsplatformdriver.h"
 #include "plugin/agsplugin_evts.h"
 #include "plugin/plugin_engine.h"
 #include "script/script.h"
 #include "script/script_runtime.h"
+#include "util/memory_budget.h"
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
@@ -72,6 +79,7 @@ using namespace AGS::Engine;
 extern int mouse_on_iface;   // mouse cursor is over this interface
 extern int ifacepopped;
 extern volatile bool want_exit, abort_engine;
+extern volatile bool game_update_suspend;
 extern int proper_exit;
 extern int displayed_room, starting_room, in_new_room, new_room_was;
 extern ScriptSystem scsystem;
@@ -748,6 +756,7 @@ static void game_loop_check_controls(bool checkControls)
 
 static void game_loop_do_update()
 {
+    AGS_TRACE_ZONE("game_loop_do_update");
     if (debug_flags & DBG_NOUPDATE) ;
     else if (game_paused==0) update_stuff();
 }
@@ -927,6 +936,58 @@ static void game_loop_update_fps()
     }
 }
 
+// Periodically prints the resource cache stats into the log, if requested by config
+static void game_loop_update_cache_stats()
+{
+    if (usetup.cache_stats_interval <= 0)
+        return;
+    static auto last_time = AGS_Clock::now();
+    const auto now = AGS_Clock::now();
+    if (now - last_time < std::chrono::seconds(usetup.cache_stats_interval))
+        return;
+    last_time = now;
+    Debug::Printf(kDbgMsg_Info, "%s", GetCacheStats().GetCStr());
+    // Frame times are reported for each period separately
+    const FrameTimeStats ft = getFrameTimeStats();
+    Debug::Printf(kDbgMsg_Info, "Frame time: frames %u, mean %.2f ms, std dev %.2f ms, max %.2f ms",
+        ft.Frames, ft.MeanMs, ft.StdDevMs, ft.MaxMs);
+    resetFrameTimeStats();
+    const InvalidRegionStats &reg = get_invalid_region_stats();
+    if (reg.Updates > 0u)
+        Debug::Printf(kDbgMsg_Info, "Dirty regions: updates %u, redrawn %.1f%% of pixels",
+            reg.Updates, reg.SurfacePixels > 0u ? reg.RedrawnPixels * 100.0 / reg.SurfacePixels : 0.0);
+    reset_invalid_region_stats();
+}
+
+// Renders the frames interpolated between the game ticks, for as long as
+// there's time left until the next tick; the renderer's vsync limits their rate
+static void game_loop_render_interpolated(IDriverDependantBitmap *extraBitmap, int extraX, int extraY)
+{
+    if (!is_frame_interpolation_on() || isTimerFpsMaxed())
+        return;
+    auto render_time = AGS_Clock::duration::zero();
+    for (auto now = AGS_Clock::now(); (now + render_time < getNextFrameTime()) && !game_update_suspend;
+         now = AGS_Clock::now())
+    {
+        if (!render_graphics_interpolated(extraBitmap, extraX, extraY))
+            return;
+        render_time = AGS_Clock::now() - now;
+    }
+}
+
+// Keeps the memory use within the budget, if one is set
+static void game_loop_update_memory_budget()
+{
+    if (MemoryBudget::GetBudget() == 0u)
+        return;
+    static auto last_time = AGS_Clock::now();
+    const auto now = AGS_Clock::now();
+    if (now - last_time < std::chrono::milliseconds(250))
+        return;
+    last_time = now;
+    MemoryBudget::Update();
+}
+
 float get_game_fps() {
     // if we have maxed out framerate then return the frame rate we're seeing instead
     // fps must be greater that 0 or some timings will take forever.
@@ -952,6 +1013,9 @@ void set_loop_counter(unsigned int new_counter) {
 }
 
 void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int extraX, int extraY) {
+    AGS_TRACE_ZONE("UpdateGameOnce");
+    BenchmarkStageScope bench_scope(kBenchStage_Update);
+    sys_evt_next_tick();
     sys_evt_process_pending();
 
     numEventsAtStartOfFunction = events.size();
@@ -1018,6 +1082,15 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
     update_audio_system_on_game_loop();
 
+    // put the sprites loaded in background into the cache before drawing,
+    // and create the textures for those which are going to be displayed
+    spriteset.ProcessPrefetchedSprites();
+    texturecache_process_uploads();
+    // start preloading the room which the player is likely to go to
+    room_preload_update();
+    // report the savegames written in background
+    update_savegame_writes();
+
     // Only render if we are not skipping a cutscene
     if (!play.fast_forward)
         render_graphics(extraBitmap, extraX, extraY);
@@ -1034,6 +1107,13 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
     game_loop_update_loop_counter();
 
+    // the benchmark and the uncapped video capture running along with
+    // the input replay end with it
+    if (benchmark_end_tick() ||
+        ((benchmark_is_running() || (video_capture_is_running() && usetup.video_capture_uncapped))
+            && sys_evt_is_replay_finished()))
+        ProperExit();
+
     // Immediately start the next frame if we are skipping a cutscene
     if (play.fast_forward)
         return;
@@ -1042,8 +1122,16 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
     game_loop_update_fps();
 
+    game_loop_update_cache_stats();
+
+    game_loop_update_memory_budget();
+
+    update_debugger_telemetry();
+
     update_polled_stuff();
 
+    game_loop_render_interpolated(extraBitmap, extraX, extraY);
+
     WaitForNextFrame();
 }
 
@@ -21,6 +21,7 @@
 #include <SDL.h>
 #include "core/platform.h"
 #include "ac/draw.h"
+#include "ac/path_helper.h"
 #include "debug/debugger.h"
 #include "debug/out.h"
 #include "gfx/ali3dexception.h"
@@ -345,6 +346,7 @@ bool create_gfx_driver_and_init_mode_any(const String &gfx_driver_id,
 {
     if (!graphics_mode_create_renderer(gfx_driver_id))
         return false;
+    gfxDriver->UseAdaptiveVsync(setup.Params.AdaptiveVSync);
 
     const int use_col_depth =
         color_depth.Forced ? color_depth.Bits : gfxDriver->GetDisplayDepthForNativeDepth(color_depth.Bits);
@@ -373,6 +375,7 @@ static bool simple_create_gfx_driver_and_init_mode(const String &gfx_driver_id,
                                             const ColorDepthOption &color_depth)
 {
     if (!graphics_mode_create_renderer(gfx_driver_id)) { return false; }
+    gfxDriver->UseAdaptiveVsync(setup.Params.AdaptiveVSync);
 
     const int col_depth = gfxDriver->GetDisplayDepthForNativeDepth(color_depth.Bits);
     const WindowSetup ws = setup.Windowed ? setup.WinSetup : setup.FsSetup;
@@ -430,8 +433,8 @@ bool graphics_mode_init_any(const GraphicResolution &game_res, const DisplayMode
         setup.Windowed ? "yes" : "no",
         ws.Size.Width, ws.Size.Height,
         scale_option.GetCStr());
-    Debug::Printf(kDbgMsg_Info, "Graphic settings: refresh rate (optional): %d, vsync: %d",
-        setup.Params.RefreshRate, setup.Params.VSync);
+    Debug::Printf(kDbgMsg_Info, "Graphic settings: refresh rate (optional): %d, vsync: %d, adaptive vsync: %d",
+        setup.Params.RefreshRate, setup.Params.VSync, setup.Params.AdaptiveVSync);
 
     // Prepare the list of available gfx factories, having the one requested by user at first place
     // TODO: make factory & driver IDs case-insensitive!
@@ -482,6 +485,9 @@ bool graphics_mode_create_renderer(const String &driver_id)
         return false;
 
     gfxDriver->SetCallbackOnInit(GfxDriverOnInitCallback);
+    // Let the renderer keep its compiled shaders in the user config dir
+    gfxDriver->SetShaderCacheFile(PreparePathForWriting(GetGameUserConfigDir(),
+        String::FromFormat("%s_shaders.cache", gfxDriver->GetDriverID())));
     // TODO: this is remains of the old code; find out if this is really
     // the best time and place to set the tint method
     gfxDriver->SetTintMethod(TintReColourise);
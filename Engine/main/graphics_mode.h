@@ -80,6 +80,7 @@ struct DisplaySetupEx
 {
     int                  RefreshRate = 0;  // gfx mode refresh rate
     bool                 VSync = false;    // vertical sync
+    bool                 AdaptiveVSync = false; // let the late frames skip vsync, if supported
 };
 
 // Full graphics configuration, contains graphics driver selection,
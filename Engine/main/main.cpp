@@ -110,11 +110,25 @@ void main_print_help() {
            "Options:\n"
            "  --background                 Keeps game running in background\n"
            "                               (this does not work in exclusive fullscreen)\n"
+           "  --benchmark TICKS            Run the game for TICKS game ticks without a frame\n"
+           "                               rate limit and with no video or audio output,\n"
+           "                               then print the timing summary and quit\n"
+           "  --benchmark-baseline FILEPATH\n"
+           "                               Compare the benchmark's timing with the one\n"
+           "                               written by an earlier run to FILEPATH\n"
+           "  --benchmark-out FILEPATH     Write the benchmark's per-tick timing to FILEPATH\n"
+           "  --capture-video FILEPATH     Record the rendered frames into the raw video\n"
+           "                               file at FILEPATH\n"
+           "  --capture-video-uncapped     Run the game without a frame rate limit while\n"
+           "                               recording the video, using the \"Null\" graphics\n"
+           "                               driver and the dummy audio driver\n"
            "  --clear-cache-on-room-change Clears sprite cache on every room change\n"
            "  --conf FILEPATH              Specify explicit config file to read on startup\n"
 #if AGS_PLATFORM_OS_WINDOWS
            "  --console-attach             Write output to the parent process's console\n"
 #endif
+           "  --event-trace FILEPATH       Record the engine event trace to FILEPATH,\n"
+           "                               in Chrome trace event format\n"
            "  --fps                        Display fps counter\n"
            "  --fullscreen                 Force display mode to fullscreen\n"
            "  --gfxdriver <id>             Request graphics driver. Available options:\n"
@@ -155,6 +169,7 @@ void main_print_help() {
            "                                 --log-stdout=+mgs:debug\n"
            "                                 --log-file=all:warn\n"
            "  --log-file-path=PATH         Define custom path for the log file\n"
+           "  --log-OUTPUT-async=1         Write to the chosen OUTPUT on a separate thread\n"
           //--------------------------------------------------------------------------------|
            "  --no-message-box             Disable alerts as modal message boxes\n"
            "  --no-plugins                 Disable plugin loading\n"
@@ -164,12 +179,17 @@ void main_print_help() {
            "  --nospr                      Don't draw room objects and characters\n"
            "  --noupdate                   Don't run game update\n"
            "  --novideo                    Don't play game videos\n"
+           "  --record-input FILEPATH      Record the player input to FILEPATH\n"
+           "  --replay-input FILEPATH      Replay the player input recorded in FILEPATH\n"
            "  --rotation <MODE>            Screen rotation preferences. MODEs are:\n"
            "                                 unlocked (0), portrait (1), landscape (2)\n"
            "  --sdl-log=LEVEL              Setup SDL backend logging level\n"
            "                               LEVELs are:\n"
            "                                 verbose (1), debug (2), info (3), warn (4),\n"
            "                                 error (5), critical (6)\n"
+           "  --script-profile FILEPATH    Profile game scripts and write reports on exit:\n"
+           "                               collapsed call stacks to FILEPATH, and function\n"
+           "                               and line costs to FILEPATH.txt\n"
 #if AGS_PLATFORM_OS_WINDOWS
            "  --setup                      Run setup application\n"
 #endif
@@ -268,6 +288,34 @@ static int main_process_cmdline(ConfigTree &cfg, int argc, char *argv[])
         }
         else if (ags_stricmp(arg, "--clear-cache-on-room-change") == 0)
             cfg["misc"]["clear_cache_on_room_change"] = "1";
+        else if ((ags_stricmp(arg, "--event-trace") == 0) && (argc > ee + 1))
+            cfg["misc"]["event_trace"] = argv[++ee];
+        else if ((ags_stricmp(arg, "--benchmark") == 0) && (argc > ee + 1))
+        {
+            cfg["misc"]["benchmark_ticks"] = argv[++ee];
+            // no output by default, but the driver may be overridden by --gfxdriver
+            cfg["graphics"]["driver"] = "Null";
+            cfg["sound"]["driver"] = "dummy";
+        }
+        else if ((ags_stricmp(arg, "--benchmark-baseline") == 0) && (argc > ee + 1))
+            cfg["misc"]["benchmark_baseline"] = argv[++ee];
+        else if ((ags_stricmp(arg, "--benchmark-out") == 0) && (argc > ee + 1))
+            cfg["misc"]["benchmark_out"] = argv[++ee];
+        else if ((ags_stricmp(arg, "--capture-video") == 0) && (argc > ee + 1))
+            cfg["misc"]["video_capture"] = argv[++ee];
+        else if (ags_stricmp(arg, "--capture-video-uncapped") == 0)
+        {
+            cfg["misc"]["video_capture_uncapped"] = "1";
+            // no output by default, but the driver may be overridden by --gfxdriver
+            cfg["graphics"]["driver"] = "Null";
+            cfg["sound"]["driver"] = "dummy";
+        }
+        else if ((ags_stricmp(arg, "--record-input") == 0) && (argc > ee + 1))
+            cfg["misc"]["input_record"] = argv[++ee];
+        else if ((ags_stricmp(arg, "--replay-input") == 0) && (argc > ee + 1))
+            cfg["misc"]["input_replay"] = argv[++ee];
+        else if ((ags_stricmp(arg, "--script-profile") == 0) && (argc > ee + 1))
+            cfg["misc"]["script_profile"] = argv[++ee];
         else if (ags_strnicmp(arg, "--tell", 6) == 0) {
             if (arg[6] == 0)
                 tellInfoKeys.insert(String("all"));
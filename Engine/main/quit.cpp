@@ -18,25 +18,32 @@
 #include <stdio.h>
 #include "core/platform.h"
 #include <allegro.h> // find files, allegro_exit
+#include "ac/asset_helper.h"
 #include "ac/cdaudio.h"
 #include "ac/common.h"
+#include "ac/draw.h"
 #include "ac/game.h"
 #include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/gamestate.h"
+#include "ac/room_loadstats.h"
 #include "ac/roomstatus.h"
 #include "ac/route_finder.h"
+#include "ac/sys_events.h"
 #include "ac/translation.h"
 #include "ac/dynobj/dynobj_manager.h"
 #include "debug/agseditordebugger.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
+#include "debug/eventtrace.h"
 #include "debug/out.h"
 #include "font/fonts.h"
+#include "main/benchmark.h"
 #include "main/config.h"
 #include "main/engine.h"
 #include "main/main.h"
 #include "main/quit.h"
+#include "main/video_capture.h"
 #include "ac/spritecache.h"
 #include "gfx/graphicsdriver.h"
 #include "gfx/bitmap.h"
@@ -45,6 +52,8 @@
 #include "platform/base/sys_main.h"
 #include "plugin/plugin_engine.h"
 #include "script/cc_common.h"
+#include "script/script_profiler.h"
+#include "util/jobscheduler.h"
 #include "media/audio/audio_system.h"
 #include "media/video/video.h"
 
@@ -195,6 +204,15 @@ void quit(const char *quitmsg)
 
     quit_tell_editor_debugger(errmsg, qreason);
 
+    ScriptProfiler::Stop();
+    room_load_stats_report();
+    asset_trace_stop();
+    render_trace_stop();
+    EventTrace::Stop();
+    benchmark_stop();
+    video_capture_stop();
+    sys_evt_stop_input_record();
+
     set_our_eip(9900);
 
     set_our_eip(9016);
@@ -220,6 +238,7 @@ void quit(const char *quitmsg)
     // Be sure to unlock mouse on exit, or users will hate us
     sys_window_lock_mouse(false);
     engine_shutdown_gfxmode();
+    JobScheduler::ShutdownGlobal();
 
     platform->PreBackendExit();
 
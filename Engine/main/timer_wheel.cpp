@@ -0,0 +1,104 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "main/timer_wheel.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+void TimerWheel::Schedule(Key key, uint32_t ticks)
+{
+    if (ticks == 0)
+    {
+        Cancel(key);
+        return;
+    }
+    const uint64_t deadline = _now + ticks;
+    _deadlines[key] = deadline;
+    Place({ key, deadline });
+}
+
+void TimerWheel::Cancel(Key key)
+{
+    _deadlines.erase(key);
+}
+
+uint32_t TimerWheel::GetRemaining(Key key) const
+{
+    auto it = _deadlines.find(key);
+    return (it != _deadlines.end()) ? static_cast<uint32_t>(it->second - _now) : 0u;
+}
+
+void TimerWheel::Advance(std::vector<Key> &expired)
+{
+    _now++;
+    const uint32_t slot0 = static_cast<uint32_t>(_now & (Level0Size - 1));
+    if (slot0 == 0)
+    {
+        // Started the new level 0 span: bring down the timers which are due in it
+        const uint32_t slot1 = static_cast<uint32_t>((_now >> Level0Bits) & (Level1Size - 1));
+        if (slot1 == 0)
+            Cascade(_overflow);
+        Cascade(_level1[slot1]);
+    }
+
+    auto &list = _level0[slot0];
+    for (const auto &e : list)
+    {
+        auto it = _deadlines.find(e.Id);
+        if (it != _deadlines.end() && it->second == e.Deadline)
+        {
+            expired.push_back(e.Id);
+            _deadlines.erase(it);
+        }
+    }
+    list.clear();
+}
+
+void TimerWheel::Clear()
+{
+    for (auto &list : _level0)
+        list.clear();
+    for (auto &list : _level1)
+        list.clear();
+    _overflow.clear();
+    _deadlines.clear();
+}
+
+void TimerWheel::Place(const Entry &e)
+{
+    const uint64_t delta = e.Deadline - _now;
+    if (delta < Level0Size)
+        _level0[e.Deadline & (Level0Size - 1)].push_back(e);
+    else if (delta < Level1Span)
+        _level1[(e.Deadline >> Level0Bits) & (Level1Size - 1)].push_back(e);
+    else
+        _overflow.push_back(e);
+}
+
+void TimerWheel::Cascade(std::vector<Entry> &list)
+{
+    std::vector<Entry> entries;
+    entries.swap(list);
+    for (const auto &e : entries)
+    {
+        auto it = _deadlines.find(e.Id);
+        if (it != _deadlines.end() && it->second == e.Deadline)
+            Place(e); // drop the cancelled and rescheduled ones
+    }
+}
+
+} // namespace Engine
+} // namespace AGS
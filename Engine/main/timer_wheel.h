@@ -0,0 +1,97 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// TimerWheel is a hierarchical timer wheel, which lets schedule the timers
+// counted in game ticks, and find out which of them expired on each tick,
+// without visiting all the timers which are still waiting.
+//
+// The timers are identified by keys, which are made of the timer's type and
+// the index of the object it belongs to. Rescheduling the timer of the same
+// key replaces the old one; the replaced and cancelled timers are left in
+// their slots and skipped when their slot is processed.
+//
+//=============================================================================
+#ifndef __AGS_EE_MAIN__TIMERWHEEL_H
+#define __AGS_EE_MAIN__TIMERWHEEL_H
+
+#include <unordered_map>
+#include <vector>
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+class TimerWheel
+{
+public:
+    typedef uint32_t Key;
+
+    // Makes a timer key from the timer's type and the object's index
+    static Key MakeKey(uint32_t type, uint32_t index) { return (type << 24) | (index & 0xFFFFFF); }
+    static uint32_t GetKeyType(Key key) { return key >> 24; }
+    static uint32_t GetKeyIndex(Key key) { return key & 0xFFFFFF; }
+
+    // Schedules the timer to expire after the given number of ticks;
+    // reschedules the timer if one with the same key is already scheduled.
+    // Timers with zero ticks are cancelled instead.
+    void Schedule(Key key, uint32_t ticks);
+    // Cancels the timer, if it is scheduled
+    void Cancel(Key key);
+    // Tells if the timer is scheduled and did not expire yet
+    bool IsScheduled(Key key) const { return _deadlines.count(key) > 0; }
+    // Gets the number of ticks remaining until the timer expires,
+    // returns 0 if the timer is not scheduled
+    uint32_t GetRemaining(Key key) const;
+    // Gets the number of scheduled timers
+    size_t GetCount() const { return _deadlines.size(); }
+    // Advances the wheel by one tick, and appends the keys of the timers
+    // which expired on this tick to the given list
+    void Advance(std::vector<Key> &expired);
+    // Cancels all timers
+    void Clear();
+
+private:
+    struct Entry
+    {
+        Key Id;
+        uint64_t Deadline;
+    };
+
+    // Level 0 slots are ticks, level 1 slots are the spans of level 0 size;
+    // the timers beyond level 1 are kept in the overflow list
+    static const uint32_t Level0Bits = 8;
+    static const uint32_t Level1Bits = 6;
+    static const uint32_t Level0Size = 1u << Level0Bits;
+    static const uint32_t Level1Size = 1u << Level1Bits;
+    static const uint64_t Level1Span = static_cast<uint64_t>(Level0Size) * Level1Size;
+
+    // Puts the entry into the slot which corresponds to its deadline
+    void Place(const Entry &e);
+    // Moves the entries from the list to the lower level slots
+    void Cascade(std::vector<Entry> &list);
+
+    uint64_t _now = 0u; // current tick
+    std::vector<Entry> _level0[Level0Size];
+    std::vector<Entry> _level1[Level1Size];
+    std::vector<Entry> _overflow;
+    // Deadlines of the scheduled timers, for validating the slot entries
+    std::unordered_map<Key, uint64_t> _deadlines;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_MAIN__TIMERWHEEL_H
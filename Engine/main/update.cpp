@@ -27,18 +27,22 @@
 #include "ac/global_character.h"
 #include "ac/lipsync.h"
 #include "ac/movelist.h"
+#include "ac/object.h"
 #include "ac/overlay.h"
 #include "ac/screenoverlay.h"
 #include "ac/spritecache.h"
 #include "ac/sys_events.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
+#include "ac/route_finder.h"
 #include "ac/timer.h"
 #include "ac/viewframe.h"
 #include "ac/walkablearea.h"
+#include "debug/eventtrace.h"
 #include "gfx/bitmap.h"
 #include "gfx/graphicsdriver.h"
 #include "main/game_run.h"
+#include "main/timer_wheel.h"
 #include "main/update.h"
 #include "media/audio/audio_system.h"
 
@@ -246,11 +250,88 @@ void restore_movelists()
     }
 }
 
+void complete_pending_routes()
+{
+    std::vector<int> movlsts;
+    get_pending_routes(movlsts);
+    for (int movlst : movlsts)
+    {
+        if (movlst >= CHMLSOFFS)
+            complete_character_walk(movlst - CHMLSOFFS);
+        else if (static_cast<uint32_t>(movlst - 1) < croom->numobj)
+            complete_object_move(movlst - 1);
+        else
+            cancel_route(movlst);
+    }
+}
+
+void cancel_pending_routes()
+{
+    std::vector<int> movlsts;
+    get_pending_routes(movlsts);
+    for (int movlst : movlsts)
+        cancel_route(movlst);
+}
+
+// The game timers, counted in game updates
+static TimerWheel game_timers;
+// Timers expired on the current update
+static std::vector<TimerWheel::Key> expired_timers;
+
+TimerWheel &get_game_timers()
+{
+    return game_timers;
+}
+
+void schedule_script_timer(int tnum, int timeout)
+{
+    // Script timer counts down to 1, which means "expired" and stays until checked
+    game_timers.Schedule(TimerWheel::MakeKey(kGameTimer_Script, tnum),
+        timeout > 1 ? static_cast<uint32_t>(timeout - 1) : 0u);
+}
+
+void schedule_overlay_timer(int over_id)
+{
+    const auto *over = get_overlay(over_id);
+    game_timers.Schedule(TimerWheel::MakeKey(kGameTimer_Overlay, over_id),
+        (over && over->timeout > 0) ? static_cast<uint32_t>(over->timeout) : 0u);
+}
+
+void sync_game_timers_to_state()
+{
+    for (int i = 0; i < MAX_TIMERS; ++i)
+    {
+        const auto key = TimerWheel::MakeKey(kGameTimer_Script, i);
+        if (game_timers.IsScheduled(key))
+            play.script_timers[i] = game_timers.GetRemaining(key) + 1;
+    }
+    auto &overs = get_overlays();
+    for (int id : get_overlay_ids())
+    {
+        const auto key = TimerWheel::MakeKey(kGameTimer_Overlay, id);
+        if (game_timers.IsScheduled(key))
+            overs[id].timeout = game_timers.GetRemaining(key);
+    }
+}
+
+void restore_game_timers()
+{
+    game_timers.Clear();
+    for (int i = 0; i < MAX_TIMERS; ++i)
+        schedule_script_timer(i, play.script_timers[i]);
+    for (int id : get_overlay_ids())
+        schedule_overlay_timer(id);
+}
+
 void update_script_timers()
 {
   if (play.gscript_timer > 0) play.gscript_timer--;
-  for (int aa=0;aa<MAX_TIMERS;aa++) {
-    if (play.script_timers[aa] > 1) play.script_timers[aa]--;
+  // Advance the game timers; only the expired ones are handled
+  expired_timers.clear();
+  game_timers.Advance(expired_timers);
+  for (const auto key : expired_timers) {
+    if (TimerWheel::GetKeyType(key) == kGameTimer_Script)
+      play.script_timers[TimerWheel::GetKeyIndex(key)] = 1;
     }
 }
 
@@ -307,16 +388,18 @@ void update_following_exactly_characters(const std::vector<int> &followingAsShee
 
 void update_overlay_timers()
 {
-	// update overlay timers
-  auto &overs = get_overlays();
-  for (auto &over : overs)
+	// remove the overlays which timeouts expired on this update
+  for (const auto key : expired_timers)
   {
-    if (over.timeout > 0) {
-      over.timeout--;
-      if (over.timeout == 0)
-      {
-        remove_screen_overlay(over.type);
-      }
+    if (TimerWheel::GetKeyType(key) != kGameTimer_Overlay)
+      continue;
+    const int type = static_cast<int>(TimerWheel::GetKeyIndex(key));
+    auto *over = get_overlay(type);
+    // the overlay could have been replaced, and got a new timer
+    if (over && (over->timeout > 0) && !game_timers.IsScheduled(key))
+    {
+      over->timeout = 0;
+      remove_screen_overlay(type);
     }
   }
 }
@@ -543,9 +626,13 @@ void update_sierra_speech()
 // update_stuff: moves and animates objects, executes repeat scripts, and
 // the like.
 void update_stuff() {
+  AGS_TRACE_ZONE("update_stuff");
 
   set_our_eip(20);
 
+  // start the walks which routes were requested since the last update
+  complete_pending_routes();
+
   update_script_timers();
 
   update_cycling_views();
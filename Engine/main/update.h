@@ -20,6 +20,8 @@
 #ifndef __AGS_EE_MAIN__UPDATE_H
 #define __AGS_EE_MAIN__UPDATE_H
 
+#include "main/timer_wheel.h"
+
 // Update MoveList of certain index, save current position;
 // *resets* mslot to zero if path is complete.
 // returns "need_to_fix_sprite" value, which may be 0,1,2;
@@ -28,7 +30,30 @@
 int do_movelist_move(short &mslot, int &pos_x, int &pos_y);
 // Recalculate derived (non-serialized) values in movelists
 void restore_movelists();
+// Starts the walks and moves which routes were searched asynchronously
+void complete_pending_routes();
+// Discards all the asynchronous route searches
+void cancel_pending_routes();
 // Update various things on the game frame (historical code mess...)
 void update_stuff();
 
+// Types of the timers scheduled in the game timer wheel
+enum GameTimerType
+{
+    kGameTimer_Script  = 1, // script timers (SetTimer)
+    kGameTimer_Overlay = 2  // overlay timeouts
+};
+// Gets the timer wheel which is advanced on each game update
+AGS::Engine::TimerWheel &get_game_timers();
+// Schedules the script timer, the timeout is in the game state's format
+void schedule_script_timer(int tnum, int timeout);
+// Schedules the overlay's timeout, if it has one
+void schedule_overlay_timer(int over_id);
+// Writes the remaining time of the game timers back into the game state
+// and overlays, for saving
+void sync_game_timers_to_state();
+// Reschedules all the game timers by the game state and overlays,
+// e.g. after restoring a save
+void restore_game_timers();
+
 #endif // __AGS_EE_MAIN__UPDATE_H
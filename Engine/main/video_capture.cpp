@@ -0,0 +1,195 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "main/video_capture.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "ac/gamesetupstruct.h"
+#include "debug/out.h"
+#include "gfx/bitmap.h"
+#include "gfx/graphicsdriver.h"
+#include "main/game_run.h"
+#include "util/file.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+extern GameSetupStruct game;
+extern IGraphicsDriver *gfxDriver;
+
+// Number of the retrieved frames waiting to be written; the game waits for
+// the writer when there are more, as the capture should not drop frames
+static const size_t MaxQueuedFrames = 8u;
+
+struct VideoCaptureState
+{
+    std::unique_ptr<Stream> Out;
+    int Width = 0, Height = 0;
+    // Screen copy requests, in the order of the frames
+    std::deque<uint32_t> Pending;
+    // Frames waiting for the writer
+    std::deque<std::unique_ptr<Bitmap>> Queue;
+    uint32_t Captured = 0u; // frames passed to the writer
+    uint32_t Failed = 0u; // frames the renderer did not copy
+    std::thread Thread;
+    std::mutex Mutex;
+    std::condition_variable FrameCv; // frame queued, or quit
+    std::condition_variable SpaceCv; // frame taken by the writer
+    bool Quit = false;
+};
+
+static std::unique_ptr<VideoCaptureState> capture;
+
+static void write_frame(Stream *out, const Bitmap *frame)
+{
+    const size_t row_size = frame->GetWidth() * 4;
+    for (int y = 0; y < frame->GetHeight(); ++y)
+        out->Write(frame->GetScanLine(y), row_size);
+}
+
+static void writer_thread(VideoCaptureState *state)
+{
+    for (;;)
+    {
+        std::unique_ptr<Bitmap> frame;
+        {
+            std::unique_lock<std::mutex> lk(state->Mutex);
+            state->FrameCv.wait(lk, [state]() { return state->Quit || !state->Queue.empty(); });
+            if (state->Queue.empty())
+                return;
+            frame = std::move(state->Queue.front());
+            state->Queue.pop_front();
+        }
+        state->SpaceCv.notify_one();
+        write_frame(state->Out.get(), frame.get());
+    }
+}
+
+// Converts the screen copy into the 32-bit frame of the video size
+static std::unique_ptr<Bitmap> convert_frame(std::unique_ptr<Bitmap> &&copy)
+{
+    if ((copy->GetColorDepth() == 32) &&
+        (copy->GetWidth() == capture->Width) && (copy->GetHeight() == capture->Height))
+        return std::move(copy);
+    std::unique_ptr<Bitmap> frame(new Bitmap(capture->Width, capture->Height, 32));
+    if (copy->GetSize() == frame->GetSize())
+    {
+        frame->Blit(copy.get());
+    }
+    else
+    {
+        // Allegro does not stretch with mismatching color depths
+        Bitmap fixdepth(copy->GetWidth(), copy->GetHeight(), 32);
+        fixdepth.Blit(copy.get());
+        frame->StretchBlt(&fixdepth, RectWH(frame->GetSize()));
+    }
+    return frame;
+}
+
+static void queue_frame(std::unique_ptr<Bitmap> &&frame)
+{
+    capture->Captured++;
+#if defined(AGS_DISABLE_THREADS)
+    write_frame(capture->Out.get(), frame.get());
+#else
+    {
+        std::unique_lock<std::mutex> lk(capture->Mutex);
+        capture->SpaceCv.wait(lk, []() { return capture->Queue.size() < MaxQueuedFrames; });
+        capture->Queue.push_back(std::move(frame));
+    }
+    capture->FrameCv.notify_one();
+#endif
+}
+
+// Retrieves the requested frames; waits for all of them if "wait" is set,
+// otherwise only takes the ones which the renderer has already copied
+static void retrieve_frames(bool wait)
+{
+    while (!capture->Pending.empty() &&
+        (wait || gfxDriver->IsScreenCopyReady(capture->Pending.front())))
+    {
+        std::unique_ptr<Bitmap> copy = gfxDriver->EndScreenCopy(capture->Pending.front());
+        capture->Pending.pop_front();
+        if (copy)
+            queue_frame(convert_frame(std::move(copy)));
+        else
+            capture->Failed++;
+    }
+}
+
+bool video_capture_start(const String &path)
+{
+    video_capture_stop();
+    std::unique_ptr<Stream> out = File::CreateFile(path);
+    if (!out)
+    {
+        Debug::Printf(kDbgMsg_Error, "Failed to open video capture file for writing: %s", path.GetCStr());
+        return false;
+    }
+    capture.reset(new VideoCaptureState());
+    capture->Out = std::move(out);
+    capture->Width = game.GetGameRes().Width;
+    capture->Height = game.GetGameRes().Height;
+#if !defined(AGS_DISABLE_THREADS)
+    capture->Thread = std::thread(writer_thread, capture.get());
+#endif
+    Debug::Printf(kDbgMsg_Info, "Video capture started: %s", path.GetCStr());
+    Debug::Printf(kDbgMsg_Info, "Convert with: ffmpeg -f rawvideo -pixel_format bgr0 -video_size %dx%d -framerate %g -i \"%s\" <OUTPUT>",
+        capture->Width, capture->Height, get_game_fps(), path.GetCStr());
+    return true;
+}
+
+void video_capture_stop()
+{
+    if (!capture)
+        return;
+    if (gfxDriver)
+        retrieve_frames(true);
+    else
+        capture->Failed += static_cast<uint32_t>(capture->Pending.size());
+#if !defined(AGS_DISABLE_THREADS)
+    {
+        std::lock_guard<std::mutex> lk(capture->Mutex);
+        capture->Quit = true;
+    }
+    capture->FrameCv.notify_one();
+    if (capture->Thread.joinable())
+        capture->Thread.join();
+#endif
+    Debug::Printf(kDbgMsg_Info, "Video capture stopped: %u frames written, %u failed to copy",
+        capture->Captured, capture->Failed);
+    capture.reset();
+}
+
+bool video_capture_is_running()
+{
+    return capture != nullptr;
+}
+
+void video_capture_frame()
+{
+    if (!capture)
+        return;
+    retrieve_frames(false);
+    const uint32_t handle = gfxDriver->BeginScreenCopy(nullptr, true);
+    if (handle == 0u)
+    {
+        capture->Failed++;
+        return;
+    }
+    capture->Pending.push_back(handle);
+}
@@ -0,0 +1,41 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Video capture: records every rendered game frame, at the native game
+// resolution, into the raw video file. The frames are requested from the
+// renderer with the asynchronous screen copies, which are retrieved a few
+// frames later, and written to the file on a separate thread. The file holds
+// the 32-bit BGRX pixels of the frames one after another, with no header;
+// the command converting it with ffmpeg is printed into the log.
+//
+// The game renders one frame per game tick, so the video's frame rate is the
+// game speed; when the game is run without the frame rate limit the video
+// still plays at the game speed. The audio is not captured.
+//
+//=============================================================================
+#ifndef __AGS_EE_MAIN__VIDEOCAPTURE_H
+#define __AGS_EE_MAIN__VIDEOCAPTURE_H
+
+#include "util/string.h"
+
+// Starts capturing the frames into the file at the given path
+bool video_capture_start(const AGS::Common::String &path);
+// Stops the capture, writing the frames which are still pending
+void video_capture_stop();
+// Tells if the capture is running
+bool video_capture_is_running();
+// Captures the frame which has just been rendered
+void video_capture_frame();
+
+#endif // __AGS_EE_MAIN__VIDEOCAPTURE_H
@@ -0,0 +1,120 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "media/audio/asyncdecoder.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+AsyncDecoder::AsyncDecoder(std::unique_ptr<SDLDecoder> decoder)
+    : _decoder(std::move(decoder))
+{
+    for (size_t i = 0; i < ChunkCount; ++i)
+        _free.TryPush(Chunk());
+}
+
+bool AsyncDecoder::Open(float pos_ms)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    Flush();
+    const bool success = _decoder->Open(pos_ms);
+    _EOS = _decoder->EOS();
+    _active = success;
+    return success;
+}
+
+float AsyncDecoder::Seek(float pos_ms)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    Flush();
+    const float new_pos = _decoder->Seek(pos_ms);
+    _EOS = _decoder->EOS();
+    _active = true;
+    return new_pos;
+}
+
+void AsyncDecoder::Suspend()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    Flush();
+    _active = false;
+}
+
+SoundBuffer AsyncDecoder::GetData()
+{
+    while (!_hasPending)
+    {
+        if (!_decoded.TryPop(_pending))
+            return SoundBuffer();
+        // the worker passes an empty chunk when it reaches the EOS or error
+        if (!_pending.Data.empty())
+            _hasPending = true;
+        else
+            _free.TryPush(std::move(_pending));
+    }
+    return SoundBuffer(_pending.Data.data(), _pending.Data.size(), _pending.Ts, _pending.DurMs);
+}
+
+void AsyncDecoder::ReleaseData()
+{
+    if (!_hasPending)
+        return;
+    _free.TryPush(std::move(_pending));
+    _hasPending = false;
+}
+
+bool AsyncDecoder::EOS() const
+{
+    // the worker sets EOS after the last chunk is queued
+    return _EOS.load(std::memory_order_acquire) && !_hasPending && _decoded.IsEmpty();
+}
+
+void AsyncDecoder::Flush()
+{
+    ReleaseData();
+    Chunk chunk;
+    while (_decoded.TryPop(chunk))
+        _free.TryPush(std::move(chunk));
+}
+
+bool AsyncDecoder::NeedsDecoding() const
+{
+    return _active && !_EOS && !_free.IsEmpty();
+}
+
+bool AsyncDecoder::Decode()
+{
+    std::unique_lock<std::mutex> lk(_mutex, std::try_to_lock);
+    if (!lk.owns_lock())
+        return false; // the mixer or another worker is using the decoder
+    bool decoded = false;
+    Chunk chunk;
+    while (_active && !_EOS && _free.TryPop(chunk))
+    {
+        const SoundBuffer buf = _decoder->GetData();
+        const uint8_t *data = static_cast<const uint8_t*>(buf.Data);
+        chunk.Data.assign(data, data + (data ? buf.Size : 0u));
+        chunk.Ts = buf.Ts;
+        chunk.DurMs = buf.DurMs;
+        const bool eos = _decoder->EOS();
+        _decoded.TryPush(std::move(chunk));
+        _EOS.store(eos, std::memory_order_release);
+        decoded = true;
+    }
+    return decoded;
+}
+
+} // namespace Engine
+} // namespace AGS
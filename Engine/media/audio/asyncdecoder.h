@@ -0,0 +1,109 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// AsyncDecoder wraps SDLDecoder and decodes the sound ahead of its playback,
+// into a small ring of the data chunks. The chunks are filled by a decode
+// worker thread and taken by the audio mixer thread, so that a slow decoding
+// does not hold the output of the other sounds.
+//
+// The decoder itself is only accessed under the lock: the worker holds it
+// while decoding, and the mixer takes it when it has to open, seek or suspend
+// the decoding. The chunks are passed between the threads through the
+// lock-free queues, and are reused, so no memory is allocated while playing.
+//
+//=============================================================================
+#ifndef __AGS_EE_MEDIA__ASYNCDECODER_H
+#define __AGS_EE_MEDIA__ASYNCDECODER_H
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "media/audio/sdldecoder.h"
+#include "util/spsc_queue.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+class AsyncDecoder
+{
+public:
+    // Number of the data chunks decoded ahead of the playback
+    static const size_t ChunkCount = 2u;
+
+    AsyncDecoder(std::unique_ptr<SDLDecoder> decoder);
+
+    // The sound properties; these are only valid after the decoder is opened
+    bool IsValid() const { return _decoder->IsValid(); }
+    SDL_AudioFormat GetFormat() const { return _decoder->GetFormat(); }
+    int GetChannels() const { return _decoder->GetChannels(); }
+    int GetFreq() const { return _decoder->GetFreq(); }
+    bool IsRepeating() const { return _decoder->IsRepeating(); }
+    float GetDurationMs() const { return _decoder->GetDurationMs(); }
+
+    // The mixer thread's methods:
+    //
+    // Opens the decoder at the given position, and begins decoding;
+    // returns the result
+    bool Open(float pos_ms);
+    // Seeks to the given position, drops the decoded data,
+    // and resumes decoding; returns the new position
+    float Seek(float pos_ms);
+    // Stops decoding, drops the decoded data
+    void Suspend();
+    // Returns the next decoded chunk, or empty buffer if there's none ready;
+    // the same chunk is returned until it's released
+    SoundBuffer GetData();
+    // Releases the chunk returned by GetData, lets it be reused for decoding
+    void ReleaseData();
+    // Tells if the decoder has reached EOS, and all the data was taken
+    bool EOS() const;
+
+    // The decode worker's methods:
+    //
+    // Tells if there are free chunks to decode into
+    bool NeedsDecoding() const;
+    // Decodes into all the free chunks; does nothing if the decoder is
+    // locked by another thread at the moment. Returns if anything was decoded
+    bool Decode();
+
+private:
+    struct Chunk
+    {
+        std::vector<uint8_t> Data;
+        float Ts = -1.f;
+        float DurMs = 0.f;
+    };
+
+    // Returns all the decoded chunks to the free queue; expects the lock held
+    void Flush();
+
+    std::unique_ptr<SDLDecoder> _decoder;
+    std::mutex _mutex;
+    std::atomic<bool> _active{false};
+    std::atomic<bool> _EOS{false};
+    // Decoded chunks, passed from the worker to the mixer
+    Common::SpscQueue<Chunk> _decoded{ChunkCount};
+    // Free chunks, passed from the mixer back to the worker
+    Common::SpscQueue<Chunk> _free{ChunkCount};
+    // The chunk taken by the mixer
+    Chunk _pending;
+    bool _hasPending = false;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_MEDIA__ASYNCDECODER_H
@@ -13,20 +13,102 @@
 //=============================================================================
 #include "media/audio/audio_core.h"
 #include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <stdexcept>
 #include <thread>
 #include <unordered_map>
+#include "core/platform.h"
+#include "debug/eventtrace.h"
 #include "debug/out.h"
 #include "media/audio/audioplayer.h"
 #include "media/audio/sdldecoder.h"
 #include "media/audio/openalsource.h"
+#include "util/jobscheduler.h"
 #include "util/memory_compat.h"
+#include "util/spsc_queue.h"
+#if AGS_PLATFORM_OS_WINDOWS
+#include "platform/windows/windows.h"
+#elif !defined(AGS_DISABLE_THREADS)
+#include <pthread.h>
+#endif
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
 
+// Playback status of a slot, published by the audio thread for the game thread
+struct AudioSlotStatus
+{
+    // Sound properties, known once the sound is opened; the streamed sounds
+    // are opened by the audio thread, when the slot is polled first time
+    std::atomic<float> Frequency{0.f};
+    std::atomic<float> DurationMs{0.f};
+    // Playback state, updated by the audio thread after each poll;
+    // it's written after the sound properties, and leaves the initial
+    // state when the sound is opened
+    std::atomic<int> PlayState{PlayStateInitial};
+    std::atomic<float> PositionMs{0.f};
+    // Id of the last command done by the audio thread; it's written after
+    // the state, so the state read after this id is at least as recent
+    std::atomic<uint32_t> DoneCommand{0u};
+};
+
+// Game thread's record of a slot
+struct AudioSlotClient
+{
+    std::shared_ptr<AudioSlotStatus> Status;
+    uint32_t LastCommand = 0u;  // id of the last queued command
+    uint32_t StateCommand = 0u; // id of the last play/pause command
+    uint32_t SeekCommand = 0u;  // id of the last seek command
+    PlaybackState RequestedState = PlayStateInitial;
+    float RequestedPosMs = 0.f;
+};
+
+typedef std::chrono::steady_clock AudioClock;
+
+// Audio thread's slot
+struct AudioSlot
+{
+    std::unique_ptr<AudioPlayer> Player;
+    std::shared_ptr<AudioSlotStatus> Status;
+    // Time of the play command, for measuring the start latency
+    AudioClock::time_point PlayTime;
+    bool WaitingStart = false;
+    int Priority = 0;
+};
+
+enum AudioCommandType
+{
+    kAudioCmd_Add,
+    kAudioCmd_Remove,
+    kAudioCmd_Play,
+    kAudioCmd_Pause,
+    kAudioCmd_Seek,
+    kAudioCmd_Configure
+};
+
+// Command sent from the game thread to the audio thread
+struct AudioCommand
+{
+    AudioCommandType Type = kAudioCmd_Add;
+    int Handle = -1;
+    uint32_t Id = 0u;
+    AudioClock::time_point Time; // when the command was queued
+    float Values[4] = {};
+    // New slot's player and status, only for kAudioCmd_Add
+    std::unique_ptr<AudioPlayer> Player;
+    std::shared_ptr<AudioSlotStatus> Status;
+};
+
+// Max number of commands waiting for the audio thread;
+// the game thread will wait if the queue ever gets full
+static const size_t AudioCommandQueueSize = 1024;
+// Max number of decode threads, chosen automatically
+static const size_t MaxAutoDecodeThreads = 2u;
+
 // Global audio core state and resources
 static struct 
 {
@@ -35,19 +117,47 @@ static struct
     // Context handle (all OpenAL operations are performed using the current context)
     ALCcontext *alcContext = nullptr;
 
-    // Audio thread: polls sound decoders, feeds OpenAL sources
+    // Audio thread: takes the decoded sound data, feeds OpenAL sources
     std::thread audio_core_thread;
-    bool audio_core_thread_running = false;
+    std::atomic<bool> audio_core_thread_running{false};
+    int poll_interval_ms = 50;
+    int max_voices = 0;
+
+    // Decode threads: decode the sounds ahead of their playback;
+    // if there are none, then the audio thread decodes by itself
+    std::vector<std::thread> decode_threads;
+    // The decoders of the existing slots, and the wake up counter,
+    // guarded by the decode mutex
+    std::mutex decode_mutex;
+    std::condition_variable decode_cv;
+    std::vector<std::shared_ptr<AsyncDecoder>> decoders;
+    uint32_t decode_wake = 0u;
 
     // Sound slot id counter
     int nextId = 0;
 
-    // One mutex to lock them all... any operation on individual decoders
-    // is done under this only mutex, which means that they are currently
-    // polled one by one, any action like pause/resume is also synced.
-    std::mutex mixer_mutex_m;
-    std::condition_variable mixer_cv;
-    std::unordered_map<int, std::unique_ptr<AudioPlayer>> slots_;
+    // The game thread never touches the players directly: the operations
+    // are passed to the audio thread through the lock-free command queue,
+    // and the playback state is read from the slot's status, which the
+    // audio thread publishes. The mutex only protects the audio thread's
+    // wait for the new commands, and is never held while polling.
+    SpscQueue<AudioCommand> commands{AudioCommandQueueSize};
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+    // Set by the decode threads when they have new data, guarded by the wake mutex
+    bool data_decoded = false;
+    // Slots of the game thread
+    std::unordered_map<int, AudioSlotClient> clients_;
+    // Slots of the audio thread
+    std::unordered_map<int, AudioSlot> slots_;
+
+    // Statistics, updated by the audio thread
+    std::atomic<uint64_t> stat_underruns{0u};
+    std::atomic<int> stat_queued_ms{0};
+    std::atomic<uint64_t> stat_starts{0u};
+    std::atomic<uint64_t> stat_start_latency_total_us{0u};
+    std::atomic<uint32_t> stat_start_latency_max_us{0u};
+    std::atomic<int> stat_virtual_voices{0};
 } g_acore;
 
 // Prints any OpenAL errors to the log
@@ -64,9 +174,37 @@ void dump_al_errors()
 // -------------------------------------------------------------------------------------------------
 
 static void audio_core_entry();
+static void audio_core_decode_entry();
+
+#if !defined(AGS_DISABLE_THREADS)
+// Raises the audio thread's priority above the normal one
+static void set_audio_thread_high_priority(std::thread &thread)
+{
+#if AGS_PLATFORM_OS_WINDOWS
+    if (!SetThreadPriority(thread.native_handle(), THREAD_PRIORITY_HIGHEST))
+        Debug::Printf(kDbgMsg_Warn, "AudioCore: failed to raise the audio thread priority");
+#elif !AGS_PLATFORM_OS_EMSCRIPTEN
+    // realtime round-robin scheduling, which usually requires privileges
+    sched_param param{};
+    param.sched_priority = sched_get_priority_min(SCHED_RR);
+    const int err = pthread_setschedparam(thread.native_handle(), SCHED_RR, &param);
+    if (err != 0)
+        Debug::Printf(kDbgMsg_Warn, "AudioCore: failed to raise the audio thread priority (error %d)", err);
+#else
+    (void)thread;
+#endif
+}
+#endif
 
-void audio_core_init() 
+void audio_core_init(const AudioCoreConfig &config)
 {
+    OpenAlSource::SetQueueLength(static_cast<ALuint>(std::max(2, config.BufferCount)));
+    SDLDecoder::SetBufferSize(config.BufferSize);
+    g_acore.poll_interval_ms = std::max(1, config.PollIntervalMs);
+    g_acore.max_voices = std::max(0, config.MaxVoices);
+    Debug::Printf(kDbgMsg_Info, "AudioCore: %d buffers of %zu bytes, polling each %d ms",
+        std::max(2, config.BufferCount), config.BufferSize, g_acore.poll_interval_ms);
+
     /* InitAL opens a device and sets up a context using default attributes, making
      * the program ready to call OpenAL functions. */
 
@@ -99,7 +237,13 @@ void audio_core_init()
 
     g_acore.audio_core_thread_running = true;
 #if !defined(AGS_DISABLE_THREADS)
+    const size_t decode_threads = JobScheduler::ResolveThreadCount(config.DecodeThreads, MaxAutoDecodeThreads);
+    for (size_t i = 0; i < decode_threads; ++i)
+        g_acore.decode_threads.emplace_back(audio_core_decode_entry);
+    Debug::Printf(kDbgMsg_Info, "AudioCore: %zu decode threads", decode_threads);
     g_acore.audio_core_thread = std::thread(audio_core_entry);
+    if (config.HighPriority)
+        set_audio_thread_high_priority(g_acore.audio_core_thread);
 #endif
 }
 
@@ -107,12 +251,27 @@ void audio_core_shutdown()
 {
     g_acore.audio_core_thread_running = false;
 #if !defined(AGS_DISABLE_THREADS)
+    {
+        std::lock_guard<std::mutex> lk(g_acore.wake_mutex);
+    }
+    g_acore.wake_cv.notify_all();
     if (g_acore.audio_core_thread.joinable())
         g_acore.audio_core_thread.join();
+    {
+        std::lock_guard<std::mutex> lk(g_acore.decode_mutex);
+    }
+    g_acore.decode_cv.notify_all();
+    for (auto &thread : g_acore.decode_threads)
+        thread.join();
+    g_acore.decode_threads.clear();
 #endif
+    g_acore.decoders.clear();
 
-    // dispose all the active slots
+    // dispose all the active slots, and the ones not yet passed to the audio thread
+    AudioCommand cmd;
+    while (g_acore.commands.TryPop(cmd)) {}
     g_acore.slots_.clear();
+    g_acore.clients_.clear();
 
     // SDL_Sound
     Sound_Quit();
@@ -142,6 +301,19 @@ void audio_core_set_master_volume(float newvol)
     dump_al_errors();
 }
 
+AudioCoreStats audio_core_get_stats()
+{
+    AudioCoreStats stats;
+    stats.Underruns = g_acore.stat_underruns.load(std::memory_order_relaxed);
+    stats.QueuedMs = g_acore.stat_queued_ms.load(std::memory_order_relaxed);
+    stats.Starts = g_acore.stat_starts.load(std::memory_order_relaxed);
+    const uint64_t total_us = g_acore.stat_start_latency_total_us.load(std::memory_order_relaxed);
+    stats.StartLatencyMs = stats.Starts > 0 ? static_cast<int>(total_us / stats.Starts / 1000) : 0;
+    stats.MaxStartLatencyMs = static_cast<int>(g_acore.stat_start_latency_max_us.load(std::memory_order_relaxed) / 1000);
+    stats.VirtualVoices = g_acore.stat_virtual_voices.load(std::memory_order_relaxed);
+    return stats;
+}
+
 
 // -------------------------------------------------------------------------------------------------
 // SLOTS
@@ -152,12 +324,75 @@ static int avail_slot_id()
     return g_acore.nextId++;
 }
 
+static void audio_core_wake()
+{
+#if !defined(AGS_DISABLE_THREADS)
+    // lock to make sure that the audio thread does not miss the wake up,
+    // if it's just about to wait
+    {
+        std::lock_guard<std::mutex> lk(g_acore.wake_mutex);
+    }
+    g_acore.wake_cv.notify_one();
+#endif
+}
+
+static void audio_core_push_command(AudioCommand &&cmd)
+{
+    cmd.Time = AudioClock::now();
+    while (!g_acore.commands.TryPush(std::move(cmd)))
+    {
+        // the queue is full, let the audio thread catch up
+#if defined(AGS_DISABLE_THREADS)
+        audio_core_entry_poll();
+#else
+        audio_core_wake();
+        std::this_thread::yield();
+#endif
+    }
+    audio_core_wake();
+}
+
+// Queues a command for the existing slot; returns the command id, or 0 if there's no such slot
+static uint32_t audio_core_slot_command(int slot_handle, AudioCommandType type,
+    float val1 = 0.f, float val2 = 0.f, float val3 = 0.f, float val4 = 0.f)
+{
+    auto it = g_acore.clients_.find(slot_handle);
+    if (it == g_acore.clients_.end())
+        return 0u;
+    AudioCommand cmd;
+    cmd.Type = type;
+    cmd.Handle = slot_handle;
+    cmd.Id = ++it->second.LastCommand;
+    cmd.Values[0] = val1;
+    cmd.Values[1] = val2;
+    cmd.Values[2] = val3;
+    cmd.Values[3] = val4;
+    audio_core_push_command(std::move(cmd));
+    return it->second.LastCommand;
+}
+
+// Tells if the command with the given id was not done by the audio thread yet
+static bool is_command_pending(const AudioSlotClient &client, uint32_t cmd_id)
+{
+    const uint32_t done = client.Status->DoneCommand.load(std::memory_order_acquire);
+    return static_cast<int32_t>(cmd_id - done) > 0;
+}
+
 static int audio_core_slot_init(std::unique_ptr<SDLDecoder> decoder)
 {
     auto handle = avail_slot_id();
-    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    g_acore.slots_[handle] = std::make_unique<AudioPlayer>(handle, std::move(decoder));
-    g_acore.mixer_cv.notify_all();
+    auto player = std::make_unique<AudioPlayer>(handle, std::move(decoder));
+    auto status = std::make_shared<AudioSlotStatus>();
+    status->Frequency.store(player->GetFrequency(), std::memory_order_relaxed);
+    status->DurationMs.store(player->GetDurationMs(), std::memory_order_relaxed);
+    g_acore.clients_[handle].Status = status;
+
+    AudioCommand cmd;
+    cmd.Type = kAudioCmd_Add;
+    cmd.Handle = handle;
+    cmd.Player = std::move(player);
+    cmd.Status = std::move(status);
+    audio_core_push_command(std::move(cmd));
     return handle;
 }
 
@@ -171,59 +406,365 @@ int audio_core_slot_init(std::shared_ptr<std::vector<uint8_t>> &data, const Stri
 
 int audio_core_slot_init(std::unique_ptr<Stream> in, const String &extension_hint, bool repeat)
 {
+    // The stream is opened on the audio thread, as reading the sound's header
+    // may take time; if it fails, the slot will report the error state
     auto decoder = std::make_unique<SDLDecoder>(std::move(in), extension_hint, repeat);
-    if (!decoder->Open())
-        return -1;
     return audio_core_slot_init(std::move(decoder));
 }
 
-AudioPlayerLock audio_core_get_player(int slot_handle)
+int audio_core_slot_init(std::shared_ptr<const SoundPcmData> pcm, bool repeat)
 {
-    std::unique_lock<std::mutex> ulk(g_acore.mixer_mutex_m);
-    auto it = g_acore.slots_.find(slot_handle);
-    if (it == g_acore.slots_.end())
-        return AudioPlayerLock(nullptr, std::move(ulk), &g_acore.mixer_cv);
-    return AudioPlayerLock(it->second.get(), std::move(ulk), &g_acore.mixer_cv);
+    return audio_core_slot_init(std::make_unique<SDLDecoder>(std::move(pcm), repeat));
+}
+
+float audio_core_slot_get_frequency(int slot_handle)
+{
+    auto it = g_acore.clients_.find(slot_handle);
+    return (it != g_acore.clients_.end()) ? it->second.Status->Frequency.load(std::memory_order_acquire) : 0.f;
+}
+
+float audio_core_slot_get_duration_ms(int slot_handle)
+{
+    auto it = g_acore.clients_.find(slot_handle);
+    return (it != g_acore.clients_.end()) ? it->second.Status->DurationMs.load(std::memory_order_acquire) : 0.f;
+}
+
+void audio_core_slot_wait_open(int slot_handle)
+{
+    auto it = g_acore.clients_.find(slot_handle);
+    if (it == g_acore.clients_.end())
+        return;
+    const auto &status = *it->second.Status;
+    while (status.PlayState.load(std::memory_order_acquire) == PlayStateInitial)
+    {
+#if defined(AGS_DISABLE_THREADS)
+        audio_core_entry_poll();
+#else
+        if (!g_acore.audio_core_thread_running)
+            return;
+        audio_core_wake();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+    }
+}
+
+PlaybackState audio_core_slot_get_play_state(int slot_handle)
+{
+    auto it = g_acore.clients_.find(slot_handle);
+    if (it == g_acore.clients_.end())
+        return PlayStateInvalid;
+    const auto &client = it->second;
+    if (is_command_pending(client, client.StateCommand))
+        return client.RequestedState;
+    return static_cast<PlaybackState>(client.Status->PlayState.load(std::memory_order_relaxed));
+}
+
+float audio_core_slot_get_position_ms(int slot_handle)
+{
+    auto it = g_acore.clients_.find(slot_handle);
+    if (it == g_acore.clients_.end())
+        return 0.f;
+    const auto &client = it->second;
+    if (is_command_pending(client, client.SeekCommand))
+        return client.RequestedPosMs;
+    return client.Status->PositionMs.load(std::memory_order_relaxed);
+}
+
+void audio_core_slot_play(int slot_handle)
+{
+    const PlaybackState state = audio_core_slot_get_play_state(slot_handle);
+    const uint32_t cmd_id = audio_core_slot_command(slot_handle, kAudioCmd_Play);
+    if (cmd_id == 0u)
+        return;
+    // report the state which the player will have after the command;
+    // a player which is not initialized yet remains in the initial state
+    if ((state == PlayStatePlaying) || (state == PlayStatePaused) || (state == PlayStateStopped))
+    {
+        auto &client = g_acore.clients_[slot_handle];
+        client.StateCommand = cmd_id;
+        client.RequestedState = PlayStatePlaying;
+    }
+}
+
+void audio_core_slot_pause(int slot_handle)
+{
+    const PlaybackState state = audio_core_slot_get_play_state(slot_handle);
+    const uint32_t cmd_id = audio_core_slot_command(slot_handle, kAudioCmd_Pause);
+    if (cmd_id == 0u)
+        return;
+    if (state == PlayStatePlaying)
+    {
+        auto &client = g_acore.clients_[slot_handle];
+        client.StateCommand = cmd_id;
+        client.RequestedState = PlayStatePaused;
+    }
+}
+
+void audio_core_slot_seek(int slot_handle, float pos_ms)
+{
+    const uint32_t cmd_id = audio_core_slot_command(slot_handle, kAudioCmd_Seek, pos_ms);
+    if (cmd_id == 0u)
+        return;
+    auto &client = g_acore.clients_[slot_handle];
+    client.SeekCommand = cmd_id;
+    client.RequestedPosMs = pos_ms;
+}
+
+void audio_core_slot_configure(int slot_handle, float volume, float speed, float panning, int priority)
+{
+    audio_core_slot_command(slot_handle, kAudioCmd_Configure, volume, speed, panning,
+        static_cast<float>(priority));
 }
 
 void audio_core_slot_stop(int slot_handle)
 {
-    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    g_acore.slots_[slot_handle]->Stop();
-    g_acore.slots_.erase(slot_handle);
-    g_acore.mixer_cv.notify_all();
+    audio_core_slot_command(slot_handle, kAudioCmd_Remove);
+    g_acore.clients_.erase(slot_handle);
 }
 
 // -------------------------------------------------------------------------------------------------
 // AUDIO PROCESSING
 // -------------------------------------------------------------------------------------------------
 
+static void publish_slot_status(AudioSlot &slot, uint32_t done_cmd)
+{
+    slot.Status->Frequency.store(slot.Player->GetFrequency(), std::memory_order_relaxed);
+    slot.Status->DurationMs.store(slot.Player->GetDurationMs(), std::memory_order_relaxed);
+    slot.Status->PlayState.store(slot.Player->GetPlayState(), std::memory_order_release);
+    slot.Status->PositionMs.store(slot.Player->GetPositionMs(), std::memory_order_relaxed);
+    if (done_cmd > 0u)
+        slot.Status->DoneCommand.store(done_cmd, std::memory_order_release);
+}
+
+// Lets the decode threads decode this slot's sound
+static void add_slot_decoder(const AudioSlot &slot)
+{
+    std::lock_guard<std::mutex> lk(g_acore.decode_mutex);
+    g_acore.decoders.push_back(slot.Player->GetDecoder());
+}
+
+static void remove_slot_decoder(const AudioSlot &slot)
+{
+    std::lock_guard<std::mutex> lk(g_acore.decode_mutex);
+    auto &decoders = g_acore.decoders;
+    decoders.erase(std::remove(decoders.begin(), decoders.end(), slot.Player->GetDecoder()), decoders.end());
+}
+
+// Wakes up the decode threads, if there's anything to decode
+static void wake_decode_threads(bool needs_decoding)
+{
+#if !defined(AGS_DISABLE_THREADS)
+    if (!needs_decoding || g_acore.decode_threads.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lk(g_acore.decode_mutex);
+        g_acore.decode_wake++;
+    }
+    g_acore.decode_cv.notify_all();
+#else
+    (void)needs_decoding;
+#endif
+}
+
+static void process_command(AudioCommand &cmd)
+{
+    if (cmd.Type == kAudioCmd_Add)
+    {
+        auto &slot = g_acore.slots_[cmd.Handle];
+        slot.Player = std::move(cmd.Player);
+        slot.Status = std::move(cmd.Status);
+        add_slot_decoder(slot);
+        return;
+    }
+
+    auto it = g_acore.slots_.find(cmd.Handle);
+    if (it == g_acore.slots_.end())
+        return;
+    auto &slot = it->second;
+    switch (cmd.Type)
+    {
+    case kAudioCmd_Remove:
+        slot.Player->Stop();
+        remove_slot_decoder(slot);
+        g_acore.slots_.erase(it);
+        return;
+    case kAudioCmd_Play:
+        if (!slot.WaitingStart && !slot.Player->HasOutputStarted())
+        {
+            slot.PlayTime = cmd.Time;
+            slot.WaitingStart = true;
+        }
+        slot.Player->Play();
+        break;
+    case kAudioCmd_Pause:
+        slot.Player->Pause();
+        break;
+    case kAudioCmd_Seek:
+        slot.Player->Seek(cmd.Values[0]);
+        break;
+    case kAudioCmd_Configure:
+        slot.Player->SetVolume(cmd.Values[0]);
+        slot.Player->SetSpeed(cmd.Values[1]);
+        slot.Player->SetPanning(cmd.Values[2]);
+        slot.Priority = static_cast<int>(cmd.Values[3]);
+        break;
+    default:
+        break;
+    }
+    publish_slot_status(slot, cmd.Id);
+}
+
+static void update_slot_stats(AudioSlot &slot, float &max_queued_ms)
+{
+    const PlaybackState state = slot.Player->GetPlayState();
+    if (state == PlayStatePlaying)
+        max_queued_ms = std::max(max_queued_ms, slot.Player->GetQueuedMs());
+    if (!slot.WaitingStart)
+        return;
+    if (slot.Player->HasOutputStarted())
+    {
+        const uint64_t latency_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            AudioClock::now() - slot.PlayTime).count();
+        g_acore.stat_starts.fetch_add(1u, std::memory_order_relaxed);
+        g_acore.stat_start_latency_total_us.fetch_add(latency_us, std::memory_order_relaxed);
+        const uint32_t latency_us32 = static_cast<uint32_t>(std::min<uint64_t>(latency_us, UINT32_MAX));
+        if (latency_us32 > g_acore.stat_start_latency_max_us.load(std::memory_order_relaxed))
+            g_acore.stat_start_latency_max_us.store(latency_us32, std::memory_order_relaxed);
+        slot.WaitingStart = false;
+    }
+    else if (IsPlaybackDone(state))
+    {
+        slot.WaitingStart = false; // finished or failed before starting
+    }
+}
+
+// Chooses which of the playing sounds are real, and which are virtual,
+// keeping no more than the max number of real voices
+static void update_virtual_voices()
+{
+    if (g_acore.max_voices <= 0)
+        return;
+    std::vector<AudioSlot*> playing;
+    for (auto &entry : g_acore.slots_)
+    {
+        if (entry.second.Player->GetPlayState() == PlayStatePlaying)
+            playing.push_back(&entry.second);
+    }
+    if (playing.size() <= static_cast<size_t>(g_acore.max_voices))
+    {
+        for (auto *slot : playing)
+            slot->Player->SetVirtual(false);
+        g_acore.stat_virtual_voices.store(0, std::memory_order_relaxed);
+        return;
+    }
+    // higher priority first, then the louder ones; on a tie prefer
+    // the real sounds, so that they don't switch back and forth
+    std::stable_sort(playing.begin(), playing.end(), [](const AudioSlot *a, const AudioSlot *b)
+    {
+        if (a->Priority != b->Priority)
+            return a->Priority > b->Priority;
+        if (a->Player->GetVolume() != b->Player->GetVolume())
+            return a->Player->GetVolume() > b->Player->GetVolume();
+        return !a->Player->IsVirtual() && b->Player->IsVirtual();
+    });
+    for (size_t i = 0; i < playing.size(); ++i)
+        playing[i]->Player->SetVirtual(i >= static_cast<size_t>(g_acore.max_voices));
+    g_acore.stat_virtual_voices.store(static_cast<int>(playing.size()) - g_acore.max_voices,
+        std::memory_order_relaxed);
+}
+
 void audio_core_entry_poll()
 {
+    AGS_TRACE_ZONE("audio_core_entry_poll");
     // burn off any errors for new loop
     dump_al_errors();
 
+    AudioCommand cmd;
+    while (g_acore.commands.TryPop(cmd)) {
+        try {
+            process_command(cmd);
+        } catch (const std::exception& e) {
+            Debug::Printf(kDbgMsg_Error, "AudioCore command exception: %s", e.what());
+        }
+        cmd = AudioCommand();
+    }
+
+    update_virtual_voices();
+
+    float max_queued_ms = 0.f;
+    bool needs_decoding = false;
     for (auto &entry : g_acore.slots_) {
         auto &slot = entry.second;
 
         try {
-            slot->Poll();
+            // without the decode threads, decode right before the output
+            if (g_acore.decode_threads.empty())
+                slot.Player->GetDecoder()->Decode();
+            slot.Player->Poll();
         } catch (const std::exception& e) {
             Debug::Printf(kDbgMsg_Error, "AudioCore poll exception: %s", e.what());
         }
+        publish_slot_status(slot, 0u);
+        update_slot_stats(slot, max_queued_ms);
+        needs_decoding |= slot.Player->GetDecoder()->NeedsDecoding();
     }
+    wake_decode_threads(needs_decoding);
+    g_acore.stat_queued_ms.store(static_cast<int>(max_queued_ms), std::memory_order_relaxed);
+    g_acore.stat_underruns.store(OpenAlSource::GetUnderrunCount(), std::memory_order_relaxed);
 }
 
 #if !defined(AGS_DISABLE_THREADS)
 static void audio_core_entry()
 {
-    std::unique_lock<std::mutex> lk(g_acore.mixer_mutex_m);
-
+    EventTrace::SetThreadName("Audio");
     while (g_acore.audio_core_thread_running) {
 
         audio_core_entry_poll();
 
-        g_acore.mixer_cv.wait_for(lk, std::chrono::milliseconds(50));
+        std::unique_lock<std::mutex> lk(g_acore.wake_mutex);
+        g_acore.wake_cv.wait_for(lk, std::chrono::milliseconds(g_acore.poll_interval_ms),
+            []() { return !g_acore.commands.IsEmpty() || g_acore.data_decoded || !g_acore.audio_core_thread_running; });
+        g_acore.data_decoded = false;
+    }
+}
+#endif
+
+#if !defined(AGS_DISABLE_THREADS)
+static void audio_core_decode_entry()
+{
+    EventTrace::SetThreadName("Audio decode");
+    std::vector<std::shared_ptr<AsyncDecoder>> decoders;
+    uint32_t last_wake = 0u;
+    while (g_acore.audio_core_thread_running) {
+        {
+            std::unique_lock<std::mutex> lk(g_acore.decode_mutex);
+            g_acore.decode_cv.wait_for(lk, std::chrono::milliseconds(g_acore.poll_interval_ms),
+                [&last_wake]() { return g_acore.decode_wake != last_wake || !g_acore.audio_core_thread_running; });
+            last_wake = g_acore.decode_wake;
+            decoders.assign(g_acore.decoders.begin(), g_acore.decoders.end());
+        }
+
+        // the decoder which is busy with another thread is skipped
+        AGS_TRACE_ZONE("Audio decode");
+        bool decoded = false;
+        for (auto &decoder : decoders) {
+            try {
+                if (decoder->NeedsDecoding())
+                    decoded |= decoder->Decode();
+            } catch (const std::exception& e) {
+                Debug::Printf(kDbgMsg_Error, "AudioCore decode exception: %s", e.what());
+            }
+        }
+        decoders.clear();
+
+        // let the audio thread pass the new data to the output right away
+        if (decoded) {
+            {
+                std::lock_guard<std::mutex> lk(g_acore.wake_mutex);
+                g_acore.data_decoded = true;
+            }
+            g_acore.wake_cv.notify_one();
+        }
     }
 }
 #endif
@@ -17,61 +17,51 @@
 //=============================================================================
 #ifndef __AGS_EE_MEDIA__AUDIOCORE_H
 #define __AGS_EE_MEDIA__AUDIOCORE_H
-#include <condition_variable>
 #include <memory>
-#include <mutex>
 #include <vector>
 #include "media/audio/audiodefines.h"
-#include "media/audio/audioplayer.h"
+#include "media/audio/sdldecoder.h"
+#include "util/stream.h"
 #include "util/string.h"
 
-
-namespace AGS
-{
-namespace Engine
+// Audio core configuration
+struct AudioCoreConfig
 {
+    // Number of sound buffers queued for output by each playing sound
+    int BufferCount = 2;
+    // Size of the sound data decoded at once, in bytes
+    size_t BufferSize = 64 * 1024;
+    // Max interval between the polls of the playing sounds, in ms
+    int PollIntervalMs = 50;
+    // Run the audio thread with a higher priority
+    bool HighPriority = false;
+    // Max number of sounds which are decoded and output at the same time,
+    // 0 means unlimited; the rest of the playing sounds are made virtual
+    int MaxVoices = 0;
+    // Number of threads decoding the sounds ahead of the audio output,
+    // 0 means choose automatically
+    int DecodeThreads = 0;
+};
 
-// AudioPlayerLock wraps a AudioPlayer pointer guarded by a mutex lock.
-// Unlocks the mutex on destruction (e.g. when going out of scope).
-class AudioPlayerLock
+// Audio core statistics
+struct AudioCoreStats
 {
-public:
-    AudioPlayerLock(AudioPlayer *player, std::unique_lock<std::mutex> &&ulk, std::condition_variable *cv)
-        : _player(player)
-        , _ulock(std::move(ulk))
-        , _cv(cv)
-    {
-    }
-
-    AudioPlayerLock(AudioPlayerLock &&lock)
-        : _player(lock._player)
-        , _ulock(std::move(lock._ulock))
-        , _cv(lock._cv)
-    {
-        lock._cv = nullptr;
-    }
-
-    ~AudioPlayerLock()
-    {
-        if (_cv)
-            _cv->notify_all();
-    }
-
-    const AudioPlayer *operator ->() const { return _player; }
-    AudioPlayer *operator ->() { return _player; }
-
-private:
-    AudioPlayer *_player = nullptr;
-    std::unique_lock<std::mutex> _ulock;
-    std::condition_variable *_cv = nullptr;
+    // Number of times a playing sound ran out of queued data
+    uint64_t Underruns = 0u;
+    // Max duration of data queued by a playing sound, at the last poll, in ms
+    int QueuedMs = 0;
+    // Number of measured sound starts
+    uint64_t Starts = 0u;
+    // Average and max time between the play command and the sound's output start, in ms
+    int StartLatencyMs = 0;
+    int MaxStartLatencyMs = 0;
+    // Number of playing sounds which are virtual, at the last poll
+    int VirtualVoices = 0;
 };
 
-} // namespace Engine
-} // namespace AGS
-
 // Initializes audio core system;
 // starts polling on a background thread.
-void audio_core_init(/*config, soundlib*/);
+void audio_core_init(const AudioCoreConfig &config = AudioCoreConfig());
 // Shut downs audio core system;
 // stops any associated threads.
 void audio_core_shutdown();
@@ -79,6 +69,8 @@ void audio_core_shutdown();
 // Audio core config
 // Set new master volume, affects all slots
 void audio_core_set_master_volume(float newvol);
+// Gets the audio core statistics
+AudioCoreStats audio_core_get_stats();
 
 // Audio slot controls: slots are abstract holders for a playback.
 //
@@ -87,8 +79,38 @@ void audio_core_set_master_volume(float newvol);
 int audio_core_slot_init(std::shared_ptr<std::vector<uint8_t>> &data, const AGS::Common::String &extension_hint, bool repeat);
 // Initializes playback streaming
 int audio_core_slot_init(std::unique_ptr<AGS::Common::Stream> in, const AGS::Common::String &extension_hint, bool repeat);
-// Returns a AudioPlayer from the given slot, wrapped in a auto-locking struct.
-AGS::Engine::AudioPlayerLock audio_core_get_player(int slot_handle);
+// Initializes playback of the already decoded sound
+int audio_core_slot_init(std::shared_ptr<const AGS::Engine::SoundPcmData> pcm, bool repeat);
+// Gets the sound's frequency (sample rate)
+float audio_core_slot_get_frequency(int slot_handle);
+// Gets the sound's duration, in ms
+float audio_core_slot_get_duration_ms(int slot_handle);
+// Waits until the sound is opened, and its properties are known;
+// the streamed sounds are opened by the audio thread, so their properties
+// are reported as zero until then
+void audio_core_slot_wait_open(int slot_handle);
+// Gets the playback state; this is the state last published by the audio
+// thread, or the requested one, if the audio thread has not handled
+// the request yet
+PlaybackState audio_core_slot_get_play_state(int slot_handle);
+// Gets the playback position, in ms; same as above, this is either the
+// last published position, or the requested seek position
+float audio_core_slot_get_position_ms(int slot_handle);
+// Playback controls: these are queued for the audio thread, and return
+// without waiting for them to be done.
+//
+// Begin playback
+void audio_core_slot_play(int slot_handle);
+// Pause playback
+void audio_core_slot_pause(int slot_handle);
+// Seek to the given time position
+void audio_core_slot_seek(int slot_handle, float pos_ms);
+// Sets the playback volume (gain), speed (fraction of normal)
+// and panning (-1.0f to 1.0), and the sound's priority; when there are more
+// playing sounds than the max voices, the ones with the lowest priority
+// (and then the quietest ones) are made virtual: they do not decode nor
+// output the sound, but advance their position, until they are real again
+void audio_core_slot_configure(int slot_handle, float volume, float speed, float panning, int priority);
 // Stop and release the audio player at the given slot
 void audio_core_slot_stop(int slot_handle);
 
@@ -12,6 +12,7 @@
 //
 //=============================================================================
 #include "media/audio/audioplayer.h"
+#include <cmath>
 #include "util/memory_compat.h"
 
 namespace AGS
@@ -20,10 +21,8 @@ namespace Engine
 {
 
 AudioPlayer::AudioPlayer(int handle, std::unique_ptr<SDLDecoder> decoder)
-    : handle_(handle), _decoder(std::move(decoder))
+    : handle_(handle), _decoder(std::make_shared<AsyncDecoder>(std::move(decoder)))
 {
-    _source = std::make_unique<OpenAlSource>(
-        _decoder->GetFormat(), _decoder->GetChannels(), _decoder->GetFreq());
 }
 
 void AudioPlayer::Init()
@@ -31,30 +30,120 @@ void AudioPlayer::Init()
     bool success;
     if (_decoder->IsValid()) // if already opened, then just seek to start
         success = _decoder->Seek(_onLoadPositionMs) == _onLoadPositionMs;
-    else
+    else // streamed sounds are opened here, on the first poll
         success = _decoder->Open(_onLoadPositionMs);
+    if (success)
+    {
+        _source = std::make_unique<OpenAlSource>(
+            _decoder->GetFormat(), _decoder->GetChannels(), _decoder->GetFreq());
+        _source->SetPanning(_panning);
+        _source->SetSpeed(_speed);
+        _source->SetVolume(_volume);
+    }
     _playState = success ? _onLoadPlayState : PlayStateError;
     if (_playState == PlayStatePlaying)
         _source->Play();
 }
 
+float AudioPlayer::GetPositionMs() const
+{
+    if (_virtual)
+        return GetVirtualPositionMs();
+    return _source ? _source->GetPositionMs() : _onLoadPositionMs;
+}
+
+float AudioPlayer::GetVirtualPositionMs() const
+{
+    if (_playState != PlayStatePlaying)
+        return _virtualPosMs;
+    const float elapsed_ms = std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - _virtualTime).count();
+    return _virtualPosMs + elapsed_ms * _speed;
+}
+
+void AudioPlayer::PollVirtual()
+{
+    const float dur_ms = _decoder->GetDurationMs();
+    if (dur_ms <= 0.f)
+        return; // unknown duration, keep going until made real
+    const float pos_ms = GetVirtualPositionMs();
+    if (pos_ms < dur_ms)
+        return;
+    if (_decoder->IsRepeating())
+    {
+        _virtualPosMs = std::fmod(pos_ms, dur_ms);
+        _virtualTime = std::chrono::steady_clock::now();
+    }
+    else
+    {
+        _virtualPosMs = dur_ms;
+        _playState = PlayStateFinished;
+    }
+}
+
+void AudioPlayer::SetVirtual(bool is_virtual)
+{
+    if ((_virtual == is_virtual) || !_source)
+        return; // not changed, or not initialized yet
+    if (is_virtual)
+    {
+        _virtualPosMs = _source->GetPositionMs();
+        _virtualTime = std::chrono::steady_clock::now();
+        _source->Stop();
+        _decoder->Suspend();
+        _virtual = true;
+    }
+    else
+    {
+        const float pos_ms = GetVirtualPositionMs();
+        _virtual = false;
+        float new_pos = _decoder->Seek(pos_ms);
+        _source->SetPlaybackPosMs(new_pos);
+        if (_playState == PlayStatePlaying)
+            _source->Play();
+    }
+}
+
+void AudioPlayer::SetPanning(float panning)
+{
+    _panning = panning;
+    if (_source)
+        _source->SetPanning(panning);
+}
+
+void AudioPlayer::SetSpeed(float speed)
+{
+    _speed = speed;
+    if (_source)
+        _source->SetSpeed(speed);
+}
+
+void AudioPlayer::SetVolume(float volume)
+{
+    _volume = volume;
+    if (_source)
+        _source->SetVolume(volume);
+}
+
 void AudioPlayer::Poll()
 {
     if (_playState == PlaybackState::PlayStateInitial)
         Init();
     if (_playState != PlayStatePlaying)
         return;
-
-    // Read data from Decoder and pass into the Al Source
-    if (!_bufferPending.Data && !_decoder->EOS())
-    { // if no buffer saved, and still something to decode, then read a buffer
-        _bufferPending = _decoder->GetData();
-        assert(_bufferPending.Data || (_bufferPending.Size == 0));
+    if (_virtual)
+    {
+        PollVirtual();
+        return;
     }
-    if (_bufferPending.Data && (_bufferPending.Size > 0))
-    { // if having a buffer already, then try to put into source
-        if (_source->PutData(_bufferPending) > 0)
-            _bufferPending = SoundBuffer(); // clear buffer on success
+
+    // Pass the data decoded ahead into the Al Source, while it accepts more;
+    // the chunk is released once the source has copied it
+    for (SoundBuffer buf = _decoder->GetData(); buf; buf = _decoder->GetData())
+    {
+        if (_source->PutData(buf) == 0)
+            break;
+        _decoder->ReleaseData();
     }
     _source->Poll();
     // If both finished decoding and playing, we done here.
@@ -76,7 +165,10 @@ void AudioPlayer::Play()
         /* fall-through */
     case PlayStatePaused:
         _playState = PlayStatePlaying;
-        _source->Play();
+        if (_virtual)
+            _virtualTime = std::chrono::steady_clock::now();
+        else
+            _source->Play();
         break;
     default:
         break;
@@ -91,8 +183,11 @@ void AudioPlayer::Pause()
         _onLoadPlayState = PlayStatePaused;
         break;
     case PlayStatePlaying:
+        if (_virtual)
+            _virtualPosMs = GetVirtualPositionMs();
+        else
+            _source->Pause();
         _playState = PlayStatePaused;
-        _source->Pause();
         break;
     default:
         break;
@@ -110,7 +205,8 @@ void AudioPlayer::Stop()
     case PlayStatePaused:
         _playState = PlayStateStopped;
         _source->Stop();
-        _bufferPending = SoundBuffer(); // clear
+        _decoder->Suspend();
+        _virtual = false;
         break;
     default:
         break;
@@ -127,9 +223,14 @@ void AudioPlayer::Seek(float pos_ms)
     case PlayStatePlaying:
     case PlayStatePaused:
     case PlayStateStopped:
+        if (_virtual)
+        {
+            _virtualPosMs = pos_ms;
+            _virtualTime = std::chrono::steady_clock::now();
+        }
+        else
         {
             _source->Stop();
-            _bufferPending = SoundBuffer(); // clear
             float new_pos = _decoder->Seek(pos_ms);
             _source->SetPlaybackPosMs(new_pos);
         }
@@ -14,7 +14,8 @@
 //
 // Audio playback class.
 // Controls playback state. Retrieves audio data from decoder and passes into
-// the audio output.
+// the audio output. The data is decoded ahead by the decode worker threads,
+// the player only takes the ready data.
 //
 // TODO: a virtual Decoder and AudioOutput interfaces, to let hide current
 // implementations, and also substitute default implementations
@@ -23,9 +24,10 @@
 //=============================================================================
 #ifndef __AGS_EE_MEDIA__AUDIOPLAYER_H
 #define __AGS_EE_MEDIA__AUDIOPLAYER_H
+#include <chrono>
 #include <memory>
 #include "media/audio/audiodefines.h" // PlaybackState etc
-#include "media/audio/sdldecoder.h"
+#include "media/audio/asyncdecoder.h"
 #include "media/audio/openalsource.h"
 
 namespace AGS
@@ -38,22 +40,33 @@ class AudioPlayer
 public:
     AudioPlayer(int handle, std::unique_ptr<SDLDecoder> decoder);
 
+    // Gets the decoder, which should be passed to a decode worker
+    const std::shared_ptr<AsyncDecoder> &GetDecoder() const { return _decoder; }
     // Gets current playback state
     PlaybackState GetPlayState() const { return _playState; }
-    // Gets frequency (sample rate)
+    // Gets frequency (sample rate); 0 until the decoder is opened
     float GetFrequency() const { return _decoder->GetFreq(); }
-    // Gets duration, in ms
+    // Gets duration, in ms; 0 until the decoder is opened
     float GetDurationMs() const { return _decoder->GetDurationMs(); }
     // Gets playback position, in ms
-    float GetPositionMs() const { return _source->GetPositionMs(); }
+    float GetPositionMs() const;
+    // Gets the playback volume (gain)
+    float GetVolume() const { return _volume; }
+    // Tells if the player is virtual: it does not decode nor output
+    // the sound, and only advances the playback position
+    bool IsVirtual() const { return _virtual; }
+    // Tells if the sound output has started since the last play command
+    bool HasOutputStarted() const { return _source && _source->HasStarted(); }
+    // Gets the duration of the data queued for output, in ms
+    float GetQueuedMs() const { return _source ? _source->GetQueuedMs() : 0.f; }
 
     // Sets the sound panning (-1.0f to 1.0)
-    void SetPanning(float panning) { _source->SetPanning(panning); }
+    void SetPanning(float panning);
     // Sets the playback speed (fraction of normal);
     // NOTE: the speed is implemented through resampling
-    void SetSpeed(float speed) { _source->SetSpeed(speed); }
+    void SetSpeed(float speed);
     // Sets the playback volume (gain)
-    void SetVolume(float volume) { _source->SetVolume(volume); }
+    void SetVolume(float volume);
 
     // Update state, transfer data from decoder to player if possible
     void Poll();
@@ -65,18 +78,33 @@ public:
     void Stop();
     // Seek to the given time position
     void Seek(float pos_ms);
+    // Makes the player virtual or real; the virtual player resumes
+    // the output from its current position when it's made real again
+    void SetVirtual(bool is_virtual);
 
 private:
-    // Opens decoder and sets up playback state
+    // Opens decoder (unless it was opened beforehand), creates the audio
+    // output and sets up playback state
     void Init();
+    // Gets the position of the virtual player
+    float GetVirtualPositionMs() const;
+    // Advances virtual playback, handles reaching the end of the sound
+    void PollVirtual();
 
     const int handle_ = -1; // for diagnostic purposes only
-    std::unique_ptr<SDLDecoder> _decoder;
+    std::shared_ptr<AsyncDecoder> _decoder;
     std::unique_ptr<OpenAlSource> _source;
     PlaybackState _playState = PlayStateInitial;
     PlaybackState _onLoadPlayState = PlayStatePaused;
     float _onLoadPositionMs = 0.0f;
-    SoundBuffer _bufferPending{};
+    // Playback parameters, applied when the audio output is created
+    float _panning = 0.f;
+    float _speed = 1.f;
+    float _volume = 1.f;
+    // Virtual playback: its position is advanced by the elapsed time
+    bool _virtual = false;
+    float _virtualPosMs = 0.f; // position at the virtual time start
+    std::chrono::steady_clock::time_point _virtualTime; // virtual time start
 };
 
 } // namespace Engine
@@ -88,6 +88,10 @@ static struct
 {
     // A record of available al buffers
     std::vector<ALuint> freeBuffers;
+    // Max number of buffers queued by a source
+    ALuint queueLength = OpenAlSource::DefaultQueueLength;
+    // Number of times the sources ran out of data while playing
+    uint64_t underruns = 0u;
 } g_oalint;
 
 
@@ -95,6 +99,16 @@ static struct
 // OpenAlSource
 //-----------------------------------------------------------------------------
 
+void OpenAlSource::SetQueueLength(ALuint count)
+{
+    g_oalint.queueLength = std::max<ALuint>(2u, count);
+}
+
+uint64_t OpenAlSource::GetUnderrunCount()
+{
+    return g_oalint.underruns;
+}
+
 OpenAlSource::OpenAlSource(SDL_AudioFormat format, int channels, int freq)
 {
     _inputFmt.format = format;
@@ -142,7 +156,7 @@ float OpenAlSource::GetPositionMs() const
         {
             float pos_ms = r.Timestamp + (al_offset * 1000.f) * r.Speed;
 #ifdef AUDIO_CORE_DEBUG
-            Debug::Printf("OpenAlSource: pos = %f", pos_ms);
+            DEBUG_PRINTF(kDbgGroup_Main, kDbgMsg_Debug, "OpenAlSource: pos = %f", pos_ms);
 #endif
             return pos_ms;
         }
@@ -152,11 +166,19 @@ float OpenAlSource::GetPositionMs() const
     return _predictTs;
 }
 
+float OpenAlSource::GetQueuedMs() const
+{
+    float queued_ms = 0.f;
+    for (const auto &r : _bufferRecords)
+        queued_ms += r.Duration / r.Speed;
+    return queued_ms;
+}
+
 size_t OpenAlSource::PutData(const SoundBuffer &data)
 {
     Unqueue();
     // If queue is full, bail out
-    if (_queued >= MaxQueue) { return 0u; }
+    if (_queued >= g_oalint.queueLength) { return 0u; }
     // Input buffer is empty?
     if (!data.Data || (data.Size == 0)) { return 0u; }
     // Check for free buffers, generate more if necessary
@@ -235,8 +257,13 @@ ALuint OpenAlSource::Poll()
     dump_al_errors();
     if (state != AL_PLAYING)
     {
+        // The source was started earlier and stopped by itself,
+        // which means that it played all the queued data
+        if ((state == AL_STOPPED) && _started)
+            g_oalint.underruns++;
         alSourcePlay(_source);
         dump_al_errors();
+        _started = true;
     }
     return _queued;
 }
@@ -256,6 +283,7 @@ void OpenAlSource::Play()
         {
             alSourcePlay(_source);
             dump_al_errors();
+            _started = true;
         }
         break;
     default:
@@ -277,6 +305,7 @@ void OpenAlSource::Stop()
         Unqueue();
         _playState = PlayStateStopped;
         _predictTs = 0.f;
+        _started = false;
         break;
     default:
         break;
@@ -33,8 +33,15 @@ namespace Engine
 class OpenAlSource
 {
 public:
-    // Max sound buffers to queue before/during processing
-    static const ALuint MaxQueue = 2;
+    // Default number of sound buffers to queue before/during processing
+    static const ALuint DefaultQueueLength = 2;
+
+    // Sets the max number of sound buffers to queue, for all sources;
+    // more buffers lower the risk of underruns, but increase the latency
+    static void SetQueueLength(ALuint count);
+    // Gets the total number of times when any source ran out of queued data
+    // while playing, and had to be restarted
+    static uint64_t GetUnderrunCount();
 
     // Initializes Al source for the given format; if there's no direct format equivalent
     // found, setups a resampler.
@@ -48,6 +55,10 @@ public:
     PlaybackState GetPlayState() const { return _playState; }
     // Tells if the data queue is empty
     bool IsEmpty() const { return _queued == 0; }
+    // Tells if the sound output has started since the last play command
+    bool HasStarted() const { return _started; }
+    // Gets the duration of the queued data, in ms
+    float GetQueuedMs() const;
     // Gets current playback position, in ms
     float GetPositionMs() const;
 
@@ -88,6 +99,7 @@ private:
     float _speed = 1.f; // change in playback rate
     float _predictTs = 0.f; // next timestamp prediction
     unsigned _queued = 0u;
+    bool _started = false; // al source was started since the last play
 
     // SDL resampler state, in case dynamic resampling in necessary
     SDLResampler _resampler;
@@ -12,6 +12,7 @@
 //
 //=============================================================================
 #include "media/audio/sdldecoder.h"
+#include <algorithm>
 #include "util/sdl2_util.h"
 
 namespace AGS
@@ -55,7 +56,14 @@ const void *SDLResampler::Convert(const void *data, size_t sz, size_t &out_sz)
 //-----------------------------------------------------------------------------
 // SDLDecoder
 //-----------------------------------------------------------------------------
-const auto SampleDefaultBufferSize = 64 * 1024;
+// Size of the sound data decoded at once
+static uint32_t SampleBufferSize = SDLDecoder::DefaultBufferSize;
+
+void SDLDecoder::SetBufferSize(size_t size)
+{
+    // keep the buffer size a multiple of the common sample frame sizes
+    SampleBufferSize = static_cast<uint32_t>(std::max<size_t>(1024u, size - size % 32));
+}
 
 SDLDecoder::SDLDecoder(std::shared_ptr<std::vector<uint8_t>> &data,
     const AGS::Common::String &ext_hint, bool repeat)
@@ -73,9 +81,17 @@ SDLDecoder::SDLDecoder(std::unique_ptr<Stream> in,
 {
 }
 
+SDLDecoder::SDLDecoder(std::shared_ptr<const SoundPcmData> pcm, bool repeat)
+    : _pcm(std::move(pcm))
+    , _repeat(repeat)
+{
+    _durationMs = _pcm->DurationMs;
+}
+
 SDLDecoder::SDLDecoder(SDLDecoder &&dec)
 {
     _sampleData = (std::move(dec._sampleData));
+    _pcm = std::move(dec._pcm);
     _rwops = std::move(dec._rwops);
     dec._rwops = nullptr;
     _sampleExt = std::move(dec._sampleExt);
@@ -86,6 +102,11 @@ bool SDLDecoder::Open(float pos_ms)
 {
     // Prevent from "reopening" twice
     assert(!_sample);
+    if (_pcm)
+    { // decoded sound is always ready
+        Seek(pos_ms);
+        return true;
+    }
     if (_sample && pos_ms > 0.f)
     {
         Seek(pos_ms);
@@ -96,12 +117,12 @@ bool SDLDecoder::Open(float pos_ms)
     if (_rwops)
     {
         sample = SoundSampleUniquePtr(Sound_NewSample(_rwops,
-            _sampleExt.GetCStr(), nullptr, SampleDefaultBufferSize));
+            _sampleExt.GetCStr(), nullptr, SampleBufferSize));
     }
     else
     {
         sample = SoundSampleUniquePtr(Sound_NewSampleFromMem(
-            _sampleData->data(), _sampleData->size(), _sampleExt.GetCStr(), nullptr, SampleDefaultBufferSize));
+            _sampleData->data(), _sampleData->size(), _sampleExt.GetCStr(), nullptr, SampleBufferSize));
     }
     if (!sample)
     {
@@ -124,12 +145,26 @@ bool SDLDecoder::Open(float pos_ms)
 void SDLDecoder::Close()
 {
     _sample.reset();
+    _pcm = nullptr;
     _rwops = nullptr; // rwops was closed by the Sound_NewSample
     _sampleData = nullptr;
 }
 
 float SDLDecoder::Seek(float pos_ms)
 {
+    if (_pcm && pos_ms >= 0.f)
+    {
+        const auto &fmt = _pcm->Format;
+        const size_t frame_size = SoundHelper::BytesPerSample(fmt.format) * fmt.channels;
+        size_t pos_bytes = SoundHelper::BytesPerMs(pos_ms, fmt.format, fmt.channels, fmt.rate);
+        pos_bytes -= pos_bytes % frame_size;
+        if (pos_bytes > _pcm->Data.size())
+            return _posMs; // old pos on failure
+        _posBytes = pos_bytes;
+        _posMs = pos_ms;
+        _EOS = false;
+        return pos_ms;
+    }
     if (!_sample || pos_ms < 0.f)
         return _posMs;
     if (Sound_Seek(_sample.get(), static_cast<uint32_t>(pos_ms)) == 0)
@@ -140,8 +175,36 @@ float SDLDecoder::Seek(float pos_ms)
     return pos_ms; // new pos on success
 }
 
+SoundBuffer SDLDecoder::GetPcmData()
+{
+    const auto &fmt = _pcm->Format;
+    if (_posBytes >= _pcm->Data.size())
+    {
+        if (!_repeat || _pcm->Data.empty())
+        {
+            _EOS = true;
+            return SoundBuffer();
+        }
+        _posBytes = 0u; // if repeat, then wrap to start
+        _posMs = 0.f;
+    }
+    const float old_pos = _posMs;
+    const size_t frame_size = SoundHelper::BytesPerSample(fmt.format) * fmt.channels;
+    const size_t sz = std::min<size_t>(SampleBufferSize - SampleBufferSize % frame_size,
+        _pcm->Data.size() - _posBytes);
+    const uint8_t *data = _pcm->Data.data() + _posBytes;
+    _posBytes += sz;
+    _posMs = SoundHelper::MillisecondsFromBytes(_posBytes, fmt.format, fmt.channels, fmt.rate);
+    if (!_repeat && (_posBytes >= _pcm->Data.size()))
+        _EOS = true;
+    return SoundBuffer(data, sz, old_pos,
+        SoundHelper::MillisecondsFromBytes(sz, fmt.format, fmt.channels, fmt.rate));
+}
+
 SoundBuffer SDLDecoder::GetData()
 {
+    if (_pcm && !_EOS)
+        return GetPcmData();
     if (!_sample || _EOS)
         return SoundBuffer();
     float old_pos = _posMs;
@@ -171,5 +234,26 @@ SoundBuffer SDLDecoder::GetData()
         SoundHelper::MillisecondsFromBytes(sz, _sample->desired.format, _sample->desired.channels, _sample->desired.rate));
 }
 
+std::shared_ptr<SoundPcmData> SDLDecoder::DecodeAll(const std::vector<uint8_t> &data,
+    const String &ext_hint, float max_duration_ms)
+{
+    SoundSampleUniquePtr sample(Sound_NewSampleFromMem(
+        data.data(), data.size(), ext_hint.GetCStr(), nullptr, SampleBufferSize));
+    if (!sample)
+        return nullptr;
+    const int dur = Sound_GetDuration(sample.get()); // may return -1 for unknown
+    if ((dur <= 0) || (dur > max_duration_ms))
+        return nullptr;
+    const uint32_t sz = Sound_DecodeAll(sample.get());
+    if ((sample->flags & SOUND_SAMPLEFLAG_ERROR) != 0 || sz == 0)
+        return nullptr;
+    auto pcm = std::make_shared<SoundPcmData>();
+    pcm->Format = sample->desired;
+    pcm->DurationMs = static_cast<float>(dur);
+    const uint8_t *buf = static_cast<const uint8_t*>(sample->buffer);
+    pcm->Data.assign(buf, buf + sz);
+    return pcm;
+}
+
 } // namespace Engine
 } // namespace AGS
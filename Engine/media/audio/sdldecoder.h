@@ -67,6 +67,14 @@ struct SoundBuffer
     operator bool() const { return Data && Size > 0; }
 };
 
+// Fully decoded sound, kept in memory to be played without decoding again.
+struct SoundPcmData
+{
+    Sound_AudioInfo Format{};
+    float DurationMs = 0.f;
+    std::vector<uint8_t> Data;
+};
+
 // RAII wrapper over SDL resampling filter;
 // initialized by passing input and desired sound format;
 // tells whether conversion is necessary and performs one on command.
@@ -103,21 +111,33 @@ private:
 class SDLDecoder
 {
 public:
+    // Default size of the sound data decoded at once, in bytes
+    static const size_t DefaultBufferSize = 64 * 1024;
+
+    // Sets the size of the sound data decoded at once, for all decoders;
+    // this only affects the decoders opened after the call
+    static void SetBufferSize(size_t size);
+
     // Initializes decoder with a complete sound data loaded to memory
     SDLDecoder(std::shared_ptr<std::vector<uint8_t>> &data, const String &ext_hint, bool repeat);
     // Initializes decoder with an input stream
     SDLDecoder(const std::unique_ptr<Stream> in, const String &ext_hint, bool repeat);
+    // Initializes decoder with the already decoded sound; such decoder
+    // only passes the parts of the sound data, and is always valid
+    SDLDecoder(std::shared_ptr<const SoundPcmData> pcm, bool repeat);
     SDLDecoder(SDLDecoder&& dec);
     ~SDLDecoder() = default;
 
     // Tells if the decoder is in a valid state, ready to work
-    bool IsValid() const { return _sample != nullptr; }
+    bool IsValid() const { return _sample != nullptr || _pcm != nullptr; }
     // Gets the audio format
-    SDL_AudioFormat GetFormat() const { return _sample ? _sample->desired.format : 0; }
+    SDL_AudioFormat GetFormat() const { return GetAudioInfo() ? GetAudioInfo()->format : 0; }
     // Gets the number of channels
-    int GetChannels() const { return _sample ? _sample->desired.channels : 0; }
+    int GetChannels() const { return GetAudioInfo() ? GetAudioInfo()->channels : 0; }
     // Gets the audio rate (frequency)
-    int GetFreq() const { return _sample ? _sample->desired.rate : 0; }
+    int GetFreq() const { return GetAudioInfo() ? GetAudioInfo()->rate : 0; }
+    // Tells if the sound is repeated when reaching the end
+    bool IsRepeating() const { return _repeat; }
     // Tells if the data reading has reached EOS
     bool EOS() const { return _EOS; }
     // Gets current reading position, in ms
@@ -134,11 +154,22 @@ public:
     // Returns the next chunk of data; may return empty buffer in EOS or error
     SoundBuffer GetData();
 
+    // Decodes the whole sound from the memory, if its duration is known
+    // and not longer than the given limit; returns null otherwise
+    static std::shared_ptr<SoundPcmData> DecodeAll(const std::vector<uint8_t> &data,
+        const String &ext_hint, float max_duration_ms);
+
 private:
+    const Sound_AudioInfo *GetAudioInfo() const
+        { return _sample ? &_sample->desired : (_pcm ? &_pcm->Format : nullptr); }
+    // Returns the next chunk of the decoded sound
+    SoundBuffer GetPcmData();
+
     SDL_RWops *_rwops = nullptr;
     std::shared_ptr<std::vector<uint8_t>> _sampleData{};
     String _sampleExt = "";
     SoundSampleUniquePtr _sample = nullptr;
+    std::shared_ptr<const SoundPcmData> _pcm;
     float _durationMs = 0.f;
     bool _repeat = false;
     bool _EOS = false;
@@ -12,13 +12,16 @@
 //
 //=============================================================================
 #include "media/audio/sound.h"
+#include <chrono>
 #include <list>
 #include <unordered_map>
+#include <unordered_set>
 #include "ac/game.h"
 #include "core/assetmanager.h"
 #include "debug/out.h"
 #include "media/audio/audio_core.h"
 #include "media/audio/audiodefines.h"
+#include "util/memory_budget.h"
 #include "util/path.h"
 #include "util/resourcecache.h"
 #include "util/stream.h"
@@ -81,46 +84,160 @@ private:
 };
 
 
+// Decoded sound cache, stores the fully decoded short sounds, which
+// then may be played any number of times without decoding.
+class PcmCache final :
+    public ResourceCache<String, std::shared_ptr<const SoundPcmData>>
+{
+public:
+    typedef std::shared_ptr<const SoundPcmData> DataRef;
+
+    PcmCache() : ResourceCache(DEFAULT_PCMCACHESIZE_KB * 1024)
+    {
+    }
+
+private:
+    size_t CalcSize(const DataRef &item) override
+    {
+        assert(item);
+        return item ? item->Data.size() : 0u;
+    }
+};
+
+
 // Maximal sound asset size which is allowed to be loaded at once;
 // anything larger will be streamed
 static size_t MaxLoadAtOnce = DEFAULT_SOUNDLOADATONCE_KB;
 static SoundCache SndCache;
+// Sound assets being read in the background, to be put into the cache
+static std::unordered_map<String, AssetReadFuture> PendingSounds;
+// Max duration of a sound which may be put into the decoded sound cache
+static int PcmMaxLengthMs = DEFAULT_PCMCACHE_MAXLENGTH_MS;
+static PcmCache SndPcmCache;
+// Sounds which are known to not fit into the decoded sound cache,
+// so that they are not decoded again on each play
+static std::unordered_set<String> NonPcmSounds;
+
+// Puts the sound data read in the background into the cache,
+// if it's small enough to be loaded at once
+static SoundCache::DataRef soundcache_put_read(const String &name, const AssetReadResult &result)
+{
+    if (!result.Data || static_cast<size_t>(result.AssetSize) > MaxLoadAtOnce)
+        return nullptr; // failed, or too big for the cache
+    SndCache.Put(name, result.Data);
+    return result.Data;
+}
+
+// Puts the sounds which finished reading in the background into the cache
+static void soundcache_update_pending()
+{
+    for (auto it = PendingSounds.begin(); it != PendingSounds.end();)
+    {
+        if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+        soundcache_put_read(it->first, it->second.get());
+        it = PendingSounds.erase(it);
+    }
+}
+
+// Takes the sound which is being read in the background, waiting for it
+static SoundCache::DataRef soundcache_take_pending(const AssetPath &apath)
+{
+    auto it = PendingSounds.find(apath.Name);
+    if (it == PendingSounds.end())
+        return nullptr;
+    // Re-request with the high priority, which merges with the pending read
+    if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        AssetMgr->ReadAssetAsync(apath, 0, MaxLoadAtOnce, kAssetRead_High);
+    AssetReadResult result = it->second.get();
+    PendingSounds.erase(it);
+    return soundcache_put_read(apath.Name, result);
+}
+
+// Registers the sound caches in the memory budget, if not done yet
+static void soundcache_register_budget()
+{
+    static bool registered = false;
+    if (registered)
+        return;
+    MemoryBudget::Register("sounds", MemoryBudget::kPriority_Sounds,
+        []() { return SndCache.GetCacheSize(); },
+        [](size_t size) { return SndCache.Shrink(size); });
+    MemoryBudget::Register("decoded sounds", MemoryBudget::kPriority_DecodedSounds,
+        []() { return SndPcmCache.GetCacheSize(); },
+        [](size_t size) { return SndPcmCache.Shrink(size); });
+    registered = true;
+}
 
 void soundcache_set_rules(size_t max_loadatonce, size_t max_cachesize)
 {
     MaxLoadAtOnce = max_loadatonce;
     SndCache.SetMaxCacheSize(max_cachesize);
+    soundcache_register_budget();
     Debug::Printf("Sound cache set: %zu KB", max_cachesize / 1024);
 }
 
+void soundcache_set_pcm_rules(size_t max_cachesize, int max_length_ms)
+{
+    SndPcmCache.SetMaxCacheSize(max_cachesize);
+    PcmMaxLengthMs = max_length_ms;
+    NonPcmSounds.clear();
+    soundcache_register_budget();
+    Debug::Printf("Decoded sound cache set: %zu KB, max sound length %d ms", max_cachesize / 1024, max_length_ms);
+}
+
 void soundcache_clear()
 {
     SndCache.Clear();
+    SndPcmCache.Clear();
+    NonPcmSounds.clear();
+    PendingSounds.clear(); // the background reads will be discarded
 }
 
 void soundcache_precache(const AssetPath &apath)
 {
     if (SndCache.GetMaxCacheSize() == 0)
         return; // cache is disabled
-    if (SndCache.Exists(apath.Name))
-        return; // already in cache
-    auto s_in = AssetMgr->OpenAsset(apath);
-    if (!s_in)
-        return; // failed to open asset
-    size_t asset_size = static_cast<size_t>(s_in->GetLength());
-    if (asset_size > MaxLoadAtOnce)
-        return; // too big for the cache
-    // Read and put into the cache
-    auto sounddata = std::make_shared<std::vector<uint8_t>>(asset_size);
-    s_in->Read(sounddata->data(), asset_size);
-    SndCache.Put(apath.Name, sounddata);
+    soundcache_update_pending();
+    if (SndCache.Exists(apath.Name) || (PendingSounds.count(apath.Name) > 0))
+        return; // already in cache, or requested
+    // Read in the background, but not more than may be loaded at once;
+    // the larger sounds will be streamed anyway
+    PendingSounds[apath.Name] = AssetMgr->ReadAssetAsync(apath, 0, MaxLoadAtOnce, kAssetRead_Low);
+}
+
+// Gets the decoded sound from the cache, or decodes and puts it there,
+// if the sound is short enough
+static PcmCache::DataRef soundcache_get_pcm(const String &name,
+    const std::vector<uint8_t> &data, const String &ext_hint)
+{
+    if ((SndPcmCache.GetMaxCacheSize() == 0) || (PcmMaxLengthMs <= 0))
+        return nullptr; // cache is disabled
+    if (SndPcmCache.Exists(name))
+        return SndPcmCache.Get(name);
+    if (NonPcmSounds.count(name) > 0)
+        return nullptr;
+    PcmCache::DataRef pcm = SDLDecoder::DecodeAll(data, ext_hint, static_cast<float>(PcmMaxLengthMs));
+    if (!pcm || (pcm->Data.size() > SndPcmCache.GetMaxCacheSize()))
+    {
+        NonPcmSounds.insert(name);
+        return nullptr;
+    }
+    SndPcmCache.Put(name, pcm);
+    return pcm;
 }
 
 SOUNDCLIP *load_sound_clip(const AssetPath &apath, const char *extension_hint, bool loop)
 {
     size_t asset_size;
     std::unique_ptr<Stream> s_in;
+    soundcache_update_pending();
     auto sounddata = SndCache.Get(apath.Name);
+    if (!sounddata)
+        sounddata = soundcache_take_pending(apath);
     if (sounddata)
     {
         asset_size = sounddata->size();
@@ -147,7 +264,12 @@ SOUNDCLIP *load_sound_clip(const AssetPath &apath, const char *extension_hint, b
             s_in->Read(sounddata->data(), asset_size);
             SndCache.Put(apath.Name, sounddata);
         }
-        slot = audio_core_slot_init(sounddata, ext_hint, loop);
+        // Short sounds are played from their decoded data, when possible
+        auto pcm = soundcache_get_pcm(apath.Name, *sounddata, ext_hint);
+        if (pcm)
+            slot = audio_core_slot_init(pcm, loop);
+        else
+            slot = audio_core_slot_init(sounddata, ext_hint, loop);
     }
     // Otherwise, if asset's size is too large, start streaming
     else
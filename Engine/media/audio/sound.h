@@ -25,12 +25,22 @@
 const size_t DEFAULT_SOUNDLOADATONCE_KB = 1024u;
 // Sound cache limit, in KB
 const size_t DEFAULT_SOUNDCACHESIZE_KB = 1024u * 32; // 32 MB
+// Decoded sound cache limit, in KB
+const size_t DEFAULT_PCMCACHESIZE_KB = 1024u * 8; // 8 MB
+// Max duration of a sound which may be put into the decoded sound cache, in ms
+const int DEFAULT_PCMCACHE_MAXLENGTH_MS = 3000;
 
 // Sets sound loading and caching rules:
 // * max_loadatonce - threshold in bytes for loading sounds immediately, vs streaming
 // * max_cachesize - sound cache limit, in bytes
 void soundcache_set_rules(size_t max_loadatonce, size_t max_cachesize);
+// Sets the decoded sound caching rules:
+// * max_cachesize - decoded sound cache limit, in bytes; 0 disables the cache
+// * max_length_ms - max duration of a sound which may be cached decoded
+void soundcache_set_pcm_rules(size_t max_cachesize, int max_length_ms);
 void soundcache_clear();
+// Requests the sound asset to be read into the cache in the background,
+// if it's small enough to be loaded at once
 void soundcache_precache(const AssetPath &apath);
 
 SOUNDCLIP *load_sound_clip(const AssetPath &apath, const char *extension_hint, bool loop);
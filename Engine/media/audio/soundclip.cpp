@@ -38,9 +38,9 @@ SOUNDCLIP::SOUNDCLIP(int slot, int snd_type, bool loop)
     pos = posMs = -1;
     paramsChanged = true;
 
-    const auto player = audio_core_get_player(slot);
-    lengthMs = (int)std::round(player->GetDurationMs());
-    freq = player->GetFrequency();
+    lengthMs = 0;
+    freq = 0;
+    read_sound_info(false);
 }
 
 SOUNDCLIP::~SOUNDCLIP()
@@ -61,9 +61,8 @@ void SOUNDCLIP::pause()
 {
     if (!is_ready())
         return;
-    auto player = audio_core_get_player(slot_);
-    player->Pause();
-    state = player->GetPlayState();
+    audio_core_slot_pause(slot_);
+    state = audio_core_slot_get_play_state(slot_);
 }
 
 void SOUNDCLIP::resume()
@@ -73,11 +72,30 @@ void SOUNDCLIP::resume()
     state = PlaybackState::PlayStatePlaying;
 }
 
+void SOUNDCLIP::read_sound_info(bool wait)
+{
+    if (freq > 0)
+        return; // already known
+    if (wait)
+        audio_core_slot_wait_open(slot_);
+    freq = (int)audio_core_slot_get_frequency(slot_);
+    lengthMs = (int)std::round(audio_core_slot_get_duration_ms(slot_));
+}
+
+int SOUNDCLIP::get_length_ms()
+{
+    read_sound_info(true);
+    return lengthMs;
+}
+
 int SOUNDCLIP::posms_to_pos(int pos_ms)
 {
     switch (soundType)
     {
     case MUS_WAVE: // Pos is in samples
+        // not waiting for the sound to open here, as this is called on each update
+        if (freq <= 0)
+            return 0;
         return static_cast<int>((static_cast<int64_t>(pos_ms) * freq) / 1000);
     case MUS_MIDI: /* TODO: reimplement */
     case MUS_MOD:  /* TODO: reimplement */
@@ -92,6 +110,9 @@ int SOUNDCLIP::pos_to_posms(int pos_)
     switch (soundType)
     {
     case MUS_WAVE: // Pos is in samples
+        read_sound_info(true);
+        if (freq <= 0)
+            return 0;
         return static_cast<int>((static_cast<int64_t>(pos_) * 1000) / freq);
     case MUS_MIDI: /* TODO: reimplement */
     case MUS_MOD:  /* TODO: reimplement */
@@ -110,13 +131,12 @@ void SOUNDCLIP::seek(int pos_)
 void SOUNDCLIP::seek_ms(int pos_ms)
 {
     if (slot_ < 0) { return; }
-    auto player = audio_core_get_player(slot_);
-    player->Pause();
+    audio_core_slot_pause(slot_);
     // TODO: for backward compatibility and MOD/XM music support
     // need to reimplement seeking to a position which units
     // are defined according to the sound type
-    player->Seek((float)pos_ms);
-    float posms_f = player->GetPositionMs();
+    audio_core_slot_seek(slot_, (float)pos_ms);
+    float posms_f = audio_core_slot_get_position_ms(slot_);
     posMs = static_cast<int>(posms_f);
     pos = posms_to_pos(posMs);
 }
@@ -125,7 +145,8 @@ bool SOUNDCLIP::update()
 {
     if (!is_ready()) return false;
 
-    auto player = audio_core_get_player(slot_);
+    read_sound_info(false);
+
     if (paramsChanged)
     {
         auto vol_f = static_cast<float>(get_final_volume()) / 255.0f;
@@ -140,14 +161,12 @@ bool SOUNDCLIP::update()
         if (panning_f < -1.0f) { panning_f = -1.0f; }
         if (panning_f > 1.0f) { panning_f = 1.0f; }
 
-        player->SetVolume(vol_f);
-        player->SetSpeed(speed_f);
-        player->SetPanning(panning_f);
+        audio_core_slot_configure(slot_, vol_f, speed_f, panning_f, priority);
         paramsChanged = false;
     }
 
-    PlaybackState core_state = player->GetPlayState();
-    float posms_f = player->GetPositionMs();
+    PlaybackState core_state = audio_core_slot_get_play_state(slot_);
+    float posms_f = audio_core_slot_get_position_ms(slot_);
     posMs = static_cast<int>(posms_f);
     pos = posms_to_pos(posMs);
     if (state == core_state || IsPlaybackDone(core_state))
@@ -159,8 +178,8 @@ bool SOUNDCLIP::update()
     switch (state)
     {
     case PlaybackState::PlayStatePlaying:
-        player->Play();
-        state = player->GetPlayState();
+        audio_core_slot_play(slot_);
+        state = audio_core_slot_get_play_state(slot_);
         break;
     default: /* do nothing */
         break;
@@ -103,8 +103,9 @@ public:
     int get_pos() { return pos; }
     // Gets current position in ms
     int get_pos_ms() { return posMs; }
-    // Gets total clip length in ms (or 0)
-    int get_length_ms() { return lengthMs; }
+    // Gets total clip length in ms (or 0); if the streamed clip was not
+    // opened yet by the audio core, waits for that
+    int get_length_ms();
 
     // Sets the current volume property, as percentage (0 - 100).
     inline void set_volume100(int volume)
@@ -176,10 +177,13 @@ private:
 
     int posms_to_pos(int pos_ms);
     int pos_to_posms(int pos);
+    // Reads the sound's properties (frequency and length), which become known
+    // once the audio core opens the sound; optionally waits for that
+    void read_sound_info(bool wait);
 
     // audio core slot handle
     const int slot_;
-    // Frequency, needed for position handling
+    // Frequency, needed for position handling; 0 until the sound is opened
     int freq;
     // current playback state
     PlaybackState state;
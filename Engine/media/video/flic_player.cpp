@@ -54,6 +54,8 @@ HError FlicPlayer::OpenImpl(std::unique_ptr<Common::Stream> data_stream,
     _durationMs = fli_frame_count * fli_speed;
     // FLIC must accumulate frame image because its frames contain diff since the last frame
     flags |= kVideo_AccumFrame;
+    // FLIC frames are paletted, not YUV
+    flags &= ~kVideo_YUVFrames;
     return HError::None();
 }
 
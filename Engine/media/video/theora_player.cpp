@@ -14,6 +14,8 @@
 #include "media/video/theora_player.h"
 
 #ifndef AGS_NO_VIDEO_PLAYER
+#include <string.h>
+#include "gfx/gfxdefines.h"
 
 namespace AGS
 {
@@ -63,6 +65,8 @@ HError TheoraPlayer::OpenImpl(std::unique_ptr<Stream> data_stream,
         flags &= ~kVideo_EnableVideo;
     if ((_apegStream->flags & APEG_HAS_AUDIO) == 0)
         flags &= ~kVideo_EnableAudio;
+    if (!_yuvFrames)
+        flags &= ~kVideo_YUVFrames;
     _dataStream = std::move(data_stream);
     return HError::None();
 }
@@ -83,8 +87,14 @@ HError TheoraPlayer::OpenAPEGStream(Stream *data_stream, const Common::String &n
     // playing if the file is large because it seeks through the whole thing
     apeg_disable_length_detection(TRUE);
     apeg_ignore_audio((flags & kVideo_EnableAudio) == 0);
+    // The YUV planes are received through the display callbacks, which
+    // are global in APEG, so only set them for opening this stream
+    _yuvFrames = false;
+    if ((flags & kVideo_YUVFrames) != 0)
+        apeg_set_display_callbacks(InitYUVDisplay, CopyYUVFrame, this);
 
     APEG_STREAM* apeg_stream = apeg_open_stream_ex(data_stream);
+    apeg_set_display_callbacks(nullptr, nullptr, nullptr);
     if (!apeg_stream)
     {
         return new Error(String::FromFormat("Failed to open theora video '%s'; could be an invalid or unsupported format", name.GetCStr()));
@@ -99,7 +109,7 @@ HError TheoraPlayer::OpenAPEGStream(Stream *data_stream, const Common::String &n
     _usedFlags = flags;
     _usedDepth = target_depth;
 
-    _frameDepth = target_depth;
+    _frameDepth = _yuvFrames ? 8 : target_depth;
     _frameSize = Size(video_w, video_h);
     _frameRate = _apegStream->frame_rate;
     _frameTime = 1000.f / _apegStream->frame_rate;
@@ -110,7 +120,13 @@ HError TheoraPlayer::OpenAPEGStream(Stream *data_stream, const Common::String &n
     // Which means that the original content may end up positioned on a larger frame.
     // In such case we store this surface in a separate wrapper for the reference,
     // while the actual video frame is assigned a sub-bitmap (a portion of the full frame).
-    if (((flags & kVideo_LegacyFrameSize) == 0) &&
+    // The YUV frames have no such surface, their planes are copied directly.
+    if (_yuvFrames)
+    {
+        _theoraFullFrame.reset();
+        _theoraSrcFrame.reset();
+    }
+    else if (((flags & kVideo_LegacyFrameSize) == 0) &&
         Size(_apegStream->bitmap->w, _apegStream->bitmap->h) != _frameSize)
     {
         _theoraFullFrame.reset(BitmapHelper::CreateRawBitmapWrapper(_apegStream->bitmap));
@@ -161,17 +177,54 @@ bool TheoraPlayer::NextVideoFrame(Bitmap *dst)
     // Update frame count
     ++(_apegStream->frame);
 
-    // Update the display frame (decode to RGB)
+    // Update the display frame (decode to RGB, or copy the YUV planes)
     _apegStream->frame_updated = 0;
+    _yuvTarget = dst;
     ret = apeg_display_video_frame(_apegStream);
+    _yuvTarget = nullptr;
     if (ret == APEG_ERROR || ret == APEG_EOF)
         return false;
+    if (_yuvFrames)
+        return true;
 
     // TODO: find a way to optimize Theora decoder by providing our own src bitmap directly
     dst->Blit(_theoraSrcFrame.get());
     return true;
 }
 
+/* static */ int TheoraPlayer::InitYUVDisplay(APEG_STREAM *stream, int coded_w, int /*coded_h*/, void *ptr)
+{
+    TheoraPlayer *player = static_cast<TheoraPlayer*>(ptr);
+    // Only 4:2:0 is supported, otherwise let APEG convert frames to RGB
+    if ((stream->pixel_format != APEG_STREAM::APEG_420) ||
+        (stream->w > player->_maxYUVFrameSize.Width) ||
+        (stream->h > player->_maxYUVFrameSize.Height))
+        return 1;
+    player->_yuvFrames = true;
+    player->_yuvCodedWidth = coded_w;
+    return 0;
+}
+
+/* static */ void TheoraPlayer::CopyYUVFrame(APEG_STREAM *stream, unsigned char **src, void *ptr)
+{
+    TheoraPlayer *player = static_cast<TheoraPlayer*>(ptr);
+    Bitmap *dst = player->_yuvTarget;
+    if (!dst)
+        return;
+    // APEG's planes are cropped to the image, and have coded frame's pitch
+    const YUVFrameLayout layout(Size(stream->w, stream->h));
+    const int y_pitch = player->_yuvCodedWidth;
+    const int c_pitch = player->_yuvCodedWidth / 2;
+    for (int y = 0; y < layout.Frame.Height; ++y)
+        memcpy(dst->GetScanLineForWriting(y), src[0] + y * y_pitch, layout.Frame.Width);
+    const Point u_at = layout.GetUOrigin(), v_at = layout.GetVOrigin();
+    for (int y = 0; y < layout.Chroma.Height; ++y)
+    {
+        memcpy(dst->GetScanLineForWriting(u_at.Y + y) + u_at.X, src[1] + y * c_pitch, layout.Chroma.Width);
+        memcpy(dst->GetScanLineForWriting(v_at.Y + y) + v_at.X, src[2] + y * c_pitch, layout.Chroma.Width);
+    }
+}
+
 SoundBuffer TheoraPlayer::NextAudioFrame()
 {
     assert(_apegStream);
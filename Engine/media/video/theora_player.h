@@ -45,6 +45,10 @@ private:
     SoundBuffer NextAudioFrame() override;
 
     Common::HError OpenAPEGStream(Stream *data_stream, const String &name, int flags, int target_depth);
+    // APEG display callbacks, used to receive the decoded YUV planes
+    // instead of the converted RGB image
+    static int  InitYUVDisplay(APEG_STREAM *stream, int coded_w, int coded_h, void *ptr);
+    static void CopyYUVFrame(APEG_STREAM *stream, unsigned char **src, void *ptr);
 
     std::unique_ptr<Stream> _dataStream;
     int _usedFlags = 0;
@@ -54,6 +58,10 @@ private:
     std::unique_ptr<Common::Bitmap> _theoraFullFrame;
     // Wrapper over portion of theora frame which we want to use
     std::unique_ptr<Common::Bitmap> _theoraSrcFrame;
+    // Tells that the frames are output in YUV format
+    bool _yuvFrames = false;
+    int _yuvCodedWidth = 0; // Y plane's pitch
+    Common::Bitmap *_yuvTarget = nullptr; // frame being retrieved
 };
 
 } // namespace Engine
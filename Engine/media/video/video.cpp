@@ -141,7 +141,11 @@ void BlockingVideoPlayer::Begin()
         }
 
         const int dst_depth = _player->GetTargetDepth();
-        if (!software_draw || ((_stateFlags & kVideoState_Stretch) == 0))
+        if (_player->HasYUVFrames())
+        {
+            _videoDDB = gfxDriver->CreateYUVFrameDDB(frame_sz.Width, frame_sz.Height);
+        }
+        else if (!software_draw || ((_stateFlags & kVideoState_Stretch) == 0))
         {
             _videoDDB = gfxDriver->CreateDDB(frame_sz.Width, frame_sz.Height, dst_depth, true);
         }
@@ -183,6 +187,9 @@ void BlockingVideoPlayer::Begin()
 void BlockingVideoPlayer::End()
 {
     StopVideo();
+    const auto stats = _player->GetFramePoolStats();
+    Debug::Printf(kDbgMsg_Info, "Video: frame pool of %u buffers, starved %u times, dropped %u frames",
+        stats.PoolSize, stats.Starved, stats.Dropped);
 
     set_game_speed(_oldFps);
 
@@ -248,26 +255,23 @@ bool BlockingVideoPlayer::Run()
         return false;
 #endif
 
-    // update/render next frame
-    std::unique_ptr<Bitmap> frame;
-    {
-        std::lock_guard<std::mutex> lk(_videoMutex);
-        _playbackState = _player->GetPlayState();
-        frame = _player->GetReadyFrame();
-    }
+    // update/render next frame; the frame queue is safe to access
+    // while the video thread is decoding the next frames
+    _playbackState = _player->GetPlayState();
+    std::unique_ptr<Bitmap> frame = _player->GetReadyFrame();
 
     if ((_videoFlags & kVideo_EnableVideo) != 0)
     {
-        if (frame)
+        if (frame && _videoDDB)
         {
-            gfxDriver->UpdateDDBFromBitmap(_videoDDB, frame.get(), false);
+            if (_player->HasYUVFrames())
+                gfxDriver->UpdateYUVFrameDDB(_videoDDB, frame.get());
+            else
+                gfxDriver->UpdateDDBFromBitmap(_videoDDB, frame.get(), false);
             _videoDDB->SetStretch(_dstRect.GetWidth(), _dstRect.GetHeight(), false);
-
-            {
-                std::lock_guard<std::mutex> lk(_videoMutex);
-                _player->ReleaseFrame(std::move(frame));
-            }
         }
+        if (frame)
+            _player->ReleaseFrame(std::move(frame));
     }
 
     Draw();
@@ -407,7 +411,15 @@ HError play_flc_video(int numb, int video_flags, int state_flags, VideoSkipType
 
 HError play_theora_video(const char *name, int video_flags, int state_flags, VideoSkipType skip)
 {
-    return video_single_run(std::make_unique<TheoraPlayer>(), name, video_flags, state_flags, skip);
+    auto video = std::make_unique<TheoraPlayer>();
+    // Hardware renderers may convert the YUV frames to RGB themselves
+    const Size max_yuv_size = gfxDriver->GetMaxYUVFrameSize();
+    if (!max_yuv_size.IsNull())
+    {
+        video->SetMaxYUVFrameSize(max_yuv_size);
+        video_flags |= kVideo_YUVFrames;
+    }
+    return video_single_run(std::move(video), name, video_flags, state_flags, skip);
 }
 
 void video_single_pause()
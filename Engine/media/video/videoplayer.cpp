@@ -14,6 +14,7 @@
 #ifndef AGS_NO_VIDEO_PLAYER
 #include "media/video/videoplayer.h"
 #include "debug/out.h"
+#include "gfx/gfxdefines.h"
 
 namespace AGS
 {
@@ -57,7 +58,11 @@ HError VideoPlayer::Open(std::unique_ptr<Common::Stream> data_stream,
     // Setup video
     if (HasVideo())
     {
-        _targetDepth = target_depth > 0 ? target_depth : _frameDepth;
+        // YUV frames are output as they are, and scaled by the renderer
+        if (HasYUVFrames())
+            _targetDepth = 8;
+        else
+            _targetDepth = target_depth > 0 ? target_depth : _frameDepth;
         SetTargetFrame(target_sz);
     }
 
@@ -69,7 +74,7 @@ HError VideoPlayer::Open(std::unique_ptr<Common::Stream> data_stream,
 
 void VideoPlayer::SetTargetFrame(const Size &target_sz)
 {
-    _targetSize = target_sz.IsNull() ? _frameSize : target_sz;
+    _targetSize = (target_sz.IsNull() || HasYUVFrames()) ? _frameSize : target_sz;
 
     // Create helper bitmaps in case of stretching or color depth conversion
     if ((_targetSize != _frameSize) || (_targetDepth != _frameDepth)
@@ -93,8 +98,17 @@ void VideoPlayer::SetTargetFrame(const Size &target_sz)
         _hicolBuf.reset();
     }
 
-    // TODO: resize the buffered queue?
-
+    // Allocate the frame pool once, so that the playback does not allocate
+    // any frames; the frames in queue are of the previous format, drop them
+    std::lock_guard<std::mutex> lk(_queueMutex);
+    _poolFrameSize = HasYUVFrames() ? YUVFrameLayout(_targetSize).GetBitmapSize() : _targetSize;
+    _poolSize = _videoQueueMax + FramePoolExtra;
+    _videoFrameQueue.clear();
+    _videoFramePool = std::stack<std::unique_ptr<Bitmap>>();
+    for (uint32_t i = 0; i < _poolSize; ++i)
+    {
+        _videoFramePool.emplace(new Bitmap(_poolFrameSize.Width, _poolFrameSize.Height, _targetDepth));
+    }
 }
 
 void VideoPlayer::Stop()
@@ -109,6 +123,7 @@ void VideoPlayer::Stop()
 
     _vframeBuf = nullptr;
     _hicolBuf = nullptr;
+    std::lock_guard<std::mutex> lk(_queueMutex);
     _videoFramePool = std::stack<std::unique_ptr<Bitmap>>();
     _videoFrameQueue = std::deque<std::unique_ptr<Bitmap>>();
 }
@@ -171,13 +186,18 @@ std::unique_ptr<Bitmap> VideoPlayer::NextFrame()
 
     BufferVideo();
 
-    auto frame = NextFrameFromQueue();
+    std::unique_ptr<Bitmap> frame;
+    {
+        std::lock_guard<std::mutex> lk(_queueMutex);
+        frame = NextFrameFromQueue();
+    }
     if (!frame)
     {
         // TODO: rewind should be done on reading from decoder, not when playing!
         // see how AudioPlayer does this
         if (IsLooping() && Rewind())
         {
+            std::lock_guard<std::mutex> lk(_queueMutex);
             frame = NextFrameFromQueue();
         }
         else
@@ -237,14 +257,28 @@ std::unique_ptr<Common::Bitmap> VideoPlayer::GetReadyFrame()
 {
     if (_framesPlayed > _wantFrameIndex)
         return nullptr;
+    std::lock_guard<std::mutex> lk(_queueMutex);
     return NextFrameFromQueue();
 }
 
 void VideoPlayer::ReleaseFrame(std::unique_ptr<Common::Bitmap> frame)
 {
+    std::lock_guard<std::mutex> lk(_queueMutex);
+    // frames of the previous target format are not recycled
+    if (!frame || (frame->GetSize() != _poolFrameSize) || (frame->GetColorDepth() != _targetDepth))
+        return;
     _videoFramePool.push(std::move(frame));
 }
 
+VideoPlayer::FramePoolStats VideoPlayer::GetFramePoolStats() const
+{
+    FramePoolStats stats;
+    stats.PoolSize = _poolSize;
+    stats.Starved = _poolStarved;
+    stats.Dropped = _framesDropped;
+    return stats;
+}
+
 bool VideoPlayer::Poll()
 {
     if (!IsPlaybackReady(_playState))
@@ -319,27 +353,31 @@ void VideoPlayer::ResumeImpl()
 
 void VideoPlayer::BufferVideo()
 {
-    if (_videoFrameQueue.size() >= _videoQueueMax)
-        return;
-
-    // Get one frame from the pool, if present, otherwise allocate a new one
+    // Get one frame from the pool; if there's none, then the user still
+    // holds the frames, and the decoding has to wait
     std::unique_ptr<Bitmap> target_frame;
-    if (_videoFramePool.empty())
-    {
-        target_frame.reset(new Bitmap(_targetSize.Width, _targetSize.Height, _targetDepth));
-    }
-    else
     {
+        std::lock_guard<std::mutex> lk(_queueMutex);
+        if (_videoFrameQueue.size() >= _videoQueueMax)
+            return;
+        if (_videoFramePool.empty())
+        {
+            _poolStarved++;
+            return;
+        }
         target_frame = std::move(_videoFramePool.top());
         _videoFramePool.pop();
     }
 
-    // Try to retrieve one video frame from decoder
-    const bool must_conv = (_targetSize != _frameSize || _targetDepth != _frameDepth
+    // Try to retrieve one video frame from decoder; this is done without
+    // holding the queue lock, as decoding and conversion may take long
+    const bool must_conv = !HasYUVFrames() &&
+        (_targetSize != _frameSize || _targetDepth != _frameDepth
         || ((_flags & kVideo_AccumFrame) != 0));
     Bitmap *usebuf = must_conv ? _vframeBuf.get() : target_frame.get();
     if (!NextVideoFrame(usebuf))
     { // failed to get frame, so move prepared target frame into the pool for now
+        std::lock_guard<std::mutex> lk(_queueMutex);
         _videoFramePool.push(std::move(target_frame));
         return;
     }
@@ -361,6 +399,7 @@ void VideoPlayer::BufferVideo()
     }
 
     // Push final frame to the queue
+    std::lock_guard<std::mutex> lk(_queueMutex);
     _videoFrameQueue.push_back(std::move(target_frame));
 }
 
@@ -382,13 +421,13 @@ void VideoPlayer::UpdateTime()
     }
     _pollTs = AGS_Clock::now();
     _playbackDuration = _pollTs - _startTs;
-    _wantFrameIndex = std::chrono::duration_cast<std::chrono::milliseconds>(_playbackDuration).count()
-        / _targetFrameTime;
+    _wantFrameIndex = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(_playbackDuration).count() / _targetFrameTime);
     /*Debug::Printf("VIDEO TIME: playdur %lld, target frame time %.2f, want frame = %u, played frame = %u",
         std::chrono::duration_cast<std::chrono::milliseconds>(_playbackDuration).count(),
         _targetFrameTime,
         _wantFrameIndex,
-        _framesPlayed);/**/
+        _framesPlayed.load());/**/
 }
 
 std::unique_ptr<Bitmap> VideoPlayer::NextFrameFromQueue()
@@ -403,6 +442,7 @@ std::unique_ptr<Bitmap> VideoPlayer::NextFrameFromQueue()
 
 bool VideoPlayer::ProcessVideo()
 {
+    std::lock_guard<std::mutex> lk(_queueMutex);
     // Optionally drop late frames, but leave at least 1 for display
     if ((_flags & kVideo_DropFrames) != 0)
     {
@@ -412,6 +452,7 @@ bool VideoPlayer::ProcessVideo()
             auto frame = NextFrameFromQueue();
             assert(frame);
             _videoFramePool.push(std::move(frame));
+            _framesDropped++;
             //Debug::Printf("DROPPED LATE FRAME, queue size: %d", _videoFrameQueue.size());
         }
     }
@@ -16,6 +16,10 @@
 // Renders video frames onto bitmap buffer; supports double-buffering,
 // where active bitmap is switched each next time.
 // Renders audio frames using OpenAlSource output.
+// Poll may be run on a separate thread: the frames are decoded without
+// locking the frame queue, so that the ready frames may be retrieved meanwhile.
+// Frames are decoded into a fixed pool of buffers, allocated when the target
+// frame is set; the user must return the retrieved frames using ReleaseFrame.
 //
 // TODO: separate Video Decoder class, would be useful e.g. for plugins.
 // TODO:
@@ -31,8 +35,10 @@
 #ifndef __AGS_EE_MEDIA__VIDEOPLAYER_H
 #define __AGS_EE_MEDIA__VIDEOPLAYER_H
 
+#include <atomic>
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <stack>
 #include "ac/timer.h"
 #include "gfx/bitmap.h"
@@ -57,6 +63,10 @@ enum VideoFlags
     // Must accumulate decoded frames, when format's frames
     // do not have a full image, but diff from the previous frame
     kVideo_AccumFrame     = 0x0020,
+    // Output frames as the 8-bit bitmaps holding the YUV 4:2:0 planes
+    // (see YUVFrameLayout), for the renderer to convert them to RGB;
+    // the decoder resets this flag if it cannot provide these.
+    kVideo_YUVFrames      = 0x0040,
 };
 
 // Parent video player class, provides basic playback logic,
@@ -66,6 +76,14 @@ enum VideoFlags
 class VideoPlayer
 {
 public:
+    // Frame buffer pool statistics
+    struct FramePoolStats
+    {
+        uint32_t PoolSize = 0u; // number of frame buffers
+        uint32_t Starved = 0u;  // times the decoder found no free buffer
+        uint32_t Dropped = 0u;  // late frames dropped
+    };
+
     virtual ~VideoPlayer();
 
     // Tries to init a video playback reading from the given stream
@@ -78,7 +96,11 @@ public:
     virtual bool IsValid() { return false; }
     bool HasVideo() const { return (_flags & kVideo_EnableVideo) != 0; }
     bool HasAudio() const { return (_flags & kVideo_EnableAudio) != 0; }
-    // Assigns a wanted target bitmap size
+    bool HasYUVFrames() const { return (_flags & kVideo_YUVFrames) != 0; }
+    // Sets the max frame size for which the YUV frames may be output;
+    // must be called before Open
+    void SetMaxYUVFrameSize(const Size &max_size) { _maxYUVFrameSize = max_size; }
+    // Assigns a wanted target bitmap size; reallocates the frame pool
     void SetTargetFrame(const Size &target_sz);
     // Begins or resumes playback
     void Play();
@@ -90,7 +112,8 @@ public:
     float Seek(float pos_ms);
     // Seek to the given frame; returns new pos or -1 (UINT32_MAX) on error
     uint32_t SeekFrame(uint32_t frame);
-    // Steps one frame forward, returns a prepared video frame on success
+    // Steps one frame forward, returns a prepared video frame on success;
+    // the frame should be returned using ReleaseFrame when no longer used
     std::unique_ptr<Common::Bitmap> NextFrame();
 
     const String &GetName() const { return _name; }
@@ -119,6 +142,8 @@ public:
     // Tell VideoPlayer that this frame is not used anymore, and may be recycled
     // TODO: redo this part later, by introducing some kind of a RAII lock wrapper.
     void ReleaseFrame(std::unique_ptr<Common::Bitmap> frame);
+    // Gets the frame buffer pool statistics
+    FramePoolStats GetFramePoolStats() const;
 
     // Updates the video playback, renders next frame
     bool Poll();
@@ -152,6 +177,8 @@ protected:
     float _frameTime = 0.f;
     uint32_t _frameCount = 0;
     float _durationMs = 0.f;
+    // Max size of the frame which may be output in YUV format
+    Size _maxYUVFrameSize{};
 
 private:
     // Rewind the stream to start and reset playback pos
@@ -165,7 +192,7 @@ private:
     // Update playback timing
     void UpdateTime();
     // Retrieve first available frame from queue,
-    // advance output frame counter
+    // advance output frame counter; must be called with the queue locked
     std::unique_ptr<Common::Bitmap> NextFrameFromQueue();
     // Process buffered video frame(s);
     // returns if should continue working
@@ -183,13 +210,16 @@ private:
     float _targetFPS = 0.f;
     float _targetFrameTime = 0.f; // frame duration in ms for "target fps"
     uint32_t _videoQueueMax = 5u;
+    // Frame buffers in addition to the queue: the one being decoded,
+    // and the one given to the user
+    static const uint32_t FramePoolExtra = 2u;
     uint32_t _audioQueueMax = 0u; // we don't have a real queue atm
     // Playback state
-    PlaybackState _playState = PlayStateInitial;
+    std::atomic<PlaybackState> _playState{PlayStateInitial};
     // Playback position, depends on how much data did we played
     float _posMs = 0.f;
     // Frames counter, increments with playback, resets on rewind or seek
-    uint32_t _framesPlayed = 0u;
+    std::atomic<uint32_t> _framesPlayed{0u};
     // Stage timestamps, used to calculate the next frame timing;
     // note that these are "virtual time", and are adjusted whenever playback
     // is paused and resumed, or playback speed changes.
@@ -198,7 +228,7 @@ private:
     AGS_Clock::time_point _pollTs; // timestamp of the last Poll in autoplay mode
     AGS_Clock::duration _playbackDuration; // full playback time
     AGS_Clock::time_point _pauseTs; // time when the playback was paused
-    uint32_t _wantFrameIndex = 0u; // expected video frame at this time
+    std::atomic<uint32_t> _wantFrameIndex{0u}; // expected video frame at this time
     // Audio
     // Audio queue (single frame for now, because output buffers too)
     SoundBuffer _audioFrame{};
@@ -210,9 +240,16 @@ private:
     std::unique_ptr<Common::Bitmap> _vframeBuf;
     // Helper buffer for copying 8-bit frames to the final frame
     std::unique_ptr<Common::Bitmap> _hicolBuf;
-    // Buffered frame queue
+    // Buffered frame queue, and the pool of the free frames;
+    // both are guarded by the queue mutex
+    std::mutex _queueMutex;
     std::stack<std::unique_ptr<Common::Bitmap>> _videoFramePool;
     std::deque<std::unique_ptr<Common::Bitmap>> _videoFrameQueue;
+    // Format of the pooled frames
+    Size _poolFrameSize;
+    uint32_t _poolSize = 0u;
+    std::atomic<uint32_t> _poolStarved{0u};
+    std::atomic<uint32_t> _framesDropped{0u};
 };
 
 } // namespace Engine
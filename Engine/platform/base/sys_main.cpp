@@ -244,6 +244,26 @@ void sys_window_show_cursor(bool on) {
     SDL_ShowCursor(on ? SDL_ENABLE : SDL_DISABLE);
 }
 
+// The custom system cursor, if one is set
+static SDL_Cursor *window_cursor = nullptr;
+
+bool sys_window_set_cursor(const uint32_t *argb, int w, int h, int hotx, int hoty) {
+    SDL_Cursor *cursor = nullptr;
+    if (argb) {
+        SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom(const_cast<uint32_t*>(argb),
+            w, h, 32, w * sizeof(uint32_t), SDL_PIXELFORMAT_ARGB8888);
+        if (!surface) return false;
+        cursor = SDL_CreateColorCursor(surface, hotx, hoty);
+        SDL_FreeSurface(surface);
+        if (!cursor) return false;
+    }
+    SDL_SetCursor(cursor ? cursor : SDL_GetDefaultCursor());
+    if (window_cursor)
+        SDL_FreeCursor(window_cursor);
+    window_cursor = cursor;
+    return true;
+}
+
 bool sys_window_lock_mouse(bool on) {
     if (!window) return false;
     SDL_SetWindowGrab(window, static_cast<SDL_bool>(on));
@@ -256,6 +276,7 @@ void sys_window_set_mouse(int x, int y) {
 }
 
 void sys_window_destroy() {
+    sys_window_set_cursor(nullptr, 0, 0, 0, 0);
     if (window) {
         SDL_DestroyWindow(window);
         window = nullptr;
@@ -67,6 +67,10 @@ bool sys_window_set_size(int w, int h, bool center);
 void sys_window_center();
 // Shows or hides system cursor when it's in the game window
 void sys_window_show_cursor(bool on);
+// Sets the image of the system cursor from the 32-bit ARGB pixels, with the
+// given hotspot; null pixels reset the cursor to the default system one.
+// Returns whether the cursor was set successfully.
+bool sys_window_set_cursor(const uint32_t *argb, int w, int h, int hotx, int hoty);
 // Locks on unlocks mouse inside the window.
 // Returns new state of the mouse lock.
 bool sys_window_lock_mouse(bool on);
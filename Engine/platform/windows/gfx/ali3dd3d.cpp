@@ -18,6 +18,7 @@
 
 #include "platform/windows/gfx/ali3dd3d.h"
 #include <algorithm>
+#include <cstring>
 #include <stack>
 #include <SDL.h>
 #include <glm/ext.hpp>
@@ -286,6 +287,8 @@ bool D3DGraphicsDriver::FirstTimeInit()
 
   vertexbuffer->Unlock();
 
+  CreateQuadVertexBuffer();
+
   direct3ddevice->GetGammaRamp(0, &defaultgammaramp);
 
   if (defaultgammaramp.red[255] < 256)
@@ -755,10 +758,14 @@ HRESULT D3DGraphicsDriver::ResetD3DDevice()
         _nativeSurface = nullptr;
     }
     ReleaseRenderTargetData();
+    _quadVertexBuffer = nullptr; // allocated in the default pool
+    _quadVertices.clear();
+    InvalidateFrame();
     HRESULT hr = direct3ddevice->Reset(&d3dpp);
     if (hr != D3D_OK)
         return hr;
     RecreateRenderTargets();
+    CreateQuadVertexBuffer();
     return D3D_OK;
 }
 
@@ -856,6 +863,8 @@ void D3DGraphicsDriver::UnInit()
   _nativeBackbuffer = BackbufferState();
 
   vertexbuffer = nullptr;
+  _quadVertexBuffer = nullptr;
+  _quadVertices.clear();
   pixelShader = nullptr;
   direct3ddevice = nullptr;
 
@@ -1018,73 +1027,107 @@ void D3DGraphicsDriver::Render(IDriverDependantBitmap *target)
         RectWH(0, 0, surf_sz.Width, surf_sz.Height), glmex::ortho_d3d(surf_sz.Width, surf_sz.Height),
         PlaneScaling(), D3DTEXF_POINT);
     RenderToSurface(&backbuffer, true);
+    InvalidateFrame(); // the texture may be displayed in the next frame
 }
 
 void D3DGraphicsDriver::RenderSprite(const D3DDrawListEntry *drawListEntry, const glm::mat4 &matGlobal,
     const SpriteColorTransform &color, const Size &rend_sz)
 {
-    RenderTexture(drawListEntry->ddb, drawListEntry->x, drawListEntry->y, matGlobal, color, rend_sz);
+    // Only the sprites drawn without the pixel shader and alpha test may be
+    // batched, these have per-sprite constants and render states
+    if (_quadVertexBuffer && (drawListEntry->ddb->_tintSaturation == 0) && (drawListEntry->ddb->_alphaTest == 0))
+    {
+        BatchTexture(drawListEntry->ddb, drawListEntry->x, drawListEntry->y, matGlobal, color, rend_sz);
+    }
+    else
+    {
+        FlushQuadBatch();
+        RenderTexture(drawListEntry->ddb, drawListEntry->x, drawListEntry->y, matGlobal, color, rend_sz);
+    }
 }
 
-void D3DGraphicsDriver::RenderTexture(D3DBitmap *bmpToDraw, int draw_x, int draw_y,
-    const glm::mat4 &matGlobal, const SpriteColorTransform &color, const Size &rend_sz)
+glm::mat4 D3DGraphicsDriver::GetTileTransform(const D3DBitmap *bmpToDraw, size_t ti, int draw_x, int draw_y,
+    const glm::mat4 &matGlobal, const Size &rend_sz)
 {
-  HRESULT hr;
+    const float xProportion = bmpToDraw->GetWidthToRender() / (float)bmpToDraw->_width;
+    const float yProportion = bmpToDraw->GetHeightToRender() / (float)bmpToDraw->_height;
+    const auto *txdata = bmpToDraw->_data.get();
+    const float width = txdata->_tiles[ti].width * xProportion;
+    const float height = txdata->_tiles[ti].height * yProportion;
+    float xOffs;
+    float yOffs = txdata->_tiles[ti].y * yProportion;
+    if (bmpToDraw->_flipped)
+      xOffs = (bmpToDraw->_width - (txdata->_tiles[ti].x + txdata->_tiles[ti].width)) * xProportion;
+    else
+      xOffs = txdata->_tiles[ti].x * xProportion;
+    float thisX = draw_x + xOffs;
+    float thisY = draw_y + yOffs;
+    thisX = (-(rend_sz.Width / 2.0f)) + thisX;
+    thisY = (rend_sz.Height / 2.0f) - thisY;
 
-  const int alpha = (color.Alpha * bmpToDraw->_alpha) / 255;
+    //Setup translation and scaling matrices
+    float widthToScale = width;
+    float heightToScale = height;
+    if (bmpToDraw->_flipped)
+    {
+      // The usual transform changes 0..1 into 0..width
+      // So first negate it (which changes 0..w into -w..0)
+      widthToScale = -widthToScale;
+      // and now shift it over to make it 0..w again
+      thisX += width;
+    }
 
-  if (bmpToDraw->_tintSaturation > 0)
-  {
-    // Use custom pixel shader
-    float vector[8];
-    if (_legacyPixelShader)
+    // Self sprite transform (first scale, then rotate and then translate, reversed)
+    glm::mat4 transform = glmex::make_transform2d(
+        thisX - _pixelRenderXOffset, thisY + _pixelRenderYOffset, widthToScale, heightToScale, 0.0f);
+    // Global batch transform
+    return matGlobal * transform;
+}
+
+bool D3DGraphicsDriver::UseLinearFilter(const D3DBitmap *bmpToDraw) const
+{
+    return (_smoothScaling) && bmpToDraw->_useResampler && (bmpToDraw->_stretchToHeight > 0) &&
+        ((bmpToDraw->_stretchToHeight != bmpToDraw->_height) ||
+         (bmpToDraw->_stretchToWidth != bmpToDraw->_width));
+}
+
+void D3DGraphicsDriver::SetTextureFilter(bool linear)
+{
+    if (linear)
     {
-      rgb_to_hsv(bmpToDraw->_red, bmpToDraw->_green, bmpToDraw->_blue, &vector[0], &vector[1], &vector[2]);
-      vector[0] /= 360.0; // In HSV, Hue is 0-360
+      direct3ddevice->SetSamplerState(0, D3DSAMP_MINFILTER, D3DTEXF_LINEAR);
+      direct3ddevice->SetSamplerState(0, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);
     }
     else
     {
-      vector[0] = (float)bmpToDraw->_red / 256.0;
-      vector[1] = (float)bmpToDraw->_green / 256.0;
-      vector[2] = (float)bmpToDraw->_blue / 256.0;
+      direct3ddevice->SetSamplerState(0, D3DSAMP_MINFILTER, _currentBackbuffer->Filter);
+      direct3ddevice->SetSamplerState(0, D3DSAMP_MAGFILTER, _currentBackbuffer->Filter);
     }
+}
 
-    vector[3] = (float)bmpToDraw->_tintSaturation / 256.0;
-    vector[4] = (float)alpha / 256.0;
-
-    if (bmpToDraw->_lightLevel > 0)
-      vector[5] = (float)bmpToDraw->_lightLevel / 256.0;
-    else
-      vector[5] = 1.0f;
-
-    direct3ddevice->SetPixelShaderConstantF(0, &vector[0], 2);
-    direct3ddevice->SetPixelShader(pixelShader.get());
-  }
-  else
-  {
-    // Not using custom pixel shader; set up the default one
-    direct3ddevice->SetPixelShader(NULL);
+void D3DGraphicsDriver::SetDefaultTextureStage(int alpha, int light_level)
+{
     int useTintRed = 255;
     int useTintGreen = 255;
     int useTintBlue = 255;
     int textureColorOp = D3DTOP_MODULATE;
 
-    if ((bmpToDraw->_lightLevel > 0) && (bmpToDraw->_lightLevel < 256))
+    if ((light_level > 0) && (light_level < 256))
     {
       // darkening the sprite... this stupid calculation is for
       // consistency with the allegro software-mode code that does
       // a trans blend with a (8,8,8) sprite
-      useTintRed = (bmpToDraw->_lightLevel * 192) / 256 + 64;
+      useTintRed = (light_level * 192) / 256 + 64;
       useTintGreen = useTintRed;
       useTintBlue = useTintRed;
     }
-    else if (bmpToDraw->_lightLevel > 256)
+    else if (light_level > 256)
     {
       // ideally we would use a multi-stage operation here
       // because we need to do TEXTURE + (TEXTURE x LIGHT)
       // but is it worth having to set the device to 2-stage?
       textureColorOp = D3DTOP_ADD;
-      useTintRed = (bmpToDraw->_lightLevel - 256) / 2;
+      useTintRed = (light_level - 256) / 2;
       useTintGreen = useTintRed;
       useTintBlue = useTintRed;
     }
@@ -1107,6 +1150,173 @@ void D3DGraphicsDriver::RenderTexture(D3DBitmap *bmpToDraw, int draw_x, int draw
       direct3ddevice->SetTextureStageState(0, D3DTSS_ALPHAARG1,  D3DTA_TEXTURE);
       direct3ddevice->SetTextureStageState(0, D3DTSS_ALPHAARG2,  D3DTA_TFACTOR);
     }
+}
+
+void D3DGraphicsDriver::CreateQuadVertexBuffer()
+{
+    // The buffer is optional: if it cannot be created, then
+    // the sprites are drawn one by one, as with the pixel shader
+    _quadBufferPos = 0u;
+    if (direct3ddevice->CreateVertexBuffer(QuadBufferVertices * sizeof(CUSTOMVERTEX),
+            D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY, D3DFVF_CUSTOMVERTEX, D3DPOOL_DEFAULT,
+            _quadVertexBuffer.Acquire(), NULL) != D3D_OK)
+    {
+        _quadVertexBuffer = nullptr;
+        Debug::Printf(kDbgMsg_Warn, "WARNING: failed to create dynamic vertex buffer, sprites will not be batched");
+    }
+}
+
+void D3DGraphicsDriver::BatchTexture(D3DBitmap *bmpToDraw, int draw_x, int draw_y,
+    const glm::mat4 &matGlobal, const SpriteColorTransform &color, const Size &rend_sz)
+{
+    QuadBatchState state;
+    state.Alpha = (color.Alpha * bmpToDraw->_alpha) / 255;
+    state.LightLevel = bmpToDraw->_lightLevel;
+    state.Linear = UseLinearFilter(bmpToDraw);
+    state.RenderHint = bmpToDraw->_renderHint;
+
+    // Each tile is two triangles, same as the triangle strip of 4 vertices
+    static const int StripToTriangles[6] = { 0, 1, 2, 2, 1, 3 };
+    const auto *txdata = bmpToDraw->_data.get();
+    for (size_t ti = 0; ti < txdata->_tiles.size(); ++ti)
+    {
+        const auto &tile = txdata->_tiles[ti];
+        state.Texture = tile.texture.get();
+        if (!_quadVertices.empty() && !(state == _quadBatch))
+            FlushQuadBatch();
+        _quadBatch = state;
+
+        // Vertices are transformed here, as every sprite has its own matrix;
+        // the texture coordinates match the ones of the tile's own vertices
+        const glm::mat4 transform = GetTileTransform(bmpToDraw, ti, draw_x, draw_y, matGlobal, rend_sz);
+        const float tu = (float)tile.width / (float)tile.allocWidth;
+        const float tv = (float)tile.height / (float)tile.allocHeight;
+        for (int vi : StripToTriangles)
+        {
+            CUSTOMVERTEX v = defaultVertices[vi];
+            const glm::vec4 pos = transform * glm::vec4(v.position.x, v.position.y, v.position.z, 1.f);
+            v.position.x = pos.x;
+            v.position.y = pos.y;
+            v.position.z = pos.z;
+            v.tu *= tu;
+            v.tv *= tv;
+            _quadVertices.push_back(v);
+        }
+    }
+    _renderStats.Sprites++;
+}
+
+void D3DGraphicsDriver::FlushQuadBatch()
+{
+    if (_quadVertices.empty())
+        return;
+
+    direct3ddevice->SetPixelShader(NULL);
+    SetDefaultTextureStage(_quadBatch.Alpha, _quadBatch.LightLevel);
+    SetTextureFilter(_quadBatch.Linear);
+    direct3ddevice->SetTexture(0, _quadBatch.Texture);
+    // The vertices are already transformed
+    direct3ddevice->SetTransform(D3DTS_WORLD, (D3DMATRIX*)glm::value_ptr(glmex::identity()));
+
+    // Treat special render modes
+    switch (_quadBatch.RenderHint)
+    {
+    case kTxHint_PremulAlpha:
+        direct3ddevice->SetRenderState(D3DRS_BLENDFACTOR, D3DCOLOR_RGBA(_quadBatch.Alpha, _quadBatch.Alpha, _quadBatch.Alpha, 255));
+        SetBlendOp(D3DBLENDOP_ADD, D3DBLEND_BLENDFACTOR, D3DBLEND_INVSRCALPHA);
+        break;
+    default:
+        break;
+    }
+
+    HRESULT hr = direct3ddevice->SetStreamSource(0, _quadVertexBuffer.get(), 0, sizeof(CUSTOMVERTEX));
+    if (hr != D3D_OK)
+    {
+      throw Ali3DException("IDirect3DDevice9::SetStreamSource failed");
+    }
+
+    // Append the vertices to the buffer without waiting for the previous
+    // draws to complete; when the buffer is full, start from its beginning
+    // with a discarded (newly allocated by the driver) storage
+    for (size_t from = 0; from < _quadVertices.size();)
+    {
+        const size_t count = std::min(_quadVertices.size() - from, static_cast<size_t>(QuadBufferVertices));
+        DWORD lock_flags = D3DLOCK_NOOVERWRITE;
+        if (_quadBufferPos + count > QuadBufferVertices)
+        {
+            _quadBufferPos = 0u;
+            lock_flags = D3DLOCK_DISCARD;
+        }
+        void *vertices = nullptr;
+        if (_quadVertexBuffer->Lock(static_cast<UINT>(_quadBufferPos * sizeof(CUSTOMVERTEX)),
+                static_cast<UINT>(count * sizeof(CUSTOMVERTEX)), &vertices, lock_flags) != D3D_OK)
+        {
+          throw Ali3DException("Failed to lock vertex buffer");
+        }
+        memcpy(vertices, &_quadVertices[from], count * sizeof(CUSTOMVERTEX));
+        _quadVertexBuffer->Unlock();
+
+        hr = direct3ddevice->DrawPrimitive(D3DPT_TRIANGLELIST, static_cast<UINT>(_quadBufferPos), static_cast<UINT>(count / 3));
+        if (hr != D3D_OK)
+        {
+          throw Ali3DException("IDirect3DDevice9::DrawPrimitive failed");
+        }
+        _renderStats.DrawCalls++;
+        _quadBufferPos += count;
+        from += count;
+    }
+
+    // Restore default blending mode
+    SetBlendOp(D3DBLENDOP_ADD, D3DBLEND_SRCALPHA, D3DBLEND_INVSRCALPHA);
+    _quadVertices.clear();
+}
+
+void D3DGraphicsDriver::RenderTexture(D3DBitmap *bmpToDraw, int draw_x, int draw_y,
+    const glm::mat4 &matGlobal, const SpriteColorTransform &color, const Size &rend_sz)
+{
+  HRESULT hr;
+
+  const int alpha = (color.Alpha * bmpToDraw->_alpha) / 255;
+
+  if (bmpToDraw->_tintSaturation > 0)
+  {
+    // Use custom pixel shader
+    float vector[8];
+    if (_legacyPixelShader)
+    {
+      rgb_to_hsv(bmpToDraw->_red, bmpToDraw->_green, bmpToDraw->_blue, &vector[0], &vector[1], &vector[2]);
+      vector[0] /= 360.0; // In HSV, Hue is 0-360
+    }
+    else
+    {
+      vector[0] = (float)bmpToDraw->_red / 256.0;
+      vector[1] = (float)bmpToDraw->_green / 256.0;
+      vector[2] = (float)bmpToDraw->_blue / 256.0;
+    }
+
+    vector[3] = (float)bmpToDraw->_tintSaturation / 256.0;
+    vector[4] = (float)alpha / 256.0;
+
+    if (bmpToDraw->_lightLevel > 0)
+      vector[5] = (float)bmpToDraw->_lightLevel / 256.0;
+    else
+      vector[5] = 1.0f;
+
+    direct3ddevice->SetPixelShaderConstantF(0, &vector[0], 2);
+    direct3ddevice->SetPixelShader(pixelShader.get());
+  }
+  else
+  {
+    // Not using custom pixel shader; set up the default one
+    direct3ddevice->SetPixelShader(NULL);
+    SetDefaultTextureStage(alpha, bmpToDraw->_lightLevel);
+  }
+
+  if (bmpToDraw->_alphaTest > 0)
+  {
+    // Draw only the pixels which pass the test, without blending
+    direct3ddevice->SetRenderState(D3DRS_ALPHAREF, (DWORD)std::min(bmpToDraw->_alphaTest - 1, 255));
+    direct3ddevice->SetRenderState(D3DRS_ALPHABLENDENABLE, FALSE);
   }
 
   const auto *txdata = bmpToDraw->_data.get();
@@ -1123,57 +1333,11 @@ void D3DGraphicsDriver::RenderTexture(D3DBitmap *bmpToDraw, int draw_x, int draw
     throw Ali3DException("IDirect3DDevice9::SetStreamSource failed");
   }
 
-  float width = bmpToDraw->GetWidthToRender();
-  float height = bmpToDraw->GetHeightToRender();
-  float xProportion = width / (float)bmpToDraw->_width;
-  float yProportion = height / (float)bmpToDraw->_height;
+  SetTextureFilter(UseLinearFilter(bmpToDraw));
 
   for (size_t ti = 0; ti < txdata->_tiles.size(); ++ti)
   {
-    width = txdata->_tiles[ti].width * xProportion;
-    height = txdata->_tiles[ti].height * yProportion;
-    float xOffs;
-    float yOffs = txdata->_tiles[ti].y * yProportion;
-    if (bmpToDraw->_flipped)
-      xOffs = (bmpToDraw->_width - (txdata->_tiles[ti].x + txdata->_tiles[ti].width)) * xProportion;
-    else
-      xOffs = txdata->_tiles[ti].x * xProportion;
-    float thisX = draw_x + xOffs;
-    float thisY = draw_y + yOffs;
-    thisX = (-(rend_sz.Width / 2.0f)) + thisX;
-    thisY = (rend_sz.Height / 2.0f) - thisY;
-
-    //Setup translation and scaling matrices
-    float widthToScale = width;
-    float heightToScale = height;
-    if (bmpToDraw->_flipped)
-    {
-      // The usual transform changes 0..1 into 0..width
-      // So first negate it (which changes 0..w into -w..0)
-      widthToScale = -widthToScale;
-      // and now shift it over to make it 0..w again
-      thisX += width;
-    }
-
-    // Self sprite transform (first scale, then rotate and then translate, reversed)
-    glm::mat4 transform = glmex::make_transform2d(
-        thisX - _pixelRenderXOffset, thisY + _pixelRenderYOffset, widthToScale, heightToScale, 0.0f);
-    // Global batch transform
-    transform = matGlobal * transform;
-
-    if ((_smoothScaling) && bmpToDraw->_useResampler && (bmpToDraw->_stretchToHeight > 0) &&
-        ((bmpToDraw->_stretchToHeight != bmpToDraw->_height) ||
-         (bmpToDraw->_stretchToWidth != bmpToDraw->_width)))
-    {
-      direct3ddevice->SetSamplerState(0, D3DSAMP_MINFILTER, D3DTEXF_LINEAR);
-      direct3ddevice->SetSamplerState(0, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);
-    }
-    else
-    {
-      direct3ddevice->SetSamplerState(0, D3DSAMP_MINFILTER, _currentBackbuffer->Filter);
-      direct3ddevice->SetSamplerState(0, D3DSAMP_MAGFILTER, _currentBackbuffer->Filter);
-    }
-
+    const glm::mat4 transform = GetTileTransform(bmpToDraw, ti, draw_x, draw_y, matGlobal, rend_sz);
     direct3ddevice->SetTransform(D3DTS_WORLD, (D3DMATRIX*)glm::value_ptr(transform));
     direct3ddevice->SetTexture(0, txdata->_tiles[ti].texture.get());
 
@@ -1193,14 +1357,35 @@ void D3DGraphicsDriver::RenderTexture(D3DBitmap *bmpToDraw, int draw_x, int draw
     {
       throw Ali3DException("IDirect3DDevice9::DrawPrimitive failed");
     }
+    _renderStats.DrawCalls++;
 
     // Restore default blending mode
     SetBlendOp(D3DBLENDOP_ADD, D3DBLEND_SRCALPHA, D3DBLEND_INVSRCALPHA);
   }
+
+  if (bmpToDraw->_alphaTest > 0)
+  {
+    // Restore default alpha test and blending
+    direct3ddevice->SetRenderState(D3DRS_ALPHAREF, (DWORD)0);
+    direct3ddevice->SetRenderState(D3DRS_ALPHABLENDENABLE, TRUE);
+  }
+  _renderStats.Sprites++;
 }
 
 void D3DGraphicsDriver::RenderAndPresent(bool clearDrawListAfterwards)
 {
+    if (IsSameAsLastFrame(_spriteList, _smoothScaling | (_renderAtScreenRes << 1)))
+    {
+        // Keep the last presented frame on screen
+        if (clearDrawListAfterwards)
+        {
+            BackupDrawLists();
+            ClearDrawLists();
+        }
+        ResetFxPool();
+        EndFrameStats();
+        return;
+    }
     RenderImpl(clearDrawListAfterwards);
     direct3ddevice->Present(NULL, NULL, NULL, NULL);
 }
@@ -1227,6 +1412,7 @@ void D3DGraphicsDriver::RenderImpl(bool clearDrawListAfterwards)
         RenderTexture(_nativeSurface, 0, 0, glmex::identity(), SpriteColorTransform(), _srcRect.GetSize());
         direct3ddevice->EndScene();
     }
+    EndFrameStats();
 }
 
 void D3DGraphicsDriver::RenderToSurface(BackbufferState *state, bool clearDrawListAfterwards)
@@ -1243,6 +1429,17 @@ void D3DGraphicsDriver::RenderToSurface(BackbufferState *state, bool clearDrawLi
         throw Ali3DException("IDirect3DDevice9::BeginScene failed");
     }
 
+    if (_stateSorting)
+    {
+        SortDrawListByState(_spriteList, [](D3DBitmap *ddb)
+        {
+            // Tinted sprites use a custom pixel shader
+            const uint32_t blend = static_cast<uint32_t>(ddb->_renderHint) |
+                ((ddb->_tintSaturation > 0) ? (1u << 4) : 0u) | (static_cast<uint32_t>(ddb->_alpha & 0xFF) << 8) |
+                (static_cast<uint32_t>(ddb->_alphaTest & 0x1FF) << 16);
+            return DrawState(ddb->_data.get(), blend);
+        });
+    }
     RenderSpriteBatches();
 
     direct3ddevice->EndScene();
@@ -1445,6 +1642,7 @@ size_t D3DGraphicsDriver::RenderSpriteBatch(const D3DSpriteBatch &batch, size_t
             // raw-draw plugin support
             // NOTE: device ptr cast will only work on 32-bit systems!
             int sx, sy;
+            FlushQuadBatch(); // plugin may render on its own
             if (auto *ddb = DoSpriteEvtCallback(e.x,
                 static_cast<int32_t>(reinterpret_cast<uintptr_t>(direct3ddevice.get())), sx, sy))
             {
@@ -1457,6 +1655,7 @@ size_t D3DGraphicsDriver::RenderSpriteBatch(const D3DSpriteBatch &batch, size_t
             break;
         }
     }
+    FlushQuadBatch();
     return from;
 }
 
@@ -1645,6 +1844,7 @@ void D3DGraphicsDriver::UpdateTextureRegion(D3DTextureTile *tile, const Bitmap *
     BitmapToVideoMem(bitmap, has_alpha, tile, memPtr, lockedRegion.Pitch, usingLinearFiltering);
 
   texture->UnlockRect(0);
+  _renderStats.UploadBytes += static_cast<uint64_t>(lockedRegion.Pitch) * tile->height;
 }
 
 void D3DGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap *ddb, const Bitmap *bitmap, bool has_alpha)
@@ -1671,6 +1871,7 @@ void D3DGraphicsDriver::UpdateTexture(Texture *txdata, const Bitmap *bitmap, boo
   {
     UpdateTextureRegion(&tile, bitmap, has_alpha, opaque);
   }
+  txdata->Touch();
 
   if (color_depth == 8)
       unselect_palette();
@@ -1763,6 +1964,16 @@ IDriverDependantBitmap* D3DGraphicsDriver::CreateRenderTargetDDB(int width, int
     return ddb;
 }
 
+void D3DGraphicsDriver::SetDDBAlphaTest(IDriverDependantBitmap *ddb, int threshold)
+{
+    ((D3DBitmap*)ddb)->_alphaTest = std::max(0, threshold);
+}
+
+uint64_t D3DGraphicsDriver::GetDDBStateHash(IDriverDependantBitmap *ddb)
+{
+    return HashDDBState((D3DBitmap*)ddb);
+}
+
 std::shared_ptr<Texture> D3DGraphicsDriver::GetTexture(IDriverDependantBitmap *ddb)
 {
     return std::static_pointer_cast<Texture>((reinterpret_cast<D3DBitmap*>(ddb))->_data);
@@ -90,8 +90,8 @@ public:
         _stretchToHeight = height;
         _useResampler = useResampler;
     }
-    int GetWidthToRender() { return _stretchToWidth; }
-    int GetHeightToRender() { return _stretchToHeight; }
+    int GetWidthToRender() const { return _stretchToWidth; }
+    int GetHeightToRender() const { return _stretchToHeight; }
     void SetLightLevel(int lightLevel) override { _lightLevel = lightLevel; }
     void SetTint(int red, int green, int blue, int tintSaturation) override
     {
@@ -132,6 +132,8 @@ public:
     int _tintSaturation;
     int _lightLevel;
     int _alpha;
+    // Min alpha of the pixels to draw opaque, or 0 to draw with blending
+    int _alphaTest;
 
     D3DBitmap(int width, int height, int colDepth, bool opaque)
     {
@@ -147,6 +149,7 @@ public:
         _tintSaturation = 0;
         _lightLevel = 0;
         _alpha = 255;
+        _alphaTest = 0;
         _opaque = opaque;
     }
 
@@ -239,6 +242,9 @@ public:
     IDriverDependantBitmap* CreateRenderTargetDDB(int width, int height, int color_depth, bool opaque) override;
     void UpdateDDBFromBitmap(IDriverDependantBitmap* ddb, const Bitmap *bitmap, bool has_alpha) override;
     void DestroyDDB(IDriverDependantBitmap* ddb) override;
+    bool SupportsAlphaTest() override { return true; }
+    void SetDDBAlphaTest(IDriverDependantBitmap *ddb, int threshold) override;
+    uint64_t GetDDBStateHash(IDriverDependantBitmap *ddb) override;
 
     // Create texture data with the given parameters
     Texture *CreateTexture(int width, int height, int color_depth, bool opaque = false, bool as_render_target = false) override;
@@ -265,6 +271,7 @@ public:
     bool SupportsGammaControl() override;
     void SetGamma(int newGamma) override;
     void UseSmoothScaling(bool enabled) override { _smoothScaling = enabled; }
+    void SetTextureAtlas(bool /*enabled*/) override { }
 
     typedef std::shared_ptr<D3DGfxFilter> PD3DFilter;
 
@@ -295,6 +302,33 @@ private:
     D3DCAPS9 direct3ddevicecaps;
     // Default vertex buffer, for textures that don't have one
     D3DVertexBufferPtr vertexbuffer;
+
+    // Render state shared by all the quads in the batch
+    struct QuadBatchState
+    {
+        IDirect3DTexture9 *Texture = nullptr;
+        bool Linear = false;
+        int Alpha = 0;
+        int LightLevel = 0;
+        TextureHint RenderHint = kTxHint_Normal;
+
+        bool operator ==(const QuadBatchState &other) const
+        {
+            return Texture == other.Texture && Linear == other.Linear &&
+                Alpha == other.Alpha && LightLevel == other.LightLevel &&
+                RenderHint == other.RenderHint;
+        }
+    };
+
+    // Capacity of the dynamic vertex buffer, in vertices (a multiple of 6)
+    static const size_t QuadBufferVertices = 6 * 2048;
+    // Dynamic vertex buffer for the batched quads, refilled as a ring
+    D3DVertexBufferPtr _quadVertexBuffer;
+    // Index of the first free vertex in the dynamic vertex buffer
+    size_t _quadBufferPos = 0u;
+    QuadBatchState _quadBatch;
+    // Pretransformed vertices of the batched quads, as triangle lists
+    std::vector<CUSTOMVERTEX> _quadVertices;
     // Texture for rendering in native resolution
     D3DBitmap *_nativeSurface = nullptr;
     CUSTOMVERTEX defaultVertices[4];
@@ -408,6 +442,23 @@ private:
     // Renders given texture onto the current render target
     void RenderTexture(D3DBitmap *bitmap, int draw_x, int draw_y, const glm::mat4 &matGlobal,
         const SpriteColorTransform &color, const Size &rend_sz);
+    // Creates the dynamic vertex buffer for the batched quads
+    void CreateQuadVertexBuffer();
+    // Adds given texture to the quad batch, flushing the batch first
+    // if the texture or the render state differ from the batched ones
+    void BatchTexture(D3DBitmap *bitmap, int draw_x, int draw_y, const glm::mat4 &matGlobal,
+        const SpriteColorTransform &color, const Size &rend_sz);
+    // Draws all the batched quads with as few calls as possible, and clears the batch
+    void FlushQuadBatch();
+    // Calculates the full transform of the texture's tile
+    glm::mat4 GetTileTransform(const D3DBitmap *bitmap, size_t tile_index, int draw_x, int draw_y,
+        const glm::mat4 &matGlobal, const Size &rend_sz);
+    // Tells whether the texture should be drawn with the linear filtering
+    bool UseLinearFilter(const D3DBitmap *bitmap) const;
+    // Sets the filtering of the texture sampler
+    void SetTextureFilter(bool linear);
+    // Sets up the fixed function texture stage, used when drawing without the pixel shader
+    void SetDefaultTextureStage(int alpha, int light_level);
     // Helper method for setting blending parameters
     void SetBlendOp(D3DBLENDOP blend_op, D3DBLEND src_factor, D3DBLEND dst_factor);
     // Helper method for setting exclusive alpha blending parameters
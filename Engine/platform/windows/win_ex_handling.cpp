@@ -103,8 +103,11 @@ int malloc_fail_handler(size_t amountwanted)
     const size_t max_normspr = spriteset.GetMaxCacheSize();
     const unsigned norm_spr_filled = max_normspr > 0 ?  ((uint64_t)total_normspr * 100 / max_normspr) : 0;
 
-    cur += snprintf(cur, end-cur, "Sprite cache KB: %zu / %zu (%u%%), locked: %zu, ext: %zu\n\n",
-                    total_normspr/KB, max_normspr/KB, norm_spr_filled, total_lockspr/KB, total_extspr/KB);
+    const uint64_t spr_requests = spriteset.GetHitCount() + spriteset.GetMissCount();
+    const unsigned spr_hits = spr_requests > 0 ? (unsigned)(spriteset.GetHitCount() * 100 / spr_requests) : 0;
+
+    cur += snprintf(cur, end-cur, "Sprite cache KB: %zu / %zu (%u%%), locked: %zu, ext: %zu, hits: %u%%\n\n",
+                    total_normspr/KB, max_normspr/KB, norm_spr_filled, total_lockspr/KB, total_extspr/KB, spr_hits);
 
 
     PROCESS_MEMORY_COUNTERS pmc;
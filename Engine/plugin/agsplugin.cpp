@@ -11,6 +11,7 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
 #include <vector>
 #include "core/platform.h"
 #include <allegro.h>
@@ -19,6 +20,7 @@
 #endif
 
 #include "ac/common.h" // quit
+#include "ac/display.h"
 #include "ac/draw.h"
 #include "ac/dynamicsprite.h"
 #include "ac/file.h"
@@ -31,11 +33,14 @@
 #include "ac/mouse.h"
 #include "ac/parser.h"
 #include "ac/path_helper.h"
+#include "ac/room.h"
 #include "ac/roomstatus.h"
 #include "ac/spritecache.h"
 #include "ac/string.h"
 #include "ac/sys_events.h"
+#include "ac/timer.h"
 #include "ac/view.h"
+#include "ac/walkablearea.h"
 #include "ac/dynobj/dynobj_manager.h"
 #include "ac/dynobj/scriptstring.h"
 #include "ac/dynobj/scriptsystem.h"
@@ -98,7 +103,7 @@ extern RuntimeScriptValue GlobalReturnValue;
 // **************** PLUGIN IMPLEMENTATION ****************
 
 
-const int PLUGIN_API_VERSION = 28;
+const int PLUGIN_API_VERSION = 29;
 struct EnginePlugin
 {
     EnginePlugin() {
@@ -121,11 +126,56 @@ struct EnginePlugin
     int       (*debugHook) (const char * whichscript, int lineNumber, int reserved) = nullptr;
     IAGSEngine  eiface; // CHECKME: why do we have a separate object per plugin?
     bool        builtin = false;
+    // Event callback statistics, printed when the plugins are stopped
+    uint32_t    eventCalls = 0u;
+    uint64_t    eventTime = 0u; // in nanoseconds
 };
 
 std::vector<EnginePlugin> plugins;
 int pluginsWantingDebugHooks = 0;
 
+// Number of the plugin events, each defined as a single bit flag below AGSE_TOOHIGH
+static const int PluginEventCount = 20;
+// Indexes of the plugins which requested each event, sorted in the plugin order
+static std::vector<int> eventSubscribers[PluginEventCount];
+static_assert(AGSE_TOOHIGH == (1 << PluginEventCount), "PluginEventCount does not match the event list");
+
+// Returns the index of the event's subscriber list,
+// or -1 if this is not a single event flag
+static int GetEventIndex(int event)
+{
+    if ((event <= 0) || (event >= AGSE_TOOHIGH) || ((event & (event - 1)) != 0))
+        return -1;
+    int index = 0;
+    for (; (event >> index) != 1; ++index);
+    return index;
+}
+
+static void UpdateEventSubscribers(int plugin_id, int events, bool subscribe)
+{
+    for (int i = 0; i < PluginEventCount; ++i)
+    {
+        if ((events & (1 << i)) == 0)
+            continue;
+        auto &subs = eventSubscribers[i];
+        const auto it = std::lower_bound(subs.begin(), subs.end(), plugin_id);
+        const bool found = (it != subs.end()) && (*it == plugin_id);
+        if (subscribe && !found)
+            subs.insert(it, plugin_id);
+        else if (!subscribe && found)
+            subs.erase(it);
+    }
+}
+
+static int RunPluginEvent(EnginePlugin &plugin, int event, int data)
+{
+    const auto start = AGS_Clock::now();
+    const int retval = plugin.onEvent(event, data);
+    plugin.eventCalls++;
+    plugin.eventTime += std::chrono::duration_cast<std::chrono::nanoseconds>(AGS_Clock::now() - start).count();
+    return retval;
+}
+
 //
 // Managed object unserializers
 //
@@ -185,6 +235,7 @@ void IAGSEngine::RequestEventHook (int32 event) {
 
 
     plugins[this->pluginId].wantHook |= event;
+    UpdateEventSubscribers(this->pluginId, event, true);
 }
 
 void IAGSEngine::UnrequestEventHook(int32 event) {
@@ -199,6 +250,7 @@ void IAGSEngine::UnrequestEventHook(int32 event) {
     }
 
     plugins[this->pluginId].wantHook &= ~event;
+    UpdateEventSubscribers(this->pluginId, event, false);
 }
 
 int IAGSEngine::GetSavedData (char *buffer, int32 bufsize) {
@@ -267,6 +319,7 @@ int IAGSEngine::GetCurrentBackground () {
     return play.bg_frame;
 }
 BITMAP *IAGSEngine::GetBackgroundScene (int32 index) {
+    ensure_room_bg_frame(index);
     return (BITMAP*)thisroom.BgFrames[index].Graphic->GetAllegroBitmap();
 }
 void IAGSEngine::GetBitmapDimensions (BITMAP *bmp, int32 *width, int32 *height, int32 *coldepth) {
@@ -355,6 +408,31 @@ void IAGSEngine::BlitSpriteTranslucent(int32 x, int32 y, BITMAP *bmp, int32 tran
         GfxUtil::DrawSpriteBlend(ds, Point(x,y), &wrap, kBlendMode_Alpha, true, false, trans);
 }
 
+void IAGSEngine::BlitBitmaps(const AGSBitmapBlit *blits, int32 count)
+{
+    Bitmap *ds = gfxDriver->GetStageBackBuffer(true);
+    if (!ds || !blits)
+        return;
+    const bool mem_backbuffer = gfxDriver->UsesMemoryBackBuffer();
+    for (int32 i = 0; i < count; ++i)
+    {
+        const AGSBitmapBlit &blit = blits[i];
+        if (!blit.Image)
+            continue;
+        if (blit.Transparency == 0)
+        {
+            wputblock_raw(ds, blit.X, blit.Y, blit.Image, blit.Masked);
+            invalidate_rect(blit.X, blit.Y, blit.X + blit.Image->w, blit.Y + blit.Image->h, false);
+            continue;
+        }
+        Bitmap wrap(blit.Image, true);
+        if (mem_backbuffer)
+            GfxUtil::DrawSpriteWithTransparency(ds, &wrap, blit.X, blit.Y, blit.Transparency);
+        else
+            GfxUtil::DrawSpriteBlend(ds, Point(blit.X, blit.Y), &wrap, kBlendMode_Alpha, true, false, blit.Transparency);
+    }
+}
+
 void IAGSEngine::BlitSpriteRotated(int32 x, int32 y, BITMAP *bmp, int32 angle)
 {
     Bitmap *ds = gfxDriver->GetStageBackBuffer(true);
@@ -449,7 +527,11 @@ BITMAP *IAGSEngine::GetSpriteGraphic (int32 num) {
 }
 BITMAP *IAGSEngine::GetRoomMask (int32 index) {
     if (index == MASK_WALKABLE)
+    {
+        // the plugin may draw on the mask
+        invalidate_walkable_areas_temp();
         return (BITMAP*)thisroom.WalkAreaMask->GetAllegroBitmap();
+    }
     else if (index == MASK_WALKBEHIND)
         return (BITMAP*)thisroom.WalkBehindMask->GetAllegroBitmap();
     else if (index == MASK_HOTSPOT)
@@ -650,6 +732,20 @@ int IAGSEngine::CallGameScriptFunction(const char *name, int32 globalScript, int
 
 void IAGSEngine::NotifySpriteUpdated(int32 slot) {
     game_sprite_updated(slot);
+    // plugins may update sprites in the middle of render, so apply at once
+    sync_shared_texture(slot);
+}
+
+void IAGSEngine::NotifySpriteAreaUpdated(int32 slot, int32 left, int32 top, int32 right, int32 bottom) {
+    if ((slot < 0) || (static_cast<uint32_t>(slot) >= game.SpriteInfos.size()))
+        return;
+    const auto &info = game.SpriteInfos[slot];
+    const Rect area = IntersectRects(Rect(left, top, right, bottom), RectWH(0, 0, info.Width, info.Height));
+    if (!area.IsEmpty())
+    {
+        game_sprite_updated(slot, area);
+        sync_shared_texture(slot);
+    }
 }
 
 void IAGSEngine::SetSpriteAlphaBlended(int32 slot, int32 isAlphaBlended) {
@@ -769,6 +865,7 @@ IAGSFontRenderer* IAGSEngine::ReplaceFontRenderer(int fontNumber, IAGSFontRender
 {
     auto *old_render = font_replace_renderer(fontNumber, newRenderer);
     GUIE::MarkForFontUpdate(fontNumber);
+    invalidate_textual_image_cache();
     return old_render;
 }
 
@@ -794,6 +891,7 @@ IAGSFontRenderer* IAGSEngine::ReplaceFontRenderer2(int fontNumber, IAGSFontRende
 {
     auto *old_render = font_replace_renderer(fontNumber, newRenderer);
     GUIE::MarkForFontUpdate(fontNumber);
+    invalidate_textual_image_cache();
     return old_render;
 }
 
@@ -801,6 +899,7 @@ void IAGSEngine::NotifyFontUpdated(int fontNumber)
 {
     font_recalc_metrics(fontNumber);
     GUIE::MarkForFontUpdate(fontNumber);
+    invalidate_textual_image_cache();
 }
 
 size_t IAGSEngine::ResolveFilePath(const char *script_path, char *buf, size_t buf_len)
@@ -835,6 +934,11 @@ void pl_stop_plugins() {
     ccSetDebugHook(nullptr);
 
     for (auto &plugin : plugins) {
+        if (plugin.eventCalls > 0) {
+            Debug::Printf(kDbgMsg_Info, "Plugin '%s': %u event callbacks, total %.2f ms, average %.2f us",
+                plugin.filename.GetCStr(), plugin.eventCalls, plugin.eventTime / 1000000.0,
+                plugin.eventTime / 1000.0 / plugin.eventCalls);
+        }
         if (plugin.available) {
             if (plugin.engineShutdown != nullptr)
                 plugin.engineShutdown();
@@ -843,6 +947,8 @@ void pl_stop_plugins() {
         }
     }
     plugins.clear();
+    for (auto &subs : eventSubscribers)
+        subs.clear();
 }
 
 void pl_startup_plugins() {
@@ -854,11 +960,28 @@ void pl_startup_plugins() {
 
 int pl_run_plugin_hooks(int event, int data)
 {
+    const int ev_index = GetEventIndex(event);
+    if (ev_index >= 0)
+    {
+        const auto &subs = eventSubscribers[ev_index];
+        for (size_t i = 0; i < subs.size();)
+        {
+            const int plugin_id = subs[i];
+            int retval = RunPluginEvent(plugins[plugin_id], event, data);
+            // the event is claimed by this plugin (see the FIXME below)
+            if (retval)
+                return retval;
+            // the callback may have changed the subscribers, so look for the next plugin
+            i = std::lower_bound(subs.begin(), subs.end(), plugin_id + 1) - subs.begin();
+        }
+        return 0;
+    }
+
     for (auto &plugin : plugins)
     {
         if (plugin.wantHook & event)
         {
-            int retval = plugin.onEvent(event, data);
+            int retval = RunPluginEvent(plugin, event, data);
             // FIXME: this is an inconvenient design: breaking out
             // should be done only for events that are claimable,
             // such as key press, but not any random event!
@@ -902,7 +1025,7 @@ int pl_run_plugin_hook_by_index(int pl_index, int event, int data)
     auto &plugin = plugins[pl_index];
     if (plugin.wantHook & event)
     {
-        return plugin.onEvent(event, data);
+        return RunPluginEvent(plugin, event, data);
     }
     return 0;
 }
@@ -913,7 +1036,7 @@ int pl_run_plugin_hook_by_name(Common::String &pl_name, int event, int data)
     {
         if ((plugin.wantHook & event) && plugin.filename.CompareNoCase(pl_name) == 0)
         {
-            return plugin.onEvent(event, data);
+            return RunPluginEvent(plugin, event, data);
         }
     }
     return 0;
@@ -1142,6 +1265,10 @@ bool pl_is_plugin_loaded(const char *pl_name)
 
 bool pl_any_want_hook(int event)
 {
+    const int ev_index = GetEventIndex(event);
+    if (ev_index >= 0)
+        return !eventSubscribers[ev_index].empty();
+
     for (auto &plugin : plugins)
     {
         if(plugin.wantHook & event)
@@ -294,6 +294,17 @@ struct AGSGameInfo {
   int UniqueId;
 };
 
+// Description of a single bitmap draw, for IAGSEngine::BlitBitmaps
+struct AGSBitmapBlit {
+  BITMAP *Image;
+  int32 X;
+  int32 Y;
+  // draw with transparency (see BlitSpriteTranslucent), 0 means opaque
+  int32 Transparency;
+  // skip the transparent pixels (see BlitBitmap); only used if Transparency is 0
+  int32 Masked;
+};
+
 // File open modes
 // Opens existing file, fails otherwise
 #define AGSSTREAM_FILE_OPEN         1
@@ -652,6 +663,14 @@ public:
   // this stream should not be closed or disposed, doing so will lead to errors in the engine.
   // Returns null if handle is invalid.
   AGSIFUNC(IAGSStream*) GetFileStreamByHandle(int32 fhandle);
+
+  // *** BELOW ARE INTERFACE VERSION 29 AND ABOVE ONLY
+  // force any sprites on-screen using the slot to be updated, same as NotifySpriteUpdated,
+  // but tells that only the given area of the sprite was changed (coordinates are inclusive);
+  // this lets the engine update the sprite's texture partially
+  AGSIFUNC(void)   NotifySpriteAreaUpdated(int32 slot, int32 left, int32 top, int32 right, int32 bottom);
+  // draw a number of bitmaps to the active screen in one call
+  AGSIFUNC(void)   BlitBitmaps(const AGSBitmapBlit *blits, int32 count);
 };
 
 
@@ -11,6 +11,7 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
 #include <cstdio>
 #include <deque>
 #include <string.h>
@@ -20,11 +21,15 @@
 #include "ac/dynobj/dynobj_manager.h"
 #include "ac/sys_events.h"
 #include "gui/guidefines.h"
+#include "main/benchmark.h"
 #include "script/cc_instance.h"
 #include "debug/debug_log.h"
+#include "debug/eventtrace.h"
 #include "debug/out.h"
 #include "script/cc_common.h"
+#include "script/cc_jit.h"
 #include "script/script.h"
+#include "script/script_profiler.h"
 #include "script/script_runtime.h"
 #include "script/systemimports.h"
 #include "util/bbop.h"
@@ -38,6 +43,7 @@
 
 using namespace AGS::Common;
 using namespace AGS::Common::Memory;
+using namespace AGS::Engine;
 
 
 enum ScriptOpArgIsReg
@@ -165,6 +171,19 @@ std::deque<ccInstance*> InstThreads;
 // Of 2012-12-20: now used only for plugin exports
 RuntimeScriptValue GlobalReturnValue;
 
+// Previously resolved import of the script
+struct ResolvedImport
+{
+    String   ImportName;    // name of import, as written in script
+    String   SymbolName;    // name of the matching registered symbol
+    uint32_t Index = UINT32_MAX; // index of the symbol in the system imports
+};
+// Cache of the resolved imports, per script, identified by its first section name.
+// Scripts, such as room scripts, may be loaded multiple times during the game,
+// and their imports resolve to the same symbols each time, which we may
+// check quickly by comparing the names instead of looking them up again.
+static std::unordered_map<String, std::vector<ResolvedImport>> ResolvedImportsCache;
+
 
 String cc_get_callstack(int max_lines)
 {
@@ -271,6 +290,7 @@ ccInstance::ccInstance()
     numimports = 0;
     resolved_imports = nullptr;
     code_fixups         = nullptr;
+    code_ops            = nullptr;
 
     memset(callStackLineNumber, 0, sizeof(callStackLineNumber));
     memset(callStackAddr, 0, sizeof(callStackAddr));
@@ -377,6 +397,27 @@ void ccInstance::AbortAndDestroy()
 
 
 int ccInstance::CallScriptFunction(const char *funcname, int32_t numargs, const RuntimeScriptValue *params)
+{
+    const ScriptFunctionRef func = GetScriptFunction(funcname);
+    if (!func.IsValid())
+    {
+        cc_clear_error();
+        currentline = 0;
+        cc_error("function '%s' not found", funcname);
+        return -2;
+    }
+    return CallScriptFunction(func, numargs, params);
+}
+
+ScriptFunctionRef ccInstance::GetScriptFunction(const char *funcname) const
+{
+    const ScriptExportEntry *exp = FindExport(funcname);
+    if (!exp)
+        return ScriptFunctionRef(instanceof.get(), -1, -1);
+    return ScriptFunctionRef(instanceof.get(), exp->Index, exp->ArgCount);
+}
+
+int ccInstance::CallScriptFunction(const ScriptFunctionRef &func, int32_t numargs, const RuntimeScriptValue *params)
 {
     cc_clear_error();
     currentline = 0;
@@ -397,46 +438,30 @@ int ccInstance::CallScriptFunction(const char *funcname, int32_t numargs, const
         return -4;
     }
 
+    if (!func.IsValid() || (func.Script != instanceof.get()) ||
+        (func.ExportIndex >= instanceof->numexports)) {
+        cc_error("function not found");
+        return -2;
+    }
+
     // NOTE: passing more parameters than expected by the function is fine:
     // the function args are pushed to the stack in REVERSE order, first
     // parameters are always the last, so function code knows how to find them
     // using negative offsets, and does not care about any preceding entries.
-    int32_t startat = -1;
-    char mangledName[200];
-    const size_t mangled_len = snprintf(mangledName, sizeof(mangledName), "%s$", funcname);
-    int export_args = numargs;
-
-    for (int k = 0; k < instanceof->numexports; k++) {
-        const char *thisExportName = instanceof->exports[k];
-        bool match = false;
-
-        // check for a mangled name match
-        if (strncmp(thisExportName, mangledName, mangled_len) == 0) {
-            // found, compare the number of parameters
-            export_args = atoi(thisExportName + mangled_len);
-            if (export_args > numargs) {
-                cc_error("Not enough parameters to exported function '%s' (expected %d, supplied %d)",
-                    funcname, export_args, numargs);
-                return -1;
-            }
-            match = true;
-        }
-        // check for an exact match (if the script was compiled with an older version)
-        if (match || (strcmp(thisExportName, funcname) == 0)) {
-            const int32_t etype = (instanceof->export_addr[k] >> 24L) & 0x000ff;
-            if (etype != EXPORT_FUNCTION) {
-                cc_error("symbol is not a function");
-                return -1;
-            }
-            startat = (instanceof->export_addr[k] & 0x00ffffff);
-            break;
-        }
+    // If the name was not mangled (the script was compiled with an older version),
+    // then the number of args is unknown, and we pass all of them.
+    const int export_args = func.ArgCount >= 0 ? func.ArgCount : numargs;
+    if (export_args > numargs) {
+        cc_error("Not enough parameters to exported function '%s' (expected %d, supplied %d)",
+            instanceof->exports[func.ExportIndex], export_args, numargs);
+        return -1;
     }
-
-    if (startat < 0) {
-        cc_error("function '%s' not found", funcname);
-        return -2;
+    const int32_t etype = (instanceof->export_addr[func.ExportIndex] >> 24L) & 0x000ff;
+    if (etype != EXPORT_FUNCTION) {
+        cc_error("symbol is not a function");
+        return -1;
     }
+    const int32_t startat = (instanceof->export_addr[func.ExportIndex] & 0x00ffffff);
 
     // Prepare instance for run
     flags &= ~INSTF_ABORTED;
@@ -455,9 +480,15 @@ int ccInstance::CallScriptFunction(const char *funcname, int32_t numargs, const
     // Push placeholder for the return value (it will be popped before ret)
     PushValueToStack(RuntimeScriptValue().SetInt32(0));
 
+    AGS_TRACE_ZONE_DETAIL("Script", instanceof->exports[func.ExportIndex]);
+    BenchmarkStageScope bench_scope(kBenchStage_Script);
     InstThreads.push_back(this); // push instance thread
     runningInst = this;
+    if (ScriptProfiler::IsEnabled())
+        ScriptProfiler::OnThreadEnter();
     const int reterr = Run(startat);
+    if (ScriptProfiler::IsEnabled())
+        ScriptProfiler::OnThreadLeave();
     // Cleanup before returning, even if error
     ASSERT_STACK_SIZE(numargs);
     PopValuesFromStack(numargs);
@@ -579,6 +610,77 @@ inline bool FixupArgument(RuntimeScriptValue &arg, const int fixup, const uintpt
 }
 
 
+// Calls the real API function, unpacking its arguments, and saves the return
+// value in AX register; returns false if the function cannot be called this way
+inline bool ccInstance::CallFastApiFunction(const RuntimeScriptValue &fn, bool needs_object,
+    const RuntimeScriptValue *params, int32_t param_count)
+{
+    if (needs_object)
+    {
+        if (fn.Type != kScValObjectFunction)
+            return false;
+        RuntimeScriptValue obj_rval = registers[SREG_OP];
+        obj_rval.DirectPtrObj();
+        void *self = obj_rval.Ptr;
+        switch (fn.IValue)
+        {
+        case kScFastCall_ObjInt:
+            registers[SREG_AX].SetInt32(reinterpret_cast<int(*)(void*)>(fn.FastFn)(self));
+            return true;
+        case kScFastCall_ObjBool:
+            registers[SREG_AX].SetInt32AsBool(reinterpret_cast<bool(*)(void*)>(fn.FastFn)(self));
+            return true;
+        case kScFastCall_ObjVoid_PInt:
+            if (param_count < 1)
+                return false;
+            reinterpret_cast<void(*)(void*, int)>(fn.FastFn)(self, params[0].IValue);
+            registers[SREG_AX] = RuntimeScriptValue((int32_t)0);
+            return true;
+        case kScFastCall_ObjVoid_PBool:
+            if (param_count < 1)
+                return false;
+            reinterpret_cast<void(*)(void*, bool)>(fn.FastFn)(self, params[0].GetAsBool());
+            registers[SREG_AX] = RuntimeScriptValue((int32_t)0);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    if (fn.Type != kScValStaticFunction)
+        return false;
+    switch (fn.IValue)
+    {
+    case kScFastCall_Int:
+        registers[SREG_AX].SetInt32(reinterpret_cast<int(*)()>(fn.FastFn)());
+        return true;
+    case kScFastCall_Int_PInt:
+        if (param_count < 1)
+            return false;
+        registers[SREG_AX].SetInt32(reinterpret_cast<int(*)(int)>(fn.FastFn)(params[0].IValue));
+        return true;
+    case kScFastCall_Void_PInt:
+        if (param_count < 1)
+            return false;
+        reinterpret_cast<void(*)(int)>(fn.FastFn)(params[0].IValue);
+        registers[SREG_AX] = RuntimeScriptValue((int32_t)0);
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Instruction handler labels: with the computed goto each handler
+// also gets a label, which address is stored in the dispatch table.
+#if (CC_COMPUTED_GOTO)
+#define CC_OPCASE(OP) case OP: op_##OP
+#define CC_OPDEFAULT default: op_default
+#define CC_OPADDR(OP) &&op_##OP
+#else
+#define CC_OPCASE(OP) case OP
+#define CC_OPDEFAULT default
+#endif
+
 #define MAXNEST 50  // number of recursive function calls allowed
 int ccInstance::Run(int32_t curpc)
 {
@@ -610,6 +712,58 @@ int ccInstance::Run(int32_t curpc)
 
     const auto timeout = std::chrono::milliseconds(_timeoutCheckMs);
     _lastAliveTs = AGS_FastClock::now();
+    const bool profiling = ScriptProfiler::IsEnabled();
+    if (profiling)
+        ScriptProfiler::OnFunctionCall(this);
+
+    // Pre-decoded instructions, if available
+    const ScriptDecodedOp *decoded_ops = codeInst->code_ops;
+    // Compiled functions are not used while profiling or debugging,
+    // because the native code does not report the lines and instructions
+    const bool use_jit = ScriptJit::IsEnabled() && !profiling && !new_line_hook
+#if DEBUG_CC_EXEC
+        && !dump_opcodes
+#endif
+        ;
+    if (use_jit && (RunNative(codeInst, loopIterationCheckDisabled, loopIterations, loopCheckIterations) != 0))
+        return -1;
+#if (CC_COMPUTED_GOTO)
+    // Instruction handlers, indexed by the instruction code
+    static const void *const op_handlers[CC_NUM_EXEC_SCCMDS] =
+    {
+        &&op_default,
+        CC_OPADDR(SCMD_ADD),            CC_OPADDR(SCMD_SUB),            CC_OPADDR(SCMD_REGTOREG),
+        CC_OPADDR(SCMD_WRITELIT),       CC_OPADDR(SCMD_RET),            CC_OPADDR(SCMD_LITTOREG),
+        CC_OPADDR(SCMD_MEMREAD),        CC_OPADDR(SCMD_MEMWRITE),       CC_OPADDR(SCMD_MULREG),
+        CC_OPADDR(SCMD_DIVREG),         CC_OPADDR(SCMD_ADDREG),         CC_OPADDR(SCMD_SUBREG),
+        CC_OPADDR(SCMD_BITAND),         CC_OPADDR(SCMD_BITOR),          CC_OPADDR(SCMD_ISEQUAL),
+        CC_OPADDR(SCMD_NOTEQUAL),       CC_OPADDR(SCMD_GREATER),        CC_OPADDR(SCMD_LESSTHAN),
+        CC_OPADDR(SCMD_GTE),            CC_OPADDR(SCMD_LTE),            CC_OPADDR(SCMD_AND),
+        CC_OPADDR(SCMD_OR),             CC_OPADDR(SCMD_CALL),           CC_OPADDR(SCMD_MEMREADB),
+        CC_OPADDR(SCMD_MEMREADW),       CC_OPADDR(SCMD_MEMWRITEB),      CC_OPADDR(SCMD_MEMWRITEW),
+        CC_OPADDR(SCMD_JZ),             CC_OPADDR(SCMD_PUSHREG),        CC_OPADDR(SCMD_POPREG),
+        CC_OPADDR(SCMD_JMP),            CC_OPADDR(SCMD_MUL),            CC_OPADDR(SCMD_CALLEXT),
+        CC_OPADDR(SCMD_PUSHREAL),       CC_OPADDR(SCMD_SUBREALSTACK),   CC_OPADDR(SCMD_LINENUM),
+        CC_OPADDR(SCMD_CALLAS),         CC_OPADDR(SCMD_THISBASE),       CC_OPADDR(SCMD_NUMFUNCARGS),
+        CC_OPADDR(SCMD_MODREG),         CC_OPADDR(SCMD_XORREG),         CC_OPADDR(SCMD_NOTREG),
+        CC_OPADDR(SCMD_SHIFTLEFT),      CC_OPADDR(SCMD_SHIFTRIGHT),     CC_OPADDR(SCMD_CALLOBJ),
+        CC_OPADDR(SCMD_CHECKBOUNDS),    CC_OPADDR(SCMD_MEMWRITEPTR),    CC_OPADDR(SCMD_MEMREADPTR),
+        CC_OPADDR(SCMD_MEMZEROPTR),     CC_OPADDR(SCMD_MEMINITPTR),     CC_OPADDR(SCMD_LOADSPOFFS),
+        CC_OPADDR(SCMD_CHECKNULL),      CC_OPADDR(SCMD_FADD),           CC_OPADDR(SCMD_FSUB),
+        CC_OPADDR(SCMD_FMULREG),        CC_OPADDR(SCMD_FDIVREG),        CC_OPADDR(SCMD_FADDREG),
+        CC_OPADDR(SCMD_FSUBREG),        CC_OPADDR(SCMD_FGREATER),       CC_OPADDR(SCMD_FLESSTHAN),
+        CC_OPADDR(SCMD_FGTE),           CC_OPADDR(SCMD_FLTE),           CC_OPADDR(SCMD_ZEROMEMORY),
+        CC_OPADDR(SCMD_CREATESTRING),   CC_OPADDR(SCMD_STRINGSEQUAL),   CC_OPADDR(SCMD_STRINGSNOTEQ),
+        CC_OPADDR(SCMD_CHECKNULLREG),   CC_OPADDR(SCMD_LOOPCHECKOFF),   CC_OPADDR(SCMD_MEMZEROPTRND),
+        CC_OPADDR(SCMD_JNZ),            CC_OPADDR(SCMD_DYNAMICBOUNDS),  CC_OPADDR(SCMD_NEWARRAY),
+        CC_OPADDR(SCMD_NEWUSEROBJECT),
+        // fused instructions
+        CC_OPADDR(SCMD_F_LITTOREG_PUSHREG), CC_OPADDR(SCMD_F_LOADSPOFFS_MEMREAD),
+        CC_OPADDR(SCMD_F_ISEQUAL_JZ),   CC_OPADDR(SCMD_F_NOTEQUAL_JZ),  CC_OPADDR(SCMD_F_GREATER_JZ),
+        CC_OPADDR(SCMD_F_LESSTHAN_JZ),  CC_OPADDR(SCMD_F_GTE_JZ),       CC_OPADDR(SCMD_F_LTE_JZ),
+        CC_OPADDR(SCMD_F_LINENUM)
+    };
+#endif
 
     /* Main bytecode execution loop */
     //=====================================================================
@@ -622,17 +776,34 @@ int ccInstance::Run(int32_t curpc)
         //
         /* Read operation */
         //=====================================================================
-        codeOp.Instruction.Code = codeInst->code[pc];
-        codeOp.Instruction.InstanceId = (codeOp.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
-        codeOp.Instruction.Code &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
+    read_op:
+        if (profiling)
+            ScriptProfiler::InstructionCount++;
+        if (decoded_ops)
+        {
+            // The code was validated when pre-decoding
+            const ScriptDecodedOp &dec_op = decoded_ops[pc];
+            codeOp.Instruction.Code = dec_op.Code;
+            codeOp.Instruction.InstanceId = dec_op.InstanceId;
+            codeOp.ArgCount = dec_op.ArgCount;
+        }
+        else
+        {
+            codeOp.Instruction.Code = codeInst->code[pc];
+            codeOp.Instruction.InstanceId = (codeOp.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
+            codeOp.Instruction.Code &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
 
-        CC_ERROR_IF_RETCODE((codeOp.Instruction.Code < 0 || codeOp.Instruction.Code >= CC_NUM_SCCMDS),
-            "invalid instruction %d found in code stream", codeOp.Instruction.Code);
+            if (codeOp.Instruction.Code < 0 || codeOp.Instruction.Code >= CC_NUM_SCCMDS)
+            {
+                cc_error("invalid instruction %d found in code stream", codeOp.Instruction.Code);
+                return -1;
+            }
 
-        codeOp.ArgCount = sccmd_info[codeOp.Instruction.Code].ArgCount;
+            codeOp.ArgCount = sccmd_info[codeOp.Instruction.Code].ArgCount;
 
-        CC_ERROR_IF_RETCODE(pc + codeOp.ArgCount >= codeInst->codesize,
-            "unexpected end of code data (%d; %d)", pc + codeOp.ArgCount, codeInst->codesize);
+            CC_ERROR_IF_RETCODE(pc + codeOp.ArgCount >= codeInst->codesize,
+                "unexpected end of code data (%d; %d)", pc + codeOp.ArgCount, codeInst->codesize);
+        }
 
 
         // Read arguments; use switch as it proved to be faster than the loop
@@ -663,15 +834,21 @@ int ccInstance::Run(int32_t curpc)
 
         /* Perform operation */
         //=====================================================================
+#if (CC_COMPUTED_GOTO)
+        if (decoded_ops)
+            goto *op_handlers[codeOp.Instruction.Code];
+#endif
         switch (codeOp.Instruction.Code)
         {
-        case SCMD_LINENUM:
+        CC_OPCASE(SCMD_LINENUM):
             line_number = codeOp.Arg1i();
             currentline = line_number;
+            if (profiling)
+                ScriptProfiler::OnLine(this);
             if (new_line_hook)
                 new_line_hook(this, currentline);
             break;
-        case SCMD_ADD:
+        CC_OPCASE(SCMD_ADD):
         {
             const auto arg_reg = codeOp.Arg1i();
             const auto arg_lit = codeOp.Arg2i();
@@ -703,7 +880,7 @@ int ccInstance::Run(int32_t curpc)
             }
             break;
         }
-        case SCMD_SUB:
+        CC_OPCASE(SCMD_SUB):
         {
             const auto arg_reg = codeOp.Arg1i();
             const auto arg_lit = codeOp.Arg2i();
@@ -733,14 +910,14 @@ int ccInstance::Run(int32_t curpc)
             }
             break;
         }
-        case SCMD_REGTOREG:
+        CC_OPCASE(SCMD_REGTOREG):
         {
             const auto &reg1 = registers[codeOp.Arg1i()];
             auto       &reg2 = registers[codeOp.Arg2i()];
             reg2 = reg1;
             break;
         }
-        case SCMD_WRITELIT:
+        CC_OPCASE(SCMD_WRITELIT):
         {
             // Take the data address from reg[MAR] and copy there arg1 bytes from arg2 address
             //
@@ -770,7 +947,7 @@ int ccInstance::Run(int32_t curpc)
             }
             break;
         }
-        case SCMD_RET:
+        CC_OPCASE(SCMD_RET):
         {
             if (loopIterationCheckDisabled > 0)
                 loopIterationCheckDisabled--;
@@ -787,7 +964,7 @@ int ccInstance::Run(int32_t curpc)
             POP_CALL_STACK;
             continue; // continue so that the PC doesn't get overwritten
         }
-        case SCMD_LITTOREG:
+        CC_OPCASE(SCMD_LITTOREG):
         {
             auto &reg1 = registers[codeOp.Arg1i()];
             FixupArgument(codeOp.Args[1], codeInst->code_fixups[pc + 2], codeInst->code[pc + 2], this->stack, codeInst->strings);
@@ -796,35 +973,35 @@ int ccInstance::Run(int32_t curpc)
             reg1 = arg_value;
             break;
         }
-        case SCMD_MEMREAD:
+        CC_OPCASE(SCMD_MEMREAD):
         {
             // Take the data address from reg[MAR] and copy int32_t to reg[arg1]
             auto &reg1 = registers[codeOp.Arg1i()];
             reg1 = registers[SREG_MAR].ReadValue();
             break;
         }
-        case SCMD_MEMWRITE:
+        CC_OPCASE(SCMD_MEMWRITE):
         {
             // Take the data address from reg[MAR] and copy there int32_t from reg[arg1]
             const auto &reg1 = registers[codeOp.Arg1i()];
             registers[SREG_MAR].WriteValue(reg1);
             break;
         }
-        case SCMD_LOADSPOFFS:
+        CC_OPCASE(SCMD_LOADSPOFFS):
         {
             const auto arg_off = codeOp.Arg1i();
             registers[SREG_MAR] = GetStackPtrOffsetRw(arg_off);
             ASSERT_CC_ERROR();
             break;
         }
-        case SCMD_MULREG:
+        CC_OPCASE(SCMD_MULREG):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetInt32(reg1.IValue * reg2.IValue);
             break;
         }
-        case SCMD_DIVREG:
+        CC_OPCASE(SCMD_DIVREG):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
@@ -836,7 +1013,7 @@ int ccInstance::Run(int32_t curpc)
             reg1.SetInt32(reg1.IValue / reg2.IValue);
             break;
         }
-        case SCMD_ADDREG:
+        CC_OPCASE(SCMD_ADDREG):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
@@ -844,7 +1021,7 @@ int ccInstance::Run(int32_t curpc)
             reg1.IValue += reg2.IValue;
             break;
         }
-        case SCMD_SUBREG:
+        CC_OPCASE(SCMD_SUBREG):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
@@ -852,84 +1029,84 @@ int ccInstance::Run(int32_t curpc)
             reg1.IValue -= reg2.IValue;
             break;
         }
-        case SCMD_BITAND:
+        CC_OPCASE(SCMD_BITAND):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetInt32(reg1.IValue & reg2.IValue);
             break;
         }
-        case SCMD_BITOR:
+        CC_OPCASE(SCMD_BITOR):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetInt32(reg1.IValue | reg2.IValue);
             break;
         }
-        case SCMD_ISEQUAL:
+        CC_OPCASE(SCMD_ISEQUAL):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetInt32AsBool(reg1 == reg2);
             break;
         }
-        case SCMD_NOTEQUAL:
+        CC_OPCASE(SCMD_NOTEQUAL):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetInt32AsBool(reg1 != reg2);
             break;
         }
-        case SCMD_GREATER:
+        CC_OPCASE(SCMD_GREATER):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetInt32AsBool(reg1.IValue > reg2.IValue);
             break;
         }
-        case SCMD_LESSTHAN:
+        CC_OPCASE(SCMD_LESSTHAN):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetInt32AsBool(reg1.IValue < reg2.IValue);
             break;
         }
-        case SCMD_GTE:
+        CC_OPCASE(SCMD_GTE):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetInt32AsBool(reg1.IValue >= reg2.IValue);
             break;
         }
-        case SCMD_LTE:
+        CC_OPCASE(SCMD_LTE):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetInt32AsBool(reg1.IValue <= reg2.IValue);
             break;
         }
-        case SCMD_AND:
+        CC_OPCASE(SCMD_AND):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetInt32AsBool(reg1.IValue && reg2.IValue);
             break;
         }
-        case SCMD_OR:
+        CC_OPCASE(SCMD_OR):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetInt32AsBool(reg1.IValue || reg2.IValue);
             break;
         }
-        case SCMD_XORREG:
+        CC_OPCASE(SCMD_XORREG):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetInt32(reg1.IValue ^ reg2.IValue);
             break;
         }
-        case SCMD_MODREG:
+        CC_OPCASE(SCMD_MODREG):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
@@ -941,13 +1118,13 @@ int ccInstance::Run(int32_t curpc)
             reg1.SetInt32(reg1.IValue % reg2.IValue);
             break;
         }
-        case SCMD_NOTREG:
+        CC_OPCASE(SCMD_NOTREG):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             reg1 = !(reg1);
             break;
         }
-        case SCMD_CALL:
+        CC_OPCASE(SCMD_CALL):
         {
             // Call another function within same script, just save PC
             // and continue from there
@@ -978,51 +1155,55 @@ int ccInstance::Run(int32_t curpc)
             curnest++;
             thisbase[curnest] = 0;
             funcstart[curnest] = pc;
+            if (profiling)
+                ScriptProfiler::OnFunctionCall(this);
+            if (use_jit && (RunNative(codeInst, loopIterationCheckDisabled, loopIterations, loopCheckIterations) != 0))
+                return -1;
             continue; // continue so that the PC doesn't get overwritten
         }
-        case SCMD_MEMREADB:
+        CC_OPCASE(SCMD_MEMREADB):
         {
             // Take the data address from reg[MAR] and copy byte to reg[arg1]
             auto &reg1 = registers[codeOp.Arg1i()];
             reg1.SetUInt8(registers[SREG_MAR].ReadByte());
             break;
         }
-        case SCMD_MEMREADW:
+        CC_OPCASE(SCMD_MEMREADW):
         {
             // Take the data address from reg[MAR] and copy int16_t to reg[arg1]
             auto &reg1 = registers[codeOp.Arg1i()];
             reg1.SetInt16(registers[SREG_MAR].ReadInt16());
             break;
         }
-        case SCMD_MEMWRITEB:
+        CC_OPCASE(SCMD_MEMWRITEB):
         {
             // Take the data address from reg[MAR] and copy there byte from reg[arg1]
             const auto &reg1 = registers[codeOp.Arg1i()];
             registers[SREG_MAR].WriteByte(reg1.IValue);
             break;
         }
-        case SCMD_MEMWRITEW:
+        CC_OPCASE(SCMD_MEMWRITEW):
         {
             // Take the data address from reg[MAR] and copy there int16_t from reg[arg1]
             const auto &reg1 = registers[codeOp.Arg1i()];
             registers[SREG_MAR].WriteInt16(reg1.IValue);
             break;
         }
-        case SCMD_JZ:
+        CC_OPCASE(SCMD_JZ):
         {
             const auto arg_lit = codeOp.Arg1i();
             if (registers[SREG_AX].IsNull())
                 pc += arg_lit;
             break;
         }
-        case SCMD_JNZ:
+        CC_OPCASE(SCMD_JNZ):
         {
             const auto arg_lit = codeOp.Arg1i();
             if (!registers[SREG_AX].IsNull())
                 pc += arg_lit;
             break;
         }
-        case SCMD_PUSHREG:
+        CC_OPCASE(SCMD_PUSHREG):
         {
             // Push reg[arg1] value to the stack
             const auto &reg1 = registers[codeOp.Arg1i()];
@@ -1030,14 +1211,14 @@ int ccInstance::Run(int32_t curpc)
             PushValueToStack(reg1);
             break;
         }
-        case SCMD_POPREG:
+        CC_OPCASE(SCMD_POPREG):
         {
             auto &reg1 = registers[codeOp.Arg1i()];
             ASSERT_STACK_SIZE(1);
             reg1 = PopValueFromStack();
             break;
         }
-        case SCMD_JMP:
+        CC_OPCASE(SCMD_JMP):
         {
             const auto arg_lit = codeOp.Arg1i();
             pc += arg_lit;
@@ -1070,14 +1251,14 @@ int ccInstance::Run(int32_t curpc)
             }
             break;
         }
-        case SCMD_MUL:
+        CC_OPCASE(SCMD_MUL):
         {
             auto &reg1 = registers[codeOp.Arg1i()];
             const auto arg_lit = codeOp.Arg2i();
             reg1.IValue *= arg_lit;
             break;
         }
-        case SCMD_CHECKBOUNDS:
+        CC_OPCASE(SCMD_CHECKBOUNDS):
         {
             const auto &reg1 = registers[codeOp.Arg1i()];
             const auto arg_lit = codeOp.Arg2i();
@@ -1089,7 +1270,7 @@ int ccInstance::Run(int32_t curpc)
             }
             break;
         }
-        case SCMD_DYNAMICBOUNDS:
+        CC_OPCASE(SCMD_DYNAMICBOUNDS):
         {
             const auto &reg1 = registers[codeOp.Arg1i()];
             // TODO: test reg[MAR] type here;
@@ -1114,7 +1295,7 @@ int ccInstance::Run(int32_t curpc)
             }
             break;
         }
-        case SCMD_MEMREADPTR:
+        CC_OPCASE(SCMD_MEMREADPTR):
         {
             auto &reg1 = registers[codeOp.Arg1i()];
             int32_t handle = registers[SREG_MAR].ReadInt32();
@@ -1127,11 +1308,12 @@ int ccInstance::Run(int32_t curpc)
             ASSERT_CC_ERROR();
             break;
         }
-        case SCMD_MEMWRITEPTR:
+        CC_OPCASE(SCMD_MEMWRITEPTR):
         {
             const auto &reg1 = registers[codeOp.Arg1i()];
             int32_t handle = registers[SREG_MAR].ReadInt32();
             void *address;
+            IScriptObject *manager = nullptr;
 
             switch (reg1.Type)
             {
@@ -1141,6 +1323,9 @@ int ccInstance::Run(int32_t curpc)
                 address = reg1.ArrMgr->GetElementPtr(reg1.Ptr, reg1.IValue);
                 break;
             case kScValScriptObject:
+                address = reg1.Ptr;
+                manager = reg1.ObjMgr;
+                break;
             case kScValPluginObject:
                 address = reg1.Ptr;
                 break;
@@ -1155,7 +1340,7 @@ int ccInstance::Run(int32_t curpc)
                 break;
             }
 
-            int32_t newHandle = ccGetObjectHandleFromAddress(address);
+            int32_t newHandle = ccGetObjectHandleFromAddress(address, manager);
             if (newHandle == -1)
                 return -1;
 
@@ -1168,9 +1353,10 @@ int ccInstance::Run(int32_t curpc)
             registers[SREG_MAR].WriteInt32(newHandle);
             break;
         }
-        case SCMD_MEMINITPTR:
+        CC_OPCASE(SCMD_MEMINITPTR):
         {
             void *address;
+            IScriptObject *manager = nullptr;
             const auto &reg1 = registers[codeOp.Arg1i()];
 
             switch (reg1.Type)
@@ -1181,6 +1367,9 @@ int ccInstance::Run(int32_t curpc)
                 address = reg1.ArrMgr->GetElementPtr(reg1.Ptr, reg1.IValue);
                 break;
             case kScValScriptObject:
+                address = reg1.Ptr;
+                manager = reg1.ObjMgr;
+                break;
             case kScValPluginObject:
                 address = reg1.Ptr;
                 break;
@@ -1196,7 +1385,7 @@ int ccInstance::Run(int32_t curpc)
             }
 
             // like memwriteptr, but doesn't attempt to free the old one
-            int32_t newHandle = ccGetObjectHandleFromAddress(address);
+            int32_t newHandle = ccGetObjectHandleFromAddress(address, manager);
             if (newHandle == -1)
                 return -1;
 
@@ -1204,14 +1393,14 @@ int ccInstance::Run(int32_t curpc)
             registers[SREG_MAR].WriteInt32(newHandle);
             break;
         }
-        case SCMD_MEMZEROPTR:
+        CC_OPCASE(SCMD_MEMZEROPTR):
         {
             int32_t handle = registers[SREG_MAR].ReadInt32();
             ccReleaseObjectReference(handle);
             registers[SREG_MAR].WriteInt32(0);
             break;
         }
-        case SCMD_MEMZEROPTRND:
+        CC_OPCASE(SCMD_MEMZEROPTRND):
         {
             int32_t handle = registers[SREG_MAR].ReadInt32();
 
@@ -1226,14 +1415,14 @@ int ccInstance::Run(int32_t curpc)
             registers[SREG_MAR].WriteInt32(0);
             break;
         }
-        case SCMD_CHECKNULL:
+        CC_OPCASE(SCMD_CHECKNULL):
             if (registers[SREG_MAR].IsNull())
             {
                 cc_error("!Null pointer referenced");
                 return -1;
             }
             break;
-        case SCMD_CHECKNULLREG:
+        CC_OPCASE(SCMD_CHECKNULLREG):
         {
             const auto &reg1 = registers[codeOp.Arg1i()];
             if (reg1.IsNull())
@@ -1243,13 +1432,13 @@ int ccInstance::Run(int32_t curpc)
             }
             break;
         }
-        case SCMD_NUMFUNCARGS:
+        CC_OPCASE(SCMD_NUMFUNCARGS):
         {
             const auto arg_lit = codeOp.Arg1i();
             num_args_to_func = arg_lit;
             break;
         }
-        case SCMD_CALLAS:
+        CC_OPCASE(SCMD_CALLAS):
         {
             PUSH_CALL_STACK;
 
@@ -1306,10 +1495,19 @@ int ccInstance::Run(int32_t curpc)
             POP_CALL_STACK;
             break;
         }
-        case SCMD_CALLEXT:
+        CC_OPCASE(SCMD_CALLEXT):
         {
             // Call to a real 'C' code function
             const auto &reg1 = registers[codeOp.Arg1i()];
+            // The register may be overwritten by the call's result, so copy
+            // the function for the profiler, along with the call start time
+            RuntimeScriptValue api_fn;
+            AGS_Clock::time_point api_start;
+            if (profiling)
+            {
+                api_fn = reg1;
+                api_start = AGS_Clock::now();
+            }
 
             was_just_callas = -1;
             if (num_args_to_func < 0)
@@ -1317,6 +1515,21 @@ int ccInstance::Run(int32_t curpc)
                 num_args_to_func = func_callstack.Count;
             }
 
+            // Try calling the real API function directly first
+            if (reg1.IValue != kScFastCall_None &&
+                CallFastApiFunction(reg1, next_call_needs_object != 0, func_callstack.GetHead() + 1, num_args_to_func))
+            {
+                if (cc_has_error())
+                {
+                    return -1;
+                }
+                if (profiling)
+                    ScriptProfiler::OnApiCall(api_fn, AGS_Clock::now() - api_start);
+                next_call_needs_object = 0;
+                num_args_to_func = -1;
+                break;
+            }
+
             // Convert pointer arguments to simple types
             for (RuntimeScriptValue *prval = func_callstack.GetHead() + num_args_to_func;
                 prval > func_callstack.GetHead(); --prval)
@@ -1383,17 +1596,19 @@ int ccInstance::Run(int32_t curpc)
             }
 
             registers[SREG_AX] = return_value;
+            if (profiling)
+                ScriptProfiler::OnApiCall(api_fn, AGS_Clock::now() - api_start);
             next_call_needs_object = 0;
             num_args_to_func = -1;
             break;
         }
-        case SCMD_PUSHREAL:
+        CC_OPCASE(SCMD_PUSHREAL):
         {
             const auto &reg1 = registers[codeOp.Arg1i()];
             PushToFuncCallStack(func_callstack, reg1);
             break;
         }
-        case SCMD_SUBREALSTACK:
+        CC_OPCASE(SCMD_SUBREALSTACK):
         {
             const auto arg_lit = codeOp.Arg1i();
             PopFromFuncCallStack(func_callstack, arg_lit);
@@ -1405,7 +1620,7 @@ int ccInstance::Run(int32_t curpc)
             }
             break;
         }
-        case SCMD_CALLOBJ:
+        CC_OPCASE(SCMD_CALLOBJ):
         {
             // set the OP register
             const auto &reg1 = registers[codeOp.Arg1i()];
@@ -1441,27 +1656,27 @@ int ccInstance::Run(int32_t curpc)
             next_call_needs_object = 1;
             break;
         }
-        case SCMD_SHIFTLEFT:
+        CC_OPCASE(SCMD_SHIFTLEFT):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetInt32(reg1.IValue << reg2.IValue);
             break;
         }
-        case SCMD_SHIFTRIGHT:
+        CC_OPCASE(SCMD_SHIFTRIGHT):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetInt32(reg1.IValue >> reg2.IValue);
             break;
         }
-        case SCMD_THISBASE:
+        CC_OPCASE(SCMD_THISBASE):
         {
             const auto arg_lit = codeOp.Arg1i();
             thisbase[curnest] = arg_lit;
             break;
         }
-        case SCMD_NEWARRAY:
+        CC_OPCASE(SCMD_NEWARRAY):
         {
             auto &reg1 = registers[codeOp.Arg1i()];
             const auto arg_elsize = codeOp.Arg2i();
@@ -1476,7 +1691,7 @@ int ccInstance::Run(int32_t curpc)
             reg1.SetScriptObject(ref.Obj, &globalDynamicArray);
             break;
         }
-        case SCMD_NEWUSEROBJECT:
+        CC_OPCASE(SCMD_NEWUSEROBJECT):
         {
             auto &reg1 = registers[codeOp.Arg1i()];
             const auto arg_size = codeOp.Arg2i();
@@ -1489,28 +1704,28 @@ int ccInstance::Run(int32_t curpc)
             reg1.SetScriptObject(ref.Obj, ref.Mgr);
             break;
         }
-        case SCMD_FADD:
+        CC_OPCASE(SCMD_FADD):
         {
             auto &reg1 = registers[codeOp.Arg1i()];
             const auto arg_lit = codeOp.Arg2i();
             reg1.SetFloat(reg1.FValue + arg_lit); // arg2 was used as int here originally
             break;
         }
-        case SCMD_FSUB:
+        CC_OPCASE(SCMD_FSUB):
         {
             auto &reg1 = registers[codeOp.Arg1i()];
             const auto arg_lit = codeOp.Arg2i();
             reg1.SetFloat(reg1.FValue - arg_lit); // arg2 was used as int here originally
             break;
         }
-        case SCMD_FMULREG:
+        CC_OPCASE(SCMD_FMULREG):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetFloat(reg1.FValue * reg2.FValue);
             break;
         }
-        case SCMD_FDIVREG:
+        CC_OPCASE(SCMD_FDIVREG):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
@@ -1522,49 +1737,49 @@ int ccInstance::Run(int32_t curpc)
             reg1.SetFloat(reg1.FValue / reg2.FValue);
             break;
         }
-        case SCMD_FADDREG:
+        CC_OPCASE(SCMD_FADDREG):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetFloat(reg1.FValue + reg2.FValue);
             break;
         }
-        case SCMD_FSUBREG:
+        CC_OPCASE(SCMD_FSUBREG):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetFloat(reg1.FValue - reg2.FValue);
             break;
         }
-        case SCMD_FGREATER:
+        CC_OPCASE(SCMD_FGREATER):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetFloatAsBool(reg1.FValue > reg2.FValue);
             break;
         }
-        case SCMD_FLESSTHAN:
+        CC_OPCASE(SCMD_FLESSTHAN):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetFloatAsBool(reg1.FValue < reg2.FValue);
             break;
         }
-        case SCMD_FGTE:
+        CC_OPCASE(SCMD_FGTE):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetFloatAsBool(reg1.FValue >= reg2.FValue);
             break;
         }
-        case SCMD_FLTE:
+        CC_OPCASE(SCMD_FLTE):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
             reg1.SetFloatAsBool(reg1.FValue <= reg2.FValue);
             break;
         }
-        case SCMD_ZEROMEMORY:
+        CC_OPCASE(SCMD_ZEROMEMORY):
         {
             const auto arg_size = codeOp.Arg1i();
             // Check if we are zeroing at stack tail
@@ -1585,7 +1800,7 @@ int ccInstance::Run(int32_t curpc)
             }
             break;
         }
-        case SCMD_CREATESTRING:
+        CC_OPCASE(SCMD_CREATESTRING):
         {
             auto &reg1 = registers[codeOp.Arg1i()];
             const char *ptr = reinterpret_cast<const char*>(reg1.GetDirectPtr());
@@ -1593,7 +1808,7 @@ int ccInstance::Run(int32_t curpc)
             reg1.SetScriptObject(ref.Obj, &myScriptStringImpl);
             break;
         }
-        case SCMD_STRINGSEQUAL:
+        CC_OPCASE(SCMD_STRINGSEQUAL):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
@@ -1610,7 +1825,7 @@ int ccInstance::Run(int32_t curpc)
             }
             break;
         }
-        case SCMD_STRINGSNOTEQ:
+        CC_OPCASE(SCMD_STRINGSNOTEQ):
         {
             auto       &reg1 = registers[codeOp.Arg1i()];
             const auto &reg2 = registers[codeOp.Arg2i()];
@@ -1627,11 +1842,75 @@ int ccInstance::Run(int32_t curpc)
             }
             break;
         }
-        case SCMD_LOOPCHECKOFF:
+        CC_OPCASE(SCMD_LOOPCHECKOFF):
             if (loopIterationCheckDisabled == 0)
                 loopIterationCheckDisabled++;
             break;
-        default:
+        // Fused instructions: these perform the whole sequence,
+        // and set ArgCount to advance past all of its instructions.
+        CC_OPCASE(SCMD_F_LITTOREG_PUSHREG):
+        {
+            auto &reg1 = registers[codeOp.Arg1i()];
+            FixupArgument(codeOp.Args[1], codeInst->code_fixups[pc + 2], codeInst->code[pc + 2], this->stack, codeInst->strings);
+            ASSERT_CC_ERROR();
+            reg1 = codeOp.Arg2();
+            const auto &reg2 = registers[codeInst->code[pc + 4]];
+            ASSERT_STACK_SPACE_VALS(1);
+            PushValueToStack(reg2);
+            codeOp.ArgCount = 4;
+            break;
+        }
+        CC_OPCASE(SCMD_F_LOADSPOFFS_MEMREAD):
+        {
+            const auto arg_off = codeOp.Arg1i();
+            registers[SREG_MAR] = GetStackPtrOffsetRw(arg_off);
+            ASSERT_CC_ERROR();
+            auto &reg1 = registers[codeInst->code[pc + 3]];
+            reg1 = registers[SREG_MAR].ReadValue();
+            codeOp.ArgCount = 3;
+            break;
+        }
+// Compares two registers, then makes a JZ jump, which follows the comparison
+#define CC_FUSED_CMP_JZ(COND) \
+        { \
+            auto       &reg1 = registers[codeOp.Arg1i()]; \
+            const auto &reg2 = registers[codeOp.Arg2i()]; \
+            reg1.SetInt32AsBool(COND); \
+            const auto arg_lit = static_cast<int32_t>(codeInst->code[pc + 4]); \
+            pc += 3; \
+            codeOp.ArgCount = 1; \
+            if (registers[SREG_AX].IsNull()) \
+                pc += arg_lit; \
+            break; \
+        }
+        CC_OPCASE(SCMD_F_ISEQUAL_JZ):
+            CC_FUSED_CMP_JZ(reg1 == reg2)
+        CC_OPCASE(SCMD_F_NOTEQUAL_JZ):
+            CC_FUSED_CMP_JZ(reg1 != reg2)
+        CC_OPCASE(SCMD_F_GREATER_JZ):
+            CC_FUSED_CMP_JZ(reg1.IValue > reg2.IValue)
+        CC_OPCASE(SCMD_F_LESSTHAN_JZ):
+            CC_FUSED_CMP_JZ(reg1.IValue < reg2.IValue)
+        CC_OPCASE(SCMD_F_GTE_JZ):
+            CC_FUSED_CMP_JZ(reg1.IValue >= reg2.IValue)
+        CC_OPCASE(SCMD_F_LTE_JZ):
+            CC_FUSED_CMP_JZ(reg1.IValue <= reg2.IValue)
+#undef CC_FUSED_CMP_JZ
+        CC_OPCASE(SCMD_F_LINENUM):
+            line_number = codeOp.Arg1i();
+            currentline = line_number;
+            if (profiling)
+                ScriptProfiler::OnLine(this);
+            if (new_line_hook)
+            {
+                // the hook may abort or pause execution, so take the regular path
+                new_line_hook(this, currentline);
+                break;
+            }
+            // proceed with the next instruction right away
+            pc += 2;
+            goto read_op;
+        CC_OPDEFAULT:
             cc_error("instruction %d is not implemented", codeOp.Instruction.Code);
             return -1;
         }
@@ -1643,6 +1922,302 @@ int ccInstance::Run(int32_t curpc)
     return 0;
 }
 
+int ccInstance::RunNative(ccInstance *codeInst, int &loop_check_off,
+    unsigned &loop_iterations, unsigned &loop_check_iterations)
+{
+    // Only the code which was validated when pre-decoding may be compiled
+    if (!codeInst->code_ops)
+        return 0;
+    if (!codeInst->jit_cache)
+        codeInst->jit_cache.reset(new ScriptJitCache());
+    const ScriptJitFunc fn = codeInst->jit_cache->OnFunctionCall(codeInst, pc,
+        [](ScriptJitContext *ctx, int32_t at_pc) { return ctx->Inst->RunNativeOp(*ctx, at_pc); },
+        [](ScriptJitContext *ctx, int32_t at_pc) { return ctx->Inst->CheckNativeLoop(*ctx, at_pc); });
+    if (!fn)
+        return 0;
+
+    ScriptJitContext ctx;
+    ctx.Inst = this;
+    ctx.CodeInst = codeInst;
+    ctx.Registers = registers;
+    ctx.LineNumber = &line_number;
+    ctx.CurrentLine = &currentline;
+    ctx.LoopCheckDisabled = loop_check_off;
+    ctx.LoopIterations = loop_iterations;
+    ctx.LoopCheckIterations = loop_check_iterations;
+    ctx.TimeoutMs = _timeoutCheckMs;
+    const int32_t ret_pc = fn(&ctx);
+    loop_check_off = ctx.LoopCheckDisabled;
+    loop_iterations = ctx.LoopIterations;
+    loop_check_iterations = ctx.LoopCheckIterations;
+    if (ret_pc < 0)
+        return -1;
+    pc = ret_pc;
+    return 0;
+}
+
+int ccInstance::RunNativeOp(ScriptJitContext &ctx, const int32_t at_pc)
+{
+    // NOTE: the instructions below must work exactly like in Run()
+    ccInstance *codeInst = ctx.CodeInst;
+    pc = at_pc;
+    const int32_t op = static_cast<int32_t>(codeInst->code[pc] & INSTANCE_ID_REMOVEMASK);
+    switch (op)
+    {
+    case SCMD_ADD:
+    {
+        const auto arg_lit = static_cast<int32_t>(codeInst->code[pc + 2]);
+        auto &reg1 = registers[SREG_SP]; // the native code only calls this for stack allocation
+        ASSERT_STACK_SPACE_AVAILABLE(1, arg_lit);
+        if (reg1.RValue->IsValid())
+        {
+            registers[SREG_SP].RValue++;
+            stackdata_ptr += arg_lit;
+        }
+        else
+        {
+            PushDataToStack(arg_lit);
+            ASSERT_CC_ERROR();
+        }
+        break;
+    }
+    case SCMD_SUB:
+    {
+        const auto arg_reg = static_cast<int32_t>(codeInst->code[pc + 1]);
+        const auto arg_lit = static_cast<int32_t>(codeInst->code[pc + 2]);
+        auto &reg1 = registers[arg_reg];
+        if (reg1.Type == kScValStackPtr)
+        {
+            if (arg_reg == SREG_SP)
+                PopDataFromStack(arg_lit);
+            else
+                reg1 = GetStackPtrOffsetRw(arg_lit);
+            ASSERT_CC_ERROR();
+        }
+        else
+        {
+            reg1.IValue -= arg_lit;
+        }
+        break;
+    }
+    case SCMD_WRITELIT:
+    {
+        const auto arg_size = static_cast<int32_t>(codeInst->code[pc + 1]);
+        RuntimeScriptValue arg_value;
+        arg_value.SetInt32(static_cast<int32_t>(codeInst->code[pc + 2]));
+        FixupArgument(arg_value, codeInst->code_fixups[pc + 2], codeInst->code[pc + 2], this->stack, codeInst->strings);
+        ASSERT_CC_ERROR();
+        switch (arg_size)
+        {
+        case sizeof(char) :
+            registers[SREG_MAR].WriteByte(arg_value.IValue);
+            break;
+        case sizeof(int16_t) :
+            registers[SREG_MAR].WriteInt16(arg_value.IValue);
+            break;
+        case sizeof(int32_t) :
+            registers[SREG_MAR].WriteValue(arg_value);
+            break;
+        default:
+            cc_error("unexpected data size for WRITELIT op: %d", arg_size);
+            break;
+        }
+        break;
+    }
+    case SCMD_LITTOREG:
+    {
+        auto &reg1 = registers[codeInst->code[pc + 1]];
+        RuntimeScriptValue arg_value;
+        arg_value.SetInt32(static_cast<int32_t>(codeInst->code[pc + 2]));
+        FixupArgument(arg_value, codeInst->code_fixups[pc + 2], codeInst->code[pc + 2], this->stack, codeInst->strings);
+        ASSERT_CC_ERROR();
+        reg1 = arg_value;
+        break;
+    }
+    case SCMD_MEMREAD:
+        registers[codeInst->code[pc + 1]] = registers[SREG_MAR].ReadValue();
+        break;
+    case SCMD_MEMWRITE:
+        registers[SREG_MAR].WriteValue(registers[codeInst->code[pc + 1]]);
+        break;
+    case SCMD_MEMREADB:
+        registers[codeInst->code[pc + 1]].SetUInt8(registers[SREG_MAR].ReadByte());
+        break;
+    case SCMD_MEMREADW:
+        registers[codeInst->code[pc + 1]].SetInt16(registers[SREG_MAR].ReadInt16());
+        break;
+    case SCMD_MEMWRITEB:
+        registers[SREG_MAR].WriteByte(registers[codeInst->code[pc + 1]].IValue);
+        break;
+    case SCMD_MEMWRITEW:
+        registers[SREG_MAR].WriteInt16(registers[codeInst->code[pc + 1]].IValue);
+        break;
+    case SCMD_LOADSPOFFS:
+        registers[SREG_MAR] = GetStackPtrOffsetRw(static_cast<int32_t>(codeInst->code[pc + 1]));
+        ASSERT_CC_ERROR();
+        break;
+    case SCMD_PUSHREG:
+        ASSERT_STACK_SPACE_VALS(1);
+        PushValueToStack(registers[codeInst->code[pc + 1]]);
+        break;
+    case SCMD_POPREG:
+        ASSERT_STACK_SIZE(1);
+        registers[codeInst->code[pc + 1]] = PopValueFromStack();
+        break;
+    case SCMD_DIVREG:
+    case SCMD_MODREG:
+    {
+        auto       &reg1 = registers[codeInst->code[pc + 1]];
+        const auto &reg2 = registers[codeInst->code[pc + 2]];
+        if (reg2.IValue == 0)
+        {
+            cc_error("!Integer divide by zero");
+            return -1;
+        }
+        reg1.SetInt32((op == SCMD_DIVREG) ? (reg1.IValue / reg2.IValue) : (reg1.IValue % reg2.IValue));
+        break;
+    }
+    case SCMD_CHECKBOUNDS:
+    {
+        const auto &reg1 = registers[codeInst->code[pc + 1]];
+        const auto arg_lit = static_cast<int32_t>(codeInst->code[pc + 2]);
+        if ((reg1.IValue < 0) ||
+            (reg1.IValue >= arg_lit))
+        {
+            cc_error("!Array index out of bounds (index: %d, bounds: 0..%d)", reg1.IValue, arg_lit - 1);
+            return -1;
+        }
+        break;
+    }
+    case SCMD_CHECKNULL:
+        if (registers[SREG_MAR].IsNull())
+        {
+            cc_error("!Null pointer referenced");
+            return -1;
+        }
+        break;
+    case SCMD_CHECKNULLREG:
+        if (registers[codeInst->code[pc + 1]].IsNull())
+        {
+            cc_error("!Null string referenced");
+            return -1;
+        }
+        break;
+    case SCMD_FADD:
+    case SCMD_FSUB:
+    {
+        auto &reg1 = registers[codeInst->code[pc + 1]];
+        const auto arg_lit = static_cast<int32_t>(codeInst->code[pc + 2]);
+        reg1.SetFloat((op == SCMD_FADD) ? (reg1.FValue + arg_lit) : (reg1.FValue - arg_lit));
+        break;
+    }
+    case SCMD_FMULREG:
+    case SCMD_FDIVREG:
+    case SCMD_FADDREG:
+    case SCMD_FSUBREG:
+    case SCMD_FGREATER:
+    case SCMD_FLESSTHAN:
+    case SCMD_FGTE:
+    case SCMD_FLTE:
+    {
+        auto       &reg1 = registers[codeInst->code[pc + 1]];
+        const auto &reg2 = registers[codeInst->code[pc + 2]];
+        switch (op)
+        {
+        case SCMD_FMULREG: reg1.SetFloat(reg1.FValue * reg2.FValue); break;
+        case SCMD_FDIVREG:
+            if (reg2.FValue == 0.0)
+            {
+                cc_error("!Floating point divide by zero");
+                return -1;
+            }
+            reg1.SetFloat(reg1.FValue / reg2.FValue);
+            break;
+        case SCMD_FADDREG: reg1.SetFloat(reg1.FValue + reg2.FValue); break;
+        case SCMD_FSUBREG: reg1.SetFloat(reg1.FValue - reg2.FValue); break;
+        case SCMD_FGREATER: reg1.SetFloatAsBool(reg1.FValue > reg2.FValue); break;
+        case SCMD_FLESSTHAN: reg1.SetFloatAsBool(reg1.FValue < reg2.FValue); break;
+        case SCMD_FGTE: reg1.SetFloatAsBool(reg1.FValue >= reg2.FValue); break;
+        default: reg1.SetFloatAsBool(reg1.FValue <= reg2.FValue); break;
+        }
+        break;
+    }
+    case SCMD_ZEROMEMORY:
+    {
+        const auto arg_size = static_cast<int32_t>(codeInst->code[pc + 1]);
+        if (registers[SREG_MAR] == registers[SREG_SP])
+        {
+            ASSERT_STACK_SPACE_BYTES(arg_size);
+            memset(stackdata_ptr, 0, arg_size);
+        }
+        else
+        {
+            cc_error("internal error: stack tail address expected on SCMD_ZEROMEMORY instruction, reg[MAR] type is %d",
+                registers[SREG_MAR].Type);
+            return -1;
+        }
+        break;
+    }
+    case SCMD_STRINGSEQUAL:
+    case SCMD_STRINGSNOTEQ:
+    {
+        auto       &reg1 = registers[codeInst->code[pc + 1]];
+        const auto &reg2 = registers[codeInst->code[pc + 2]];
+        if ((reg1.IsNull()) || (reg2.IsNull()))
+        {
+            cc_error("!Null pointer referenced");
+            return -1;
+        }
+        const char *ptr1 = reinterpret_cast<const char*>(reg1.GetDirectPtr());
+        const char *ptr2 = reinterpret_cast<const char*>(reg2.GetDirectPtr());
+        reg1.SetInt32AsBool((strcmp(ptr1, ptr2) == 0) == (op == SCMD_STRINGSEQUAL));
+        break;
+    }
+    case SCMD_LOOPCHECKOFF:
+        if (ctx.LoopCheckDisabled == 0)
+            ctx.LoopCheckDisabled++;
+        break;
+    default:
+        cc_error("instruction %d is not supported by the compiled code", op);
+        return -1;
+    }
+    return 0;
+}
+
+int ccInstance::CheckNativeLoop(ScriptJitContext &ctx, const int32_t target_pc)
+{
+    // NOTE: this must work exactly like the SCMD_JMP check in Run()
+    pc = target_pc;
+    ++ctx.LoopIterations;
+    if (flags & INSTF_RUNNING)
+    { // was notified still running, don't do anything
+        flags &= ~INSTF_RUNNING;
+        ctx.LoopIterations = 0u;
+        ctx.LoopCheckIterations = 0u;
+    }
+    else if ((ctx.LoopCheckDisabled == 0) && (_maxWhileLoops > 0) &&
+        (++ctx.LoopCheckIterations > _maxWhileLoops))
+    {
+        cc_error("!Script appears to be hung (a while loop ran %d times). The problem may be in a calling function; check the call stack.", ctx.LoopCheckIterations);
+        return -1;
+    }
+    else if ((ctx.LoopIterations & 0x3FF) == 0 && // test each 1024 loops (arbitrary)
+        (std::chrono::duration_cast<std::chrono::milliseconds>(
+            AGS_FastClock::now() - _lastAliveTs) > std::chrono::milliseconds(ctx.TimeoutMs)))
+    { // minimal timeout occured
+        sys_evt_process_pending();
+        _lastAliveTs = AGS_FastClock::now();
+    }
+    // The engine might have aborted the script while processing the events;
+    // let the interpreter handle this at the jump's target
+    if (flags & INSTF_ABORTED)
+    {
+        ctx.ExitPc = target_pc;
+        return 1;
+    }
+    return 0;
+}
+
 String ccInstance::GetCallStack(const int maxLines) const
 {
     String buffer = String::FromFormat("in \"%s\", line %d\n", runningInst->instanceof->GetSectionName(pc), line_number);
@@ -1668,18 +2243,10 @@ void ccInstance::GetScriptPosition(ScriptPosition &script_pos) const
 // get a pointer to a variable or function exported by the script
 RuntimeScriptValue ccInstance::GetSymbolAddress(const char *symname) const
 {
-    char altName[200];
-    snprintf(altName, sizeof(altName), "%s$", symname);
-    RuntimeScriptValue rval_null;
-    const size_t len_altName = strlen(altName);
-    for (int k = 0; k < instanceof->numexports; k++) {
-        if (strcmp(instanceof->exports[k], symname) == 0)
-            return exports[k];
-        // mangled function name
-        if (strncmp(instanceof->exports[k], altName, len_altName) == 0)
-            return exports[k];
-    }
-    return rval_null;
+    const ScriptExportEntry *exp = FindExport(symname);
+    if (!exp)
+        return RuntimeScriptValue();
+    return exports[exp->Index];
 }
 
 void ccInstance::DumpInstruction(const ScriptOperation &op) const
@@ -1687,7 +2254,7 @@ void ccInstance::DumpInstruction(const ScriptOperation &op) const
     // line_num local var should be shared between all the instances
     static int line_num = 0;
 
-    if (op.Instruction.Code == SCMD_LINENUM)
+    if (op.Instruction.Code == SCMD_LINENUM || op.Instruction.Code == SCMD_F_LINENUM)
     {
         line_num = op.Args[0].IValue;
         return;
@@ -1697,7 +2264,10 @@ void ccInstance::DumpInstruction(const ScriptOperation &op) const
     TextStreamWriter writer(std::move(data_s));
     writer.WriteFormat("Line %3d, IP:%8d (SP:%p) ", line_num, pc, registers[SREG_SP].RValue);
 
-    const ScriptCommandInfo &cmd_info = sccmd_info[op.Instruction.Code];
+    // Fused instructions are logged as their first instruction
+    const int32_t op_code = (op.Instruction.Code < CC_NUM_SCCMDS) ? op.Instruction.Code :
+        (runningInst->code[pc] & INSTANCE_ID_REMOVEMASK);
+    const ScriptCommandInfo &cmd_info = sccmd_info[op_code];
     writer.WriteString(cmd_info.CmdName);
 
     for (int i = 0; i < cmd_info.ArgCount; ++i)
@@ -1789,6 +2359,7 @@ bool ccInstance::_Create(PScript scri, const ccInstance * joined)
     if (joined != nullptr) {
         // share memory space with an existing instance (ie. this is a thread/fork)
         globalvars = joined->globalvars;
+        exportmap = joined->exportmap;
         globaldatasize = joined->globaldatasize;
         globaldata = joined->globaldata;
         code = joined->code;
@@ -1797,7 +2368,7 @@ bool ccInstance::_Create(PScript scri, const ccInstance * joined)
     else {
         // create own memory space
         // NOTE: globalvars are created in CreateGlobalVars()
-        globalvars.reset(new ScVarMap());
+        globalvars.reset(new ScVarTable());
         globaldatasize = scri->globaldatasize;
         globaldata = nullptr;
         if (globaldatasize > 0)
@@ -1850,6 +2421,7 @@ bool ccInstance::_Create(PScript scri, const ccInstance * joined)
     {
         resolved_imports = joined->resolved_imports;
         code_fixups = joined->code_fixups;
+        code_ops = joined->code_ops;
     }
     else
     {
@@ -1861,6 +2433,7 @@ bool ccInstance::_Create(PScript scri, const ccInstance * joined)
         {
             return false;
         }
+        CreateExportMap(scri.get());
     }
 
     exports = new RuntimeScriptValue[scri->numexports];
@@ -1937,6 +2510,7 @@ void ccInstance::Free()
             free(code);
     }
     globalvars.reset();
+    exportmap.reset();
     globaldata = nullptr;
     code = nullptr;
     strings = nullptr;
@@ -1952,9 +2526,36 @@ void ccInstance::Free()
     {
         delete [] resolved_imports;
         delete [] code_fixups;
+        delete [] code_ops;
     }
     resolved_imports = nullptr;
     code_fixups = nullptr;
+    code_ops = nullptr;
+    jit_cache.reset();
+}
+
+void ccInstance::UnregisterExports()
+{
+    simp.RemoveScriptExports(this);
+}
+
+bool ccInstance::RegisterExports()
+{
+    if (ccGetOption(SCOPT_AUTOIMPORT) == 0)
+        return true;
+    for (int i = 0; i < instanceof->numexports; i++) {
+        if (!ccAddExternalScriptSymbol(instanceof->exports[i], exports[i], this)) {
+            cc_error("Export table overflow at '%s'", instanceof->exports[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+void ccInstance::ResetGlobalData()
+{
+    if (globaldatasize > 0)
+        memcpy(globaldata, instanceof->globaldata, globaldatasize);
 }
 
 bool ccInstance::ResolveScriptImports(const ccScript *scri)
@@ -1976,6 +2577,13 @@ bool ccInstance::ResolveScriptImports(const ccScript *scri)
         return true;
     }
 
+    std::vector<ResolvedImport> *cache = nullptr;
+    if (scri->numSections > 0)
+    {
+        cache = &ResolvedImportsCache[scri->sectionNames[0]];
+        cache->resize(numimports);
+    }
+
     resolved_imports = new uint32_t[numimports];
     size_t errors = 0, last_err_idx = 0;
     for (int import_idx = 0; import_idx < scri->numimports; ++import_idx)
@@ -1986,7 +2594,27 @@ bool ccInstance::ResolveScriptImports(const ccScript *scri)
             continue;
         }
 
+        // Test if the cached symbol is still registered under the same index
+        if (cache)
+        {
+            const ResolvedImport &cached = (*cache)[import_idx];
+            const ScriptImport *import = simp.getByIndex(cached.Index);
+            if (import && cached.ImportName == scri->imports[import_idx] &&
+                import->Name == cached.SymbolName)
+            {
+                resolved_imports[import_idx] = cached.Index;
+                continue;
+            }
+        }
+
         resolved_imports[import_idx] = simp.get_index_of(scri->imports[import_idx]);
+        if (cache && resolved_imports[import_idx] != UINT32_MAX)
+        {
+            ResolvedImport &cached = (*cache)[import_idx];
+            cached.ImportName = scri->imports[import_idx];
+            cached.SymbolName = simp.getByIndex(resolved_imports[import_idx])->Name;
+            cached.Index = resolved_imports[import_idx];
+        }
         if (resolved_imports[import_idx] == UINT32_MAX)
         {
             Debug::Printf(kDbgMsg_Error, "unresolved import '%s' in '%s'", scri->imports[import_idx], scri->numSections > 0 ? scri->sectionNames[0] : "<unknown>");
@@ -2011,6 +2639,7 @@ bool ccInstance::ResolveScriptImports(const ccScript *scri)
 bool ccInstance::CreateGlobalVars(const ccScript *scri)
 {
     ScriptVariable glvar;
+    globalvars->reserve(scri->numfixups + scri->numexports);
 
     // Step One: deduce global variables from fixups
     for (int i = 0; i < scri->numfixups; ++i)
@@ -2062,6 +2691,16 @@ bool ccInstance::CreateGlobalVars(const ccScript *scri)
         }
     }
 
+    // Sort the table by address for the lookup, and remove duplicate entries,
+    // keeping the first registered one for each address;
+    // NOTE: the table must not be modified after this, as the pointers to
+    // its elements are written into the code and exports during fixups.
+    std::stable_sort(globalvars->begin(), globalvars->end(),
+        [](const ScriptVariable &a, const ScriptVariable &b) { return a.ScAddress < b.ScAddress; });
+    globalvars->erase(std::unique(globalvars->begin(), globalvars->end(),
+        [](const ScriptVariable &a, const ScriptVariable &b) { return a.ScAddress == b.ScAddress; }),
+        globalvars->end());
+    globalvars->shrink_to_fit();
     return true;
 }
 
@@ -2079,7 +2718,7 @@ bool ccInstance::AddGlobalVar(const ScriptVariable &glvar)
         /* return false; */
         Debug::Printf(kDbgMsg_Warn, "WARNING: global variable refers to data beyond allocated buffer (%d, %d)", glvar.ScAddress, globaldatasize);
     }
-    globalvars->insert(std::make_pair(glvar.ScAddress, glvar));
+    globalvars->push_back(glvar);
     return true;
 }
 
@@ -2093,8 +2732,44 @@ ScriptVariable *ccInstance::FindGlobalVar(const int32_t var_addr)
         */
         Debug::Printf(kDbgMsg_Warn, "WARNING: looking up for global variable beyond allocated buffer (%d, %d)", var_addr, globaldatasize);
     }
-    const ScVarMap::iterator it = globalvars->find(var_addr);
-    return it != globalvars->end() ? &it->second : nullptr;
+    const auto it = std::lower_bound(globalvars->begin(), globalvars->end(), var_addr,
+        [](const ScriptVariable &var, int32_t addr) { return var.ScAddress < addr; });
+    return (it != globalvars->end() && it->ScAddress == var_addr) ? &*it : nullptr;
+}
+
+void ccInstance::CreateExportMap(const ccScript *scri)
+{
+    exportmap.reset(new ScExportMap());
+    exportmap->reserve(scri->numexports);
+    for (int i = 0; i < scri->numexports; ++i)
+    {
+        // Function names are mangled as "name$argnum", while old scripts and
+        // non-function exports have plain names
+        const char *exp_name = scri->exports[i];
+        const char *mangle_at = strchr(exp_name, '$');
+        ScriptExportEntry entry;
+        entry.Index = i;
+        String name;
+        if (mangle_at)
+        {
+            name.SetString(exp_name, mangle_at - exp_name);
+            entry.ArgCount = atoi(mangle_at + 1);
+        }
+        else
+        {
+            name = exp_name;
+        }
+        // NOTE: in case of duplicate names the first found export is used
+        exportmap->insert(std::make_pair(name, entry));
+    }
+}
+
+const ScriptExportEntry *ccInstance::FindExport(const char *symname) const
+{
+    if (!exportmap)
+        return nullptr;
+    const auto it = exportmap->find(String::Wrapper(symname));
+    return it != exportmap->end() ? &it->second : nullptr;
 }
 
 static int DetermineScriptLine(const int32_t *code, const size_t codesz, const size_t at_pc)
@@ -2198,9 +2873,95 @@ bool ccInstance::ResolveImportFixups(const ccScript *scri)
         if (import->InstancePtr != nullptr && (code[fixup + 1] & INSTANCE_ID_REMOVEMASK) == SCMD_CALLEXT)
             code[fixup + 1] = SCMD_CALLAS | (import->InstancePtr->loadedInstanceId << INSTANCE_ID_SHIFT);
     }
+    // The code is final now; prepare the instruction stream for the executor
+    CreateDecodedOps(scri);
     return true;
 }
 
+void ccInstance::CreateDecodedOps(const ccScript *scri)
+{
+    delete [] code_ops;
+    code_ops = nullptr;
+    if (codesize <= 0)
+        return;
+
+    std::unique_ptr<ScriptDecodedOp[]> ops(new ScriptDecodedOp[codesize]);
+    for (int32_t at_pc = 0; at_pc < codesize; ++at_pc)
+    {
+        const int32_t op = code[at_pc] & INSTANCE_ID_REMOVEMASK;
+        const int32_t inst_id = (code[at_pc] >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
+        // If the code stream cannot be decoded in full, then leave it
+        // to the executor, which will report the error if this code is ever run
+        if (op < 0 || op >= CC_NUM_SCCMDS || at_pc + sccmd_info[op].ArgCount >= codesize)
+        {
+            Debug::Printf(kDbgMsg_Warn, "WARNING: script %s: unable to pre-decode instruction %d at bytecode pos %d, using slower execution path",
+                scri->numSections > 0 ? scri->sectionNames[0] : "?", op, at_pc);
+            return;
+        }
+        ops[at_pc].Code = static_cast<int16_t>(op);
+        ops[at_pc].InstanceId = static_cast<uint8_t>(inst_id);
+        ops[at_pc].ArgCount = static_cast<uint8_t>(sccmd_info[op].ArgCount);
+        at_pc += sccmd_info[op].ArgCount;
+    }
+    code_ops = ops.release();
+    FuseDecodedOps();
+}
+
+void ccInstance::FuseDecodedOps()
+{
+    // NOTE: only the first instruction's op is replaced; the following ones
+    // are kept as they are, so any jump into the middle of the fused sequence
+    // still lands on a valid instruction.
+    for (int32_t at_pc = 0; at_pc < codesize; at_pc += code_ops[at_pc].ArgCount + 1)
+    {
+        ScriptDecodedOp &op = code_ops[at_pc];
+        const int32_t next_pc = at_pc + op.ArgCount + 1;
+        if (next_pc >= codesize)
+            break;
+        const int next_code = code_ops[next_pc].Code;
+        switch (op.Code)
+        {
+        case SCMD_LITTOREG:
+            if (next_code == SCMD_PUSHREG)
+                op.Code = SCMD_F_LITTOREG_PUSHREG;
+            break;
+        case SCMD_LOADSPOFFS:
+            if (next_code == SCMD_MEMREAD)
+                op.Code = SCMD_F_LOADSPOFFS_MEMREAD;
+            break;
+        case SCMD_ISEQUAL:
+            if (next_code == SCMD_JZ)
+                op.Code = SCMD_F_ISEQUAL_JZ;
+            break;
+        case SCMD_NOTEQUAL:
+            if (next_code == SCMD_JZ)
+                op.Code = SCMD_F_NOTEQUAL_JZ;
+            break;
+        case SCMD_GREATER:
+            if (next_code == SCMD_JZ)
+                op.Code = SCMD_F_GREATER_JZ;
+            break;
+        case SCMD_LESSTHAN:
+            if (next_code == SCMD_JZ)
+                op.Code = SCMD_F_LESSTHAN_JZ;
+            break;
+        case SCMD_GTE:
+            if (next_code == SCMD_JZ)
+                op.Code = SCMD_F_GTE_JZ;
+            break;
+        case SCMD_LTE:
+            if (next_code == SCMD_JZ)
+                op.Code = SCMD_F_LTE_JZ;
+            break;
+        case SCMD_LINENUM:
+            op.Code = SCMD_F_LINENUM;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 void ccInstance::PushValueToStack(const RuntimeScriptValue &rval)
 {
     // Write value to the stack tail and advance stack ptr
@@ -24,8 +24,9 @@
 #include "ac/timer.h"
 #include "script/cc_script.h"  // ccScript
 #include "script/cc_internal.h"  // bytecode constants
-#include "script/nonblockingscriptfunction.h"
+#include "script/runtimescriptvalue.h"
 #include "util/string.h"
+#include "util/string_types.h"
 
 using namespace AGS;
 
@@ -54,6 +55,18 @@ using namespace AGS;
 #define DEBUG_CC_EXEC (AGS_PLATFORM_DEBUG)
 #endif
 
+// Script executor dispatch flag:
+// lets the interpreter jump straight to the instruction handlers
+// using "labels as values" ("computed goto"), where compiler supports these;
+// otherwise the regular switch is used.
+#ifndef CC_COMPUTED_GOTO
+#if defined(__GNUC__) || defined(__clang__)
+#define CC_COMPUTED_GOTO 1
+#else
+#define CC_COMPUTED_GOTO 0
+#endif
+#endif
+
 
 struct ScriptInstruction
 {
@@ -64,6 +77,33 @@ struct ScriptInstruction
     int32_t	InstanceId = 0;
 };
 
+// Fused instructions ("superinstructions"), which combine the frequent
+// instruction sequences emitted by the script compiler. These are never
+// written to the bytecode, and only assigned to the pre-decoded ops.
+enum ScriptFusedCommand
+{
+    SCMD_F_LITTOREG_PUSHREG = CC_NUM_SCCMDS, // LITTOREG + PUSHREG
+    SCMD_F_LOADSPOFFS_MEMREAD,  // LOADSPOFFS + MEMREAD
+    SCMD_F_ISEQUAL_JZ,          // ISEQUAL + JZ
+    SCMD_F_NOTEQUAL_JZ,         // NOTEQUAL + JZ
+    SCMD_F_GREATER_JZ,          // GREATER + JZ
+    SCMD_F_LESSTHAN_JZ,         // LESSTHAN + JZ
+    SCMD_F_GTE_JZ,              // GTE + JZ
+    SCMD_F_LTE_JZ,              // LTE + JZ
+    SCMD_F_LINENUM,             // LINENUM followed by any instruction
+    CC_NUM_EXEC_SCCMDS          // total number of executable instruction codes
+};
+
+// Pre-decoded instruction header, stored for each bytecode position
+// where an instruction begins. Lets the executor skip extracting
+// instruction code and validating it on each step.
+struct ScriptDecodedOp
+{
+    int16_t Code = 0;       // pure instruction code, or a fused instruction
+    uint8_t InstanceId = 0; // instance id, for the far calls
+    uint8_t ArgCount = 0;   // number of instruction's arguments
+};
+
 struct ScriptOperation
 {
 	ScriptInstruction   Instruction;
@@ -89,11 +129,39 @@ struct ScriptVariable
     }
 
     int32_t             ScAddress;  // original 32-bit relative data address, written in compiled script;
-                                    // if we are to use Map or HashMap, this could be used as Key
+                                    // used as a key in the instance's global variables table
     RuntimeScriptValue  RValue;
 };
 
+// Exported symbol's entry in the instance's lookup table
+struct ScriptExportEntry
+{
+    int32_t Index = -1;     // index in the script's exports array
+    int32_t ArgCount = -1;  // declared number of args, if known (name was mangled)
+};
+
+// A resolved reference to the exported script function;
+// may be cached by the caller to skip function lookup on each call.
+struct ScriptFunctionRef
+{
+    const ccScript *Script = nullptr; // the script this function belongs to
+    int32_t ExportIndex = -1;   // index in the script's exports array
+    int32_t ArgCount = -1;      // declared number of args, if known
+
+    ScriptFunctionRef() = default;
+    ScriptFunctionRef(const ccScript *script, int32_t export_index, int32_t arg_count)
+        : Script(script), ExportIndex(export_index), ArgCount(arg_count) {}
+    // Tells whether this reference was resolved for the given script
+    // (successfully or not)
+    bool IsResolvedFor(const ccScript *script) const { return Script == script; }
+    // Tells whether this reference is pointing to an existing function
+    bool IsValid() const { return Script && (ExportIndex >= 0); }
+    // Resets the reference to the non-resolved state
+    void Reset() { *this = ScriptFunctionRef(); }
+};
+
 struct FunctionCallStack;
+namespace AGS { namespace Engine { class ScriptJitCache; struct ScriptJitContext; } }
 
 struct ScriptPosition
 {
@@ -117,11 +185,17 @@ struct ScriptPosition
 struct ccInstance
 {
 public:
-    typedef std::unordered_map<int32_t, ScriptVariable> ScVarMap;
-    typedef std::shared_ptr<ScVarMap>                   PScVarMap;
+    // Global variables table, sorted by the variable's address;
+    // filled once when the instance is created and never modified after
+    typedef std::vector<ScriptVariable>                 ScVarTable;
+    typedef std::shared_ptr<ScVarTable>                 PScVarTable;
+    // Exports lookup table, maps an unmangled symbol name to the export entry
+    typedef std::unordered_map<Common::String, ScriptExportEntry> ScExportMap;
+    typedef std::shared_ptr<ScExportMap>                ScExportMapPtr;
 public:
     int32_t flags;
-    PScVarMap globalvars;
+    PScVarTable globalvars;
+    ScExportMapPtr exportmap;
     char *globaldata;
     int32_t globaldatasize;
     // Executed byte-code. Unlike ccScript's code array which is int32_t, the one
@@ -158,6 +232,13 @@ public:
     int  numimports;
 
     char *code_fixups;
+    // Pre-decoded instruction headers, matching the code array by index;
+    // entries on argument positions are left unused.
+    // Generated after all code fixups are done; may be null, in which case
+    // the executor decodes the instructions as it goes.
+    ScriptDecodedOp *code_ops;
+    // Compiled functions of this instance's code, created on demand
+    std::unique_ptr<AGS::Engine::ScriptJitCache> jit_cache;
 
     // returns the currently executing instance, or NULL if none
     static ccInstance *GetCurrentInstance(void);
@@ -182,6 +263,12 @@ public:
     
     // Call an exported function in the script
     int     CallScriptFunction(const char *funcname, int32_t num_params, const RuntimeScriptValue *params);
+    // Call an exported function in the script, using a previously resolved reference
+    int     CallScriptFunction(const ScriptFunctionRef &func, int32_t num_params, const RuntimeScriptValue *params);
+    // Looks up for the exported function and returns a reference to it;
+    // the returned reference is not valid if the function was not found,
+    // but it is still marked as resolved for this instance's script.
+    ScriptFunctionRef GetScriptFunction(const char *funcname) const;
     
     // Get the script's execution position and callstack as human-readable text
     Common::String GetCallStack(int max_lines = INT_MAX) const;
@@ -194,6 +281,13 @@ public:
     bool    IsBeingRun() const;
     // Notifies that the game was being updated (script not hanging)
     void    NotifyAlive();
+    // Removes this instance's exports from the global symbol table,
+    // or adds them back; used for the instances which are kept aside
+    // for a while without being run
+    void    UnregisterExports();
+    bool    RegisterExports();
+    // Resets the global data to the initial values from the script
+    void    ResetGlobalData();
 
     // For each import, find the instance that corresponds to it and save it
     // in resolved_imports[]. Return whether the function is successful
@@ -208,12 +302,33 @@ private:
     void    Free();
 
     bool    CreateGlobalVars(const ccScript *scri);
+    // Generates the lookup table for the script exports
+    void    CreateExportMap(const ccScript *scri);
+    // Finds the export entry by the unmangled name
+    const ScriptExportEntry *FindExport(const char *symname) const;
     bool    AddGlobalVar(const ScriptVariable &glvar);
     ScriptVariable *FindGlobalVar(int32_t var_addr);
     bool    CreateRuntimeCodeFixups(const ccScript *scri);
+    // Calls the API function directly, if it was registered with a signature
+    bool    CallFastApiFunction(const RuntimeScriptValue &fn, bool needs_object,
+                                const RuntimeScriptValue *params, int32_t param_count);
+    // Generates pre-decoded instruction stream from the final fixed up code
+    void    CreateDecodedOps(const ccScript *scri);
+    // Replaces the known instruction sequences in the pre-decoded stream with fused instructions
+    void    FuseDecodedOps();
 
     // Begin executing script starting from the given bytecode index
     int     Run(int32_t curpc);
+    // Runs the function beginning at the current pc as a native code, if it
+    // was compiled; leaves pc at the function's RET instruction, or where
+    // the native code had to stop. Returns -1 on error, 0 otherwise
+    int     RunNative(ccInstance *codeInst, int &loop_check_off,
+                      unsigned &loop_iterations, unsigned &loop_check_iterations);
+    // Runs a single instruction on behalf of the native code
+    int     RunNativeOp(AGS::Engine::ScriptJitContext &ctx, int32_t at_pc);
+    // Performs the loop check on behalf of the native code,
+    // before the backward jump to the given position
+    int     CheckNativeLoop(AGS::Engine::ScriptJitContext &ctx, int32_t target_pc);
 
     // Stack processing
     // Push writes new value and increments stack ptr;
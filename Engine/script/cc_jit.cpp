@@ -0,0 +1,776 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "script/cc_jit.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+#include "core/platform.h"
+#include "debug/out.h"
+#include "script/cc_instance.h"
+
+// Native code generation is only implemented for x86-64,
+// and not on the platforms which do not allow executable memory
+#if (defined(__x86_64__) || defined(_M_X64)) && !AGS_PLATFORM_OS_IOS && !AGS_PLATFORM_OS_EMSCRIPTEN
+#define CC_JIT_X64 1
+#else
+#define CC_JIT_X64 0
+#endif
+
+#if (CC_JIT_X64)
+#if AGS_PLATFORM_OS_WINDOWS
+#include "platform/windows/windows.h"
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+
+#if (CC_JIT_X64)
+
+// Allocates executable memory and copies the code there
+static void *AllocExecMemory(const std::vector<uint8_t> &code)
+{
+#if AGS_PLATFORM_OS_WINDOWS
+    void *mem = VirtualAlloc(nullptr, code.size(), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (!mem)
+        return nullptr;
+    memcpy(mem, code.data(), code.size());
+    DWORD old_protect;
+    if (!VirtualProtect(mem, code.size(), PAGE_EXECUTE_READ, &old_protect))
+    {
+        VirtualFree(mem, 0, MEM_RELEASE);
+        return nullptr;
+    }
+    FlushInstructionCache(GetCurrentProcess(), mem, code.size());
+    return mem;
+#else
+    void *mem = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED)
+        return nullptr;
+    memcpy(mem, code.data(), code.size());
+    if (mprotect(mem, code.size(), PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(mem, code.size());
+        return nullptr;
+    }
+    return mem;
+#endif
+}
+
+static void FreeExecMemory(void *mem, size_t size)
+{
+#if AGS_PLATFORM_OS_WINDOWS
+    (void)size;
+    VirtualFree(mem, 0, MEM_RELEASE);
+#else
+    munmap(mem, size);
+#endif
+}
+
+// x86-64 general purpose registers
+enum X64Reg
+{
+    kX64_RAX = 0, kX64_RCX = 1, kX64_RDX = 2, kX64_RBX = 3,
+    kX64_RSP = 4, kX64_RSI = 6, kX64_RDI = 7, kX64_R12 = 12
+};
+
+// x86-64 condition codes
+enum X64Cond
+{
+    kX64_CondB = 0x2, kX64_CondE = 0x4, kX64_CondNE = 0x5,
+    kX64_CondL = 0xC, kX64_CondGE = 0xD, kX64_CondLE = 0xE, kX64_CondG = 0xF
+};
+
+#if AGS_PLATFORM_OS_WINDOWS
+// Win64 calling convention: args in rcx, rdx; 32 bytes of shadow space
+const int X64Arg0 = kX64_RCX;
+const int X64Arg1 = kX64_RDX;
+const uint8_t X64FrameSize = 40;
+#else
+// System V calling convention: args in rdi, rsi
+const int X64Arg0 = kX64_RDI;
+const int X64Arg1 = kX64_RSI;
+const uint8_t X64FrameSize = 8;
+#endif
+
+// Writes the x86-64 machine code
+class X64Emitter
+{
+public:
+    std::vector<uint8_t> &GetCode() { return _code; }
+    size_t GetPos() const { return _code.size(); }
+
+    void Byte(uint8_t b) { _code.push_back(b); }
+    void Bytes(std::initializer_list<uint8_t> bytes) { _code.insert(_code.end(), bytes); }
+    void Word(uint16_t v) { Byte(v & 0xFF); Byte((v >> 8) & 0xFF); }
+    void Dword(uint32_t v) { for (int i = 0; i < 4; ++i) Byte((v >> (i * 8)) & 0xFF); }
+    void Qword(uint64_t v) { for (int i = 0; i < 8; ++i) Byte((v >> (i * 8)) & 0xFF); }
+
+    // Instruction with the [base + disp32] memory operand
+    void OpMem(std::initializer_list<uint8_t> opcode, int reg, int base, int32_t disp,
+        bool wide = false, uint8_t prefix = 0)
+    {
+        if (prefix)
+            Byte(prefix);
+        Rex(wide, reg, base);
+        Bytes(opcode);
+        Byte(0x80 | ((reg & 7) << 3) | (base & 7));
+        if ((base & 7) == kX64_RSP)
+            Byte(0x24); // SIB for rsp/r12 base
+        Dword(static_cast<uint32_t>(disp));
+    }
+    // Instruction with two register operands (or a register and opcode extension)
+    void OpReg(std::initializer_list<uint8_t> opcode, int reg, int rm, bool wide = false)
+    {
+        Rex(wide, reg, rm);
+        Bytes(opcode);
+        Byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+    }
+    void MovImm32(int reg, uint32_t imm)
+    {
+        Rex(false, 0, reg);
+        Byte(0xB8 + (reg & 7));
+        Dword(imm);
+    }
+    void MovImm64(int reg, uint64_t imm)
+    {
+        Rex(true, 0, reg);
+        Byte(0xB8 + (reg & 7));
+        Qword(imm);
+    }
+    // setcc r8, for al, cl, dl and bl
+    void SetCC(int cond, int reg) { Bytes({ 0x0F, static_cast<uint8_t>(0x90 | cond) }); Byte(0xC0 | reg); }
+    // Jumps with 32-bit displacement; return the displacement's position
+    size_t Jcc(int cond) { Bytes({ 0x0F, static_cast<uint8_t>(0x80 | cond) }); Dword(0); return GetPos() - 4; }
+    size_t Jmp() { Byte(0xE9); Dword(0); return GetPos() - 4; }
+    // Sets the jump's displacement to the target position
+    void Bind(size_t disp_at, size_t target)
+    {
+        const uint32_t disp = static_cast<uint32_t>(static_cast<int32_t>(target - (disp_at + 4)));
+        for (int i = 0; i < 4; ++i)
+            _code[disp_at + i] = (disp >> (i * 8)) & 0xFF;
+    }
+
+private:
+    void Rex(bool wide, int reg, int rm)
+    {
+        const uint8_t rex = 0x40 | (wide ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0);
+        if (rex != 0x40)
+            Byte(rex);
+    }
+
+    std::vector<uint8_t> _code;
+};
+
+// Translates the script function's bytecode into x86-64 code.
+// The native function keeps the pointer to the context in r12,
+// and the pointer to the script registers in rbx.
+class X64Compiler
+{
+public:
+    X64Compiler(const ccInstance *inst, ScriptJitOpFunc run_op, ScriptJitOpFunc loop_check)
+        : _inst(inst), _runOp(run_op), _loopCheck(loop_check) {}
+
+    // Compiles the function starting at the given position; returns false
+    // if the function cannot be compiled
+    bool Compile(int32_t start_pc, std::vector<uint8_t> &out_code);
+
+private:
+    // Max number of instructions in the compiled function
+    static const size_t MaxInstructions = 4096;
+
+    int32_t Arg(int32_t pc, int n) const { return static_cast<int32_t>(_inst->code[pc + n]); }
+    int32_t Op(int32_t pc) const { return static_cast<int32_t>(_inst->code[pc] & INSTANCE_ID_REMOVEMASK); }
+    // Returns the number of leading register arguments of the instruction,
+    // or -1 if the instruction is not supported
+    static int GetRegArgCount(int32_t op);
+    // Finds all the instructions reachable from the function's start
+    bool FindInstructions(int32_t start_pc);
+    void EmitInstruction(int32_t pc);
+
+    static int32_t RegField(int reg, size_t field_off)
+    {
+        return static_cast<int32_t>(reg * sizeof(RuntimeScriptValue) + field_off);
+    }
+    void LoadInt(int x64_reg, int reg);
+    void StoreInt(int reg, int x64_reg);
+    void StoreTypeAndClear(int reg);
+    void SetInt(int reg, int x64_reg);
+    void SetIntImm(int reg, int32_t value);
+    void SetIntFromCond(int reg, int cond);
+    // Sets ZF if the register is null
+    void TestNull(int reg);
+    // Calls the executor's callback, leaves the function if it returns non-zero
+    void CallOp(ScriptJitOpFunc fn, int32_t pc);
+    void JumpTo(size_t disp_at, int32_t target_pc) { _jumps.push_back(std::make_pair(disp_at, target_pc)); }
+
+    const ccInstance *_inst;
+    ScriptJitOpFunc _runOp;
+    ScriptJitOpFunc _loopCheck;
+    X64Emitter _e;
+    std::vector<int32_t> _ops; // instruction positions, sorted
+    std::unordered_map<int32_t, size_t> _labels; // native code position of each instruction
+    std::vector<std::pair<size_t, int32_t>> _jumps; // jumps to instructions
+    std::vector<size_t> _exitJumps; // jumps to the exit stub
+    std::vector<size_t> _retJumps; // jumps to the epilogue
+};
+
+int X64Compiler::GetRegArgCount(int32_t op)
+{
+    switch (op)
+    {
+    case SCMD_RET:
+    case SCMD_JMP:
+    case SCMD_JZ:
+    case SCMD_JNZ:
+    case SCMD_LINENUM:
+    case SCMD_THISBASE:
+    case SCMD_LOADSPOFFS:
+    case SCMD_WRITELIT:
+    case SCMD_CHECKNULL:
+    case SCMD_ZEROMEMORY:
+    case SCMD_LOOPCHECKOFF:
+        return 0;
+    case SCMD_ADD:
+    case SCMD_SUB:
+    case SCMD_LITTOREG:
+    case SCMD_MEMREAD:
+    case SCMD_MEMWRITE:
+    case SCMD_MEMREADB:
+    case SCMD_MEMREADW:
+    case SCMD_MEMWRITEB:
+    case SCMD_MEMWRITEW:
+    case SCMD_PUSHREG:
+    case SCMD_POPREG:
+    case SCMD_MUL:
+    case SCMD_NOTREG:
+    case SCMD_CHECKBOUNDS:
+    case SCMD_CHECKNULLREG:
+    case SCMD_FADD:
+    case SCMD_FSUB:
+        return 1;
+    case SCMD_REGTOREG:
+    case SCMD_MULREG:
+    case SCMD_DIVREG:
+    case SCMD_MODREG:
+    case SCMD_ADDREG:
+    case SCMD_SUBREG:
+    case SCMD_BITAND:
+    case SCMD_BITOR:
+    case SCMD_XORREG:
+    case SCMD_SHIFTLEFT:
+    case SCMD_SHIFTRIGHT:
+    case SCMD_ISEQUAL:
+    case SCMD_NOTEQUAL:
+    case SCMD_GREATER:
+    case SCMD_LESSTHAN:
+    case SCMD_GTE:
+    case SCMD_LTE:
+    case SCMD_AND:
+    case SCMD_OR:
+    case SCMD_FMULREG:
+    case SCMD_FDIVREG:
+    case SCMD_FADDREG:
+    case SCMD_FSUBREG:
+    case SCMD_FGREATER:
+    case SCMD_FLESSTHAN:
+    case SCMD_FGTE:
+    case SCMD_FLTE:
+    case SCMD_STRINGSEQUAL:
+    case SCMD_STRINGSNOTEQ:
+        return 2;
+    default:
+        return -1; // calls, managed pointers and object creation
+    }
+}
+
+bool X64Compiler::FindInstructions(int32_t start_pc)
+{
+    const int32_t codesize = _inst->codesize;
+    const ScriptDecodedOp *code_ops = _inst->code_ops;
+    // Instruction boundaries, the jumps must land on these
+    std::vector<bool> is_op(codesize);
+    for (int32_t at_pc = 0; at_pc < codesize; at_pc += code_ops[at_pc].ArgCount + 1)
+        is_op[at_pc] = true;
+
+    std::vector<bool> visited(codesize);
+    std::vector<int32_t> pending;
+    pending.push_back(start_pc);
+    while (!pending.empty())
+    {
+        const int32_t pc = pending.back();
+        pending.pop_back();
+        if (pc < 0 || pc >= codesize || !is_op[pc])
+            return false;
+        if (visited[pc])
+            continue;
+        visited[pc] = true;
+        _ops.push_back(pc);
+        if (_ops.size() > MaxInstructions)
+            return false;
+
+        const int32_t op = Op(pc);
+        const int reg_args = GetRegArgCount(op);
+        if (reg_args < 0)
+            return false;
+        for (int i = 1; i <= reg_args; ++i)
+        {
+            if (Arg(pc, i) < 0 || Arg(pc, i) >= CC_NUM_REGISTERS)
+                return false;
+        }
+
+        const int32_t next_pc = pc + code_ops[pc].ArgCount + 1;
+        switch (op)
+        {
+        case SCMD_RET:
+            break;
+        case SCMD_JMP:
+            pending.push_back(next_pc + Arg(pc, 1));
+            break;
+        case SCMD_JZ:
+        case SCMD_JNZ:
+            pending.push_back(next_pc + Arg(pc, 1));
+            pending.push_back(next_pc);
+            break;
+        default:
+            pending.push_back(next_pc);
+            break;
+        }
+    }
+    std::sort(_ops.begin(), _ops.end());
+    return true;
+}
+
+void X64Compiler::LoadInt(int x64_reg, int reg)
+{
+    // mov r32, [rbx + reg.IValue]
+    _e.OpMem({ 0x8B }, x64_reg, kX64_RBX, RegField(reg, offsetof(RuntimeScriptValue, IValue)));
+}
+
+void X64Compiler::StoreInt(int reg, int x64_reg)
+{
+    // mov [rbx + reg.IValue], r32
+    _e.OpMem({ 0x89 }, x64_reg, kX64_RBX, RegField(reg, offsetof(RuntimeScriptValue, IValue)));
+}
+
+void X64Compiler::StoreTypeAndClear(int reg)
+{
+    // The rest of RuntimeScriptValue::SetInt32: integer type, null pointers, size 4
+    const int32_t type_at = RegField(reg, offsetof(RuntimeScriptValue, Type));
+    if (sizeof(RuntimeScriptValue::Type) == 1)
+    {
+        _e.OpMem({ 0xC6 }, 0, kX64_RBX, type_at);
+        _e.Byte(kScValInteger);
+    }
+    else
+    {
+        _e.OpMem({ 0xC7 }, 0, kX64_RBX, type_at);
+        _e.Dword(kScValInteger);
+    }
+    _e.OpMem({ 0xC7 }, 0, kX64_RBX, RegField(reg, offsetof(RuntimeScriptValue, Ptr)), true);
+    _e.Dword(0);
+    _e.OpMem({ 0xC7 }, 0, kX64_RBX, RegField(reg, offsetof(RuntimeScriptValue, MgrPtr)), true);
+    _e.Dword(0);
+    const int32_t size_at = RegField(reg, offsetof(RuntimeScriptValue, Size));
+    if (sizeof(RuntimeScriptValue::Size) == 2)
+    {
+        _e.OpMem({ 0xC7 }, 0, kX64_RBX, size_at, false, 0x66);
+        _e.Word(4);
+    }
+    else
+    {
+        _e.OpMem({ 0xC7 }, 0, kX64_RBX, size_at);
+        _e.Dword(4);
+    }
+}
+
+void X64Compiler::SetInt(int reg, int x64_reg)
+{
+    StoreInt(reg, x64_reg);
+    StoreTypeAndClear(reg);
+}
+
+void X64Compiler::SetIntImm(int reg, int32_t value)
+{
+    // mov dword [rbx + reg.IValue], imm32
+    _e.OpMem({ 0xC7 }, 0, kX64_RBX, RegField(reg, offsetof(RuntimeScriptValue, IValue)));
+    _e.Dword(static_cast<uint32_t>(value));
+    StoreTypeAndClear(reg);
+}
+
+void X64Compiler::SetIntFromCond(int reg, int cond)
+{
+    _e.SetCC(cond, kX64_RAX);
+    _e.OpReg({ 0x0F, 0xB6 }, kX64_RAX, kX64_RAX); // movzx eax, al
+    SetInt(reg, kX64_RAX);
+}
+
+void X64Compiler::TestNull(int reg)
+{
+    // (Ptr | IValue) == 0
+    _e.OpMem({ 0x8B }, kX64_RAX, kX64_RBX, RegField(reg, offsetof(RuntimeScriptValue, Ptr)), true);
+    LoadInt(kX64_RCX, reg);
+    _e.OpReg({ 0x09 }, kX64_RCX, kX64_RAX, true); // or rax, rcx
+}
+
+void X64Compiler::CallOp(ScriptJitOpFunc fn, int32_t pc)
+{
+    _e.OpReg({ 0x89 }, kX64_R12, X64Arg0, true); // mov arg0, r12
+    _e.MovImm32(X64Arg1, static_cast<uint32_t>(pc));
+    _e.MovImm64(kX64_RAX, reinterpret_cast<uint64_t>(fn));
+    _e.OpReg({ 0xFF }, 2, kX64_RAX); // call rax
+    _e.OpReg({ 0x85 }, kX64_RAX, kX64_RAX); // test eax, eax
+    _exitJumps.push_back(_e.Jcc(kX64_CondNE));
+}
+
+void X64Compiler::EmitInstruction(int32_t pc)
+{
+    const int32_t op = Op(pc);
+    switch (op)
+    {
+    case SCMD_LINENUM:
+    {
+        const int32_t line = Arg(pc, 1);
+        _e.OpMem({ 0x8B }, kX64_RAX, kX64_R12, offsetof(ScriptJitContext, LineNumber), true);
+        _e.Bytes({ 0xC7, 0x00 }); // mov dword [rax], imm32
+        _e.Dword(static_cast<uint32_t>(line));
+        _e.OpMem({ 0x8B }, kX64_RAX, kX64_R12, offsetof(ScriptJitContext, CurrentLine), true);
+        _e.Bytes({ 0xC7, 0x00 });
+        _e.Dword(static_cast<uint32_t>(line));
+        break;
+    }
+    case SCMD_ADD:
+        if (Arg(pc, 1) == SREG_SP)
+        { // stack allocation
+            CallOp(_runOp, pc);
+            break;
+        }
+        _e.OpMem({ 0x81 }, 0, kX64_RBX, RegField(Arg(pc, 1), offsetof(RuntimeScriptValue, IValue)));
+        _e.Dword(static_cast<uint32_t>(Arg(pc, 2)));
+        break;
+    case SCMD_SUB:
+    {
+        if (Arg(pc, 1) == SREG_SP)
+        { // stack pop
+            CallOp(_runOp, pc);
+            break;
+        }
+        // stack pointer in other register is offset by the executor
+        const int32_t type_at = RegField(Arg(pc, 1), offsetof(RuntimeScriptValue, Type));
+        _e.OpMem({ static_cast<uint8_t>(sizeof(RuntimeScriptValue::Type) == 1 ? 0x80 : 0x83) }, 7, kX64_RBX, type_at);
+        _e.Byte(kScValStackPtr);
+        const size_t to_int = _e.Jcc(kX64_CondNE);
+        CallOp(_runOp, pc);
+        const size_t to_done = _e.Jmp();
+        _e.Bind(to_int, _e.GetPos());
+        _e.OpMem({ 0x81 }, 5, kX64_RBX, RegField(Arg(pc, 1), offsetof(RuntimeScriptValue, IValue)));
+        _e.Dword(static_cast<uint32_t>(Arg(pc, 2)));
+        _e.Bind(to_done, _e.GetPos());
+        break;
+    }
+    case SCMD_REGTOREG:
+    {
+        static_assert(sizeof(RuntimeScriptValue) % 8 == 0, "RuntimeScriptValue is copied by 8 bytes");
+        const int src = Arg(pc, 1), dst = Arg(pc, 2);
+        if (src == dst)
+            break;
+        for (size_t off = 0; off < sizeof(RuntimeScriptValue); off += 8)
+        {
+            _e.OpMem({ 0x8B }, kX64_RAX, kX64_RBX, RegField(src, off), true);
+            _e.OpMem({ 0x89 }, kX64_RAX, kX64_RBX, RegField(dst, off), true);
+        }
+        break;
+    }
+    case SCMD_LITTOREG:
+        if (_inst->code_fixups[pc + 2] != FIXUP_NOFIXUP)
+        { // the fixed up value is resolved by the executor
+            CallOp(_runOp, pc);
+            break;
+        }
+        SetIntImm(Arg(pc, 1), Arg(pc, 2));
+        break;
+    case SCMD_MUL:
+        LoadInt(kX64_RAX, Arg(pc, 1));
+        _e.OpReg({ 0x69 }, kX64_RAX, kX64_RAX); // imul eax, eax, imm32
+        _e.Dword(static_cast<uint32_t>(Arg(pc, 2)));
+        StoreInt(Arg(pc, 1), kX64_RAX);
+        break;
+    case SCMD_ADDREG:
+    case SCMD_SUBREG:
+        // only the IValue is changed, this may be a pointer arithmetics
+        LoadInt(kX64_RAX, Arg(pc, 2));
+        _e.OpMem({ static_cast<uint8_t>(op == SCMD_ADDREG ? 0x01 : 0x29) }, kX64_RAX, kX64_RBX,
+            RegField(Arg(pc, 1), offsetof(RuntimeScriptValue, IValue)));
+        break;
+    case SCMD_MULREG:
+        LoadInt(kX64_RAX, Arg(pc, 1));
+        _e.OpMem({ 0x0F, 0xAF }, kX64_RAX, kX64_RBX, RegField(Arg(pc, 2), offsetof(RuntimeScriptValue, IValue)));
+        SetInt(Arg(pc, 1), kX64_RAX);
+        break;
+    case SCMD_BITAND:
+    case SCMD_BITOR:
+    case SCMD_XORREG:
+    {
+        const uint8_t opcode = (op == SCMD_BITAND) ? 0x23 : (op == SCMD_BITOR) ? 0x0B : 0x33;
+        LoadInt(kX64_RAX, Arg(pc, 1));
+        _e.OpMem({ opcode }, kX64_RAX, kX64_RBX, RegField(Arg(pc, 2), offsetof(RuntimeScriptValue, IValue)));
+        SetInt(Arg(pc, 1), kX64_RAX);
+        break;
+    }
+    case SCMD_SHIFTLEFT:
+    case SCMD_SHIFTRIGHT:
+        LoadInt(kX64_RCX, Arg(pc, 2));
+        LoadInt(kX64_RAX, Arg(pc, 1));
+        _e.OpReg({ 0xD3 }, op == SCMD_SHIFTLEFT ? 4 : 7, kX64_RAX); // shl/sar eax, cl
+        SetInt(Arg(pc, 1), kX64_RAX);
+        break;
+    case SCMD_DIVREG:
+    case SCMD_MODREG:
+    {
+        LoadInt(kX64_RCX, Arg(pc, 2));
+        _e.OpReg({ 0x85 }, kX64_RCX, kX64_RCX); // test ecx, ecx
+        const size_t to_div = _e.Jcc(kX64_CondNE);
+        CallOp(_runOp, pc); // reports division by zero
+        const size_t to_done = _e.Jmp();
+        _e.Bind(to_div, _e.GetPos());
+        LoadInt(kX64_RAX, Arg(pc, 1));
+        // division by -1 is done separately, as INT_MIN / -1 raises an exception
+        _e.OpReg({ 0x83 }, 7, kX64_RCX); // cmp ecx, -1
+        _e.Byte(0xFF);
+        const size_t to_idiv = _e.Jcc(kX64_CondNE);
+        if (op == SCMD_DIVREG)
+            _e.OpReg({ 0xF7 }, 3, kX64_RAX); // neg eax
+        else
+            _e.OpReg({ 0x33 }, kX64_RAX, kX64_RAX); // xor eax, eax
+        const size_t to_store = _e.Jmp();
+        _e.Bind(to_idiv, _e.GetPos());
+        _e.Byte(0x99); // cdq
+        _e.OpReg({ 0xF7 }, 7, kX64_RCX); // idiv ecx
+        if (op == SCMD_MODREG)
+            _e.OpReg({ 0x8B }, kX64_RAX, kX64_RDX); // mov eax, edx
+        _e.Bind(to_store, _e.GetPos());
+        SetInt(Arg(pc, 1), kX64_RAX);
+        _e.Bind(to_done, _e.GetPos());
+        break;
+    }
+    case SCMD_ISEQUAL:
+    case SCMD_NOTEQUAL:
+        // compare (Ptr + IValue) of both registers
+        _e.OpMem({ 0x8B }, kX64_RAX, kX64_RBX, RegField(Arg(pc, 1), offsetof(RuntimeScriptValue, Ptr)), true);
+        _e.OpMem({ 0x63 }, kX64_RCX, kX64_RBX, RegField(Arg(pc, 1), offsetof(RuntimeScriptValue, IValue)), true);
+        _e.OpReg({ 0x01 }, kX64_RCX, kX64_RAX, true); // add rax, rcx
+        _e.OpMem({ 0x8B }, kX64_RDX, kX64_RBX, RegField(Arg(pc, 2), offsetof(RuntimeScriptValue, Ptr)), true);
+        _e.OpMem({ 0x63 }, kX64_RCX, kX64_RBX, RegField(Arg(pc, 2), offsetof(RuntimeScriptValue, IValue)), true);
+        _e.OpReg({ 0x01 }, kX64_RCX, kX64_RDX, true); // add rdx, rcx
+        _e.OpReg({ 0x39 }, kX64_RDX, kX64_RAX, true); // cmp rax, rdx
+        SetIntFromCond(Arg(pc, 1), op == SCMD_ISEQUAL ? kX64_CondE : kX64_CondNE);
+        break;
+    case SCMD_GREATER:
+    case SCMD_LESSTHAN:
+    case SCMD_GTE:
+    case SCMD_LTE:
+    {
+        const int cond = (op == SCMD_GREATER) ? kX64_CondG : (op == SCMD_LESSTHAN) ? kX64_CondL :
+            (op == SCMD_GTE) ? kX64_CondGE : kX64_CondLE;
+        LoadInt(kX64_RAX, Arg(pc, 1));
+        _e.OpMem({ 0x3B }, kX64_RAX, kX64_RBX, RegField(Arg(pc, 2), offsetof(RuntimeScriptValue, IValue)));
+        SetIntFromCond(Arg(pc, 1), cond);
+        break;
+    }
+    case SCMD_AND:
+    case SCMD_OR:
+        LoadInt(kX64_RAX, Arg(pc, 1));
+        _e.OpReg({ 0x85 }, kX64_RAX, kX64_RAX);
+        _e.SetCC(kX64_CondNE, kX64_RAX);
+        LoadInt(kX64_RCX, Arg(pc, 2));
+        _e.OpReg({ 0x85 }, kX64_RCX, kX64_RCX);
+        _e.SetCC(kX64_CondNE, kX64_RCX);
+        _e.OpReg({ static_cast<uint8_t>(op == SCMD_AND ? 0x20 : 0x08) }, kX64_RCX, kX64_RAX); // and/or al, cl
+        _e.OpReg({ 0x0F, 0xB6 }, kX64_RAX, kX64_RAX); // movzx eax, al
+        SetInt(Arg(pc, 1), kX64_RAX);
+        break;
+    case SCMD_NOTREG:
+        TestNull(Arg(pc, 1));
+        SetIntFromCond(Arg(pc, 1), kX64_CondE);
+        break;
+    case SCMD_CHECKBOUNDS:
+    {
+        const int32_t bound = Arg(pc, 2);
+        if (bound <= 0)
+        { // always fails
+            CallOp(_runOp, pc);
+            break;
+        }
+        LoadInt(kX64_RAX, Arg(pc, 1));
+        _e.OpReg({ 0x81 }, 7, kX64_RAX); // cmp eax, imm32 (unsigned, catches negative index)
+        _e.Dword(static_cast<uint32_t>(bound));
+        const size_t to_ok = _e.Jcc(kX64_CondB);
+        CallOp(_runOp, pc); // reports the error
+        _e.Bind(to_ok, _e.GetPos());
+        break;
+    }
+    case SCMD_JZ:
+    case SCMD_JNZ:
+        TestNull(SREG_AX);
+        JumpTo(_e.Jcc(op == SCMD_JZ ? kX64_CondE : kX64_CondNE), pc + 2 + Arg(pc, 1));
+        break;
+    case SCMD_JMP:
+    {
+        const int32_t target_pc = pc + 2 + Arg(pc, 1);
+        if (Arg(pc, 1) < 0)
+            CallOp(_loopCheck, target_pc); // make sure it's not stuck in a while loop
+        JumpTo(_e.Jmp(), target_pc);
+        break;
+    }
+    case SCMD_THISBASE:
+        // only affects the calls made by this function, and these are not compiled
+        break;
+    case SCMD_RET:
+        // return to the interpreter, which runs RET itself
+        _e.MovImm32(kX64_RAX, static_cast<uint32_t>(pc));
+        _retJumps.push_back(_e.Jmp());
+        break;
+    default:
+        CallOp(_runOp, pc);
+        break;
+    }
+}
+
+bool X64Compiler::Compile(int32_t start_pc, std::vector<uint8_t> &out_code)
+{
+    if (!_inst->code_ops || !FindInstructions(start_pc))
+        return false;
+
+    // Prologue
+    _e.Byte(0x53); // push rbx
+    _e.Bytes({ 0x41, 0x54 }); // push r12
+    _e.Bytes({ 0x48, 0x83, 0xEC, X64FrameSize }); // sub rsp, frame
+    _e.OpReg({ 0x89 }, X64Arg0, kX64_R12, true); // mov r12, arg0
+    _e.OpMem({ 0x8B }, kX64_RBX, kX64_R12, offsetof(ScriptJitContext, Registers), true);
+    if (_ops.front() != start_pc)
+        JumpTo(_e.Jmp(), start_pc);
+
+    // Function body; each instruction either jumps, or falls through to the next one
+    for (const auto pc : _ops)
+    {
+        _labels[pc] = _e.GetPos();
+        EmitInstruction(pc);
+    }
+
+    // Exit stub: leave with the position set by the executor
+    const size_t exit_at = _e.GetPos();
+    _e.OpMem({ 0x8B }, kX64_RAX, kX64_R12, offsetof(ScriptJitContext, ExitPc));
+    // Epilogue
+    const size_t epilogue_at = _e.GetPos();
+    _e.Bytes({ 0x48, 0x83, 0xC4, X64FrameSize }); // add rsp, frame
+    _e.Bytes({ 0x41, 0x5C }); // pop r12
+    _e.Byte(0x5B); // pop rbx
+    _e.Byte(0xC3); // ret
+
+    for (const auto &jump : _jumps)
+        _e.Bind(jump.first, _labels[jump.second]);
+    for (const auto disp_at : _exitJumps)
+        _e.Bind(disp_at, exit_at);
+    for (const auto disp_at : _retJumps)
+        _e.Bind(disp_at, epilogue_at);
+    out_code = std::move(_e.GetCode());
+    return true;
+}
+
+#endif // CC_JIT_X64
+
+
+ScriptJitCache::~ScriptJitCache()
+{
+#if (CC_JIT_X64)
+    for (auto &fn : _funcs)
+    {
+        if (fn.second.Code)
+            FreeExecMemory(fn.second.Code, fn.second.CodeSize);
+    }
+#endif
+}
+
+ScriptJitFunc ScriptJitCache::OnFunctionCall(const ccInstance *code_inst, int32_t pc,
+    ScriptJitOpFunc run_op, ScriptJitOpFunc loop_check)
+{
+#if (CC_JIT_X64)
+    Function &fn = _funcs[pc];
+    if (fn.Code)
+        return reinterpret_cast<ScriptJitFunc>(fn.Code);
+    if (fn.Failed || (++fn.Calls < ScriptJit::HotCallCount))
+        return nullptr;
+
+    std::vector<uint8_t> code;
+    X64Compiler compiler(code_inst, run_op, loop_check);
+    if (compiler.Compile(pc, code))
+        fn.Code = AllocExecMemory(code);
+    if (!fn.Code)
+    {
+        fn.Failed = true;
+        return nullptr;
+    }
+    fn.CodeSize = code.size();
+    Debug::Printf(kDbgGroup_Script, kDbgMsg_Debug, "Script function at %d in %s compiled to native code (%zu bytes)",
+        pc, code_inst->instanceof->GetSectionName(pc), code.size());
+    return reinterpret_cast<ScriptJitFunc>(fn.Code);
+#else
+    (void)code_inst; (void)pc; (void)run_op; (void)loop_check;
+    return nullptr;
+#endif
+}
+
+size_t ScriptJitCache::GetCompiledCount() const
+{
+    size_t count = 0u;
+    for (const auto &fn : _funcs)
+    {
+        if (fn.second.Code)
+            count++;
+    }
+    return count;
+}
+
+namespace ScriptJit
+{
+
+static bool JitEnabled = false;
+
+bool IsSupported()
+{
+    return CC_JIT_X64 != 0;
+}
+
+void SetEnabled(bool on)
+{
+    JitEnabled = on && IsSupported();
+}
+
+bool IsEnabled()
+{
+    return JitEnabled;
+}
+
+} // namespace ScriptJit
+
+} // namespace Engine
+} // namespace AGS
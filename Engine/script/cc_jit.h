@@ -0,0 +1,120 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Script function compiler ("JIT" tier).
+//
+// When enabled, the script executor counts the calls of each script function,
+// and once a function becomes "hot", translates it from the fixed up bytecode
+// into the native machine code, which is then run instead of interpreting it.
+// The native code works on the same registers and stack as the interpreter,
+// and returns to the interpreter at the function's RET instruction.
+//
+// Only the functions which do not call other functions, and only use the
+// supported subset of instructions (register math, comparisons, jumps, stack
+// and memory access), are compiled; any other function is left to the
+// interpreter. Register math and jumps are translated into the native code
+// directly, while the rest of instructions are run by calling back into the
+// executor. Backward jumps do the same loop checks as the interpreter.
+//
+// The native code generation is only implemented for x86-64; on other
+// platforms nothing is compiled. The compiled code is not used while the
+// script profiler or debugger is running.
+//
+//=============================================================================
+#ifndef __AGS_EE_SCRIPT__CCJIT_H
+#define __AGS_EE_SCRIPT__CCJIT_H
+
+#include <unordered_map>
+#include "core/types.h"
+
+struct ccInstance;
+struct RuntimeScriptValue;
+
+namespace AGS
+{
+namespace Engine
+{
+
+// Execution state shared by the interpreter and the native code
+struct ScriptJitContext
+{
+    ccInstance *Inst = nullptr;     // instance which registers and stack are used
+    ccInstance *CodeInst = nullptr; // instance which code is run
+    RuntimeScriptValue *Registers = nullptr;
+    int32_t *LineNumber = nullptr;  // instance's current line
+    int *CurrentLine = nullptr;     // global current line
+    // Loop check state of the interpreter
+    int LoopCheckDisabled = 0;
+    unsigned LoopIterations = 0u;
+    unsigned LoopCheckIterations = 0u;
+    unsigned TimeoutMs = 0u;
+    // Position at which the interpreter should continue, if the native code
+    // had to stop before reaching RET; -1 means that an error occured
+    int32_t ExitPc = -1;
+};
+
+// Compiled function; runs until the function's RET instruction and returns
+// its position, or returns ScriptJitContext::ExitPc if it had to stop earlier
+typedef int32_t (*ScriptJitFunc)(ScriptJitContext *ctx);
+
+// Callbacks into the executor, called by the native code;
+// return 0 to proceed, or non-zero to stop and leave the native code
+typedef int (*ScriptJitOpFunc)(ScriptJitContext *ctx, int32_t pc);
+
+// Counts calls of the script functions and keeps the compiled ones
+class ScriptJitCache
+{
+public:
+    ScriptJitCache() = default;
+    ~ScriptJitCache();
+
+    // Registers a call to the function starting at the given bytecode position;
+    // returns the compiled function, or null if it should be interpreted
+    ScriptJitFunc OnFunctionCall(const ccInstance *code_inst, int32_t pc,
+        ScriptJitOpFunc run_op, ScriptJitOpFunc loop_check);
+    // Returns the number of functions which were compiled
+    size_t GetCompiledCount() const;
+
+private:
+    ScriptJitCache(const ScriptJitCache&) = delete;
+    ScriptJitCache &operator=(const ScriptJitCache&) = delete;
+
+    struct Function
+    {
+        unsigned Calls = 0u;
+        bool     Failed = false; // cannot be compiled, don't try again
+        void    *Code = nullptr; // executable memory
+        size_t   CodeSize = 0u;
+    };
+
+    std::unordered_map<int32_t, Function> _funcs;
+};
+
+namespace ScriptJit
+{
+    // Number of calls after which the function is compiled
+    const unsigned HotCallCount = 16u;
+
+    // Tells if native code generation is implemented for this platform
+    bool IsSupported();
+    // Enables or disables the compiled code; has no effect if not supported
+    void SetEnabled(bool on);
+    // Tells if the compiled code is enabled
+    bool IsEnabled();
+}
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_SCRIPT__CCJIT_H
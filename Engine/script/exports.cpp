@@ -27,6 +27,7 @@ extern void RegisterDateTimeAPI();
 extern void RegisterDialogAPI();
 extern void RegisterDialogOptionsRenderingAPI();
 extern void RegisterDrawingSurfaceAPI(ScriptAPIVersion base_api, ScriptAPIVersion compat_api);
+extern void RegisterDynamicArrayAPI();
 extern void RegisterDynamicSpriteAPI();
 extern void RegisterFileAPI();
 extern void RegisterGameAPI();
@@ -49,6 +50,7 @@ extern void RegisterScreenAPI();
 extern void RegisterSliderAPI();
 extern void RegisterSpeechAPI(ScriptAPIVersion base_api, ScriptAPIVersion compat_api);
 extern void RegisterStringAPI();
+extern void RegisterStringBuilderAPI();
 extern void RegisterSystemAPI();
 extern void RegisterTextBoxAPI();
 extern void RegisterViewFrameAPI();
@@ -67,6 +69,7 @@ void setup_script_exports(ScriptAPIVersion base_api, ScriptAPIVersion compat_api
     RegisterDialogAPI();
     RegisterDialogOptionsRenderingAPI();
     RegisterDrawingSurfaceAPI(base_api, compat_api);
+    RegisterDynamicArrayAPI();
     RegisterDynamicSpriteAPI();
     RegisterFileAPI();
     RegisterGameAPI();
@@ -89,6 +92,7 @@ void setup_script_exports(ScriptAPIVersion base_api, ScriptAPIVersion compat_api
     RegisterSliderAPI();
     RegisterSpeechAPI(base_api, compat_api);
     RegisterStringAPI();
+    RegisterStringBuilderAPI();
     RegisterSystemAPI();
     RegisterTextBoxAPI();
     RegisterViewFrameAPI();
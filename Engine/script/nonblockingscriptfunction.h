@@ -19,6 +19,7 @@
 #define __AGS_EE_SCRIPT__NONBLOCKINGSCRIPTFUNCTION_H
 
 #include "ac/runtime_defines.h"
+#include "script/cc_instance.h"
 #include "script/runtimescriptvalue.h"
 
 #include <vector>
@@ -32,6 +33,10 @@ struct NonBlockingScriptFunction
     bool globalScriptHasFunction;
     std::vector<bool> moduleHasFunction;
     bool atLeastOneImplementationExists;
+    // Cached function references, resolved on the first run
+    ScriptFunctionRef roomFunction;
+    ScriptFunctionRef globalScriptFunction;
+    std::vector<ScriptFunctionRef> moduleFunction;
 
     NonBlockingScriptFunction(const char*funcName, int numParams)
     {
@@ -43,4 +48,18 @@ struct NonBlockingScriptFunction
     }
 };
 
+// Script callback run as a claimable event, in the room script and modules
+// first, then in the global script; caches the references to its functions
+struct ClaimableScriptEvent
+{
+    const char* functionName;
+    // Cached function references, resolved on the first run
+    ScriptFunctionRef roomFunction;
+    ScriptFunctionRef globalScriptFunction;
+    std::vector<ScriptFunctionRef> moduleFunction;
+
+    explicit ClaimableScriptEvent(const char *funcName)
+        : functionName(funcName) {}
+};
+
 #endif // __AGS_EE_SCRIPT__NONBLOCKINGSCRIPTFUNCTION_H
@@ -23,7 +23,22 @@
 #include "script/script_api.h"
 #include "util/memory.h"
 
+// Compact value layout flag:
+// when enabled, the value type and size are packed together into the first
+// 32 bits of RuntimeScriptValue, which reduces the struct from 32 to 24 bytes
+// on 64-bit systems (and from 20 to 16 bytes on 32-bit ones). This makes
+// script stack and registers smaller, and their copying cheaper.
+// The packed Size is 16-bit, which is sufficient since values never
+// reference more data than the size of the script's stack data.
+#ifndef CC_COMPACT_VALUES
+#define CC_COMPACT_VALUES 0
+#endif
+
+#if CC_COMPACT_VALUES
+enum ScriptValueType : uint8_t
+#else
 enum ScriptValueType
+#endif
 {
     kScValUndefined,    // to detect errors
     kScValInteger,      // as strictly 32-bit integer (for integer math)
@@ -69,6 +84,10 @@ public:
     }
 
     ScriptValueType Type;
+#if CC_COMPACT_VALUES
+    // The "real" size of data, see the explanation below
+    int16_t         Size;
+#endif
     // The 32-bit value used for integer/float math and for storing
     // variable/element offset relative to object (and array) address
     union
@@ -95,6 +114,7 @@ public:
         void             *MgrPtr; // generic object manager pointer
         IScriptObject    *ObjMgr; // script object manager
         CCStaticArray    *ArrMgr; // static array manager
+        void             *FastFn; // real API function, for the direct calls (see SetFastCall)
     };
     // The "real" size of data, either one stored in I/FValue,
     // or the one referenced by Ptr. Used for calculating stack
@@ -102,7 +122,9 @@ public:
     // Original AGS scripts always assumed pointer is 32-bit.
     // Therefore for stored pointers Size is always 4 both for x32
     // and x64 builds, so that the script is interpreted correctly.
+#if !CC_COMPACT_VALUES
     int             Size;
+#endif
 
     inline bool IsValid() const
     {
@@ -305,6 +327,15 @@ public:
         return *this;
     }
 
+    // Assigns the real function to call directly, for the API function value;
+    // the function's signature is stored in IValue
+    inline RuntimeScriptValue &SetFastCall(const ScriptAPIFastFn &fastfn)
+    {
+        IValue  = fastfn.Sig;
+        FastFn  = fastfn.Fn;
+        return *this;
+    }
+
     inline RuntimeScriptValue &SetCodePtr(void *ptr)
     {
         Type    = kScValCodePtr;
@@ -450,4 +481,9 @@ public:
     void *      GetDirectPtr() const;
 };
 
+#if CC_COMPACT_VALUES
+static_assert(sizeof(RuntimeScriptValue) == 8 + 2 * sizeof(void*),
+    "RuntimeScriptValue has unexpected size in compact layout");
+#endif
+
 #endif // __AGS_EE_SCRIPT__RUNTIMESCRIPTVALUE_H
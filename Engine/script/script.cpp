@@ -13,6 +13,7 @@
 //=============================================================================
 #include <stdio.h>
 #include <string.h>
+#include <algorithm>
 #include "script/script.h"
 #include "ac/common.h"
 #include "ac/character.h"
@@ -77,16 +78,32 @@ NonBlockingScriptFunction runDialogOptionTextInputHandlerFunc("dialog_options_te
 NonBlockingScriptFunction runDialogOptionRepExecFunc("dialog_options_repexec", 1);
 NonBlockingScriptFunction runDialogOptionCloseFunc("dialog_options_close", 1);
 
+// All the non-blocking functions, for the common setup and cleanup
+static NonBlockingScriptFunction *const nonBlockingFuncs[] = {
+    &repExecAlways, &lateRepExecAlways, &getDialogOptionsDimensionsFunc, &renderDialogOptionsFunc,
+    &getDialogOptionUnderCursorFunc, &runDialogOptionMouseClickHandlerFunc, &runDialogOptionKeyPressHandlerFunc,
+    &runDialogOptionTextInputHandlerFunc, &runDialogOptionRepExecFunc, &runDialogOptionCloseFunc
+};
+
 ScriptSystem scsystem;
 
 std::vector<PScript> scriptModules;
 std::vector<UInstance> moduleInst;
 std::vector<UInstance> moduleInstFork;
-std::vector<RuntimeScriptValue> moduleRepExecAddr;
+std::vector<ScriptFunctionRef> moduleRepExecFunction;
 size_t numScriptModules = 0;
+// The global script's rep-exec function
+static ScriptFunctionRef globalRepExecFunction;
+
+// The script callbacks run as claimable events
+static ClaimableScriptEvent claimableEvents[] = {
+    ClaimableScriptEvent("on_key_press"), ClaimableScriptEvent("on_mouse_click"),
+    ClaimableScriptEvent("on_text_input"), ClaimableScriptEvent("on_event")
+};
 
 
-static bool DoRunScriptFuncCantBlock(ccInstance *sci, NonBlockingScriptFunction* funcToRun, bool hasTheFunc);
+static bool DoRunScriptFuncCantBlock(ccInstance *sci, NonBlockingScriptFunction* funcToRun,
+    ScriptFunctionRef &func_ref, bool hasTheFunc);
 
 
 int run_dialog_request (int parmtr) {
@@ -123,18 +140,21 @@ void run_function_on_non_blocking_thread(NonBlockingScriptFunction* funcToRun) {
     // run modules
     // modules need a forkedinst for this to work
     for (size_t i = 0; i < numScriptModules; ++i) {
-        funcToRun->moduleHasFunction[i] = DoRunScriptFuncCantBlock(moduleInstFork[i].get(), funcToRun, funcToRun->moduleHasFunction[i]);
+        funcToRun->moduleHasFunction[i] = DoRunScriptFuncCantBlock(moduleInstFork[i].get(), funcToRun,
+            funcToRun->moduleFunction[i], funcToRun->moduleHasFunction[i]);
 
         if (room_changes_was != play.room_changes)
             return;
     }
 
-    funcToRun->globalScriptHasFunction = DoRunScriptFuncCantBlock(gameinstFork.get(), funcToRun, funcToRun->globalScriptHasFunction);
+    funcToRun->globalScriptHasFunction = DoRunScriptFuncCantBlock(gameinstFork.get(), funcToRun,
+        funcToRun->globalScriptFunction, funcToRun->globalScriptHasFunction);
 
     if (room_changes_was != play.room_changes)
         return;
 
-    funcToRun->roomHasFunction = DoRunScriptFuncCantBlock(roominstFork.get(), funcToRun, funcToRun->roomHasFunction);
+    funcToRun->roomHasFunction = DoRunScriptFuncCantBlock(roominstFork.get(), funcToRun,
+        funcToRun->roomFunction, funcToRun->roomHasFunction);
 }
 
 int run_interaction_event(const ObjectEvent &obj_evt, Interaction *nint, int evnt, int chkAny, bool isInv) {
@@ -274,13 +294,14 @@ int create_global_script() {
             return kscript_create_error;
 
         moduleInstFork[module_idx].reset(fork);
-        moduleRepExecAddr[module_idx] = moduleInst[module_idx]->GetSymbolAddress(REP_EXEC_NAME);
     }
 
     gameinstFork.reset(gameinst->Fork());
     if (gameinstFork == nullptr)
         return kscript_create_error;
 
+    ResolveGlobalScriptCallbacks();
+
     ccSetOption(SCOPT_AUTOIMPORT, 0);
     return 0;
 }
@@ -324,13 +345,20 @@ void QueueScriptFunction(ScriptInstType sc_inst, const char *fn_name, size_t par
         RunScriptFunctionAuto(sc_inst, fn_name, param_count, params);
 }
 
-static bool DoRunScriptFuncCantBlock(ccInstance *sci, NonBlockingScriptFunction* funcToRun, bool hasTheFunc)
+static bool DoRunScriptFuncCantBlock(ccInstance *sci, NonBlockingScriptFunction* funcToRun,
+    ScriptFunctionRef &func_ref, bool hasTheFunc)
 {
     if (!hasTheFunc)
         return(false);
 
+    // Resolve the function once per script, and use the cached reference after
+    if (!func_ref.IsResolvedFor(sci->instanceof.get()))
+        func_ref = sci->GetScriptFunction(funcToRun->functionName);
+    if (!func_ref.IsValid())
+        return(false); // the function doesn't exist, so don't try and run it again
+
     no_blocking_functions++;
-    int result = sci->CallScriptFunction(funcToRun->functionName, funcToRun->numParameters, funcToRun->params);
+    int result = sci->CallScriptFunction(func_ref, funcToRun->numParameters, funcToRun->params);
 
     if (result == -2) {
         // the function doens't exist, so don't try and run it again
@@ -350,12 +378,12 @@ static bool DoRunScriptFuncCantBlock(ccInstance *sci, NonBlockingScriptFunction*
 }
 
 char scfunctionname[MAX_FUNCTION_NAME_LEN + 1]; // FIXME this!!
-static int PrepareTextScript(ccInstance *sci, const char**tsname)
+static int PrepareTextScript(ccInstance *sci, const ScriptFunctionRef &func_ref, const char**tsname)
 {
     cc_clear_error();
     // FIXME: try to make it so this function is not called with NULL sci
     if (sci == nullptr) return -1;
-    if (sci->GetSymbolAddress(tsname[0]).IsNull()) {
+    if (!func_ref.IsValid()) {
         cc_error("no such function in script");
         return -2;
     }
@@ -389,6 +417,13 @@ static int PrepareTextScript(ccInstance *sci, const char**tsname)
 }
 
 int RunScriptFunction(ccInstance *sci, const char *tsname, size_t numParam, const RuntimeScriptValue *params)
+{
+    const ScriptFunctionRef func_ref = sci ? sci->GetScriptFunction(tsname) : ScriptFunctionRef();
+    return RunScriptFunction(sci, func_ref, tsname, numParam, params);
+}
+
+int RunScriptFunction(ccInstance *sci, const ScriptFunctionRef &func_ref, const char *tsname,
+    size_t numParam, const RuntimeScriptValue *params)
 {
     int oldRestoreCount = gameHasBeenRestored;
     // TODO: research why this is really necessary, and refactor to avoid such hacks!
@@ -401,14 +436,14 @@ int RunScriptFunction(ccInstance *sci, const char *tsname, size_t numParam, cons
     ScriptError cachedCcError = cc_get_error();
 
     cc_clear_error();
-    int toret = PrepareTextScript(sci, &tsname);
+    int toret = PrepareTextScript(sci, func_ref, &tsname);
     if (toret) {
         cc_error(cachedCcError);
         return -18;
     }
 
     cc_clear_error();
-    toret = curscript->Inst->CallScriptFunction(tsname, numParam, params);
+    toret = curscript->Inst->CallScriptFunction(func_ref, numParam, params);
 
     // 100 is if Aborted (eg. because we are LoadAGSGame'ing)
     if ((toret != 0) && (toret != -2) && (toret != 100)) {
@@ -462,25 +497,27 @@ static int RunUnclaimableEvent(const char *tsname)
     const int restore_game_count_was = gameHasBeenRestored;
     for (size_t i = 0; i < numScriptModules; ++i)
     {
-        if (!moduleRepExecAddr[i].IsNull())
-            RunScriptFunction(moduleInst[i].get(), tsname);
+        if (moduleRepExecFunction[i].IsValid())
+            RunScriptFunction(moduleInst[i].get(), moduleRepExecFunction[i], tsname);
         // Break on room change or save restoration
         if ((room_changes_was != play.room_changes) ||
             (restore_game_count_was != gameHasBeenRestored))
             return 0;
     }
-    return RunScriptFunction(gameinst.get(), tsname);
+    return RunScriptFunction(gameinst.get(), globalRepExecFunction, tsname);
 }
 
-static int RunClaimableEvent(const char *tsname, size_t param_count, const RuntimeScriptValue *params)
+static int RunClaimableEvent(ClaimableScriptEvent &evt, size_t param_count, const RuntimeScriptValue *params)
 {
     // Run claimable event chain in script modules and room script
     bool eventWasClaimed;
-    int toret = run_claimable_event(tsname, true, param_count, params, &eventWasClaimed);
+    int toret = run_claimable_event(evt, true, param_count, params, &eventWasClaimed);
     // Break on event claim
     if (eventWasClaimed)
         return toret;
-    return RunScriptFunction(gameinst.get(), tsname, param_count, params);
+    ccInstance *sci = gameinst.get();
+    return RunScriptFunction(sci, ResolveScriptFunction(sci, evt.functionName, evt.globalScriptFunction),
+        evt.functionName, param_count, params);
 }
 
 int RunScriptFunctionAuto(ScriptInstType sc_inst, const char *tsname, size_t param_count, const RuntimeScriptValue *params)
@@ -496,10 +533,10 @@ int RunScriptFunctionAuto(ScriptInstType sc_inst, const char *tsname, size_t par
     }
     // Claimable event is run in all the script modules and room script,
     // before running in the globalscript instance
-    if ((strcmp(tsname, tsnames[kTS_KeyPress]) == 0) || (strcmp(tsname, tsnames[kTS_MouseClick]) == 0) ||
-        (strcmp(tsname, tsnames[kTS_TextInput]) == 0) || (strcmp(tsname, "on_event") == 0))
+    for (auto &evt : claimableEvents)
     {
-        return RunClaimableEvent(tsname, param_count, params);
+        if (strcmp(tsname, evt.functionName) == 0)
+            return RunClaimableEvent(evt, param_count, params);
     }
     // Else run on the single chosen script instance
     ccInstance *sci = GetScriptInstanceByType(sc_inst);
@@ -513,27 +550,67 @@ void AllocScriptModules()
     // NOTE: this preallocation possibly required to safeguard some algorithms
     moduleInst.resize(numScriptModules);
     moduleInstFork.resize(numScriptModules);
-    moduleRepExecAddr.resize(numScriptModules);
-    repExecAlways.moduleHasFunction.resize(numScriptModules, true);
-    lateRepExecAlways.moduleHasFunction.resize(numScriptModules, true);
-    getDialogOptionsDimensionsFunc.moduleHasFunction.resize(numScriptModules, true);
-    renderDialogOptionsFunc.moduleHasFunction.resize(numScriptModules, true);
-    getDialogOptionUnderCursorFunc.moduleHasFunction.resize(numScriptModules, true);
-    runDialogOptionMouseClickHandlerFunc.moduleHasFunction.resize(numScriptModules, true);
-    runDialogOptionKeyPressHandlerFunc.moduleHasFunction.resize(numScriptModules, true);
-    runDialogOptionTextInputHandlerFunc.moduleHasFunction.resize(numScriptModules, true);
-    runDialogOptionRepExecFunc.moduleHasFunction.resize(numScriptModules, true);
-    runDialogOptionCloseFunc.moduleHasFunction.resize(numScriptModules, true);
-    for (auto &val : moduleRepExecAddr)
+    moduleRepExecFunction.assign(numScriptModules, ScriptFunctionRef());
+    for (auto *func : nonBlockingFuncs)
+    {
+        func->moduleHasFunction.resize(numScriptModules, true);
+        func->moduleFunction.resize(numScriptModules);
+    }
+    for (auto &evt : claimableEvents)
+    {
+        evt.globalScriptFunction.Reset();
+        evt.moduleFunction.assign(numScriptModules, ScriptFunctionRef());
+    }
+}
+
+void ResolveGlobalScriptCallbacks()
+{
+    for (size_t i = 0; i < numScriptModules; ++i)
+    {
+        ccInstance *inst = moduleInst[i].get();
+        moduleRepExecFunction[i] = inst->GetScriptFunction(REP_EXEC_NAME);
+        for (auto *func : nonBlockingFuncs)
+        {
+            func->moduleFunction[i] = inst->GetScriptFunction(func->functionName);
+            func->moduleHasFunction[i] = func->moduleFunction[i].IsValid();
+        }
+        for (auto &evt : claimableEvents)
+            evt.moduleFunction[i] = inst->GetScriptFunction(evt.functionName);
+    }
+
+    globalRepExecFunction = gameinst->GetScriptFunction(REP_EXEC_NAME);
+    for (auto *func : nonBlockingFuncs)
     {
-        val.Invalidate();
+        func->globalScriptFunction = gameinst->GetScriptFunction(func->functionName);
+        func->globalScriptHasFunction = func->globalScriptFunction.IsValid();
     }
+    for (auto &evt : claimableEvents)
+        evt.globalScriptFunction = gameinst->GetScriptFunction(evt.functionName);
+}
+
+void ResolveRoomScriptCallbacks()
+{
+    for (auto *func : nonBlockingFuncs)
+    {
+        func->roomFunction = roominst->GetScriptFunction(func->functionName);
+        func->roomHasFunction = func->roomFunction.IsValid();
+    }
+    for (auto &evt : claimableEvents)
+        evt.roomFunction = roominst->GetScriptFunction(evt.functionName);
+}
+
+const ScriptFunctionRef &ResolveScriptFunction(ccInstance *sci, const char *fn_name, ScriptFunctionRef &func_ref)
+{
+    if (sci && !func_ref.IsResolvedFor(sci->instanceof.get()))
+        func_ref = sci->GetScriptFunction(fn_name);
+    return func_ref;
 }
 
 void FreeAllScriptInstances()
 {
     ccInstance::FreeInstanceStack();
     FreeRoomScriptInstance();
+    FreeCachedRoomScriptInstances();
 
     // NOTE: don't know why, but Forks must be deleted prior to primary inst,
     // or bad things will happen; TODO: investigate and make this less fragile
@@ -550,6 +627,108 @@ void FreeRoomScriptInstance()
     // or bad things will happen; TODO: investigate and make this less fragile
     roominstFork.reset();
     roominst.reset();
+    // Room script is gone, so are any cached references to its functions
+    for (auto *func : nonBlockingFuncs)
+        func->roomFunction.Reset();
+    for (auto &evt : claimableEvents)
+        evt.roomFunction.Reset();
+}
+
+// Room script instance of the recently visited room
+struct CachedRoomScript
+{
+    int RoomNum = -1;
+    // NOTE: the members are destroyed in reverse order, so the Fork is deleted
+    // prior to primary inst, same as in FreeRoomScriptInstance()
+    UInstance Inst;
+    UInstance Fork;
+};
+
+// Max number of the cached room script instances
+static const size_t RoomScriptCacheSize = 4;
+// Cached room script instances, the most recently used first
+static std::vector<CachedRoomScript> cachedRoomScripts;
+
+void CacheRoomScriptInstance(int room_num)
+{
+    if (!roominst || !roominstFork || roominst->IsBeingRun() || roominstFork->IsBeingRun())
+    {
+        FreeRoomScriptInstance();
+        return;
+    }
+
+    // The instance must not be found by its exports while it's not in use
+    roominst->UnregisterExports();
+    CachedRoomScript entry;
+    entry.RoomNum = room_num;
+    entry.Inst = std::move(roominst);
+    entry.Fork = std::move(roominstFork);
+    FreeRoomScriptInstance(); // resets the cached function references
+    cachedRoomScripts.insert(cachedRoomScripts.begin(), std::move(entry));
+    if (cachedRoomScripts.size() > RoomScriptCacheSize)
+        cachedRoomScripts.pop_back();
+}
+
+// Tells if the two lists of the script's symbol names are the same
+static bool IsSameNameList(char **names1, char **names2, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        if ((names1[i] != names2[i]) &&
+            (!names1[i] || !names2[i] || (strcmp(names1[i], names2[i]) != 0)))
+            return false;
+    }
+    return true;
+}
+
+// Tells if the two scripts have the same code, data and linkage
+static bool IsSameScript(const ccScript *s1, const ccScript *s2)
+{
+    if ((s1->codesize != s2->codesize) ||
+        (s1->globaldatasize != s2->globaldatasize) ||
+        (s1->stringssize != s2->stringssize) ||
+        (s1->numfixups != s2->numfixups) ||
+        (s1->numimports != s2->numimports) ||
+        (s1->numexports != s2->numexports))
+        return false;
+    return
+        ((s1->codesize == 0) || (memcmp(s1->code, s2->code, s1->codesize * sizeof(int32_t)) == 0)) &&
+        ((s1->globaldatasize == 0) || (memcmp(s1->globaldata, s2->globaldata, s1->globaldatasize) == 0)) &&
+        ((s1->stringssize == 0) || (memcmp(s1->strings, s2->strings, s1->stringssize) == 0)) &&
+        ((s1->numfixups == 0) || ((memcmp(s1->fixuptypes, s2->fixuptypes, s1->numfixups) == 0) &&
+            (memcmp(s1->fixups, s2->fixups, s1->numfixups * sizeof(int32_t)) == 0))) &&
+        ((s1->numexports == 0) ||
+            (memcmp(s1->export_addr, s2->export_addr, s1->numexports * sizeof(int32_t)) == 0)) &&
+        IsSameNameList(s1->exports, s2->exports, s1->numexports) &&
+        IsSameNameList(s1->imports, s2->imports, s1->numimports);
+}
+
+bool RestoreCachedRoomScriptInstance(int room_num, const ccScript *script)
+{
+    auto it = std::find_if(cachedRoomScripts.begin(), cachedRoomScripts.end(),
+        [room_num](const CachedRoomScript &e) { return e.RoomNum == room_num; });
+    if (it == cachedRoomScripts.end())
+        return false;
+    CachedRoomScript entry = std::move(*it);
+    cachedRoomScripts.erase(it);
+
+    // Don't use the cached instance if the room's script is not the same;
+    // the script is reloaded each time along with the room
+    if (!IsSameScript(entry.Inst->instanceof.get(), script))
+        return false;
+    if (!entry.Inst->RegisterExports())
+        return false;
+
+    roominst = std::move(entry.Inst);
+    roominstFork = std::move(entry.Fork);
+    roominst->ResetGlobalData();
+    ResolveRoomScriptCallbacks();
+    return true;
+}
+
+void FreeCachedRoomScriptInstances()
+{
+    cachedRoomScripts.clear();
 }
 
 void FreeGlobalScripts()
@@ -560,16 +739,19 @@ void FreeGlobalScripts()
     scriptModules.clear();
     dialogScriptsScript.reset();
 
-    repExecAlways.moduleHasFunction.clear();
-    lateRepExecAlways.moduleHasFunction.clear();
-    getDialogOptionsDimensionsFunc.moduleHasFunction.clear();
-    renderDialogOptionsFunc.moduleHasFunction.clear();
-    getDialogOptionUnderCursorFunc.moduleHasFunction.clear();
-    runDialogOptionMouseClickHandlerFunc.moduleHasFunction.clear();
-    runDialogOptionKeyPressHandlerFunc.moduleHasFunction.clear();
-    runDialogOptionTextInputHandlerFunc.moduleHasFunction.clear();
-    runDialogOptionRepExecFunc.moduleHasFunction.clear();
-    runDialogOptionCloseFunc.moduleHasFunction.clear();
+    for (auto *func : nonBlockingFuncs)
+    {
+        func->moduleHasFunction.clear();
+        func->moduleFunction.clear();
+        func->globalScriptFunction.Reset();
+    }
+    moduleRepExecFunction.clear();
+    globalRepExecFunction.Reset();
+    for (auto &evt : claimableEvents)
+    {
+        evt.moduleFunction.clear();
+        evt.globalScriptFunction.Reset();
+    }
 }
 
 String GetScriptName(ccInstance *sci)
@@ -85,6 +85,19 @@ void    QueueScriptFunction(ScriptInstType sc_inst, const char *fn_name, size_t
 // Try to run a script function on a given script instance
 int     RunScriptFunction(ccInstance *sci, const char *tsname, size_t param_count = 0,
     const RuntimeScriptValue *params = nullptr);
+// Try to run a script function on a given script instance, using the function
+// reference resolved beforehand instead of looking the function up by name
+int     RunScriptFunction(ccInstance *sci, const ScriptFunctionRef &func_ref, const char *tsname,
+    size_t param_count = 0, const RuntimeScriptValue *params = nullptr);
+// Resolves which of the standard script callbacks are implemented by the
+// global script and each module, so that the engine only runs those
+void    ResolveGlobalScriptCallbacks();
+// Resolves which of the standard script callbacks are implemented by the
+// current room script
+void    ResolveRoomScriptCallbacks();
+// Resolves the script function reference if it was not resolved for this
+// instance's script yet, and returns the cached reference
+const ScriptFunctionRef &ResolveScriptFunction(ccInstance *sci, const char *fn_name, ScriptFunctionRef &func_ref);
 // Run a script function in all the regular script modules, in order, where available
 // includes globalscript, but not the current room script.
 void    RunScriptFunctionInModules(const char *tsname, size_t param_count = 0,
@@ -103,6 +116,16 @@ void    AllocScriptModules();
 void    FreeAllScriptInstances();
 // Delete only the current room script instance
 void    FreeRoomScriptInstance();
+// Moves the current room script instance into the cache of recently visited
+// rooms, from which it may be taken when the player enters the same room again
+void    CacheRoomScriptInstance(int room_num);
+// Takes the cached room script instance and makes it the current one,
+// with its global data reset; the given script is the one which would be
+// used otherwise, for the validation. Returns false if there's no valid
+// cached instance for this room.
+bool    RestoreCachedRoomScriptInstance(int room_num, const ccScript *script);
+// Delete all the cached room script instances
+void    FreeCachedRoomScriptInstances();
 // Deletes all the global scripts and modules;
 // this frees all of the bytecode and runtime script memory.
 void    FreeGlobalScripts();
@@ -171,7 +194,7 @@ extern NonBlockingScriptFunction runDialogOptionCloseFunc;
 extern std::vector<PScript> scriptModules;
 extern std::vector<UInstance> moduleInst;
 extern std::vector<UInstance> moduleInstFork;
-extern std::vector<RuntimeScriptValue> moduleRepExecAddr;
+extern std::vector<ScriptFunctionRef> moduleRepExecFunction;
 extern size_t numScriptModules;
 
 #endif // __AGS_EE_SCRIPT__SCRIPT_H
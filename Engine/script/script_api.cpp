@@ -13,6 +13,7 @@
 //=============================================================================
 #include <stdio.h>
 #include <string.h>
+#include <algorithm>
 #include <allegro.h>
 #include "ac/game_version.h"
 #include "script/cc_common.h"
@@ -62,10 +63,41 @@ inline const char *GetArgPtr(const RuntimeScriptValue *sc_args, va_list *varg_pt
         return reinterpret_cast<const char*>(sc_args[arg_idx].Ptr);
 }
 
+// Writes a decimal integer into the output, up to the given number of chars;
+// returns the full length of the number, same as snprintf would do
+static int WriteDecimalInt(char *out, ptrdiff_t avail, int value)
+{
+    char digits[12];
+    char *const end = digits + sizeof(digits);
+    char *ptr = end;
+    uint32_t uvalue = value < 0 ? 0u - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+    do
+    {
+        *(--ptr) = static_cast<char>('0' + uvalue % 10);
+        uvalue /= 10;
+    }
+    while (uvalue);
+    if (value < 0)
+        *(--ptr) = '-';
+    const ptrdiff_t len = end - ptr;
+    memcpy(out, ptr, std::min(len, avail));
+    return static_cast<int>(len);
+}
+
+// Copies a string into the output, up to the given number of chars;
+// returns the number of copied chars
+static int WriteString(char *out, ptrdiff_t avail, const char *str)
+{
+    char *out_ptr = out;
+    for (const char *out_end = out + avail; *str && out_ptr != out_end; ++out_ptr, ++str)
+        *out_ptr = *str;
+    return static_cast<int>(out_ptr - out);
+}
 
-// TODO: this implementation can be further optimised by either not calling
-// snprintf but formatting values ourselves, or by using some library method
-// that supports customizing, such as getting arguments in a custom way.
+// TODO: this implementation can be further optimised by using some library
+// method that supports customizing, such as getting arguments in a custom way.
+// The plain placeholders without flags, width and precision are formatted
+// here directly, the rest are passed to snprintf.
 const char *ScriptSprintf(char *buffer, size_t buf_length, const char *format,
                           const RuntimeScriptValue *sc_args, int32_t sc_argc, va_list *varg_ptr)
 {
@@ -187,10 +219,15 @@ const char *ScriptSprintf(char *buffer, size_t buf_length, const char *format,
                 // NOTE: snprintf is called with avail_outbuf + 1 here, because we let it use our reserved
                 // character for null-terminator, in case we are at the end of the buffer
                 *fmt_bufptr = 0; // terminate the format buffer, we are going to use it
+                const bool plain_fmt = (fmt_bufptr - fmtbuf == 2);
                 switch (fmt_done)
                 {
                 case kFormatParseArgInteger:
-                    snprintf_res = snprintf(out_ptr, avail_outbuf + 1, fmtbuf, GetArgInt(sc_args, varg_ptr, arg_idx)); break;
+                    if (plain_fmt && (fmtbuf[1] == 'd' || fmtbuf[1] == 'i'))
+                        snprintf_res = WriteDecimalInt(out_ptr, avail_outbuf, GetArgInt(sc_args, varg_ptr, arg_idx));
+                    else
+                        snprintf_res = snprintf(out_ptr, avail_outbuf + 1, fmtbuf, GetArgInt(sc_args, varg_ptr, arg_idx));
+                    break;
                 case kFormatParseArgFloat:
                     snprintf_res = snprintf(out_ptr, avail_outbuf + 1, fmtbuf, GetArgFloat(sc_args, varg_ptr, arg_idx)); break;
                 case kFormatParseArgCharacter:
@@ -198,7 +235,7 @@ const char *ScriptSprintf(char *buffer, size_t buf_length, const char *format,
                     int chr = GetArgInt(sc_args, varg_ptr, arg_idx);
                     char cbuf[5]{};
                     usetc(cbuf, chr);
-                    snprintf_res = snprintf(out_ptr, avail_outbuf + 1, "%s", cbuf);
+                    snprintf_res = WriteString(out_ptr, avail_outbuf, cbuf);
                     break;
                 }
                 case kFormatParseArgString:
@@ -223,7 +260,10 @@ const char *ScriptSprintf(char *buffer, size_t buf_length, const char *format,
                         cc_error("!ScriptSprintf: formatting argument %d is a pointer to output buffer", arg_idx + 1);
                         return "";
                     }
-                    snprintf_res = snprintf(out_ptr, avail_outbuf + 1, fmtbuf, p);
+                    if (plain_fmt)
+                        snprintf_res = WriteString(out_ptr, avail_outbuf, p);
+                    else
+                        snprintf_res = snprintf(out_ptr, avail_outbuf + 1, fmtbuf, p);
                     break;
                 }
                 case kFormatParseArgPointer:
@@ -30,6 +30,47 @@ struct RuntimeScriptValue;
 typedef RuntimeScriptValue ScriptAPIFunction(const RuntimeScriptValue *params, int32_t param_count);
 typedef RuntimeScriptValue ScriptAPIObjectFunction(void *self, const RuntimeScriptValue *params, int32_t param_count);
 
+// Signatures of the API functions, which may be called by the script executor
+// directly, with the arguments unpacked, bypassing the "translator" function.
+enum ScriptAPIFastCall
+{
+    kScFastCall_None = 0,
+    kScFastCall_Int,            // int FUNCTION()
+    kScFastCall_Int_PInt,       // int FUNCTION(int)
+    kScFastCall_Void_PInt,      // void FUNCTION(int)
+    kScFastCall_ObjInt,         // int METHOD(CLASS *self)
+    kScFastCall_ObjBool,        // bool METHOD(CLASS *self)
+    kScFastCall_ObjVoid_PInt,   // void METHOD(CLASS *self, int)
+    kScFastCall_ObjVoid_PBool,  // void METHOD(CLASS *self, bool)
+};
+
+// The real API function's pointer, with its signature deduced from the type
+struct ScriptAPIFastFn
+{
+    ScriptAPIFastCall Sig = kScFastCall_None;
+    void *Fn = nullptr;
+
+    ScriptAPIFastFn() = default;
+    ScriptAPIFastFn(int (*fn)())
+        : Sig(kScFastCall_Int), Fn(reinterpret_cast<void*>(fn)) {}
+    ScriptAPIFastFn(int (*fn)(int))
+        : Sig(kScFastCall_Int_PInt), Fn(reinterpret_cast<void*>(fn)) {}
+    ScriptAPIFastFn(void (*fn)(int))
+        : Sig(kScFastCall_Void_PInt), Fn(reinterpret_cast<void*>(fn)) {}
+    template <typename TSelf>
+    ScriptAPIFastFn(int (*fn)(TSelf*))
+        : Sig(kScFastCall_ObjInt), Fn(reinterpret_cast<void*>(fn)) {}
+    template <typename TSelf>
+    ScriptAPIFastFn(bool (*fn)(TSelf*))
+        : Sig(kScFastCall_ObjBool), Fn(reinterpret_cast<void*>(fn)) {}
+    template <typename TSelf>
+    ScriptAPIFastFn(void (*fn)(TSelf*, int))
+        : Sig(kScFastCall_ObjVoid_PInt), Fn(reinterpret_cast<void*>(fn)) {}
+    template <typename TSelf>
+    ScriptAPIFastFn(void (*fn)(TSelf*, bool))
+        : Sig(kScFastCall_ObjVoid_PBool), Fn(reinterpret_cast<void*>(fn)) {}
+};
+
 // Sprintf that takes either script values or common argument list from plugin.
 // Uses EITHER sc_args/sc_argc or varg_ptr as parameter list, whichever is not
 // NULL, with varg_ptr having HIGHER priority.
@@ -51,6 +92,10 @@ inline const char *ScriptVSprintf(char *buffer, size_t buf_length, const char *f
 // for the common case where they have similar names: the script's "translator"
 // function's name is derived from the real one by adding a "Sc_" prefix.
 #define API_FN_PAIR(FN_NAME) Sc_##FN_NAME, (void*)FN_NAME
+// Same as API_FN_PAIR, but also lets the script executor call the real
+// function directly. Must only be used when the "translator" function does
+// nothing but unpacks the arguments and passes them to the real one.
+#define API_FN_FAST(FN_NAME) Sc_##FN_NAME, ScriptAPIFastFn(FN_NAME)
 
 // Helper macros for script functions;
 // asserting for internal mistakes; supressing "unused param" warnings
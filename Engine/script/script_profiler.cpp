@@ -0,0 +1,364 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "script/script_profiler.h"
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "ac/timer.h"
+#include "debug/out.h"
+#include "script/cc_instance.h"
+#include "script/cc_internal.h"
+#include "script/systemimports.h"
+#include "util/file.h"
+#include "util/string_types.h"
+#include "util/textstreamwriter.h"
+
+using namespace AGS::Common;
+
+extern std::deque<ccInstance*> InstThreads;
+
+namespace AGS
+{
+namespace Engine
+{
+namespace ScriptProfiler
+{
+
+uint64_t InstructionCount = 0u;
+
+// Accumulated cost of a single script line
+struct LineCost
+{
+    String   Section;
+    String   Function;
+    int32_t  Line = 0;
+    AGS_Clock::duration Time = AGS_Clock::duration::zero();
+    uint64_t Instructions = 0u;
+};
+
+// Function lookup for the profiled script
+struct ScriptInfo
+{
+    // Keep the script referenced, so that its address (used as a key)
+    // is not reused by any other script while profiling
+    PScript Script;
+    // Function names, sorted by the function's code offset
+    std::vector<std::pair<int32_t, String>> Functions;
+};
+
+// Accumulated cost of the engine API function called by scripts
+struct ApiCallCost
+{
+    RuntimeScriptValue Function;
+    uint64_t Calls = 0u;
+    AGS_Clock::duration Time = AGS_Clock::duration::zero();
+};
+
+typedef std::pair<const char*, int32_t> LineKey; // section name ptr, line number
+typedef std::pair<const ccScript*, int32_t> FunctionKey; // script ptr, function start
+
+static bool Enabled = false;
+static String ReportPath;
+static AGS_Clock::duration SampleInterval;
+static std::unordered_map<const ccScript*, ScriptInfo> Scripts;
+static std::map<LineKey, LineCost> Lines;
+static std::map<FunctionKey, uint64_t> FunctionCalls;
+// Engine API calls, by the function's pointer
+static std::unordered_map<const void*, ApiCallCost> ApiCalls;
+// Collapsed call stacks and their total sampled time
+static std::unordered_map<String, AGS_Clock::duration> Stacks;
+// Currently executed line of each running script thread
+static std::vector<LineCost*> ThreadLines;
+static AGS_Clock::time_point LastTime;
+static AGS_Clock::time_point LastSampleTime;
+static uint64_t LastInstructionCount = 0u;
+
+
+static const ScriptInfo &GetScriptInfo(const PScript &script)
+{
+    auto it = Scripts.find(script.get());
+    if (it != Scripts.end())
+        return it->second;
+
+    ScriptInfo &info = Scripts[script.get()];
+    info.Script = script;
+    for (int i = 0; i < script->numexports; ++i)
+    {
+        const int32_t etype = (script->export_addr[i] >> 24L) & 0x000ff;
+        if (etype != EXPORT_FUNCTION)
+            continue;
+        const int32_t addr = script->export_addr[i] & 0x00ffffff;
+        info.Functions.push_back(std::make_pair(addr, String::FromFormat("%s::%s",
+            script->GetSectionName(addr), String(script->exports[i]).LeftSection('$').GetCStr())));
+    }
+    std::sort(info.Functions.begin(), info.Functions.end(),
+        [](const std::pair<int32_t, String> &a, const std::pair<int32_t, String> &b) { return a.first < b.first; });
+    return info;
+}
+
+static String GetFunctionName(const PScript &script, int32_t pc)
+{
+    const ScriptInfo &info = GetScriptInfo(script);
+    auto it = std::upper_bound(info.Functions.begin(), info.Functions.end(), pc,
+        [](int32_t at_pc, const std::pair<int32_t, String> &f) { return at_pc < f.first; });
+    if (it == info.Functions.begin())
+        return String::FromFormat("%s::(unknown)", script->GetSectionName(pc));
+    return (--it)->second;
+}
+
+static LineCost *GetLineCost(const ccInstance *inst)
+{
+    const PScript &script = inst->runningInst->instanceof;
+    const char *section = script->GetSectionName(inst->pc);
+    const LineKey key = std::make_pair(section, inst->line_number);
+    auto it = Lines.find(key);
+    if (it != Lines.end())
+        return &it->second;
+
+    LineCost &cost = Lines[key];
+    cost.Section = section;
+    cost.Line = inst->line_number;
+    cost.Function = GetFunctionName(script, inst->pc);
+    return &cost;
+}
+
+// Adds the time and instructions passed since the last update to the current line
+static void UpdateCurrentLine(const AGS_Clock::time_point &now)
+{
+    if (!ThreadLines.empty() && ThreadLines.back())
+    {
+        LineCost *cost = ThreadLines.back();
+        cost->Time += now - LastTime;
+        cost->Instructions += InstructionCount - LastInstructionCount;
+    }
+    LastTime = now;
+    LastInstructionCount = InstructionCount;
+}
+
+// Records the call stacks of all the script threads, starting with the oldest one
+static void SampleCallStack(const AGS_Clock::duration &weight)
+{
+    String stack;
+    for (const ccInstance *thread : InstThreads)
+    {
+        for (int i = 0; i < thread->callStackSize; ++i)
+        {
+            if (!stack.IsEmpty())
+                stack.AppendChar(';');
+            stack.Append(GetFunctionName(thread->callStackCodeInst[i]->instanceof, thread->callStackAddr[i]));
+        }
+        if (!stack.IsEmpty())
+            stack.AppendChar(';');
+        stack.Append(GetFunctionName(thread->runningInst->instanceof, thread->pc));
+    }
+    if (!stack.IsEmpty())
+        Stacks[stack] += weight;
+}
+
+static void WriteReports()
+{
+    using namespace std::chrono;
+
+    auto out = File::CreateFile(ReportPath);
+    if (!out)
+    {
+        Debug::Printf(kDbgMsg_Error, "Script profiler: failed to write report: %s", ReportPath.GetCStr());
+        return;
+    }
+    {
+        TextStreamWriter writer(std::move(out));
+        for (const auto &stack : Stacks)
+        {
+            writer.WriteFormat("%s %lld\n", stack.first.GetCStr(),
+                static_cast<long long>(duration_cast<microseconds>(stack.second).count()));
+        }
+    }
+
+    const String text_path = String::FromFormat("%s.txt", ReportPath.GetCStr());
+    out = File::CreateFile(text_path);
+    if (!out)
+    {
+        Debug::Printf(kDbgMsg_Error, "Script profiler: failed to write report: %s", text_path.GetCStr());
+        return;
+    }
+
+    std::vector<const LineCost*> lines;
+    std::map<String, LineCost> func_map;
+    for (const auto &line : Lines)
+    {
+        lines.push_back(&line.second);
+        LineCost &func = func_map[line.second.Function];
+        func.Function = line.second.Function;
+        func.Time += line.second.Time;
+        func.Instructions += line.second.Instructions;
+    }
+    std::vector<const LineCost*> funcs;
+    for (const auto &func : func_map)
+        funcs.push_back(&func.second);
+    const auto by_time = [](const LineCost *a, const LineCost *b) { return a->Time > b->Time; };
+    std::sort(funcs.begin(), funcs.end(), by_time);
+    std::sort(lines.begin(), lines.end(), by_time);
+
+    std::vector<std::pair<String, uint64_t>> calls;
+    for (const auto &call : FunctionCalls)
+    {
+        const PScript &script = Scripts[call.first.first].Script;
+        calls.push_back(std::make_pair(GetFunctionName(script, call.first.second), call.second));
+    }
+    std::sort(calls.begin(), calls.end(),
+        [](const std::pair<String, uint64_t> &a, const std::pair<String, uint64_t> &b) { return a.second > b.second; });
+
+    std::vector<const ApiCallCost*> api_calls;
+    for (const auto &api : ApiCalls)
+        api_calls.push_back(&api.second);
+    std::sort(api_calls.begin(), api_calls.end(),
+        [](const ApiCallCost *a, const ApiCallCost *b) { return a->Time > b->Time; });
+
+    TextStreamWriter writer(std::move(out));
+    writer.WriteLine("Functions:");
+    writer.WriteLine("time (us)\tinstructions\tfunction");
+    for (const auto *func : funcs)
+    {
+        writer.WriteFormat("%lld\t%llu\t%s\n",
+            static_cast<long long>(duration_cast<microseconds>(func->Time).count()),
+            static_cast<unsigned long long>(func->Instructions), func->Function.GetCStr());
+    }
+    writer.WriteLine("");
+    writer.WriteLine("Function calls:");
+    writer.WriteLine("calls\tfunction");
+    for (const auto &call : calls)
+    {
+        writer.WriteFormat("%llu\t%s\n", static_cast<unsigned long long>(call.second), call.first.GetCStr());
+    }
+    writer.WriteLine("");
+    writer.WriteLine("Engine API calls:");
+    writer.WriteLine("time (us)\tcalls\tfunction");
+    for (const auto *api : api_calls)
+    {
+        String name = simp.findName(api->Function);
+        if (name.IsEmpty())
+            name = simp_for_plugin.findName(api->Function);
+        if (name.IsEmpty())
+            name = String::FromFormat("(unknown %p)", api->Function.Ptr);
+        writer.WriteFormat("%lld\t%llu\t%s\n",
+            static_cast<long long>(duration_cast<microseconds>(api->Time).count()),
+            static_cast<unsigned long long>(api->Calls), name.GetCStr());
+    }
+    writer.WriteLine("");
+    writer.WriteLine("Lines:");
+    writer.WriteLine("time (us)\tinstructions\tsection:line\tfunction");
+    for (const auto *line : lines)
+    {
+        writer.WriteFormat("%lld\t%llu\t%s:%d\t%s\n",
+            static_cast<long long>(duration_cast<microseconds>(line->Time).count()),
+            static_cast<unsigned long long>(line->Instructions),
+            line->Section.GetCStr(), line->Line, line->Function.GetCStr());
+    }
+    Debug::Printf(kDbgMsg_Info, "Script profiler: reports written to %s and %s",
+        ReportPath.GetCStr(), text_path.GetCStr());
+}
+
+void Start(const String &report_path, unsigned sample_interval_ms)
+{
+    if (Enabled)
+        return;
+    ReportPath = report_path;
+    SampleInterval = std::chrono::milliseconds(sample_interval_ms);
+    InstructionCount = 0u;
+    LastInstructionCount = 0u;
+    LastTime = LastSampleTime = AGS_Clock::now();
+    Enabled = true;
+    Debug::Printf(kDbgMsg_Info, "Script profiler: started, sample interval %u ms", sample_interval_ms);
+}
+
+void Stop()
+{
+    if (!Enabled)
+        return;
+    UpdateCurrentLine(AGS_Clock::now());
+    if (!ReportPath.IsEmpty())
+        WriteReports();
+    Enabled = false;
+    ThreadLines.clear();
+    Stacks.clear();
+    Lines.clear();
+    FunctionCalls.clear();
+    ApiCalls.clear();
+    Scripts.clear();
+}
+
+bool IsEnabled()
+{
+    return Enabled;
+}
+
+void OnThreadEnter()
+{
+    if (!Enabled)
+        return;
+    const auto now = AGS_Clock::now();
+    UpdateCurrentLine(now);
+    // Don't count the time between the script runs
+    if (ThreadLines.empty())
+        LastSampleTime = now;
+    ThreadLines.push_back(nullptr);
+}
+
+void OnThreadLeave()
+{
+    if (!Enabled || ThreadLines.empty())
+        return;
+    UpdateCurrentLine(AGS_Clock::now());
+    ThreadLines.pop_back();
+}
+
+void OnLine(const ccInstance *inst)
+{
+    if (!Enabled || ThreadLines.empty())
+        return;
+    const auto now = AGS_Clock::now();
+    UpdateCurrentLine(now);
+    ThreadLines.back() = GetLineCost(inst);
+    if (now - LastSampleTime >= SampleInterval)
+    {
+        SampleCallStack(now - LastSampleTime);
+        LastSampleTime = now;
+    }
+}
+
+void OnFunctionCall(const ccInstance *inst)
+{
+    if (!Enabled)
+        return;
+    const PScript &script = inst->runningInst->instanceof;
+    // make sure that the script is referenced while it's used as a key
+    GetScriptInfo(script);
+    FunctionCalls[std::make_pair(script.get(), inst->pc)]++;
+}
+
+void OnApiCall(const RuntimeScriptValue &fn, AGS_Clock::duration time)
+{
+    if (!Enabled)
+        return;
+    ApiCallCost &cost = ApiCalls[fn.Ptr];
+    cost.Function = fn;
+    cost.Calls++;
+    cost.Time += time;
+}
+
+} // namespace ScriptProfiler
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,78 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Script profiler.
+//
+// When enabled, the profiler accumulates the wall-clock time and the number
+// of executed instructions for each script line, and also samples the script
+// call stacks with the given interval. On stop it writes two reports:
+// * collapsed call stacks, in a format accepted by the flame graph tools,
+//   where each stack is followed by its total time in microseconds;
+// * a text report with function and line costs, sorted by time, the
+//   list of functions sorted by the number of calls ("hot" functions), and
+//   the engine API functions called by scripts, sorted by their total time.
+//
+// The script executor notifies the profiler when a script thread starts or
+// ends, on each line change, on each function call and after each engine API
+// call. These notifications are only made while the profiler is enabled.
+//
+//=============================================================================
+#ifndef __AGS_EE_SCRIPT__SCRIPTPROFILER_H
+#define __AGS_EE_SCRIPT__SCRIPTPROFILER_H
+
+#include "core/types.h"
+#include "ac/timer.h"
+#include "util/string.h"
+
+struct ccInstance;
+struct RuntimeScriptValue;
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace ScriptProfiler
+{
+    // Starts profiling; the reports will be written using given path:
+    // collapsed stacks to the file itself, and text report to "<path>.txt";
+    // with the empty path no reports are written, which is useful for
+    // reading the InstructionCount only
+    void Start(const Common::String &report_path, unsigned sample_interval_ms);
+    // Stops profiling and writes the reports
+    void Stop();
+    // Tells if the profiler is enabled
+    bool IsEnabled();
+
+    // Notifies that the script thread is about to start execution
+    void OnThreadEnter();
+    // Notifies that the script thread has finished (or suspended) execution
+    void OnThreadLeave();
+    // Notifies that the thread instance has reached a new script line
+    void OnLine(const ccInstance *inst);
+    // Notifies that the thread instance has entered a script function
+    void OnFunctionCall(const ccInstance *inst);
+    // Notifies that the script has called the engine API function,
+    // and the time that the call took
+    void OnApiCall(const RuntimeScriptValue &fn, AGS_Clock::duration time);
+
+    // Total number of instructions executed while profiling;
+    // incremented by the script executor directly for performance reasons
+    extern uint64_t InstructionCount;
+}
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_SCRIPT__SCRIPTPROFILER_H
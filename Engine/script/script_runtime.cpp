@@ -34,6 +34,16 @@ bool ccAddExternalObjectFunction(const String &name, ScriptAPIObjectFunction *sc
         simp_for_plugin.add(name, RuntimeScriptValue().SetPluginFunction(dirfn), nullptr) != UINT32_MAX);
 }
 
+bool ccAddExternalStaticFunction(const String &name, ScriptAPIFunction *scfn, const ScriptAPIFastFn &fastfn)
+{
+    return ccAddExternalFunction(ScFnRegister(name.GetCStr(), scfn, fastfn));
+}
+
+bool ccAddExternalObjectFunction(const String &name, ScriptAPIObjectFunction *scfn, const ScriptAPIFastFn &fastfn)
+{
+    return ccAddExternalFunction(ScFnRegister(name.GetCStr(), scfn, fastfn));
+}
+
 bool ccAddExternalFunction(const ScFnRegister &scfnreg)
 {
     String name = String::Wrapper(scfnreg.Name);
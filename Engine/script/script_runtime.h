@@ -38,6 +38,14 @@ struct ScFnRegister
         : Name(name)
         , Fn(RuntimeScriptValue().SetObjectFunction(fn))
         , PlFn(RuntimeScriptValue().SetPluginFunction(plfn)) {}
+    ScFnRegister(const char *name, ScriptAPIFunction *fn, const ScriptAPIFastFn &fastfn)
+        : Name(name)
+        , Fn(RuntimeScriptValue().SetStaticFunction(fn).SetFastCall(fastfn))
+        , PlFn(RuntimeScriptValue().SetPluginFunction(fastfn.Fn)) {}
+    ScFnRegister(const char *name, ScriptAPIObjectFunction *fn, const ScriptAPIFastFn &fastfn)
+        : Name(name)
+        , Fn(RuntimeScriptValue().SetObjectFunction(fn).SetFastCall(fastfn))
+        , PlFn(RuntimeScriptValue().SetPluginFunction(fastfn.Fn)) {}
     template <typename TPlFn>
     ScFnRegister(const char *name, ScriptAPIFunction *fn, TPlFn plfn)
         : Name(name)
@@ -58,6 +66,10 @@ struct ScFnRegister
 bool ccAddExternalStaticFunction(const String &name, ScriptAPIFunction *scfn, void *dirfn = nullptr);
 bool ccAddExternalObjectFunction(const String &name, ScriptAPIObjectFunction *scfn, void *dirfn = nullptr);
 bool ccAddExternalFunction(const ScFnRegister &scfnreg);
+// Same as above, but also let script executor call the real function directly;
+// the real function is also registered for plugins.
+bool ccAddExternalStaticFunction(const String &name, ScriptAPIFunction *scfn, const ScriptAPIFastFn &fastfn);
+bool ccAddExternalObjectFunction(const String &name, ScriptAPIObjectFunction *scfn, const ScriptAPIFastFn &fastfn);
 // Register a function, exported from a plugin. Requires direct function pointer only.
 bool ccAddExternalPluginFunction(const String &name, void *pfn);
 // Register engine objects for script's access.
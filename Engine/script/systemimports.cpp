@@ -11,6 +11,7 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
 #include <stdlib.h>
 #include <string.h>
 #include "script/systemimports.h"
@@ -33,19 +34,18 @@ uint32_t SystemImports::add(const String &name, const RuntimeScriptValue &value,
         return ixof;
     }
 
-    ixof = imports.size();
-    for (size_t i = 0; i < imports.size(); ++i)
+    if (!free_slots.empty())
     {
-        if (imports[i].Name == nullptr)
-        {
-            ixof = i;
-            break;
-        }
+        ixof = free_slots.back();
+        free_slots.pop_back();
     }
-
-    btree[name] = ixof;
-    if (ixof == imports.size())
+    else
+    {
+        ixof = imports.size();
         imports.push_back(ScriptImport());
+    }
+
+    add_index(name, ixof);
     imports[ixof].Name          = name;
     imports[ixof].Value         = value;
     imports[ixof].InstancePtr   = anotherscr;
@@ -57,10 +57,11 @@ void SystemImports::remove(const String &name)
     uint32_t idx = get_index_of(name);
     if (idx == UINT32_MAX)
         return;
-    btree.erase(imports[idx].Name);
+    remove_index(imports[idx].Name, idx);
     imports[idx].Name = nullptr;
     imports[idx].Value.Invalidate();
     imports[idx].InstancePtr = nullptr;
+    free_slots.push_back(idx);
 }
 
 const ScriptImport *SystemImports::getByName(const String &name)
@@ -72,26 +73,25 @@ const ScriptImport *SystemImports::getByName(const String &name)
     return &imports[o];
 }
 
-const ScriptImport *SystemImports::getByIndex(uint32_t index)
+const ScriptImport *SystemImports::getByIndex(uint32_t idx)
 {
-    if (index >= imports.size())
+    if (idx >= imports.size())
         return nullptr;
 
-    return &imports[index];
+    return &imports[idx];
 }
 
 uint32_t SystemImports::get_index_of(const String &name)
 {
-    IndexMap::const_iterator it = btree.find(name);
-    if (it != btree.end())
-        return it->second;
+    uint32_t idx = find_exact(name);
+    if (idx != UINT32_MAX)
+        return idx;
 
     // CHECKME: what are "mangled names" and where do they come from?
-    String mangled_name = String::FromFormat("%s$", name.GetCStr());
     // if it's a function with a mangled name, allow it
-    it = btree.lower_bound(mangled_name);
-    if (it != btree.end() && it->first.CompareLeft(mangled_name) == 0)
-        return it->second;
+    idx = find_mangled(name);
+    if (idx != UINT32_MAX)
+        return idx;
 
     if (name.GetLength() > 3)
     {
@@ -106,6 +106,50 @@ uint32_t SystemImports::get_index_of(const String &name)
     return UINT32_MAX;
 }
 
+uint32_t SystemImports::find_exact(const String &name) const
+{
+    IndexMap::const_iterator it = index.find(name);
+    return it != index.end() ? it->second : UINT32_MAX;
+}
+
+uint32_t SystemImports::find_mangled(const String &name) const
+{
+    BaseIndexMap::const_iterator it = base_index.find(name);
+    if (it == base_index.end())
+        return UINT32_MAX;
+    // If there are multiple matching symbols, then choose the one
+    // which name is lexicographically first, for consistency
+    uint32_t idx = it->second.front();
+    for (uint32_t other : it->second)
+    {
+        if (imports[other].Name.Compare(imports[idx].Name) < 0)
+            idx = other;
+    }
+    return idx;
+}
+
+void SystemImports::add_index(const String &name, uint32_t ixof)
+{
+    index[name] = ixof;
+    // Register the mangled name under each of its possible base names
+    for (size_t c = name.FindChar('$'); c != String::NoIndex; c = name.FindChar('$', c + 1))
+        base_index[name.Left(c)].push_back(ixof);
+}
+
+void SystemImports::remove_index(const String &name, uint32_t ixof)
+{
+    index.erase(name);
+    for (size_t c = name.FindChar('$'); c != String::NoIndex; c = name.FindChar('$', c + 1))
+    {
+        BaseIndexMap::iterator it = base_index.find(name.Left(c));
+        if (it == base_index.end())
+            continue;
+        it->second.erase(std::remove(it->second.begin(), it->second.end(), ixof), it->second.end());
+        if (it->second.empty())
+            base_index.erase(it);
+    }
+}
+
 String SystemImports::findName(const RuntimeScriptValue &value)
 {
     for (const auto &import : imports)
@@ -125,23 +169,27 @@ void SystemImports::RemoveScriptExports(ccInstance *inst)
         return;
     }
 
-    for (auto &import : imports)
+    for (uint32_t i = 0; i < imports.size(); ++i)
     {
+        ScriptImport &import = imports[i];
         if (import.Name == nullptr)
             continue;
 
         if (import.InstancePtr == inst)
         {
-            btree.erase(import.Name);
+            remove_index(import.Name, i);
             import.Name = nullptr;
             import.Value.Invalidate();
             import.InstancePtr = nullptr;
+            free_slots.push_back(i);
         }
     }
 }
 
 void SystemImports::clear()
 {
-    btree.clear();
+    index.clear();
+    base_index.clear();
+    free_slots.clear();
     imports.clear();
 }
@@ -15,7 +15,8 @@
 #ifndef __CC_SYSTEMIMPORTS_H
 #define __CC_SYSTEMIMPORTS_H
 
-#include <map>
+#include <unordered_map>
+#include <vector>
 #include "script/cc_instance.h"    // ccInstance
 
 struct IScriptObject;
@@ -37,19 +38,32 @@ struct ScriptImport
 struct SystemImports
 {
 private:
-    // Note we can't use a hash-map here, because we sometimes need to search
-    // by partial keys.
-    typedef std::map<String, uint32_t> IndexMap;
+    // Maps a full symbol name to its index in imports
+    typedef std::unordered_map<String, uint32_t> IndexMap;
+    // Maps a base name of a mangled symbol ("name$argnum")
+    // to the indexes of all the symbols sharing it
+    typedef std::unordered_map<String, std::vector<uint32_t>> BaseIndexMap;
 
     std::vector<ScriptImport> imports;
-    IndexMap btree;
+    // Indexes of the freed import slots, for reuse
+    std::vector<uint32_t> free_slots;
+    IndexMap index;
+    BaseIndexMap base_index;
+
+    // Finds the symbol by an exact name match
+    uint32_t find_exact(const String &name) const;
+    // Finds the mangled symbol which name starts with "name$"
+    uint32_t find_mangled(const String &name) const;
+    // Registers and unregisters the symbol in the lookup tables
+    void add_index(const String &name, uint32_t ixof);
+    void remove_index(const String &name, uint32_t ixof);
 
 public:
     uint32_t add(const String &name, const RuntimeScriptValue &value, ccInstance *inst);
     void remove(const String &name);
     const ScriptImport *getByName(const String &name);
     uint32_t get_index_of(const String &name);
-    const ScriptImport *getByIndex(uint32_t index);
+    const ScriptImport *getByIndex(uint32_t idx);
     String findName(const RuntimeScriptValue &value);
     void RemoveScriptExports(ccInstance *inst);
     void clear();
@@ -0,0 +1,76 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gtest/gtest.h"
+#include "ac/dynobj/cc_dynamicarray.h"
+#include "ac/dynobj/dynobj_manager.h"
+#include "ac/dynobj/scriptuserobject.h"
+
+TEST(DynamicArray, BulkOperations) {
+    DynObjectRef arr = CCDynamicArray::Create(10, sizeof(int32_t), false);
+    ccAddObjectReference(arr.Handle);
+    int32_t *elems = static_cast<int32_t*>(arr.Obj);
+    ASSERT_EQ(DynamicArrayHelpers::GetElemCount(arr.Obj), 10u);
+    ASSERT_EQ(DynamicArrayHelpers::GetElemSize(arr.Obj), sizeof(int32_t));
+
+    DynamicArrayHelpers::Fill(arr.Obj, 2, 5, 7);
+    for (int i = 0; i < 10; ++i)
+        ASSERT_EQ(elems[i], (i >= 2 && i < 7) ? 7 : 0);
+
+    // Copy within the same array, with overlapping ranges
+    for (int i = 0; i < 10; ++i)
+        elems[i] = i;
+    DynamicArrayHelpers::Copy(arr.Obj, 0, arr.Obj, 2, 8);
+    for (int i = 2; i < 10; ++i)
+        ASSERT_EQ(elems[i], i - 2);
+
+    DynObjectRef larger = DynamicArrayHelpers::Resize(arr.Obj, 15, sizeof(int32_t));
+    ccAddObjectReference(larger.Handle);
+    ASSERT_EQ(DynamicArrayHelpers::GetElemCount(larger.Obj), 15u);
+    for (int i = 0; i < 15; ++i)
+        ASSERT_EQ(static_cast<int32_t*>(larger.Obj)[i], (i < 10) ? elems[i] : 0);
+
+    // Resizing the empty array, which element size is not known
+    DynObjectRef empty = CCDynamicArray::Create(0, sizeof(int32_t), false);
+    ccAddObjectReference(empty.Handle);
+    ASSERT_EQ(DynamicArrayHelpers::GetElemSize(empty.Obj), 0u);
+    DynObjectRef resized = DynamicArrayHelpers::Resize(empty.Obj, 3, sizeof(int32_t));
+    ccAddObjectReference(resized.Handle);
+    ASSERT_EQ(DynamicArrayHelpers::GetElemSize(resized.Obj), sizeof(int32_t));
+
+    ccReleaseObjectReference(arr.Handle);
+    ccReleaseObjectReference(larger.Handle);
+    ccReleaseObjectReference(empty.Handle);
+    ccReleaseObjectReference(resized.Handle);
+}
+
+TEST(DynamicArray, ManagedHandles) {
+    DynObjectRef arr = CCDynamicArray::Create(4, sizeof(int32_t), true);
+    ccAddObjectReference(arr.Handle);
+    DynObjectRef obj = ScriptUserObject::Create(8);
+    ccAddObjectReference(obj.Handle);
+
+    // Each copy of the handle in the arrays keeps a reference
+    DynamicArrayHelpers::Fill(arr.Obj, 0, 4, obj.Handle);
+    DynObjectRef clone = DynamicArrayHelpers::Clone(arr.Obj, sizeof(int32_t));
+    ccAddObjectReference(clone.Handle);
+    DynamicArrayHelpers::Fill(arr.Obj, 0, 4, 0);
+    DynamicArrayHelpers::Copy(clone.Obj, 0, clone.Obj, 1, 3);
+    ccReleaseObjectReference(obj.Handle);
+    ASSERT_NE(ccGetObjectAddressFromHandle(obj.Handle), nullptr);
+    // Disposing the last array which holds the handles disposes the object
+    ccReleaseObjectReference(clone.Handle);
+    ASSERT_EQ(ccGetObjectAddressFromHandle(obj.Handle), nullptr);
+
+    ccReleaseObjectReference(arr.Handle);
+}
@@ -0,0 +1,233 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Runs the same script functions with the compiled code (JIT) enabled and
+// disabled, and compares their results and errors. Each function is called
+// enough times to get compiled before the checked calls.
+//
+//=============================================================================
+#include <memory>
+#include <utility>
+#include <vector>
+#include "gtest/gtest.h"
+#include "core/def_version.h"
+#include "script/cc_common.h"
+#include "script/cc_instance.h"
+#include "script/cc_jit.h"
+#include "script/cs_compiler.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+namespace
+{
+
+const char *JitTestScript =
+    "int counter;\n"
+    "int values[8];\n"
+    "\n"
+    "int IntMath(int a, int b)\n"
+    "{\n"
+    "  int r = a * 3 - b;\n"
+    "  r += (a << 2) ^ (b >> 1);\n"
+    "  r = r | (a & 0xF0);\n"
+    "  if (b != 0)\n"
+    "    r += a / b + a % b;\n"
+    "  if (a > b && a >= 0 || b <= -2)\n"
+    "    r -= 7;\n"
+    "  if (!(a == b))\n"
+    "    r++;\n"
+    "  return r;\n"
+    "}\n"
+    "\n"
+    "int FloatMath(int a, int b)\n"
+    "{\n"
+    "  float x = 0.5;\n"
+    "  float y = 1.25;\n"
+    "  for (int i = 0; i < a; i++)\n"
+    "  {\n"
+    "    x = x * y - 0.25;\n"
+    "    if (x > 100.0)\n"
+    "      x = x / 3.0;\n"
+    "  }\n"
+    "  if (x > 10.0)\n"
+    "    return b;\n"
+    "  return -b;\n"
+    "}\n"
+    "\n"
+    "int Globals(int n, int m)\n"
+    "{\n"
+    "  for (int i = 0; i < 8; i++)\n"
+    "    values[i] += n * i - m;\n"
+    "  counter += values[n & 7];\n"
+    "  return counter;\n"
+    "}\n"
+    "\n"
+    "int GetValue(int k, int unused)\n"
+    "{\n"
+    "  return values[k];\n"
+    "}\n"
+    "\n"
+    "int Divide(int a, int b)\n"
+    "{\n"
+    "  return a / b;\n"
+    "}\n"
+    "\n"
+    "int Spin(int n, int unused)\n"
+    "{\n"
+    "  int i = 0;\n"
+    "  while (i < n)\n"
+    "    i++;\n"
+    "  return i;\n"
+    "}\n"
+    "\n"
+    "int noloopcheck SpinNoCheck(int n, int unused)\n"
+    "{\n"
+    "  int i = 0;\n"
+    "  while (i < n)\n"
+    "    i++;\n"
+    "  return i;\n"
+    "}\n";
+
+// Max iterations of a loop before the script is considered hung
+const unsigned TestMaxWhileLoops = 10000u;
+
+struct CallResult
+{
+    int     Return = 0;
+    bool    Error = false;
+    String  ErrorText;
+    int     ErrorLine = 0;
+};
+
+class ScriptJitTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ccSetSoftwareVersion(ACI_VERSION_STR);
+        ccSetOption(SCOPT_EXPORTALL, 1);
+        ccSetOption(SCOPT_LINENUMBERS, 1);
+        ccSetOption(SCOPT_LEFTTORIGHT, 1);
+        ccSetOption(SCOPT_OLDSTRINGS, 0);
+        _script.reset(ccCompileText(JitTestScript, "jit_test.asc"));
+        ASSERT_TRUE(_script != nullptr) << cc_get_error().ErrorString.GetCStr();
+        // long system poll period, so that the loop checks are deterministic
+        ccInstance::SetExecTimeout(60000u, 0u, TestMaxWhileLoops);
+    }
+
+    void TearDown() override
+    {
+        ScriptJit::SetEnabled(false);
+        ccInstance::SetExecTimeout(60u, 0u, 0u);
+    }
+
+    // Runs the function once for each set of args in a new script instance,
+    // stops after the first error; optionally tells if anything was compiled
+    std::vector<CallResult> Run(bool jit, const char *func_name,
+        const std::vector<std::pair<int, int>> &calls, bool *compiled = nullptr)
+    {
+        std::vector<CallResult> results;
+        ScriptJit::SetEnabled(jit);
+        std::unique_ptr<ccInstance> inst(ccInstance::CreateFromScript(_script));
+        EXPECT_TRUE(inst != nullptr);
+        if (!inst)
+            return results;
+        // resolving the imports also prepares the code for the executor
+        EXPECT_TRUE(inst->ResolveScriptImports(inst->instanceof.get()));
+        EXPECT_TRUE(inst->ResolveImportFixups(inst->instanceof.get()));
+        const ScriptFunctionRef fn = inst->GetScriptFunction(func_name);
+        EXPECT_TRUE(fn.IsValid()) << func_name;
+        for (const auto &args : calls)
+        {
+            RuntimeScriptValue params[] = {
+                RuntimeScriptValue().SetInt32(args.first), RuntimeScriptValue().SetInt32(args.second) };
+            CallResult res;
+            res.Error = (inst->CallScriptFunction(fn, 2, params) != 0) || cc_has_error();
+            if (res.Error)
+            {
+                res.ErrorText = cc_get_error().ErrorString;
+                res.ErrorLine = cc_get_error().Line;
+            }
+            else
+            {
+                res.Return = inst->returnValue;
+            }
+            results.push_back(res);
+            if (res.Error)
+                break;
+        }
+        if (compiled)
+            *compiled = inst->jit_cache && (inst->jit_cache->GetCompiledCount() > 0u);
+        return results;
+    }
+
+    // Runs the function with and without compiled code, compares the results;
+    // the function is called with the warm up args first, so that it gets compiled
+    void Compare(const char *func_name, const std::pair<int, int> &warmup_args,
+        const std::vector<std::pair<int, int>> &checked_calls, bool expect_error = false)
+    {
+        std::vector<std::pair<int, int>> calls(ScriptJit::HotCallCount + 4, warmup_args);
+        calls.insert(calls.end(), checked_calls.begin(), checked_calls.end());
+        const auto ref = Run(false, func_name, calls);
+        bool compiled = false;
+        const auto res = Run(true, func_name, calls, &compiled);
+        // nothing is compiled on the unsupported platforms
+        EXPECT_EQ(ScriptJit::IsSupported(), compiled) << func_name;
+        ASSERT_EQ(ref.size(), res.size()) << func_name;
+        for (size_t i = 0; i < ref.size(); ++i)
+        {
+            EXPECT_EQ(ref[i].Error, res[i].Error) << func_name << " call " << i;
+            EXPECT_EQ(ref[i].Return, res[i].Return) << func_name << " call " << i;
+            EXPECT_STREQ(ref[i].ErrorText.GetCStr(), res[i].ErrorText.GetCStr()) << func_name << " call " << i;
+            EXPECT_EQ(ref[i].ErrorLine, res[i].ErrorLine) << func_name << " call " << i;
+        }
+        EXPECT_EQ(expect_error, !ref.empty() && ref.back().Error) << func_name;
+    }
+
+    PScript _script;
+};
+
+} // namespace
+
+TEST_F(ScriptJitTest, IntMath) {
+    Compare("IntMath", { 5, 3 }, { { 0, 0 }, { 7, -3 }, { -100, 7 }, { 123456, 789 },
+        { -2147483647, -1 }, { 0x7FFFFFFF, 2 }, { 12, 12 }, { -5, -2 } });
+}
+
+TEST_F(ScriptJitTest, FloatMath) {
+    Compare("FloatMath", { 3, 1 }, { { 0, 2 }, { 10, 3 }, { 25, 4 }, { 100, 5 } });
+}
+
+TEST_F(ScriptJitTest, GlobalData) {
+    Compare("Globals", { 1, 2 }, { { 3, 4 }, { -5, 6 }, { 100, -7 }, { 7, 7 } });
+}
+
+TEST_F(ScriptJitTest, BoundsCheckError) {
+    Compare("GetValue", { 1, 0 }, { { 0, 0 }, { 7, 0 }, { 8, 0 } }, true);
+    Compare("GetValue", { 1, 0 }, { { -1, 0 } }, true);
+}
+
+TEST_F(ScriptJitTest, DivideByZeroError) {
+    Compare("Divide", { 10, 3 }, { { -10, 3 }, { 7, 0 } }, true);
+}
+
+TEST_F(ScriptJitTest, HungLoopError) {
+    Compare("Spin", { 5, 0 }, { { static_cast<int>(TestMaxWhileLoops), 0 },
+        { static_cast<int>(TestMaxWhileLoops) * 10, 0 } }, true);
+}
+
+TEST_F(ScriptJitTest, NoLoopCheck) {
+    Compare("SpinNoCheck", { 5, 0 }, { { static_cast<int>(TestMaxWhileLoops) * 10, 0 } });
+}
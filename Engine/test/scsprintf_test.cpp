@@ -81,6 +81,22 @@ TEST(ScSprintf, ScSprintf) {
     result = ScriptSprintf(ScSfBuffer, 11, "12345678%d", params, 0);
     ASSERT_TRUE(strcmp(result, "12345678%d") == 0);
 
+    // Plain placeholders, which are formatted without snprintf
+    RuntimeScriptValue plain_params[7];
+    plain_params[0].SetInt32(argi);
+    plain_params[1].SetInt32(0);
+    plain_params[2].SetInt32(-2147483647 - 1);
+    plain_params[3].SetInt32('Z');
+    plain_params[4].SetStringLiteral(argcc);
+    plain_params[5].SetInt32(argi);
+    plain_params[6].SetStringLiteral("ab");
+    result = ScriptSprintf(ScSfBuffer, STD_BUFFER_SIZE, "%d|%i|%d|%c|%s|%5d|%-3s|", plain_params, 7);
+    ASSERT_TRUE(strcmp(result, "123|0|-2147483648|Z|string literal|  123|ab |") == 0);
+    result = ScriptSprintf(ScSfBuffer, 6, "%d", plain_params + 2, 1);
+    ASSERT_TRUE(strcmp(result, "-2147") == 0);
+    result = ScriptSprintf(ScSfBuffer, 9, "AB%sCD", plain_params + 4, 1);
+    ASSERT_TRUE(strcmp(result, "ABstring") == 0);
+
     // Test null string pointer in backward-compatibility mode
     loaded_game_file_version = kGameVersion_312;
     params[0].SetStringLiteral(NULL);
@@ -0,0 +1,111 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <algorithm>
+#include <map>
+#include <random>
+#include "gtest/gtest.h"
+#include "main/timer_wheel.h"
+
+using namespace AGS::Engine;
+
+TEST(TimerWheel, Basic) {
+    TimerWheel wheel;
+    std::vector<TimerWheel::Key> expired;
+    const auto key1 = TimerWheel::MakeKey(1, 5);
+    const auto key2 = TimerWheel::MakeKey(2, 5);
+    ASSERT_NE(key1, key2);
+    ASSERT_EQ(TimerWheel::GetKeyType(key2), 2u);
+    ASSERT_EQ(TimerWheel::GetKeyIndex(key2), 5u);
+
+    wheel.Schedule(key1, 1);
+    wheel.Schedule(key2, 3);
+    ASSERT_EQ(wheel.GetCount(), 2u);
+    ASSERT_EQ(wheel.GetRemaining(key2), 3u);
+    wheel.Advance(expired);
+    ASSERT_EQ(expired, std::vector<TimerWheel::Key>({ key1 }));
+    ASSERT_FALSE(wheel.IsScheduled(key1));
+    ASSERT_EQ(wheel.GetRemaining(key2), 2u);
+    expired.clear();
+    wheel.Advance(expired);
+    ASSERT_TRUE(expired.empty());
+    wheel.Advance(expired);
+    ASSERT_EQ(expired, std::vector<TimerWheel::Key>({ key2 }));
+    ASSERT_EQ(wheel.GetCount(), 0u);
+
+    // Rescheduled timer expires only once, at the new time
+    expired.clear();
+    wheel.Schedule(key1, 2);
+    wheel.Schedule(key1, 4);
+    for (int i = 0; i < 3; ++i)
+        wheel.Advance(expired);
+    ASSERT_TRUE(expired.empty());
+    wheel.Advance(expired);
+    ASSERT_EQ(expired, std::vector<TimerWheel::Key>({ key1 }));
+
+    // Cancelled timer does not expire
+    expired.clear();
+    wheel.Schedule(key1, 2);
+    wheel.Schedule(key2, 0);
+    ASSERT_FALSE(wheel.IsScheduled(key2));
+    wheel.Cancel(key1);
+    for (int i = 0; i < 3; ++i)
+        wheel.Advance(expired);
+    ASSERT_TRUE(expired.empty());
+}
+
+TEST(TimerWheel, LongTimers) {
+    // Compare the wheel with the straightforward countdown,
+    // using the delays which span all of the wheel's levels
+    TimerWheel wheel;
+    std::map<TimerWheel::Key, uint32_t> countdown;
+    std::mt19937 rng(1234);
+    const uint32_t delays[] = { 1, 255, 256, 257, 16383, 16384, 16385, 40000 };
+    const uint32_t num_ticks = 50000;
+    std::vector<TimerWheel::Key> expired;
+    for (uint32_t tick = 0; tick < num_ticks; ++tick)
+    {
+        if (tick % 97 == 0)
+        {
+            const auto key = TimerWheel::MakeKey(1, rng() % 64);
+            const uint32_t delay = delays[rng() % (sizeof(delays) / sizeof(delays[0]))] + rng() % 3;
+            wheel.Schedule(key, delay);
+            countdown[key] = delay;
+        }
+        if (tick % 1000 == 0 && !countdown.empty())
+        {
+            const auto key = countdown.begin()->first;
+            wheel.Cancel(key);
+            countdown.erase(key);
+        }
+
+        expired.clear();
+        wheel.Advance(expired);
+        std::vector<TimerWheel::Key> expected;
+        for (auto it = countdown.begin(); it != countdown.end();)
+        {
+            if (--it->second == 0)
+            {
+                expected.push_back(it->first);
+                it = countdown.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        std::sort(expired.begin(), expired.end());
+        ASSERT_EQ(expired, expected);
+        ASSERT_EQ(wheel.GetCount(), countdown.size());
+    }
+}
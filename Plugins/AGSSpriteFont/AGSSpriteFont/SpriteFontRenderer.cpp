@@ -12,11 +12,15 @@ SpriteFontRenderer::SpriteFontRenderer(IAGSEngine *engine)
 }
 
 
-SpriteFontRenderer::~SpriteFontRenderer(void) = default;
+SpriteFontRenderer::~SpriteFontRenderer(void)
+{
+	clearTextCache(-1);
+}
 
 
 void SpriteFontRenderer::FreeMemory(int fontNum)
 {
+	clearTextCache(fontNum);
 	for(auto it = _fonts.begin(); it != _fonts.end() ; ++it)
 	{
 		SpriteFont *font = *it;
@@ -40,6 +44,7 @@ void SpriteFontRenderer::SetSpriteFont(int fontNum, int sprite, int rows, int co
 	font->Use32bit = use32bit;
 	font->CharHeight = charHeight;
 	font->CharWidth = charWidth;
+	clearTextCache(fontNum);
 
 	if (_engine->version >= 26)
 		_engine->NotifyFontUpdated(fontNum);
@@ -104,23 +109,72 @@ SpriteFont *SpriteFontRenderer::getFontFor(int fontNum)
 
 void SpriteFontRenderer::RenderText(const char *text, int fontNumber, BITMAP *destination, int x, int y, int colour)
 {
-	
 	SpriteFont *font = getFontFor(fontNumber);
-	//BITMAP *vScreen = _engine->GetVirtualScreen();
-	
-	//_engine->SetVirtualScreen(destination);
-	size_t len_text =  strlen(text);
+	// The glyphs never overlap, so drawing the text image, which has the
+	// glyphs copied as is over the transparent background, is the same
+	// as drawing the glyphs one by one
+	BITMAP *image = getTextImage(font, text);
+	if (!image)
+		return;
+	int32 width, height, coldepth;
+	_engine->GetBitmapDimensions(image, &width, &height, &coldepth);
+	Draw(image, destination, x, y, 0, 0, width, height);
+}
+
+BITMAP *SpriteFontRenderer::getTextImage(SpriteFont *font, const char *text)
+{
+	size_t len_text = strlen(text);
+	if (len_text == 0 || font->CharWidth <= 0 || font->CharHeight <= 0 || font->Columns <= 0)
+		return nullptr;
+
+	BITMAP *src = _engine->GetSpriteGraphic(font->SpriteNumber);
+	if (!src)
+		return nullptr;
+	auto key = std::make_pair(font->FontReplaced, std::string(text));
+	auto it = _textCache.find(key);
+	if (it != _textCache.end())
+	{
+		if (it->second.Sprite == src)
+			return it->second.Image;
+		// the font sprite was replaced, so render the text again
+		_engine->FreeBitmap(it->second.Image);
+		_textCache.erase(it);
+	}
+	if (_textCache.size() >= MaxCachedTexts)
+		clearTextCache(-1);
+
+	int32 srcWidth, srcHeight, srcColDepth;
+	_engine->GetBitmapDimensions(src, &srcWidth, &srcHeight, &srcColDepth);
+	BITMAP *image = _engine->CreateBlankBitmap(len_text * font->CharWidth, font->CharHeight, srcColDepth);
 	for(size_t i = 0; i < len_text; i++)
 	{
 		char c = text[i];
 		c -= font->MinChar;
 		int row = c / font->Columns;
 		int column = c % font->Columns;
-		BITMAP *src = _engine->GetSpriteGraphic(font->SpriteNumber);
-		Draw(src, destination, x + (i * font->CharWidth), y, column * font->CharWidth, row * font->CharHeight, font->CharWidth, font->CharHeight); 
+		Draw(src, image, i * font->CharWidth, 0, column * font->CharWidth, row * font->CharHeight, font->CharWidth, font->CharHeight);
+	}
+
+	CachedText &cached = _textCache[key];
+	cached.Image = image;
+	cached.Sprite = src;
+	return image;
+}
+
+void SpriteFontRenderer::clearTextCache(int fontNum)
+{
+	for (auto it = _textCache.begin(); it != _textCache.end();)
+	{
+		if (fontNum < 0 || it->first.first == fontNum)
+		{
+			_engine->FreeBitmap(it->second.Image);
+			it = _textCache.erase(it);
+		}
+		else
+		{
+			++it;
+		}
 	}
-	
-	//_engine->SetVirtualScreen(vScreen);
 }
 
 
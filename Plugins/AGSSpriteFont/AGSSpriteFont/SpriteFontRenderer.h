@@ -1,6 +1,8 @@
 #pragma once
 #include "plugin/agsplugin.h"
 #include "SpriteFont.h"
+#include <map>
+#include <string>
 #include <vector>
 class SpriteFontRenderer :
 	public IAGSFontRenderer2
@@ -28,9 +30,24 @@ public:
 	int GetLineSpacing(int fontNumber) { return 0; /* not specified */ }
 
 protected:
+	// Text image rendered with a font, kept to draw the same text again in one pass
+	struct CachedText
+	{
+		BITMAP *Image = nullptr;
+		BITMAP *Sprite = nullptr; // font sprite the text was rendered from
+	};
+	// Max number of the cached text images; the cache is reset when it's full
+	static const size_t MaxCachedTexts = 256;
+
 	SpriteFont *getFontFor(int fontNum);
+	// Returns the cached image of the text, rendering it if necessary;
+	// returns null if the text has nothing to draw
+	BITMAP *getTextImage(SpriteFont *font, const char *text);
+	// Frees the cached text images of the font, or of all fonts if fontNum < 0
+	void clearTextCache(int fontNum);
 	void Draw(BITMAP *src, BITMAP *dest, int destx, int desty, int srcx, int srcy, int width, int height);
 	std::vector<SpriteFont * > _fonts;
+	std::map<std::pair<int, std::string>, CachedText> _textCache;
 	IAGSEngine *_engine;
 };
 
@@ -21,6 +21,7 @@ void VariableWidthFont::SetGlyph(int character, int x, int y, int width, int hei
 	characters[character].Width = width;
 	characters[character].Height = height;
 	characters[character].Character = character;
+	TextWidths.clear();
 }
 
 void VariableWidthFont::SetLineHeightAdjust(int lineHeight, int spacingHeight, int spacingOverride)
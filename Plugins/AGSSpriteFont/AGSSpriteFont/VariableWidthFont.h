@@ -1,5 +1,7 @@
 #pragma once
 #include <map>
+#include <string>
+#include <unordered_map>
 #include "CharacterEntry.h"
 #include "plugin/agsplugin.h"
 class VariableWidthFont
@@ -13,6 +15,8 @@ public:
 	int FontReplaced;
 	int Spacing;
 	std::map<char, CharacterEntry> characters;
+	// Measured widths of the texts, reset whenever the glyphs or spacing change
+	std::unordered_map<std::string, int> TextWidths;
 	// Clifftop Games custom plugin support
 	int LineHeightAdjust;
 	int LineSpacingAdjust;
@@ -12,11 +12,15 @@ VariableWidthSpriteFontRenderer::VariableWidthSpriteFontRenderer(IAGSEngine *eng
 }
 
 
-VariableWidthSpriteFontRenderer::~VariableWidthSpriteFontRenderer(void) = default;
+VariableWidthSpriteFontRenderer::~VariableWidthSpriteFontRenderer(void)
+{
+	clearTextCache(-1);
+}
 
 
 void VariableWidthSpriteFontRenderer::FreeMemory(int fontNum)
 {
+	clearTextCache(fontNum);
 	for(auto it = _fonts.begin(); it != _fonts.end() ; ++it)
 	{
 		VariableWidthFont *font = *it;
@@ -33,8 +37,12 @@ bool VariableWidthSpriteFontRenderer::SupportsExtendedCharacters(int fontNumber)
 
 int VariableWidthSpriteFontRenderer::GetTextWidth(const char *text, int fontNumber)
 {
-	int total = 0;
 	VariableWidthFont *font = getFontFor(fontNumber);
+	auto it = font->TextWidths.find(text);
+	if (it != font->TextWidths.end())
+		return it->second;
+
+	int total = 0;
 	size_t len_text = strlen(text);
 	for(size_t i = 0; i < len_text; i++)
 	{
@@ -44,6 +52,9 @@ int VariableWidthSpriteFontRenderer::GetTextWidth(const char *text, int fontNumb
 			if (text[i] != ' ') total += font->Spacing;
 		}
 	}
+	if (font->TextWidths.size() >= MaxCachedWidths)
+		font->TextWidths.clear();
+	font->TextWidths[text] = total;
 	return total;
 }
 
@@ -85,6 +96,8 @@ void VariableWidthSpriteFontRenderer::SetSpacing(int fontNum, int spacing)
 {
 	VariableWidthFont *font = getFontFor(fontNum);
 	font->Spacing = spacing;
+	font->TextWidths.clear();
+	clearTextCache(fontNum);
 }
 
 void VariableWidthSpriteFontRenderer::SetLineHeightAdjust(int fontNum, int lineHeight, int spacingHeight, int spacingOverride)
@@ -124,6 +137,7 @@ void VariableWidthSpriteFontRenderer::SetGlyph(int fontNum, int charNum, int x,
 {
 	VariableWidthFont *font = getFontFor(fontNum);
 	font->SetGlyph(charNum, x, y, width, height);
+	clearTextCache(fontNum);
 
 	// Only notify engine at the first engine glyph,
 	// that should be enough for calculating font height metrics,
@@ -136,6 +150,7 @@ void VariableWidthSpriteFontRenderer::SetSprite(int fontNum, int spriteNum)
 {
 	VariableWidthFont *font = getFontFor(fontNum);
 	font->SpriteNumber = spriteNum;
+	clearTextCache(fontNum);
 }
 
 VariableWidthFont *VariableWidthSpriteFontRenderer::getFontFor(int fontNum){
@@ -155,8 +170,23 @@ VariableWidthFont *VariableWidthSpriteFontRenderer::getFontFor(int fontNum){
 void VariableWidthSpriteFontRenderer::RenderText(const char *text, int fontNumber, BITMAP *destination, int x, int y, int colour)
 {
 	VariableWidthFont *font = getFontFor(fontNumber);
+	// With no negative spacing the glyphs never overlap, so drawing the text
+	// image, which has the glyphs copied as is over the transparent background,
+	// is the same as drawing the glyphs one by one
+	if (font->Spacing >= 0)
+	{
+		BITMAP *image = getTextImage(font, text);
+		if (!image)
+			return;
+		int32 width, height, coldepth;
+		_engine->GetBitmapDimensions(image, &width, &height, &coldepth);
+		Draw(image, destination, x, y, 0, 0, width, height);
+		return;
+	}
+
 	int totalWidth = 0;
 	size_t len_text = strlen(text);
+	size_t num_glyphs = font->characters.size();
 	for(size_t i = 0; i < len_text; i++)
 	{
 		char c = text[i];
@@ -166,7 +196,79 @@ void VariableWidthSpriteFontRenderer::RenderText(const char *text, int fontNumbe
 		totalWidth += font->characters[c].Width;
 		if (text[i] != ' ') totalWidth += font->Spacing;
 	}
-	
+	// the missing characters got empty glyphs, which changes the text widths
+	if (font->characters.size() != num_glyphs)
+		font->TextWidths.clear();
+}
+
+BITMAP *VariableWidthSpriteFontRenderer::getTextImage(VariableWidthFont *font, const char *text)
+{
+	BITMAP *src = _engine->GetSpriteGraphic(font->SpriteNumber);
+	if (!src)
+		return nullptr;
+	auto key = std::make_pair(font->FontReplaced, std::string(text));
+	auto it = _textCache.find(key);
+	if (it != _textCache.end())
+	{
+		if (it->second.Sprite == src)
+			return it->second.Image;
+		// the font sprite was replaced, so render the text again
+		_engine->FreeBitmap(it->second.Image);
+		_textCache.erase(it);
+	}
+
+	// Measure the text; the missing characters get empty glyphs, same as
+	// when they are drawn one by one, which also changes the text widths
+	size_t len_text = strlen(text);
+	size_t num_glyphs = font->characters.size();
+	int totalWidth = 0, width = 0, height = 0;
+	for(size_t i = 0; i < len_text; i++)
+	{
+		const CharacterEntry &glyph = font->characters[text[i]];
+		width = MAX(width, totalWidth + glyph.Width);
+		height = MAX(height, glyph.Height);
+		totalWidth += glyph.Width;
+		if (text[i] != ' ') totalWidth += font->Spacing;
+	}
+	if (font->characters.size() != num_glyphs)
+		font->TextWidths.clear();
+	if (width <= 0 || height <= 0)
+		return nullptr;
+	if (_textCache.size() >= MaxCachedTexts)
+		clearTextCache(-1);
+
+	int32 srcWidth, srcHeight, srcColDepth;
+	_engine->GetBitmapDimensions(src, &srcWidth, &srcHeight, &srcColDepth);
+	BITMAP *image = _engine->CreateBlankBitmap(width, height, srcColDepth);
+	totalWidth = 0;
+	for(size_t i = 0; i < len_text; i++)
+	{
+		const CharacterEntry &glyph = font->characters[text[i]];
+		Draw(src, image, totalWidth, 0, glyph.X, glyph.Y, glyph.Width, glyph.Height);
+		totalWidth += glyph.Width;
+		if (text[i] != ' ') totalWidth += font->Spacing;
+	}
+
+	CachedText &cached = _textCache[key];
+	cached.Image = image;
+	cached.Sprite = src;
+	return image;
+}
+
+void VariableWidthSpriteFontRenderer::clearTextCache(int fontNum)
+{
+	for (auto it = _textCache.begin(); it != _textCache.end();)
+	{
+		if (fontNum < 0 || it->first.first == fontNum)
+		{
+			_engine->FreeBitmap(it->second.Image);
+			it = _textCache.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
 }
 
 
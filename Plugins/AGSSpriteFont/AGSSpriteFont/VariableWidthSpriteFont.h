@@ -1,6 +1,8 @@
 #pragma once
 #include "plugin/agsplugin.h"
 #include "VariableWidthFont.h"
+#include <map>
+#include <string>
 #include <vector>
 
 class VariableWidthSpriteFontRenderer :
@@ -33,8 +35,25 @@ public:
 	int GetLineSpacing(int fontNumber);
 
 protected:
+	// Text image rendered with a font, kept to draw the same text again in one pass
+	struct CachedText
+	{
+		BITMAP *Image = nullptr;
+		BITMAP *Sprite = nullptr; // font sprite the text was rendered from
+	};
+	// Max number of the cached text images; the cache is reset when it's full
+	static const size_t MaxCachedTexts = 256;
+	// Max number of the measured text widths kept per font
+	static const size_t MaxCachedWidths = 1024;
+
 	IAGSEngine *_engine;
 	std::vector<VariableWidthFont * > _fonts;
+	std::map<std::pair<int, std::string>, CachedText> _textCache;
 	VariableWidthFont *getFontFor(int fontNum);
+	// Returns the cached image of the text, rendering it if necessary;
+	// returns null if the text has nothing to draw
+	BITMAP *getTextImage(VariableWidthFont *font, const char *text);
+	// Frees the cached text images of the font, or of all fonts if fontNum < 0
+	void clearTextCache(int fontNum);
 	void Draw(BITMAP *src, BITMAP *dest, int destx, int desty, int srcx, int srcy, int width, int height);
 };
@@ -21,6 +21,7 @@ but a workalike plugin created by JJS for the AGS engine PSP port.
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <vector>
 
 #if defined(PSP_VERSION)
 #include <pspsdk.h>
@@ -52,6 +53,7 @@ int screen_color_depth = 16;
 IAGSEngine* engine;
 
 bool g_BitmapMustBeUpdated = true;
+bool g_TintMustBeUpdated = true;
 
 int g_RedTint = 0;
 int g_GreenTint = 0;
@@ -80,6 +82,14 @@ AGSCharacter* g_FollowCharacter = nullptr;
 
 BITMAP* g_LightBitmap = nullptr;
 
+// The light bitmap's pixels, already converted for the blender
+// by calc_x_n, so that this is not repeated for every frame
+std::vector<unsigned long> g_LightColors;
+std::vector<unsigned char> g_LightFactors;
+
+// The tinted color for every 16-bit screen pixel value
+unsigned short g_TintTable[65536];
+
 
 // This function is from Allegro, split for more performance.
 
@@ -175,12 +185,11 @@ void ClipToRange(int &variable, int min, int max)
 void AlphaBlendBitmap()
 {
   unsigned short* destpixel = *(unsigned short**)engine->GetRawBitmapSurface(engine->GetVirtualScreen());
-  unsigned int* sourcepixel = *(unsigned int**)engine->GetRawBitmapSurface(g_LightBitmap);
 
   unsigned short* currentdestpixel = destpixel;
-  unsigned int* currentsourcepixel = sourcepixel;
+  int sourceindex;
 
-  int x, y;
+  int row, col;
 
   int targetX = (g_FlashlightDrawAtX > -1) ? g_FlashlightDrawAtX : 0;
   int targetY = (g_FlashlightDrawAtY > -1) ? g_FlashlightDrawAtY : 0;
@@ -191,70 +200,81 @@ void AlphaBlendBitmap()
   int startY = (g_FlashlightDrawAtY < 0) ? -1 * g_FlashlightDrawAtY : 0;
   int endY = (g_FlashlightDrawAtY + g_DarknessDiameter < screen_height) ? g_DarknessDiameter :  g_DarknessDiameter - ((g_FlashlightDrawAtY + g_DarknessDiameter) - screen_height);
 
-  for (y = 0; y < endY - startY; y++)
+  for (row = 0; row < endY - startY; row++)
   {
-    currentdestpixel = destpixel + (y + targetY) * screen_width + targetX;
-    currentsourcepixel = sourcepixel + (y + startY) * g_DarknessDiameter + startX;
+    currentdestpixel = destpixel + (row + targetY) * screen_width + targetX;
+    sourceindex = (row + startY) * g_DarknessDiameter + startX;
 
-    for (x = 0; x < endX - startX; x++)
+    for (col = 0; col < endX - startX; col++)
     {
-      calc_x_n(*currentsourcepixel);
-      *currentdestpixel = (unsigned short)_blender_alpha16_bgr(*currentdestpixel);
+      // Fully transparent light pixels leave the screen unchanged
+      n = g_LightFactors[sourceindex];
+      if (n)
+      {
+        x = g_LightColors[sourceindex];
+        *currentdestpixel = (unsigned short)_blender_alpha16_bgr(*currentdestpixel);
+      }
 
       currentdestpixel++;
-      currentsourcepixel++;
+      sourceindex++;
     }
   }
   
   engine->ReleaseBitmapSurface(engine->GetVirtualScreen());
-  engine->ReleaseBitmapSurface(g_LightBitmap);
 }
 
 
-void DrawTint()
+void CreateTintTable()
 {
-  int x, y;
-  BITMAP* screen = engine->GetVirtualScreen();
-  unsigned short* destpixel = *(unsigned short**)engine->GetRawBitmapSurface(screen);
-
   int32 red, blue, green, alpha;
 
-  for (y = 0; y < screen_height; y++)
+  int color;
+  for (color = 0; color < 65536; color++)
   {
-    for (x = 0; x < screen_width; x++)
+    engine->GetRawColorComponents(16, color, &red, &green, &blue, &alpha);
+
+    if (g_RedTint != 0)
     {
-      engine->GetRawColorComponents(16, *destpixel, &red, &green, &blue, &alpha);
+      red += g_RedTint * 8;
+      if (red > 255)
+        red = 255;
+      else if (red < 0)
+        red = 0;
+    }
 
-      if (g_RedTint != 0)
-      {
-        red += g_RedTint * 8;
-        if (red > 255)
-          red = 255;
-        else if (red < 0)
-          red = 0;
-      }
+    if (g_BlueTint != 0)
+    {
+      blue += g_BlueTint * 8;
+      if (blue > 255)
+        blue = 255;
+      else if (blue < 0)
+        blue = 0;
+    }
 
-      if (g_BlueTint != 0)
-      {
-        blue += g_BlueTint * 8;
-        if (blue > 255)
-          blue = 255;
-        else if (blue < 0)
-          blue = 0;
-      }
+    if (g_GreenTint != 0)
+    {
+      green += g_GreenTint * 8;
+      if (green > 255)
+        green = 255;
+      else if (green < 0)
+        green = 0;
+    }
 
-      if (g_GreenTint != 0)
-      {
-        green += g_GreenTint * 8;
-        if (green > 255)
-          green = 255;
-        else if (green < 0)
-          green = 0;
-      }
+    g_TintTable[color] = (unsigned short)engine->MakeRawColorPixel(16, red, green, blue, alpha);
+  }
+}
 
-      *destpixel = engine->MakeRawColorPixel(16, red, green, blue, alpha);
-      destpixel++;
-    }
+
+void DrawTint()
+{
+  BITMAP* screen = engine->GetVirtualScreen();
+  unsigned short* destpixel = *(unsigned short**)engine->GetRawBitmapSurface(screen);
+
+  int i;
+  for (i = 0; i < screen_width * screen_height; i++)
+  {
+    *destpixel = g_TintTable[*destpixel];
+    destpixel++;
   }
 
   engine->ReleaseBitmapSurface(screen);
@@ -363,7 +383,8 @@ void CreateLightBitmap()
 
   // Fill with darkness color.
   unsigned int color = (255 - (int)((float)g_DarknessLightLevel * 2.55f)) << 24;
-  unsigned int* pixel = *(unsigned int**)engine->GetRawBitmapSurface(g_LightBitmap);
+  unsigned int* pixels = *(unsigned int**)engine->GetRawBitmapSurface(g_LightBitmap);
+  unsigned int* pixel = pixels;
 
   int i;
   for (i = 0; i < g_DarknessDiameter * g_DarknessDiameter; i++)
@@ -408,6 +429,16 @@ void CreateLightBitmap()
       plotCircle(g_DarknessSize, g_DarknessSize, i, color);
   }
 
+  // Convert the pixels for the blender once.
+  g_LightColors.resize(g_DarknessDiameter * g_DarknessDiameter);
+  g_LightFactors.resize(g_DarknessDiameter * g_DarknessDiameter);
+  for (i = 0; i < g_DarknessDiameter * g_DarknessDiameter; i++)
+  {
+    calc_x_n(pixels[i]);
+    g_LightColors[i] = x;
+    g_LightFactors[i] = (unsigned char)n;
+  }
+
   engine->ReleaseBitmapSurface(g_LightBitmap);
 }
 
@@ -465,7 +496,15 @@ void CreateLightBitmap()
 
 
    if ((g_GreenTint != 0) || (g_RedTint != 0) || (g_BlueTint != 0))
+   {
+     if (g_TintMustBeUpdated)
+     {
+       CreateTintTable();
+       g_TintMustBeUpdated = false;
+     }
+
      DrawTint();
+   }
 
    if (g_DarknessSize > 0)
      AlphaBlendBitmap();
@@ -521,6 +560,7 @@ void RestoreGame(long file)
     g_FollowCharacter = engine->GetCharacter(g_FollowCharacterId);
 
   g_BitmapMustBeUpdated = true;
+  g_TintMustBeUpdated = true;
 }
 
 
@@ -565,7 +605,7 @@ void SetFlashlightTint(int RedTint, int GreenTint, int BlueTint)
   ClipToRange(BlueTint, -31, 31);
 
   if ((RedTint != g_RedTint) || (GreenTint != g_GreenTint) || (BlueTint != g_BlueTint))
-    g_BitmapMustBeUpdated = true;
+    g_TintMustBeUpdated = true;
 
   g_RedTint = RedTint;
   g_GreenTint = GreenTint;
@@ -60,18 +60,22 @@ typedef struct
 } view_t;
 
 
+const int MaxParticles = 2000;
+
+// Simulation data of all the drops, stored as a separate array per field,
+// so that the update loops go over contiguous memory
 typedef struct
 {
-  float x;
-  float y;
-  int alpha;
-  float speed;
-  int max_y;
-  int kind_id;
-  int drift;
-  float drift_speed;
-  float drift_offset;
-} drop_t;
+  float x[MaxParticles];
+  float y[MaxParticles];
+  int alpha[MaxParticles];
+  float speed[MaxParticles];
+  int max_y[MaxParticles];
+  int kind_id[MaxParticles];
+  int drift[MaxParticles];
+  float drift_speed[MaxParticles];
+  float drift_offset[MaxParticles];
+} drops_t;
 
 
 class Weather
@@ -110,6 +114,10 @@ class Weather
 
   private:
     void ClipToRange(int &variable, int min, int max);
+    // Adds the drop to the list of the drops to draw this frame
+    void QueueDrop(int i, int x);
+    // Draws the queued drops
+    void DrawDrops();
     
     bool mIsSnow;
     
@@ -139,8 +147,10 @@ class Weather
     int mMaxFallSpeed;
     int mDeltaFallSpeed;
     
-    drop_t mParticles[2000];
+    drops_t mDrops;
     view_t mViews[5];
+    AGSBitmapBlit mBlits[MaxParticles];
+    int mBlitCount;
 
     bool mViewsInitialized;
 };
@@ -173,30 +183,32 @@ void Weather::Update()
   if (!ReinitializeViews())
     return;
 
+  mBlitCount = 0;
   int i;
   for (i = 0; i < mAmount * 2; i++)
   {
-    mParticles[i].y += mParticles[i].speed;
-    mParticles[i].x += mWindSpeed;
+    mDrops.y[i] += mDrops.speed[i];
+    mDrops.x[i] += mWindSpeed;
     
-    if (mParticles[i].x < 0)
-      mParticles[i].x += screen_width;
+    if (mDrops.x[i] < 0)
+      mDrops.x[i] += screen_width;
       
-    if (mParticles[i].x > screen_width - 1)
-      mParticles[i].x -= screen_width;
+    if (mDrops.x[i] > screen_width - 1)
+      mDrops.x[i] -= screen_width;
     
-    if (mParticles[i].y > mParticles[i].max_y)
+    if (mDrops.y[i] > mDrops.max_y[i])
     {
-      mParticles[i].y = -1 * (rand() % screen_height);
-      mParticles[i].x = rand() % screen_width;
-      mParticles[i].alpha = rand() % mDeltaAlpha + mMinAlpha;
-      mParticles[i].speed = (float)(rand() % mDeltaFallSpeed + mMinFallSpeed) / 50.0f;
-      mParticles[i].max_y = rand() % mDeltaBaseline + mTopBaseline;
+      mDrops.y[i] = -1 * (rand() % screen_height);
+      mDrops.x[i] = rand() % screen_width;
+      mDrops.alpha[i] = rand() % mDeltaAlpha + mMinAlpha;
+      mDrops.speed[i] = (float)(rand() % mDeltaFallSpeed + mMinFallSpeed) / 50.0f;
+      mDrops.max_y[i] = rand() % mDeltaBaseline + mTopBaseline;
     }
-    else if ((mParticles[i].y > 0) && (mParticles[i].alpha > 0))
-      engine->BlitSpriteTranslucent(mParticles[i].x, mParticles[i].y, mViews[mParticles[i].kind_id].bitmap, mParticles[i].alpha);
+    else if ((mDrops.y[i] > 0) && (mDrops.alpha[i] > 0))
+      QueueDrop(i, mDrops.x[i]);
   }
   
+  DrawDrops();
   engine->MarkRegionDirty(0, 0, screen_width, screen_height);
 }
 
@@ -211,40 +223,67 @@ void Weather::UpdateWithDrift()
   if (!ReinitializeViews())
     return;
 
+  mBlitCount = 0;
   int i, drift;
   for (i = 0; i < mAmount * 2; i++)
   {
-    mParticles[i].y += mParticles[i].speed;
-    drift = mParticles[i].drift * sin((float)(mParticles[i].y + mParticles[i].drift_offset) * mParticles[i].drift_speed * 2.0f * PI / 360.0f);
+    mDrops.y[i] += mDrops.speed[i];
+    drift = mDrops.drift[i] * sin((float)(mDrops.y[i] + mDrops.drift_offset[i]) * mDrops.drift_speed[i] * 2.0f * PI / 360.0f);
 
     if (signum(mWindSpeed) == signum(drift))
-      mParticles[i].x += mWindSpeed;
+      mDrops.x[i] += mWindSpeed;
     else
-      mParticles[i].x += mWindSpeed / 4;
+      mDrops.x[i] += mWindSpeed / 4;
     
-    if (mParticles[i].x < 0)
-      mParticles[i].x += screen_width;
+    if (mDrops.x[i] < 0)
+      mDrops.x[i] += screen_width;
       
-    if (mParticles[i].x > screen_width - 1)
-      mParticles[i].x -= screen_width;
+    if (mDrops.x[i] > screen_width - 1)
+      mDrops.x[i] -= screen_width;
     
-    if (mParticles[i].y > mParticles[i].max_y)
+    if (mDrops.y[i] > mDrops.max_y[i])
     {
-      mParticles[i].y = -1 * (rand() % screen_height);
-      mParticles[i].x = rand() % screen_width;
-      mParticles[i].alpha = rand() % mDeltaAlpha + mMinAlpha;
-      mParticles[i].speed = (float)(rand() % mDeltaFallSpeed + mMinFallSpeed) / 50.0f;
-      mParticles[i].max_y = rand() % mDeltaBaseline + mTopBaseline;
-      mParticles[i].drift = rand() % mDeltaDrift + mMinDrift;
-      mParticles[i].drift_speed = (rand() % mDeltaDriftSpeed + mMinDriftSpeed) / 50.0f;
+      mDrops.y[i] = -1 * (rand() % screen_height);
+      mDrops.x[i] = rand() % screen_width;
+      mDrops.alpha[i] = rand() % mDeltaAlpha + mMinAlpha;
+      mDrops.speed[i] = (float)(rand() % mDeltaFallSpeed + mMinFallSpeed) / 50.0f;
+      mDrops.max_y[i] = rand() % mDeltaBaseline + mTopBaseline;
+      mDrops.drift[i] = rand() % mDeltaDrift + mMinDrift;
+      mDrops.drift_speed[i] = (rand() % mDeltaDriftSpeed + mMinDriftSpeed) / 50.0f;
     }
-    else if ((mParticles[i].y > 0) && (mParticles[i].alpha > 0))
-      engine->BlitSpriteTranslucent(mParticles[i].x + drift, mParticles[i].y, mViews[mParticles[i].kind_id].bitmap, mParticles[i].alpha);
+    else if ((mDrops.y[i] > 0) && (mDrops.alpha[i] > 0))
+      QueueDrop(i, mDrops.x[i] + drift);
   }
   
+  DrawDrops();
   engine->MarkRegionDirty(0, 0, screen_width, screen_height);
 }
 
+void Weather::QueueDrop(int i, int x)
+{
+  AGSBitmapBlit &blit = mBlits[mBlitCount++];
+  blit.Image = mViews[mDrops.kind_id[i]].bitmap;
+  blit.X = x;
+  blit.Y = mDrops.y[i];
+  blit.Transparency = mDrops.alpha[i];
+  blit.Masked = 1;
+}
+
+
+void Weather::DrawDrops()
+{
+  // Newer engines draw the whole list in one call
+  if (engine->version >= 29)
+  {
+    engine->BlitBitmaps(mBlits, mBlitCount);
+    return;
+  }
+
+  int i;
+  for (i = 0; i < mBlitCount; i++)
+    engine->BlitSpriteTranslucent(mBlits[i].X, mBlits[i].Y, mBlits[i].Image, mBlits[i].Transparency);
+}
+
 static size_t engineFileRead(void * ptr, size_t size, size_t count, long fileHandle) {
   auto totalBytes = engine->FRead(ptr, size*count, fileHandle);
   return totalBytes/size;
@@ -385,6 +424,7 @@ void Weather::Initialize()
     SetFallSpeed(100, 300);
   
   mViewsInitialized = false;
+  mBlitCount = 0;
 
   int i;
   for (i = 0; i < 5; i++)
@@ -401,19 +441,19 @@ void Weather::Initialize()
 
 void Weather::InitializeParticles()
 {
-  memset(mParticles, 0, sizeof(drop_t) * 2000);
+  memset(&mDrops, 0, sizeof(mDrops));
   int i;
-  for (i = 0; i < 2000; i++)
+  for (i = 0; i < MaxParticles; i++)
   {
-    mParticles[i].kind_id = rand() % 5;
-    mParticles[i].y = rand() % (screen_height * 2) - screen_height;
-    mParticles[i].x = rand() % screen_width;
-    mParticles[i].alpha = rand() % mDeltaAlpha + mMinAlpha;
-    mParticles[i].speed = (float)(rand() % mDeltaFallSpeed + mMinFallSpeed) / 50.0f;
-    mParticles[i].max_y = rand() % mDeltaBaseline + mTopBaseline;
-    mParticles[i].drift = rand() % mDeltaDrift + mMinDrift;
-    mParticles[i].drift_speed = (rand() % mDeltaDriftSpeed + mMinDriftSpeed) / 50.0f;  
-    mParticles[i].drift_offset = rand() % 100;
+    mDrops.kind_id[i] = rand() % 5;
+    mDrops.y[i] = rand() % (screen_height * 2) - screen_height;
+    mDrops.x[i] = rand() % screen_width;
+    mDrops.alpha[i] = rand() % mDeltaAlpha + mMinAlpha;
+    mDrops.speed[i] = (float)(rand() % mDeltaFallSpeed + mMinFallSpeed) / 50.0f;
+    mDrops.max_y[i] = rand() % mDeltaBaseline + mTopBaseline;
+    mDrops.drift[i] = rand() % mDeltaDrift + mMinDrift;
+    mDrops.drift_speed[i] = (rand() % mDeltaDriftSpeed + mMinDriftSpeed) / 50.0f;  
+    mDrops.drift_offset[i] = rand() % 100;
   }
 }
 
@@ -545,8 +585,8 @@ void Weather::SetTransparency(int min_value, int max_value)
     mDeltaAlpha = 1;
 
   int i;
-  for (i = 0; i < 2000; i++)
-    mParticles[i].alpha = rand() % mDeltaAlpha + mMinAlpha;
+  for (i = 0; i < MaxParticles; i++)
+    mDrops.alpha[i] = rand() % mDeltaAlpha + mMinAlpha;
 }
 
 
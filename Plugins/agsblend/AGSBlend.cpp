@@ -21,6 +21,8 @@
 #include <stdio.h>
 #include <math.h>
 #include <algorithm>
+#include <thread>
+#include <vector>
 
 #if !defined(BUILTIN_PLUGINS)
 #define THIS_IS_THE_PLUGIN
@@ -250,6 +252,32 @@ int HighPass(int sprite, int threshold){
 }
 
 
+/// <summary>
+///  Runs the function over the [0, count) range, split into chunks between
+///  a number of threads; ranges shorter than two chunks are run on this thread
+/// </summary>
+template <typename TFn>
+void ParallelFor(int count, int min_chunk, TFn fn){
+
+    const int max_threads = std::max(1u, std::thread::hardware_concurrency());
+    const int threads = std::min(max_threads, count / std::max(1, min_chunk));
+    if (threads <= 1) {
+        fn(0, count);
+        return;
+    }
+
+    const int chunk = (count + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    for (int start = chunk; start < count; start += chunk)
+        workers.emplace_back(fn, start, std::min(count, start + chunk));
+    fn(0, std::min(count, chunk));
+    for (auto &worker : workers)
+        worker.join();
+}
+
+// Min number of pixels per blur thread, so that starting one is worth it
+#define BLUR_MIN_PIXELS_PER_THREAD 32768
+
 int Blur (int sprite, int radius) {
              
     BITMAP* src = engine->GetSpriteGraphic(sprite);
@@ -259,158 +287,106 @@ int Blur (int sprite, int radius) {
 
     unsigned char **srccharbuffer = engine->GetRawBitmapSurface (src);
     unsigned int **srclongbuffer = (unsigned int**)srccharbuffer;
-    int negrad = -1 * radius;
-    
-    //use a 1Dimensional array since the array is on the free store, not the stack
-    Pixel32 * Pixels = new Pixel32[(srcWidth + (radius * 2)) * (srcHeight + (radius * 2))]; // this defines a copy of the individual channels in class form.
-    Pixel32 * Dest = new Pixel32[(srcWidth + (radius * 2)) * (srcHeight + (radius * 2))]; // this is the destination sprite. both have a border all the way round equal to the radius for the blurring.
-    Pixel32 * Temp = new Pixel32[(srcWidth + (radius * 2)) * (srcHeight + (radius * 2))];    
 
-             
-    int arraywidth = srcWidth + (radius * 2); //define the array width since its used many times in the algorithm
+    // Both arrays have a border all the way round equal to the radius for the blurring,
+    // which is left zero. The pixels are stored premultiplied by alpha, exactly as they
+    // are summed up by each pass, so that every pixel is only converted once.
+    const int arraywidth = srcWidth + (radius * 2);
+    const int arrayheight = srcHeight + (radius * 2);
+    std::vector<Pixel32> Pixels(arraywidth * arrayheight); // a copy of the sprite's channels
+    std::vector<Pixel32> Temp(arraywidth * arrayheight); // the result of the horizontal pass
+
+    const int numofpixels = (radius * 2 + 1);
+    const int rows_per_thread = std::max(1, BLUR_MIN_PIXELS_PER_THREAD / std::max(1, srcWidth));
+
+    // Copy the sprite to the Pixels array
+    ParallelFor(srcHeight, rows_per_thread, [&](int y_from, int y_to) {
+        for (int y = y_from; y < y_to; y++) {
+            const unsigned int *src_row = srclongbuffer[y];
+            Pixel32 *pixel_row = &Pixels[xytolocale(radius, y + radius, arraywidth)];
+            for (int x = 0; x < srcWidth; x++) {
+                const int alpha = geta32(src_row[x]);
+                pixel_row[x].Red = (getr32(src_row[x]) * alpha) / 255;
+                pixel_row[x].Green = (getg32(src_row[x]) * alpha) / 255;
+                pixel_row[x].Blue = (getb32(src_row[x]) * alpha) / 255;
+                pixel_row[x].Alpha = alpha;
+            }
+        }
+    });
 
+    // Horizontal pass: each row keeps a running total of the pixels in the window
+    ParallelFor(srcHeight, rows_per_thread, [&](int y_from, int y_to) {
+        for (int y = y_from; y < y_to; y++) {
+            const Pixel32 *pixel_row = &Pixels[xytolocale(0, y + radius, arraywidth)];
+            Pixel32 *temp_row = &Temp[xytolocale(radius, y + radius, arraywidth)];
+            int totalr = 0, totalg = 0, totalb = 0, totala = 0;
 
-    for (int y = 0; y<srcHeight; y++){ //copy the sprite to the Pixels class array
-         
-         for (int x = 0; x<srcWidth; x++){
-             
-             int locale = xytolocale(x + radius, y + radius, arraywidth);
-             
-             Pixels[locale].Red = getr32(srclongbuffer[y][x]);
-             Pixels[locale].Green = getg32(srclongbuffer[y][x]);             
-             Pixels[locale].Blue = getb32(srclongbuffer[y][x]);
-             Pixels[locale].Alpha = geta32(srclongbuffer[y][x]);  
-                                                     
-
-         
-         }
-         
-     }    
-   
-    
-    int  numofpixels = (radius * 2 + 1);
-    for (int y = 0; y < srcHeight; y++) {
-                
-                int totalr = 0;
-                int totalg = 0;
-                int totalb = 0;                
-                int totala = 0;
-            
             // Process entire window for first pixel
-            for (int kx = negrad; kx <= radius; kx++){
-                int locale = xytolocale(kx + radius, y + radius, arraywidth);
-                 totala += Pixels[locale].Alpha;
-                 totalr += (Pixels[locale].Red * Pixels[locale].Alpha)/ 255;
-                 totalg += (Pixels[locale].Green * Pixels[locale].Alpha)/ 255;
-                 totalb += (Pixels[locale].Blue * Pixels[locale].Alpha)/ 255;
-                }
-                
-            int locale = xytolocale(radius, y + radius, arraywidth);
-            Temp[locale].Red = totalr / numofpixels; // take an average and assign it to the destination array
-            Temp[locale].Green = totalg / numofpixels;
-            Temp[locale].Blue = totalb / numofpixels;
-            Temp[locale].Alpha = totala / numofpixels;       
-
-
-            // Subsequent pixels just update window total
-            for (int x = 1; x < srcWidth; x++) {
-                // Subtract pixel leaving window
-                int locale = xytolocale(x - 1, y + radius, arraywidth);
-                totala -= Pixels[locale].Alpha;
-                totalr -= (Pixels[locale].Red * Pixels[locale].Alpha)/ 255;
-                totalg -= (Pixels[locale].Green * Pixels[locale].Alpha)/ 255;
-                totalb -= (Pixels[locale].Blue * Pixels[locale].Alpha)/ 255;
+            for (int kx = 0; kx <= radius * 2; kx++) {
+                totala += pixel_row[kx].Alpha;
+                totalr += pixel_row[kx].Red;
+                totalg += pixel_row[kx].Green;
+                totalb += pixel_row[kx].Blue;
+            }
 
-                
-                // Add pixel entering window
-                
-                locale = xytolocale(x + radius + radius, y + radius, arraywidth);
-                 totala += Pixels[locale].Alpha;
-                 totalr += (Pixels[locale].Red * Pixels[locale].Alpha)/ 255;
-                 totalg += (Pixels[locale].Green * Pixels[locale].Alpha)/ 255;
-                 totalb += (Pixels[locale].Blue * Pixels[locale].Alpha)/ 255;
-                
-                
-                 locale = xytolocale(x + radius, y + radius, arraywidth);
-                 Temp[locale].Red = totalr / numofpixels; // take an average and assign it to the destination array
-                 Temp[locale].Green = totalg / numofpixels;
-                 Temp[locale].Blue = totalb / numofpixels;
-                 Temp[locale].Alpha = totala / numofpixels;       
+            for (int x = 0; x < srcWidth; x++) {
+                if (x > 0) {
+                    // Subsequent pixels just update window total:
+                    // subtract pixel leaving window, add pixel entering window
+                    const Pixel32 &leaving = pixel_row[x - 1];
+                    const Pixel32 &entering = pixel_row[x + radius * 2];
+                    totala += entering.Alpha - leaving.Alpha;
+                    totalr += entering.Red - leaving.Red;
+                    totalg += entering.Green - leaving.Green;
+                    totalb += entering.Blue - leaving.Blue;
+                }
 
+                // Take an average, and store it premultiplied for the vertical pass
+                const int alpha = totala / numofpixels;
+                temp_row[x].Red = ((totalr / numofpixels) * alpha) / 255;
+                temp_row[x].Green = ((totalg / numofpixels) * alpha) / 255;
+                temp_row[x].Blue = ((totalb / numofpixels) * alpha) / 255;
+                temp_row[x].Alpha = alpha;
+            }
+        }
+    });
+
+    // Vertical pass: keeps running totals for all the columns at once, which lets
+    // go over the rows in order; each thread starts with its own full window
+    ParallelFor(srcHeight, rows_per_thread, [&](int y_from, int y_to) {
+        std::vector<Pixel32> totals(srcWidth);
+        for (int ky = y_from; ky <= y_from + radius * 2; ky++) {
+            const Pixel32 *temp_row = &Temp[xytolocale(radius, ky, arraywidth)];
+            for (int x = 0; x < srcWidth; x++) {
+                totals[x].Alpha += temp_row[x].Alpha;
+                totals[x].Red += temp_row[x].Red;
+                totals[x].Green += temp_row[x].Green;
+                totals[x].Blue += temp_row[x].Blue;
             }
         }
 
-    
-
-
-    for (int x = 0; x < srcWidth; x++) {
-                
-                int totalr = 0;
-                int totalg = 0;
-                int totalb = 0;                
-                int totala = 0;
-            
-            // Process entire window for first pixel
-            for (int ky = negrad; ky <= radius; ky++){
-                int locale = xytolocale(x + radius, ky + radius, arraywidth);
-                 totala += Temp[locale].Alpha;
-                 totalr += (Temp[locale].Red * Temp[locale].Alpha)/ 255;
-                 totalg += (Temp[locale].Green * Temp[locale].Alpha)/ 255;
-                 totalb += (Temp[locale].Blue * Temp[locale].Alpha)/ 255;
+        for (int y = y_from; y < y_to; y++) {
+            if (y > y_from) {
+                const Pixel32 *leaving_row = &Temp[xytolocale(radius, y - 1, arraywidth)];
+                const Pixel32 *entering_row = &Temp[xytolocale(radius, y + radius * 2, arraywidth)];
+                for (int x = 0; x < srcWidth; x++) {
+                    totals[x].Alpha += entering_row[x].Alpha - leaving_row[x].Alpha;
+                    totals[x].Red += entering_row[x].Red - leaving_row[x].Red;
+                    totals[x].Green += entering_row[x].Green - leaving_row[x].Green;
+                    totals[x].Blue += entering_row[x].Blue - leaving_row[x].Blue;
                 }
-                
-            int locale = xytolocale(x + radius,radius, arraywidth);
-            Dest[locale].Red = totalr / numofpixels; // take an average and assign it to the destination array
-            Dest[locale].Green = totalg / numofpixels;
-            Dest[locale].Blue = totalb / numofpixels;
-            Dest[locale].Alpha = totala / numofpixels;       
-
-
-            // Subsequent pixels just update window total
-            for (int y = 1; y < srcHeight; y++) {
-                // Subtract pixel leaving window
-                int locale = xytolocale(x + radius, y - 1, arraywidth);
-                totala -= Temp[locale].Alpha;
-                totalr -= (Temp[locale].Red * Temp[locale].Alpha)/ 255;
-                totalg -= (Temp[locale].Green * Temp[locale].Alpha)/ 255;
-                totalb -= (Temp[locale].Blue * Temp[locale].Alpha)/ 255;
-
-                
-                // Add pixel entering window
-                
-                locale = xytolocale(x + radius, y + radius + radius, arraywidth);
-                 totala += Temp[locale].Alpha;
-                 totalr += (Temp[locale].Red * Temp[locale].Alpha)/ 255;
-                 totalg += (Temp[locale].Green * Temp[locale].Alpha)/ 255;
-                 totalb += (Temp[locale].Blue * Temp[locale].Alpha)/ 255;
-                
-                
-                 locale = xytolocale(x + radius, y + radius, arraywidth);
-                 Dest[locale].Red = totalr / numofpixels; // take an average and assign it to the destination array
-                 Dest[locale].Green = totalg / numofpixels;
-                 Dest[locale].Blue = totalb / numofpixels;
-				 Dest[locale].Alpha = totala / numofpixels;       
+            }
 
+            // Take an average and write it to the main buffer
+            unsigned int *dest_row = srclongbuffer[y];
+            for (int x = 0; x < srcWidth; x++) {
+                dest_row[x] = makeacol32(totals[x].Red / numofpixels, totals[x].Green / numofpixels,
+                    totals[x].Blue / numofpixels, totals[x].Alpha / numofpixels);
             }
         }
-     
-     
-     
-        for (int y = 0; y<srcHeight; y++){
-             
-             for (int x = 0; x<srcWidth; x++){
-                int locale = xytolocale(x + radius, y + radius, arraywidth);
-                srclongbuffer[y][x] = Dest[locale].GetColorAsInt(); //write the destination array to the main buffer
+    });
 
-             }
-             
-         } 
-        delete [] Pixels;
-        delete [] Dest;
-        delete [] Temp;
-        engine->ReleaseBitmapSurface(src);
-        delete srclongbuffer;
-        delete srccharbuffer;
+    engine->ReleaseBitmapSurface(src);
 	return 0;
 }
 
@@ -422,6 +398,115 @@ int Clamp(int val, int min, int max){
     
 }
 
+/// <summary>
+///  Tells the engine which part of the sprite was changed
+/// </summary>
+void NotifySpriteAreaUpdated(int sprite, int left, int top, int right, int bottom){
+
+    if (engine->version >= 29)
+        engine->NotifySpriteAreaUpdated(sprite, left, top, right, bottom);
+    else
+        engine->NotifySpriteUpdated(sprite);
+}
+
+/// <summary>
+///  Composes the blended color over the destination pixel
+/// </summary>
+inline unsigned int ComposePixel(int finalr, int finalg, int finalb, int srca,
+    int destr, int destg, int destb, int desta){
+
+    // Opaque source, or fully transparent destination: these give exactly
+    // the same result as the full formula below, without the divisions
+    if (srca == 255)
+        return makeacol32(finalr, finalg, finalb, 255);
+    if (desta == 0)
+        return makeacol32(finalr, finalg, finalb, srca);
+
+    const int finala = 255-(255-srca)*(255-desta)/255;
+    finalr = srca*finalr/finala + desta*destr*(255-srca)/finala/255;
+    finalg = srca*finalg/finala + desta*destg*(255-srca)/finala/255;
+    finalb = srca*finalb/finala + desta*destb*(255-srca)/finala/255;
+    return makeacol32(finalr, finalg, finalb, finala);
+}
+
+/// <summary>
+///  Blends a single color channel using the DrawSprite's draw mode
+/// </summary>
+template <int DrawMode>
+inline int BlendChannel(int B, int L){
+
+    switch (DrawMode) {
+    case 1: return ChannelBlend_Lighten(B,L);
+    case 2: return ChannelBlend_Darken(B,L);
+    case 3: return ChannelBlend_Multiply(B,L);
+    case 4: return ChannelBlend_Add(B,L);
+    case 5: return ChannelBlend_Subtract(B,L);
+    case 6: return ChannelBlend_Difference(B,L);
+    case 7: return ChannelBlend_Negation(B,L);
+    case 8: return ChannelBlend_Screen(B,L);
+    case 9: return ChannelBlend_Exclusion(B,L);
+    case 10: return ChannelBlend_Overlay(B,L);
+    case 11: return ChannelBlend_SoftLight(B,L);
+    case 12: return ChannelBlend_HardLight(B,L);
+    case 13: return ChannelBlend_ColorDodge(B,L);
+    case 14: return ChannelBlend_ColorBurn(B,L);
+    case 15: return ChannelBlend_LinearDodge(B,L);
+    case 16: return ChannelBlend_LinearBurn(B,L);
+    case 17: return ChannelBlend_LinearLight(B,L);
+    case 18: return ChannelBlend_VividLight(B,L);
+    case 19: return ChannelBlend_PinLight(B,L);
+    case 20: return ChannelBlend_HardMix(B,L);
+    case 21: return ChannelBlend_Reflect(B,L);
+    case 22: return ChannelBlend_Glow(B,L);
+    case 23: return ChannelBlend_Phoenix(B,L);
+    default: return B;
+    }
+}
+
+/// <summary>
+///  Draws the sprite's area using the draw mode; the mode is a template
+///  argument, so that it is not tested for every pixel
+/// </summary>
+template <int DrawMode>
+void DrawSpriteArea(unsigned int **srclongbuffer, unsigned int **destlongbuffer, int x, int y,
+    int startx, int starty, int endx, int endy, int trans){
+
+    for (int ycount = starty; ycount < endy; ycount++) {
+        const unsigned int *src_row = srclongbuffer[ycount];
+        unsigned int *dest_row = destlongbuffer[ycount + y];
+        for (int xcount = startx; xcount < endx; xcount++) {
+            const unsigned int src_col = src_row[xcount];
+            int srca = geta32(src_col);
+            if (srca == 0)
+                continue;
+
+            srca = srca * trans / 100;
+            const unsigned int dest_col = dest_row[xcount + x];
+            const int srcr = getr32(src_col);
+            const int srcg = getg32(src_col);
+            const int srcb = getb32(src_col);
+            const int destr = getr32(dest_col);
+            const int destg = getg32(dest_col);
+            const int destb = getb32(dest_col);
+            const int desta = geta32(dest_col);
+            dest_row[xcount + x] = ComposePixel(
+                BlendChannel<DrawMode>(srcr, destr), BlendChannel<DrawMode>(srcg, destg),
+                BlendChannel<DrawMode>(srcb, destb), srca, destr, destg, destb, desta);
+        }
+    }
+}
+
+typedef void (*DrawSpriteAreaFn)(unsigned int **, unsigned int **, int, int, int, int, int, int, int);
+
+const DrawSpriteAreaFn DrawSpriteModes[] = {
+    DrawSpriteArea<0>, DrawSpriteArea<1>, DrawSpriteArea<2>, DrawSpriteArea<3>,
+    DrawSpriteArea<4>, DrawSpriteArea<5>, DrawSpriteArea<6>, DrawSpriteArea<7>,
+    DrawSpriteArea<8>, DrawSpriteArea<9>, DrawSpriteArea<10>, DrawSpriteArea<11>,
+    DrawSpriteArea<12>, DrawSpriteArea<13>, DrawSpriteArea<14>, DrawSpriteArea<15>,
+    DrawSpriteArea<16>, DrawSpriteArea<17>, DrawSpriteArea<18>, DrawSpriteArea<19>,
+    DrawSpriteArea<20>, DrawSpriteArea<21>, DrawSpriteArea<22>, DrawSpriteArea<23>
+};
+
 int DrawSprite(int destination, int sprite, int x, int y, int DrawMode, int trans){
     
     trans = 100 - trans;
@@ -441,263 +526,23 @@ int DrawSprite(int destination, int sprite, int x, int y, int DrawMode, int tran
     unsigned char **destcharbuffer = engine->GetRawBitmapSurface (dest);
     unsigned int **destlongbuffer = (unsigned int**)destcharbuffer;
     
-   
-     
     if (srcWidth + x > destWidth) srcWidth = destWidth - x - 1;
     if (srcHeight + y > destHeight) srcHeight = destHeight - y - 1;
 
-    int destx, desty; 
-    int srcr, srcg, srcb, srca, destr, destg, destb, desta, finalr, finalg, finalb, finala;
-    unsigned int col;
     int starty = 0;
     int startx = 0;
 
     if (x < 0) startx = -1 * x;
     if (y < 0) starty = -1 * y;
 
-    int ycount = 0;
-    int xcount = 0;
-    for(ycount = starty; ycount<srcHeight; ycount ++){
-            
-        for(xcount = startx; xcount<srcWidth; xcount ++){
-            
-            destx = xcount + x;
-            desty = ycount + y;
-            
-            srca =  (geta32(srclongbuffer[ycount][xcount]));
-            
-            if (srca != 0) {
-                srca = srca * trans / 100;     
-                srcr =  getr32(srclongbuffer[ycount][xcount]);  
-                srcg =  getg32(srclongbuffer[ycount][xcount]);
-                srcb =  getb32(srclongbuffer[ycount][xcount]);
-    
-                destr =  getr32(destlongbuffer[desty][destx]);
-                destg =  getg32(destlongbuffer[desty][destx]);
-                destb =  getb32(destlongbuffer[desty][destx]);
-                desta =  geta32(destlongbuffer[desty][destx]);
-                
-
-     
-                
-                switch (DrawMode) {
-                
-                case 0:
-                     
-                     finalr = srcr;
-                     finalg = srcg;
-                     finalb = srcb;   
-                     break;                                       
-                
-                case 1:
-                     
-                     finalr = ChannelBlend_Lighten(srcr,destr);                    
-                     finalg = ChannelBlend_Lighten(srcg,destg);
-                     finalb = ChannelBlend_Lighten(srcb,destb);                                          
-                     break;
-                
-                case 2:
-                     
-                     
-                     finalr = ChannelBlend_Darken(srcr,destr);                    
-                     finalg = ChannelBlend_Darken(srcg,destg);
-                     finalb = ChannelBlend_Darken(srcb,destb);    
-                     break; 
-
-                case 3:
-                     
-                     
-                     finalr = ChannelBlend_Multiply(srcr,destr);                    
-                     finalg = ChannelBlend_Multiply(srcg,destg);
-                     finalb = ChannelBlend_Multiply(srcb,destb);    
-                     break;                           
-                       
-                case 4:
-                     
-                     
-                     finalr = ChannelBlend_Add(srcr,destr);                    
-                     finalg = ChannelBlend_Add(srcg,destg);
-                     finalb = ChannelBlend_Add(srcb,destb);    
-                     break;        
-                     
-                case 5:
-                     
-                     
-                     finalr = ChannelBlend_Subtract(srcr,destr);                    
-                     finalg = ChannelBlend_Subtract(srcg,destg);
-                     finalb = ChannelBlend_Subtract(srcb,destb);    
-                     break;  
-                     
-                case 6:
-                     
-                     
-                     finalr = ChannelBlend_Difference(srcr,destr);                    
-                     finalg = ChannelBlend_Difference(srcg,destg);
-                     finalb = ChannelBlend_Difference(srcb,destb);    
-                     break;  
-                     
-                case 7:
-                     
-                     
-                     finalr = ChannelBlend_Negation(srcr,destr);                    
-                     finalg = ChannelBlend_Negation(srcg,destg);
-                     finalb = ChannelBlend_Negation(srcb,destb);    
-                     break;  
-                     
-                case 8:
-                     
-                     
-                     finalr = ChannelBlend_Screen(srcr,destr);                    
-                     finalg = ChannelBlend_Screen(srcg,destg);
-                     finalb = ChannelBlend_Screen(srcb,destb);    
-                     break;                                                                                                       
-                       
-                                
-                case 9:
-                     
-                     
-                     finalr = ChannelBlend_Exclusion(srcr,destr);                    
-                     finalg = ChannelBlend_Exclusion(srcg,destg);
-                     finalb = ChannelBlend_Exclusion(srcb,destb);    
-                     break;                                                                                                       
-                       
-                
-                case 10:
-                     
-                     
-                     finalr = ChannelBlend_Overlay(srcr,destr);                    
-                     finalg = ChannelBlend_Overlay(srcg,destg);
-                     finalb = ChannelBlend_Overlay(srcb,destb);    
-                     break;                                                                                                       
-                       
-                
-                case 11:
-                     
-                     
-                     finalr = ChannelBlend_SoftLight(srcr,destr);                    
-                     finalg = ChannelBlend_SoftLight(srcg,destg);
-                     finalb = ChannelBlend_SoftLight(srcb,destb);    
-                     break; 
-                     
-                case 12:
-                     
-                     
-                     finalr = ChannelBlend_HardLight(srcr,destr);                    
-                     finalg = ChannelBlend_HardLight(srcg,destg);
-                     finalb = ChannelBlend_HardLight(srcb,destb);    
-                     break;   
-                     
-                case 13:
-                     
-                     
-                     finalr = ChannelBlend_ColorDodge(srcr,destr);                    
-                     finalg = ChannelBlend_ColorDodge(srcg,destg);
-                     finalb = ChannelBlend_ColorDodge(srcb,destb);    
-                     break;   
-                     
-                case 14:
-                     
-                     
-                     finalr = ChannelBlend_ColorBurn(srcr,destr);                    
-                     finalg = ChannelBlend_ColorBurn(srcg,destg);
-                     finalb = ChannelBlend_ColorBurn(srcb,destb);    
-                     break;   
-                     
-                case 15:
-                     
-                     
-                     finalr = ChannelBlend_LinearDodge(srcr,destr);                    
-                     finalg = ChannelBlend_LinearDodge(srcg,destg);
-                     finalb = ChannelBlend_LinearDodge(srcb,destb);    
-                     break;   
-                     
-                case 16:
-                     
-                     
-                     finalr = ChannelBlend_LinearBurn(srcr,destr);                    
-                     finalg = ChannelBlend_LinearBurn(srcg,destg);
-                     finalb = ChannelBlend_LinearBurn(srcb,destb);    
-                     break;                                                                                                                                                                                                                  
-                       
-                 
-                
-                case 17:
-                     
-                     
-                     finalr = ChannelBlend_LinearLight(srcr,destr);                    
-                     finalg = ChannelBlend_LinearLight(srcg,destg);
-                     finalb = ChannelBlend_LinearLight(srcb,destb);    
-                     break;                                                                                                                                                                                                                  
-                       
-                
-                
-                case 18:
-                     
-                     
-                     finalr = ChannelBlend_VividLight(srcr,destr);                    
-                     finalg = ChannelBlend_VividLight(srcg,destg);
-                     finalb = ChannelBlend_VividLight(srcb,destb);    
-                     break;   
-                     
-                case 19:
-                     
-                     
-                     finalr = ChannelBlend_PinLight(srcr,destr);                    
-                     finalg = ChannelBlend_PinLight(srcg,destg);
-                     finalb = ChannelBlend_PinLight(srcb,destb);    
-                     break; 
-
-                case 20:
-                     
-                     
-                     finalr = ChannelBlend_HardMix(srcr,destr);                    
-                     finalg = ChannelBlend_HardMix(srcg,destg);
-                     finalb = ChannelBlend_HardMix(srcb,destb);    
-                     break;                                                                                                                                                                                                                                                          
-                     
-                case 21:
-                     
-                     
-                     finalr = ChannelBlend_Reflect(srcr,destr);                    
-                     finalg = ChannelBlend_Reflect(srcg,destg);
-                     finalb = ChannelBlend_Reflect(srcb,destb);    
-                     break;   
-                     
-                case 22:
-                     
-                     
-                     finalr = ChannelBlend_Glow(srcr,destr);                    
-                     finalg = ChannelBlend_Glow(srcg,destg);
-                     finalb = ChannelBlend_Glow(srcb,destb);    
-                     break; 
-                     
-                case 23:
-                     
-                     
-                     finalr = ChannelBlend_Phoenix(srcr,destr);                    
-                     finalg = ChannelBlend_Phoenix(srcg,destg);
-                     finalb = ChannelBlend_Phoenix(srcb,destb);    
-                     break;                                                              
-                       
-                } 
-                                                               
-                finala = 255-(255-srca)*(255-desta)/255;                                              
-                finalr = srca*finalr/finala + desta*destr*(255-srca)/finala/255;
-                finalg = srca*finalg/finala + desta*destg*(255-srca)/finala/255;
-                finalb = srca*finalb/finala + desta*destb*(255-srca)/finala/255;
-                col = makeacol32(finalr, finalg, finalb, finala);
-                destlongbuffer[desty][destx] = col;
-            
-            }
-            
-            
-          }    
-               
-    }      
+    const int mode_count = sizeof(DrawSpriteModes) / sizeof(DrawSpriteModes[0]);
+    const DrawSpriteAreaFn draw_fn = (DrawMode >= 0 && DrawMode < mode_count) ?
+        DrawSpriteModes[DrawMode] : DrawSpriteArea<0>;
+    draw_fn(srclongbuffer, destlongbuffer, x, y, startx, starty, srcWidth, srcHeight, trans);
     
     engine->ReleaseBitmapSurface(src);
     engine->ReleaseBitmapSurface(dest);
-    engine->NotifySpriteUpdated(destination);
+    NotifySpriteAreaUpdated(destination, startx + x, starty + y, srcWidth + x - 1, srcHeight + y - 1);
     return 0;
     
 }
@@ -725,69 +570,41 @@ int DrawAdd(int destination, int sprite, int x, int y, float scale){
     if (srcWidth + x > destWidth) srcWidth = destWidth - x - 1;
     if (srcHeight + y > destHeight) srcHeight = destHeight - y - 1;
 
-    int destx, desty; 
-    int srcr, srcg, srcb, srca, destr, destg, destb, desta, finalr, finalg, finalb, finala;
-    unsigned int col;
-    int ycount = 0;
-    int xcount = 0;
-
     int starty = 0;
     int startx = 0;
 
     if (x < 0) startx = -1 * x;
     if (y < 0) starty = -1 * y;
 
-
-
-    for(ycount = starty; ycount<srcHeight; ycount ++){
-            
-        for(xcount = startx; xcount<srcWidth; xcount ++){
-            
-            destx = xcount + x;
-            desty = ycount + y;
-                       
-            srca =  (geta32(srclongbuffer[ycount][xcount]));
-            
-            if (srca != 0) {
-                     
-                     
-                srcr =  getr32(srclongbuffer[ycount][xcount]) * srca / 255 * scale;  
-                srcg =  getg32(srclongbuffer[ycount][xcount]) * srca / 255 * scale;
-                srcb =  getb32(srclongbuffer[ycount][xcount]) * srca / 255 * scale;
-                desta =  geta32(destlongbuffer[desty][destx]);
-                
-                if (desta == 0){
-                   destr = 0;
-                   destg = 0;
-                   destb = 0;          
-                          
-                }
-                else {                          
-                destr =  getr32(destlongbuffer[desty][destx]);
-                destg =  getg32(destlongbuffer[desty][destx]);
-                destb =  getb32(destlongbuffer[desty][destx]);
-                }
-                
-                finala = 255-(255-srca)*(255-desta)/255;
-                finalr = Clamp(srcr + destr, 0, 255);
-                finalg = Clamp(srcg + destg, 0, 255);
-                finalb = Clamp(srcb + destb, 0, 255);
-                col = makeacol32(finalr, finalg, finalb, finala);
-                destlongbuffer[desty][destx] = col;
-            
-            }
-            
-          }    
-               
-    }      
+    for (int ycount = starty; ycount < srcHeight; ycount++) {
+        const unsigned int *src_row = srclongbuffer[ycount];
+        unsigned int *dest_row = destlongbuffer[ycount + y];
+        for (int xcount = startx; xcount < srcWidth; xcount++) {
+            const unsigned int src_col = src_row[xcount];
+            const int srca = geta32(src_col);
+            if (srca == 0)
+                continue;
+
+            const int srcr = getr32(src_col) * srca / 255 * scale;
+            const int srcg = getg32(src_col) * srca / 255 * scale;
+            const int srcb = getb32(src_col) * srca / 255 * scale;
+            const unsigned int dest_col = dest_row[xcount + x];
+            const int desta = geta32(dest_col);
+            // a fully transparent destination pixel is treated as black
+            const int destr = (desta == 0) ? 0 : getr32(dest_col);
+            const int destg = (desta == 0) ? 0 : getg32(dest_col);
+            const int destb = (desta == 0) ? 0 : getb32(dest_col);
+
+            const int finala = 255-(255-srca)*(255-desta)/255;
+            dest_row[xcount + x] = makeacol32(Clamp(srcr + destr, 0, 255),
+                Clamp(srcg + destg, 0, 255), Clamp(srcb + destb, 0, 255), finala);
+        }
+    }
     
     engine->ReleaseBitmapSurface(src);
     engine->ReleaseBitmapSurface(dest);
-    engine->NotifySpriteUpdated(destination);
+    NotifySpriteAreaUpdated(destination, startx + x, starty + y, srcWidth + x - 1, srcHeight + y - 1);
     return 0;
-    
-    
-    
 }
 
 
@@ -816,55 +633,30 @@ int DrawAlpha(int destination, int sprite, int x, int y, int trans)
     if (srcWidth + x > destWidth) srcWidth = destWidth - x - 1;
     if (srcHeight + y > destHeight) srcHeight = destHeight - y - 1;
 
-    int destx, desty; 
-    int srcr, srcg, srcb, srca, destr, destg, destb, desta, finalr, finalg, finalb, finala;
-    
-    int ycount = 0;
-    int xcount = 0;
-
 	int starty = 0;
     int startx = 0;
 
     if (x < 0) startx = -1 * x;
     if (y < 0) starty = -1 * y;
 
-
-    for(ycount = starty; ycount<srcHeight; ycount ++){
-            
-        for(xcount = startx; xcount<srcWidth; xcount ++){
-            
-            destx = xcount + x;
-            desty = ycount + y;
-                       
-            srca =  (geta32(srclongbuffer[ycount][xcount])) * trans / 100;
-            
-            if (srca != 0) {
-                     
-                srcr =  getr32(srclongbuffer[ycount][xcount]);  
-                srcg =  getg32(srclongbuffer[ycount][xcount]);
-                srcb =  getb32(srclongbuffer[ycount][xcount]);
-    
-                destr =  getr32(destlongbuffer[desty][destx]);
-                destg =  getg32(destlongbuffer[desty][destx]);
-                destb =  getb32(destlongbuffer[desty][destx]);
-                desta =  geta32(destlongbuffer[desty][destx]);
-
-                finala = 255-(255-srca)*(255-desta)/255;
-                finalr = srca*srcr/finala + desta*destr*(255-srca)/finala/255;
-                finalg = srca*srcg/finala + desta*destg*(255-srca)/finala/255;
-                finalb = srca*srcb/finala + desta*destb*(255-srca)/finala/255;
-                
-                destlongbuffer[desty][destx] = makeacol32(finalr, finalg, finalb, finala);
-            
-            }
-            
-          }    
-               
-    }      
+    for (int ycount = starty; ycount < srcHeight; ycount++) {
+        const unsigned int *src_row = srclongbuffer[ycount];
+        unsigned int *dest_row = destlongbuffer[ycount + y];
+        for (int xcount = startx; xcount < srcWidth; xcount++) {
+            const unsigned int src_col = src_row[xcount];
+            const int srca = geta32(src_col) * trans / 100;
+            if (srca == 0)
+                continue;
+
+            const unsigned int dest_col = dest_row[xcount + x];
+            dest_row[xcount + x] = ComposePixel(getr32(src_col), getg32(src_col), getb32(src_col), srca,
+                getr32(dest_col), getg32(dest_col), getb32(dest_col), geta32(dest_col));
+        }
+    }
     
     engine->ReleaseBitmapSurface(src);
     engine->ReleaseBitmapSurface(dest);
-    engine->NotifySpriteUpdated(destination);
+    NotifySpriteAreaUpdated(destination, startx + x, starty + y, srcWidth + x - 1, srcHeight + y - 1);
     
     return 0;
 }
@@ -2104,6 +2104,7 @@ void AGS_EngineShutdown() {
 	delete [] Reflection.Characters;
 	delete [] Reflection.Objects;
 	//QuitCleanup ();
+	Stop_RaycastWorkers ();
 }
 
 
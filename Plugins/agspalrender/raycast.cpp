@@ -28,6 +28,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <stdio.h>
 #include <math.h>
 
@@ -81,7 +86,8 @@ namespace agspalrender {
  unsigned char **transalphabuffer;
  double **transzbuffer;
  bool *transslicedrawn;
- int *transwallblendmode;
+ int **transwallblendmode;
+ int *transwallcounts;
  double **ZBuffer;
  double *distTable;
  short *interactionmap;
@@ -728,14 +734,14 @@ int Ray_GetHotspotAt (int x,int y)
 {
 	if (!interactionmap) return -1;
 	else if (x > sWidth || x < 0 || y > sHeight || y < 0) return -1;
-	else return interactionmap [x*sWidth+y] & 0x00FF;
+	else return interactionmap [x*sHeight+y] & 0x00FF;
 }
 
 int Ray_GetObjectAt (int x,int y)
 {
 	if (!interactionmap) return -1;
 	else if (x > sWidth || x < 0 || y > sHeight || y < 0) return -1;
-	else return interactionmap [x*sWidth+y] >> 8;
+	else return interactionmap [x*sHeight+y] >> 8;
 }
 
 FLOAT_RETURN_TYPE Ray_GetDistanceAt (int x,int y)
@@ -765,7 +771,8 @@ void Init_Raycaster ()
 	transalphabuffer = new unsigned char*[sWidth];
 	transslicedrawn = new bool[sWidth]();
 	transzbuffer = new double*[sWidth];
-	transwallblendmode = new int [mapWidth]();
+	transwallblendmode = new int*[sWidth];
+	transwallcounts = new int[sWidth]();
 	ZBuffer = new double*[sWidth];
 	distTable = new double[sHeight+(sHeight>>1)];
 	interactionmap = new short[sWidth*sHeight]();
@@ -779,53 +786,126 @@ void Init_Raycaster ()
 	  transalphabuffer[x] = new unsigned char [sHeight*(mapWidth)]();
 	  transzbuffer[x] = new double [sHeight*(mapWidth)]();
 	  ZBuffer[x] = new double [sHeight]();
+	  transwallblendmode[x] = new int [mapWidth]();
 	  transslicedrawn [x] = false;
 	}
 }
 
-bool rendering;
-void Raycast_Render (int slot)
+// Number of the screen columns, which a worker takes at once
+#define COLUMN_CHUNK 8
+
+// A pool of worker threads, which render the screen columns along with
+// the game's thread. Every column only writes into its own part of the
+// buffers, so the columns may be rendered in any order.
+class ColumnWorkers
+{
+public:
+	~ColumnWorkers () { Stop (); }
+	// Calls render (x) for every column in [0, count), blocks until all are done
+	void Run (int count, const std::function<void(int)> &render);
+	// Stops and joins the worker threads
+	void Stop ();
+
+private:
+	void WorkerLoop (unsigned generation);
+	// Renders the chunks of columns, until there are none left
+	void Work ();
+
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable start_cv;
+	std::condition_variable done_cv;
+	const std::function<void(int)> *job = nullptr;
+	int column_count = 0;
+	std::atomic<int> next_column {0};
+	size_t running = 0; // number of the workers busy with the current job
+	unsigned generation = 0; // the current job's number
+	bool stop = false;
+};
+
+void ColumnWorkers::Run (int count, const std::function<void(int)> &render)
+{
+	if (threads.empty ())
+	{
+		const unsigned cpus = std::thread::hardware_concurrency ();
+		const unsigned num = std::min (cpus > 1 ? cpus - 1 : 0u, 7u);
+		for (unsigned i = 0; i < num; i++)
+			threads.emplace_back (&ColumnWorkers::WorkerLoop, this, generation);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		job = &render;
+		column_count = count;
+		next_column = 0;
+		running = threads.size ();
+		generation++;
+	}
+	start_cv.notify_all ();
+	Work ();
+	std::unique_lock<std::mutex> lock (mutex);
+	done_cv.wait (lock, [this]() { return running == 0; });
+	job = nullptr;
+}
+
+void ColumnWorkers::Stop ()
 {
-	ambientweight = 0;
-	raycastOn = true;
-	double playerrad = atan2 (dirY,dirX)+(2.0 * PI);
-	rendering=true;
-	int32 w=sWidth,h=sHeight;
-	BITMAP *screen = engine->GetSpriteGraphic (slot);
-	if (!screen) engine->AbortGame ("Raycast_Render: No valid sprite to draw on.");
-	engine->GetBitmapDimensions (screen,&w,&h,nullptr);
-	BITMAP *sbBm = engine->GetSpriteGraphic (skybox);
-	if (!sbBm) engine->AbortGame ("Raycast_Render: No valid skybox sprite.");
-	if (skybox > 0)
 	{
-		int bgdeg = (int)((playerrad / PI) * 180.0)+180;
-		int xoffset = (int)(playerrad*320.0);
-		BITMAP *virtsc = engine->GetVirtualScreen ();
-		engine->SetVirtualScreen (screen);
-		xoffset = abs(xoffset % w);
-		if (xoffset > 0)
-		{
-			engine->BlitBitmap (xoffset-320,1,sbBm,false);
-		}
-		engine->BlitBitmap (xoffset,1,sbBm,false);
-		engine->SetVirtualScreen (virtsc);
+		std::lock_guard<std::mutex> lock (mutex);
+		stop = true;
+	}
+	start_cv.notify_all ();
+	for (auto &thread : threads)
+		thread.join ();
+	threads.clear ();
+	stop = false;
+}
+
+void ColumnWorkers::WorkerLoop (unsigned last_generation)
+{
+	std::unique_lock<std::mutex> lock (mutex);
+	for (;;)
+	{
+		start_cv.wait (lock, [&]() { return stop || generation != last_generation; });
+		if (stop) return;
+		last_generation = generation;
+		lock.unlock ();
+		Work ();
+		lock.lock ();
+		if (--running == 0) done_cv.notify_one ();
 	}
+}
+
+void ColumnWorkers::Work ()
+{
+	for (;;)
+	{
+		const int from = next_column.fetch_add (COLUMN_CHUNK);
+		if (from >= column_count) return;
+		const int to = std::min (column_count, from + COLUMN_CHUNK);
+		for (int x = from; x < to; x++)
+			(*job) (x);
+	}
+}
+
+static ColumnWorkers column_workers;
+
+void Stop_RaycastWorkers ()
+{
+	column_workers.Stop ();
+}
+
+// Casts the screen column, and draws its walls, floor and ceiling;
+// returns the number of the column's pixels lit by the ambient light
+static int Raycast_RenderColumn (int x, int w, int h, unsigned char **buffer)
+{
+	int ambientcount = 0;
 	int transwallcount = 0;
-	unsigned char** buffer = engine->GetRawBitmapSurface (screen);
-	for (int x = 0;x<w;x++)
+	transslicedrawn [x] = false;
+	for (int y=0;y<h;y++)
 	{
-		transslicedrawn [x] = false;
-		for (int y=0;y<h;y++)
-		{
-			ZBuffer[x][y] = 0;
-		}
+		ZBuffer[x][y] = 0;
 	}
-	int multiplier = mapWidth;
-	memset (interactionmap,0,sizeof(short)*(sHeight*sWidth));
-  //start the main loop
-    for(int x = 0; x < w; x++)
-    {
-	  transwallcount=0;
       //calculate ray position and direction 
       double cameraX = 2 * x / double(w) - 1; //x-coordinate in camera space     
       double rayPosX = posX;
@@ -1056,10 +1136,10 @@ void Raycast_Render (int slot)
 							if (wallData[worldMap[mapX][mapY]].alpha[texside] == 255 && wallData[worldMap[mapX][mapY]].mask[texside] == 0)
 							{
 							buffer[y][x] = color;
-							if (ambientpixels) ambientweight++;
+							if (ambientpixels) ambientcount++;
 							//SET THE ZBUFFER FOR THE SPRITE CASTING
 							ZBuffer[x][y] = perpWallDist; //perpendicular distance is used
-							interactionmap [x*sWidth+y] = wallData[worldMap[mapX][mapY]].hotspotinteract;
+							interactionmap [x*sHeight+y] = wallData[worldMap[mapX][mapY]].hotspotinteract;
 							editorMap [x][y] = ((short)mapX)<<16 | ((short)mapY);
 							}
 							else
@@ -1071,10 +1151,10 @@ void Raycast_Render (int slot)
 									//memset (transzbuffer[x],0,sizeof(double)*(sHeight*mapWidth));
 									transslicedrawn[x] = true;
 								}
-								transwallblendmode[transwallcount] = wallData[worldMap[mapX][mapY]].blendtype[texside];
+								transwallblendmode[x][transwallcount] = wallData[worldMap[mapX][mapY]].blendtype[texside];
 								int transwalloffset = transwallcount*h;
 								transcolorbuffer[x][transwalloffset+y] = color;
-								if (ambientpixels) ambientweight++;
+								if (ambientpixels) ambientcount++;
 								if (wallData[worldMap[mapX][mapY]].mask[texside] == 0) transalphabuffer[x][transwalloffset+y] = wallData[worldMap[mapX][mapY]].alpha[texside];
 								else 
 								{
@@ -1227,7 +1307,7 @@ void Raycast_Render (int slot)
 			if (ceilingcolor == 0)
 			{
 				lighting = std::max (lighting,ambientlight);
-				ambientweight ++;
+				ambientcount ++;
 			}
 			if (lighting < 255)
 			{
@@ -1247,7 +1327,7 @@ void Raycast_Render (int slot)
 						{
 						ZBuffer[x][ny] = currentDist; //perpendicular distance is used
 						buffer[ny][x] = floorcolor;
-						interactionmap [x*sWidth+ny] = 0;
+						interactionmap [x*sHeight+ny] = 0;
 						editorMap [x][ny] = ((short)mapX)<<16 | ((short)mapY);
 						}
 					}
@@ -1284,7 +1364,7 @@ void Raycast_Render (int slot)
 			if (ceilingcolor == 0) 
 			{
 				lighting = std::max (lighting,ambientlight);
-				ambientweight++;
+				ambientcount++;
 			}
 			if (lighting < 255)
 			{
@@ -1305,7 +1385,7 @@ void Raycast_Render (int slot)
 						{
 						ZBuffer[x][ny] = currentDist; //perpendicular distance is used
 						buffer[ny][x] = floorcolor;
-						interactionmap [x*sWidth+ny] = 0;
+						interactionmap [x*sHeight+ny] = 0;
 						editorMap [x][ny] = ((short)cmapX)<<16 | ((short)cmapY);
 						}
 					}
@@ -1332,8 +1412,8 @@ void Raycast_Render (int slot)
 				else ZBuffer[x][h-y] = 999999999999.0;
 				editorMap [x][h-y] = ((short)cmapX)<<16 | ((short)cmapY);
 			}
-			interactionmap [x*sWidth+y] = 0;
-			interactionmap [x*sWidth+(h-y)] = 0;
+			interactionmap [x*sHeight+y] = 0;
+			interactionmap [x*sHeight+(h-y)] = 0;
 			if ((int)cmapX == selectedX && (int)cmapY == selectedY)
 			{
 				if (floorTexX == 0 || floorTexX == 63 || floorTexY == 0 || floorTexY == 63)
@@ -1359,15 +1439,55 @@ void Raycast_Render (int slot)
 				int color = transcolorbuffer[x][transwalloffset+y];
 				if (color !=0) 
 				{
-					  if (transwallblendmode[transwalldrawn] == 0) buffer[y][x] = Mix::MixColorAlpha (color,buffer[y][x],transalphabuffer[x][transwalloffset+y]); //paint pixel if it isn't black, black is the invisible color
-					  else if (transwallblendmode[transwalldrawn] == 1) buffer[y][x] = Mix::MixColorAdditive (color,buffer[y][x],transalphabuffer[x][transwalloffset+y]);
+					  if (transwallblendmode[x][transwalldrawn] == 0) buffer[y][x] = Mix::MixColorAlpha (color,buffer[y][x],transalphabuffer[x][transwalloffset+y]); //paint pixel if it isn't black, black is the invisible color
+					  else if (transwallblendmode[x][transwalldrawn] == 1) buffer[y][x] = Mix::MixColorAdditive (color,buffer[y][x],transalphabuffer[x][transwalloffset+y]);
 					  //if (ZBuffer[x][y] > transzbuffer[transwalldrawn*h+y]) ZBuffer[x][y] = transzbuffer[transwalldrawn*h+y]; //put the sprite on the zbuffer so we can draw around it.
 			    }
 		    }
 		}
 	  }
 		//End of wall loop.
-    }
+	transwallcounts[x] = transwallcount;
+	return ambientcount;
+}
+
+
+bool rendering;
+void Raycast_Render (int slot)
+{
+	ambientweight = 0;
+	raycastOn = true;
+	double playerrad = atan2 (dirY,dirX)+(2.0 * PI);
+	rendering=true;
+	int32 w=sWidth,h=sHeight;
+	BITMAP *screen = engine->GetSpriteGraphic (slot);
+	if (!screen) engine->AbortGame ("Raycast_Render: No valid sprite to draw on.");
+	engine->GetBitmapDimensions (screen,&w,&h,nullptr);
+	BITMAP *sbBm = engine->GetSpriteGraphic (skybox);
+	if (!sbBm) engine->AbortGame ("Raycast_Render: No valid skybox sprite.");
+	if (skybox > 0)
+	{
+		int bgdeg = (int)((playerrad / PI) * 180.0)+180;
+		int xoffset = (int)(playerrad*320.0);
+		BITMAP *virtsc = engine->GetVirtualScreen ();
+		engine->SetVirtualScreen (screen);
+		xoffset = abs(xoffset % w);
+		if (xoffset > 0)
+		{
+			engine->BlitBitmap (xoffset-320,1,sbBm,false);
+		}
+		engine->BlitBitmap (xoffset,1,sbBm,false);
+		engine->SetVirtualScreen (virtsc);
+	}
+	unsigned char** buffer = engine->GetRawBitmapSurface (screen);
+	memset (interactionmap,0,sizeof(short)*(sHeight*sWidth));
+  //start the main loop
+	std::atomic<int> ambientcount (0);
+	column_workers.Run (w, [&](int x)
+	{
+		ambientcount += Raycast_RenderColumn (x, w, h, buffer);
+	});
+	ambientweight = ambientcount;
     
 	
     //SPRITE CASTING
@@ -1491,7 +1611,7 @@ void Raycast_Render (int slot)
         {
 		  if (spriteTransformY[i] < ZBuffer[stripe][y])
 		  {
-			  if (transslicedrawn[stripe]) while ((transzbuffer[stripe][transwalldraw*h+y] > spriteTransformY[i] && transzbuffer[stripe][transwalldraw*h+y] != 0) && (transwalldraw < transwallcount)) transwalldraw++;
+			  if (transslicedrawn[stripe]) while ((transzbuffer[stripe][transwalldraw*h+y] > spriteTransformY[i] && transzbuffer[stripe][transwalldraw*h+y] != 0) && (transwalldraw < transwallcounts[stripe])) transwalldraw++;
 			int d = (y-vMoveScreen) * 256 - h * 128 + spriteHeight * 128; //256 and 128 factors to avoid floats
 			//int texY = ((d * texHeight) / spriteHeight) / 256;
 			int texY = ((d * sprh) / spriteHeight) / 256;
@@ -1508,8 +1628,8 @@ void Raycast_Render (int slot)
 				  color = Mix::MixColorLightLevel (color,spr_light);
 				  if (transzbuffer[stripe][transwalldraw*h+y] < spriteTransformY[i] && transzbuffer[stripe][transwalldraw*h+y] != 0 && transslicedrawn[stripe] && transcolorbuffer[stripe][transwalldraw*h+y] > 0 && transalphabuffer[stripe][transwalldraw*h+y]>0) 
 				  {
-					  if (transwallblendmode[transwalldraw] == 0) color = Mix::MixColorAlpha (color,transcolorbuffer[stripe][transwalldraw*h+y],transalphabuffer[stripe][transwalldraw*h+y]);
-					  else if (transwallblendmode[transwalldraw] == 1) color = Mix::MixColorAdditive (color,transcolorbuffer[stripe][transwalldraw*h+y],transalphabuffer[stripe][transwalldraw*h+y]);
+					  if (transwallblendmode[stripe][transwalldraw] == 0) color = Mix::MixColorAlpha (color,transcolorbuffer[stripe][transwalldraw*h+y],transalphabuffer[stripe][transwalldraw*h+y]);
+					  else if (transwallblendmode[stripe][transwalldraw] == 1) color = Mix::MixColorAdditive (color,transcolorbuffer[stripe][transwalldraw*h+y],transalphabuffer[stripe][transwalldraw*h+y]);
 					  buffer[y][stripe] = color;
 					  ZBuffer[stripe][y] = transzbuffer[stripe][transwalldraw*h+y];
 				  }
@@ -1518,7 +1638,7 @@ void Raycast_Render (int slot)
 				  buffer[y][stripe] = color; //paint pixel if it isn't black, black is the invisible color
 				  ZBuffer[stripe][y] = spriteTransformY[i]; //put the sprite on the zbuffer so we can draw around it.
 				  }
-				  interactionmap [stripe*sWidth+y] = sprite[spriteOrder[i]].objectinteract<<8;
+				  interactionmap [stripe*sHeight+y] = sprite[spriteOrder[i]].objectinteract<<8;
 			}
 		  }
         }
@@ -1541,12 +1661,14 @@ void QuitCleanup ()
 				if (transalphabuffer[i])delete [] transalphabuffer[i];
 				if (transzbuffer[i])delete [] transzbuffer[i];
 				if (ZBuffer[i]) delete [] ZBuffer[i];
+				if (transwallblendmode[i]) delete [] transwallblendmode[i];
 			}	
 			if (transcolorbuffer) delete [] transcolorbuffer;
 			if (transalphabuffer) delete [] transalphabuffer;
 			if (transzbuffer) delete [] transzbuffer;
 			if (ZBuffer) delete [] ZBuffer;
 			if (transwallblendmode) delete [] transwallblendmode;
+			if (transwallcounts) delete [] transwallcounts;
 			if (interactionmap) delete [] interactionmap;
 		}
 }
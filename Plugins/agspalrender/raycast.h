@@ -78,7 +78,8 @@ struct Sprite
  extern unsigned char **transalphabuffer;
  extern double **transzbuffer;
  extern bool *transslicedrawn;
- extern int *transwallblendmode;
+ extern int **transwallblendmode;
+ extern int *transwallcounts;
  extern double **ZBuffer;
  extern double *distTable;
  extern short *interactionmap;
@@ -94,6 +95,7 @@ void RotateLeft ();
 void RotateRight ();
 void Init_Raycaster ();
 void QuitCleanup ();
+void Stop_RaycastWorkers ();
 void LoadMap (int worldmapSlot,int lightmapSlot,int ceilingmapSlot,int floormapSlot);
 void Ray_InitSprite (int id, SCRIPT_FLOAT(x), SCRIPT_FLOAT(y), int slot, unsigned char alpha, int blendmode, SCRIPT_FLOAT(scale_x), SCRIPT_FLOAT(scale_y), SCRIPT_FLOAT(vMove));
 void Ray_SetPlayerPosition (SCRIPT_FLOAT(x),SCRIPT_FLOAT(y));
@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include "data/mfl_utils.h"
 #include "util/file.h"
+#include "util/jobscheduler.h"
 #include "util/multifilelib.h"
 #include "util/path.h"
 #include "util/stdio_compat.h"
@@ -17,10 +18,18 @@
 using namespace AGS::Common;
 using namespace AGS::DataUtil;
 
+// Max number of threads reading the assets, when chosen automatically
+const size_t MaxAutoThreads = 8;
+
 const char *HELP_STRING = "Usage: agspak <input-dir> <output-pak> [OPTIONS]\n"
 "Options:\n"
+"  -c             compress assets (requires a newer engine to read the pack)\n"
+"  -j <N>         number of threads reading the assets, 0 to choose\n"
+"                 automatically (default)\n"
 "  -p <MB>        split game assets between partitions of this size max\n"
-"  -r             recursive mode: include all subdirectories too";
+"  -r             recursive mode: include all subdirectories too\n"
+"  -t <file>      order assets by the first use, according to the asset trace\n"
+"                 recorded by the engine (see \"asset_trace\" config option)";
 
 int main(int argc, char *argv[])
 {
@@ -44,12 +53,21 @@ int main(int argc, char *argv[])
 
     size_t part_size = 0;
     bool do_subdirs = false;
+    bool do_compress = false;
+    int thread_count = 0;
+    String trace_file;
     for (int i = 3; i < argc; ++i)
     {
         if (ags_stricmp(argv[i], "-p") == 0 && (i < argc - 1))
             part_size = StrUtil::StringToInt(argv[++i]);
+        else if (ags_stricmp(argv[i], "-c") == 0)
+            do_compress = true;
+        else if (ags_stricmp(argv[i], "-j") == 0 && (i < argc - 1))
+            thread_count = StrUtil::StringToInt(argv[++i]);
         else if (ags_stricmp(argv[i], "-r") == 0)
             do_subdirs = true;
+        else if (ags_stricmp(argv[i], "-t") == 0 && (i < argc - 1))
+            trace_file = argv[++i];
     }
 
     const char *src = argv[1];
@@ -83,6 +101,23 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    if (!trace_file.IsEmpty())
+    {
+        err = OrderAssetsByTrace(assets, trace_file);
+        if (!err)
+        {
+            printf("Error: failed to order assets by trace:\n");
+            printf("%s\n", err->FullMessage().GetCStr());
+            return -1;
+        }
+    }
+
+    if (do_compress)
+    {
+        for (auto &asset : assets)
+            asset.Compression = kAssetCompress_LZ4Block;
+    }
+
     AssetLibInfo lib;
     soff_t part_size_b = part_size * 1024 * 1024; // MB to bytes
     err = MakeAssetLib(lib, lib_basefile, assets, part_size_b);
@@ -97,7 +132,11 @@ int main(int argc, char *argv[])
     // Write pack file
     //-----------------------------------------------------------------------//
     String lib_dir = Path::GetParent(lib_basefile);
-    err = WriteLibrary(lib, asset_dir, lib_dir, MFLUtil::kMFLVersion_MultiV30);
+    const MFLUtil::MFLVersion lib_version = do_compress ?
+        MFLUtil::kMFLVersion_MultiV31 : MFLUtil::kMFLVersion_MultiV30;
+    JobScheduler::InitGlobal(JobScheduler::ResolveThreadCount(thread_count, MaxAutoThreads) - 1);
+    err = WriteLibrary(lib, asset_dir, lib_dir, lib_version);
+    JobScheduler::ShutdownGlobal();
     if (!err)
     {
         printf("Error: failed to write pack file:\n");
@@ -1,16 +1,27 @@
 #include <algorithm>
+#include <regex>
 #include <stdio.h>
 #include "data/mfl_utils.h"
 #include "util/file.h"
+#include "util/jobscheduler.h"
 #include "util/multifilelib.h"
 #include "util/path.h"
 #include "util/stdio_compat.h"
 #include "util/string_compat.h"
+#include "util/string_utils.h"
 
 using namespace AGS::Common;
 using namespace AGS::DataUtil;
 
-const char *HELP_STRING = "Usage: agsunpak <input-pak> <output-dir>";
+// Max number of threads extracting the assets, when chosen automatically
+const size_t MaxAutoThreads = 8;
+
+const char *HELP_STRING = "Usage: agsunpak <input-pak> <output-dir> [OPTIONS]\n"
+"Options:\n"
+"  -f <wildcard>  extract only the assets matching the wildcard, such as\n"
+"                 \"*.ogg\" or \"speech/ego*\"; may be given multiple times\n"
+"  -j <N>         number of threads extracting the assets, 0 to choose\n"
+"                 automatically (default)";
 
 int main(int argc, char *argv[])
 {
@@ -32,6 +43,16 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    std::vector<String> filters;
+    int thread_count = 0;
+    for (int i = 3; i < argc; ++i)
+    {
+        if (ags_stricmp(argv[i], "-f") == 0 && (i < argc - 1))
+            filters.push_back(argv[++i]);
+        else if (ags_stricmp(argv[i], "-j") == 0 && (i < argc - 1))
+            thread_count = StrUtil::StringToInt(argv[++i]);
+    }
+
     const char *src = argv[1];
     const char *dst = argv[2];
     printf("Input pack file: %s\n", src);
@@ -67,6 +88,33 @@ int main(int argc, char *argv[])
         printf("Pack file has no assets.\nDone.\n");
         return 0;
     }
+
+    if (filters.size() > 0)
+    {
+        std::vector<std::regex> regexes;
+        for (const auto &f : filters)
+        {
+            String wildcard = f;
+            wildcard.Replace('\\', '/');
+            regexes.emplace_back(StrUtil::WildcardToRegex(wildcard).GetCStr(), std::regex_constants::icase);
+        }
+        auto &assets = lib.AssetInfos;
+        assets.erase(std::remove_if(assets.begin(), assets.end(),
+            [&regexes](const AssetInfo &asset)
+            {
+                String name = asset.FileName;
+                name.Replace('\\', '/');
+                for (const auto &re : regexes)
+                    if (std::regex_match(name.GetCStr(), re))
+                        return false;
+                return true;
+            }), assets.end());
+        if (assets.size() == 0)
+        {
+            printf("No assets match the given filters.\nDone.\n");
+            return 0;
+        }
+    }
     
     //-----------------------------------------------------------------------//
     // Extract files
@@ -77,7 +125,9 @@ int main(int argc, char *argv[])
     // file we just opened, because it may be different from the name
     // saved in lib; e.g. if the lib was attached to *.exe.
     lib.LibFileNames[0] = lib_basefile;
+    JobScheduler::InitGlobal(JobScheduler::ResolveThreadCount(thread_count, MaxAutoThreads) - 1);
     HError err = UnpackLibrary(lib, lib_dir, dst);
+    JobScheduler::ShutdownGlobal();
     if (!err)
     {
         printf("Failed unpacking the library\n%s", err->FullMessage().GetCStr());
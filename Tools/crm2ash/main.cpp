@@ -1,37 +1,53 @@
+#include <atomic>
 #include <stdio.h>
 #include "data/room_utils.h"
 #include "data/scriptgen.h"
-#include "util/data_ext.h"
 #include "util/file.h"
+#include "util/jobscheduler.h"
 #include "util/string_compat.h"
+#include "util/string_utils.h"
 
 using namespace AGS::Common;
 using namespace AGS::DataUtil;
 
+// Max number of threads processing the rooms, when chosen automatically
+const size_t MaxAutoThreads = 8;
 
-class RoomScNamesReader : public DataExtReader
-{
-public:
-    RoomScNamesReader(RoomScNames &data, RoomFileVersion data_ver, std::unique_ptr<Stream> &&in)
-        : DataExtReader(std::move(in),
-            kDataExt_NumID8 | ((data_ver < kRoomVersion_350) ? kDataExt_File32 : kDataExt_File64))
-        , _data(data)
-        , _dataVer(data_ver)
-    {}
-
-private:
-    HError ReadBlock(Stream *in, int block_id, const String &ext_id,
-        soff_t block_len, bool &read_next) override
-    {
-        return ReadRoomScNames(_data, in, (RoomFileBlock)block_id, ext_id, block_len, _dataVer);
-    }
+const char *HELP_STRING = "Usage: crm2ash <input-room.crm> <output-room.ash>\n"
+"       crm2ash -o <output-dir> [OPTIONS] [<input-room.crm> ...]\n"
+"Batch mode:\n"
+"  -o <dir>       write the script header of each room into this directory,\n"
+"                 named after the room file\n"
+"Options:\n"
+"  -j <N>         number of threads processing the rooms, 0 to choose\n"
+"                 automatically (default)\n"
+"  -m <file>      read the list of input rooms from this file, one per line\n";
 
-    RoomScNames &_data;
-    RoomFileVersion _dataVer;
-};
+// Generates the script header for the room file, and writes it into dst
+static HError MakeRoomHeader(const String &src, const String &dst)
+{
+    //-----------------------------------------------------------------------//
+    // Read room struct
+    //-----------------------------------------------------------------------//
+    RoomScNames data;
+    HError err = ReadRoomScNames(data, src);
+    if (!err)
+        return new Error("Failed to read room file", err);
 
+    //-----------------------------------------------------------------------//
+    // Create script header
+    //-----------------------------------------------------------------------//
+    String header = MakeRoomScriptHeader(data);
 
-const char *HELP_STRING = "Usage: crm2ash <input-room.crm> <output-room.ash>\n";
+    //-----------------------------------------------------------------------//
+    // Write script header
+    //-----------------------------------------------------------------------//
+    auto out = File::CreateFile(dst);
+    if (!out)
+        return new Error("Failed to open script header for writing.");
+    out->Write(header.GetCStr(), header.GetLength());
+    return HError::None();
+}
 
 int main(int argc, char *argv[])
 {
@@ -46,55 +62,90 @@ int main(int argc, char *argv[])
             return 0; // display help and bail out
         }
     }
-    if (argc < 3)
+
+    std::vector<String> rooms;
+    String out_dir;
+    String room_list;
+    int thread_count = 0;
+    for (int i = 1; i < argc; ++i)
     {
-        printf("Error: not enough arguments\n");
-        printf("%s\n", HELP_STRING);
-        return -1;
+        if (ags_stricmp(argv[i], "-o") == 0 && (i < argc - 1))
+            out_dir = argv[++i];
+        else if (ags_stricmp(argv[i], "-m") == 0 && (i < argc - 1))
+            room_list = argv[++i];
+        else if (ags_stricmp(argv[i], "-j") == 0 && (i < argc - 1))
+            thread_count = StrUtil::StringToInt(argv[++i]);
+        else
+            rooms.push_back(argv[i]);
     }
 
-    const char *src = argv[1];
-    const char *dst = argv[2];
-    printf("Input room file: %s\n", src);
-    printf("Output script header: %s\n", dst);
+    //-----------------------------------------------------------------------//
+    // Single room mode
+    //-----------------------------------------------------------------------//
+    if (out_dir.IsEmpty())
+    {
+        if (rooms.size() < 2)
+        {
+            printf("Error: not enough arguments\n");
+            printf("%s\n", HELP_STRING);
+            return -1;
+        }
+        printf("Input room file: %s\n", rooms[0].GetCStr());
+        printf("Output script header: %s\n", rooms[1].GetCStr());
+        HError err = MakeRoomHeader(rooms[0], rooms[1]);
+        if (!err)
+        {
+            printf("Error: %s\n", err->FullMessage().GetCStr());
+            return -1;
+        }
+        printf("Script header written successfully.\nDone.\n");
+        return 0;
+    }
 
     //-----------------------------------------------------------------------//
-    // Read room struct
+    // Batch mode
     //-----------------------------------------------------------------------//
-    RoomDataSource datasrc;
-    HError err = static_cast<PError>(OpenRoomFile(src, datasrc));
-    if (!err)
+    if (!room_list.IsEmpty())
     {
-        printf("Error: failed to open room file for reading:\n");
-        printf("%s\n", err->FullMessage().GetCStr());
-        return -1;
+        HError err = ReadRoomList(rooms, room_list);
+        if (!err)
+        {
+            printf("Error: %s\n", err->FullMessage().GetCStr());
+            return -1;
+        }
     }
-    
-    RoomScNames data;
-    RoomScNamesReader reader(data, datasrc.DataVersion, std::move(datasrc.InputStream));
-    err = reader.Read();
-    if (!err)
+    if (rooms.empty())
     {
-        printf("Error: failed to read room file:\n");
-        printf("%s\n", err->FullMessage().GetCStr());
+        printf("Error: no input rooms\n");
+        printf("%s\n", HELP_STRING);
         return -1;
     }
+    printf("Input rooms: %zu\n", rooms.size());
+    printf("Output directory: %s\n", out_dir.GetCStr());
 
-    //-----------------------------------------------------------------------//
-    // Create script header
-    //-----------------------------------------------------------------------//
-    String header = MakeRoomScriptHeader(data);
-
-    //-----------------------------------------------------------------------//
-    // Write script header
-    //-----------------------------------------------------------------------//
-    auto out = File::CreateFile(dst);
-    if (!out)
+    std::atomic<size_t> failed{0u};
+    JobScheduler::InitGlobal(JobScheduler::ResolveThreadCount(thread_count, MaxAutoThreads) - 1);
+    JobScheduler::Global().ParallelFor("Room script header", rooms.size(),
+        [&rooms, &out_dir, &failed](size_t i)
+        {
+            const String dst = MakeRoomOutputPath(rooms[i], out_dir, "ash");
+            HError err = MakeRoomHeader(rooms[i], dst);
+            if (err)
+            {
+                printf("+ %s\n", dst.GetCStr());
+            }
+            else
+            {
+                printf("Error: %s: %s\n", rooms[i].GetCStr(), err->FullMessage().GetCStr());
+                failed++;
+            }
+        });
+    JobScheduler::ShutdownGlobal();
+    if (failed > 0)
     {
-        printf("Error: failed to open script header for writing.\n");
+        printf("Failed to process %zu room(s).\n", failed.load());
         return -1;
     }
-    out->Write(header.GetCStr(), header.GetLength());
-    printf("Script header written successfully.\nDone.\n");
+    printf("Script headers written successfully.\nDone.\n");
     return 0;
 }
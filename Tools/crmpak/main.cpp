@@ -1,15 +1,20 @@
+#include <atomic>
 #include <cerrno>
 #include <cinttypes>
 #include <cstdio>
 #include <cstring>
 #include "game/room_file.h"
 #include "util/data_ext.h"
+#include "data/room_utils.h"
 #include "util/file.h"
+#include "util/jobscheduler.h"
 #include "util/memory_compat.h"
 #include "util/memorystream.h"
 #include "util/string_compat.h"
+#include "util/string_utils.h"
 
 using namespace AGS::Common;
+using namespace AGS::DataUtil;
 
 
 // TODO: move to Common? need to find a good place
@@ -30,14 +35,14 @@ static void print_known_blockids()
         printf("%d:%s\n", i, GetRoomBlockName((RoomFileBlock)i).GetCStr());
 }
 
-HError print_room_blockids(RoomDataSource &datasrc)
+HError print_room_blockids(RoomDataSource &datasrc, String &log)
 {
     HError err = HError::None();
     RoomBlockParser parser(std::move(datasrc.InputStream), datasrc.DataVersion);
-    printf("------ Block ID ------|------- Offset -------|--- Size --\n");
+    log.Append("------ Block ID ------|------- Offset -------|--- Size --\n");
     for (err = parser.OpenBlock(); err && !parser.AtEnd(); err = parser.OpenBlock())
     {
-        printf(" %-16s (%d) | %-20" PRId64 " | %-10zu\n",
+        log.AppendFmt(" %-16s (%d) | %-20" PRId64 " | %-10zu\n",
             parser.GetBlockName().GetCStr(), parser.GetBlockID(), parser.GetBlockOffset(), (size_t)parser.GetBlockLength());
         parser.SkipBlock();
     }
@@ -57,12 +62,22 @@ void UnpackScriptText(Stream *in, Stream *out)
 }
 
 
+// Max number of threads processing the rooms, when chosen automatically
+const size_t MaxAutoThreads = 8;
+
 const char *BIN_STRING = "crmpak v0.1.0 - AGS compiled room's (re)packer\n"
 "Copyright (c) 2021 AGS Team and contributors";
 
 const char *HELP_STRING =
 "Usage: crmpak [OPTIONS] [<in-room.crm> <COMMAND> [<CMD_OPTIONS>]]\n"
+"       crmpak [OPTIONS] -m <list-file> <COMMAND> [<CMD_OPTIONS>]\n"
 "Options:\n"
+"  -j <N>                 number of threads processing the rooms in a batch,\n"
+"                         0 to choose automatically (default)\n"
+"  -m <list-file>         batch mode: run the command for each room listed in\n"
+"                         this file, one per line; the block <file> and the\n"
+"                         '-w' argument then tell the directories, where the\n"
+"                         files are named after the rooms\n"
 "  --tell-blockids        print a list of the known block ids\n"
 "Commands:\n"
 "  -d <blockid>           delete: remove a block from the compiled room\n"
@@ -75,99 +90,23 @@ const char *HELP_STRING =
 "  -w <out-room.crm>      for all commands but '-e': write the resulting room\n"
 "                         into a new file; otherwise will modify the input file\n";
 
-int main(int argc, char *argv[])
+// The command to run for the room
+struct RoomCommand
 {
-    for (int i = 1; i < argc; ++i)
-    {
-        const char *arg = argv[i];
-        if (strcmp(arg, "--help") == 0 || strcmp(arg, "/?") == 0 || strcmp(arg, "-?") == 0)
-        {
-            printf("%s\n", BIN_STRING);
-            printf("%s\n", HELP_STRING);
-            return 0; // display help and bail out
-        }
-    }
-
-    const char *in_roomfile = argv[1];
-    char command = 0;
-    const char *arg_block = nullptr;
-    const char *arg_blockfile = nullptr;
-    const char *out_roomfile = nullptr;
-    bool unpack = false;
-    for (int i = 2; i < argc; ++i)
-    {
-        if (strcmp(argv[i], "--tell-blockids") == 0)
-        {
-            print_known_blockids();
-            return 0;
-        }
-
-        if (argv[i][0] != '-' || strlen(argv[i]) != 2)
-            continue;
-        char arg = argv[i][1];
-        switch (arg)
-        {
-        case 'e': case 'i': case 'x':
-            command = arg;
-            if (argc > i + 2)
-            {
-                arg_block = argv[++i];
-                arg_blockfile = argv[++i];
-            }
-            break;
-        case 'd':
-            command = arg;
-            if (argc > i + 1) arg_block = argv[++i];
-            break;
-        case 'w':
-            if (argc > i + 1) out_roomfile = argv[(i++) + 1];
-            break;
-        case 'l': command = arg;
-            break;
-        case 'u': unpack = true;
-            break;
-        }
-    }
-
-    // Test supported commands and number of args
-    printf("%s\n", BIN_STRING);
-    if (command == 0)
-    {
-        printf("Error: command not specified\n");
-        printf("%s\n", HELP_STRING);
-        return -1;
-    }
-    else if ((command != 'l') &&
-        (!arg_block || ((command != 'd') && !arg_blockfile)))
-    {
-        printf("Error: not enough arguments\n");
-        printf("%s\n", HELP_STRING);
-        return -1;
-    }
-
-    // Print working info
-    int block_numid = 0;
-    String block_strid;
-    printf("Room file: %s\n", in_roomfile);
-    if (command != 'l')
-    {
-        // Parse room block ID
-        char *parse_end = nullptr;
-        errno = 0;
-        block_numid = strtol(arg_block, &parse_end, 0);
-        bool is_old_numid = ((errno == 0) && (parse_end == arg_block + strlen(arg_block)));
-        block_strid = is_old_numid ? GetRoomBlockName((RoomFileBlock)block_numid) : arg_block;
+    char Command = 0;
+    int BlockNumId = 0;
+    String BlockStrId;
+    bool Unpack = false;
+};
 
-        printf("Block ID: %s (%d)\n", block_strid.GetCStr(), block_numid);
-        switch (command)
-        {
-        case 'e': case 'x': printf("Output file: %s\n", arg_blockfile); break;
-        case 'i': printf("Input file: %s\n", arg_blockfile); break;
-        case 'd': default: break;
-        }
-        if (out_roomfile && (command != 'e'))
-            printf("Write modified room into: %s\n", out_roomfile);
-    }
+// Runs the command for the room; the text to print is appended to the log.
+// The empty out_roomfile means that the input room is modified.
+static HError process_room(const RoomCommand &cmd, const String &in_roomfile,
+    const String &arg_blockfile, const String &out_roomfile, String &log)
+{
+    const char command = cmd.Command;
+    const int block_numid = cmd.BlockNumId;
+    const String &block_strid = cmd.BlockStrId;
 
     //-----------------------------------------------------------------------//
     // Open the room, export list of block ids ('l' command).
@@ -175,22 +114,14 @@ int main(int argc, char *argv[])
     RoomDataSource datasrc;
     HError err = static_cast<PError>(OpenRoomFile(in_roomfile, datasrc));
     if (!err)
-    {
-        printf("Error: failed to open room file for reading:\n");
-        printf("%s\n", err->FullMessage().GetCStr());
-        return -1;
-    }
+        return new Error("Failed to open room file for reading", err);
 
     if (command == 'l')
     {
-        err = print_room_blockids(datasrc);
+        err = print_room_blockids(datasrc, log);
         if (!err)
-        {
-            printf("Error: failed to parse the input room:\n");
-            printf("%s\n", err->FullMessage().GetCStr());
-            return -1;
-        }
-        return 0;
+            return new Error("Failed to parse the input room", err);
+        return HError::None();
     }
 
     //-----------------------------------------------------------------------//
@@ -220,16 +151,12 @@ int main(int argc, char *argv[])
     datasrc.InputStream = parser.ReleaseStream();
         
     if (!err)
-    {
-        printf("Error: failed to parse the input room:\n");
-        printf("%s\n", err->FullMessage().GetCStr());
-        return -1;
-    }
+        return new Error("Failed to parse the input room", err);
     // If no block found for deletion / export - stop
     if ((block_head < 0) && (command != 'i'))
     {
-        printf("Requested block not found.\n");
-        return 0;
+        log.Append("Requested block not found.\n");
+        return HError::None();
     }
 
     //-----------------------------------------------------------------------//
@@ -239,15 +166,12 @@ int main(int argc, char *argv[])
     {
         std::unique_ptr<Stream> block_out(File::CreateFile(arg_blockfile));
         if (!block_out)
-        {
-            printf("Error: failed to open block file for writing.\n");
-            return -1;
-        }
+            return new Error("Failed to open block file for writing.");
         // Note we export only the internal block data, skipping the header
         datasrc.InputStream->Seek(block_data_at, kSeekBegin);
         // TODO: this TextScript case is a hack, the tool has to be redesigned
         // with better options for unpacking blocks into a source data
-        if (unpack && block_strid == "TextScript")
+        if (cmd.Unpack && block_strid == "TextScript")
         {
             UnpackScriptText(datasrc.InputStream.get(), block_out.get());
         }
@@ -259,10 +183,7 @@ int main(int argc, char *argv[])
 
     // Export is complete - stop
     if (command == 'e')
-    {
-        printf("Done.\n");
-        return 0;
-    }
+        return HError::None();
 
     //-----------------------------------------------------------------------//
     // Write the new room file (commands 'd', 'i', 'x')
@@ -273,24 +194,18 @@ int main(int argc, char *argv[])
     {
         block_in = File::OpenFileRead(arg_blockfile);
         if (!block_in)
-        {
-            printf("Error: failed to open block file for reading.\n");
-            return -1;
-        }
+            return new Error("Failed to open block file for reading.");
     }
 
     // Depending on settings we write either directly into the new room file,
     // or into the temp buffer which we then use to overwrite existing room
     std::unique_ptr<Stream> room_out;
     std::vector<uint8_t> temp_data;
-    if (out_roomfile)
+    if (!out_roomfile.IsEmpty())
     {
         room_out = File::CreateFile(out_roomfile);
         if (!room_out)
-        {
-            printf("Error: failed to open room file for writing.\n");
-            return -1;
-        }
+            return new Error("Failed to open room file for writing.");
     }
     else
     {
@@ -322,16 +237,183 @@ int main(int argc, char *argv[])
 
     // If we saved the new room into the memory, now it's the time to overwrite
     // the original room with the accumulated data
-    if (!out_roomfile)
+    if (out_roomfile.IsEmpty())
     {
         auto temp_room = std::make_unique<Stream>(std::make_unique<VectorStream>(temp_data));
         room_out = File::CreateFile(in_roomfile);
         if (!room_out)
+            return new Error("Failed to open room file for writing.");
+        CopyStream(temp_room.get(), room_out.get(), temp_data.size());
+    }
+    return HError::None();
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "/?") == 0 || strcmp(arg, "-?") == 0)
+        {
+            printf("%s\n", BIN_STRING);
+            printf("%s\n", HELP_STRING);
+            return 0; // display help and bail out
+        }
+    }
+
+    const char *in_roomfile = nullptr;
+    const char *room_list = nullptr;
+    int thread_count = 0;
+    char command = 0;
+    const char *arg_block = nullptr;
+    const char *arg_blockfile = nullptr;
+    const char *out_roomfile = nullptr;
+    bool unpack = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--tell-blockids") == 0)
+        {
+            print_known_blockids();
+            return 0;
+        }
+
+        if (argv[i][0] != '-' || strlen(argv[i]) != 2)
+        {
+            if (!in_roomfile && !room_list)
+                in_roomfile = argv[i];
+            continue;
+        }
+        char arg = argv[i][1];
+        switch (arg)
+        {
+        case 'e': case 'i': case 'x':
+            command = arg;
+            if (argc > i + 2)
+            {
+                arg_block = argv[++i];
+                arg_blockfile = argv[++i];
+            }
+            break;
+        case 'd':
+            command = arg;
+            if (argc > i + 1) arg_block = argv[++i];
+            break;
+        case 'j':
+            if (argc > i + 1) thread_count = StrUtil::StringToInt(argv[++i]);
+            break;
+        case 'm':
+            if (argc > i + 1) room_list = argv[++i];
+            break;
+        case 'w':
+            if (argc > i + 1) out_roomfile = argv[(i++) + 1];
+            break;
+        case 'l': command = arg;
+            break;
+        case 'u': unpack = true;
+            break;
+        }
+    }
+
+    // Test supported commands and number of args
+    printf("%s\n", BIN_STRING);
+    if (command == 0)
+    {
+        printf("Error: command not specified\n");
+        printf("%s\n", HELP_STRING);
+        return -1;
+    }
+    else if ((!in_roomfile && !room_list) || ((command != 'l') &&
+        (!arg_block || ((command != 'd') && !arg_blockfile))))
+    {
+        printf("Error: not enough arguments\n");
+        printf("%s\n", HELP_STRING);
+        return -1;
+    }
+
+    // Print working info
+    RoomCommand cmd;
+    cmd.Command = command;
+    cmd.Unpack = unpack;
+    if (room_list)
+        printf("Room list: %s\n", room_list);
+    else
+        printf("Room file: %s\n", in_roomfile);
+    if (command != 'l')
+    {
+        // Parse room block ID
+        char *parse_end = nullptr;
+        errno = 0;
+        cmd.BlockNumId = strtol(arg_block, &parse_end, 0);
+        bool is_old_numid = ((errno == 0) && (parse_end == arg_block + strlen(arg_block)));
+        cmd.BlockStrId = is_old_numid ? GetRoomBlockName((RoomFileBlock)cmd.BlockNumId) : arg_block;
+
+        printf("Block ID: %s (%d)\n", cmd.BlockStrId.GetCStr(), cmd.BlockNumId);
+        const char *file_kind = room_list ? "directory" : "file";
+        switch (command)
         {
-            printf("Error: failed to open room file for writing.\n");
+        case 'e': case 'x': printf("Output %s: %s\n", file_kind, arg_blockfile); break;
+        case 'i': printf("Input %s: %s\n", file_kind, arg_blockfile); break;
+        case 'd': default: break;
+        }
+        if (out_roomfile && (command != 'e'))
+            printf("Write modified room into: %s\n", out_roomfile);
+    }
+
+    //-----------------------------------------------------------------------//
+    // Single room mode
+    //-----------------------------------------------------------------------//
+    if (!room_list)
+    {
+        String log;
+        HError err = process_room(cmd, in_roomfile, arg_blockfile, out_roomfile, log);
+        printf("%s", log.GetCStr());
+        if (!err)
+        {
+            printf("Error: %s\n", err->FullMessage().GetCStr());
             return -1;
         }
-        CopyStream(temp_room.get(), room_out.get(), temp_data.size());
+        if (command != 'l')
+            printf("Done.\n");
+        return 0;
+    }
+
+    //-----------------------------------------------------------------------//
+    // Batch mode: the rooms are processed in parallel, each one writes
+    // its own files, named after the room
+    //-----------------------------------------------------------------------//
+    std::vector<String> rooms;
+    HError err = ReadRoomList(rooms, room_list);
+    if (!err)
+    {
+        printf("Error: %s\n", err->FullMessage().GetCStr());
+        return -1;
+    }
+
+    std::atomic<size_t> failed{0u};
+    JobScheduler::InitGlobal(JobScheduler::ResolveThreadCount(thread_count, MaxAutoThreads) - 1);
+    JobScheduler::Global().ParallelFor("Process room", rooms.size(),
+        [&](size_t i)
+        {
+            const String &room = rooms[i];
+            const String blockfile = arg_blockfile ?
+                MakeRoomOutputPath(room, arg_blockfile, cmd.BlockStrId) : String();
+            const String out_room = out_roomfile ?
+                MakeRoomOutputPath(room, out_roomfile, "crm") : String();
+            String log = String::FromFormat("%s:\n", room.GetCStr());
+            HError room_err = process_room(cmd, room, blockfile, out_room, log);
+            if (!room_err)
+            {
+                log.AppendFmt("Error: %s\n", room_err->FullMessage().GetCStr());
+                failed++;
+            }
+            // print the whole room's log at once, not to mix with the others
+            printf("%s", log.GetCStr());
+        });
+    JobScheduler::ShutdownGlobal();
+    if (failed > 0)
+    {
+        printf("Failed to process %zu room(s).\n", failed.load());
+        return -1;
     }
     printf("Done.\n");
     return 0;
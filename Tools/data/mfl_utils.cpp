@@ -12,11 +12,21 @@
 //
 //=============================================================================
 #include "data/mfl_utils.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <unordered_map>
+#include "util/compressedblockstream.h"
 #include "util/directory.h"
 #include "util/file.h"
+#include "util/jobscheduler.h"
+#include "util/memory_compat.h"
+#include "util/memorystream.h"
 #include "util/path.h"
 #include "util/stream.h"
+#include "util/string_types.h"
+#include "util/textstreamreader.h"
 
 using namespace AGS::Common;
 
@@ -28,45 +38,92 @@ namespace DataUtil
 // TODO: might replace "printf" with the logging functions,
 // but then we'd also need to make sure they are initialized in tools
 
+// Size of the chunks in which the assets are copied when unpacking
+static const size_t UnpackChunkSize = 1024 * 1024;
+
+// Extracts a single asset from the library part into the file
+static void UnpackAsset(const AssetInfo &asset, const String &lib_path, const String &dst_dir)
+{
+    const String dst_f = Path::ConcatPaths(dst_dir, asset.FileName);
+    std::unique_ptr<Stream> out(File::CreateFile(dst_f));
+    if (!out)
+    {
+        printf("Error: unable to open a file for writing: %s\n", asset.FileName.GetCStr());
+        return;
+    }
+    std::unique_ptr<Stream> asset_in =
+        File::OpenFile(lib_path, asset.Offset, asset.Offset + asset.DataSize, UnpackChunkSize);
+    if (asset_in && (asset.Compression == kAssetCompress_LZ4Block))
+        asset_in = CompressedBlockStream::Open(std::move(asset_in));
+    else if (asset.Compression != kAssetCompress_None)
+        asset_in.reset(); // unknown compression
+    soff_t wrote = 0;
+    if (asset_in)
+    {
+        // Copy in large chunks, which the buffered streams pass through
+        std::vector<uint8_t> chunk(static_cast<size_t>(std::min<soff_t>(asset.Size, UnpackChunkSize)));
+        for (soff_t left = asset.Size; left > 0;)
+        {
+            const size_t read = asset_in->Read(chunk.data(), static_cast<size_t>(std::min<soff_t>(left, chunk.size())));
+            if (read == 0 || out->Write(chunk.data(), read) < read)
+                break;
+            wrote += read;
+            left -= read;
+        }
+    }
+    if (wrote == asset.Size)
+        printf("+ %s\n", asset.FileName.GetCStr());
+    else
+        printf("Error: file was not written correctly: %s\n Expected: %jd, wrote: %jd bytes\n",
+            asset.FileName.GetCStr(), static_cast<intmax_t>(asset.Size), static_cast<intmax_t>(wrote));
+}
+
 HError UnpackLibrary(const AssetLibInfo &lib, const String &lib_dir, const String &dst_dir)
 {
-    for (size_t i = 0; i < lib.LibFileNames.size(); ++i)
+    std::vector<String> lib_paths;
+    for (const auto &lib_f : lib.LibFileNames)
     {
-        String lib_f = lib.LibFileNames[i];
         String path = Path::ConcatPaths(lib_dir, lib_f);
-        std::unique_ptr<Stream> lib_in(File::OpenFileRead(path));
-        if (!lib_in)
+        if (!File::IsFile(path))
         {
             return new Error(String::FromFormat("Failed to open a library file for reading: %s",
                 lib_f.GetCStr()));
         }
-        printf("Extracting %s:\n", lib_f.GetCStr());
-        for (const auto &asset : lib.AssetInfos)
+        lib_paths.push_back(path);
+    }
+
+    // The subdirectories are created first, because the assets
+    // are extracted in parallel, and may share them
+    std::vector<const AssetInfo*> assets;
+    std::unordered_map<String, bool> sub_dirs;
+    for (const auto &asset : lib.AssetInfos)
+    {
+        if (asset.LibUid >= lib_paths.size())
+        {
+            printf("Error: asset refers to a missing library part: %s\n", asset.FileName.GetCStr());
+            continue;
+        }
+        const String sub_dir = Path::GetParent(asset.FileName);
+        if (!sub_dir.IsEmpty() && sub_dir != ".")
         {
-            if (asset.LibUid != i) continue;
-            String dst_f = Path::ConcatPaths(dst_dir, asset.FileName);
-            String sub_dir = Path::GetParent(asset.FileName);
-            if (!sub_dir.IsEmpty() && sub_dir != "." &&
-                !Directory::CreateAllDirectories(dst_dir, sub_dir))
+            const auto dir_it = sub_dirs.find(sub_dir);
+            const bool dir_ok = (dir_it != sub_dirs.end()) ? dir_it->second :
+                sub_dirs.insert(std::make_pair(sub_dir, Directory::CreateAllDirectories(dst_dir, sub_dir))).first->second;
+            if (!dir_ok)
             {
                 printf("Error: unable to create a subdirectory: %s\n", sub_dir.GetCStr());
                 continue;
             }
-            std::unique_ptr<Stream> out(File::CreateFile(dst_f));
-            if (!out)
-            {
-                printf("Error: unable to open a file for writing: %s\n", asset.FileName.GetCStr());
-                continue;
-            }
-            lib_in->Seek(asset.Offset, kSeekBegin);
-            soff_t wrote = CopyStream(lib_in.get(), out.get(), asset.Size);
-            if (wrote == asset.Size)
-                printf("+ %s\n", asset.FileName.GetCStr());
-            else
-                printf("Error: file was not written correctly: %s\n Expected: %jd, wrote: %jd bytes\n",
-                    asset.FileName.GetCStr(), static_cast<intmax_t>(asset.Size), static_cast<intmax_t>(wrote));
         }
+        assets.push_back(&asset);
     }
+
+    printf("Extracting %zu assets from %s:\n", assets.size(), lib.LibFileNames[0].GetCStr());
+    JobScheduler::Global().ParallelFor("Unpack asset", assets.size(),
+        [&assets, &lib_paths, &dst_dir](size_t i)
+        {
+            UnpackAsset(*assets[i], lib_paths[assets[i]->LibUid], dst_dir);
+        });
     return HError::None();
 }
 
@@ -90,6 +147,51 @@ HError MakeAssetList(std::vector<AssetInfo> &assets, const String &asset_dir,
     return HError::None();
 }
 
+HError OrderAssetsByTrace(std::vector<AssetInfo> &assets, const String &trace_file)
+{
+    std::unique_ptr<Stream> in(File::OpenFileRead(trace_file));
+    if (!in)
+        return new Error(String::FromFormat("Failed to open the asset trace: %s", trace_file.GetCStr()));
+
+    // Each trace line is "<time> <room> <asset name>", in the order of use;
+    // the order key is a pair of (room's first appearance, line index)
+    typedef std::pair<size_t, size_t> TraceKey;
+    std::unordered_map<String, TraceKey, HashStrNoCase, StrEqNoCase> trace;
+    std::unordered_map<int, size_t> room_ranks;
+    TextStreamReader reader(std::move(in));
+    for (size_t line_index = 0; !reader.EOS(); ++line_index)
+    {
+        String line = reader.ReadLine();
+        line.Trim();
+        const size_t room_at = line.FindChar(' ');
+        const size_t name_at = line.FindChar(' ', room_at + 1);
+        if (room_at == String::NoIndex || name_at == String::NoIndex)
+            continue; // skip malformed lines
+        const int room = line.Mid(room_at + 1, name_at - room_at - 1).ToInt();
+        String name = line.Mid(name_at + 1);
+        name.Replace('\\', '/');
+        const size_t room_rank = room_ranks.insert(std::make_pair(room, room_ranks.size())).first->second;
+        trace.insert(std::make_pair(name, TraceKey(room_rank, line_index)));
+    }
+
+    const TraceKey untraced(SIZE_MAX, SIZE_MAX);
+    std::vector<std::pair<TraceKey, AssetInfo>> ordered;
+    ordered.reserve(assets.size());
+    for (auto &asset : assets)
+    {
+        String name = asset.FileName;
+        name.Replace('\\', '/');
+        const auto it = trace.find(name);
+        ordered.push_back(std::make_pair(it != trace.end() ? it->second : untraced, std::move(asset)));
+    }
+    std::stable_sort(ordered.begin(), ordered.end(),
+        [](const std::pair<TraceKey, AssetInfo> &a, const std::pair<TraceKey, AssetInfo> &b)
+        { return a.first < b.first; });
+    for (size_t i = 0; i < ordered.size(); ++i)
+        assets[i] = std::move(ordered[i].second);
+    return HError::None();
+}
+
 HError MakeAssetLib(AssetLibInfo &lib, const String &lib_basefile,
     std::vector<AssetInfo> &assets, soff_t part_size)
 {
@@ -139,30 +241,239 @@ HError MakeAssetLib(AssetLibInfo &lib, const String &lib_basefile,
     return HError::None();
 }
 
+// Max total size of the assets read into memory ahead of writing them
+static const soff_t MaxReadAheadSize = 256 * 1024 * 1024;
+// Assets larger than this are not kept in memory, but streamed when written
+static const soff_t MaxInMemoryAssetSize = 64 * 1024 * 1024;
+// Size of the buffer used when writing the library file
+static const size_t WriteBufferSize = 4 * 1024 * 1024;
+// Size of the chunks in which the streamed assets are read
+static const size_t StreamChunkSize = 1024 * 1024;
+
+// Calculates a 64-bit FNV-1a hash of the data, continuing from the given one
+static uint64_t HashData(const uint8_t *data, size_t size, uint64_t hash = 14695981039346656037ULL)
+{
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    return hash;
+}
+
+// The asset prepared for writing by a job: its data is hashed, and, if it is
+// small enough, kept in memory along with the compressed one
+struct PreparedAsset
+{
+    AssetInfo *Asset = nullptr;
+    String Path;
+    uint64_t Hash = 0u;
+    bool InMemory = false;
+    std::vector<uint8_t> Data;
+    std::vector<uint8_t> Packed; // compressed data, if smaller than the original
+    String Error;
+    JobHandle Job;
+};
+
+static void PrepareAsset(PreparedAsset &pa)
+{
+    std::unique_ptr<Stream> in(File::OpenFileRead(pa.Path));
+    if (!in)
+    {
+        pa.Error = String::FromFormat("Failed to open the file for reading: %s", pa.Asset->FileName.GetCStr());
+        return;
+    }
+    const soff_t size = pa.Asset->Size;
+    if (!pa.InMemory)
+    {
+        std::vector<uint8_t> chunk(StreamChunkSize);
+        uint64_t hash = HashData(nullptr, 0);
+        for (soff_t left = size; left > 0;)
+        {
+            const size_t read = in->Read(chunk.data(), static_cast<size_t>(std::min<soff_t>(left, chunk.size())));
+            if (read == 0)
+                break;
+            hash = HashData(chunk.data(), read, hash);
+            left -= read;
+        }
+        pa.Hash = hash;
+        return;
+    }
+
+    pa.Data.resize(static_cast<size_t>(size));
+    if (in->Read(pa.Data.data(), pa.Data.size()) < pa.Data.size())
+    {
+        pa.Error = String::FromFormat("Failed to read the asset '%s'.", pa.Asset->FileName.GetCStr());
+        return;
+    }
+    pa.Hash = HashData(pa.Data.data(), pa.Data.size());
+    // Only keep the compressed data if it's smaller than the original
+    if (pa.Asset->Compression == kAssetCompress_LZ4Block)
+    {
+        Stream data_in(std::make_unique<VectorStream>(pa.Data));
+        Stream packed_out(std::make_unique<VectorStream>(pa.Packed, kStream_Write));
+        if (CompressedBlockStream::Compress(&data_in, size, &packed_out) < 0)
+        {
+            pa.Error = String::FromFormat("Failed to compress the asset '%s'.", pa.Asset->FileName.GetCStr());
+            return;
+        }
+        if (static_cast<soff_t>(pa.Packed.size()) >= size)
+            pa.Packed = std::vector<uint8_t>();
+    }
+}
+
+// Tells if the two asset files have identical contents
+static bool CompareAssetFiles(const String &path1, const String &path2, soff_t size)
+{
+    std::unique_ptr<Stream> in1(File::OpenFileRead(path1));
+    std::unique_ptr<Stream> in2(File::OpenFileRead(path2));
+    if (!in1 || !in2)
+        return false;
+    std::vector<uint8_t> chunk1(StreamChunkSize), chunk2(StreamChunkSize);
+    for (soff_t left = size; left > 0;)
+    {
+        const size_t to_read = static_cast<size_t>(std::min<soff_t>(left, StreamChunkSize));
+        if (in1->Read(chunk1.data(), to_read) < to_read ||
+            in2->Read(chunk2.data(), to_read) < to_read ||
+            memcmp(chunk1.data(), chunk2.data(), to_read) != 0)
+            return false;
+        left -= to_read;
+    }
+    return true;
+}
+
+// Writes the prepared asset's data into the library, at the current position
+static HError WritePreparedAsset(PreparedAsset &pa, Stream *out)
+{
+    AssetInfo &asset = *pa.Asset;
+    if (!pa.Packed.empty())
+    {
+        asset.DataSize = pa.Packed.size();
+        out->Write(pa.Packed.data(), pa.Packed.size());
+        return HError::None();
+    }
+    if (pa.InMemory)
+    {
+        asset.Compression = kAssetCompress_None;
+        asset.DataSize = asset.Size;
+        out->Write(pa.Data.data(), pa.Data.size());
+        return HError::None();
+    }
+
+    // The large assets are streamed from their files
+    std::unique_ptr<Stream> in(File::OpenFileRead(pa.Path));
+    if (!in)
+        return new Error(String::FromFormat("Failed to open the file for reading: %s", asset.FileName.GetCStr()));
+    if (asset.Compression == kAssetCompress_LZ4Block)
+    {
+        std::vector<uint8_t> packed;
+        Stream packed_out(std::make_unique<VectorStream>(packed, kStream_Write));
+        if (CompressedBlockStream::Compress(in.get(), asset.Size, &packed_out) < 0)
+            return new Error(String::FromFormat("Failed to compress the asset '%s'.", asset.FileName.GetCStr()));
+        if (static_cast<soff_t>(packed.size()) < asset.Size)
+        {
+            asset.DataSize = packed.size();
+            out->Write(packed.data(), packed.size());
+            return HError::None();
+        }
+        in->Seek(0, kSeekBegin);
+    }
+    asset.Compression = kAssetCompress_None;
+    asset.DataSize = asset.Size;
+    if (CopyStream(in.get(), out, asset.Size) < asset.Size)
+        return new Error(String::FromFormat("Failed to write the asset '%s'.", asset.FileName.GetCStr()));
+    return HError::None();
+}
+
 HError WriteLibraryFile(AssetLibInfo &lib, const String &asset_dir,
     const String &lib_filename, MFLUtil::MFLVersion lib_version, int lib_index)
 {
-    std::unique_ptr<Stream> out(File::CreateFile(lib_filename));
+    std::unique_ptr<Stream> out(File::OpenFile(lib_filename, kFile_CreateAlways, kStream_Write, WriteBufferSize));
     if (!out)
         return new Error("Error: failed to open pack file for writing.");
 
     soff_t s_offset = out->GetPosition();
-    MFLUtil::WriteHeader(lib, MFLUtil::kMFLVersion_MultiV30, lib_index, out.get());
+    MFLUtil::WriteHeader(lib, lib_version, lib_index, out.get());
+
+    std::vector<PreparedAsset> prepared;
     for (auto &asset : lib.AssetInfos)
     {
-        if (asset.LibUid == lib_index)
+        if (asset.LibUid != lib_index)
+            continue;
+        if (lib_version < MFLUtil::kMFLVersion_MultiV31)
+            asset.Compression = kAssetCompress_None;
+        PreparedAsset pa;
+        pa.Asset = &asset;
+        pa.Path = Path::ConcatPaths(asset_dir, asset.FileName);
+        pa.InMemory = asset.Size <= MaxInMemoryAssetSize;
+        prepared.push_back(std::move(pa));
+    }
+
+    // The assets are read, hashed and compressed by the jobs, ahead of
+    // writing them, as long as their total size fits the read-ahead limit;
+    // the results are written in the original order.
+    // The assets with the same contents are written only once, and all of
+    // their entries refer to the same data.
+    JobScheduler &jobs = JobScheduler::Global();
+    std::unordered_map<uint64_t, std::vector<const PreparedAsset*>> written;
+    soff_t read_ahead = 0;
+    size_t next_job = 0;
+    HError err = HError::None();
+    for (auto &pa : prepared)
+    {
+        for (; next_job < prepared.size(); ++next_job)
+        {
+            PreparedAsset &next = prepared[next_job];
+            const soff_t mem_size = next.InMemory ? next.Asset->Size : 0;
+            if (read_ahead > 0 && (read_ahead + mem_size > MaxReadAheadSize))
+                break;
+            read_ahead += mem_size;
+            next.Job = jobs.Submit("Prepare asset", [&next]() { PrepareAsset(next); });
+        }
+        jobs.Wait(pa.Job);
+        pa.Job.reset();
+        if (!pa.Error.IsEmpty())
+        {
+            err = new Error(pa.Error);
+            break;
+        }
+
+        AssetInfo &asset = *pa.Asset;
+        const PreparedAsset *same = nullptr;
+        auto &same_hash = written[pa.Hash];
+        for (const auto *other : same_hash)
+        {
+            if (other->Asset->Size == asset.Size &&
+                CompareAssetFiles(other->Path, pa.Path, asset.Size))
+            {
+                same = other;
+                break;
+            }
+        }
+        if (same)
+        {
+            asset.Offset = same->Asset->Offset;
+            asset.DataSize = same->Asset->DataSize;
+            asset.Compression = same->Asset->Compression;
+        }
+        else
         {
             asset.Offset = out->GetPosition() - s_offset;
-            String path = Path::ConcatPaths(asset_dir, asset.FileName);
-            std::unique_ptr<Stream> in(File::OpenFileRead(path));
-            if (!in)
-                return new Error("Failed to open the file for reading.");
-            if (CopyStream(in.get(), out.get(), asset.Size) < asset.Size)
-                return new Error(String::FromFormat("Failed to write the asset '%s'.", asset.FileName.GetCStr()));
+            err = WritePreparedAsset(pa, out.get());
+            if (!err)
+                break;
+            same_hash.push_back(&pa);
         }
+        if (pa.InMemory)
+            read_ahead -= asset.Size;
+        pa.Data = std::vector<uint8_t>();
+        pa.Packed = std::vector<uint8_t>();
     }
+    // The jobs refer to the prepared assets, so wait for them on failure
+    for (const auto &pa : prepared)
+        jobs.Wait(pa.Job);
+    if (!err)
+        return err;
+
     out->Seek(s_offset, kSeekBegin);
-    MFLUtil::WriteHeader(lib, MFLUtil::kMFLVersion_MultiV30, lib_index, out.get());
+    MFLUtil::WriteHeader(lib, lib_version, lib_index, out.get());
     out->Seek(0, kSeekEnd);
     MFLUtil::WriteEnder(s_offset, lib_version, out.get());
     return HError::None();
@@ -171,7 +482,9 @@ HError WriteLibraryFile(AssetLibInfo &lib, const String &asset_dir,
 HError WriteLibrary(AssetLibInfo &lib, const String &asset_dir,
     const String &dst_dir, MFLUtil::MFLVersion lib_version)
 {
-    for (size_t id = 0; id < lib.LibFileNames.size(); ++id)
+    // The first part has the table of contents, which needs the offsets
+    // of the assets in all the other parts, so it's written last
+    for (size_t id = lib.LibFileNames.size(); id-- > 0;)
     {
         String dst_file = Path::ConcatPaths(dst_dir, lib.LibFileNames[id]);
         HError err = WriteLibraryFile(lib, asset_dir, dst_file, lib_version, id);
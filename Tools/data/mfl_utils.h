@@ -34,16 +34,27 @@ namespace DataUtil
     // The output files will be written into dst_dir directory;
     // if the asset name contains directories, they will be created as sub-
     // directories inside dst_dir.
+    // The assets are extracted in parallel, by the jobs of the shared
+    // JobScheduler; only the assets listed in lib are extracted, so the
+    // list may be filtered beforehand.
     HError UnpackLibrary(const AssetLibInfo &lib, const String &lib_dir, const String &dst_dir);
     // Gather a list of files from a given directory
     HError MakeAssetList(std::vector<AssetInfo> &assets, const String &asset_dir,
         bool do_subdirs, const String &lib_basefile);
+    // Reorders the list of assets according to the asset trace recorded by
+    // the engine (see "asset_trace" config option): the assets used in the
+    // same room are grouped together, the groups are ordered by the room's
+    // first appearance, and the assets inside a group by their first use.
+    // The assets not found in the trace are put last, in their original order.
+    HError OrderAssetsByTrace(std::vector<AssetInfo> &assets, const String &trace_file);
     // Generate AssetLibInfo based on a list of assets, optionally limiting each
     // library partition by part_size bytes
     HError MakeAssetLib(AssetLibInfo &lib, const String &lib_basefile,
         std::vector<AssetInfo> &assets, soff_t part_size = 0);
     // Writes the library partition into the file lib_filename;
     // recalculates asset offsets and stores in lib as it goes.
+    // The assets marked for compression are compressed if the library
+    // version supports that, and if the compression reduces their size.
     HError WriteLibraryFile(AssetLibInfo &lib, const String &src_dir,
         const String &lib_filename, AGS::Common::MFLUtil::MFLVersion lib_version, int lib_index);
     // Writes the potentially multi-file library into the dst_dir directory;
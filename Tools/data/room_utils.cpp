@@ -12,7 +12,11 @@
 //
 //=============================================================================
 #include "data/room_utils.h"
+#include "util/data_ext.h"
+#include "util/file.h"
+#include "util/path.h"
 #include "util/string_utils.h"
+#include "util/textstreamreader.h"
 
 #define MIN_ROOM_HOTSPOTS  20
 #define LEGACY_HOTSPOT_NAME_LEN 30
@@ -99,5 +103,60 @@ HError ReadRoomScNames(RoomScNames &data, Stream *in, RoomFileBlock block, const
     }
 }
 
+class RoomScNamesReader : public DataExtReader
+{
+public:
+    RoomScNamesReader(RoomScNames &data, RoomFileVersion data_ver, std::unique_ptr<Stream> &&in)
+        : DataExtReader(std::move(in),
+            kDataExt_NumID8 | ((data_ver < kRoomVersion_350) ? kDataExt_File32 : kDataExt_File64))
+        , _data(data)
+        , _dataVer(data_ver)
+    {}
+
+private:
+    HError ReadBlock(Stream *in, int block_id, const String &ext_id,
+        soff_t block_len, bool &read_next) override
+    {
+        return ReadRoomScNames(_data, in, (RoomFileBlock)block_id, ext_id, block_len, _dataVer);
+    }
+
+    RoomScNames &_data;
+    RoomFileVersion _dataVer;
+};
+
+HError ReadRoomScNames(RoomScNames &data, const String &room_file)
+{
+    RoomDataSource datasrc;
+    HError err = static_cast<PError>(OpenRoomFile(room_file, datasrc));
+    if (!err)
+        return err;
+    RoomScNamesReader reader(data, datasrc.DataVersion, std::move(datasrc.InputStream));
+    return reader.Read();
+}
+
+HError ReadRoomList(std::vector<String> &rooms, const String &list_file)
+{
+    std::unique_ptr<Stream> in(File::OpenFileRead(list_file));
+    if (!in)
+        return new Error(String::FromFormat("Failed to open the room list: %s", list_file.GetCStr()));
+    const String list_dir = Path::GetParent(list_file);
+    TextStreamReader reader(std::move(in));
+    while (!reader.EOS())
+    {
+        String line = reader.ReadLine();
+        line.Trim();
+        if (line.IsEmpty() || line[0] == '#')
+            continue;
+        rooms.push_back(Path::IsRelativePath(line) ? Path::ConcatPaths(list_dir, line) : line);
+    }
+    return HError::None();
+}
+
+String MakeRoomOutputPath(const String &room_file, const String &out_dir, const String &ext)
+{
+    return Path::ConcatPaths(out_dir,
+        String::FromFormat("%s.%s", Path::RemoveExtension(Path::GetFilename(room_file)).GetCStr(), ext.GetCStr()));
+}
+
 } // namespace DataUtil
 } // namespace AGS
@@ -43,6 +43,17 @@ HError ReadObjScNamesBlock(RoomScNames &data, Stream *in, RoomFileVersion data_v
 // reads only blocks necessary for retrieving script names.
 HError ReadRoomScNames(RoomScNames &data, Stream *in, RoomFileBlock block, const String &ext_id,
     soff_t block_len, RoomFileVersion data_ver);
+// Opens the room file and reads the script names from it
+HError ReadRoomScNames(RoomScNames &data, const String &room_file);
+
+// Following functions help the tools to process the rooms in batches
+// Reads the list of room files, one per line; skips the empty lines and the
+// lines starting with '#'. The relative paths are resolved from the list's
+// own directory.
+HError ReadRoomList(std::vector<String> &rooms, const String &list_file);
+// Makes the path of the file produced for the room in a batch: a file in
+// the output directory, named after the room file and the given extension
+String MakeRoomOutputPath(const String &room_file, const String &out_dir, const String &ext);
 
 } // namespace DataUtil
 } // namespace AGS